@@ -42,7 +42,9 @@
 #include "clang/Tooling/Tooling.h"
 #include "llvm/Support/Process.h"
 #include "llvm/Support/Signals.h"
+#include "llvm/Support/ThreadPool.h"
 #include <algorithm>
+#include <mutex>
 #include <utility>
 
 #if CLANG_ENABLE_STATIC_ANALYZER
@@ -392,7 +394,7 @@ ClangTidyASTConsumerFactory::CreateASTConsumer(
   std::unique_ptr<ClangTidyProfiling> Profiling;
   if (Context.getEnableProfiling()) {
     Profiling = std::make_unique<ClangTidyProfiling>(
-        Context.getProfileStorageParams());
+        Context.getProfileStorageParams(), Context.getProfileTotals());
     FinderOptions.CheckProfiling.emplace(Profiling->Records);
   }
 
@@ -488,12 +490,36 @@ getCheckOptions(const ClangTidyOptions &Options,
   return Factory.getCheckOptions();
 }
 
-std::vector<ClangTidyError>
-runClangTidy(clang::tidy::ClangTidyContext &Context,
-             const CompilationDatabase &Compilations,
-             ArrayRef<std::string> InputFiles,
-             llvm::IntrusiveRefCntPtr<llvm::vfs::OverlayFileSystem> BaseFS,
-             bool EnableCheckProfile, llvm::StringRef StoreCheckProfile) {
+namespace {
+/// Forwards to the options provider of another context, one call at a time,
+/// so that the contexts of several threads can share one provider and its
+/// cache of configuration files.
+class SharedOptionsProvider : public ClangTidyOptionsProvider {
+public:
+  SharedOptionsProvider(const ClangTidyContext &Context, std::mutex &Mutex)
+      : Context(Context), Mutex(Mutex) {}
+
+  const ClangTidyGlobalOptions &getGlobalOptions() override {
+    return Context.getGlobalOptions();
+  }
+
+  std::vector<OptionsSource> getRawOptions(StringRef FileName) override {
+    std::lock_guard<std::mutex> Lock(Mutex);
+    return {OptionsSource(Context.getOptionsForFile(FileName),
+                          OptionsSourceTypeDefaultBinary)};
+  }
+
+private:
+  const ClangTidyContext &Context;
+  std::mutex &Mutex;
+};
+} // namespace
+
+static std::vector<ClangTidyError>
+runClangTidyOnFiles(ClangTidyContext &Context,
+                    const CompilationDatabase &Compilations,
+                    ArrayRef<std::string> InputFiles,
+                    llvm::IntrusiveRefCntPtr<llvm::vfs::OverlayFileSystem> BaseFS) {
   ClangTool Tool(Compilations, InputFiles,
                  std::make_shared<PCHContainerOperations>(), BaseFS);
 
@@ -517,8 +543,6 @@ runClangTidy(clang::tidy::ClangTidyContext &Context,
 
   Tool.appendArgumentsAdjuster(PerFileExtraArgumentsInserter);
   Tool.appendArgumentsAdjuster(getStripPluginsAdjuster());
-  Context.setEnableProfiling(EnableCheckProfile);
-  Context.setProfileStoragePrefix(StoreCheckProfile);
 
   ClangTidyDiagnosticConsumer DiagConsumer(Context);
   DiagnosticsEngine DE(new DiagnosticIDs(), new DiagnosticOptions(),
@@ -568,6 +592,67 @@ runClangTidy(clang::tidy::ClangTidyContext &Context,
   return DiagConsumer.take();
 }
 
+std::vector<ClangTidyError>
+runClangTidy(clang::tidy::ClangTidyContext &Context,
+             const CompilationDatabase &Compilations,
+             ArrayRef<std::string> InputFiles,
+             llvm::IntrusiveRefCntPtr<llvm::vfs::OverlayFileSystem> BaseFS,
+             bool EnableCheckProfile, llvm::StringRef StoreCheckProfile,
+             unsigned NumThreads) {
+  Context.setEnableProfiling(EnableCheckProfile);
+  Context.setProfileStoragePrefix(StoreCheckProfile);
+
+  // Print one profile for all the translation units, unless the profiles are
+  // stored separately.
+  llvm::Optional<ClangTidyProfiling> TotalProfiling;
+  if (EnableCheckProfile && StoreCheckProfile.empty()) {
+    TotalProfiling.emplace();
+    Context.setProfileTotals(TotalProfiling.getPointer());
+  }
+
+  if (NumThreads == 0)
+    NumThreads = llvm::hardware_concurrency();
+  std::vector<ClangTidyError> Errors;
+  if (NumThreads <= 1 || InputFiles.size() <= 1) {
+    Errors = runClangTidyOnFiles(Context, Compilations, InputFiles, BaseFS);
+  } else {
+    // Each file gets its own context, with the options provider of Context
+    // shared between them.
+    std::vector<std::vector<ClangTidyError>> FileErrors(InputFiles.size());
+    std::mutex Mutex;
+    llvm::ThreadPool Pool(NumThreads);
+    for (size_t I = 0, E = InputFiles.size(); I != E; ++I) {
+      Pool.async([&, I] {
+        ClangTidyContext FileContext(
+            std::make_unique<SharedOptionsProvider>(Context, Mutex),
+            Context.canEnableAnalyzerAlphaCheckers());
+        FileContext.setEnableProfiling(EnableCheckProfile);
+        FileContext.setProfileStoragePrefix(StoreCheckProfile);
+        FileContext.setProfileTotals(Context.getProfileTotals());
+        // Each thread gets its own file system to allow different concurrent
+        // working directories.
+        llvm::IntrusiveRefCntPtr<llvm::vfs::OverlayFileSystem> FS(
+            new llvm::vfs::OverlayFileSystem(
+                llvm::vfs::createPhysicalFileSystem().release()));
+        FileErrors[I] =
+            runClangTidyOnFiles(FileContext, Compilations, InputFiles[I], FS);
+        std::lock_guard<std::mutex> Lock(Mutex);
+        Context.addStats(FileContext.getStats());
+      });
+    }
+    Pool.wait();
+
+    // Deduplicate the errors of all the files together, as a serial run does.
+    ClangTidyDiagnosticConsumer DiagConsumer(Context);
+    for (std::vector<ClangTidyError> &ErrorsForFile : FileErrors)
+      DiagConsumer.addErrors(std::move(ErrorsForFile));
+    Errors = DiagConsumer.take();
+  }
+
+  Context.setProfileTotals(nullptr);
+  return Errors;
+}
+
 void handleErrors(llvm::ArrayRef<ClangTidyError> Errors,
                   ClangTidyContext &Context, bool Fix,
                   unsigned &WarningsAsErrorsCount,
@@ -212,6 +212,14 @@ ClangTidyContext::getProfileStorageParams() const {
   return ClangTidyProfiling::StorageParams(ProfilePrefix, CurrentFile);
 }
 
+void ClangTidyContext::addStats(const ClangTidyStats &OtherStats) {
+  Stats.ErrorsDisplayed += OtherStats.ErrorsDisplayed;
+  Stats.ErrorsIgnoredCheckFilter += OtherStats.ErrorsIgnoredCheckFilter;
+  Stats.ErrorsIgnoredNOLINT += OtherStats.ErrorsIgnoredNOLINT;
+  Stats.ErrorsIgnoredNonUserCode += OtherStats.ErrorsIgnoredNonUserCode;
+  Stats.ErrorsIgnoredLineFilter += OtherStats.ErrorsIgnoredLineFilter;
+}
+
 bool ClangTidyContext::isCheckEnabled(StringRef CheckName) const {
   assert(CheckFilter != nullptr);
   return CheckFilter->contains(CheckName);
@@ -717,6 +725,9 @@ struct EqualClangTidyError {
 
 std::vector<ClangTidyError> ClangTidyDiagnosticConsumer::take() {
   finalizeLastError();
+  std::move(AddedErrors.begin(), AddedErrors.end(),
+            std::back_inserter(Errors));
+  AddedErrors.clear();
 
   std::sort(Errors.begin(), Errors.end(), LessClangTidyError());
   Errors.erase(std::unique(Errors.begin(), Errors.end(), EqualClangTidyError()),
@@ -725,3 +736,9 @@ std::vector<ClangTidyError> ClangTidyDiagnosticConsumer::take() {
     removeIncompatibleErrors();
   return std::move(Errors);
 }
+
+void ClangTidyDiagnosticConsumer::addErrors(
+    std::vector<ClangTidyError> OtherErrors) {
+  std::move(OtherErrors.begin(), OtherErrors.end(),
+            std::back_inserter(AddedErrors));
+}
@@ -152,6 +152,15 @@ public:
   llvm::Optional<ClangTidyProfiling::StorageParams>
   getProfileStorageParams() const;
 
+  /// Sets the profile which the check profiles of the translation units are
+  /// added to, instead of being printed for each translation unit.
+  void setProfileTotals(ClangTidyProfiling *Totals) { ProfileTotals = Totals; }
+  ClangTidyProfiling *getProfileTotals() const { return ProfileTotals; }
+
+  /// Adds the counters in \p OtherStats, e.g. those collected by the context
+  /// of another thread.
+  void addStats(const ClangTidyStats &OtherStats);
+
   /// Should be called when starting to process new translation unit.
   void setCurrentBuildDirectory(StringRef BuildDirectory) {
     CurrentBuildDirectory = BuildDirectory;
@@ -200,6 +209,7 @@ private:
 
   bool Profile;
   std::string ProfilePrefix;
+  ClangTidyProfiling *ProfileTotals = nullptr;
 
   bool AllowEnablingAnalyzerAlphaCheckers;
 };
@@ -241,6 +251,10 @@ public:
   // Retrieve the diagnostics that were captured.
   std::vector<ClangTidyError> take();
 
+  /// Adds errors taken from the consumer of another translation unit, so that
+  /// take() deduplicates them together with the ones captured here.
+  void addErrors(std::vector<ClangTidyError> OtherErrors);
+
 private:
   void finalizeLastError();
   void removeIncompatibleErrors();
@@ -260,6 +274,7 @@ private:
   DiagnosticsEngine *ExternalDiagEngine;
   bool RemoveIncompatibleErrors;
   std::vector<ClangTidyError> Errors;
+  std::vector<ClangTidyError> AddedErrors;
   std::unique_ptr<llvm::Regex> HeaderFilter;
   bool LastErrorRelatesToUserCode;
   bool LastErrorPassesLineFilter;
@@ -76,10 +76,16 @@ void ClangTidyProfiling::storeProfileData() {
   printAsJSON(OS);
 }
 
-ClangTidyProfiling::ClangTidyProfiling(llvm::Optional<StorageParams> Storage)
-    : Storage(std::move(Storage)) {}
+ClangTidyProfiling::ClangTidyProfiling(llvm::Optional<StorageParams> Storage,
+                                       ClangTidyProfiling *Totals)
+    : Storage(std::move(Storage)), Totals(Totals) {}
 
 ClangTidyProfiling::~ClangTidyProfiling() {
+  if (Totals) {
+    Totals->addRecords(Records);
+    return;
+  }
+
   TG.emplace("clang-tidy", "clang-tidy checks profiling", Records);
 
   if (!Storage.hasValue())
@@ -88,5 +94,12 @@ ClangTidyProfiling::~ClangTidyProfiling() {
     storeProfileData();
 }
 
+void ClangTidyProfiling::addRecords(
+    const llvm::StringMap<llvm::TimeRecord> &OtherRecords) {
+  std::lock_guard<std::mutex> Lock(RecordsMutex);
+  for (const auto &Record : OtherRecords)
+    Records[Record.getKey()] += Record.getValue();
+}
+
 } // namespace tidy
 } // namespace clang
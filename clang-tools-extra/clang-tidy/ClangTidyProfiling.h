@@ -14,6 +14,7 @@
 #include "llvm/Support/Chrono.h"
 #include "llvm/Support/Timer.h"
 #include "llvm/Support/raw_ostream.h"
+#include <mutex>
 #include <string>
 #include <utility>
 #include <vector>
@@ -38,6 +39,9 @@ private:
 
   llvm::Optional<StorageParams> Storage;
 
+  ClangTidyProfiling *Totals = nullptr;
+  std::mutex RecordsMutex;
+
   void printUserFriendlyTable(llvm::raw_ostream &OS);
   void printAsJSON(llvm::raw_ostream &OS);
 
@@ -48,9 +52,16 @@ public:
 
   ClangTidyProfiling() = default;
 
-  ClangTidyProfiling(llvm::Optional<StorageParams> Storage);
+  /// If \p Totals is given, the records are added to it on destruction
+  /// instead of being printed or stored.
+  ClangTidyProfiling(llvm::Optional<StorageParams> Storage,
+                     ClangTidyProfiling *Totals = nullptr);
 
   ~ClangTidyProfiling();
+
+  /// Adds \p OtherRecords to the records, e.g. to sum up the profiles of
+  /// several translation units. Can be called from several threads.
+  void addRecords(const llvm::StringMap<llvm::TimeRecord> &OtherRecords);
 };
 
 } // end namespace tidy
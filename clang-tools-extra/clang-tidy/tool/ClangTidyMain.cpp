@@ -224,6 +224,14 @@ over the real file system.
                                        cl::value_desc("filename"),
                                        cl::cat(ClangTidyCategory));
 
+static cl::opt<unsigned> NumThreads("j", cl::desc(R"(
+Number of files to process in parallel. 0 means
+one per hardware thread. Cannot be combined with
+-vfsoverlay.
+)"),
+                                    cl::init(1), cl::value_desc("N"),
+                                    cl::cat(ClangTidyCategory));
+
 namespace clang {
 namespace tidy {
 
@@ -334,6 +342,10 @@ static int clangTidyMain(int argc, const char **argv) {
       new vfs::OverlayFileSystem(vfs::getRealFileSystem()));
 
   if (!VfsOverlay.empty()) {
+    if (NumThreads != 1) {
+      llvm::errs() << "Error: -j cannot be combined with -vfsoverlay.\n";
+      return 1;
+    }
     IntrusiveRefCntPtr<vfs::FileSystem> VfsFromFile =
         getVfsFromFile(VfsOverlay, BaseFS);
     if (!VfsFromFile)
@@ -429,7 +441,7 @@ static int clangTidyMain(int argc, const char **argv) {
                            AllowEnablingAnalyzerAlphaCheckers);
   std::vector<ClangTidyError> Errors =
       runClangTidy(Context, OptionsParser.getCompilations(), PathList, BaseFS,
-                   EnableCheckProfile, ProfilePrefix);
+                   EnableCheckProfile, ProfilePrefix, NumThreads);
   bool FoundErrors = llvm::find_if(Errors, [](const ClangTidyError &E) {
                        return E.DiagLevel == ClangTidyError::Error;
                      }) != Errors.end();
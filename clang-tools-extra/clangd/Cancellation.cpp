@@ -13,20 +13,34 @@ namespace clang {
 namespace clangd {
 
 char CancelledError::ID = 0;
-static Key<std::shared_ptr<std::atomic<bool>>> FlagKey;
+
+namespace {
+struct CancelState {
+  std::atomic<bool> Cancelled{false};
+  // The task this one was started in, if any.
+  std::shared_ptr<const CancelState> Parent;
+};
+} // namespace
+static Key<std::shared_ptr<const CancelState>> StateKey;
 
 std::pair<Context, Canceler> cancelableTask() {
-  auto Flag = std::make_shared<std::atomic<bool>>();
+  auto State = std::make_shared<CancelState>();
+  if (auto *Parent = Context::current().get(StateKey))
+    State->Parent = *Parent;
   return {
-      Context::current().derive(FlagKey, Flag),
-      [Flag] { *Flag = true; },
+      Context::current().derive(StateKey, State),
+      [State] { State->Cancelled = true; },
   };
 }
 
 bool isCancelled(const Context &Ctx) {
-  if (auto *Flag = Ctx.get(FlagKey))
-    return **Flag;
-  return false; // Not in scope of a task.
+  auto *State = Ctx.get(StateKey);
+  if (!State)
+    return false; // Not in scope of a task.
+  for (const CancelState *S = State->get(); S; S = S->Parent.get())
+    if (S->Cancelled)
+      return true;
+  return false;
 }
 
 } // namespace clangd
@@ -73,6 +73,7 @@ using Canceler = std::function<void()>;
 /// The returned Context defines the scope of the task.
 /// When the context is active, isCancelled() is false until the Canceler is
 /// invoked, and true afterwards.
+/// A task defined within the scope of another one is also cancelled with it.
 std::pair<Context, Canceler> cancelableTask();
 
 /// True if the current context is within a cancelable task which was cancelled.
@@ -84,6 +84,13 @@ struct UpdateIndexCallbacks : public ParsingCallbacks {
     });
   }
 
+  void onPartialMainAST(PathRef Path, ParsedAST &AST,
+                        PublishFn Publish) override {
+    // The index and highlightings wait for the complete AST.
+    Publish(
+        [&]() { DiagConsumer.onDiagnosticsReady(Path, AST.getDiagnostics()); });
+  }
+
   void onFailedAST(PathRef Path, std::vector<Diag> Diags,
                    PublishFn Publish) override {
     Publish([&]() { DiagConsumer.onDiagnosticsReady(Path, Diags); });
@@ -119,6 +126,7 @@ ClangdServer::ClangdServer(const GlobalCompilationDatabase &CDB,
                      : nullptr),
       GetClangTidyOptions(Opts.GetClangTidyOptions),
       SuggestMissingIncludes(Opts.SuggestMissingIncludes),
+      SkipUnchangedFunctionBodies(Opts.SkipUnchangedFunctionBodies),
       TweakFilter(Opts.TweakFilter), WorkspaceRoot(Opts.WorkspaceRoot),
       // Pass a callback into `WorkScheduler` to extract symbols from a newly
       // parsed file and rebuild the file index synchronously each time an AST
@@ -163,6 +171,7 @@ void ClangdServer::addDocument(PathRef File, llvm::StringRef Contents,
   if (GetClangTidyOptions)
     Opts.ClangTidyOpts = GetClangTidyOptions(*FS, File);
   Opts.SuggestMissingIncludes = SuggestMissingIncludes;
+  Opts.SkipUnchangedFunctionBodies = SkipUnchangedFunctionBodies;
 
   // Compile command is set asynchronously during update, as it can be slow.
   ParseInputs Inputs;
@@ -190,6 +199,18 @@ void ClangdServer::codeComplete(PathRef File, Position Pos,
   if (!CodeCompleteOpts.Index) // Respect overridden index.
     CodeCompleteOpts.Index = Index;
 
+  // A completion that is still queued or running when the next one in the same
+  // file arrives is superseded, so cancel it.
+  auto Cancelable = cancelableTask();
+  {
+    std::lock_guard<std::mutex> Lock(LastCompletionMutex);
+    Canceler &Last = LastCompletionByFile[File];
+    if (Last)
+      Last();
+    Last = std::move(Cancelable.second);
+  }
+  WithContext CancelableContext(std::move(Cancelable.first));
+
   auto Task = [Pos, FS = FSProvider.getFileSystem(), CodeCompleteOpts,
                File = File.str(), CB = std::move(CB),
                this](llvm::Expected<InputsAndPreamble> IP) mutable {
@@ -221,7 +242,11 @@ void ClangdServer::codeComplete(PathRef File, Position Pos,
         CodeCompleteOpts, SpecFuzzyFind ? SpecFuzzyFind.getPointer() : nullptr);
     {
       clang::clangd::trace::Span Tracer("Completion results callback");
-      CB(std::move(Result));
+      // The completion may have stopped early, and its results be incomplete.
+      if (isCancelled())
+        CB(llvm::make_error<CancelledError>());
+      else
+        CB(std::move(Result));
     }
     if (SpecFuzzyFind && SpecFuzzyFind->NewReq.hasValue()) {
       std::lock_guard<std::mutex> Lock(CachedCompletionFuzzyFindRequestMutex);
@@ -125,6 +125,10 @@ public:
 
     bool SuggestMissingIncludes = false;
 
+    /// Publish diagnostics of edited files sooner by first rebuilding them
+    /// without the unchanged function bodies before the edit.
+    bool SkipUnchangedFunctionBodies = false;
+
     /// Clangd will execute compiler drivers matching one of these globs to
     /// fetch system include path.
     std::vector<std::string> QueryDriverGlobs;
@@ -326,6 +330,8 @@ private:
   // can be caused by missing includes (e.g. member access in incomplete type).
   bool SuggestMissingIncludes = false;
 
+  bool SkipUnchangedFunctionBodies = false;
+
   std::function<bool(const Tweak &)> TweakFilter;
 
   // GUARDED_BY(CachedCompletionFuzzyFindRequestMutex)
@@ -333,6 +339,12 @@ private:
       CachedCompletionFuzzyFindRequestByFile;
   mutable std::mutex CachedCompletionFuzzyFindRequestMutex;
 
+  // Cancels the last code completion in each file. Its results are no longer
+  // needed once another completion is requested in the same file.
+  // GUARDED_BY(LastCompletionMutex)
+  llvm::StringMap<Canceler> LastCompletionByFile;
+  std::mutex LastCompletionMutex;
+
   llvm::Optional<std::string> WorkspaceRoot;
   // WorkScheduler has to be the last member, because its destructor has to be
   // called before all other members to stop the worker thread that references
@@ -19,6 +19,7 @@
 
 #include "CodeComplete.h"
 #include "AST.h"
+#include "Cancellation.h"
 #include "CodeCompletionStrings.h"
 #include "Compiler.h"
 #include "Diagnostics.h"
@@ -1150,6 +1151,9 @@ bool allowIndex(CodeCompletionContext &CC) {
 std::future<SymbolSlab> startAsyncFuzzyFind(const SymbolIndex &Index,
                                             const FuzzyFindRequest &Req) {
   return runAsync<SymbolSlab>([&Index, Req]() {
+    // The completion was superseded before we got to run.
+    if (isCancelled())
+      return SymbolSlab();
     trace::Span Tracer("Async fuzzyFind");
     SymbolSlab::Builder Syms;
     Index.fuzzyFind(Req, [&Syms](const Symbol &Sym) { Syms.insert(Sym); });
@@ -1253,6 +1257,9 @@ public:
     CodeCompleteResult Output;
     auto RecorderOwner = std::make_unique<CompletionRecorder>(Opts, [&]() {
       assert(Recorder && "Recorder is not set");
+      // Nobody is waiting for the results, skip querying and ranking.
+      if (isCancelled())
+        return;
       CCContextKind = Recorder->CCContext.getKind();
       auto Style = getFormatStyleForFile(
           SemaCCInput.FileName, SemaCCInput.Contents, SemaCCInput.VFS.get());
@@ -1375,6 +1382,8 @@ public:
     QueryScopes = Scopes.scopesForIndexQuery();
     ScopeProximity.emplace(QueryScopes);
 
+    if (isCancelled())
+      return {};
     SymbolSlab IndexResults = Opts.Index ? queryIndex() : SymbolSlab();
 
     CodeCompleteResult Output = toCodeCompleteResult(mergeResults(
@@ -1436,9 +1445,13 @@ private:
     //        explicitly request symbols corresponding to Sema results.
     //        We can use their signals even if the index can't suggest them.
     // We must copy index results to preserve them, but there are at most Limit.
+    if (isCancelled())
+      return {};
     auto IndexResults = (Opts.Index && allowIndex(Recorder->CCContext))
                             ? queryIndex()
                             : SymbolSlab();
+    if (isCancelled())
+      return {};
     trace::Span Tracer("Populate CodeCompleteResult");
     // Merge Sema and Index results, score them, and pick the winners.
     auto Top =
@@ -38,6 +38,11 @@ public:
 struct ParseOptions {
   tidy::ClangTidyOptions ClangTidyOpts;
   bool SuggestMissingIncludes = false;
+  /// When rebuilding the AST for diagnostics after an edit, skip the bodies of
+  /// functions that end before the first changed character and reuse their
+  /// diagnostics from the last build. Template and constexpr functions are
+  /// always parsed, as later code may depend on their bodies.
+  bool SkipUnchangedFunctionBodies = false;
 };
 
 /// Information required to run clang, e.g. to parse AST or do code completion.
@@ -182,19 +182,18 @@ bool FuzzyMatcher::init(llvm::StringRef NewWord) {
   WordN = std::min<int>(MaxWord, NewWord.size());
   if (PatN > WordN)
     return false;
-  std::copy(NewWord.begin(), NewWord.begin() + WordN, Word);
-  if (PatN == 0)
-    return true;
-  for (int I = 0; I < WordN; ++I)
-    LowWord[I] = lower(Word[I]);
-
-  // Cheap subsequence check.
+  // Cheap subsequence check. Most words fail it, so do it before copying.
   for (int W = 0, P = 0; P != PatN; ++W) {
     if (W == WordN)
       return false;
-    if (LowWord[W] == LowPat[P])
+    if (lower(NewWord[W]) == LowPat[P])
       ++P;
   }
+  std::copy(NewWord.begin(), NewWord.begin() + WordN, Word);
+  if (PatN == 0)
+    return true;
+  for (int I = 0; I < WordN; ++I)
+    LowWord[I] = lower(Word[I]);
 
   // FIXME: some words are hard to tokenize algorithmically.
   // e.g. vsprintf is V S Print F, and should match [pri] but not [int].
@@ -213,6 +212,11 @@ bool FuzzyMatcher::init(llvm::StringRef NewWord) {
 // and 3 being a great one. So we treat the score range as [0, 3 * PatN].
 // This range is not strict: we can apply larger bonuses/penalties, or penalize
 // non-matched characters.
+//
+// Each pattern character must be followed by enough word characters to match
+// the rest of the pattern, so only a band of each row can lead to a full match:
+// Pat[P] is matched against Word[P..WordN-PatN+P]. Cells outside the band are
+// not computed and hold stale values, dumpLast() does not show them.
 void FuzzyMatcher::buildGraph() {
   for (int W = 0; W < WordN; ++W) {
     Scores[0][W + 1][Miss] = {Scores[0][W][Miss].Score - skipPenalty(W, Miss),
@@ -220,7 +224,7 @@ void FuzzyMatcher::buildGraph() {
     Scores[0][W + 1][Match] = {AwfulScore, Miss};
   }
   for (int P = 0; P < PatN; ++P) {
-    for (int W = P; W < WordN; ++W) {
+    for (int W = P, End = WordN - PatN + P; W <= End; ++W) {
       auto &Score = Scores[P + 1][W + 1], &PreMiss = Scores[P + 1][W];
 
       auto MatchMissScore = PreMiss[Match].Score;
@@ -384,7 +388,9 @@ llvm::SmallString<256> FuzzyMatcher::dumpLast(llvm::raw_ostream &OS) const {
     for (Action A : {Miss, Match}) {
       OS << ((I && A == Miss) ? Pat[I - 1] : ' ') << "|";
       for (int J = 0; J <= WordN; ++J) {
-        if (!isAwful(Scores[I][J][A].Score))
+        if (I && J > WordN - PatN + I) // Outside the band, see buildGraph().
+          OS << "    ";
+        else if (!isAwful(Scores[I][J][A].Score))
           OS << llvm::format("%3d%c", Scores[I][J][A].Score,
                              Scores[I][J][A].Prev == Match ? '*' : ' ');
         else
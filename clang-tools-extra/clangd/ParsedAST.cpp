@@ -21,6 +21,8 @@
 #include "index/Index.h"
 #include "clang/AST/ASTContext.h"
 #include "clang/AST/Decl.h"
+#include "clang/AST/DeclCXX.h"
+#include "clang/Basic/DiagnosticIDs.h"
 #include "clang/Basic/LangOptions.h"
 #include "clang/Basic/SourceLocation.h"
 #include "clang/Basic/SourceManager.h"
@@ -64,8 +66,11 @@ template <class T> std::size_t getUsedBytes(const std::vector<T> &Vec) {
 
 class DeclTrackingASTConsumer : public ASTConsumer {
 public:
-  DeclTrackingASTConsumer(std::vector<Decl *> &TopLevelDecls)
-      : TopLevelDecls(TopLevelDecls) {}
+  DeclTrackingASTConsumer(std::vector<Decl *> &TopLevelDecls,
+                          const PreviousParse *Previous,
+                          std::vector<FunctionBody> &SkippedBodies)
+      : TopLevelDecls(TopLevelDecls), Previous(Previous),
+        SkippedBodies(SkippedBodies) {}
 
   bool HandleTopLevelDecl(DeclGroupRef DG) override {
     for (Decl *D : DG) {
@@ -85,24 +90,140 @@ public:
     return true;
   }
 
+  // Only called when rebuilding with Previous, which enables skipping.
+  bool shouldSkipFunctionBody(Decl *D) override {
+    if (!Previous)
+      return false;
+    // Bodies of templates are needed to instantiate them later.
+    const FunctionDecl *FD = D->getAsFunction();
+    if (!FD || FD->isTemplated())
+      return false;
+    auto &SM = D->getASTContext().getSourceManager();
+    SourceLocation Loc = FD->getLocation();
+    if (!Loc.isFileID() || !isInsideMainFile(Loc, SM))
+      return false;
+    unsigned Offset = SM.getFileOffset(Loc);
+    auto It = llvm::partition_point(
+        Previous->Bodies,
+        [&](const FunctionBody &B) { return B.NameOffset < Offset; });
+    if (It == Previous->Bodies.end() || It->NameOffset != Offset ||
+        It->End > Previous->EditOffset)
+      return false;
+    SkippedBodies.push_back(*It);
+    return true;
+  }
+
 private:
   std::vector<Decl *> &TopLevelDecls;
+  const PreviousParse *Previous;
+  std::vector<FunctionBody> &SkippedBodies;
 };
 
 class ClangdFrontendAction : public SyntaxOnlyAction {
 public:
+  ClangdFrontendAction(const PreviousParse *Previous) : Previous(Previous) {}
+
   std::vector<Decl *> takeTopLevelDecls() { return std::move(TopLevelDecls); }
+  std::vector<FunctionBody> takeSkippedBodies() {
+    return std::move(SkippedBodies);
+  }
 
 protected:
   std::unique_ptr<ASTConsumer>
   CreateASTConsumer(CompilerInstance &CI, llvm::StringRef InFile) override {
-    return std::make_unique<DeclTrackingASTConsumer>(/*ref*/ TopLevelDecls);
+    return std::make_unique<DeclTrackingASTConsumer>(
+        /*ref*/ TopLevelDecls, Previous, /*ref*/ SkippedBodies);
   }
 
 private:
+  const PreviousParse *Previous;
   std::vector<Decl *> TopLevelDecls;
+  std::vector<FunctionBody> SkippedBodies;
 };
 
+// Records the parsed bodies of non-template functions defined in D, which a
+// later parse may skip.
+void collectFunctionBodies(const Decl &D, const SourceManager &SM,
+                           std::vector<FunctionBody> &Out) {
+  if (const auto *FD = dyn_cast<FunctionDecl>(&D)) {
+    if (!FD->doesThisDeclarationHaveABody() || FD->hasSkippedBody() ||
+        FD->isTemplated())
+      return;
+    const Stmt *Body = FD->getBody();
+    if (!Body)
+      return;
+    SourceLocation Begin = Body->getBeginLoc();
+    if (const auto *Ctor = dyn_cast<CXXConstructorDecl>(FD))
+      for (const CXXCtorInitializer *Init : Ctor->inits()) {
+        SourceLocation InitBegin = Init->getSourceRange().getBegin();
+        if (Init->isWritten() && InitBegin.isValid() &&
+            SM.isBeforeInTranslationUnit(InitBegin, Begin))
+          Begin = InitBegin;
+      }
+    SourceLocation Name = FD->getLocation(), End = Body->getEndLoc();
+    for (SourceLocation Loc : {Name, Begin, End})
+      if (!Loc.isFileID() || !isInsideMainFile(Loc, SM))
+        return;
+    Out.push_back({SM.getFileOffset(Name), SM.getFileOffset(Begin),
+                   SM.getFileOffset(End) + 1});
+    return;
+  }
+  if (isa<NamespaceDecl>(D) || isa<LinkageSpecDecl>(D) ||
+      isa<CXXRecordDecl>(D))
+    for (const Decl *Child : cast<DeclContext>(D).decls())
+      collectFunctionBodies(*Child, SM, Out);
+}
+
+// Whether D warns about an unused entity. A parse that skipped some function
+// bodies did not see the uses in them.
+bool isUnusedWarning(const Diag &D) {
+  if (D.Source != Diag::Clang)
+    return false;
+  llvm::StringRef Flag = DiagnosticIDs::getWarningOptionForDiag(D.ID);
+  return Flag.startswith("unused") || Flag.startswith("unneeded");
+}
+
+// Returns the offset of the start of a main-file diagnostic, if it lies past
+// the preamble.
+llvm::Optional<size_t> mainFileOffset(const Diag &D, llvm::StringRef Code,
+                                      unsigned PreambleSize) {
+  if (!D.InsideMainFile)
+    return None;
+  auto Offset = positionToOffset(Code, D.Range.start,
+                                 /*AllowColumnsBeyondLineLength=*/false);
+  if (!Offset) {
+    llvm::consumeError(Offset.takeError());
+    return None;
+  }
+  if (*Offset < PreambleSize)
+    return None;
+  return *Offset;
+}
+
+// Replaces the diagnostics a parse that skipped function bodies got wrong or
+// missed, with the ones from the previous parse.
+void reuseDiagnostics(std::vector<Diag> &Diags, const PreviousParse &Previous,
+                      llvm::ArrayRef<FunctionBody> Skipped,
+                      llvm::StringRef Code, unsigned PreambleSize) {
+  llvm::erase_if(Diags, [&](const Diag &D) {
+    if (!isUnusedWarning(D))
+      return false;
+    auto Offset = mainFileOffset(D, Code, PreambleSize);
+    return Offset && *Offset < Previous.EditOffset;
+  });
+  for (const Diag &D : Previous.Diags) {
+    auto Offset = mainFileOffset(D, Code, PreambleSize);
+    if (!Offset || *Offset >= Previous.EditOffset)
+      continue;
+    // Skipped is sorted, as bodies are skipped in the order of the file.
+    auto Body = llvm::partition_point(
+        Skipped, [&](const FunctionBody &B) { return B.End <= *Offset; });
+    bool InSkippedBody = Body != Skipped.end() && Body->Begin <= *Offset;
+    if (InSkippedBody || isUnusedWarning(D))
+      Diags.push_back(D);
+  }
+}
+
 // When using a preamble, only preprocessor events outside its bounds are seen.
 // This is almost what we want: replaying transitive preprocessing wastes time.
 // However this confuses clang-tidy checks: they don't see any #includes!
@@ -220,11 +341,15 @@ ParsedAST::build(std::unique_ptr<clang::CompilerInvocation> CI,
                  std::shared_ptr<const PreambleData> Preamble,
                  std::unique_ptr<llvm::MemoryBuffer> Buffer,
                  llvm::IntrusiveRefCntPtr<llvm::vfs::FileSystem> VFS,
-                 const SymbolIndex *Index, const ParseOptions &Opts) {
+                 const SymbolIndex *Index, const ParseOptions &Opts,
+                 const PreviousParse *Previous) {
   assert(CI);
   // Command-line parsing sets DisableFree to true by default, but we don't want
   // to leak memory in clangd.
   CI->getFrontendOpts().DisableFree = false;
+  // The consumer decides which bodies are skipped.
+  if (Previous)
+    CI->getFrontendOpts().SkipFunctionBodies = true;
   const PrecompiledPreamble *PreamblePCH =
       Preamble ? &Preamble->Preamble : nullptr;
 
@@ -237,7 +362,7 @@ ParsedAST::build(std::unique_ptr<clang::CompilerInvocation> CI,
   if (!Clang)
     return None;
 
-  auto Action = std::make_unique<ClangdFrontendAction>();
+  auto Action = std::make_unique<ClangdFrontendAction>(Previous);
   const FrontendInputFile &MainInput = Clang->getFrontendOpts().Inputs[0];
   if (!Action->BeginSourceFile(*Clang, MainInput)) {
     log("BeginSourceFile() failed when building AST for {0}",
@@ -372,6 +497,16 @@ ParsedAST::build(std::unique_ptr<clang::CompilerInvocation> CI,
   // modernize-use-trailing-return-type does that today).
   syntax::TokenBuffer Tokens = std::move(CollectTokens).consume();
   std::vector<Decl *> ParsedDecls = Action->takeTopLevelDecls();
+  std::vector<FunctionBody> SkippedBodies = Action->takeSkippedBodies();
+  std::vector<FunctionBody> Bodies;
+  if (Opts.SkipUnchangedFunctionBodies) {
+    for (const Decl *D : ParsedDecls)
+      collectFunctionBodies(*D, Clang->getSourceManager(), Bodies);
+    Bodies.insert(Bodies.end(), SkippedBodies.begin(), SkippedBodies.end());
+    llvm::sort(Bodies, [](const FunctionBody &L, const FunctionBody &R) {
+      return L.NameOffset < R.NameOffset;
+    });
+  }
   // AST traversals should exclude the preamble, to avoid performance cliffs.
   Clang->getASTContext().setTraversalScope(ParsedDecls);
   {
@@ -400,10 +535,16 @@ ParsedAST::build(std::unique_ptr<clang::CompilerInvocation> CI,
     std::vector<Diag> D = ASTDiags.take(CTContext.getPointer());
     Diags.insert(Diags.end(), D.begin(), D.end());
   }
-  return ParsedAST(std::move(Preamble), std::move(Clang), std::move(Action),
+  if (!SkippedBodies.empty())
+    reuseDiagnostics(Diags, *Previous, SkippedBodies, Content,
+                     PreamblePCH ? PreamblePCH->getBounds().Size : 0);
+  ParsedAST Result(std::move(Preamble), std::move(Clang), std::move(Action),
                    std::move(Tokens), std::move(Macros), std::move(ParsedDecls),
                    std::move(Diags), std::move(Includes),
                    std::move(CanonIncludes));
+  Result.Bodies = std::move(Bodies);
+  Result.SkippedBodies = !SkippedBodies.empty();
+  return std::move(Result);
 }
 
 ParsedAST::ParsedAST(ParsedAST &&Other) = default;
@@ -505,7 +646,8 @@ llvm::Optional<ParsedAST>
 buildAST(PathRef FileName, std::unique_ptr<CompilerInvocation> Invocation,
          llvm::ArrayRef<Diag> CompilerInvocationDiags,
          const ParseInputs &Inputs,
-         std::shared_ptr<const PreambleData> Preamble) {
+         std::shared_ptr<const PreambleData> Preamble,
+         const PreviousParse *Previous) {
   trace::Span Tracer("BuildAST");
   SPAN_ATTACH(Tracer, "File", FileName);
 
@@ -522,7 +664,7 @@ buildAST(PathRef FileName, std::unique_ptr<CompilerInvocation> Invocation,
       std::make_unique<CompilerInvocation>(*Invocation),
       CompilerInvocationDiags, Preamble,
       llvm::MemoryBuffer::getMemBufferCopy(Inputs.Contents, FileName),
-      std::move(VFS), Inputs.Index, Inputs.Opts);
+      std::move(VFS), Inputs.Index, Inputs.Opts, Previous);
 }
 
 } // namespace clangd
@@ -42,18 +42,42 @@ namespace clang {
 namespace clangd {
 class SymbolIndex;
 
+/// A function definition in the main file, given as file offsets.
+struct FunctionBody {
+  /// The offset of the function's name, which identifies it across parses of
+  /// an unchanged prefix of the file.
+  unsigned NameOffset;
+  /// The half-open range of the body, including any constructor initializers.
+  unsigned Begin;
+  unsigned End;
+};
+
+/// What a new parse of a main file can reuse from the last one, see
+/// ParseOptions::SkipUnchangedFunctionBodies.
+struct PreviousParse {
+  /// Function bodies seen by the last parse, sorted by NameOffset.
+  std::vector<FunctionBody> Bodies;
+  /// Diagnostics of the last parse.
+  std::vector<Diag> Diags;
+  /// The contents of the file are unchanged up to this offset.
+  unsigned EditOffset = 0;
+};
+
 /// Stores and provides access to parsed AST.
 class ParsedAST {
 public:
   /// Attempts to run Clang and store parsed AST. If \p Preamble is non-null
   /// it is reused during parsing.
+  /// If \p Previous is non-null, bodies of functions that end before its
+  /// EditOffset are skipped and their diagnostics are taken from \p Previous.
   static llvm::Optional<ParsedAST>
   build(std::unique_ptr<clang::CompilerInvocation> CI,
         llvm::ArrayRef<Diag> CompilerInvocationDiags,
         std::shared_ptr<const PreambleData> Preamble,
         std::unique_ptr<llvm::MemoryBuffer> Buffer,
         llvm::IntrusiveRefCntPtr<llvm::vfs::FileSystem> VFS,
-        const SymbolIndex *Index, const ParseOptions &Opts);
+        const SymbolIndex *Index, const ParseOptions &Opts,
+        const PreviousParse *Previous = nullptr);
 
   ParsedAST(ParsedAST &&Other);
   ParsedAST &operator=(ParsedAST &&Other);
@@ -97,6 +121,13 @@ public:
   /// (!) does not have tokens from the preamble.
   const syntax::TokenBuffer &getTokens() const { return Tokens; }
 
+  /// Function bodies in the main file, sorted by NameOffset. Only recorded if
+  /// ParseOptions::SkipUnchangedFunctionBodies is set.
+  llvm::ArrayRef<FunctionBody> getFunctionBodies() const { return Bodies; }
+  /// Whether some function bodies were not parsed. Such an AST is only good
+  /// for its diagnostics.
+  bool hasSkippedFunctionBodies() const { return SkippedBodies; }
+
 private:
   ParsedAST(std::shared_ptr<const PreambleData> Preamble,
             std::unique_ptr<CompilerInstance> Clang,
@@ -130,6 +161,8 @@ private:
   std::vector<Decl *> LocalTopLevelDecls;
   IncludeStructure Includes;
   CanonicalIncludes CanonIncludes;
+  std::vector<FunctionBody> Bodies;
+  bool SkippedBodies = false;
 };
 
 /// Build an AST from provided user inputs. This function does not check if
@@ -139,7 +172,8 @@ llvm::Optional<ParsedAST>
 buildAST(PathRef FileName, std::unique_ptr<CompilerInvocation> Invocation,
          llvm::ArrayRef<Diag> CompilerInvocationDiags,
          const ParseInputs &Inputs,
-         std::shared_ptr<const PreambleData> Preamble);
+         std::shared_ptr<const PreambleData> Preamble,
+         const PreviousParse *Previous = nullptr);
 
 /// For testing/debugging purposes. Note that this method deserializes all
 /// unserialized Decls, so use with care.
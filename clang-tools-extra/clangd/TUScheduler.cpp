@@ -80,40 +80,49 @@ llvm::Optional<llvm::StringRef> TUScheduler::getFileBeingProcessedInContext() {
 }
 
 /// An LRU cache of idle ASTs.
-/// Because we want to limit the overall number of these we retain, the cache
-/// owns ASTs (and may evict them) while their workers are idle.
+/// Because we want to limit the overall number and size of these we retain,
+/// the cache owns ASTs (and may evict them) while their workers are idle.
 /// Workers borrow ASTs when active, and return them when done.
 class TUScheduler::ASTCache {
 public:
   using Key = const ASTWorker *;
 
-  ASTCache(unsigned MaxRetainedASTs) : MaxRetainedASTs(MaxRetainedASTs) {}
+  ASTCache(unsigned MaxRetainedASTs, std::size_t MaxRetainedBytes)
+      : MaxRetainedASTs(MaxRetainedASTs), MaxRetainedBytes(MaxRetainedBytes) {}
 
   /// Returns result of getUsedBytes() for the AST cached by \p K.
   /// If no AST is cached, 0 is returned.
   std::size_t getUsedBytes(Key K) {
     std::lock_guard<std::mutex> Lock(Mut);
     auto It = findByKey(K);
-    if (It == LRU.end() || !It->second)
+    if (It == LRU.end() || !It->AST)
       return 0;
-    return It->second->getUsedBytes();
+    return It->AST->getUsedBytes();
   }
 
-  /// Store the value in the pool, possibly removing the last used AST.
+  /// Store the value in the pool, possibly removing the least recently used
+  /// ASTs. The most recently stored AST is never evicted to satisfy the byte
+  /// budget, otherwise files with large ASTs would be rebuilt on every read.
   /// The value should not be in the pool when this function is called.
   void put(Key K, std::unique_ptr<ParsedAST> V) {
-    std::unique_lock<std::mutex> Lock(Mut);
+    // Measure the AST before taking the lock, this walks its allocators.
+    std::size_t Bytes = V ? V->getUsedBytes() : 0;
+    // Declared before the lock, so that the expensive destructors run after it
+    // is released.
+    std::vector<std::unique_ptr<ParsedAST>> ForCleanup;
+    std::lock_guard<std::mutex> Lock(Mut);
     assert(findByKey(K) == LRU.end());
 
-    LRU.insert(LRU.begin(), {K, std::move(V)});
-    if (LRU.size() <= MaxRetainedASTs)
-      return;
-    // We're past the limit, remove the last element.
-    std::unique_ptr<ParsedAST> ForCleanup = std::move(LRU.back().second);
-    LRU.pop_back();
-    // Run the expensive destructor outside the lock.
-    Lock.unlock();
-    ForCleanup.reset();
+    LRU.insert(LRU.begin(), {K, std::move(V), Bytes});
+    UsedBytes += Bytes;
+    while (LRU.size() > MaxRetainedASTs ||
+           (MaxRetainedBytes && UsedBytes > MaxRetainedBytes &&
+            LRU.size() > 1)) {
+      // We're past the limit, remove the last element.
+      UsedBytes -= LRU.back().Bytes;
+      ForCleanup.push_back(std::move(LRU.back().AST));
+      LRU.pop_back();
+    }
   }
 
   /// Returns the cached value for \p K, or llvm::None if the value is not in
@@ -124,7 +133,8 @@ public:
     auto Existing = findByKey(K);
     if (Existing == LRU.end())
       return None;
-    std::unique_ptr<ParsedAST> V = std::move(Existing->second);
+    std::unique_ptr<ParsedAST> V = std::move(Existing->AST);
+    UsedBytes -= Existing->Bytes;
     LRU.erase(Existing);
     // GCC 4.8 fails to compile `return V;`, as it tries to call the copy
     // constructor of unique_ptr, so we call the move ctor explicitly to avoid
@@ -133,17 +143,89 @@ public:
   }
 
 private:
-  using KVPair = std::pair<Key, std::unique_ptr<ParsedAST>>;
+  struct Entry {
+    Key K;
+    std::unique_ptr<ParsedAST> AST;
+    /// The result of getUsedBytes() for AST when it was stored.
+    std::size_t Bytes;
+  };
 
-  std::vector<KVPair>::iterator findByKey(Key K) {
-    return llvm::find_if(LRU, [K](const KVPair &P) { return P.first == K; });
+  std::vector<Entry>::iterator findByKey(Key K) {
+    return llvm::find_if(LRU, [K](const Entry &E) { return E.K == K; });
   }
 
   std::mutex Mut;
   unsigned MaxRetainedASTs;
+  std::size_t MaxRetainedBytes;
+  std::size_t UsedBytes = 0; /* GUARDED_BY(Mut) */
   /// Items sorted in LRU order, i.e. first item is the most recently accessed
   /// one.
-  std::vector<KVPair> LRU; /* GUARDED_BY(Mut) */
+  std::vector<Entry> LRU; /* GUARDED_BY(Mut) */
+};
+
+/// An LRU cache of the preambles of closed files.
+/// Reopening a file reuses its retained preamble, as long as the preamble is
+/// still valid for the new inputs. Preambles are evicted once their total size
+/// exceeds the budget.
+class TUScheduler::PreambleCache {
+public:
+  PreambleCache(std::size_t MaxRetainedBytes)
+      : MaxRetainedBytes(MaxRetainedBytes) {}
+
+  /// Retain \p Preamble, the last preamble built for \p File before it was
+  /// closed, possibly evicting the least recently retained preambles.
+  void put(PathRef File, std::shared_ptr<const PreambleData> Preamble) {
+    if (!Preamble)
+      return;
+    std::size_t Size = Preamble->Preamble.getSize();
+    if (MaxRetainedBytes == 0 || Size > MaxRetainedBytes)
+      return;
+    // Declared before the lock, so that evicted preambles are destroyed after
+    // it is released.
+    std::vector<std::shared_ptr<const PreambleData>> ForCleanup;
+    std::lock_guard<std::mutex> Lock(Mut);
+    auto Existing = findByFile(File);
+    if (Existing != LRU.end()) {
+      UsedBytes -= Existing->second->Preamble.getSize();
+      ForCleanup.push_back(std::move(Existing->second));
+      LRU.erase(Existing);
+    }
+    LRU.insert(LRU.begin(), {File.str(), std::move(Preamble)});
+    UsedBytes += Size;
+    while (UsedBytes > MaxRetainedBytes) {
+      UsedBytes -= LRU.back().second->Preamble.getSize();
+      ForCleanup.push_back(std::move(LRU.back().second));
+      LRU.pop_back();
+    }
+  }
+
+  /// Returns the preamble retained for \p File and removes it from the cache,
+  /// or null if there is none.
+  std::shared_ptr<const PreambleData> take(PathRef File) {
+    std::lock_guard<std::mutex> Lock(Mut);
+    auto Existing = findByFile(File);
+    if (Existing == LRU.end())
+      return nullptr;
+    std::shared_ptr<const PreambleData> Preamble = std::move(Existing->second);
+    UsedBytes -= Preamble->Preamble.getSize();
+    LRU.erase(Existing);
+    return Preamble;
+  }
+
+private:
+  using FilePreamblePair = std::pair<Path, std::shared_ptr<const PreambleData>>;
+
+  std::vector<FilePreamblePair>::iterator findByFile(PathRef File) {
+    return llvm::find_if(
+        LRU, [File](const FilePreamblePair &P) { return P.first == File; });
+  }
+
+  std::mutex Mut;
+  const std::size_t MaxRetainedBytes;
+  std::size_t UsedBytes = 0; /* GUARDED_BY(Mut) */
+  /// Items sorted in LRU order, i.e. first item is the most recently retained
+  /// one.
+  std::vector<FilePreamblePair> LRU; /* GUARDED_BY(Mut) */
 };
 
 namespace {
@@ -162,9 +244,10 @@ class ASTWorkerHandle;
 class ASTWorker {
   friend class ASTWorkerHandle;
   ASTWorker(PathRef FileName, const GlobalCompilationDatabase &CDB,
-            TUScheduler::ASTCache &LRUCache, Semaphore &Barrier, bool RunSync,
-            steady_clock::duration UpdateDebounce, bool StorePreamblesInMemory,
-            ParsingCallbacks &Callbacks);
+            TUScheduler::ASTCache &LRUCache,
+            TUScheduler::PreambleCache &ClosedPreambles, Semaphore &Barrier,
+            bool RunSync, steady_clock::duration UpdateDebounce,
+            bool StorePreamblesInMemory, ParsingCallbacks &Callbacks);
 
 public:
   /// Create a new ASTWorker and return a handle to it.
@@ -174,7 +257,8 @@ public:
   /// request, it is used to limit the number of actively running threads.
   static ASTWorkerHandle
   create(PathRef FileName, const GlobalCompilationDatabase &CDB,
-         TUScheduler::ASTCache &IdleASTs, AsyncTaskRunner *Tasks,
+         TUScheduler::ASTCache &IdleASTs,
+         TUScheduler::PreambleCache &ClosedPreambles, AsyncTaskRunner *Tasks,
          Semaphore &Barrier, steady_clock::duration UpdateDebounce,
          bool StorePreamblesInMemory, ParsingCallbacks &Callbacks);
   ~ASTWorker();
@@ -224,6 +308,8 @@ private:
   Deadline scheduleLocked();
   /// Should the first task in the queue be skipped instead of run?
   bool shouldSkipHeadLocked() const;
+  /// Whether an update is queued behind the running request.
+  bool hasPendingUpdate() const;
   /// This is private because `FileInputs.FS` is not thread-safe and thus not
   /// safe to share. Callers should make sure not to expose `FS` via a public
   /// interface.
@@ -239,6 +325,8 @@ private:
 
   /// Handles retention of ASTs.
   TUScheduler::ASTCache &IdleASTs;
+  /// Preambles retained after files were closed.
+  TUScheduler::PreambleCache &ClosedPreambles;
   const bool RunSync;
   /// Time to wait after an update to see whether another update obsoletes it.
   const steady_clock::duration UpdateDebounce;
@@ -255,6 +343,11 @@ private:
   Semaphore &Barrier;
   /// Whether the 'onMainAST' callback ran for the current FileInputs.
   bool RanASTCallback = false;
+  /// The last AST built for diagnostics, if ParseOptions::
+  /// SkipUnchangedFunctionBodies is set, and the inputs it was built from.
+  /// Only accessed by the worker thread.
+  llvm::Optional<PreviousParse> LastParse;
+  std::shared_ptr<const ParseInputs> LastParseInputs;
   /// Guards members used by both TUScheduler and the worker thread.
   mutable std::mutex Mutex;
   /// File inputs, currently being used by the worker.
@@ -324,12 +417,14 @@ private:
 
 ASTWorkerHandle
 ASTWorker::create(PathRef FileName, const GlobalCompilationDatabase &CDB,
-                  TUScheduler::ASTCache &IdleASTs, AsyncTaskRunner *Tasks,
-                  Semaphore &Barrier, steady_clock::duration UpdateDebounce,
+                  TUScheduler::ASTCache &IdleASTs,
+                  TUScheduler::PreambleCache &ClosedPreambles,
+                  AsyncTaskRunner *Tasks, Semaphore &Barrier,
+                  steady_clock::duration UpdateDebounce,
                   bool StorePreamblesInMemory, ParsingCallbacks &Callbacks) {
-  std::shared_ptr<ASTWorker> Worker(
-      new ASTWorker(FileName, CDB, IdleASTs, Barrier, /*RunSync=*/!Tasks,
-                    UpdateDebounce, StorePreamblesInMemory, Callbacks));
+  std::shared_ptr<ASTWorker> Worker(new ASTWorker(
+      FileName, CDB, IdleASTs, ClosedPreambles, Barrier, /*RunSync=*/!Tasks,
+      UpdateDebounce, StorePreamblesInMemory, Callbacks));
   if (Tasks)
     Tasks->runAsync("worker:" + llvm::sys::path::filename(FileName),
                     [Worker]() { Worker->run(); });
@@ -338,10 +433,13 @@ ASTWorker::create(PathRef FileName, const GlobalCompilationDatabase &CDB,
 }
 
 ASTWorker::ASTWorker(PathRef FileName, const GlobalCompilationDatabase &CDB,
-                     TUScheduler::ASTCache &LRUCache, Semaphore &Barrier,
-                     bool RunSync, steady_clock::duration UpdateDebounce,
+                     TUScheduler::ASTCache &LRUCache,
+                     TUScheduler::PreambleCache &ClosedPreambles,
+                     Semaphore &Barrier, bool RunSync,
+                     steady_clock::duration UpdateDebounce,
                      bool StorePreamblesInMemory, ParsingCallbacks &Callbacks)
-    : IdleASTs(LRUCache), RunSync(RunSync), UpdateDebounce(UpdateDebounce),
+    : IdleASTs(LRUCache), ClosedPreambles(ClosedPreambles), RunSync(RunSync),
+      UpdateDebounce(UpdateDebounce),
       FileName(FileName), CDB(CDB),
       StorePreambleInMemory(StorePreamblesInMemory),
       Callbacks(Callbacks), Status{TUAction(TUAction::Idle, ""),
@@ -428,8 +526,16 @@ void ASTWorker::update(ParseInputs Inputs, WantDiagnostics WantDiags) {
 
     std::shared_ptr<const PreambleData> OldPreamble =
         getPossiblyStalePreamble();
+    // If the file was just reopened, try the preamble it had when it was
+    // closed.
+    std::shared_ptr<const PreambleData> ReusablePreamble = OldPreamble;
+    if (!ReusablePreamble) {
+      ReusablePreamble = ClosedPreambles.take(FileName);
+      if (ReusablePreamble)
+        OldCommand = ReusablePreamble->CompileCommand;
+    }
     std::shared_ptr<const PreambleData> NewPreamble = buildPreamble(
-        FileName, *Invocation, OldPreamble, OldCommand, Inputs,
+        FileName, *Invocation, ReusablePreamble, OldCommand, Inputs,
         StorePreambleInMemory,
         [this](ASTContext &Ctx, std::shared_ptr<clang::Preprocessor> PP,
                const CanonicalIncludes &CanonIncludes) {
@@ -437,6 +543,27 @@ void ASTWorker::update(ParseInputs Inputs, WantDiagnostics WantDiags) {
         });
 
     bool CanReuseAST = InputsAreTheSame && (OldPreamble == NewPreamble);
+    // The function bodies of the last parse can be skipped if only the text
+    // after them changed.
+    llvm::Optional<PreviousParse> Previous;
+    if (CanReuseAST) {
+      if (LastParse)
+        LastParseInputs = getCurrentFileInputs();
+    } else {
+      if (Inputs.Opts.SkipUnchangedFunctionBodies && LastParse &&
+          LastParseInputs == PrevInputs && OldPreamble == NewPreamble &&
+          PrevInputs->CompileCommand == Inputs.CompileCommand) {
+        const std::string &Old = PrevInputs->Contents, &New = Inputs.Contents;
+        size_t Common = std::min(Old.size(), New.size());
+        Previous = std::move(LastParse);
+        Previous->EditOffset =
+            std::mismatch(New.begin(), New.begin() + Common, Old.begin())
+                .first -
+            New.begin();
+      }
+      LastParse.reset();
+      LastParseInputs.reset();
+    }
     {
       std::lock_guard<std::mutex> Lock(Mutex);
       LastBuiltPreamble = NewPreamble;
@@ -445,6 +572,7 @@ void ASTWorker::update(ParseInputs Inputs, WantDiagnostics WantDiags) {
     // to the old preamble, so it can be freed if there are no other references
     // to it.
     OldPreamble.reset();
+    ReusablePreamble.reset();
     PreambleWasBuilt.notify();
     emitTUStatus({TUAction::BuildingFile, TaskName});
     if (!CanReuseAST) {
@@ -483,6 +611,31 @@ void ASTWorker::update(ParseInputs Inputs, WantDiagnostics WantDiags) {
 
     // Get the AST for diagnostics.
     llvm::Optional<std::unique_ptr<ParsedAST>> AST = IdleASTs.take(this);
+    if (!AST && Previous) {
+      // Publish the diagnostics of an AST with the unchanged function bodies
+      // skipped first, then build the complete AST unless the file is about to
+      // change again.
+      llvm::Optional<ParsedAST> PartialAST =
+          buildAST(FileName, std::make_unique<CompilerInvocation>(*Invocation),
+                   CompilerInvocationDiags, Inputs, NewPreamble,
+                   Previous.getPointer());
+      if (PartialAST && PartialAST->hasSkippedFunctionBodies()) {
+        log("Skipped unchanged function bodies of {0}", FileName);
+        {
+          trace::Span Span("Running partial main AST callback");
+          Callbacks.onPartialMainAST(FileName, *PartialAST, RunPublish);
+        }
+        LastParse.emplace();
+        LastParse->Bodies = PartialAST->getFunctionBodies();
+        LastParse->Diags = PartialAST->getDiagnostics();
+        LastParseInputs = getCurrentFileInputs();
+        if (hasPendingUpdate())
+          return;
+      } else if (PartialAST) {
+        // Nothing was skipped, so this is the complete AST.
+        AST = std::make_unique<ParsedAST>(std::move(*PartialAST));
+      }
+    }
     if (!AST) {
       llvm::Optional<ParsedAST> NewAST =
           buildAST(FileName, std::move(Invocation), CompilerInvocationDiags,
@@ -509,6 +662,12 @@ void ASTWorker::update(ParseInputs Inputs, WantDiagnostics WantDiags) {
 
       Callbacks.onMainAST(FileName, **AST, RunPublish);
       RanASTCallback = true;
+      if (Inputs.Opts.SkipUnchangedFunctionBodies) {
+        LastParse.emplace();
+        LastParse->Bodies = (*AST)->getFunctionBodies();
+        LastParse->Diags = (*AST)->getDiagnostics();
+        LastParseInputs = getCurrentFileInputs();
+      }
     } else {
       // Failed to build the AST, at least report diagnostics from the command
       // line if there were any.
@@ -755,6 +914,16 @@ Deadline ASTWorker::scheduleLocked() {
   return D;
 }
 
+bool ASTWorker::hasPendingUpdate() const {
+  if (RunSync)
+    return false;
+  std::lock_guard<std::mutex> Lock(Mutex);
+  // The running request is still at the front of the queue.
+  assert(!Requests.empty());
+  return std::any_of(std::next(Requests.begin()), Requests.end(),
+                     [](const Request &R) { return R.UpdateType.hasValue(); });
+}
+
 // Returns true if Requests.front() is a dead update that can be skipped.
 bool ASTWorker::shouldSkipHeadLocked() const {
   assert(!Requests.empty());
@@ -851,7 +1020,10 @@ TUScheduler::TUScheduler(const GlobalCompilationDatabase &CDB,
       Callbacks(Callbacks ? move(Callbacks)
                           : std::make_unique<ParsingCallbacks>()),
       Barrier(AsyncThreadsCount),
-      IdleASTs(std::make_unique<ASTCache>(RetentionPolicy.MaxRetainedASTs)),
+      IdleASTs(std::make_unique<ASTCache>(RetentionPolicy.MaxRetainedASTs,
+                                          RetentionPolicy.MaxRetainedASTBytes)),
+      ClosedPreambles(std::make_unique<PreambleCache>(
+          RetentionPolicy.MaxRetainedPreambleBytes)),
       UpdateDebounce(UpdateDebounce) {
   if (0 < AsyncThreadsCount) {
     PreambleTasks.emplace();
@@ -887,7 +1059,7 @@ bool TUScheduler::update(PathRef File, ParseInputs Inputs,
   if (!FD) {
     // Create a new worker to process the AST-related tasks.
     ASTWorkerHandle Worker = ASTWorker::create(
-        File, CDB, *IdleASTs,
+        File, CDB, *IdleASTs, *ClosedPreambles,
         WorkerThreads ? WorkerThreads.getPointer() : nullptr, Barrier,
         UpdateDebounce, StorePreamblesInMemory, *Callbacks);
     FD = std::unique_ptr<FileData>(
@@ -900,10 +1072,14 @@ bool TUScheduler::update(PathRef File, ParseInputs Inputs,
 }
 
 void TUScheduler::remove(PathRef File) {
-  bool Removed = Files.erase(File);
-  if (!Removed)
+  auto It = Files.find(File);
+  if (It == Files.end()) {
     elog("Trying to remove file from TUScheduler that is not tracked: {0}",
          File);
+    return;
+  }
+  ClosedPreambles->put(File, It->second->Worker->getPossiblyStalePreamble());
+  Files.erase(It);
 }
 
 llvm::StringRef TUScheduler::getContents(PathRef File) const {
@@ -58,6 +58,16 @@ struct ASTRetentionPolicy {
   /// Maximum number of ASTs to be retained in memory when there are no pending
   /// requests for them.
   unsigned MaxRetainedASTs = 3;
+
+  /// Maximum total size of the ASTs retained in memory, as estimated by
+  /// ParsedAST::getUsedBytes(). The most recently used AST is retained even if
+  /// it exceeds the budget on its own. Zero means no limit.
+  std::size_t MaxRetainedASTBytes = 0;
+
+  /// Maximum total size of the preambles retained after their files were
+  /// closed. A retained preamble is reused when the file is reopened, unless
+  /// the file's preamble region, compile command or headers changed.
+  std::size_t MaxRetainedPreambleBytes = 0;
 };
 
 struct TUAction {
@@ -128,6 +138,13 @@ public:
   /// Publish() may never run in this case).
   virtual void onMainAST(PathRef Path, ParsedAST &AST, PublishFn Publish) {}
 
+  /// Called on an AST that skipped unchanged function bodies to get the
+  /// diagnostics out sooner, see ParseOptions::SkipUnchangedFunctionBodies.
+  /// Its diagnostics are complete, but the AST lacks the skipped bodies.
+  /// onMainAST follows with the complete AST, unless the file changes first.
+  virtual void onPartialMainAST(PathRef Path, ParsedAST &AST,
+                                PublishFn Publish) {}
+
   /// Called whenever the AST fails to build. \p Diags will have the diagnostics
   /// that led to failure.
   virtual void onFailedAST(PathRef Path, std::vector<Diag> Diags,
@@ -237,6 +254,10 @@ public:
   /// an LRU cache.
   class ASTCache;
 
+  /// Responsible for retaining the preambles of closed files. An
+  /// implementation is an LRU cache.
+  class PreambleCache;
+
   // The file being built/processed in the current thread. This is a hack in
   // order to get the file name into the index implementations. Do not depend on
   // this inside clangd.
@@ -251,6 +272,7 @@ private:
   Semaphore Barrier;
   llvm::StringMap<std::unique_ptr<FileData>> Files;
   std::unique_ptr<ASTCache> IdleASTs;
+  std::unique_ptr<PreambleCache> ClosedPreambles;
   // None when running tasks synchronously and non-None when running tasks
   // asynchronously.
   llvm::Optional<AsyncTaskRunner> PreambleTasks;
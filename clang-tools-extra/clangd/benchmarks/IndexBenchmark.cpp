@@ -6,11 +6,14 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include "../FuzzyMatch.h"
+#include "../Quality.h"
 #include "../index/Serialization.h"
 #include "../index/dex/Dex.h"
 #include "benchmark/benchmark.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/StringRef.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/Regex.h"
 #include <fstream>
@@ -83,6 +86,59 @@ static void DexQueries(benchmark::State &State) {
 }
 BENCHMARK(DexQueries);
 
+// All symbols of the index, which completion ranks against the queries.
+SymbolSlab loadSymbols() {
+  auto Buffer = llvm::MemoryBuffer::getFile(IndexFilename);
+  if (!Buffer) {
+    llvm::errs() << "Error when reading index file: "
+                 << Buffer.getError().message() << '\n';
+    exit(1);
+  }
+  auto IndexFile = readIndexFile((*Buffer)->getBuffer());
+  if (!IndexFile || !IndexFile->Symbols) {
+    llvm::errs() << "Error when reading index file\n";
+    exit(1);
+  }
+  return std::move(*IndexFile->Symbols);
+}
+
+// Matches the name of every symbol against each query.
+static void FuzzyMatchQueries(benchmark::State &State) {
+  const auto Symbols = loadSymbols();
+  const auto Requests = extractQueriesFromLogs();
+  for (auto _ : State)
+    for (const auto &Request : Requests) {
+      FuzzyMatcher Matcher(Request.Query);
+      for (const Symbol &Sym : Symbols)
+        benchmark::DoNotOptimize(Matcher.match(Sym.Name));
+    }
+}
+BENCHMARK(FuzzyMatchQueries);
+
+// Scores every symbol for each query, the way code completion ranks index
+// results.
+static void CompletionScoring(benchmark::State &State) {
+  const auto Symbols = loadSymbols();
+  const auto Requests = extractQueriesFromLogs();
+  for (auto _ : State)
+    for (const auto &Request : Requests) {
+      FuzzyMatcher Matcher(Request.Query);
+      for (const Symbol &Sym : Symbols) {
+        auto Match = Matcher.match(Sym.Name);
+        if (!Match)
+          continue;
+        SymbolQualitySignals Quality;
+        Quality.merge(Sym);
+        SymbolRelevanceSignals Relevance;
+        Relevance.NameMatch = *Match;
+        Relevance.merge(Sym);
+        benchmark::DoNotOptimize(evaluateSymbolAndRelevance(
+            Quality.evaluate(), Relevance.evaluate()));
+      }
+    }
+}
+BENCHMARK(CompletionScoring);
+
 } // namespace
 } // namespace clangd
 } // namespace clang
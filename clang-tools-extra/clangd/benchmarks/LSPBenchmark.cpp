@@ -0,0 +1,197 @@
+//===--- LSPBenchmark.cpp - Clangd end-to-end request benchmarks -*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// Replays a recorded LSP session (as written by clangd --input-mirror-file)
+// against ClangdLSPServer, and reports the latency of each kind of request.
+// The session must be replayed on the source tree it was recorded on.
+//
+// Each message of the session is sent once the replies to all earlier
+// requests arrived, so latencies do not depend on the speed of the replay.
+// Notifications are not waited for: consecutive didChange notifications reach
+// clangd as a burst, like keystrokes do. The latency of a didOpen or didChange
+// is the time until diagnostics for the file are published, measured from the
+// last edit of the file (so it includes the debounce delay).
+//
+//===----------------------------------------------------------------------===//
+
+#include "../ClangdLSPServer.h"
+#include "../FSProvider.h"
+#include "../Transport.h"
+#include "benchmark/benchmark.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Support/FormatVariadic.h"
+#include "llvm/Support/raw_ostream.h"
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <vector>
+
+const char *SessionFilename;
+
+namespace clang {
+namespace clangd {
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// Latencies in milliseconds, by LSP method.
+using LatencyMap = llvm::StringMap<std::vector<double>>;
+
+// Passes the messages read by Session on to clangd, and times the responses.
+class ReplayTransport : public Transport, private Transport::MessageHandler {
+public:
+  ReplayTransport(Transport &Session, LatencyMap &Latencies)
+      : Session(Session), Latencies(Latencies) {}
+
+  // Called by clangd.
+  void notify(llvm::StringRef Method, llvm::json::Value Params) override {
+    if (Method != "textDocument/publishDiagnostics")
+      return;
+    const auto *Obj = Params.getAsObject();
+    auto URI = Obj ? Obj->getString("uri") : llvm::None;
+    if (!URI)
+      return;
+    std::lock_guard<std::mutex> Lock(Mu);
+    auto It = PendingEdits.find(*URI);
+    if (It == PendingEdits.end())
+      return;
+    record(It->second.first, It->second.second);
+    PendingEdits.erase(It);
+  }
+
+  void call(llvm::StringRef Method, llvm::json::Value Params,
+            llvm::json::Value ID) override {
+    // Requests from the server (e.g. applyEdit) are left unanswered.
+  }
+
+  void reply(llvm::json::Value ID,
+             llvm::Expected<llvm::json::Value> Result) override {
+    if (!Result)
+      llvm::consumeError(Result.takeError());
+    std::lock_guard<std::mutex> Lock(Mu);
+    auto It = PendingCalls.find(llvm::formatv("{0}", ID).str());
+    if (It == PendingCalls.end())
+      return;
+    record(It->second.first, It->second.second);
+    PendingCalls.erase(It);
+    CV.notify_all();
+  }
+
+  llvm::Error loop(Transport::MessageHandler &Handler) override {
+    Server = &Handler;
+    return Session.loop(*this);
+  }
+
+private:
+  // Called with the messages of the session.
+  bool onNotify(llvm::StringRef Method, llvm::json::Value Params) override {
+    waitForReplies();
+    if (Method == "textDocument/didOpen" || Method == "textDocument/didChange")
+      if (const auto *Obj = Params.getAsObject())
+        if (const auto *Doc = Obj->getObject("textDocument"))
+          if (auto URI = Doc->getString("uri")) {
+            std::lock_guard<std::mutex> Lock(Mu);
+            PendingEdits[*URI] = {Method, Clock::now()};
+          }
+    return Server->onNotify(Method, std::move(Params));
+  }
+
+  bool onCall(llvm::StringRef Method, llvm::json::Value Params,
+              llvm::json::Value ID) override {
+    waitForReplies();
+    {
+      std::lock_guard<std::mutex> Lock(Mu);
+      PendingCalls[llvm::formatv("{0}", ID).str()] = {Method, Clock::now()};
+    }
+    return Server->onCall(Method, std::move(Params), std::move(ID));
+  }
+
+  bool onReply(llvm::json::Value ID,
+               llvm::Expected<llvm::json::Value> Result) override {
+    return Server->onReply(std::move(ID), std::move(Result));
+  }
+
+  void waitForReplies() {
+    std::unique_lock<std::mutex> Lock(Mu);
+    CV.wait(Lock, [&] { return PendingCalls.empty(); });
+  }
+
+  // Requires Mu.
+  void record(llvm::StringRef Method, Clock::time_point Start) {
+    Latencies[Method].push_back(
+        std::chrono::duration<double, std::milli>(Clock::now() - Start)
+            .count());
+  }
+
+  Transport &Session;
+  Transport::MessageHandler *Server = nullptr;
+  LatencyMap &Latencies;
+  std::mutex Mu;
+  std::condition_variable CV;
+  // Requests awaiting a reply by ID, and edits awaiting diagnostics by URI.
+  llvm::StringMap<std::pair<std::string, Clock::time_point>> PendingCalls;
+  llvm::StringMap<std::pair<std::string, Clock::time_point>> PendingEdits;
+};
+
+double percentile(std::vector<double> &Sorted, double P) {
+  return Sorted[std::min<size_t>(Sorted.size() - 1, P * Sorted.size())];
+}
+
+static void ReplaySession(benchmark::State &State) {
+  LatencyMap Latencies;
+  for (auto _ : State) {
+    std::FILE *In = std::fopen(SessionFilename, "r");
+    if (!In) {
+      State.SkipWithError("Cannot open the session file");
+      return;
+    }
+    auto Session = newJSONTransport(In, llvm::nulls(), /*InMirror=*/nullptr,
+                                    /*Pretty=*/false);
+    ReplayTransport Replay(*Session, Latencies);
+    RealFileSystemProvider FSProvider;
+    ClangdServer::Options Opts;
+    ClangdLSPServer LSPServer(Replay, FSProvider, CodeCompleteOptions(),
+                              /*CompileCommandsDir=*/llvm::None,
+                              /*UseDirBasedCDB=*/true,
+                              /*ForcedOffsetEncoding=*/llvm::None, Opts);
+    LSPServer.run();
+    std::fclose(In);
+  }
+  for (auto &Entry : Latencies) {
+    std::vector<double> &Sorted = Entry.second;
+    llvm::sort(Sorted);
+    State.counters[(Entry.first() + " p50(ms)").str()] =
+        percentile(Sorted, 0.5);
+    State.counters[(Entry.first() + " p99(ms)").str()] =
+        percentile(Sorted, 0.99);
+  }
+}
+BENCHMARK(ReplaySession)->Unit(benchmark::kMillisecond);
+
+} // namespace
+} // namespace clangd
+} // namespace clang
+
+int main(int argc, char *argv[]) {
+  if (argc < 2) {
+    llvm::errs() << "Usage: " << argv[0]
+                 << " session.lsp BENCHMARK_OPTIONS...\n";
+    return -1;
+  }
+  SessionFilename = argv[1];
+  // Trim the first argument of the benchmark invocation and pretend no
+  // arguments were passed in the first place.
+  argv[1] = argv[0];
+  ++argv;
+  --argc;
+  ::benchmark::Initialize(&argc, argv);
+  ::benchmark::RunSpecifiedBenchmarks();
+}
@@ -0,0 +1,62 @@
+//===--- IndexServerMain.cpp -------------------------------------*- C++-*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// clangd-index-server serves a static index to clangd over its standard
+// streams, see index/Remote.h.
+//
+//===----------------------------------------------------------------------===//
+
+#include "Logger.h"
+#include "index/Remote.h"
+#include "index/Serialization.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Signals.h"
+#include "llvm/Support/raw_ostream.h"
+#include <cstdio>
+
+namespace clang {
+namespace clangd {
+namespace {
+
+static llvm::cl::opt<std::string>
+    IndexPath(llvm::cl::desc("<INDEX FILE>"), llvm::cl::Positional,
+              llvm::cl::Required);
+
+} // namespace
+} // namespace clangd
+} // namespace clang
+
+int main(int argc, const char **argv) {
+  using namespace clang::clangd;
+  llvm::sys::PrintStackTraceOnErrorSignal(argv[0]);
+
+  const char *Overview = R"(
+  Serves a static index built by clangd-indexer to clangd instances, which
+  connect with --remote-index-command. Requests are read from stdin and
+  responses written to stdout, so the server can be reached e.g. through ssh.
+
+  Example usage:
+
+  $ clangd --remote-index-command="ssh host clangd-index-server clangd.dex"
+  )";
+  llvm::cl::ParseCommandLineOptions(argc, argv, Overview);
+
+  // Logs go to stderr, as stdout carries the responses.
+  StreamLogger Log(llvm::errs(), Logger::Info);
+  LoggingSession LoggingSession(Log);
+
+  std::unique_ptr<SymbolIndex> Index = loadIndex(IndexPath, /*UseDex=*/true);
+  if (!Index) {
+    elog("Failed to load the index {0}", IndexPath);
+    return 1;
+  }
+  auto Channel = createFDChannel(fileno(stdin), fileno(stdout),
+                                 /*CloseFDs=*/false);
+  serveIndex(*Index, *Channel);
+  return 0;
+}
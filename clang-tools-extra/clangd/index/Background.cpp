@@ -10,6 +10,7 @@
 #include "Compiler.h"
 #include "Context.h"
 #include "FSProvider.h"
+#include "FileDistance.h"
 #include "Headers.h"
 #include "Logger.h"
 #include "ParsedAST.h"
@@ -170,13 +171,24 @@ BackgroundQueue::Task BackgroundIndex::changedFilesTask(
     SPAN_ATTACH(Tracer, "files", int64_t(ChangedFiles.size()));
 
     auto NeedsReIndexing = loadProject(std::move(ChangedFiles));
-    // Run indexing for files that need to be updated.
+    // Run indexing for files that need to be updated, starting with the ones
+    // closest to the files the user is working on.
+    llvm::StringMap<SourceParams> Sources;
+    {
+      std::lock_guard<std::mutex> Lock(OpenedFilesMu);
+      for (const std::string &File : OpenedFiles)
+        Sources[File] = SourceParams();
+    }
+    FileDistance Distances(std::move(Sources));
     std::shuffle(NeedsReIndexing.begin(), NeedsReIndexing.end(),
                  std::mt19937(std::random_device{}()));
     std::vector<BackgroundQueue::Task> Tasks;
     Tasks.reserve(NeedsReIndexing.size());
-    for (auto &Cmd : NeedsReIndexing)
+    for (auto &Cmd : NeedsReIndexing) {
+      unsigned Distance = Distances.distance(Cmd.Filename);
       Tasks.push_back(indexFileTask(std::move(Cmd)));
+      Tasks.back().Distance = Distance;
+    }
     Queue.append(std::move(Tasks));
   });
 
@@ -205,6 +217,17 @@ BackgroundIndex::indexFileTask(tooling::CompileCommand Cmd) {
 }
 
 void BackgroundIndex::boostRelated(llvm::StringRef Path) {
+  {
+    std::lock_guard<std::mutex> Lock(OpenedFilesMu);
+    // Only the few most recent ones matter for ordering the queue.
+    constexpr unsigned MaxOpenedFiles = 16;
+    llvm::erase_if(OpenedFiles,
+                   [&](const std::string &File) { return File == Path; });
+    OpenedFiles.push_back(Path.str());
+    if (OpenedFiles.size() > MaxOpenedFiles)
+      OpenedFiles.erase(OpenedFiles.begin());
+  }
+
   namespace types = clang::driver::types;
   auto Type =
       types::lookupTypeForExtension(llvm::sys::path::extension(Path).substr(1));
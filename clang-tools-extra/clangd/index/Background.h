@@ -73,9 +73,14 @@ public:
     std::function<void()> Run;
     llvm::ThreadPriority ThreadPri = llvm::ThreadPriority::Background;
     unsigned QueuePri = 0; // Higher-priority tasks will run first.
+    unsigned Distance = 0; // Among equal priorities, lower distances run first.
     std::string Tag;       // Allows priority to be boosted later.
 
-    bool operator<(const Task &O) const { return QueuePri < O.QueuePri; }
+    bool operator<(const Task &O) const {
+      if (QueuePri != O.QueuePri)
+        return QueuePri < O.QueuePri;
+      return Distance > O.Distance;
+    }
   };
 
   // Add tasks to the queue.
@@ -133,6 +138,8 @@ public:
 
   /// Boosts priority of indexing related to Path.
   /// Typically used to index TUs when headers are opened.
+  /// TUs enqueued later are indexed in order of their distance from the most
+  /// recently opened files.
   void boostRelated(llvm::StringRef Path);
 
   // Cause background threads to stop after ther current task, any remaining
@@ -174,6 +181,10 @@ private:
   llvm::StringMap<ShardVersion> ShardVersions; // Key is absolute file path.
   std::mutex ShardVersionsMu;
 
+  // Most recently opened files, newest last.
+  std::vector<std::string> OpenedFiles; /* GUARDED_BY(OpenedFilesMu) */
+  std::mutex OpenedFilesMu;
+
   BackgroundIndexStorage::Factory IndexStorageFactory;
   // Tries to load shards for the MainFiles and their dependencies.
   std::vector<tooling::CompileCommand>
@@ -15,6 +15,7 @@
 #include "llvm/ADT/DenseSet.h"
 #include "llvm/ADT/SmallString.h"
 #include "llvm/ADT/StringMap.h"
+#include "llvm/Support/Parallel.h"
 #include "llvm/Support/Path.h"
 #include <string>
 #include <utility>
@@ -30,18 +31,16 @@ class BackgroundIndexLoader {
 public:
   BackgroundIndexLoader(BackgroundIndexStorage::Factory &IndexStorageFactory)
       : IndexStorageFactory(IndexStorageFactory) {}
-  /// Load the shards for \p MainFile and all of its dependencies.
-  void load(PathRef MainFile);
+  /// Load the shards for \p MainFiles and all of their dependencies.
+  void load(llvm::ArrayRef<Path> MainFiles);
 
   /// Consumes the loader and returns all shards.
   std::vector<LoadedShard> takeResult() &&;
 
 private:
-  /// Returns the Shard for \p StartSourceFile from cache or loads it from \p
-  /// Storage. Also returns paths for dependencies of \p StartSourceFile if it
-  /// wasn't cached yet.
-  std::pair<const LoadedShard &, std::vector<Path>>
-  loadShard(PathRef StartSourceFile, PathRef DependentTU);
+  /// Loads the shard for \p LS.AbsolutePath from storage. Returns the paths
+  /// of its dependencies. Safe to call concurrently for different shards.
+  std::vector<Path> loadShard(LoadedShard &LS);
 
   /// Cache for Storage lookups.
   llvm::StringMap<LoadedShard> LoadedShards;
@@ -49,33 +48,24 @@ private:
   BackgroundIndexStorage::Factory &IndexStorageFactory;
 };
 
-std::pair<const LoadedShard &, std::vector<Path>>
-BackgroundIndexLoader::loadShard(PathRef StartSourceFile, PathRef DependentTU) {
-  auto It = LoadedShards.try_emplace(StartSourceFile);
-  LoadedShard &LS = It.first->getValue();
+std::vector<Path> BackgroundIndexLoader::loadShard(LoadedShard &LS) {
   std::vector<Path> Edges = {};
-  // Return the cached shard.
-  if (!It.second)
-    return {LS, Edges};
-
-  LS.AbsolutePath = StartSourceFile.str();
-  LS.DependentTU = DependentTU;
   BackgroundIndexStorage *Storage = IndexStorageFactory(LS.AbsolutePath);
-  auto Shard = Storage->loadShard(StartSourceFile);
+  auto Shard = Storage->loadShard(LS.AbsolutePath);
   if (!Shard || !Shard->Sources) {
-    vlog("Failed to load shard: {0}", StartSourceFile);
-    return {LS, Edges};
+    vlog("Failed to load shard: {0}", LS.AbsolutePath);
+    return Edges;
   }
 
   LS.Shard = std::move(Shard);
   for (const auto &It : *LS.Shard->Sources) {
-    auto AbsPath = URI::resolve(It.getKey(), StartSourceFile);
+    auto AbsPath = URI::resolve(It.getKey(), LS.AbsolutePath);
     if (!AbsPath) {
       elog("Failed to resolve URI: {0}", AbsPath.takeError());
       continue;
     }
     // A shard contains only edges for non main-file sources.
-    if (*AbsPath != StartSourceFile) {
+    if (*AbsPath != LS.AbsolutePath) {
       Edges.push_back(*AbsPath);
       continue;
     }
@@ -87,26 +77,36 @@ BackgroundIndexLoader::loadShard(PathRef StartSourceFile, PathRef DependentTU) {
     LS.HadErrors = IGN.Flags & IncludeGraphNode::SourceFlag::HadErrors;
   }
   assert(LS.Digest != FileDigest{{0}} && "Digest is empty?");
-  return {LS, Edges};
+  return Edges;
 }
 
-void BackgroundIndexLoader::load(PathRef MainFile) {
-  llvm::StringSet<> InQueue;
-  // Following containers points to strings inside InQueue.
-  std::queue<PathRef> ToVisit;
-  InQueue.insert(MainFile);
-  ToVisit.push(MainFile);
-
-  while (!ToVisit.empty()) {
-    PathRef SourceFile = ToVisit.front();
-    ToVisit.pop();
-
-    auto ShardAndEdges = loadShard(SourceFile, MainFile);
-    for (PathRef Edge : ShardAndEdges.second) {
-      auto It = InQueue.insert(Edge);
-      if (It.second)
-        ToVisit.push(It.first->getKey());
-    }
+void BackgroundIndexLoader::load(llvm::ArrayRef<Path> MainFiles) {
+  // The include graph is traversed breadth-first, and all shards discovered at
+  // the same depth are read and deserialized in parallel. A shard reachable
+  // from several TUs is attributed to the TU that reached it first.
+  std::vector<LoadedShard *> ToLoad;
+  auto Enqueue = [&](PathRef SourceFile, PathRef DependentTU) {
+    auto It = LoadedShards.try_emplace(SourceFile);
+    if (!It.second)
+      return;
+    LoadedShard &LS = It.first->getValue();
+    LS.AbsolutePath = SourceFile.str();
+    LS.DependentTU = DependentTU.str();
+    ToLoad.push_back(&LS);
+  };
+  for (PathRef MainFile : MainFiles)
+    Enqueue(MainFile, MainFile);
+
+  while (!ToLoad.empty()) {
+    std::vector<LoadedShard *> Loading = std::move(ToLoad);
+    ToLoad.clear();
+    std::vector<std::vector<Path>> Edges(Loading.size());
+    llvm::parallel::for_each_n(
+        llvm::parallel::par, size_t(0), Loading.size(),
+        [&](size_t I) { Edges[I] = loadShard(*Loading[I]); });
+    for (size_t I = 0; I < Loading.size(); ++I)
+      for (PathRef Edge : Edges[I])
+        Enqueue(Edge, Loading[I]->DependentTU);
   }
 }
 
@@ -124,10 +124,10 @@ loadIndexShards(llvm::ArrayRef<Path> MainFiles,
                 BackgroundIndexStorage::Factory &IndexStorageFactory,
                 const GlobalCompilationDatabase &CDB) {
   BackgroundIndexLoader Loader(IndexStorageFactory);
-  for (llvm::StringRef MainFile : MainFiles) {
-    assert(llvm::sys::path::is_absolute(MainFile));
-    Loader.load(MainFile);
-  }
+  assert(llvm::all_of(MainFiles, [](llvm::StringRef MainFile) {
+    return llvm::sys::path::is_absolute(MainFile);
+  }));
+  Loader.load(MainFiles);
   return std::move(Loader).takeResult();
 }
 
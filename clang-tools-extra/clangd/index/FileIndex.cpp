@@ -97,6 +97,7 @@ void FileSymbols::update(PathRef Path, std::unique_ptr<SymbolSlab> Symbols,
                          std::unique_ptr<RelationSlab> Relations,
                          bool CountReferences) {
   std::lock_guard<std::mutex> Lock(Mutex);
+  ChangedFiles.insert(Path);
   if (!Symbols)
     FileToSymbols.erase(Path);
   else
@@ -115,8 +116,88 @@ void FileSymbols::update(PathRef Path, std::unique_ptr<SymbolSlab> Symbols,
     FileToRelations[Path] = std::move(Relations);
 }
 
+std::unique_ptr<SymbolIndex> FileSymbols::buildShardedIndex() {
+  std::lock_guard<std::mutex> ShardsLock(ShardsMutex);
+  std::vector<std::string> Changed;
+  {
+    std::lock_guard<std::mutex> Lock(Mutex);
+    for (const auto &Path : ChangedFiles) {
+      Changed.push_back(Path.getKey());
+      Shard &S = Shards[Path.getKey()];
+      S.Symbols = FileToSymbols.lookup(Path.getKey());
+      S.Refs = FileToRefs.lookup(Path.getKey()).Slab;
+      S.Relations = FileToRelations.lookup(Path.getKey());
+    }
+    ChangedFiles.clear();
+  }
+
+  // Changed files give up the symbols they provided, and take back those they
+  // still have; other files only take over the symbols left without an owner.
+  std::vector<SymbolID> Released;
+  for (const auto &Path : Changed) {
+    Shard &S = Shards[Path];
+    for (const SymbolID &ID : S.Owned)
+      SymbolOwners.erase(ID);
+    Released.insert(Released.end(), S.Owned.begin(), S.Owned.end());
+    S.Owned.clear();
+    S.Index = nullptr;
+  }
+  for (const auto &Path : Changed) {
+    Shard &S = Shards[Path];
+    if (!S.Symbols)
+      continue;
+    for (const auto &Sym : *S.Symbols) {
+      assert(Sym.References == 0 &&
+             "Symbol with non-zero references sent to FileSymbols");
+      if (SymbolOwners.try_emplace(Sym.ID, &S).second)
+        S.Owned.push_back(Sym.ID);
+    }
+  }
+  for (const SymbolID &ID : Released) {
+    if (SymbolOwners.count(ID))
+      continue;
+    for (auto &Entry : Shards) {
+      Shard &S = Entry.getValue();
+      if (S.Symbols && S.Symbols->find(ID) != S.Symbols->end()) {
+        SymbolOwners[ID] = &S;
+        S.Owned.push_back(ID);
+        S.Index = nullptr;
+        break;
+      }
+    }
+  }
+  for (const auto &Path : Changed) {
+    auto It = Shards.find(Path);
+    if (!It->getValue().Symbols && !It->getValue().Refs &&
+        !It->getValue().Relations)
+      Shards.erase(It);
+  }
+
+  std::vector<std::shared_ptr<const dex::Dex>> Indexes;
+  for (auto &Entry : Shards) {
+    Shard &S = Entry.getValue();
+    if (!S.Index) {
+      std::vector<const Symbol *> Symbols;
+      for (const SymbolID &ID : S.Owned)
+        Symbols.push_back(&*S.Symbols->find(ID));
+      auto Refs = S.Refs ? S.Refs : std::make_shared<RefSlab>();
+      auto Relations =
+          S.Relations ? S.Relations : std::make_shared<RelationSlab>();
+      size_t StorageSize = (S.Symbols ? S.Symbols->bytes() : 0) +
+                           Refs->bytes() + Relations->bytes();
+      S.Index = std::make_shared<dex::Dex>(
+          llvm::make_pointee_range(Symbols), *Refs, *Relations,
+          std::make_tuple(S.Symbols, Refs, Relations), StorageSize);
+    }
+    Indexes.push_back(S.Index);
+  }
+  return std::make_unique<dex::ShardedDex>(std::move(Indexes));
+}
+
 std::unique_ptr<SymbolIndex>
 FileSymbols::buildIndex(IndexType Type, DuplicateHandling DuplicateHandle) {
+  if (Type == IndexType::Heavy && DuplicateHandle == DuplicateHandling::PickOne)
+    return buildShardedIndex();
   std::vector<std::shared_ptr<SymbolSlab>> SymbolSlabs;
   std::vector<std::shared_ptr<RefSlab>> RefSlabs;
   std::vector<std::shared_ptr<RelationSlab>> RelationSlabs;
@@ -21,7 +21,10 @@
 #include "Path.h"
 #include "index/CanonicalIncludes.h"
 #include "index/Symbol.h"
+#include "index/dex/Dex.h"
 #include "clang/Lex/Preprocessor.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/StringSet.h"
 #include <memory>
 
 namespace clang {
@@ -57,6 +60,10 @@ enum class DuplicateHandling {
 ///
 /// The snapshot semantics keeps critical sections minimal since we only need
 /// locking when we swap or obtain references to snapshots.
+///
+/// Heavy indexes with DuplicateHandling::PickOne are built incrementally: each
+/// file has its own Dex over the symbols it is picked to provide, which is only
+/// rebuilt when the file or the symbols it provides change.
 class FileSymbols {
 public:
   /// Updates all symbols and refs in a file.
@@ -79,8 +86,28 @@ private:
     std::shared_ptr<RefSlab> Slab;
     bool CountReferences = false;
   };
+  /// The part of the incrementally built index that comes from one file.
+  struct Shard {
+    std::shared_ptr<SymbolSlab> Symbols;
+    std::shared_ptr<RefSlab> Refs;
+    std::shared_ptr<RelationSlab> Relations;
+    /// The symbols of this file that no other shard provides.
+    std::vector<SymbolID> Owned;
+    /// Null if the shard must be rebuilt.
+    std::shared_ptr<const dex::Dex> Index;
+  };
+
+  std::unique_ptr<SymbolIndex> buildShardedIndex();
+
   mutable std::mutex Mutex;
 
+  /// Files updated since the last buildShardedIndex(), guarded by Mutex.
+  llvm::StringSet<> ChangedFiles;
+  /// Serializes buildShardedIndex(), and guards the shards.
+  std::mutex ShardsMutex;
+  llvm::StringMap<Shard> Shards;
+  llvm::DenseMap<SymbolID, Shard *> SymbolOwners;
+
   /// Stores the latest symbol snapshots for all active files.
   llvm::StringMap<std::shared_ptr<SymbolSlab>> FileToSymbols;
   /// Stores the latest ref snapshots for all active files.
@@ -33,27 +33,112 @@ std::shared_ptr<SymbolIndex> SwapIndex::snapshot() const {
 
 bool fromJSON(const llvm::json::Value &Parameters, FuzzyFindRequest &Request) {
   llvm::json::ObjectMapper O(Parameters);
-  int64_t Limit;
+  llvm::Optional<int64_t> Limit;
   bool OK =
       O && O.map("Query", Request.Query) && O.map("Scopes", Request.Scopes) &&
       O.map("AnyScope", Request.AnyScope) && O.map("Limit", Limit) &&
       O.map("RestrictForCodeCompletion", Request.RestrictForCodeCompletion) &&
       O.map("ProximityPaths", Request.ProximityPaths) &&
       O.map("PreferredTypes", Request.PreferredTypes);
-  if (OK && Limit <= std::numeric_limits<uint32_t>::max())
-    Request.Limit = Limit;
+  if (OK && Limit && *Limit <= std::numeric_limits<uint32_t>::max())
+    Request.Limit = *Limit;
   return OK;
 }
 
 llvm::json::Value toJSON(const FuzzyFindRequest &Request) {
   return llvm::json::Object{
       {"Query", Request.Query},
-      {"Scopes", llvm::json::Array{Request.Scopes}},
+      {"Scopes", llvm::json::Array(Request.Scopes)},
       {"AnyScope", Request.AnyScope},
       {"Limit", Request.Limit},
       {"RestrictForCodeCompletion", Request.RestrictForCodeCompletion},
-      {"ProximityPaths", llvm::json::Array{Request.ProximityPaths}},
-      {"PreferredTypes", llvm::json::Array{Request.PreferredTypes}},
+      {"ProximityPaths", llvm::json::Array(Request.ProximityPaths)},
+      {"PreferredTypes", llvm::json::Array(Request.PreferredTypes)},
+  };
+}
+
+namespace {
+// IDs are sorted, so that equal requests have equal serializations.
+llvm::json::Value toJSON(const llvm::DenseSet<SymbolID> &IDs) {
+  std::vector<std::string> Strings;
+  for (const SymbolID &ID : IDs)
+    Strings.push_back(ID.str());
+  llvm::sort(Strings);
+  return llvm::json::Array(Strings);
+}
+
+bool fromJSON(const llvm::json::Value *Value, llvm::DenseSet<SymbolID> &IDs) {
+  const llvm::json::Array *Strings = Value ? Value->getAsArray() : nullptr;
+  if (!Strings)
+    return false;
+  for (const llvm::json::Value &String : *Strings) {
+    auto S = String.getAsString();
+    if (!S)
+      return false;
+    auto ID = SymbolID::fromStr(*S);
+    if (!ID) {
+      llvm::consumeError(ID.takeError());
+      return false;
+    }
+    IDs.insert(*ID);
+  }
+  return true;
+}
+
+llvm::Optional<uint32_t> limitFromJSON(const llvm::json::Object &O) {
+  auto Limit = O.getInteger("Limit");
+  if (Limit && *Limit >= 0 && *Limit <= std::numeric_limits<uint32_t>::max())
+    return *Limit;
+  return llvm::None;
+}
+} // namespace
+
+bool fromJSON(const llvm::json::Value &Parameters, LookupRequest &Request) {
+  const llvm::json::Object *O = Parameters.getAsObject();
+  return O && fromJSON(O->get("IDs"), Request.IDs);
+}
+
+llvm::json::Value toJSON(const LookupRequest &Request) {
+  return llvm::json::Object{{"IDs", toJSON(Request.IDs)}};
+}
+
+bool fromJSON(const llvm::json::Value &Parameters, RefsRequest &Request) {
+  const llvm::json::Object *O = Parameters.getAsObject();
+  if (!O || !fromJSON(O->get("IDs"), Request.IDs))
+    return false;
+  auto Filter = O->getInteger("Filter");
+  if (!Filter)
+    return false;
+  Request.Filter = static_cast<RefKind>(*Filter) & RefKind::All;
+  Request.Limit = limitFromJSON(*O);
+  return true;
+}
+
+llvm::json::Value toJSON(const RefsRequest &Request) {
+  return llvm::json::Object{
+      {"IDs", toJSON(Request.IDs)},
+      {"Filter", static_cast<int>(Request.Filter)},
+      {"Limit", Request.Limit},
+  };
+}
+
+bool fromJSON(const llvm::json::Value &Parameters, RelationsRequest &Request) {
+  const llvm::json::Object *O = Parameters.getAsObject();
+  if (!O || !fromJSON(O->get("Subjects"), Request.Subjects))
+    return false;
+  auto Predicate = O->getInteger("Predicate");
+  if (!Predicate)
+    return false;
+  Request.Predicate = static_cast<index::SymbolRole>(*Predicate);
+  Request.Limit = limitFromJSON(*O);
+  return true;
+}
+
+llvm::json::Value toJSON(const RelationsRequest &Request) {
+  return llvm::json::Object{
+      {"Subjects", toJSON(Request.Subjects)},
+      {"Predicate", static_cast<int>(Request.Predicate)},
+      {"Limit", Request.Limit},
   };
 }
 
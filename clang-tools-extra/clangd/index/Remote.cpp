@@ -0,0 +1,450 @@
+//===--- Remote.cpp - Index served by another process -----------*- C++-*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "Remote.h"
+#include "Logger.h"
+#include "Serialization.h"
+#include "Trace.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Support/Endian.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/FormatVariadic.h"
+#include "llvm/Support/Process.h"
+#include "llvm/Support/ScopedPrinter.h"
+#include "llvm/Support/raw_ostream.h"
+#include <list>
+#include <mutex>
+#ifdef LLVM_ON_UNIX
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace clang {
+namespace clangd {
+namespace {
+
+llvm::Error makeError(const llvm::Twine &Msg) {
+  return llvm::make_error<llvm::StringError>(Msg,
+                                             llvm::inconvertibleErrorCode());
+}
+
+class FDChannel : public IndexChannel {
+public:
+  FDChannel(int InFD, int OutFD, bool CloseFDs)
+      : InFD(InFD), CloseFDs(CloseFDs), Out(OutFD, CloseFDs) {}
+
+  ~FDChannel() {
+    Out.clear_error(); // Errors were reported by send().
+    if (CloseFDs)
+      llvm::sys::Process::SafelyCloseFileDescriptor(InFD);
+  }
+
+  bool send(llvm::StringRef Message) override {
+    char Size[4];
+    llvm::support::endian::write32le(Size, Message.size());
+    Out.write(Size, sizeof(Size));
+    Out << Message;
+    Out.flush();
+    return !Out.has_error();
+  }
+
+  bool receive(std::string &Message) override {
+    char Size[4];
+    if (!read(Size, sizeof(Size)))
+      return false;
+    Message.resize(llvm::support::endian::read32le(Size));
+    return read(&Message[0], Message.size());
+  }
+
+private:
+  bool read(char *Buf, size_t N) {
+    while (N) {
+      auto Read = llvm::sys::fs::readNativeFile(
+          llvm::sys::fs::convertFDToNativeFile(InFD), {Buf, N});
+      if (!Read) {
+        llvm::consumeError(Read.takeError());
+        return false;
+      }
+      if (*Read == 0) // EOF
+        return false;
+      Buf += *Read;
+      N -= *Read;
+    }
+    return true;
+  }
+
+  int InFD;
+  bool CloseFDs;
+  llvm::raw_fd_ostream Out;
+};
+
+// Results are sent in several messages, so that clients can start consuming
+// them early, and neither side has to hold a huge single message.
+constexpr size_t ResultsPerMessage = 256;
+
+// Accumulates the results of a request on the server side.
+class ResponseWriter {
+public:
+  ResponseWriter(IndexChannel &Channel) : Channel(Channel) {}
+
+  void add(const Symbol &Sym) {
+    Symbols->insert(Sym);
+    added();
+  }
+  void add(const Ref &R) {
+    // Callbacks don't say which symbol a reference belongs to.
+    Refs->insert(SymbolID(), R);
+    added();
+  }
+  void add(const SymbolID &Subject, index::SymbolRole Predicate,
+           const Symbol &Object) {
+    Relations->insert({Subject, Predicate, Object.ID});
+    Symbols->insert(Object);
+    added();
+  }
+
+  // Sends the pending results, and returns false if the channel is broken.
+  bool flush() {
+    if (!Pending)
+      return OK;
+    Pending = 0;
+    SymbolSlab SymbolData = std::move(*Symbols).build();
+    RefSlab RefData = std::move(*Refs).build();
+    RelationSlab RelationData = std::move(*Relations).build();
+    Symbols = std::make_unique<SymbolSlab::Builder>();
+    Refs = std::make_unique<RefSlab::Builder>();
+    Relations = std::make_unique<RelationSlab::Builder>();
+    IndexFileOut Data;
+    Data.Symbols = &SymbolData;
+    Data.Refs = &RefData;
+    Data.Relations = &RelationData;
+    OK = OK && Channel.send("D" + llvm::to_string(Data));
+    return OK;
+  }
+
+private:
+  void added() {
+    if (++Pending == ResultsPerMessage)
+      flush();
+  }
+
+  IndexChannel &Channel;
+  // Builders can't be reset, so they are replaced after each message.
+  std::unique_ptr<SymbolSlab::Builder> Symbols =
+      std::make_unique<SymbolSlab::Builder>();
+  std::unique_ptr<RefSlab::Builder> Refs = std::make_unique<RefSlab::Builder>();
+  std::unique_ptr<RelationSlab::Builder> Relations =
+      std::make_unique<RelationSlab::Builder>();
+  size_t Pending = 0;
+  bool OK = true;
+};
+
+// Handles one request, returning the content of the end message.
+llvm::json::Object handleRequest(const SymbolIndex &Index,
+                                 llvm::StringRef Message,
+                                 ResponseWriter &Out) {
+  auto Request = llvm::json::parse(Message);
+  if (!Request)
+    return llvm::json::Object{{"error", llvm::toString(Request.takeError())}};
+  const llvm::json::Object *Object = Request->getAsObject();
+  llvm::Optional<llvm::StringRef> Method;
+  const llvm::json::Value *Params = nullptr;
+  if (Object) {
+    Method = Object->getString("method");
+    Params = Object->get("params");
+  }
+  if (!Method || !Params)
+    return llvm::json::Object{{"error", "malformed request"}};
+  trace::Span Tracer(("Serve " + *Method).str());
+
+  if (*Method == "fuzzyFind") {
+    FuzzyFindRequest Req;
+    if (fromJSON(*Params, Req))
+      return llvm::json::Object{
+          {"more", Index.fuzzyFind(
+                       Req, [&](const Symbol &Sym) { Out.add(Sym); })}};
+  } else if (*Method == "lookup") {
+    LookupRequest Req;
+    if (fromJSON(*Params, Req)) {
+      Index.lookup(Req, [&](const Symbol &Sym) { Out.add(Sym); });
+      return {};
+    }
+  } else if (*Method == "refs") {
+    RefsRequest Req;
+    if (fromJSON(*Params, Req)) {
+      Index.refs(Req, [&](const Ref &R) { Out.add(R); });
+      return {};
+    }
+  } else if (*Method == "relations") {
+    RelationsRequest Req;
+    if (fromJSON(*Params, Req)) {
+      Index.relations(Req, [&](const SymbolID &Subject, const Symbol &Object) {
+        Out.add(Subject, Req.Predicate, Object);
+      });
+      return {};
+    }
+  } else {
+    return llvm::json::Object{{"error", ("unknown method " + *Method).str()}};
+  }
+  return llvm::json::Object{
+      {"error", ("malformed " + *Method + " request").str()}};
+}
+
+// The results of one request, as received by the client.
+struct Response {
+  std::vector<std::unique_ptr<IndexFileIn>> Parts;
+  bool HasMore = false;
+};
+
+class RemoteIndex : public SymbolIndex {
+public:
+  RemoteIndex(std::unique_ptr<IndexChannel> Channel, size_t CacheSize)
+      : Channel(std::move(Channel)), CacheSize(CacheSize) {}
+
+  bool
+  fuzzyFind(const FuzzyFindRequest &Req,
+            llvm::function_ref<void(const Symbol &)> Callback) const override {
+    auto R = cachedCall("fuzzyFind", toJSON(Req), [&](const IndexFileIn &Part) {
+      if (Part.Symbols)
+        for (const Symbol &Sym : *Part.Symbols)
+          Callback(Sym);
+    });
+    return R && R->HasMore;
+  }
+
+  void lookup(const LookupRequest &Req,
+              llvm::function_ref<void(const Symbol &)> Callback) const override {
+    std::lock_guard<std::mutex> Lock(Mu);
+    // Symbols are cached one by one, so that a lookup only has to ask for the
+    // ones that weren't seen before.
+    LookupRequest Missing;
+    for (const SymbolID &ID : Req.IDs) {
+      auto Cached = getCached("lookup:" + ID.str());
+      if (!Cached) {
+        Missing.IDs.insert(ID);
+        continue;
+      }
+      for (const auto &Part : Cached->Parts) {
+        if (!Part->Symbols)
+          continue;
+        auto It = Part->Symbols->find(ID);
+        if (It != Part->Symbols->end())
+          Callback(*It);
+      }
+    }
+    if (Missing.IDs.empty())
+      return;
+    auto R = call("lookup", toJSON(Missing), [&](const IndexFileIn &Part) {
+      if (Part.Symbols)
+        for (const Symbol &Sym : *Part.Symbols)
+          Callback(Sym);
+    });
+    if (R)
+      for (const SymbolID &ID : Missing.IDs)
+        putCached("lookup:" + ID.str(), R);
+  }
+
+  void refs(const RefsRequest &Req,
+            llvm::function_ref<void(const Ref &)> Callback) const override {
+    cachedCall("refs", toJSON(Req), [&](const IndexFileIn &Part) {
+      if (Part.Refs)
+        for (const auto &Refs : *Part.Refs)
+          for (const Ref &R : Refs.second)
+            Callback(R);
+    });
+  }
+
+  void relations(const RelationsRequest &Req,
+                 llvm::function_ref<void(const SymbolID &, const Symbol &)>
+                     Callback) const override {
+    cachedCall("relations", toJSON(Req), [&](const IndexFileIn &Part) {
+      if (!Part.Relations || !Part.Symbols)
+        return;
+      for (const Relation &Rel : *Part.Relations) {
+        auto It = Part.Symbols->find(Rel.Object);
+        if (It != Part.Symbols->end())
+          Callback(Rel.Subject, *It);
+      }
+    });
+  }
+
+  // The index itself lives in the server, only the cache is local.
+  size_t estimateMemoryUsage() const override { return 0; }
+
+private:
+  using PartCallback = llvm::function_ref<void(const IndexFileIn &)>;
+
+  std::shared_ptr<const Response> cachedCall(llvm::StringRef Method,
+                                             llvm::json::Value Params,
+                                             PartCallback OnPart) const {
+    std::string Key = llvm::formatv("{0}:{1}", Method, Params);
+    std::lock_guard<std::mutex> Lock(Mu);
+    if (auto Cached = getCached(Key)) {
+      for (const auto &Part : Cached->Parts)
+        OnPart(*Part);
+      return Cached;
+    }
+    auto R = call(Method, std::move(Params), OnPart);
+    if (R)
+      putCached(Key, R);
+    return R;
+  }
+
+  // Sends a request and calls OnPart on each part of the response as soon as
+  // it arrives. Returns null if the connection is broken. Requires Mu.
+  std::shared_ptr<const Response> call(llvm::StringRef Method,
+                                       llvm::json::Value Params,
+                                       PartCallback OnPart) const {
+    if (Broken)
+      return nullptr;
+    trace::Span Tracer(("Remote " + Method).str());
+    auto Result = std::make_shared<Response>();
+    std::string Message =
+        llvm::formatv("{0}", llvm::json::Value(llvm::json::Object{
+                                 {"method", Method}, {"params", Params}}));
+    if (!Channel->send(Message))
+      return failed("failed to send request");
+    while (true) {
+      if (!Channel->receive(Message) || Message.empty())
+        return failed("failed to receive response");
+      llvm::StringRef Payload = llvm::StringRef(Message).drop_front();
+      if (Message.front() == 'D') {
+        auto Part = readIndexFile(Payload);
+        if (!Part)
+          return failed(llvm::toString(Part.takeError()));
+        Result->Parts.push_back(std::make_unique<IndexFileIn>(std::move(*Part)));
+        OnPart(*Result->Parts.back());
+        continue;
+      }
+      if (Message.front() != 'E')
+        return failed("malformed response");
+      auto End = llvm::json::parse(Payload);
+      if (!End)
+        return failed(llvm::toString(End.takeError()));
+      if (const auto *Object = End->getAsObject()) {
+        if (auto Error = Object->getString("error")) {
+          // The request failed, but the connection is fine.
+          elog("Remote index {0} failed: {1}", Method, *Error);
+          return nullptr;
+        }
+        Result->HasMore = Object->getBoolean("more").getValueOr(false);
+      }
+      return Result;
+    }
+  }
+
+  std::nullptr_t failed(const llvm::Twine &Reason) const {
+    elog("Remote index connection lost: {0}", Reason);
+    Broken = true;
+    return nullptr;
+  }
+
+  // Cache entries are ordered by last use, most recent first. Requires Mu.
+  std::shared_ptr<const Response> getCached(llvm::StringRef Key) const {
+    auto It = CacheIndex.find(Key);
+    if (It == CacheIndex.end())
+      return nullptr;
+    Cache.splice(Cache.begin(), Cache, It->second);
+    return It->second->second;
+  }
+
+  void putCached(llvm::StringRef Key,
+                 std::shared_ptr<const Response> R) const {
+    if (!CacheSize)
+      return;
+    Cache.emplace_front(Key, std::move(R));
+    CacheIndex[Key] = Cache.begin();
+    if (Cache.size() > CacheSize) {
+      CacheIndex.erase(Cache.back().first);
+      Cache.pop_back();
+    }
+  }
+
+  // Requests are sent one at a time, and callbacks run under this lock.
+  mutable std::mutex Mu;
+  std::unique_ptr<IndexChannel> Channel;
+  mutable bool Broken = false;
+  size_t CacheSize;
+  mutable std::list<std::pair<std::string, std::shared_ptr<const Response>>>
+      Cache;
+  mutable llvm::StringMap<decltype(Cache)::iterator> CacheIndex;
+};
+
+} // namespace
+
+std::unique_ptr<IndexChannel> createFDChannel(int InFD, int OutFD,
+                                              bool CloseFDs) {
+  return std::make_unique<FDChannel>(InFD, OutFD, CloseFDs);
+}
+
+llvm::Expected<std::unique_ptr<IndexChannel>>
+spawnIndexServer(llvm::ArrayRef<std::string> Argv) {
+  if (Argv.empty())
+    return makeError("empty index server command");
+#ifdef LLVM_ON_UNIX
+  int ToServer[2], FromServer[2];
+  if (::pipe(ToServer))
+    return llvm::errorCodeToError(
+        std::error_code(errno, std::generic_category()));
+  if (::pipe(FromServer)) {
+    std::error_code EC(errno, std::generic_category());
+    ::close(ToServer[0]);
+    ::close(ToServer[1]);
+    return llvm::errorCodeToError(EC);
+  }
+  // Don't leak our ends of the pipes into other children.
+  ::fcntl(ToServer[1], F_SETFD, FD_CLOEXEC);
+  ::fcntl(FromServer[0], F_SETFD, FD_CLOEXEC);
+
+  std::vector<char *> Args;
+  for (const std::string &Arg : Argv)
+    Args.push_back(const_cast<char *>(Arg.c_str()));
+  Args.push_back(nullptr);
+  pid_t Child = ::fork();
+  if (Child == 0) {
+    ::dup2(ToServer[0], STDIN_FILENO);
+    ::dup2(FromServer[1], STDOUT_FILENO);
+    ::close(ToServer[0]);
+    ::close(FromServer[1]);
+    ::execvp(Args.front(), Args.data());
+    ::_exit(127);
+  }
+  std::error_code EC(errno, std::generic_category());
+  ::close(ToServer[0]);
+  ::close(FromServer[1]);
+  if (Child < 0) {
+    ::close(ToServer[1]);
+    ::close(FromServer[0]);
+    return llvm::errorCodeToError(EC);
+  }
+  log("Started index server {0} (pid {1})", Argv.front(), Child);
+  return createFDChannel(FromServer[0], ToServer[1], /*CloseFDs=*/true);
+#else
+  return makeError("starting an index server is not supported on this host");
+#endif
+}
+
+void serveIndex(const SymbolIndex &Index, IndexChannel &Channel) {
+  std::string Message;
+  while (Channel.receive(Message)) {
+    ResponseWriter Out(Channel);
+    llvm::json::Object End = handleRequest(Index, Message, Out);
+    if (!Out.flush() ||
+        !Channel.send(llvm::formatv("E{0}", llvm::json::Value(std::move(End)))
+                          .str()))
+      return;
+  }
+}
+
+std::unique_ptr<SymbolIndex>
+createRemoteIndex(std::unique_ptr<IndexChannel> Channel, size_t CacheSize) {
+  return std::make_unique<RemoteIndex>(std::move(Channel), CacheSize);
+}
+
+} // namespace clangd
+} // namespace clang
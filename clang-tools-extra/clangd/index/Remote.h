@@ -0,0 +1,69 @@
+//===--- Remote.h - Index served by another process -------------*- C++-*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// A SymbolIndex that forwards requests to an index server, so that many clangd
+// instances can share one static index of a large codebase hosted elsewhere.
+//
+// The server reads requests from a byte stream and writes responses back, so
+// it can be reached through anything that forwards standard streams, e.g.
+//   clangd --remote-index-command="ssh host clangd-index-server idx.riff"
+//
+// Every message is a 4-byte little-endian length followed by the payload.
+// A request is a JSON object {"method": "lookup", "params": {...}}. The server
+// answers with any number of data messages ('D' followed by a RIFF index file
+// holding some of the results, so they can be consumed while the rest are
+// still in flight), then one end message ('E' followed by a JSON object, e.g.
+// {"more": true} for a fuzzyFind that hit its limit).
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_TOOLS_EXTRA_CLANGD_INDEX_REMOTE_H
+#define LLVM_CLANG_TOOLS_EXTRA_CLANGD_INDEX_REMOTE_H
+
+#include "Index.h"
+#include "llvm/Support/Error.h"
+#include <memory>
+
+namespace clang {
+namespace clangd {
+
+/// A connection between an index server and one of its clients.
+class IndexChannel {
+public:
+  virtual ~IndexChannel() = default;
+  /// Both return false once the connection is broken or closed.
+  virtual bool send(llvm::StringRef Message) = 0;
+  virtual bool receive(std::string &Message) = 0;
+};
+
+/// Reads messages from InFD and writes them to OutFD, e.g. the standard streams
+/// of a server process. The descriptors are closed with the channel if
+/// CloseFDs is set.
+std::unique_ptr<IndexChannel> createFDChannel(int InFD, int OutFD,
+                                              bool CloseFDs);
+
+/// Starts the server command Argv and talks to it through its standard streams.
+llvm::Expected<std::unique_ptr<IndexChannel>>
+spawnIndexServer(llvm::ArrayRef<std::string> Argv);
+
+/// Answers requests from Channel with Index until the channel is closed.
+void serveIndex(const SymbolIndex &Index, IndexChannel &Channel);
+
+/// Returns an index that sends its requests through Channel.
+/// Lookups are batched into one request per call, skipping symbols whose
+/// results are already cached. Up to CacheSize responses are kept, which is
+/// appropriate as the index behind the server is not expected to change.
+/// If the connection breaks, requests return no results.
+std::unique_ptr<SymbolIndex>
+createRemoteIndex(std::unique_ptr<IndexChannel> Channel,
+                  size_t CacheSize = 1024);
+
+} // namespace clangd
+} // namespace clang
+
+#endif // LLVM_CLANG_TOOLS_EXTRA_CLANGD_INDEX_REMOTE_H
@@ -408,6 +408,82 @@ Relation readRelation(Reader &Data) {
   return {Subject, Predicate, Object};
 }
 
+// POSTING LISTS ENCODING
+// A posting lists section holds the Dex inverted index over the symbols in the
+// symb section:
+//  - symbol count: varint
+//  - Dex order: symbol count * varint (position of the symbol in symb)
+//  - a flat list of posting lists, and each list has:
+//    - token kind: 1 byte
+//    - token data: string table index (varint)
+//    - chunk count: varint
+//    - chunks: head (4 bytes) and VByte-encoded payload (Chunk::PayloadSize)
+// Chunks are stored as PostingList encodes them, so no re-encoding is needed.
+
+void writePostingLists(const dex::PostingLists &Postings,
+                       llvm::ArrayRef<llvm::StringRef> TokenData,
+                       const StringTableOut &Strings, llvm::raw_ostream &OS) {
+  writeVar(Postings.Order.size(), OS);
+  for (uint32_t Position : Postings.Order)
+    writeVar(Position, OS);
+  for (size_t I = 0; I < Postings.Lists.size(); ++I) {
+    const auto &List = Postings.Lists[I];
+    OS.write(static_cast<uint8_t>(List.first.kind()));
+    writeVar(Strings.index(TokenData[I]), OS);
+    writeVar(List.second.chunks().size(), OS);
+    for (const dex::Chunk &C : List.second.chunks()) {
+      write32(C.Head, OS);
+      OS.write(reinterpret_cast<const char *>(C.Payload.data()),
+               C.Payload.size());
+    }
+  }
+}
+
+llvm::Expected<dex::PostingLists>
+readPostingLists(Reader &Data, llvm::ArrayRef<llvm::StringRef> Strings,
+                 size_t NumSymbols) {
+  dex::PostingLists Result;
+  if (Data.consumeVar() != NumSymbols)
+    return makeError("posting lists built from different symbols");
+  Result.Order.resize(NumSymbols);
+  std::vector<bool> Seen(NumSymbols);
+  for (uint32_t &Position : Result.Order) {
+    Position = Data.consumeVar();
+    if (Position >= NumSymbols || Seen[Position])
+      return makeError("malformed posting list order");
+    Seen[Position] = true;
+  }
+  while (!Data.eof()) {
+    uint8_t Kind = Data.consume8();
+    if (Kind > static_cast<uint8_t>(dex::Token::Kind::Sentinel))
+      return makeError("malformed posting list token");
+    dex::Token Tok(static_cast<dex::Token::Kind>(Kind),
+                   Data.consumeString(Strings));
+    std::vector<dex::Chunk> Chunks(Data.consumeVar());
+    if (Chunks.empty())
+      return makeError("empty posting list");
+    // DocIDs must be in range and increasing, or iteration would misbehave.
+    int64_t Last = -1;
+    for (dex::Chunk &C : Chunks) {
+      C.Head = Data.consume32();
+      llvm::StringRef Payload = Data.consume(C.Payload.size());
+      if (Data.err())
+        return makeError("truncated posting list");
+      std::copy(Payload.begin(), Payload.end(), C.Payload.begin());
+      if (C.Head <= Last)
+        return makeError("malformed posting list");
+      Last = C.decompress().back();
+    }
+    if (Last >= static_cast<int64_t>(NumSymbols))
+      return makeError("malformed posting list");
+    Result.Lists.emplace_back(std::move(Tok),
+                              dex::PostingList(std::move(Chunks)));
+  }
+  if (Data.err())
+    return makeError("malformed or truncated posting lists");
+  return std::move(Result);
+}
+
 struct InternedCompileCommand {
   llvm::StringRef Directory;
   std::vector<llvm::StringRef> CommandLine;
@@ -440,6 +516,9 @@ readCompileCommand(Reader CmdReader, llvm::ArrayRef<llvm::StringRef> Strings) {
 //   - stri: string table
 //   - symb: symbols
 //   - refs: references to symbols
+//   - rela: relations between symbols
+//   - cmdl: the compile command
+//   - dexp: Dex posting lists over the symbols
 
 // The current versioning scheme is simple - non-current versions are rejected.
 // If you make a breaking change, bump this version number to invalidate stored
@@ -519,6 +598,16 @@ llvm::Expected<IndexFileIn> readRIFF(llvm::StringRef Data) {
       return makeError("malformed or truncated relations");
     Result.Relations = std::move(Relations).build();
   }
+  if (Chunks.count("dexp")) {
+    if (!Result.Symbols)
+      return makeError("posting lists without symbols");
+    Reader PostingsReader(Chunks.lookup("dexp"));
+    auto Postings = readPostingLists(PostingsReader, Strings->Strings,
+                                     Result.Symbols->size());
+    if (!Postings)
+      return Postings.takeError();
+    Result.Postings = std::move(*Postings);
+  }
   if (Chunks.count("cmdl")) {
     Reader CmdReader(Chunks.lookup("cmdl"));
     if (CmdReader.err())
@@ -599,6 +688,17 @@ void writeRIFF(const IndexFileOut &Data, llvm::raw_ostream &OS) {
     }
   }
 
+  std::vector<llvm::StringRef> TokenData;
+  if (Data.Postings) {
+    assert(Data.Postings->Order.size() == Data.Symbols->size() &&
+           "Posting lists were built from different symbols");
+    TokenData.reserve(Data.Postings->Lists.size());
+    for (const auto &List : Data.Postings->Lists) {
+      TokenData.push_back(List.first.data());
+      Strings.intern(TokenData.back());
+    }
+  }
+
   std::string StringSection;
   {
     llvm::raw_string_ostream StringOS(StringSection);
@@ -653,6 +753,15 @@ void writeRIFF(const IndexFileOut &Data, llvm::raw_ostream &OS) {
     RIFF.Chunks.push_back({riff::fourCC("cmdl"), CmdlSection});
   }
 
+  std::string PostingsSection;
+  if (Data.Postings) {
+    {
+      llvm::raw_string_ostream PostingsOS(PostingsSection);
+      writePostingLists(*Data.Postings, TokenData, Strings, PostingsOS);
+    }
+    RIFF.Chunks.push_back({riff::fourCC("dexp"), PostingsSection});
+  }
+
   OS << RIFF;
 }
 
@@ -697,6 +806,7 @@ std::unique_ptr<SymbolIndex> loadIndex(llvm::StringRef SymbolFilename,
   SymbolSlab Symbols;
   RefSlab Refs;
   RelationSlab Relations;
+  llvm::Optional<dex::PostingLists> Postings;
   {
     trace::Span Tracer("ParseIndex");
     if (auto I = readIndexFile(Buffer->get()->getBuffer())) {
@@ -706,6 +816,8 @@ std::unique_ptr<SymbolIndex> loadIndex(llvm::StringRef SymbolFilename,
         Refs = std::move(*I->Refs);
       if (I->Relations)
         Relations = std::move(*I->Relations);
+      if (UseDex)
+        Postings = std::move(I->Postings);
     } else {
       elog("Bad Index: {0}", I.takeError());
       return nullptr;
@@ -717,10 +829,16 @@ std::unique_ptr<SymbolIndex> loadIndex(llvm::StringRef SymbolFilename,
   size_t NumRelations = Relations.size();
 
   trace::Span Tracer("BuildIndex");
-  auto Index = UseDex ? dex::Dex::build(std::move(Symbols), std::move(Refs),
-                                        std::move(Relations))
-                      : MemIndex::build(std::move(Symbols), std::move(Refs),
-                                        std::move(Relations));
+  std::unique_ptr<SymbolIndex> Index;
+  if (!UseDex)
+    Index = MemIndex::build(std::move(Symbols), std::move(Refs),
+                            std::move(Relations));
+  else if (Postings) // Reuse the serialized posting lists.
+    Index = dex::Dex::build(std::move(Symbols), std::move(Refs),
+                            std::move(Relations), std::move(*Postings));
+  else
+    Index = dex::Dex::build(std::move(Symbols), std::move(Refs),
+                            std::move(Relations));
   vlog("Loaded {0} from {1} with estimated memory usage {2} bytes\n"
        "  - number of symbols: {3}\n"
        "  - number of refs: {4}\n"
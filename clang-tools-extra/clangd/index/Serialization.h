@@ -12,6 +12,7 @@
 //  - metadata such as version info
 //  - a string table (which is compressed)
 //  - lists of encoded symbols
+//  - optionally, the posting lists of a Dex built over those symbols
 //
 // The format has a simple versioning scheme: the format version number is
 // written in the file and non-current versions are rejected when reading.
@@ -27,6 +28,7 @@
 #include "Headers.h"
 #include "Index.h"
 #include "index/Symbol.h"
+#include "index/dex/PostingList.h"
 #include "clang/Tooling/CompilationDatabase.h"
 #include "llvm/Support/Error.h"
 
@@ -47,6 +49,8 @@ struct IndexFileIn {
   llvm::Optional<IncludeGraph> Sources;
   // This contains only the Directory and CommandLine.
   llvm::Optional<tooling::CompileCommand> Cmd;
+  // Only present if Symbols is, and built from it.
+  llvm::Optional<dex::PostingLists> Postings;
 };
 // Parse an index file. The input must be a RIFF or YAML file.
 llvm::Expected<IndexFileIn> readIndexFile(llvm::StringRef);
@@ -58,9 +62,10 @@ struct IndexFileOut {
   const RelationSlab *Relations = nullptr;
   // Keys are URIs of the source files.
   const IncludeGraph *Sources = nullptr;
-  // TODO: Support serializing Dex posting lists.
   IndexFileFormat Format = IndexFileFormat::RIFF;
   const tooling::CompileCommand *Cmd = nullptr;
+  // Must be built from Symbols. Only written in the RIFF format.
+  const dex::PostingLists *Postings = nullptr;
 
   IndexFileOut() = default;
   IndexFileOut(const IndexFileIn &I)
@@ -68,7 +73,8 @@ struct IndexFileOut {
         Refs(I.Refs ? I.Refs.getPointer() : nullptr),
         Relations(I.Relations ? I.Relations.getPointer() : nullptr),
         Sources(I.Sources ? I.Sources.getPointer() : nullptr),
-        Cmd(I.Cmd ? I.Cmd.getPointer() : nullptr) {}
+        Cmd(I.Cmd ? I.Cmd.getPointer() : nullptr),
+        Postings(I.Postings ? I.Postings.getPointer() : nullptr) {}
 };
 // Serializes an index file.
 llvm::raw_ostream &operator<<(llvm::raw_ostream &OS, const IndexFileOut &O);
@@ -33,6 +33,19 @@ std::unique_ptr<SymbolIndex> Dex::build(SymbolSlab Symbols, RefSlab Refs,
                                 Size);
 }
 
+std::unique_ptr<SymbolIndex> Dex::build(SymbolSlab Symbols, RefSlab Refs,
+                                        RelationSlab Rels,
+                                        PostingLists Postings) {
+  auto Size = Symbols.bytes() + Refs.bytes();
+  auto Data = std::make_pair(std::move(Symbols), std::move(Refs));
+  auto Index = std::make_unique<Dex>(Data.first, Data.second, Rels,
+                                     std::move(Postings));
+  Index->KeepAlive = std::shared_ptr<void>(
+      std::make_shared<decltype(Data)>(std::move(Data)), nullptr);
+  Index->BackingDataSize = Size;
+  return Index;
+}
+
 namespace {
 
 // Mark symbols which are can be used for code completion.
@@ -64,40 +77,65 @@ std::vector<Token> generateSearchTokens(const Symbol &Sym) {
 
 } // namespace
 
-void Dex::buildIndex() {
-  this->Corpus = dex::Corpus(Symbols.size());
-  std::vector<std::pair<float, const Symbol *>> ScoredSymbols(Symbols.size());
-
-  for (size_t I = 0; I < Symbols.size(); ++I) {
-    const Symbol *Sym = Symbols[I];
-    LookupTable[Sym->ID] = Sym;
-    ScoredSymbols[I] = {quality(*Sym), Sym};
-  }
-
+PostingLists buildPostingLists(llvm::ArrayRef<const Symbol *> Symbols) {
+  PostingLists Result;
+  std::vector<std::pair<float, uint32_t>> ScoredSymbols(Symbols.size());
+  for (size_t I = 0; I < Symbols.size(); ++I)
+    ScoredSymbols[I] = {quality(*Symbols[I]), I};
   // Symbols are sorted by symbol qualities so that items in the posting lists
-  // are stored in the descending order of symbol quality.
-  llvm::sort(ScoredSymbols, std::greater<std::pair<float, const Symbol *>>());
-
-  // SymbolQuality was empty up until now.
-  SymbolQuality.resize(Symbols.size());
-  // Populate internal storage using Symbol + Score pairs.
-  for (size_t I = 0; I < ScoredSymbols.size(); ++I) {
-    SymbolQuality[I] = ScoredSymbols[I].first;
-    Symbols[I] = ScoredSymbols[I].second;
-  }
+  // are stored in the descending order of symbol quality. Ties keep the input
+  // order, so that the same symbols always produce the same lists.
+  llvm::sort(ScoredSymbols, [](const std::pair<float, uint32_t> &L,
+                               const std::pair<float, uint32_t> &R) {
+    return std::make_pair(-L.first, L.second) <
+           std::make_pair(-R.first, R.second);
+  });
+  Result.Order.resize(Symbols.size());
+  for (size_t I = 0; I < ScoredSymbols.size(); ++I)
+    Result.Order[I] = ScoredSymbols[I].second;
 
   // Populate TempInvertedIndex with lists for index symbols.
   llvm::DenseMap<Token, std::vector<DocID>> TempInvertedIndex;
   for (DocID SymbolRank = 0; SymbolRank < Symbols.size(); ++SymbolRank) {
-    const auto *Sym = Symbols[SymbolRank];
+    const auto *Sym = Symbols[Result.Order[SymbolRank]];
     for (const auto &Token : generateSearchTokens(*Sym))
       TempInvertedIndex[Token].push_back(SymbolRank);
   }
 
   // Convert lists of items to posting lists.
+  Result.Lists.reserve(TempInvertedIndex.size());
   for (const auto &TokenToPostingList : TempInvertedIndex)
-    InvertedIndex.insert(
-        {TokenToPostingList.first, PostingList(TokenToPostingList.second)});
+    Result.Lists.emplace_back(TokenToPostingList.first,
+                              PostingList(TokenToPostingList.second));
+  llvm::sort(Result.Lists, [](const std::pair<Token, PostingList> &L,
+                              const std::pair<Token, PostingList> &R) {
+    return std::make_pair(L.first.kind(), L.first.data()) <
+           std::make_pair(R.first.kind(), R.first.data());
+  });
+  return Result;
+}
+
+void Dex::buildIndex() { buildIndex(buildPostingLists(Symbols)); }
+
+void Dex::buildIndex(PostingLists Postings) {
+  assert(Postings.Order.size() == Symbols.size() &&
+         "Posting lists were built from different symbols");
+  this->Corpus = dex::Corpus(Symbols.size());
+  // Place symbols in DocID order.
+  std::vector<const Symbol *> Unordered = std::move(Symbols);
+  Symbols.resize(Unordered.size());
+  SymbolQuality.resize(Unordered.size());
+  for (size_t I = 0; I < Unordered.size(); ++I) {
+    const Symbol *Sym = Unordered[Postings.Order[I]];
+    Symbols[I] = Sym;
+    SymbolQuality[I] = quality(*Sym);
+    LookupTable[Sym->ID] = Sym;
+  }
+
+  InvertedIndex.reserve(Postings.Lists.size());
+  for (auto &TokenToPostingList : Postings.Lists)
+    InvertedIndex.try_emplace(std::move(TokenToPostingList.first),
+                              std::move(TokenToPostingList.second));
 }
 
 std::unique_ptr<Iterator> Dex::iterator(const Token &Tok) const {
@@ -162,6 +200,12 @@ Dex::createTypeBoostingIterator(llvm::ArrayRef<std::string> Types) const {
 /// of the matched symbols.
 bool Dex::fuzzyFind(const FuzzyFindRequest &Req,
                     llvm::function_ref<void(const Symbol &)> Callback) const {
+  return scoredFuzzyFind(Req, [&](const Symbol &Sym, float) { Callback(Sym); });
+}
+
+bool Dex::scoredFuzzyFind(
+    const FuzzyFindRequest &Req,
+    llvm::function_ref<void(const Symbol &, float)> Callback) const {
   assert(!StringRef(Req.Query).contains("::") &&
          "There must be no :: in query.");
   trace::Span Tracer("Dex fuzzyFind");
@@ -235,7 +279,7 @@ bool Dex::fuzzyFind(const FuzzyFindRequest &Req,
   // Apply callback to the top Req.Limit items in the descending
   // order of cumulative score.
   for (const auto &Item : std::move(Top).items())
-    Callback(*Symbols[Item.first]);
+    Callback(*Symbols[Item.first], Item.second);
   return More;
 }
 
@@ -296,6 +340,88 @@ size_t Dex::estimateMemoryUsage() const {
   return Bytes + BackingDataSize;
 }
 
+bool ShardedDex::fuzzyFind(
+    const FuzzyFindRequest &Req,
+    llvm::function_ref<void(const Symbol &)> Callback) const {
+  trace::Span Tracer("ShardedDex fuzzyFind");
+  // Symbols are ranked against each other with the scores of their shards.
+  using SymbolAndScore = std::pair<const Symbol *, float>;
+  auto Compare = [](const SymbolAndScore &LHS, const SymbolAndScore &RHS) {
+    return LHS.second > RHS.second;
+  };
+  TopN<SymbolAndScore, decltype(Compare)> Top(
+      Req.Limit ? *Req.Limit : std::numeric_limits<size_t>::max(), Compare);
+  bool More = false;
+  for (const auto &Shard : Shards)
+    More |= Shard->scoredFuzzyFind(Req, [&](const Symbol &Sym, float Score) {
+      if (Top.push({&Sym, Score}))
+        More = true;
+    });
+  for (const auto &Item : std::move(Top).items())
+    Callback(*Item.first);
+  return More;
+}
+
+void ShardedDex::lookup(
+    const LookupRequest &Req,
+    llvm::function_ref<void(const Symbol &)> Callback) const {
+  trace::Span Tracer("ShardedDex lookup");
+  for (const auto &ID : Req.IDs)
+    for (const auto &Shard : Shards) {
+      auto I = Shard->LookupTable.find(ID);
+      if (I != Shard->LookupTable.end()) {
+        Callback(*I->second);
+        break;
+      }
+    }
+}
+
+void ShardedDex::refs(const RefsRequest &Req,
+                      llvm::function_ref<void(const Ref &)> Callback) const {
+  trace::Span Tracer("ShardedDex refs");
+  uint32_t Remaining =
+      Req.Limit.getValueOr(std::numeric_limits<uint32_t>::max());
+  for (const auto &ID : Req.IDs)
+    for (const auto &Shard : Shards)
+      for (const auto &Ref : Shard->Refs.lookup(ID)) {
+        if (Remaining > 0 && static_cast<int>(Req.Filter & Ref.Kind)) {
+          --Remaining;
+          Callback(Ref);
+        }
+      }
+}
+
+void ShardedDex::relations(
+    const RelationsRequest &Req,
+    llvm::function_ref<void(const SymbolID &, const Symbol &)> Callback) const {
+  trace::Span Tracer("ShardedDex relations");
+  uint32_t Remaining =
+      Req.Limit.getValueOr(std::numeric_limits<uint32_t>::max());
+  for (const SymbolID &Subject : Req.Subjects) {
+    // The relation and its object may come from different shards.
+    LookupRequest LookupReq;
+    for (const auto &Shard : Shards) {
+      auto It = Shard->Relations.find(std::make_pair(Subject, Req.Predicate));
+      if (It == Shard->Relations.end())
+        continue;
+      for (const auto &Object : It->second) {
+        if (Remaining > 0) {
+          --Remaining;
+          LookupReq.IDs.insert(Object);
+        }
+      }
+    }
+    lookup(LookupReq, [&](const Symbol &Object) { Callback(Subject, Object); });
+  }
+}
+
+size_t ShardedDex::estimateMemoryUsage() const {
+  size_t Bytes = Shards.size() * sizeof(std::shared_ptr<const Dex>);
+  for (const auto &Shard : Shards)
+    Bytes += Shard->estimateMemoryUsage();
+  return Bytes;
+}
+
 std::vector<std::string> generateProximityURIs(llvm::StringRef URIPath) {
   std::vector<std::string> Result;
   auto ParsedURI = URI::parse(URIPath);
@@ -32,12 +32,12 @@ namespace clang {
 namespace clangd {
 namespace dex {
 
+/// Builds the posting lists of a Dex over the given symbols.
+PostingLists buildPostingLists(llvm::ArrayRef<const Symbol *> Symbols);
+
 /// In-memory Dex trigram-based index implementation.
-// FIXME(kbobyrev): Introduce serialization and deserialization of the symbol
-// index so that it can be loaded from the disk. Since static index is not
-// changed frequently, it's safe to assume that it has to be built only once
-// (when the clangd process starts). Therefore, it can be easier to store built
-// index on disk and then load it if available.
+/// Static indexes may carry the posting lists built by buildPostingLists(), in
+/// which case the index is reconstructed from them rather than rebuilt.
 class Dex : public SymbolIndex {
 public:
   // All data must outlive this index.
@@ -53,6 +53,20 @@ public:
           Rel.Object);
     buildIndex();
   }
+  // Reuses Postings, which must have been built from the same Symbols.
+  template <typename SymbolRange, typename RefsRange, typename RelationsRange>
+  Dex(SymbolRange &&Symbols, RefsRange &&Refs, RelationsRange &&Relations,
+      PostingLists Postings)
+      : Corpus(0) {
+    for (auto &&Sym : Symbols)
+      this->Symbols.push_back(&Sym);
+    for (auto &&Ref : Refs)
+      this->Refs.try_emplace(Ref.first, Ref.second);
+    for (auto &&Rel : Relations)
+      this->Relations[std::make_pair(Rel.Subject, Rel.Predicate)].push_back(
+          Rel.Object);
+    buildIndex(std::move(Postings));
+  }
   // Symbols and Refs are owned by BackingData, Index takes ownership.
   template <typename SymbolRange, typename RefsRange, typename RelationsRange,
             typename Payload>
@@ -67,11 +81,19 @@ public:
 
   /// Builds an index from slabs. The index takes ownership of the slab.
   static std::unique_ptr<SymbolIndex> build(SymbolSlab, RefSlab, RelationSlab);
+  /// As above, reusing posting lists built from the same SymbolSlab.
+  static std::unique_ptr<SymbolIndex> build(SymbolSlab, RefSlab, RelationSlab,
+                                            PostingLists);
 
   bool
   fuzzyFind(const FuzzyFindRequest &Req,
             llvm::function_ref<void(const Symbol &)> Callback) const override;
 
+  /// As fuzzyFind, but also passes the score of each symbol to Callback.
+  bool scoredFuzzyFind(
+      const FuzzyFindRequest &Req,
+      llvm::function_ref<void(const Symbol &, float Score)> Callback) const;
+
   void lookup(const LookupRequest &Req,
               llvm::function_ref<void(const Symbol &)> Callback) const override;
 
@@ -85,7 +107,10 @@ public:
   size_t estimateMemoryUsage() const override;
 
 private:
+  friend class ShardedDex;
+
   void buildIndex();
+  void buildIndex(PostingLists Postings);
   std::unique_ptr<Iterator> iterator(const Token &Tok) const;
   std::unique_ptr<Iterator>
   createFileProximityIterator(llvm::ArrayRef<std::string> ProximityPaths) const;
@@ -113,6 +138,34 @@ private:
   size_t BackingDataSize = 0;
 };
 
+/// Answers requests from several Dex indexes over disjoint sets of symbols as
+/// if they were a single index, which allows updating part of a large index
+/// without rebuilding all of it. Refs and relations of all shards are used.
+class ShardedDex : public SymbolIndex {
+public:
+  explicit ShardedDex(std::vector<std::shared_ptr<const Dex>> Shards)
+      : Shards(std::move(Shards)) {}
+
+  bool
+  fuzzyFind(const FuzzyFindRequest &Req,
+            llvm::function_ref<void(const Symbol &)> Callback) const override;
+
+  void lookup(const LookupRequest &Req,
+              llvm::function_ref<void(const Symbol &)> Callback) const override;
+
+  void refs(const RefsRequest &Req,
+            llvm::function_ref<void(const Ref &)> Callback) const override;
+
+  void relations(const RelationsRequest &Req,
+                 llvm::function_ref<void(const SymbolID &, const Symbol &)>
+                     Callback) const override;
+
+  size_t estimateMemoryUsage() const override;
+
+private:
+  std::vector<std::shared_ptr<const Dex>> Shards;
+};
+
 /// Returns Search Token for a number of parent directories of given Path.
 /// Should be used within the index build process.
 ///
@@ -24,6 +24,7 @@
 #define LLVM_CLANG_TOOLS_EXTRA_CLANGD_INDEX_DEX_POSTINGLIST_H
 
 #include "Iterator.h"
+#include "Token.h"
 #include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/SmallVector.h"
 #include <cstdint>
@@ -32,7 +33,6 @@
 namespace clang {
 namespace clangd {
 namespace dex {
-class Token;
 
 /// NOTE: This is an implementation detail.
 ///
@@ -59,6 +59,9 @@ static_assert(sizeof(Chunk) == 32, "Chunk should take 32 bytes of memory.");
 class PostingList {
 public:
   explicit PostingList(llvm::ArrayRef<DocID> Documents);
+  /// Adopts chunks produced by an earlier encoding, e.g. read from an index
+  /// file, without decoding them.
+  explicit PostingList(std::vector<Chunk> Chunks) : Chunks(std::move(Chunks)) {}
 
   /// Constructs DocumentIterator over given posting list. DocumentIterator will
   /// go through the chunks and decompress them on-the-fly when necessary.
@@ -68,8 +71,22 @@ public:
   /// Returns in-memory size of external storage.
   size_t bytes() const { return Chunks.capacity() * sizeof(Chunk); }
 
+  /// Returns the encoded representation, e.g. for serialization.
+  llvm::ArrayRef<Chunk> chunks() const { return Chunks; }
+
 private:
-  const std::vector<Chunk> Chunks;
+  std::vector<Chunk> Chunks;
+};
+
+/// The inverted index of a Dex, detached from the symbols it was built from.
+/// It is stored in index files next to the symbols so that a static index can
+/// be loaded without regenerating search tokens and re-encoding posting lists.
+struct PostingLists {
+  /// The symbol with DocID I is at position Order[I] of the symbol range the
+  /// lists were built from (for a SymbolSlab, the order of iteration).
+  std::vector<uint32_t> Order;
+  /// Sorted by token kind and data, so that serialization is deterministic.
+  std::vector<std::pair<Token, PostingList>> Lists;
 };
 
 } // namespace dex
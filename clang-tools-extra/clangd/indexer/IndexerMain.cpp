@@ -16,6 +16,7 @@
 #include "index/Serialization.h"
 #include "index/Symbol.h"
 #include "index/SymbolCollector.h"
+#include "index/dex/Dex.h"
 #include "clang/Tooling/ArgumentsAdjusters.h"
 #include "clang/Tooling/CommonOptionsParser.h"
 #include "clang/Tooling/Execution.h"
@@ -125,6 +126,16 @@ int main(int argc, const char **argv) {
     llvm::errs() << llvm::toString(std::move(Err)) << "\n";
   }
 
+  // Store the Dex posting lists too, so that loading the index is cheap.
+  if (clang::clangd::Format == clang::clangd::IndexFileFormat::RIFF &&
+      Data.Symbols) {
+    std::vector<const clang::clangd::Symbol *> Symbols;
+    Symbols.reserve(Data.Symbols->size());
+    for (const auto &Sym : *Data.Symbols)
+      Symbols.push_back(&Sym);
+    Data.Postings = clang::clangd::dex::buildPostingLists(Symbols);
+  }
+
   // Emit collected data.
   clang::clangd::IndexFileOut Out(Data);
   Out.Format = clang::clangd::Format;
@@ -14,6 +14,7 @@
 #include "Trace.h"
 #include "Transport.h"
 #include "index/Background.h"
+#include "index/Remote.h"
 #include "index/Serialization.h"
 #include "clang/Basic/Version.h"
 #include "clang/Format/Format.h"
@@ -255,6 +256,15 @@ opt<bool> SuggestMissingIncludes{
     init(true),
 };
 
+opt<bool> SkipUnchangedFunctionBodies{
+    "skip-unchanged-function-bodies",
+    cat(Features),
+    desc("Publish diagnostics sooner after an edit by first reparsing "
+         "without the function bodies that precede it"),
+    init(false),
+    Hidden,
+};
+
 list<std::string> TweakList{
     "tweaks",
     cat(Features),
@@ -283,6 +293,16 @@ opt<Path> IndexFile{
     Hidden,
 };
 
+opt<std::string> RemoteIndexCommand{
+    "remote-index-command",
+    cat(Misc),
+    desc("Command starting a clangd-index-server to use as the static index, "
+         "e.g. \"ssh host clangd-index-server /path/to/index\". "
+         "Overrides --index-file"),
+    init(""),
+    Hidden,
+};
+
 opt<bool> Test{
     "lit-test",
     cat(Misc),
@@ -581,7 +601,18 @@ clangd accepts flags on the commandline, and in the CLANGD_FLAGS environment var
   Opts.BackgroundIndex = EnableBackgroundIndex;
   std::unique_ptr<SymbolIndex> StaticIdx;
   std::future<void> AsyncIndexLoad; // Block exit while loading the index.
-  if (EnableIndex && !IndexFile.empty()) {
+  if (EnableIndex && !RemoteIndexCommand.empty()) {
+    llvm::BumpPtrAllocator Alloc;
+    llvm::StringSaver Saver(Alloc);
+    llvm::SmallVector<const char *, 8> Argv;
+    llvm::cl::TokenizeGNUCommandLine(RemoteIndexCommand, Saver, Argv);
+    auto Channel =
+        spawnIndexServer(std::vector<std::string>(Argv.begin(), Argv.end()));
+    if (Channel)
+      StaticIdx = createRemoteIndex(std::move(*Channel));
+    else
+      elog("Couldn't start the index server: {0}", Channel.takeError());
+  } else if (EnableIndex && !IndexFile.empty()) {
     // Load the index asynchronously. Meanwhile SwapIndex returns no results.
     SwapIndex *Placeholder;
     StaticIdx.reset(Placeholder = new SwapIndex(std::make_unique<MemIndex>()));
@@ -653,6 +684,7 @@ clangd accepts flags on the commandline, and in the CLANGD_FLAGS environment var
     };
   }
   Opts.SuggestMissingIncludes = SuggestMissingIncludes;
+  Opts.SkipUnchangedFunctionBodies = SkipUnchangedFunctionBodies;
   Opts.QueryDriverGlobs = std::move(QueryDriverGlobs);
 
   Opts.TweakFilter = [&](const Tweak &T) {
@@ -713,5 +713,22 @@ TEST(BackgroundQueueTest, Boost) {
   }
 }
 
+TEST(BackgroundQueueTest, Distance) {
+  std::string Sequence;
+
+  BackgroundQueue::Task Near([&] { Sequence.push_back('N'); });
+  Near.Distance = 1;
+  BackgroundQueue::Task Far([&] { Sequence.push_back('F'); });
+  Far.Distance = 5;
+  BackgroundQueue::Task FarBoosted([&] { Sequence.push_back('B'); });
+  FarBoosted.Distance = 10;
+  FarBoosted.QueuePri = 1;
+
+  BackgroundQueue Q;
+  Q.append({Far, Near, FarBoosted});
+  Q.work([&] { Q.stop(); });
+  EXPECT_EQ("BNF", Sequence) << "priority first, then distance";
+}
+
 } // namespace clangd
 } // namespace clang
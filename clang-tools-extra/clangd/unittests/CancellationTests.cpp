@@ -44,6 +44,23 @@ TEST(CancellationTest, TaskContextDiesHandleLives) {
   Task.second();
 }
 
+TEST(CancellationTest, NestedTasks) {
+  auto Outer = cancelableTask();
+  WithContext OuterContext(std::move(Outer.first));
+  auto Inner = cancelableTask();
+  {
+    WithContext InnerContext(Inner.first.clone());
+    Inner.second();
+    EXPECT_TRUE(isCancelled());
+  }
+  EXPECT_FALSE(isCancelled());
+
+  auto Other = cancelableTask();
+  WithContext OtherContext(std::move(Other.first));
+  Outer.second();
+  EXPECT_TRUE(isCancelled());
+}
+
 TEST(CancellationTest, AsynCancellationTest) {
   std::atomic<bool> HasCancelled(false);
   Notification Cancelled;
@@ -123,6 +123,49 @@ TEST(FileSymbolsTest, MergeOverlap) {
             AllOf(QName("x"), DeclURI("file:///x1"), DefURI("file:///x2"))));
 }
 
+TEST(FileSymbolsTest, IncrementalPickOne) {
+  FileSymbols FS;
+  FS.update("f1", numSlab(1, 3), refSlab(SymbolID("3"), "f1.cc"), nullptr,
+            false);
+  FS.update("f2", numSlab(3, 5), refSlab(SymbolID("3"), "f2.cc"), nullptr,
+            false);
+  auto Index = FS.buildIndex(IndexType::Heavy);
+  EXPECT_THAT(runFuzzyFind(*Index, ""),
+              UnorderedElementsAre(QName("1"), QName("2"), QName("3"),
+                                   QName("4"), QName("5")));
+  EXPECT_THAT(getRefs(*Index, SymbolID("3")),
+              ElementsAre(Pair(_, UnorderedElementsAre(FileURI("f1.cc"),
+                                                       FileURI("f2.cc")))));
+  LookupRequest Lookup;
+  Lookup.IDs.insert(SymbolID("3"));
+  std::vector<std::string> Found;
+  Index->lookup(Lookup, [&](const Symbol &Sym) { Found.push_back(Sym.Name); });
+  EXPECT_THAT(Found, ElementsAre("3"));
+
+  FuzzyFindRequest Req;
+  Req.AnyScope = true;
+  Req.Limit = 2;
+  Found.clear();
+  EXPECT_TRUE(Index->fuzzyFind(
+      Req, [&](const Symbol &Sym) { Found.push_back(Sym.Name); }));
+  EXPECT_EQ(Found.size(), 2u);
+
+  // Symbols of a removed file remain available from other files.
+  FS.update("f1", nullptr, nullptr, nullptr, false);
+  Index = FS.buildIndex(IndexType::Heavy);
+  EXPECT_THAT(runFuzzyFind(*Index, ""),
+              UnorderedElementsAre(QName("3"), QName("4"), QName("5")));
+  EXPECT_THAT(getRefs(*Index, SymbolID("3")), RefsAre({FileURI("f2.cc")}));
+
+  FS.update("f2", numSlab(5, 6), nullptr, nullptr, false);
+  FS.update("f3", numSlab(1, 1), nullptr, nullptr, false);
+  EXPECT_THAT(runFuzzyFind(*FS.buildIndex(IndexType::Heavy), ""),
+              UnorderedElementsAre(QName("1"), QName("5"), QName("6")));
+  // Earlier snapshots are not affected by updates.
+  EXPECT_THAT(runFuzzyFind(*Index, ""),
+              UnorderedElementsAre(QName("3"), QName("4"), QName("5")));
+}
+
 TEST(FileSymbolsTest, SnapshotAliveAfterRemove) {
   FileSymbols FS;
 
@@ -34,6 +34,9 @@ namespace {
 using ::testing::AllOf;
 using ::testing::ElementsAre;
 using ::testing::ElementsAreArray;
+using ::testing::Field;
+using ::testing::HasSubstr;
+using ::testing::UnorderedElementsAre;
 
 MATCHER_P(DeclNamed, Name, "") {
   if (NamedDecl *ND = dyn_cast<NamedDecl>(arg))
@@ -280,6 +283,68 @@ TEST(ParsedASTTest, CollectsMainFileMacroExpansions) {
               testing::UnorderedElementsAreArray(TestCase.points()));
 }
 
+// Builds Code with SkipUnchangedFunctionBodies, reusing Previous if set.
+ParsedAST buildWithPrevious(llvm::StringRef Code,
+                            const PreviousParse *Previous) {
+  ParseInputs Inputs;
+  Inputs.CompileCommand.Filename = testPath("foo.cpp");
+  Inputs.CompileCommand.CommandLine = {"clang", "-Wunused-function",
+                                       testPath("foo.cpp")};
+  Inputs.CompileCommand.Directory = testRoot();
+  Inputs.Contents = Code;
+  Inputs.FS = buildTestFS({{testPath("foo.cpp"), Code}});
+  Inputs.Opts.SkipUnchangedFunctionBodies = true;
+  IgnoreDiagnostics IgnoreDiags;
+  auto AST = buildAST(testPath("foo.cpp"),
+                      buildCompilerInvocation(Inputs, IgnoreDiags), {}, Inputs,
+                      /*Preamble=*/nullptr, Previous);
+  EXPECT_TRUE(AST);
+  return std::move(*AST);
+}
+
+TEST(ParsedASTTest, SkipsUnchangedFunctionBodies) {
+  std::string Code = R"cpp(
+    static int unused() { return 0; }
+    static int helper() { return 0; }
+    void a() { int X = "s"; helper(); }
+    template <typename T> void t() { T::fail(); }
+    void b() {}
+  )cpp";
+  ParsedAST First = buildWithPrevious(Code, nullptr);
+  EXPECT_FALSE(First.hasSkippedFunctionBodies());
+  // The template is not recorded, it is always parsed.
+  EXPECT_EQ(First.getFunctionBodies().size(), 4u);
+  EXPECT_THAT(First.getDiagnostics(),
+              UnorderedElementsAre(
+                  Field(&Diag::Message, HasSubstr("unused function 'unused'")),
+                  Field(&Diag::Message, HasSubstr("cannot initialize"))));
+
+  PreviousParse Previous;
+  Previous.Bodies = First.getFunctionBodies();
+  Previous.Diags = First.getDiagnostics();
+  Previous.EditOffset = Code.size();
+  Code += "void c() { t<int>(); }";
+  ParsedAST Second = buildWithPrevious(Code, &Previous);
+  EXPECT_TRUE(Second.hasSkippedFunctionBodies());
+  EXPECT_EQ(Second.getFunctionBodies().size(), 5u);
+  // The use of helper() was not seen, but its warning is not reported.
+  EXPECT_THAT(Second.getDiagnostics(),
+              UnorderedElementsAre(
+                  Field(&Diag::Message, HasSubstr("unused function 'unused'")),
+                  Field(&Diag::Message, HasSubstr("cannot initialize")),
+                  Field(&Diag::Message, HasSubstr("prior to '::'"))));
+
+  // Bodies after the edit are parsed again.
+  Previous.EditOffset = Code.find("void a");
+  ParsedAST Third = buildWithPrevious(Code, &Previous);
+  EXPECT_TRUE(Third.hasSkippedFunctionBodies());
+  EXPECT_THAT(Third.getDiagnostics(),
+              UnorderedElementsAre(
+                  Field(&Diag::Message, HasSubstr("unused function 'unused'")),
+                  Field(&Diag::Message, HasSubstr("cannot initialize")),
+                  Field(&Diag::Message, HasSubstr("prior to '::'"))));
+}
+
 } // namespace
 } // namespace clangd
 } // namespace clang
@@ -0,0 +1,177 @@
+//===-- RemoteIndexTests.cpp ------------------------------------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "TestIndex.h"
+#include "index/MemIndex.h"
+#include "index/Remote.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include <condition_variable>
+#include <deque>
+#include <thread>
+
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+using ::testing::UnorderedElementsAre;
+
+namespace clang {
+namespace clangd {
+namespace {
+
+// One direction of an in-process connection.
+struct Queue {
+  std::mutex Mu;
+  std::condition_variable CV;
+  std::deque<std::string> Messages;
+  bool Closed = false;
+  int Sent = 0;
+};
+
+class QueueChannel : public IndexChannel {
+public:
+  QueueChannel(Queue &In, Queue &Out) : In(In), Out(Out) {}
+
+  bool send(llvm::StringRef Message) override {
+    std::lock_guard<std::mutex> Lock(Out.Mu);
+    if (Out.Closed)
+      return false;
+    Out.Messages.push_back(Message);
+    ++Out.Sent;
+    Out.CV.notify_all();
+    return true;
+  }
+
+  bool receive(std::string &Message) override {
+    std::unique_lock<std::mutex> Lock(In.Mu);
+    In.CV.wait(Lock, [&] { return In.Closed || !In.Messages.empty(); });
+    if (In.Messages.empty())
+      return false;
+    Message = std::move(In.Messages.front());
+    In.Messages.pop_front();
+    return true;
+  }
+
+private:
+  Queue &In, &Out;
+};
+
+// Serves Index on a thread, until destroyed.
+class RemoteIndexTest : public ::testing::Test {
+protected:
+  void serve(std::unique_ptr<SymbolIndex> Index) {
+    ServerIndex = std::move(Index);
+    Server = std::thread([this] {
+      QueueChannel Channel(Requests, Responses);
+      serveIndex(*ServerIndex, Channel);
+    });
+    Client = createRemoteIndex(
+        std::make_unique<QueueChannel>(Responses, Requests), /*CacheSize=*/4);
+  }
+
+  void disconnect() {
+    for (Queue *Q : {&Requests, &Responses}) {
+      std::lock_guard<std::mutex> Lock(Q->Mu);
+      Q->Closed = true;
+      Q->CV.notify_all();
+    }
+    if (Server.joinable())
+      Server.join();
+  }
+
+  ~RemoteIndexTest() { disconnect(); }
+
+  int requests() {
+    std::lock_guard<std::mutex> Lock(Requests.Mu);
+    return Requests.Sent;
+  }
+
+  Queue Requests, Responses;
+  std::unique_ptr<SymbolIndex> ServerIndex;
+  std::unique_ptr<SymbolIndex> Client;
+  std::thread Server;
+};
+
+TEST_F(RemoteIndexTest, Requests) {
+  SymbolSlab Symbols = generateSymbols({"ns::abc", "ns::abd", "other::xyz"});
+  SymbolID ABC = symbol("ns::abc").ID;
+  RefSlab::Builder Refs;
+  Ref R;
+  R.Kind = RefKind::Reference;
+  R.Location.FileURI = "unittest:///foo.cc";
+  Refs.insert(ABC, R);
+  serve(MemIndex::build(std::move(Symbols), std::move(Refs).build(),
+                        RelationSlab()));
+
+  FuzzyFindRequest Req;
+  Req.Query = "ab";
+  Req.Scopes = {"ns::"};
+  EXPECT_THAT(match(*Client, Req), UnorderedElementsAre("ns::abc", "ns::abd"));
+  bool Incomplete = false;
+  Req.Limit = 1;
+  EXPECT_EQ(match(*Client, Req, &Incomplete).size(), 1u);
+  EXPECT_TRUE(Incomplete);
+
+  EXPECT_THAT(lookup(*Client, {ABC, symbol("other::xyz").ID}),
+              UnorderedElementsAre("ns::abc", "other::xyz"));
+
+  RefsRequest RefsReq;
+  RefsReq.IDs.insert(ABC);
+  std::vector<std::string> Files;
+  Client->refs(RefsReq, [&](const Ref &R) {
+    Files.push_back(R.Location.FileURI);
+  });
+  EXPECT_THAT(Files, ElementsAre("unittest:///foo.cc"));
+}
+
+TEST_F(RemoteIndexTest, CachesAndBatches) {
+  serve(MemIndex::build(generateSymbols({"a", "b", "c"}), RefSlab(),
+                        RelationSlab()));
+  SymbolID A = symbol("a").ID, B = symbol("b").ID, C = symbol("c").ID;
+
+  EXPECT_THAT(lookup(*Client, {A}), ElementsAre("a"));
+  EXPECT_EQ(requests(), 1);
+  // Only b and c are requested, together.
+  EXPECT_THAT(lookup(*Client, {A, B, C}), UnorderedElementsAre("a", "b", "c"));
+  EXPECT_EQ(requests(), 2);
+  EXPECT_THAT(lookup(*Client, {C, B}), UnorderedElementsAre("b", "c"));
+  EXPECT_EQ(requests(), 2);
+
+  FuzzyFindRequest Req;
+  Req.Query = "a";
+  Req.AnyScope = true;
+  EXPECT_THAT(match(*Client, Req), ElementsAre("a"));
+  EXPECT_THAT(match(*Client, Req), ElementsAre("a"));
+  EXPECT_EQ(requests(), 3);
+
+  // Missing symbols are cached too.
+  SymbolID D = symbol("d").ID;
+  EXPECT_THAT(lookup(*Client, {D}), IsEmpty());
+  EXPECT_THAT(lookup(*Client, {D}), IsEmpty());
+  EXPECT_EQ(requests(), 4);
+}
+
+TEST_F(RemoteIndexTest, ManyResults) {
+  serve(MemIndex::build(generateNumSymbols(1, 1000), RefSlab(),
+                        RelationSlab()));
+  FuzzyFindRequest Req;
+  Req.AnyScope = true;
+  EXPECT_EQ(match(*Client, Req).size(), 1000u);
+}
+
+TEST_F(RemoteIndexTest, Disconnected) {
+  serve(MemIndex::build(generateSymbols({"a"}), RefSlab(), RelationSlab()));
+  disconnect();
+  EXPECT_THAT(lookup(*Client, {symbol("a").ID}), IsEmpty());
+  FuzzyFindRequest Req;
+  Req.AnyScope = true;
+  EXPECT_THAT(match(*Client, Req), IsEmpty());
+}
+
+} // namespace
+} // namespace clangd
+} // namespace clang
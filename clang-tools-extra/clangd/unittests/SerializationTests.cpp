@@ -9,6 +9,7 @@
 #include "Headers.h"
 #include "index/Index.h"
 #include "index/Serialization.h"
+#include "index/dex/Dex.h"
 #include "clang/Tooling/CompilationDatabase.h"
 #include "llvm/Support/ScopedPrinter.h"
 #include "gmock/gmock.h"
@@ -270,6 +271,54 @@ TEST(SerializationTest, CmdlTest) {
     EXPECT_NE(SerializedCmd.Output, Cmd.Output);
   }
 }
+
+TEST(SerializationTest, PostingListsTest) {
+  auto In = readIndexFile(YAML);
+  ASSERT_TRUE(bool(In)) << In.takeError();
+  std::vector<const Symbol *> Symbols;
+  for (const auto &Sym : *In->Symbols)
+    Symbols.push_back(&Sym);
+  dex::PostingLists Postings = dex::buildPostingLists(Symbols);
+
+  IndexFileOut Out(*In);
+  Out.Format = IndexFileFormat::RIFF;
+  Out.Postings = &Postings;
+  std::string Serialized = llvm::to_string(Out);
+
+  auto In2 = readIndexFile(Serialized);
+  ASSERT_TRUE(bool(In2)) << In2.takeError();
+  ASSERT_TRUE(In2->Symbols);
+  ASSERT_TRUE(In2->Postings);
+  EXPECT_EQ(In2->Postings->Order, Postings.Order);
+  ASSERT_EQ(In2->Postings->Lists.size(), Postings.Lists.size());
+  for (size_t I = 0; I < Postings.Lists.size(); ++I) {
+    const auto &Expected = Postings.Lists[I];
+    const auto &Actual = In2->Postings->Lists[I];
+    EXPECT_EQ(Actual.first, Expected.first);
+    ASSERT_EQ(Actual.second.chunks().size(), Expected.second.chunks().size());
+    for (size_t J = 0; J < Expected.second.chunks().size(); ++J)
+      EXPECT_EQ(Actual.second.chunks()[J].decompress(),
+                Expected.second.chunks()[J].decompress());
+  }
+
+  auto Index = dex::Dex::build(std::move(*In2->Symbols), RefSlab(),
+                               RelationSlab(), std::move(*In2->Postings));
+  FuzzyFindRequest Req;
+  Req.Query = "Foo";
+  Req.AnyScope = true;
+  std::vector<std::string> Matches;
+  Index->fuzzyFind(Req, [&](const Symbol &Sym) {
+    Matches.push_back((Sym.Scope + Sym.Name).str());
+  });
+  EXPECT_THAT(Matches, UnorderedElementsAre("clang::Foo1", "clang::Foo2"));
+
+  // Lists that don't match the symbols are rejected.
+  Postings.Order[0] = Postings.Order[1];
+  auto Bad = readIndexFile(llvm::to_string(Out));
+  EXPECT_FALSE(bool(Bad));
+  llvm::consumeError(Bad.takeError());
+}
+
 } // namespace
 } // namespace clangd
 } // namespace clang
@@ -513,6 +513,86 @@ TEST_F(TUSchedulerTests, EvictedAST) {
               UnorderedElementsAre(Foo, AnyOf(Bar, Baz)));
 }
 
+TEST_F(TUSchedulerTests, EvictedASTOverByteBudget) {
+  ASTRetentionPolicy Policy;
+  Policy.MaxRetainedASTs = 3;
+  // Every AST is larger than that, so only the most recent one is retained.
+  Policy.MaxRetainedASTBytes = 1;
+  TUScheduler S(CDB,
+                /*AsyncThreadsCount=*/1, /*StorePreambleInMemory=*/true,
+                /*ASTCallbacks=*/nullptr,
+                /*UpdateDebounce=*/std::chrono::steady_clock::duration::zero(),
+                Policy);
+
+  llvm::StringLiteral SourceContents = R"cpp(
+    int* a;
+    double* b = a;
+  )cpp";
+
+  auto Foo = testPath("foo.cpp");
+  auto Bar = testPath("bar.cpp");
+
+  S.update(Foo, getInputs(Foo, SourceContents), WantDiagnostics::Yes);
+  ASSERT_TRUE(S.blockUntilIdle(timeoutSeconds(10)));
+  ASSERT_THAT(S.getFilesWithCachedAST(), ElementsAre(Foo));
+
+  S.update(Bar, getInputs(Bar, SourceContents), WantDiagnostics::Yes);
+  ASSERT_TRUE(S.blockUntilIdle(timeoutSeconds(10)));
+  EXPECT_THAT(S.getFilesWithCachedAST(), ElementsAre(Bar));
+}
+
+TEST_F(TUSchedulerTests, RetainedPreamble) {
+  class CountPreambles : public ParsingCallbacks {
+  public:
+    CountPreambles(std::atomic<int> &Count) : Count(Count) {}
+
+    void onPreambleAST(PathRef Path, ASTContext &Ctx,
+                       std::shared_ptr<clang::Preprocessor> PP,
+                       const CanonicalIncludes &) override {
+      ++Count;
+    }
+
+  private:
+    std::atomic<int> &Count;
+  };
+
+  std::atomic<int> BuiltPreambleCounter(0);
+  ASTRetentionPolicy Policy;
+  Policy.MaxRetainedPreambleBytes = 1 << 30;
+  TUScheduler S(CDB,
+                /*AsyncThreadsCount=*/1, /*StorePreambleInMemory=*/true,
+                std::make_unique<CountPreambles>(BuiltPreambleCounter),
+                /*UpdateDebounce=*/std::chrono::steady_clock::duration::zero(),
+                Policy);
+
+  auto Foo = testPath("foo.cpp");
+  auto Header = testPath("foo.h");
+
+  Files[Header] = "void foo();";
+  Timestamps[Header] = time_t(0);
+  auto Contents = R"cpp(
+    #include "foo.h"
+    int main() { foo(); }
+  )cpp";
+  S.update(Foo, getInputs(Foo, Contents), WantDiagnostics::Yes);
+  ASSERT_TRUE(S.blockUntilIdle(timeoutSeconds(10)));
+  ASSERT_EQ(BuiltPreambleCounter.load(), 1);
+
+  // Reopening the file reuses the preamble it had when it was closed.
+  S.remove(Foo);
+  S.update(Foo, getInputs(Foo, Contents), WantDiagnostics::Yes);
+  ASSERT_TRUE(S.blockUntilIdle(timeoutSeconds(10)));
+  EXPECT_EQ(BuiltPreambleCounter.load(), 1);
+
+  // The retained preamble is discarded if the header changed in the meantime.
+  S.remove(Foo);
+  Files[Header] = "void foo(); void bar();";
+  Timestamps[Header] = time_t(1);
+  S.update(Foo, getInputs(Foo, Contents), WantDiagnostics::Yes);
+  ASSERT_TRUE(S.blockUntilIdle(timeoutSeconds(10)));
+  EXPECT_EQ(BuiltPreambleCounter.load(), 2);
+}
+
 TEST_F(TUSchedulerTests, EmptyPreamble) {
   TUScheduler S(CDB,
                 /*AsyncThreadsCount=*/4, /*StorePreambleInMemory=*/true,
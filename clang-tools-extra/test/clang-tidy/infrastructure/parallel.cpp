@@ -0,0 +1,8 @@
+// RUN: clang-tidy -j 2 -checks='-*,google-explicit-constructor' %s %s -- 2>&1 | FileCheck -implicit-check-not='{{warning:|error:}}' %s
+// RUN: not clang-tidy -j 2 -vfsoverlay=%t.yaml -checks='-*,google-explicit-constructor' %s -- 2>&1 | FileCheck -check-prefix=CHECK-VFS %s
+
+// The two runs on the same file report the warning once.
+struct A { A(int); };
+// CHECK: :[[@LINE-1]]:12: warning: single-argument constructors must be marked explicit
+
+// CHECK-VFS: Error: -j cannot be combined with -vfsoverlay.
@@ -2544,7 +2544,7 @@ public:
     Profile(ID, getElementType());
   }
 
-  static void Profile(llvm::FoldingSetNodeID &ID, QualType Element) {
+  template <typename IDT> static void Profile(IDT &ID, QualType Element) {
     ID.AddPointer(Element.getAsOpaquePtr());
   }
 
@@ -2620,7 +2620,7 @@ public:
     Profile(ID, getPointeeType());
   }
 
-  static void Profile(llvm::FoldingSetNodeID &ID, QualType Pointee) {
+  template <typename IDT> static void Profile(IDT &ID, QualType Pointee) {
     ID.AddPointer(Pointee.getAsOpaquePtr());
   }
 
@@ -2708,8 +2708,8 @@ public:
       Profile(ID, getPointeeType());
   }
 
-  static void Profile(llvm::FoldingSetNodeID &ID, QualType Pointee) {
-      ID.AddPointer(Pointee.getAsOpaquePtr());
+  template <typename IDT> static void Profile(IDT &ID, QualType Pointee) {
+    ID.AddPointer(Pointee.getAsOpaquePtr());
   }
 
   static bool classof(const Type *T) {
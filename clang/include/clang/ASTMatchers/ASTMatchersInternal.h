@@ -178,6 +178,10 @@ public:
     return NodeMap < Other.NodeMap;
   }
 
+  bool operator==(const BoundNodesMap &Other) const {
+    return NodeMap == Other.NodeMap;
+  }
+
   /// A map from IDs to the bound nodes.
   ///
   /// Note that we're using std::map here, as for memoization:
@@ -250,6 +254,10 @@ public:
     return Bindings < Other.Bindings;
   }
 
+  bool operator==(const BoundNodesTreeBuilder &Other) const {
+    return Bindings == Other.Bindings;
+  }
+
   /// Returns \c true if this \c BoundNodesTreeBuilder can be compared,
   /// i.e. all stored node maps have memoization data.
   bool isComparable() const {
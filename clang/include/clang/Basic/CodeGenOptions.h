@@ -196,6 +196,10 @@ public:
   /// Output filename for the split debug info, not used in the skeleton CU.
   std::string SplitDwarfOutput;
 
+  /// The output file, after which the files of the other partitions are named
+  /// when ParallelCodeGen is greater than one.
+  std::string ParallelCodeGenOutput;
+
   /// The name of the relocation model to use.
   llvm::Reloc::Model RelocationModel;
 
@@ -21,6 +21,7 @@
 #include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/ADT/StringMap.h"
 #include "llvm/Support/Error.h"
+#include "llvm/Support/MemoryBuffer.h"
 
 namespace clang {
 class CompilerInstance;
@@ -276,6 +277,8 @@ private:
     llvm::Error ensureCTUIndexLoaded(StringRef CrossTUDir, StringRef IndexName);
     llvm::Expected<ASTUnit *> getASTUnitForFile(StringRef FileName,
                                                 bool DisplayCTUProgress);
+    /// Returns the path of the AST file \p FileName named in the index.
+    std::string getASTFilePath(StringRef FileName) const;
 
     template <typename... T> using BaseMapTy = llvm::StringMap<T...>;
     using OwningMapTy = BaseMapTy<std::unique_ptr<clang::ASTUnit>>;
@@ -284,8 +287,14 @@ private:
     OwningMapTy FileASTUnitMap;
     NonOwningMapTy NameASTUnitMap;
 
-    using IndexMapTy = BaseMapTy<std::string>;
+    /// The index file, mapped into memory.
+    std::unique_ptr<llvm::MemoryBuffer> IndexBuffer;
+    /// Maps lookup names to the AST file names in the index. The strings
+    /// point into IndexBuffer.
+    using IndexMapTy = BaseMapTy<StringRef>;
     IndexMapTy NameFileMap;
+    /// The directory the AST file names in the index are relative to.
+    std::string IndexCTUDir;
 
     ASTFileLoader FileAccessor;
 
@@ -238,6 +238,18 @@ class HeaderSearch {
   /// whether they were valid or not.
   llvm::DenseMap<const FileEntry *, bool> LoadedModuleMaps;
 
+  /// The lowercased names of the entries of a search directory.
+  struct DirListing {
+    /// False if the directory couldn't be listed.
+    bool Valid = false;
+    llvm::StringSet<> Names;
+  };
+
+  /// The listings of the search directories looked into so far, under
+  /// -fcache-search-dir-listings.
+  llvm::DenseMap<const DirectoryEntry *, std::unique_ptr<DirListing>>
+      DirListings;
+
   /// Uniqued set of framework names, which is used to track which
   /// headers were included as framework headers.
   llvm::StringSet<llvm::BumpPtrAllocator> FrameworkNames;
@@ -647,6 +659,16 @@ private:
                           Module *RequestingModule,
                           ModuleMap::KnownHeader *SuggestedModule);
 
+  /// Checks whether the search directory \p Dir may contain \p Filename.
+  ///
+  /// \return \c false only if the listing of \p Dir shows that the file
+  ///         doesn't exist, so looking it up can be skipped.
+  bool mayContainFile(const DirectoryEntry *Dir, StringRef Filename);
+
+  /// Lists the entries of a search directory, or reads the listing saved by
+  /// an earlier compilation if the directory wasn't modified since.
+  std::unique_ptr<DirListing> loadDirListing(const DirectoryEntry *Dir);
+
 public:
   /// Retrieve the module map.
   ModuleMap &getModuleMap() { return ModMap; }
@@ -110,6 +110,10 @@ public:
   /// The directory used for the module cache.
   std::string ModuleCachePath;
 
+  /// The directory where the listings of search directories are saved, to be
+  /// reused by later compilations. Implies \c CacheSearchDirListings.
+  std::string SearchDirListingsCachePath;
+
   /// The directory used for a user build.
   std::string ModuleUserBuildPath;
 
@@ -202,6 +206,14 @@ public:
 
   unsigned ModulesHashContent : 1;
 
+  /// Whether to read the pages of loaded module files on a background thread,
+  /// so that deserialization rarely waits for them to be paged in.
+  unsigned ModulesPrefetch : 1;
+
+  /// Whether to list each search directory once, and resolve the lookups of
+  /// names that are not in the listing without querying the file system.
+  unsigned CacheSearchDirListings : 1;
+
   HeaderSearchOptions(StringRef _Sysroot = "/")
       : Sysroot(_Sysroot), ModuleFormat("raw"), DisableModuleHash(false),
         ImplicitModuleMaps(false), ModuleMapFileHomeIsCwd(false),
@@ -209,7 +221,8 @@ public:
         UseStandardCXXIncludes(true), UseLibcxx(false), Verbose(false),
         ModulesValidateOncePerBuildSession(false),
         ModulesValidateSystemHeaders(false), UseDebugInfo(false),
-        ModulesValidateDiagnosticOptions(true), ModulesHashContent(false) {}
+        ModulesValidateDiagnosticOptions(true), ModulesHashContent(false),
+        ModulesPrefetch(false), CacheSearchDirListings(false) {}
 
   /// AddPath - Add the \p Path path to the specified \p Group list.
   void AddPath(StringRef Path, frontend::IncludeDirGroup Group,
@@ -793,6 +793,7 @@ private:
   unsigned NumTokenPaste = 0;
   unsigned NumFastTokenPaste = 0;
   unsigned NumSkipped = 0;
+  unsigned NumSkippedFromCache = 0;
 
   /// The predefined macros that preprocessor should use from the
   /// command line etc.
@@ -2328,10 +2329,20 @@ private:
   Optional<unsigned>
   getSkippedRangeForExcludedConditionalBlock(SourceLocation HashLoc);
 
+  /// Remember that the excluded conditional block starting at the directive
+  /// at \p HashLoc ends at the directive at \p NextHashLoc.
+  void cacheSkippedRange(SourceLocation HashLoc, SourceLocation NextHashLoc);
+
   /// Contains the currently active skipped range mappings for skipping excluded
   /// conditional directives.
   ExcludedPreprocessorDirectiveSkipMapping
       *ExcludedConditionalDirectiveSkipMappings;
+
+  /// The excluded conditional blocks skipped so far in each buffer, so that
+  /// they are skipped without being lexed when the buffer is entered again
+  /// (e.g. a header included several times with different macros defined).
+  llvm::DenseMap<const llvm::MemoryBuffer *, PreprocessorSkippedRangeMapping>
+      SkippedRangesCache;
 };
 
 /// Abstract base class that describes a handler that will receive
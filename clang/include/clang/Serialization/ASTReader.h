@@ -62,6 +62,7 @@
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Timer.h"
 #include "llvm/Support/VersionTuple.h"
+#include <atomic>
 #include <cassert>
 #include <cstddef>
 #include <cstdint>
@@ -70,6 +71,7 @@
 #include <memory>
 #include <set>
 #include <string>
+#include <thread>
 #include <utility>
 #include <vector>
 
@@ -440,6 +442,13 @@ private:
   /// The module manager which manages modules and their dependencies
   ModuleManager ModuleMgr;
 
+  /// Threads that fault in the pages of module files that were just loaded,
+  /// see HeaderSearchOptions::ModulesPrefetch.
+  std::vector<std::thread> PrefetchThreads;
+
+  /// Tells the prefetch threads to stop, as the module files go away.
+  std::atomic<bool> StopPrefetching{false};
+
   /// A dummy identifier resolver used to merge TU-scope declarations in
   /// C, for the cases where we don't have a Sema object to provide a real
   /// identifier resolver.
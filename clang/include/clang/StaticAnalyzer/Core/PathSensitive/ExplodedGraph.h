@@ -329,6 +329,10 @@ protected:
   /// A list of recently allocated nodes that can potentially be recycled.
   NodeVector ChangedNodes;
 
+  /// Nodes from the previous round of reclamation which were not recycled
+  /// only because they had no successor yet.
+  NodeVector FrontierNodes;
+
   /// A list of nodes that can be reused.
   NodeVector FreeNodes;
 
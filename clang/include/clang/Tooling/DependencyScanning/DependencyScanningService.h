@@ -10,8 +10,14 @@
 #define LLVM_CLANG_TOOLING_DEPENDENCY_SCANNING_SERVICE_H
 
 #include "clang/Tooling/DependencyScanning/DependencyScanningFilesystem.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include <mutex>
 
 namespace clang {
+
+class InMemoryModuleCache;
+
 namespace tooling {
 namespace dependencies {
 
@@ -30,12 +36,33 @@ enum class ScanningMode {
   MinimizedSourcePreprocessing
 };
 
+/// The implicitly built modules that were successfully loaded by any of the
+/// workers, so that other compiler invocations don't have to read them from
+/// the module cache on disk again.
+///
+/// Only modules that the in-memory cache of an invocation considers final are
+/// shared. The others may still be dropped and rebuilt by that invocation.
+class DependencyScanningModuleCache {
+public:
+  /// Makes the shared modules available to a new compiler invocation.
+  void addTo(InMemoryModuleCache &Cache);
+
+  /// Shares the modules among \p FileNames that are final in \p Cache.
+  void addFrom(const InMemoryModuleCache &Cache,
+               ArrayRef<std::string> FileNames);
+
+private:
+  std::mutex Lock;
+  llvm::StringMap<std::unique_ptr<llvm::MemoryBuffer>> PCMs;
+};
+
 /// The dependency scanning service contains the shared state that is used by
 /// the invidual dependency scanning workers.
 class DependencyScanningService {
 public:
   DependencyScanningService(ScanningMode Mode, bool ReuseFileManager = true,
-                            bool SkipExcludedPPRanges = true);
+                            bool SkipExcludedPPRanges = true,
+                            bool ShareModules = true);
 
   ScanningMode getMode() const { return Mode; }
 
@@ -47,6 +74,12 @@ public:
     return SharedCache;
   }
 
+  /// Returns the modules shared between workers, or null if the workers
+  /// shouldn't share modules.
+  DependencyScanningModuleCache *getSharedModuleCache() {
+    return ShareModules ? &SharedModuleCache : nullptr;
+  }
+
 private:
   const ScanningMode Mode;
   const bool ReuseFileManager;
@@ -54,8 +87,11 @@ private:
   /// ranges by bumping the buffer pointer in the lexer instead of lexing the
   /// tokens in the range until reaching the corresponding directive.
   const bool SkipExcludedPPRanges;
+  const bool ShareModules;
   /// The global file system cache.
   DependencyScanningFilesystemSharedCache SharedCache;
+  /// The global cache of built modules.
+  DependencyScanningModuleCache SharedModuleCache;
 };
 
 } // end namespace dependencies
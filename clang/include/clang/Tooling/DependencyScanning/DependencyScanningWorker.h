@@ -15,6 +15,7 @@
 #include "clang/Frontend/PCHContainerOperations.h"
 #include "clang/Lex/PreprocessorExcludedConditionalDirectiveSkipMapping.h"
 #include "clang/Tooling/CompilationDatabase.h"
+#include "llvm/ADT/STLExtras.h"
 #include "llvm/Support/Error.h"
 #include "llvm/Support/FileSystem.h"
 #include <string>
@@ -26,6 +27,7 @@ class DependencyOutputOptions;
 namespace tooling {
 namespace dependencies {
 
+class DependencyScanningModuleCache;
 class DependencyScanningService;
 class DependencyScanningWorkerFilesystem;
 
@@ -73,8 +75,22 @@ private:
   /// The file manager that is reused accross multiple invocations by this
   /// worker. If null, the file manager will not be reused.
   llvm::IntrusiveRefCntPtr<FileManager> Files;
+  /// The modules shared with the other workers, or null.
+  DependencyScanningModuleCache *SharedModules;
 };
 
+/// Scans \p NumInputs inputs on \p NumWorkers threads (or one per hardware
+/// thread if zero), each with its own worker sharing \p Service.
+///
+/// Workers take the next input to scan as soon as they are done with the
+/// previous one, so that a few slow inputs don't hold up the others. \p Scan
+/// is called with the worker to use and the index of the input to scan, and
+/// must be safe to call from several threads at once.
+void scanInParallel(
+    DependencyScanningService &Service, size_t NumInputs, unsigned NumWorkers,
+    llvm::function_ref<void(DependencyScanningWorker &Worker, size_t Index)>
+        Scan);
+
 } // end namespace dependencies
 } // end namespace tooling
 } // end namespace clang
@@ -2915,12 +2915,15 @@ void ASTContext::adjustExceptionSpec(
 /// number with the specified element type.
 QualType ASTContext::getComplexType(QualType T) const {
   // Unique pointers, to guarantee there is only one pointer of a particular
-  // structure.
-  llvm::FoldingSetNodeID ID;
-  ComplexType::Profile(ID, T);
+  // structure. Compare the element types directly rather than building the
+  // FoldingSetNodeIDs of the types.
+  llvm::FoldingSetNodeIDHasher Hash;
+  ComplexType::Profile(Hash, T);
+  auto Matches = [&](ComplexType &CT) { return CT.getElementType() == T; };
 
   void *InsertPos = nullptr;
-  if (ComplexType *CT = ComplexTypes.FindNodeOrInsertPos(ID, InsertPos))
+  if (ComplexType *CT =
+          ComplexTypes.FindNodeOrInsertPos(Hash, Matches, InsertPos))
     return QualType(CT, 0);
 
   // If the pointee type isn't canonical, this won't be a canonical type either,
@@ -2930,7 +2933,8 @@ QualType ASTContext::getComplexType(QualType T) const {
     Canonical = getComplexType(getCanonicalType(T));
 
     // Get the new insert position for the node we care about.
-    ComplexType *NewIP = ComplexTypes.FindNodeOrInsertPos(ID, InsertPos);
+    ComplexType *NewIP =
+        ComplexTypes.FindNodeOrInsertPos(Hash, Matches, InsertPos);
     assert(!NewIP && "Shouldn't be in the map!"); (void)NewIP;
   }
   auto *New = new (*this, TypeAlignment) ComplexType(T, Canonical);
@@ -2943,12 +2947,15 @@ QualType ASTContext::getComplexType(QualType T) const {
 /// the specified type.
 QualType ASTContext::getPointerType(QualType T) const {
   // Unique pointers, to guarantee there is only one pointer of a particular
-  // structure.
-  llvm::FoldingSetNodeID ID;
-  PointerType::Profile(ID, T);
+  // structure. Compare the pointee types directly rather than building the
+  // FoldingSetNodeIDs of the types.
+  llvm::FoldingSetNodeIDHasher Hash;
+  PointerType::Profile(Hash, T);
+  auto Matches = [&](PointerType &PT) { return PT.getPointeeType() == T; };
 
   void *InsertPos = nullptr;
-  if (PointerType *PT = PointerTypes.FindNodeOrInsertPos(ID, InsertPos))
+  if (PointerType *PT =
+          PointerTypes.FindNodeOrInsertPos(Hash, Matches, InsertPos))
     return QualType(PT, 0);
 
   // If the pointee type isn't canonical, this won't be a canonical type either,
@@ -2958,7 +2965,8 @@ QualType ASTContext::getPointerType(QualType T) const {
     Canonical = getPointerType(getCanonicalType(T));
 
     // Get the new insert position for the node we care about.
-    PointerType *NewIP = PointerTypes.FindNodeOrInsertPos(ID, InsertPos);
+    PointerType *NewIP =
+        PointerTypes.FindNodeOrInsertPos(Hash, Matches, InsertPos);
     assert(!NewIP && "Shouldn't be in the map!"); (void)NewIP;
   }
   auto *New = new (*this, TypeAlignment) PointerType(T, Canonical);
@@ -3032,13 +3040,15 @@ QualType ASTContext::getDecayedType(QualType T) const {
 QualType ASTContext::getBlockPointerType(QualType T) const {
   assert(T->isFunctionType() && "block of function types only");
   // Unique pointers, to guarantee there is only one block of a particular
-  // structure.
-  llvm::FoldingSetNodeID ID;
-  BlockPointerType::Profile(ID, T);
+  // structure. Compare the pointee types directly rather than building the
+  // FoldingSetNodeIDs of the types.
+  llvm::FoldingSetNodeIDHasher Hash;
+  BlockPointerType::Profile(Hash, T);
+  auto Matches = [&](BlockPointerType &PT) { return PT.getPointeeType() == T; };
 
   void *InsertPos = nullptr;
   if (BlockPointerType *PT =
-        BlockPointerTypes.FindNodeOrInsertPos(ID, InsertPos))
+        BlockPointerTypes.FindNodeOrInsertPos(Hash, Matches, InsertPos))
     return QualType(PT, 0);
 
   // If the block pointee type isn't canonical, this won't be a canonical
@@ -3049,7 +3059,7 @@ QualType ASTContext::getBlockPointerType(QualType T) const {
 
     // Get the new insert position for the node we care about.
     BlockPointerType *NewIP =
-      BlockPointerTypes.FindNodeOrInsertPos(ID, InsertPos);
+      BlockPointerTypes.FindNodeOrInsertPos(Hash, Matches, InsertPos);
     assert(!NewIP && "Shouldn't be in the map!"); (void)NewIP;
   }
   auto *New = new (*this, TypeAlignment) BlockPointerType(T, Canonical);
@@ -56,6 +56,7 @@
 #include "llvm/ADT/Optional.h"
 #include "llvm/ADT/SmallBitVector.h"
 #include "llvm/Support/SaveAndRestore.h"
+#include "llvm/Support/TimeProfiler.h"
 #include "llvm/Support/raw_ostream.h"
 
 #define DEBUG_TYPE "exprconstant"
@@ -975,7 +976,7 @@ namespace {
       return {nullptr, 0};
     }
 
-    bool nextStep(const Stmt *S) {
+    bool nextStep(const Stmt *S) override {
       if (!StepsLeft) {
         FFDiag(S->getBeginLoc(), diag::note_constexpr_step_limit_exceeded);
         return false;
@@ -13559,6 +13560,10 @@ bool Expr::EvaluateAsConstantExpr(EvalResult &Result, ConstExprUsage Usage,
   assert(!isValueDependent() &&
          "Expression evaluator can't be called on a dependent expression.");
 
+  llvm::TimeTraceScope TimeScope("EvaluateAsConstantExpr", [&]() {
+    return getExprLoc().printToString(Ctx.getSourceManager());
+  });
+
   EvalInfo::EvaluationMode EM = EvalInfo::EM_ConstantExpression;
   EvalInfo Info(Ctx, Result, EM);
   Info.InConstantContext = true;
@@ -13586,6 +13591,13 @@ bool Expr::EvaluateAsInitializer(APValue &Value, const ASTContext &Ctx,
       !Ctx.getLangOpts().CPlusPlus11)
     return false;
 
+  llvm::TimeTraceScope TimeScope("EvaluateAsInitializer", [&]() {
+    std::string Name;
+    llvm::raw_string_ostream OS(Name);
+    VD->printQualifiedName(OS);
+    return Name;
+  });
+
   Expr::EvalStatus EStatus;
   EStatus.Diag = &Notes;
 
@@ -86,6 +86,12 @@ private:
 } // namespace interp
 } // namespace clang
 
+template <class Emitter>
+bool ByteCodeExprGen<Emitter>::VisitExpr(const Expr *E) {
+  // Unsupported expressions are left to the AST walker.
+  return this->bail(E);
+}
+
 template <class Emitter>
 bool ByteCodeExprGen<Emitter>::VisitCastExpr(const CastExpr *CE) {
   auto *SubExpr = CE->getSubExpr();
@@ -118,6 +124,21 @@ bool ByteCodeExprGen<Emitter>::VisitCastExpr(const CastExpr *CE) {
   case CK_ToVoid:
     return discard(SubExpr);
 
+  case CK_IntegralCast:
+  case CK_IntegralToBoolean: {
+    Optional<PrimType> FromT = classify(SubExpr->getType());
+    Optional<PrimType> ToT = classify(CE->getType());
+    if (!FromT || !ToT || *FromT == PT_Ptr || *ToT == PT_Ptr)
+      return this->bail(CE);
+    if (DiscardResult)
+      return discard(SubExpr);
+    if (!visit(SubExpr))
+      return false;
+    if (*FromT == *ToT)
+      return true;
+    return this->emitCast(*FromT, *ToT, CE);
+  }
+
   default: {
     // TODO: implement other casts.
     return this->bail(CE);
@@ -137,11 +158,154 @@ bool ByteCodeExprGen<Emitter>::VisitIntegerLiteral(const IntegerLiteral *LE) {
   return this->bail(LE);
 }
 
+template <class Emitter>
+bool ByteCodeExprGen<Emitter>::VisitCXXBoolLiteralExpr(
+    const CXXBoolLiteralExpr *LE) {
+  if (DiscardResult)
+    return true;
+  return this->emitConstBool(LE->getValue(), LE);
+}
+
 template <class Emitter>
 bool ByteCodeExprGen<Emitter>::VisitParenExpr(const ParenExpr *PE) {
   return this->Visit(PE->getSubExpr());
 }
 
+template <class Emitter>
+bool ByteCodeExprGen<Emitter>::VisitDeclRefExpr(const DeclRefExpr *DE) {
+  const ValueDecl *D = DE->getDecl();
+  if (auto *ECD = dyn_cast<EnumConstantDecl>(D)) {
+    if (DiscardResult)
+      return true;
+    if (Optional<PrimType> T = classify(DE->getType()))
+      return emitConst(*T, getIntWidth(DE->getType()), ECD->getInitVal(), DE);
+    return this->bail(DE);
+  }
+
+  // Other declarations produce a pointer, which is only dereferenced here if
+  // that could not be done directly on the variable.
+  if (D->getType()->isReferenceType())
+    return this->bail(DE);
+  if (DiscardResult)
+    return true;
+  auto It = Locals.find(D);
+  if (It != Locals.end())
+    return this->emitGetPtrLocal(It->second.Offset, DE);
+  if (auto *PD = dyn_cast<ParmVarDecl>(D)) {
+    auto PIt = this->Params.find(PD);
+    if (PIt != this->Params.end())
+      return this->emitGetPtrParam(PIt->second, DE);
+  }
+  if (auto *VD = dyn_cast<VarDecl>(D))
+    return getPtrVarDecl(VD, DE);
+  return this->bail(DE);
+}
+
+template <class Emitter>
+bool ByteCodeExprGen<Emitter>::VisitCXXDefaultArgExpr(
+    const CXXDefaultArgExpr *DE) {
+  return this->Visit(DE->getExpr());
+}
+
+template <class Emitter>
+bool ByteCodeExprGen<Emitter>::VisitUnaryOperator(const UnaryOperator *UO) {
+  const Expr *SubExpr = UO->getSubExpr();
+  switch (UO->getOpcode()) {
+  case UO_PostInc:
+  case UO_PostDec:
+  case UO_PreInc:
+  case UO_PreDec:
+    return visitIncDec(UO);
+  case UO_Plus:
+  case UO_Extension:
+    return this->Visit(SubExpr);
+  case UO_Minus:
+  case UO_Not:
+  case UO_LNot:
+    break;
+  default:
+    return this->bail(UO);
+  }
+
+  Optional<PrimType> T = classify(UO->getType());
+  Optional<PrimType> SubT = classify(SubExpr->getType());
+  if (!T || !SubT || *T == PT_Ptr || *SubT == PT_Ptr)
+    return this->bail(UO);
+
+  auto Discard = [this, T, UO](bool Result) {
+    if (!Result)
+      return false;
+    return DiscardResult ? this->emitPop(*T, UO) : true;
+  };
+
+  switch (UO->getOpcode()) {
+  case UO_Minus:
+    // Negation is subtraction from zero, which diagnoses overflow.
+    if (*SubT != *T)
+      return this->bail(UO);
+    if (!visitZeroInitializer(*T, UO) || !visit(SubExpr))
+      return false;
+    return Discard(this->emitSub(*T, UO));
+  case UO_Not: {
+    if (*SubT != *T)
+      return this->bail(UO);
+    unsigned NumBits = getIntWidth(UO->getType());
+    if (!visit(SubExpr))
+      return false;
+    if (!emitConst(*T, NumBits, APInt::getAllOnesValue(NumBits), UO))
+      return false;
+    return Discard(this->emitBitXor(*T, UO));
+  }
+  case UO_LNot:
+    if (!visit(SubExpr) || !visitZeroInitializer(*SubT, UO))
+      return false;
+    if (!this->emitEQ(*SubT, UO))
+      return false;
+    if (*T != PT_Bool && !this->emitCast(PT_Bool, *T, UO))
+      return false;
+    return Discard(true);
+  default:
+    llvm_unreachable("unexpected unary operator");
+  }
+}
+
+template <class Emitter>
+bool ByteCodeExprGen<Emitter>::visitIncDec(const UnaryOperator *UO) {
+  const Expr *SubExpr = UO->getSubExpr();
+  Optional<PrimType> T = classify(SubExpr->getType());
+  if (!T || *T == PT_Ptr || *T == PT_Bool || !isLocalLValue(SubExpr))
+    return this->bail(UO);
+
+  // Promotable types are updated in int, so they wrap instead of overflowing.
+  if (SubExpr->getType()->isPromotableIntegerType())
+    return this->bail(UO);
+
+  // In C, the result of a prefix operator is not an lvalue.
+  if (!DiscardResult && UO->isPrefix() && !UO->isGLValue())
+    return this->bail(UO);
+
+  const bool IsInc = UO->isIncrementOp();
+  if (UO->isPostfix() && !DiscardResult) {
+    // The opcodes update the variable and leave the old value on the stack.
+    if (!visit(SubExpr))
+      return false;
+    return IsInc ? this->emitInc(*T, UO) : this->emitDec(*T, UO);
+  }
+
+  auto Update = [this, SubExpr, UO, IsInc](PrimType T) {
+    if (!emitConst(SubExpr, 1))
+      return false;
+    return IsInc ? this->emitAdd(T, UO) : this->emitSub(T, UO);
+  };
+  return dereference(SubExpr, DerefKind::ReadWrite, Update,
+                     [this, UO, &Update](PrimType T) {
+                       if (!this->emitLoad(T, UO) || !Update(T))
+                         return false;
+                       return DiscardResult ? this->emitStorePop(T, UO)
+                                            : this->emitStore(T, UO);
+                     });
+}
+
 template <class Emitter>
 bool ByteCodeExprGen<Emitter>::VisitBinaryOperator(const BinaryOperator *BO) {
   const Expr *LHS = BO->getLHS();
@@ -155,6 +319,23 @@ bool ByteCodeExprGen<Emitter>::VisitBinaryOperator(const BinaryOperator *BO) {
     if (!this->Visit(RHS))
       return false;
     return true;
+  case BO_LAnd:
+  case BO_LOr:
+    return visitLogicalOperator(BO);
+  case BO_Assign: {
+    // In C, the result of an assignment is not an lvalue.
+    if (!classify(LHS->getType()) || !isLocalLValue(LHS) ||
+        (!DiscardResult && !BO->isGLValue()))
+      return this->bail(BO);
+    return dereference(
+        LHS, DerefKind::Write, [this, RHS](PrimType) { return visit(RHS); },
+        [this, RHS, BO](PrimType T) {
+          if (!visit(RHS))
+            return false;
+          return DiscardResult ? this->emitStorePop(T, BO)
+                               : this->emitStore(T, BO);
+        });
+  }
   default:
     break;
   }
@@ -191,20 +372,175 @@ bool ByteCodeExprGen<Emitter>::VisitBinaryOperator(const BinaryOperator *BO) {
       return Discard(this->emitGT(*LT, BO));
     case BO_GE:
       return Discard(this->emitGE(*LT, BO));
-    case BO_Sub:
-      return Discard(this->emitSub(*T, BO));
-    case BO_Add:
-      return Discard(this->emitAdd(*T, BO));
-    case BO_Mul:
-      return Discard(this->emitMul(*T, BO));
     default:
-      return this->bail(BO);
+      // Pointer arithmetic is not supported yet.
+      if (*T == PT_Ptr || *LT != *T || *RT != *T)
+        return this->bail(BO);
+      return Discard(emitArith(BO->getOpcode(), *T, BO));
     }
   }
 
   return this->bail(BO);
 }
 
+template <class Emitter>
+bool ByteCodeExprGen<Emitter>::VisitCompoundAssignOperator(
+    const CompoundAssignOperator *CAO) {
+  const Expr *LHS = CAO->getLHS();
+  const Expr *RHS = CAO->getRHS();
+  Optional<PrimType> T = classify(LHS->getType());
+  if (!T || *T == PT_Ptr || *T == PT_Bool || !isLocalLValue(LHS) ||
+      classify(RHS->getType()) != T || (!DiscardResult && !CAO->isGLValue()))
+    return this->bail(CAO);
+
+  // Only operations performed in the type of the variable are supported.
+  ASTContext &ASTCtx = Ctx.getASTContext();
+  if (!ASTCtx.hasSameUnqualifiedType(CAO->getComputationLHSType(),
+                                     LHS->getType()) ||
+      !ASTCtx.hasSameUnqualifiedType(CAO->getComputationResultType(),
+                                     LHS->getType()))
+    return this->bail(CAO);
+
+  BinaryOperatorKind Op =
+      BinaryOperator::getOpForCompoundAssignment(CAO->getOpcode());
+  return dereference(
+      LHS, DerefKind::ReadWrite,
+      [this, RHS, Op, CAO](PrimType T) {
+        return visit(RHS) && emitArith(Op, T, CAO);
+      },
+      [this, RHS, Op, CAO](PrimType T) {
+        if (!this->emitLoad(T, CAO) || !visit(RHS) || !emitArith(Op, T, CAO))
+          return false;
+        return DiscardResult ? this->emitStorePop(T, CAO)
+                             : this->emitStore(T, CAO);
+      });
+}
+
+template <class Emitter>
+bool ByteCodeExprGen<Emitter>::VisitConditionalOperator(
+    const ConditionalOperator *CO) {
+  if (!classify(CO))
+    return this->bail(CO);
+
+  LabelTy LabelFalse = this->getLabel();
+  LabelTy LabelEnd = this->getLabel();
+  if (!visitBool(CO->getCond()))
+    return false;
+  if (!this->jumpFalse(LabelFalse))
+    return false;
+  if (!this->Visit(CO->getTrueExpr()))
+    return false;
+  if (!this->jump(LabelEnd))
+    return false;
+  this->emitLabel(LabelFalse);
+  if (!this->Visit(CO->getFalseExpr()))
+    return false;
+  return this->fallthrough(LabelEnd);
+}
+
+template <class Emitter>
+bool ByteCodeExprGen<Emitter>::VisitCallExpr(const CallExpr *CE) {
+  // Only direct calls to functions taking and returning primitives.
+  const FunctionDecl *FD = CE->getDirectCallee();
+  if (!FD || isa<CXXMethodDecl>(FD) || FD->getBuiltinID() ||
+      FD->isVariadic() || FD->getNumParams() != CE->getNumArgs())
+    return this->bail(CE);
+
+  QualType RetTy = FD->getReturnType();
+  Optional<PrimType> T = classify(RetTy);
+  if (RetTy->isReferenceType() || (!T && !RetTy->isVoidType()))
+    return this->bail(CE);
+  for (const ParmVarDecl *PD : FD->parameters()) {
+    if (PD->getType()->isReferenceType() || !classify(PD->getType()))
+      return this->bail(CE);
+  }
+
+  // Functions which cannot be compiled, including the ones being compiled
+  // when calls are recursive, are left to the AST walker.
+  Expected<Function *> Func = P.getOrCreateFunction(FD);
+  if (!Func) {
+    llvm::consumeError(Func.takeError());
+    return this->bail(CE);
+  }
+  if (!*Func || !(*Func)->isConstexpr())
+    return this->bail(CE);
+
+  for (const Expr *Arg : CE->arguments()) {
+    if (!visit(Arg))
+      return false;
+  }
+  if (!this->emitCall(*Func, CE))
+    return false;
+  return DiscardResult && T ? this->emitPop(*T, CE) : true;
+}
+
+template <class Emitter>
+bool ByteCodeExprGen<Emitter>::visitLogicalOperator(const BinaryOperator *BO) {
+  Optional<PrimType> T = classify(BO->getType());
+  if (!T)
+    return this->bail(BO);
+
+  // The right operand is skipped if the left one determines the result.
+  const bool IsOr = BO->getOpcode() == BO_LOr;
+  LabelTy LabelShort = this->getLabel();
+  LabelTy LabelEnd = this->getLabel();
+  if (!visitBool(BO->getLHS()))
+    return false;
+  if (IsOr ? !this->jumpTrue(LabelShort) : !this->jumpFalse(LabelShort))
+    return false;
+  if (!visitBool(BO->getRHS()))
+    return false;
+  if (!this->jump(LabelEnd))
+    return false;
+  this->emitLabel(LabelShort);
+  if (!this->emitConstBool(IsOr, BO))
+    return false;
+  if (!this->fallthrough(LabelEnd))
+    return false;
+
+  if (*T != PT_Bool && !this->emitCast(PT_Bool, *T, BO))
+    return false;
+  return DiscardResult ? this->emitPop(*T, BO) : true;
+}
+
+template <class Emitter>
+bool ByteCodeExprGen<Emitter>::emitArith(BinaryOperatorKind Op, PrimType T,
+                                         const Expr *E) {
+  switch (Op) {
+  case BO_Add:
+    return this->emitAdd(T, E);
+  case BO_Sub:
+    return this->emitSub(T, E);
+  case BO_Mul:
+    return this->emitMul(T, E);
+  case BO_Div:
+    return this->emitDiv(T, E);
+  case BO_Rem:
+    return this->emitRem(T, E);
+  case BO_And:
+    return this->emitBitAnd(T, E);
+  case BO_Or:
+    return this->emitBitOr(T, E);
+  case BO_Xor:
+    return this->emitBitXor(T, E);
+  default:
+    // TODO: implement shifts.
+    return this->bail(E);
+  }
+}
+
+template <class Emitter>
+bool ByteCodeExprGen<Emitter>::isLocalLValue(const Expr *E) const {
+  auto *DE = dyn_cast<DeclRefExpr>(E->IgnoreParens());
+  if (!DE || DE->getDecl()->getType()->isReferenceType())
+    return false;
+  if (Locals.count(DE->getDecl()))
+    return true;
+  if (auto *PD = dyn_cast<ParmVarDecl>(DE->getDecl()))
+    return this->Params.count(PD);
+  return false;
+}
+
 template <class Emitter>
 bool ByteCodeExprGen<Emitter>::discard(const Expr *E) {
   OptionScope<Emitter> Scope(this, /*discardResult=*/true);
@@ -220,7 +556,14 @@ bool ByteCodeExprGen<Emitter>::visit(const Expr *E) {
 template <class Emitter>
 bool ByteCodeExprGen<Emitter>::visitBool(const Expr *E) {
   if (Optional<PrimType> T = classify(E->getType())) {
-    return visit(E);
+    if (!visit(E))
+      return false;
+    if (*T == PT_Bool)
+      return true;
+    if (*T == PT_Ptr)
+      return this->bail(E);
+    // Integers are tested against zero.
+    return visitZeroInitializer(*T, E) && this->emitNE(*T, E);
   } else {
     return this->bail(E);
   }
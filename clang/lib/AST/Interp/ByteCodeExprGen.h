@@ -66,10 +66,18 @@ public:
       : Emitter(Ctx, P, Args...), Ctx(Ctx), P(P) {}
 
   // Expression visitors - result returned on stack.
+  bool VisitExpr(const Expr *E);
   bool VisitCastExpr(const CastExpr *E);
   bool VisitIntegerLiteral(const IntegerLiteral *E);
+  bool VisitCXXBoolLiteralExpr(const CXXBoolLiteralExpr *E);
   bool VisitParenExpr(const ParenExpr *E);
+  bool VisitDeclRefExpr(const DeclRefExpr *E);
+  bool VisitCXXDefaultArgExpr(const CXXDefaultArgExpr *E);
+  bool VisitUnaryOperator(const UnaryOperator *E);
   bool VisitBinaryOperator(const BinaryOperator *E);
+  bool VisitCompoundAssignOperator(const CompoundAssignOperator *E);
+  bool VisitConditionalOperator(const ConditionalOperator *E);
+  bool VisitCallExpr(const CallExpr *E);
 
 protected:
   bool visitExpr(const Expr *E) override;
@@ -166,6 +174,18 @@ private:
   /// Emits a zero initializer.
   bool visitZeroInitializer(PrimType T, const Expr *E);
 
+  /// Emits an arithmetic or bitwise operation on two values of type T.
+  bool emitArith(BinaryOperatorKind Op, PrimType T, const Expr *E);
+
+  /// Compiles a short-circuiting logical operator.
+  bool visitLogicalOperator(const BinaryOperator *BO);
+
+  /// Compiles the increment or decrement of a variable.
+  bool visitIncDec(const UnaryOperator *UO);
+
+  /// Checks if an lvalue names a local or a parameter which can be modified.
+  bool isLocalLValue(const Expr *E) const;
+
   enum class DerefKind {
     /// Value is read and pushed to stack.
     Read,
@@ -44,19 +44,23 @@ public:
   LoopScope(ByteCodeStmtGen<Emitter> *Ctx, LabelTy BreakLabel,
             LabelTy ContinueLabel)
       : LabelScope<Emitter>(Ctx), OldBreakLabel(Ctx->BreakLabel),
-        OldContinueLabel(Ctx->ContinueLabel) {
+        OldContinueLabel(Ctx->ContinueLabel),
+        OldLoopVarScope(Ctx->LoopVarScope) {
     this->Ctx->BreakLabel = BreakLabel;
     this->Ctx->ContinueLabel = ContinueLabel;
+    this->Ctx->LoopVarScope = Ctx->VarScope;
   }
 
   ~LoopScope() {
     this->Ctx->BreakLabel = OldBreakLabel;
     this->Ctx->ContinueLabel = OldContinueLabel;
+    this->Ctx->LoopVarScope = OldLoopVarScope;
   }
 
 private:
   OptLabelTy OldBreakLabel;
   OptLabelTy OldContinueLabel;
+  VariableScope<Emitter> *OldLoopVarScope;
 };
 
 // Sets the context for a switch scope, mapping labels.
@@ -122,6 +126,16 @@ bool ByteCodeStmtGen<Emitter>::visitStmt(const Stmt *S) {
     return visitReturnStmt(cast<ReturnStmt>(S));
   case Stmt::IfStmtClass:
     return visitIfStmt(cast<IfStmt>(S));
+  case Stmt::WhileStmtClass:
+    return visitWhileStmt(cast<WhileStmt>(S));
+  case Stmt::DoStmtClass:
+    return visitDoStmt(cast<DoStmt>(S));
+  case Stmt::ForStmtClass:
+    return visitForStmt(cast<ForStmt>(S));
+  case Stmt::BreakStmtClass:
+    return visitBreakStmt(cast<BreakStmt>(S));
+  case Stmt::ContinueStmtClass:
+    return visitContinueStmt(cast<ContinueStmt>(S));
   case Stmt::NullStmtClass:
     return true;
   default: {
@@ -226,6 +240,112 @@ bool ByteCodeStmtGen<Emitter>::visitIfStmt(const IfStmt *IS) {
   return true;
 }
 
+template <class Emitter>
+bool ByteCodeStmtGen<Emitter>::visitWhileStmt(const WhileStmt *WS) {
+  if (WS->getConditionVariableDeclStmt())
+    return this->bail(WS);
+
+  LabelTy CondLabel = this->getLabel();
+  LabelTy EndLabel = this->getLabel();
+  LoopScope<Emitter> LS(this, EndLabel, CondLabel);
+
+  // Each iteration counts against the evaluation step limit.
+  this->emitLabel(CondLabel);
+  if (!this->emitStep(WS))
+    return false;
+  if (!this->visitBool(WS->getCond()))
+    return false;
+  if (!this->jumpFalse(EndLabel))
+    return false;
+  if (!visitStmt(WS->getBody()))
+    return false;
+  if (!this->jump(CondLabel))
+    return false;
+  this->emitLabel(EndLabel);
+  return true;
+}
+
+template <class Emitter>
+bool ByteCodeStmtGen<Emitter>::visitDoStmt(const DoStmt *DS) {
+  LabelTy StartLabel = this->getLabel();
+  LabelTy CondLabel = this->getLabel();
+  LabelTy EndLabel = this->getLabel();
+  LoopScope<Emitter> LS(this, EndLabel, CondLabel);
+
+  this->emitLabel(StartLabel);
+  if (!this->emitStep(DS))
+    return false;
+  if (!visitStmt(DS->getBody()))
+    return false;
+  this->emitLabel(CondLabel);
+  if (!this->visitBool(DS->getCond()))
+    return false;
+  if (!this->jumpTrue(StartLabel))
+    return false;
+  this->emitLabel(EndLabel);
+  return true;
+}
+
+template <class Emitter>
+bool ByteCodeStmtGen<Emitter>::visitForStmt(const ForStmt *FS) {
+  if (FS->getConditionVariableDeclStmt())
+    return this->bail(FS);
+
+  // Variables declared in the init statement live until the end of the loop.
+  BlockScope<Emitter> ForScope(this);
+  if (const Stmt *Init = FS->getInit())
+    if (!visitStmt(Init))
+      return false;
+
+  LabelTy CondLabel = this->getLabel();
+  LabelTy IncLabel = this->getLabel();
+  LabelTy EndLabel = this->getLabel();
+  LoopScope<Emitter> LS(this, EndLabel, IncLabel);
+
+  this->emitLabel(CondLabel);
+  if (!this->emitStep(FS))
+    return false;
+  if (const Expr *Cond = FS->getCond()) {
+    if (!this->visitBool(Cond))
+      return false;
+    if (!this->jumpFalse(EndLabel))
+      return false;
+  }
+  if (!visitStmt(FS->getBody()))
+    return false;
+  this->emitLabel(IncLabel);
+  if (const Expr *Inc = FS->getInc())
+    if (!this->discard(Inc))
+      return false;
+  if (!this->jump(CondLabel))
+    return false;
+  this->emitLabel(EndLabel);
+  return true;
+}
+
+template <class Emitter>
+bool ByteCodeStmtGen<Emitter>::visitBreakStmt(const BreakStmt *BS) {
+  if (!BreakLabel)
+    return this->bail(BS);
+  emitLoopCleanup();
+  return this->jump(*BreakLabel);
+}
+
+template <class Emitter>
+bool ByteCodeStmtGen<Emitter>::visitContinueStmt(const ContinueStmt *CS) {
+  if (!ContinueLabel)
+    return this->bail(CS);
+  emitLoopCleanup();
+  return this->jump(*ContinueLabel);
+}
+
+template <class Emitter>
+void ByteCodeStmtGen<Emitter>::emitLoopCleanup() {
+  for (VariableScope<Emitter> *C = this->VarScope; C != LoopVarScope;
+       C = C->getParent())
+    C->emitDestruction();
+}
+
 template <class Emitter>
 bool ByteCodeStmtGen<Emitter>::visitVarDecl(const VarDecl *VD) {
   auto DT = VD->getType();
@@ -235,6 +355,10 @@ bool ByteCodeStmtGen<Emitter>::visitVarDecl(const VarDecl *VD) {
     return true;
   }
 
+  // Uninitialized variables are not supported yet.
+  if (!VD->getInit())
+    return this->bail(VD);
+
   // Integers, pointers, primitives.
   if (Optional<PrimType> T = this->classify(DT)) {
     auto Off = this->allocateLocalPrimitive(VD, *T, DT.isConstQualified());
@@ -62,6 +62,14 @@ private:
   bool visitDeclStmt(const DeclStmt *DS);
   bool visitReturnStmt(const ReturnStmt *RS);
   bool visitIfStmt(const IfStmt *IS);
+  bool visitWhileStmt(const WhileStmt *WS);
+  bool visitDoStmt(const DoStmt *DS);
+  bool visitForStmt(const ForStmt *FS);
+  bool visitBreakStmt(const BreakStmt *BS);
+  bool visitContinueStmt(const ContinueStmt *CS);
+
+  /// Emits the destruction of the scopes left by a jump out of a loop.
+  void emitLoopCleanup();
 
   /// Compiles a variable declaration.
   bool visitVarDecl(const VarDecl *VD);
@@ -77,6 +85,8 @@ private:
   OptLabelTy BreakLabel;
   /// Point to continue to.
   OptLabelTy ContinueLabel;
+  /// Scope enclosing the innermost loop.
+  VariableScope<Emitter> *LoopVarScope = nullptr;
   /// Default case label.
   OptLabelTy DefaultLabel;
 };
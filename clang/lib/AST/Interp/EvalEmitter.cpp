@@ -244,6 +244,22 @@ bool EvalEmitter::emitDestroy(uint32_t I, const SourceInfo &Info) {
   return true;
 }
 
+bool EvalEmitter::emitCall(Function *Func, const SourceInfo &Info) {
+  if (!isActive())
+    return true;
+  CurrentSource = Info;
+
+  if (!CheckCall(S, CodePtr(), Func))
+    return false;
+  ++S.CallStackDepth;
+  S.Current = new InterpFrame(S, Func, S.Current, CodePtr(), {});
+
+  // Run the callee to completion: its return pushes the result and hands
+  // control back to the root frame, which stops the interpreter.
+  APValue Unused;
+  return Interpret(S, Unused);
+}
+
 //===----------------------------------------------------------------------===//
 // Opcode evaluators
 //===----------------------------------------------------------------------===//
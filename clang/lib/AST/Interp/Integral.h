@@ -204,6 +204,33 @@ public:
     return CheckMulUB(A.V, B.V, R->V);
   }
 
+  /// Division and remainder expect a valid divisor, which is neither zero nor
+  /// -1 along with a minimal dividend.
+  static bool div(Integral A, Integral B, unsigned OpBits, Integral *R) {
+    *R = Integral(A.V / B.V);
+    return false;
+  }
+
+  static bool rem(Integral A, Integral B, unsigned OpBits, Integral *R) {
+    *R = Integral(A.V % B.V);
+    return false;
+  }
+
+  static bool bitAnd(Integral A, Integral B, unsigned OpBits, Integral *R) {
+    *R = Integral(A.V & B.V);
+    return false;
+  }
+
+  static bool bitOr(Integral A, Integral B, unsigned OpBits, Integral *R) {
+    *R = Integral(A.V | B.V);
+    return false;
+  }
+
+  static bool bitXor(Integral A, Integral B, unsigned OpBits, Integral *R) {
+    *R = Integral(A.V ^ B.V);
+    return false;
+  }
+
 private:
   template <typename T>
   static typename std::enable_if<std::is_signed<T>::value, bool>::type
@@ -372,6 +372,23 @@ bool CheckCallable(InterpState &S, CodePtr OpPC, Function *F) {
   return true;
 }
 
+bool CheckCall(InterpState &S, CodePtr OpPC, Function *F) {
+  // Like the AST walker, do not evaluate calls when checking whether a
+  // function is a potential constant expression.
+  if (S.checkingPotentialConstantExpression())
+    return false;
+  if (!CheckCallable(S, OpPC, F))
+    return false;
+
+  const SourceInfo &Loc = S.Current->getSource(OpPC);
+  if (S.CallStackDepth > S.getLangOpts().ConstexprCallDepth) {
+    S.FFDiag(Loc, diag::note_constexpr_depth_limit_exceeded)
+        << S.getLangOpts().ConstexprCallDepth;
+    return false;
+  }
+  return S.nextStep(Loc.asStmt());
+}
+
 bool CheckThis(InterpState &S, CodePtr OpPC, const Pointer &This) {
   if (!This.isZero())
     return true;
@@ -85,6 +85,9 @@ bool CheckInit(InterpState &S, CodePtr OpPC, const Pointer &Ptr);
 /// Checks if a method can be called.
 bool CheckCallable(InterpState &S, CodePtr OpPC, Function *F);
 
+/// Checks if a call can be evaluated, counting it as an evaluation step.
+bool CheckCall(InterpState &S, CodePtr OpPC, Function *F);
+
 /// Checks the 'this' pointer.
 bool CheckThis(InterpState &S, CodePtr OpPC, const Pointer &This);
 
@@ -152,6 +155,111 @@ bool Mul(InterpState &S, CodePtr OpPC) {
   return AddSubMulHelper<T, T::mul, std::multiplies>(S, OpPC, Bits, LHS, RHS);
 }
 
+//===----------------------------------------------------------------------===//
+// Div, Rem
+//===----------------------------------------------------------------------===//
+
+template <typename T, bool (*OpFW)(T, T, unsigned, T *)>
+bool DivRemHelper(InterpState &S, CodePtr OpPC, const T &LHS, const T &RHS,
+                  const T &OverflowResult) {
+  if (RHS.isZero()) {
+    const SourceInfo &Loc = S.Current->getSource(OpPC);
+    S.FFDiag(Loc, diag::note_expr_divide_by_zero);
+    return false;
+  }
+
+  // INT_MIN / -1 and INT_MIN % -1 overflow: report them, continuing with the
+  // two's complement result if evaluation proceeds.
+  if (LHS.isSigned() && LHS.isMin() && RHS.isMinusOne()) {
+    const unsigned Bits = LHS.bitWidth() + 1;
+    if (!S.reportOverflow(S.Current->getExpr(OpPC), -LHS.toAPSInt(Bits)))
+      return false;
+    S.Stk.push<T>(OverflowResult);
+    return true;
+  }
+
+  T Result;
+  OpFW(LHS, RHS, LHS.bitWidth(), &Result);
+  S.Stk.push<T>(Result);
+  return true;
+}
+
+template <PrimType Name, class T = typename PrimConv<Name>::T>
+bool Div(InterpState &S, CodePtr OpPC) {
+  const T &RHS = S.Stk.pop<T>();
+  const T &LHS = S.Stk.pop<T>();
+  return DivRemHelper<T, T::div>(S, OpPC, LHS, RHS, LHS);
+}
+
+template <PrimType Name, class T = typename PrimConv<Name>::T>
+bool Rem(InterpState &S, CodePtr OpPC) {
+  const T &RHS = S.Stk.pop<T>();
+  const T &LHS = S.Stk.pop<T>();
+  return DivRemHelper<T, T::rem>(S, OpPC, LHS, RHS, T::zero());
+}
+
+//===----------------------------------------------------------------------===//
+// BitAnd, BitOr, BitXor
+//===----------------------------------------------------------------------===//
+
+template <typename T, bool (*OpFW)(T, T, unsigned, T *)>
+bool BitwiseHelper(InterpState &S) {
+  const T &RHS = S.Stk.pop<T>();
+  const T &LHS = S.Stk.pop<T>();
+  T Result;
+  OpFW(LHS, RHS, LHS.bitWidth(), &Result);
+  S.Stk.push<T>(Result);
+  return true;
+}
+
+template <PrimType Name, class T = typename PrimConv<Name>::T>
+bool BitAnd(InterpState &S, CodePtr OpPC) {
+  return BitwiseHelper<T, T::bitAnd>(S);
+}
+
+template <PrimType Name, class T = typename PrimConv<Name>::T>
+bool BitOr(InterpState &S, CodePtr OpPC) {
+  return BitwiseHelper<T, T::bitOr>(S);
+}
+
+template <PrimType Name, class T = typename PrimConv<Name>::T>
+bool BitXor(InterpState &S, CodePtr OpPC) {
+  return BitwiseHelper<T, T::bitXor>(S);
+}
+
+//===----------------------------------------------------------------------===//
+// Inc, Dec
+//===----------------------------------------------------------------------===//
+
+template <PrimType Name, bool (*OpFn)(InterpState &, CodePtr),
+          class T = typename PrimConv<Name>::T>
+bool IncDecHelper(InterpState &S, CodePtr OpPC) {
+  const Pointer Ptr = S.Stk.pop<Pointer>();
+  if (!CheckLoad(S, OpPC, Ptr) || !CheckStore(S, OpPC, Ptr))
+    return false;
+
+  // Compute the new value with the checked arithmetic of Add and Sub.
+  const T Value = Ptr.deref<T>();
+  S.Stk.push<T>(Value);
+  S.Stk.push<T>(T::from(1));
+  if (!OpFn(S, OpPC))
+    return false;
+
+  Ptr.deref<T>() = S.Stk.pop<T>();
+  S.Stk.push<T>(Value);
+  return true;
+}
+
+template <PrimType Name, class T = typename PrimConv<Name>::T>
+bool Inc(InterpState &S, CodePtr OpPC) {
+  return IncDecHelper<Name, Add<Name>>(S, OpPC);
+}
+
+template <PrimType Name, class T = typename PrimConv<Name>::T>
+bool Dec(InterpState &S, CodePtr OpPC) {
+  return IncDecHelper<Name, Sub<Name>>(S, OpPC);
+}
+
 //===----------------------------------------------------------------------===//
 // EQ, NE, GT, GE, LT, LE
 //===----------------------------------------------------------------------===//
@@ -803,7 +911,12 @@ inline bool Destroy(InterpState &S, CodePtr OpPC, uint32_t I) {
 template <PrimType TIn, PrimType TOut> bool Cast(InterpState &S, CodePtr OpPC) {
   using T = typename PrimConv<TIn>::T;
   using U = typename PrimConv<TOut>::T;
-  S.Stk.push<U>(U::from(S.Stk.pop<T>()));
+  // Integral conversions wrap around, conversions to bool test for zero.
+  const T &Value = S.Stk.pop<T>();
+  if (T::isSigned())
+    S.Stk.push<U>(U::from(static_cast<int64_t>(Value)));
+  else
+    S.Stk.push<U>(U::from(static_cast<uint64_t>(Value)));
   return true;
 }
 
@@ -925,6 +1038,24 @@ inline bool Shl(InterpState &S, CodePtr OpPC) {
   }
 }
 
+//===----------------------------------------------------------------------===//
+// Call, Step
+//===----------------------------------------------------------------------===//
+
+inline bool Call(InterpState &S, CodePtr &PC, Function *Func) {
+  // The source of the call is attached to the address after the opcode.
+  if (!CheckCall(S, PC - sizeof(Function *), Func))
+    return false;
+  ++S.CallStackDepth;
+  S.Current = new InterpFrame(S, Func, S.Current, PC, {});
+  PC = S.Current->getPC();
+  return true;
+}
+
+inline bool Step(InterpState &S, CodePtr OpPC) {
+  return S.nextStep(S.Current->getSource(OpPC).asStmt());
+}
+
 //===----------------------------------------------------------------------===//
 // NoRet
 //===----------------------------------------------------------------------===//
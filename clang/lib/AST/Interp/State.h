@@ -69,6 +69,8 @@ public:
   virtual ASTContext &getCtx() const = 0;
   virtual bool hasPriorDiagnostic() = 0;
   virtual unsigned getCallStackDepth() = 0;
+  /// Counts an evaluation step, diagnosing S if the step limit is exceeded.
+  virtual bool nextStep(const Stmt *S) = 0;
 
 public:
   // Diagnose that the evaluation could not be folded (FF => FoldFailure)
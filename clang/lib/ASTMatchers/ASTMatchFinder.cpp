@@ -20,6 +20,7 @@
 #include "clang/AST/ASTContext.h"
 #include "clang/AST/RecursiveASTVisitor.h"
 #include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/Statistic.h"
 #include "llvm/ADT/StringMap.h"
 #include "llvm/Support/Timer.h"
 #include <deque>
@@ -31,6 +32,13 @@ namespace ast_matchers {
 namespace internal {
 namespace {
 
+#define DEBUG_TYPE "ast-matchers"
+
+STATISTIC(NumMemoizationHits, "Number of memoized match results reused");
+STATISTIC(NumMemoizationMisses, "Number of match results not memoized yet");
+STATISTIC(NumMemoizationCacheClears,
+          "Number of times the memoization cache was full");
+
 typedef MatchFinder::MatchCallback MatchCallback;
 
 // The maximum number of memoization entries to store.
@@ -59,11 +67,6 @@ struct MatchKey {
   DynTypedMatcher::MatcherIDType MatcherID;
   ast_type_traits::DynTypedNode Node;
   BoundNodesTreeBuilder BoundNodes;
-
-  bool operator<(const MatchKey &Other) const {
-    return std::tie(MatcherID, Node, BoundNodes) <
-           std::tie(Other.MatcherID, Other.Node, Other.BoundNodes);
-  }
 };
 
 // Used to store the result of a match and possibly bound nodes.
@@ -405,10 +408,9 @@ public:
     // Note that we key on the bindings *before* the match.
     Key.BoundNodes = *Builder;
 
-    MemoizationMap::iterator I = ResultCache.find(Key);
-    if (I != ResultCache.end()) {
-      *Builder = I->second.Nodes;
-      return I->second.ResultOfMatch;
+    if (const MemoizedMatchResult *Cached = findMemoizedResult(Key)) {
+      *Builder = Cached->Nodes;
+      return Cached->ResultOfMatch;
     }
 
     MemoizedMatchResult Result;
@@ -416,13 +418,53 @@ public:
     Result.ResultOfMatch = matchesRecursively(Node, Matcher, &Result.Nodes,
                                               MaxDepth, Traversal, Bind);
 
-    MemoizedMatchResult &CachedResult = ResultCache[Key];
-    CachedResult = std::move(Result);
+    const MemoizedMatchResult &CachedResult =
+        memoizeResult(std::move(Key), std::move(Result));
 
     *Builder = CachedResult.Nodes;
     return CachedResult.ResultOfMatch;
   }
 
+  // Returns the memoized result of matching Key.MatcherID on Key.Node with
+  // the bindings Key.BoundNodes, or null if there is none.
+  const MemoizedMatchResult *findMemoizedResult(const MatchKey &Key) {
+    auto I = ResultCache.find(std::make_pair(Key.MatcherID, Key.Node));
+    if (I != ResultCache.end()) {
+      for (const auto &BoundNodesAndResult : I->second) {
+        if (BoundNodesAndResult.first == Key.BoundNodes) {
+          ++NumMemoizationHits;
+          return &BoundNodesAndResult.second;
+        }
+      }
+    }
+    ++NumMemoizationMisses;
+    return nullptr;
+  }
+
+  // Memoizes Result for Key and returns the memoized copy, which stays valid
+  // until the next call to memoizeResult or clearFullResultCache.
+  //
+  // Note that we cannot reuse the lookup done by findMemoizedResult, as the
+  // recursive calls computing Result might invalidate it.
+  const MemoizedMatchResult &memoizeResult(MatchKey Key,
+                                           MemoizedMatchResult Result) {
+    ++NumMemoizedResults;
+    MemoizedResults &Results =
+        ResultCache[std::make_pair(Key.MatcherID, Key.Node)];
+    Results.emplace_back(std::move(Key.BoundNodes), std::move(Result));
+    return Results.back().second;
+  }
+
+  // Clears the result cache if it holds too many entries. This has to be
+  // called outside of the recursive calls that use the cache.
+  void clearFullResultCache() {
+    if (NumMemoizedResults <= MaxMemoizationEntries)
+      return;
+    ResultCache.clear();
+    NumMemoizedResults = 0;
+    ++NumMemoizationCacheClears;
+  }
+
   // Matches children or descendants of 'Node' with 'BaseMatcher'.
   bool matchesRecursively(const ast_type_traits::DynTypedNode &Node,
                           const DynTypedMatcher &Matcher,
@@ -450,8 +492,7 @@ public:
                       BoundNodesTreeBuilder *Builder,
                       ast_type_traits::TraversalKind Traversal,
                       BindKind Bind) override {
-    if (ResultCache.size() > MaxMemoizationEntries)
-      ResultCache.clear();
+    clearFullResultCache();
     return memoizedMatchesRecursively(Node, Matcher, Builder, 1, Traversal,
                                       Bind);
   }
@@ -460,8 +501,7 @@ public:
                            const DynTypedMatcher &Matcher,
                            BoundNodesTreeBuilder *Builder,
                            BindKind Bind) override {
-    if (ResultCache.size() > MaxMemoizationEntries)
-      ResultCache.clear();
+    clearFullResultCache();
     return memoizedMatchesRecursively(Node, Matcher, Builder, INT_MAX,
                                       ast_type_traits::TraversalKind::TK_AsIs,
                                       Bind);
@@ -473,8 +513,7 @@ public:
                          AncestorMatchMode MatchMode) override {
     // Reset the cache outside of the recursive call to make sure we
     // don't invalidate any iterators.
-    if (ResultCache.size() > MaxMemoizationEntries)
-      ResultCache.clear();
+    clearFullResultCache();
     return memoizedMatchesAncestorOfRecursively(Node, Matcher, Builder,
                                                 MatchMode);
   }
@@ -651,12 +690,9 @@ private:
     Key.Node = Node;
     Key.BoundNodes = *Builder;
 
-    // Note that we cannot use insert and reuse the iterator, as recursive
-    // calls to match might invalidate the result cache iterators.
-    MemoizationMap::iterator I = ResultCache.find(Key);
-    if (I != ResultCache.end()) {
-      *Builder = I->second.Nodes;
-      return I->second.ResultOfMatch;
+    if (const MemoizedMatchResult *Cached = findMemoizedResult(Key)) {
+      *Builder = Cached->Nodes;
+      return Cached->ResultOfMatch;
     }
 
     MemoizedMatchResult Result;
@@ -664,8 +700,8 @@ private:
     Result.ResultOfMatch =
         matchesAncestorOfRecursively(Node, Matcher, &Result.Nodes, MatchMode);
 
-    MemoizedMatchResult &CachedResult = ResultCache[Key];
-    CachedResult = std::move(Result);
+    const MemoizedMatchResult &CachedResult =
+        memoizeResult(std::move(Key), std::move(Result));
 
     *Builder = CachedResult.Nodes;
     return CachedResult.ResultOfMatch;
@@ -820,9 +856,16 @@ private:
                  llvm::SmallPtrSet<const ObjCCompatibleAliasDecl *, 2>>
       CompatibleAliases;
 
-  // Maps (matcher, node) -> the match result for memoization.
-  typedef std::map<MatchKey, MemoizedMatchResult> MemoizationMap;
-  MemoizationMap ResultCache;
+  // Maps (matcher, node) -> the match results for memoization, one for each
+  // set of bindings the matcher was run with. There is usually only one.
+  typedef SmallVector<std::pair<BoundNodesTreeBuilder, MemoizedMatchResult>, 1>
+      MemoizedResults;
+  llvm::DenseMap<std::pair<DynTypedMatcher::MatcherIDType,
+                           ast_type_traits::DynTypedNode>,
+                 MemoizedResults>
+      ResultCache;
+  // The number of results in ResultCache.
+  unsigned NumMemoizedResults = 0;
 };
 
 static CXXRecordDecl *
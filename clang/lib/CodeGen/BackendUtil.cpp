@@ -27,7 +27,9 @@
 #include "llvm/CodeGen/SchedulerRegistry.h"
 #include "llvm/CodeGen/TargetSubtargetInfo.h"
 #include "llvm/IR/DataLayout.h"
+#include "llvm/IR/DiagnosticHandler.h"
 #include "llvm/IR/IRPrintingPasses.h"
+#include "llvm/IR/LLVMContext.h"
 #include "llvm/IR/LegacyPassManager.h"
 #include "llvm/IR/Module.h"
 #include "llvm/IR/ModuleSummaryIndex.h"
@@ -41,8 +43,10 @@
 #include "llvm/Support/BuryPointer.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
 #include "llvm/Support/PrettyStackTrace.h"
 #include "llvm/Support/TargetRegistry.h"
+#include "llvm/Support/ThreadPool.h"
 #include "llvm/Support/TimeProfiler.h"
 #include "llvm/Support/Timer.h"
 #include "llvm/Support/raw_ostream.h"
@@ -68,10 +72,14 @@
 #include "llvm/Transforms/Scalar/GVN.h"
 #include "llvm/Transforms/Utils.h"
 #include "llvm/Transforms/Utils/CanonicalizeAliases.h"
+#include "llvm/Transforms/Utils/Cloning.h"
 #include "llvm/Transforms/Utils/EntryExitInstrumenter.h"
 #include "llvm/Transforms/Utils/NameAnonGlobals.h"
+#include "llvm/Transforms/Utils/SplitModule.h"
 #include "llvm/Transforms/Utils/SymbolRewriter.h"
+#include <atomic>
 #include <memory>
+#include <mutex>
 using namespace clang;
 using namespace llvm;
 
@@ -117,6 +125,15 @@ class EmitAssemblyHelper {
   bool AddEmitPasses(legacy::PassManager &CodeGenPasses, BackendAction Action,
                      raw_pwrite_stream &OS, raw_pwrite_stream *DwoOS);
 
+  /// Whether to generate code for partitions of the module on several
+  /// threads, instead of running the code generator on the whole module.
+  bool shouldSplitCodeGen() const;
+
+  /// Split the module into CodeGenOpts.ParallelCodeGen partitions, and
+  /// generate code for them in parallel. The first partition is written to
+  /// \p OS, the others to files named after the output file.
+  void EmitPartitionsInParallel(BackendAction Action, raw_pwrite_stream &OS);
+
   std::unique_ptr<llvm::ToolOutputFile> openOutputFile(StringRef Path) {
     std::error_code EC;
     auto F = std::make_unique<llvm::ToolOutputFile>(Path, EC,
@@ -775,12 +792,12 @@ void EmitAssemblyHelper::CreateTargetMachine(bool MustCreateTM) {
                                           Options, RM, CM, OptLevel));
 }
 
-bool EmitAssemblyHelper::AddEmitPasses(legacy::PassManager &CodeGenPasses,
-                                       BackendAction Action,
-                                       raw_pwrite_stream &OS,
-                                       raw_pwrite_stream *DwoOS) {
+static bool addEmitPasses(legacy::PassManager &CodeGenPasses,
+                          TargetMachine &TM, const CodeGenOptions &CodeGenOpts,
+                          BackendAction Action, raw_pwrite_stream &OS,
+                          raw_pwrite_stream *DwoOS) {
   // Add LibraryInfo.
-  llvm::Triple TargetTriple(TheModule->getTargetTriple());
+  llvm::Triple TargetTriple(TM.getTargetTriple());
   std::unique_ptr<TargetLibraryInfoImpl> TLII(
       createTLII(TargetTriple, CodeGenOpts));
   CodeGenPasses.add(new TargetLibraryInfoWrapperPass(*TLII));
@@ -795,8 +812,15 @@ bool EmitAssemblyHelper::AddEmitPasses(legacy::PassManager &CodeGenPasses,
   if (CodeGenOpts.OptimizationLevel > 0)
     CodeGenPasses.add(createObjCARCContractPass());
 
-  if (TM->addPassesToEmitFile(CodeGenPasses, OS, DwoOS, CGFT,
-                              /*DisableVerify=*/!CodeGenOpts.VerifyModule)) {
+  return !TM.addPassesToEmitFile(CodeGenPasses, OS, DwoOS, CGFT,
+                                 /*DisableVerify=*/!CodeGenOpts.VerifyModule);
+}
+
+bool EmitAssemblyHelper::AddEmitPasses(legacy::PassManager &CodeGenPasses,
+                                       BackendAction Action,
+                                       raw_pwrite_stream &OS,
+                                       raw_pwrite_stream *DwoOS) {
+  if (!addEmitPasses(CodeGenPasses, *TM, CodeGenOpts, Action, OS, DwoOS)) {
     Diags.Report(diag::err_fe_unable_to_interface_with_target);
     return false;
   }
@@ -804,6 +828,147 @@ bool EmitAssemblyHelper::AddEmitPasses(legacy::PassManager &CodeGenPasses,
   return true;
 }
 
+namespace {
+/// Hands the diagnostics of the partitions, which are code generated on other
+/// threads, one at a time to the handlers of the context of the whole module.
+struct PartitionDiagnostics {
+  LLVMContext &MainContext;
+  std::mutex Mutex;
+
+  explicit PartitionDiagnostics(LLVMContext &MainContext)
+      : MainContext(MainContext) {}
+
+  static void handleInlineAsmDiagnostic(const llvm::SMDiagnostic &D,
+                                        void *Context, unsigned LocCookie) {
+    auto &PD = *static_cast<PartitionDiagnostics *>(Context);
+    std::lock_guard<std::mutex> Lock(PD.Mutex);
+    PD.MainContext.getInlineAsmDiagnosticHandler()(
+        D, PD.MainContext.getInlineAsmDiagnosticContext(), LocCookie);
+  }
+};
+
+class PartitionDiagnosticHandler : public DiagnosticHandler {
+  PartitionDiagnostics &PD;
+
+  const DiagnosticHandler &mainHandler() const {
+    return *PD.MainContext.getDiagHandlerPtr();
+  }
+
+public:
+  explicit PartitionDiagnosticHandler(PartitionDiagnostics &PD) : PD(PD) {}
+
+  bool handleDiagnostics(const DiagnosticInfo &DI) override {
+    std::lock_guard<std::mutex> Lock(PD.Mutex);
+    PD.MainContext.diagnose(DI);
+    return true;
+  }
+
+  bool isAnalysisRemarkEnabled(StringRef PassName) const override {
+    return mainHandler().isAnalysisRemarkEnabled(PassName);
+  }
+  bool isMissedOptRemarkEnabled(StringRef PassName) const override {
+    return mainHandler().isMissedOptRemarkEnabled(PassName);
+  }
+  bool isPassedOptRemarkEnabled(StringRef PassName) const override {
+    return mainHandler().isPassedOptRemarkEnabled(PassName);
+  }
+  bool isAnyRemarkEnabled() const override {
+    return mainHandler().isAnyRemarkEnabled();
+  }
+};
+} // namespace
+
+bool EmitAssemblyHelper::shouldSplitCodeGen() const {
+  // Split DWARF would need a .dwo file per partition, and the time trace and
+  // pass timers aren't thread-safe.
+  return CodeGenOpts.ParallelCodeGen > 1 &&
+         !CodeGenOpts.ParallelCodeGenOutput.empty() &&
+         CodeGenOpts.ParallelCodeGenOutput != "-" &&
+         CodeGenOpts.SplitDwarfOutput.empty() &&
+         !llvm::timeTraceProfilerEnabled() && !llvm::TimePassesIsEnabled;
+}
+
+void EmitAssemblyHelper::EmitPartitionsInParallel(BackendAction Action,
+                                                  raw_pwrite_stream &OS) {
+  unsigned NumPartitions = CodeGenOpts.ParallelCodeGen;
+  StringRef Output = CodeGenOpts.ParallelCodeGenOutput;
+  std::vector<std::unique_ptr<llvm::ToolOutputFile>> PartitionFiles;
+  std::vector<raw_pwrite_stream *> PartitionOSs = {&OS};
+  for (unsigned I = 1; I != NumPartitions; ++I) {
+    // foo.o is split into foo.o, foo.1.o, foo.2.o...
+    SmallString<128> Path(Output);
+    llvm::sys::path::replace_extension(
+        Path, "." + Twine(I) + llvm::sys::path::extension(Output));
+    PartitionFiles.push_back(openOutputFile(Path));
+    if (!PartitionFiles.back())
+      return;
+    PartitionOSs.push_back(&PartitionFiles.back()->os());
+  }
+
+  PartitionDiagnostics PD(TheModule->getContext());
+  std::atomic<bool> Failed(false);
+  {
+    // The threads are joined when the pool is destroyed.
+    ThreadPool Pool(NumPartitions);
+    unsigned I = 0;
+    // Locals are kept in the partitions of their users rather than being
+    // externalized, so the symbols of the objects are those of the module.
+    SplitModule(
+        CloneModule(*TheModule), NumPartitions,
+        [&](std::unique_ptr<Module> MPart) {
+          // Each partition is code generated in a context of its own. The
+          // partitions share the context of the module, so they are moved
+          // there as bitcode written on this thread.
+          SmallString<0> BC;
+          raw_svector_ostream BCOS(BC);
+          WriteBitcodeToFile(*MPart, BCOS);
+          raw_pwrite_stream *PartitionOS = PartitionOSs[I++];
+          Pool.async(
+              [&, PartitionOS](const SmallString<0> &BC) {
+                LLVMContext Ctx;
+                Ctx.setDiagnosticHandler(
+                    std::make_unique<PartitionDiagnosticHandler>(PD));
+                if (PD.MainContext.getInlineAsmDiagnosticHandler())
+                  Ctx.setInlineAsmDiagnosticHandler(
+                      PartitionDiagnostics::handleInlineAsmDiagnostic, &PD);
+                Expected<std::unique_ptr<Module>> MOrErr = parseBitcodeFile(
+                    MemoryBufferRef(StringRef(BC.data(), BC.size()),
+                                    "<split-module>"),
+                    Ctx);
+                if (!MOrErr)
+                  report_fatal_error("Failed to read bitcode");
+
+                std::unique_ptr<TargetMachine> PartitionTM(
+                    TM->getTarget().createTargetMachine(
+                        TM->getTargetTriple().str(), TM->getTargetCPU(),
+                        TM->getTargetFeatureString(), TM->Options,
+                        TM->getRelocationModel(), TM->getCodeModel(),
+                        TM->getOptLevel()));
+                legacy::PassManager CodeGenPasses;
+                CodeGenPasses.add(createTargetTransformInfoWrapperPass(
+                    PartitionTM->getTargetIRAnalysis()));
+                if (!addEmitPasses(CodeGenPasses, *PartitionTM, CodeGenOpts,
+                                   Action, *PartitionOS, /*DwoOS=*/nullptr)) {
+                  Failed = true;
+                  return;
+                }
+                CodeGenPasses.run(**MOrErr);
+              },
+              // Move BC into the task rather than copying it.
+              std::move(BC));
+        },
+        /*PreserveLocals=*/true);
+  }
+
+  if (Failed) {
+    Diags.Report(diag::err_fe_unable_to_interface_with_target);
+    return;
+  }
+  if (!Diags.hasErrorOccurred())
+    for (auto &File : PartitionFiles)
+      File->keep();
+}
+
 void EmitAssemblyHelper::EmitAssembly(BackendAction Action,
                                       std::unique_ptr<raw_pwrite_stream> OS) {
   TimeRegion Region(FrontendTimesIsEnabled ? &CodeGenerationTime : nullptr);
@@ -835,6 +1000,7 @@ void EmitAssemblyHelper::EmitAssembly(BackendAction Action,
       createTargetTransformInfoWrapperPass(getTargetIRAnalysis()));
 
   std::unique_ptr<llvm::ToolOutputFile> ThinLinkOS, DwoOS;
+  bool SplitCodeGen = false;
 
   switch (Action) {
   case Backend_EmitNothing:
@@ -877,6 +1043,10 @@ void EmitAssemblyHelper::EmitAssembly(BackendAction Action,
     break;
 
   default:
+    if (shouldSplitCodeGen()) {
+      SplitCodeGen = true;
+      break;
+    }
     if (!CodeGenOpts.SplitDwarfOutput.empty()) {
       DwoOS = openOutputFile(CodeGenOpts.SplitDwarfOutput);
       if (!DwoOS)
@@ -910,7 +1080,10 @@ void EmitAssemblyHelper::EmitAssembly(BackendAction Action,
     PerModulePasses.run(*TheModule);
   }
 
-  {
+  if (SplitCodeGen) {
+    PrettyStackTraceString CrashInfo("Parallel code generation");
+    EmitPartitionsInParallel(Action, *OS);
+  } else {
     PrettyStackTraceString CrashInfo("Code generation");
     llvm::TimeTraceScope TimeScope("CodeGenPasses", StringRef(""));
     CodeGenPasses.run(*TheModule);
@@ -1256,6 +1429,7 @@ void EmitAssemblyHelper::EmitAssemblyWithNewPassManager(
   // create that pass manager here and use it as needed below.
   legacy::PassManager CodeGenPasses;
   bool NeedCodeGen = false;
+  bool SplitCodeGen = false;
   std::unique_ptr<llvm::ToolOutputFile> ThinLinkOS, DwoOS;
 
   // Append any output we need to the pass manager.
@@ -1300,6 +1474,10 @@ void EmitAssemblyHelper::EmitAssemblyWithNewPassManager(
   case Backend_EmitAssembly:
   case Backend_EmitMCNull:
   case Backend_EmitObj:
+    if (shouldSplitCodeGen()) {
+      SplitCodeGen = true;
+      break;
+    }
     NeedCodeGen = true;
     CodeGenPasses.add(
         createTargetTransformInfoWrapperPass(getTargetIRAnalysis()));
@@ -1325,7 +1503,10 @@ void EmitAssemblyHelper::EmitAssemblyWithNewPassManager(
   }
 
   // Now if needed, run the legacy PM for codegen.
-  if (NeedCodeGen) {
+  if (SplitCodeGen) {
+    PrettyStackTraceString CrashInfo("Parallel code generation");
+    EmitPartitionsInParallel(Action, *OS);
+  } else if (NeedCodeGen) {
     PrettyStackTraceString CrashInfo("Code generation");
     CodeGenPasses.run(*TheModule);
   }
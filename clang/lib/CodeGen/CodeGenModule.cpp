@@ -2828,8 +2828,16 @@ void CodeGenModule::EmitGlobalDefinition(GlobalDecl GD, llvm::GlobalValue *GV) {
     return EmitGlobalFunctionDefinition(GD, GV);
   }
 
-  if (const auto *VD = dyn_cast<VarDecl>(D))
+  if (const auto *VD = dyn_cast<VarDecl>(D)) {
+    llvm::TimeTraceScope TimeScope("CodeGen Variable", [&]() {
+      std::string Name;
+      llvm::raw_string_ostream OS(Name);
+      VD->getNameForDiagnostic(OS, getContext().getPrintingPolicy(),
+                               /*Qualified=*/true);
+      return Name;
+    });
     return EmitGlobalVarDefinition(VD, !VD->hasDefinition());
+  }
 
   llvm_unreachable("Invalid argument to EmitGlobalDefinition()");
 }
@@ -12,6 +12,7 @@
 #include "clang/CrossTU/CrossTranslationUnit.h"
 #include "clang/AST/ASTImporter.h"
 #include "clang/AST/Decl.h"
+#include "clang/AST/DeclCXX.h"
 #include "clang/Basic/TargetInfo.h"
 #include "clang/CrossTU/CrossTUDiagnostic.h"
 #include "clang/Frontend/ASTUnit.h"
@@ -22,9 +23,9 @@
 #include "llvm/ADT/Statistic.h"
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/ManagedStatic.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/raw_ostream.h"
-#include <fstream>
 #include <sstream>
 
 namespace clang {
@@ -128,33 +129,46 @@ std::error_code IndexError::convertToErrorCode() const {
   return std::error_code(static_cast<int>(Code), *Category);
 }
 
+/// Parses the index in \p Buffer, which was read from \p IndexPath, and calls
+/// \p AddEntry with the lookup name and the file name of each entry. The
+/// names point into \p Buffer. \p AddEntry returns false if there is an entry
+/// for the lookup name already.
+static llvm::Error parseCrossTUIndexBuffer(
+    StringRef Buffer, StringRef IndexPath,
+    llvm::function_ref<bool(StringRef, StringRef)> AddEntry) {
+  unsigned LineNo = 1;
+  while (!Buffer.empty()) {
+    StringRef Line;
+    std::tie(Line, Buffer) = Buffer.split('\n');
+    const size_t Pos = Line.find(' ');
+    if (Pos == 0 || Pos == StringRef::npos)
+      return llvm::make_error<IndexError>(
+          index_error_code::invalid_index_format, IndexPath.str(), LineNo);
+    if (!AddEntry(Line.substr(0, Pos), Line.substr(Pos + 1)))
+      return llvm::make_error<IndexError>(
+          index_error_code::multiple_definitions, IndexPath.str(), LineNo);
+    LineNo++;
+  }
+  return llvm::Error::success();
+}
+
 llvm::Expected<llvm::StringMap<std::string>>
 parseCrossTUIndex(StringRef IndexPath, StringRef CrossTUDir) {
-  std::ifstream ExternalMapFile(IndexPath);
-  if (!ExternalMapFile)
+  llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> BufferOrErr =
+      llvm::MemoryBuffer::getFile(IndexPath);
+  if (!BufferOrErr)
     return llvm::make_error<IndexError>(index_error_code::missing_index_file,
                                         IndexPath.str());
 
   llvm::StringMap<std::string> Result;
-  std::string Line;
-  unsigned LineNo = 1;
-  while (std::getline(ExternalMapFile, Line)) {
-    const size_t Pos = Line.find(" ");
-    if (Pos > 0 && Pos != std::string::npos) {
-      StringRef LineRef{Line};
-      StringRef LookupName = LineRef.substr(0, Pos);
-      if (Result.count(LookupName))
-        return llvm::make_error<IndexError>(
-            index_error_code::multiple_definitions, IndexPath.str(), LineNo);
-      StringRef FileName = LineRef.substr(Pos + 1);
-      SmallString<256> FilePath = CrossTUDir;
-      llvm::sys::path::append(FilePath, FileName);
-      Result[LookupName] = FilePath.str().str();
-    } else
-      return llvm::make_error<IndexError>(
-          index_error_code::invalid_index_format, IndexPath.str(), LineNo);
-    LineNo++;
-  }
+  if (llvm::Error Err = parseCrossTUIndexBuffer(
+          (*BufferOrErr)->getBuffer(), IndexPath,
+          [&](StringRef LookupName, StringRef FileName) {
+            SmallString<256> FilePath = CrossTUDir;
+            llvm::sys::path::append(FilePath, FileName);
+            return Result.try_emplace(LookupName, FilePath.str()).second;
+          }))
+    return std::move(Err);
   return Result;
 }
 
@@ -187,6 +201,69 @@ template <typename T> static bool hasBodyOrInit(const T *D) {
   return hasBodyOrInit(D, Unused);
 }
 
+/// Finds the definition of \p D with the given lookup name in \p FromCtx
+/// through the lookup tables of the namespaces and records enclosing \p D.
+/// Unlike walking all the decls of the AST, this only deserializes the decls
+/// named like \p D and its enclosing contexts. Returns null if \p D cannot be
+/// found by name, e.g. because it is in an anonymous namespace.
+template <typename T>
+static const T *lookupDefByName(const T *D, ASTContext &FromCtx,
+                                StringRef LookupName) {
+  SmallVector<const NamedDecl *, 4> Contexts;
+  for (const DeclContext *DC = D->getDeclContext(); !DC->isTranslationUnit();
+       DC = DC->getParent()) {
+    if (DC->isTransparentContext())
+      continue;
+    if (!isa<NamespaceDecl>(DC) && !isa<RecordDecl>(DC))
+      return nullptr;
+    Contexts.push_back(cast<NamedDecl>(DC));
+  }
+
+  auto GetIdentifier = [&FromCtx](const NamedDecl *ND) -> IdentifierInfo * {
+    const IdentifierInfo *II = ND->getIdentifier();
+    return II ? &FromCtx.Idents.get(II->getName()) : nullptr;
+  };
+
+  DeclContext *FromDC = FromCtx.getTranslationUnitDecl();
+  for (const NamedDecl *Context : llvm::reverse(Contexts)) {
+    IdentifierInfo *II = GetIdentifier(Context);
+    if (!II)
+      return nullptr;
+    DeclContext *Next = nullptr;
+    for (NamedDecl *Found : FromDC->lookup(II)) {
+      if (isa<NamespaceDecl>(Context)) {
+        if (auto *NS = dyn_cast<NamespaceDecl>(Found)) {
+          Next = NS;
+          break;
+        }
+      } else if (auto *RD = dyn_cast<RecordDecl>(Found)) {
+        if ((RD = RD->getDefinition())) {
+          Next = RD;
+          break;
+        }
+      }
+    }
+    if (!Next)
+      return nullptr;
+    FromDC = Next;
+  }
+
+  IdentifierInfo *II = GetIdentifier(D);
+  if (!II)
+    return nullptr;
+  for (NamedDecl *Found : FromDC->lookup(II)) {
+    const auto *ND = dyn_cast<T>(Found);
+    const T *ResultDecl;
+    if (!ND || !hasBodyOrInit(ND, ResultDecl))
+      continue;
+    llvm::Optional<std::string> ResultLookupName =
+        CrossTranslationUnitContext::getLookupName(ResultDecl);
+    if (ResultLookupName && *ResultLookupName == LookupName)
+      return ResultDecl;
+  }
+  return nullptr;
+}
+
 CrossTranslationUnitContext::CrossTranslationUnitContext(CompilerInstance &CI)
     : Context(CI.getASTContext()), ASTStorage(CI) {}
 
@@ -294,8 +371,14 @@ llvm::Expected<const T *> CrossTranslationUnitContext::getCrossTUDefinitionImpl(
         index_error_code::lang_dialect_mismatch);
   }
 
-  TranslationUnitDecl *TU = Unit->getASTContext().getTranslationUnitDecl();
-  if (const T *ResultDecl = findDefInDeclContext<T>(TU, *LookupName))
+  // Prefer name lookup, which avoids deserializing the whole external AST.
+  const T *ResultDecl =
+      lookupDefByName(D, Unit->getASTContext(), *LookupName);
+  if (!ResultDecl) {
+    TranslationUnitDecl *TU = Unit->getASTContext().getTranslationUnitDecl();
+    ResultDecl = findDefInDeclContext<T>(TU, *LookupName);
+  }
+  if (ResultDecl)
     return importDefinition(ResultDecl, Unit);
   return llvm::make_error<IndexError>(index_error_code::failed_import);
 }
@@ -417,15 +500,16 @@ CrossTranslationUnitContext::ASTUnitStorage::getASTUnitForFunction(
       return std::move(IndexLoadError);
 
     // Check if there is and entry in the index for the function.
-    if (!NameFileMap.count(FunctionName)) {
+    auto IndexEntry = NameFileMap.find(FunctionName);
+    if (IndexEntry == NameFileMap.end()) {
       ++NumNotInOtherTU;
       return llvm::make_error<IndexError>(index_error_code::missing_definition);
     }
 
     // Search in the index for the filename where the definition of FuncitonName
     // resides.
-    if (llvm::Expected<ASTUnit *> FoundForFile =
-            getASTUnitForFile(NameFileMap[FunctionName], DisplayCTUProgress)) {
+    if (llvm::Expected<ASTUnit *> FoundForFile = getASTUnitForFile(
+            getASTFilePath(IndexEntry->second), DisplayCTUProgress)) {
 
       // Update the cache.
       NameASTUnitMap[FunctionName] = *FoundForFile;
@@ -445,13 +529,23 @@ CrossTranslationUnitContext::ASTUnitStorage::getFileForFunction(
     StringRef FunctionName, StringRef CrossTUDir, StringRef IndexName) {
   if (llvm::Error IndexLoadError = ensureCTUIndexLoaded(CrossTUDir, IndexName))
     return std::move(IndexLoadError);
-  return NameFileMap[FunctionName];
+  auto IndexEntry = NameFileMap.find(FunctionName);
+  if (IndexEntry == NameFileMap.end())
+    return std::string();
+  return getASTFilePath(IndexEntry->second);
+}
+
+std::string CrossTranslationUnitContext::ASTUnitStorage::getASTFilePath(
+    StringRef FileName) const {
+  SmallString<256> FilePath(IndexCTUDir);
+  llvm::sys::path::append(FilePath, FileName);
+  return FilePath.str();
 }
 
 llvm::Error CrossTranslationUnitContext::ASTUnitStorage::ensureCTUIndexLoaded(
     StringRef CrossTUDir, StringRef IndexName) {
-  // Dont initialize if the map is filled.
-  if (!NameFileMap.empty())
+  // Dont initialize if the index is loaded.
+  if (IndexBuffer)
     return llvm::Error::success();
 
   // Get the absolute path to the index file.
@@ -461,14 +555,28 @@ llvm::Error CrossTranslationUnitContext::ASTUnitStorage::ensureCTUIndexLoaded(
   else
     llvm::sys::path::append(IndexFile, IndexName);
 
-  if (auto IndexMapping = parseCrossTUIndex(IndexFile, CrossTUDir)) {
-    // Initialize member map.
-    NameFileMap = *IndexMapping;
-    return llvm::Error::success();
-  } else {
+  // The index of a large project can be big, so map it into memory and point
+  // into it instead of copying every entry.
+  llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> BufferOrErr =
+      llvm::MemoryBuffer::getFile(IndexFile);
+  if (!BufferOrErr)
+    return llvm::make_error<IndexError>(index_error_code::missing_index_file,
+                                        IndexFile.str().str());
+
+  IndexMapTy Mapping;
+  if (llvm::Error Err = parseCrossTUIndexBuffer(
+          (*BufferOrErr)->getBuffer(), IndexFile,
+          [&](StringRef LookupName, StringRef FileName) {
+            return Mapping.try_emplace(LookupName, FileName).second;
+          }))
     // Error while parsing CrossTU index file.
-    return IndexMapping.takeError();
-  };
+    return Err;
+
+  // Initialize member map.
+  IndexBuffer = std::move(*BufferOrErr);
+  NameFileMap = std::move(Mapping);
+  IndexCTUDir = CrossTUDir;
+  return llvm::Error::success();
 }
 
 llvm::Expected<ASTUnit *> CrossTranslationUnitContext::loadExternalAST(
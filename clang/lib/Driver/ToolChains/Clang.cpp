@@ -1190,6 +1190,8 @@ void Clang::AddPreprocessingOptions(Compilation &C, const JobAction &JA,
   Args.AddAllArgs(CmdArgs,
                   {options::OPT_D, options::OPT_U, options::OPT_I_Group,
                    options::OPT_F, options::OPT_index_header_map});
+  Args.AddLastArg(CmdArgs, options::OPT_fcache_search_dir_listings);
+  Args.AddLastArg(CmdArgs, options::OPT_fsearch_dir_listings_cache_path);
 
   // Add -Wp, and -Xpreprocessor if using the preprocessor.
 
@@ -2860,6 +2862,7 @@ static void RenderModulesOptions(Compilation &C, const Driver &D,
     CmdArgs.push_back("-fmodules-validate-system-headers");
 
   Args.AddLastArg(CmdArgs, options::OPT_fmodules_disable_diagnostic_validation);
+  Args.AddLastArg(CmdArgs, options::OPT_fmodules_prefetch);
 }
 
 static void RenderCharacterOptions(const ArgList &Args, const llvm::Triple &T,
@@ -3352,6 +3355,11 @@ static void RenderDebugOptions(const ToolChain &TC, const Driver &D,
                    TC)) {
       CmdArgs.push_back("-mllvm");
       CmdArgs.push_back("-generate-type-units");
+      if (const Arg *A = Args.getLastArg(options::OPT_fdebug_types_cache_EQ)) {
+        CmdArgs.push_back("-mllvm");
+        CmdArgs.push_back(Args.MakeArgString(
+            Twine("-split-dwarf-type-cache=") + A->getValue()));
+      }
     }
   }
 
@@ -3579,8 +3587,20 @@ void Clang::ConstructJob(Compilation &C, const JobAction &JA,
       CmdArgs.push_back(IsHeaderModulePrecompile
                             ? "-emit-header-module"
                             : "-emit-module-interface");
-    else
+    else {
       CmdArgs.push_back("-emit-pch");
+
+      // Code generated for the PCH is only useful for the instantiations
+      // it contains, so -fpch-codegen implies instantiating templates.
+      bool PCHCodegen =
+          Args.hasFlag(options::OPT_fpch_codegen, options::OPT_fno_pch_codegen,
+                       false);
+      if (PCHCodegen)
+        CmdArgs.push_back("-fmodules-codegen");
+      if (Args.hasFlag(options::OPT_fpch_instantiate_templates,
+                       options::OPT_fno_pch_instantiate_templates, PCHCodegen))
+        CmdArgs.push_back("-fpch-instantiate-templates");
+    }
   } else if (isa<VerifyPCHJobAction>(JA)) {
     CmdArgs.push_back("-verify-pch");
   } else {
@@ -4197,6 +4217,8 @@ void Clang::ConstructJob(Compilation &C, const JobAction &JA,
                     options::OPT_fno_unique_section_names, true))
     CmdArgs.push_back("-fno-unique-section-names");
 
+  Args.AddLastArg(CmdArgs, options::OPT_fparallel_codegen_EQ);
+
   Args.AddLastArg(CmdArgs, options::OPT_finstrument_functions,
                   options::OPT_finstrument_functions_after_inlining,
                   options::OPT_finstrument_function_entry_bare);
@@ -1339,8 +1339,17 @@ public:
           SmallVectorImpl<AnnotatedLine *> &AnnotatedLines,
           FormatTokenLexer &Tokens) override {
     tooling::Replacements Result;
+    // The first run decides on an automatic language standard for all of them,
+    // so derive the local style even if this run turns out to be unaffected.
     deriveLocalStyle(AnnotatedLines);
-    AffectedRangeMgr.computeAffectedLines(AnnotatedLines);
+    // Nothing in this run needs formatting if no line and no leading
+    // whitespace of a line is affected. This is the common case for most runs
+    // when only a few ranges of a large file are formatted.
+    if (!AffectedRangeMgr.computeAffectedLines(AnnotatedLines) &&
+        llvm::none_of(AnnotatedLines, [](const AnnotatedLine *Line) {
+          return Line->LeadingEmptyLinesAffected;
+        }))
+      return {Result, 0};
     for (unsigned i = 0, e = AnnotatedLines.size(); i != e; ++i) {
       Annotator.calculateFormattingInformation(*AnnotatedLines[i]);
     }
@@ -2426,7 +2435,8 @@ reformat(const FormatStyle &Style, StringRef Code,
     if (NewCode) {
       Fixes = Fixes.merge(PassFixes.first);
       Penalty += PassFixes.second;
-      if (I + 1 < E) {
+      // Passes that did not change anything leave the environment valid.
+      if (I + 1 < E && !PassFixes.first.empty()) {
         CurrentCode = std::move(*NewCode);
         Env = std::make_unique<Environment>(
             *CurrentCode, FileName,
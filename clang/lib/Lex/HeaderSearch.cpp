@@ -28,16 +28,21 @@
 #include "llvm/ADT/SmallString.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/Statistic.h"
+#include "llvm/ADT/StringExtras.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Support/Allocator.h"
 #include "llvm/Support/Capacity.h"
 #include "llvm/Support/Errc.h"
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/VirtualFileSystem.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/Support/xxhash.h"
 #include <algorithm>
 #include <cassert>
+#include <chrono>
 #include <cstddef>
 #include <cstdio>
 #include <cstring>
@@ -56,6 +61,9 @@ ALWAYS_ENABLED_STATISTIC(
 ALWAYS_ENABLED_STATISTIC(NumFrameworkLookups, "Number of framework lookups.");
 ALWAYS_ENABLED_STATISTIC(NumSubFrameworkLookups,
                          "Number of subframework lookups.");
+ALWAYS_ENABLED_STATISTIC(
+    NumDirListingSkips,
+    "Number of search directory lookups skipped due to directory listings.");
 
 const IdentifierInfo *
 HeaderFileInfo::getControllingMacro(ExternalPreprocessorSource *External) {
@@ -106,6 +114,11 @@ void HeaderSearch::PrintStats() {
 
   llvm::errs() << NumFrameworkLookups << " framework lookups.\n"
                << NumSubFrameworkLookups << " subframework lookups.\n";
+
+  if (!DirListings.empty())
+    llvm::errs() << DirListings.size() << " search directories listed.\n"
+                 << "  " << NumDirListingSkips
+                 << " lookups skipped due to directory listings.\n";
 }
 
 /// CreateHeaderMap - This method returns a HeaderMap for the specified
@@ -345,6 +358,128 @@ Optional<FileEntryRef> HeaderSearch::getFileAndSuggestModule(
   return *File;
 }
 
+/// The first line of the files holding saved directory listings.
+static const char DirListingMagic[] = "clang-dir-listing-v1";
+
+/// Reads the names saved by writeDirListing, if they were saved for \p Dir
+/// with the modification time \p Stamp.
+static bool readDirListing(StringRef Path, StringRef Dir, StringRef Stamp,
+                           llvm::StringSet<> &Names) {
+  auto Buffer = llvm::MemoryBuffer::getFile(Path);
+  if (!Buffer)
+    return false;
+  SmallVector<StringRef, 64> Lines;
+  (*Buffer)->getBuffer().split(Lines, '\n', /*MaxSplit=*/-1,
+                               /*KeepEmpty=*/false);
+  if (Lines.size() < 3 || Lines[0] != DirListingMagic || Lines[1] != Dir ||
+      Lines[2] != Stamp)
+    return false;
+  for (StringRef Name : llvm::makeArrayRef(Lines).drop_front(3))
+    Names.insert(Name);
+  return true;
+}
+
+static void writeDirListing(StringRef Path, StringRef Dir, StringRef Stamp,
+                            const llvm::StringSet<> &Names) {
+  if (llvm::sys::fs::create_directories(llvm::sys::path::parent_path(Path)))
+    return;
+  // Write to a temporary file and rename it, so that concurrent compilations
+  // never see a partial listing.
+  int FD;
+  SmallString<256> TmpPath;
+  if (llvm::sys::fs::createUniqueFile(Path + "-%%%%%%%%", FD, TmpPath))
+    return;
+  {
+    llvm::raw_fd_ostream OS(FD, /*shouldClose=*/true);
+    OS << DirListingMagic << '\n' << Dir << '\n' << Stamp << '\n';
+    for (const auto &Name : Names)
+      OS << Name.getKey() << '\n';
+    OS.close();
+    if (OS.has_error()) {
+      OS.clear_error();
+      llvm::sys::fs::remove(TmpPath);
+      return;
+    }
+  }
+  if (llvm::sys::fs::rename(TmpPath, Path))
+    llvm::sys::fs::remove(TmpPath);
+}
+
+std::unique_ptr<HeaderSearch::DirListing>
+HeaderSearch::loadDirListing(const DirectoryEntry *Dir) {
+  auto Listing = std::make_unique<DirListing>();
+  llvm::vfs::FileSystem &FS = FileMgr.getVirtualFileSystem();
+  SmallString<256> DirName(Dir->getName());
+  if (FS.makeAbsolute(DirName))
+    return Listing;
+  llvm::ErrorOr<llvm::vfs::Status> Status = FS.status(DirName);
+  if (!Status)
+    return Listing;
+
+  // A saved listing is up to date as long as the modification time of the
+  // directory is unchanged. Overlays change what the directories contain, so
+  // listings are not saved when there are any.
+  SmallString<256> CachePath;
+  std::string Stamp;
+  if (!HSOpts->SearchDirListingsCachePath.empty() &&
+      HSOpts->VFSOverlayFiles.empty()) {
+    CachePath = HSOpts->SearchDirListingsCachePath;
+    llvm::sys::path::append(CachePath,
+                            llvm::utohexstr(llvm::xxHash64(DirName)));
+    Stamp = std::to_string(
+        Status->getLastModificationTime().time_since_epoch().count());
+    if (readDirListing(CachePath, DirName, Stamp, Listing->Names)) {
+      Listing->Valid = true;
+      return Listing;
+    }
+  }
+
+  std::error_code EC;
+  for (llvm::vfs::directory_iterator It = FS.dir_begin(DirName, EC), End;
+       !EC && It != End; It.increment(EC))
+    Listing->Names.insert(llvm::sys::path::filename(It->path()).lower());
+  if (EC) {
+    Listing->Names.clear();
+    return Listing;
+  }
+  Listing->Valid = true;
+
+  // A directory modified within the granularity of its timestamp may be
+  // modified again without its timestamp changing, so its listing isn't saved.
+  if (!CachePath.empty() &&
+      std::chrono::system_clock::now() - Status->getLastModificationTime() >
+          std::chrono::seconds(2))
+    writeDirListing(CachePath, DirName, Stamp, Listing->Names);
+  return Listing;
+}
+
+bool HeaderSearch::mayContainFile(const DirectoryEntry *Dir,
+                                  StringRef Filename) {
+  if (!HSOpts->CacheSearchDirListings &&
+      HSOpts->SearchDirListingsCachePath.empty())
+    return true;
+
+  // Only the first component of the name is looked up, which is enough to
+  // rule out most search directories.
+  auto Component = llvm::sys::path::begin(Filename);
+  if (Component == llvm::sys::path::end(Filename))
+    return true;
+  StringRef Name = *Component;
+  if (Name == "." || Name == "..")
+    return true;
+
+  std::unique_ptr<DirListing> &Listing = DirListings[Dir];
+  if (!Listing)
+    Listing = loadDirListing(Dir);
+  // Names are compared case-insensitively, so that case-insensitive file
+  // systems keep finding the headers. Elsewhere, this can only cause lookups
+  // that fail.
+  if (!Listing->Valid || Listing->Names.count(Name.lower()))
+    return true;
+  ++NumDirListingSkips;
+  return false;
+}
+
 /// LookupFile - Lookup the specified file in this search path, returning it
 /// if it exists or returning null if not.
 Optional<FileEntryRef> DirectoryLookup::LookupFile(
@@ -359,6 +494,9 @@ Optional<FileEntryRef> DirectoryLookup::LookupFile(
 
   SmallString<1024> TmpDir;
   if (isNormalDir()) {
+    if (!HS.mayContainFile(getDir(), Filename))
+      return None;
+
     // Concatenate the requested file onto the directory.
     TmpDir = getDir()->getName();
     llvm::sys::path::append(TmpDir, Filename);
@@ -47,8 +47,115 @@
 #include <tuple>
 #include <utility>
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#elif __ALTIVEC__
+#include <altivec.h>
+#undef bool
+#endif
+
 using namespace clang;
 
+//===----------------------------------------------------------------------===//
+// Character Run Scanning
+//===----------------------------------------------------------------------===//
+
+// These skip runs of characters that need no special handling, and return a
+// pointer to the first character that does, like the simple loops they replace.
+// With SSE2 they look at 16 characters at a time while those are all before
+// BufferEnd, then finish one character at a time.
+
+#ifdef __SSE2__
+/// Returns a mask of the characters in Chars that are in [Lo, Hi].
+static inline int inRangeMask(__m128i Chars, char Lo, char Hi) {
+  // Characters are compared as signed, which leaves out non-ASCII ones.
+  __m128i Ge = _mm_cmpgt_epi8(Chars, _mm_set1_epi8(Lo - 1));
+  __m128i Le = _mm_cmplt_epi8(Chars, _mm_set1_epi8(Hi + 1));
+  return _mm_movemask_epi8(_mm_and_si128(Ge, Le));
+}
+
+static inline int equalMask(__m128i Chars, char C) {
+  return _mm_movemask_epi8(_mm_cmpeq_epi8(Chars, _mm_set1_epi8(C)));
+}
+
+static inline __m128i load16(const char *Ptr) {
+  return _mm_loadu_si128(reinterpret_cast<const __m128i *>(Ptr));
+}
+#endif
+
+/// Skips [_A-Za-z0-9]*.
+static const char *skipIdentifierBody(const char *CurPtr,
+                                      const char *BufferEnd) {
+#ifdef __SSE2__
+  while (CurPtr + 16 <= BufferEnd) {
+    __m128i Chars = load16(CurPtr);
+    // Setting bit 5 maps upper case letters to lower case ones, and nothing
+    // else to a letter.
+    int Body = inRangeMask(_mm_or_si128(Chars, _mm_set1_epi8(0x20)), 'a', 'z') |
+               inRangeMask(Chars, '0', '9') | equalMask(Chars, '_');
+    if (Body != 0xFFFF)
+      return CurPtr + llvm::countTrailingOnes<unsigned>(Body);
+    CurPtr += 16;
+  }
+#endif
+  while (isIdentifierBody(*CurPtr))
+    ++CurPtr;
+  return CurPtr;
+}
+
+/// Skips [ \t\f\v]*.
+static const char *skipHorizontalWhitespace(const char *CurPtr,
+                                            const char *BufferEnd) {
+#ifdef __SSE2__
+  while (CurPtr + 16 <= BufferEnd) {
+    __m128i Chars = load16(CurPtr);
+    int Space = equalMask(Chars, ' ') | inRangeMask(Chars, '\t', '\t') |
+                inRangeMask(Chars, '\v', '\f');
+    if (Space != 0xFFFF)
+      return CurPtr + llvm::countTrailingOnes<unsigned>(Space);
+    CurPtr += 16;
+  }
+#endif
+  while (isHorizontalWhitespace(*CurPtr))
+    ++CurPtr;
+  return CurPtr;
+}
+
+/// Skips to the next newline or nul character.
+static const char *skipToLineEnd(const char *CurPtr, const char *BufferEnd) {
+#ifdef __SSE2__
+  while (CurPtr + 16 <= BufferEnd) {
+    __m128i Chars = load16(CurPtr);
+    int End = equalMask(Chars, '\n') | equalMask(Chars, '\r') |
+              equalMask(Chars, 0);
+    if (End != 0)
+      return CurPtr + llvm::countTrailingZeros<unsigned>(End);
+    CurPtr += 16;
+  }
+#endif
+  while (*CurPtr != 0 && *CurPtr != '\n' && *CurPtr != '\r')
+    ++CurPtr;
+  return CurPtr;
+}
+
+/// Skips the characters of a string literal that stand for themselves, i.e.
+/// anything but a quote, escape, trigraph, newline or nul character.
+static const char *skipPlainStringChars(const char *CurPtr,
+                                        const char *BufferEnd) {
+#ifdef __SSE2__
+  while (CurPtr + 16 <= BufferEnd) {
+    __m128i Chars = load16(CurPtr);
+    int Special = equalMask(Chars, '"') | equalMask(Chars, '\\') |
+                  equalMask(Chars, '?') | equalMask(Chars, '\n') |
+                  equalMask(Chars, '\r') | equalMask(Chars, 0);
+    if (Special != 0)
+      return CurPtr + llvm::countTrailingZeros<unsigned>(Special);
+    CurPtr += 16;
+  }
+#endif
+  return CurPtr;
+}
+
 //===----------------------------------------------------------------------===//
 // Token Class Implementation
 //===----------------------------------------------------------------------===//
@@ -1637,11 +1744,8 @@ bool Lexer::tryConsumeIdentifierUTF8Char(const char *&CurPtr) {
 bool Lexer::LexIdentifier(Token &Result, const char *CurPtr) {
   // Match [_A-Za-z0-9]*, we have already matched [_A-Za-z$]
   unsigned Size;
-  unsigned char C = *CurPtr++;
-  while (isIdentifierBody(C))
-    C = *CurPtr++;
-
-  --CurPtr;   // Back up over the skipped character.
+  CurPtr = skipIdentifierBody(CurPtr, BufferEnd);
+  unsigned char C = *CurPtr;
 
   // Fast path, no $,\,? in identifier found.  '\' might be an escaped newline
   // or UCN, and ? might be a trigraph for '\', an escaped newline or UCN.
@@ -1943,6 +2047,7 @@ bool Lexer::LexStringLiteral(Token &Result, const char *CurPtr,
 
       NulCharacter = CurPtr-1;
     }
+    CurPtr = skipPlainStringChars(CurPtr, BufferEnd);
     C = getAndAdvanceChar(CurPtr, Result);
   }
 
@@ -2192,8 +2297,10 @@ bool Lexer::SkipWhitespace(Token &Result, const char *CurPtr,
   // Skip consecutive spaces efficiently.
   while (true) {
     // Skip horizontal whitespace very aggressively.
-    while (isHorizontalWhitespace(Char))
-      Char = *++CurPtr;
+    if (isHorizontalWhitespace(Char)) {
+      CurPtr = skipHorizontalWhitespace(CurPtr, BufferEnd);
+      Char = *CurPtr;
+    }
 
     // Otherwise if we have something other than whitespace, we're done.
     if (!isVerticalWhitespace(Char))
@@ -2261,11 +2368,10 @@ bool Lexer::SkipLineComment(Token &Result, const char *CurPtr,
   // character that ends the line comment.
   char C;
   while (true) {
+    // Skip over characters in the fast loop, up to a newline, DOS-style
+    // newline or potential EOF.
+    CurPtr = skipToLineEnd(CurPtr, BufferEnd);
     C = *CurPtr;
-    // Skip over characters in the fast loop.
-    while (C != 0 &&                // Potentially EOF.
-           C != '\n' && C != '\r')  // Newline or DOS-style newline.
-      C = *++CurPtr;
 
     const char *NextLine = CurPtr;
     if (C != 0) {
@@ -2468,13 +2574,6 @@ static bool isEndOfBlockCommentWithEscapedNewLine(const char *CurPtr,
   return true;
 }
 
-#ifdef __SSE2__
-#include <emmintrin.h>
-#elif __ALTIVEC__
-#include <altivec.h>
-#undef bool
-#endif
-
 /// We have just read from input the / and * characters that started a comment.
 /// Read until we find the * and / characters that terminate the comment.
 /// Note that we don't bother decoding trigraphs or escaped newlines in block
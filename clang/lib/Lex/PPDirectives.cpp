@@ -372,19 +372,26 @@ SourceLocation Preprocessor::CheckEndOfDirective(const char *DirType,
 
 Optional<unsigned> Preprocessor::getSkippedRangeForExcludedConditionalBlock(
     SourceLocation HashLoc) {
-  if (!ExcludedConditionalDirectiveSkipMappings)
-    return None;
   if (!HashLoc.isFileID())
     return None;
 
   std::pair<FileID, unsigned> HashFileOffset =
       SourceMgr.getDecomposedLoc(HashLoc);
   const llvm::MemoryBuffer *Buf = SourceMgr.getBuffer(HashFileOffset.first);
-  auto It = ExcludedConditionalDirectiveSkipMappings->find(Buf);
-  if (It == ExcludedConditionalDirectiveSkipMappings->end())
-    return None;
+  const PreprocessorSkippedRangeMapping *Mapping = nullptr;
+  if (ExcludedConditionalDirectiveSkipMappings) {
+    auto It = ExcludedConditionalDirectiveSkipMappings->find(Buf);
+    if (It != ExcludedConditionalDirectiveSkipMappings->end())
+      Mapping = It->getSecond();
+  }
+  if (!Mapping) {
+    auto It = SkippedRangesCache.find(Buf);
+    if (It == SkippedRangesCache.end())
+      return None;
+    Mapping = &It->getSecond();
+  }
 
-  const PreprocessorSkippedRangeMapping &SkippedRanges = *It->getSecond();
+  const PreprocessorSkippedRangeMapping &SkippedRanges = *Mapping;
   // Check if the offset of '#' is mapped in the skipped ranges.
   auto MappingIt = SkippedRanges.find(HashFileOffset.second);
   if (MappingIt == SkippedRanges.end())
@@ -401,6 +408,18 @@ Optional<unsigned> Preprocessor::getSkippedRangeForExcludedConditionalBlock(
   return BytesToSkip - LengthDiff;
 }
 
+void Preprocessor::cacheSkippedRange(SourceLocation HashLoc,
+                                     SourceLocation NextHashLoc) {
+  if (!HashLoc.isFileID() || !NextHashLoc.isFileID())
+    return;
+  std::pair<FileID, unsigned> Start = SourceMgr.getDecomposedLoc(HashLoc);
+  std::pair<FileID, unsigned> End = SourceMgr.getDecomposedLoc(NextHashLoc);
+  if (Start.first != End.first || End.second <= Start.second)
+    return;
+  const llvm::MemoryBuffer *Buf = SourceMgr.getBuffer(Start.first);
+  SkippedRangesCache[Buf][Start.second] = End.second - Start.second;
+}
+
 /// SkipExcludedConditionalBlock - We just read a \#if or related directive and
 /// decided that the subsequent tokens are in the \#if'd out portion of the
 /// file.  Lex the rest of the file, until we see an \#endif.  If
@@ -417,6 +436,14 @@ void Preprocessor::SkipExcludedConditionalBlock(SourceLocation HashTokenLoc,
   ++NumSkipped;
   assert(!CurTokenLexer && CurPPLexer && "Lexing a macro, not a file?");
 
+  // The ranges between the directives of this conditional are cached, unless
+  // the lexer doesn't start at the directive, or skipping a range silently
+  // would lose something (a code completion point or an error).
+  bool CacheRanges = !isCodeCompletionEnabled() &&
+                     !PreambleConditionalStack.reachedEOFWhileSkipping();
+  SourceLocation RangeStart = HashTokenLoc;
+  bool RangeHasErrors = false;
+
   if (PreambleConditionalStack.reachedEOFWhileSkipping())
     PreambleConditionalStack.clearSkipInfo();
   else
@@ -431,6 +458,7 @@ void Preprocessor::SkipExcludedConditionalBlock(SourceLocation HashTokenLoc,
           getSkippedRangeForExcludedConditionalBlock(HashTokenLoc)) {
     // Skip to the next '#endif' / '#else' / '#elif'.
     CurLexer->skipOver(*SkipLength);
+    ++NumSkippedFromCache;
   }
   while (true) {
     CurLexer->Lex(Tok);
@@ -456,6 +484,7 @@ void Preprocessor::SkipExcludedConditionalBlock(SourceLocation HashTokenLoc,
     // If this token is not a preprocessor directive, just skip it.
     if (Tok.isNot(tok::hash) || !Tok.isAtStartOfLine())
       continue;
+    SourceLocation DirectiveHashLoc = Tok.getLocation();
 
     // We just parsed a # character at the start of a line, so we're in
     // directive mode.  Tell the lexer this so any newlines we see will be
@@ -535,6 +564,8 @@ void Preprocessor::SkipExcludedConditionalBlock(SourceLocation HashTokenLoc,
 
         // If we popped the outermost skipping block, we're done skipping!
         if (!CondInfo.WasSkipping) {
+          if (CacheRanges && !RangeHasErrors)
+            cacheSkippedRange(RangeStart, DirectiveHashLoc);
           // Restore the value of LexingRawMode so that trailing comments
           // are handled correctly, if we've reached the outermost block.
           CurPPLexer->LexingRawMode = false;
@@ -552,8 +583,18 @@ void Preprocessor::SkipExcludedConditionalBlock(SourceLocation HashTokenLoc,
         // as a non-skipping conditional.
         PPConditionalInfo &CondInfo = CurPPLexer->peekConditionalLevel();
 
+        if (!CondInfo.WasSkipping) {
+          if (CacheRanges && !RangeHasErrors)
+            cacheSkippedRange(RangeStart, DirectiveHashLoc);
+          RangeStart = DirectiveHashLoc;
+          RangeHasErrors = false;
+        }
+
         // If this is a #else with a #else before it, report the error.
-        if (CondInfo.FoundElse) Diag(Tok, diag::pp_err_else_after_else);
+        if (CondInfo.FoundElse) {
+          Diag(Tok, diag::pp_err_else_after_else);
+          RangeHasErrors |= CondInfo.WasSkipping;
+        }
 
         // Note that we've seen a #else in this conditional.
         CondInfo.FoundElse = true;
@@ -576,8 +617,18 @@ void Preprocessor::SkipExcludedConditionalBlock(SourceLocation HashTokenLoc,
       } else if (Sub == "lif") {  // "elif".
         PPConditionalInfo &CondInfo = CurPPLexer->peekConditionalLevel();
 
+        if (!CondInfo.WasSkipping) {
+          if (CacheRanges && !RangeHasErrors)
+            cacheSkippedRange(RangeStart, DirectiveHashLoc);
+          RangeStart = DirectiveHashLoc;
+          RangeHasErrors = false;
+        }
+
         // If this is a #elif with a #else before it, report the error.
-        if (CondInfo.FoundElse) Diag(Tok, diag::pp_err_elif_after_else);
+        if (CondInfo.FoundElse) {
+          Diag(Tok, diag::pp_err_elif_after_else);
+          RangeHasErrors |= CondInfo.WasSkipping;
+        }
 
         // If this is in a skipping block or if we're already handled this #if
         // block, don't bother parsing the condition.
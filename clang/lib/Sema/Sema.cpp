@@ -981,6 +981,15 @@ void Sema::ActOnEndOfTranslationUnit() {
                                  LateParsedInstantiations.begin(),
                                  LateParsedInstantiations.end());
     LateParsedInstantiations.clear();
+
+    // Under -fpch-instantiate-templates, the instantiations are stored in the
+    // PCH, so that its users do not perform them again. Late-parsed templates
+    // are not parsed until the PCH is used, so they are left pending.
+    if (LangOpts.PCHInstantiateTemplates && !LangOpts.DelayedTemplateParsing) {
+      llvm::TimeTraceScope TimeScope("PerformPendingInstantiations",
+                                     StringRef(""));
+      PerformPendingInstantiations();
+    }
   }
 
   DiagnoseUnterminatedPragmaPack();
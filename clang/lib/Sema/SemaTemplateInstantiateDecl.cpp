@@ -4703,6 +4703,14 @@ void Sema::InstantiateVariableDefinition(SourceLocation PointOfInstantiation,
   MultiLevelTemplateArgumentList TemplateArgs =
       getTemplateInstantiationArgs(Var);
 
+  llvm::TimeTraceScope TimeScope("InstantiateVariable", [&]() {
+    std::string Name;
+    llvm::raw_string_ostream OS(Name);
+    Var->getNameForDiagnostic(OS, getPrintingPolicy(),
+                              /*Qualified=*/true);
+    return Name;
+  });
+
   VarTemplateSpecializationDecl *VarSpec =
       dyn_cast<VarTemplateSpecializationDecl>(Var);
   if (VarSpec) {
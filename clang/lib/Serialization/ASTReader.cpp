@@ -102,6 +102,7 @@
 #include "llvm/ADT/Triple.h"
 #include "llvm/ADT/iterator_range.h"
 #include "llvm/Bitstream/BitstreamReader.h"
+#include "llvm/Config/llvm-config.h"
 #include "llvm/Support/Casting.h"
 #include "llvm/Support/Compiler.h"
 #include "llvm/Support/Compression.h"
@@ -112,6 +113,7 @@
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
+#include "llvm/Support/Process.h"
 #include "llvm/Support/SaveAndRestore.h"
 #include "llvm/Support/Timer.h"
 #include "llvm/Support/VersionTuple.h"
@@ -4096,6 +4098,22 @@ static bool SkipCursorToBlock(BitstreamCursor &Cursor, unsigned BlockID) {
   }
 }
 
+#if LLVM_ENABLE_THREADS
+/// Reads a byte of each page of \p Buffers, so that the pages of memory-mapped
+/// module files are in memory by the time deserialization needs them.
+static void prefetchModuleFiles(std::vector<StringRef> Buffers,
+                                const std::atomic<bool> &Stop) {
+  const size_t PageSize = llvm::sys::Process::getPageSizeEstimate();
+  unsigned char Sum = 0;
+  for (StringRef Buffer : Buffers)
+    for (size_t I = 0; I < Buffer.size() && !Stop; I += PageSize)
+      Sum += Buffer[I];
+  // Don't let the reads be optimized away.
+  static volatile unsigned char Sink;
+  Sink = Sum;
+}
+#endif
+
 ASTReader::ASTReadResult ASTReader::ReadAST(StringRef FileName,
                                             ModuleKind Type,
                                             SourceLocation ImportLoc,
@@ -4225,6 +4243,20 @@ ASTReader::ASTReadResult ASTReader::ReadAST(StringRef FileName,
       F.ImportLoc = TranslateSourceLocation(*M->ImportedBy, M->ImportLoc);
   }
 
+#if LLVM_ENABLE_THREADS
+  // The module files have been accepted, so their buffers stay alive until
+  // the reader goes away. Declarations can only be deserialized on this
+  // thread, but reading the files can overlap with the rest of the work.
+  if (PP.getHeaderSearchInfo().getHeaderSearchOpts().ModulesPrefetch &&
+      !Loaded.empty()) {
+    std::vector<StringRef> Buffers;
+    for (const ImportedModule &IM : Loaded)
+      Buffers.push_back(IM.Mod->Buffer->getBuffer());
+    PrefetchThreads.emplace_back(prefetchModuleFiles, std::move(Buffers),
+                                 std::ref(StopPrefetching));
+  }
+#endif
+
   if (!PP.getLangOpts().CPlusPlus ||
       (Type != MK_ImplicitModule && Type != MK_ExplicitModule &&
        Type != MK_PrebuiltModule)) {
@@ -12184,6 +12216,9 @@ ASTReader::ASTReader(Preprocessor &PP, InMemoryModuleCache &ModuleCache,
 }
 
 ASTReader::~ASTReader() {
+  StopPrefetching = true;
+  for (std::thread &T : PrefetchThreads)
+    T.join();
   if (OwnsDeserializationListener)
     delete DeserializationListener;
 }
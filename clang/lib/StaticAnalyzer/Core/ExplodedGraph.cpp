@@ -169,7 +169,7 @@ void ExplodedGraph::collectNode(ExplodedNode *node) {
 }
 
 void ExplodedGraph::reclaimRecentlyAllocatedNodes() {
-  if (ChangedNodes.empty())
+  if (ChangedNodes.empty() && FrontierNodes.empty())
     return;
 
   // Only periodically reclaim nodes so that we can build up a set of
@@ -180,9 +180,20 @@ void ExplodedGraph::reclaimRecentlyAllocatedNodes() {
     return;
   ReclaimCounter = ReclaimNodeInterval;
 
-  for (const auto node : ChangedNodes)
+  // The nodes created last in this round are usually still on the frontier.
+  // Give them one more chance in the next round, when most of them will have
+  // a successor, instead of keeping them for the rest of the analysis.
+  for (const auto node : FrontierNodes)
     if (shouldCollect(node))
       collectNode(node);
+  FrontierNodes.clear();
+
+  for (const auto node : ChangedNodes) {
+    if (shouldCollect(node))
+      collectNode(node);
+    else if (node->succ_empty())
+      FrontierNodes.push_back(node);
+  }
   ChangedNodes.clear();
 }
 
@@ -33,6 +33,8 @@
 #include "clang/StaticAnalyzer/Core/PathSensitive/AnalysisManager.h"
 #include "clang/StaticAnalyzer/Core/PathSensitive/ExprEngine.h"
 #include "clang/StaticAnalyzer/Frontend/CheckerRegistration.h"
+#include "llvm/ADT/DepthFirstIterator.h"
+#include "llvm/ADT/EquivalenceClasses.h"
 #include "llvm/ADT/PostOrderIterator.h"
 #include "llvm/ADT/Statistic.h"
 #include "llvm/Support/FileSystem.h"
@@ -40,7 +42,9 @@
 #include "llvm/Support/Program.h"
 #include "llvm/Support/Timer.h"
 #include "llvm/Support/raw_ostream.h"
+#include <algorithm>
 #include <memory>
+#include <numeric>
 #include <queue>
 #include <utility>
 
@@ -59,6 +63,9 @@ STATISTIC(NumVisitedBlocksInAnalyzedFunctions,
           "The # of visited basic blocks in the analyzed functions.");
 STATISTIC(PercentReachableBlocks, "The % of reachable basic blocks.");
 STATISTIC(MaxCFGSize, "The maximum number of basic blocks in a function.");
+STATISTIC(MaxPathSensitiveMemoryKB,
+          "The maximum memory (in KiB) allocated for the path-sensitive "
+          "analysis of a function.");
 
 //===----------------------------------------------------------------------===//
 // Special PathDiagnosticConsumers.
@@ -188,6 +195,12 @@ class AnalysisConsumer : public AnalysisASTConsumer,
   /// Bug Reporter to use while recursively visiting Decls.
   BugReporter *RecVisitorBR;
 
+  /// The shard of each analysis root when the analysis of the translation
+  /// unit is split with the 'shard-count' option.
+  llvm::DenseMap<const Decl *, unsigned> ShardOfDecl;
+  /// The shard of the next root which is not part of the call graph.
+  unsigned NextShard = 0;
+
   std::vector<std::function<void(CheckerRegistry &)>> CheckerRegistrationFns;
 
 public:
@@ -465,6 +478,15 @@ private:
 
   /// Check if we should skip (not analyze) the given function.
   AnalysisMode getModeForDecl(Decl *D, AnalysisMode Mode);
+
+  /// Split the functions of \p CG into 'shard-count' shards. Functions which
+  /// are connected in the call graph end up in the same shard, so that the
+  /// shards inline and skip the same functions as an unsplit analysis.
+  void assignShards(CallGraph &CG);
+
+  /// Return the shard in which \p D is analyzed path-sensitively.
+  unsigned getShardForDecl(const Decl *D);
+
   void runAnalysisOnTranslationUnit(ASTContext &C);
 
   /// Print \p S to stderr if \c Opts->AnalyzerDisplayProgress is set.
@@ -555,6 +577,9 @@ void AnalysisConsumer::HandleDeclsCallGraph(const unsigned LocalTUDeclsSize) {
   // inlined functions. The topological order allows the "do not reanalyze
   // previously inlined function" performance heuristic to be triggered more
   // often.
+  if (Opts->ShardCount > 1)
+    assignShards(CG);
+
   SetOfConstDecls Visited;
   SetOfConstDecls VisitedAsTopLevel;
   llvm::ReversePostOrderTraversal<clang::CallGraph*> RPOT(&CG);
@@ -590,6 +615,69 @@ void AnalysisConsumer::HandleDeclsCallGraph(const unsigned LocalTUDeclsSize) {
   }
 }
 
+void AnalysisConsumer::assignShards(CallGraph &CG) {
+  // Functions reachable from one another in the call graph may be inlined
+  // into each other, so they have to be analyzed by the same process. Group
+  // them into the weakly connected components of the call graph.
+  llvm::EquivalenceClasses<const Decl *> Components;
+  for (CallGraphNode *N : llvm::depth_first(CG.getRoot())) {
+    const Decl *D = N->getDecl();
+    if (!D)
+      continue;
+    Components.insert(D);
+    for (CallGraphNode *Callee : *N)
+      if (const Decl *CalleeD = Callee->getDecl())
+        Components.unionSets(D, CalleeD);
+  }
+
+  // Number the components in the order in which they are visited; the
+  // assignment has to be the same in every process analyzing this TU.
+  llvm::DenseMap<const Decl *, unsigned> ComponentOfLeader;
+  SmallVector<unsigned, 32> ComponentSizes;
+  SmallVector<std::pair<const Decl *, unsigned>, 64> DeclComponents;
+  llvm::ReversePostOrderTraversal<clang::CallGraph *> RPOT(&CG);
+  for (CallGraphNode *N : RPOT) {
+    const Decl *D = N->getDecl();
+    if (!D)
+      continue;
+    auto Inserted = ComponentOfLeader.try_emplace(
+        Components.getLeaderValue(D), ComponentSizes.size());
+    if (Inserted.second)
+      ComponentSizes.push_back(0);
+    unsigned Component = Inserted.first->second;
+    ++ComponentSizes[Component];
+    DeclComponents.emplace_back(D, Component);
+  }
+
+  // Hand out the components, largest first, to the least loaded shard.
+  SmallVector<unsigned, 32> Order(ComponentSizes.size());
+  std::iota(Order.begin(), Order.end(), 0);
+  llvm::stable_sort(Order, [&](unsigned L, unsigned R) {
+    return ComponentSizes[L] > ComponentSizes[R];
+  });
+  SmallVector<unsigned, 8> ShardSizes(Opts->ShardCount, 0);
+  SmallVector<unsigned, 32> ShardOfComponent(ComponentSizes.size());
+  for (unsigned Component : Order) {
+    unsigned Shard =
+        std::min_element(ShardSizes.begin(), ShardSizes.end()) -
+        ShardSizes.begin();
+    ShardOfComponent[Component] = Shard;
+    ShardSizes[Shard] += ComponentSizes[Component];
+  }
+
+  for (const auto &DC : DeclComponents)
+    ShardOfDecl[DC.first] = ShardOfComponent[DC.second];
+}
+
+unsigned AnalysisConsumer::getShardForDecl(const Decl *D) {
+  // Decls which are not in the call graph, e.g. the ones analyzed without
+  // inlining, are dealt out in the deterministic order they are visited in.
+  auto Inserted = ShardOfDecl.try_emplace(D, NextShard);
+  if (Inserted.second)
+    NextShard = (NextShard + 1) % Opts->ShardCount;
+  return Inserted.first->second;
+}
+
 static bool isBisonFile(ASTContext &C) {
   const SourceManager &SM = C.getSourceManager();
   FileID FID = SM.getMainFileID();
@@ -602,11 +690,16 @@ static bool isBisonFile(ASTContext &C) {
 void AnalysisConsumer::runAnalysisOnTranslationUnit(ASTContext &C) {
   BugReporter BR(*Mgr);
   TranslationUnitDecl *TU = C.getTranslationUnitDecl();
-  if (SyntaxCheckTimer)
-    SyntaxCheckTimer->startTimer();
-  checkerMgr->runCheckersOnASTDecl(TU, *Mgr, BR);
-  if (SyntaxCheckTimer)
-    SyntaxCheckTimer->stopTimer();
+  // When the analysis is split into shards, the AST-only checks only run in
+  // the first one.
+  const bool RunSyntaxChecks = Opts->ShardIndex == 0;
+  if (RunSyntaxChecks) {
+    if (SyntaxCheckTimer)
+      SyntaxCheckTimer->startTimer();
+    checkerMgr->runCheckersOnASTDecl(TU, *Mgr, BR);
+    if (SyntaxCheckTimer)
+      SyntaxCheckTimer->stopTimer();
+  }
 
   // Run the AST-only checks using the order in which functions are defined.
   // If inlining is not turned on, use the simplest function order for path
@@ -631,7 +724,8 @@ void AnalysisConsumer::runAnalysisOnTranslationUnit(ASTContext &C) {
     HandleDeclsCallGraph(LocalTUDeclsSize);
 
   // After all decls handled, run checkers on the entire TranslationUnit.
-  checkerMgr->runCheckersOnEndOfTranslationUnit(TU, *Mgr, BR);
+  if (RunSyntaxChecks)
+    checkerMgr->runCheckersOnEndOfTranslationUnit(TU, *Mgr, BR);
 
   BR.FlushReports();
   RecVisitorBR = nullptr;
@@ -756,7 +850,16 @@ AnalysisConsumer::getModeForDecl(Decl *D, AnalysisMode Mode) {
   if (!Opts->AnalyzeAll && !Mgr->isInCodeFile(SL)) {
     if (SL.isInvalid() || SM.isInSystemHeader(SL))
       return AM_None;
-    return Mode & ~AM_Path;
+    Mode &= ~AM_Path;
+  }
+
+  // When the analysis is split into shards, run the AST-only checks in the
+  // first shard and the path-sensitive analysis of each root in its shard.
+  if (Opts->ShardCount > 1) {
+    if (Opts->ShardIndex != 0)
+      Mode &= ~AM_Syntax;
+    if ((Mode & AM_Path) && getShardForDecl(D) != Opts->ShardIndex)
+      Mode &= ~AM_Path;
   }
 
   return Mode;
@@ -827,6 +930,15 @@ void AnalysisConsumer::RunPathSensitiveChecks(Decl *D,
   if (ExprEngineTimer)
     ExprEngineTimer->stopTimer();
 
+  // The states, the store and the environment are allocated with the
+  // allocator of the exploded graph as well.
+  size_t Memory = Eng.getGraph().getAllocator().getTotalMemory();
+  MaxPathSensitiveMemoryKB.updateMax(Memory / 1024);
+  if (Mgr->options.DisplayMemoryUsage)
+    llvm::errs() << "MEMORY: " << getFunctionName(D) << ": "
+                 << Eng.getGraph().size() << " nodes, " << Memory / 1024
+                 << " KiB\n";
+
   if (!Mgr->options.DumpExplodedGraphTo.empty())
     Eng.DumpGraph(Mgr->options.TrimGraph, Mgr->options.DumpExplodedGraphTo);
 
@@ -7,6 +7,7 @@
 //===----------------------------------------------------------------------===//
 
 #include "clang/Tooling/DependencyScanning/DependencyScanningService.h"
+#include "clang/Serialization/InMemoryModuleCache.h"
 
 using namespace clang;
 using namespace tooling;
@@ -14,6 +15,33 @@ using namespace dependencies;
 
 DependencyScanningService::DependencyScanningService(ScanningMode Mode,
                                                      bool ReuseFileManager,
-                                                     bool SkipExcludedPPRanges)
+                                                     bool SkipExcludedPPRanges,
+                                                     bool ShareModules)
     : Mode(Mode), ReuseFileManager(ReuseFileManager),
-      SkipExcludedPPRanges(SkipExcludedPPRanges) {}
+      SkipExcludedPPRanges(SkipExcludedPPRanges), ShareModules(ShareModules) {}
+
+void DependencyScanningModuleCache::addTo(InMemoryModuleCache &Cache) {
+  std::unique_lock<std::mutex> LockGuard(Lock);
+  for (const auto &PCM : PCMs) {
+    if (Cache.getPCMState(PCM.getKey()) != InMemoryModuleCache::Unknown)
+      continue;
+    // The buffers stay owned by the service, which outlives the invocations.
+    Cache.addBuiltPCM(PCM.getKey(),
+                      llvm::MemoryBuffer::getMemBuffer(
+                          PCM.getValue()->getMemBufferRef(),
+                          /*RequiresNullTerminator=*/false));
+  }
+}
+
+void DependencyScanningModuleCache::addFrom(const InMemoryModuleCache &Cache,
+                                            ArrayRef<std::string> FileNames) {
+  std::unique_lock<std::mutex> LockGuard(Lock);
+  for (const std::string &FileName : FileNames) {
+    if (PCMs.count(FileName) || !Cache.isPCMFinal(FileName))
+      continue;
+    // The buffer in Cache goes away with the invocation, so keep a copy.
+    const llvm::MemoryBuffer *Buffer = Cache.lookupPCM(FileName);
+    PCMs[FileName] =
+        llvm::MemoryBuffer::getMemBufferCopy(Buffer->getBuffer(), FileName);
+  }
+}
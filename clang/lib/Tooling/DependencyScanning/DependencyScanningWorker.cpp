@@ -13,8 +13,13 @@
 #include "clang/Frontend/TextDiagnosticPrinter.h"
 #include "clang/Frontend/Utils.h"
 #include "clang/Lex/PreprocessorOptions.h"
+#include "clang/Serialization/ASTReader.h"
+#include "clang/Serialization/InMemoryModuleCache.h"
 #include "clang/Tooling/DependencyScanning/DependencyScanningService.h"
 #include "clang/Tooling/Tooling.h"
+#include "llvm/Support/Threading.h"
+#include <atomic>
+#include <thread>
 
 using namespace clang;
 using namespace tooling;
@@ -72,16 +77,24 @@ public:
   DependencyScanningAction(
       StringRef WorkingDirectory, DependencyConsumer &Consumer,
       llvm::IntrusiveRefCntPtr<DependencyScanningWorkerFilesystem> DepFS,
-      ExcludedPreprocessorDirectiveSkipMapping *PPSkipMappings)
+      ExcludedPreprocessorDirectiveSkipMapping *PPSkipMappings,
+      DependencyScanningModuleCache *SharedModules)
       : WorkingDirectory(WorkingDirectory), Consumer(Consumer),
-        DepFS(std::move(DepFS)), PPSkipMappings(PPSkipMappings) {}
+        DepFS(std::move(DepFS)), PPSkipMappings(PPSkipMappings),
+        SharedModules(SharedModules) {}
 
   bool runInvocation(std::shared_ptr<CompilerInvocation> Invocation,
                      FileManager *FileMgr,
                      std::shared_ptr<PCHContainerOperations> PCHContainerOps,
                      DiagnosticConsumer *DiagConsumer) override {
+    // Start from the modules that other invocations already loaded.
+    IntrusiveRefCntPtr<InMemoryModuleCache> ModuleCache =
+        new InMemoryModuleCache();
+    if (SharedModules)
+      SharedModules->addTo(*ModuleCache);
+
     // Create a compiler instance to handle the actual work.
-    CompilerInstance Compiler(std::move(PCHContainerOps));
+    CompilerInstance Compiler(std::move(PCHContainerOps), ModuleCache.get());
     Compiler.setInvocation(std::move(Invocation));
 
     // Don't print 'X warnings and Y errors generated'.
@@ -139,6 +152,15 @@ public:
     const bool Result = Compiler.ExecuteAction(*Action);
     if (!DepFS)
       FileMgr->clearStatCache();
+
+    // Share the modules that were built or loaded by this invocation.
+    if (SharedModules)
+      if (IntrusiveRefCntPtr<ASTReader> Reader = Compiler.getModuleManager()) {
+        std::vector<std::string> FileNames;
+        for (const serialization::ModuleFile &MF : Reader->getModuleManager())
+          FileNames.push_back(MF.FileName);
+        SharedModules->addFrom(*ModuleCache, FileNames);
+      }
     return Result;
   }
 
@@ -147,12 +169,14 @@ private:
   DependencyConsumer &Consumer;
   llvm::IntrusiveRefCntPtr<DependencyScanningWorkerFilesystem> DepFS;
   ExcludedPreprocessorDirectiveSkipMapping *PPSkipMappings;
+  DependencyScanningModuleCache *SharedModules;
 };
 
 } // end anonymous namespace
 
 DependencyScanningWorker::DependencyScanningWorker(
-    DependencyScanningService &Service) {
+    DependencyScanningService &Service)
+    : SharedModules(Service.getSharedModuleCache()) {
   DiagOpts = new DiagnosticOptions();
   PCHContainerOps = std::make_shared<PCHContainerOperations>();
   RealFS = new ProxyFileSystemWithoutChdir(llvm::vfs::getRealFileSystem());
@@ -195,7 +219,37 @@ llvm::Error DependencyScanningWorker::computeDependencies(
     Tool.setPrintErrorMessage(false);
     Tool.setDiagnosticConsumer(&DC);
     DependencyScanningAction Action(WorkingDirectory, Consumer, DepFS,
-                                    PPSkipMappings.get());
+                                    PPSkipMappings.get(), SharedModules);
     return !Tool.run(&Action);
   });
 }
+
+void dependencies::scanInParallel(
+    DependencyScanningService &Service, size_t NumInputs, unsigned NumWorkers,
+    llvm::function_ref<void(DependencyScanningWorker &Worker, size_t Index)>
+        Scan) {
+#if LLVM_ENABLE_THREADS
+  if (NumWorkers == 0)
+    NumWorkers = llvm::hardware_concurrency();
+#else
+  NumWorkers = 1;
+#endif
+  NumWorkers = std::max(1u, std::min<unsigned>(NumWorkers, NumInputs));
+
+  std::atomic<size_t> NextInput(0);
+  auto RunWorker = [&] {
+    DependencyScanningWorker Worker(Service);
+    for (size_t I = NextInput++; I < NumInputs; I = NextInput++)
+      Scan(Worker, I);
+  };
+#if LLVM_ENABLE_THREADS
+  std::vector<std::thread> Threads;
+  for (unsigned I = 1; I < NumWorkers; ++I)
+    Threads.emplace_back(RunWorker);
+  RunWorker();
+  for (std::thread &T : Threads)
+    T.join();
+#else
+  RunWorker();
+#endif
+}
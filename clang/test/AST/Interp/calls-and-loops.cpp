@@ -0,0 +1,91 @@
+// RUN: %clang_cc1 -std=c++14 -fsyntax-only -fforce-experimental-new-constant-interpreter -verify %s
+// RUN: %clang_cc1 -std=c++14 -fsyntax-only -verify %s
+// expected-no-diagnostics
+
+constexpr int add(int a, int b) { return a + b; }
+static_assert(add(2, 3) == 5, "");
+
+constexpr int twice(int a) { return add(a, a); }
+static_assert(twice(21) == 42, "");
+
+constexpr int withDefault(int a, int b = 10) { return a - b; }
+static_assert(withDefault(15) == 5, "");
+static_assert(withDefault(15, 5) == 10, "");
+
+constexpr int sumTo(int n) {
+  int s = 0;
+  for (int i = 1; i <= n; ++i)
+    s += i;
+  return s;
+}
+static_assert(sumTo(100) == 5050, "");
+
+constexpr int countDigits(unsigned n) {
+  int c = 0;
+  do {
+    n /= 10u;
+    c++;
+  } while (n != 0u);
+  return c;
+}
+static_assert(countDigits(0u) == 1, "");
+static_assert(countDigits(12345u) == 5, "");
+
+constexpr int gcd(int a, int b) {
+  while (b != 0) {
+    int t = a % b;
+    a = b;
+    b = t;
+  }
+  return a;
+}
+static_assert(gcd(48, 18) == 6, "");
+
+constexpr int firstMultiple(int n, int k) {
+  for (int i = 1;; ++i) {
+    if (i % k != 0)
+      continue;
+    if (i >= n)
+      return i;
+  }
+}
+static_assert(firstMultiple(10, 7) == 14, "");
+
+constexpr int breakOut(int n) {
+  int i = 0;
+  while (true) {
+    if (i * i > n)
+      break;
+    ++i;
+  }
+  return i - 1;
+}
+static_assert(breakOut(50) == 7, "");
+
+constexpr int postIncrement(int a) {
+  int b = a++;
+  int c = a--;
+  return b * 100 + c * 10 + a;
+}
+static_assert(postIncrement(1) == 121, "");
+
+constexpr unsigned bits(unsigned a, unsigned b) {
+  return ((a & b) | (a ^ b)) & ~0u;
+}
+static_assert(bits(12u, 10u) == 14u, "");
+
+constexpr bool inRange(int x, int lo, int hi) {
+  return lo <= x && x < hi;
+}
+static_assert(inRange(3, 0, 5), "");
+static_assert(!inRange(5, 0, 5), "");
+static_assert(inRange(1, 0, 2) || inRange(10, 0, 2), "");
+
+constexpr int sign(int x) { return x < 0 ? -1 : x > 0 ? 1 : 0; }
+static_assert(sign(-5) == -1 && sign(0) == 0 && sign(7) == 1, "");
+
+constexpr long long widen(int x) { return x; }
+static_assert(widen(-1) == -1LL, "");
+
+constexpr bool isOdd(int x) { return x % 2; }
+static_assert(isOdd(3) && !isOdd(4), "");
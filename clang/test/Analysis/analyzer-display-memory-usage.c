@@ -0,0 +1,15 @@
+// RUN: %clang_analyze_cc1 -analyzer-checker=core %s \
+// RUN:   -analyzer-config display-memory-usage=true 2>&1 | FileCheck %s
+
+int callee(int x) { return x + 1; }
+
+int f(int x) {
+  if (x > 0)
+    return callee(x);
+  return 0;
+}
+
+// 'callee' is inlined into 'f' and not analyzed on its own.
+// CHECK-NOT: MEMORY: callee
+// CHECK: MEMORY: f: {{[0-9]+}} nodes, {{[0-9]+}} KiB
+// CHECK-NOT: MEMORY:
@@ -0,0 +1,31 @@
+// RUN: %clang_analyze_cc1 -analyzer-checker=core -verify=shard0 %s \
+// RUN:   -analyzer-config shard-count=2 -analyzer-config shard-index=0
+// RUN: %clang_analyze_cc1 -analyzer-checker=core -verify=shard1 %s \
+// RUN:   -analyzer-config shard-count=2 -analyzer-config shard-index=1
+
+// RUN: not %clang_analyze_cc1 -analyzer-checker=core %s \
+// RUN:   -analyzer-config shard-count=2 -analyzer-config shard-index=2 \
+// RUN:   2>&1 | FileCheck %s -check-prefix=CHECK-INVALID-INDEX
+// CHECK-INVALID-INDEX: (frontend): invalid input for analyzer-config option
+// CHECK-INVALID-INDEX-SAME: 'shard-index'
+
+// RUN: not %clang_analyze_cc1 -analyzer-checker=core %s \
+// RUN:   -analyzer-config shard-count=0 \
+// RUN:   2>&1 | FileCheck %s -check-prefix=CHECK-INVALID-COUNT
+// CHECK-INVALID-COUNT: (frontend): invalid input for analyzer-config option
+// CHECK-INVALID-COUNT-SAME: 'shard-count'
+
+// The caller and the callee are analyzed in the same shard, so the callee is
+// inlined and not analyzed again as a top-level function.
+int callee(int *p) {
+  return *p; // shard0-warning{{Dereference of null pointer (loaded from variable 'p')}}
+}
+
+int caller() {
+  return callee(0);
+}
+
+void unrelated() {
+  int *p = 0;
+  *p = 1; // shard1-warning{{Dereference of null pointer (loaded from variable 'p')}}
+}
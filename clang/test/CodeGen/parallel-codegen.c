@@ -0,0 +1,31 @@
+// REQUIRES: x86-registered-target
+// RUN: rm -rf %t && mkdir %t
+// RUN: %clang_cc1 -triple x86_64-unknown-linux -fparallel-codegen=2 -emit-obj \
+// RUN:   -o %t/out.o %s
+// RUN: llvm-nm %t/out.o %t/out.1.o | FileCheck %s
+//
+// Static functions stay local to the partition of their callers.
+// CHECK-DAG: T f1
+// CHECK-DAG: T f2
+// CHECK-DAG: T f3
+// CHECK-DAG: t helper
+// CHECK-DAG: D global
+
+// Nothing is split when writing to stdout.
+// RUN: %clang_cc1 -triple x86_64-unknown-linux -fparallel-codegen=2 -emit-obj \
+// RUN:   -o - %s | llvm-nm - | FileCheck --check-prefix=STDOUT %s
+// STDOUT: T f1
+// STDOUT: T f2
+// STDOUT: T f3
+
+// RUN: %clang -### -target x86_64-unknown-linux -fparallel-codegen=4 -c %s 2>&1 \
+// RUN:   | FileCheck --check-prefix=DRIVER %s
+// DRIVER: "-cc1"{{.*}} "-fparallel-codegen=4"
+
+int global = 1;
+
+static int helper(int x) { return x * global; }
+
+int f1(int x) { return helper(x) + 1; }
+int f2(int x) { return helper(x) + 2; }
+int f3(int x) { return x + 3; }
@@ -0,0 +1,21 @@
+// RUN: %clangxx -S -std=c++14 -ftime-trace -ftime-trace-granularity=0 -o %T/check-time-trace-summary %s
+// RUN: %python %S/../../utils/time-trace-summary.py --events 'Instantiate|Evaluate|Overload|CodeGen' \
+// RUN:   %T/check-time-trace-summary.json | FileCheck %s
+
+// CHECK: traces, {{[0-9]+}} entities
+// CHECK-DAG: InstantiateFunction square<int>
+// CHECK-DAG: InstantiateVariable Zero<int>
+// CHECK-DAG: EvaluateAsInitializer Nine
+// CHECK-DAG: OverloadResolution square
+// CHECK-DAG: CodeGen Function square<int>
+// CHECK-DAG: CodeGen Variable Zero<int>
+
+template <typename T>
+constexpr T square(T X) { return X * X; }
+
+template <typename T>
+T Zero = T();
+
+constexpr int Nine = square(3);
+
+int use() { return Zero<int> + square(Nine); }
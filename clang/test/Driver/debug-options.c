@@ -208,6 +208,11 @@
 // RUN: %clang -### -fdebug-types-section -fno-debug-types-section -target x86_64-unknown-linux %s 2>&1 \
 // RUN:        | FileCheck -check-prefix=NOFDTS %s
 //
+// RUN: %clang -### -fdebug-types-section -fdebug-types-cache=/tmp/types -target x86_64-unknown-linux %s 2>&1 \
+// RUN:        | FileCheck -check-prefix=FDTC %s
+// RUN: %clang -### -fdebug-types-cache=/tmp/types -target x86_64-unknown-linux %s 2>&1 \
+// RUN:        | FileCheck -check-prefix=NOFDTC %s
+//
 // RUN: %clang -### -fdebug-types-section -target x86_64-apple-darwin %s 2>&1 \
 // RUN:        | FileCheck -check-prefix=FDTSE %s
 //
@@ -328,6 +333,9 @@
 // NOFDTS-NOT: "-mllvm" "-generate-type-units"
 // NOFDTSE-NOT: error: unsupported option '-fdebug-types-section' for target 'x86_64-apple-darwin'
 //
+// FDTC: "-mllvm" "-generate-type-units" "-mllvm" "-split-dwarf-type-cache=/tmp/types"
+// NOFDTC-NOT: "-split-dwarf-type-cache
+//
 // CI: "-dwarf-column-info"
 //
 // NOCI-NOT: "-dwarf-column-info"
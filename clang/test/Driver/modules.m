@@ -45,6 +45,12 @@
 // RUN: %clang -fmodules-disable-diagnostic-validation -### %s 2>&1 | FileCheck -check-prefix=MODULES_DISABLE_DIAGNOSTIC_VALIDATION %s
 // MODULES_DISABLE_DIAGNOSTIC_VALIDATION: -fmodules-disable-diagnostic-validation
 
+// RUN: %clang -### %s 2>&1 | FileCheck -check-prefix=MODULES_PREFETCH_DEFAULT %s
+// MODULES_PREFETCH_DEFAULT-NOT: -fmodules-prefetch
+
+// RUN: %clang -fmodules-prefetch -### %s 2>&1 | FileCheck -check-prefix=MODULES_PREFETCH %s
+// MODULES_PREFETCH: -fmodules-prefetch
+
 // RUN: %clang -fmodules -### %s 2>&1 | FileCheck -check-prefix=MODULES_PREBUILT_PATH_DEFAULT %s
 // MODULES_PREBUILT_PATH_DEFAULT-NOT: -fprebuilt-module-path
 
@@ -0,0 +1,25 @@
+// RUN: %clang -### -x c++-header %s -fpch-codegen -o %t.pch 2>&1 | FileCheck --check-prefix=CODEGEN %s
+// CODEGEN: "-emit-pch"
+// CODEGEN-SAME: "-fmodules-codegen"
+// CODEGEN-SAME: "-fpch-instantiate-templates"
+
+// RUN: %clang -### -x c++-header %s -fpch-codegen -fno-pch-instantiate-templates -o %t.pch 2>&1 | FileCheck --check-prefix=NOINST %s
+// NOINST: "-emit-pch"
+// NOINST-SAME: "-fmodules-codegen"
+// NOINST-NOT: "-fpch-instantiate-templates"
+
+// RUN: %clang -### -x c++-header %s -fpch-instantiate-templates -o %t.pch 2>&1 | FileCheck --check-prefix=INST %s
+// INST: "-emit-pch"
+// INST-NOT: "-fmodules-codegen"
+// INST-SAME: "-fpch-instantiate-templates"
+
+// RUN: %clang -### -x c++-header %s -o %t.pch 2>&1 | FileCheck --check-prefix=DEFAULT %s
+// DEFAULT: "-emit-pch"
+// DEFAULT-NOT: "-fmodules-codegen"
+// DEFAULT-NOT: "-fpch-instantiate-templates"
+
+// The object file for a PCH is compiled from the PCH itself.
+// RUN: touch %t.pch
+// RUN: %clang -### -c %t.pch -o %t.o 2>&1 | FileCheck --check-prefix=OBJ %s
+// OBJ: "-emit-obj"
+// OBJ-SAME: "-x" "precompiled-header"
@@ -0,0 +1,13 @@
+// RUN: rm -rf %t
+// RUN: %clang_cc1 -fmodules -fimplicit-module-maps -x objective-c -fmodules-cache-path=%t -fmodules-prefetch -I %S/Inputs %s -verify
+// expected-no-diagnostics
+
+// Prefetching the module files doesn't change what is read from them.
+@import diamond_bottom;
+
+void test_prefetch(int i, float f, double d, char c) {
+  top(&i);
+  left(&f);
+  right(&d);
+  bottom(&c);
+}
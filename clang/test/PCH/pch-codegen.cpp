@@ -0,0 +1,46 @@
+// Build a PCH holding the instantiations used by the header, with code for
+// them generated once, from the PCH itself.
+// RUN: %clang_cc1 -triple x86_64-linux-gnu -x c++-header -fpch-instantiate-templates -fmodules-codegen -emit-pch %s -o %t.pch
+// RUN: %clang_cc1 -triple x86_64-linux-gnu -emit-llvm -x precompiled-header %t.pch -o - | FileCheck --check-prefix=PCH %s
+// RUN: %clang_cc1 -triple x86_64-linux-gnu -emit-llvm -include-pch %t.pch %s -o - | FileCheck --check-prefix=USE %s
+
+// Without -fpch-instantiate-templates, the instantiations are left pending
+// and performed again by every user.
+// RUN: %clang_cc1 -triple x86_64-linux-gnu -x c++-header -fmodules-codegen -emit-pch %s -o %t.noinst.pch
+// RUN: %clang_cc1 -triple x86_64-linux-gnu -emit-llvm -include-pch %t.noinst.pch %s -o - | FileCheck --check-prefix=NOINST %s
+
+#ifndef HEADER
+#define HEADER
+
+template <typename T> struct S {
+  T get() { return T(); }
+};
+
+template <typename T> T twice(T t) { return t + t; }
+
+inline int useInt() {
+  S<int> s;
+  return s.get() + twice(1);
+}
+
+inline double useDouble() { return twice(1.0); }
+
+#else
+
+int main() { return useInt() + useDouble() + twice(2.0) + twice(1.0f); }
+
+#endif
+
+// PCH-DAG: define weak_odr {{.*}}i32 @_Z6useIntv()
+// PCH-DAG: define weak_odr {{.*}}i32 @_ZN1SIiE3getEv(
+// PCH-DAG: define weak_odr {{.*}}i32 @_Z5twiceIiET_S0_(
+// PCH-DAG: define weak_odr {{.*}}double @_Z5twiceIdET_S0_(
+
+// Instantiations from the PCH are not emitted again, the others are.
+// USE-DAG: declare {{.*}}i32 @_Z6useIntv()
+// USE-DAG: declare {{.*}}double @_Z9useDoublev()
+// USE-DAG: declare {{.*}}double @_Z5twiceIdET_S0_(
+// USE-DAG: define linkonce_odr {{.*}}float @_Z5twiceIfET_S0_(
+// USE-NOT: define {{.*}}@_ZN1SIiE3getEv(
+
+// NOINST: define linkonce_odr {{.*}}double @_Z5twiceIdET_S0_(
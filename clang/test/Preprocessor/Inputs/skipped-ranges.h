@@ -0,0 +1,12 @@
+#if MODE == 1
+int mode_one;
+#elif MODE == 2
+int mode_two;
+#else
+#ifdef NESTED
+int nested;
+#else
+int not_nested;
+#endif
+int mode_other;
+#endif
@@ -0,0 +1,32 @@
+// RUN: rm -rf %t && mkdir -p %t/a %t/b/sub %t/cache
+// RUN: echo 'int from_b;' > %t/b/foo.h
+// RUN: echo 'int from_sub;' > %t/b/sub/bar.h
+// RUN: touch -t 200001010000 %t/a %t/b
+//
+// RUN: %clang_cc1 -E -fcache-search-dir-listings -I %t/a -I %t/b %s \
+// RUN:   | FileCheck --check-prefix=FROM-B %s
+//
+// The listings of both directories are saved, and reused.
+// RUN: %clang_cc1 -E -fsearch-dir-listings-cache-path=%t/cache -I %t/a -I %t/b \
+// RUN:   %s | FileCheck --check-prefix=FROM-B %s
+// RUN: ls %t/cache | count 2
+// RUN: %clang_cc1 -E -fsearch-dir-listings-cache-path=%t/cache -I %t/a -I %t/b \
+// RUN:   %s | FileCheck --check-prefix=FROM-B %s
+//
+// A saved listing is not used once its directory was modified.
+// RUN: echo 'int from_a;' > %t/a/foo.h
+// RUN: %clang_cc1 -E -fsearch-dir-listings-cache-path=%t/cache -I %t/a -I %t/b \
+// RUN:   %s | FileCheck --check-prefix=FROM-A %s
+//
+// RUN: %clang -### -fcache-search-dir-listings \
+// RUN:   -fsearch-dir-listings-cache-path=%t/cache -E %s 2>&1 \
+// RUN:   | FileCheck --check-prefix=DRIVER %s
+
+#include <foo.h>
+#include <sub/bar.h>
+
+// FROM-B: int from_b;
+// FROM-B: int from_sub;
+// FROM-A: int from_a;
+// FROM-A: int from_sub;
+// DRIVER: "-fcache-search-dir-listings" "-fsearch-dir-listings-cache-path={{.*}}cache"
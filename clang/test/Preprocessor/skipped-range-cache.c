@@ -0,0 +1,34 @@
+// RUN: %clang_cc1 -E -print-stats %s -o - 2>%t.stats | FileCheck %s
+// RUN: FileCheck --check-prefix=STATS %s < %t.stats
+
+// The excluded blocks of a header are only lexed the first time they are
+// skipped. Later inclusions skip them using the cached ranges, whichever
+// branches the macros select.
+
+#define MODE 1
+#include "Inputs/skipped-ranges.h"
+// CHECK: int mode_one;
+// CHECK-NOT: {{^int}}
+#undef MODE
+#define MODE 2
+#include "Inputs/skipped-ranges.h"
+// CHECK: int mode_two;
+// CHECK-NOT: {{^int}}
+#undef MODE
+#define MODE 3
+#include "Inputs/skipped-ranges.h"
+// CHECK: int not_nested;
+// CHECK-NEXT: int mode_other;
+// CHECK-NOT: {{^int}}
+#define NESTED
+#include "Inputs/skipped-ranges.h"
+// CHECK: int nested;
+// CHECK-NEXT: int mode_other;
+// CHECK-NOT: {{^int}}
+#undef MODE
+#define MODE 1
+#include "Inputs/skipped-ranges.h"
+// CHECK: int mode_one;
+// CHECK-NOT: {{^int}}
+
+// STATS: {{[1-9][0-9]*}} regions skipped using cached ranges.
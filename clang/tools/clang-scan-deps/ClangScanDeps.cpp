@@ -16,8 +16,8 @@
 #include "llvm/Support/Program.h"
 #include "llvm/Support/Signals.h"
 #include "llvm/Support/Threading.h"
+#include <atomic>
 #include <mutex>
-#include <thread>
 
 using namespace clang;
 using namespace tooling::dependencies;
@@ -38,18 +38,17 @@ private:
   raw_ostream &OS;
 };
 
-/// The high-level implementation of the dependency discovery tool that runs on
-/// an individual worker thread.
+/// The high-level implementation of the dependency discovery tool, which runs
+/// the workers of all threads.
 class DependencyScanningTool {
 public:
   /// Construct a dependency scanning tool.
   ///
   /// \param Compilations     The reference to the compilation database that's
   /// used by the clang tool.
-  DependencyScanningTool(DependencyScanningService &Service,
-                         const tooling::CompilationDatabase &Compilations,
+  DependencyScanningTool(const tooling::CompilationDatabase &Compilations,
                          SharedStream &OS, SharedStream &Errs)
-      : Worker(Service), Compilations(Compilations), OS(OS), Errs(Errs) {}
+      : Compilations(Compilations), OS(OS), Errs(Errs) {}
 
   /// Print out the dependency information into a string using the dependency
   /// file format that is specified in the options (-MD is the default) and
@@ -57,8 +56,9 @@ public:
   ///
   /// \returns A \c StringError with the diagnostic output if clang errors
   /// occurred, dependency file contents otherwise.
-  llvm::Expected<std::string> getDependencyFile(const std::string &Input,
-                                                StringRef CWD) {
+  llvm::Expected<std::string>
+  getDependencyFile(DependencyScanningWorker &Worker, const std::string &Input,
+                    StringRef CWD) {
     /// Prints out all of the gathered dependencies into a string.
     class DependencyPrinterConsumer : public DependencyConsumer {
     public:
@@ -110,8 +110,9 @@ public:
   /// Computes the dependencies for the given file and prints them out.
   ///
   /// \returns True on error.
-  bool runOnFile(const std::string &Input, StringRef CWD) {
-    auto MaybeFile = getDependencyFile(Input, CWD);
+  bool runOnFile(DependencyScanningWorker &Worker, const std::string &Input,
+                 StringRef CWD) {
+    auto MaybeFile = getDependencyFile(Worker, Input, CWD);
     if (!MaybeFile) {
       llvm::handleAllErrors(
           MaybeFile.takeError(), [this, &Input](llvm::StringError &Err) {
@@ -127,7 +128,6 @@ public:
   }
 
 private:
-  DependencyScanningWorker Worker;
   const tooling::CompilationDatabase &Compilations;
   SharedStream &OS;
   SharedStream &Errs;
@@ -177,6 +177,12 @@ llvm::cl::opt<bool> SkipExcludedPPRanges(
         "until reaching the end directive."),
     llvm::cl::init(true), llvm::cl::cat(DependencyScannerCategory));
 
+llvm::cl::opt<bool> ShareModules(
+    "share-modules",
+    llvm::cl::desc("Share the implicitly built modules loaded by any worker "
+                   "with the other workers, in memory."),
+    llvm::cl::init(true), llvm::cl::cat(DependencyScannerCategory));
+
 llvm::cl::opt<bool> Verbose("v", llvm::cl::Optional,
                             llvm::cl::desc("Use verbose output."),
                             llvm::cl::init(false),
@@ -274,55 +280,26 @@ int main(int argc, const char **argv) {
   SharedStream DependencyOS(llvm::outs());
 
   DependencyScanningService Service(ScanMode, ReuseFileManager,
-                                    SkipExcludedPPRanges);
+                                    SkipExcludedPPRanges, ShareModules);
 #if LLVM_ENABLE_THREADS
   unsigned NumWorkers =
       NumThreads == 0 ? llvm::hardware_concurrency() : NumThreads;
 #else
   unsigned NumWorkers = 1;
 #endif
-  std::vector<std::unique_ptr<DependencyScanningTool>> WorkerTools;
-  for (unsigned I = 0; I < NumWorkers; ++I)
-    WorkerTools.push_back(std::make_unique<DependencyScanningTool>(
-        Service, *AdjustingCompilations, DependencyOS, Errs));
-
-  std::vector<std::thread> WorkerThreads;
+  DependencyScanningTool Tool(*AdjustingCompilations, DependencyOS, Errs);
   std::atomic<bool> HadErrors(false);
-  std::mutex Lock;
-  size_t Index = 0;
 
   if (Verbose) {
     llvm::outs() << "Running clang-scan-deps on " << Inputs.size()
                  << " files using " << NumWorkers << " workers\n";
   }
-  for (unsigned I = 0; I < NumWorkers; ++I) {
-    auto Worker = [I, &Lock, &Index, &Inputs, &HadErrors, &WorkerTools]() {
-      while (true) {
-        std::string Input;
-        StringRef CWD;
-        // Take the next input.
-        {
-          std::unique_lock<std::mutex> LockGuard(Lock);
-          if (Index >= Inputs.size())
-            return;
-          const auto &Compilation = Inputs[Index++];
-          Input = Compilation.first;
-          CWD = Compilation.second;
-        }
-        // Run the tool on it.
-        if (WorkerTools[I]->runOnFile(Input, CWD))
-          HadErrors = true;
-      }
-    };
-#if LLVM_ENABLE_THREADS
-    WorkerThreads.emplace_back(std::move(Worker));
-#else
-    // Run the worker without spawning a thread when threads are disabled.
-    Worker();
-#endif
-  }
-  for (auto &W : WorkerThreads)
-    W.join();
+  scanInParallel(Service, Inputs.size(), NumWorkers,
+                 [&](DependencyScanningWorker &Worker, size_t I) {
+                   if (Tool.runOnFile(Worker, Inputs[I].first,
+                                      Inputs[I].second))
+                     HadErrors = true;
+                 });
 
   return HadErrors;
 }
@@ -10,6 +10,9 @@
 // core compiler functionality along with a number of additional tools for
 // demonstration and testing purposes.
 //
+// It also implements clang -cc1server, which runs many -cc1 compilations in one
+// process.
+//
 //===----------------------------------------------------------------------===//
 
 #include "clang/Basic/Stack.h"
@@ -25,15 +28,21 @@
 #include "clang/Frontend/TextDiagnosticPrinter.h"
 #include "clang/Frontend/Utils.h"
 #include "clang/FrontendTool/Utils.h"
+#include "clang/Serialization/ASTReader.h"
+#include "clang/Serialization/InMemoryModuleCache.h"
 #include "llvm/ADT/Statistic.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/Config/llvm-config.h"
 #include "llvm/LinkAllPasses.h"
 #include "llvm/Option/Arg.h"
 #include "llvm/Option/ArgList.h"
 #include "llvm/Option/OptTable.h"
 #include "llvm/Support/BuryPointer.h"
+#include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Compiler.h"
 #include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/JSON.h"
 #include "llvm/Support/ManagedStatic.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/Signals.h"
@@ -285,3 +294,213 @@ int cc1_main(ArrayRef<const char *> Argv, const char *Argv0, void *MainAddr) {
 
   return !Success;
 }
+
+//===----------------------------------------------------------------------===//
+// Compile server
+//===----------------------------------------------------------------------===//
+
+namespace {
+
+/// The module files and PCHs loaded by earlier compilations of the server,
+/// along with the state of the files they were read from.
+class ServerModuleCache {
+public:
+  /// Adds the files that didn't change on disk to the cache of a compilation,
+  /// as if they had just been read from disk. The compilation still validates
+  /// them against their inputs, and may rebuild them.
+  void addTo(InMemoryModuleCache &Cache) {
+    for (auto It = PCMs.begin(), End = PCMs.end(); It != End;) {
+      auto Current = It++;
+      llvm::sys::fs::file_status Status;
+      if (llvm::sys::fs::status(Current->getKey(), Status) ||
+          Status.getLastModificationTime() != Current->getValue().ModTime ||
+          Status.getSize() != Current->getValue().Buffer->getBufferSize()) {
+        PCMs.erase(Current);
+        continue;
+      }
+      Cache.addPCM(Current->getKey(),
+                   llvm::MemoryBuffer::getMemBuffer(
+                       Current->getValue().Buffer->getMemBufferRef(),
+                       /*RequiresNullTerminator=*/false));
+    }
+  }
+
+  /// Keeps the files that were successfully loaded by a compilation.
+  void addFrom(CompilerInstance &Clang) {
+    IntrusiveRefCntPtr<ASTReader> Reader = Clang.getModuleManager();
+    if (!Reader)
+      return;
+    for (const serialization::ModuleFile &MF : Reader->getModuleManager()) {
+      llvm::sys::fs::file_status Status;
+      if (!Clang.getModuleCache().isPCMFinal(MF.FileName) ||
+          llvm::sys::fs::status(MF.FileName, Status) ||
+          Status.getSize() != MF.Buffer->getBufferSize())
+        continue;
+      PCM &Entry = PCMs[MF.FileName];
+      Entry.Buffer = llvm::MemoryBuffer::getMemBufferCopy(MF.Buffer->getBuffer(),
+                                                          MF.FileName);
+      Entry.ModTime = Status.getLastModificationTime();
+    }
+  }
+
+private:
+  struct PCM {
+    std::unique_ptr<llvm::MemoryBuffer> Buffer;
+    llvm::sys::TimePoint<> ModTime;
+  };
+  llvm::StringMap<PCM> PCMs;
+};
+
+} // namespace
+
+/// Runs one -cc1 compilation of the server, writing its diagnostics to DiagOS.
+static bool serverCompile(ArrayRef<const char *> Argv, const char *Argv0,
+                          void *MainAddr, ServerModuleCache &Modules,
+                          Optional<std::vector<std::string>> &LLVMArgs,
+                          raw_ostream &DiagOS) {
+  IntrusiveRefCntPtr<InMemoryModuleCache> ModuleCache =
+      new InMemoryModuleCache();
+  Modules.addTo(*ModuleCache);
+  auto PCHOps = std::make_shared<PCHContainerOperations>();
+  PCHOps->registerWriter(std::make_unique<ObjectFilePCHContainerWriter>());
+  PCHOps->registerReader(std::make_unique<ObjectFilePCHContainerReader>());
+  auto Clang = std::make_unique<CompilerInstance>(PCHOps, ModuleCache.get());
+
+  IntrusiveRefCntPtr<DiagnosticIDs> DiagID(new DiagnosticIDs());
+  IntrusiveRefCntPtr<DiagnosticOptions> DiagOpts = new DiagnosticOptions();
+  TextDiagnosticBuffer *DiagsBuffer = new TextDiagnosticBuffer;
+  DiagnosticsEngine Diags(DiagID, &*DiagOpts, DiagsBuffer);
+  bool Success =
+      CompilerInvocation::CreateFromArgs(Clang->getInvocation(), Argv, Diags);
+
+  // The process outlives the compilation, so it must clean up after itself.
+  Clang->getFrontendOpts().DisableFree = false;
+  Clang->getCodeGenOpts().DisableFree = false;
+
+  if (Clang->getHeaderSearchOpts().UseBuiltinIncludes &&
+      Clang->getHeaderSearchOpts().ResourceDir.empty())
+    Clang->getHeaderSearchOpts().ResourceDir =
+      CompilerInvocation::GetResourcesPath(Argv0, MainAddr);
+
+  Clang->createDiagnostics(
+      new TextDiagnosticPrinter(DiagOS, &Clang->getDiagnosticOpts()));
+  if (!Clang->hasDiagnostics())
+    return false;
+  DiagsBuffer->FlushDiagnostics(Clang->getDiagnostics());
+  if (!Success)
+    return false;
+
+  DiagnosticsEngine &ClangDiags = Clang->getDiagnostics();
+  const FrontendOptions &FEOpts = Clang->getFrontendOpts();
+  // Standard output carries the responses of the server.
+  if ((FEOpts.ProgramAction != frontend::ParseSyntaxOnly &&
+       (FEOpts.OutputFile.empty() || FEOpts.OutputFile == "-")) ||
+      Clang->getDependencyOutputOpts().OutputFile == "-") {
+    ClangDiags.Report(ClangDiags.getCustomDiagID(
+        DiagnosticsEngine::Error,
+        "the compile server cannot write to standard output"));
+    return false;
+  }
+  // -mllvm options are global to the process, and can't be reset.
+  if (!LLVMArgs)
+    LLVMArgs = FEOpts.LLVMArgs;
+  else if (*LLVMArgs != FEOpts.LLVMArgs) {
+    ClangDiags.Report(ClangDiags.getCustomDiagID(
+        DiagnosticsEngine::Error,
+        "the -mllvm options differ from the first compilation of the server"));
+    return false;
+  }
+  llvm::cl::ResetAllOptionOccurrences();
+
+  llvm::install_fatal_error_handler(LLVMErrorHandler,
+                                    static_cast<void *>(&ClangDiags));
+  Success = ExecuteCompilerInvocation(Clang.get());
+  llvm::remove_fatal_error_handler();
+
+  llvm::TimerGroup::printAll(llvm::errs());
+  llvm::TimerGroup::clearAll();
+
+  if (Success)
+    Modules.addFrom(*Clang);
+  return Success;
+}
+
+/// Reads a line from F, without the newline. Returns false at the end of F.
+static bool readLine(std::FILE *F, std::string &Line) {
+  Line.clear();
+  int C;
+  while ((C = std::fgetc(F)) != EOF && C != '\n')
+    Line.push_back(C);
+  return C != EOF || !Line.empty();
+}
+
+/// Runs the compilations requested on standard input, one after the other, in
+/// this process. This saves the startup and target initialization of a process
+/// per compilation, and keeps module files and PCHs in memory across
+/// compilations for as long as they don't change on disk.
+///
+/// Each request is a line holding a JSON object, with the working directory
+/// and the -cc1 arguments of a compilation:
+///   {"directory": "/src", "arguments": ["-triple", ..., "foo.c"]}
+/// The response is written as a line to standard output once it is done:
+///   {"exit": 0, "diagnostics": "foo.c:1:1: warning: ..."}
+///
+/// A fatal error in a compilation ends the server, like it ends -cc1.
+int cc1server_main(ArrayRef<const char *> Argv, const char *Argv0,
+                   void *MainAddr) {
+  ensureSufficientStack();
+
+  llvm::InitializeAllTargets();
+  llvm::InitializeAllTargetMCs();
+  llvm::InitializeAllAsmPrinters();
+  llvm::InitializeAllAsmParsers();
+
+#ifdef LINK_POLLY_INTO_TOOLS
+  llvm::PassRegistry &Registry = *llvm::PassRegistry::getPassRegistry();
+  polly::initializePollyPasses(Registry);
+#endif
+
+  ServerModuleCache Modules;
+  Optional<std::vector<std::string>> LLVMArgs;
+  std::string Line;
+  while (readLine(stdin, Line)) {
+    std::string Diagnostics;
+    llvm::raw_string_ostream DiagOS(Diagnostics);
+    bool Success = false;
+
+    llvm::Expected<llvm::json::Value> Request = llvm::json::parse(Line);
+    const llvm::json::Object *Obj = Request ? Request->getAsObject() : nullptr;
+    const llvm::json::Array *Arguments =
+        Obj ? Obj->getArray("arguments") : nullptr;
+    Optional<StringRef> Directory = Obj ? Obj->getString("directory") : None;
+    if (!Request) {
+      DiagOS << "error: invalid request: "
+             << llvm::toString(Request.takeError()) << "\n";
+    } else if (!Arguments || !Directory) {
+      DiagOS << "error: invalid request: expected a directory and arguments\n";
+    } else if (std::error_code EC =
+                   llvm::sys::fs::set_current_path(*Directory)) {
+      DiagOS << "error: cannot change to directory '" << *Directory
+             << "': " << EC.message() << "\n";
+    } else {
+      std::vector<std::string> Args;
+      for (const llvm::json::Value &Arg : *Arguments)
+        if (Optional<StringRef> S = Arg.getAsString())
+          Args.push_back(*S);
+      std::vector<const char *> ArgPtrs;
+      for (const std::string &Arg : Args)
+        ArgPtrs.push_back(Arg.c_str());
+      Success =
+          serverCompile(ArgPtrs, Argv0, MainAddr, Modules, LLVMArgs, DiagOS);
+    }
+
+    llvm::outs() << llvm::json::Value(llvm::json::Object{
+                        {"exit", Success ? 0 : 1},
+                        {"diagnostics", std::move(DiagOS.str())},
+                    })
+                 << "\n";
+    llvm::outs().flush();
+  }
+  return 0;
+}
+
@@ -603,6 +603,38 @@ TEST_F(FormatTestSelective, KeepsIndentAfterCommentSectionImport) {
   EXPECT_EQ(Code, format(Code, 47, 1));
 }
 
+TEST_F(FormatTestSelective, FormatsOnlyAffectedPreprocessorBranches) {
+  std::string Code = "#if A\n"    // 6 chars long
+                     "int  a;\n"  // 8 chars long
+                     "#else\n"    // 6 chars long
+                     "int  b;\n"  // this line starts at char 20
+                     "#endif\n";
+  EXPECT_EQ("#if A\n"
+            "int a;\n"
+            "#else\n"
+            "int  b;\n"
+            "#endif\n",
+            format(Code, 6, 0));
+  EXPECT_EQ("#if A\n"
+            "int  a;\n"
+            "#else\n"
+            "int b;\n"
+            "#endif\n",
+            format(Code, 20, 0));
+}
+
+TEST_F(FormatTestSelective, FormatsAffectedLeadingEmptyLines) {
+  EXPECT_EQ("int  a;\n"
+            "\n"
+            "int  b;",
+            format("int  a;\n"
+                   "\n"
+                   "\n"
+                   "\n"
+                   "int  b;",
+                   9, 0));
+}
+
 } // end namespace
 } // end namespace format
 } // end namespace clang
@@ -0,0 +1,117 @@
+#!/usr/bin/env python
+
+"""
+Summarizes the -ftime-trace output of a whole build.
+
+Reads the .json trace files written by clang -ftime-trace (or directories
+holding them, searched recursively), and prints the entities that took the
+most time across all of them, e.g. the templates whose instantiations cost the
+most. Times are inclusive: an instantiation includes the instantiations it
+triggered. An entity nested within itself (e.g. by a recursive instantiation)
+is only counted once.
+
+Example usage:
+
+  $ CXXFLAGS="-ftime-trace" make
+  $ time-trace-summary.py --top 20 build/
+"""
+
+from __future__ import print_function
+
+import argparse
+import collections
+import json
+import os
+import re
+import sys
+
+
+def find_traces(paths):
+    for path in paths:
+        if not os.path.isdir(path):
+            yield path
+            continue
+        for root, _, files in os.walk(path):
+            for name in files:
+                if name.endswith('.json'):
+                    yield os.path.join(root, name)
+
+
+def read_events(path):
+    try:
+        with open(path) as f:
+            trace = json.load(f)
+    except (IOError, ValueError):
+        return []
+    if not isinstance(trace, dict):
+        return []
+    # The flame graph is on thread 0; other threads hold per-name totals.
+    return [e for e in trace.get('traceEvents', [])
+            if e.get('ph') == 'X' and e.get('tid') == 0 and 'dur' in e]
+
+
+def entity(event, strip_args):
+    detail = event.get('args', {}).get('detail', '')
+    if strip_args:
+        # Group all specializations of a template together.
+        detail = re.sub(r'<.*>', '<>', detail)
+    return (event['name'], detail)
+
+
+def summarize(paths, name_regex, strip_args):
+    # Entity -> [total us, count, number of traces].
+    totals = collections.defaultdict(lambda: [0, 0, 0])
+    num_traces = 0
+    for path in find_traces(paths):
+        events = read_events(path)
+        if not events:
+            continue
+        num_traces += 1
+        seen = set()
+        # Ends of the open occurrences of each entity, to skip nested ones.
+        open_until = {}
+        for e in sorted(events, key=lambda e: (e['ts'], -e['dur'])):
+            if not name_regex.search(e['name']):
+                continue
+            key = entity(e, strip_args)
+            if open_until.get(key, -1) >= e['ts'] + e['dur']:
+                continue
+            open_until[key] = e['ts'] + e['dur']
+            total = totals[key]
+            total[0] += e['dur']
+            total[1] += 1
+            if key not in seen:
+                seen.add(key)
+                total[2] += 1
+    return num_traces, totals
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description=__doc__, formatter_class=argparse.RawTextHelpFormatter)
+    parser.add_argument('paths', nargs='+', metavar='PATH',
+                        help='trace files or directories holding them')
+    parser.add_argument('--top', type=int, default=30,
+                        help='number of entities to print (default: 30)')
+    parser.add_argument('--events', default='^Instantiate',
+                        help='regex of the event names to summarize '
+                             '(default: ^Instantiate)')
+    parser.add_argument('--strip-template-args', action='store_true',
+                        help='group the specializations of each template')
+    args = parser.parse_args()
+
+    num_traces, totals = summarize(args.paths, re.compile(args.events),
+                                   args.strip_template_args)
+    if not num_traces:
+        sys.exit('No time traces found')
+
+    print('%d traces, %d entities' % (num_traces, len(totals)))
+    print('%10s %8s %7s  %s' % ('total ms', 'count', 'traces', 'entity'))
+    ranked = sorted(totals.items(), key=lambda kv: (-kv[1][0], kv[0]))
+    for (name, detail), (dur, count, traces) in ranked[:args.top]:
+        print('%10.1f %8d %7d  %s %s' % (dur / 1000.0, count, traces, name,
+                                         detail))
+
+
+if __name__ == '__main__':
+    main()
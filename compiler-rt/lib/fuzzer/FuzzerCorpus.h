@@ -17,7 +17,9 @@
 #include "FuzzerRandom.h"
 #include "FuzzerSHA1.h"
 #include "FuzzerTracePC.h"
+#include "FuzzerUtil.h"
 #include <algorithm>
+#include <atomic>
 #include <numeric>
 #include <random>
 #include <unordered_set>
@@ -40,6 +42,42 @@ struct InputInfo {
   Vector<uint8_t> DataFlowTraceForFocusFunction;
 };
 
+// A set of features in a file that is shared between processes. -fork mode
+// uses it to let its jobs know which features other jobs have found already.
+// Features are taken modulo kFeatureSetSize, like in InputCorpus, and updates
+// are lock free.
+class SharedFeatureSet {
+  static const size_t kFeatureSetSize = 1 << 21;
+  static const size_t kNumWords = kFeatureSetSize / 64;
+
+ public:
+  bool Map(const std::string &Path) {
+    Words = static_cast<std::atomic<uint64_t> *>(
+        MapSharedFile(Path, kNumWords * sizeof(uint64_t)));
+    return Words != nullptr;
+  }
+
+  bool IsMapped() const { return Words != nullptr; }
+
+  // Adds Features to the set. Returns true if any of them was not in it.
+  template <class T>
+  bool Add(const T &Features) {
+    bool Added = false;
+    for (auto Feature : Features) {
+      size_t Idx = Feature % kFeatureSetSize;
+      uint64_t Mask = 1ULL << (Idx % 64);
+      if (Words[Idx / 64].load(std::memory_order_relaxed) & Mask)
+        continue;
+      if (!(Words[Idx / 64].fetch_or(Mask, std::memory_order_relaxed) & Mask))
+        Added = true;
+    }
+    return Added;
+  }
+
+ private:
+  std::atomic<uint64_t> *Words = nullptr;
+};
+
 class InputCorpus {
   static const size_t kFeatureSetSize = 1 << 21;
  public:
@@ -242,6 +280,16 @@ class InputCorpus {
   size_t NumFeatures() const { return NumAddedFeatures; }
   size_t NumFeatureUpdates() const { return NumUpdatedFeatures; }
 
+  bool MapSharedFeatures(const std::string &Path) {
+    return SharedFeatures.Map(Path);
+  }
+
+  // Records the unique features of II in the shared feature set, if there is
+  // one. Returns false if all of them were found by other processes already.
+  bool AddSharedFeatures(const InputInfo &II) {
+    return !SharedFeatures.IsMapped() || SharedFeatures.Add(II.UniqFeatureSet);
+  }
+
 private:
 
   static const bool FeatureDebug = false;
@@ -301,6 +349,7 @@ private:
   size_t NumUpdatedFeatures = 0;
   uint32_t InputSizesPerFeature[kFeatureSetSize];
   uint32_t SmallestElementPerFeature[kFeatureSetSize];
+  SharedFeatureSet SharedFeatures;
 
   std::string OutputCorpus;
 };
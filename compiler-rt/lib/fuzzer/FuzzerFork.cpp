@@ -9,6 +9,7 @@
 //===----------------------------------------------------------------------===//
 
 #include "FuzzerCommand.h"
+#include "FuzzerCorpus.h"
 #include "FuzzerFork.h"
 #include "FuzzerIO.h"
 #include "FuzzerInternal.h"
@@ -93,6 +94,9 @@ struct GlobalEnv {
   std::string DFTDir;
   std::string DataFlowBinary;
   Set<uint32_t> Features, Cov;
+  // Features found by any job, also the ones not merged yet.
+  SharedFeatureSet SharedFeatures;
+  std::string SharedFeaturesPath;
   Set<std::string> FilesWithDFT;
   Vector<std::string> Files;
   Random *Rand;
@@ -159,6 +163,8 @@ struct GlobalEnv {
 
     Cmd.addArgument(Job->CorpusDir);
     Cmd.addFlag("features_dir", Job->FeaturesDir);
+    if (SharedFeatures.IsMapped())
+      Cmd.addFlag("shared_features", SharedFeaturesPath);
 
     for (auto &D : {Job->CorpusDir, Job->FeaturesDir}) {
       RmDirRecursive(D);
@@ -220,6 +226,8 @@ struct GlobalEnv {
       Files.push_back(NewPath);
     }
     Features.insert(NewFeatures.begin(), NewFeatures.end());
+    if (SharedFeatures.IsMapped())
+      SharedFeatures.Add(NewFeatures);
     Cov.insert(NewCov.begin(), NewCov.end());
     for (auto Idx : NewCov)
       if (auto *TE = TPC.PCTableEntryByIdx(Idx))
@@ -314,6 +322,9 @@ void FuzzWithFork(Random &Rand, const FuzzingOptions &Options,
                       {}, &Env.Cov,
                       CFPath, false);
   RemoveFile(CFPath);
+  Env.SharedFeaturesPath = DirPlusFile(Env.TempDir, "features");
+  if (Env.SharedFeatures.Map(Env.SharedFeaturesPath))
+    Env.SharedFeatures.Add(Env.Features);
   Printf("INFO: -fork=%d: %zd seed inputs, starting to fuzz in %s\n", NumJobs,
          Env.Files.size(), Env.TempDir.c_str());
 
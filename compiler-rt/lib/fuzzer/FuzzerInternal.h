@@ -118,6 +118,9 @@ private:
   size_t NumberOfNewUnitsAdded = 0;
 
   size_t LastCorpusUpdateRun = 0;
+  // False if the last input added to the corpus has no features that are new
+  // to all -fork jobs. Such inputs are not written to the output corpus.
+  bool IsNewToAllJobs = true;
 
   bool HasMoreMallocsThanFrees = false;
   size_t NumberOfLeakDetectionAttempts = 0;
@@ -19,6 +19,7 @@
 #include <iterator>
 #include <set>
 #include <sstream>
+#include <thread>
 #include <unordered_set>
 
 namespace fuzzer {
@@ -296,6 +297,102 @@ static size_t WriteNewControlFile(const std::string &CFPath,
   return FilesToUse.size();
 }
 
+// Executes the inner process until it passes.
+// Every inner process should execute at least one input.
+static void RunInnerMerge(const Command &BaseCmd, const std::string &CFPath,
+                          size_t NumAttempts, bool V) {
+  for (size_t Attempt = 1; Attempt <= NumAttempts; Attempt++) {
+    Fuzzer::MaybeExitGracefully();
+    VPrintf(V, "MERGE-OUTER: attempt %zd on %s\n", Attempt, CFPath.c_str());
+    Command Cmd(BaseCmd);
+    Cmd.addFlag("merge_control_file", CFPath);
+    Cmd.addFlag("merge_inner", "1");
+    if (!V) {
+      Cmd.setOutputFile(getDevNull());
+      Cmd.combineOutAndErr();
+    }
+    auto ExitCode = ExecuteCommand(Cmd);
+    if (!ExitCode) {
+      VPrintf(V, "MERGE-OUTER: succesfull in %zd attempt(s)\n", Attempt);
+      break;
+    }
+  }
+}
+
+// Splits the inputs of the fresh control file CFPath between NumJobs control
+// files, runs an inner process on each of them in parallel, and appends their
+// results to CFPath, so that it looks as if one inner process processed it.
+// The inputs are dealt out round-robin: input I goes to job I % NumJobs, so
+// that every job gets its share of the initial corpus and of every size.
+static void ParallelInnerMerge(const Command &BaseCmd,
+                               const std::string &CFPath, size_t NumJobs,
+                               bool V) {
+  Merger M;
+  std::ifstream IF(CFPath);
+  M.ParseOrExit(IF, false);
+  IF.close();
+  NumJobs = std::min(NumJobs, M.Files.size());
+  VPrintf(V, "MERGE-OUTER: running %zd inner processes in parallel\n",
+          NumJobs);
+
+  Vector<std::string> JobCFPaths;
+  Vector<std::thread> Threads;
+  for (size_t J = 0; J < NumJobs; J++) {
+    JobCFPaths.push_back(CFPath + "." + std::to_string(J));
+    size_t NumFiles = 0, NumFilesInFirstCorpus = 0;
+    for (size_t i = J; i < M.Files.size(); i += NumJobs) {
+      NumFiles++;
+      if (i < M.NumFilesInFirstCorpus)
+        NumFilesInFirstCorpus++;
+    }
+    std::ofstream OF(JobCFPaths.back());
+    OF << NumFiles << "\n" << NumFilesInFirstCorpus << "\n";
+    for (size_t i = J; i < M.Files.size(); i += NumJobs)
+      OF << M.Files[i].Name << "\n";
+    if (!OF) {
+      Printf("MERGE-OUTER: failed to write to the control file: %s\n",
+             JobCFPaths.back().c_str());
+      exit(1);
+    }
+    OF.close();
+    Threads.push_back(std::thread(RunInnerMerge, std::cref(BaseCmd),
+                                  JobCFPaths.back(), NumFiles, V));
+  }
+  for (auto &T : Threads)
+    T.join();
+
+  Vector<Merger> Jobs(NumJobs);
+  for (size_t J = 0; J < NumJobs; J++) {
+    std::ifstream JobIF(JobCFPaths[J]);
+    Jobs[J].ParseOrExit(JobIF, true);
+    JobIF.close();
+    RemoveFile(JobCFPaths[J]);
+  }
+  // Inputs that a job did not get to are recorded as failed ones.
+  std::ofstream OF(CFPath, std::ofstream::out | std::ofstream::app);
+  for (size_t i = 0; i < M.Files.size(); i++) {
+    auto &Job = Jobs[i % NumJobs];
+    size_t Idx = i / NumJobs;
+    auto &File = Job.Files[Idx];
+    OF << "STARTED " << i << " " << File.Size << "\n";
+    if (Idx >= Job.FirstNotProcessedFile)
+      continue;
+    OF << "FT " << i;
+    for (auto F : File.Features)
+      OF << " " << F;
+    OF << "\n";
+    OF << "COV " << i;
+    for (auto C : File.Cov)
+      OF << " " << C;
+    OF << "\n";
+  }
+  if (!OF) {
+    Printf("MERGE-OUTER: failed to write to the control file: %s\n",
+           CFPath.c_str());
+    exit(1);
+  }
+}
+
 // Outer process. Does not call the target code and thus should not fail.
 void CrashResistantMerge(const Vector<std::string> &Args,
                          const Vector<SizedFile> &OldCorpus,
@@ -306,7 +403,8 @@ void CrashResistantMerge(const Vector<std::string> &Args,
                          const Set<uint32_t> &InitialCov,
                          Set<uint32_t> *NewCov,
                          const std::string &CFPath,
-                         bool V /*Verbose*/) {
+                         bool V /*Verbose*/,
+                         size_t NumJobs) {
   if (NewCorpus.empty() && OldCorpus.empty()) return;  // Nothing to merge.
   size_t NumAttempts = 0;
   Vector<MergeFileInfo> KnownFiles;
@@ -348,7 +446,8 @@ void CrashResistantMerge(const Vector<std::string> &Args,
     }
   }
 
-  if (!NumAttempts) {
+  bool Resuming = NumAttempts != 0;
+  if (!Resuming) {
     // The supplied control file is empty or bad, create a fresh one.
     VPrintf(V, "MERGE-OUTER: "
             "%zd files, %zd in the initial corpus, %zd processed earlier\n",
@@ -357,28 +456,15 @@ void CrashResistantMerge(const Vector<std::string> &Args,
     NumAttempts = WriteNewControlFile(CFPath, OldCorpus, NewCorpus, KnownFiles);
   }
 
-  // Execute the inner process until it passes.
-  // Every inner process should execute at least one input.
   Command BaseCmd(Args);
   BaseCmd.removeFlag("merge");
+  BaseCmd.removeFlag("merge_jobs");
   BaseCmd.removeFlag("fork");
   BaseCmd.removeFlag("collect_data_flow");
-  for (size_t Attempt = 1; Attempt <= NumAttempts; Attempt++) {
-    Fuzzer::MaybeExitGracefully();
-    VPrintf(V, "MERGE-OUTER: attempt %zd\n", Attempt);
-    Command Cmd(BaseCmd);
-    Cmd.addFlag("merge_control_file", CFPath);
-    Cmd.addFlag("merge_inner", "1");
-    if (!V) {
-      Cmd.setOutputFile(getDevNull());
-      Cmd.combineOutAndErr();
-    }
-    auto ExitCode = ExecuteCommand(Cmd);
-    if (!ExitCode) {
-      VPrintf(V, "MERGE-OUTER: succesfull in %zd attempt(s)\n", Attempt);
-      break;
-    }
-  }
+  if (NumJobs > 1 && !Resuming)
+    ParallelInnerMerge(BaseCmd, CFPath, NumJobs, V);
+  else
+    RunInnerMerge(BaseCmd, CFPath, NumAttempts, V);
   // Read the control file and do the merge.
   Merger M;
   std::ifstream IF(CFPath);
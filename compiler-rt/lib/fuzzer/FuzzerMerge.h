@@ -79,7 +79,8 @@ void CrashResistantMerge(const Vector<std::string> &Args,
                          const Set<uint32_t> &InitialCov,
                          Set<uint32_t> *NewCov,
                          const std::string &CFPath,
-                         bool Verbose);
+                         bool Verbose,
+                         size_t NumJobs = 1);
 
 }  // namespace fuzzer
 
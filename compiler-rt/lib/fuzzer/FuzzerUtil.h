@@ -60,6 +60,11 @@ int ExecuteCommand(const Command &Cmd);
 
 FILE *OpenProcessPipe(const char *Command, const char *Mode);
 
+// Maps the file at Path into memory, shared with other processes that map it.
+// The file is created, or extended with zeros, if it is smaller than Size.
+// Returns nullptr on failure or if this isn't supported.
+void *MapSharedFile(const std::string &Path, size_t Size);
+
 const void *SearchMemory(const void *haystack, size_t haystacklen,
                          const void *needle, size_t needlelen);
 
@@ -492,6 +492,8 @@ int ExecuteCommand(const Command &Cmd) {
   return Info.return_code;
 }
 
+void *MapSharedFile(const std::string &Path, size_t Size) { return nullptr; }
+
 const void *SearchMemory(const void *Data, size_t DataLen, const void *Patt,
                          size_t PattLen) {
   return memmem(Data, DataLen, Patt, PattLen);
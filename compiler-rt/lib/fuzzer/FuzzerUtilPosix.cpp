@@ -16,11 +16,13 @@
 #include <chrono>
 #include <cstring>
 #include <errno.h>
+#include <fcntl.h>
 #include <iomanip>
 #include <signal.h>
 #include <stdio.h>
 #include <sys/mman.h>
 #include <sys/resource.h>
+#include <sys/stat.h>
 #include <sys/syscall.h>
 #include <sys/time.h>
 #include <sys/types.h>
@@ -148,6 +150,22 @@ FILE *OpenProcessPipe(const char *Command, const char *Mode) {
   return popen(Command, Mode);
 }
 
+void *MapSharedFile(const std::string &Path, size_t Size) {
+  int FD = open(Path.c_str(), O_RDWR | O_CREAT, 0600);
+  if (FD < 0)
+    return nullptr;
+  struct stat St;
+  void *Res = nullptr;
+  if (fstat(FD, &St) == 0 &&
+      ((size_t)St.st_size >= Size || ftruncate(FD, Size) == 0)) {
+    Res = mmap(nullptr, Size, PROT_READ | PROT_WRITE, MAP_SHARED, FD, 0);
+    if (Res == MAP_FAILED)
+      Res = nullptr;
+  }
+  close(FD);
+  return Res;
+}
+
 const void *SearchMemory(const void *Data, size_t DataLen, const void *Patt,
                          size_t PattLen) {
   return memmem(Data, DataLen, Patt, PattLen);
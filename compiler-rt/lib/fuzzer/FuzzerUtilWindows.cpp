@@ -156,6 +156,8 @@ int ExecuteCommand(const Command &Cmd) {
   return system(CmdLine.c_str());
 }
 
+void *MapSharedFile(const std::string &Path, size_t Size) { return nullptr; }
+
 const void *SearchMemory(const void *Data, size_t DataLen, const void *Patt,
                          size_t PattLen) {
   // TODO: make this implementation more efficient.
@@ -39,6 +39,16 @@ COMPILER_RT_VISIBILITY void __llvm_profile_set_dumped() {
   lprofSetProfileDumped();
 }
 
+static unsigned ContinuousMode = 0;
+
+COMPILER_RT_VISIBILITY int __llvm_profile_is_continuous_mode_enabled(void) {
+  return ContinuousMode;
+}
+
+COMPILER_RT_VISIBILITY void lprofSetContinuousMode(unsigned Enable) {
+  ContinuousMode = Enable;
+}
+
 /* Return the number of bytes needed to add to SizeInBytes to make it
  *   the result a multiple of 8.
  */
@@ -44,6 +44,19 @@ typedef struct ValueProfNode {
  */
 uint8_t __llvm_profile_get_num_padding_bytes(uint64_t SizeInBytes);
 
+/*!
+ * \brief Get the number of padding bytes around the counters section of the
+ * raw profile.
+ *
+ * The counters are not padded, unless continuous mode is on. Then they start
+ * and end at page boundaries of the profile file, so that they can be mapped
+ * onto it. The names are always padded to an eight byte boundary.
+ */
+void __llvm_profile_get_padding_sizes_for_counters(
+    uint64_t DataSize, uint64_t CountersSize, uint64_t NamesSize,
+    uint64_t *PaddingBytesBeforeCounters, uint64_t *PaddingBytesAfterCounters,
+    uint64_t *PaddingBytesAfterNames);
+
 /*!
  * \brief Get required size for profile buffer.
  */
@@ -182,6 +195,17 @@ int __llvm_profile_register_write_file_atexit(void);
 /*! \brief Initialize file handling. */
 void __llvm_profile_initialize_file(void);
 
+/*!
+ * \brief Return non-zero if the counters are mapped onto the profile file.
+ *
+ * Continuous mode is requested with the \c %c specifier in the profile name.
+ * The counters section is then mapped onto the profile file when the file is
+ * set up, so the counters are kept up to date in the file while the program
+ * runs, and are not lost when it is killed. Only the value profile data is
+ * written at exit.
+ */
+int __llvm_profile_is_continuous_mode_enabled(void);
+
 /*!
  * \brief Return path prefix (excluding the base filename) of the profile data.
  * This is useful for users using \c -fprofile-generate=./path_prefix who do
@@ -83,11 +83,14 @@ typedef struct lprofFilename {
    * 2 profile data files. %1m is equivalent to %m. Also %m specifier
    * can only appear once at the end of the name pattern. */
   unsigned MergePoolSize;
+  /* A flag indicating if the %c specifier requests continuous mode, which
+   * maps the counters onto the profile file. */
+  unsigned ContinuousModeRequested;
   ProfileNameSpecifier PNS;
 } lprofFilename;
 
-COMPILER_RT_WEAK lprofFilename lprofCurFilename = {0,   0, 0, 0, {0},
-                                                   {0}, 0, 0, 0, PNS_unknown};
+COMPILER_RT_WEAK lprofFilename lprofCurFilename = {
+    0, 0, 0, 0, {0}, {0}, 0, 0, 0, 0, PNS_unknown};
 
 static int ProfileMergeRequested = 0;
 static int isProfileMergeRequested() { return ProfileMergeRequested; }
@@ -277,11 +280,41 @@ static FILE *getFileObject(const char *OutputName) {
   return fopen(OutputName, "ab");
 }
 
+/* Write the value profile data to file \c OutputName in continuous mode. The
+ * rest of the profile is already in the file, with the counters mapped onto
+ * it, so only the value profile data after the names is written. */
+static int writeValueProfDataToFile(const char *OutputName) {
+  int RetVal;
+  FILE *OutputFile;
+
+  OutputFile = lprofOpenFileEx(OutputName);
+  if (!OutputFile)
+    return -1;
+
+  FreeHook = &free;
+  setupIOBuffer();
+  ProfDataWriter fileWriter;
+  initFileWriter(&fileWriter, OutputFile);
+  RetVal = -1;
+  if (fseek(OutputFile, __llvm_profile_get_size_for_buffer(), SEEK_SET) != -1 &&
+      !lprofWriteValueProfData(&fileWriter, lprofGetVPDataReader()) &&
+      !fflush(OutputFile) &&
+      /* Drop the value profile data of a previous write, if any. */
+      !COMPILER_RT_FTRUNCATE(OutputFile, ftell(OutputFile)))
+    RetVal = 0;
+
+  fclose(OutputFile);
+  return RetVal;
+}
+
 /* Write profile data to file \c OutputName.  */
 static int writeFile(const char *OutputName) {
   int RetVal;
   FILE *OutputFile;
 
+  if (__llvm_profile_is_continuous_mode_enabled() && !getProfileFile())
+    return writeValueProfDataToFile(OutputName);
+
   int MergeDone = 0;
   VPMergeHook = &lprofMergeValueProfData;
   if (doMerging())
@@ -357,6 +390,116 @@ static void truncateCurrentFile(void) {
   fclose(File);
 }
 
+#if !defined(_WIN32)
+/* Map the counters section onto the profile file \p File, which holds the
+ * profile of this module in the continuous mode layout. Returns 0 if
+ * successful.  */
+static int mmapCountersOntoFile(FILE *File) {
+  const __llvm_profile_data *DataBegin = __llvm_profile_begin_data();
+  const __llvm_profile_data *DataEnd = __llvm_profile_end_data();
+  uint64_t *CountersBegin = __llvm_profile_begin_counters();
+  uint64_t *CountersEnd = __llvm_profile_end_counters();
+  const uint64_t DataSize = __llvm_profile_get_data_size(DataBegin, DataEnd);
+  const uint64_t CountersSize = CountersEnd - CountersBegin;
+  const uint64_t NamesSize =
+      __llvm_profile_end_names() - __llvm_profile_begin_names();
+  uint64_t PaddingBytesBeforeCounters, PaddingBytesAfterCounters,
+      PaddingBytesAfterNames;
+  uint64_t CountersOffset;
+  void *Counters;
+
+  __llvm_profile_get_padding_sizes_for_counters(
+      DataSize, CountersSize, NamesSize, &PaddingBytesBeforeCounters,
+      &PaddingBytesAfterCounters, &PaddingBytesAfterNames);
+  CountersOffset = sizeof(__llvm_profile_header) +
+                   DataSize * sizeof(__llvm_profile_data) +
+                   PaddingBytesBeforeCounters;
+
+  /* The file has the current values of the counters, so they are kept. */
+  Counters = mmap(CountersBegin, CountersSize * sizeof(uint64_t),
+                  PROT_READ | PROT_WRITE, MAP_FIXED | MAP_SHARED,
+                  fileno(File), CountersOffset);
+  if (Counters != CountersBegin) {
+    PROF_ERR("Continuous counter sync mode is enabled, but mmap() failed: "
+             "%s\n",
+             strerror(errno));
+    return -1;
+  }
+  return 0;
+}
+#endif
+
+/* Set up continuous mode for the current profile file: write the profile of
+ * this module to the file and map the counters section onto it. From then
+ * on the counters are updated in the file, which holds a valid profile at
+ * any time, even if the program is killed. With %m, the counters of a
+ * compatible profile in the file are kept. */
+static void initializeContinuousMode(void) {
+#if defined(_WIN32)
+  PROF_WARN("Continuous counter sync mode is not supported: %s\n",
+            "no support for mapping the counters on Windows");
+#else
+  uint64_t *CountersBegin = __llvm_profile_begin_counters();
+  uint64_t *CountersEnd = __llvm_profile_end_counters();
+  uint64_t PageSize = lprofGetPageSize();
+  const char *Filename;
+  char *FilenameBuf;
+  FILE *File;
+  int Length, MergeDone = 0;
+  ProfDataWriter fileWriter;
+
+  if (CountersBegin == CountersEnd)
+    return;
+
+  /* Only whole pages can be mapped onto the file. The runtime page aligns the
+   * counters section on the platforms that support continuous mode. */
+  if (!PageSize || (uintptr_t)CountersBegin % PageSize ||
+      (uintptr_t)CountersEnd % PageSize) {
+    PROF_WARN("Continuous counter sync mode is not supported: %s\n",
+              "the counters section is not page aligned");
+    return;
+  }
+
+  Length = getCurFilenameLength();
+  FilenameBuf = (char *)COMPILER_RT_ALLOCA(Length + 1);
+  Filename = getCurFilename(FilenameBuf, 0);
+  if (!Filename)
+    return;
+
+  createProfileDir(Filename);
+  File = lprofOpenFileEx(Filename);
+  if (!File) {
+    PROF_ERR("Failed to open file \"%s\" for continuous mode: %s\n", Filename,
+             strerror(errno));
+    return;
+  }
+
+  VPMergeHook = &lprofMergeValueProfData;
+  if (doMerging() && doProfileMerging(File, &MergeDone)) {
+    PROF_ERR("Profile Merging of file %s failed: %s\n", Filename,
+             strerror(errno));
+    fclose(File);
+    return;
+  }
+
+  lprofSetContinuousMode(1);
+  initFileWriter(&fileWriter, File);
+  if (fseek(File, 0L, SEEK_SET) == -1 || lprofWriteData(&fileWriter, 0, 0) ||
+      fflush(File) ||
+      COMPILER_RT_FTRUNCATE(File, __llvm_profile_get_size_for_buffer()) ||
+      mmapCountersOntoFile(File)) {
+    PROF_ERR("Failed to set up continuous mode for file \"%s\": %s\n",
+             Filename, strerror(errno));
+    lprofSetContinuousMode(0);
+  } else if (getenv("LLVM_PROFILE_VERBOSE")) {
+    PROF_NOTE("Mapped the counters onto profile file \"%s\".\n", Filename);
+  }
+
+  /* The mapping outlives the file.  */
+  fclose(File);
+#endif
+}
+
 static const char *DefaultProfileName = "default.profraw";
 static void resetFilenameToDefault(void) {
   if (lprofCurFilename.FilenamePat && lprofCurFilename.OwnsFilenamePat) {
@@ -422,6 +565,13 @@ static int parseFilenamePattern(const char *FilenamePat,
                       FilenamePat);
             return -1;
           }
+      } else if (FilenamePat[I] == 'c') {
+        if (lprofCurFilename.ContinuousModeRequested) {
+          PROF_WARN("%%c specifier can only be specified once in %s.\n",
+                    FilenamePat);
+          return -1;
+        }
+        lprofCurFilename.ContinuousModeRequested = 1;
       } else if (containsMergeSpecifier(FilenamePat, I)) {
         if (MergingEnabled) {
           PROF_WARN("%%m specifier can only be specified once in %s.\n",
@@ -461,6 +611,13 @@ static void parseAndSetFilename(const char *FilenamePat,
     return;
   }
 
+  /* The counters stay mapped onto the profile file set up first. */
+  if (__llvm_profile_is_continuous_mode_enabled()) {
+    PROF_WARN("Profile path \"%s\" via %s is ignored: %s\n", FilenamePat,
+              getPNSStr(PNS), "continuous mode is already set up");
+    return;
+  }
+
   /* When PNS >= OldPNS, the last one wins. */
   if (!FilenamePat || parseFilenamePattern(FilenamePat, CopyFilenamePat))
     resetFilenameToDefault();
@@ -478,6 +635,9 @@ static void parseAndSetFilename(const char *FilenamePat,
   }
 
   truncateCurrentFile();
+
+  if (lprofCurFilename.ContinuousModeRequested)
+    initializeContinuousMode();
 }
 
 /* Return buffer length that is required to store the current profile
@@ -490,7 +650,8 @@ static int getCurFilenameLength() {
     return 0;
 
   if (!(lprofCurFilename.NumPids || lprofCurFilename.NumHosts ||
-        lprofCurFilename.MergePoolSize))
+        lprofCurFilename.MergePoolSize ||
+        lprofCurFilename.ContinuousModeRequested))
     return strlen(lprofCurFilename.FilenamePat);
 
   Len = strlen(lprofCurFilename.FilenamePat) +
@@ -514,7 +675,8 @@ static const char *getCurFilename(char *FilenameBuf, int ForceUseBuf) {
     return 0;
 
   if (!(lprofCurFilename.NumPids || lprofCurFilename.NumHosts ||
-        lprofCurFilename.MergePoolSize)) {
+        lprofCurFilename.MergePoolSize ||
+        lprofCurFilename.ContinuousModeRequested)) {
     if (!ForceUseBuf)
       return lprofCurFilename.FilenamePat;
 
@@ -708,7 +870,7 @@ int __llvm_profile_write_file(void) {
 
 COMPILER_RT_VISIBILITY
 int __llvm_profile_dump(void) {
-  if (!doMerging())
+  if (!doMerging() && !__llvm_profile_is_continuous_mode_enabled())
     PROF_WARN("Later invocation of __llvm_profile_dump can lead to clobbering "
               " of previously dumped profile data : %s. Either use %%m "
               "in profile name or change profile name before dumping.\n",
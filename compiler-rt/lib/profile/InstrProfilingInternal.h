@@ -150,6 +150,11 @@ int lprofWriteDataImpl(ProfDataWriter *Writer,
                        VPDataReaderType *VPDataReader, const char *NamesBegin,
                        const char *NamesEnd, int SkipNameDataWrite);
 
+/* Write only the value profile data, which follows the names in the raw
+ * profile. Continuous mode writes the rest of the profile up front. */
+int lprofWriteValueProfData(ProfDataWriter *Writer,
+                            VPDataReaderType *VPDataReader);
+
 /* Merge value profile data pointed to by SrcValueProfData into
  * in-memory profile counters pointed by to DstData.  */
 void lprofMergeValueProfData(struct ValueProfData *SrcValueProfData,
@@ -177,6 +182,10 @@ uint64_t lprofGetLoadModuleSignature();
 unsigned lprofProfileDumped();
 void lprofSetProfileDumped();
 
+/* Turn continuous mode on or off. The layout of the raw profile depends on
+ * it, see __llvm_profile_get_padding_sizes_for_counters. */
+void lprofSetContinuousMode(unsigned Enable);
+
 COMPILER_RT_VISIBILITY extern void (*FreeHook)(void *);
 COMPILER_RT_VISIBILITY extern uint8_t *DynamicBufferIOBuffer;
 COMPILER_RT_VISIBILITY extern uint32_t VPBufferSize;
@@ -65,7 +65,9 @@ int __llvm_profile_check_compatibility(const char *ProfileData,
 
   if (ProfileSize < sizeof(__llvm_profile_header) +
                         Header->DataSize * sizeof(__llvm_profile_data) +
-                        Header->NamesSize + Header->CountersSize)
+                        Header->PaddingBytesBeforeCounters +
+                        Header->CountersSize * sizeof(uint64_t) +
+                        Header->PaddingBytesAfterCounters + Header->NamesSize)
     return 1;
 
   for (SrcData = SrcDataStart,
@@ -93,8 +95,10 @@ void __llvm_profile_merge_from_buffer(const char *ProfileData,
   SrcDataStart =
       (__llvm_profile_data *)(ProfileData + sizeof(__llvm_profile_header));
   SrcDataEnd = SrcDataStart + Header->DataSize;
-  SrcCountersStart = (uint64_t *)SrcDataEnd;
-  SrcNameStart = (const char *)(SrcCountersStart + Header->CountersSize);
+  SrcCountersStart =
+      (uint64_t *)((const char *)SrcDataEnd + Header->PaddingBytesBeforeCounters);
+  SrcNameStart = (const char *)(SrcCountersStart + Header->CountersSize) +
+                 Header->PaddingBytesAfterCounters;
   SrcValueProfDataStart =
       (ValueProfData *)(SrcNameStart + Header->NamesSize +
                         __llvm_profile_get_num_padding_bytes(
@@ -46,6 +46,20 @@ uint32_t
 char __prof_nms_sect_data[0] COMPILER_RT_SECTION(INSTR_PROF_NAME_SECT_NAME);
 ValueProfNode __prof_vnodes_sect_data[0] COMPILER_RT_SECTION(INSTR_PROF_VNODES_SECT_NAME);
 
+#if !defined(__Fuchsia__)
+/* Page align the start and the end of the counters section, so that
+ * continuous mode can map it onto the profile file. The runtime is linked
+ * after the instrumented objects, so this empty array is laid out at the end
+ * of the section. */
+#if defined(__powerpc64__)
+#define PROF_CNTS_PAGE_ALIGNMENT 65536
+#else
+#define PROF_CNTS_PAGE_ALIGNMENT 4096
+#endif
+uint64_t __prof_cnts_sect_page_align[0] COMPILER_RT_SECTION(
+    INSTR_PROF_CNTS_SECT_NAME) COMPILER_RT_ALIGNAS(PROF_CNTS_PAGE_ALIGNMENT);
+#endif
+
 COMPILER_RT_VISIBILITY const __llvm_profile_data *
 __llvm_profile_begin_data(void) {
   return &PROF_DATA_START;
@@ -325,3 +325,14 @@ COMPILER_RT_VISIBILITY void lprofRestoreSigKill() {
   prctl(PR_SET_PDEATHSIG, SIGKILL);
 #endif
 }
+
+COMPILER_RT_VISIBILITY uint64_t lprofGetPageSize() {
+#if defined(_WIN32)
+  SYSTEM_INFO SystemInfo;
+  GetSystemInfo(&SystemInfo);
+  return SystemInfo.dwPageSize;
+#else
+  long PageSize = sysconf(_SC_PAGESIZE);
+  return PageSize > 0 ? (uint64_t)PageSize : 0;
+#endif
+}
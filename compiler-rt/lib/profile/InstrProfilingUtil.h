@@ -10,6 +10,7 @@
 #define PROFILE_INSTRPROFILINGUTIL_H
 
 #include <stddef.h>
+#include <stdint.h>
 #include <stdio.h>
 
 /*! \brief Create a directory tree. */
@@ -69,4 +70,7 @@ int lprofSuspendSigKill();
 /* Restore previously suspended SIGKILL. */
 void lprofRestoreSigKill();
 
+/* Return the page size of the system, or 0 if it is not known. */
+uint64_t lprofGetPageSize();
+
 #endif /* PROFILE_INSTRPROFILINGUTIL_H */
@@ -21,7 +21,6 @@
 
 static int hasStaticCounters = 1;
 static int OutOfNodesWarnings = 0;
-static int hasNonDefaultValsPerSite = 0;
 #define INSTR_PROF_MAX_VP_WARNS 10
 #define INSTR_PROF_DEFAULT_NUM_VAL_PER_SITE 16
 #define INSTR_PROF_VNODE_POOL_SIZE 1024
@@ -42,7 +41,6 @@ COMPILER_RT_VISIBILITY void lprofSetupValueProfiler() {
   Str = getenv("LLVM_VP_MAX_NUM_VALS_PER_SITE");
   if (Str && Str[0]) {
     VPMaxNumValsPerSite = atoi(Str);
-    hasNonDefaultValsPerSite = 1;
   }
   if (VPMaxNumValsPerSite > INSTR_PROF_MAX_NUM_VAL_PER_SITE)
     VPMaxNumValsPerSite = INSTR_PROF_MAX_NUM_VAL_PER_SITE;
@@ -50,7 +48,6 @@ COMPILER_RT_VISIBILITY void lprofSetupValueProfiler() {
 
 COMPILER_RT_VISIBILITY void lprofSetMaxValsPerSite(uint32_t MaxVals) {
   VPMaxNumValsPerSite = MaxVals;
-  hasNonDefaultValsPerSite = 1;
 }
 
 /* This method is only used in value profiler mock testing.  */
@@ -85,10 +82,6 @@ static int allocateValueProfileCounters(__llvm_profile_data *Data) {
   /* This function will never be called when value site array is allocated
      statically at compile time.  */
   hasStaticCounters = 0;
-  /* When dynamic allocation is enabled, allow tracking the max number of
-   * values allowd.  */
-  if (!hasNonDefaultValsPerSite)
-    VPMaxNumValsPerSite = INSTR_PROF_MAX_NUM_VAL_PER_SITE;
 
   for (VKI = IPVK_First; VKI <= IPVK_Last; ++VKI)
     NumVSites += Data->NumValueSites[VKI];
@@ -107,9 +100,6 @@ static int allocateValueProfileCounters(__llvm_profile_data *Data) {
 static ValueProfNode *allocateOneNode(void) {
   ValueProfNode *Node;
 
-  if (!hasStaticCounters)
-    return (ValueProfNode *)calloc(1, sizeof(ValueProfNode));
-
   /* Early check to avoid value wrapping around.  */
   if (CurrentVNode + 1 > EndVNode) {
     if (OutOfNodesWarnings++ < INSTR_PROF_MAX_VP_WARNS) {
@@ -130,6 +120,80 @@ static ValueProfNode *allocateOneNode(void) {
   return Node;
 }
 
+/* With dynamic allocation, the values of a site are kept in a table of
+ * VPMaxNumValsPerSite nodes allocated when the site gets its first value,
+ * so that the memory used by a site is bounded and allocated once. The
+ * table is open addressed with linear probing, and a free node has a zero
+ * count. Its nodes are chained by their Next field, so that it is walked
+ * like the node lists of the static allocation. The node before the table
+ * holds its size.
+ */
+static ValueProfNode *allocateSiteTable(ValueProfNode **Site) {
+  uint32_t I, Size = VPMaxNumValsPerSite;
+  ValueProfNode *Mem;
+
+  if (!Size)
+    return 0;
+  Mem = (ValueProfNode *)calloc(Size + 1, sizeof(ValueProfNode));
+  if (!Mem)
+    return 0;
+  Mem[0].Value = Size;
+  for (I = 1; I < Size; ++I)
+    Mem[I].Next = &Mem[I + 1];
+  if (!COMPILER_RT_BOOL_CMPXCHG(Site, 0, &Mem[1])) {
+    free(Mem);
+    return *Site;
+  }
+  return &Mem[1];
+}
+
+static COMPILER_RT_ALWAYS_INLINE uint32_t getSiteTableSlot(uint64_t Value,
+                                                           uint32_t Size) {
+  return (uint32_t)((Value * 0x9E3779B97F4A7C15ULL) >> 32) % Size;
+}
+
+static void instrumentTargetValueInTable(uint64_t TargetValue,
+                                         ValueProfNode **Site,
+                                         uint64_t CountValue) {
+  ValueProfNode *Table = *Site;
+  ValueProfNode *MinCountVNode = NULL;
+  uint32_t I, Slot, Size;
+
+  if (!Table) {
+    Table = allocateSiteTable(Site);
+    if (!Table)
+      return;
+  }
+  Size = (uint32_t)Table[-1].Value;
+  Slot = getSiteTableSlot(TargetValue, Size);
+  for (I = 0; I < Size; ++I) {
+    ValueProfNode *Node = &Table[Slot];
+    /* The values are never removed from a table, so the first free node
+     * ends the probing. Like the other counter updates, claiming a node is
+     * racy: concurrent updates may be lost, but never corrupt the table.  */
+    if (!Node->Count) {
+      Node->Value = TargetValue;
+      Node->Count = CountValue;
+      return;
+    }
+    if (Node->Value == TargetValue) {
+      Node->Count += CountValue;
+      return;
+    }
+    if (!MinCountVNode || Node->Count < MinCountVNode->Count)
+      MinCountVNode = Node;
+    if (++Slot == Size)
+      Slot = 0;
+  }
+
+  /* The table is full, evict like for the node lists below.  */
+  if (MinCountVNode->Count <= CountValue) {
+    MinCountVNode->Value = TargetValue;
+    MinCountVNode->Count = CountValue;
+  } else
+    MinCountVNode->Count -= CountValue;
+}
+
 static COMPILER_RT_ALWAYS_INLINE void
 instrumentTargetValueImpl(uint64_t TargetValue, void *Data,
                           uint32_t CounterIndex, uint64_t CountValue) {
@@ -144,6 +208,11 @@ instrumentTargetValueImpl(uint64_t TargetValue, void *Data,
   }
 
   ValueProfNode **ValueCounters = (ValueProfNode **)PData->Values;
+  if (!hasStaticCounters) {
+    instrumentTargetValueInTable(TargetValue, &ValueCounters[CounterIndex],
+                                 CountValue);
+    return;
+  }
   ValueProfNode *PrevVNode = NULL;
   ValueProfNode *MinCountVNode = NULL;
   ValueProfNode *CurVNode = ValueCounters[CounterIndex];
@@ -209,17 +278,12 @@ instrumentTargetValueImpl(uint64_t TargetValue, void *Data,
   CurVNode->Value = TargetValue;
   CurVNode->Count += CountValue;
 
-  uint32_t Success = 0;
+  /* If another thread linked a node first, this one stays unused in the
+   * pool.  */
   if (!ValueCounters[CounterIndex])
-    Success =
-        COMPILER_RT_BOOL_CMPXCHG(&ValueCounters[CounterIndex], 0, CurVNode);
+    COMPILER_RT_BOOL_CMPXCHG(&ValueCounters[CounterIndex], 0, CurVNode);
   else if (PrevVNode && !PrevVNode->Next)
-    Success = COMPILER_RT_BOOL_CMPXCHG(&(PrevVNode->Next), 0, CurVNode);
-
-  if (!Success && !hasStaticCounters) {
-    free(CurVNode);
-    return;
-  }
+    COMPILER_RT_BOOL_CMPXCHG(&(PrevVNode->Next), 0, CurVNode);
 }
 
 COMPILER_RT_VISIBILITY void
@@ -323,12 +387,14 @@ initializeValueProfRuntimeRecord(const __llvm_profile_data *Data,
 
     RTRecord.NodesKind[I] = Nodes ? &Nodes[S] : INSTR_PROF_NULLPTR;
     for (J = 0; J < N; J++) {
-      /* Compute value count for each site. */
+      /* Compute value count for each site, the nodes with a zero count
+       * hold no value.  */
       uint32_t C = 0;
       ValueProfNode *Site =
           Nodes ? RTRecord.NodesKind[I][J] : INSTR_PROF_NULLPTR;
       while (Site) {
-        C++;
+        if (Site->Count)
+          C++;
         Site = Site->Next;
       }
       if (C > UCHAR_MAX)
@@ -346,6 +412,8 @@ static ValueProfNode *getNextNValueData(uint32_t VK, uint32_t Site,
   unsigned I;
   ValueProfNode *VNode = StartNode ? StartNode : RTRecord.NodesKind[VK][Site];
   for (I = 0; I < N; I++) {
+    while (!VNode->Count)
+      VNode = VNode->Next;
     Dst[I].Value = VNode->Value;
     Dst[I].Count = VNode->Count;
     VNode = VNode->Next;
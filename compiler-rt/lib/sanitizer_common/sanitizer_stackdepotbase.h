@@ -100,34 +100,46 @@ StackDepotBase<Node, kReservedBits, kTabSizeLog>::Put(args_type args,
   if (!Node::is_valid(args)) return handle_type();
   uptr h = Node::hash(args);
   atomic_uintptr_t *p = &tab[h % kTabSize];
-  uptr v = atomic_load(p, memory_order_consume);
-  Node *s = (Node *)(v & ~1);
-  // First, try to find the existing stack.
-  Node *node = find(s, args, h);
-  if (node) return node->get_handle();
-  // If failed, lock, retry and insert new.
-  Node *s2 = lock(p);
-  if (s2 != s) {
-    node = find(s2, args, h);
+  // New nodes are pushed onto the front of the bucket with a CAS, so threads
+  // inserting into the same bucket don't wait for each other. The lsb of the
+  // bucket is only set by LockAll().
+  Node *s = nullptr;
+  for (int i = 0;; i++) {
+    uptr v = atomic_load(p, memory_order_consume);
+    Node *head = (Node *)(v & ~1);
+    // Look for the existing stack. After a failed CAS this also finds the
+    // stack if another thread has inserted it in the meantime.
+    Node *node = find(head, args, h);
     if (node) {
-      unlock(p, s2);
+      // The node we created for the stack, if any, is not used. It can't be
+      // freed, and its id is never handed out.
       return node->get_handle();
     }
+    if (v & 1) {
+      if (i < 10)
+        proc_yield(10);
+      else
+        internal_sched_yield();
+      continue;
+    }
+    if (!s) {
+      uptr part = (h % kTabSize) / kPartSize;
+      u32 id = atomic_fetch_add(&seq[part], 1, memory_order_relaxed) + 1;
+      CHECK_LT(id, kMaxId);
+      id |= part << kPartShift;
+      CHECK_NE(id, 0);
+      CHECK_EQ(id & (((u32)-1) >> kReservedBits), id);
+      uptr memsz = Node::storage_size(args);
+      s = (Node *)PersistentAlloc(memsz);
+      stats.allocated += memsz;
+      s->id = id;
+      s->store(args, h);
+    }
+    s->link = head;
+    if (atomic_compare_exchange_weak(p, &v, (uptr)s, memory_order_release))
+      break;
   }
-  uptr part = (h % kTabSize) / kPartSize;
-  u32 id = atomic_fetch_add(&seq[part], 1, memory_order_relaxed) + 1;
   stats.n_uniq_ids++;
-  CHECK_LT(id, kMaxId);
-  id |= part << kPartShift;
-  CHECK_NE(id, 0);
-  CHECK_EQ(id & (((u32)-1) >> kReservedBits), id);
-  uptr memsz = Node::storage_size(args);
-  s = (Node *)PersistentAlloc(memsz);
-  stats.allocated += memsz;
-  s->id = id;
-  s->store(args, h);
-  s->link = s2;
-  unlock(p, s);
   if (inserted) *inserted = true;
   return s->get_handle();
 }
@@ -12,6 +12,7 @@
 #include "sanitizer_common/sanitizer_stackdepot.h"
 #include "sanitizer_common/sanitizer_internal_defs.h"
 #include "sanitizer_common/sanitizer_libc.h"
+#include "sanitizer_pthread_wrappers.h"
 #include "gtest/gtest.h"
 
 namespace __sanitizer {
@@ -89,4 +90,42 @@ TEST(SanitizerCommon, StackDepotReverseMap) {
   }
 }
 
+static const uptr kConcurrentStacks = 1000;
+static const uptr kConcurrentThreads = 8;
+
+struct StackDepotConcurrentData {
+  u32 ids[kConcurrentThreads][kConcurrentStacks];
+  uptr thread;
+};
+
+static void *StackDepotPutThread(void *arg) {
+  StackDepotConcurrentData *data = (StackDepotConcurrentData *)arg;
+  uptr t = __sync_fetch_and_add(&data->thread, 1);
+  for (uptr i = 0; i < kConcurrentStacks; i++) {
+    // All threads insert the same stacks, in a different order.
+    uptr j = (i + t * 97) % kConcurrentStacks;
+    uptr array[] = {0x1000, 0x2000 + j, 0x3000 + j * 7};
+    data->ids[t][j] = StackDepotPut(StackTrace(array, ARRAY_SIZE(array)));
+  }
+  return 0;
+}
+
+TEST(SanitizerCommon, StackDepotConcurrentPut) {
+  StackDepotConcurrentData data = {};
+  pthread_t threads[kConcurrentThreads];
+  for (uptr i = 0; i < kConcurrentThreads; i++)
+    PTHREAD_CREATE(&threads[i], 0, StackDepotPutThread, &data);
+  for (uptr i = 0; i < kConcurrentThreads; i++)
+    PTHREAD_JOIN(threads[i], 0);
+
+  for (uptr j = 0; j < kConcurrentStacks; j++) {
+    EXPECT_NE(0U, data.ids[0][j]);
+    for (uptr t = 1; t < kConcurrentThreads; t++)
+      EXPECT_EQ(data.ids[0][j], data.ids[t][j]);
+    StackTrace stack = StackDepotGet(data.ids[0][j]);
+    EXPECT_EQ(3U, stack.size);
+    EXPECT_EQ(0x2000 + j, stack.trace[1]);
+  }
+}
+
 }  // namespace __sanitizer
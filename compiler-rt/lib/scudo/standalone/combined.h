@@ -20,6 +20,8 @@
 #include "secondary.h"
 #include "tsd.h"
 
+#include <pthread.h>
+
 namespace scudo {
 
 template <class Params> class Allocator {
@@ -125,9 +127,20 @@ public:
     Options.DeleteSizeMismatch = getFlags()->delete_size_mismatch;
     Options.QuarantineMaxChunkSize =
         static_cast<u32>(getFlags()->quarantine_max_chunk_size);
+    const s32 ReleaseToOsIntervalMs = getFlags()->release_to_os_interval_ms;
+    Options.ReleaseInBackground =
+        getFlags()->release_to_os_in_background && ReleaseToOsIntervalMs >= 0;
+    if (Options.ReleaseInBackground) {
+      BackgroundRelease.IntervalMs = static_cast<u32>(ReleaseToOsIntervalMs);
+      if (getFlags()->rss_target_mb > 0)
+        BackgroundRelease.RssTarget =
+            static_cast<uptr>(getFlags()->rss_target_mb) << 20;
+    }
 
     Stats.initLinkerInitialized();
-    Primary.initLinkerInitialized(getFlags()->release_to_os_interval_ms);
+    Primary.initLinkerInitialized(
+        ReleaseToOsIntervalMs,
+        /*ReleaseOnDeallocation=*/!Options.ReleaseInBackground);
     Secondary.initLinkerInitialized(&Stats);
 
     Quarantine.init(
@@ -138,6 +151,7 @@ public:
   void reset() { memset(this, 0, sizeof(*this)); }
 
   void unmapTestOnly() {
+    stopBackgroundRelease();
     TSDRegistry.unmapTestOnly();
     Primary.unmapTestOnly();
   }
@@ -161,6 +175,8 @@ public:
                           uptr Alignment = MinAlignment,
                           bool ZeroContents = false) {
     initThreadMaybe();
+    if (UNLIKELY(Options.ReleaseInBackground))
+      startBackgroundReleaseMaybe();
 
     if (UNLIKELY(Alignment > MaxAlignment)) {
       if (Options.MayReturnNull)
@@ -476,9 +492,28 @@ private:
     u8 ZeroContents : 1;        // zero_contents
     u8 DeallocTypeMismatch : 1; // dealloc_type_mismatch
     u8 DeleteSizeMismatch : 1;  // delete_size_mismatch
+    u8 ReleaseInBackground : 1; // release_to_os_in_background
     u32 QuarantineMaxChunkSize; // quarantine_max_chunk_size
   } Options;
 
+  enum BackgroundReleaseState : u8 {
+    BackgroundReleaseNotStarted = 0,
+    BackgroundReleaseStarting,
+    BackgroundReleaseRunning,
+    BackgroundReleaseFailed,
+  };
+
+  struct {
+    atomic_u8 State;
+    atomic_u8 Stop;
+    pthread_t Thread;
+    u32 IntervalMs; // release_to_os_interval_ms
+    uptr RssTarget; // rss_target_mb, in bytes
+    atomic_uptr Runs;
+    atomic_uptr RunsOverRssTarget;
+    atomic_uptr ReleasedBytes;
+  } BackgroundRelease;
+
   // The following might get optimized out by the compiler.
   NOINLINE void performSanityChecks() {
     // Verify that the header offset field can hold the maximum offset. In the
@@ -534,6 +569,74 @@ private:
     TSDRegistry.initThreadMaybe(this, MinimalInit);
   }
 
+  // The background release thread is started by the first allocation rather
+  // than during initialization, as creating a thread can allocate, which must
+  // not happen while the registry holds its initialization lock.
+  ALWAYS_INLINE void startBackgroundReleaseMaybe() {
+    if (LIKELY(atomic_load_relaxed(&BackgroundRelease.State) !=
+               BackgroundReleaseNotStarted))
+      return;
+    startBackgroundRelease();
+  }
+
+  NOINLINE void startBackgroundRelease() {
+    u8 Expected = BackgroundReleaseNotStarted;
+    // Only one thread gets to create it, allocations made by pthread_create
+    // itself see the Starting state.
+    if (!atomic_compare_exchange_strong(&BackgroundRelease.State, &Expected,
+                                        BackgroundReleaseStarting,
+                                        memory_order_acquire))
+      return;
+    const bool Started = pthread_create(&BackgroundRelease.Thread, nullptr,
+                                        backgroundReleaseThread, this) == 0;
+    // Don't retry on failure, deallocations still don't release memory, but
+    // releaseToOS() can be called explicitly.
+    atomic_store(&BackgroundRelease.State,
+                 Started ? BackgroundReleaseRunning : BackgroundReleaseFailed,
+                 memory_order_release);
+  }
+
+  void stopBackgroundRelease() {
+    if (atomic_load(&BackgroundRelease.State, memory_order_acquire) !=
+        BackgroundReleaseRunning)
+      return;
+    atomic_store(&BackgroundRelease.Stop, 1, memory_order_release);
+    pthread_join(BackgroundRelease.Thread, nullptr);
+  }
+
+  static void *backgroundReleaseThread(void *Arg) {
+    reinterpret_cast<ThisT *>(Arg)->backgroundReleaseLoop();
+    return nullptr;
+  }
+
+  void backgroundReleaseLoop() {
+    // Sleep in short steps to notice a stop request in a timely manner.
+    constexpr u32 MaxSleepMs = 100U;
+    const u32 IntervalMs = Max(1U, BackgroundRelease.IntervalMs);
+    u32 SleptMs = 0;
+    while (!atomic_load(&BackgroundRelease.Stop, memory_order_acquire)) {
+      if (SleptMs < IntervalMs) {
+        const u32 SleepMs = Min(MaxSleepMs, IntervalMs - SleptMs);
+        sleepMilliseconds(SleepMs);
+        SleptMs += SleepMs;
+        continue;
+      }
+      SleptMs = 0;
+      // Above the RSS target, release everything that can be, regardless of
+      // when it was freed or last released.
+      const bool OverRssTarget =
+          BackgroundRelease.RssTarget &&
+          getResidentSetSize() > BackgroundRelease.RssTarget;
+      const uptr ReleasedBytes = Primary.releaseToOS(/*Force=*/OverRssTarget);
+      atomic_fetch_add(&BackgroundRelease.Runs, 1U, memory_order_relaxed);
+      if (OverRssTarget)
+        atomic_fetch_add(&BackgroundRelease.RunsOverRssTarget, 1U,
+                         memory_order_relaxed);
+      atomic_fetch_add(&BackgroundRelease.ReleasedBytes, ReleasedBytes,
+                       memory_order_relaxed);
+    }
+  }
+
   void quarantineOrDeallocateChunk(void *Ptr, Chunk::UnpackedHeader *Header,
                                    uptr Size) {
     Chunk::UnpackedHeader NewHeader = *Header;
@@ -584,6 +687,14 @@ private:
   }
 
   uptr getStats(ScopedString *Str) {
+    if (Options.ReleaseInBackground)
+      Str->append(
+          "Stats: background release: %zu runs (%zu over the RSS target), "
+          "%zuK released; rss: %zuK\n",
+          atomic_load_relaxed(&BackgroundRelease.Runs),
+          atomic_load_relaxed(&BackgroundRelease.RunsOverRssTarget),
+          atomic_load_relaxed(&BackgroundRelease.ReleasedBytes) >> 10,
+          getResidentSetSize() >> 10);
     Primary.getStats(Str);
     Secondary.getStats(Str);
     Quarantine.getStats(Str);
@@ -128,10 +128,18 @@ INLINE uptr getPageSizeCached() {
 
 u32 getNumberOfCPUs();
 
+// Returns the CPU the calling thread is running on, or -1 if unknown.
+s32 getCurrentCPU();
+
 const char *getEnv(const char *Name);
 
 u64 getMonotonicTime();
 
+void sleepMilliseconds(u32 Milliseconds);
+
+// Returns the resident set size of the process in bytes, or 0 if unknown.
+uptr getResidentSetSize();
+
 // Our randomness gathering function is limited to 256 bytes to ensure we get
 // as many bytes as requested, and avoid interruptions (on Linux).
 constexpr uptr MaxRandomLength = 256U;
@@ -122,12 +122,49 @@ u64 getMonotonicTime() {
          static_cast<u64>(TS.tv_nsec);
 }
 
+void sleepMilliseconds(u32 Milliseconds) {
+  timespec TS;
+  TS.tv_sec = Milliseconds / 1000;
+  TS.tv_nsec = static_cast<long>(Milliseconds % 1000) * 1000000;
+  while (nanosleep(&TS, &TS) == -1 && errno == EINTR) {
+  }
+}
+
+uptr getResidentSetSize() {
+  // This can run in the middle of an allocation, so parse /proc/self/statm
+  // ("size resident shared ...", in pages) without allocating.
+  const int Fd = open("/proc/self/statm", O_RDONLY | O_CLOEXEC);
+  if (Fd < 0)
+    return 0;
+  char Buffer[64];
+  const ssize_t Length = read(Fd, Buffer, sizeof(Buffer) - 1);
+  close(Fd);
+  if (Length <= 0)
+    return 0;
+  Buffer[Length] = '\0';
+  const char *P = Buffer;
+  while (*P && *P != ' ')
+    P++;
+  if (*P != ' ')
+    return 0;
+  P++;
+  uptr Pages = 0;
+  for (; *P >= '0' && *P <= '9'; P++)
+    Pages = Pages * 10 + static_cast<uptr>(*P - '0');
+  return Pages * getPageSizeCached();
+}
+
 u32 getNumberOfCPUs() {
   cpu_set_t CPUs;
   CHECK_EQ(sched_getaffinity(0, sizeof(cpu_set_t), &CPUs), 0);
   return static_cast<u32>(CPU_COUNT(&CPUs));
 }
 
+// With a recent libc, sched_getcpu() reads the CPU number from the thread's
+// restartable sequence area, otherwise it goes through the vDSO. Either way it
+// doesn't enter the kernel.
+s32 getCurrentCPU() { return sched_getcpu(); }
+
 // Blocking is possibly unused if the getrandom block is not compiled in.
 bool getRandom(void *Buffer, uptr Length, UNUSED bool Blocking) {
   if (!Buffer || !Length || Length > MaxRandomLength)
@@ -55,7 +55,10 @@ public:
 
   static bool canAllocate(uptr Size) { return Size <= SizeClassMap::MaxSize; }
 
-  void initLinkerInitialized(s32 ReleaseToOsInterval) {
+  // If ReleaseOnDeallocation is false, memory is only released to the OS by
+  // explicit calls to releaseToOS(), e.g. from a background thread.
+  void initLinkerInitialized(s32 ReleaseToOsInterval,
+                             bool ReleaseOnDeallocation = true) {
     if (SCUDO_FUCHSIA)
       reportError("SizeClassAllocator32 is not supported on Fuchsia");
 
@@ -77,10 +80,11 @@ public:
                         (getSizeByClassId(I) >= (PageSize / 32));
     }
     ReleaseToOsIntervalMs = ReleaseToOsInterval;
+    ReleaseOnPush = ReleaseOnDeallocation;
   }
-  void init(s32 ReleaseToOsInterval) {
+  void init(s32 ReleaseToOsInterval, bool ReleaseOnDeallocation = true) {
     memset(this, 0, sizeof(*this));
-    initLinkerInitialized(ReleaseToOsInterval);
+    initLinkerInitialized(ReleaseToOsInterval, ReleaseOnDeallocation);
   }
 
   void unmapTestOnly() {
@@ -118,7 +122,7 @@ public:
     ScopedLock L(Sci->Mutex);
     Sci->FreeList.push_front(B);
     Sci->Stats.PushedBlocks += B->getCount();
-    if (Sci->CanRelease)
+    if (Sci->CanRelease && ReleaseOnPush)
       releaseToOSMaybe(Sci, ClassId);
   }
 
@@ -161,14 +165,19 @@ public:
       getStats(Str, I, 0);
   }
 
-  uptr releaseToOS() {
+  // Releases the free memory of all size classes to the OS. Unless Force is
+  // true, this is subject to the same conditions as releases on deallocation,
+  // in particular the release interval.
+  uptr releaseToOS(bool Force = true) {
     uptr TotalReleasedBytes = 0;
     for (uptr I = 0; I < NumClasses; I++) {
       if (I == SizeClassMap::BatchClassId)
         continue;
       SizeClassInfo *Sci = getSizeClassInfo(I);
+      if (!Force && !Sci->CanRelease)
+        continue;
       ScopedLock L(Sci->Mutex);
-      TotalReleasedBytes += releaseToOSMaybe(Sci, I, /*Force=*/true);
+      TotalReleasedBytes += releaseToOSMaybe(Sci, I, Force);
     }
     return TotalReleasedBytes;
   }
@@ -398,6 +407,7 @@ private:
   uptr MinRegionIndex;
   uptr MaxRegionIndex;
   s32 ReleaseToOsIntervalMs;
+  bool ReleaseOnPush;
   // Unless several threads request regions simultaneously from different size
   // classes, the stash rarely contains more than 1 entry.
   static constexpr uptr MaxStashedRegions = 4;
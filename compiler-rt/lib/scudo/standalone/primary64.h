@@ -53,7 +53,10 @@ public:
 
   static bool canAllocate(uptr Size) { return Size <= SizeClassMap::MaxSize; }
 
-  void initLinkerInitialized(s32 ReleaseToOsInterval) {
+  // If ReleaseOnDeallocation is false, memory is only released to the OS by
+  // explicit calls to releaseToOS(), e.g. from a background thread.
+  void initLinkerInitialized(s32 ReleaseToOsInterval,
+                             bool ReleaseOnDeallocation = true) {
     // Reserve the space required for the Primary.
     PrimaryBase = reinterpret_cast<uptr>(
         map(nullptr, PrimarySize, "scudo:primary", MAP_NOACCESS, &Data));
@@ -85,10 +88,11 @@ public:
       Region->RandState = getRandomU32(&Seed);
     }
     ReleaseToOsIntervalMs = ReleaseToOsInterval;
+    ReleaseOnPush = ReleaseOnDeallocation;
   }
-  void init(s32 ReleaseToOsInterval) {
+  void init(s32 ReleaseToOsInterval, bool ReleaseOnDeallocation = true) {
     memset(this, 0, sizeof(*this));
-    initLinkerInitialized(ReleaseToOsInterval);
+    initLinkerInitialized(ReleaseToOsInterval, ReleaseOnDeallocation);
   }
 
   void unmapTestOnly() {
@@ -120,7 +124,7 @@ public:
     ScopedLock L(Region->Mutex);
     Region->FreeList.push_front(B);
     Region->Stats.PushedBlocks += B->getCount();
-    if (Region->CanRelease)
+    if (Region->CanRelease && ReleaseOnPush)
       releaseToOSMaybe(Region, ClassId);
   }
 
@@ -168,14 +172,19 @@ public:
       getStats(Str, I, 0);
   }
 
-  uptr releaseToOS() {
+  // Releases the free memory of all size classes to the OS. Unless Force is
+  // true, this is subject to the same conditions as releases on deallocation,
+  // in particular the release interval.
+  uptr releaseToOS(bool Force = true) {
     uptr TotalReleasedBytes = 0;
     for (uptr I = 0; I < NumClasses; I++) {
       if (I == SizeClassMap::BatchClassId)
         continue;
       RegionInfo *Region = getRegionInfo(I);
+      if (!Force && !Region->CanRelease)
+        continue;
       ScopedLock L(Region->Mutex);
-      TotalReleasedBytes += releaseToOSMaybe(Region, I, /*Force=*/true);
+      TotalReleasedBytes += releaseToOSMaybe(Region, I, Force);
     }
     return TotalReleasedBytes;
   }
@@ -219,6 +228,7 @@ private:
   RegionInfo *RegionInfoArray;
   MapPlatformData Data;
   s32 ReleaseToOsIntervalMs;
+  bool ReleaseOnPush;
 
   RegionInfo *getRegionInfo(uptr ClassId) const {
     DCHECK_LT(ClassId, NumClasses);
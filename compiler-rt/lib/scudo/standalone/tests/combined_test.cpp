@@ -25,7 +25,13 @@ static constexpr scudo::Chunk::Origin Origin = scudo::Chunk::Origin::Malloc;
 // parameters are on the low end, to avoid having to loop excessively in some
 // tests.
 static bool UseQuarantine = false;
+// Similarly for the background release, with a short interval and an RSS
+// target that is always exceeded.
+static bool UseBackgroundRelease = false;
 extern "C" const char *__scudo_default_options() {
+  if (UseBackgroundRelease)
+    return "release_to_os_in_background=true:release_to_os_interval_ms=10:"
+           "rss_target_mb=1";
   if (!UseQuarantine)
     return "";
   return "quarantine_size_kb=256:thread_local_quarantine_size_kb=128:"
@@ -219,6 +225,54 @@ TEST(ScudoCombinedTest, ThreadedCombined) {
   testAllocatorThreaded<scudo::AndroidSvelteConfig>();
 }
 
+static std::string getStats(scudo::Allocator<scudo::DefaultConfig> *A) {
+  scudo::uptr BufferSize = 8192;
+  std::vector<char> Buffer(BufferSize);
+  scudo::uptr ActualSize = A->getStats(Buffer.data(), BufferSize);
+  while (ActualSize > BufferSize) {
+    BufferSize = ActualSize + 1024;
+    Buffer.resize(BufferSize);
+    ActualSize = A->getStats(Buffer.data(), BufferSize);
+  }
+  return std::string(Buffer.data());
+}
+
+TEST(ScudoCombinedTest, BackgroundRelease) {
+  using AllocatorT = scudo::Allocator<scudo::DefaultConfig>;
+  auto Deleter = [](AllocatorT *A) {
+    A->unmapTestOnly();
+    delete A;
+  };
+  UseBackgroundRelease = true;
+  std::unique_ptr<AllocatorT, decltype(Deleter)> Allocator(new AllocatorT,
+                                                           Deleter);
+  Allocator->reset();
+
+  // Use a new thread, the exclusive TSD of this one might belong to the
+  // allocator of a previous test.
+  std::thread T([&Allocator]() {
+    std::vector<void *> V;
+    for (scudo::uptr I = 0; I < 1024U; I++)
+      V.push_back(Allocator->allocate(4096U, Origin));
+    for (void *P : V)
+      Allocator->deallocate(P, Origin);
+  });
+  T.join();
+
+  // Wait for the background thread to go through a release.
+  const char *NoRuns = "background release: 0 runs";
+  std::string Stats = getStats(Allocator.get());
+  for (scudo::uptr I = 0; I < 500U && Stats.find(NoRuns) != std::string::npos;
+       I++) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    Stats = getStats(Allocator.get());
+  }
+  EXPECT_NE(Stats.find("Stats: background release:"), std::string::npos);
+  EXPECT_EQ(Stats.find(NoRuns), std::string::npos);
+  EXPECT_EQ(Stats.find("(0 over the RSS target)"), std::string::npos);
+  UseBackgroundRelease = false;
+}
+
 struct DeathConfig {
   // Tiny allocator, its Primary only serves chunks of 1024 bytes.
   using DeathSizeClassMap = scudo::SizeClassMap<1U, 10U, 10U, 10U, 1U, 10U>;
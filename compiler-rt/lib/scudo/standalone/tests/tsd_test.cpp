@@ -15,6 +15,10 @@
 #include <mutex>
 #include <thread>
 
+#if SCUDO_LINUX
+#include <sched.h>
+#endif
+
 // We mock out an allocator with a TSD registry, mostly using empty stubs. The
 // cache contains a single volatile uptr, to be able to test that several
 // concurrent threads will not access or modify the same cache at the same time.
@@ -166,3 +170,43 @@ TEST(ScudoTSDTest, TSDRegistryThreaded) {
   testRegistryThreaded<MockAllocator<SharedCaches>>();
   testRegistryThreaded<MockAllocator<ExclusiveCaches>>();
 }
+
+#if SCUDO_LINUX
+static void *getPinnedTSD(MockAllocator<SharedCaches> *Allocator, int CPU) {
+  cpu_set_t CPUs;
+  CPU_ZERO(&CPUs);
+  CPU_SET(CPU, &CPUs);
+  EXPECT_EQ(sched_setaffinity(0, sizeof(CPUs), &CPUs), 0);
+  auto Registry = Allocator->getTSDRegistry();
+  Registry->initThreadMaybe(Allocator, /*MinimalInit=*/false);
+  bool UnlockRequired;
+  auto TSD = Registry->getTSDAndLock(&UnlockRequired);
+  EXPECT_NE(TSD, nullptr);
+  if (UnlockRequired)
+    TSD->unlock();
+  return TSD;
+}
+
+TEST(ScudoTSDTest, TSDRegistrySharedPerCPU) {
+  using AllocatorT = MockAllocator<SharedCaches>;
+  auto Deleter = [](AllocatorT *A) {
+    A->unmapTestOnly();
+    delete A;
+  };
+  std::unique_ptr<AllocatorT, decltype(Deleter)> Allocator(new AllocatorT,
+                                                           Deleter);
+  Allocator->reset();
+  cpu_set_t CPUs;
+  ASSERT_EQ(sched_getaffinity(0, sizeof(CPUs), &CPUs), 0);
+  int CPU = 0;
+  while (!CPU_ISSET(CPU, &CPUs))
+    CPU++;
+  // Threads running on the same CPU start with the same context.
+  void *TSDs[2];
+  for (void *&TSD : TSDs) {
+    std::thread T([&]() { TSD = getPinnedTSD(Allocator.get(), CPU); });
+    T.join();
+  }
+  EXPECT_EQ(TSDs[0], TSDs[1]);
+}
+#endif // SCUDO_LINUX
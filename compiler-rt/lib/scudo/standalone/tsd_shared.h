@@ -102,13 +102,37 @@ private:
 
   NOINLINE void initThread(Allocator *Instance) {
     initOnceMaybe(Instance);
-    // Initial context assignment is done in a plain round-robin fashion.
+    // Initially use the context of the CPU we are running on. If the CPU is
+    // unknown, assignment is done in a plain round-robin fashion.
+    TSD<Allocator> *CPUTSD = getCPUTSD();
+    if (CPUTSD) {
+      setCurrentTSD(CPUTSD);
+      return;
+    }
     const u32 Index = atomic_fetch_add(&CurrentIndex, 1U, memory_order_relaxed);
     setCurrentTSD(&TSDs[Index % NumberOfTSDs]);
   }
 
+  // Returns the context of the CPU the thread is running on, or null if the
+  // CPU is unknown. As there are as many contexts as CPUs (up to MaxTSDCount),
+  // threads that pick their context this way only contend for it when they
+  // were preempted or migrated while holding it.
+  ALWAYS_INLINE TSD<Allocator> *getCPUTSD() {
+    const s32 CPU = getCurrentCPU();
+    if (CPU < 0)
+      return nullptr;
+    return &TSDs[static_cast<u32>(CPU) % NumberOfTSDs];
+  }
+
   NOINLINE TSD<Allocator> *getTSDAndLockSlow(TSD<Allocator> *CurrentTSD) {
     if (MaxTSDCount > 1U && NumberOfTSDs > 1U) {
+      // The thread probably moved to another CPU since it last allocated, so
+      // first try to follow it.
+      TSD<Allocator> *CPUTSD = getCPUTSD();
+      if (CPUTSD && CPUTSD != CurrentTSD && CPUTSD->tryLock()) {
+        setCurrentTSD(CPUTSD);
+        return CPUTSD;
+      }
       // Use the Precedence of the current TSD as our random seed. Since we are
       // in the slow path, it means that tryLock failed, and as a result it's
       // very likely that said Precedence is non-zero.
@@ -73,8 +73,18 @@ const unsigned kMaxTidInClock = kMaxTid;  // Go does not track freed memory.
 #endif
 const uptr kShadowStackSize = 64 * 1024;
 
+#ifndef TSAN_SHADOW_COUNT
+# define TSAN_SHADOW_COUNT 4
+#endif
+#if TSAN_SHADOW_COUNT != 2 && TSAN_SHADOW_COUNT != 4
+# error "TSAN_SHADOW_COUNT must be 2 or 4"
+#endif
+
 // Count of shadow values in a shadow cell.
-const uptr kShadowCnt = 4;
+// With 2 values, shadow memory is half as large and every access inspects half
+// as many values, but fewer previous accesses are remembered, so some races
+// that involve more than two recent accesses to the same location are missed.
+const uptr kShadowCnt = TSAN_SHADOW_COUNT;
 
 // That many user bytes are mapped onto a single shadow cell.
 const uptr kShadowCell = 8;
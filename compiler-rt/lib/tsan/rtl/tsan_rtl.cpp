@@ -667,7 +667,7 @@ void MemoryAccessImpl1(ThreadState *thr, uptr addr,
   // consumes almost 4K of stack. Gtest gives only 4K of stack to death test
   // threads, which is not enough for the unrolled loop.
 #if SANITIZER_DEBUG
-  for (int idx = 0; idx < 4; idx++) {
+  for (int idx = 0; idx < (int)kShadowCnt; idx++) {
 #include "tsan_update_shadow_word_inl.h"
   }
 #else
@@ -679,6 +679,7 @@ void MemoryAccessImpl1(ThreadState *thr, uptr addr,
   } else {
 #include "tsan_update_shadow_word_inl.h"
   }
+#if TSAN_SHADOW_COUNT > 2
   idx = 2;
   if (stored) {
 #include "tsan_update_shadow_word_inl.h"
@@ -691,6 +692,7 @@ void MemoryAccessImpl1(ThreadState *thr, uptr addr,
   } else {
 #include "tsan_update_shadow_word_inl.h"
   }
+#endif
 #endif
 
   // we did not find any races and had already stored
@@ -742,7 +744,7 @@ bool ContainsSameAccessSlow(u64 *s, u64 a, u64 sync_epoch, bool is_write) {
   return false;
 }
 
-#if defined(__SSE3__)
+#if defined(__SSE3__) && TSAN_SHADOW_COUNT == 4
 #define SHUF(v0, v1, i0, i1, i2, i3) _mm_castps_si128(_mm_shuffle_ps( \
     _mm_castsi128_ps(v0), _mm_castsi128_ps(v1), \
     (i0)*1 + (i1)*4 + (i2)*16 + (i3)*64))
@@ -802,7 +804,7 @@ bool ContainsSameAccessFast(u64 *s, u64 a, u64 sync_epoch, bool is_write) {
 
 ALWAYS_INLINE
 bool ContainsSameAccess(u64 *s, u64 a, u64 sync_epoch, bool is_write) {
-#if defined(__SSE3__)
+#if defined(__SSE3__) && TSAN_SHADOW_COUNT == 4
   bool res = ContainsSameAccessFast(s, a, sync_epoch, is_write);
   // NOTE: this check can fail if the shadow is concurrently mutated
   // by other threads. But it still can be useful if you modify
@@ -823,7 +825,8 @@ void MemoryAccess(ThreadState *thr, uptr pc, uptr addr,
       (int)thr->fast_state.tid(), (void*)pc, (void*)addr,
       (int)(1 << kAccessSizeLog), kAccessIsWrite, shadow_mem,
       (uptr)shadow_mem[0], (uptr)shadow_mem[1],
-      (uptr)shadow_mem[2], (uptr)shadow_mem[3]);
+      kShadowCnt > 2 ? (uptr)shadow_mem[2] : 0,
+      kShadowCnt > 2 ? (uptr)shadow_mem[3] : 0);
 #if SANITIZER_DEBUG
   if (!IsAppMem(addr)) {
     Printf("Access to non app mem %zx\n", addr);
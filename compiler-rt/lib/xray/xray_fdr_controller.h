@@ -28,6 +28,8 @@ template <size_t Version = 5> class FDRController {
   FDRLogWriter &W;
   int (*WallClockReader)(clockid_t, struct timespec *) = 0;
   uint64_t CycleThreshold = 0;
+  // Called with every buffer before it is returned to the queue.
+  void (*Publish)(const BufferQueue::Buffer &) = nullptr;
 
   uint64_t LastFunctionEntryTSC = 0;
   uint64_t LatestTSC = 0;
@@ -134,6 +136,8 @@ template <size_t Version = 5> class FDRController {
       return false;
 
     First = true;
+    if (Publish != nullptr)
+      Publish(B);
     if (finalized()) {
       BQ->releaseBuffer(B); // ignore result.
       return false;
@@ -234,12 +238,15 @@ template <size_t Version = 5> class FDRController {
 public:
   template <class WallClockFunc>
   FDRController(BufferQueue *BQ, BufferQueue::Buffer &B, FDRLogWriter &W,
-                WallClockFunc R, uint64_t C) XRAY_NEVER_INSTRUMENT
+                WallClockFunc R, uint64_t C,
+                void (*P)(const BufferQueue::Buffer &) =
+                    nullptr) XRAY_NEVER_INSTRUMENT
       : BQ(BQ),
         B(B),
         W(W),
         WallClockReader(R),
-        CycleThreshold(C) {}
+        CycleThreshold(C),
+        Publish(P) {}
 
   bool functionEnter(int32_t FuncId, uint64_t TSC,
                      uint16_t CPU) XRAY_NEVER_INSTRUMENT {
@@ -34,6 +34,7 @@
 #include "xray_fdr_controller.h"
 #include "xray_fdr_flags.h"
 #include "xray_fdr_log_writer.h"
+#include "xray_fdr_stream.h"
 #include "xray_flags.h"
 #include "xray_recursion_guard.h"
 #include "xray_tsc.h"
@@ -66,6 +67,12 @@ struct XRAY_TLS_ALIGNAS(64) ThreadLocalData {
                                     alignof(FDRController<>)>::type;
   ControllerStorage CStorage;
   FDRController<> *Controller = nullptr;
+
+  // The number of outermost function calls seen so far, the call depth, and
+  // whether the current outermost call is sampled (see func_sample_rate).
+  uint64_t Calls = 0;
+  uint32_t CallDepth = 0;
+  bool Sampled = true;
 };
 
 } // namespace
@@ -83,6 +90,9 @@ static BufferQueue *BQ = nullptr;
 // Global thresholds for function durations.
 static atomic_uint64_t ThresholdTicks{0};
 
+// Global sample rate for function calls.
+static atomic_uint32_t SampleRate{1};
+
 // Global for ticks per second.
 static atomic_uint64_t TicksPerSec{0};
 
@@ -484,7 +494,7 @@ static bool setupTLD(ThreadLocalData &TLD) XRAY_NEVER_INSTRUMENT {
     auto *CStorage = reinterpret_cast<FDRController<> *>(&TLD.CStorage);
     new (CStorage)
         FDRController<>(TLD.BQ, TLD.Buffer, *TLD.Writer, clock_gettime,
-                        atomic_load_relaxed(&ThresholdTicks));
+                        atomic_load_relaxed(&ThresholdTicks), fdrStreamPublish);
     TLD.Controller = CStorage;
   }
 
@@ -492,6 +502,32 @@ static bool setupTLD(ThreadLocalData &TLD) XRAY_NEVER_INSTRUMENT {
   return true;
 }
 
+// Decides whether a function entry or exit is recorded. With a sample rate of
+// N, only every N-th outermost call on a thread is recorded, together with all
+// the calls it makes, so that the recorded entries and exits stay balanced.
+static bool isSampled(ThreadLocalData &TLD,
+                      XRayEntryType Entry) XRAY_NEVER_INSTRUMENT {
+  uint32_t Rate = atomic_load_relaxed(&SampleRate);
+  if (LIKELY(Rate <= 1))
+    return true;
+  switch (Entry) {
+  case XRayEntryType::ENTRY:
+  case XRayEntryType::LOG_ARGS_ENTRY:
+    if (TLD.CallDepth++ == 0)
+      TLD.Sampled = TLD.Calls++ % Rate == 0;
+    return TLD.Sampled;
+  case XRayEntryType::EXIT:
+  case XRayEntryType::TAIL:
+    if (TLD.CallDepth > 0)
+      --TLD.CallDepth;
+    return TLD.Sampled;
+  case XRayEntryType::CUSTOM_EVENT:
+  case XRayEntryType::TYPED_EVENT:
+    break;
+  }
+  return true;
+}
+
 void fdrLoggingHandleArg0(int32_t FuncId,
                           XRayEntryType Entry) XRAY_NEVER_INSTRUMENT {
   auto TC = getTimestamp();
@@ -502,7 +538,7 @@ void fdrLoggingHandleArg0(int32_t FuncId,
     return;
 
   auto &TLD = getThreadLocalData();
-  if (!setupTLD(TLD))
+  if (!setupTLD(TLD) || !isSampled(TLD, Entry))
     return;
 
   switch (Entry) {
@@ -532,7 +568,7 @@ void fdrLoggingHandleArg1(int32_t FuncId, XRayEntryType Entry,
     return;
 
   auto &TLD = getThreadLocalData();
-  if (!setupTLD(TLD))
+  if (!setupTLD(TLD) || !isSampled(TLD, Entry))
     return;
 
   switch (Entry) {
@@ -677,6 +713,13 @@ XRayLogInitStatus fdrLoggingInit(size_t, size_t, void *Options,
     }
   }
 
+  // Failing to set up the stream is not fatal, the log is still written at
+  // flush.
+  XRayFileHeader StreamHeader = fdrCommonHeaderInfo();
+  StreamHeader.FdrData = FdrAdditionalHeaderData{BQ->ConfiguredBufferSize()};
+  fdrStreamInit(FDRFlags.stream_file, StreamHeader, BQ->ConfiguredBufferSize(),
+                BufferMax);
+
   static pthread_once_t OnceInit = PTHREAD_ONCE_INIT;
   pthread_once(
       &OnceInit, +[] {
@@ -693,6 +736,7 @@ XRayLogInitStatus fdrLoggingInit(size_t, size_t, void *Options,
                 return;
               if (TLD.Buffer.Data == nullptr)
                 return;
+              fdrStreamPublish(TLD.Buffer);
               auto EC = TLD.BQ->releaseBuffer(TLD.Buffer);
               if (EC != BufferQueue::ErrorCode::Ok)
                 Report("At thread exit, failed to release buffer at %p; "
@@ -701,6 +745,10 @@ XRayLogInitStatus fdrLoggingInit(size_t, size_t, void *Options,
             });
       });
 
+  atomic_store(&SampleRate,
+               fdrFlags()->func_sample_rate > 1 ? fdrFlags()->func_sample_rate
+                                                : 1,
+               memory_order_release);
   atomic_store(&ThresholdTicks,
                atomic_load_relaxed(&TicksPerSec) *
                    fdrFlags()->func_duration_threshold_us / 1000000,
@@ -0,0 +1,105 @@
+//===-- xray_fdr_stream.cpp -------------------------------------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// This file is a part of XRay, a function call tracing system.
+//
+// Implements publishing FDR mode buffers to a shared stream file.
+//
+//===----------------------------------------------------------------------===//
+#include "xray_fdr_stream.h"
+
+#include "sanitizer_common/sanitizer_common.h"
+#include "sanitizer_common/sanitizer_file.h"
+#include "sanitizer_common/sanitizer_libc.h"
+#include "xray_defs.h"
+#include "xray_fdr_log_records.h"
+
+namespace __xray {
+
+static atomic_uintptr_t Stream{0};
+static uptr StreamSize = 0;
+
+bool fdrStreamInit(const char *Path, const XRayFileHeader &Header,
+                   size_t BufferSize, size_t SlotCount) XRAY_NEVER_INSTRUMENT {
+  // Unmap the stream of an earlier initialization. Threads no longer publish
+  // to it at this point, as the log was finalized and flushed since.
+  if (auto *Old = reinterpret_cast<FDRStreamHeader *>(
+          atomic_exchange(&Stream, 0, memory_order_acq_rel)))
+    UnmapOrDie(Old, StreamSize);
+
+  if (Path == nullptr || Path[0] == '\0' || SlotCount == 0)
+    return true;
+
+  uptr SlotStride =
+      RoundUpTo(sizeof(FDRStreamSlot) + sizeof(MetadataRecord) + BufferSize,
+                kCacheLineSize);
+  uptr Size = RoundUpTo(sizeof(FDRStreamHeader) + SlotStride * SlotCount,
+                        GetPageSizeCached());
+  fd_t Fd = OpenFile(Path, RdWr);
+  if (Fd == kInvalidFd) {
+    Report("XRay FDR: Failed to open stream file '%s'.\n", Path);
+    return false;
+  }
+  FileCloser Closer(Fd);
+  // Truncate the file first, so that everything in it starts out as zero.
+  if (internal_iserror(internal_ftruncate(Fd, 0)) ||
+      internal_iserror(internal_ftruncate(Fd, Size))) {
+    Report("XRay FDR: Failed to resize stream file '%s'.\n", Path);
+    return false;
+  }
+  auto *H = reinterpret_cast<FDRStreamHeader *>(
+      MapWritableFileToMemory(nullptr, Size, Fd, 0));
+  if (H == nullptr)
+    return false;
+
+  H->Version = kFDRStreamVersion;
+  H->SlotCount = SlotCount;
+  H->SlotStride = SlotStride;
+  H->FileHeader = Header;
+  // Readers check the magic last.
+  atomic_thread_fence(memory_order_release);
+  internal_memcpy(H->Magic, kFDRStreamMagic, sizeof(kFDRStreamMagic));
+
+  StreamSize = Size;
+  atomic_store(&Stream, reinterpret_cast<uptr>(H), memory_order_release);
+  return true;
+}
+
+void fdrStreamPublish(const BufferQueue::Buffer &B) XRAY_NEVER_INSTRUMENT {
+  auto *H = reinterpret_cast<FDRStreamHeader *>(
+      atomic_load(&Stream, memory_order_acquire));
+  if (H == nullptr || B.Data == nullptr)
+    return;
+  uint64_t Extents = atomic_load(B.Extents, memory_order_acquire);
+  if (Extents == 0 || Extents > B.Size)
+    return;
+
+  uint64_t N = atomic_fetch_add(&H->Published, 1, memory_order_relaxed);
+  auto *Slot = reinterpret_cast<FDRStreamSlot *>(
+      reinterpret_cast<char *>(H) + sizeof(FDRStreamHeader) +
+      (N % H->SlotCount) * H->SlotStride);
+  atomic_store(&Slot->Sequence, 2 * N + 1, memory_order_relaxed);
+  atomic_thread_fence(memory_order_release);
+
+  // Like in the log file, the buffer's records are preceded by a record with
+  // their size.
+  MetadataRecord ExtentsRecord;
+  ExtentsRecord.Type = uint8_t(RecordType::Metadata);
+  ExtentsRecord.RecordKind =
+      uint8_t(MetadataRecord::RecordKinds::BufferExtents);
+  internal_memset(ExtentsRecord.Data, 0, sizeof(ExtentsRecord.Data));
+  internal_memcpy(ExtentsRecord.Data, &Extents, sizeof(Extents));
+  char *Data = reinterpret_cast<char *>(Slot + 1);
+  internal_memcpy(Data, &ExtentsRecord, sizeof(ExtentsRecord));
+  internal_memcpy(Data + sizeof(ExtentsRecord), B.Data, Extents);
+  Slot->Size = sizeof(ExtentsRecord) + Extents;
+
+  atomic_store(&Slot->Sequence, 2 * N + 2, memory_order_release);
+}
+
+} // namespace __xray
@@ -0,0 +1,74 @@
+//===-- xray_fdr_stream.h ---------------------------------------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// This file is a part of XRay, a function call tracing system.
+//
+// With the stream_file flag, FDR mode copies every buffer that a thread is done
+// with into a ring of slots in a shared file, so that another process (e.g.
+// `llvm-xray live`) can consume the trace while the program runs.
+//
+//===----------------------------------------------------------------------===//
+#ifndef XRAY_XRAY_FDR_STREAM_H
+#define XRAY_XRAY_FDR_STREAM_H
+
+#include <time.h>
+
+#include "sanitizer_common/sanitizer_atomic.h"
+#include "xray/xray_records.h"
+#include "xray_buffer_queue.h"
+
+namespace __xray {
+
+// The layout of the stream file. It starts with an FDRStreamHeader, followed
+// by SlotCount slots of SlotStride bytes each. Each slot starts with an
+// FDRStreamSlot, followed by the slot's data: a BufferExtents metadata record
+// and the records of one buffer, i.e. one block of an FDR mode log file.
+//
+// The N-th published buffer (counting from zero) goes into slot N % SlotCount.
+// While it is being written, the slot's Sequence is 2 * N + 1, and once it is
+// complete, 2 * N + 2. Readers compare the sequence before and after copying
+// the slot's data to detect slots that have been overwritten in the meantime.
+//
+// llvm-xray has its own copy of this layout, keep the two in sync.
+struct FDRStreamHeader {
+  char Magic[8];
+  uint32_t Version;
+  uint32_t SlotCount;
+  uint64_t SlotStride;
+  // The number of buffers that have been published, including the ones that
+  // are still being written.
+  atomic_uint64_t Published;
+  // The header of an FDR mode log file with the records in the slots.
+  XRayFileHeader FileHeader;
+};
+
+struct FDRStreamSlot {
+  atomic_uint64_t Sequence;
+  // The number of bytes of data in the slot.
+  uint64_t Size;
+};
+
+static_assert(sizeof(FDRStreamHeader) == 64, "FDRStreamHeader != 64 bytes");
+static_assert(sizeof(FDRStreamSlot) == 16, "FDRStreamSlot != 16 bytes");
+
+static constexpr char kFDRStreamMagic[8] = {'X', 'R', 'A', 'Y',
+                                            'S', 'T', 'R', 'M'};
+static constexpr uint32_t kFDRStreamVersion = 1;
+
+// Creates the stream file at Path, with room for SlotCount buffers of
+// BufferSize bytes, replacing the stream of an earlier initialization. Returns
+// false on failure, in which case nothing is published.
+bool fdrStreamInit(const char *Path, const XRayFileHeader &Header,
+                   size_t BufferSize, size_t SlotCount);
+
+// Copies the records in B into the stream, if there is one.
+void fdrStreamPublish(const BufferQueue::Buffer &B);
+
+} // namespace __xray
+
+#endif // XRAY_XRAY_FDR_STREAM_H
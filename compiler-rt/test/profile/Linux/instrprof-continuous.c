@@ -0,0 +1,28 @@
+// RUN: %clang_profgen -o %t %s
+// RUN: rm -rf %t.profdir
+// RUN: env LLVM_PROFILE_FILE=%t.profdir/default_%c.profraw not --crash %run %t
+// RUN: llvm-profdata show --all-functions --counts %t.profdir/default_.profraw | FileCheck %s
+//
+// With %m, the counters of each killed run are added to the file.
+// RUN: env LLVM_PROFILE_FILE=%t.profdir/merge_%c%m.profraw not --crash %run %t
+// RUN: env LLVM_PROFILE_FILE=%t.profdir/merge_%c%m.profraw not --crash %run %t
+// RUN: llvm-profdata show --all-functions --counts %t.profdir/merge_*.profraw | FileCheck %s --check-prefix=MERGE
+
+#include <signal.h>
+#include <unistd.h>
+
+void foo(int N) {}
+
+int main() {
+  for (int I = 0; I < 5; ++I)
+    foo(I);
+  // Nothing is written at exit: the counters are already in the file.
+  kill(getpid(), SIGKILL);
+  return 0;
+}
+
+// CHECK: Total functions: 2
+// CHECK: Maximum function count: 5
+
+// MERGE: Total functions: 2
+// MERGE: Maximum function count: 10
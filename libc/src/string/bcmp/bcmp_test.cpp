@@ -0,0 +1,30 @@
+//===------------------------ Unittests for bcmp --------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include <vector>
+
+#include "src/string/bcmp/bcmp.h"
+#include "gtest/gtest.h"
+
+TEST(BcmpTest, Equal) {
+  std::vector<char> lhs(300, 'a'), rhs(300, 'a');
+  for (size_t size = 0; size <= lhs.size(); ++size)
+    ASSERT_EQ(__llvm_libc::bcmp(lhs.data(), rhs.data(), size), 0);
+}
+
+TEST(BcmpTest, SingleDifference) {
+  const size_t kMaxSize = 200;
+  for (size_t size = 1; size <= kMaxSize; ++size) {
+    for (size_t pos = 0; pos < size; ++pos) {
+      std::vector<char> lhs(size, 'a'), rhs(size, 'a');
+      rhs[pos] = 'b';
+      ASSERT_NE(__llvm_libc::bcmp(lhs.data(), rhs.data(), size), 0)
+          << "size " << size << " pos " << pos;
+    }
+  }
+}
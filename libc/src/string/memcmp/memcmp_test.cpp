@@ -0,0 +1,37 @@
+//===----------------------- Unittests for memcmp -------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include <vector>
+
+#include "src/string/memcmp/memcmp.h"
+#include "gtest/gtest.h"
+
+TEST(MemcmpTest, Equal) {
+  std::vector<char> lhs(300, 'a'), rhs(300, 'a');
+  for (size_t size = 0; size <= lhs.size(); ++size)
+    ASSERT_EQ(__llvm_libc::memcmp(lhs.data(), rhs.data(), size), 0);
+}
+
+// Places a single difference at every position and checks its sign, also
+// for bytes that compare differently as signed chars.
+TEST(MemcmpTest, FirstDifferenceDecides) {
+  const size_t kMaxSize = 200;
+  for (size_t size = 1; size <= kMaxSize; ++size) {
+    for (size_t pos = 0; pos < size; ++pos) {
+      std::vector<char> lhs(size, 'a'), rhs(size, 'a');
+      lhs[pos] = 'b';
+      rhs[pos] = static_cast<char>(0x80);
+      if (pos + 1 < size)
+        lhs[size - 1] = 'z';
+      ASSERT_LT(__llvm_libc::memcmp(lhs.data(), rhs.data(), size), 0)
+          << "size " << size << " pos " << pos;
+      ASSERT_GT(__llvm_libc::memcmp(rhs.data(), lhs.data(), size), 0)
+          << "size " << size << " pos " << pos;
+    }
+  }
+}
@@ -0,0 +1,23 @@
+//===---------------------- Implementation of memcpy ----------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "src/string/memcpy/memcpy.h"
+
+#include "src/__support/common.h"
+#include "src/string/memory_utils/memcpy_utils.h"
+
+namespace __llvm_libc {
+
+void *LLVM_LIBC_ENTRYPOINT(memcpy)(void *__restrict dst,
+                                  const void *__restrict src, size_t count) {
+  CopyMemory(reinterpret_cast<char *>(dst), reinterpret_cast<const char *>(src),
+             count);
+  return dst;
+}
+
+} // namespace __llvm_libc
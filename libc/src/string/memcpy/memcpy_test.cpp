@@ -0,0 +1,37 @@
+//===----------------------- Unittests for memcpy -------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include <vector>
+
+#include "src/string/memcpy/memcpy.h"
+#include "gtest/gtest.h"
+
+// Copies every size up to a few large blocks, from and to every alignment, and
+// checks that exactly the requested bytes change.
+TEST(MemcpyTest, SizesAndAlignments) {
+  const size_t kMaxSize = 400;
+  const size_t kMaxOffset = 64;
+  std::vector<char> src(kMaxSize + kMaxOffset);
+  for (size_t i = 0; i < src.size(); ++i)
+    src[i] = static_cast<char>(i * 7 + 1);
+  for (size_t size = 0; size <= kMaxSize; ++size) {
+    for (size_t offset = 0; offset < kMaxOffset; offset += 7) {
+      std::vector<char> dst(kMaxSize + kMaxOffset + 1, 'x');
+      void *result = __llvm_libc::memcpy(dst.data() + offset,
+                                         src.data() + 64 - offset, size);
+      ASSERT_EQ(dst.data() + offset, result);
+      for (size_t i = 0; i < dst.size(); ++i) {
+        if (i < offset || i >= offset + size)
+          ASSERT_EQ(dst[i], 'x') << "size " << size << " offset " << offset;
+        else
+          ASSERT_EQ(dst[i], src[64 - offset + i - offset])
+              << "size " << size << " offset " << offset;
+      }
+    }
+  }
+}
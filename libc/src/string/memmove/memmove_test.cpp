@@ -0,0 +1,36 @@
+//===----------------------- Unittests for memmove ------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include <vector>
+
+#include "src/string/memmove/memmove.h"
+#include "gtest/gtest.h"
+
+// Moves every size up to a few large blocks within one buffer, by every
+// distance in both directions, and compares with a move through a copy.
+TEST(MemmoveTest, OverlappingSizesAndDistances) {
+  const size_t kMaxSize = 300;
+  const size_t kBase = 100;
+  std::vector<char> initial(kMaxSize + 2 * kBase);
+  for (size_t i = 0; i < initial.size(); ++i)
+    initial[i] = static_cast<char>(i * 7 + 1);
+  for (size_t size = 0; size <= kMaxSize; size += size < 140 ? 1 : 13) {
+    for (int distance = -int(kBase); distance <= int(kBase); distance += 3) {
+      std::vector<char> buffer = initial;
+      std::vector<char> expected = initial;
+      char *src = buffer.data() + kBase;
+      char *dst = src + distance;
+      std::vector<char> moved(src, src + size);
+      std::copy(moved.begin(), moved.end(),
+                expected.begin() + kBase + distance);
+      ASSERT_EQ(dst, __llvm_libc::memmove(dst, src, size));
+      ASSERT_EQ(buffer, expected)
+          << "size " << size << " distance " << distance;
+    }
+  }
+}
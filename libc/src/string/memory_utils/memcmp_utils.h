@@ -0,0 +1,115 @@
+//===---------------------------- Memcmp utils ----------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_LIBC_SRC_STRING_MEMORY_UTILS_MEMCMP_UTILS_H
+#define LLVM_LIBC_SRC_STRING_MEMORY_UTILS_MEMCMP_UTILS_H
+
+#include "src/string/memory_utils/utils.h"
+
+namespace __llvm_libc {
+
+// Returns zero if the kBlockSize bytes at a and b are equal, and nonzero
+// otherwise.
+template <size_t kBlockSize>
+LLVM_LIBC_INLINE uint64_t DiffBlock(const char *a, const char *b) {
+  static_assert(kBlockSize % 8 == 0, "kBlockSize must be a multiple of 8");
+  uint64_t diff = 0;
+  for (size_t i = 0; i < kBlockSize; i += 8)
+    diff |= load<uint64_t>(a + i) ^ load<uint64_t>(b + i);
+  return diff;
+}
+
+template <>
+LLVM_LIBC_INLINE uint64_t DiffBlock<1>(const char *a, const char *b) {
+  return load<uint8_t>(a) ^ load<uint8_t>(b);
+}
+
+template <>
+LLVM_LIBC_INLINE uint64_t DiffBlock<2>(const char *a, const char *b) {
+  return load<uint16_t>(a) ^ load<uint16_t>(b);
+}
+
+template <>
+LLVM_LIBC_INLINE uint64_t DiffBlock<4>(const char *a, const char *b) {
+  return load<uint32_t>(a) ^ load<uint32_t>(b);
+}
+
+// Compares the count bytes at a and b with two possibly overlapping blocks.
+// Precondition: kBlockSize <= count <= 2 * kBlockSize.
+template <size_t kBlockSize>
+LLVM_LIBC_INLINE uint64_t DiffBlockOverlap(const char *a, const char *b,
+                                           size_t count) {
+  const size_t offset = count - kBlockSize;
+  return DiffBlock<kBlockSize>(a, b) |
+         DiffBlock<kBlockSize>(a + offset, b + offset);
+}
+
+// Returns zero if the count bytes at a and b are equal, and nonzero otherwise.
+static inline uint64_t DiffMemory(const char *a, const char *b, size_t count) {
+  if (count == 0)
+    return 0;
+  if (count == 1)
+    return DiffBlock<1>(a, b);
+  if (count == 2)
+    return DiffBlock<2>(a, b);
+  if (count == 3)
+    return DiffBlock<2>(a, b) | DiffBlock<1>(a + 2, b + 2);
+  if (count <= 8)
+    return DiffBlockOverlap<4>(a, b, count);
+  if (count <= 16)
+    return DiffBlockOverlap<8>(a, b, count);
+  if (count <= 32)
+    return DiffBlockOverlap<16>(a, b, count);
+  size_t offset = 0;
+  for (; offset + 32 < count; offset += 32)
+    if (DiffBlock<32>(a + offset, b + offset))
+      return 1;
+  return DiffBlock<32>(a + count - 32, b + count - 32);
+}
+
+// Compares the 8 bytes at a and b as unsigned chars, in the order memcmp does.
+LLVM_LIBC_INLINE int CompareWord(const char *a, const char *b) {
+  uint64_t x = load<uint64_t>(a);
+  uint64_t y = load<uint64_t>(b);
+  if (x == y)
+    return 0;
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+  x = __builtin_bswap64(x);
+  y = __builtin_bswap64(y);
+#endif
+  return x < y ? -1 : 1;
+}
+
+// Compares count bytes at a and b like memcmp. Equal prefixes, the common
+// case, are skipped over 32 bytes at a time.
+static inline int CompareMemory(const char *a, const char *b, size_t count) {
+  if (count < 8) {
+    for (size_t i = 0; i < count; ++i)
+      if (a[i] != b[i])
+        return static_cast<unsigned char>(a[i]) <
+                       static_cast<unsigned char>(b[i])
+                   ? -1
+                   : 1;
+    return 0;
+  }
+  size_t offset = 0;
+  for (; offset + 32 <= count; offset += 32)
+    if (DiffBlock<32>(a + offset, b + offset))
+      break;
+  for (; offset + 8 <= count; offset += 8)
+    if (int result = CompareWord(a + offset, b + offset))
+      return result;
+  // The bytes before offset are equal, so the last word may overlap them.
+  if (offset < count)
+    return CompareWord(a + count - 8, b + count - 8);
+  return 0;
+}
+
+} // namespace __llvm_libc
+
+#endif // LLVM_LIBC_SRC_STRING_MEMORY_UTILS_MEMCMP_UTILS_H
@@ -0,0 +1,123 @@
+//===---------------------------- Memcpy utils ----------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_LIBC_SRC_STRING_MEMORY_UTILS_MEMCPY_UTILS_H
+#define LLVM_LIBC_SRC_STRING_MEMORY_UTILS_MEMCPY_UTILS_H
+
+#include "src/string/memory_utils/utils.h"
+
+namespace __llvm_libc {
+
+// Copies kBlockSize bytes from src to dst. kBlockSize is a compile time
+// constant, so this compiles down to the widest loads and stores available.
+template <size_t kBlockSize>
+LLVM_LIBC_INLINE void CopyBlock(char *__restrict dst,
+                                const char *__restrict src) {
+  __builtin_memcpy(dst, src, kBlockSize);
+}
+
+// Copies the last kBlockSize bytes from src to dst.
+// Precondition: count >= kBlockSize.
+template <size_t kBlockSize>
+LLVM_LIBC_INLINE void CopyLastBlock(char *__restrict dst,
+                                    const char *__restrict src, size_t count) {
+  const size_t offset = count - kBlockSize;
+  CopyBlock<kBlockSize>(dst + offset, src + offset);
+}
+
+// Copies count bytes from src to dst with two possibly overlapping blocks.
+// Precondition: kBlockSize <= count <= 2 * kBlockSize.
+template <size_t kBlockSize>
+LLVM_LIBC_INLINE void CopyBlockOverlap(char *__restrict dst,
+                                       const char *__restrict src,
+                                       size_t count) {
+  CopyBlock<kBlockSize>(dst, src);
+  CopyLastBlock<kBlockSize>(dst, src, count);
+}
+
+// Copies count bytes from src to dst in blocks that are aligned in dst. The
+// first and the last block may overlap the aligned ones.
+// Precondition: count >= kBlockSize.
+template <size_t kBlockSize>
+LLVM_LIBC_INLINE void CopyAlignedBlocks(char *__restrict dst,
+                                        const char *__restrict src,
+                                        size_t count) {
+  CopyBlock<kBlockSize>(dst, src);
+  size_t offset = kBlockSize - offset_from_last_aligned<kBlockSize>(dst);
+  for (; offset + kBlockSize < count; offset += kBlockSize)
+    CopyBlock<kBlockSize>(dst + offset, src + offset);
+  CopyLastBlock<kBlockSize>(dst, src, count);
+}
+
+// Copies of this many bytes or more go to the kernel picked for the CPU.
+static constexpr size_t kLargeCopySize = 128;
+
+using CopyLargeFn = void (*)(char *__restrict, const char *__restrict, size_t);
+
+static void CopyLargeDefault(char *__restrict dst, const char *__restrict src,
+                             size_t count) {
+  CopyAlignedBlocks<32>(dst, src, count);
+}
+
+#ifdef LLVM_LIBC_HAS_WIDE_VECTORS
+LLVM_LIBC_TARGET_AVX static void
+CopyLargeAvx(char *__restrict dst, const char *__restrict src, size_t count) {
+  CopyAlignedBlocks<32>(dst, src, count);
+}
+
+LLVM_LIBC_TARGET_AVX512 static void
+CopyLargeAvx512(char *__restrict dst, const char *__restrict src,
+                size_t count) {
+  CopyAlignedBlocks<64>(dst, src, count);
+}
+#endif
+
+static CopyLargeFn SelectCopyLarge() {
+#ifdef LLVM_LIBC_HAS_WIDE_VECTORS
+  switch (get_vector_width()) {
+  case 64:
+    return CopyLargeAvx512;
+  case 32:
+    return CopyLargeAvx;
+  }
+#endif
+  return CopyLargeDefault;
+}
+
+// Copies count bytes from src to dst, picking the copy strategy by size class.
+// Small sizes are the most frequent ones, so they are handled first, without
+// loops.
+static inline void CopyMemory(char *__restrict dst, const char *__restrict src,
+                              size_t count) {
+  static CopyLargeFn CopyLarge;
+  if (count == 0)
+    return;
+  if (count == 1)
+    return CopyBlock<1>(dst, src);
+  if (count == 2)
+    return CopyBlock<2>(dst, src);
+  if (count == 3)
+    return CopyBlock<3>(dst, src);
+  if (count == 4)
+    return CopyBlock<4>(dst, src);
+  if (count < 8)
+    return CopyBlockOverlap<4>(dst, src, count);
+  if (count < 16)
+    return CopyBlockOverlap<8>(dst, src, count);
+  if (count < 32)
+    return CopyBlockOverlap<16>(dst, src, count);
+  if (count < 64)
+    return CopyBlockOverlap<32>(dst, src, count);
+  if (count < kLargeCopySize)
+    return CopyBlockOverlap<64>(dst, src, count);
+  get_kernel(&CopyLarge, SelectCopyLarge)(dst, src, count);
+}
+
+} // namespace __llvm_libc
+
+#endif // LLVM_LIBC_SRC_STRING_MEMORY_UTILS_MEMCPY_UTILS_H
@@ -0,0 +1,100 @@
+//===--------------------------- Memmove utils ----------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_LIBC_SRC_STRING_MEMORY_UTILS_MEMMOVE_UTILS_H
+#define LLVM_LIBC_SRC_STRING_MEMORY_UTILS_MEMMOVE_UTILS_H
+
+#include "src/string/memory_utils/memcpy_utils.h"
+
+namespace __llvm_libc {
+
+// Moves kBlockSize bytes from src to dst, which may overlap. All bytes are
+// loaded before any is stored.
+template <size_t kBlockSize>
+LLVM_LIBC_INLINE void MoveBlock(char *dst, const char *src) {
+  char tmp[kBlockSize];
+  __builtin_memcpy(tmp, src, kBlockSize);
+  __builtin_memcpy(dst, tmp, kBlockSize);
+}
+
+// Moves count bytes from src to dst, which may overlap, with two possibly
+// overlapping blocks.
+// Precondition: kBlockSize <= count <= 2 * kBlockSize.
+template <size_t kBlockSize>
+LLVM_LIBC_INLINE void MoveBlockOverlap(char *dst, const char *src,
+                                       size_t count) {
+  char head[kBlockSize];
+  char tail[kBlockSize];
+  __builtin_memcpy(head, src, kBlockSize);
+  __builtin_memcpy(tail, src + count - kBlockSize, kBlockSize);
+  __builtin_memcpy(dst, head, kBlockSize);
+  __builtin_memcpy(dst + count - kBlockSize, tail, kBlockSize);
+}
+
+static constexpr size_t kMoveBlockSize = 32;
+
+// Moves count bytes from src to dst, front to back. The last block is loaded
+// first, as the loop may overwrite it when dst < src.
+// Precondition: count >= kMoveBlockSize.
+static inline void MoveForward(char *dst, const char *src, size_t count) {
+  char tail[kMoveBlockSize];
+  __builtin_memcpy(tail, src + count - kMoveBlockSize, kMoveBlockSize);
+  for (size_t offset = 0; offset + kMoveBlockSize < count;
+       offset += kMoveBlockSize)
+    MoveBlock<kMoveBlockSize>(dst + offset, src + offset);
+  __builtin_memcpy(dst + count - kMoveBlockSize, tail, kMoveBlockSize);
+}
+
+// Moves count bytes from src to dst, back to front. The first block is loaded
+// first, as the loop may overwrite it when dst > src.
+// Precondition: count >= kMoveBlockSize.
+static inline void MoveBackward(char *dst, const char *src, size_t count) {
+  char head[kMoveBlockSize];
+  __builtin_memcpy(head, src, kMoveBlockSize);
+  for (size_t offset = count; offset > kMoveBlockSize;) {
+    offset -= kMoveBlockSize;
+    MoveBlock<kMoveBlockSize>(dst + offset, src + offset);
+  }
+  __builtin_memcpy(dst, head, kMoveBlockSize);
+}
+
+// Moves count bytes from src to dst, which may overlap. Small sizes load
+// everything before storing anything, large non-overlapping moves are copies.
+static inline void MoveMemory(char *dst, const char *src, size_t count) {
+  if (count == 0)
+    return;
+  if (count == 1)
+    return MoveBlock<1>(dst, src);
+  if (count == 2)
+    return MoveBlock<2>(dst, src);
+  if (count == 3)
+    return MoveBlock<3>(dst, src);
+  if (count == 4)
+    return MoveBlock<4>(dst, src);
+  if (count < 8)
+    return MoveBlockOverlap<4>(dst, src, count);
+  if (count < 16)
+    return MoveBlockOverlap<8>(dst, src, count);
+  if (count < 32)
+    return MoveBlockOverlap<16>(dst, src, count);
+  if (count < 64)
+    return MoveBlockOverlap<32>(dst, src, count);
+  if (count < 128)
+    return MoveBlockOverlap<64>(dst, src, count);
+  const uintptr_t d = reinterpret_cast<uintptr_t>(dst);
+  const uintptr_t s = reinterpret_cast<uintptr_t>(src);
+  if (d + count <= s || s + count <= d)
+    return CopyMemory(dst, src, count);
+  if (d < s)
+    return MoveForward(dst, src, count);
+  MoveBackward(dst, src, count);
+}
+
+} // namespace __llvm_libc
+
+#endif // LLVM_LIBC_SRC_STRING_MEMORY_UTILS_MEMMOVE_UTILS_H
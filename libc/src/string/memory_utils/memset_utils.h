@@ -0,0 +1,115 @@
+//===---------------------------- Memset utils ----------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_LIBC_SRC_STRING_MEMORY_UTILS_MEMSET_UTILS_H
+#define LLVM_LIBC_SRC_STRING_MEMORY_UTILS_MEMSET_UTILS_H
+
+#include "src/string/memory_utils/utils.h"
+
+namespace __llvm_libc {
+
+// Sets kBlockSize bytes at dst to value. kBlockSize is a compile time
+// constant, so this compiles down to the widest stores available.
+template <size_t kBlockSize>
+LLVM_LIBC_INLINE void SetBlock(char *dst, unsigned char value) {
+  __builtin_memset(dst, value, kBlockSize);
+}
+
+// Sets the last kBlockSize bytes of the count bytes at dst to value.
+// Precondition: count >= kBlockSize.
+template <size_t kBlockSize>
+LLVM_LIBC_INLINE void SetLastBlock(char *dst, unsigned char value,
+                                   size_t count) {
+  SetBlock<kBlockSize>(dst + count - kBlockSize, value);
+}
+
+// Sets count bytes at dst to value with two possibly overlapping blocks.
+// Precondition: kBlockSize <= count <= 2 * kBlockSize.
+template <size_t kBlockSize>
+LLVM_LIBC_INLINE void SetBlockOverlap(char *dst, unsigned char value,
+                                      size_t count) {
+  SetBlock<kBlockSize>(dst, value);
+  SetLastBlock<kBlockSize>(dst, value, count);
+}
+
+// Sets count bytes at dst to value in blocks that are aligned in dst. The
+// first and the last block may overlap the aligned ones.
+// Precondition: count >= kBlockSize.
+template <size_t kBlockSize>
+LLVM_LIBC_INLINE void SetAlignedBlocks(char *dst, unsigned char value,
+                                       size_t count) {
+  SetBlock<kBlockSize>(dst, value);
+  size_t offset = kBlockSize - offset_from_last_aligned<kBlockSize>(dst);
+  for (; offset + kBlockSize < count; offset += kBlockSize)
+    SetBlock<kBlockSize>(dst + offset, value);
+  SetLastBlock<kBlockSize>(dst, value, count);
+}
+
+// Sets of this many bytes or more go to the kernel picked for the CPU.
+static constexpr size_t kLargeSetSize = 128;
+
+using SetLargeFn = void (*)(char *, unsigned char, size_t);
+
+static void SetLargeDefault(char *dst, unsigned char value, size_t count) {
+  SetAlignedBlocks<32>(dst, value, count);
+}
+
+#ifdef LLVM_LIBC_HAS_WIDE_VECTORS
+LLVM_LIBC_TARGET_AVX static void SetLargeAvx(char *dst, unsigned char value,
+                                             size_t count) {
+  SetAlignedBlocks<32>(dst, value, count);
+}
+
+LLVM_LIBC_TARGET_AVX512 static void
+SetLargeAvx512(char *dst, unsigned char value, size_t count) {
+  SetAlignedBlocks<64>(dst, value, count);
+}
+#endif
+
+static SetLargeFn SelectSetLarge() {
+#ifdef LLVM_LIBC_HAS_WIDE_VECTORS
+  switch (get_vector_width()) {
+  case 64:
+    return SetLargeAvx512;
+  case 32:
+    return SetLargeAvx;
+  }
+#endif
+  return SetLargeDefault;
+}
+
+// Sets count bytes at dst to value, picking the strategy by size class like
+// CopyMemory does.
+static inline void SetMemory(char *dst, unsigned char value, size_t count) {
+  static SetLargeFn SetLarge;
+  if (count == 0)
+    return;
+  if (count == 1)
+    return SetBlock<1>(dst, value);
+  if (count == 2)
+    return SetBlock<2>(dst, value);
+  if (count == 3)
+    return SetBlock<3>(dst, value);
+  if (count == 4)
+    return SetBlock<4>(dst, value);
+  if (count < 8)
+    return SetBlockOverlap<4>(dst, value, count);
+  if (count < 16)
+    return SetBlockOverlap<8>(dst, value, count);
+  if (count < 32)
+    return SetBlockOverlap<16>(dst, value, count);
+  if (count < 64)
+    return SetBlockOverlap<32>(dst, value, count);
+  if (count < kLargeSetSize)
+    return SetBlockOverlap<64>(dst, value, count);
+  get_kernel(&SetLarge, SelectSetLarge)(dst, value, count);
+}
+
+} // namespace __llvm_libc
+
+#endif // LLVM_LIBC_SRC_STRING_MEMORY_UTILS_MEMSET_UTILS_H
@@ -0,0 +1,72 @@
+//===---------------------------- Memory utils ----------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_LIBC_SRC_STRING_MEMORY_UTILS_UTILS_H
+#define LLVM_LIBC_SRC_STRING_MEMORY_UTILS_UTILS_H
+
+#include <stddef.h> // size_t
+#include <stdint.h> // intptr_t / uintptr_t
+
+// The helpers below are meant to be inlined into the entrypoints, also into
+// the ones compiled for a wider vector extension than the default target.
+#define LLVM_LIBC_INLINE __attribute__((always_inline)) inline
+
+namespace __llvm_libc {
+
+// Returns the number of bytes to substract from ptr to get to the previous
+// multiple of alignment. If ptr is already aligned returns 0.
+template <size_t alignment>
+LLVM_LIBC_INLINE intptr_t offset_from_last_aligned(const void *ptr) {
+  static_assert((alignment & (alignment - 1)) == 0,
+                "alignment must be a power of 2");
+  return reinterpret_cast<uintptr_t>(ptr) & (alignment - 1U);
+}
+
+// Loads a T from ptr, which does not have to be aligned.
+template <typename T> LLVM_LIBC_INLINE T load(const char *ptr) {
+  T value;
+  __builtin_memcpy(&value, ptr, sizeof(T));
+  return value;
+}
+
+// The width in bytes of the widest vector loads and stores that the running
+// CPU supports, as reported by __cpu_model from the compiler-rt builtins
+// (cpu_model.c). Only x86 has more than one width to choose from.
+static inline size_t get_vector_width() {
+#if defined(__x86_64__) || defined(__i386__)
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx512f"))
+    return 64;
+  if (__builtin_cpu_supports("avx"))
+    return 32;
+#endif
+  return 16;
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+#define LLVM_LIBC_TARGET_AVX __attribute__((target("avx")))
+#define LLVM_LIBC_TARGET_AVX512 __attribute__((target("avx512f")))
+#define LLVM_LIBC_HAS_WIDE_VECTORS 1
+#endif
+
+// Returns the kernel that select() picks for the running CPU, calling it only
+// the first time. All threads that race on the first call store the same
+// kernel into *cache, which must be zero initialized.
+template <typename Fn, typename SelectFn>
+LLVM_LIBC_INLINE Fn get_kernel(Fn *cache, SelectFn select) {
+  Fn kernel = __atomic_load_n(cache, __ATOMIC_RELAXED);
+  if (!kernel) {
+    kernel = select();
+    __atomic_store_n(cache, kernel, __ATOMIC_RELAXED);
+  }
+  return kernel;
+}
+
+} // namespace __llvm_libc
+
+#endif // LLVM_LIBC_SRC_STRING_MEMORY_UTILS_UTILS_H
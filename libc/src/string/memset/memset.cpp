@@ -0,0 +1,22 @@
+//===---------------------- Implementation of memset ----------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "src/string/memset/memset.h"
+
+#include "src/__support/common.h"
+#include "src/string/memory_utils/memset_utils.h"
+
+namespace __llvm_libc {
+
+void *LLVM_LIBC_ENTRYPOINT(memset)(void *dst, int value, size_t count) {
+  SetMemory(reinterpret_cast<char *>(dst), static_cast<unsigned char>(value),
+            count);
+  return dst;
+}
+
+} // namespace __llvm_libc
@@ -0,0 +1,34 @@
+//===----------------------- Unittests for memset -------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include <vector>
+
+#include "src/string/memset/memset.h"
+#include "gtest/gtest.h"
+
+TEST(MemsetTest, SizesAndAlignments) {
+  const size_t kMaxSize = 400;
+  const size_t kMaxOffset = 64;
+  for (size_t size = 0; size <= kMaxSize; ++size) {
+    for (size_t offset = 0; offset < kMaxOffset; offset += 7) {
+      std::vector<char> dst(kMaxSize + kMaxOffset + 1, 'x');
+      void *result = __llvm_libc::memset(dst.data() + offset, 'y', size);
+      ASSERT_EQ(dst.data() + offset, result);
+      for (size_t i = 0; i < dst.size(); ++i)
+        ASSERT_EQ(dst[i], i < offset || i >= offset + size ? 'x' : 'y')
+            << "size " << size << " offset " << offset;
+    }
+  }
+}
+
+TEST(MemsetTest, ValueIsConvertedToUnsignedChar) {
+  char dst[4];
+  __llvm_libc::memset(dst, 0x1ff, sizeof(dst));
+  for (char c : dst)
+    ASSERT_EQ(static_cast<unsigned char>(c), 0xffU);
+}
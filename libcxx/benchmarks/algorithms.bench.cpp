@@ -14,14 +14,19 @@
 
 namespace {
 
-enum class ValueType { Uint32, String };
-struct AllValueTypes : EnumValuesAsTuple<AllValueTypes, ValueType, 2> {
-  static constexpr const char* Names[] = {"uint32", "string"};
+enum class ValueType { Uint32, Uint64, Pointer, String };
+struct AllValueTypes : EnumValuesAsTuple<AllValueTypes, ValueType, 4> {
+  static constexpr const char* Names[] = {"uint32", "uint64", "pointer",
+                                          "string"};
 };
 
 template <class V>
-using Value =
-    std::conditional_t<V() == ValueType::Uint32, uint32_t, std::string>;
+using Value = std::conditional_t<
+    V() == ValueType::Uint32, uint32_t,
+    std::conditional_t<
+        V() == ValueType::Uint64, uint64_t,
+        std::conditional_t<V() == ValueType::Pointer, const uint32_t*,
+                           std::string> > >;
 
 enum class Order {
   Random,
@@ -37,7 +42,8 @@ struct AllOrders : EnumValuesAsTuple<AllOrders, Order, 6> {
                                           "PipeOrgan",  "Heap"};
 };
 
-void fillValues(std::vector<uint32_t>& V, size_t N, Order O) {
+template <class T>
+void fillValues(std::vector<T>& V, size_t N, Order O) {
   if (O == Order::SingleElement) {
     V.resize(N, 0);
   } else {
@@ -46,6 +52,17 @@ void fillValues(std::vector<uint32_t>& V, size_t N, Order O) {
   }
 }
 
+void fillValues(std::vector<const uint32_t*>& V, size_t N, Order O) {
+  // The pointers index into storage that outlives the cached inputs.
+  static const std::vector<uint32_t> Storage(1 << 18);
+  if (O == Order::SingleElement) {
+    V.resize(N, Storage.data());
+  } else {
+    while (V.size() < N)
+      V.push_back(Storage.data() + V.size());
+  }
+}
+
 void fillValues(std::vector<std::string>& V, size_t N, Order O) {
 
   if (O == Order::SingleElement) {
@@ -3,6 +3,9 @@
 #include "test_iterators.h"
 #include "filesystem_include.h"
 
+#include <cstdio>
+#include <string>
+
 static const size_t TestNumInputs = 1024;
 
 
@@ -160,4 +163,57 @@ BENCHMARK_CAPTURE(BM_LexicallyNormal, small_path,
 BENCHMARK_CAPTURE(BM_LexicallyNormal, large_path,
   getRandomPaths, /*PathLen*/32)->RangeMultiplier(2)->Range(2, 256)->Complexity();
 
+// A directory tree with Width subdirectories per level, Depth levels deep,
+// and Width files in every directory. Removed on destruction.
+struct TempTree {
+  fs::path Root;
+
+  TempTree(size_t Width, size_t Depth) {
+    Root = fs::temp_directory_path() /
+           ("libcxx-bench-tree-" + getRandomString(8));
+    create(Root, Width, Depth);
+  }
+  ~TempTree() { fs::remove_all(Root); }
+
+  static void create(const fs::path &Dir, size_t Width, size_t Depth) {
+    fs::create_directories(Dir);
+    for (size_t I = 0; I < Width; ++I) {
+      std::string Name = std::to_string(I);
+      std::FILE *F = std::fopen((Dir / ("file" + Name)).c_str(), "w");
+      if (F)
+        std::fclose(F);
+      if (Depth > 0)
+        create(Dir / ("dir" + Name), Width, Depth - 1);
+    }
+  }
+};
+
+void BM_DirectoryIterate(benchmark::State &st) {
+  TempTree Tree(st.range(0), 0);
+  size_t Count = 0;
+  while (st.KeepRunning()) {
+    for (const fs::directory_entry &E : fs::directory_iterator(Tree.Root))
+      benchmark::DoNotOptimize(&E);
+    Count += st.range(0);
+  }
+  st.SetItemsProcessed(Count);
+}
+BENCHMARK(BM_DirectoryIterate)->Range(64, 4096);
+
+// Recursion needs the type of every entry; is_directory is also the most
+// common query made while walking a tree.
+void BM_RecursiveDirectoryIterate(benchmark::State &st) {
+  TempTree Tree(st.range(0), 3);
+  size_t Count = 0;
+  while (st.KeepRunning()) {
+    for (const fs::directory_entry &E :
+         fs::recursive_directory_iterator(Tree.Root)) {
+      benchmark::DoNotOptimize(E.is_directory());
+      ++Count;
+    }
+  }
+  st.SetItemsProcessed(Count);
+}
+BENCHMARK(BM_RecursiveDirectoryIterate)->Arg(4)->Arg(8)->Arg(16);
+
 BENCHMARK_MAIN();
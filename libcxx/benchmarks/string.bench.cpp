@@ -220,6 +220,57 @@ struct StringMove {
   static std::string name() { return "BM_StringMove" + Length::name(); }
 };
 
+template <class LHLength, class RHLength>
+struct StringAppend {
+  static void run(benchmark::State& state) {
+    std::string LHS = makeString(LHLength());
+    std::string RHS = makeString(RHLength());
+    for (auto _ : state) {
+      benchmark::DoNotOptimize(LHS);
+      benchmark::DoNotOptimize(RHS);
+      std::string S = LHS;
+      S.append(RHS.data(), RHS.size());
+      benchmark::DoNotOptimize(S);
+    }
+  }
+
+  static std::string name() {
+    return "BM_StringAppend" + LHLength::name() + RHLength::name();
+  }
+};
+
+template <class LHLength, class RHLength>
+struct StringConcat {
+  static void run(benchmark::State& state) {
+    std::string LHS = makeString(LHLength());
+    std::string RHS = makeString(RHLength());
+    for (auto _ : state) {
+      benchmark::DoNotOptimize(LHS);
+      benchmark::DoNotOptimize(RHS);
+      benchmark::DoNotOptimize(LHS + RHS);
+    }
+  }
+
+  static std::string name() {
+    return "BM_StringConcat" + LHLength::name() + RHLength::name();
+  }
+};
+
+template <class Length>
+struct StringPushBack {
+  static void run(benchmark::State& state) {
+    const std::string Orig = makeString(Length());
+    for (auto _ : state) {
+      std::string S;
+      for (char C : Orig)
+        S.push_back(C);
+      benchmark::DoNotOptimize(S);
+    }
+  }
+
+  static std::string name() { return "BM_StringPushBack" + Length::name(); }
+};
+
 enum class Relation { Eq, Less, Compare };
 struct AllRelations : EnumValuesAsTuple<AllRelations, Relation, 3> {
   static constexpr const char* Names[] = {"Eq", "Less", "Compare"};
@@ -429,6 +480,9 @@ int main(int argc, char** argv) {
   makeCartesianProductBenchmark<StringCopy, AllLengths>();
   makeCartesianProductBenchmark<StringMove, AllLengths>();
   makeCartesianProductBenchmark<StringDestroy, AllLengths>();
+  makeCartesianProductBenchmark<StringAppend, AllLengths, AllLengths>();
+  makeCartesianProductBenchmark<StringConcat, AllLengths, AllLengths>();
+  makeCartesianProductBenchmark<StringPushBack, AllLengths>();
   makeCartesianProductBenchmark<StringRelational, AllRelations, AllLengths,
                                 AllLengths, AllDiffTypes>();
   makeCartesianProductBenchmark<StringRelationalLiteral, AllRelations,
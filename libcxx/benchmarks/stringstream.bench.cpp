@@ -37,4 +37,24 @@ static void BM_Istream_numbers(benchmark::State &state) {
 }
 
 BENCHMARK(BM_Istream_numbers)->RangeMultiplier(2)->Range(1024, 4096);
+
+static void BM_Ostream_integers(benchmark::State &state) {
+  for (auto _ : state) {
+    std::ostringstream s;
+    for (int i = 0; i < state.range(0); ++i)
+      s << i << ' ' << -i * 7919LL << ' ';
+    benchmark::DoNotOptimize(s.str().size());
+  }
+}
+BENCHMARK(BM_Ostream_integers)->RangeMultiplier(2)->Range(1024, 4096);
+
+static void BM_Ostream_doubles(benchmark::State &state) {
+  for (auto _ : state) {
+    std::ostringstream s;
+    for (int i = 0; i < state.range(0); ++i)
+      s << i * 0.37 << ' ';
+    benchmark::DoNotOptimize(s.str().size());
+  }
+}
+BENCHMARK(BM_Ostream_doubles)->RangeMultiplier(2)->Range(1024, 4096);
 BENCHMARK_MAIN();
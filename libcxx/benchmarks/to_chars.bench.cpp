@@ -0,0 +1,78 @@
+
+#include <charconv>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "test_macros.h"
+
+constexpr std::size_t NUM_VALUES = 1 << 12;
+
+// Finite values with uniformly distributed bit patterns, which exercise the
+// whole exponent range.
+template <class T, class Bits>
+static std::vector<T> makeValues() {
+  std::mt19937_64 gen(42);
+  std::vector<T> values;
+  while (values.size() < NUM_VALUES) {
+    Bits bits = static_cast<Bits>(gen());
+    T value;
+    std::memcpy(&value, &bits, sizeof(value));
+    if (value - value == 0)
+      values.push_back(value);
+  }
+  return values;
+}
+
+template <class T, class Bits>
+static void BM_ToCharsShortest(benchmark::State& state) {
+  std::vector<T> values = makeValues<T, Bits>();
+  char buffer[64];
+  for (auto _ : state)
+    for (T value : values)
+      benchmark::DoNotOptimize(std::to_chars(buffer, buffer + sizeof(buffer), value));
+  state.SetItemsProcessed(state.iterations() * NUM_VALUES);
+}
+BENCHMARK_TEMPLATE(BM_ToCharsShortest, float, std::uint32_t);
+BENCHMARK_TEMPLATE(BM_ToCharsShortest, double, std::uint64_t);
+
+// The closest snprintf equivalent, which needs the maximum precision to round
+// trip and is therefore not the shortest representation.
+static void BM_SnprintfDouble(benchmark::State& state) {
+  std::vector<double> values = makeValues<double, std::uint64_t>();
+  char buffer[64];
+  for (auto _ : state)
+    for (double value : values)
+      benchmark::DoNotOptimize(std::snprintf(buffer, sizeof(buffer), "%.17g", value));
+  state.SetItemsProcessed(state.iterations() * NUM_VALUES);
+}
+BENCHMARK(BM_SnprintfDouble);
+
+static void BM_FromCharsDouble(benchmark::State& state) {
+  std::vector<double> values = makeValues<double, std::uint64_t>();
+  std::vector<char> text;
+  std::vector<std::size_t> ends;
+  for (double value : values) {
+    char buffer[64];
+    char* end = std::to_chars(buffer, buffer + sizeof(buffer), value).ptr;
+    text.insert(text.end(), buffer, end);
+    ends.push_back(text.size());
+  }
+  for (auto _ : state) {
+    std::size_t begin = 0;
+    for (std::size_t end : ends) {
+      double value;
+      benchmark::DoNotOptimize(std::from_chars(text.data() + begin, text.data() + end, value));
+      benchmark::DoNotOptimize(value);
+      begin = end;
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * NUM_VALUES);
+}
+BENCHMARK(BM_FromCharsDouble);
+
+BENCHMARK_MAIN();
@@ -1,4 +1,5 @@
 #include <unordered_set>
+#include <ext/open_hash_set>
 #include <vector>
 #include <functional>
 #include <cstdint>
@@ -304,4 +305,90 @@ BENCHMARK_CAPTURE(BM_EmplaceDuplicate,
     std::unordered_set<std::string>{},
     getRandomCStringInputs)->Arg(TestNumInputs);
 
+//----------------------------------------------------------------------------//
+//                  __gnu_cxx::open_hash_set comparisons
+// ---------------------------------------------------------------------------//
+
+BENCHMARK_CAPTURE(BM_InsertValue,
+    open_hash_set_uint32,
+    __gnu_cxx::open_hash_set<uint32_t>{},
+    getRandomIntegerInputs<uint32_t>)->Arg(TestNumInputs);
+
+BENCHMARK_CAPTURE(BM_InsertValue,
+    open_hash_set_uint32_sorted,
+    __gnu_cxx::open_hash_set<uint32_t>{},
+    getSortedIntegerInputs<uint32_t>)->Arg(TestNumInputs);
+
+BENCHMARK_CAPTURE(BM_InsertValueRehash,
+    open_hash_set_top_bits_uint32,
+    __gnu_cxx::open_hash_set<uint32_t, UInt32Hash>{},
+    getSortedTopBitsIntegerInputs<uint32_t>)->Arg(TestNumInputs);
+
+BENCHMARK_CAPTURE(BM_InsertValue,
+    open_hash_set_string,
+    __gnu_cxx::open_hash_set<std::string>{},
+    getRandomStringInputs)->Arg(TestNumInputs);
+
+BENCHMARK_CAPTURE(BM_InsertValueRehash,
+    open_hash_set_string,
+    __gnu_cxx::open_hash_set<std::string>{},
+    getRandomStringInputs)->Arg(TestNumInputs);
+
+
+BENCHMARK_CAPTURE(BM_Find,
+    open_hash_set_random_uint64,
+    __gnu_cxx::open_hash_set<uint64_t>{},
+    getRandomIntegerInputs<uint64_t>)->Arg(TestNumInputs);
+
+BENCHMARK_CAPTURE(BM_FindRehash,
+    open_hash_set_random_uint64,
+    __gnu_cxx::open_hash_set<uint64_t, UInt64Hash>{},
+    getRandomIntegerInputs<uint64_t>)->Arg(TestNumInputs);
+
+BENCHMARK_CAPTURE(BM_Find,
+    open_hash_set_sorted_uint64,
+    __gnu_cxx::open_hash_set<uint64_t>{},
+    getSortedIntegerInputs<uint64_t>)->Arg(TestNumInputs);
+
+BENCHMARK_CAPTURE(BM_Find,
+    open_hash_set_sorted_large_uint64,
+    __gnu_cxx::open_hash_set<uint64_t>{},
+    getSortedLargeIntegerInputs<uint64_t>)->Arg(TestNumInputs);
+
+BENCHMARK_CAPTURE(BM_Find,
+    open_hash_set_top_bits_uint64,
+    __gnu_cxx::open_hash_set<uint64_t>{},
+    getSortedTopBitsIntegerInputs<uint64_t>)->Arg(TestNumInputs);
+
+BENCHMARK_CAPTURE(BM_Find,
+    open_hash_set_string,
+    __gnu_cxx::open_hash_set<std::string>{},
+    getRandomStringInputs)->Arg(TestNumInputs);
+
+BENCHMARK_CAPTURE(BM_FindRehash,
+    open_hash_set_string,
+    __gnu_cxx::open_hash_set<std::string>{},
+    getRandomStringInputs)->Arg(TestNumInputs);
+
+
+BENCHMARK_CAPTURE(BM_InsertDuplicate,
+    open_hash_set_int,
+    __gnu_cxx::open_hash_set<int>{},
+    getRandomIntegerInputs<int>)->Arg(TestNumInputs);
+
+BENCHMARK_CAPTURE(BM_InsertDuplicate,
+    open_hash_set_string,
+    __gnu_cxx::open_hash_set<std::string>{},
+    getRandomStringInputs)->Arg(TestNumInputs);
+
+BENCHMARK_CAPTURE(BM_EmplaceDuplicate,
+    open_hash_set_int,
+    __gnu_cxx::open_hash_set<int>{},
+    getRandomIntegerInputs<int>)->Arg(TestNumInputs);
+
+BENCHMARK_CAPTURE(BM_EmplaceDuplicate,
+    open_hash_set_string,
+    __gnu_cxx::open_hash_set<std::string>{},
+    getRandomStringInputs)->Arg(TestNumInputs);
+
 BENCHMARK_MAIN();
@@ -7,8 +7,14 @@
 //===----------------------------------------------------------------------===//
 
 #include "charconv"
+#include "limits"
+#include "locale"
+#include "memory"
+#include <errno.h>
 #include <string.h>
 
+#include "include/ryu_tables.h"
+
 _LIBCPP_BEGIN_NAMESPACE_STD
 
 namespace __itoa
@@ -157,4 +163,720 @@ __u64toa(uint64_t value, char* buffer)
 
 }  // namespace __itoa
 
+namespace __ryu
+{
+
+// Shortest round-trip conversion of binary floating-point numbers to decimal,
+// after Ulf Adams' Ryu. The result is the decimal m * 10^e with the fewest
+// digits in the rounding interval of the input, and among those the closest
+// to the input.
+
+struct __decimal64
+{
+    uint64_t __mantissa;
+    int32_t __exponent;
+};
+
+struct __decimal32
+{
+    uint32_t __mantissa;
+    int32_t __exponent;
+};
+
+// ceil(log2(5^e)) for e > 0, and 1 for e == 0; valid for 0 <= e <= 3528.
+inline _LIBCPP_INLINE_VISIBILITY int32_t
+__pow5bits(int32_t e)
+{
+    return static_cast<int32_t>((static_cast<uint32_t>(e) * 1217359) >> 19) + 1;
+}
+
+// floor(log10(2^e)) for 0 <= e <= 1650.
+inline _LIBCPP_INLINE_VISIBILITY uint32_t
+__log10_pow2(int32_t e)
+{
+    return (static_cast<uint32_t>(e) * 78913) >> 18;
+}
+
+// floor(log10(5^e)) for 0 <= e <= 2620.
+inline _LIBCPP_INLINE_VISIBILITY uint32_t
+__log10_pow5(int32_t e)
+{
+    return (static_cast<uint32_t>(e) * 732923) >> 20;
+}
+
+template <typename T>
+inline _LIBCPP_INLINE_VISIBILITY uint32_t
+__pow5_factor(T value)
+{
+    uint32_t count = 0;
+    for (; value % 5 == 0; value /= 5)
+        ++count;
+    return count;
+}
+
+template <typename T>
+inline _LIBCPP_INLINE_VISIBILITY bool
+__multiple_of_pow5(T value, uint32_t p)
+{
+    return __pow5_factor(value) >= p;
+}
+
+template <typename T>
+inline _LIBCPP_INLINE_VISIBILITY bool
+__multiple_of_pow2(T value, uint32_t p)
+{
+    return (value & ((T(1) << p) - 1)) == 0;
+}
+
+// (m * mul) >> j, where mul is a 128-bit {low, high} pair and j >= 64.
+inline _LIBCPP_INLINE_VISIBILITY uint64_t
+__mul_shift64(uint64_t m, const uint64_t* mul, int32_t j)
+{
+#ifndef _LIBCPP_HAS_NO_INT128
+    const __uint128_t b0 = static_cast<__uint128_t>(m) * mul[0];
+    const __uint128_t b2 = static_cast<__uint128_t>(m) * mul[1];
+    return static_cast<uint64_t>(((b0 >> 64) + b2) >> (j - 64));
+#else
+    // Schoolbook multiplication of the 64-bit m by the 128-bit mul, keeping
+    // only the bits above the lowest 64.
+    const uint64_t m_lo = static_cast<uint32_t>(m), m_hi = m >> 32;
+    uint64_t hi = 0, mid = 0;
+    {
+        const uint64_t a_lo = static_cast<uint32_t>(mul[0]), a_hi = mul[0] >> 32;
+        const uint64_t ll = m_lo * a_lo, lh = m_lo * a_hi, hl = m_hi * a_lo, hh = m_hi * a_hi;
+        const uint64_t cross = (ll >> 32) + static_cast<uint32_t>(lh) + static_cast<uint32_t>(hl);
+        mid = hh + (lh >> 32) + (hl >> 32) + (cross >> 32); // high half of m * mul[0]
+    }
+    uint64_t b2_lo, b2_hi;
+    {
+        const uint64_t a_lo = static_cast<uint32_t>(mul[1]), a_hi = mul[1] >> 32;
+        const uint64_t ll = m_lo * a_lo, lh = m_lo * a_hi, hl = m_hi * a_lo, hh = m_hi * a_hi;
+        const uint64_t cross = (ll >> 32) + static_cast<uint32_t>(lh) + static_cast<uint32_t>(hl);
+        b2_lo = (cross << 32) | static_cast<uint32_t>(ll);
+        b2_hi = hh + (lh >> 32) + (hl >> 32) + (cross >> 32);
+    }
+    const uint64_t lo = mid + b2_lo;
+    hi = b2_hi + (lo < mid);
+    const int32_t shift = j - 64;
+    if (shift == 0)
+        return lo;
+    if (shift >= 64)
+        return hi >> (shift - 64);
+    return (hi << (64 - shift)) | (lo >> shift);
+#endif
+}
+
+// (m * factor) >> shift, where factor has at most 64 bits and shift > 32.
+inline _LIBCPP_INLINE_VISIBILITY uint32_t
+__mul_shift32(uint32_t m, uint64_t factor, int32_t shift)
+{
+    const uint64_t bits0 = static_cast<uint64_t>(m) * static_cast<uint32_t>(factor);
+    const uint64_t bits1 = static_cast<uint64_t>(m) * (factor >> 32);
+    return static_cast<uint32_t>(((bits0 >> 32) + bits1) >> (shift - 32));
+}
+
+static __decimal64
+__d2d(uint64_t ieee_mantissa, uint32_t ieee_exponent)
+{
+    constexpr int mantissa_bits = 52;
+    constexpr int bias = 1023;
+
+    int32_t e2;
+    uint64_t m2;
+    if (ieee_exponent == 0)
+    {
+        e2 = 1 - bias - mantissa_bits - 2;
+        m2 = ieee_mantissa;
+    }
+    else
+    {
+        e2 = static_cast<int32_t>(ieee_exponent) - bias - mantissa_bits - 2;
+        m2 = (uint64_t(1) << mantissa_bits) | ieee_mantissa;
+    }
+    const bool accept_bounds = (m2 & 1) == 0;
+
+    // The rounding interval is [mv - 1 - mm_shift, mv + 2] / 4 * 2^e2, with
+    // a narrower lower half at the powers of two.
+    const uint64_t mv = 4 * m2;
+    const uint32_t mm_shift = ieee_mantissa != 0 || ieee_exponent <= 1;
+
+    uint64_t vr, vp, vm;
+    int32_t e10;
+    bool vm_is_trailing_zeros = false;
+    bool vr_is_trailing_zeros = false;
+    if (e2 >= 0)
+    {
+        const uint32_t q = __log10_pow2(e2) - (e2 > 3);
+        e10 = static_cast<int32_t>(q);
+        const int32_t k = __double_pow5_inv_bitcount + __pow5bits(static_cast<int32_t>(q)) - 1;
+        const int32_t i = -e2 + static_cast<int32_t>(q) + k;
+        vr = __mul_shift64(4 * m2, __double_pow5_inv_split[q], i);
+        vp = __mul_shift64(4 * m2 + 2, __double_pow5_inv_split[q], i);
+        vm = __mul_shift64(4 * m2 - 1 - mm_shift, __double_pow5_inv_split[q], i);
+        if (q <= 21)
+        {
+            // Only one of mv, mp and mm can be a multiple of 5, if any.
+            if (mv % 5 == 0)
+                vr_is_trailing_zeros = __multiple_of_pow5(mv, q);
+            else if (accept_bounds)
+                vm_is_trailing_zeros = __multiple_of_pow5(mv - 1 - mm_shift, q);
+            else
+                vp -= __multiple_of_pow5(mv + 2, q);
+        }
+    }
+    else
+    {
+        const uint32_t q = __log10_pow5(-e2) - (-e2 > 1);
+        e10 = static_cast<int32_t>(q) + e2;
+        const int32_t i = -e2 - static_cast<int32_t>(q);
+        const int32_t k = __pow5bits(i) - __double_pow5_bitcount;
+        const int32_t j = static_cast<int32_t>(q) - k;
+        vr = __mul_shift64(4 * m2, __double_pow5_split[i], j);
+        vp = __mul_shift64(4 * m2 + 2, __double_pow5_split[i], j);
+        vm = __mul_shift64(4 * m2 - 1 - mm_shift, __double_pow5_split[i], j);
+        if (q <= 1)
+        {
+            // mv = 4 * m2 always has at least two trailing zero bits.
+            vr_is_trailing_zeros = true;
+            if (accept_bounds)
+                vm_is_trailing_zeros = mm_shift == 1;
+            else
+                --vp;
+        }
+        else if (q < 63)
+        {
+            vr_is_trailing_zeros = __multiple_of_pow2(mv, q);
+        }
+    }
+
+    // Remove the digits that all of [vm, vp] share.
+    int32_t removed = 0;
+    uint8_t last_removed_digit = 0;
+    uint64_t output;
+    if (vm_is_trailing_zeros || vr_is_trailing_zeros)
+    {
+        for (; vp / 10 > vm / 10; ++removed)
+        {
+            vm_is_trailing_zeros &= vm % 10 == 0;
+            vr_is_trailing_zeros &= last_removed_digit == 0;
+            last_removed_digit = static_cast<uint8_t>(vr % 10);
+            vr /= 10;
+            vp /= 10;
+            vm /= 10;
+        }
+        if (vm_is_trailing_zeros)
+        {
+            for (; vm % 10 == 0; ++removed)
+            {
+                vr_is_trailing_zeros &= last_removed_digit == 0;
+                last_removed_digit = static_cast<uint8_t>(vr % 10);
+                vr /= 10;
+                vp /= 10;
+                vm /= 10;
+            }
+        }
+        // Round half to even if the exact value is ...50...0.
+        if (vr_is_trailing_zeros && last_removed_digit == 5 && vr % 2 == 0)
+            last_removed_digit = 4;
+        output = vr + ((vr == vm && (!accept_bounds || !vm_is_trailing_zeros)) ||
+                       last_removed_digit >= 5);
+    }
+    else
+    {
+        // The common case: no exact ties, and vm is not in the interval.
+        bool round_up = false;
+        if (vp / 100 > vm / 100)
+        {
+            round_up = vr % 100 >= 50;
+            vr /= 100;
+            vp /= 100;
+            vm /= 100;
+            removed += 2;
+        }
+        for (; vp / 10 > vm / 10; ++removed)
+        {
+            round_up = vr % 10 >= 5;
+            vr /= 10;
+            vp /= 10;
+            vm /= 10;
+        }
+        output = vr + (vr == vm || round_up);
+    }
+    return {output, e10 + removed};
+}
+
+static __decimal32
+__f2d(uint32_t ieee_mantissa, uint32_t ieee_exponent)
+{
+    constexpr int mantissa_bits = 23;
+    constexpr int bias = 127;
+
+    int32_t e2;
+    uint32_t m2;
+    if (ieee_exponent == 0)
+    {
+        e2 = 1 - bias - mantissa_bits - 2;
+        m2 = ieee_mantissa;
+    }
+    else
+    {
+        e2 = static_cast<int32_t>(ieee_exponent) - bias - mantissa_bits - 2;
+        m2 = (uint32_t(1) << mantissa_bits) | ieee_mantissa;
+    }
+    const bool accept_bounds = (m2 & 1) == 0;
+
+    const uint32_t mv = 4 * m2;
+    const uint32_t mp = 4 * m2 + 2;
+    const uint32_t mm_shift = ieee_mantissa != 0 || ieee_exponent <= 1;
+    const uint32_t mm = 4 * m2 - 1 - mm_shift;
+
+    uint32_t vr, vp, vm;
+    int32_t e10;
+    bool vm_is_trailing_zeros = false;
+    bool vr_is_trailing_zeros = false;
+    uint8_t last_removed_digit = 0;
+    if (e2 >= 0)
+    {
+        const uint32_t q = __log10_pow2(e2);
+        e10 = static_cast<int32_t>(q);
+        const int32_t k = __float_pow5_inv_bitcount + __pow5bits(static_cast<int32_t>(q)) - 1;
+        const int32_t i = -e2 + static_cast<int32_t>(q) + k;
+        vr = __mul_shift32(mv, __float_pow5_inv_split[q], i);
+        vp = __mul_shift32(mp, __float_pow5_inv_split[q], i);
+        vm = __mul_shift32(mm, __float_pow5_inv_split[q], i);
+        if (q != 0 && (vp - 1) / 10 <= vm / 10)
+        {
+            // The loop below removes no digit, but the rounding needs the
+            // first removed one.
+            const int32_t l = __float_pow5_inv_bitcount + __pow5bits(static_cast<int32_t>(q - 1)) - 1;
+            last_removed_digit = static_cast<uint8_t>(
+                __mul_shift32(mv, __float_pow5_inv_split[q - 1],
+                              -e2 + static_cast<int32_t>(q) - 1 + l) % 10);
+        }
+        if (q <= 9)
+        {
+            if (mv % 5 == 0)
+                vr_is_trailing_zeros = __multiple_of_pow5(mv, q);
+            else if (accept_bounds)
+                vm_is_trailing_zeros = __multiple_of_pow5(mm, q);
+            else
+                vp -= __multiple_of_pow5(mp, q);
+        }
+    }
+    else
+    {
+        const uint32_t q = __log10_pow5(-e2);
+        e10 = static_cast<int32_t>(q) + e2;
+        const int32_t i = -e2 - static_cast<int32_t>(q);
+        const int32_t k = __pow5bits(i) - __float_pow5_bitcount;
+        int32_t j = static_cast<int32_t>(q) - k;
+        vr = __mul_shift32(mv, __float_pow5_split[i], j);
+        vp = __mul_shift32(mp, __float_pow5_split[i], j);
+        vm = __mul_shift32(mm, __float_pow5_split[i], j);
+        if (q != 0 && (vp - 1) / 10 <= vm / 10)
+        {
+            j = static_cast<int32_t>(q) - 1 - (__pow5bits(i + 1) - __float_pow5_bitcount);
+            last_removed_digit = static_cast<uint8_t>(
+                __mul_shift32(mv, __float_pow5_split[i + 1], j) % 10);
+        }
+        if (q <= 1)
+        {
+            vr_is_trailing_zeros = true;
+            if (accept_bounds)
+                vm_is_trailing_zeros = mm_shift == 1;
+            else
+                --vp;
+        }
+        else if (q < 31)
+        {
+            vr_is_trailing_zeros = __multiple_of_pow2(mv, q - 1);
+        }
+    }
+
+    int32_t removed = 0;
+    uint32_t output;
+    if (vm_is_trailing_zeros || vr_is_trailing_zeros)
+    {
+        for (; vp / 10 > vm / 10; ++removed)
+        {
+            vm_is_trailing_zeros &= vm % 10 == 0;
+            vr_is_trailing_zeros &= last_removed_digit == 0;
+            last_removed_digit = static_cast<uint8_t>(vr % 10);
+            vr /= 10;
+            vp /= 10;
+            vm /= 10;
+        }
+        if (vm_is_trailing_zeros)
+        {
+            for (; vm % 10 == 0; ++removed)
+            {
+                vr_is_trailing_zeros &= last_removed_digit == 0;
+                last_removed_digit = static_cast<uint8_t>(vr % 10);
+                vr /= 10;
+                vp /= 10;
+                vm /= 10;
+            }
+        }
+        if (vr_is_trailing_zeros && last_removed_digit == 5 && vr % 2 == 0)
+            last_removed_digit = 4;
+        output = vr + ((vr == vm && (!accept_bounds || !vm_is_trailing_zeros)) ||
+                       last_removed_digit >= 5);
+    }
+    else
+    {
+        for (; vp / 10 > vm / 10; ++removed)
+        {
+            last_removed_digit = static_cast<uint8_t>(vr % 10);
+            vr /= 10;
+            vp /= 10;
+            vm /= 10;
+        }
+        output = vr + (vr == vm || last_removed_digit >= 5);
+    }
+    return {output, e10 + removed};
+}
+
+}  // namespace __ryu
+
+namespace
+{
+
+// Writes the decimal __digits * 10^__e10 in the given format, where an empty
+// format selects the shorter of fixed and scientific, preferring fixed.
+to_chars_result
+__format_decimal(char* __first, char* __last, bool __negative, uint64_t __mantissa,
+                 int __e10, chars_format __fmt)
+{
+    char __digits[24];
+    int __n = static_cast<int>(__itoa::__u64toa(__mantissa, __digits) - __digits);
+    while (__n > 1 && __digits[__n - 1] == '0')
+    {
+        --__n;
+        ++__e10;
+    }
+    if (__mantissa == 0)
+        __e10 = 0;
+    // The exponent of the scientific form d.ddd * 10^__x.
+    const int __x = __n - 1 + __e10;
+
+    const ptrdiff_t __sci_len = __n + (__n > 1) + 2 + (__x <= -100 || __x >= 100 ? 3 : 2);
+    ptrdiff_t __fixed_len;
+    if (__e10 >= 0)
+        __fixed_len = __n + __e10;
+    else if (__x >= 0)
+        __fixed_len = __n + 1;
+    else
+        __fixed_len = 2 + (-__x - 1) + __n;
+
+    bool __fixed;
+    if (__fmt == chars_format{})
+        __fixed = __fixed_len <= __sci_len;
+    else if (__fmt == chars_format::general)
+        __fixed = -4 <= __x && __x < 6;
+    else
+        __fixed = __fmt == chars_format::fixed;
+
+    const ptrdiff_t __len = __negative + (__fixed ? __fixed_len : __sci_len);
+    if (__last - __first < __len)
+        return {__last, errc::value_too_large};
+
+    char* __p = __first;
+    if (__negative)
+        *__p++ = '-';
+    if (__fixed)
+    {
+        if (__e10 >= 0)
+        {
+            memcpy(__p, __digits, __n);
+            memset(__p + __n, '0', __e10);
+        }
+        else if (__x >= 0)
+        {
+            memcpy(__p, __digits, __x + 1);
+            __p[__x + 1] = '.';
+            memcpy(__p + __x + 2, __digits + __x + 1, __n - __x - 1);
+        }
+        else
+        {
+            __p[0] = '0';
+            __p[1] = '.';
+            memset(__p + 2, '0', -__x - 1);
+            memcpy(__p + 2 + (-__x - 1), __digits, __n);
+        }
+    }
+    else
+    {
+        char* __q = __p;
+        *__q++ = __digits[0];
+        if (__n > 1)
+        {
+            *__q++ = '.';
+            memcpy(__q, __digits + 1, __n - 1);
+            __q += __n - 1;
+        }
+        *__q++ = 'e';
+        *__q++ = __x < 0 ? '-' : '+';
+        unsigned __ax = __x < 0 ? -__x : __x;
+        if (__ax >= 100)
+        {
+            *__q++ = static_cast<char>('0' + __ax / 100);
+            __ax %= 100;
+        }
+        *__q++ = static_cast<char>('0' + __ax / 10);
+        *__q++ = static_cast<char>('0' + __ax % 10);
+    }
+    return {__first + __len, errc{}};
+}
+
+// Writes the value in the style of printf's %a, without the "0x" prefix and
+// with the fewest hexadecimal digits.
+to_chars_result
+__format_hex(char* __first, char* __last, bool __negative, uint64_t __fraction,
+             int __fraction_bits, uint32_t __biased_exponent, int __bias)
+{
+    // Align the fraction to whole hexadecimal digits.
+    const int __pad = (4 - __fraction_bits % 4) % 4;
+    __fraction <<= __pad;
+    int __ndigits = (__fraction_bits + __pad) / 4;
+    while (__ndigits > 0 && (__fraction & 0xF) == 0)
+    {
+        __fraction >>= 4;
+        --__ndigits;
+    }
+    int __exponent;
+    char __lead;
+    if (__biased_exponent != 0)
+    {
+        __lead = '1';
+        __exponent = static_cast<int>(__biased_exponent) - __bias;
+    }
+    else
+    {
+        __lead = '0';
+        __exponent = __fraction == 0 ? 0 : 1 - __bias;
+    }
+    char __exp_buf[8];
+    const unsigned __aexp = __exponent < 0 ? -__exponent : __exponent;
+    const int __exp_len = static_cast<int>(__itoa::__u32toa(__aexp, __exp_buf) - __exp_buf);
+
+    const ptrdiff_t __len = __negative + 1 + (__ndigits > 0 ? 1 + __ndigits : 0) + 2 + __exp_len;
+    if (__last - __first < __len)
+        return {__last, errc::value_too_large};
+
+    char* __p = __first;
+    if (__negative)
+        *__p++ = '-';
+    *__p++ = __lead;
+    if (__ndigits > 0)
+    {
+        *__p++ = '.';
+        for (int __i = __ndigits - 1; __i >= 0; --__i)
+            *__p++ = "0123456789abcdef"[(__fraction >> (4 * __i)) & 0xF];
+    }
+    *__p++ = 'p';
+    *__p++ = __exponent < 0 ? '-' : '+';
+    memcpy(__p, __exp_buf, __exp_len);
+    return {__first + __len, errc{}};
+}
+
+to_chars_result
+__format_special(char* __first, char* __last, bool __negative, bool __is_nan)
+{
+    const ptrdiff_t __len = __negative + 3;
+    if (__last - __first < __len)
+        return {__last, errc::value_too_large};
+    char* __p = __first;
+    if (__negative)
+        *__p++ = '-';
+    memcpy(__p, __is_nan ? "nan" : "inf", 3);
+    return {__first + __len, errc{}};
+}
+
+to_chars_result
+__to_chars_double(char* __first, char* __last, double __value, chars_format __fmt)
+{
+    uint64_t __bits;
+    memcpy(&__bits, &__value, sizeof(__bits));
+    const bool __negative = (__bits >> 63) != 0;
+    const uint64_t __mantissa = __bits & ((uint64_t(1) << 52) - 1);
+    const uint32_t __exponent = static_cast<uint32_t>((__bits >> 52) & 0x7FF);
+    if (__exponent == 0x7FF)
+        return __format_special(__first, __last, __negative, __mantissa != 0);
+    if (__fmt == chars_format::hex)
+        return __format_hex(__first, __last, __negative, __mantissa, 52, __exponent, 1023);
+    if (__exponent == 0 && __mantissa == 0)
+        return __format_decimal(__first, __last, __negative, 0, 0, __fmt);
+    const __ryu::__decimal64 __d = __ryu::__d2d(__mantissa, __exponent);
+    return __format_decimal(__first, __last, __negative, __d.__mantissa, __d.__exponent, __fmt);
+}
+
+to_chars_result
+__to_chars_float(char* __first, char* __last, float __value, chars_format __fmt)
+{
+    uint32_t __bits;
+    memcpy(&__bits, &__value, sizeof(__bits));
+    const bool __negative = (__bits >> 31) != 0;
+    const uint32_t __mantissa = __bits & ((uint32_t(1) << 23) - 1);
+    const uint32_t __exponent = (__bits >> 23) & 0xFF;
+    if (__exponent == 0xFF)
+        return __format_special(__first, __last, __negative, __mantissa != 0);
+    if (__fmt == chars_format::hex)
+        return __format_hex(__first, __last, __negative, __mantissa, 23, __exponent, 127);
+    if (__exponent == 0 && __mantissa == 0)
+        return __format_decimal(__first, __last, __negative, 0, 0, __fmt);
+    const __ryu::__decimal32 __d = __ryu::__f2d(__mantissa, __exponent);
+    return __format_decimal(__first, __last, __negative, __d.__mantissa, __d.__exponent, __fmt);
+}
+
+inline bool
+__is_digit(char __c, bool __hex)
+{
+    if ('0' <= __c && __c <= '9')
+        return true;
+    return __hex && (('a' <= __c && __c <= 'f') || ('A' <= __c && __c <= 'F'));
+}
+
+inline bool
+__starts_with_nocase(const char* __first, const char* __last, const char* __word)
+{
+    for (; *__word; ++__word, ++__first)
+        if (__first == __last || (*__first | 0x20) != *__word)
+            return false;
+    return true;
+}
+
+// Matches the subject sequence of from_chars and hands it to strtod in the
+// "C" locale, which rounds correctly.
+template <class _Tp>
+from_chars_result
+__from_chars_floating_point(const char* __first, const char* __last, _Tp& __value,
+                            chars_format __fmt)
+{
+    const char* __p = __first;
+    const bool __negative = __p != __last && *__p == '-';
+    if (__negative)
+        ++__p;
+
+    if (__starts_with_nocase(__p, __last, "inf"))
+    {
+        __p += 3;
+        if (__starts_with_nocase(__p, __last, "inity"))
+            __p += 5;
+        __value = __negative ? -numeric_limits<_Tp>::infinity() : numeric_limits<_Tp>::infinity();
+        return {__p, errc{}};
+    }
+    if (__starts_with_nocase(__p, __last, "nan"))
+    {
+        __p += 3;
+        if (__p != __last && *__p == '(')
+        {
+            const char* __q = __p + 1;
+            while (__q != __last && (isalnum(static_cast<unsigned char>(*__q)) || *__q == '_'))
+                ++__q;
+            if (__q != __last && *__q == ')')
+                __p = __q + 1;
+        }
+        __value = __negative ? -numeric_limits<_Tp>::quiet_NaN() : numeric_limits<_Tp>::quiet_NaN();
+        return {__p, errc{}};
+    }
+
+    const bool __hex = __fmt == chars_format::hex;
+    const char* __digits = __p;
+    ptrdiff_t __ndigits = 0;
+    for (; __p != __last && __is_digit(*__p, __hex); ++__p)
+        ++__ndigits;
+    if (__p != __last && *__p == '.')
+        for (++__p; __p != __last && __is_digit(*__p, __hex); ++__p)
+            ++__ndigits;
+    if (__ndigits == 0)
+        return {__first, errc::invalid_argument};
+
+    if (__fmt != chars_format::fixed && __p != __last && (*__p | 0x20) == (__hex ? 'p' : 'e'))
+    {
+        const char* __q = __p + 1;
+        if (__q != __last && (*__q == '+' || *__q == '-'))
+            ++__q;
+        if (__q != __last && __is_digit(*__q, false))
+        {
+            while (__q != __last && __is_digit(*__q, false))
+                ++__q;
+            __p = __q;
+        }
+        else if (__fmt == chars_format::scientific)
+            return {__first, errc::invalid_argument};
+    }
+    else if (__fmt == chars_format::scientific)
+        return {__first, errc::invalid_argument};
+
+    // strtod needs a NUL-terminated copy, with the prefix of hexadecimal
+    // floating-point and without a sign, which was matched above.
+    const ptrdiff_t __len = __p - __digits;
+    char __small[128];
+    unique_ptr<char[]> __large;
+    char* __buf = __small;
+    if (__len + 3 > static_cast<ptrdiff_t>(sizeof(__small)))
+    {
+        __large.reset(new char[__len + 3]);
+        __buf = __large.get();
+    }
+    char* __b = __buf;
+    if (__hex)
+    {
+        *__b++ = '0';
+        *__b++ = 'x';
+    }
+    memcpy(__b, __digits, __len);
+    __b[__len] = '\0';
+
+    const int __saved_errno = errno;
+    errno = 0;
+    char* __end;
+    _Tp __result = __do_strtod<_Tp>(__buf, &__end);
+    const bool __out_of_range = errno == ERANGE &&
+        (__result == 0 || __result == numeric_limits<_Tp>::infinity());
+    errno = __saved_errno;
+    if (__out_of_range)
+        return {__p, errc::result_out_of_range};
+    __value = __negative ? -__result : __result;
+    return {__p, errc{}};
+}
+
+}  // namespace
+
+to_chars_result
+to_chars(char* __first, char* __last, float __value)
+{
+    return __to_chars_float(__first, __last, __value, chars_format{});
+}
+
+to_chars_result
+to_chars(char* __first, char* __last, double __value)
+{
+    return __to_chars_double(__first, __last, __value, chars_format{});
+}
+
+to_chars_result
+to_chars(char* __first, char* __last, float __value, chars_format __fmt)
+{
+    return __to_chars_float(__first, __last, __value, __fmt);
+}
+
+to_chars_result
+to_chars(char* __first, char* __last, double __value, chars_format __fmt)
+{
+    return __to_chars_double(__first, __last, __value, __fmt);
+}
+
+from_chars_result
+from_chars(const char* __first, const char* __last, float& __value, chars_format __fmt)
+{
+    return __from_chars_floating_point(__first, __last, __value, __fmt);
+}
+
+from_chars_result
+from_chars(const char* __first, const char* __last, double& __value, chars_format __fmt)
+{
+    return __from_chars_floating_point(__first, __last, __value, __fmt);
+}
+
 _LIBCPP_END_NAMESPACE_STD
@@ -13,6 +13,9 @@
 #include <windows.h>
 #else
 #include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
 #endif
 #include <errno.h>
 
@@ -58,6 +61,24 @@ static file_type get_file_type(DirEntT* ent, long) {
   return file_type::none;
 }
 
+static file_type get_file_type(mode_t mode) {
+  if (S_ISLNK(mode))
+    return file_type::symlink;
+  if (S_ISREG(mode))
+    return file_type::regular;
+  if (S_ISDIR(mode))
+    return file_type::directory;
+  if (S_ISBLK(mode))
+    return file_type::block;
+  if (S_ISCHR(mode))
+    return file_type::character;
+  if (S_ISFIFO(mode))
+    return file_type::fifo;
+  if (S_ISSOCK(mode))
+    return file_type::socket;
+  return file_type::unknown;
+}
+
 static pair<string_view, file_type> posix_readdir(DIR* dir_stream,
                                                   error_code& ec) {
   struct dirent* dir_entry_ptr = nullptr;
@@ -127,8 +148,15 @@ public:
     close();
   }
 
+  __dir_stream(__dir_stream& parent, directory_options opts, error_code& ec)
+      : __dir_stream(parent.__entry_.path(), opts, ec) {}
+
   bool good() const noexcept { return __stream_ != INVALID_HANDLE_VALUE; }
 
+  file_type __entry_sym_type(error_code& ec) {
+    return __entry_.__get_sym_ft(&ec);
+  }
+
   bool advance(error_code& ec) {
     while (::FindNextFile(__stream_, &__data_)) {
       if (!strcmp(__data_.cFileName, ".") || strcmp(__data_.cFileName, ".."))
@@ -171,6 +199,7 @@ public:
   __dir_stream& operator=(const __dir_stream&) = delete;
 
   __dir_stream(__dir_stream&& other) noexcept : __stream_(other.__stream_),
+                                                __name_(other.__name_),
                                                 __root_(move(other.__root_)),
                                                 __entry_(move(other.__entry_)) {
     other.__stream_ = nullptr;
@@ -180,10 +209,23 @@ public:
       : __stream_(nullptr), __root_(root) {
     if ((__stream_ = ::opendir(root.c_str())) == nullptr) {
       ec = detail::capture_errno();
-      const bool allow_eacess =
-          bool(opts & directory_options::skip_permission_denied);
-      if (allow_eacess && ec.value() == EACCES)
-        ec.clear();
+      ignore_permission_denied(opts, ec);
+      return;
+    }
+    advance(ec);
+  }
+
+  // Opens the directory named by the current entry of parent relative to
+  // parent's descriptor, rather than resolving its full path again.
+  __dir_stream(__dir_stream& parent, directory_options opts, error_code& ec)
+      : __stream_(nullptr), __root_(parent.__entry_.path()) {
+    int fd = ::openat(::dirfd(parent.__stream_), parent.__name_,
+                      O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd == -1 || (__stream_ = ::fdopendir(fd)) == nullptr) {
+      ec = detail::capture_errno();
+      if (fd != -1)
+        ::close(fd);
+      ignore_permission_denied(opts, ec);
       return;
     }
     advance(ec);
@@ -206,15 +248,48 @@ public:
         close();
         return false;
       } else {
-        __entry_.__assign_iter_entry(
-            __root_ / str,
-            directory_entry::__create_iter_result(str_type_pair.second));
+        __name_ = str.data();
+        // Every entry shares the root, so reuse the previous entry's path
+        // and its allocation, replacing only the filename.
+        if (__entry_.__p_.empty())
+          __entry_.__p_ = __root_ / str;
+        else
+          __entry_.__p_.remove_filename() /= str;
+        __entry_.__data_ =
+            directory_entry::__create_iter_result(str_type_pair.second);
         return true;
       }
     }
   }
 
+  // The type of the current entry, without following symlinks. If readdir
+  // did not report it, stat the entry relative to the directory and cache the
+  // result in the entry.
+  file_type __entry_sym_type(error_code& ec) {
+    if (__entry_.__data_.__cache_type_ != directory_entry::_Empty)
+      return __entry_.__get_sym_ft(&ec);
+    struct ::stat st;
+    if (::fstatat(::dirfd(__stream_), __name_, &st, AT_SYMLINK_NOFOLLOW) == -1) {
+      ec = detail::capture_errno();
+      if (ec.value() == ENOENT || ec.value() == ENOTDIR)
+        return file_type::not_found;
+      return file_type::none;
+    }
+    ec.clear();
+    file_type ft = detail::get_file_type(st.st_mode);
+    __entry_.__data_ = directory_entry::__create_iter_result(ft);
+    return ft;
+  }
+
 private:
+  static void ignore_permission_denied(directory_options opts,
+                                       error_code& ec) {
+    const bool allow_eacess =
+        bool(opts & directory_options::skip_permission_denied);
+    if (allow_eacess && ec.value() == EACCES)
+      ec.clear();
+  }
+
   error_code close() noexcept {
     error_code m_ec;
     if (::closedir(__stream_) == -1)
@@ -224,6 +299,8 @@ private:
   }
 
   DIR* __stream_{nullptr};
+  // The name of the current entry, valid until the next call to readdir.
+  const char* __name_{nullptr};
 
 public:
   path __root_;
@@ -360,7 +437,7 @@ bool recursive_directory_iterator::__try_recursion(error_code* ec) {
   bool skip_rec = false;
   error_code m_ec;
   if (!rec_sym) {
-    file_status st(curr_it.__entry_.__get_sym_ft(&m_ec));
+    file_status st(curr_it.__entry_sym_type(m_ec));
     if (m_ec && status_known(st))
       m_ec.clear();
     if (m_ec || is_symlink(st) || !is_directory(st))
@@ -374,7 +451,7 @@ bool recursive_directory_iterator::__try_recursion(error_code* ec) {
   }
 
   if (!skip_rec) {
-    __dir_stream new_it(curr_it.__entry_.path(), __imp_->__options_, m_ec);
+    __dir_stream new_it(curr_it, __imp_->__options_, m_ec);
     if (new_it.good()) {
       __imp_->__stack_.push(move(new_it));
       return true;
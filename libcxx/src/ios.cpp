@@ -151,6 +151,13 @@ ios_base::getloc() const
     return loc_storage;
 }
 
+bool
+ios_base::__has_classic_locale() const
+{
+    const locale& loc_storage = *reinterpret_cast<const locale*>(&__loc_);
+    return loc_storage == locale::classic();
+}
+
 // xalloc
 #if defined(_LIBCPP_HAS_C_ATOMIC_IMP) && !defined(_LIBCPP_HAS_NO_THREADS)
 atomic<int> ios_base::__xindex_ = ATOMIC_VAR_INIT(0);
@@ -0,0 +1,106 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+// UNSUPPORTED: c++98, c++03
+
+// <ext/open_hash_map>
+
+#include <ext/open_hash_map>
+#include <cassert>
+#include <memory>
+
+#include "test_macros.h"
+#include "count_new.h"
+
+void test_default_does_not_allocate() {
+  DisableAllocationGuard g;
+  ((void)g);
+  __gnu_cxx::open_hash_map<int, int> h;
+  assert(h.bucket_count() == 0);
+  assert(h.begin() == h.end());
+  assert(h.find(1) == h.end());
+}
+
+// Compares against a plain array through a sequence of insertions and
+// erasures, so that both the table's growth and its deleted slots get used.
+void test_against_array() {
+  const int N = 512;
+  int ref[N];
+  for (int i = 0; i < N; ++i)
+    ref[i] = -1;
+  std::size_t size = 0;
+  __gnu_cxx::open_hash_map<int, std::unique_ptr<int> > h;
+  unsigned x = 1;
+  for (int it = 0; it < 20000; ++it) {
+    x = x * 1103515245 + 12345;
+    int k = (x >> 8) % N;
+    if ((x >> 4) % 3 == 0) {
+      assert(h.erase(k) == (ref[k] != -1 ? 1u : 0u));
+      if (ref[k] != -1)
+        --size;
+      ref[k] = -1;
+    } else {
+      bool inserted = h.try_emplace(k, std::unique_ptr<int>(new int(it))).second;
+      assert(inserted == (ref[k] == -1));
+      if (inserted) {
+        ref[k] = it;
+        ++size;
+      }
+    }
+    assert(h.size() == size);
+    assert(h.load_factor() <= h.max_load_factor());
+  }
+  std::size_t n = 0;
+  for (auto& p : h) {
+    assert(*p.second == ref[p.first]);
+    ++n;
+  }
+  assert(n == size);
+  for (int k = 0; k < N; ++k)
+    assert(h.count(k) == (ref[k] != -1 ? 1u : 0u));
+}
+
+// Erasure must not move the other elements.
+void test_erase_keeps_references() {
+  __gnu_cxx::open_hash_map<int, int> h;
+  h.reserve(100);
+  for (int i = 0; i < 100; ++i)
+    h[i] = i;
+  int* p = &h[42];
+  for (int i = 0; i < 100; i += 2)
+    h.erase(i + 1);
+  assert(p == &h[42] && *p == 42);
+  auto it = h.begin();
+  while (it != h.end())
+    it = it->first % 4 == 0 ? h.erase(it) : std::next(it);
+  assert(h.size() == 25);
+}
+
+void test_copy_move_swap() {
+  __gnu_cxx::open_hash_map<int, int> h = {{1, 10}, {2, 20}, {3, 30}};
+  __gnu_cxx::open_hash_map<int, int> c = h;
+  assert(c == h);
+  c[4] = 40;
+  assert(c != h);
+  __gnu_cxx::open_hash_map<int, int> m = std::move(c);
+  assert(m.size() == 4 && c.empty());
+  swap(m, h);
+  assert(m.size() == 3 && h.size() == 4 && h.at(4) == 40);
+  assert(m.insert_or_assign(1, 11).second == false && m[1] == 11);
+  h.clear();
+  assert(h.empty() && h.begin() == h.end());
+}
+
+int main(int, char**) {
+  test_default_does_not_allocate();
+  test_against_array();
+  test_erase_keeps_references();
+  test_copy_move_swap();
+
+  return 0;
+}
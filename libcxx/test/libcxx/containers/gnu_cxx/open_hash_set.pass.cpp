@@ -0,0 +1,57 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+// UNSUPPORTED: c++98, c++03
+
+// <ext/open_hash_set>
+
+#include <ext/open_hash_set>
+#include <cassert>
+
+#include "test_macros.h"
+#include "count_new.h"
+
+void test_default_does_not_allocate() {
+  DisableAllocationGuard g;
+  ((void)g);
+  __gnu_cxx::open_hash_set<int> h;
+  assert(h.bucket_count() == 0);
+  assert(h.begin() == h.end());
+}
+
+void test_basic() {
+  __gnu_cxx::open_hash_set<int> h = {1, 2, 3};
+  assert(h.size() == 3);
+  assert(h.insert(2).second == false);
+  assert(h.insert(4).second == true);
+  assert(h.erase(1) == 1 && h.erase(1) == 0);
+  assert(h.count(2) == 1 && h.count(1) == 0);
+  assert(h.equal_range(3).first != h.end());
+
+  // Identity hashes of multiples of a power of two must still spread.
+  for (int i = 0; i < 1000; ++i)
+    h.insert(i << 12);
+  assert(h.size() == 1003);
+  for (int i = 0; i < 1000; ++i)
+    assert(h.find(i << 12) != h.end());
+
+  h.rehash(0);
+  assert(h.size() == 1003);
+  h.max_load_factor(0.5f);
+  h.rehash(0);
+  assert(h.load_factor() <= 0.5f);
+  h.erase(h.begin(), h.end());
+  assert(h.empty());
+}
+
+int main(int, char**) {
+  test_default_does_not_allocate();
+  test_basic();
+
+  return 0;
+}
@@ -168,6 +168,8 @@
 // extended headers
 #include <ext/hash_map>
 #include <ext/hash_set>
+#include <ext/open_hash_map>
+#include <ext/open_hash_set>
 
 #if defined(WITH_MAIN)
 int main(int, char**) { return 0; }
@@ -281,3 +281,7 @@ TEST_MACROS();
 TEST_MACROS();
 #include <ext/hash_set>
 TEST_MACROS();
+#include <ext/open_hash_map>
+TEST_MACROS();
+#include <ext/open_hash_set>
+TEST_MACROS();
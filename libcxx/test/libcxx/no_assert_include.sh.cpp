@@ -165,6 +165,8 @@
 // extended headers
 #include <ext/hash_map>
 #include <ext/hash_set>
+#include <ext/open_hash_map>
+#include <ext/open_hash_set>
 
 #ifdef assert
 #error "Do not include cassert or assert.h in standard header files"
@@ -0,0 +1,52 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+// UNSUPPORTED: c++98, c++03, c++11, c++14, c++17
+
+// <string>
+
+// template <class Operation>
+// void resize_and_overwrite(size_type n, Operation op); // extension (P1072)
+
+#include <string>
+#include <cassert>
+
+#include "test_macros.h"
+
+template <class S>
+void test(S s, typename S::size_type n, typename S::size_type r) {
+  const S orig = s;
+  s.resize_and_overwrite(n, [&](typename S::value_type* p, typename S::size_type sz) {
+    assert(sz == n);
+    // The existing characters are kept.
+    for (typename S::size_type i = 0; i < orig.size() && i < n; ++i)
+      assert(p[i] == orig[i]);
+    for (typename S::size_type i = orig.size(); i < r; ++i)
+      p[i] = 'x';
+    return r;
+  });
+  assert(s.size() == r);
+  assert(s.data()[r] == '\0');
+  for (typename S::size_type i = 0; i < r; ++i)
+    assert(s[i] == (i < orig.size() ? orig[i] : 'x'));
+}
+
+int main(int, char**) {
+  typedef std::string S;
+  test(S(), 0, 0);
+  test(S(), 5, 5);
+  test(S(), 5, 2);
+  test(S("abc"), 10, 10);
+  test(S("abcdefghij"), 5, 3);
+  test(S("abc"), 100, 100);
+  test(S("abc"), 100, 1);
+  test(S(200, 'a'), 300, 250);
+  test(S(200, 'a'), 10, 10);
+
+  return 0;
+}
@@ -0,0 +1,113 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+// UNSUPPORTED: c++98, c++03
+// UNSUPPORTED: !libc++ && c++11
+// UNSUPPORTED: !libc++ && c++14
+
+// XFAIL: with_system_cxx_lib=macosx10.14
+// XFAIL: with_system_cxx_lib=macosx10.13
+// XFAIL: with_system_cxx_lib=macosx10.12
+// XFAIL: with_system_cxx_lib=macosx10.11
+// XFAIL: with_system_cxx_lib=macosx10.10
+// XFAIL: with_system_cxx_lib=macosx10.9
+// XFAIL: with_system_cxx_lib=macosx10.8
+// XFAIL: with_system_cxx_lib=macosx10.7
+
+// <charconv>
+
+// from_chars_result from_chars(const char* first, const char* last,
+//                              float& value,
+//                              chars_format fmt = chars_format::general);
+// from_chars_result from_chars(const char* first, const char* last,
+//                              double& value,
+//                              chars_format fmt = chars_format::general);
+
+#include <charconv>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+#include "test_macros.h"
+
+template <typename T>
+void test(const char* s, std::chars_format fmt, T expected, size_t consumed)
+{
+    T value = 42;
+    std::from_chars_result r = std::from_chars(s, s + std::strlen(s), value, fmt);
+    assert(r.ec == std::errc{});
+    assert(r.ptr == s + consumed);
+    assert(value == expected);
+}
+
+template <typename T>
+void test_error(const char* s, std::chars_format fmt, std::errc ec, size_t consumed)
+{
+    T value = 42;
+    std::from_chars_result r = std::from_chars(s, s + std::strlen(s), value, fmt);
+    assert(r.ec == ec);
+    assert(r.ptr == s + consumed);
+    assert(value == 42);
+}
+
+template <typename T>
+void test_all()
+{
+    const std::chars_format general = std::chars_format::general;
+    const std::chars_format scientific = std::chars_format::scientific;
+    const std::chars_format fixed = std::chars_format::fixed;
+    const std::chars_format hex = std::chars_format::hex;
+
+    test<T>("1", general, 1, 1);
+    test<T>("-1.5", general, -1.5, 4);
+    test<T>(".5", general, 0.5, 2);
+    test<T>("5.", general, 5, 2);
+    test<T>("1.25e2x", general, 125, 6);
+    test<T>("1.5e", general, 1.5, 3);
+    test<T>("1.5e+", general, 1.5, 3);
+    test<T>("1e2", fixed, 1, 1);
+    test<T>("1e2", scientific, 100, 3);
+    test<T>("1p3", hex, 8, 3);
+    test<T>("-a.8p-1", hex, -5.25, 7);
+    test<T>("0x1p3", hex, 0, 1);
+    test<T>("inf", general, std::numeric_limits<T>::infinity(), 3);
+    test<T>("-INFINITY", general, -std::numeric_limits<T>::infinity(), 9);
+    test<T>("infinit", general, std::numeric_limits<T>::infinity(), 3);
+
+    T value = 0;
+    const char* nan = "nan(abc_1)x";
+    std::from_chars_result r = std::from_chars(nan, nan + std::strlen(nan), value);
+    assert(r.ec == std::errc{});
+    assert(r.ptr == nan + 10);
+    assert(std::isnan(value));
+
+    test_error<T>("", general, std::errc::invalid_argument, 0);
+    test_error<T>("+1", general, std::errc::invalid_argument, 0);
+    test_error<T>(" 1", general, std::errc::invalid_argument, 0);
+    test_error<T>("-", general, std::errc::invalid_argument, 0);
+    test_error<T>(".e1", general, std::errc::invalid_argument, 0);
+    test_error<T>("1.5", scientific, std::errc::invalid_argument, 0);
+    test_error<T>("1e400000", general, std::errc::result_out_of_range, 8);
+    test_error<T>("-1e-400000", general, std::errc::result_out_of_range, 10);
+}
+
+int main(int, char**)
+{
+    test_all<float>();
+    test_all<double>();
+
+    test<double>("2.2250738585072011e-308", std::chars_format::general,
+                 2.2250738585072011e-308, 23);
+    test<double>("4.9406564584124654e-324", std::chars_format::general,
+                 4.9406564584124654e-324, 23);
+    test<float>("1.00000005960464477550", std::chars_format::general,
+                1.0000001f, 22);
+
+    return 0;
+}
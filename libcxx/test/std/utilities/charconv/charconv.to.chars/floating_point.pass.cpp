@@ -0,0 +1,143 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+// UNSUPPORTED: c++98, c++03
+// UNSUPPORTED: !libc++ && c++11
+// UNSUPPORTED: !libc++ && c++14
+
+// XFAIL: with_system_cxx_lib=macosx10.14
+// XFAIL: with_system_cxx_lib=macosx10.13
+// XFAIL: with_system_cxx_lib=macosx10.12
+// XFAIL: with_system_cxx_lib=macosx10.11
+// XFAIL: with_system_cxx_lib=macosx10.10
+// XFAIL: with_system_cxx_lib=macosx10.9
+// XFAIL: with_system_cxx_lib=macosx10.8
+// XFAIL: with_system_cxx_lib=macosx10.7
+
+// <charconv>
+
+// to_chars_result to_chars(char* first, char* last, float value);
+// to_chars_result to_chars(char* first, char* last, double value);
+// to_chars_result to_chars(char* first, char* last, float value,
+//                          chars_format fmt);
+// to_chars_result to_chars(char* first, char* last, double value,
+//                          chars_format fmt);
+
+#include <charconv>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+#include "test_macros.h"
+
+template <typename T>
+void test(T value, const char* expected)
+{
+    char buf[400];
+    std::to_chars_result r = std::to_chars(buf, buf + sizeof(buf), value);
+    assert(r.ec == std::errc{});
+    assert(static_cast<size_t>(r.ptr - buf) == std::strlen(expected));
+    assert(std::memcmp(buf, expected, r.ptr - buf) == 0);
+
+    // Too small a buffer fails.
+    r = std::to_chars(buf, buf + std::strlen(expected) - 1, value);
+    assert(r.ec == std::errc::value_too_large);
+    assert(r.ptr == buf + std::strlen(expected) - 1);
+}
+
+template <typename T>
+void test(T value, std::chars_format fmt, const char* expected)
+{
+    char buf[400];
+    std::to_chars_result r = std::to_chars(buf, buf + sizeof(buf), value, fmt);
+    assert(r.ec == std::errc{});
+    assert(static_cast<size_t>(r.ptr - buf) == std::strlen(expected));
+    assert(std::memcmp(buf, expected, r.ptr - buf) == 0);
+}
+
+template <typename T>
+void test_round_trip(T value)
+{
+    const std::chars_format formats[] = {
+        std::chars_format::scientific, std::chars_format::fixed,
+        std::chars_format::general, std::chars_format::hex};
+    for (std::chars_format fmt : formats)
+    {
+        char buf[400];
+        std::to_chars_result r = std::to_chars(buf, buf + sizeof(buf), value, fmt);
+        assert(r.ec == std::errc{});
+        T parsed = 0;
+        std::from_chars_result p = std::from_chars(buf, r.ptr, parsed, fmt);
+        assert(p.ec == std::errc{});
+        assert(p.ptr == r.ptr);
+        assert(parsed == value);
+    }
+}
+
+int main(int, char**)
+{
+    test(0.0, "0");
+    test(-0.0, "-0");
+    test(1.0, "1");
+    test(0.1, "0.1");
+    test(0.3, "0.3");
+    test(123.456, "123.456");
+    test(1e21, "1e+21");
+    test(1e22, "1e+22");
+    test(1e23, "1e+23");
+    test(123456789.0, "123456789");
+    test(1e-5, "1e-05");
+    test(0.001, "0.001");
+    test(9007199254740993.0, "9007199254740992");
+    test(5e-324, "5e-324");
+    test(1.7976931348623157e308, "1.7976931348623157e+308");
+    test(std::numeric_limits<double>::infinity(), "inf");
+    test(-std::numeric_limits<double>::infinity(), "-inf");
+
+    test(0.1f, "0.1");
+    test(1.5474251e+26f, "1.5474251e+26");
+    test(16777216.f, "16777216");
+    test(3.4028235e38f, "3.4028235e+38");
+    test(1e-45f, "1e-45");
+
+    test(1.0, std::chars_format::scientific, "1e+00");
+    test(123.456, std::chars_format::scientific, "1.23456e+02");
+    test(1e-300, std::chars_format::scientific, "1e-300");
+    test(1e21, std::chars_format::fixed, "1000000000000000000000");
+    test(1.5e-5, std::chars_format::fixed, "0.000015");
+    test(123.456, std::chars_format::fixed, "123.456");
+    test(123456.0, std::chars_format::general, "123456");
+    test(1234567.0, std::chars_format::general, "1.234567e+06");
+    test(0.0001, std::chars_format::general, "0.0001");
+    test(0.00001, std::chars_format::general, "1e-05");
+    test(1.0, std::chars_format::hex, "1p+0");
+    test(0.1, std::chars_format::hex, "1.999999999999ap-4");
+    test(-10.0, std::chars_format::hex, "-1.4p+3");
+    test(0.0, std::chars_format::hex, "0p+0");
+    test(5e-324, std::chars_format::hex, "0.0000000000001p-1022");
+    test(0.1f, std::chars_format::hex, "1.99999ap-4");
+    test(1e-45f, std::chars_format::hex, "0.000002p-126");
+
+    const double doubles[] = {0.1, 1.0 / 3, 2.0 / 3, 1e100, 1.5e-300, 4.9e-324,
+                              2.2250738585072014e-308, 1.7976931348623157e308};
+    for (double d : doubles)
+    {
+        test_round_trip(d);
+        test_round_trip(-d);
+    }
+    const float floats[] = {0.1f, 1.f / 3, 2.f / 3, 1e30f, 1.5e-30f, 1e-45f,
+                            1.17549435e-38f, 3.4028235e38f};
+    for (float f : floats)
+    {
+        test_round_trip(f);
+        test_round_trip(-f);
+    }
+
+    return 0;
+}
@@ -100,12 +100,24 @@ struct _LIBCXXABI_HIDDEN __cxa_dependent_exception {
     _Unwind_Exception unwindHeader;
 };
 
+// Pairs of a thrown class type and a class type of a handler that were found
+// not to match, so that __class_type_info::can_catch does not repeat the
+// base class search for them.
+struct _LIBCXXABI_HIDDEN __cxa_catch_miss_cache {
+    static const unsigned kSize = 16;
+    struct Entry {
+        const std::type_info* thrownType;
+        const std::type_info* catchType;
+    } entries[kSize];
+};
+
 struct _LIBCXXABI_HIDDEN __cxa_eh_globals {
     __cxa_exception *   caughtExceptions;
     unsigned int        uncaughtExceptions;
 #if defined(_LIBCXXABI_ARM_EHABI)
     __cxa_exception* propagatingExceptions;
 #endif
+    __cxa_catch_miss_cache catchMisses;
 };
 
 extern "C" _LIBCXXABI_FUNC_VIS __cxa_eh_globals * __cxa_get_globals      ();
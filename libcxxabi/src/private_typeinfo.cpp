@@ -43,6 +43,8 @@
 
 #include <string.h>
 
+#include "cxa_exception.h"
+
 #ifdef _LIBCXX_DYNAMIC_FALLBACK
 #include "abort_message.h"
 #include <sys/syslog.h>
@@ -221,6 +223,20 @@ __class_type_info::can_catch(const __shim_type_info* thrown_type,
     if (thrown_class_type == 0)
         return false;
     // bullet 2
+    // Whether this is an unambiguous public base of the thrown class only
+    // depends on the types, as the thrown object is never null. Exceptions
+    // often pass many unrelated handlers, so remember the misses per thread
+    // instead of searching the bases again for each of them.
+    __cxa_catch_miss_cache::Entry* miss = 0;
+    if (__cxa_eh_globals* globals = __cxa_get_globals_fast())
+    {
+        // type_info objects are usually adjacent, 16 or more bytes apart.
+        uintptr_t hash = (reinterpret_cast<uintptr_t>(thrown_class_type) >> 4) * 31 +
+                         (reinterpret_cast<uintptr_t>(this) >> 4);
+        miss = &globals->catchMisses.entries[hash % __cxa_catch_miss_cache::kSize];
+        if (miss->thrownType == thrown_class_type && miss->catchType == this)
+            return false;
+    }
     __dynamic_cast_info info = {thrown_class_type, 0, this, -1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,};
     info.number_of_dst_type = 1;
     thrown_class_type->has_unambiguous_public_base(&info, adjustedPtr, public_path);
@@ -229,6 +245,11 @@ __class_type_info::can_catch(const __shim_type_info* thrown_type,
         adjustedPtr = const_cast<void*>(info.dst_ptr_leading_to_static_ptr);
         return true;
     }
+    if (miss)
+    {
+        miss->thrownType = thrown_class_type;
+        miss->catchType = this;
+    }
     return false;
 }
 
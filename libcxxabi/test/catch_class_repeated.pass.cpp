@@ -0,0 +1,66 @@
+//===---------------------- catch_class_repeated.cpp ----------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+// __class_type_info::can_catch remembers handler types that did not match a
+// thrown class type. Make sure that repeatedly throwing through the same
+// clauses gives the same answers as the first time, for several types in a row.
+
+// UNSUPPORTED: libcxxabi-no-exceptions
+
+#include <cassert>
+
+struct A { int a; };
+struct B : A { int b; };
+struct C : A { int c; };
+struct D : B, C { int d; }; // A is an ambiguous base of D.
+struct E : private A { int e; };
+struct Unrelated { int u; };
+
+template <class Thrown>
+int throw_through_unrelated_clauses(int depth) {
+  try {
+    if (depth == 0)
+      throw Thrown();
+    return throw_through_unrelated_clauses<Thrown>(depth - 1);
+  } catch (Unrelated&) {
+    assert(false);
+  } catch (int) {
+    assert(false);
+  } catch (Thrown*) {
+    assert(false);
+  }
+  return -1;
+}
+
+template <class Thrown, class Caught>
+bool is_caught_as() {
+  try {
+    try {
+      throw_through_unrelated_clauses<Thrown>(3);
+    } catch (Caught&) {
+      return true;
+    }
+  } catch (Thrown&) {
+    return false;
+  }
+  assert(false);
+  return false;
+}
+
+int main() {
+  for (int i = 0; i < 100; ++i) {
+    assert((is_caught_as<B, A>()));
+    assert((is_caught_as<C, A>()));
+    assert((!is_caught_as<D, A>()));
+    assert((is_caught_as<D, B>()));
+    assert((is_caught_as<D, C>()));
+    assert((!is_caught_as<E, A>()));
+    assert((!is_caught_as<A, B>()));
+    assert((is_caught_as<A, A>()));
+  }
+}
@@ -149,6 +149,13 @@ extern char __exidx_end;
 #define ElfW(type) Elf_##type
 #endif
 
+// glibc runs dl_iterate_phdr() callbacks under its loader lock, which the
+// frame header cache relies on for synchronization.
+#if defined(_LIBUNWIND_SUPPORT_DWARF_UNWIND) && defined(__GLIBC__) &&          \
+    !defined(_LIBUNWIND_NO_FRAME_HEADER_CACHE)
+#define _LIBUNWIND_USE_FRAME_HEADER_CACHE 1
+#endif
+
 #endif
 
 namespace libunwind {
@@ -178,6 +185,12 @@ struct UnwindInfoSections {
 #endif
 };
 
+#if defined(_LIBUNWIND_USE_FRAME_HEADER_CACHE)
+#include "FrameHeaderCache.hpp"
+
+// There is one cache per copy of libunwind, i.e. usually one per process.
+static FrameHeaderCache TheFrameHeaderCache;
+#endif
 
 /// LocalAddressSpace is used as a template parameter to UnwindCursor when
 /// unwinding a thread in the same process.  The wrappers compile away,
@@ -479,7 +492,7 @@ inline bool LocalAddressSpace::findUnwindSections(pint_t targetAddr,
 
   dl_iterate_cb_data cb_data = {this, &info, targetAddr};
   int found = dl_iterate_phdr(
-      [](struct dl_phdr_info *pinfo, size_t, void *data) -> int {
+      [](struct dl_phdr_info *pinfo, size_t pinfo_size, void *data) -> int {
         auto cbdata = static_cast<dl_iterate_cb_data *>(data);
         bool found_obj = false;
         bool found_hdr = false;
@@ -487,6 +500,14 @@ inline bool LocalAddressSpace::findUnwindSections(pint_t targetAddr,
         assert(cbdata);
         assert(cbdata->sects);
 
+#if defined(_LIBUNWIND_USE_FRAME_HEADER_CACHE)
+        if (TheFrameHeaderCache.find(pinfo, pinfo_size, cbdata->targetAddr,
+                                     *cbdata->sects))
+          return true;
+#else
+        (void)pinfo_size;
+#endif
+
         if (cbdata->targetAddr < pinfo->dlpi_addr) {
           return false;
         }
@@ -548,6 +569,9 @@ inline bool LocalAddressSpace::findUnwindSections(pint_t targetAddr,
 
         if (found_obj && found_hdr) {
           cbdata->sects->dwarf_section_length = object_length;
+#if defined(_LIBUNWIND_USE_FRAME_HEADER_CACHE)
+          TheFrameHeaderCache.add(*cbdata->sects);
+#endif
           return true;
         } else {
           return false;
@@ -0,0 +1,132 @@
+//===------------------------ FrameHeaderCache.hpp ------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//
+//  Caches the unwind sections of recently unwound loaded objects, so that
+//  finding them does not require walking and decoding the program headers of
+//  every loaded object.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef __FRAMEHEADERCACHE_HPP__
+#define __FRAMEHEADERCACHE_HPP__
+
+// This header is included by AddressSpace.hpp inside namespace libunwind,
+// after <link.h> and the definition of UnwindInfoSections.
+
+/// Small most-recently-used cache of the sections found by
+/// LocalAddressSpace::findUnwindSections(), keyed by the PT_LOAD segment
+/// containing the looked up address.
+///
+/// The cache must only be used from within a dl_iterate_phdr() callback:
+/// the C library serializes those callbacks with its loader lock, which also
+/// protects the cache. The cache is consulted on the first callback of an
+/// iteration, so a hit ends the iteration right away. It is reset whenever
+/// the dlpi_adds/dlpi_subs counters show that objects have been loaded or
+/// unloaded since it was filled.
+///
+/// No constructor: instances are meant to be zero-initialized statics, which
+/// start out invalid.
+class _LIBUNWIND_HIDDEN FrameHeaderCache {
+  struct CacheEntry {
+    uintptr_t LowPC() const { return Info.dso_base; }
+    uintptr_t HighPC() const {
+      return Info.dso_base + Info.dwarf_section_length;
+    }
+    UnwindInfoSections Info;
+    CacheEntry *Next;
+  };
+
+  static const size_t kCacheEntryCount = 8;
+
+  // libunwind cannot depend on the C++ library, so the entries are
+  // preallocated and linked into a list of unused and a list of used
+  // entries, most recently used first.
+  CacheEntry Entries[kCacheEntryCount];
+  CacheEntry *MostRecentlyUsed;
+  CacheEntry *Unused;
+  unsigned long long LastAdds;
+  unsigned long long LastSubs;
+  bool Valid;
+
+  void reset(unsigned long long Adds, unsigned long long Subs) {
+    MostRecentlyUsed = nullptr;
+    Unused = &Entries[0];
+    for (size_t i = 0; i < kCacheEntryCount - 1; i++)
+      Entries[i].Next = &Entries[i + 1];
+    Entries[kCacheEntryCount - 1].Next = nullptr;
+    LastAdds = Adds;
+    LastSubs = Subs;
+    Valid = true;
+  }
+
+public:
+  /// Look up the sections of the object containing \p TargetAddr. \p PInfo and
+  /// \p PInfoSize are the arguments of the current dl_iterate_phdr()
+  /// callback. Returns true and fills in \p Sects on a hit.
+  bool find(const dl_phdr_info *PInfo, size_t PInfoSize, uintptr_t TargetAddr,
+            UnwindInfoSections &Sects) {
+    // Without the load/unload counters, stale entries cannot be detected.
+    if (PInfoSize <
+        offsetof(dl_phdr_info, dlpi_subs) + sizeof(PInfo->dlpi_subs)) {
+      Valid = false;
+      return false;
+    }
+    if (!Valid || PInfo->dlpi_adds != LastAdds ||
+        PInfo->dlpi_subs != LastSubs) {
+      // Objects came or went. Dropping everything is a big hammer, but this
+      // is rare and usually happens with an empty cache anyway.
+      reset(PInfo->dlpi_adds, PInfo->dlpi_subs);
+      return false;
+    }
+
+    CacheEntry *Previous = nullptr;
+    for (CacheEntry *Current = MostRecentlyUsed; Current != nullptr;
+         Previous = Current, Current = Current->Next) {
+      if (TargetAddr < Current->LowPC() || TargetAddr >= Current->HighPC())
+        continue;
+      if (Previous) {
+        Previous->Next = Current->Next;
+        Current->Next = MostRecentlyUsed;
+        MostRecentlyUsed = Current;
+      }
+      Sects = Current->Info;
+      return true;
+    }
+    return false;
+  }
+
+  /// Remember \p Sects, evicting the least recently used entry if the cache
+  /// is full. Does nothing unless find() has validated the cache during the
+  /// current dl_iterate_phdr() iteration.
+  void add(const UnwindInfoSections &Sects) {
+    if (!Valid)
+      return;
+
+    CacheEntry *Current;
+    if (Unused != nullptr) {
+      Current = Unused;
+      Unused = Unused->Next;
+    } else {
+      CacheEntry *Previous = nullptr;
+      Current = MostRecentlyUsed;
+      while (Current->Next != nullptr) {
+        Previous = Current;
+        Current = Current->Next;
+      }
+      if (Previous)
+        Previous->Next = nullptr;
+      else
+        MostRecentlyUsed = nullptr;
+    }
+
+    Current->Info = Sects;
+    Current->Next = MostRecentlyUsed;
+    MostRecentlyUsed = Current;
+  }
+};
+
+#endif // __FRAMEHEADERCACHE_HPP__
@@ -0,0 +1,83 @@
+#include "../src/config.h"
+#include "../src/AddressSpace.hpp"
+
+// Only run this test where the frame header cache is used.
+#if defined(_LIBUNWIND_USE_FRAME_HEADER_CACHE)
+
+#include <assert.h>
+#include <link.h>
+
+using namespace libunwind;
+
+#define kBaseAddr 0x10000
+#define kSegmentLength 0x100
+
+static FrameHeaderCache FHC;
+
+static UnwindInfoSections makeSections(uintptr_t base) {
+  UnwindInfoSections uis;
+  memset(&uis, 0, sizeof(uis));
+  uis.dso_base = base;
+  uis.dwarf_section_length = kSegmentLength;
+  return uis;
+}
+
+static bool lookup(dl_phdr_info &pinfo, uintptr_t addr, uintptr_t &base) {
+  UnwindInfoSections uis;
+  memset(&uis, 0, sizeof(uis));
+  if (!FHC.find(&pinfo, sizeof(pinfo), addr, uis))
+    return false;
+  base = uis.dso_base;
+  return true;
+}
+
+int main() {
+  dl_phdr_info pinfo;
+  memset(&pinfo, 0, sizeof(pinfo));
+  uintptr_t base;
+
+  // The first lookup validates the (empty) cache and misses.
+  assert(!lookup(pinfo, kBaseAddr, base));
+
+  // Fill more objects than the cache holds. Only the most recent ones stay.
+  for (uintptr_t i = 0; i < 16; ++i)
+    FHC.add(makeSections(kBaseAddr + i * kSegmentLength));
+  assert(!lookup(pinfo, kBaseAddr, base));
+  assert(lookup(pinfo, kBaseAddr + 15 * kSegmentLength + 1, base));
+  assert(base == kBaseAddr + 15 * kSegmentLength);
+  assert(lookup(pinfo, kBaseAddr + 8 * kSegmentLength, base));
+  assert(base == kBaseAddr + 8 * kSegmentLength);
+
+  // The entry just found is the most recently used one, so it survives the
+  // next eviction while the least recently used one does not.
+  FHC.add(makeSections(kBaseAddr));
+  assert(lookup(pinfo, kBaseAddr + 8 * kSegmentLength, base));
+  assert(!lookup(pinfo, kBaseAddr + 9 * kSegmentLength, base));
+  assert(lookup(pinfo, kBaseAddr, base));
+
+  // Addresses past the end of a segment are not part of it.
+  assert(!lookup(pinfo, kBaseAddr + 16 * kSegmentLength, base));
+
+  // Loading or unloading an object invalidates everything.
+  pinfo.dlpi_adds++;
+  assert(!lookup(pinfo, kBaseAddr, base));
+  assert(!lookup(pinfo, kBaseAddr + 8 * kSegmentLength, base));
+  pinfo.dlpi_subs++;
+  FHC.add(makeSections(kBaseAddr));
+  assert(!lookup(pinfo, kBaseAddr, base));
+
+  // A C library that does not provide the counters disables the cache.
+  FHC.add(makeSections(kBaseAddr));
+  assert(lookup(pinfo, kBaseAddr, base));
+  UnwindInfoSections uis;
+  assert(!FHC.find(&pinfo, offsetof(dl_phdr_info, dlpi_adds), kBaseAddr, uis));
+  FHC.add(makeSections(kBaseAddr));
+  assert(!lookup(pinfo, kBaseAddr, base));
+  assert(!lookup(pinfo, kBaseAddr, base));
+
+  return 0;
+}
+
+#else
+int main() { return 0; }
+#endif
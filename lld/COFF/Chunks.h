@@ -18,6 +18,7 @@
 #include "llvm/ADT/iterator_range.h"
 #include "llvm/MC/StringTableBuilder.h"
 #include "llvm/Object/COFF.h"
+#include <atomic>
 #include <utility>
 #include <vector>
 
@@ -314,8 +315,8 @@ public:
   // Auxiliary Format 5: Section Definitions. Used for ICF.
   uint32_t checksum = 0;
 
-  // Used by the garbage collector.
-  bool live;
+  // Used by the garbage collector, which may set it from several threads.
+  std::atomic<bool> live;
 
   // Whether this section needs to be kept distinct from other sections during
   // ICF. This is set by the driver using address-significance tables.
@@ -110,6 +110,8 @@ struct Configuration {
   bool debugGHashes = false;
   bool debugSymtab = false;
   bool showTiming = false;
+  bool timeTraceEnabled = false;
+  unsigned timeTraceGranularity = 500;
   bool showSummary = false;
   unsigned debugTypes = static_cast<unsigned>(DebugType::None);
   std::vector<std::string> natvisFiles;
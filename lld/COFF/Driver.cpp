@@ -25,6 +25,7 @@
 #include "lld/Common/Timer.h"
 #include "lld/Common/Version.h"
 #include "llvm/ADT/Optional.h"
+#include "llvm/ADT/ScopeExit.h"
 #include "llvm/ADT/StringSwitch.h"
 #include "llvm/BinaryFormat/Magic.h"
 #include "llvm/LTO/LTO.h"
@@ -42,6 +43,7 @@
 #include "llvm/Support/Process.h"
 #include "llvm/Support/TarWriter.h"
 #include "llvm/Support/TargetSelect.h"
+#include "llvm/Support/TimeProfiler.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/ToolDrivers/llvm-lib/LibDriver.h"
 #include <algorithm>
@@ -1091,6 +1093,21 @@ Optional<std::string> getReproduceFile(const opt::InputArgList &args) {
   return None;
 }
 
+// Writes the time trace recorded by /time-trace to a file.
+static void writeTimeTrace(opt::InputArgList &args) {
+  std::string path = args.getLastArgValue(OPT_time_trace_file);
+  if (path.empty())
+    path = config->outputFile + ".time-trace";
+
+  std::error_code ec;
+  raw_fd_ostream os(path, ec, sys::fs::OF_Text);
+  if (ec) {
+    error("cannot open " + path + ": " + ec.message());
+    return;
+  }
+  timeTraceProfilerWrite(os);
+}
+
 void LinkerDriver::link(ArrayRef<const char *> argsArr) {
   // Needed for LTO.
   InitializeAllTargetInfos();
@@ -1140,6 +1157,18 @@ void LinkerDriver::link(ArrayRef<const char *> argsArr) {
 
   config->showSummary = args.hasArg(OPT_summary);
 
+  // Initialize the time trace profiler. It is torn down on every way out of
+  // this function, but the trace is only written for a completed link.
+  config->timeTraceEnabled = args.hasArg(OPT_time_trace);
+  config->timeTraceGranularity =
+      args::getInteger(args, OPT_time_trace_granularity, 500);
+  if (config->timeTraceEnabled)
+    timeTraceProfilerInitialize(config->timeTraceGranularity);
+  auto timeTraceCleanup = make_scope_exit([] {
+    if (config->timeTraceEnabled)
+      timeTraceProfilerCleanup();
+  });
+
   ScopedTimer t(Timer::root());
   // Handle --version, which is an lld extension. This option is a bit odd
   // because it doesn't start with "/", but we deliberately chose "--" to
@@ -1865,7 +1894,10 @@ void LinkerDriver::link(ArrayRef<const char *> argsArr) {
   // Do LTO by compiling bitcode input files to a set of native COFF files then
   // link those files (unless -thinlto-index-only was given, in which case we
   // resolve symbols and write indices, but don't generate native code or link).
-  symtab->addCombinedLTOObjects();
+  {
+    llvm::TimeTraceScope timeScope("LTO", StringRef(""));
+    symtab->addCombinedLTOObjects();
+  }
 
   // If -thinlto-index-only is given, we should create only "index
   // files" and not object files. Index file creation is already done
@@ -1970,6 +2002,9 @@ void LinkerDriver::link(ArrayRef<const char *> argsArr) {
   Timer::root().stop();
   if (config->showTiming)
     Timer::root().print();
+
+  if (config->timeTraceEnabled)
+    writeTimeTrace(args);
 }
 
 } // namespace coff
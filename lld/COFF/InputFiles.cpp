@@ -32,6 +32,7 @@
 #include "llvm/Support/ErrorOr.h"
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/Path.h"
+#include "llvm/Support/TimeProfiler.h"
 #include "llvm/Target/TargetOptions.h"
 #include <cstring>
 #include <system_error>
@@ -182,6 +183,7 @@ void LazyObjFile::parse() {
 }
 
 void ObjFile::parse() {
+  llvm::TimeTraceScope timeScope("Parse input file", getName());
   // Parse a memory buffer as a COFF file.
   std::unique_ptr<Binary> bin = CHECK(createBinary(mb), this);
 
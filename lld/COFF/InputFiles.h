@@ -20,6 +20,7 @@
 #include "llvm/Object/Archive.h"
 #include "llvm/Object/COFF.h"
 #include "llvm/Support/StringSaver.h"
+#include <atomic>
 #include <memory>
 #include <set>
 #include <vector>
@@ -318,8 +319,8 @@ public:
   // symbols provided by this import library member. We also track whether the
   // imported symbol is used separately from whether the thunk is used in order
   // to avoid creating unnecessary thunks.
-  bool live = !config->doGC;
-  bool thunkLive = !config->doGC;
+  std::atomic<bool> live{!config->doGC};
+  std::atomic<bool> thunkLive{!config->doGC};
 };
 
 // Used for LTO.
@@ -8,8 +8,10 @@
 
 #include "Chunks.h"
 #include "Symbols.h"
+#include "lld/Common/Threads.h"
 #include "lld/Common/Timer.h"
 #include "llvm/ADT/STLExtras.h"
+#include "llvm/Support/TimeProfiler.h"
 #include <vector>
 
 namespace lld {
@@ -22,11 +24,13 @@ static Timer gctimer("GC", Timer::root());
 // from the final output.
 void markLive(ArrayRef<Chunk *> chunks) {
   ScopedTimer t(gctimer);
+  llvm::TimeTraceScope timeScope("GC", StringRef(""));
 
   // We build up a worklist of sections which have been marked as live. We only
   // push into the worklist when we discover an unmarked section, and we mark
-  // as we push, so sections never appear twice in the list.
-  SmallVector<SectionChunk *, 256> worklist;
+  // as we push, so sections never appear twice in the list. Marking is an
+  // atomic exchange, so that the worklist can be processed by several threads.
+  std::vector<SectionChunk *> worklist;
 
   // COMDAT section chunks are dead by default. Add non-COMDAT chunks.
   for (Chunk *c : chunks)
@@ -34,16 +38,14 @@ void markLive(ArrayRef<Chunk *> chunks) {
       if (sc->live)
         worklist.push_back(sc);
 
-  auto enqueue = [&](SectionChunk *c) {
-    if (c->live)
-      return;
-    c->live = true;
-    worklist.push_back(c);
+  auto enqueue = [](SectionChunk *c, std::vector<SectionChunk *> &stack) {
+    if (!c->live.exchange(true))
+      stack.push_back(c);
   };
 
-  auto addSym = [&](Symbol *b) {
+  auto addSym = [&](Symbol *b, std::vector<SectionChunk *> &stack) {
     if (auto *sym = dyn_cast<DefinedRegular>(b))
-      enqueue(sym->getChunk());
+      enqueue(sym->getChunk(), stack);
     else if (auto *sym = dyn_cast<DefinedImportData>(b))
       sym->file->live = true;
     else if (auto *sym = dyn_cast<DefinedImportThunk>(b))
@@ -52,20 +54,39 @@ void markLive(ArrayRef<Chunk *> chunks) {
 
   // Add GC root chunks.
   for (Symbol *b : config->gcroot)
-    addSym(b);
+    addSym(b, worklist);
 
+  // The worklist is dealt out to a number of stacks, and each stack is walked
+  // depth first in parallel. A walk stops after a bounded number of sections,
+  // and whatever is left on the stacks is dealt out again, so that a large
+  // subgraph reached from one root is spread over all threads.
+  const size_t numStacks = 64;
+  const size_t maxSectionsPerWalk = 4096;
   while (!worklist.empty()) {
-    SectionChunk *sc = worklist.pop_back_val();
-    assert(sc->live && "We mark as live when pushing onto the worklist!");
+    std::vector<std::vector<SectionChunk *>> stacks(numStacks);
+    for (size_t i = 0, e = worklist.size(); i != e; ++i)
+      stacks[i % numStacks].push_back(worklist[i]);
 
-    // Mark all symbols listed in the relocation table for this section.
-    for (Symbol *b : sc->symbols())
-      if (b)
-        addSym(b);
+    parallelForEach(stacks, [&](std::vector<SectionChunk *> &stack) {
+      for (size_t n = 0; n != maxSectionsPerWalk && !stack.empty(); ++n) {
+        SectionChunk *sc = stack.back();
+        stack.pop_back();
+        assert(sc->live && "We mark as live when pushing onto the worklist!");
 
-    // Mark associative sections if any.
-    for (SectionChunk &c : sc->children())
-      enqueue(&c);
+        // Mark all symbols listed in the relocation table for this section.
+        for (Symbol *b : sc->symbols())
+          if (b)
+            addSym(b, stack);
+
+        // Mark associative sections if any.
+        for (SectionChunk &c : sc->children())
+          enqueue(&c, stack);
+      }
+    });
+
+    worklist.clear();
+    for (std::vector<SectionChunk *> &stack : stacks)
+      worklist.insert(worklist.end(), stack.begin(), stack.end());
   }
 }
 
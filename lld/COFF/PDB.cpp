@@ -57,6 +57,7 @@
 #include "llvm/Support/FormatVariadic.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/ScopedPrinter.h"
+#include <atomic>
 #include <memory>
 
 using namespace llvm;
@@ -72,6 +73,7 @@ static ExitOnError exitOnErr;
 static Timer totalPdbLinkTimer("PDB Emission (Cumulative)", Timer::root());
 
 static Timer addObjectsTimer("Add Objects", totalPdbLinkTimer);
+static Timer typeHashingTimer("Global Type Hashing", addObjectsTimer);
 static Timer typeMergingTimer("Type Merging", addObjectsTimer);
 static Timer symbolMergingTimer("Symbol Merging", addObjectsTimer);
 static Timer globalsLayoutTimer("Globals Stream Layout", totalPdbLinkTimer);
@@ -102,6 +104,10 @@ public:
   /// Link CodeView from each object file in the symbol table into the PDB.
   void addObjectsToPDB();
 
+  /// Compute global hashes of the type records of all object files that don't
+  /// have a usable .debug$H section, in parallel, for /DEBUG:GHASH.
+  void computeGlobalHashes();
+
   /// Link info for each import file in the symbol table into the PDB.
   void addImportFilesToPDB(ArrayRef<OutputSection *> outputSections);
 
@@ -185,6 +191,10 @@ private:
   /// far.
   std::map<uint32_t, CVIndexMap> precompTypeIndexMappings;
 
+  /// Global hashes computed ahead of time by computeGlobalHashes().
+  llvm::DenseMap<const ObjFile *, std::vector<GloballyHashedType>>
+      precomputedHashes;
+
   // For statistics
   uint64_t globalSymbols = 0;
   uint64_t moduleSymbols = 0;
@@ -324,13 +334,30 @@ static void addTypeInfo(pdb::TpiStreamBuilder &tpiBuilder,
   // Start the TPI or IPI stream header.
   tpiBuilder.setVersionHeader(pdb::PdbTpiV80);
 
-  // Flatten the in memory type table and hash each type.
-  typeTable.ForEachRecord([&](TypeIndex ti, const CVType &type) {
-    auto hash = pdb::hashTypeRecord(type);
-    if (auto e = hash.takeError())
-      fatal("type hashing error");
-    tpiBuilder.addTypeRecord(type.RecordData, *hash);
+  // Flatten the in memory type table.
+  std::vector<CVType> types;
+  types.reserve(typeTable.size());
+  typeTable.ForEachRecord(
+      [&](TypeIndex ti, const CVType &type) { types.push_back(type); });
+
+  // Hash each type. Records are hashed independently of each other, so do
+  // that in parallel, and then add them to the stream in order.
+  std::vector<uint32_t> hashes(types.size());
+  std::atomic<bool> failed{false};
+  parallelForEachN(0, types.size(), [&](size_t i) {
+    Expected<uint32_t> hash = pdb::hashTypeRecord(types[i]);
+    if (!hash) {
+      consumeError(hash.takeError());
+      failed = true;
+      return;
+    }
+    hashes[i] = *hash;
   });
+  if (failed)
+    fatal("type hashing error");
+
+  for (size_t i = 0, e = types.size(); i != e; ++i)
+    tpiBuilder.addTypeRecord(types[i].RecordData, hashes[i]);
 }
 
 Expected<const CVIndexMap &>
@@ -394,7 +421,10 @@ PDBLinker::mergeDebugT(ObjFile *file, CVIndexMap *objectIndexMap) {
   if (config->debugGHashes) {
     ArrayRef<GloballyHashedType> hashes;
     std::vector<GloballyHashedType> ownedHashes;
-    if (Optional<ArrayRef<uint8_t>> debugH = getDebugH(file))
+    auto it = precomputedHashes.find(file);
+    if (it != precomputedHashes.end())
+      hashes = it->second;
+    else if (Optional<ArrayRef<uint8_t>> debugH = getDebugH(file))
       hashes = getHashesFromDebugH(*debugH);
     else {
       ownedHashes = GloballyHashedType::hashTypes(types);
@@ -406,6 +436,8 @@ PDBLinker::mergeDebugT(ObjFile *file, CVIndexMap *objectIndexMap) {
             objectIndexMap->tpiMap, types, hashes, file->pchSignature))
       fatal("codeview::mergeTypeAndIdRecords failed: " +
             toString(std::move(err)));
+    if (it != precomputedHashes.end())
+      precomputedHashes.erase(it);
   } else {
     if (auto err = mergeTypeAndIdRecords(tMerger.iDTable, tMerger.typeTable,
                                          objectIndexMap->tpiMap, types,
@@ -1268,11 +1300,46 @@ static PublicSym32 createPublic(Defined *def) {
 
 // Add all object files to the PDB. Merge .debug$T sections into IpiData and
 // TpiData.
+// Computing global hashes takes a SHA1 of every type record, and it is the
+// most expensive part of type merging for objects compiled without
+// -gcodeview-ghash. The hashes of an object only depend on the object itself,
+// so we compute them for all objects in parallel before merging. Objects that
+// use a type server or precompiled headers are left for mergeDebugT() because
+// their type streams are only final once their dependencies are loaded.
+//
+// Merging itself remains serial and in command line order, so type indices
+// don't depend on the number of threads.
+void PDBLinker::computeGlobalHashes() {
+  ScopedTimer t(typeHashingTimer);
+
+  std::vector<ObjFile *> files;
+  for (ObjFile *file : ObjFile::instances) {
+    if (!file->debugTypesObj || !file->debugTypes)
+      continue;
+    TpiSource::TpiKind kind = file->debugTypesObj->kind;
+    if (kind != TpiSource::Regular && kind != TpiSource::PCH)
+      continue;
+    if (!getDebugH(file))
+      files.push_back(file);
+  }
+
+  std::vector<std::vector<GloballyHashedType>> hashes(files.size());
+  parallelForEachN(0, files.size(), [&](size_t i) {
+    hashes[i] = GloballyHashedType::hashTypes(*files[i]->debugTypes);
+  });
+
+  for (size_t i = 0, e = files.size(); i != e; ++i)
+    precomputedHashes[files[i]] = std::move(hashes[i]);
+}
+
 void PDBLinker::addObjectsToPDB() {
   ScopedTimer t1(addObjectsTimer);
 
   createModuleDBI(builder);
 
+  if (config->debugGHashes)
+    computeGlobalHashes();
+
   for (ObjFile *file : ObjFile::instances)
     addObjFile(file);
 
@@ -28,6 +28,7 @@
 #include "llvm/Support/Parallel.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/RandomNumberGenerator.h"
+#include "llvm/Support/TimeProfiler.h"
 #include "llvm/Support/xxhash.h"
 #include <algorithm>
 #include <cstdio>
@@ -289,7 +290,10 @@ private:
 static Timer codeLayoutTimer("Code Layout", Timer::root());
 static Timer diskCommitTimer("Commit Output File", Timer::root());
 
-void writeResult() { Writer().run(); }
+void writeResult() {
+  llvm::TimeTraceScope timeScope("Write output file", StringRef(""));
+  Writer().run();
+}
 
 void OutputSection::addChunk(Chunk *c) {
   chunks.push_back(c);
@@ -616,6 +620,7 @@ void Writer::run() {
   t1.stop();
 
   if (!config->pdbPath.empty() && config->debug) {
+    llvm::TimeTraceScope timeScope("Create PDB", StringRef(""));
     assert(buildId);
     createPDB(symtab, outputSections, sectionTable, buildId->buildId);
   }
@@ -44,6 +44,7 @@
 #include "lld/Common/Strings.h"
 #include "lld/Common/TargetOptionsCommandFlags.h"
 #include "lld/Common/Threads.h"
+#include "lld/Common/Timer.h"
 #include "lld/Common/Version.h"
 #include "llvm/ADT/SetVector.h"
 #include "llvm/ADT/StringExtras.h"
@@ -56,6 +57,7 @@
 #include "llvm/Support/Path.h"
 #include "llvm/Support/TarWriter.h"
 #include "llvm/Support/TargetSelect.h"
+#include "llvm/Support/TimeProfiler.h"
 #include "llvm/Support/raw_ostream.h"
 #include <cstdlib>
 #include <utility>
@@ -314,6 +316,10 @@ static void checkOptions() {
   if (!config->shared && !config->auxiliaryList.empty())
     error("-f may not be used without -shared");
 
+  if (!config->thinLTORemoteCacheDir.empty() && config->thinLTOCacheDir.empty())
+    error("--thinlto-remote-cache-dir may not be used without "
+          "--thinlto-cache-dir");
+
   if (!config->relocatable && !config->defineCommon)
     error("-no-define-common not supported in non relocatable output");
 
@@ -336,6 +342,8 @@ static void checkOptions() {
       error("-r and -pie may not be used together");
     if (config->exportDynamic)
       error("-r and --export-dynamic may not be used together");
+    if (config->incremental)
+      error("-r and --incremental may not be used together");
   }
 
   if (config->executeOnly) {
@@ -417,6 +425,21 @@ static void checkZOptions(opt::InputArgList &args) {
       error("unknown -z value: " + StringRef(arg->getValue()));
 }
 
+// Writes the time trace recorded by --time-trace to a file.
+static void writeTimeTrace(opt::InputArgList &args) {
+  std::string path = args.getLastArgValue(OPT_time_trace_file);
+  if (path.empty())
+    path = (config->outputFile + ".time-trace").str();
+
+  std::error_code ec;
+  raw_fd_ostream os(path, ec, sys::fs::OF_Text);
+  if (ec) {
+    error("cannot open " + path + ": " + ec.message());
+    return;
+  }
+  timeTraceProfilerWrite(os);
+}
+
 void LinkerDriver::main(ArrayRef<const char *> argsArr) {
   ELFOptTable parser;
   opt::InputArgList args = parser.parse(argsArr.slice(1));
@@ -472,6 +495,29 @@ void LinkerDriver::main(ArrayRef<const char *> argsArr) {
   if (args.hasArg(OPT_version))
     return;
 
+  ScopedTimer t(Timer::root());
+
+  // Initialize the time trace profiler.
+  if (config->timeTraceEnabled)
+    timeTraceProfilerInitialize(config->timeTraceGranularity);
+
+  {
+    llvm::TimeTraceScope timeScope("ExecuteLinker", StringRef(""));
+    linkInputs(args);
+  }
+
+  t.stop();
+  if (config->showTiming)
+    Timer::root().print();
+
+  if (config->timeTraceEnabled) {
+    writeTimeTrace(args);
+    timeTraceProfilerCleanup();
+  }
+}
+
+// Reads input files and links them.
+void LinkerDriver::linkInputs(opt::InputArgList &args) {
   initLLVM();
   createFiles(args);
   if (errorCount())
@@ -491,16 +537,16 @@ void LinkerDriver::main(ArrayRef<const char *> argsArr) {
   switch (config->ekind) {
   case ELF32LEKind:
     link<ELF32LE>(args);
-    return;
+    break;
   case ELF32BEKind:
     link<ELF32BE>(args);
-    return;
+    break;
   case ELF64LEKind:
     link<ELF64LE>(args);
-    return;
+    break;
   case ELF64BEKind:
     link<ELF64BE>(args);
-    return;
+    break;
   default:
     llvm_unreachable("unknown Config->EKind");
   }
@@ -871,6 +917,8 @@ static void readConfigs(opt::InputArgList &args) {
       args.hasArg(OPT_ignore_data_address_equality);
   config->ignoreFunctionAddressEquality =
       args.hasArg(OPT_ignore_function_address_equality);
+  config->incremental =
+      args.hasFlag(OPT_incremental, OPT_no_incremental, false);
   config->init = args.getLastArgValue(OPT_init, "_init");
   config->ltoAAPipeline = args.getLastArgValue(OPT_lto_aa_pipeline);
   config->ltoCSProfileGenerate = args.hasArg(OPT_lto_cs_profile_generate);
@@ -912,6 +960,7 @@ static void readConfigs(opt::InputArgList &args) {
   config->searchPaths = args::getStrings(args, OPT_library_path);
   config->sectionStartMap = getSectionStartMap(args);
   config->shared = args.hasArg(OPT_shared);
+  config->showTiming = args.hasArg(OPT_time);
   config->singleRoRx = args.hasArg(OPT_no_rosegment);
   config->soName = args.getLastArgValue(OPT_soname);
   config->sortSection = getSortSection(args);
@@ -929,10 +978,17 @@ static void readConfigs(opt::InputArgList &args) {
                              args.hasArg(OPT_thinlto_index_only_eq);
   config->thinLTOIndexOnlyArg = args.getLastArgValue(OPT_thinlto_index_only_eq);
   config->thinLTOJobs = args::getInteger(args, OPT_thinlto_jobs, -1u);
+  config->thinLTOMemoryLimit =
+      args::getInteger(args, OPT_thinlto_memory_limit, 0);
+  config->timeTraceEnabled = args.hasArg(OPT_time_trace);
+  config->timeTraceGranularity =
+      args::getInteger(args, OPT_time_trace_granularity, 500);
   config->thinLTOObjectSuffixReplace =
       getOldNewOptions(args, OPT_thinlto_object_suffix_replace_eq);
   config->thinLTOPrefixReplace =
       getOldNewOptions(args, OPT_thinlto_prefix_replace_eq);
+  config->thinLTORemoteCacheDir =
+      args.getLastArgValue(OPT_thinlto_remote_cache_dir);
   config->trace = args.hasArg(OPT_trace);
   config->undefined = args::getStrings(args, OPT_undefined);
   config->undefinedVersion =
@@ -988,6 +1044,8 @@ static void readConfigs(opt::InputArgList &args) {
     error("--lto-partitions: number of threads must be > 0");
   if (config->thinLTOJobs == 0)
     error("--thinlto-jobs: number of threads must be > 0");
+  if (int64_t(config->thinLTOMemoryLimit) < 0)
+    error("--thinlto-memory-limit: limit must be >= 0");
 
   if (config->splitStackAdjustSize < 0)
     error("--split-stack-adjust-size: size must be >= 0");
@@ -1731,12 +1789,27 @@ template <class ELFT> void LinkerDriver::link(opt::InputArgList &args) {
   for (auto *arg : args.filtered(OPT_trace_symbol))
     symtab->insert(arg->getValue())->traced = true;
 
+  // Hashing symbol names and inserting them to the symbol table is a large
+  // part of the cost of reading object files, and it doesn't depend on the
+  // order of files, so do that for all object files in parallel first.
+  // Symbol resolution itself still happens in command line order below,
+  // because its outcome (e.g. which archive members are fetched) depends on
+  // that order.
+  parallelForEach(files, [](InputFile *file) {
+    if (file->ekind == config->ekind)
+      if (auto *f = dyn_cast<ObjFile<ELFT>>(file))
+        f->preinsertSymbols();
+  });
+
   // Add all files to the symbol table. This will add almost all
   // symbols that we need to the symbol table. This process might
   // add files to the link, via autolinking, these files are always
   // appended to the Files vector.
-  for (size_t i = 0; i < files.size(); ++i)
-    parseFile(files[i]);
+  {
+    llvm::TimeTraceScope timeScope("Parse input files", StringRef(""));
+    for (size_t i = 0; i < files.size(); ++i)
+      parseFile(files[i]);
+  }
 
   // Now that we have every file, we can decide if we will need a
   // dynamic symbol table.
@@ -1828,7 +1901,10 @@ template <class ELFT> void LinkerDriver::link(opt::InputArgList &args) {
   //
   // With this the symbol table should be complete. After this, no new names
   // except a few linker-synthesized ones will be added to the symbol table.
-  compileBitcodeFiles<ELFT>();
+  {
+    llvm::TimeTraceScope timeScope("LTO", StringRef(""));
+    compileBitcodeFiles<ELFT>();
+  }
   if (errorCount())
     return;
 
@@ -1916,11 +1992,17 @@ template <class ELFT> void LinkerDriver::link(opt::InputArgList &args) {
   replaceCommonSymbols();
 
   // Split SHF_MERGE and .eh_frame sections into pieces in preparation for garbage collection.
-  splitSections<ELFT>();
+  {
+    llvm::TimeTraceScope timeScope("Split sections", StringRef(""));
+    splitSections<ELFT>();
+  }
 
   // Garbage collection and removal of shared symbols from unused shared objects.
-  markLive<ELFT>();
-  demoteSharedSymbols();
+  {
+    llvm::TimeTraceScope timeScope("GC", StringRef(""));
+    markLive<ELFT>();
+    demoteSharedSymbols();
+  }
 
   // Make copies of any input sections that need to be copied into each
   // partition.
@@ -1957,6 +2039,7 @@ template <class ELFT> void LinkerDriver::link(opt::InputArgList &args) {
   // Two input sections with different output sections should not be folded.
   // ICF runs after processSectionCommands() so that we know the output sections.
   if (config->icf != ICFLevel::None) {
+    llvm::TimeTraceScope timeScope("ICF", StringRef(""));
     findKeepUniqueSections<ELFT>(args);
     doIcf<ELFT>();
   }
@@ -1970,6 +2053,7 @@ template <class ELFT> void LinkerDriver::link(opt::InputArgList &args) {
   }
 
   // Write the result to the file.
+  llvm::TimeTraceScope timeScope("Write output file", StringRef(""));
   writeResult<ELFT>();
 }
 
@@ -31,6 +31,7 @@ public:
   void addLibrary(StringRef name);
 
 private:
+  void linkInputs(llvm::opt::InputArgList &args);
   void createFiles(llvm::opt::InputArgList &args);
   void inferMachineType();
   template <class ELFT> void link(llvm::opt::InputArgList &args);
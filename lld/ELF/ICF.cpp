@@ -81,6 +81,8 @@
 #include "SyntheticSections.h"
 #include "Writer.h"
 #include "lld/Common/Threads.h"
+#include "lld/Common/Timer.h"
+#include "llvm/ADT/Hashing.h"
 #include "llvm/ADT/StringExtras.h"
 #include "llvm/BinaryFormat/ELF.h"
 #include "llvm/Object/ELF.h"
@@ -94,6 +96,10 @@ using namespace llvm::object;
 
 namespace lld {
 namespace elf {
+static Timer icfTimer("ICF", Timer::root());
+static Timer icfHashTimer("Hashing", icfTimer);
+static Timer icfEqualityTimer("Equality Comparison", icfTimer);
+
 namespace {
 template <class ELFT> class ICF {
 public:
@@ -115,6 +121,8 @@ private:
 
   size_t findBoundary(size_t begin, size_t end);
 
+  void removeSingletons();
+
   void forEachClassRange(size_t begin, size_t end,
                          llvm::function_ref<void(size_t, size_t)> fn);
 
@@ -393,6 +401,7 @@ void ICF<ELFT>::forEachClass(llvm::function_ref<void(size_t, size_t)> fn) {
   // If threading is disabled or the number of sections are
   // too small to use threading, call Fn sequentially.
   if (!threadsEnabled || sections.size() < 1024) {
+    current = next = 0;
     forEachClassRange(0, sections.size(), fn);
     ++cnt;
     return;
@@ -422,6 +431,49 @@ void ICF<ELFT>::forEachClass(llvm::function_ref<void(size_t, size_t)> fn) {
   ++cnt;
 }
 
+// Sections that are in a class of their own after comparing their static
+// contents can never be merged with anything, whatever their relocations
+// point to. In a typical C++ program they are the vast majority, so we remove
+// them from Sections to avoid visiting them again and again until
+// convergence.
+//
+// Class IDs are end indices in Sections, so we have to renumber the classes
+// that remain. Removed sections get IDs past the end so that they are still
+// different from everything else.
+template <class ELFT> void ICF<ELFT>::removeSingletons() {
+  current = next;
+  std::vector<InputSection *> remaining;
+  std::vector<InputSection *> singletons;
+  forEachClassRange(0, sections.size(), [&](size_t begin, size_t end) {
+    if (end - begin == 1) {
+      singletons.push_back(sections[begin]);
+      return;
+    }
+    for (size_t i = begin; i < end; ++i)
+      remaining.push_back(sections[i]);
+    for (size_t i = begin; i < end; ++i)
+      sections[i]->eqClass[0] = sections[i]->eqClass[1] = remaining.size();
+  });
+
+  uint32_t id = remaining.size();
+  for (InputSection *s : singletons)
+    s->eqClass[0] = s->eqClass[1] = ++id;
+  sections = std::move(remaining);
+}
+
+// Computes a hash of a section's data and the parts of its relocations that
+// constantEq() compares for equality, so that the initial partition already
+// separates most sections that are not constant-equal.
+template <class ELFT, class RelTy>
+static uint32_t getContentHash(InputSection *isec, ArrayRef<RelTy> rels) {
+  hash_code hash = hash_combine(xxHash64(isec->data()), isec->flags,
+                                isec->getParent(), rels.size());
+  for (const RelTy &rel : rels)
+    hash = hash_combine(hash, (uint64_t)rel.r_offset,
+                        rel.getType(config->isMips64EL));
+  return hash;
+}
+
 // Combine the hashes of the sections referenced by the given section into its
 // hash.
 template <class ELFT, class RelTy>
@@ -445,6 +497,9 @@ static void print(const Twine &s) {
 
 // The main function of ICF.
 template <class ELFT> void ICF<ELFT>::run() {
+  ScopedTimer t(icfTimer);
+  ScopedTimer hashTimer(icfHashTimer);
+
   // Collect sections to merge.
   for (InputSectionBase *sec : inputSections) {
     auto *s = cast<InputSection>(sec);
@@ -454,7 +509,10 @@ template <class ELFT> void ICF<ELFT>::run() {
 
   // Initially, we use hash values to partition sections.
   parallelForEach(sections, [&](InputSection *s) {
-    s->eqClass[0] = xxHash64(s->data());
+    if (s->areRelocsRela)
+      s->eqClass[0] = getContentHash<ELFT>(s, s->template relas<ELFT>());
+    else
+      s->eqClass[0] = getContentHash<ELFT>(s, s->template rels<ELFT>());
   });
 
   for (unsigned cnt = 0; cnt != 2; ++cnt) {
@@ -471,9 +529,14 @@ template <class ELFT> void ICF<ELFT>::run() {
   llvm::stable_sort(sections, [](const InputSection *a, const InputSection *b) {
     return a->eqClass[0] < b->eqClass[0];
   });
+  hashTimer.stop();
+
+  ScopedTimer equalityTimer(icfEqualityTimer);
+  size_t numEligible = sections.size();
 
   // Compare static contents and assign unique IDs for each static content.
   forEachClass([&](size_t begin, size_t end) { segregate(begin, end, true); });
+  removeSingletons();
 
   // Split groups by comparing relocations until convergence is obtained.
   do {
@@ -481,8 +544,10 @@ template <class ELFT> void ICF<ELFT>::run() {
     forEachClass(
         [&](size_t begin, size_t end) { segregate(begin, end, false); });
   } while (repeat);
+  equalityTimer.stop();
 
-  log("ICF needed " + Twine(cnt) + " iterations");
+  log("ICF needed " + Twine(cnt) + " iterations for " + Twine(sections.size()) +
+      " out of " + Twine(numEligible) + " sections");
 
   // Merge sections by the equivalence class.
   forEachClassRange(0, sections.size(), [&](size_t begin, size_t end) {
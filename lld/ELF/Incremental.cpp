@@ -0,0 +1,382 @@
+//===- Incremental.cpp ----------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements --incremental. Relinking a large program after a small
+// change usually produces an output that is mostly identical to the previous
+// one, yet we write every byte of it again. With --incremental, we keep the
+// previous output file and overwrite only the parts that have changed.
+//
+// For that to work, the layout has to stay the same from one link to the
+// next. We therefore reserve some extra space after each code and data input
+// section and after each non-SHF_ALLOC output section, and we remember the
+// reserved sizes in a state file next to the output. As long as sections
+// don't outgrow their reservations, they keep their addresses and file
+// offsets.
+//
+// The state file also contains, for each input section, a fingerprint of the
+// bytes that we wrote for it last time: its position, its contents and the
+// values of its relocations. If the layout matches the previous link and the
+// output file has not been touched since, we map the existing file and skip
+// input sections whose fingerprints did not change. Otherwise, we write a new
+// output file from scratch as usual.
+//
+// Note that the rest of the link is not incremental; we still read all input
+// files and resolve all symbols and relocations.
+//
+//===----------------------------------------------------------------------===//
+
+#include "Incremental.h"
+#include "Config.h"
+#include "InputFiles.h"
+#include "InputSection.h"
+#include "OutputSections.h"
+#include "Symbols.h"
+#include "SyntheticSections.h"
+#include "Target.h"
+#include "lld/Common/ErrorHandler.h"
+#include "lld/Common/Threads.h"
+#include "lld/Common/Version.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/Support/xxhash.h"
+
+using namespace llvm;
+using namespace llvm::ELF;
+using namespace llvm::object;
+
+namespace lld {
+namespace elf {
+
+// "LLDINC01" in little-endian.
+static const uint64_t stateMagic = 0x3130434e49444c4c;
+
+namespace {
+struct IncrementalState {
+  // Loaded from the state file of the previous link.
+  bool hasOld = false;
+  uint64_t oldLayoutHash = 0;
+  uint64_t oldFileSize = 0;
+  uint64_t oldModTime = 0;
+  DenseMap<uint64_t, uint64_t> oldSlots;
+  DenseMap<uint64_t, uint64_t> oldFingerprints;
+
+  // Computed by the current link.
+  DenseMap<const InputSection *, uint64_t> keys;
+  DenseMap<const InputSection *, uint64_t> slots;
+  DenseMap<uint64_t, uint64_t> outputSlots;
+  std::vector<InputSection *> sections;
+  std::vector<uint64_t> gapEnds;
+  std::vector<uint64_t> fingerprints;
+  DenseMap<const InputSection *, uint32_t> sectionIndex;
+  uint64_t layoutHash = 0;
+  bool inPlace = false;
+};
+} // namespace
+
+static IncrementalState state;
+
+static std::string getStatePath() {
+  return (config->outputFile + ".lld-incremental").str();
+}
+
+static uint64_t hashWords(ArrayRef<uint64_t> v) {
+  return xxHash64(toStringRef(makeArrayRef(
+      reinterpret_cast<const uint8_t *>(v.data()), v.size() * sizeof(v[0]))));
+}
+
+// Returns the size of a new reservation for something that is SIZE bytes
+// long today.
+static uint64_t growSize(uint64_t size) {
+  return alignTo(size + std::max<uint64_t>(size / 8, 32), 16);
+}
+
+void readIncrementalState() {
+  // Give each input section a key that is stable across links, so that we
+  // can find the space we reserved for it last time.
+  for (InputFile *file : objectFiles) {
+    uint64_t fileHash = xxHash64(toString(file));
+    ArrayRef<InputSectionBase *> sections = file->getSections();
+    for (size_t i = 0, e = sections.size(); i != e; ++i)
+      if (auto *isec = dyn_cast_or_null<InputSection>(sections[i]))
+        if (isec != &InputSection::discarded)
+          state.keys[isec] = hashWords({fileHash, i});
+  }
+
+  ErrorOr<std::unique_ptr<MemoryBuffer>> mbOrErr =
+      MemoryBuffer::getFile(getStatePath(), /*FileSize=*/-1,
+                            /*RequiresNullTerminator=*/false);
+  if (!mbOrErr)
+    return;
+
+  StringRef buf = (*mbOrErr)->getBuffer();
+  if (buf.size() % sizeof(uint64_t))
+    return;
+  std::vector<uint64_t> v(buf.size() / sizeof(uint64_t));
+  memcpy(v.data(), buf.data(), buf.size());
+
+  // Reads a list of key-value pairs starting at v[i].
+  size_t i = 4;
+  auto readMap = [&](DenseMap<uint64_t, uint64_t> &map) {
+    if (i >= v.size() || (v.size() - i - 1) / 2 < v[i])
+      return false;
+    for (uint64_t j = 0, e = v[i++]; j != e; ++j, i += 2)
+      map[v[i]] = v[i + 1];
+    return true;
+  };
+
+  if (v.size() < 4 || v[0] != stateMagic)
+    return;
+  DenseMap<uint64_t, uint64_t> outputSlots;
+  if (!readMap(state.oldSlots) || !readMap(outputSlots) ||
+      !readMap(state.oldFingerprints)) {
+    state.oldSlots.clear();
+    state.oldFingerprints.clear();
+    return;
+  }
+
+  state.hasOld = true;
+  state.oldLayoutHash = v[1];
+  state.oldFileSize = v[2];
+  state.oldModTime = v[3];
+  state.outputSlots = std::move(outputSlots);
+}
+
+// Extra space is reserved only after sections that can be followed by
+// padding without changing the meaning of the program. Fragments of .init
+// and .fini must stay contiguous, and sections such as .init_array are
+// arrays that must not have holes.
+static bool isPaddable(const InputSection *sec) {
+  if (!(sec->flags & SHF_ALLOC) || (sec->flags & SHF_TLS) ||
+      isa<SyntheticSection>(sec))
+    return false;
+  StringRef name = sec->name;
+  if (sec->flags & SHF_EXECINSTR)
+    return name.startswith(".text");
+  return name.startswith(".rodata") || name.startswith(".data") ||
+         name.startswith(".bss");
+}
+
+uint64_t getIncrementalSize(const InputSection *sec) {
+  uint64_t size = sec->getSize();
+  if (!config->incremental || !isPaddable(sec))
+    return size;
+
+  auto it = state.slots.find(sec);
+  if (it != state.slots.end())
+    return it->second;
+
+  auto keyIt = state.keys.find(sec);
+  if (keyIt == state.keys.end())
+    return size;
+
+  // Reuse the old reservation if the section still fits in it.
+  uint64_t slot = state.oldSlots.lookup(keyIt->second);
+  if (slot < size)
+    slot = growSize(size);
+  state.slots[sec] = slot;
+  return slot;
+}
+
+uint64_t getIncrementalSize(const OutputSection *sec) {
+  if (!config->incremental || (sec->flags & SHF_ALLOC) ||
+      sec->type == SHT_NOBITS)
+    return sec->size;
+
+  uint64_t key = xxHash64(sec->name);
+  uint64_t &slot = state.outputSlots[key];
+  if (slot < sec->size)
+    slot = growSize(sec->size);
+  return slot;
+}
+
+// Computes a hash of everything that determines where things are placed in
+// the output file. Non-SHF_ALLOC sections may shrink or grow within their
+// reservations without affecting the rest of the file.
+static uint64_t computeLayoutHash(uint64_t fileSize) {
+  std::vector<uint64_t> v = {xxHash64(getLLDVersion()), fileSize,
+                             (uint64_t)config->ekind, config->emachine,
+                             outputSections.size()};
+  for (OutputSection *sec : outputSections) {
+    v.push_back(xxHash64(sec->name));
+    v.push_back(sec->addr);
+    v.push_back(sec->offset);
+    v.push_back(sec->type);
+    v.push_back(sec->flags);
+    v.push_back(sec->alignment);
+    v.push_back(read32(sec->getFiller().data()));
+    if (sec->flags & SHF_ALLOC)
+      v.push_back(sec->size);
+  }
+  return hashWords(v);
+}
+
+template <class ELFT, class RelTy>
+static void addNonAllocRelocs(std::vector<uint64_t> &v, InputSection *sec,
+                              ArrayRef<RelTy> rels) {
+  ObjFile<ELFT> *file = sec->getFile<ELFT>();
+  for (const RelTy &rel : rels) {
+    Symbol &sym = file->getRelocTargetSym(rel);
+    v.push_back(rel.r_offset);
+    v.push_back(rel.r_info);
+    v.push_back(getAddend<ELFT>(rel));
+    v.push_back(sym.getVA(0));
+  }
+}
+
+// Computes a hash of the bytes that writeTo() and the gap filler produce for
+// a given input section, without actually producing them.
+template <class ELFT>
+static uint64_t computeFingerprint(InputSection *sec, uint64_t gapEnd) {
+  std::vector<uint64_t> v = {sec->getParent()->offset + sec->outSecOff,
+                             gapEnd, sec->getVA(0), sec->getSize(),
+                             xxHash64(toStringRef(sec->data()))};
+
+  if (sec->flags & SHF_ALLOC) {
+    for (const Relocation &rel : sec->relocations) {
+      v.push_back(rel.type);
+      v.push_back(rel.offset);
+      v.push_back(rel.addend);
+      v.push_back(rel.expr);
+      v.push_back(getRelocTargetVA(sec->file, rel.type, rel.addend,
+                                   sec->getVA(rel.offset), *rel.sym,
+                                   rel.expr));
+    }
+  } else if (sec->numRelocations) {
+    if (sec->areRelocsRela)
+      addNonAllocRelocs<ELFT>(v, sec, sec->template relas<ELFT>());
+    else
+      addNonAllocRelocs<ELFT>(v, sec, sec->template rels<ELFT>());
+  }
+  return hashWords(v);
+}
+
+// Returns true if we can skip writing a section when its fingerprint did not
+// change. Synthetic sections and sections whose contents depend on other
+// sections are always written.
+static bool isSkippable(const InputSection *sec) {
+  if (isa<SyntheticSection>(sec) || !sec->file || sec->getSize() == 0)
+    return false;
+  return sec->type != SHT_NOBITS && sec->type != SHT_REL &&
+         sec->type != SHT_RELA && sec->type != SHT_GROUP;
+}
+
+template <class ELFT> void prepareIncrementalUpdate(uint64_t fileSize) {
+  for (OutputSection *os : outputSections) {
+    if (os->type == SHT_NOBITS)
+      continue;
+    std::vector<InputSection *> v = getInputSections(os);
+    for (size_t i = 0, e = v.size(); i != e; ++i) {
+      if (!isSkippable(v[i]))
+        continue;
+      state.sectionIndex[v[i]] = state.sections.size();
+      state.sections.push_back(v[i]);
+      state.gapEnds.push_back(i + 1 == e ? os->size : v[i + 1]->outSecOff);
+    }
+  }
+
+  state.fingerprints.resize(state.sections.size());
+  parallelForEachN(0, state.sections.size(), [](size_t i) {
+    state.fingerprints[i] = computeFingerprint<ELFT>(state.sections[i],
+                                                     state.gapEnds[i]);
+  });
+  state.layoutHash = computeLayoutHash(fileSize);
+
+  // The state file describes the output file as it is now. Remove it before
+  // we start modifying the output, so that we don't trust a half-written
+  // output if we crash.
+  std::string path = getStatePath();
+  sys::fs::remove(path);
+
+  if (!state.hasOld || state.layoutHash != state.oldLayoutHash)
+    return;
+  sys::fs::file_status st;
+  if (sys::fs::status(config->outputFile, st) ||
+      st.type() != sys::fs::file_type::regular_file ||
+      st.getSize() != state.oldFileSize ||
+      (uint64_t)st.getLastModificationTime().time_since_epoch().count() !=
+          state.oldModTime)
+    return;
+  state.inPlace = true;
+}
+
+bool isIncrementalUpdate() { return state.inPlace; }
+
+bool needsWrite(const InputSection *sec) {
+  if (!state.inPlace)
+    return true;
+  auto it = state.sectionIndex.find(sec);
+  if (it == state.sectionIndex.end())
+    return true;
+  uint64_t off = sec->getParent()->offset + sec->outSecOff;
+  auto oldIt = state.oldFingerprints.find(off);
+  return oldIt == state.oldFingerprints.end() ||
+         oldIt->second != state.fingerprints[it->second];
+}
+
+void clearIncrementalSlack() {
+  if (!state.inPlace)
+    return;
+  for (OutputSection *sec : outputSections) {
+    if ((sec->flags & SHF_ALLOC) || sec->type == SHT_NOBITS)
+      continue;
+    uint64_t size = sec->size;
+    uint64_t slot = state.outputSlots.lookup(xxHash64(sec->name));
+    if (slot > size)
+      memset(Out::bufferStart + sec->offset + size, 0, slot - size);
+  }
+}
+
+void writeIncrementalState() {
+  sys::fs::file_status st;
+  if (std::error_code ec = sys::fs::status(config->outputFile, st)) {
+    error("cannot stat " + config->outputFile + ": " + ec.message());
+    return;
+  }
+
+  std::vector<uint64_t> v = {
+      stateMagic, state.layoutHash, st.getSize(),
+      (uint64_t)st.getLastModificationTime().time_since_epoch().count()};
+
+  v.push_back(state.slots.size());
+  for (auto &kv : state.slots) {
+    v.push_back(state.keys.lookup(kv.first));
+    v.push_back(kv.second);
+  }
+
+  v.push_back(state.outputSlots.size());
+  for (auto &kv : state.outputSlots) {
+    v.push_back(kv.first);
+    v.push_back(kv.second);
+  }
+
+  v.push_back(state.sections.size());
+  for (size_t i = 0, e = state.sections.size(); i != e; ++i) {
+    InputSection *sec = state.sections[i];
+    v.push_back(sec->getParent()->offset + sec->outSecOff);
+    v.push_back(state.fingerprints[i]);
+  }
+
+  std::string path = getStatePath();
+  std::error_code ec;
+  raw_fd_ostream os(path, ec, sys::fs::OF_None);
+  if (ec) {
+    error("cannot open " + path + ": " + ec.message());
+    return;
+  }
+  os.write(reinterpret_cast<const char *>(v.data()), v.size() * sizeof(v[0]));
+}
+
+template void prepareIncrementalUpdate<ELF32LE>(uint64_t);
+template void prepareIncrementalUpdate<ELF32BE>(uint64_t);
+template void prepareIncrementalUpdate<ELF64LE>(uint64_t);
+template void prepareIncrementalUpdate<ELF64BE>(uint64_t);
+
+} // namespace elf
+} // namespace lld
@@ -0,0 +1,48 @@
+//===- Incremental.h --------------------------------------------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLD_ELF_INCREMENTAL_H
+#define LLD_ELF_INCREMENTAL_H
+
+#include "lld/Common/LLVM.h"
+
+namespace lld {
+namespace elf {
+class InputSection;
+class OutputSection;
+
+// Reads the state saved by the previous --incremental link, if any.
+void readIncrementalState();
+
+// Returns the number of bytes reserved for an input section in the output.
+uint64_t getIncrementalSize(const InputSection *sec);
+
+// Returns the number of bytes reserved for a non-SHF_ALLOC output section in
+// the output file.
+uint64_t getIncrementalSize(const OutputSection *sec);
+
+// Decides whether the existing output file can be updated in place. Must be
+// called after the final layout is known but before the file is opened.
+template <class ELFT> void prepareIncrementalUpdate(uint64_t fileSize);
+
+bool isIncrementalUpdate();
+
+// Returns false if an input section and the gap after it are known to be
+// identical to what the existing output file already contains.
+bool needsWrite(const InputSection *sec);
+
+// Zero-fills the unused space reserved after non-SHF_ALLOC output sections.
+void clearIncrementalSlack();
+
+// Saves the state of the current link so that the next link can use it.
+void writeIncrementalState();
+
+} // namespace elf
+} // namespace lld
+
+#endif
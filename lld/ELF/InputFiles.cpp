@@ -28,6 +28,7 @@
 #include "llvm/Support/Endian.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/TarWriter.h"
+#include "llvm/Support/TimeProfiler.h"
 #include "llvm/Support/raw_ostream.h"
 
 using namespace llvm;
@@ -159,6 +160,9 @@ template <class ELFT> static void doParseFile(InputFile *file) {
   if (!isCompatible(file))
     return;
 
+  llvm::TimeTraceScope timeScope("Parse input file",
+                                 [&] { return toString(file); });
+
   // Binary file
   if (auto *f = dyn_cast<BinaryFile>(file)) {
     binaryFiles.push_back(f);
@@ -1046,6 +1050,25 @@ StringRef ObjFile<ELFT>::getSectionName(const Elf_Shdr &sec) {
   return CHECK(getObj().getSectionName(&sec, sectionStringTable), this);
 }
 
+template <class ELFT> void ObjFile<ELFT>::preinsertSymbols() {
+  ArrayRef<Elf_Sym> eSyms = this->getELFSyms<ELFT>();
+  this->symbols.resize(eSyms.size());
+
+  for (size_t i = this->firstGlobal, end = eSyms.size(); i != end; ++i) {
+    if (eSyms[i].getBinding() == STB_LOCAL)
+      continue;
+
+    // Leave broken symbols to initializeSymbols() so that errors are
+    // reported in a deterministic order.
+    Expected<StringRef> name = eSyms[i].getName(this->stringTable);
+    if (!name) {
+      consumeError(name.takeError());
+      continue;
+    }
+    this->symbols[i] = symtab->insertConcurrent(*name);
+  }
+}
+
 // Initialize this->Symbols. this->Symbols is a parallel array as
 // its corresponding ELF symbol table.
 template <class ELFT> void ObjFile<ELFT>::initializeSymbols() {
@@ -1053,11 +1076,16 @@ template <class ELFT> void ObjFile<ELFT>::initializeSymbols() {
   this->symbols.resize(eSyms.size());
 
   // Our symbol table may have already been partially initialized
-  // because of LazyObjFile.
-  for (size_t i = 0, end = eSyms.size(); i != end; ++i)
-    if (!this->symbols[i] && eSyms[i].getBinding() != STB_LOCAL)
+  // because of LazyObjFile or preinsertSymbols().
+  for (size_t i = 0, end = eSyms.size(); i != end; ++i) {
+    if (eSyms[i].getBinding() == STB_LOCAL)
+      continue;
+    if (this->symbols[i])
+      symtab->markInserted(this->symbols[i]);
+    else
       this->symbols[i] =
           symtab->insert(CHECK(eSyms[i].getName(this->stringTable), this));
+  }
 
   // Fill this->Symbols. A symbol is either local or global.
   for (size_t i = 0, end = eSyms.size(); i != end; ++i) {
@@ -1559,11 +1587,6 @@ void LazyObjFile::fetch() {
   file->groupId = groupId;
 
   mb = {};
-
-  // Copy symbol vector so that the new InputFile doesn't have to
-  // insert the same defined symbols to the symbol table again.
-  file->symbols = std::move(symbols);
-
   parseFile(file);
 }
 
@@ -1574,10 +1597,18 @@ template <class ELFT> void LazyObjFile::parse() {
   if (isBitcode(this->mb)) {
     std::unique_ptr<lto::InputFile> obj =
         CHECK(lto::InputFile::create(this->mb), this);
+    StringRef buf = this->mb.getBuffer();
     for (const lto::InputFile::Symbol &sym : obj->symbols()) {
       if (sym.isUndefined())
         continue;
-      symtab->addSymbol(LazyObject{*this, saver.save(sym.getName())});
+
+      // Symbol names usually point into the string table of the bitcode
+      // file, which is mapped for the duration of the link. We need to make
+      // a copy only if the symbol table had to be rebuilt in memory.
+      StringRef name = sym.getName();
+      if (name.begin() < buf.begin() || buf.end() < name.end())
+        name = saver.save(name);
+      symtab->addSymbol(LazyObject{*this, name});
     }
     return;
   }
@@ -1599,21 +1630,23 @@ template <class ELFT> void LazyObjFile::parse() {
     ArrayRef<Elf_Sym> eSyms = CHECK(obj.symbols(&sec), this);
     uint32_t firstGlobal = sec.sh_info;
     StringRef strtab = CHECK(obj.getStringTableForSymtab(sec, sections), this);
-    this->symbols.resize(eSyms.size());
 
-    // Get existing symbols or insert placeholder symbols.
+    // Get existing symbols or insert placeholder symbols. We don't keep the
+    // list after this function returns. Most lazy object files are never
+    // fetched, and for those that are, inserting the symbols again is
+    // cheaper than keeping a vector for every one of them. Symbol names
+    // refer to the mapped file, so nothing is copied.
+    std::vector<Symbol *> syms;
     for (size_t i = firstGlobal, end = eSyms.size(); i != end; ++i)
       if (eSyms[i].st_shndx != SHN_UNDEF)
-        this->symbols[i] = symtab->insert(CHECK(eSyms[i].getName(strtab), this));
+        syms.push_back(symtab->insert(CHECK(eSyms[i].getName(strtab), this)));
 
     // Replace existing symbols with LazyObject symbols.
     //
     // resolve() may trigger this->fetch() if an existing symbol is an
     // undefined symbol. If that happens, this LazyObjFile has served
     // its purpose, and we can exit from the loop early.
-    for (Symbol *sym : this->symbols) {
-      if (!sym)
-        continue;
+    for (Symbol *sym : syms) {
       sym->resolve(LazyObject{*this, sym->getName()});
 
       // MemoryBuffer is emptied if this file is instantiated as ObjFile.
@@ -205,6 +205,10 @@ public:
 
   void parse(bool ignoreComdats = false);
 
+  // Creates symbol table entries for the global symbols of this file ahead
+  // of parse(). This is thread-safe and may be called for many files at once.
+  void preinsertSymbols();
+
   StringRef getShtGroupSignature(ArrayRef<Elf_Shdr> sections,
                                  const Elf_Shdr &sec);
 
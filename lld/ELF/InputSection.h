@@ -356,6 +356,11 @@ private:
 // The list of all input sections.
 extern std::vector<InputSectionBase *> inputSections;
 
+// Returns the value that a relocation of a given type and expression applies
+// at address P.
+uint64_t getRelocTargetVA(const InputFile *file, RelType type, int64_t addend,
+                          uint64_t p, const Symbol &sym, RelExpr expr);
+
 } // namespace elf
 
 std::string toString(const elf::InputSectionBase *);
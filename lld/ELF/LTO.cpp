@@ -31,6 +31,7 @@
 #include "llvm/Support/Error.h"
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Threading.h"
 #include <algorithm>
 #include <cstddef>
 #include <memory>
@@ -137,8 +138,12 @@ BitcodeCompiler::BitcodeCompiler() {
     backend = lto::createWriteIndexesThinBackend(
         config->thinLTOPrefixReplace.first, config->thinLTOPrefixReplace.second,
         config->thinLTOEmitImportsFiles, indexFile.get(), onIndexWrite);
-  } else if (config->thinLTOJobs != -1U) {
-    backend = lto::createInProcessThinBackend(config->thinLTOJobs);
+  } else if (config->thinLTOJobs != -1U || config->thinLTOMemoryLimit) {
+    unsigned jobs = config->thinLTOJobs;
+    if (jobs == -1U)
+      jobs = llvm::heavyweight_hardware_concurrency();
+    backend = lto::createInProcessThinBackend(
+        jobs, config->thinLTOMemoryLimit * 1024 * 1024);
   }
 
   ltoObj = std::make_unique<lto::LTO>(createConfig(), backend,
@@ -240,13 +245,19 @@ std::vector<InputFile *> BitcodeCompiler::compile() {
   // The --thinlto-cache-dir option specifies the path to a directory in which
   // to cache native object files for ThinLTO incremental builds. If a path was
   // specified, configure LTO to use it as the cache directory.
+  // --thinlto-remote-cache-dir adds a second-level cache shared with other
+  // machines, which is consulted when the local cache misses.
   lto::NativeObjectCache cache;
-  if (!config->thinLTOCacheDir.empty())
+  if (!config->thinLTOCacheDir.empty()) {
+    std::shared_ptr<lto::RemoteObjectCache> remote;
+    if (!config->thinLTORemoteCacheDir.empty())
+      remote = check(lto::directoryRemoteCache(config->thinLTORemoteCacheDir));
     cache = check(
-        lto::localCache(config->thinLTOCacheDir,
-                        [&](size_t task, std::unique_ptr<MemoryBuffer> mb) {
-                          files[task] = std::move(mb);
-                        }));
+        lto::tieredCache(config->thinLTOCacheDir, std::move(remote),
+                         [&](size_t task, std::unique_ptr<MemoryBuffer> mb) {
+                           files[task] = std::move(mb);
+                         }));
+  }
 
   if (!bitcodeFiles.empty())
     checkError(ltoObj->run(
@@ -8,6 +8,7 @@
 
 #include "OutputSections.h"
 #include "Config.h"
+#include "Incremental.h"
 #include "LinkerScript.h"
 #include "SymbolTable.h"
 #include "SyntheticSections.h"
@@ -20,6 +21,7 @@
 #include "llvm/Support/MD5.h"
 #include "llvm/Support/MathExtras.h"
 #include "llvm/Support/SHA1.h"
+#include "llvm/Support/TimeProfiler.h"
 
 using namespace llvm;
 using namespace llvm::dwarf;
@@ -292,48 +294,127 @@ static void writeInt(uint8_t *buf, uint64_t data, uint64_t size) {
     llvm_unreachable("unsupported Size argument");
 }
 
-template <class ELFT> void OutputSection::writeTo(uint8_t *buf) {
-  if (type == SHT_NOBITS)
+// The contents of an output section to be written. Input sections can be
+// written independently of each other, so they are the unit of parallelism.
+struct SectionWrite {
+  OutputSection *sec;
+  uint8_t *buf;
+  std::vector<InputSection *> sections;
+  std::array<uint8_t, 4> filler;
+  bool nonZeroFiller;
+};
+
+// Writes the I-th input section of W and fills the gap after it.
+template <class ELFT> static void writeInputSection(SectionWrite &w, size_t i) {
+  InputSection *isec = w.sections[i];
+  if (!needsWrite(isec))
     return;
 
+  // Synthetic sections expect to be written to a zero-filled buffer, which
+  // is not the case when we are updating an existing output file.
+  bool inPlace = isIncrementalUpdate();
+  if (inPlace && isa<SyntheticSection>(isec))
+    memset(w.buf + isec->outSecOff, 0, isec->getSize());
+  isec->writeTo<ELFT>(w.buf);
+
+  // Fill gaps between sections. An existing output file may have stale
+  // bytes in the gaps, so fill them even if the filler is zero.
+  if (w.nonZeroFiller || inPlace) {
+    uint8_t *start = w.buf + isec->outSecOff + isec->getSize();
+    uint8_t *end;
+    if (i + 1 == w.sections.size())
+      end = w.buf + w.sec->size;
+    else
+      end = w.buf + w.sections[i + 1]->outSecOff;
+    fill(start, end - start, w.filler);
+  }
+}
+
+// Linker scripts may have BYTE()-family commands with which you
+// can write arbitrary bytes to the output. Process them if any.
+static void writeByteCommands(OutputSection *sec, uint8_t *buf) {
+  for (BaseCommand *base : sec->sectionCommands)
+    if (auto *data = dyn_cast<ByteCommand>(base))
+      writeInt(buf + data->offset, data->expression().getValue(), data->size);
+}
+
+// Writes the parts of an output section that are not input sections, except
+// BYTE()-family commands. Returns false if there is nothing else to write.
+template <class ELFT> bool OutputSection::prepareWrite(SectionWrite &w) {
+  if (type == SHT_NOBITS)
+    return false;
+
   // If -compress-debug-section is specified and if this is a debug seciton,
   // we've already compressed section contents. If that's the case,
   // just write it down.
   if (!compressedData.empty()) {
-    memcpy(buf, zDebugHeader.data(), zDebugHeader.size());
-    memcpy(buf + zDebugHeader.size(), compressedData.data(),
+    memcpy(w.buf, zDebugHeader.data(), zDebugHeader.size());
+    memcpy(w.buf + zDebugHeader.size(), compressedData.data(),
            compressedData.size());
-    return;
+    return false;
   }
 
   // Write leading padding.
-  std::vector<InputSection *> sections = getInputSections(this);
-  std::array<uint8_t, 4> filler = getFiller();
-  bool nonZeroFiller = read32(filler.data()) != 0;
-  if (nonZeroFiller)
-    fill(buf, sections.empty() ? size : sections[0]->outSecOff, filler);
-
-  parallelForEachN(0, sections.size(), [&](size_t i) {
-    InputSection *isec = sections[i];
-    isec->writeTo<ELFT>(buf);
-
-    // Fill gaps between sections.
-    if (nonZeroFiller) {
-      uint8_t *start = buf + isec->outSecOff + isec->getSize();
-      uint8_t *end;
-      if (i + 1 == sections.size())
-        end = buf + size;
-      else
-        end = buf + sections[i + 1]->outSecOff;
-      fill(start, end - start, filler);
+  w.sections = getInputSections(this);
+  w.filler = getFiller();
+  w.nonZeroFiller = read32(w.filler.data()) != 0;
+  if (w.nonZeroFiller || isIncrementalUpdate())
+    fill(w.buf, w.sections.empty() ? size : w.sections[0]->outSecOff,
+         w.filler);
+  return true;
+}
+
+template <class ELFT> void OutputSection::writeTo(uint8_t *buf) {
+  SectionWrite w{this, buf, {}, {}, false};
+  if (!prepareWrite<ELFT>(w))
+    return;
+  parallelForEachN(0, w.sections.size(),
+                   [&](size_t i) { writeInputSection<ELFT>(w, i); });
+  writeByteCommands(this, buf);
+}
+
+// Writing output sections one by one with writeTo() leaves threads idle
+// at the end of each output section, and the cost of starting a parallel
+// loop is not amortized for small output sections. This function writes the
+// input sections of all given output sections in a single parallel loop
+// instead. Output sections don't overlap in the output file, so they can be
+// written in any order.
+template <class ELFT>
+void writeOutputSections(ArrayRef<OutputSection *> outputSections) {
+  // The time trace profiler can only record events from one thread. Without
+  // threads, write output sections one by one so that each of them shows up
+  // in the trace.
+  if (!threadsEnabled) {
+    for (OutputSection *sec : outputSections) {
+      llvm::TimeTraceScope timeScope("Write output section", sec->name);
+      sec->writeTo<ELFT>(Out::bufferStart + sec->offset);
     }
+    return;
+  }
+
+  std::vector<SectionWrite> writes(outputSections.size());
+  parallelForEachN(0, outputSections.size(), [&](size_t i) {
+    OutputSection *sec = outputSections[i];
+    writes[i] = {sec, Out::bufferStart + sec->offset, {}, {}, false};
+    if (!sec->prepareWrite<ELFT>(writes[i]))
+      writes[i].sec = nullptr;
   });
 
-  // Linker scripts may have BYTE()-family commands with which you
-  // can write arbitrary bytes to the output. Process them if any.
-  for (BaseCommand *base : sectionCommands)
-    if (auto *data = dyn_cast<ByteCommand>(base))
-      writeInt(buf + data->offset, data->expression().getValue(), data->size);
+  // Flatten (output section, input section) pairs into one list of jobs.
+  std::vector<std::pair<uint32_t, uint32_t>> jobs;
+  for (size_t i = 0, e = writes.size(); i != e; ++i)
+    if (writes[i].sec)
+      for (size_t j = 0, f = writes[i].sections.size(); j != f; ++j)
+        jobs.push_back({i, j});
+
+  parallelForEachN(0, jobs.size(), [&](size_t i) {
+    writeInputSection<ELFT>(writes[jobs[i].first], jobs[i].second);
+  });
+
+  // BYTE()-family commands may overwrite fillers, so they are written last.
+  for (SectionWrite &w : writes)
+    if (w.sec)
+      writeByteCommands(w.sec, w.buf);
 }
 
 static void finalizeShtGroup(OutputSection *os,
@@ -492,6 +573,11 @@ template void OutputSection::writeTo<ELF32BE>(uint8_t *Buf);
 template void OutputSection::writeTo<ELF64LE>(uint8_t *Buf);
 template void OutputSection::writeTo<ELF64BE>(uint8_t *Buf);
 
+template void writeOutputSections<ELF32LE>(ArrayRef<OutputSection *>);
+template void writeOutputSections<ELF32BE>(ArrayRef<OutputSection *>);
+template void writeOutputSections<ELF64LE>(ArrayRef<OutputSection *>);
+template void writeOutputSections<ELF64BE>(ArrayRef<OutputSection *>);
+
 template void OutputSection::maybeCompress<ELF32LE>();
 template void OutputSection::maybeCompress<ELF32BE>();
 template void OutputSection::maybeCompress<ELF64LE>();
@@ -24,6 +24,7 @@ namespace elf {
 struct PhdrEntry;
 class InputSection;
 class InputSectionBase;
+struct SectionWrite;
 
 // This represents a section in an output file.
 // It is composed of multiple InputSections.
@@ -108,14 +109,25 @@ public:
   void sortInitFini();
   void sortCtorsDtors();
 
+  std::array<uint8_t, 4> getFiller();
+
 private:
   // Used for implementation of --compress-debug-sections option.
   std::vector<uint8_t> zDebugHeader;
   llvm::SmallVector<char, 1> compressedData;
 
-  std::array<uint8_t, 4> getFiller();
+  template <class ELFT> bool prepareWrite(SectionWrite &w);
+
+  template <class ELFT>
+  friend void writeOutputSections(ArrayRef<OutputSection *> outputSections);
 };
 
+// Writes the contents of the given output sections to the output buffer.
+// Equivalent to calling writeTo() for each of them, but makes better use of
+// threads if there are many small sections.
+template <class ELFT>
+void writeOutputSections(ArrayRef<OutputSection *> outputSections);
+
 int getPriority(StringRef s);
 
 std::vector<InputSection *> getInputSections(OutputSection* os);
@@ -52,6 +52,7 @@
 #include "lld/Common/ErrorHandler.h"
 #include "lld/Common/Memory.h"
 #include "lld/Common/Strings.h"
+#include "lld/Common/Threads.h"
 #include "llvm/ADT/SmallSet.h"
 #include "llvm/Support/Endian.h"
 #include "llvm/Support/raw_ostream.h"
@@ -1384,6 +1385,17 @@ static void scanReloc(InputSectionBase &sec, OffsetGetter &getOffset, RelTy *&i,
   processRelocAux<ELFT>(sec, expr, type, offset, sym, rel, addend);
 }
 
+// Sort relocations by offset for more efficient searching for
+// R_RISCV_PCREL_HI20 and R_PPC64_ADDR64.
+static void sortRelocations(InputSectionBase &sec) {
+  if (config->emachine == EM_RISCV ||
+      (config->emachine == EM_PPC64 && sec.name == ".toc"))
+    llvm::stable_sort(sec.relocations,
+                      [](const Relocation &lhs, const Relocation &rhs) {
+                        return lhs.offset < rhs.offset;
+                      });
+}
+
 template <class ELFT, class RelTy>
 static void scanRelocs(InputSectionBase &sec, ArrayRef<RelTy> rels) {
   OffsetGetter getOffset(sec);
@@ -1394,23 +1406,174 @@ static void scanRelocs(InputSectionBase &sec, ArrayRef<RelTy> rels) {
   for (auto i = rels.begin(), end = rels.end(); i != end;)
     scanReloc<ELFT>(sec, getOffset, i, end);
 
-  // Sort relocations by offset for more efficient searching for
-  // R_RISCV_PCREL_HI20 and R_PPC64_ADDR64.
-  if (config->emachine == EM_RISCV ||
-      (config->emachine == EM_PPC64 && sec.name == ".toc"))
-    llvm::stable_sort(sec.relocations,
-                      [](const Relocation &lhs, const Relocation &rhs) {
-                        return lhs.offset < rhs.offset;
-                      });
+  sortRelocations(sec);
 }
 
-template <class ELFT> void scanRelocations(InputSectionBase &s) {
+template <class ELFT> static void scanSection(InputSectionBase &s) {
   if (s.areRelocsRela)
     scanRelocs<ELFT>(s, s.relas<ELFT>());
   else
     scanRelocs<ELFT>(s, s.rels<ELFT>());
 }
 
+// Scanning relocations is done in two steps. The first step runs in parallel
+// and handles the relocations that only append a Relocation to their own
+// section, which are the vast majority in a typical link. Everything else
+// (GOT, PLT, copy relocations, dynamic relocations, TLS, ifuncs, diagnostics
+// for undefined symbols, ...) touches state shared between sections, so the
+// first step leaves such relocations alone. The second step then visits the
+// leftovers serially, in the same order as a purely serial scan would, and
+// splices the results into place. The output is therefore identical whether
+// or not threads are used.
+namespace {
+struct DeferredReloc {
+  // Index of the relocation in the section's relocation table.
+  uint32_t relIdx;
+  // Index in InputSectionBase::relocations the result should be inserted at.
+  uint32_t pos;
+};
+} // namespace
+
+// Tries to process a relocation without touching anything but Sec. Returns
+// false if the relocation needs to be processed by scanReloc() instead. The
+// conditions here must be conservative: a relocation may be handled only if
+// scanReloc() would have produced the same result regardless of what other
+// relocations did before it.
+template <class ELFT, class RelTy>
+static bool preScanReloc(InputSectionBase &sec, OffsetGetter &getOffset,
+                         const RelTy &rel, const RelTy *end) {
+  uint32_t symIndex = rel.getSymbol(config->isMips64EL);
+  Symbol &sym = sec.getFile<ELFT>()->getSymbol(symIndex);
+  if (sym.isUndefined() || sym.isGnuIFunc() || sym.isTls())
+    return false;
+
+  RelType type = rel.getType(config->isMips64EL);
+  uint64_t offset = getOffset.get(rel.r_offset);
+  if (offset == uint64_t(-1))
+    return true;
+
+  const uint8_t *relocatedAddr = sec.data().begin() + rel.r_offset;
+  RelExpr expr = target->getRelExpr(type, sym, relocatedAddr);
+  if (oneof<R_HINT, R_NONE>(expr))
+    return true;
+
+  int64_t addend = computeAddend<ELFT>(rel, end, sec, expr, sym.isLocal());
+
+  // Same relaxation as in scanReloc().
+  if (!sym.isPreemptible) {
+    if (expr == R_GOT_PC && !isAbsoluteValue(sym))
+      expr = target->adjustRelaxExpr(type, relocatedAddr, expr);
+    else
+      expr = fromPlt(expr);
+  }
+
+  // These need GOT or PLT entries or set flags on them.
+  if (needsPlt(expr) || needsGot(expr) ||
+      oneof<R_GOTPLTONLY_PC, R_GOTPLTREL, R_GOTPLT, R_TLSGD_GOTPLT,
+            R_GOTONLY_PC, R_GOTREL>(expr))
+    return false;
+
+  // isStaticLinkTimeConstant() may report an error for a relative relocation
+  // to an absolute symbol. Leave it to the serial step so that diagnostics are
+  // reported in a deterministic order.
+  if (isAbsoluteValue(sym) && isRelExpr(expr))
+    return false;
+
+  if (!isStaticLinkTimeConstant(expr, type, sym, sec, offset))
+    return false;
+
+  sec.relocations.push_back({expr, type, offset, addend, &sym});
+  return true;
+}
+
+template <class ELFT, class RelTy>
+static void preScanRelocs(InputSectionBase &sec, ArrayRef<RelTy> rels,
+                          std::vector<DeferredReloc> &deferred) {
+  OffsetGetter getOffset(sec);
+  sec.relocations.reserve(rels.size());
+
+  for (size_t i = 0, e = rels.size(); i != e; ++i) {
+    const RelTy &rel = rels[i];
+    if (preScanReloc<ELFT>(sec, getOffset, rel, rels.end()))
+      continue;
+    deferred.push_back({(uint32_t)i, (uint32_t)sec.relocations.size()});
+
+    // A TLS relocation may be relaxed together with the relocations following
+    // it, in which case scanReloc() skips them. Defer them as well so that
+    // they are never processed twice.
+    Symbol &sym =
+        sec.getFile<ELFT>()->getSymbol(rel.getSymbol(config->isMips64EL));
+    if (!sym.isTls())
+      continue;
+    int skip = target->getTlsGdRelaxSkip(rel.getType(config->isMips64EL));
+    for (; skip > 1 && i + 1 != e; --skip) {
+      ++i;
+      deferred.push_back({(uint32_t)i, (uint32_t)sec.relocations.size()});
+    }
+  }
+}
+
+template <class ELFT, class RelTy>
+static void scanDeferredRelocs(InputSectionBase &sec, ArrayRef<RelTy> rels,
+                               ArrayRef<DeferredReloc> deferred) {
+  if (!deferred.empty()) {
+    std::vector<Relocation> done = std::move(sec.relocations);
+    sec.relocations.clear();
+    sec.relocations.reserve(done.size() + deferred.size());
+
+    OffsetGetter getOffset(sec);
+    const RelTy *end = rels.end();
+    const RelTy *next = rels.begin();
+    uint32_t pos = 0;
+    for (const DeferredReloc &d : deferred) {
+      sec.relocations.insert(sec.relocations.end(), done.begin() + pos,
+                             done.begin() + d.pos);
+      pos = d.pos;
+
+      // Skip relocations that were consumed along with a preceding one.
+      const RelTy *i = rels.begin() + d.relIdx;
+      if (i < next)
+        continue;
+      scanReloc<ELFT>(sec, getOffset, i, end);
+      next = i;
+    }
+    sec.relocations.insert(sec.relocations.end(), done.begin() + pos,
+                           done.end());
+  }
+
+  sortRelocations(sec);
+}
+
+template <class ELFT>
+void scanRelocations(ArrayRef<InputSectionBase *> sections) {
+  // MIPS and PowerPC need target-specific bookkeeping for most relocations
+  // (multi-relocation records, MIPS GOT, TOC), so there is little to gain from
+  // the parallel step. Scan them serially.
+  if (config->emachine == EM_MIPS || config->emachine == EM_PPC ||
+      config->emachine == EM_PPC64) {
+    for (InputSectionBase *sec : sections)
+      scanSection<ELFT>(*sec);
+    return;
+  }
+
+  std::vector<std::vector<DeferredReloc>> deferred(sections.size());
+  parallelForEachN(0, sections.size(), [&](size_t i) {
+    InputSectionBase &sec = *sections[i];
+    if (sec.areRelocsRela)
+      preScanRelocs<ELFT>(sec, sec.relas<ELFT>(), deferred[i]);
+    else
+      preScanRelocs<ELFT>(sec, sec.rels<ELFT>(), deferred[i]);
+  });
+
+  for (size_t i = 0, e = sections.size(); i != e; ++i) {
+    InputSectionBase &sec = *sections[i];
+    if (sec.areRelocsRela)
+      scanDeferredRelocs<ELFT>(sec, sec.relas<ELFT>(), deferred[i]);
+    else
+      scanDeferredRelocs<ELFT>(sec, sec.rels<ELFT>(), deferred[i]);
+  }
+}
+
 static bool mergeCmp(const InputSection *a, const InputSection *b) {
   // std::merge requires a strict weak ordering.
   if (a->outSecOff < b->outSecOff)
@@ -1831,10 +1994,10 @@ bool ThunkCreator::createThunks(ArrayRef<OutputSection *> outputSections) {
   return addressesChanged;
 }
 
-template void scanRelocations<ELF32LE>(InputSectionBase &);
-template void scanRelocations<ELF32BE>(InputSectionBase &);
-template void scanRelocations<ELF64LE>(InputSectionBase &);
-template void scanRelocations<ELF64BE>(InputSectionBase &);
+template void scanRelocations<ELF32LE>(ArrayRef<InputSectionBase *>);
+template void scanRelocations<ELF32BE>(ArrayRef<InputSectionBase *>);
+template void scanRelocations<ELF64LE>(ArrayRef<InputSectionBase *>);
+template void scanRelocations<ELF64BE>(ArrayRef<InputSectionBase *>);
 template void reportUndefinedSymbols<ELF32LE>();
 template void reportUndefinedSymbols<ELF32BE>();
 template void reportUndefinedSymbols<ELF64LE>();
@@ -108,10 +108,15 @@ struct Relocation {
   Symbol *sym;
 };
 
+// Scans relocations of the given sections to create GOT/PLT entries, dynamic
+// relocations and so on. Parts of the work are done in parallel, but the
+// result does not depend on the number of threads.
+//
 // This function writes undefined symbol diagnostics to an internal buffer.
 // Call reportUndefinedSymbols() after calling scanRelocations() to emit
 // the diagnostics.
-template <class ELFT> void scanRelocations(InputSectionBase &);
+template <class ELFT>
+void scanRelocations(ArrayRef<InputSectionBase *> sections);
 
 template <class ELFT> void reportUndefinedSymbols();
 
@@ -33,12 +33,15 @@ SymbolTable *symtab;
 
 void SymbolTable::wrap(Symbol *sym, Symbol *real, Symbol *wrap) {
   // Swap symbols as instructed by -wrap.
-  int &idx1 = symMap[CachedHashStringRef(sym->getName())];
-  int &idx2 = symMap[CachedHashStringRef(real->getName())];
-  int &idx3 = symMap[CachedHashStringRef(wrap->getName())];
+  CachedHashStringRef name1(sym->getName());
+  CachedHashStringRef name2(real->getName());
+  CachedHashStringRef name3(wrap->getName());
+  Symbol *&sym1 = getShard(name1).map[name1];
+  Symbol *&sym2 = getShard(name2).map[name2];
+  Symbol *&sym3 = getShard(name3).map[name3];
 
-  idx2 = idx1;
-  idx1 = idx3;
+  sym2 = sym1;
+  sym1 = sym3;
 
   // Now renaming is complete. No one refers Real symbol. We could leave
   // Real as-is, but if Real is written to the symbol table, that may
@@ -48,28 +51,20 @@ void SymbolTable::wrap(Symbol *sym, Symbol *real, Symbol *wrap) {
   real->setName(s);
 }
 
-// Find an existing symbol or create a new one.
-Symbol *SymbolTable::insert(StringRef name) {
-  // <name>@@<version> means the symbol is the default version. In that
-  // case <name>@@<version> will be used to resolve references to <name>.
-  //
-  // Since this is a hot path, the following string search code is
-  // optimized for speed. StringRef::find(char) is much faster than
-  // StringRef::find(StringRef).
+// <name>@@<version> means the symbol is the default version. In that
+// case <name>@@<version> will be used to resolve references to <name>.
+//
+// Since this is a hot path, the following string search code is
+// optimized for speed. StringRef::find(char) is much faster than
+// StringRef::find(StringRef).
+static StringRef stripDefaultVersion(StringRef name) {
   size_t pos = name.find('@');
   if (pos != StringRef::npos && pos + 1 < name.size() && name[pos + 1] == '@')
-    name = name.take_front(pos);
-
-  auto p = symMap.insert({CachedHashStringRef(name), (int)symVector.size()});
-  int &symIndex = p.first->second;
-  bool isNew = p.second;
-
-  if (!isNew)
-    return symVector[symIndex];
-
-  Symbol *sym = reinterpret_cast<Symbol *>(make<SymbolUnion>());
-  symVector.push_back(sym);
+    return name.take_front(pos);
+  return name;
+}
 
+static void initPlaceholder(Symbol *sym, StringRef name) {
   // *sym was not initialized by a constructor. Fields that may get referenced
   // when it is a placeholder must be initialized here.
   sym->setName(name);
@@ -83,7 +78,41 @@ Symbol *SymbolTable::insert(StringRef name) {
   sym->referenced = false;
   sym->traced = false;
   sym->scriptDefined = false;
+  sym->inSymVector = false;
   sym->partition = 1;
+}
+
+// Find an existing symbol or create a new one.
+Symbol *SymbolTable::insert(StringRef name) {
+  CachedHashStringRef key(stripDefaultVersion(name));
+  auto p = getShard(key).map.insert({key, nullptr});
+  Symbol *&sym = p.first->second;
+
+  if (!p.second) {
+    // The symbol may have been created by insertConcurrent().
+    markInserted(sym);
+    return sym;
+  }
+
+  sym = reinterpret_cast<Symbol *>(make<SymbolUnion>());
+  initPlaceholder(sym, key.val());
+  markInserted(sym);
+  return sym;
+}
+
+Symbol *SymbolTable::insertConcurrent(StringRef name) {
+  CachedHashStringRef key(stripDefaultVersion(name));
+  Shard &shard = getShard(key);
+  std::lock_guard<std::mutex> lock(shard.mu);
+
+  auto p = shard.map.insert({key, nullptr});
+  Symbol *&sym = p.first->second;
+  if (!p.second)
+    return sym;
+
+  // make() is not thread-safe, so allocate from the shard.
+  sym = reinterpret_cast<Symbol *>(shard.alloc.Allocate<SymbolUnion>());
+  initPlaceholder(sym, key.val());
   return sym;
 }
 
@@ -94,10 +123,12 @@ Symbol *SymbolTable::addSymbol(const Symbol &newSym) {
 }
 
 Symbol *SymbolTable::find(StringRef name) {
-  auto it = symMap.find(CachedHashStringRef(name));
-  if (it == symMap.end())
+  CachedHashStringRef key(name);
+  Shard &shard = getShard(key);
+  auto it = shard.map.find(key);
+  if (it == shard.map.end())
     return nullptr;
-  Symbol *sym = symVector[it->second];
+  Symbol *sym = it->second;
   if (sym->isPlaceholder())
     return nullptr;
   return sym;
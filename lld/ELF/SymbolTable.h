@@ -15,6 +15,8 @@
 #include "llvm/ADT/CachedHashString.h"
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/STLExtras.h"
+#include "llvm/Support/Allocator.h"
+#include <mutex>
 
 namespace lld {
 namespace elf {
@@ -43,6 +45,21 @@ public:
 
   Symbol *insert(StringRef name);
 
+  // Like insert(), but may be called from multiple threads at once. The
+  // returned symbol does not become visible to find() or forEachSymbol()
+  // until it is passed to insert() or markInserted() on the main thread,
+  // so that the order of symbols does not depend on thread scheduling.
+  Symbol *insertConcurrent(StringRef name);
+
+  // Makes a symbol returned by insertConcurrent() visible as if it had been
+  // created by insert() at this point. Does nothing for other symbols.
+  void markInserted(Symbol *sym) {
+    if (!sym->inSymVector) {
+      sym->inSymVector = true;
+      symVector.push_back(sym);
+    }
+  }
+
   Symbol *addSymbol(const Symbol &newSym);
 
   void scanVersionScript();
@@ -68,14 +85,31 @@ private:
                           StringRef versionName);
   void assignWildcardVersion(SymbolVersion ver, uint16_t versionId);
 
+  // The symbol map is split into shards by name hash. Each shard has its own
+  // lock and allocator so that object files can insert their symbols in
+  // parallel. The lock is only taken by insertConcurrent().
+  struct Shard {
+    std::mutex mu;
+    llvm::DenseMap<llvm::CachedHashStringRef, Symbol *> map;
+    llvm::BumpPtrAllocator alloc;
+  };
+
+  static constexpr unsigned numShards = 64;
+
+  Shard &getShard(llvm::CachedHashStringRef name) {
+    // DenseMap uses the low bits of the hash, so use the high bits here.
+    return shards[name.hash() >> 26];
+  }
+
+  Shard shards[numShards];
+
   // The order the global symbols are in is not defined. We can use an arbitrary
   // order, but it has to be reproducible. That is true even when cross linking.
   // The default hashing of StringRef produces different results on 32 and 64
-  // bit systems so we use a map to a vector. That is arbitrary, deterministic
-  // but a bit inefficient.
+  // bit systems so we keep symbols in a vector in the order they are inserted.
+  // That is arbitrary, deterministic but a bit inefficient.
   // FIXME: Experiment with passing in a custom hashing or sorting the symbols
   // once symbol resolution is finished.
-  llvm::DenseMap<llvm::CachedHashStringRef, int> symMap;
   std::vector<Symbol *> symVector;
 
   // A map from demangled symbol names to their symbol objects.
@@ -243,7 +243,7 @@ protected:
         canInline(false), referenced(false), traced(false), needsPltAddr(false),
         isInIplt(false), gotInIgot(false), isPreemptible(false),
         used(!config->gcSections), needsTocRestore(false),
-        scriptDefined(false) {}
+        scriptDefined(false), inSymVector(false) {}
 
 public:
   // True the symbol should point to its PLT entry.
@@ -271,6 +271,10 @@ public:
   // True if this symbol is defined by a linker script.
   unsigned scriptDefined : 1;
 
+  // True if this symbol has been added to the symbol table's list of symbols.
+  // See SymbolTable::insertConcurrent().
+  unsigned inSymVector : 1;
+
   // The partition whose dynamic symbol table contains this symbol's definition.
   uint8_t partition = 1;
 
@@ -546,6 +550,7 @@ void Symbol::replace(const Symbol &newSym) {
   traced = old.traced;
   isPreemptible = old.isPreemptible;
   scriptDefined = old.scriptDefined;
+  inSymVector = old.inSymVector;
   partition = old.partition;
 
   // Symbol length is computed lazily. If we already know a symbol length,
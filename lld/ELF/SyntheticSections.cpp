@@ -3036,31 +3036,82 @@ void MergeSyntheticSection::addSection(MergeInputSection *ms) {
 
 MergeTailSection::MergeTailSection(StringRef name, uint32_t type,
                                    uint64_t flags, uint32_t alignment)
-    : MergeSyntheticSection(name, type, flags, alignment),
-      builder(StringTableBuilder::RAW, alignment) {}
+    : MergeSyntheticSection(name, type, flags, alignment) {}
 
-size_t MergeTailSection::getSize() const { return builder.getSize(); }
+void MergeTailSection::writeTo(uint8_t *buf) {
+  for (size_t i = 0; i < numShards; ++i)
+    shards[i].write(buf + shardOffsets[i]);
+}
 
-void MergeTailSection::writeTo(uint8_t *buf) { builder.write(buf); }
+// Returns a shard ID for a null-terminated string S whose characters are
+// ENTSIZE bytes long. If S is a suffix of T, their last characters must
+// be the same, so they get the same shard ID. The empty string is a suffix
+// of every string, so it always goes to shard 0.
+static size_t getTailShardId(StringRef s, size_t entSize, size_t numShards) {
+  if (s.size() <= entSize)
+    return 0;
+  return (uint8_t)s[s.size() - entSize - 1] % numShards;
+}
 
+// Tail merging is much more expensive than the plain deduplication done by
+// MergeNoTailSection, as it has to sort all strings to find suffixes. Since
+// a string can only be merged with strings that share its last character,
+// we shard strings by it and tail-merge the shards in parallel.
 void MergeTailSection::finalizeContents() {
-  // Add all string pieces to the string table builder to create section
-  // contents.
-  for (MergeInputSection *sec : sections)
-    for (size_t i = 0, e = sec->pieces.size(); i != e; ++i)
-      if (sec->pieces[i].live)
-        builder.add(sec->getData(i));
+  for (size_t i = 0; i < numShards; ++i)
+    shards.emplace_back(StringTableBuilder::RAW, alignment);
+
+  // Concurrency level. Must be a power of 2 to avoid expensive modulo
+  // operations in the following tight loop.
+  size_t concurrency = 1;
+  if (threadsEnabled)
+    concurrency =
+        std::min<size_t>(PowerOf2Floor(hardware_concurrency()), numShards);
+
+  // Add all string pieces to the string table builders. Each thread adds
+  // strings in the same order as a single-threaded run would, so the output
+  // is deterministic.
+  parallelForEachN(0, concurrency, [&](size_t threadId) {
+    for (MergeInputSection *sec : sections) {
+      size_t entSize = std::max<size_t>(sec->entsize, 1);
+      for (size_t i = 0, e = sec->pieces.size(); i != e; ++i) {
+        if (!sec->pieces[i].live)
+          continue;
+        CachedHashStringRef data = sec->getData(i);
+        size_t shardId = getTailShardId(data.val(), entSize, numShards);
+        if ((shardId & (concurrency - 1)) == threadId)
+          shards[shardId].add(data);
+      }
+    }
+  });
 
-  // Fix the string table content. After this, the contents will never change.
-  builder.finalize();
+  // Fix the string table contents. After this, they will never change.
+  parallelForEachN(0, numShards, [&](size_t i) { shards[i].finalize(); });
+
+  // Compute an in-section offset for each shard.
+  size_t off = 0;
+  for (size_t i = 0; i < numShards; ++i) {
+    if (shards[i].getSize() > 0)
+      off = alignTo(off, alignment);
+    shardOffsets[i] = off;
+    off += shards[i].getSize();
+  }
+  size = off;
 
   // finalize() fixed tail-optimized strings, so we can now get
   // offsets of strings. Get an offset for each string and save it
   // to a corresponding SectionPiece for easy access.
-  for (MergeInputSection *sec : sections)
-    for (size_t i = 0, e = sec->pieces.size(); i != e; ++i)
-      if (sec->pieces[i].live)
-        sec->pieces[i].outputOff = builder.getOffset(sec->getData(i));
+  parallelForEach(sections, [&](MergeInputSection *sec) {
+    size_t entSize = std::max<size_t>(sec->entsize, 1);
+    for (size_t i = 0, e = sec->pieces.size(); i != e; ++i) {
+      if (!sec->pieces[i].live)
+        continue;
+      CachedHashStringRef data = sec->getData(i);
+      size_t shardId = getTailShardId(data.val(), entSize, numShards);
+      sec->pieces[i].outputOff =
+          shardOffsets[shardId] + shards[shardId].getOffset(data);
+    }
+  });
 }
 
 void MergeNoTailSection::writeTo(uint8_t *buf) {
@@ -851,12 +851,20 @@ public:
   MergeTailSection(StringRef name, uint32_t type, uint64_t flags,
                    uint32_t alignment);
 
-  size_t getSize() const override;
+  size_t getSize() const override { return size; }
   void writeTo(uint8_t *buf) override;
   void finalizeContents() override;
 
 private:
-  llvm::StringTableBuilder builder;
+  // Section size
+  size_t size;
+
+  // String table contents. A string can only be a suffix of strings that
+  // end with the same character, so strings are sharded by their last
+  // character and each shard is tail-merged independently.
+  constexpr static size_t numShards = 32;
+  std::vector<llvm::StringTableBuilder> shards;
+  size_t shardOffsets[numShards];
 };
 
 class MergeNoTailSection final : public MergeSyntheticSection {
@@ -11,6 +11,7 @@
 #include "ARMErrataFix.h"
 #include "CallGraphSort.h"
 #include "Config.h"
+#include "Incremental.h"
 #include "LinkerScript.h"
 #include "MapFile.h"
 #include "OutputSections.h"
@@ -27,6 +28,7 @@
 #include "llvm/ADT/StringSwitch.h"
 #include "llvm/Support/RandomNumberGenerator.h"
 #include "llvm/Support/SHA1.h"
+#include "llvm/Support/TimeProfiler.h"
 #include "llvm/Support/xxhash.h"
 #include <climits>
 
@@ -542,6 +544,9 @@ template <class ELFT> void createSyntheticSections() {
 
 // The main function of the writer.
 template <class ELFT> void Writer<ELFT>::run() {
+  if (config->incremental)
+    readIncrementalState();
+
   if (config->discard != DiscardPolicy::All)
     copyLocalSymbols();
 
@@ -552,7 +557,10 @@ template <class ELFT> void Writer<ELFT>::run() {
   // completes section contents. For example, we need to add strings
   // to the string table, and add entries to .got and .plt.
   // finalizeSections does that.
-  finalizeSections();
+  {
+    llvm::TimeTraceScope timeScope("Finalize sections", StringRef(""));
+    finalizeSections();
+  }
   checkExecuteOnly();
   if (errorCount())
     return;
@@ -590,6 +598,11 @@ template <class ELFT> void Writer<ELFT>::run() {
   // It does not make sense try to open the file if we have error already.
   if (errorCount())
     return;
+
+  // With --incremental, find out if we can update the existing output.
+  if (config->incremental)
+    prepareIncrementalUpdate<ELFT>(fileSize);
+
   // Write the result down to a file.
   openFile();
   if (errorCount())
@@ -600,6 +613,7 @@ template <class ELFT> void Writer<ELFT>::run() {
       writeTrapInstr();
     writeHeader();
     writeSections();
+    clearIncrementalSlack();
   } else {
     writeSectionsBinary();
   }
@@ -616,8 +630,13 @@ template <class ELFT> void Writer<ELFT>::run() {
   if (errorCount())
     return;
 
-  if (auto e = buffer->commit())
+  if (auto e = buffer->commit()) {
     error("failed to write to the output file: " + toString(std::move(e)));
+    return;
+  }
+
+  if (config->incremental)
+    writeIncrementalState();
 }
 
 static bool shouldKeepInSymtab(const Defined &sym) {
@@ -1746,7 +1765,10 @@ template <class ELFT> void Writer<ELFT>::finalizeSections() {
   // after processSymbolAssignments() because it needs to know whether a
   // linker-script-defined symbol is absolute.
   if (!config->relocatable) {
-    forEachRelSec(scanRelocations<ELFT>);
+    llvm::TimeTraceScope timeScope("Scan relocations", StringRef(""));
+    std::vector<InputSectionBase *> relSections;
+    forEachRelSec([&](InputSectionBase &sec) { relSections.push_back(&sec); });
+    scanRelocations<ELFT>(relSections);
     reportUndefinedSymbols<ELFT>();
   }
 
@@ -2348,6 +2370,12 @@ template <class ELFT> void Writer<ELFT>::assignFileOffsets() {
   for (OutputSection *sec : outputSections) {
     off = setFileOffset(sec, off);
 
+    // With --incremental, leave room for non-SHF_ALLOC sections to grow so
+    // that the sections following them keep their file offsets.
+    if (config->incremental && !(sec->flags & SHF_ALLOC) &&
+        sec->type != SHT_NOBITS)
+      off = sec->offset + getIncrementalSize(sec);
+
     // If this is a last section of the last executable segment and that
     // segment is the last loadable segment, align the offset of the
     // following section to avoid loading non-segments parts of the file.
@@ -2590,10 +2618,14 @@ template <class ELFT> void Writer<ELFT>::openFile() {
     return;
   }
 
-  unlinkAsync(config->outputFile);
+  // If we are updating the existing output in place, we must not remove it.
   unsigned flags = 0;
+  if (isIncrementalUpdate())
+    flags = FileOutputBuffer::F_modify;
+  else
+    unlinkAsync(config->outputFile);
   if (!config->relocatable)
-    flags = FileOutputBuffer::F_executable;
+    flags |= FileOutputBuffer::F_executable;
   Expected<std::unique_ptr<FileOutputBuffer>> bufferOrErr =
       FileOutputBuffer::create(config->outputFile, fileSize, flags);
 
@@ -2649,16 +2681,22 @@ template <class ELFT> void Writer<ELFT>::writeTrapInstr() {
 
 // Write section contents to a mmap'ed file.
 template <class ELFT> void Writer<ELFT>::writeSections() {
+  llvm::TimeTraceScope timeScope("Write output sections", StringRef(""));
+
   // In -r or -emit-relocs mode, write the relocation sections first as in
   // ELf_Rel targets we might find out that we need to modify the relocated
   // section while doing it.
-  for (OutputSection *sec : outputSections)
+  std::vector<OutputSection *> relSections;
+  std::vector<OutputSection *> otherSections;
+  for (OutputSection *sec : outputSections) {
     if (sec->type == SHT_REL || sec->type == SHT_RELA)
-      sec->writeTo<ELFT>(Out::bufferStart + sec->offset);
+      relSections.push_back(sec);
+    else
+      otherSections.push_back(sec);
+  }
 
-  for (OutputSection *sec : outputSections)
-    if (sec->type != SHT_REL && sec->type != SHT_RELA)
-      sec->writeTo<ELFT>(Out::bufferStart + sec->offset);
+  writeOutputSections<ELFT>(relSections);
+  writeOutputSections<ELFT>(otherSections);
 }
 
 // Split one uint8 array into small pieces of uint8 arrays.
@@ -245,9 +245,8 @@ static void setRelocs(const std::vector<T *> &chunks,
   }
 }
 
-void ObjFile::parse(bool ignoreComdats) {
+void ObjFile::decode() {
   // Parse a memory buffer as a wasm file.
-  LLVM_DEBUG(dbgs() << "Parsing object: " << toString(this) << "\n");
   std::unique_ptr<Binary> bin = CHECK(createBinary(mb), toString(this));
 
   auto *obj = dyn_cast<WasmObjectFile>(bin.get());
@@ -258,6 +257,12 @@ void ObjFile::parse(bool ignoreComdats) {
 
   bin.release();
   wasmObj.reset(obj);
+}
+
+void ObjFile::parse(bool ignoreComdats) {
+  LLVM_DEBUG(dbgs() << "Parsing object: " << toString(this) << "\n");
+  if (!wasmObj)
+    decode();
 
   // Build up a map of function indices to table indices for use when
   // verifying the existing table index relocations
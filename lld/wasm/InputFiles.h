@@ -97,6 +97,11 @@ public:
 
   void parse(bool ignoreComdats = false);
 
+  // Decodes the wasm object. This is the expensive part of parse(), and it
+  // does not touch the symbol table, so different files can be decoded in
+  // parallel. parse() does this itself if it has not been done yet.
+  void decode();
+
   // Returns the underlying wasm file.
   const WasmObjectFile *getWasmObj() const { return wasmObj.get(); }
 
@@ -527,7 +527,12 @@ public:
 
   const FileSpec &GetSymbolFileFileSpec() const { return m_symfile_spec; }
 
-  void PreloadSymbols();
+  /// Parses the symbol table of this module ahead of time.
+  ///
+  /// \param[in] index_debug_info
+  ///     If true, the symbol file also indexes the debug information now
+  ///     instead of on the first lookup.
+  void PreloadSymbols(bool index_debug_info = true);
 
   void SetSymbolFileFileSpec(const FileSpec &file);
 
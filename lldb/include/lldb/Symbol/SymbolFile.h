@@ -232,6 +232,10 @@ public:
   /// for this module have been changed.
   virtual void SectionFileAddressesChanged();
 
+  /// Returns the number of bytes that the debug information that is
+  /// currently parsed into memory uses, e.g. the DIEs of DWARF units.
+  virtual uint64_t GetParsedDebugInfoMemorySize() { return 0; }
+
   struct RegisterInfoResolver {
     virtual ~RegisterInfoResolver(); // anchor
 
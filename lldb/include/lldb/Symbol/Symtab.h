@@ -189,10 +189,19 @@ private:
   void SymbolIndicesToSymbolContextList(std::vector<uint32_t> &symbol_indexes,
                                         SymbolContextList &sc_list);
 
+  /// The name index entries of a range of symbols.
+  struct NameIndexBatch;
+
+  /// Demangles the symbols in [begin, end) and collects their name index
+  /// entries in \p batch. Batches of disjoint ranges can be collected in
+  /// parallel.
+  void CollectNameIndexEntries(uint32_t begin, uint32_t end,
+                               NameIndexBatch &batch);
+
   void RegisterMangledNameEntry(
-      uint32_t value, std::set<const char *> &class_contexts,
-      std::vector<std::pair<NameToIndexMap::Entry, const char *>> &backlog,
-      RichManglingContext &rmc);
+      const NameToIndexMap::Entry &entry, const char *decl_context,
+      bool is_ctor_or_dtor, std::set<const char *> &class_contexts,
+      std::vector<std::pair<NameToIndexMap::Entry, const char *>> &backlog);
 
   void RegisterBacklogEntry(const NameToIndexMap::Entry &entry,
                             const char *decl_context,
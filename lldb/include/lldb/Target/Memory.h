@@ -31,6 +31,10 @@ public:
 
   size_t Read(lldb::addr_t addr, void *dst, size_t dst_len, Status &error);
 
+  // Read the cache lines that cover [addr, addr + size) and aren't cached
+  // yet, with a single Process::ReadMemoryRangesFromInferior() call.
+  void Prefetch(lldb::addr_t addr, size_t size);
+
   uint32_t GetMemoryCacheLineSize() const { return m_L2_cache_line_byte_size; }
 
   void AddInvalidRange(lldb::addr_t base_addr, lldb::addr_t byte_size);
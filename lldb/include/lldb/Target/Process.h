@@ -1424,6 +1424,22 @@ public:
   virtual size_t DoReadMemory(lldb::addr_t vm_addr, void *buf, size_t size,
                               Status &error) = 0;
 
+  /// Actually do the reading of several ranges of memory from a process.
+  ///
+  /// Subclasses that can read several ranges with a single request to the
+  /// process should override this function. The default implementation
+  /// reads the ranges one by one with DoReadMemory().
+  ///
+  /// \param[in] ranges
+  ///     The ranges of virtual load addresses to read.
+  ///
+  /// \return
+  ///     One buffer per range. A buffer is shorter than its range if only
+  ///     the start of the range could be read, and empty if none of it
+  ///     could be read.
+  virtual std::vector<lldb::DataBufferSP>
+  DoReadMemoryRanges(llvm::ArrayRef<Range<lldb::addr_t, lldb::addr_t>> ranges);
+
   /// Read of memory from a process.
   ///
   /// This function will read memory from the current process's address space
@@ -1490,6 +1506,23 @@ public:
   size_t ReadMemoryFromInferior(lldb::addr_t vm_addr, void *buf, size_t size,
                                 Status &error);
 
+  /// Read the memory of several ranges from the process, bypassing the
+  /// memory cache, and remove any traps that may have been inserted into the
+  /// memory.
+  ///
+  /// \see DoReadMemoryRanges()
+  std::vector<lldb::DataBufferSP> ReadMemoryRangesFromInferior(
+      llvm::ArrayRef<Range<lldb::addr_t, lldb::addr_t>> ranges);
+
+  /// Read the memory in [\a vm_addr, \a vm_addr + \a size) into the memory
+  /// cache, with as few requests to the process as possible.
+  ///
+  /// Clients that know that they will read many small pieces of a block of
+  /// memory, like the data formatter of a container that is about to read
+  /// its elements, should call this first. It does nothing if the memory
+  /// cache is disabled.
+  void PrefetchMemory(lldb::addr_t vm_addr, size_t size);
+
   /// Read a NULL terminated string from memory
   ///
   /// This function will read a cache page at a time until a NULL string
@@ -88,6 +88,8 @@ public:
 
   void SetPreloadSymbols(bool b);
 
+  bool GetPreloadDebugInfo() const;
+
   bool GetDisableASLR() const;
 
   void SetDisableASLR(bool b);
@@ -802,6 +804,25 @@ public:
 
   void ModulesDidLoad(ModuleList &module_list);
 
+  /// Batches the work of loading many modules at once.
+  ///
+  /// While a batch is alive, GetOrCreateModule() neither preloads the symbols
+  /// of the modules it creates nor notifies anyone about them. When the last
+  /// batch goes away, the symbols of all new modules are preloaded in
+  /// parallel and ModulesDidLoad() is called once for all of them. Dynamic
+  /// loaders use this when they load the shared libraries of a process.
+  class ModuleLoadBatch {
+  public:
+    ModuleLoadBatch(Target &target);
+    ~ModuleLoadBatch();
+
+  private:
+    ModuleLoadBatch(const ModuleLoadBatch &) = delete;
+    const ModuleLoadBatch &operator=(const ModuleLoadBatch &) = delete;
+
+    Target &m_target;
+  };
+
   void ModulesDidUnload(ModuleList &module_list, bool delete_locations);
 
   void SymbolsDidLoad(ModuleList &module_list);
@@ -1329,6 +1350,17 @@ protected:
   bool m_suppress_stop_hooks;
   bool m_is_dummy_target;
   unsigned m_next_persistent_variable_index = 0;
+  /// The number of live ModuleLoadBatch objects.
+  uint32_t m_module_load_batch_depth = 0;
+  /// The modules created during a ModuleLoadBatch whose symbols should be
+  /// preloaded, and those that were added to m_images, when it ends.
+  std::vector<lldb::ModuleSP> m_batch_modules_to_preload;
+  ModuleList m_batch_modules_to_notify;
+
+  /// Preloads the symbols of \p modules, in parallel if there are several.
+  void PreloadModuleSymbols(llvm::ArrayRef<lldb::ModuleSP> modules);
+
+  void EndModuleLoadBatch();
 
   static void ImageSearchPathsChanged(const PathMappingList &path_list,
                                       void *baton);
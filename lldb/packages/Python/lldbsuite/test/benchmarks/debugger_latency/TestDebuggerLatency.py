@@ -0,0 +1,187 @@
+"""
+Measure the latency of common debugger operations on a large synthetic
+program: creating a target, attaching, resolving a breakpoint by name,
+'frame variable' and stepping over a line.
+
+The program is built once per debug info flavor. The results are printed and
+written as JSON to the file named by LLDB_BENCHMARK_RESULTS, or to
+'latency.json' in the build directory, so that they can be tracked over time.
+"""
+
+from __future__ import print_function
+
+import json
+import os
+import time
+
+import lldb
+from lldbsuite.test.decorators import *
+from lldbsuite.test.lldbbench import *
+from lldbsuite.test.lldbtest import *
+import lldbsuite.test.lldbutil as lldbutil
+
+
+class DebuggerLatencyBench(BenchBase):
+
+    mydir = TestBase.compute_mydir(__file__)
+
+    # The size of the synthetic program.
+    num_units = 50
+    functions_per_unit = 200
+
+    # The number of times each operation is measured.
+    count = 10
+
+    # Extra compiler flags for each debug info flavor.
+    flavors = [
+        ('dwarf4', '-gdwarf-4'),
+        ('dwarf5', '-gdwarf-5'),
+        ('split-dwarf', '-gdwarf-5 -gsplit-dwarf'),
+        ('debug-names', '-gdwarf-5 -gpubnames'),
+    ]
+
+    def setUp(self):
+        BenchBase.setUp(self)
+        self.results = {}
+
+    def generate_sources(self):
+        """Write the synthetic translation units into the build directory and
+        return their names."""
+        self.makeBuildDir()
+        sources = []
+        for unit in range(self.num_units):
+            name = 'synthetic_%d.cpp' % unit
+            with open(self.getBuildArtifact(name), 'w') as f:
+                f.write('namespace unit%d {\n' % unit)
+                f.write('struct Record {\n  int id;\n  long value;\n'
+                        '  const char *name;\n};\n')
+                for func in range(self.functions_per_unit):
+                    f.write('int function_%d(int x) {\n' % func)
+                    f.write('  Record r = {x, x * %dL, "f%d"};\n' %
+                            (func, func))
+                    f.write('  return r.id + static_cast<int>(r.value);\n}\n')
+                f.write('}\n')
+                f.write('int unit%d_entry(int x) {\n  int sum = 0;\n' % unit)
+                for func in range(self.functions_per_unit):
+                    f.write('  sum += unit%d::function_%d(x);\n' %
+                            (unit, func))
+                f.write('  return sum;\n}\n')
+            sources.append(name)
+
+        with open(self.getBuildArtifact('synthetic_entry.cpp'), 'w') as f:
+            for unit in range(self.num_units):
+                f.write('int unit%d_entry(int x);\n' % unit)
+            f.write('int synthetic_entry(int x) {\n  int sum = 0;\n')
+            for unit in range(self.num_units):
+                f.write('  sum += unit%d_entry(x);\n' % unit)
+            f.write('  return sum;\n}\n')
+        sources.append('synthetic_entry.cpp')
+        return sources
+
+    def measure(self, flavor, operation, setup, body, teardown=None):
+        """Run body() self.count times, each after a fresh setup(), and
+        record the average and the individual times in seconds."""
+        samples = []
+        for _ in range(self.count):
+            state = setup()
+            start = time.time()
+            body(state)
+            samples.append(time.time() - start)
+            if teardown:
+                teardown(state)
+        self.results.setdefault(flavor, {})[operation] = {
+            'average': sum(samples) / len(samples),
+            'samples': samples,
+        }
+
+    def fresh_target(self, exe):
+        # Drop the modules of the previous iteration, so that every
+        # measurement has to parse the debug info again.
+        self.dbg.DeleteTarget(self.dbg.GetSelectedTarget())
+        lldb.SBDebugger.MemoryPressureDetected()
+        return exe
+
+    def create_target(self, exe):
+        target = self.dbg.CreateTarget(exe)
+        self.assertTrue(target, VALID_TARGET)
+        return target
+
+    def stop_at_step_target(self, exe_name):
+        self.fresh_target(exe_name)
+        _, _, thread, _ = lldbutil.run_to_name_breakpoint(
+            self, 'step_target', exe_name=exe_name)
+        return thread
+
+    def kill(self, _):
+        self.dbg.GetSelectedTarget().GetProcess().Kill()
+
+    def run_flavor(self, flavor, flags, sources):
+        exe_name = 'a.out.%s' % flavor
+        self.build(dictionary={
+            'EXE': exe_name,
+            'SYNTHETIC_SOURCES': ' '.join(sources),
+            'CFLAGS_EXTRAS': flags,
+        })
+        exe = self.getBuildArtifact(exe_name)
+
+        self.measure(flavor, 'target create', lambda: self.fresh_target(exe),
+                     self.create_target)
+
+        def breakpoint_by_name(target):
+            bkpt = target.BreakpointCreateByName('unit0::function_0')
+            self.assertTrue(bkpt.GetNumLocations() > 0)
+        self.measure(flavor, 'breakpoint by name',
+                     lambda: self.create_target(self.fresh_target(exe)),
+                     breakpoint_by_name)
+
+        def spawn():
+            target = self.create_target(self.fresh_target(exe))
+            token = self.getBuildArtifact('%s.token' % exe_name)
+            if os.path.exists(token):
+                os.remove(token)
+            popen = self.spawnSubprocess(exe, [token])
+            lldbutil.wait_for_file_on_target(self, token)
+            return target, popen.pid
+
+        def attach(state):
+            target, pid = state
+            error = lldb.SBError()
+            process = target.AttachToProcessWithID(self.dbg.GetListener(),
+                                                   pid, error)
+            self.assertTrue(error.Success() and process, PROCESS_IS_VALID)
+        self.measure(flavor, 'attach', spawn, attach, self.kill)
+
+        def frame_variable(thread):
+            result = lldb.SBCommandReturnObject()
+            self.dbg.GetCommandInterpreter().HandleCommand('frame variable',
+                                                           result)
+            self.assertTrue(result.Succeeded())
+        self.measure(flavor, 'frame variable',
+                     lambda: self.stop_at_step_target(exe_name),
+                     frame_variable, self.kill)
+
+        def step_over(thread):
+            thread.StepOver()
+            self.assertEqual(thread.GetStopReason(),
+                             lldb.eStopReasonPlanComplete)
+        self.measure(flavor, 'step over',
+                     lambda: self.stop_at_step_target(exe_name), step_over,
+                     self.kill)
+
+    @benchmarks_test
+    @skipIfRemote
+    @skipIfWindows
+    def test_debugger_latency(self):
+        """Measure the latency of common debugger operations."""
+        sources = self.generate_sources()
+        self.addTearDownHook(self.cleanupSubprocesses)
+        self.dbg.SetAsync(False)
+
+        for flavor, flags in self.flavors:
+            self.run_flavor(flavor, flags, sources)
+
+        path = os.environ.get('LLDB_BENCHMARK_RESULTS',
+                              self.getBuildArtifact('latency.json'))
+        with open(path, 'w') as f:
+            json.dump(self.results, f, indent=2, sort_keys=True)
+        print(json.dumps(self.results, indent=2, sort_keys=True))
@@ -0,0 +1,36 @@
+#include <chrono>
+#include <cstdio>
+#include <thread>
+
+// Defined in the generated sources.
+int synthetic_entry(int seed);
+
+struct Point {
+  int x;
+  int y;
+};
+
+int step_target(int seed) {
+  Point origin = {seed, seed + 1};
+  int values[4] = {1, 2, 3, 4};
+  int sum = origin.x + origin.y; // Step over this line.
+  for (int v : values)
+    sum += v;
+  sum += synthetic_entry(seed);
+  return sum;
+}
+
+int main(int argc, char const *argv[]) {
+  lldb_enable_attach();
+
+  if (argc > 1) {
+    // Create the synchronization token and wait to be attached to.
+    if (FILE *f = fopen(argv[1], "wx")) {
+      fputs("\n", f);
+      fclose(f);
+    }
+    while (true)
+      std::this_thread::sleep_for(std::chrono::seconds(1));
+  }
+  return step_target(argc) == 0;
+}
@@ -7,9 +7,11 @@
 //===----------------------------------------------------------------------===//
 
 #include "CommandObjectStats.h"
+#include "lldb/Core/Module.h"
 #include "lldb/Host/Host.h"
 #include "lldb/Interpreter/CommandInterpreter.h"
 #include "lldb/Interpreter/CommandReturnObject.h"
+#include "lldb/Symbol/SymbolFile.h"
 #include "lldb/Target/Target.h"
 
 using namespace lldb;
@@ -86,6 +88,19 @@ protected:
           stat);
       i += 1;
     }
+
+    // Don't parse any debug information just to report how much memory it
+    // uses.
+    uint64_t debug_info_size = 0;
+    target.GetImages().ForEach([&](const ModuleSP &module_sp) {
+      if (SymbolFile *sym_file =
+              module_sp->GetSymbolFile(/*can_create=*/false))
+        debug_info_size += sym_file->GetParsedDebugInfoMemorySize();
+      return true;
+    });
+    result.AppendMessageWithFormat(
+        "Memory used by parsed debug info : %" PRIu64 " bytes\n",
+        debug_info_size);
     result.SetStatus(eReturnStatusSuccessFinishResult);
     return true;
   }
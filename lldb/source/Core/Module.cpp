@@ -1379,14 +1379,15 @@ size_t Module::FindSymbolsMatchingRegExAndType(const RegularExpression &regex,
   return sc_list.GetSize() - initial_size;
 }
 
-void Module::PreloadSymbols() {
+void Module::PreloadSymbols(bool index_debug_info) {
   std::lock_guard<std::recursive_mutex> guard(m_mutex);
   SymbolFile *sym_file = GetSymbolFile();
   if (!sym_file)
     return;
 
   // Prime the symbol file first, since it adds symbols to the symbol table.
-  sym_file->PreloadSymbols();
+  if (index_debug_info)
+    sym_file->PreloadSymbols();
 
   // Now we can prime the symbol table.
   if (Symtab *symtab = sym_file->GetSymtab())
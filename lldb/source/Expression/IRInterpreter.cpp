@@ -88,6 +88,53 @@ static bool CanIgnoreCall(const CallInst *call) {
   return false;
 }
 
+/// Float and double are the only floating point types the interpreter
+/// handles; everything else, e.g. long double, goes to the JIT.
+static bool IsSupportedFloatType(const Type *type) {
+  return type->isFloatTy() || type->isDoubleTy();
+}
+
+static bool EvaluateFCmp(CmpInst::Predicate predicate,
+                         APFloat::cmpResult cmp) {
+  const bool unordered = cmp == APFloat::cmpUnordered;
+  switch (predicate) {
+  default:
+    return false;
+  case CmpInst::FCMP_FALSE:
+    return false;
+  case CmpInst::FCMP_OEQ:
+    return cmp == APFloat::cmpEqual;
+  case CmpInst::FCMP_OGT:
+    return cmp == APFloat::cmpGreaterThan;
+  case CmpInst::FCMP_OGE:
+    return cmp == APFloat::cmpGreaterThan || cmp == APFloat::cmpEqual;
+  case CmpInst::FCMP_OLT:
+    return cmp == APFloat::cmpLessThan;
+  case CmpInst::FCMP_OLE:
+    return cmp == APFloat::cmpLessThan || cmp == APFloat::cmpEqual;
+  case CmpInst::FCMP_ONE:
+    return cmp == APFloat::cmpLessThan || cmp == APFloat::cmpGreaterThan;
+  case CmpInst::FCMP_ORD:
+    return !unordered;
+  case CmpInst::FCMP_UNO:
+    return unordered;
+  case CmpInst::FCMP_UEQ:
+    return unordered || cmp == APFloat::cmpEqual;
+  case CmpInst::FCMP_UGT:
+    return unordered || cmp == APFloat::cmpGreaterThan;
+  case CmpInst::FCMP_UGE:
+    return unordered || cmp != APFloat::cmpLessThan;
+  case CmpInst::FCMP_ULT:
+    return unordered || cmp == APFloat::cmpLessThan;
+  case CmpInst::FCMP_ULE:
+    return unordered || cmp != APFloat::cmpGreaterThan;
+  case CmpInst::FCMP_UNE:
+    return cmp != APFloat::cmpEqual;
+  case CmpInst::FCMP_TRUE:
+    return true;
+  }
+}
+
 class InterpreterStackFrame {
 public:
   typedef std::map<const Value *, lldb::addr_t> ValueMap;
@@ -196,6 +243,27 @@ public:
     return false;
   }
 
+  /// Evaluates a float or double value. Values are stored as their bit
+  /// patterns, so this reinterprets the bits in the semantics of the type.
+  bool EvaluateFloat(APFloat &result, const Value *value, Module &module) {
+    Type *type = value->getType();
+    if (!IsSupportedFloatType(type))
+      return false;
+
+    lldb_private::Scalar bits;
+    if (!EvaluateValue(bits, value, module))
+      return false;
+
+    result = APFloat(type->getFltSemantics(),
+                     APInt(type->getPrimitiveSizeInBits(), bits.ULongLong()));
+    return true;
+  }
+
+  bool AssignFloat(const Value *value, const APFloat &result, Module &module) {
+    lldb_private::Scalar bits(result.bitcastToAPInt());
+    return AssignValue(value, bits, module);
+  }
+
   bool AssignValue(const Value *value, lldb_private::Scalar &scalar,
                    Module &module) {
     lldb::addr_t process_address = ResolveValue(value, module);
@@ -571,6 +639,28 @@ bool IRInterpreter::CanInterpret(llvm::Module &module, llvm::Function &function,
           break;
         }
       } break;
+      case Instruction::FCmp:
+      case Instruction::FAdd:
+      case Instruction::FSub:
+      case Instruction::FMul:
+      case Instruction::FDiv:
+      case Instruction::FNeg:
+      case Instruction::FPExt:
+      case Instruction::FPTrunc:
+      case Instruction::FPToSI:
+      case Instruction::FPToUI:
+      case Instruction::SIToFP:
+      case Instruction::UIToFP:
+        // The operands are checked below, the result type is checked here.
+        if (ii->getType()->isFloatingPointTy() &&
+            !IsSupportedFloatType(ii->getType())) {
+          LLDB_LOGF(log, "Unsupported instruction: %s",
+                    PrintValue(&*ii).c_str());
+          error.SetErrorToGenericError();
+          error.SetErrorString(unsupported_opcode_error);
+          return false;
+        }
+        break;
       case Instruction::And:
       case Instruction::AShr:
       case Instruction::IntToPtr:
@@ -601,6 +691,7 @@ bool IRInterpreter::CanInterpret(llvm::Module &module, llvm::Function &function,
         switch (operand_type->getTypeID()) {
         default:
           break;
+        case Type::HalfTyID:
         case Type::VectorTyID: {
           LLDB_LOGF(log, "Unsupported operand type: %s",
                     PrintType(operand_type).c_str());
@@ -1171,6 +1262,166 @@ bool IRInterpreter::Interpret(llvm::Module &module, llvm::Function &function,
         LLDB_LOGF(log, "  = : %s", frame.SummarizeValue(inst).c_str());
       }
     } break;
+    case Instruction::FAdd:
+    case Instruction::FSub:
+    case Instruction::FMul:
+    case Instruction::FDiv:
+    case Instruction::FNeg: {
+      Value *lhs = inst->getOperand(0);
+
+      APFloat L(0.0);
+
+      if (!frame.EvaluateFloat(L, lhs, module)) {
+        LLDB_LOGF(log, "Couldn't evaluate %s", PrintValue(lhs).c_str());
+        error.SetErrorToGenericError();
+        error.SetErrorString(bad_value_error);
+        return false;
+      }
+
+      APFloat result = L;
+
+      if (inst->getOpcode() == Instruction::FNeg) {
+        result.changeSign();
+      } else {
+        Value *rhs = inst->getOperand(1);
+
+        APFloat R(0.0);
+
+        if (!frame.EvaluateFloat(R, rhs, module)) {
+          LLDB_LOGF(log, "Couldn't evaluate %s", PrintValue(rhs).c_str());
+          error.SetErrorToGenericError();
+          error.SetErrorString(bad_value_error);
+          return false;
+        }
+
+        switch (inst->getOpcode()) {
+        default:
+          break;
+        case Instruction::FAdd:
+          result.add(R, APFloat::rmNearestTiesToEven);
+          break;
+        case Instruction::FSub:
+          result.subtract(R, APFloat::rmNearestTiesToEven);
+          break;
+        case Instruction::FMul:
+          result.multiply(R, APFloat::rmNearestTiesToEven);
+          break;
+        case Instruction::FDiv:
+          result.divide(R, APFloat::rmNearestTiesToEven);
+          break;
+        }
+      }
+
+      frame.AssignFloat(inst, result, module);
+
+      if (log) {
+        LLDB_LOGF(log, "Interpreted a %s", inst->getOpcodeName());
+        LLDB_LOGF(log, "  L : %s", frame.SummarizeValue(lhs).c_str());
+        LLDB_LOGF(log, "  = : %s", frame.SummarizeValue(inst).c_str());
+      }
+    } break;
+    case Instruction::FCmp: {
+      const FCmpInst *fcmp_inst = dyn_cast<FCmpInst>(inst);
+
+      if (!fcmp_inst) {
+        LLDB_LOGF(
+            log,
+            "getOpcode() returns FCmp, but instruction is not an FCmpInst");
+        error.SetErrorToGenericError();
+        error.SetErrorString(interpreter_internal_error);
+        return false;
+      }
+
+      Value *lhs = inst->getOperand(0);
+      Value *rhs = inst->getOperand(1);
+
+      APFloat L(0.0);
+      APFloat R(0.0);
+
+      if (!frame.EvaluateFloat(L, lhs, module)) {
+        LLDB_LOGF(log, "Couldn't evaluate %s", PrintValue(lhs).c_str());
+        error.SetErrorToGenericError();
+        error.SetErrorString(bad_value_error);
+        return false;
+      }
+
+      if (!frame.EvaluateFloat(R, rhs, module)) {
+        LLDB_LOGF(log, "Couldn't evaluate %s", PrintValue(rhs).c_str());
+        error.SetErrorToGenericError();
+        error.SetErrorString(bad_value_error);
+        return false;
+      }
+
+      lldb_private::Scalar result;
+      result = EvaluateFCmp(fcmp_inst->getPredicate(), L.compare(R));
+
+      frame.AssignValue(inst, result, module);
+
+      if (log) {
+        LLDB_LOGF(log, "Interpreted an FCmpInst");
+        LLDB_LOGF(log, "  L : %s", frame.SummarizeValue(lhs).c_str());
+        LLDB_LOGF(log, "  R : %s", frame.SummarizeValue(rhs).c_str());
+        LLDB_LOGF(log, "  = : %s", frame.SummarizeValue(inst).c_str());
+      }
+    } break;
+    case Instruction::FPExt:
+    case Instruction::FPTrunc:
+    case Instruction::FPToSI:
+    case Instruction::FPToUI:
+    case Instruction::SIToFP:
+    case Instruction::UIToFP: {
+      Value *source = inst->getOperand(0);
+      Type *dest_type = inst->getType();
+
+      if (inst->getOpcode() == Instruction::SIToFP ||
+          inst->getOpcode() == Instruction::UIToFP) {
+        lldb_private::Scalar S;
+
+        if (!frame.EvaluateValue(S, source, module)) {
+          LLDB_LOGF(log, "Couldn't evaluate %s", PrintValue(source).c_str());
+          error.SetErrorToGenericError();
+          error.SetErrorString(bad_value_error);
+          return false;
+        }
+
+        APInt source_apint(source->getType()->getPrimitiveSizeInBits(),
+                           S.ULongLong());
+        APFloat result(dest_type->getFltSemantics());
+        result.convertFromAPInt(source_apint,
+                                inst->getOpcode() == Instruction::SIToFP,
+                                APFloat::rmNearestTiesToEven);
+        frame.AssignFloat(inst, result, module);
+      } else {
+        APFloat F(0.0);
+
+        if (!frame.EvaluateFloat(F, source, module)) {
+          LLDB_LOGF(log, "Couldn't evaluate %s", PrintValue(source).c_str());
+          error.SetErrorToGenericError();
+          error.SetErrorString(bad_value_error);
+          return false;
+        }
+
+        if (dest_type->isFloatingPointTy()) {
+          bool loses_info;
+          F.convert(dest_type->getFltSemantics(), APFloat::rmNearestTiesToEven,
+                    &loses_info);
+          frame.AssignFloat(inst, F, module);
+        } else {
+          APSInt result(dest_type->getPrimitiveSizeInBits(),
+                        inst->getOpcode() == Instruction::FPToUI);
+          bool is_exact;
+          F.convertToInteger(result, APFloat::rmTowardZero, &is_exact);
+          lldb_private::Scalar R(static_cast<APInt &>(result));
+          frame.AssignValue(inst, R, module);
+        }
+      }
+
+      if (log) {
+        LLDB_LOGF(log, "Interpreted a %s", inst->getOpcodeName());
+        LLDB_LOGF(log, "  Src : %s", frame.SummarizeValue(source).c_str());
+        LLDB_LOGF(log, "  = : %s", frame.SummarizeValue(inst).c_str());
+      }
+    } break;
     case Instruction::IntToPtr: {
       const IntToPtrInst *int_to_ptr_inst = dyn_cast<IntToPtrInst>(inst);
 
@@ -10,6 +10,8 @@
 
 #include "lldb/Core/ValueObject.h"
 #include "lldb/DataFormatters/FormattersHelpers.h"
+#include "lldb/Target/Process.h"
+#include "lldb/Target/Target.h"
 #include "lldb/Utility/ConstString.h"
 
 using namespace lldb;
@@ -155,6 +157,20 @@ bool lldb_private::formatters::LibcxxStdVectorSyntheticFrontEnd::Update() {
           m_backend.GetChildMemberWithName(ConstString("__end_"), true).get();
     }
   }
+
+  // The elements are usually displayed right after an update. Read the ones
+  // that will be displayed into the memory cache at once, instead of with
+  // one read per element.
+  if (m_start && m_finish) {
+    if (ProcessSP process_sp = m_backend.GetProcessSP()) {
+      size_t num_children = CalculateNumChildren();
+      if (TargetSP target_sp = m_backend.GetTargetSP())
+        num_children = std::min<size_t>(
+            num_children, target_sp->GetMaximumNumberOfChildrenToDisplay());
+      process_sp->PrefetchMemory(m_start->GetValueAsUnsigned(0),
+                                 num_children * m_element_size);
+    }
+  }
   return false;
 }
 
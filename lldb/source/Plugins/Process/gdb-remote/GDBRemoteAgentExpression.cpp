@@ -0,0 +1,802 @@
+//===-- GDBRemoteAgentExpression.cpp ----------------------------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "GDBRemoteAgentExpression.h"
+
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/Support/MathExtras.h"
+
+#include <vector>
+
+using namespace llvm;
+using namespace lldb_private;
+using namespace lldb_private::process_gdb_remote;
+
+namespace {
+// The opcodes of the agent expression bytecode that are used here.
+enum AgentOpcode : uint8_t {
+  eOpAdd = 0x02,
+  eOpSub = 0x03,
+  eOpMul = 0x04,
+  eOpDivSigned = 0x05,
+  eOpDivUnsigned = 0x06,
+  eOpRemSigned = 0x07,
+  eOpRemUnsigned = 0x08,
+  eOpLsh = 0x09,
+  eOpRshSigned = 0x0a,
+  eOpRshUnsigned = 0x0b,
+  eOpLogNot = 0x0e,
+  eOpBitAnd = 0x0f,
+  eOpBitOr = 0x10,
+  eOpBitXor = 0x11,
+  eOpBitNot = 0x12,
+  eOpEqual = 0x13,
+  eOpLessSigned = 0x14,
+  eOpLessUnsigned = 0x15,
+  eOpExt = 0x16,
+  eOpRef8 = 0x17,
+  eOpRef16 = 0x18,
+  eOpRef32 = 0x19,
+  eOpRef64 = 0x1a,
+  eOpIfGoto = 0x20,
+  eOpGoto = 0x21,
+  eOpConst8 = 0x22,
+  eOpConst16 = 0x23,
+  eOpConst32 = 0x24,
+  eOpConst64 = 0x25,
+  eOpReg = 0x26,
+  eOpEnd = 0x27,
+  eOpDup = 0x28,
+  eOpPop = 0x29,
+  eOpZeroExt = 0x2a,
+  eOpSwap = 0x2b,
+  eOpPick = 0x32,
+  eOpRot = 0x33,
+};
+
+/// The C type of a value on the stack. Values are kept sign or zero extended
+/// to 64 bits according to their type.
+struct CType {
+  uint32_t bits;
+  bool is_signed;
+};
+
+const CType g_int_type = {32, true};
+
+class AgentExpressionCompiler {
+public:
+  AgentExpressionCompiler(
+      StringRef condition, uint32_t long_byte_size,
+      function_ref<Optional<AgentExpressionRegister>(StringRef)>
+          lookup_register)
+      : m_text(condition), m_long_bits(long_byte_size * 8),
+        m_lookup_register(lookup_register) {}
+
+  Expected<std::string> Compile() {
+    Expected<CType> type = ParseLogicalOr();
+    if (!type)
+      return type.takeError();
+    SkipSpaces();
+    if (!m_text.empty())
+      return Fail("unexpected '" + m_text + "'");
+    Emit(eOpEnd);
+    return m_code;
+  }
+
+private:
+  Error Fail(const Twine &message) {
+    return createStringError(inconvertibleErrorCode(), message);
+  }
+
+  void SkipSpaces() { m_text = m_text.ltrim(); }
+
+  /// Consumes \p token if it is next, but not if it is the start of a longer
+  /// operator that starts with it, e.g. '<' in "<=".
+  bool Consume(StringRef token) {
+    SkipSpaces();
+    if (!m_text.startswith(token))
+      return false;
+    StringRef rest = m_text.drop_front(token.size());
+    if (token.size() == 1 && !rest.empty() &&
+        StringRef("<>=&|").contains(token[0]) &&
+        (rest[0] == '=' || rest[0] == token[0]))
+      return false;
+    m_text = rest;
+    return true;
+  }
+
+  StringRef ConsumeIdentifier() {
+    SkipSpaces();
+    size_t len = 0;
+    while (len < m_text.size() &&
+           (isAlnum(m_text[len]) || m_text[len] == '_'))
+      ++len;
+    StringRef ident = m_text.take_front(len);
+    m_text = m_text.drop_front(len);
+    return ident;
+  }
+
+  void Emit(uint8_t byte) { m_code.push_back(static_cast<char>(byte)); }
+
+  void EmitBigEndian(uint64_t value, unsigned bytes) {
+    for (unsigned i = bytes; i-- > 0;)
+      Emit(static_cast<uint8_t>(value >> (i * 8)));
+  }
+
+  void EmitConst(uint64_t value) {
+    if (isUInt<8>(value)) {
+      Emit(eOpConst8);
+      EmitBigEndian(value, 1);
+    } else if (isUInt<16>(value)) {
+      Emit(eOpConst16);
+      EmitBigEndian(value, 2);
+    } else if (isUInt<32>(value)) {
+      Emit(eOpConst32);
+      EmitBigEndian(value, 4);
+    } else {
+      Emit(eOpConst64);
+      EmitBigEndian(value, 8);
+    }
+  }
+
+  /// Converts the value on top of the stack, which has the type \p from, to
+  /// the type \p to.
+  void EmitConversion(CType from, CType to) {
+    if (to.bits >= 64 ||
+        (to.bits >= from.bits && to.is_signed == from.is_signed))
+      return;
+    Emit(to.is_signed ? eOpExt : eOpZeroExt);
+    Emit(static_cast<uint8_t>(to.bits));
+  }
+
+  /// Emits a jump whose target is filled in by PatchJump(), and returns the
+  /// offset of the target.
+  size_t EmitJump(uint8_t opcode) {
+    Emit(opcode);
+    size_t offset = m_code.size();
+    EmitBigEndian(0, 2);
+    return offset;
+  }
+
+  /// Makes the jump whose target is at \p offset jump to the end of the code.
+  Error PatchJump(size_t offset) {
+    if (!isUInt<16>(m_code.size()))
+      return Fail("condition is too long");
+    m_code[offset] = static_cast<char>(m_code.size() >> 8);
+    m_code[offset + 1] = static_cast<char>(m_code.size());
+    return Error::success();
+  }
+
+  /// Turns the value on top of the stack into 0 or 1.
+  void EmitTruthValue() {
+    Emit(eOpLogNot);
+    Emit(eOpLogNot);
+  }
+
+  static CType Promote(CType type) {
+    return type.bits < 32 ? g_int_type : type;
+  }
+
+  /// The usual arithmetic conversions of C, for integers.
+  static CType GetCommonType(CType lhs, CType rhs) {
+    lhs = Promote(lhs);
+    rhs = Promote(rhs);
+    if (lhs.is_signed == rhs.is_signed)
+      return lhs.bits >= rhs.bits ? lhs : rhs;
+    CType unsigned_type = lhs.is_signed ? rhs : lhs;
+    CType signed_type = lhs.is_signed ? lhs : rhs;
+    if (unsigned_type.bits >= signed_type.bits)
+      return unsigned_type;
+    return signed_type;
+  }
+
+  /// Converts the two values on top of the stack to their common type and
+  /// returns it.
+  CType EmitCommonType(CType lhs, CType rhs) {
+    CType common = GetCommonType(lhs, rhs);
+    EmitConversion(rhs, common);
+    Emit(eOpSwap);
+    EmitConversion(lhs, common);
+    Emit(eOpSwap);
+    return common;
+  }
+
+  Expected<CType> ParseLogicalOr() {
+    Expected<CType> lhs = ParseLogicalAnd();
+    if (!lhs)
+      return lhs;
+    while (Consume("||")) {
+      // The right hand side is only evaluated if the left hand side is false,
+      // in which case the result is the truth value of the right hand side.
+      EmitTruthValue();
+      Emit(eOpDup);
+      size_t jump = EmitJump(eOpIfGoto);
+      Emit(eOpPop);
+      Expected<CType> rhs = ParseLogicalAnd();
+      if (!rhs)
+        return rhs;
+      EmitTruthValue();
+      if (Error error = PatchJump(jump))
+        return std::move(error);
+      lhs = g_int_type;
+    }
+    return lhs;
+  }
+
+  Expected<CType> ParseLogicalAnd() {
+    Expected<CType> lhs = ParseEquality();
+    if (!lhs)
+      return lhs;
+    while (Consume("&&")) {
+      // The right hand side is only evaluated if the left hand side is true.
+      EmitTruthValue();
+      Emit(eOpDup);
+      Emit(eOpLogNot);
+      size_t jump = EmitJump(eOpIfGoto);
+      Emit(eOpPop);
+      Expected<CType> rhs = ParseEquality();
+      if (!rhs)
+        return rhs;
+      EmitTruthValue();
+      if (Error error = PatchJump(jump))
+        return std::move(error);
+      lhs = g_int_type;
+    }
+    return lhs;
+  }
+
+  Expected<CType> ParseEquality() {
+    Expected<CType> lhs = ParseRelational();
+    if (!lhs)
+      return lhs;
+    while (true) {
+      bool is_equal;
+      if (Consume("=="))
+        is_equal = true;
+      else if (Consume("!="))
+        is_equal = false;
+      else
+        break;
+      Expected<CType> rhs = ParseRelational();
+      if (!rhs)
+        return rhs;
+      EmitCommonType(*lhs, *rhs);
+      Emit(eOpEqual);
+      if (!is_equal)
+        Emit(eOpLogNot);
+      lhs = g_int_type;
+    }
+    return lhs;
+  }
+
+  Expected<CType> ParseRelational() {
+    Expected<CType> lhs = ParseAdditive();
+    if (!lhs)
+      return lhs;
+    while (true) {
+      // a < b is "less", a > b is "swap less", a <= b is !(b < a) and a >= b
+      // is !(a < b).
+      bool swap, negate;
+      if (Consume("<=")) {
+        swap = true;
+        negate = true;
+      } else if (Consume(">=")) {
+        swap = false;
+        negate = true;
+      } else if (Consume("<")) {
+        swap = false;
+        negate = false;
+      } else if (Consume(">")) {
+        swap = true;
+        negate = false;
+      } else {
+        break;
+      }
+      Expected<CType> rhs = ParseAdditive();
+      if (!rhs)
+        return rhs;
+      CType common = EmitCommonType(*lhs, *rhs);
+      if (swap)
+        Emit(eOpSwap);
+      Emit(common.is_signed ? eOpLessSigned : eOpLessUnsigned);
+      if (negate)
+        Emit(eOpLogNot);
+      lhs = g_int_type;
+    }
+    return lhs;
+  }
+
+  Expected<CType> ParseAdditive() {
+    Expected<CType> lhs = ParseUnary();
+    if (!lhs)
+      return lhs;
+    while (true) {
+      uint8_t opcode;
+      if (Consume("+"))
+        opcode = eOpAdd;
+      else if (Consume("-"))
+        opcode = eOpSub;
+      else
+        break;
+      Expected<CType> rhs = ParseUnary();
+      if (!rhs)
+        return rhs;
+      CType common = EmitCommonType(*lhs, *rhs);
+      Emit(opcode);
+      // Wrap around like C does for the (unsigned) type of the result.
+      EmitConversion({64, common.is_signed}, common);
+      lhs = common;
+    }
+    return lhs;
+  }
+
+  Expected<CType> ParseUnary() {
+    if (Consume("!")) {
+      Expected<CType> operand = ParseUnary();
+      if (!operand)
+        return operand;
+      Emit(eOpLogNot);
+      return g_int_type;
+    }
+    if (Consume("-")) {
+      Emit(eOpConst8);
+      Emit(0);
+      Expected<CType> operand = ParseUnary();
+      if (!operand)
+        return operand;
+      CType type = Promote(*operand);
+      EmitConversion(*operand, type);
+      Emit(eOpSub);
+      EmitConversion({64, type.is_signed}, type);
+      return type;
+    }
+    if (Consume("*"))
+      return ParseMemoryRead();
+    if (Consume("(")) {
+      Expected<CType> type = ParseLogicalOr();
+      if (!type)
+        return type;
+      if (!Consume(")"))
+        return Fail("expected ')'");
+      return type;
+    }
+    if (Consume("$"))
+      return ParseRegister();
+    return ParseNumber();
+  }
+
+  /// Parses "(type *)address" after a '*'.
+  Expected<CType> ParseMemoryRead() {
+    if (!Consume("("))
+      return Fail("only reads through a cast to an integer pointer are "
+                  "supported");
+    Expected<CType> type = ParseIntegerType();
+    if (!type)
+      return type;
+    if (!Consume("*") || !Consume(")"))
+      return Fail("expected '*)'");
+    Expected<CType> address = ParseUnary();
+    if (!address)
+      return address;
+    switch (type->bits) {
+    case 8:
+      Emit(eOpRef8);
+      break;
+    case 16:
+      Emit(eOpRef16);
+      break;
+    case 32:
+      Emit(eOpRef32);
+      break;
+    default:
+      Emit(eOpRef64);
+      break;
+    }
+    // The value is read zero extended.
+    if (type->is_signed)
+      EmitConversion({64, false}, *type);
+    return type;
+  }
+
+  Expected<CType> ParseIntegerType() {
+    SmallVector<StringRef, 4> words;
+    while (true) {
+      StringRef word = ConsumeIdentifier();
+      if (word.empty())
+        break;
+      words.push_back(word);
+    }
+    if (words.size() == 1) {
+      StringRef name = words[0];
+      bool is_signed = !name.consume_front("u");
+      unsigned bits;
+      if (name.consume_front("int") && name.consume_back("_t") &&
+          !name.getAsInteger(10, bits) &&
+          (bits == 8 || bits == 16 || bits == 32 || bits == 64))
+        return CType{bits, is_signed};
+      if (words[0] == "bool")
+        return CType{8, false};
+    }
+
+    unsigned num_signed = 0, num_unsigned = 0, num_char = 0, num_short = 0,
+             num_int = 0, num_long = 0;
+    for (StringRef word : words) {
+      if (word == "signed")
+        ++num_signed;
+      else if (word == "unsigned")
+        ++num_unsigned;
+      else if (word == "char")
+        ++num_char;
+      else if (word == "short")
+        ++num_short;
+      else if (word == "int")
+        ++num_int;
+      else if (word == "long")
+        ++num_long;
+      else
+        return Fail("unsupported type '" + word + "'");
+    }
+    if (words.empty() || num_signed + num_unsigned > 1 || num_int > 1 ||
+        num_char + num_short + (num_long ? 1 : 0) > 1 || num_long > 2 ||
+        (num_char && num_int))
+      return Fail("unsupported type");
+    // Whether plain char is signed depends on the target.
+    if (num_char && !num_signed && !num_unsigned)
+      return Fail("plain char is not supported");
+
+    CType type = {32, num_unsigned == 0};
+    if (num_char)
+      type.bits = 8;
+    else if (num_short)
+      type.bits = 16;
+    else if (num_long == 1)
+      type.bits = m_long_bits;
+    else if (num_long == 2)
+      type.bits = 64;
+    return type;
+  }
+
+  Expected<CType> ParseRegister() {
+    StringRef name = ConsumeIdentifier();
+    if (name.empty())
+      return Fail("expected a register name after '$'");
+    Optional<AgentExpressionRegister> reg = m_lookup_register(name);
+    if (!reg)
+      return Fail("unknown or unsupported register '" + name + "'");
+    if (reg->byte_size == 0 || reg->byte_size > 8 || reg->number > UINT16_MAX)
+      return Fail("unsupported register '" + name + "'");
+    Emit(eOpReg);
+    EmitBigEndian(reg->number, 2);
+    CType type = {reg->byte_size * 8, reg->is_signed};
+    // Registers are read zero extended.
+    if (type.is_signed)
+      EmitConversion({64, false}, type);
+    return type;
+  }
+
+  Expected<CType> ParseNumber() {
+    SkipSpaces();
+    size_t len = 0;
+    while (len < m_text.size() && isAlnum(m_text[len]))
+      ++len;
+    StringRef literal = m_text.take_front(len);
+    m_text = m_text.drop_front(len);
+    if (literal.empty() || !isDigit(literal[0]))
+      return Fail("expected an integer");
+
+    StringRef digits = literal.rtrim("uUlL");
+    StringRef suffix = literal.drop_front(digits.size());
+    bool has_unsigned_suffix = suffix.find_first_of("uU") != StringRef::npos;
+    size_t num_long = suffix.count('l') + suffix.count('L');
+    if (suffix.size() - num_long > 1 || num_long > 2)
+      return Fail("invalid integer suffix '" + suffix + "'");
+
+    uint64_t value;
+    // getAsInteger() with radix 0 understands the 0x and 0 prefixes.
+    if (digits.getAsInteger(0, value))
+      return Fail("invalid integer '" + literal + "'");
+    bool is_decimal = digits == "0" || digits[0] != '0';
+
+    // Pick the first type that can represent the value, like C does.
+    uint32_t min_bits = num_long == 0 ? 32 : num_long == 1 ? m_long_bits : 64;
+    CType type;
+    bool found = false;
+    for (uint32_t bits : {32u, 64u}) {
+      if (bits < min_bits)
+        continue;
+      uint64_t max = bits == 64 ? UINT64_MAX : (uint64_t(1) << bits) - 1;
+      if (!has_unsigned_suffix && value <= max >> 1) {
+        type = {bits, true};
+        found = true;
+        break;
+      }
+      if ((has_unsigned_suffix || !is_decimal) && value <= max) {
+        type = {bits, false};
+        found = true;
+        break;
+      }
+    }
+    if (!found)
+      return Fail("integer '" + literal + "' is too large");
+    EmitConst(value);
+    return type;
+  }
+
+  StringRef m_text;
+  uint32_t m_long_bits;
+  function_ref<Optional<AgentExpressionRegister>(StringRef)> m_lookup_register;
+  std::string m_code;
+};
+} // namespace
+
+Expected<std::string> process_gdb_remote::CompileAgentExpression(
+    StringRef condition, uint32_t long_byte_size,
+    function_ref<Optional<AgentExpressionRegister>(StringRef)>
+        lookup_register) {
+  return AgentExpressionCompiler(condition, long_byte_size, lookup_register)
+      .Compile();
+}
+
+Expected<uint64_t> process_gdb_remote::EvaluateAgentExpression(
+    StringRef bytecode,
+    function_ref<Expected<uint64_t>(uint32_t)> read_register,
+    function_ref<Expected<uint64_t>(lldb::addr_t, uint32_t)> read_memory) {
+  // Agent expressions may contain loops; don't let a broken one hang the
+  // stub.
+  const size_t max_steps = 100000;
+  const size_t max_stack_size = 1024;
+
+  auto fail = [](const Twine &message) -> Expected<uint64_t> {
+    return createStringError(inconvertibleErrorCode(), message);
+  };
+
+  std::vector<uint64_t> stack;
+  size_t pc = 0;
+  auto read_operand = [&](unsigned bytes, uint64_t &value) {
+    if (pc + bytes > bytecode.size())
+      return false;
+    value = 0;
+    for (unsigned i = 0; i < bytes; ++i)
+      value = (value << 8) | static_cast<uint8_t>(bytecode[pc++]);
+    return true;
+  };
+
+  for (size_t steps = 0; steps < max_steps; ++steps) {
+    if (pc >= bytecode.size())
+      return fail("agent expression has no end");
+    const uint8_t opcode = bytecode[pc++];
+
+    // The number of stack entries each opcode needs.
+    size_t needed = 0;
+    switch (opcode) {
+    case eOpAdd:
+    case eOpSub:
+    case eOpMul:
+    case eOpDivSigned:
+    case eOpDivUnsigned:
+    case eOpRemSigned:
+    case eOpRemUnsigned:
+    case eOpLsh:
+    case eOpRshSigned:
+    case eOpRshUnsigned:
+    case eOpBitAnd:
+    case eOpBitOr:
+    case eOpBitXor:
+    case eOpEqual:
+    case eOpLessSigned:
+    case eOpLessUnsigned:
+    case eOpSwap:
+      needed = 2;
+      break;
+    case eOpRot:
+      needed = 3;
+      break;
+    case eOpLogNot:
+    case eOpBitNot:
+    case eOpExt:
+    case eOpZeroExt:
+    case eOpRef8:
+    case eOpRef16:
+    case eOpRef32:
+    case eOpRef64:
+    case eOpIfGoto:
+    case eOpEnd:
+    case eOpDup:
+    case eOpPop:
+      needed = 1;
+      break;
+    default:
+      break;
+    }
+    if (stack.size() < needed)
+      return fail("agent expression stack underflow");
+    if (stack.size() >= max_stack_size)
+      return fail("agent expression stack overflow");
+
+    switch (opcode) {
+    case eOpAdd:
+    case eOpSub:
+    case eOpMul:
+    case eOpDivSigned:
+    case eOpDivUnsigned:
+    case eOpRemSigned:
+    case eOpRemUnsigned:
+    case eOpLsh:
+    case eOpRshSigned:
+    case eOpRshUnsigned:
+    case eOpBitAnd:
+    case eOpBitOr:
+    case eOpBitXor:
+    case eOpEqual:
+    case eOpLessSigned:
+    case eOpLessUnsigned: {
+      const uint64_t b = stack.back();
+      stack.pop_back();
+      const uint64_t a = stack.back();
+      uint64_t result = 0;
+      switch (opcode) {
+      case eOpAdd:
+        result = a + b;
+        break;
+      case eOpSub:
+        result = a - b;
+        break;
+      case eOpMul:
+        result = a * b;
+        break;
+      case eOpDivSigned:
+      case eOpRemSigned:
+        if (b == 0)
+          return fail("division by zero in agent expression");
+        // INT64_MIN / -1 overflows; C leaves it undefined, just wrap.
+        if (int64_t(b) == -1)
+          result = opcode == eOpDivSigned ? 0 - a : 0;
+        else if (opcode == eOpDivSigned)
+          result = uint64_t(int64_t(a) / int64_t(b));
+        else
+          result = uint64_t(int64_t(a) % int64_t(b));
+        break;
+      case eOpDivUnsigned:
+      case eOpRemUnsigned:
+        if (b == 0)
+          return fail("division by zero in agent expression");
+        result = opcode == eOpDivUnsigned ? a / b : a % b;
+        break;
+      case eOpLsh:
+        result = b >= 64 ? 0 : a << b;
+        break;
+      case eOpRshSigned:
+        result = uint64_t(int64_t(a) >> std::min<uint64_t>(b, 63));
+        break;
+      case eOpRshUnsigned:
+        result = b >= 64 ? 0 : a >> b;
+        break;
+      case eOpBitAnd:
+        result = a & b;
+        break;
+      case eOpBitOr:
+        result = a | b;
+        break;
+      case eOpBitXor:
+        result = a ^ b;
+        break;
+      case eOpEqual:
+        result = a == b;
+        break;
+      case eOpLessSigned:
+        result = int64_t(a) < int64_t(b);
+        break;
+      case eOpLessUnsigned:
+        result = a < b;
+        break;
+      }
+      stack.back() = result;
+      break;
+    }
+    case eOpLogNot:
+      stack.back() = stack.back() == 0;
+      break;
+    case eOpBitNot:
+      stack.back() = ~stack.back();
+      break;
+    case eOpExt:
+    case eOpZeroExt: {
+      uint64_t bits;
+      if (!read_operand(1, bits))
+        return fail("truncated agent expression");
+      if (bits == 0 || bits > 64)
+        return fail("invalid extension in agent expression");
+      if (bits == 64)
+        break;
+      if (opcode == eOpExt)
+        stack.back() = SignExtend64(stack.back(), bits);
+      else
+        stack.back() &= maskTrailingOnes<uint64_t>(bits);
+      break;
+    }
+    case eOpRef8:
+    case eOpRef16:
+    case eOpRef32:
+    case eOpRef64: {
+      const uint32_t size = 1u << (opcode - eOpRef8);
+      Expected<uint64_t> value = read_memory(stack.back(), size);
+      if (!value)
+        return value.takeError();
+      stack.back() = *value;
+      break;
+    }
+    case eOpIfGoto:
+    case eOpGoto: {
+      uint64_t target;
+      if (!read_operand(2, target))
+        return fail("truncated agent expression");
+      bool jump = true;
+      if (opcode == eOpIfGoto) {
+        jump = stack.back() != 0;
+        stack.pop_back();
+      }
+      if (jump)
+        pc = target;
+      break;
+    }
+    case eOpConst8:
+    case eOpConst16:
+    case eOpConst32:
+    case eOpConst64: {
+      uint64_t value;
+      if (!read_operand(1u << (opcode - eOpConst8), value))
+        return fail("truncated agent expression");
+      stack.push_back(value);
+      break;
+    }
+    case eOpReg: {
+      uint64_t number;
+      if (!read_operand(2, number))
+        return fail("truncated agent expression");
+      Expected<uint64_t> value = read_register(number);
+      if (!value)
+        return value.takeError();
+      stack.push_back(*value);
+      break;
+    }
+    case eOpEnd:
+      return stack.back();
+    case eOpDup:
+      stack.push_back(stack.back());
+      break;
+    case eOpPop:
+      stack.pop_back();
+      break;
+    case eOpSwap:
+      std::swap(stack[stack.size() - 1], stack[stack.size() - 2]);
+      break;
+    case eOpPick: {
+      uint64_t n;
+      if (!read_operand(1, n))
+        return fail("truncated agent expression");
+      if (n >= stack.size())
+        return fail("agent expression stack underflow");
+      stack.push_back(stack[stack.size() - 1 - n]);
+      break;
+    }
+    case eOpRot: {
+      // a b c => c a b
+      uint64_t c = stack.back();
+      stack[stack.size() - 1] = stack[stack.size() - 2];
+      stack[stack.size() - 2] = stack[stack.size() - 3];
+      stack[stack.size() - 3] = c;
+      break;
+    }
+    default:
+      return fail("unsupported agent expression opcode 0x" +
+                  utohexstr(opcode));
+    }
+  }
+  return fail("agent expression ran for too long");
+}
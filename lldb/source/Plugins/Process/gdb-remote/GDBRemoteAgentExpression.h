@@ -0,0 +1,76 @@
+//===-- GDBRemoteAgentExpression.h ------------------------------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef liblldb_GDBRemoteAgentExpression_h_
+#define liblldb_GDBRemoteAgentExpression_h_
+
+#include "lldb/lldb-types.h"
+#include "llvm/ADT/Optional.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Error.h"
+
+#include <cstdint>
+#include <string>
+
+namespace lldb_private {
+namespace process_gdb_remote {
+
+// Agent expressions are the bytecode that GDB uses to let a stub evaluate
+// breakpoint conditions, see the "Agent Expressions" appendix of the GDB
+// manual. lldb compiles simple conditions into them, so that lldb-server can
+// resume from a breakpoint hit whose condition is false without involving
+// the client.
+
+/// A register that a condition refers to.
+struct AgentExpressionRegister {
+  /// The register number in the remote protocol.
+  uint32_t number;
+  uint32_t byte_size;
+  bool is_signed;
+};
+
+/// Compiles \p condition into agent expression bytecode.
+///
+/// Only a small subset of C is supported, and it is evaluated with C's
+/// integer semantics: integer literals, registers ($name), memory reads of
+/// fixed size integers (*(uint32_t *)address), + and -, comparisons, !, &&,
+/// || and parentheses. Anything else, in particular variables, is rejected,
+/// and the condition has to be evaluated by lldb.
+///
+/// \param[in] long_byte_size
+///     The size of "long" for the target.
+///
+/// \param[in] lookup_register
+///     Returns the register with the given name, or None if there is no
+///     such register or it is not an integer register.
+llvm::Expected<std::string> CompileAgentExpression(
+    llvm::StringRef condition, uint32_t long_byte_size,
+    llvm::function_ref<llvm::Optional<AgentExpressionRegister>(llvm::StringRef)>
+        lookup_register);
+
+/// Evaluates the agent expression \p bytecode and returns the value that is
+/// on top of the stack when it ends.
+///
+/// \param[in] read_register
+///     Returns the value of the register with the given remote number,
+///     zero extended to 64 bits.
+///
+/// \param[in] read_memory
+///     Reads an integer of the given size, in target byte order, from the
+///     given address, and returns it zero extended to 64 bits.
+llvm::Expected<uint64_t> EvaluateAgentExpression(
+    llvm::StringRef bytecode,
+    llvm::function_ref<llvm::Expected<uint64_t>(uint32_t)> read_register,
+    llvm::function_ref<llvm::Expected<uint64_t>(lldb::addr_t, uint32_t)>
+        read_memory);
+
+} // namespace process_gdb_remote
+} // namespace lldb_private
+
+#endif // liblldb_GDBRemoteAgentExpression_h_
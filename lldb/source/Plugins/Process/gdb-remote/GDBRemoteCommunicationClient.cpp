@@ -76,6 +76,8 @@ GDBRemoteCommunicationClient::GDBRemoteCommunicationClient()
       m_supports_qXfer_libraries_svr4_read(eLazyBoolCalculate),
       m_supports_qXfer_features_read(eLazyBoolCalculate),
       m_supports_qXfer_memory_map_read(eLazyBoolCalculate),
+      m_supports_qMultiMemRead(eLazyBoolCalculate),
+      m_supports_conditional_breakpoints(eLazyBoolCalculate),
       m_supports_augmented_libraries_svr4_read(eLazyBoolCalculate),
       m_supports_jThreadExtendedInfo(eLazyBoolCalculate),
       m_supports_jLoadedDynamicLibrariesInfos(eLazyBoolCalculate),
@@ -192,6 +194,20 @@ bool GDBRemoteCommunicationClient::GetQXferMemoryMapReadSupported() {
   return m_supports_qXfer_memory_map_read == eLazyBoolYes;
 }
 
+bool GDBRemoteCommunicationClient::GetMultiMemReadSupported() {
+  if (m_supports_qMultiMemRead == eLazyBoolCalculate) {
+    GetRemoteQSupported();
+  }
+  return m_supports_qMultiMemRead == eLazyBoolYes;
+}
+
+bool GDBRemoteCommunicationClient::GetConditionalBreakpointsSupported() {
+  if (m_supports_conditional_breakpoints == eLazyBoolCalculate) {
+    GetRemoteQSupported();
+  }
+  return m_supports_conditional_breakpoints == eLazyBoolYes;
+}
+
 uint64_t GDBRemoteCommunicationClient::GetRemoteMaxPacketSize() {
   if (m_max_packet_size == 0) {
     GetRemoteQSupported();
@@ -290,6 +306,8 @@ void GDBRemoteCommunicationClient::ResetDiscoverableSettings(bool did_exec) {
     m_supports_qXfer_libraries_svr4_read = eLazyBoolCalculate;
     m_supports_qXfer_features_read = eLazyBoolCalculate;
     m_supports_qXfer_memory_map_read = eLazyBoolCalculate;
+    m_supports_qMultiMemRead = eLazyBoolCalculate;
+    m_supports_conditional_breakpoints = eLazyBoolCalculate;
     m_supports_augmented_libraries_svr4_read = eLazyBoolCalculate;
     m_supports_qProcessInfoPID = true;
     m_supports_qfProcessInfo = true;
@@ -335,6 +353,8 @@ void GDBRemoteCommunicationClient::GetRemoteQSupported() {
   m_supports_augmented_libraries_svr4_read = eLazyBoolNo;
   m_supports_qXfer_features_read = eLazyBoolNo;
   m_supports_qXfer_memory_map_read = eLazyBoolNo;
+  m_supports_qMultiMemRead = eLazyBoolNo;
+  m_supports_conditional_breakpoints = eLazyBoolNo;
   m_max_packet_size = UINT64_MAX; // It's supposed to always be there, but if
                                   // not, we assume no limit
 
@@ -371,6 +391,10 @@ void GDBRemoteCommunicationClient::GetRemoteQSupported() {
       m_supports_qXfer_features_read = eLazyBoolYes;
     if (::strstr(response_cstr, "qXfer:memory-map:read+"))
       m_supports_qXfer_memory_map_read = eLazyBoolYes;
+    if (::strstr(response_cstr, "qMultiMemRead+"))
+      m_supports_qMultiMemRead = eLazyBoolYes;
+    if (::strstr(response_cstr, "ConditionalBreakpoints+"))
+      m_supports_conditional_breakpoints = eLazyBoolYes;
 
     // Look for a list of compressions in the features list e.g.
     // qXfer:features:read+;PacketSize=20000;qEcho+;SupportedCompressions=zlib-
@@ -650,6 +674,53 @@ bool GDBRemoteCommunicationClient::GetxPacketSupported() {
   return m_supports_x;
 }
 
+llvm::Expected<std::vector<std::string>>
+GDBRemoteCommunicationClient::ReadMemoryRanges(
+    llvm::ArrayRef<std::pair<lldb::addr_t, lldb::addr_t>> ranges) {
+  // qMultiMemRead:<addr>,<size>[;<addr>,<size>]*
+  StreamString packet;
+  packet.PutCString("qMultiMemRead:");
+  for (size_t i = 0; i < ranges.size(); ++i)
+    packet.Printf("%s%" PRIx64 ",%" PRIx64, i == 0 ? "" : ";",
+                  ranges[i].first, ranges[i].second);
+
+  StringExtractorGDBRemote response;
+  if (SendPacketAndWaitForResponse(packet.GetString(), response, true) !=
+      PacketResult::Success)
+    return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                   "failed to send qMultiMemRead packet");
+  if (!response.IsNormalResponse())
+    return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                   "qMultiMemRead packet failed");
+
+  // <bytes read>[,<bytes read>]*;<binary data of all ranges>
+  std::vector<uint64_t> sizes;
+  for (size_t i = 0; i < ranges.size(); ++i) {
+    if (i > 0 && response.GetChar() != ',')
+      break;
+    uint64_t size = response.GetHexMaxU64(false, UINT64_MAX);
+    if (size > ranges[i].second)
+      break;
+    sizes.push_back(size);
+  }
+  if (sizes.size() != ranges.size() || response.GetChar() != ';')
+    return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                   "malformed qMultiMemRead response");
+
+  // The packet receive layer has already de-quoted the binary data.
+  llvm::StringRef data = response.GetStringRef().substr(
+      response.GetFilePos());
+  std::vector<std::string> result;
+  for (uint64_t size : sizes) {
+    if (data.size() < size)
+      return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                     "truncated qMultiMemRead response");
+    result.push_back(data.take_front(size).str());
+    data = data.drop_front(size);
+  }
+  return result;
+}
+
 GDBRemoteCommunicationClient::PacketResult
 GDBRemoteCommunicationClient::SendPacketsAndConcatenateResponses(
     const char *payload_prefix, std::string &response_string) {
@@ -2657,7 +2728,8 @@ bool GDBRemoteCommunicationClient::GetThreadStopInfo(
 }
 
 uint8_t GDBRemoteCommunicationClient::SendGDBStoppointTypePacket(
-    GDBStoppointType type, bool insert, addr_t addr, uint32_t length) {
+    GDBStoppointType type, bool insert, addr_t addr, uint32_t length,
+    llvm::ArrayRef<std::string> conditions) {
   Log *log(GetLogIfAnyCategoriesSet(LIBLLDB_LOG_BREAKPOINTS));
   LLDB_LOGF(log, "GDBRemoteCommunicationClient::%s() %s at addr = 0x%" PRIx64,
             __FUNCTION__, insert ? "add" : "remove", addr);
@@ -2666,19 +2738,19 @@ uint8_t GDBRemoteCommunicationClient::SendGDBStoppointTypePacket(
   if (!SupportsGDBStoppointPacket(type))
     return UINT8_MAX;
   // Construct the breakpoint packet
-  char packet[64];
-  const int packet_len =
-      ::snprintf(packet, sizeof(packet), "%c%i,%" PRIx64 ",%x",
-                 insert ? 'Z' : 'z', type, addr, length);
-  // Check we haven't overwritten the end of the packet buffer
-  assert(packet_len + 1 < (int)sizeof(packet));
-  UNUSED_IF_ASSERT_DISABLED(packet_len);
+  StreamString packet;
+  packet.Printf("%c%i,%" PRIx64 ",%x", insert ? 'Z' : 'z', type, addr, length);
+  // Append the conditions as ;X<len>,<hex encoded bytecode>
+  for (const std::string &condition : conditions) {
+    packet.Printf(";X%x,", static_cast<uint32_t>(condition.size()));
+    packet.PutBytesAsRawHex8(condition.data(), condition.size());
+  }
   StringExtractorGDBRemote response;
   // Make sure the response is either "OK", "EXX" where XX are two hex digits,
   // or "" (unsupported)
   response.SetResponseValidatorToOKErrorNotSupported();
   // Try to send the breakpoint packet, and check that it was correctly sent
-  if (SendPacketAndWaitForResponse(packet, response, true) ==
+  if (SendPacketAndWaitForResponse(packet.GetString(), response, true) ==
       PacketResult::Success) {
     // Receive and OK packet when the breakpoint successfully placed
     if (response.IsOKResponse())
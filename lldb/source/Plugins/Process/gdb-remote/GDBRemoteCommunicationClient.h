@@ -300,7 +300,8 @@ public:
       GDBStoppointType type, // Type of breakpoint or watchpoint
       bool insert,           // Insert or remove?
       lldb::addr_t addr,     // Address of breakpoint or watchpoint
-      uint32_t length);      // Byte Size of breakpoint or watchpoint
+      uint32_t length,       // Byte Size of breakpoint or watchpoint
+      llvm::ArrayRef<std::string> conditions = {}); // Agent expressions
 
   bool SetNonStopMode(const bool enable);
 
@@ -339,6 +340,21 @@ public:
 
   bool GetQXferMemoryMapReadSupported();
 
+  bool GetMultiMemReadSupported();
+
+  /// Whether the stub evaluates breakpoint conditions that are sent as agent
+  /// expressions with the Z0 and Z1 packets.
+  bool GetConditionalBreakpointsSupported();
+
+  /// Read the memory of several ranges with a single qMultiMemRead packet.
+  ///
+  /// \return
+  ///     The bytes read from each range, which are fewer than requested if
+  ///     only the start of a range could be read, or an error if the packet
+  ///     failed as a whole.
+  llvm::Expected<std::vector<std::string>> ReadMemoryRanges(
+      llvm::ArrayRef<std::pair<lldb::addr_t, lldb::addr_t>> ranges);
+
   LazyBool SupportsAllocDeallocMemory() // const
   {
     // Uncomment this to have lldb pretend the debug server doesn't respond to
@@ -523,6 +539,8 @@ protected:
   LazyBool m_supports_qXfer_libraries_svr4_read;
   LazyBool m_supports_qXfer_features_read;
   LazyBool m_supports_qXfer_memory_map_read;
+  LazyBool m_supports_qMultiMemRead;
+  LazyBool m_supports_conditional_breakpoints;
   LazyBool m_supports_augmented_libraries_svr4_read;
   LazyBool m_supports_jThreadExtendedInfo;
   LazyBool m_supports_jLoadedDynamicLibrariesInfos;
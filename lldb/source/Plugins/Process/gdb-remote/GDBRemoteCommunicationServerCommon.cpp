@@ -842,6 +842,8 @@ GDBRemoteCommunicationServerCommon::Handle_qSupported(
   response.PutCString(";QPassSignals+");
   response.PutCString(";qXfer:auxv:read+");
   response.PutCString(";qXfer:libraries-svr4:read+");
+  response.PutCString(";qMultiMemRead+");
+  response.PutCString(";ConditionalBreakpoints+");
 #endif
 
   return SendPacketNoLock(response.GetString());
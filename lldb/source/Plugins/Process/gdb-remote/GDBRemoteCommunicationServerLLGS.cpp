@@ -42,6 +42,7 @@
 #include "llvm/Support/JSON.h"
 #include "llvm/Support/ScopedPrinter.h"
 
+#include "GDBRemoteAgentExpression.h"
 #include "ProcessGDBRemote.h"
 #include "ProcessGDBRemoteLog.h"
 #include "lldb/Utility/StringExtractorGDBRemote.h"
@@ -113,6 +114,9 @@ void GDBRemoteCommunicationServerLLGS::RegisterPacketHandlers() {
   RegisterMemberFunctionHandler(
       StringExtractorGDBRemote::eServerPacketType_qMemoryRegionInfoSupported,
       &GDBRemoteCommunicationServerLLGS::Handle_qMemoryRegionInfoSupported);
+  RegisterMemberFunctionHandler(
+      StringExtractorGDBRemote::eServerPacketType_qMultiMemRead,
+      &GDBRemoteCommunicationServerLLGS::Handle_qMultiMemRead);
   RegisterMemberFunctionHandler(
       StringExtractorGDBRemote::eServerPacketType_qProcessInfo,
       &GDBRemoteCommunicationServerLLGS::Handle_qProcessInfo);
@@ -835,6 +839,141 @@ void GDBRemoteCommunicationServerLLGS::HandleInferiorState_Stopped(
   }
 }
 
+bool GDBRemoteCommunicationServerLLGS::ResumeFromFalseCondition(
+    NativeProcessProtocol &process) {
+  Log *log(GetLogIfAnyCategoriesSet(LIBLLDB_LOG_BREAKPOINTS));
+
+  // Find the thread that stopped. If several threads stopped for a reason,
+  // let the client sort them out.
+  NativeThreadProtocol *stopped_thread = nullptr;
+  ThreadStopInfo stop_info;
+  uint32_t num_stopped = 0;
+  for (uint32_t i = 0;; ++i) {
+    NativeThreadProtocol *thread = process.GetThreadAtIndex(i);
+    if (!thread)
+      break;
+    ThreadStopInfo thread_stop_info;
+    std::string description;
+    if (!thread->GetStopReason(thread_stop_info, description) ||
+        thread_stop_info.reason == eStopReasonNone)
+      continue;
+    ++num_stopped;
+    stopped_thread = thread;
+    stop_info = thread_stop_info;
+  }
+
+  // We were stepping over a breakpoint whose conditions were false. Put the
+  // breakpoint back, and continue unless the step stopped for another reason.
+  if (m_condition_step_tid != LLDB_INVALID_THREAD_ID) {
+    const lldb::tid_t step_tid = m_condition_step_tid;
+    const lldb::addr_t step_addr = m_condition_step_addr;
+    m_condition_step_tid = LLDB_INVALID_THREAD_ID;
+    m_condition_step_addr = LLDB_INVALID_ADDRESS;
+
+    auto pos = m_breakpoints.find(step_addr);
+    if (pos != m_breakpoints.end()) {
+      Status error = process.SetBreakpoint(step_addr, pos->second.size,
+                                           pos->second.hardware);
+      if (error.Fail()) {
+        LLDB_LOG(log, "failed to reinsert breakpoint at {0:x}: {1}",
+                 step_addr, error);
+        m_breakpoints.erase(pos);
+        return false;
+      }
+    }
+    if (num_stopped != 1 || stopped_thread->GetID() != step_tid ||
+        stop_info.reason != eStopReasonTrace)
+      return false;
+
+    Status error = process.Resume(
+        ResumeActionList(eStateRunning, LLDB_INVALID_SIGNAL_NUMBER));
+    if (error.Fail()) {
+      LLDB_LOG(log, "failed to resume after a false condition: {0}", error);
+      return false;
+    }
+    return true;
+  }
+
+  if (num_stopped != 1 || stop_info.reason != eStopReasonBreakpoint)
+    return false;
+
+  NativeRegisterContext &reg_ctx = stopped_thread->GetRegisterContext();
+  const lldb::addr_t pc = reg_ctx.GetPC();
+  auto pos = m_breakpoints.find(pc);
+  if (pos == m_breakpoints.end() || pos->second.conditions.empty())
+    return false;
+
+  auto read_register = [&](uint32_t reg) -> llvm::Expected<uint64_t> {
+    const RegisterInfo *reg_info = reg_ctx.GetRegisterInfoAtIndex(reg);
+    if (!reg_info || reg_info->byte_size > 8)
+      return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                     "invalid register %u", reg);
+    RegisterValue value;
+    Status error = reg_ctx.ReadRegister(reg_info, value);
+    if (error.Fail())
+      return error.ToError();
+    bool success = false;
+    uint64_t result = value.GetAsUInt64(0, &success);
+    if (!success)
+      return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                     "failed to read register %u", reg);
+    return result;
+  };
+  auto read_memory = [&](lldb::addr_t addr,
+                         uint32_t size) -> llvm::Expected<uint64_t> {
+    uint8_t buf[8];
+    size_t bytes_read = 0;
+    Status error = process.ReadMemoryWithoutTrap(addr, buf, size, bytes_read);
+    if (error.Fail())
+      return error.ToError();
+    if (bytes_read != size)
+      return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                     "failed to read memory at 0x%" PRIx64,
+                                     addr);
+    DataExtractor data(buf, size, process.GetByteOrder(),
+                       process.GetAddressByteSize());
+    lldb::offset_t offset = 0;
+    return data.GetMaxU64(&offset, size);
+  };
+
+  // Report the hit if any condition is true, or can't be evaluated.
+  for (const std::string &condition : pos->second.conditions) {
+    llvm::Expected<uint64_t> result =
+        EvaluateAgentExpression(condition, read_register, read_memory);
+    if (!result) {
+      LLDB_LOG_ERROR(log, result.takeError(),
+                     "failed to evaluate condition at {1:x}: {0}", pc);
+      return false;
+    }
+    if (*result)
+      return false;
+  }
+
+  // Step the thread over the breakpoint while the other threads stay
+  // stopped. We get here again when the step is done.
+  const lldb::tid_t tid = stopped_thread->GetID();
+  LLDB_LOG(log, "conditions at {0:x} are false, stepping tid {1} over it", pc,
+           tid);
+  Status error = process.RemoveBreakpoint(pc, pos->second.hardware);
+  if (error.Fail()) {
+    LLDB_LOG(log, "failed to remove breakpoint at {0:x}: {1}", pc, error);
+    return false;
+  }
+
+  ResumeActionList actions;
+  actions.AppendAction(tid, eStateStepping);
+  actions.SetDefaultThreadActionIfNeeded(eStateStopped, 0);
+  error = process.Resume(actions);
+  if (error.Fail()) {
+    LLDB_LOG(log, "failed to step over breakpoint at {0:x}: {1}", pc, error);
+    process.SetBreakpoint(pc, pos->second.size, pos->second.hardware);
+    return false;
+  }
+  m_condition_step_tid = tid;
+  m_condition_step_addr = pc;
+  return true;
+}
+
 void GDBRemoteCommunicationServerLLGS::ProcessStateChanged(
     NativeProcessProtocol *process, lldb::StateType state) {
   assert(process && "process cannot be NULL");
@@ -858,6 +997,8 @@ void GDBRemoteCommunicationServerLLGS::ProcessStateChanged(
     // Then stop the forwarding, so that any late output (see llvm.org/pr25652)
     // does not interfere with our protocol.
     StopSTDIOForwarding();
+    if (ResumeFromFalseCondition(*process))
+      break;
     HandleInferiorState_Stopped(process);
     break;
 
@@ -2335,6 +2476,67 @@ GDBRemoteCommunicationServerLLGS::Handle_memory_read(
   return SendPacketNoLock(response.GetString());
 }
 
+GDBRemoteCommunication::PacketResult
+GDBRemoteCommunicationServerLLGS::Handle_qMultiMemRead(
+    StringExtractorGDBRemote &packet) {
+  Log *log(GetLogIfAnyCategoriesSet(LIBLLDB_LOG_PROCESS));
+
+  if (!m_debugged_process_up ||
+      (m_debugged_process_up->GetID() == LLDB_INVALID_PROCESS_ID)) {
+    LLDB_LOGF(
+        log,
+        "GDBRemoteCommunicationServerLLGS::%s failed, no process available",
+        __FUNCTION__);
+    return SendErrorResponse(0x15);
+  }
+
+  // Parse out the ranges: qMultiMemRead:<addr>,<size>[;<addr>,<size>]*
+  packet.SetFilePos(strlen("qMultiMemRead:"));
+  std::vector<std::pair<lldb::addr_t, uint64_t>> ranges;
+  uint64_t total_size = 0;
+  while (packet.GetBytesLeft() > 0) {
+    if (!ranges.empty() && packet.GetChar() != ';')
+      return SendIllFormedResponse(packet,
+                                   "Semicolon sep missing in qMultiMemRead");
+    const lldb::addr_t addr = packet.GetHexMaxU64(false, LLDB_INVALID_ADDRESS);
+    if (addr == LLDB_INVALID_ADDRESS || packet.GetChar() != ',')
+      return SendIllFormedResponse(packet,
+                                   "Comma sep missing in qMultiMemRead");
+    const uint64_t size = packet.GetHexMaxU64(false, UINT64_MAX);
+    if (size == UINT64_MAX)
+      return SendIllFormedResponse(packet, "Length missing in qMultiMemRead");
+    total_size += size;
+    ranges.emplace_back(addr, size);
+  }
+  // Don't let a client make us allocate unreasonable amounts of memory.
+  if (ranges.empty() || total_size > 16 * 1024 * 1024)
+    return SendErrorResponse(0x78);
+
+  // Reply with the number of bytes read from each range, followed by the
+  // data of all ranges.
+  std::string data;
+  StreamGDBRemote response;
+  for (size_t i = 0; i < ranges.size(); ++i) {
+    std::string buf(ranges[i].second, '\0');
+    size_t bytes_read = 0;
+    Status error = m_debugged_process_up->ReadMemoryWithoutTrap(
+        ranges[i].first, &buf[0], buf.size(), bytes_read);
+    if (error.Fail()) {
+      LLDB_LOGF(log,
+                "GDBRemoteCommunicationServerLLGS::%s pid %" PRIu64
+                " mem 0x%" PRIx64 ": failed to read. Error: %s",
+                __FUNCTION__, m_debugged_process_up->GetID(), ranges[i].first,
+                error.AsCString());
+      bytes_read = 0;
+    }
+    response.Printf("%s%" PRIx64, i == 0 ? "" : ",", (uint64_t)bytes_read);
+    data.append(buf.data(), bytes_read);
+  }
+  response.PutChar(';');
+  response.PutEscapedBytes(data.data(), data.size());
+  return SendPacketNoLock(response.GetString());
+}
+
 GDBRemoteCommunication::PacketResult
 GDBRemoteCommunicationServerLLGS::Handle_M(StringExtractorGDBRemote &packet) {
   Log *log(GetLogIfAnyCategoriesSet(LIBLLDB_LOG_PROCESS));
@@ -2589,12 +2791,37 @@ GDBRemoteCommunicationServerLLGS::Handle_Z(StringExtractorGDBRemote &packet) {
     return SendIllFormedResponse(
         packet, "Malformed Z packet, failed to parse size argument");
 
+  // Parse out the conditions: ;X<len>,<bytecode>, where the agent expression
+  // bytecode is hex encoded. Ignore target side commands (;cmds:...).
+  std::vector<std::string> conditions;
+  while (packet.GetBytesLeft() > 0 && packet.GetChar() == ';') {
+    if (packet.GetChar() != 'X')
+      break;
+    const uint32_t len = packet.GetHexMaxU32(false, 0);
+    if (len == 0 || packet.GetChar() != ',')
+      return SendIllFormedResponse(packet, "Malformed Z packet condition");
+    std::string condition;
+    if (packet.GetHexByteString(condition) != len)
+      return SendIllFormedResponse(
+          packet, "Malformed Z packet, condition length mismatch");
+    conditions.push_back(std::move(condition));
+  }
+
   if (want_breakpoint) {
+    // Inserting a breakpoint again only updates its conditions.
+    auto pos = m_breakpoints.find(addr);
+    if (pos != m_breakpoints.end()) {
+      pos->second.conditions = std::move(conditions);
+      return SendOKResponse();
+    }
+
     // Try to set the breakpoint.
     const Status error =
         m_debugged_process_up->SetBreakpoint(addr, size, want_hardware);
-    if (error.Success())
+    if (error.Success()) {
+      m_breakpoints[addr] = {size, want_hardware, std::move(conditions)};
       return SendOKResponse();
+    }
     Log *log(GetLogIfAnyCategoriesSet(LIBLLDB_LOG_BREAKPOINTS));
     LLDB_LOG(log, "pid {0} failed to set breakpoint: {1}",
              m_debugged_process_up->GetID(), error);
@@ -2681,8 +2908,10 @@ GDBRemoteCommunicationServerLLGS::Handle_z(StringExtractorGDBRemote &packet) {
     // Try to clear the breakpoint.
     const Status error =
         m_debugged_process_up->RemoveBreakpoint(addr, want_hardware);
-    if (error.Success())
+    if (error.Success()) {
+      m_breakpoints.erase(addr);
       return SendOKResponse();
+    }
     Log *log(GetLogIfAnyCategoriesSet(LIBLLDB_LOG_BREAKPOINTS));
     LLDB_LOG(log, "pid {0} failed to remove breakpoint: {1}",
              m_debugged_process_up->GetID(), error);
@@ -3287,6 +3516,10 @@ void GDBRemoteCommunicationServerLLGS::ClearProcessSpecificData() {
 
   LLDB_LOG(log, "clearing {0} xfer buffers", m_xfer_buffer_map.size());
   m_xfer_buffer_map.clear();
+
+  m_breakpoints.clear();
+  m_condition_step_tid = LLDB_INVALID_THREAD_ID;
+  m_condition_step_addr = LLDB_INVALID_ADDRESS;
 }
 
 FileSpec
@@ -9,6 +9,7 @@
 #ifndef liblldb_GDBRemoteCommunicationServerLLGS_h_
 #define liblldb_GDBRemoteCommunicationServerLLGS_h_
 
+#include <map>
 #include <mutex>
 #include <unordered_map>
 
@@ -88,6 +89,21 @@ protected:
   uint32_t m_next_saved_registers_id = 1;
   bool m_handshake_completed = false;
 
+  /// A breakpoint that the client inserted with Z0 or Z1, and the agent
+  /// expressions of its conditions. A hit is only reported to the client if
+  /// there are no conditions, or if any of them is true.
+  struct ConditionalBreakpoint {
+    uint32_t size;
+    bool hardware;
+    std::vector<std::string> conditions;
+  };
+  std::map<lldb::addr_t, ConditionalBreakpoint> m_breakpoints;
+
+  /// The thread that is stepping over a breakpoint whose conditions were
+  /// false, and the address of that breakpoint.
+  lldb::tid_t m_condition_step_tid = LLDB_INVALID_THREAD_ID;
+  lldb::addr_t m_condition_step_addr = LLDB_INVALID_ADDRESS;
+
   PacketResult SendONotification(const char *buffer, uint32_t len);
 
   PacketResult SendWResponse(NativeProcessProtocol *process);
@@ -137,6 +153,8 @@ protected:
   // Handles $m and $x packets.
   PacketResult Handle_memory_read(StringExtractorGDBRemote &packet);
 
+  PacketResult Handle_qMultiMemRead(StringExtractorGDBRemote &packet);
+
   PacketResult Handle_M(StringExtractorGDBRemote &packet);
 
   PacketResult
@@ -203,6 +221,12 @@ private:
 
   void HandleInferiorState_Stopped(NativeProcessProtocol *process);
 
+  /// Called when the process stopped. If it stopped only because a thread
+  /// hit a breakpoint whose conditions are all false, this steps the thread
+  /// over the breakpoint and resumes the process without telling the client,
+  /// and returns true.
+  bool ResumeFromFalseCondition(NativeProcessProtocol &process);
+
   NativeThreadProtocol *GetThreadFromSuffix(StringExtractorGDBRemote &packet);
 
   uint32_t GetNextSavedRegistersID();
@@ -27,6 +27,7 @@
 #include <mutex>
 #include <sstream>
 
+#include "lldb/Breakpoint/BreakpointLocation.h"
 #include "lldb/Breakpoint/Watchpoint.h"
 #include "lldb/Core/Debugger.h"
 #include "lldb/Core/Module.h"
@@ -69,6 +70,7 @@
 #include "lldb/Utility/StreamString.h"
 #include "lldb/Utility/Timer.h"
 
+#include "GDBRemoteAgentExpression.h"
 #include "GDBRemoteRegisterContext.h"
 #include "Plugins/Platform/MacOSX/PlatformRemoteiOS.h"
 #include "Plugins/Process/Utility/GDBRemoteSignals.h"
@@ -1290,6 +1292,8 @@ Status ProcessGDBRemote::DoResume() {
   Log *log(ProcessGDBRemoteLog::GetLogIfAllCategoriesSet(GDBR_LOG_PROCESS));
   LLDB_LOGF(log, "ProcessGDBRemote::Resume()");
 
+  UpdateStubBreakpointConditions();
+
   ListenerSP listener_sp(
       Listener::MakeListener("gdb-remote.resume-packet-sent"));
   if (listener_sp->StartListeningForEvents(
@@ -2776,6 +2780,52 @@ size_t ProcessGDBRemote::DoReadMemory(addr_t addr, void *buf, size_t size,
   return 0;
 }
 
+std::vector<DataBufferSP> ProcessGDBRemote::DoReadMemoryRanges(
+    llvm::ArrayRef<Range<addr_t, addr_t>> ranges) {
+  if (!m_gdb_comm.GetMultiMemReadSupported())
+    return Process::DoReadMemoryRanges(ranges);
+
+  GetMaxMemorySize();
+  std::vector<DataBufferSP> buffers(ranges.size());
+  // Send as many ranges per packet as fit into the reply. Ranges that don't
+  // fit into a single reply are read with x or m packets.
+  size_t i = 0;
+  while (i < ranges.size()) {
+    std::vector<std::pair<addr_t, addr_t>> batch;
+    uint64_t batch_size = 0;
+    const size_t first = i;
+    for (; i < ranges.size(); ++i) {
+      const uint64_t size = ranges[i].GetByteSize();
+      if (size > m_max_memory_size || batch_size + size > m_max_memory_size)
+        break;
+      batch.emplace_back(ranges[i].GetRangeBase(), size);
+      batch_size += size;
+    }
+    if (batch.empty()) {
+      buffers[i] = Process::DoReadMemoryRanges(ranges.slice(i, 1))[0];
+      ++i;
+      continue;
+    }
+
+    llvm::Expected<std::vector<std::string>> data_or_err =
+        m_gdb_comm.ReadMemoryRanges(batch);
+    if (!data_or_err) {
+      LLDB_LOG_ERROR(ProcessGDBRemoteLog::GetLogIfAnyCategoryIsSet(
+                         GDBR_LOG_MEMORY),
+                     data_or_err.takeError(),
+                     "qMultiMemRead failed, reading ranges one by one: {0}");
+      std::vector<DataBufferSP> fallback =
+          Process::DoReadMemoryRanges(ranges.slice(first, batch.size()));
+      std::move(fallback.begin(), fallback.end(), buffers.begin() + first);
+      continue;
+    }
+    for (size_t j = 0; j < data_or_err->size(); ++j)
+      buffers[first + j] = std::make_shared<DataBufferHeap>(
+          (*data_or_err)[j].data(), (*data_or_err)[j].size());
+  }
+  return buffers;
+}
+
 Status ProcessGDBRemote::WriteObjectFile(
     std::vector<ObjectFile::LoadableData> entries) {
   Status error;
@@ -3131,12 +3181,15 @@ Status ProcessGDBRemote::EnableBreakpointSite(BreakpointSite *bp_site) {
   if (m_gdb_comm.SupportsGDBStoppointPacket(eBreakpointSoftware) &&
       (!bp_site->HardwareRequired())) {
     // Try to send off a software breakpoint packet ($Z0)
+    std::vector<std::string> conditions = GetStubBreakpointConditions(*bp_site);
     uint8_t error_no = m_gdb_comm.SendGDBStoppointTypePacket(
-        eBreakpointSoftware, true, addr, bp_op_size);
+        eBreakpointSoftware, true, addr, bp_op_size, conditions);
     if (error_no == 0) {
       // The breakpoint was placed successfully
       bp_site->SetEnabled(true);
       bp_site->SetType(BreakpointSite::eExternal);
+      if (m_gdb_comm.GetConditionalBreakpointsSupported())
+        m_stub_breakpoint_conditions[site_id] = std::move(conditions);
       return error;
     }
 
@@ -3171,12 +3224,15 @@ Status ProcessGDBRemote::EnableBreakpointSite(BreakpointSite *bp_site) {
   // hardware breakpoint.
   if (m_gdb_comm.SupportsGDBStoppointPacket(eBreakpointHardware)) {
     // Try to send off a hardware breakpoint packet ($Z1)
+    std::vector<std::string> conditions = GetStubBreakpointConditions(*bp_site);
     uint8_t error_no = m_gdb_comm.SendGDBStoppointTypePacket(
-        eBreakpointHardware, true, addr, bp_op_size);
+        eBreakpointHardware, true, addr, bp_op_size, conditions);
     if (error_no == 0) {
       // The breakpoint was placed successfully
       bp_site->SetEnabled(true);
       bp_site->SetType(BreakpointSite::eHardware);
+      if (m_gdb_comm.GetConditionalBreakpointsSupported())
+        m_stub_breakpoint_conditions[site_id] = std::move(conditions);
       return error;
     }
 
@@ -3214,6 +3270,80 @@ Status ProcessGDBRemote::EnableBreakpointSite(BreakpointSite *bp_site) {
   return EnableSoftwareBreakpoint(bp_site);
 }
 
+std::vector<std::string>
+ProcessGDBRemote::GetStubBreakpointConditions(BreakpointSite &bp_site) {
+  if (!m_gdb_comm.GetConditionalBreakpointsSupported())
+    return {};
+
+  auto lookup_register =
+      [&](llvm::StringRef name) -> llvm::Optional<AgentExpressionRegister> {
+    const size_t num_regs = m_register_info.GetNumRegisters();
+    for (size_t i = 0; i < num_regs; ++i) {
+      const RegisterInfo *reg_info = m_register_info.GetRegisterInfoAtIndex(i);
+      if (!reg_info || name != reg_info->name)
+        continue;
+      // Registers that are part of another register can't be read on their
+      // own.
+      if (reg_info->value_regs || (reg_info->encoding != eEncodingUint &&
+                                   reg_info->encoding != eEncodingSint))
+        return llvm::None;
+      return AgentExpressionRegister{
+          reg_info->kinds[eRegisterKindProcessPlugin], reg_info->byte_size,
+          reg_info->encoding == eEncodingSint};
+    }
+    return llvm::None;
+  };
+
+  Log *log(ProcessGDBRemoteLog::GetLogIfAllCategoriesSet(GDBR_LOG_BREAKPOINTS));
+  std::vector<std::string> conditions;
+  const size_t num_owners = bp_site.GetNumberOfOwners();
+  for (size_t i = 0; i < num_owners; ++i) {
+    BreakpointLocationSP loc_sp = bp_site.GetOwnerAtIndex(i);
+    const char *condition = loc_sp ? loc_sp->GetConditionText() : nullptr;
+    if (!condition || !condition[0])
+      return {};
+    llvm::Expected<std::string> bytecode = CompileAgentExpression(
+        condition, GetAddressByteSize(), lookup_register);
+    if (!bytecode) {
+      LLDB_LOG_ERROR(log, bytecode.takeError(),
+                     "condition \"{1}\" is evaluated by lldb: {0}",
+                     condition);
+      return {};
+    }
+    conditions.push_back(std::move(*bytecode));
+  }
+  return conditions;
+}
+
+void ProcessGDBRemote::UpdateStubBreakpointConditions() {
+  BreakpointSiteList &sites = GetBreakpointSiteList();
+  for (auto pos = m_stub_breakpoint_conditions.begin();
+       pos != m_stub_breakpoint_conditions.end();) {
+    BreakpointSiteSP bp_site_sp = sites.FindByID(pos->first);
+    if (!bp_site_sp || !bp_site_sp->IsEnabled()) {
+      pos = m_stub_breakpoint_conditions.erase(pos);
+      continue;
+    }
+    std::vector<std::string> conditions =
+        GetStubBreakpointConditions(*bp_site_sp);
+    if (conditions != pos->second) {
+      // The stub treats the insertion of an existing breakpoint as an update
+      // of its conditions.
+      GDBStoppointType type =
+          bp_site_sp->GetType() == BreakpointSite::eHardware ||
+                  bp_site_sp->IsHardware()
+              ? eBreakpointHardware
+              : eBreakpointSoftware;
+      if (m_gdb_comm.SendGDBStoppointTypePacket(
+              type, true, bp_site_sp->GetLoadAddress(),
+              GetSoftwareBreakpointTrapOpcode(bp_site_sp.get()),
+              conditions) == 0)
+        pos->second = std::move(conditions);
+    }
+    ++pos;
+  }
+}
+
 Status ProcessGDBRemote::DisableBreakpointSite(BreakpointSite *bp_site) {
   Status error;
   assert(bp_site != nullptr);
@@ -3252,8 +3382,10 @@ Status ProcessGDBRemote::DisableBreakpointSite(BreakpointSite *bp_site) {
         error.SetErrorToGenericError();
     } break;
     }
-    if (error.Success())
+    if (error.Success()) {
       bp_site->SetEnabled(false);
+      m_stub_breakpoint_conditions.erase(site_id);
+    }
   } else {
     LLDB_LOGF(log,
               "ProcessGDBRemote::DisableBreakpointSite (site_id = %" PRIu64
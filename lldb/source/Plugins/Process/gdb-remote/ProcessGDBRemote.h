@@ -133,6 +133,9 @@ public:
   size_t DoReadMemory(lldb::addr_t addr, void *buf, size_t size,
                       Status &error) override;
 
+  std::vector<lldb::DataBufferSP> DoReadMemoryRanges(
+      llvm::ArrayRef<Range<lldb::addr_t, lldb::addr_t>> ranges) override;
+
   Status
   WriteObjectFile(std::vector<ObjectFile::LoadableData> entries) override;
 
@@ -410,6 +413,20 @@ private:
   std::string m_partial_profile_data;
   std::map<uint64_t, uint32_t> m_thread_id_to_used_usec_map;
   uint64_t m_last_signals_version = 0;
+  /// The conditions that were sent to the stub with the Z0 or Z1 packet of a
+  /// breakpoint site, by site ID.
+  std::map<lldb::user_id_t, std::vector<std::string>>
+      m_stub_breakpoint_conditions;
+
+  /// Compiles the conditions of all owners of \p bp_site into agent
+  /// expressions. Returns nothing if the stub doesn't evaluate conditions, or
+  /// if one of the owners has no condition or one that the stub can't
+  /// evaluate: the stub may only resume from a hit if lldb wouldn't stop.
+  std::vector<std::string> GetStubBreakpointConditions(BreakpointSite &bp_site);
+
+  /// Sends the conditions of breakpoint sites whose conditions changed since
+  /// they were inserted.
+  void UpdateStubBreakpointConditions();
 
   static bool NewThreadNotifyBreakpointHit(void *baton,
                                            StoppointCallbackContext *context,
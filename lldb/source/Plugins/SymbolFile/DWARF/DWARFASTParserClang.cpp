@@ -2642,8 +2642,12 @@ bool DWARFASTParserClang::ParseChildMembers(
           if (var_type) {
             if (accessibility == eAccessNone)
               accessibility = eAccessPublic;
+            // Unlike a field, a static member doesn't need a complete type
+            // for the layout of the class. Its type is completed lazily when
+            // something looks inside of it, so completing the class doesn't
+            // complete all the types that are reachable from static members.
             ClangASTContext::AddVariableToRecordType(
-                class_clang_type, name, var_type->GetLayoutCompilerType(),
+                class_clang_type, name, var_type->GetForwardCompilerType(),
                 accessibility);
           }
           break;
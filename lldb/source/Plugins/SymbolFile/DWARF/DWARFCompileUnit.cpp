@@ -62,7 +62,8 @@ void DWARFCompileUnit::BuildAddressRangeTable(
   // the DWARF and then throwing them all away to keep memory usage down.
   ScopedExtractDIEs clear_dies(ExtractDIEsScoped());
 
-  die = DIEPtr();
+  // DIEPtr() would keep the DIEs in memory for good.
+  die = ExtractedDIEPtr();
   if (die)
     die->BuildAddressRangeTable(this, debug_aranges);
 
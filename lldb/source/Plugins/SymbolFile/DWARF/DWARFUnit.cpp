@@ -425,6 +425,17 @@ void DWARFUnit::SetStrOffsetsBase(dw_offset_t str_offsets_base) {
   m_str_offsets_base = str_offsets_base;
 }
 
+size_t DWARFUnit::GetDIEMemorySize() const {
+  size_t size;
+  {
+    llvm::sys::ScopedReader lock(m_die_array_mutex);
+    size = m_die_array.capacity() * sizeof(DWARFDebugInfoEntry);
+  }
+  if (m_dwo_symbol_file)
+    size += m_dwo_symbol_file->GetCompileUnit()->GetDIEMemorySize();
+  return size;
+}
+
 // It may be called only with m_die_array_mutex held R/W.
 void DWARFUnit::ClearDIEsRWLocked() {
   m_die_array.clear();
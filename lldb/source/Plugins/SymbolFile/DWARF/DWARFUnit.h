@@ -204,6 +204,10 @@ public:
 
   SymbolFileDWARFDwo *GetDwoSymbolFile() const;
 
+  /// Returns the number of bytes used by the DIEs of this unit, and those of
+  /// its split unit, that are currently extracted.
+  size_t GetDIEMemorySize() const;
+
   die_iterator_range dies() {
     ExtractDIEsIfNeeded();
     return die_iterator_range(m_die_array.begin(), m_die_array.end());
@@ -246,6 +250,12 @@ protected:
   // Get all DWARF debug informration entries. Parse all DIEs if needed.
   const DWARFDebugInfoEntry *DIEPtr() {
     ExtractDIEsIfNeeded();
+    return ExtractedDIEPtr();
+  }
+
+  // Get the DIEs that are already extracted. Unlike DIEPtr(), this doesn't
+  // keep the DIEs extracted by an enclosing ScopedExtractDIEs in memory.
+  const DWARFDebugInfoEntry *ExtractedDIEPtr() const {
     if (m_die_array.empty())
       return NULL;
     return &m_die_array[0];
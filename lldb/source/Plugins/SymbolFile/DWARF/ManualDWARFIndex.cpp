@@ -17,10 +17,21 @@
 #include "lldb/Symbol/ObjectFile.h"
 #include "lldb/Utility/Stream.h"
 #include "lldb/Utility/Timer.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/Support/DataExtractor.h"
+#include "llvm/Support/EndianStream.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/xxhash.h"
 
 using namespace lldb_private;
 using namespace lldb;
 
+// Cache files start with this magic and version. Bump the version when the
+// layout of the file or the contents of the index change.
+static const uint32_t g_cache_magic = 0x58444e49; // "INDX"
+static const uint32_t g_cache_version = 1;
+
 void ManualDWARFIndex::Index() {
   if (!m_debug_info)
     return;
@@ -31,6 +42,10 @@ void ManualDWARFIndex::Index() {
   static Timer::Category func_cat(LLVM_PRETTY_FUNCTION);
   Timer scoped_timer(func_cat, "%p", static_cast<void *>(&debug_info));
 
+  FileSpec cache_file = GetCacheFile();
+  if (cache_file && LoadFromCache(cache_file))
+    return;
+
   std::vector<DWARFUnit *> units_to_index;
   units_to_index.reserve(debug_info.GetNumUnits());
   for (size_t U = 0; U < debug_info.GetNumUnits(); ++U) {
@@ -85,6 +100,175 @@ void ManualDWARFIndex::Index() {
                      [&]() { finalize_fn(&IndexSet::globals); },
                      [&]() { finalize_fn(&IndexSet::types); },
                      [&]() { finalize_fn(&IndexSet::namespaces); });
+
+  // The .dwo files of split DWARF can change without the module changing,
+  // so only cache the index if all of it comes from the module.
+  if (cache_file &&
+      llvm::none_of(units_to_index, [](DWARFUnit *unit) {
+        return unit->GetDwoSymbolFile() != nullptr;
+      }))
+    SaveToCache(cache_file);
+}
+
+std::array<NameToDIE *, 8> ManualDWARFIndex::GetNameMaps() {
+  return {{&m_set.function_basenames, &m_set.function_fullnames,
+           &m_set.function_methods, &m_set.function_selectors,
+           &m_set.objc_class_selectors, &m_set.globals, &m_set.types,
+           &m_set.namespaces}};
+}
+
+FileSpec ManualDWARFIndex::GetCacheFile() {
+  if (!m_cache_dir)
+    return FileSpec();
+  const auto mod_time = m_module.GetModificationTime();
+  if (mod_time == llvm::sys::TimePoint<>() && !m_module.GetUUID().IsValid())
+    return FileSpec();
+
+  // Identify the module by path, architecture, UUID and modification time,
+  // so that a rebuilt module gets a new cache file. The units to avoid are
+  // part of the key, as they change what the index contains.
+  std::string key;
+  llvm::raw_string_ostream key_os(key);
+  key_os << m_module.GetFileSpec().GetPath() << '\0'
+         << m_module.GetObjectName().GetStringRef() << '\0'
+         << m_module.GetArchitecture().GetTriple().str() << '\0'
+         << m_module.GetUUID().GetAsString() << '\0'
+         << mod_time.time_since_epoch().count();
+  std::vector<dw_offset_t> units_to_avoid(m_units_to_avoid.begin(),
+                                          m_units_to_avoid.end());
+  llvm::sort(units_to_avoid);
+  for (dw_offset_t offset : units_to_avoid)
+    key_os << '\0' << offset;
+
+  FileSpec cache_file = m_cache_dir;
+  cache_file.AppendPathComponent(
+      (m_module.GetFileSpec().GetFilename().GetStringRef() + "-" +
+       llvm::utohexstr(llvm::xxHash64(key_os.str()), /*LowerCase=*/true) +
+       ".dwarfindex")
+          .str());
+  return cache_file;
+}
+
+// The cache file contains, in little endian:
+//   uint32_t magic, version
+//   uint32_t string table size, followed by the NUL terminated names
+//   for each name map:
+//     uint32_t number of entries, followed by one entry per name:
+//     uint32_t name offset, dwo number (or UINT32_MAX), DIE offset
+//     uint8_t section
+bool ManualDWARFIndex::LoadFromCache(const FileSpec &cache_file) {
+  auto buffer_or_err = llvm::MemoryBuffer::getFile(
+      cache_file.GetPath(), /*FileSize=*/-1, /*RequiresNullTerminator=*/false);
+  if (!buffer_or_err)
+    return false;
+  llvm::DataExtractor data((*buffer_or_err)->getBuffer(),
+                           /*IsLittleEndian=*/true, /*AddressSize=*/8);
+  uint64_t offset = 0;
+  if (!data.isValidOffsetForDataOfSize(offset, 12) ||
+      data.getU32(&offset) != g_cache_magic ||
+      data.getU32(&offset) != g_cache_version)
+    return false;
+  const uint32_t strtab_size = data.getU32(&offset);
+  if (!data.isValidOffsetForDataOfSize(offset, strtab_size))
+    return false;
+  llvm::StringRef strtab = data.getData().substr(offset, strtab_size);
+  if (!strtab.empty() && strtab.back() != '\0')
+    return false;
+  offset += strtab_size;
+
+  auto load_map = [&](NameToDIE &map) {
+    if (!data.isValidOffsetForDataOfSize(offset, 4))
+      return false;
+    const uint32_t count = data.getU32(&offset);
+    if (!data.isValidOffsetForDataOfSize(offset, uint64_t(count) * 13))
+      return false;
+    for (uint32_t i = 0; i < count; ++i) {
+      const uint32_t name = data.getU32(&offset);
+      const uint32_t dwo_num = data.getU32(&offset);
+      const uint32_t die_offset = data.getU32(&offset);
+      const uint8_t section = data.getU8(&offset);
+      if (name >= strtab.size() || section > DIERef::DebugTypes ||
+          (dwo_num != UINT32_MAX && dwo_num >= (1u << 30)))
+        return false;
+      llvm::Optional<uint32_t> dwo;
+      if (dwo_num != UINT32_MAX)
+        dwo = dwo_num;
+      map.Insert(ConstString(strtab.data() + name),
+                 DIERef(dwo, static_cast<DIERef::Section>(section),
+                        die_offset));
+    }
+    return true;
+  };
+  for (NameToDIE *map : GetNameMaps()) {
+    if (!load_map(*map)) {
+      m_set = IndexSet();
+      return false;
+    }
+  }
+
+  // The maps are sorted by the addresses of the names, which differ between
+  // sessions.
+  for (NameToDIE *map : GetNameMaps())
+    map->Finalize();
+
+  if (Log *log = LogChannelDWARF::GetLogIfAll(DWARF_LOG_DEBUG_INFO))
+    m_module.LogMessage(log, "ManualDWARFIndex::Index loaded index from '%s'",
+                        cache_file.GetPath().c_str());
+  return true;
+}
+
+void ManualDWARFIndex::SaveToCache(const FileSpec &cache_file) {
+  std::string strtab;
+  llvm::DenseMap<const char *, uint32_t> name_offsets;
+  std::string maps;
+  llvm::raw_string_ostream maps_os(maps);
+  llvm::support::endian::Writer maps_writer(maps_os, llvm::support::little);
+  for (NameToDIE *map : GetNameMaps()) {
+    uint32_t count = 0;
+    map->ForEach([&](ConstString, const DIERef &) {
+      ++count;
+      return true;
+    });
+    maps_writer.write<uint32_t>(count);
+    map->ForEach([&](ConstString name, const DIERef &ref) {
+      auto insert_result = name_offsets.try_emplace(name.GetCString(), 0);
+      if (insert_result.second) {
+        insert_result.first->second = strtab.size();
+        strtab += name.GetStringRef();
+        strtab += '\0';
+      }
+      maps_writer.write<uint32_t>(insert_result.first->second);
+      maps_writer.write<uint32_t>(ref.dwo_num().getValueOr(UINT32_MAX));
+      maps_writer.write<uint32_t>(ref.die_offset());
+      maps_writer.write<uint8_t>(ref.section());
+      return true;
+    });
+  }
+  maps_os.flush();
+
+  // Write to a temporary file first, so that a concurrent session never sees
+  // a partially written cache file.
+  const std::string path = cache_file.GetPath();
+  llvm::sys::fs::create_directories(m_cache_dir.GetPath());
+  int fd;
+  llvm::SmallString<128> tmp_path;
+  if (llvm::sys::fs::createUniqueFile(path + "-%%%%%%.tmp", fd, tmp_path))
+    return;
+  {
+    llvm::raw_fd_ostream os(fd, /*shouldClose=*/true);
+    llvm::support::endian::Writer writer(os, llvm::support::little);
+    writer.write<uint32_t>(g_cache_magic);
+    writer.write<uint32_t>(g_cache_version);
+    writer.write<uint32_t>(strtab.size());
+    os << strtab << maps;
+    if (os.has_error()) {
+      os.clear_error();
+      llvm::sys::fs::remove(tmp_path);
+      return;
+    }
+  }
+  if (llvm::sys::fs::rename(tmp_path, path))
+    llvm::sys::fs::remove(tmp_path);
 }
 
 void ManualDWARFIndex::IndexUnit(DWARFUnit &unit, IndexSet &set) {
@@ -11,17 +11,25 @@
 
 #include "Plugins/SymbolFile/DWARF/DWARFIndex.h"
 #include "Plugins/SymbolFile/DWARF/NameToDIE.h"
+#include "lldb/Utility/FileSpec.h"
 #include "llvm/ADT/DenseSet.h"
+#include <array>
 
 class DWARFDebugInfo;
 
 namespace lldb_private {
 class ManualDWARFIndex : public DWARFIndex {
 public:
+  /// \param[in] cache_dir
+  ///     If set, the index is saved in this directory once it is built, and
+  ///     loaded from there instead of scanning the units when the same
+  ///     module is indexed again in a later session.
   ManualDWARFIndex(Module &module, DWARFDebugInfo *debug_info,
-                   llvm::DenseSet<dw_offset_t> units_to_avoid = {})
+                   llvm::DenseSet<dw_offset_t> units_to_avoid = {},
+                   FileSpec cache_dir = {})
       : DWARFIndex(module), m_debug_info(debug_info),
-        m_units_to_avoid(std::move(units_to_avoid)) {}
+        m_units_to_avoid(std::move(units_to_avoid)),
+        m_cache_dir(std::move(cache_dir)) {}
 
   void Preload() override { Index(); }
 
@@ -58,6 +66,16 @@ private:
   void Index();
   void IndexUnit(DWARFUnit &unit, IndexSet &set);
 
+  /// Returns the path of the cache file of this index, or an empty FileSpec
+  /// if the index isn't cached.
+  FileSpec GetCacheFile();
+  /// Fills m_set from the cache file. Returns false if there is no usable
+  /// cache file.
+  bool LoadFromCache(const FileSpec &cache_file);
+  void SaveToCache(const FileSpec &cache_file);
+  /// The name maps of m_set, in the order in which they are cached.
+  std::array<NameToDIE *, 8> GetNameMaps();
+
   static void IndexUnitImpl(DWARFUnit &unit,
                             const lldb::LanguageType cu_language,
                             IndexSet &set);
@@ -66,6 +84,8 @@ private:
   DWARFDebugInfo *m_debug_info;
   /// Which dwarf units should we skip while building the index.
   llvm::DenseSet<dw_offset_t> m_units_to_avoid;
+  /// Where the index is cached across sessions, if anywhere.
+  FileSpec m_cache_dir;
 
   IndexSet m_set;
 };
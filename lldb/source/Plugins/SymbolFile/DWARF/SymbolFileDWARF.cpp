@@ -145,6 +145,11 @@ public:
     return m_collection_sp->GetPropertyAtIndexAsBoolean(
         nullptr, ePropertyIgnoreIndexes, false);
   }
+
+  FileSpec GetIndexCachePath() const {
+    return m_collection_sp->GetPropertyAtIndexAsFileSpec(
+        nullptr, ePropertyIndexCachePath);
+  }
 };
 
 typedef std::shared_ptr<PluginProperties> SymbolFileDWARFPropertiesSP;
@@ -471,8 +476,10 @@ void SymbolFileDWARF::InitializeObject() {
     }
   }
 
-  m_index = std::make_unique<ManualDWARFIndex>(*GetObjectFile()->GetModule(),
-                                                DebugInfo());
+  m_index = std::make_unique<ManualDWARFIndex>(
+      *GetObjectFile()->GetModule(), DebugInfo(),
+      llvm::DenseSet<dw_offset_t>(),
+      GetGlobalPluginProperties()->GetIndexCachePath());
 }
 
 bool SymbolFileDWARF::SupportedVersion(uint16_t version) {
@@ -703,7 +710,9 @@ lldb::CompUnitSP SymbolFileDWARF::ParseCompileUnit(DWARFCompileUnit &dwarf_cu) {
     } else {
       ModuleSP module_sp(m_objfile_sp->GetModule());
       if (module_sp) {
-        const DWARFDIE cu_die = dwarf_cu.DIE();
+        // Only the unit DIE is needed, don't keep all the DIEs of the unit in
+        // memory just to create the compile unit.
+        const DWARFBaseDIE cu_die = dwarf_cu.GetUnitDIEOnly();
         if (cu_die) {
           FileSpec cu_file_spec(cu_die.GetName(), dwarf_cu.GetPathStyle());
           if (cu_file_spec) {
@@ -3824,6 +3833,17 @@ ConstString SymbolFileDWARF::GetPluginName() { return GetPluginNameStatic(); }
 
 uint32_t SymbolFileDWARF::GetPluginVersion() { return 1; }
 
+uint64_t SymbolFileDWARF::GetParsedDebugInfoMemorySize() {
+  std::lock_guard<std::recursive_mutex> guard(GetModuleMutex());
+  // Don't parse the unit headers just to find out that nothing was parsed.
+  if (!m_info)
+    return 0;
+  uint64_t size = 0;
+  for (size_t i = 0, num_units = m_info->GetNumUnits(); i < num_units; ++i)
+    size += m_info->GetUnitAtIndex(i)->GetDIEMemorySize();
+  return size;
+}
+
 void SymbolFileDWARF::Dump(lldb_private::Stream &s) {
   SymbolFile::Dump(s);
   m_index->Dump(s);
@@ -205,6 +205,8 @@ public:
 
   void PreloadSymbols() override;
 
+  uint64_t GetParsedDebugInfoMemorySize() override;
+
   std::recursive_mutex &GetModuleMutex() const override;
 
   // PluginInterface protocol
@@ -1245,6 +1245,19 @@ void SymbolFileDWARFDebugMap::DumpClangAST(Stream &s) {
   });
 }
 
+uint64_t SymbolFileDWARFDebugMap::GetParsedDebugInfoMemorySize() {
+  // Only look at the object files that are already loaded.
+  uint64_t size = 0;
+  for (const auto &entry : m_oso_map) {
+    if (!entry.second->module_sp)
+      continue;
+    if (SymbolFile *oso_symfile =
+            entry.second->module_sp->GetSymbolFile(/*can_create=*/false))
+      size += oso_symfile->GetParsedDebugInfoMemorySize();
+  }
+  return size;
+}
+
 // PluginInterface protocol
 lldb_private::ConstString SymbolFileDWARFDebugMap::GetPluginName() {
   return GetPluginNameStatic();
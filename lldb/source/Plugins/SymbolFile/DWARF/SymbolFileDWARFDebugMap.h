@@ -125,6 +125,8 @@ public:
 
   void DumpClangAST(lldb_private::Stream &s) override;
 
+  uint64_t GetParsedDebugInfoMemorySize() override;
+
   // PluginInterface protocol
   lldb_private::ConstString GetPluginName() override;
 
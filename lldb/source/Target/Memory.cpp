@@ -122,6 +122,52 @@ bool MemoryCache::RemoveInvalidRange(lldb::addr_t base_addr,
   return false;
 }
 
+void MemoryCache::Prefetch(addr_t addr, size_t size) {
+  // Don't let a bogus size, e.g. from an uninitialized container, read a
+  // huge amount of memory.
+  const size_t max_prefetch_size = 1024 * 1024;
+  size = std::min(size, max_prefetch_size);
+  if (size == 0 || addr + size < addr)
+    return;
+
+  std::lock_guard<std::recursive_mutex> guard(m_mutex);
+  const uint32_t cache_line_byte_size = m_L2_cache_line_byte_size;
+  const addr_t end_addr = addr + size;
+
+  // Collect the missing lines, merging adjacent ones into a single range.
+  std::vector<AddrRange> missing;
+  for (addr_t curr_addr = addr - (addr % cache_line_byte_size);
+       curr_addr < end_addr; curr_addr += cache_line_byte_size) {
+    if (m_invalid_ranges.FindEntryThatContains(curr_addr) ||
+        m_L2_cache.find(curr_addr) != m_L2_cache.end())
+      continue;
+    if (!missing.empty() && missing.back().GetRangeEnd() == curr_addr)
+      missing.back().SetByteSize(missing.back().GetByteSize() +
+                                 cache_line_byte_size);
+    else
+      missing.push_back(AddrRange(curr_addr, cache_line_byte_size));
+  }
+  if (missing.empty())
+    return;
+
+  std::vector<DataBufferSP> buffers =
+      m_process.ReadMemoryRangesFromInferior(missing);
+  for (size_t i = 0; i < missing.size() && i < buffers.size(); ++i) {
+    if (!buffers[i])
+      continue;
+    const uint8_t *bytes = buffers[i]->GetBytes();
+    const size_t bytes_read = buffers[i]->GetByteSize();
+    // Like Read(), cache the last line even if only a part of it was read.
+    for (size_t offset = 0; offset < bytes_read;
+         offset += cache_line_byte_size) {
+      const size_t line_size =
+          std::min<size_t>(cache_line_byte_size, bytes_read - offset);
+      m_L2_cache[missing[i].GetRangeBase() + offset] =
+          std::make_shared<DataBufferHeap>(bytes + offset, line_size);
+    }
+  }
+}
+
 size_t MemoryCache::Read(addr_t addr, void *dst, size_t dst_len,
                          Status &error) {
   size_t bytes_left = dst_len;
@@ -155,7 +201,10 @@ size_t MemoryCache::Read(addr_t addr, void *dst, size_t dst_len,
   // unlikely that the caller function will ask for the next
   // 4 bytes after the large memory read - so there's little benefit to saving
   // it in the cache.
-  if (dst && dst_len > m_L2_cache_line_byte_size) {
+  // Reads that a prefetch has put into the L2 cache are served from there.
+  if (dst && dst_len > m_L2_cache_line_byte_size &&
+      m_L2_cache.find(addr - addr % m_L2_cache_line_byte_size) ==
+          m_L2_cache.end()) {
     size_t bytes_read =
         m_process.ReadMemoryFromInferior(addr, dst, dst_len, error);
     // Add this non block sized range to the L1 cache if we actually read
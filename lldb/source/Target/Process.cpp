@@ -60,6 +60,7 @@
 #include "lldb/Target/ThreadPlanBase.h"
 #include "lldb/Target/ThreadPlanCallFunction.h"
 #include "lldb/Target/UnixSignals.h"
+#include "lldb/Utility/DataBufferHeap.h"
 #include "lldb/Utility/Event.h"
 #include "lldb/Utility/Log.h"
 #include "lldb/Utility/NameMatches.h"
@@ -2105,6 +2106,48 @@ size_t Process::ReadMemoryFromInferior(addr_t addr, void *buf, size_t size,
   return bytes_read;
 }
 
+std::vector<DataBufferSP> Process::DoReadMemoryRanges(
+    llvm::ArrayRef<Range<addr_t, addr_t>> ranges) {
+  std::vector<DataBufferSP> buffers;
+  buffers.reserve(ranges.size());
+  for (const auto &range : ranges) {
+    auto buffer_sp = std::make_shared<DataBufferHeap>(range.GetByteSize(), 0);
+    size_t bytes_read = 0;
+    Status error;
+    while (bytes_read < range.GetByteSize()) {
+      const size_t curr_size = range.GetByteSize() - bytes_read;
+      const size_t curr_bytes_read =
+          DoReadMemory(range.GetRangeBase() + bytes_read,
+                       buffer_sp->GetBytes() + bytes_read, curr_size, error);
+      bytes_read += curr_bytes_read;
+      if (curr_bytes_read == curr_size || curr_bytes_read == 0)
+        break;
+    }
+    buffer_sp->SetByteSize(bytes_read);
+    buffers.push_back(buffer_sp);
+  }
+  return buffers;
+}
+
+std::vector<DataBufferSP> Process::ReadMemoryRangesFromInferior(
+    llvm::ArrayRef<Range<addr_t, addr_t>> ranges) {
+  std::vector<DataBufferSP> buffers = DoReadMemoryRanges(ranges);
+  assert(buffers.size() == ranges.size() && "One buffer per range expected");
+  // Replace any software breakpoint opcodes that fall into the ranges back
+  // into the buffers before we return
+  for (size_t i = 0; i < buffers.size(); ++i)
+    if (buffers[i] && buffers[i]->GetByteSize() > 0)
+      RemoveBreakpointOpcodesFromBuffer(ranges[i].GetRangeBase(),
+                                        buffers[i]->GetByteSize(),
+                                        buffers[i]->GetBytes());
+  return buffers;
+}
+
+void Process::PrefetchMemory(addr_t vm_addr, size_t size) {
+  if (!GetDisableMemoryCache())
+    m_memory_cache.Prefetch(vm_addr, size);
+}
+
 uint64_t Process::ReadUnsignedIntegerFromMemory(lldb::addr_t vm_addr,
                                                 size_t integer_byte_size,
                                                 uint64_t fail_value,
@@ -58,6 +58,7 @@
 #include "lldb/Utility/Timer.h"
 
 #include "llvm/ADT/ScopeExit.h"
+#include "llvm/Support/ThreadPool.h"
 
 #include <memory>
 #include <mutex>
@@ -1568,6 +1569,10 @@ void Target::NotifyWillClearList(const ModuleList &module_list) {}
 void Target::NotifyModuleAdded(const ModuleList &module_list,
                                const ModuleSP &module_sp) {
   // A module is being added to this target for the first time
+  if (m_valid && m_module_load_batch_depth) {
+    m_batch_modules_to_notify.Append(module_sp);
+    return;
+  }
   if (m_valid) {
     ModuleList my_module_list;
     my_module_list.Append(module_sp);
@@ -1618,6 +1623,51 @@ void Target::ModulesDidLoad(ModuleList &module_list) {
   }
 }
 
+Target::ModuleLoadBatch::ModuleLoadBatch(Target &target) : m_target(target) {
+  ++m_target.m_module_load_batch_depth;
+}
+
+Target::ModuleLoadBatch::~ModuleLoadBatch() { m_target.EndModuleLoadBatch(); }
+
+void Target::EndModuleLoadBatch() {
+  assert(m_module_load_batch_depth > 0);
+  if (--m_module_load_batch_depth)
+    return;
+
+  std::vector<ModuleSP> to_preload;
+  to_preload.swap(m_batch_modules_to_preload);
+  PreloadModuleSymbols(to_preload);
+
+  ModuleList to_notify(m_batch_modules_to_notify);
+  m_batch_modules_to_notify.Clear();
+  ModulesDidLoad(to_notify);
+}
+
+void Target::PreloadModuleSymbols(llvm::ArrayRef<ModuleSP> modules) {
+  static Timer::Category func_cat(LLVM_PRETTY_FUNCTION);
+  Timer scoped_timer(func_cat, "Target::PreloadModuleSymbols (%zu modules)",
+                     modules.size());
+  // Indexing the debug information is the most expensive part, and most of
+  // it is never needed, so it is left to the first lookup by default.
+  const bool index_debug_info = GetPreloadDebugInfo();
+  if (modules.size() <= 1) {
+    for (const ModuleSP &module_sp : modules)
+      module_sp->PreloadSymbols(index_debug_info);
+    return;
+  }
+
+  // Every module is guarded by its own mutex, so they can be preloaded
+  // concurrently. This uses its own threads rather than the TaskPool: the
+  // symbol table and the DWARF index use the TaskPool themselves, and a
+  // TaskPool worker that waits for other TaskPool tasks can deadlock.
+  llvm::ThreadPool pool;
+  for (const ModuleSP &module_sp : modules)
+    pool.async([module_sp, index_debug_info]() {
+      module_sp->PreloadSymbols(index_debug_info);
+    });
+  pool.wait();
+}
+
 void Target::SymbolsDidLoad(ModuleList &module_list) {
   if (m_valid && module_list.GetSize()) {
     if (m_process_sp) {
@@ -2070,8 +2120,12 @@ ModuleSP Target::GetOrCreateModule(const ModuleSpec &module_spec, bool notify,
 
         // Preload symbols outside of any lock, so hopefully we can do this for
         // each library in parallel.
-        if (GetPreloadSymbols())
-          module_sp->PreloadSymbols();
+        if (GetPreloadSymbols()) {
+          if (m_module_load_batch_depth)
+            m_batch_modules_to_preload.push_back(module_sp);
+          else
+            module_sp->PreloadSymbols(GetPreloadDebugInfo());
+        }
 
         if (old_module_sp && m_images.GetIndexForModule(old_module_sp.get()) !=
                                  LLDB_INVALID_INDEX32) {
@@ -3613,6 +3667,12 @@ void TargetProperties::SetPreloadSymbols(bool b) {
   m_collection_sp->SetPropertyAtIndexAsBoolean(nullptr, idx, b);
 }
 
+bool TargetProperties::GetPreloadDebugInfo() const {
+  const uint32_t idx = ePropertyPreloadDebugInfo;
+  return m_collection_sp->GetPropertyAtIndexAsBoolean(
+      nullptr, idx, g_target_properties[idx].default_uint_value != 0);
+}
+
 bool TargetProperties::GetDisableASLR() const {
   const uint32_t idx = ePropertyDisableASLR;
   return m_collection_sp->GetPropertyAtIndexAsBoolean(
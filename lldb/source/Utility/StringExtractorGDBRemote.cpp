@@ -218,6 +218,8 @@ StringExtractorGDBRemote::GetServerPacketType() const {
         return eServerPacketType_qMemoryRegionInfo;
       if (PACKET_MATCHES("qMemoryRegionInfo"))
         return eServerPacketType_qMemoryRegionInfoSupported;
+      if (PACKET_STARTS_WITH("qMultiMemRead:"))
+        return eServerPacketType_qMultiMemRead;
       if (PACKET_STARTS_WITH("qModuleInfo:"))
         return eServerPacketType_qModuleInfo;
       break;
@@ -9,8 +9,10 @@
 #include "Decoder.h"
 
 // C/C++ Includes
+#include <algorithm>
 #include <cinttypes>
 #include <cstring>
+#include <thread>
 
 #include "lldb/API/SBModule.h"
 #include "lldb/API/SBProcess.h"
@@ -307,23 +309,93 @@ void Decoder::ReadTraceDataAndImageInfo(lldb::SBProcess &sbprocess,
 void Decoder::DecodeProcessorTrace(lldb::SBProcess &sbprocess, lldb::tid_t tid,
                                    lldb::SBError &sberror,
                                    ThreadTraceInfo &threadTraceInfo) {
-  // Initialize instruction decoder
-  struct pt_insn_decoder *decoder = nullptr;
-  struct pt_config config;
   Buffer &pt_buffer = threadTraceInfo.GetPTBuffer();
   CPUInfo &pt_cpu = threadTraceInfo.GetCPUInfo();
   ReadExecuteSectionInfos &readExecuteSectionInfos =
       threadTraceInfo.GetReadExecuteSectionInfos();
-
-  InitializePTInstDecoder(&decoder, &config, pt_cpu, pt_buffer,
-                          readExecuteSectionInfos, sberror);
-  if (!sberror.Success())
-    return;
-
-  // Start raw trace decoding
   Instructions &instruction_list = threadTraceInfo.GetInstructionLog();
   instruction_list.clear();
-  DecodeTrace(decoder, instruction_list, sberror);
+
+  // Large traces are split into chunks that are decoded in parallel, each
+  // with its own decoder and image, and then concatenated in order.
+  size_t num_threads = std::max(std::thread::hardware_concurrency(), 1u);
+  std::vector<uint64_t> chunks =
+      GetDecodingChunks(pt_cpu, pt_buffer, num_threads);
+  const size_t num_chunks = chunks.size();
+  std::vector<Instructions> chunk_instructions(num_chunks);
+  std::vector<lldb::SBError> chunk_errors(num_chunks);
+
+  auto decode_chunk = [&](size_t i) {
+    uint8_t *begin = pt_buffer.data() + chunks[i];
+    uint8_t *end = pt_buffer.data() +
+                   (i + 1 < num_chunks ? chunks[i + 1] : pt_buffer.size());
+    struct pt_insn_decoder *decoder = nullptr;
+    struct pt_config config;
+    InitializePTInstDecoder(&decoder, &config, pt_cpu, begin, end,
+                            readExecuteSectionInfos, chunk_errors[i]);
+    if (!chunk_errors[i].Success())
+      return;
+    DecodeTrace(decoder, chunk_instructions[i], chunk_errors[i]);
+    pt_insn_free_decoder(decoder);
+  };
+
+  if (num_chunks == 1) {
+    decode_chunk(0);
+  } else {
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < num_chunks; i++)
+      threads.emplace_back(decode_chunk, i);
+    for (std::thread &thread : threads)
+      thread.join();
+  }
+
+  size_t num_instructions = 0;
+  for (const Instructions &instructions : chunk_instructions)
+    num_instructions += instructions.size();
+  instruction_list.reserve(num_instructions);
+  for (size_t i = 0; i < num_chunks; i++) {
+    instruction_list.insert(instruction_list.end(),
+                            chunk_instructions[i].begin(),
+                            chunk_instructions[i].end());
+    // Like a sequential decode, report the last error.
+    if (!chunk_errors[i].Success())
+      sberror = chunk_errors[i];
+  }
+}
+
+std::vector<uint64_t> Decoder::GetDecodingChunks(const CPUInfo &pt_cpu,
+                                                 Buffer &pt_buffer,
+                                                 size_t max_num_chunks) const {
+  // Don't bother with threads for small traces.
+  const uint64_t min_chunk_size = 1024 * 1024;
+  std::vector<uint64_t> chunks = {0};
+  if (max_num_chunks <= 1 || pt_buffer.size() < 2 * min_chunk_size)
+    return chunks;
+
+  struct pt_config config;
+  pt_config_init(&config);
+  config.cpu = pt_cpu;
+  if (pt_cpu_errata(&config.errata, &config.cpu) < 0)
+    return chunks;
+  config.begin = pt_buffer.data();
+  config.end = pt_buffer.data() + pt_buffer.size();
+
+  struct pt_packet_decoder *decoder = pt_pkt_alloc_decoder(&config);
+  if (!decoder)
+    return chunks;
+
+  const uint64_t chunk_size =
+      std::max<uint64_t>(pt_buffer.size() / max_num_chunks, min_chunk_size);
+  while (pt_pkt_sync_forward(decoder) >= 0) {
+    uint64_t offset;
+    if (pt_pkt_get_sync_offset(decoder, &offset) < 0)
+      break;
+    if (offset - chunks.back() >= chunk_size &&
+        pt_buffer.size() - offset >= chunk_size / 2)
+      chunks.push_back(offset);
+  }
+  pt_pkt_free_decoder(decoder);
+  return chunks;
 }
 
 // Raw trace decoding requires information of Read & Execute sections of each
@@ -507,7 +579,7 @@ void Decoder::ParseCPUInfo(CPUInfo &pt_cpu, lldb::SBStructuredData &s,
 // in trace decoder.
 void Decoder::InitializePTInstDecoder(
     struct pt_insn_decoder **decoder, struct pt_config *config,
-    const CPUInfo &pt_cpu, Buffer &pt_buffer,
+    const CPUInfo &pt_cpu, uint8_t *trace_begin, uint8_t *trace_end,
     const ReadExecuteSectionInfos &readExecuteSectionInfos,
     lldb::SBError &sberror) const {
   if (!decoder || !config) {
@@ -528,8 +600,8 @@ void Decoder::InitializePTInstDecoder(
   }
 
   // Load trace buffer's starting and end address in pt_config struct
-  config->begin = pt_buffer.data();
-  config->end = pt_buffer.data() + pt_buffer.size();
+  config->begin = trace_begin;
+  config->end = trace_end;
 
   // Fill trace decoder with pt_config struct
   *decoder = pt_insn_alloc_decoder(config);
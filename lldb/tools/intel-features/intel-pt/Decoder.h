@@ -240,9 +240,18 @@ private:
   ///  - start trace decoding
   void InitializePTInstDecoder(
       struct pt_insn_decoder **decoder, struct pt_config *config,
-      const CPUInfo &pt_cpu, Buffer &pt_buffer,
+      const CPUInfo &pt_cpu, uint8_t *trace_begin, uint8_t *trace_end,
       const ReadExecuteSectionInfos &readExecuteSectionInfos,
       lldb::SBError &sberror) const;
+
+  // Helper function of DecodeProcessorTrace() to split the raw trace into
+  // chunks that can be decoded independently. Each chunk starts at a PSB
+  // packet, from which the decoder can synchronize without knowing the
+  // decoder state at the end of the previous chunk. Returns the start offsets
+  // of the chunks in the trace buffer.
+  std::vector<uint64_t> GetDecodingChunks(const CPUInfo &pt_cpu,
+                                          Buffer &pt_buffer,
+                                          size_t max_num_chunks) const;
   void DecodeTrace(struct pt_insn_decoder *decoder,
                    Instructions &instruction_list, lldb::SBError &sberror);
 
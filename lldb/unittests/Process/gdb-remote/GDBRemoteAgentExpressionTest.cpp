@@ -0,0 +1,130 @@
+//===-- GDBRemoteAgentExpressionTest.cpp ------------------------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "Plugins/Process/gdb-remote/GDBRemoteAgentExpression.h"
+#include "llvm/Testing/Support/Error.h"
+#include "gtest/gtest.h"
+
+#include <map>
+
+using namespace lldb_private::process_gdb_remote;
+using namespace lldb_private;
+using namespace llvm;
+
+namespace {
+
+struct FakeTarget {
+  std::map<uint32_t, uint64_t> registers;
+  std::map<lldb::addr_t, uint8_t> memory;
+
+  void WriteLittleEndian(lldb::addr_t addr, uint64_t value, uint32_t size) {
+    for (uint32_t i = 0; i < size; ++i)
+      memory[addr + i] = static_cast<uint8_t>(value >> (8 * i));
+  }
+
+  Expected<uint64_t> Evaluate(StringRef condition) {
+    auto lookup_register =
+        [](StringRef name) -> Optional<AgentExpressionRegister> {
+      if (name == "rax")
+        return AgentExpressionRegister{0, 8, false};
+      if (name == "eflags")
+        return AgentExpressionRegister{1, 4, false};
+      return None;
+    };
+    Expected<std::string> bytecode =
+        CompileAgentExpression(condition, 8, lookup_register);
+    if (!bytecode)
+      return bytecode.takeError();
+
+    auto read_register = [this](uint32_t reg) -> Expected<uint64_t> {
+      auto pos = registers.find(reg);
+      if (pos == registers.end())
+        return createStringError(inconvertibleErrorCode(), "no register");
+      return pos->second;
+    };
+    auto read_memory = [this](lldb::addr_t addr,
+                              uint32_t size) -> Expected<uint64_t> {
+      uint64_t value = 0;
+      for (uint32_t i = 0; i < size; ++i) {
+        auto pos = memory.find(addr + i);
+        if (pos == memory.end())
+          return createStringError(inconvertibleErrorCode(), "no memory");
+        value |= uint64_t(pos->second) << (8 * i);
+      }
+      return value;
+    };
+    return EvaluateAgentExpression(*bytecode, read_register, read_memory);
+  }
+};
+
+} // namespace
+
+TEST(GDBRemoteAgentExpressionTest, Literals) {
+  FakeTarget target;
+  EXPECT_THAT_EXPECTED(target.Evaluate("1 == 1"), HasValue(1u));
+  EXPECT_THAT_EXPECTED(target.Evaluate("0x10 != 16"), HasValue(0u));
+  EXPECT_THAT_EXPECTED(target.Evaluate("(2 + 3) - 1 == 4"), HasValue(1u));
+  EXPECT_THAT_EXPECTED(target.Evaluate("!(1 < 2)"), HasValue(0u));
+  EXPECT_THAT_EXPECTED(target.Evaluate("-1 < 0"), HasValue(1u));
+}
+
+TEST(GDBRemoteAgentExpressionTest, UsualArithmeticConversions) {
+  FakeTarget target;
+  // -1 is converted to unsigned int.
+  EXPECT_THAT_EXPECTED(target.Evaluate("-1 < 0u"), HasValue(0u));
+  // unsigned int is converted to long.
+  EXPECT_THAT_EXPECTED(target.Evaluate("-1l < 0u"), HasValue(1u));
+  EXPECT_THAT_EXPECTED(target.Evaluate("0u - 1 == 4294967295"), HasValue(1u));
+}
+
+TEST(GDBRemoteAgentExpressionTest, Registers) {
+  FakeTarget target;
+  target.registers[0] = 5;
+  EXPECT_THAT_EXPECTED(target.Evaluate("$rax == 5"), HasValue(1u));
+  EXPECT_THAT_EXPECTED(target.Evaluate("$rax > 5"), HasValue(0u));
+  // eflags is known, but can't be read.
+  EXPECT_THAT_EXPECTED(target.Evaluate("$eflags == 0"), Failed());
+  EXPECT_THAT_EXPECTED(target.Evaluate("$xmm0 == 0"), Failed());
+}
+
+TEST(GDBRemoteAgentExpressionTest, Memory) {
+  FakeTarget target;
+  target.WriteLittleEndian(0x1000, 0xffffffff, 4);
+  EXPECT_THAT_EXPECTED(target.Evaluate("*(int *)0x1000 == -1"), HasValue(1u));
+  EXPECT_THAT_EXPECTED(target.Evaluate("*(int *)0x1000 < 0"), HasValue(1u));
+  EXPECT_THAT_EXPECTED(target.Evaluate("*(unsigned int *)0x1000 < 0"),
+                       HasValue(0u));
+  EXPECT_THAT_EXPECTED(target.Evaluate("*(int16_t *)0x1000 == -1"),
+                       HasValue(1u));
+  EXPECT_THAT_EXPECTED(target.Evaluate("*(uint8_t *)0x1000 == 255"),
+                       HasValue(1u));
+  EXPECT_THAT_EXPECTED(target.Evaluate("*(int *)0x2000 == 0"), Failed());
+}
+
+TEST(GDBRemoteAgentExpressionTest, LogicalOperators) {
+  FakeTarget target;
+  target.registers[0] = 3;
+  EXPECT_THAT_EXPECTED(target.Evaluate("$rax > 1 && $rax < 4"), HasValue(1u));
+  EXPECT_THAT_EXPECTED(target.Evaluate("$rax > 3 && $rax < 4"), HasValue(0u));
+  EXPECT_THAT_EXPECTED(target.Evaluate("$rax == 1 || $rax == 3"),
+                       HasValue(1u));
+  // The right hand side isn't evaluated if the left hand side decides.
+  EXPECT_THAT_EXPECTED(target.Evaluate("$rax == 3 || *(int *)0x2000 == 0"),
+                       HasValue(1u));
+  EXPECT_THAT_EXPECTED(target.Evaluate("$rax != 3 && *(int *)0x2000 == 0"),
+                       HasValue(0u));
+}
+
+TEST(GDBRemoteAgentExpressionTest, Unsupported) {
+  FakeTarget target;
+  EXPECT_THAT_EXPECTED(target.Evaluate("i == 5"), Failed());
+  EXPECT_THAT_EXPECTED(target.Evaluate("foo() == 5"), Failed());
+  EXPECT_THAT_EXPECTED(target.Evaluate("*(char *)0x1000 == 0"), Failed());
+  EXPECT_THAT_EXPECTED(target.Evaluate("*(float *)0x1000 == 0"), Failed());
+  EXPECT_THAT_EXPECTED(target.Evaluate("1 == "), Failed());
+}
@@ -362,6 +362,32 @@ TEST_F(GDBRemoteCommunicationClientTest, GetMemoryRegionInfoInvalidResponse) {
   EXPECT_FALSE(result.get().Success());
 }
 
+TEST_F(GDBRemoteCommunicationClientTest, ReadMemoryRanges) {
+  std::pair<lldb::addr_t, lldb::addr_t> ranges[] = {{0x1000, 4},
+                                                    {0x2000, 4}};
+  std::future<Expected<std::vector<std::string>>> result =
+      std::async(std::launch::async,
+                 [&] { return client.ReadMemoryRanges(ranges); });
+
+  // Only the first two bytes of the second range are readable.
+  HandlePacket(server, "qMultiMemRead:1000,4;2000,4", "4,2;ABCDEF");
+  Expected<std::vector<std::string>> data = result.get();
+  ASSERT_THAT_EXPECTED(data, llvm::Succeeded());
+  EXPECT_THAT(*data, testing::ElementsAre("ABCD", "EF"));
+}
+
+TEST_F(GDBRemoteCommunicationClientTest, ReadMemoryRangesInvalidResponse) {
+  std::pair<lldb::addr_t, lldb::addr_t> ranges[] = {{0x1000, 4},
+                                                    {0x2000, 4}};
+  std::future<Expected<std::vector<std::string>>> result =
+      std::async(std::launch::async,
+                 [&] { return client.ReadMemoryRanges(ranges); });
+
+  // The data is shorter than the sizes claim.
+  HandlePacket(server, "qMultiMemRead:1000,4;2000,4", "4,4;ABCDEF");
+  EXPECT_THAT_EXPECTED(result.get(), llvm::Failed());
+}
+
 TEST_F(GDBRemoteCommunicationClientTest, SendStartTracePacket) {
   TraceOptions options;
   Status error;
@@ -0,0 +1,580 @@
+//===- ISelBenchmark.cpp - SelectionDAG vs. GlobalISel compile time -------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// Compiles a fixed corpus of IR to an object file with each instruction
+// selector at -O0 and -O2, reporting the time and memory of codegen and, from
+// one extra -time-passes compile, the time of each selection phase and, in
+// builds with statistics, the number of MachineMemOperands allocated and
+// reused (see -unique-machine-memoperands).
+//
+// Usage: ISelBenchmark [benchmark options] [-mtriple=<triple>] [file.ll...]
+//
+// Extra .ll files are compiled in addition to the built-in corpus, and other
+// LLVM options are passed on to codegen.
+//
+//===----------------------------------------------------------------------===//
+
+#include "benchmark/benchmark.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/StringSwitch.h"
+#include "llvm/Analysis/TargetLibraryInfo.h"
+#include "llvm/AsmParser/Parser.h"
+#include "llvm/IR/DiagnosticInfo.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/LegacyPassManager.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Pass.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Process.h"
+#include "llvm/Support/SourceMgr.h"
+#include "llvm/Support/TargetRegistry.h"
+#include "llvm/Support/TargetSelect.h"
+#include "llvm/Support/Timer.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/Target/TargetMachine.h"
+#include "llvm/Target/TargetOptions.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace llvm;
+
+static cl::opt<std::string>
+    TargetTriple("mtriple", cl::desc("Target triple to compile for"),
+                 cl::init("aarch64-unknown-linux-gnu"));
+
+static cl::list<std::string> InputFilenames(cl::Positional,
+                                            cl::desc("<input .ll files>"));
+
+namespace {
+
+struct Input {
+  std::string Name;
+  std::string IR;
+};
+
+// Vectorized numeric loops, as left by the loop vectorizer.
+const char KernelsIR[] = R"IR(
+define void @saxpy(float* noalias %y, float* noalias %x, float %a, i64 %n) {
+entry:
+  %a.ins = insertelement <4 x float> undef, float %a, i32 0
+  %a.splat = shufflevector <4 x float> %a.ins, <4 x float> undef, <4 x i32> zeroinitializer
+  %n.vec = and i64 %n, -4
+  %has.vec = icmp sgt i64 %n.vec, 0
+  br i1 %has.vec, label %vector.body, label %middle
+
+vector.body:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %vector.body ]
+  %px = getelementptr inbounds float, float* %x, i64 %i
+  %py = getelementptr inbounds float, float* %y, i64 %i
+  %px.v = bitcast float* %px to <4 x float>*
+  %py.v = bitcast float* %py to <4 x float>*
+  %xv = load <4 x float>, <4 x float>* %px.v, align 4
+  %yv = load <4 x float>, <4 x float>* %py.v, align 4
+  %mul = fmul <4 x float> %a.splat, %xv
+  %add = fadd <4 x float> %mul, %yv
+  store <4 x float> %add, <4 x float>* %py.v, align 4
+  %i.next = add nuw nsw i64 %i, 4
+  %vec.done = icmp sge i64 %i.next, %n.vec
+  br i1 %vec.done, label %middle, label %vector.body
+
+middle:
+  %j.start = phi i64 [ 0, %entry ], [ %i.next, %vector.body ]
+  %has.rem = icmp slt i64 %j.start, %n
+  br i1 %has.rem, label %scalar.body, label %exit
+
+scalar.body:
+  %j = phi i64 [ %j.start, %middle ], [ %j.next, %scalar.body ]
+  %qx = getelementptr inbounds float, float* %x, i64 %j
+  %qy = getelementptr inbounds float, float* %y, i64 %j
+  %xs = load float, float* %qx, align 4
+  %ys = load float, float* %qy, align 4
+  %muls = fmul float %a, %xs
+  %adds = fadd float %muls, %ys
+  store float %adds, float* %qy, align 4
+  %j.next = add nuw nsw i64 %j, 1
+  %done = icmp eq i64 %j.next, %n
+  br i1 %done, label %exit, label %scalar.body
+
+exit:
+  ret void
+}
+
+define double @dot(double* noalias %a, double* noalias %b, i64 %n) {
+entry:
+  %n.vec = and i64 %n, -4
+  %has.vec = icmp sgt i64 %n.vec, 0
+  br i1 %has.vec, label %vector.body, label %reduce
+
+vector.body:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %vector.body ]
+  %acc0 = phi <2 x double> [ zeroinitializer, %entry ], [ %acc0.next, %vector.body ]
+  %acc1 = phi <2 x double> [ zeroinitializer, %entry ], [ %acc1.next, %vector.body ]
+  %pa = getelementptr inbounds double, double* %a, i64 %i
+  %pb = getelementptr inbounds double, double* %b, i64 %i
+  %pa0 = bitcast double* %pa to <2 x double>*
+  %pb0 = bitcast double* %pb to <2 x double>*
+  %pa.hi = getelementptr inbounds double, double* %pa, i64 2
+  %pb.hi = getelementptr inbounds double, double* %pb, i64 2
+  %pa1 = bitcast double* %pa.hi to <2 x double>*
+  %pb1 = bitcast double* %pb.hi to <2 x double>*
+  %a0 = load <2 x double>, <2 x double>* %pa0, align 8
+  %b0 = load <2 x double>, <2 x double>* %pb0, align 8
+  %a1 = load <2 x double>, <2 x double>* %pa1, align 8
+  %b1 = load <2 x double>, <2 x double>* %pb1, align 8
+  %m0 = fmul fast <2 x double> %a0, %b0
+  %m1 = fmul fast <2 x double> %a1, %b1
+  %acc0.next = fadd fast <2 x double> %acc0, %m0
+  %acc1.next = fadd fast <2 x double> %acc1, %m1
+  %i.next = add nuw nsw i64 %i, 4
+  %vec.done = icmp sge i64 %i.next, %n.vec
+  br i1 %vec.done, label %reduce, label %vector.body
+
+reduce:
+  %r0 = phi <2 x double> [ zeroinitializer, %entry ], [ %acc0.next, %vector.body ]
+  %r1 = phi <2 x double> [ zeroinitializer, %entry ], [ %acc1.next, %vector.body ]
+  %sum = fadd fast <2 x double> %r0, %r1
+  %lo = extractelement <2 x double> %sum, i32 0
+  %hi = extractelement <2 x double> %sum, i32 1
+  %res = fadd fast double %lo, %hi
+  ret double %res
+}
+
+define void @scale_clamp(i32* noalias %out, i16* noalias %in, i32 %scale, i64 %n) {
+entry:
+  %s.ins = insertelement <8 x i32> undef, i32 %scale, i32 0
+  %s.splat = shufflevector <8 x i32> %s.ins, <8 x i32> undef, <8 x i32> zeroinitializer
+  %n.vec = and i64 %n, -8
+  %has.vec = icmp sgt i64 %n.vec, 0
+  br i1 %has.vec, label %vector.body, label %exit
+
+vector.body:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %vector.body ]
+  %pin = getelementptr inbounds i16, i16* %in, i64 %i
+  %pout = getelementptr inbounds i32, i32* %out, i64 %i
+  %pin.v = bitcast i16* %pin to <8 x i16>*
+  %pout.v = bitcast i32* %pout to <8 x i32>*
+  %v = load <8 x i16>, <8 x i16>* %pin.v, align 2
+  %ext = sext <8 x i16> %v to <8 x i32>
+  %mul = mul nsw <8 x i32> %ext, %s.splat
+  %shr = ashr <8 x i32> %mul, <i32 4, i32 4, i32 4, i32 4, i32 4, i32 4, i32 4, i32 4>
+  %neg = icmp slt <8 x i32> %shr, zeroinitializer
+  %clamp = select <8 x i1> %neg, <8 x i32> zeroinitializer, <8 x i32> %shr
+  store <8 x i32> %clamp, <8 x i32>* %pout.v, align 4
+  %i.next = add nuw nsw i64 %i, 8
+  %vec.done = icmp sge i64 %i.next, %n.vec
+  br i1 %vec.done, label %exit, label %vector.body
+
+exit:
+  ret void
+}
+)IR";
+
+// A switch-based bytecode interpreter, the shape of generated state machines.
+const char InterpreterIR[] = R"IR(
+define i64 @interp(i8* %code, i64* %regs, i64 %limit) {
+entry:
+  br label %dispatch
+
+dispatch:
+  %pc = phi i64 [ 0, %entry ], [ %pc.1, %op.add ], [ %pc.1, %op.sub ], [ %pc.1, %op.mul ], [ %pc.1, %op.xor ], [ %pc.1, %op.shl ], [ %pc.1, %op.load ], [ %pc.1, %op.store ], [ %pc.jz, %op.jz ], [ %pc.1, %op.div ], [ %pc.1, %op.min ]
+  %acc = phi i64 [ 0, %entry ], [ %acc.add, %op.add ], [ %acc.sub, %op.sub ], [ %acc.mul, %op.mul ], [ %acc.xor, %op.xor ], [ %acc.shl, %op.shl ], [ %acc.load, %op.load ], [ %acc, %op.store ], [ %acc, %op.jz ], [ %acc.div, %op.div ], [ %acc.min, %op.min ]
+  %steps = phi i64 [ 0, %entry ], [ %steps.1, %op.add ], [ %steps.1, %op.sub ], [ %steps.1, %op.mul ], [ %steps.1, %op.xor ], [ %steps.1, %op.shl ], [ %steps.1, %op.load ], [ %steps.1, %op.store ], [ %steps.1, %op.jz ], [ %steps.1, %op.div ], [ %steps.1, %op.min ]
+  %steps.1 = add i64 %steps, 1
+  %over = icmp ugt i64 %steps.1, %limit
+  br i1 %over, label %halt, label %fetch
+
+fetch:
+  %p.op = getelementptr inbounds i8, i8* %code, i64 %pc
+  %op = load i8, i8* %p.op, align 1
+  %pc.arg = add i64 %pc, 1
+  %p.arg = getelementptr inbounds i8, i8* %code, i64 %pc.arg
+  %arg8 = load i8, i8* %p.arg, align 1
+  %arg = zext i8 %arg8 to i64
+  %reg.idx = and i64 %arg, 15
+  %p.reg = getelementptr inbounds i64, i64* %regs, i64 %reg.idx
+  %pc.1 = add i64 %pc, 2
+  switch i8 %op, label %halt [
+    i8 0, label %op.add
+    i8 1, label %op.sub
+    i8 2, label %op.mul
+    i8 3, label %op.xor
+    i8 4, label %op.shl
+    i8 5, label %op.load
+    i8 6, label %op.store
+    i8 7, label %op.jz
+    i8 8, label %op.div
+    i8 9, label %op.min
+  ]
+
+op.add:
+  %r.add = load i64, i64* %p.reg, align 8
+  %acc.add = add i64 %acc, %r.add
+  br label %dispatch
+
+op.sub:
+  %r.sub = load i64, i64* %p.reg, align 8
+  %acc.sub = sub i64 %acc, %r.sub
+  br label %dispatch
+
+op.mul:
+  %r.mul = load i64, i64* %p.reg, align 8
+  %acc.mul = mul i64 %acc, %r.mul
+  br label %dispatch
+
+op.xor:
+  %acc.xor = xor i64 %acc, %arg
+  br label %dispatch
+
+op.shl:
+  %amt = and i64 %arg, 63
+  %acc.shl = shl i64 %acc, %amt
+  br label %dispatch
+
+op.load:
+  %acc.load = load i64, i64* %p.reg, align 8
+  br label %dispatch
+
+op.store:
+  store i64 %acc, i64* %p.reg, align 8
+  br label %dispatch
+
+op.jz:
+  %is.zero = icmp eq i64 %acc, 0
+  %target = mul i64 %arg, 2
+  %pc.jz = select i1 %is.zero, i64 %target, i64 %pc.1
+  br label %dispatch
+
+op.div:
+  %r.div = load i64, i64* %p.reg, align 8
+  %r.nz = or i64 %r.div, 1
+  %acc.div = udiv i64 %acc, %r.nz
+  br label %dispatch
+
+op.min:
+  %r.min = load i64, i64* %p.reg, align 8
+  %lt = icmp slt i64 %r.min, %acc
+  %acc.min = select i1 %lt, i64 %r.min, i64 %acc
+  br label %dispatch
+
+halt:
+  %result = phi i64 [ %acc, %dispatch ], [ %acc, %fetch ]
+  ret i64 %result
+}
+)IR";
+
+// Pointer chasing, calls and aggregates, as in typical non-numeric code.
+const char CallsIR[] = R"IR(
+%struct.node = type { %struct.node*, i32, i64 }
+
+@weights = internal constant [8 x i32] [i32 3, i32 1, i32 4, i32 1, i32 5, i32 9, i32 2, i32 6]
+
+declare i8* @malloc(i64)
+declare void @free(i8*)
+declare void @consume(i64, i32)
+
+define %struct.node* @push(%struct.node* %head, i32 %v, i64 %w) {
+entry:
+  %mem = call i8* @malloc(i64 24)
+  %n = bitcast i8* %mem to %struct.node*
+  %next = getelementptr inbounds %struct.node, %struct.node* %n, i64 0, i32 0
+  store %struct.node* %head, %struct.node** %next, align 8
+  %val = getelementptr inbounds %struct.node, %struct.node* %n, i64 0, i32 1
+  store i32 %v, i32* %val, align 8
+  %wt = getelementptr inbounds %struct.node, %struct.node* %n, i64 0, i32 2
+  store i64 %w, i64* %wt, align 8
+  ret %struct.node* %n
+}
+
+define i64 @sum_list(%struct.node* %head) {
+entry:
+  %empty = icmp eq %struct.node* %head, null
+  br i1 %empty, label %exit, label %loop
+
+loop:
+  %n = phi %struct.node* [ %head, %entry ], [ %next, %loop ]
+  %sum = phi i64 [ 0, %entry ], [ %sum.next, %loop ]
+  %pval = getelementptr inbounds %struct.node, %struct.node* %n, i64 0, i32 1
+  %val = load i32, i32* %pval, align 8
+  %idx = and i32 %val, 7
+  %idx.ext = zext i32 %idx to i64
+  %pw = getelementptr inbounds [8 x i32], [8 x i32]* @weights, i64 0, i64 %idx.ext
+  %w = load i32, i32* %pw, align 4
+  %prod = mul nsw i32 %val, %w
+  %prod.ext = sext i32 %prod to i64
+  %pwt = getelementptr inbounds %struct.node, %struct.node* %n, i64 0, i32 2
+  %wt = load i64, i64* %pwt, align 8
+  %neg = icmp slt i64 %wt, 0
+  %term = select i1 %neg, i64 %prod.ext, i64 %wt
+  %sum.next = add i64 %sum, %term
+  %pnext = getelementptr inbounds %struct.node, %struct.node* %n, i64 0, i32 0
+  %next = load %struct.node*, %struct.node** %pnext, align 8
+  %end = icmp eq %struct.node* %next, null
+  br i1 %end, label %exit, label %loop
+
+exit:
+  %result = phi i64 [ 0, %entry ], [ %sum.next, %loop ]
+  ret i64 %result
+}
+
+define void @free_list(%struct.node* %head) {
+entry:
+  %empty = icmp eq %struct.node* %head, null
+  br i1 %empty, label %exit, label %loop
+
+loop:
+  %n = phi %struct.node* [ %head, %entry ], [ %next, %loop ]
+  %pnext = getelementptr inbounds %struct.node, %struct.node* %n, i64 0, i32 0
+  %next = load %struct.node*, %struct.node** %pnext, align 8
+  %mem = bitcast %struct.node* %n to i8*
+  call void @free(i8* %mem)
+  %end = icmp eq %struct.node* %next, null
+  br i1 %end, label %exit, label %loop
+
+exit:
+  ret void
+}
+
+define i64 @mix(i64 %a, i64 %b, i32 %k) {
+entry:
+  %q = sdiv i64 %a, 7
+  %r = srem i64 %b, 13
+  %k.ext = zext i32 %k to i64
+  %t0 = mul i64 %q, %k.ext
+  %t1 = xor i64 %t0, %r
+  %big = icmp ugt i64 %t1, 1000
+  br i1 %big, label %slow, label %fast
+
+slow:
+  call void @consume(i64 %t1, i32 %k)
+  %t2 = lshr i64 %t1, 3
+  br label %join
+
+fast:
+  %t3 = shl i64 %t1, 1
+  %t4 = call i64 @mix(i64 %t3, i64 %a, i32 0)
+  br label %join
+
+join:
+  %v = phi i64 [ %t2, %slow ], [ %t4, %fast ]
+  %c = icmp eq i32 %k, 0
+  %res = select i1 %c, i64 %v, i64 %b
+  ret i64 %res
+}
+)IR";
+
+enum class Selector { SelectionDAG, GlobalISel };
+
+/// Counts the functions for which GlobalISel fell back to SelectionDAG, whose
+/// time is then that of both selectors.
+class FallbackCounter : public DiagnosticHandler {
+  unsigned &Fallbacks;
+
+public:
+  FallbackCounter(unsigned &Fallbacks) : Fallbacks(Fallbacks) {}
+
+  bool handleDiagnostics(const DiagnosticInfo &DI) override {
+    if (DI.getKind() != DK_ISelFallback)
+      return false;
+    ++Fallbacks;
+    return true;
+  }
+};
+
+/// A module ready for codegen. The members are destroyed in reverse order, so
+/// the passes go before the stream and the module they refer to.
+struct Compilation {
+  LLVMContext Context;
+  std::unique_ptr<Module> M;
+  SmallString<0> Object;
+  raw_svector_ostream OS{Object};
+  legacy::PassManager PM;
+  unsigned Fallbacks = 0;
+};
+
+std::unique_ptr<Compilation> prepare(LLVMTargetMachine &TM, const Input &In,
+                                     std::string &Error) {
+  auto C = std::make_unique<Compilation>();
+  C->Context.setDiagnosticHandler(
+      std::make_unique<FallbackCounter>(C->Fallbacks));
+  SMDiagnostic Err;
+  C->M = parseAssemblyString(In.IR, Err, C->Context);
+  if (!C->M) {
+    raw_string_ostream OS(Error);
+    Err.print(In.Name.c_str(), OS);
+    return nullptr;
+  }
+  C->M->setTargetTriple(TM.getTargetTriple().str());
+  C->M->setDataLayout(TM.createDataLayout());
+
+  C->PM.add(new TargetLibraryInfoWrapperPass(TM.getTargetTriple()));
+  if (TM.addPassesToEmitFile(C->PM, C->OS, nullptr,
+                             TargetMachine::CGFT_ObjectFile)) {
+    Error = "target does not support object file emission";
+    return nullptr;
+  }
+  return C;
+}
+
+/// Returns the selection phase a -time-passes timer belongs to, if any.
+StringRef getPhase(StringRef Group, StringRef Timer) {
+  if (Group == "Instruction Selection and Scheduling") {
+    if (Timer.startswith("DAG Combining"))
+      return "DAGCombine";
+    if (Timer.contains("Legalization"))
+      return "DAGLegalize";
+    if (Timer == "Instruction Selection")
+      return "DAGSelect";
+    return "DAGSchedule";
+  }
+  if (Group != "... Pass execution timing report ...")
+    return "";
+  return StringSwitch<StringRef>(Timer)
+      .Cases("IRTranslator", "Legalizer", "RegBankSelect", "InstructionSelect",
+             Timer)
+      .Cases("Fast Register Allocator", "Greedy Register Allocator",
+             "RegAlloc")
+      .Default(Timer.endswith("Instruction Selection") ? "SelectionDAGISel"
+                                                       : "");
+}
+
+/// Adds up the wall time of each phase in a -time-passes report, in ms.
+void addPhaseTimes(StringRef Report, StringMap<double> &Phases) {
+  SmallVector<StringRef, 64> Lines;
+  Report.split(Lines, '\n');
+  StringRef Group;
+  for (unsigned I = 0, E = Lines.size(); I != E; ++I) {
+    StringRef Line = Lines[I];
+    // Each group starts with its description between two rules.
+    if (Line.startswith("===---") && I + 2 < E &&
+        Lines[I + 2].startswith("===---")) {
+      Group = Lines[I + 1].trim();
+      I += 2;
+      continue;
+    }
+    // Rows are columns of "time (percent%)", ending with the wall time, then
+    // the name of the timer.
+    size_t PercentEnd = Line.rfind("%)");
+    if (PercentEnd == StringRef::npos)
+      continue;
+    // With -track-memory, the memory column comes before the name.
+    StringRef Name = Line.substr(PercentEnd + 2).ltrim().ltrim("0123456789");
+    Name = Name.trim();
+    StringRef Columns = Line.substr(0, Line.rfind('(', PercentEnd)).rtrim();
+    double Wall;
+    if (Columns.substr(Columns.rfind(' ') + 1).getAsDouble(Wall))
+      continue;
+    StringRef Phase = getPhase(Group, Name);
+    if (!Phase.empty())
+      Phases[Phase] += Wall * 1000;
+  }
+}
+
+/// Everything kept alive by the -time-passes compiles. Pass timers are keyed
+/// by the address of their pass, so freeing the passes of one compile would
+/// let those of another reuse their timers and names.
+std::vector<std::unique_ptr<Compilation>> TimedCompilations;
+
+void compile(benchmark::State &State, const Input &In, Selector Sel,
+             CodeGenOpt::Level OptLevel) {
+  std::string Error;
+  const Target *T = TargetRegistry::lookupTarget(TargetTriple, Error);
+  if (!T) {
+    State.SkipWithError(Error.c_str());
+    return;
+  }
+  TargetOptions Options;
+  Options.EnableGlobalISel = Sel == Selector::GlobalISel;
+  Options.GlobalISelAbort = GlobalISelAbortMode::DisableWithDiag;
+  std::unique_ptr<LLVMTargetMachine> TM(
+      static_cast<LLVMTargetMachine *>(T->createTargetMachine(
+          TargetTriple, "", "", Options, None, None, OptLevel)));
+
+  size_t Memory = 0;
+  unsigned Fallbacks = 0;
+  for (auto _ : State) {
+    State.PauseTiming();
+    std::unique_ptr<Compilation> C = prepare(*TM, In, Error);
+    if (!C) {
+      State.SkipWithError(Error.c_str());
+      return;
+    }
+    size_t MemoryBefore = sys::Process::GetMallocUsage();
+    State.ResumeTiming();
+
+    C->PM.run(*C->M);
+
+    State.PauseTiming();
+    Memory += sys::Process::GetMallocUsage() - MemoryBefore;
+    Fallbacks = C->Fallbacks;
+    C.reset();
+    State.ResumeTiming();
+  }
+  State.counters["MemoryKB"] = Memory / State.iterations() / 1024.0;
+  State.counters["Fallbacks"] = Fallbacks;
+
+  // Break the time down by phase with one more compile under -time-passes.
+  std::unique_ptr<Compilation> C = prepare(*TM, In, Error);
+  ResetStatistics();
+  TimePassesIsEnabled = true;
+  C->PM.run(*C->M);
+  TimePassesIsEnabled = false;
+  for (const auto &Stat : GetStatistics())
+    if (Stat.first == "NumMemOperands")
+      State.counters["MemOperands"] = Stat.second;
+    else if (Stat.first == "NumMemOperandsReused")
+      State.counters["MemOperandsReused"] = Stat.second;
+  std::string Report;
+  raw_string_ostream OS(Report);
+  TimerGroup::printAll(OS);
+  TimerGroup::clearAll();
+  StringMap<double> Phases;
+  addPhaseTimes(OS.str(), Phases);
+  for (auto &Phase : Phases)
+    State.counters[(Phase.first() + "(ms)").str()] = Phase.second;
+  TimedCompilations.push_back(std::move(C));
+}
+
+} // end anonymous namespace
+
+int main(int argc, char **argv) {
+  benchmark::Initialize(&argc, argv);
+  cl::ParseCommandLineOptions(argc, argv, "SelectionDAG/GlobalISel benchmark\n");
+
+  // Collect the statistics, without printing them on exit.
+  EnableStatistics(false);
+  InitializeAllTargets();
+  InitializeAllTargetMCs();
+  InitializeAllAsmPrinters();
+
+  std::vector<Input> Inputs = {{"kernels", KernelsIR},
+                               {"interpreter", InterpreterIR},
+                               {"calls", CallsIR}};
+  for (const std::string &Filename : InputFilenames) {
+    auto Buffer = MemoryBuffer::getFile(Filename);
+    if (!Buffer) {
+      errs() << Filename << ": " << Buffer.getError().message() << '\n';
+      return 1;
+    }
+    Inputs.push_back({Filename, (*Buffer)->getBuffer().str()});
+  }
+
+  for (const Input &In : Inputs)
+    for (CodeGenOpt::Level OptLevel : {CodeGenOpt::None, CodeGenOpt::Default})
+      for (Selector Sel : {Selector::SelectionDAG, Selector::GlobalISel}) {
+        std::string Name =
+            In.Name + (Sel == Selector::GlobalISel ? "/GlobalISel" : "/DAG") +
+            (OptLevel == CodeGenOpt::None ? "/O0" : "/O2");
+        benchmark::RegisterBenchmark(Name.c_str(), compile, In, Sel, OptLevel)
+            ->Unit(benchmark::kMillisecond);
+      }
+  benchmark::RunSpecifiedBenchmarks();
+}
@@ -0,0 +1,94 @@
+#include "benchmark/benchmark.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SwissMap.h"
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <vector>
+
+// Pointers to heap objects, the most common kind of key of DenseMap in LLVM,
+// in random order: visiting them in allocation order would favor the weak
+// pointer hash of DenseMapInfo, which keeps neighbouring pointers together.
+static std::vector<void *> makeKeys(unsigned N,
+                                    std::vector<std::unique_ptr<int>> &Owner) {
+  std::vector<void *> Keys;
+  for (unsigned I = 0; I != N; ++I) {
+    Owner.push_back(std::make_unique<int>(I));
+    Keys.push_back(Owner.back().get());
+  }
+  std::shuffle(Keys.begin(), Keys.end(), std::mt19937(N));
+  return Keys;
+}
+
+template <typename MapT> static void BM_Insert(benchmark::State &state) {
+  std::vector<std::unique_ptr<int>> Owner;
+  std::vector<void *> Keys = makeKeys(state.range(0), Owner);
+  for (auto _ : state) {
+    MapT Map;
+    for (void *K : Keys)
+      Map[K] = 0;
+    benchmark::DoNotOptimize(Map);
+  }
+  state.SetItemsProcessed(state.iterations() * Keys.size());
+}
+
+template <typename MapT> static void BM_FindHit(benchmark::State &state) {
+  std::vector<std::unique_ptr<int>> Owner;
+  std::vector<void *> Keys = makeKeys(state.range(0), Owner);
+  MapT Map;
+  for (void *K : Keys)
+    Map[K] = 1;
+  for (auto _ : state) {
+    unsigned Sum = 0;
+    for (void *K : Keys)
+      Sum += Map.find(K)->second;
+    benchmark::DoNotOptimize(Sum);
+  }
+  state.SetItemsProcessed(state.iterations() * Keys.size());
+}
+
+template <typename MapT> static void BM_FindMiss(benchmark::State &state) {
+  std::vector<std::unique_ptr<int>> Owner, OtherOwner;
+  std::vector<void *> Keys = makeKeys(state.range(0), Owner);
+  std::vector<void *> Others = makeKeys(state.range(0), OtherOwner);
+  MapT Map;
+  for (void *K : Keys)
+    Map[K] = 1;
+  for (auto _ : state) {
+    unsigned Count = 0;
+    for (void *K : Others)
+      Count += Map.count(K);
+    benchmark::DoNotOptimize(Count);
+  }
+  state.SetItemsProcessed(state.iterations() * Others.size());
+}
+
+// Keep a few live entries while inserting and erasing, as worklists do.
+template <typename MapT> static void BM_Churn(benchmark::State &state) {
+  std::vector<std::unique_ptr<int>> Owner;
+  std::vector<void *> Keys = makeKeys(state.range(0), Owner);
+  for (auto _ : state) {
+    MapT Map;
+    for (unsigned I = 0, E = Keys.size(); I != E; ++I) {
+      Map[Keys[I]] = I;
+      if (I >= 64)
+        Map.erase(Keys[I - 64]);
+    }
+    benchmark::DoNotOptimize(Map);
+  }
+  state.SetItemsProcessed(state.iterations() * Keys.size());
+}
+
+using PtrDenseMap = llvm::DenseMap<void *, unsigned>;
+using PtrSwissMap = llvm::SwissMap<void *, unsigned>;
+
+#define MAP_BENCHMARK(Name)                                                    \
+  BENCHMARK_TEMPLATE(Name, PtrDenseMap)->Range(16, 1 << 20);                   \
+  BENCHMARK_TEMPLATE(Name, PtrSwissMap)->Range(16, 1 << 20)
+
+MAP_BENCHMARK(BM_Insert);
+MAP_BENCHMARK(BM_FindHit);
+MAP_BENCHMARK(BM_FindMiss);
+MAP_BENCHMARK(BM_Churn);
+
+BENCHMARK_MAIN();
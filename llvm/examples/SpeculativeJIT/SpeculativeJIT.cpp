@@ -34,6 +34,13 @@ static cl::opt<unsigned> NumThreads("num-threads", cl::Optional,
                                     cl::desc("Number of compile threads"),
                                     cl::init(4));
 
+static cl::opt<std::string>
+    AccessTrace("access-trace", cl::Optional,
+                cl::desc("Compile the functions called by previous runs "
+                         "ahead of time, and record the functions called by "
+                         "this run, in the given file"),
+                cl::value_desc("filename"));
+
 ExitOnError ExitOnErr;
 
 // Add Layers
@@ -76,6 +83,8 @@ public:
 
   ExecutionSession &getES() { return *ES; }
 
+  Speculator &getSpeculator() { return S; }
+
   Error addModule(JITDylib &JD, ThreadSafeModule TSM) {
     return CODLayer.add(JD, std::move(TSM));
   }
@@ -162,6 +171,9 @@ int main(int argc, char *argv[]) {
   // Create a JIT instance.
   auto SJ = ExitOnErr(SpeculativeJIT::Create());
 
+  if (!AccessTrace.empty())
+    SJ->getSpeculator().recordAccesses();
+
   // Load the IR inputs.
   for (const auto &InputFile : InputFiles) {
     SMDiagnostic Err;
@@ -183,6 +195,10 @@ int main(int argc, char *argv[]) {
     ArgV.push_back(InputArg.data());
   ArgV.push_back(nullptr);
 
+  if (!AccessTrace.empty())
+    ExitOnErr(SJ->getSpeculator().speculateFromAccessTrace(
+        SJ->getES().getMainJITDylib(), AccessTrace));
+
   // Look up the JIT'd main, cast it to a function pointer, then call it.
 
   auto MainSym = ExitOnErr(SJ->lookup("main"));
@@ -191,5 +207,8 @@ int main(int argc, char *argv[]) {
 
   Main(ArgV.size() - 1, ArgV.data());
 
+  if (!AccessTrace.empty())
+    ExitOnErr(SJ->getSpeculator().writeAccessTrace(AccessTrace));
+
   return 0;
 }
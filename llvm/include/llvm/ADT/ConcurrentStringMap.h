@@ -0,0 +1,134 @@
+//===- ConcurrentStringMap.h - Thread-safe string map -----------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// This file defines ConcurrentStringMap, a StringMap that several threads can
+// insert into at the same time, e.g. to intern names during a parallel parse.
+//
+// The map is split in shards selected by the hash of the key, each with its
+// own lock, StringMap and BumpPtrAllocator. Threads inserting different keys
+// thus rarely wait for each other, and never for a global lock.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_ADT_CONCURRENTSTRINGMAP_H
+#define LLVM_ADT_CONCURRENTSTRINGMAP_H
+
+#include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Allocator.h"
+#include "llvm/Support/DJB.h"
+#include "llvm/Support/MathExtras.h"
+#include <cassert>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+namespace llvm {
+
+/// A map from strings to values that is safe to insert into and look up from
+/// several threads at once.
+///
+/// Entries are never moved nor removed (short of clear()), so the returned
+/// entries and their keys stay valid as long as the map. The map doesn't
+/// synchronize accesses to the values themselves: a value that is modified
+/// after its insertion needs its own synchronization.
+template <typename ValueTy> class ConcurrentStringMap {
+public:
+  using MapEntryTy = StringMapEntry<ValueTy>;
+
+  /// \p NumShards must be a power of two. More shards mean less contention
+  /// and more memory for an empty map.
+  explicit ConcurrentStringMap(unsigned NumShards = 64)
+      : Shards(new Shard[NumShards]), ShardMask(NumShards - 1) {
+    assert(isPowerOf2_32(NumShards) && "NumShards must be a power of two");
+  }
+
+  ConcurrentStringMap(const ConcurrentStringMap &) = delete;
+  ConcurrentStringMap &operator=(const ConcurrentStringMap &) = delete;
+
+  /// Returns the entry for \p Key, constructing its value from \p Args if the
+  /// key isn't already in the map. The bool is true if the insertion took
+  /// place.
+  template <typename... ArgsTy>
+  std::pair<MapEntryTy *, bool> try_emplace(StringRef Key, ArgsTy &&... Args) {
+    Shard &S = getShard(Key);
+    std::lock_guard<std::mutex> Lock(S.Mutex);
+    auto R = S.Map.try_emplace(Key, std::forward<ArgsTy>(Args)...);
+    return std::make_pair(&*R.first, R.second);
+  }
+
+  std::pair<MapEntryTy *, bool> insert(std::pair<StringRef, ValueTy> KV) {
+    return try_emplace(KV.first, std::move(KV.second));
+  }
+
+  /// Returns a copy of \p Key, with the same lifetime as the map, that is the
+  /// same for equal strings. The returned strings are null-terminated.
+  StringRef intern(StringRef Key) { return try_emplace(Key).first->getKey(); }
+
+  /// Returns the entry for \p Key, or null if it isn't in the map.
+  MapEntryTy *find(StringRef Key) const {
+    Shard &S = getShard(Key);
+    std::lock_guard<std::mutex> Lock(S.Mutex);
+    auto I = S.Map.find(Key);
+    return I == S.Map.end() ? nullptr : &*I;
+  }
+
+  size_t count(StringRef Key) const { return find(Key) ? 1 : 0; }
+
+  /// Returns the number of entries. This is only a snapshot if other threads
+  /// are inserting.
+  size_t size() const {
+    size_t Size = 0;
+    for (unsigned I = 0; I <= ShardMask; ++I) {
+      std::lock_guard<std::mutex> Lock(Shards[I].Mutex);
+      Size += Shards[I].Map.size();
+    }
+    return Size;
+  }
+
+  bool empty() const { return size() == 0; }
+
+  /// Calls \p Fn on each entry, in no particular order. \p Fn must not insert
+  /// into the map.
+  template <typename FnTy> void forEach(FnTy Fn) {
+    for (unsigned I = 0; I <= ShardMask; ++I) {
+      std::lock_guard<std::mutex> Lock(Shards[I].Mutex);
+      for (MapEntryTy &E : Shards[I].Map)
+        Fn(E);
+    }
+  }
+
+  /// Removes all entries and frees their memory. Not thread-safe.
+  void clear() {
+    for (unsigned I = 0; I <= ShardMask; ++I) {
+      Shards[I].Map.clear();
+      Shards[I].Map.getAllocator().Reset();
+    }
+  }
+
+private:
+  struct Shard {
+    mutable std::mutex Mutex;
+    StringMap<ValueTy, BumpPtrAllocator> Map;
+  };
+
+  Shard &getShard(StringRef Key) const {
+    // StringMap picks buckets with the low bits of djbHash. Pick the shard
+    // with the high bits of a multiplicative hash of it, so that the keys of
+    // a shard still spread over its buckets.
+    uint32_t H = djbHash(Key, 0) * 0x9E3779B9U;
+    return Shards[(H >> 16) & ShardMask];
+  }
+
+  std::unique_ptr<Shard[]> Shards;
+  unsigned ShardMask;
+};
+
+} // end namespace llvm
+
+#endif // LLVM_ADT_CONCURRENTSTRINGMAP_H
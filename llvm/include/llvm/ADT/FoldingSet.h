@@ -15,6 +15,7 @@
 #ifndef LLVM_ADT_FOLDINGSET_H
 #define LLVM_ADT_FOLDINGSET_H
 
+#include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/iterator.h"
 #include "llvm/Support/Allocator.h"
@@ -100,6 +101,7 @@ namespace llvm {
 /// The result indicates whether the node existed in the folding set.
 
 class FoldingSetNodeID;
+class FoldingSetNodeIDHasher;
 class StringRef;
 
 //===----------------------------------------------------------------------===//
@@ -207,6 +209,11 @@ protected:
   /// faster.
   Node *FindNodeOrInsertPos(const FoldingSetNodeID &ID, void *&InsertPos);
 
+  /// FindNodeOrInsertPos - Look up the node in the bucket of \p IDHash for
+  /// which \p Matches returns true, without building any FoldingSetNodeID.
+  Node *FindNodeOrInsertPos(unsigned IDHash, function_ref<bool(Node *)> Matches,
+                            void *&InsertPos);
+
   /// InsertNode - Insert the specified node into the folding set, knowing that
   /// it is not already in the folding set.  InsertPos must be obtained from
   /// FindNodeOrInsertPos.
@@ -354,6 +361,76 @@ public:
   FoldingSetNodeIDRef Intern(BumpPtrAllocator &Allocator) const;
 };
 
+namespace detail {
+/// The hash of a profile, computed one data word at a time so that
+/// FoldingSetNodeIDHasher can compute it without storing the profile.
+class FoldingSetHashState {
+  uint64_t State = 0x243F6A8885A308D3ULL;
+
+public:
+  void add(unsigned Word) {
+    State = (((State << 5) | (State >> 59)) ^ Word) * 0x517CC1B727220A95ULL;
+  }
+
+  unsigned get() const {
+    // Mix the high bits, which the multiplications spread the words into,
+    // into the low bits that select the bucket.
+    uint64_t H = State;
+    H ^= H >> 33;
+    H *= 0xFF51AFD7ED558CCDULL;
+    H ^= H >> 33;
+    H *= 0xC4CEB9FE1A85EC53ULL;
+    H ^= H >> 33;
+    return static_cast<unsigned>(H);
+  }
+};
+} // end namespace detail
+
+//===--------------------------------------------------------------------===//
+/// FoldingSetNodeIDHasher - This class computes the hash of a profile, the
+/// same as FoldingSetNodeID::ComputeHash would, without storing its data.
+/// Along with a function matching the nodes directly, it lets hot lookups
+/// skip building the FoldingSetNodeID of the node and those of the nodes in
+/// its bucket:
+///
+///    FoldingSetNodeIDHasher Hash;
+///    Hash.AddPointer(Operand);
+///    void *InsertPoint;
+///    MyNode *M = MyFoldingSet.FindNodeOrInsertPos(
+///        Hash, [&](MyNode &N) { return N.getOperand() == Operand; },
+///        InsertPoint);
+///
+/// The bits added must be those the Profile of the node would add, and the
+/// function must return true exactly for the nodes with that profile.
+class FoldingSetNodeIDHasher {
+  detail::FoldingSetHashState State;
+
+public:
+  /// Add* - Add various data types to the hash, like FoldingSetNodeID does.
+  void AddPointer(const void *Ptr) {
+    AddInteger(reinterpret_cast<uintptr_t>(Ptr));
+  }
+  void AddInteger(signed I) { State.add(I); }
+  void AddInteger(unsigned I) { State.add(I); }
+  void AddInteger(long I) { AddInteger((unsigned long)I); }
+  void AddInteger(unsigned long I) {
+    if (sizeof(long) == sizeof(int))
+      AddInteger(unsigned(I));
+    else
+      AddInteger((unsigned long long)I);
+  }
+  void AddInteger(long long I) { AddInteger((unsigned long long)I); }
+  void AddInteger(unsigned long long I) {
+    AddInteger(unsigned(I));
+    AddInteger(unsigned(I >> 32));
+  }
+  void AddBoolean(bool B) { AddInteger(B ? 1U : 0U); }
+  void AddString(StringRef String);
+
+  /// ComputeHash - Return the hash of the data added so far.
+  unsigned ComputeHash() const { return State.get(); }
+};
+
 // Convenience type to hide the implementation of the folding set.
 using FoldingSetNode = FoldingSetBase::Node;
 template<class T> class FoldingSetIterator;
@@ -445,6 +522,17 @@ public:
     return static_cast<T *>(FoldingSetBase::FindNodeOrInsertPos(ID, InsertPos));
   }
 
+  /// FindNodeOrInsertPos - Look up the node whose profile is hashed by \p Hash
+  /// and for which \p Matches, called with the nodes of the same bucket,
+  /// returns true. If none does, return the insertion token as above.
+  template <typename MatchFn>
+  T *FindNodeOrInsertPos(const FoldingSetNodeIDHasher &Hash, MatchFn Matches,
+                         void *&InsertPos) {
+    return static_cast<T *>(FoldingSetBase::FindNodeOrInsertPos(
+        Hash.ComputeHash(),
+        [&](Node *N) { return Matches(*static_cast<T *>(N)); }, InsertPos));
+  }
+
   /// InsertNode - Insert the specified node into the folding set, knowing that
   /// it is not already in the folding set.  InsertPos must be obtained from
   /// FindNodeOrInsertPos.
@@ -582,6 +670,14 @@ public:
     return Set.FindNodeOrInsertPos(ID, InsertPos);
   }
 
+  /// FindNodeOrInsertPos - Look up the node hashed by \p Hash for which
+  /// \p Matches returns true, as for FoldingSet.
+  template <typename MatchFn>
+  T *FindNodeOrInsertPos(const FoldingSetNodeIDHasher &Hash, MatchFn Matches,
+                         void *&InsertPos) {
+    return Set.FindNodeOrInsertPos(Hash, Matches, InsertPos);
+  }
+
   /// GetOrInsertNode - If there is an existing simple Node exactly
   /// equal to the specified node, return it.  Otherwise, insert 'N' and
   /// return it instead.
@@ -0,0 +1,642 @@
+//===- llvm/ADT/SwissMap.h - Hash map with out-of-line metadata -*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// This file defines the SwissMap class, an open-addressing hash map in the
+// style of Abseil's SwissTable.
+//
+// Each bucket has a control byte, kept in an array of their own, which either
+// holds 7 bits of the hash of the key in the bucket, or says that the bucket is
+// empty or was erased. Lookups compare the control bytes of 16 consecutive
+// buckets at once (with SSE2 when available) and only compare the keys whose
+// control byte matches. Most lookups thus touch one cache line of metadata and
+// one bucket, even in a heavily loaded table.
+//
+// The interface is that of DenseMap, so that clients can switch from one to
+// the other. Unlike DenseMap, SwissMap needs no empty or tombstone key: only
+// getHashValue and isEqual of the KeyInfoT are used.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_ADT_SWISSMAP_H
+#define LLVM_ADT_SWISSMAP_H
+
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/DenseMapInfo.h"
+#include "llvm/ADT/EpochTracker.h"
+#include "llvm/Support/Compiler.h"
+#include "llvm/Support/MathExtras.h"
+#include "llvm/Support/type_traits.h"
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include <iterator>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace llvm {
+
+namespace detail {
+
+/// Control byte values. Buckets holding a key have the 7 low bits of the hash
+/// of the key, which are non-negative.
+enum : int8_t { SwissEmpty = -128, SwissDeleted = -2 };
+
+/// The control bytes of 16 consecutive buckets.
+class SwissGroup {
+public:
+  enum : unsigned { Width = 16 };
+
+#ifdef __SSE2__
+  explicit SwissGroup(const int8_t *Pos)
+      : Ctrl(_mm_loadu_si128(reinterpret_cast<const __m128i *>(Pos))) {}
+
+  /// Returns a bit per bucket whose control byte is \p H2, from low to high.
+  uint32_t match(int8_t H2) const {
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(H2), Ctrl));
+  }
+
+  /// Returns a bit per bucket that is empty or erased, i.e. whose control byte
+  /// has the sign bit set.
+  uint32_t matchEmptyOrDeleted() const { return _mm_movemask_epi8(Ctrl); }
+
+private:
+  __m128i Ctrl;
+#else
+  explicit SwissGroup(const int8_t *Pos) { memcpy(Ctrl, Pos, Width); }
+
+  uint32_t match(int8_t H2) const {
+    uint32_t Mask = 0;
+    for (unsigned I = 0; I != Width; ++I)
+      Mask |= uint32_t(Ctrl[I] == H2) << I;
+    return Mask;
+  }
+
+  uint32_t matchEmptyOrDeleted() const {
+    uint32_t Mask = 0;
+    for (unsigned I = 0; I != Width; ++I)
+      Mask |= uint32_t(Ctrl[I] < 0) << I;
+    return Mask;
+  }
+
+private:
+  int8_t Ctrl[Width];
+#endif
+
+public:
+  uint32_t matchEmpty() const { return match(SwissEmpty); }
+};
+
+} // end namespace detail
+
+template <typename KeyT, typename ValueT, typename KeyInfoT, typename Bucket,
+          bool IsConst = false>
+class SwissMapIterator;
+
+template <typename KeyT, typename ValueT,
+          typename KeyInfoT = DenseMapInfo<KeyT>,
+          typename BucketT = detail::DenseMapPair<KeyT, ValueT>>
+class SwissMap : public DebugEpochBase {
+  template <typename T>
+  using const_arg_type_t = typename const_pointer_or_const_ref<T>::type;
+
+  enum : unsigned { GroupWidth = detail::SwissGroup::Width };
+
+  /// NumBuckets + GroupWidth control bytes. The last GroupWidth ones are
+  /// copies of the first ones, so that a group can be loaded from any bucket.
+  int8_t *Ctrl = nullptr;
+  BucketT *Buckets = nullptr;
+  /// Zero, or a power of two that is at least GroupWidth.
+  unsigned NumBuckets = 0;
+  unsigned NumEntries = 0;
+  /// The number of entries that can be inserted in empty buckets before the
+  /// table has to grow. Erased buckets count as used.
+  unsigned GrowthLeft = 0;
+
+public:
+  using size_type = unsigned;
+  using key_type = KeyT;
+  using mapped_type = ValueT;
+  using value_type = BucketT;
+
+  using iterator = SwissMapIterator<KeyT, ValueT, KeyInfoT, BucketT>;
+  using const_iterator =
+      SwissMapIterator<KeyT, ValueT, KeyInfoT, BucketT, true>;
+
+  explicit SwissMap(unsigned InitialReserve = 0) { reserve(InitialReserve); }
+
+  SwissMap(const SwissMap &Other) { copyFrom(Other); }
+
+  SwissMap(SwissMap &&Other) { swap(Other); }
+
+  template <typename InputIt> SwissMap(const InputIt &I, const InputIt &E) {
+    reserve(std::distance(I, E));
+    insert(I, E);
+  }
+
+  SwissMap(std::initializer_list<typename iterator::value_type> Vals) {
+    reserve(Vals.size());
+    insert(Vals.begin(), Vals.end());
+  }
+
+  ~SwissMap() {
+    destroyAll();
+    deallocate();
+  }
+
+  SwissMap &operator=(const SwissMap &Other) {
+    if (&Other != this)
+      copyFrom(Other);
+    return *this;
+  }
+
+  SwissMap &operator=(SwissMap &&Other) {
+    destroyAll();
+    deallocate();
+    NumBuckets = NumEntries = GrowthLeft = 0;
+    swap(Other);
+    return *this;
+  }
+
+  void swap(SwissMap &RHS) {
+    this->incrementEpoch();
+    RHS.incrementEpoch();
+    std::swap(Ctrl, RHS.Ctrl);
+    std::swap(Buckets, RHS.Buckets);
+    std::swap(NumBuckets, RHS.NumBuckets);
+    std::swap(NumEntries, RHS.NumEntries);
+    std::swap(GrowthLeft, RHS.GrowthLeft);
+  }
+
+  inline iterator begin() {
+    return iterator(Buckets, Buckets + NumBuckets, Ctrl, *this);
+  }
+  inline iterator end() {
+    return iterator(Buckets + NumBuckets, Buckets + NumBuckets,
+                    Ctrl + NumBuckets, *this, true);
+  }
+  inline const_iterator begin() const {
+    return const_iterator(Buckets, Buckets + NumBuckets, Ctrl, *this);
+  }
+  inline const_iterator end() const {
+    return const_iterator(Buckets + NumBuckets, Buckets + NumBuckets,
+                          Ctrl + NumBuckets, *this, true);
+  }
+
+  LLVM_NODISCARD bool empty() const { return NumEntries == 0; }
+  unsigned size() const { return NumEntries; }
+
+  /// Grow the table so that \p NumEntries entries can be inserted without
+  /// growing it again.
+  void reserve(size_type NumEntries) {
+    unsigned NewNumBuckets = getMinBucketsToReserve(NumEntries);
+    incrementEpoch();
+    if (NewNumBuckets > NumBuckets)
+      grow(NewNumBuckets);
+  }
+
+  void clear() {
+    incrementEpoch();
+    if (NumEntries == 0 && GrowthLeft == maxLoad(NumBuckets))
+      return;
+    destroyAll();
+    if (NumBuckets)
+      memset(Ctrl, detail::SwissEmpty, NumBuckets + GroupWidth);
+    NumEntries = 0;
+    GrowthLeft = maxLoad(NumBuckets);
+  }
+
+  void shrink_and_clear() {
+    incrementEpoch();
+    destroyAll();
+    deallocate();
+    NumBuckets = NumEntries = GrowthLeft = 0;
+  }
+
+  /// Return 1 if the specified key is in the map, 0 otherwise.
+  size_type count(const_arg_type_t<KeyT> Val) const {
+    unsigned Index;
+    return lookupIndex(Val, Index) ? 1 : 0;
+  }
+
+  iterator find(const_arg_type_t<KeyT> Val) { return find_as(Val); }
+  const_iterator find(const_arg_type_t<KeyT> Val) const {
+    return find_as(Val);
+  }
+
+  /// Alternate version of find() which allows a different, and possibly
+  /// less expensive, key type. The DenseMapInfo is responsible for supplying
+  /// methods getHashValue(LookupKeyT) and isEqual(LookupKeyT, KeyT) for each
+  /// key type used.
+  template <class LookupKeyT> iterator find_as(const LookupKeyT &Val) {
+    unsigned Index;
+    if (lookupIndex(Val, Index))
+      return makeIterator(Index);
+    return end();
+  }
+  template <class LookupKeyT>
+  const_iterator find_as(const LookupKeyT &Val) const {
+    unsigned Index;
+    if (lookupIndex(Val, Index))
+      return makeConstIterator(Index);
+    return end();
+  }
+
+  /// Return the entry for the specified key, or a default constructed value
+  /// if no such entry exists.
+  ValueT lookup(const_arg_type_t<KeyT> Val) const {
+    unsigned Index;
+    if (lookupIndex(Val, Index))
+      return Buckets[Index].getSecond();
+    return ValueT();
+  }
+
+  // Inserts key,value pair into the map if the key isn't already in the map.
+  // If the key is already in the map, it returns false and doesn't update the
+  // value.
+  std::pair<iterator, bool> insert(const std::pair<KeyT, ValueT> &KV) {
+    return try_emplace(KV.first, KV.second);
+  }
+
+  // Inserts key,value pair into the map if the key isn't already in the map.
+  // If the key is already in the map, it returns false and doesn't update the
+  // value.
+  std::pair<iterator, bool> insert(std::pair<KeyT, ValueT> &&KV) {
+    return try_emplace(std::move(KV.first), std::move(KV.second));
+  }
+
+  // Inserts key,value pair into the map if the key isn't already in the map.
+  // The value is constructed in-place if the key is not in the map, otherwise
+  // it is not moved.
+  template <typename... Ts>
+  std::pair<iterator, bool> try_emplace(KeyT &&Key, Ts &&... Args) {
+    return tryEmplaceImpl(std::move(Key), std::forward<Ts>(Args)...);
+  }
+
+  // Inserts key,value pair into the map if the key isn't already in the map.
+  // The value is constructed in-place if the key is not in the map, otherwise
+  // it is not moved.
+  template <typename... Ts>
+  std::pair<iterator, bool> try_emplace(const KeyT &Key, Ts &&... Args) {
+    return tryEmplaceImpl(Key, std::forward<Ts>(Args)...);
+  }
+
+  /// insert - Range insertion of pairs.
+  template <typename InputIt> void insert(InputIt I, InputIt E) {
+    for (; I != E; ++I)
+      insert(*I);
+  }
+
+  bool erase(const KeyT &Val) {
+    unsigned Index;
+    if (!lookupIndex(Val, Index))
+      return false;
+    eraseAt(Index);
+    return true;
+  }
+  void erase(iterator I) { eraseAt(&*I - Buckets); }
+
+  value_type &FindAndConstruct(const KeyT &Key) {
+    return *try_emplace(Key).first;
+  }
+
+  ValueT &operator[](const KeyT &Key) { return FindAndConstruct(Key).second; }
+
+  value_type &FindAndConstruct(KeyT &&Key) {
+    return *try_emplace(std::move(Key)).first;
+  }
+
+  ValueT &operator[](KeyT &&Key) {
+    return FindAndConstruct(std::move(Key)).second;
+  }
+
+  unsigned getNumBuckets() const { return NumBuckets; }
+
+  /// Return the approximate size (in bytes) of the actual map.
+  /// This is just the raw memory used by SwissMap.
+  /// If entries are pointers to objects, the size of the referenced objects
+  /// are not included.
+  size_t getMemorySize() const {
+    return NumBuckets ? NumBuckets * (sizeof(BucketT) + 1) + GroupWidth : 0;
+  }
+
+private:
+  static unsigned maxLoad(unsigned NumBuckets) {
+    return NumBuckets - NumBuckets / 8;
+  }
+
+  static unsigned getMinBucketsToReserve(unsigned NumEntries) {
+    if (NumEntries == 0)
+      return 0;
+    uint64_t NumBuckets =
+        std::max<uint64_t>(GroupWidth, PowerOf2Ceil(NumEntries));
+    while (maxLoad(NumBuckets) < NumEntries)
+      NumBuckets *= 2;
+    return NumBuckets;
+  }
+
+  /// Returns the bits of the hash of \p Key that select the first group to
+  /// probe, and the 7 bits that go in the control byte.
+  template <typename LookupKeyT>
+  static std::pair<size_t, int8_t> hashOf(const LookupKeyT &Key) {
+    // Hashes from DenseMapInfo are often weak (e.g. a shift of a pointer),
+    // so mix the high bits of the product into the low ones.
+    uint64_t H = uint64_t(KeyInfoT::getHashValue(Key)) * 0x9E3779B97F4A7C15ULL;
+    H ^= H >> 32;
+    return {size_t(H >> 7), int8_t(H & 0x7F)};
+  }
+
+  /// Looks for \p Key, probing the groups starting at increasing triangular
+  /// numbers of groups from the first one. As the number of groups is a power
+  /// of two, this visits every bucket.
+  template <typename LookupKeyT>
+  bool lookupIndex(const LookupKeyT &Key, unsigned &Index) const {
+    if (NumBuckets == 0)
+      return false;
+    std::pair<size_t, int8_t> H = hashOf(Key);
+    unsigned Mask = NumBuckets - 1;
+    unsigned Pos = H.first & Mask;
+    for (unsigned Step = GroupWidth;; Pos = (Pos + Step) & Mask,
+                  Step += GroupWidth) {
+      detail::SwissGroup G(Ctrl + Pos);
+      for (uint32_t Match = G.match(H.second); Match; Match &= Match - 1) {
+        unsigned I = (Pos + countTrailingZeros(Match)) & Mask;
+        if (LLVM_LIKELY(KeyInfoT::isEqual(Key, Buckets[I].getFirst()))) {
+          Index = I;
+          return true;
+        }
+      }
+      // The table always has empty buckets, so this terminates.
+      if (LLVM_LIKELY(G.matchEmpty()))
+        return false;
+    }
+  }
+
+  /// Returns the first empty or erased bucket of the probe sequence of \p H1.
+  unsigned findInsertIndex(size_t H1) const {
+    unsigned Mask = NumBuckets - 1;
+    unsigned Pos = H1 & Mask;
+    for (unsigned Step = GroupWidth;; Pos = (Pos + Step) & Mask,
+                  Step += GroupWidth)
+      if (uint32_t Match = detail::SwissGroup(Ctrl + Pos).matchEmptyOrDeleted())
+        return (Pos + countTrailingZeros(Match)) & Mask;
+  }
+
+  void setCtrl(unsigned Index, int8_t C) {
+    Ctrl[Index] = C;
+    if (Index < GroupWidth)
+      Ctrl[NumBuckets + Index] = C;
+  }
+
+  template <typename KeyArg, typename... Ts>
+  std::pair<iterator, bool> tryEmplaceImpl(KeyArg &&Key, Ts &&... Args) {
+    unsigned Index;
+    if (lookupIndex(Key, Index))
+      return std::make_pair(makeIterator(Index), false); // Already in map.
+
+    Index = prepareInsert(hashOf(Key));
+    BucketT *TheBucket = Buckets + Index;
+    ::new (&TheBucket->getFirst()) KeyT(std::forward<KeyArg>(Key));
+    ::new (&TheBucket->getSecond()) ValueT(std::forward<Ts>(Args)...);
+    return std::make_pair(makeIterator(Index), true);
+  }
+
+  /// Finds a bucket for a new entry, growing the table if needed, and marks it
+  /// as used.
+  unsigned prepareInsert(std::pair<size_t, int8_t> H) {
+    incrementEpoch();
+    unsigned Index = 0;
+    if (NumBuckets)
+      Index = findInsertIndex(H.first);
+    if (NumBuckets == 0 ||
+        (GrowthLeft == 0 && Ctrl[Index] == detail::SwissEmpty)) {
+      // If at most half of the load is entries, the rest is erased buckets:
+      // rehashing in place gets rid of them.
+      if (NumBuckets && NumEntries * 2 <= maxLoad(NumBuckets))
+        grow(NumBuckets);
+      else
+        grow(std::max<unsigned>(NumBuckets * 2, GroupWidth));
+      Index = findInsertIndex(H.first);
+    }
+    ++NumEntries;
+    if (Ctrl[Index] == detail::SwissEmpty)
+      --GrowthLeft;
+    setCtrl(Index, H.second);
+    return Index;
+  }
+
+  void eraseAt(unsigned Index) {
+    Buckets[Index].getSecond().~ValueT();
+    Buckets[Index].getFirst().~KeyT();
+    --NumEntries;
+
+    // If the groups around the bucket were never full, no probe sequence went
+    // past the bucket: it can be made empty rather than erased.
+    unsigned Before = (Index - GroupWidth) & (NumBuckets - 1);
+    uint32_t EmptyAfter = detail::SwissGroup(Ctrl + Index).matchEmpty();
+    uint32_t EmptyBefore = detail::SwissGroup(Ctrl + Before).matchEmpty();
+    bool WasNeverFull =
+        EmptyAfter && EmptyBefore &&
+        countTrailingZeros(EmptyAfter) +
+                (countLeadingZeros(EmptyBefore) - (32 - GroupWidth)) <
+            GroupWidth;
+    setCtrl(Index, WasNeverFull ? detail::SwissEmpty : detail::SwissDeleted);
+    if (WasNeverFull)
+      ++GrowthLeft;
+  }
+
+  /// Reallocates the table with \p AtLeast buckets, and reinserts the entries.
+  void grow(unsigned AtLeast) {
+    int8_t *OldCtrl = Ctrl;
+    BucketT *OldBuckets = Buckets;
+    unsigned OldNumBuckets = NumBuckets;
+    allocate(std::max<unsigned>(GroupWidth, PowerOf2Ceil(AtLeast)));
+    GrowthLeft -= NumEntries;
+    if (!OldCtrl)
+      return;
+
+    for (unsigned I = 0; I != OldNumBuckets; ++I) {
+      if (OldCtrl[I] < 0)
+        continue;
+      BucketT &B = OldBuckets[I];
+      std::pair<size_t, int8_t> H = hashOf(B.getFirst());
+      unsigned Index = findInsertIndex(H.first);
+      setCtrl(Index, H.second);
+      ::new (&Buckets[Index].getFirst()) KeyT(std::move(B.getFirst()));
+      ::new (&Buckets[Index].getSecond()) ValueT(std::move(B.getSecond()));
+      B.getSecond().~ValueT();
+      B.getFirst().~KeyT();
+    }
+    deallocate_buffer(OldBuckets, sizeof(BucketT) * OldNumBuckets,
+                      alignof(BucketT));
+    deallocate_buffer(OldCtrl, OldNumBuckets + GroupWidth, GroupWidth);
+  }
+
+  /// Allocates an empty table of \p Num buckets, leaving the old one alone.
+  void allocate(unsigned Num) {
+    NumBuckets = Num;
+    Buckets = static_cast<BucketT *>(
+        allocate_buffer(sizeof(BucketT) * NumBuckets, alignof(BucketT)));
+    Ctrl = static_cast<int8_t *>(
+        allocate_buffer(NumBuckets + GroupWidth, GroupWidth));
+    memset(Ctrl, detail::SwissEmpty, NumBuckets + GroupWidth);
+    GrowthLeft = maxLoad(NumBuckets);
+  }
+
+  void deallocate() {
+    if (!Ctrl)
+      return;
+    deallocate_buffer(Buckets, sizeof(BucketT) * NumBuckets, alignof(BucketT));
+    deallocate_buffer(Ctrl, NumBuckets + GroupWidth, GroupWidth);
+    Ctrl = nullptr;
+    Buckets = nullptr;
+  }
+
+  void destroyAll() {
+    if (std::is_trivially_destructible<BucketT>::value)
+      return;
+    for (unsigned I = 0; I != NumBuckets; ++I) {
+      if (Ctrl[I] < 0)
+        continue;
+      Buckets[I].getSecond().~ValueT();
+      Buckets[I].getFirst().~KeyT();
+    }
+  }
+
+  void copyFrom(const SwissMap &Other) {
+    destroyAll();
+    deallocate();
+    NumBuckets = NumEntries = GrowthLeft = 0;
+    if (Other.NumBuckets == 0)
+      return;
+
+    allocate(Other.NumBuckets);
+    memcpy(Ctrl, Other.Ctrl, NumBuckets + GroupWidth);
+    for (unsigned I = 0; I != NumBuckets; ++I) {
+      if (Ctrl[I] < 0)
+        continue;
+      ::new (&Buckets[I].getFirst()) KeyT(Other.Buckets[I].getFirst());
+      ::new (&Buckets[I].getSecond()) ValueT(Other.Buckets[I].getSecond());
+    }
+    NumEntries = Other.NumEntries;
+    GrowthLeft = Other.GrowthLeft;
+  }
+
+  iterator makeIterator(unsigned Index) {
+    return iterator(Buckets + Index, Buckets + NumBuckets, Ctrl + Index, *this,
+                    true);
+  }
+  const_iterator makeConstIterator(unsigned Index) const {
+    return const_iterator(Buckets + Index, Buckets + NumBuckets, Ctrl + Index,
+                          *this, true);
+  }
+};
+
+template <typename KeyT, typename ValueT, typename KeyInfoT, typename Bucket,
+          bool IsConst>
+class SwissMapIterator : DebugEpochBase::HandleBase {
+  friend class SwissMapIterator<KeyT, ValueT, KeyInfoT, Bucket, true>;
+  friend class SwissMapIterator<KeyT, ValueT, KeyInfoT, Bucket, false>;
+
+  using ConstIterator = SwissMapIterator<KeyT, ValueT, KeyInfoT, Bucket, true>;
+
+public:
+  using difference_type = ptrdiff_t;
+  using value_type =
+      typename std::conditional<IsConst, const Bucket, Bucket>::type;
+  using pointer = value_type *;
+  using reference = value_type &;
+  using iterator_category = std::forward_iterator_tag;
+
+private:
+  pointer Ptr = nullptr;
+  pointer End = nullptr;
+  const int8_t *Ctrl = nullptr;
+
+public:
+  SwissMapIterator() = default;
+
+  SwissMapIterator(pointer Pos, pointer E, const int8_t *Ctrl,
+                   const DebugEpochBase &Epoch, bool NoAdvance = false)
+      : DebugEpochBase::HandleBase(&Epoch), Ptr(Pos), End(E), Ctrl(Ctrl) {
+    assert(isHandleInSync() && "invalid construction!");
+    if (!NoAdvance)
+      AdvancePastEmptyBuckets();
+  }
+
+  // Converting ctor from non-const iterators to const iterators. SFINAE'd out
+  // for const iterator destinations so it doesn't end up as a user defined copy
+  // constructor.
+  template <bool IsConstSrc,
+            typename = typename std::enable_if<!IsConstSrc && IsConst>::type>
+  SwissMapIterator(
+      const SwissMapIterator<KeyT, ValueT, KeyInfoT, Bucket, IsConstSrc> &I)
+      : DebugEpochBase::HandleBase(I), Ptr(I.Ptr), End(I.End), Ctrl(I.Ctrl) {}
+
+  reference operator*() const {
+    assert(isHandleInSync() && "invalid iterator access!");
+    return *Ptr;
+  }
+  pointer operator->() const {
+    assert(isHandleInSync() && "invalid iterator access!");
+    return Ptr;
+  }
+
+  bool operator==(const ConstIterator &RHS) const {
+    assert((!Ptr || isHandleInSync()) && "handle not in sync!");
+    assert((!RHS.Ptr || RHS.isHandleInSync()) && "handle not in sync!");
+    assert(getEpochAddress() == RHS.getEpochAddress() &&
+           "comparing incomparable iterators!");
+    return Ptr == RHS.Ptr;
+  }
+  bool operator!=(const ConstIterator &RHS) const {
+    assert((!Ptr || isHandleInSync()) && "handle not in sync!");
+    assert((!RHS.Ptr || RHS.isHandleInSync()) && "handle not in sync!");
+    assert(getEpochAddress() == RHS.getEpochAddress() &&
+           "comparing incomparable iterators!");
+    return Ptr != RHS.Ptr;
+  }
+
+  inline SwissMapIterator &operator++() { // Preincrement
+    assert(isHandleInSync() && "invalid iterator access!");
+    ++Ptr;
+    ++Ctrl;
+    AdvancePastEmptyBuckets();
+    return *this;
+  }
+  SwissMapIterator operator++(int) { // Postincrement
+    assert(isHandleInSync() && "invalid iterator access!");
+    SwissMapIterator tmp = *this;
+    ++*this;
+    return tmp;
+  }
+
+private:
+  void AdvancePastEmptyBuckets() {
+    while (Ptr != End && *Ctrl < 0) {
+      ++Ptr;
+      ++Ctrl;
+    }
+  }
+};
+
+template <typename KeyT, typename ValueT, typename KeyInfoT>
+inline size_t capacity_in_bytes(const SwissMap<KeyT, ValueT, KeyInfoT> &X) {
+  return X.getMemorySize();
+}
+
+} // end namespace llvm
+
+#endif // LLVM_ADT_SWISSMAP_H
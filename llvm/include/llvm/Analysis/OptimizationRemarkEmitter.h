@@ -74,8 +74,9 @@ public:
   template <typename T>
   void emit(T RemarkBuilder, decltype(RemarkBuilder()) * = nullptr) {
     // Avoid building the remark unless we know there are at least *some*
-    // remarks enabled. We can't currently check whether remarks are requested
-    // for the calling pass since that requires actually building the remark.
+    // remarks enabled. We can't check whether remarks are requested for the
+    // calling pass since that requires actually building the remark; passes
+    // that emit many remarks should pass their name to the overload below.
 
     if (F->getContext().getRemarkStreamer() ||
         F->getContext().getDiagHandlerPtr()->isAnyRemarkEnabled()) {
@@ -84,6 +85,17 @@ public:
     }
   }
 
+  /// Like the above, but the remark is only built if remarks from \p PassName
+  /// are requested. \p PassName must be the pass name of the remark.
+  template <typename T>
+  void emit(StringRef PassName, T RemarkBuilder,
+            decltype(RemarkBuilder()) * = nullptr) {
+    if (allowExtraAnalysis(PassName)) {
+      auto R = RemarkBuilder();
+      emit((DiagnosticInfoOptimizationBase &)R);
+    }
+  }
+
   /// Whether we allow for extra compile-time budget to perform more
   /// analysis to produce fewer false positives.
   ///
@@ -91,10 +103,7 @@ public:
   /// use the extra analysis (1) to filter trivial false positives or (2) to
   /// provide more context so that non-trivial false positives can be quickly
   /// detected by the user.
-  bool allowExtraAnalysis(StringRef PassName) const {
-    return (F->getContext().getRemarkStreamer() ||
-            F->getContext().getDiagHandlerPtr()->isAnyRemarkEnabled(PassName));
-  }
+  bool allowExtraAnalysis(StringRef PassName) const;
 
 private:
   const Function *F;
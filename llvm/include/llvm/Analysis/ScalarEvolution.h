@@ -1351,9 +1351,10 @@ private:
     /// value returned by getMax or zero.
     bool isMaxOrZero(ScalarEvolution *SE) const;
 
-    /// Return true if any backedge taken count expressions refer to the given
-    /// subexpression.
-    bool hasOperand(const SCEV *S, ScalarEvolution *SE) const;
+    /// Add the backedge taken count expressions and all of their
+    /// subexpressions to \p Ops.
+    void collectOperands(SmallPtrSetImpl<const SCEV *> &Ops,
+                         ScalarEvolution *SE) const;
 
     /// Invalidate this result and free associated memory.
     void clear();
@@ -1367,6 +1368,12 @@ private:
   /// function as they are computed.
   DenseMap<const Loop *, BackedgeTakenInfo> PredicatedBackedgeTakenCounts;
 
+  /// Maps each expression used by a cached backedge-taken count to the loops
+  /// using it, so that forgetMemoizedResults does not need to search all of
+  /// the counts. The integer part is set for predicated counts.
+  DenseMap<const SCEV *, SmallPtrSet<PointerIntPair<const Loop *, 1, bool>, 4>>
+      BECountUsers;
+
   /// This map contains entries for all of the PHI instructions that we
   /// attempt to compute constant evolutions for.  This allows us to avoid
   /// potentially expensive recomputation of these properties.  An instruction
@@ -1881,6 +1888,14 @@ private:
   /// accordingly.
   void addToLoopUseLists(const SCEV *S);
 
+  /// Add the (predicated, if \p Predicated is set) backedge-taken count of
+  /// \p L to \c BECountUsers.
+  void addToBECountUsers(const Loop *L, bool Predicated);
+
+  /// Drop the (predicated, if \p Predicated is set) backedge-taken count of
+  /// \p L and remove it from \c BECountUsers.
+  void forgetBackedgeTakenCount(const Loop *L, bool Predicated);
+
   /// Try to match the pattern generated by getURemExpr(A, B). If successful,
   /// Assign A and B to LHS and RHS, respectively.
   bool matchURem(const SCEV *Expr, const SCEV *&LHS, const SCEV *&RHS);
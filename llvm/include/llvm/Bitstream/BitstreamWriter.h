@@ -247,6 +247,25 @@ public:
     BlockScope.pop_back();
   }
 
+  /// Prepare this stream, which must be empty, to encode blocks that will
+  /// later be appended to \p Parent at its current position with
+  /// EmitSplicedBlocks. The blocks are encoded with the abbrev ID width of the
+  /// parent's current block and may use the abbrevs from its BLOCKINFO_BLOCK.
+  void InheritBlockInfo(const BitstreamWriter &Parent) {
+    assert(GetCurrentBitNo() == 0 && BlockScope.empty() &&
+           "Expected an empty stream");
+    CurCodeSize = Parent.CurCodeSize;
+    BlockInfoRecords = Parent.BlockInfoRecords;
+  }
+
+  /// Append the blocks encoded by a stream prepared with InheritBlockInfo.
+  /// Both the current position and \p Bytes must be 32-bit aligned.
+  void EmitSplicedBlocks(StringRef Bytes) {
+    assert(CurBit == 0 && "Not 32-bit aligned");
+    assert((Bytes.size() & 3) == 0 && "Blocks not 32-bit aligned");
+    Out.append(Bytes.begin(), Bytes.end());
+  }
+
   //===--------------------------------------------------------------------===//
   // Record Emission
   //===--------------------------------------------------------------------===//
@@ -20,6 +20,7 @@
 #include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/BitVector.h"
 #include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/DenseSet.h"
 #include "llvm/ADT/GraphTraits.h"
 #include "llvm/ADT/Optional.h"
 #include "llvm/ADT/SmallVector.h"
@@ -268,6 +269,26 @@ class MachineFunction {
   // Allocation management for basic blocks in function.
   Recycler<MachineBasicBlock> BasicBlockRecycler;
 
+  /// Hashes and compares MachineMemOperands by all of their fields.
+  struct MemOperandInfo {
+    static MachineMemOperand *getEmptyKey() {
+      return DenseMapInfo<MachineMemOperand *>::getEmptyKey();
+    }
+    static MachineMemOperand *getTombstoneKey() {
+      return DenseMapInfo<MachineMemOperand *>::getTombstoneKey();
+    }
+    static unsigned getHashValue(const MachineMemOperand *MMO);
+    static bool isEqual(const MachineMemOperand *LHS,
+                        const MachineMemOperand *RHS);
+  };
+
+  /// The memory operands handed out so far, with -unique-machine-memoperands.
+  DenseSet<MachineMemOperand *, MemOperandInfo> MemOperandPool;
+
+  /// Return a MachineMemOperand equal to \p MMO, allocating it if uniquing is
+  /// disabled or this function has no such memory operand yet.
+  MachineMemOperand *getOrCreateMemOperand(const MachineMemOperand &MMO);
+
   // List of machine basic blocks in function
   using BasicBlockListType = ilist<MachineBasicBlock>;
   BasicBlockListType BasicBlocks;
@@ -157,20 +157,16 @@ public:
   /// that are normally too noisy.  In this mode, we can use the extra analysis
   /// (1) to filter trivial false positives or (2) to provide more context so
   /// that non-trivial false positives can be quickly detected by the user.
-  bool allowExtraAnalysis(StringRef PassName) const {
-    return (
-        MF.getFunction().getContext().getRemarkStreamer() ||
-        MF.getFunction().getContext().getDiagHandlerPtr()->isAnyRemarkEnabled(
-            PassName));
-  }
+  bool allowExtraAnalysis(StringRef PassName) const;
 
   /// Take a lambda that returns a remark which will be emitted.  Second
   /// argument is only used to restrict this to functions.
   template <typename T>
   void emit(T RemarkBuilder, decltype(RemarkBuilder()) * = nullptr) {
     // Avoid building the remark unless we know there are at least *some*
-    // remarks enabled. We can't currently check whether remarks are requested
-    // for the calling pass since that requires actually building the remark.
+    // remarks enabled. We can't check whether remarks are requested for the
+    // calling pass since that requires actually building the remark; passes
+    // that emit many remarks should pass their name to the overload below.
 
     if (MF.getFunction().getContext().getRemarkStreamer() ||
         MF.getFunction()
@@ -182,6 +178,17 @@ public:
     }
   }
 
+  /// Like the above, but the remark is only built if remarks from \p PassName
+  /// are requested. \p PassName must be the pass name of the remark.
+  template <typename T>
+  void emit(StringRef PassName, T RemarkBuilder,
+            decltype(RemarkBuilder()) * = nullptr) {
+    if (allowExtraAnalysis(PassName)) {
+      auto R = RemarkBuilder();
+      emit((DiagnosticInfoOptimizationBase &)R);
+    }
+  }
+
 private:
   MachineFunction &MF;
 
@@ -139,6 +139,9 @@ namespace llvm {
   /// Basic register allocator.
   extern char &RABasicID;
 
+  /// Linear scan register allocator.
+  extern char &RALinearScanID;
+
   /// VirtRegRewriter pass. Rewrite virtual registers to physical registers as
   /// assigned in VirtRegMap.
   extern char &VirtRegRewriterID;
@@ -171,6 +174,13 @@ namespace llvm {
   ///
   FunctionPass *createGreedyRegisterAllocator();
 
+  /// LinearScanRegisterAllocation Pass - This pass assigns registers in the
+  /// order of the live ranges, with cheap spilling and splitting decisions, for
+  /// builds that want better code than the fast allocator in less time than
+  /// the greedy one.
+  ///
+  FunctionPass *createLinearScanRegisterAllocator();
+
   /// PBQPRegisterAllocation Pass - This pass implements the Partitioned Boolean
   /// Quadratic Prograaming (PBQP) based register allocator.
   ///
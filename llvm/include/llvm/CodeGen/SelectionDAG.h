@@ -1725,6 +1725,13 @@ private:
   SDNode *FindNodeOrInsertPos(const FoldingSetNodeID &ID, const SDLoc &DL,
                               void *&InsertPos);
 
+  /// Look up the node with opcode \p Opcode, value types \p VTs, operands
+  /// \p Ops and no other data in CSEMap, like the overload above does for the
+  /// ID of such a node, without building the IDs of the nodes it compares.
+  SDNode *FindNodeOrInsertPos(unsigned Opcode, SDVTList VTs,
+                              ArrayRef<SDValue> Ops, const SDLoc &DL,
+                              void *&InsertPos);
+
   /// List of non-single value types.
   FoldingSet<SDVTListNode> VTListMap;
 
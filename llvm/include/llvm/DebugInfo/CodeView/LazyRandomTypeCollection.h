@@ -70,6 +70,17 @@ public:
 
   uint32_t getOffsetOfType(TypeIndex Index);
 
+  /// Returns the offset of every record in the type stream, in type index
+  /// order. This scans the whole stream, but the result can be saved and
+  /// handed to setTypeOffsets() whenever the same stream is loaded again.
+  std::vector<uint32_t> getTypeOffsets() const;
+
+  /// Makes every record of the type stream known from \p Offsets, as returned
+  /// by getTypeOffsets() for the same stream, so that no lookup ever has to
+  /// scan the stream. Fails without changing the collection if \p Offsets
+  /// doesn't describe the records of the stream.
+  Error setTypeOffsets(ArrayRef<uint32_t> Offsets);
+
   Optional<CVType> tryGetType(TypeIndex Index);
 
   CVType getType(TypeIndex Index) override;
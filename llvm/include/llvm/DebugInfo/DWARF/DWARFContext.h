@@ -26,6 +26,7 @@
 #include "llvm/DebugInfo/DWARF/DWARFDebugMacro.h"
 #include "llvm/DebugInfo/DWARF/DWARFDie.h"
 #include "llvm/DebugInfo/DWARF/DWARFGdbIndex.h"
+#include "llvm/DebugInfo/DWARF/DWARFLineIndex.h"
 #include "llvm/DebugInfo/DWARF/DWARFObject.h"
 #include "llvm/DebugInfo/DWARF/DWARFSection.h"
 #include "llvm/DebugInfo/DWARF/DWARFTypeUnit.h"
@@ -91,6 +92,10 @@ class DWARFContext : public DIContext {
 
   std::unique_ptr<MCRegisterInfo> RegInfo;
 
+  /// If set, file and line queries are answered from this index instead of
+  /// the line tables.
+  std::unique_ptr<DWARFLineIndex> LineIndex;
+
   /// Read compile units from the debug_info section (if necessary)
   /// and type units from the debug_types sections (if necessary)
   /// and store them in NormalUnits.
@@ -230,6 +235,21 @@ public:
   /// Get a DIE given an exact offset.
   DWARFDie getDIEForOffset(uint64_t Offset);
 
+  /// Extract the DIEs of all normal units up front, spreading the units over
+  /// at most \p NumThreads threads, or one per core if it is zero. Units are
+  /// otherwise extracted serially on first access, which dominates the cost
+  /// of clients that walk all of the debug info.
+  void extractAllDIEs(unsigned NumThreads = 0);
+
+  /// Answer file and line queries from \p Index, e.g. one that was built by
+  /// DWARFLineIndex::build() for this context and cached. Queries that don't
+  /// ask for a function name then don't need to find the compile unit or
+  /// parse its line table.
+  void setLineIndex(std::unique_ptr<DWARFLineIndex> Index) {
+    LineIndex = std::move(Index);
+  }
+  const DWARFLineIndex *getLineIndex() const { return LineIndex.get(); }
+
   unsigned getMaxVersion() {
     // Ensure info units have been parsed to discover MaxVersion
     info_section_units();
@@ -11,6 +11,7 @@
 
 #include "llvm/DebugInfo/DWARF/DWARFAbbreviationDeclaration.h"
 #include "llvm/Support/DataExtractor.h"
+#include <cassert>
 #include <cstdint>
 #include <map>
 #include <vector>
@@ -39,6 +40,18 @@ public:
   const DWARFAbbreviationDeclaration *
   getAbbreviationDeclaration(uint32_t AbbrCode) const;
 
+  /// Returns the position of \p Decl, which must belong to this set.
+  uint32_t getDeclarationIndex(const DWARFAbbreviationDeclaration *Decl) const {
+    assert(Decl >= Decls.data() && Decl < Decls.data() + Decls.size());
+    return Decl - Decls.data();
+  }
+
+  const DWARFAbbreviationDeclaration &
+  getDeclarationAtIndex(uint32_t Index) const {
+    assert(Index < Decls.size());
+    return Decls[Index];
+  }
+
   const_iterator begin() const {
     return Decls.begin();
   }
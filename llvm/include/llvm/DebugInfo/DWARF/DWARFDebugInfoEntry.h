@@ -11,6 +11,7 @@
 
 #include "llvm/BinaryFormat/Dwarf.h"
 #include "llvm/DebugInfo/DWARF/DWARFAbbreviationDeclaration.h"
+#include "llvm/DebugInfo/DWARF/DWARFDebugAbbrev.h"
 #include "llvm/DebugInfo/DWARF/DWARFDataExtractor.h"
 #include <cstdint>
 
@@ -20,6 +21,11 @@ class DataExtractor;
 class DWARFUnit;
 
 /// DWARFDebugInfoEntry - A DIE with only the minimum required data.
+///
+/// Units keep one of these for every DIE they contain, so the entry is kept
+/// to 16 bytes: the abbreviation declaration is referred to by its index in
+/// the unit's abbreviation set rather than by pointer, and the attributes are
+/// only decoded when they are looked up through a DWARFDie.
 class DWARFDebugInfoEntry {
   /// Offset within the .debug_info of the start of this entry.
   uint64_t Offset = 0;
@@ -28,7 +34,9 @@ class DWARFDebugInfoEntry {
   /// compile/type unit DIE has a depth of zero.
   uint32_t Depth = 0;
 
-  const DWARFAbbreviationDeclaration *AbbrevDecl = nullptr;
+  /// Index of the abbreviation declaration in the unit's abbreviation set plus
+  /// one, or zero for a NULL entry.
+  uint32_t AbbrevIdx = 0;
 
 public:
   DWARFDebugInfoEntry() = default;
@@ -46,14 +54,18 @@ public:
   uint64_t getOffset() const { return Offset; }
   uint32_t getDepth() const { return Depth; }
 
-  dwarf::Tag getTag() const {
-    return AbbrevDecl ? AbbrevDecl->getTag() : dwarf::DW_TAG_null;
-  }
-
-  bool hasChildren() const { return AbbrevDecl && AbbrevDecl->hasChildren(); }
-
-  const DWARFAbbreviationDeclaration *getAbbreviationDeclarationPtr() const {
-    return AbbrevDecl;
+  /// Returns true for an entry that terminates a sibling chain.
+  bool isNULL() const { return AbbrevIdx == 0; }
+
+  /// Get the abbreviation declaration of this entry from \p Abbrevs, the
+  /// abbreviation set of the unit the entry was extracted from.
+  ///
+  /// \returns the abbreviation declaration or NULL for null tags.
+  const DWARFAbbreviationDeclaration *getAbbreviationDeclarationPtr(
+      const DWARFAbbreviationDeclarationSet *Abbrevs) const {
+    if (isNULL())
+      return nullptr;
+    return &Abbrevs->getDeclarationAtIndex(AbbrevIdx - 1);
   }
 };
 
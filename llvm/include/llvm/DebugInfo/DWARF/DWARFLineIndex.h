@@ -0,0 +1,102 @@
+//===- DWARFLineIndex.h -----------------------------------------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_DEBUGINFO_DWARF_DWARFLINEINDEX_H
+#define LLVM_DEBUGINFO_DWARF_DWARFLINEINDEX_H
+
+#include "llvm/ADT/StringRef.h"
+#include "llvm/DebugInfo/DIContext.h"
+#include "llvm/Object/ObjectFile.h"
+#include "llvm/Support/Error.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace llvm {
+
+class DWARFContext;
+class raw_ostream;
+
+/// A compact index of the line tables of all compile units of a
+/// DWARFContext, for clients that resolve many addresses to file and line.
+///
+/// The rows of each sequence are split into buckets of up to BucketSize rows.
+/// Every bucket stores its first row in full, and the other rows as deltas
+/// from the previous row in a shared byte array. A lookup binary searches the
+/// sequences, then the buckets of the sequence, and finally decodes at most
+/// BucketSize rows, without ever touching the DIEs or the .debug_line
+/// section. The index takes a few bytes per row, compared to the 40 bytes of
+/// a DWARFDebugLine::Row.
+///
+/// An index can be saved with encode() and loaded with decode(), so it only
+/// needs to be built once per binary.
+class DWARFLineIndex {
+public:
+  /// The number of rows per bucket, i.e. the maximum number of rows that are
+  /// decoded per lookup.
+  static constexpr uint32_t BucketSize = 16;
+
+  /// Builds the index from the line tables of all compile units of \p Ctx.
+  /// If sequences of different units overlap, the sequence with the lower
+  /// start address is indexed and the other one is dropped.
+  static DWARFLineIndex build(DWARFContext &Ctx);
+
+  /// Loads an index saved by encode().
+  static Expected<DWARFLineIndex> decode(StringRef Data);
+
+  /// Saves the index in a form that decode() can load.
+  void encode(raw_ostream &OS) const;
+
+  /// Fills the file name, line, column and discriminator of \p Result for
+  /// \p Address. Returns true if the address is covered by a sequence.
+  bool getFileLineInfoForAddress(object::SectionedAddress Address,
+                                 DILineInfoSpecifier::FileLineInfoKind Kind,
+                                 DILineInfo &Result) const;
+
+  size_t getNumSequences() const { return Sequences.size(); }
+  size_t getNumRows() const { return NumRows; }
+
+private:
+  struct Sequence {
+    uint64_t SectionIndex;
+    uint64_t LowPC;
+    uint64_t HighPC;
+    uint32_t FirstBucket;
+    uint32_t NumBuckets;
+  };
+
+  /// The full state of the first row of a bucket. The following rows of the
+  /// bucket are delta encoded in RowData, starting at DataOffset.
+  struct Bucket {
+    uint64_t Address;
+    uint32_t DataOffset;
+    uint32_t File;
+    uint32_t Line;
+    uint32_t Discriminator;
+    uint16_t Column;
+  };
+
+  /// The file names of the rows, as returned for FileLineInfoKind::Default
+  /// and FileLineInfoKind::AbsoluteFilePath.
+  struct FileName {
+    std::string Name;
+    std::string Path;
+  };
+
+  const Sequence *findSequence(object::SectionedAddress Address) const;
+
+  std::vector<Sequence> Sequences;
+  std::vector<Bucket> Buckets;
+  std::vector<uint8_t> RowData;
+  std::vector<FileName> Files;
+  size_t NumRows = 0;
+};
+
+} // end namespace llvm
+
+#endif // LLVM_DEBUGINFO_DWARF_DWARFLINEINDEX_H
@@ -9,6 +9,7 @@
 #ifndef LLVM_DEBUGINFO_DWARF_DWARFVERIFIER_H
 #define LLVM_DEBUGINFO_DWARF_DWARFVERIFIER_H
 
+#include "llvm/ADT/STLExtras.h"
 #include "llvm/DebugInfo/DIContext.h"
 #include "llvm/DebugInfo/DWARF/DWARFAcceleratorTable.h"
 #include "llvm/DebugInfo/DWARF/DWARFAddressRange.h"
@@ -105,6 +106,21 @@ private:
   raw_ostream &note() const;
   raw_ostream &dump(const DWARFDie &Die, unsigned indent = 0) const;
 
+  /// Calls \p Verify for the items 0 to \p Count - 1, using up to
+  /// DumpOpts.NumThreads threads.
+  ///
+  /// Every thread verifies a contiguous range of items with its own verifier,
+  /// which buffers the output and the references that it found. These are
+  /// merged into this verifier in item order, so the output does not depend
+  /// on the number of threads. \p Verify must only use the verifier it is
+  /// passed, and must not touch lazily parsed state of the DWARFContext that
+  /// was not parsed before.
+  ///
+  /// \returns The number of errors that occurred during verification.
+  unsigned
+  verifyInParallel(size_t Count,
+                   function_ref<unsigned(DWARFVerifier &, size_t)> Verify);
+
   /// Verifies the abbreviations section.
   ///
   /// This function currently checks that:
@@ -0,0 +1,73 @@
+//===- DwarfTransformer.h ---------------------------------------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_DEBUGINFO_GSYM_DWARFTRANSFORMER_H
+#define LLVM_DEBUGINFO_GSYM_DWARFTRANSFORMER_H
+
+#include "llvm/Support/Error.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace llvm {
+
+class DWARFContext;
+class DWARFDie;
+class raw_ostream;
+
+namespace gsym {
+
+class GsymCreator;
+struct FunctionInfo;
+struct InlineInfo;
+
+/// DwarfTransformer converts the DWARF of an object file into GSYM.
+///
+/// Every concrete subprogram DIE with address ranges becomes one FunctionInfo
+/// per address range. The FunctionInfo gets the rows of the DWARF line table
+/// that fall into the range as its LineTable, and the inlined subroutines
+/// within the subprogram as its InlineInfo tree, so that lookups in the
+/// resulting GSYM file produce the same source locations and inline call
+/// stacks as the DWARF did.
+class DwarfTransformer {
+public:
+  /// \param D The DWARF to convert.
+  /// \param OS Stream that receives warnings about DWARF that can't be
+  /// represented, e.g. inline ranges that aren't within their parent.
+  /// \param G The GsymCreator that receives the function infos. The caller
+  /// finalizes and saves it.
+  DwarfTransformer(DWARFContext &D, raw_ostream &OS, GsymCreator &G)
+      : DICtx(D), Log(OS), Gsym(G) {}
+
+  /// Convert all compile units.
+  ///
+  /// \param NumThreads The number of threads used to extract the DIEs of the
+  /// units and to convert them, or zero for one per core. The function infos
+  /// are added to the GsymCreator in no particular order when more than one
+  /// thread is used; GsymCreator::finalize() sorts them.
+  llvm::Error convert(uint32_t NumThreads);
+
+private:
+  /// Per compile unit state.
+  struct CUInfo;
+
+  void handleDie(CUInfo &CUI, DWARFDie Die);
+  void handleSubprogram(CUInfo &CUI, DWARFDie Die);
+  void parseInlineInfo(CUInfo &CUI, DWARFDie Die, InlineInfo &Parent);
+  void convertLineTable(CUInfo &CUI, FunctionInfo &FI, uint64_t SectionIndex);
+
+  DWARFContext &DICtx;
+  raw_ostream &Log;
+  GsymCreator &Gsym;
+  std::atomic<size_t> NumFunctions{0};
+};
+
+} // namespace gsym
+} // namespace llvm
+
+#endif // #ifndef LLVM_DEBUGINFO_GSYM_DWARFTRANSFORMER_H
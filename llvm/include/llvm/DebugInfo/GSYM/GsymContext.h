@@ -0,0 +1,69 @@
+//===- GsymContext.h --------------------------------------------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_DEBUGINFO_GSYM_GSYMCONTEXT_H
+#define LLVM_DEBUGINFO_GSYM_GSYMCONTEXT_H
+
+#include "llvm/DebugInfo/DIContext.h"
+#include "llvm/DebugInfo/GSYM/GsymReader.h"
+#include <string>
+
+namespace llvm {
+namespace gsym {
+
+struct FunctionInfo;
+struct LineEntry;
+
+/// A DIContext that answers address lookups from a GSYM file.
+///
+/// This lets clients of DIContext, like the symbolizer, use a GSYM file
+/// instead of the DWARF it was created from. Lookups only read the
+/// GsymReader, so unlike DWARFContext a GsymContext can be queried from
+/// multiple threads at once.
+class GsymContext : public DIContext {
+public:
+  GsymContext(GsymReader Reader);
+  GsymContext(GsymContext &) = delete;
+  GsymContext &operator=(GsymContext &) = delete;
+
+  static bool classof(const DIContext *DICtx) {
+    return DICtx->getKind() == CK_GSYM;
+  }
+
+  void dump(raw_ostream &OS, DIDumpOptions DIDumpOpts) override;
+
+  DILineInfo getLineInfoForAddress(
+      object::SectionedAddress Address,
+      DILineInfoSpecifier Specifier = DILineInfoSpecifier()) override;
+  DILineInfoTable getLineInfoForAddressRange(
+      object::SectionedAddress Address, uint64_t Size,
+      DILineInfoSpecifier Specifier = DILineInfoSpecifier()) override;
+  DIInliningInfo getInliningInfoForAddress(
+      object::SectionedAddress Address,
+      DILineInfoSpecifier Specifier = DILineInfoSpecifier()) override;
+
+  /// GSYM doesn't describe variables, so this is always empty.
+  std::vector<DILocal>
+  getLocalsForAddress(object::SectionedAddress Address) override;
+
+private:
+  /// Returns the full path of the file at \p Index in the file table, or
+  /// an empty string if there is none.
+  std::string getFilePath(uint32_t Index) const;
+
+  /// Returns the line entry of \p FI for \p Addr, or an invalid entry if the
+  /// function has no line table.
+  static LineEntry lookupLine(const FunctionInfo &FI, uint64_t Addr);
+
+  GsymReader Reader;
+};
+
+} // namespace gsym
+} // namespace llvm
+
+#endif // #ifndef LLVM_DEBUGINFO_GSYM_GSYMCONTEXT_H
@@ -0,0 +1,44 @@
+//===- ObjectFileTransformer.h ----------------------------------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_DEBUGINFO_GSYM_OBJECTFILETRANSFORMER_H
+#define LLVM_DEBUGINFO_GSYM_OBJECTFILETRANSFORMER_H
+
+#include "llvm/Support/Error.h"
+
+namespace llvm {
+
+class raw_ostream;
+
+namespace object {
+class ObjectFile;
+}
+
+namespace gsym {
+
+class GsymCreator;
+
+/// ObjectFileTransformer adds the function symbols of an object file to a
+/// GsymCreator, and sets its UUID from the build ID of the object.
+///
+/// Functions without debug info still get a name this way. Symbols that
+/// cover the same address range as a FunctionInfo from the debug info are
+/// removed by GsymCreator::finalize().
+class ObjectFileTransformer {
+public:
+  /// \param Obj The object file whose symbol table is converted.
+  /// \param Log Stream that receives warnings about symbols that are skipped.
+  /// \param Gsym The GsymCreator that receives the function infos.
+  static llvm::Error convert(const object::ObjectFile &Obj, raw_ostream &Log,
+                             GsymCreator &Gsym);
+};
+
+} // namespace gsym
+} // namespace llvm
+
+#endif // #ifndef LLVM_DEBUGINFO_GSYM_OBJECTFILETRANSFORMER_H
@@ -41,6 +41,9 @@ public:
   // Returns the preferred base of the module, i.e. where the loader would place
   // it in memory assuming there were no conflicts.
   virtual uint64_t getModulePreferredBase() const = 0;
+
+  // Return true if the module can be queried from multiple threads at once.
+  virtual bool isThreadSafe() const { return false; }
 };
 
 } // end namespace symbolize
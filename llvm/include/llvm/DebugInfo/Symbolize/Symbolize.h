@@ -21,6 +21,7 @@
 #include <cstdint>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <utility>
 #include <vector>
@@ -44,8 +45,17 @@ public:
     std::vector<std::string> DsymHints;
     std::string FallbackDebugPath;
     std::string DWPName;
+    /// Convert the DWARF of each module to GSYM and answer queries from that.
+    /// GSYM lookups are much cheaper than DWARF ones and can run concurrently.
+    bool UseGSYM = false;
+    /// Directory to keep the GSYM files in, so that later runs don't need to
+    /// convert the DWARF again. GSYM data is only kept in memory if empty.
+    std::string GsymCacheDir;
   };
 
+  /// An LLVMSymbolizer can be used from multiple threads. Queries of modules
+  /// that aren't thread-safe (see SymbolizableModule::isThreadSafe) are
+  /// serialized.
   LLVMSymbolizer() = default;
   LLVMSymbolizer(const Options &Opts) : Opts(Opts) {}
 
@@ -92,6 +102,13 @@ private:
                    std::unique_ptr<DIContext> Context,
                    StringRef ModuleName);
 
+  /// Returns a GsymContext for the debug info in \p DebugObj, taken from the
+  /// GSYM cache if possible, or null if the debug info can't be converted.
+  std::unique_ptr<DIContext> createGsymContext(const ObjectFile &DebugObj);
+
+  /// Locks QueryMutex unless \p Info can be queried concurrently.
+  std::unique_lock<std::mutex> lockModule(const SymbolizableModule *Info);
+
   ObjectFile *lookUpDsymFile(const std::string &Path,
                              const MachOObjectFile *ExeObj,
                              const std::string &ArchName);
@@ -124,6 +141,12 @@ private:
       ObjectForUBPathAndArch;
 
   Options Opts;
+
+  /// Guards the module and object caches above.
+  std::mutex ModulesMutex;
+
+  /// Serializes queries of modules that aren't thread-safe.
+  std::mutex QueryMutex;
 };
 
 } // end namespace symbolize
@@ -17,7 +17,11 @@
 #include "llvm/ExecutionEngine/JITSymbol.h"
 #include "llvm/Support/Error.h"
 #include "llvm/Support/Memory.h"
+#include <atomic>
 #include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
 
 namespace llvm {
 namespace jitlink {
@@ -92,6 +96,105 @@ public:
   allocate(const SegmentsRequestMap &Request) override;
 };
 
+/// A JITLinkMemoryManager that allocates memory shared with the process the
+/// code runs in.
+///
+/// Each allocation is a shared memory object, mapped read-write in this
+/// process to serve as the linker working memory, and mapped by the Mapper
+/// in the executor at the target addresses. Both mappings use the same
+/// physical pages, so finalizing the allocation only applies the final
+/// protections on the executor side: the content is never copied, and the
+/// executor never needs its code to be writable.
+///
+/// Shared memory objects are only supported on Unix hosts.
+class SharedMemoryManager : public JITLinkMemoryManager {
+public:
+  /// Maps the shared memory objects in the executor.
+  class Mapper {
+  public:
+    virtual ~Mapper();
+
+    /// Should map Size bytes of the shared memory object with the given name
+    /// and return the address of the mapping. The object is unlinked as soon
+    /// as this returns.
+    virtual Expected<JITTargetAddress> map(StringRef Name, uint64_t Size) = 0;
+
+    /// Should apply the given protections to a range of a mapping, once its
+    /// content is final.
+    virtual Error protect(JITTargetAddress Addr, uint64_t Size,
+                          ProtectionFlags Prot) = 0;
+
+    /// Should unmap a mapping returned by map.
+    virtual Error unmap(JITTargetAddress Addr, uint64_t Size) = 0;
+  };
+
+  /// Maps the shared memory objects a second time in this process.
+  class InProcessMapper : public Mapper {
+  public:
+    Expected<JITTargetAddress> map(StringRef Name, uint64_t Size) override;
+    Error protect(JITTargetAddress Addr, uint64_t Size,
+                  ProtectionFlags Prot) override;
+    Error unmap(JITTargetAddress Addr, uint64_t Size) override;
+  };
+
+  SharedMemoryManager(
+      std::unique_ptr<Mapper> M = std::make_unique<InProcessMapper>())
+      : M(std::move(M)) {}
+
+  Expected<std::unique_ptr<Allocation>>
+  allocate(const SegmentsRequestMap &Request) override;
+
+private:
+  std::unique_ptr<Mapper> M;
+  std::atomic<uint64_t> NextObjectId{0};
+};
+
+/// A JITLinkMemoryManager that packs the segments of many allocations into
+/// shared in-process slabs.
+///
+/// Each slab is a shared memory object mapped twice: once read-write, to serve
+/// as the linker working memory, and once with the final protections of the
+/// segments it holds. Segments with the same protections share slabs at their
+/// requested alignment, so an object with a few hundred bytes of code does not
+/// take a page of its own, and the mappings of the slabs never change while
+/// code in them runs. Finalizing an allocation only invalidates the
+/// instruction cache for its code.
+///
+/// Deallocated ranges are reused by later allocations. A slab is unmapped as
+/// soon as it is empty, except for the last slab of each protection. Segments
+/// larger than the slab size get a slab of their own.
+///
+/// Shared memory objects are only supported on Unix hosts.
+class SlabMemoryManager : public JITLinkMemoryManager {
+public:
+  SlabMemoryManager(uint64_t SlabSize = 1024 * 1024);
+  ~SlabMemoryManager() override;
+
+  Expected<std::unique_ptr<Allocation>>
+  allocate(const SegmentsRequestMap &Request) override;
+
+  /// Returns the number of slabs currently mapped.
+  size_t getNumSlabs() const;
+
+private:
+  class Slab;
+
+  struct SlabRange {
+    Slab *S = nullptr;
+    uint64_t Offset = 0;
+    uint64_t Size = 0;
+  };
+
+  Expected<SlabRange> allocateRange(ProtectionFlags Prot, uint64_t Size,
+                                    uint64_t Alignment);
+  void releaseRange(ProtectionFlags Prot, const SlabRange &Range);
+
+  mutable std::mutex SlabsMutex;
+  uint64_t SlabSize;
+  DenseMap<unsigned, std::vector<std::unique_ptr<Slab>>> Slabs;
+  uint64_t NextObjectId = 0;
+};
+
 } // end namespace jitlink
 } // end namespace llvm
 
@@ -15,6 +15,8 @@
 
 #include "llvm/ExecutionEngine/Orc/JITTargetMachineBuilder.h"
 #include <memory>
+#include <mutex>
+#include <vector>
 
 namespace llvm {
 
@@ -71,8 +73,11 @@ private:
 
 /// A thread-safe version of SimpleCompiler.
 ///
-/// This class creates a new TargetMachine and SimpleCompiler instance for each
-/// compile.
+/// This class creates a new SimpleCompiler instance for each compile. The
+/// TargetMachines are created on demand and handed back to a pool shared by
+/// all copies of the compiler once the compile is done, so there are never
+/// more of them than concurrent compiles, and they are not set up again for
+/// every module.
 class ConcurrentIRCompiler {
 public:
   ConcurrentIRCompiler(JITTargetMachineBuilder JTMB,
@@ -82,9 +87,22 @@ public:
 
   std::unique_ptr<MemoryBuffer> operator()(Module &M);
 
+  /// Returns the number of TargetMachines created so far.
+  size_t getNumTargetMachinesCreated() const;
+
 private:
+  struct TargetMachinePool {
+    std::mutex PoolMutex;
+    std::vector<std::unique_ptr<TargetMachine>> Available;
+    size_t NumCreated = 0;
+  };
+
+  Expected<std::unique_ptr<TargetMachine>> takeTargetMachine();
+  void returnTargetMachine(std::unique_ptr<TargetMachine> TM);
+
   JITTargetMachineBuilder JTMB;
   ObjectCache *ObjCache = nullptr;
+  std::shared_ptr<TargetMachinePool> TMPool;
 };
 
 } // end namespace orc
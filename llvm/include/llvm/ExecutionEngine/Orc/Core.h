@@ -20,6 +20,7 @@
 #include "llvm/ExecutionEngine/OrcV1Deprecation.h"
 #include "llvm/IR/Module.h"
 #include "llvm/Support/Debug.h"
+#include "llvm/Support/RWMutex.h"
 
 #include <memory>
 #include <vector>
@@ -748,6 +749,19 @@ private:
       std::vector<std::pair<JITDylib *, SymbolStringPtr>>;
   static void notifyFailed(FailedSymbolsWorklist FailedSymbols);
 
+  /// Update the published copy of the symbol table. These must be called
+  /// with the session lock held, alongside the changes to Symbols.
+  void publishDefinition(const SymbolStringPtr &Name);
+  void publishReady(const SymbolStringPtr &Name, JITEvaluatedSymbol Sym);
+  void unpublish(const SymbolStringPtr &Name);
+  void publishHasGenerators(bool HasGenerators);
+
+  /// The names defined by this JITDylib, with the address of the ones that are
+  /// ready, for the lookups of ready symbols that do not take the session
+  /// lock (see ExecutionSession::lookupReady).
+  using PublishedSymbolsMap =
+      DenseMap<SymbolStringPtr, Optional<JITEvaluatedSymbol>>;
+
   ExecutionSession &ES;
   std::string JITDylibName;
   SymbolTable Symbols;
@@ -755,6 +769,12 @@ private:
   MaterializingInfosMap MaterializingInfos;
   std::vector<std::unique_ptr<DefinitionGenerator>> DefGenerators;
   JITDylibSearchList SearchOrder;
+
+  // Guards PublishedSymbols and HasGenerators, which are written under the
+  // session lock too.
+  mutable sys::RWMutex PublishedSymbolsMutex;
+  PublishedSymbolsMap PublishedSymbols;
+  bool HasGenerators = false;
 };
 
 /// An ExecutionSession represents a running JIT program.
@@ -925,6 +945,12 @@ private:
 
   void runOutstandingMUs();
 
+  /// Look up symbols that are all ready without taking the session lock.
+  /// Returns None if any of them has to go through the full lookup: if it is
+  /// not ready yet, is not found, or may be added by a definition generator.
+  Optional<SymbolMap> lookupReady(const JITDylibSearchList &SearchOrder,
+                                  const SymbolNameSet &Symbols);
+
   mutable std::recursive_mutex SessionMutex;
   std::shared_ptr<SymbolStringPool> SSP;
   VModuleKey LastKey = 0;
@@ -944,8 +970,10 @@ private:
 template <typename GeneratorT>
 GeneratorT &JITDylib::addGenerator(std::unique_ptr<GeneratorT> DefGenerator) {
   auto &G = *DefGenerator;
-  ES.runSessionLocked(
-      [&]() { DefGenerators.push_back(std::move(DefGenerator)); });
+  ES.runSessionLocked([&]() {
+    DefGenerators.push_back(std::move(DefGenerator));
+    publishHasGenerators(true);
+  });
   return G;
 }
 
@@ -123,6 +123,14 @@ public:
     return *this;
   }
 
+  /// Deallocates the memory of the objects emitted for key K, once the
+  /// plugins have been notified. The symbols of the objects should have been
+  /// removed from their JITDylib first, and no code in them may still run.
+  Error removeModule(VModuleKey K);
+
+  /// Deallocates the memory of all the objects emitted by this layer.
+  Error removeAllModules();
+
 private:
   using AllocPtr = std::unique_ptr<jitlink::JITLinkMemoryManager::Allocation>;
 
@@ -131,14 +139,11 @@ private:
   void notifyLoaded(MaterializationResponsibility &MR);
   Error notifyEmitted(MaterializationResponsibility &MR, AllocPtr Alloc);
 
-  Error removeModule(VModuleKey K);
-  Error removeAllModules();
-
   mutable std::mutex LayerMutex;
   jitlink::JITLinkMemoryManager &MemMgr;
   bool OverrideObjectFlags = false;
   bool AutoClaimObjectSymbols = false;
-  DenseMap<VModuleKey, AllocPtr> TrackedAllocs;
+  DenseMap<VModuleKey, std::vector<AllocPtr>> TrackedAllocs;
   std::vector<AllocPtr> UntrackedAllocs;
   std::vector<std::unique_ptr<Plugin>> Plugins;
 };
@@ -161,7 +166,7 @@ private:
 
   jitlink::EHFrameRegistrar &Registrar;
   DenseMap<MaterializationResponsibility *, EHFrameRange> InProcessLinks;
-  DenseMap<VModuleKey, EHFrameRange> TrackedEHFrameRanges;
+  DenseMap<VModuleKey, std::vector<EHFrameRange>> TrackedEHFrameRanges;
   std::vector<EHFrameRange> UntrackedEHFrameRanges;
 };
 
@@ -179,18 +179,24 @@ public:
     bool finalizeMemory(std::string *ErrMsg = nullptr) override {
       LLVM_DEBUG(dbgs() << "Allocator " << Id << " finalizing:\n");
 
-      for (auto &ObjAllocs : Unfinalized) {
-        if (copyAndProtect(ObjAllocs.CodeAllocs, ObjAllocs.RemoteCodeAddr,
-                           sys::Memory::MF_READ | sys::Memory::MF_EXEC))
+      if (Client.hasWriteMemAndProtect()) {
+        if (copyAndProtectAll())
           return true;
+      } else {
+        for (auto &ObjAllocs : Unfinalized) {
+          if (copyAndProtect(ObjAllocs.CodeAllocs, ObjAllocs.RemoteCodeAddr,
+                             sys::Memory::MF_READ | sys::Memory::MF_EXEC))
+            return true;
 
-        if (copyAndProtect(ObjAllocs.RODataAllocs, ObjAllocs.RemoteRODataAddr,
-                           sys::Memory::MF_READ))
-          return true;
+          if (copyAndProtect(ObjAllocs.RODataAllocs,
+                             ObjAllocs.RemoteRODataAddr, sys::Memory::MF_READ))
+            return true;
 
-        if (copyAndProtect(ObjAllocs.RWDataAllocs, ObjAllocs.RemoteRWDataAddr,
-                           sys::Memory::MF_READ | sys::Memory::MF_WRITE))
-          return true;
+          if (copyAndProtect(ObjAllocs.RWDataAllocs,
+                             ObjAllocs.RemoteRWDataAddr,
+                             sys::Memory::MF_READ | sys::Memory::MF_WRITE))
+            return true;
+        }
       }
       Unfinalized.clear();
 
@@ -316,6 +322,43 @@ public:
       return false;
     }
 
+    // Copies the data of all the unfinalized allocs and sets the permissions on
+    // their segments with a single call.
+    bool copyAndProtectAll() {
+      std::vector<DirectBufferWriter> Writes;
+      std::vector<std::pair<JITTargetAddress, uint32_t>> Prots;
+
+      auto AddSegment = [&](const std::vector<Alloc> &Allocs,
+                            JITTargetAddress RemoteSegmentAddr,
+                            unsigned Permissions) {
+        if (!RemoteSegmentAddr)
+          return;
+        assert(!Allocs.empty() && "No sections in allocated segment");
+        for (auto &Alloc : Allocs)
+          Writes.push_back(DirectBufferWriter(Alloc.getLocalAddress(),
+                                              Alloc.getRemoteAddress(),
+                                              Alloc.getSize()));
+        Prots.push_back(std::make_pair(RemoteSegmentAddr, Permissions));
+      };
+
+      for (auto &ObjAllocs : Unfinalized) {
+        AddSegment(ObjAllocs.CodeAllocs, ObjAllocs.RemoteCodeAddr,
+                   sys::Memory::MF_READ | sys::Memory::MF_EXEC);
+        AddSegment(ObjAllocs.RODataAllocs, ObjAllocs.RemoteRODataAddr,
+                   sys::Memory::MF_READ);
+        AddSegment(ObjAllocs.RWDataAllocs, ObjAllocs.RemoteRWDataAddr,
+                   sys::Memory::MF_READ | sys::Memory::MF_WRITE);
+      }
+
+      if (Prots.empty())
+        return false;
+
+      LLVM_DEBUG(dbgs() << "  copying " << Writes.size()
+                        << " sections and setting permissions on "
+                        << Prots.size() << " blocks\n");
+      return Client.writeMemAndProtect(Id, Writes, Prots);
+    }
+
     OrcRemoteTargetClient &Client;
     ResourceIdMgr::ResourceId Id;
     std::vector<ObjectAllocs> Unmapped;
@@ -580,6 +623,19 @@ public:
   /// Get the triple for the remote target.
   const std::string &getTargetTriple() const { return RemoteTargetTriple; }
 
+  /// Statistics on the writes to the remote memory.
+  struct MemoryTransferStats {
+    /// The number of bytes written, including pointers.
+    uint64_t BytesWritten = 0;
+    /// The number of calls made to write memory or set its protections.
+    uint64_t RoundTrips = 0;
+  };
+
+  /// Get the statistics on the writes to the remote memory so far.
+  const MemoryTransferStats &getMemoryTransferStats() const {
+    return MemStats;
+  }
+
   Error terminateSession() { return callB<utils::TerminateSession>(); }
 
 private:
@@ -600,8 +656,17 @@ private:
       std::tie(RemoteTargetTriple, RemotePointerSize, RemotePageSize,
                RemoteTrampolineSize, RemoteIndirectStubSize) = *RIOrErr;
       Err = Error::success();
-    } else
+    } else {
       Err = RIOrErr.takeError();
+      return;
+    }
+
+    // Servers that predate WriteMemAndProtect get a call per section.
+    if (auto NegotiateErr = negotiateFunction<mem::WriteMemAndProtect>()) {
+      LLVM_DEBUG(dbgs() << "Remote does not support batched writes: "
+                        << toString(std::move(NegotiateErr)) << "\n");
+    } else
+      HasWriteMemAndProtectFn = true;
   }
 
   void deregisterEHFrames(JITTargetAddress Addr, uint32_t Size) {
@@ -661,6 +726,7 @@ private:
 
   bool setProtections(ResourceIdMgr::ResourceId Id,
                       JITTargetAddress RemoteSegAddr, unsigned ProtFlags) {
+    ++MemStats.RoundTrips;
     if (auto Err = callB<mem::SetProtections>(Id, RemoteSegAddr, ProtFlags)) {
       ES.reportError(std::move(Err));
       return true;
@@ -669,6 +735,8 @@ private:
   }
 
   bool writeMem(JITTargetAddress Addr, const char *Src, uint64_t Size) {
+    ++MemStats.RoundTrips;
+    MemStats.BytesWritten += Size;
     if (auto Err = callB<mem::WriteMem>(DirectBufferWriter(Src, Addr, Size))) {
       ES.reportError(std::move(Err));
       return true;
@@ -676,7 +744,25 @@ private:
       return false;
   }
 
+  bool hasWriteMemAndProtect() const { return HasWriteMemAndProtectFn; }
+
+  bool writeMemAndProtect(
+      ResourceIdMgr::ResourceId Id,
+      const std::vector<DirectBufferWriter> &Writes,
+      const std::vector<std::pair<JITTargetAddress, uint32_t>> &Prots) {
+    ++MemStats.RoundTrips;
+    for (auto &DBW : Writes)
+      MemStats.BytesWritten += DBW.getSize();
+    if (auto Err = callB<mem::WriteMemAndProtect>(Id, Writes, Prots)) {
+      ES.reportError(std::move(Err));
+      return true;
+    } else
+      return false;
+  }
+
   Error writePointer(JITTargetAddress Addr, JITTargetAddress PtrVal) {
+    ++MemStats.RoundTrips;
+    MemStats.BytesWritten += RemotePointerSize;
     return callB<mem::WritePtr>(Addr, PtrVal);
   }
 
@@ -691,6 +777,8 @@ private:
   uint32_t RemoteIndirectStubSize = 0;
   ResourceIdMgr AllocatorIds, IndirectStubOwnerIds;
   Optional<RemoteCompileCallbackManager> CallbackManager;
+  bool HasWriteMemAndProtectFn = false;
+  MemoryTransferStats MemStats;
 };
 
 } // end namespace remote
@@ -267,6 +267,19 @@ namespace mem {
     static const char *getName() { return "WriteMem"; }
   };
 
+  /// Write a list of remote memory blocks, then set the protections on the
+  /// given segments of the allocator, in a single round trip. The blocks are
+  /// read from the channel straight into their destination.
+  class WriteMemAndProtect
+      : public rpc::Function<
+            WriteMemAndProtect,
+            void(ResourceIdMgr::ResourceId AllocID,
+                 std::vector<remote::DirectBufferWriter> Writes,
+                 std::vector<std::pair<JITTargetAddress, uint32_t>> Prots)> {
+  public:
+    static const char *getName() { return "WriteMemAndProtect"; }
+  };
+
   /// Write to a remote pointer.
   class WritePtr : public rpc::Function<WritePtr, void(JITTargetAddress Dst,
                                                        JITTargetAddress Val)> {
@@ -72,6 +72,8 @@ public:
     addHandler<mem::ReserveMem>(*this, &ThisT::handleReserveMem);
     addHandler<mem::SetProtections>(*this, &ThisT::handleSetProtections);
     addHandler<mem::WriteMem>(*this, &ThisT::handleWriteMem);
+    addHandler<mem::WriteMemAndProtect>(*this,
+                                        &ThisT::handleWriteMemAndProtect);
     addHandler<mem::WritePtr>(*this, &ThisT::handleWritePtr);
     addHandler<eh::RegisterEHFrames>(*this, &ThisT::handleRegisterEHFrames);
     addHandler<eh::DeregisterEHFrames>(*this, &ThisT::handleDeregisterEHFrames);
@@ -421,6 +423,21 @@ private:
     return Error::success();
   }
 
+  Error handleWriteMemAndProtect(
+      ResourceIdMgr::ResourceId Id, std::vector<DirectBufferWriter> Writes,
+      std::vector<std::pair<JITTargetAddress, uint32_t>> Prots) {
+    // The blocks were written when the arguments were deserialized.
+    for (auto &DBW : Writes)
+      if (auto Err = handleWriteMem(DBW))
+        return Err;
+
+    for (auto &Prot : Prots)
+      if (auto Err = handleSetProtections(Id, Prot.first, Prot.second))
+        return Err;
+
+    return Error::success();
+  }
+
   Error handleWritePtr(JITTargetAddress Addr, JITTargetAddress PtrVal) {
     LLVM_DEBUG(dbgs() << "  Writing pointer *" << format("0x%016x", Addr)
                       << " = " << format("0x%016x", PtrVal) << "\n");
@@ -0,0 +1,77 @@
+//===- PersistentObjectCache.h - On-disk cache of JIT'd objects -*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// An ObjectCache that keeps the objects compiled by the JIT in a directory, so
+// that they can be reused by later runs of the process.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_EXECUTIONENGINE_ORC_PERSISTENTOBJECTCACHE_H
+#define LLVM_EXECUTIONENGINE_ORC_PERSISTENTOBJECTCACHE_H
+
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ExecutionEngine/ObjectCache.h"
+#include "llvm/Support/CachePruning.h"
+#include "llvm/Support/Error.h"
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace llvm {
+
+class Module;
+
+namespace orc {
+
+class JITTargetMachineBuilder;
+
+/// An ObjectCache that stores objects in a directory on disk.
+///
+/// The objects are keyed by a hash of the bitcode of the module, of the
+/// options of the TargetMachine that compiles it and of the LLVM version, so a
+/// module is only ever served an object compiled from identical IR with the
+/// same settings. Entries are written atomically, so the directory can be
+/// shared by several processes.
+///
+/// The cache is pruned with pruneCache when it is created: entries that have
+/// not been used for a while are evicted, least recently used first, as
+/// configured by the CachePruningPolicy.
+///
+/// The cache can be used from several compile threads at once, e.g. by a
+/// ConcurrentIRCompiler.
+class PersistentObjectCache : public ObjectCache {
+public:
+  /// Create a cache for the objects compiled with the TargetMachines built by
+  /// \p JTMB, stored in \p CacheDir, which is created if it does not exist.
+  static Expected<std::unique_ptr<PersistentObjectCache>>
+  Create(StringRef CacheDir, const JITTargetMachineBuilder &JTMB,
+         CachePruningPolicy Policy = CachePruningPolicy());
+
+  void notifyObjectCompiled(const Module *M, MemoryBufferRef Obj) override;
+  std::unique_ptr<MemoryBuffer> getObject(const Module *M) override;
+
+private:
+  PersistentObjectCache(std::string CacheDir, std::string TargetKey)
+      : CacheDir(std::move(CacheDir)), TargetKey(std::move(TargetKey)) {}
+
+  std::string getKey(const Module &M) const;
+
+  std::string CacheDir;
+  /// The description of the TargetMachine options, folded into every key.
+  std::string TargetKey;
+
+  /// The keys of the modules being compiled after a cache miss. The key must
+  /// be computed before compiling, code generation modifies the module.
+  std::mutex PendingKeysMutex;
+  DenseMap<const Module *, std::string> PendingKeys;
+};
+
+} // end namespace orc
+} // end namespace llvm
+
+#endif // LLVM_EXECUTIONENGINE_ORC_PERSISTENTOBJECTCACHE_H
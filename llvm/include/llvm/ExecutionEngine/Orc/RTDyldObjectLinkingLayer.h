@@ -113,7 +113,15 @@ public:
     return *this;
   }
 
+  /// Deregisters the EH frames of the objects emitted for key K and destroys
+  /// their memory managers, which frees their code and data. The symbols of
+  /// the objects should have been removed from their JITDylib first, and no
+  /// code in them may still run.
+  void removeModule(VModuleKey K);
+
 private:
+  using MemoryManagerPtr = std::unique_ptr<RuntimeDyld::MemoryManager>;
+
   Error onObjLoad(VModuleKey K, MaterializationResponsibility &R,
                   object::ObjectFile &Obj,
                   std::unique_ptr<RuntimeDyld::LoadedObjectInfo> LoadedObjInfo,
@@ -130,7 +138,8 @@ private:
   bool ProcessAllSections = false;
   bool OverrideObjectFlags = false;
   bool AutoClaimObjectSymbols = false;
-  std::vector<std::unique_ptr<RuntimeDyld::MemoryManager>> MemMgrs;
+  DenseMap<VModuleKey, std::vector<MemoryManagerPtr>> TrackedMemMgrs;
+  std::vector<MemoryManagerPtr> UntrackedMemMgrs;
 };
 
 class LegacyRTDyldObjectLinkingLayerBase {
@@ -69,12 +69,27 @@ public:
   using StubAddrLikelies = DenseMap<TargetFAddr, SymbolNameSet>;
 
 private:
-  void registerSymbolsWithAddr(TargetFAddr ImplAddr,
+  void registerSymbolsWithAddr(TargetFAddr ImplAddr, SymbolStringPtr Target,
                                SymbolNameSet likelySymbols) {
     std::lock_guard<std::mutex> Lockit(ConcurrentAccess);
     GlobalSpecMap.insert({ImplAddr, std::move(likelySymbols)});
+    if (RecordAccesses)
+      ImplNames.insert({ImplAddr, std::move(Target)});
   }
 
+  // Append the function at FAddr to the access trace, on its first call.
+  void recordAccess(TargetFAddr FAddr) {
+    std::lock_guard<std::mutex> Lockit(ConcurrentAccess);
+    auto It = ImplNames.find(FAddr);
+    if (It == ImplNames.end())
+      return;
+    AccessTrace.push_back(std::move(It->getSecond()));
+    ImplNames.erase(It);
+  }
+
+  // Compile the implementations of the given stub symbols, without waiting.
+  void compileImpls(const SymbolNameSet &Stubs);
+
   void launchCompile(JITTargetAddress FAddr) {
     SymbolNameSet CandidateSet;
     // Copy CandidateSet is necessary, to avoid unsynchronized access to
@@ -87,36 +102,7 @@ private:
       CandidateSet = It->getSecond();
     }
 
-    SymbolDependenceMap SpeculativeLookUpImpls;
-
-    for (auto &Callee : CandidateSet) {
-      auto ImplSymbol = AliaseeImplTable.getImplFor(Callee);
-      // try to distinguish already compiled & library symbols
-      if (!ImplSymbol.hasValue())
-        continue;
-      const auto &ImplSymbolName = ImplSymbol.getPointer()->first;
-      JITDylib *ImplJD = ImplSymbol.getPointer()->second;
-      auto &SymbolsInJD = SpeculativeLookUpImpls[ImplJD];
-      SymbolsInJD.insert(ImplSymbolName);
-    }
-
-    DEBUG_WITH_TYPE("orc", for (auto &I
-                                : SpeculativeLookUpImpls) {
-      llvm::dbgs() << "\n In " << I.first->getName() << " JITDylib ";
-      for (auto &N : I.second)
-        llvm::dbgs() << "\n Likely Symbol : " << N;
-    });
-
-    // for a given symbol, there may be no symbol qualified for speculatively
-    // compile try to fix this before jumping to this code if possible.
-    for (auto &LookupPair : SpeculativeLookUpImpls)
-      ES.lookup(JITDylibSearchList({{LookupPair.first, true}}),
-                LookupPair.second, SymbolState::Ready,
-                [this](Expected<SymbolMap> Result) {
-                  if (auto Err = Result.takeError())
-                    ES.reportError(std::move(Err));
-                },
-                NoDependenciesToRegister);
+    compileImpls(CandidateSet);
   }
 
 public:
@@ -134,7 +120,27 @@ public:
 
   // Speculatively compile likely functions for the given Stub Address.
   // destination of __orc_speculate_for jump
-  void speculateFor(TargetFAddr StubAddr) { launchCompile(StubAddr); }
+  void speculateFor(TargetFAddr StubAddr) {
+    recordAccess(StubAddr);
+    launchCompile(StubAddr);
+  }
+
+  /// Record the functions in the order of their first calls, to be written
+  /// with writeAccessTrace. Must be enabled before modules are added to the
+  /// IRSpeculationLayer.
+  void recordAccesses() { RecordAccesses = true; }
+  bool isRecordingAccesses() const { return RecordAccesses; }
+
+  /// Write the functions called so far to \p Path, one symbol per line.
+  Error writeAccessTrace(StringRef Path);
+
+  /// Compile the functions of the access trace written to \p Path by a
+  /// previous run, looking them up in \p JD. The compiles are dispatched
+  /// together and this returns without waiting for them, so that they run in
+  /// parallel on the compile threads of the session ahead of the first calls.
+  /// A missing trace file is not an error, and the functions of the trace
+  /// that \p JD does not define anymore are ignored.
+  Error speculateFromAccessTrace(JITDylib &JD, StringRef Path);
 
   // FIXME : Register with Stub Address, after JITLink Fix.
   void registerSymbols(FunctionCandidatesMap Candidates, JITDylib *JD) {
@@ -146,7 +152,7 @@ public:
                            this](Expected<SymbolMap> ReadySymbol) {
         if (ReadySymbol) {
           auto RAddr = (*ReadySymbol)[Target].getAddress();
-          registerSymbolsWithAddr(RAddr, std::move(Likely));
+          registerSymbolsWithAddr(RAddr, Target, std::move(Likely));
         } else
           this->getES().reportError(ReadySymbol.takeError());
       };
@@ -164,6 +170,9 @@ private:
   ImplSymbolMap &AliaseeImplTable;
   ExecutionSession &ES;
   StubAddrLikelies GlobalSpecMap;
+  bool RecordAccesses = false;
+  DenseMap<TargetFAddr, SymbolStringPtr> ImplNames;
+  std::vector<SymbolStringPtr> AccessTrace;
 };
 
 class IRSpeculationLayer : public IRLayer {
@@ -0,0 +1,140 @@
+//===- TieredCompilationLayer.h - Recompile hot functions -------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// A layer that compiles functions quickly first, then recompiles the hot ones
+// with optimizations in the background.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_EXECUTIONENGINE_ORC_TIEREDCOMPILATIONLAYER_H
+#define LLVM_EXECUTIONENGINE_ORC_TIEREDCOMPILATIONLAYER_H
+
+#include "llvm/ADT/StringSet.h"
+#include "llvm/ExecutionEngine/Orc/Core.h"
+#include "llvm/ExecutionEngine/Orc/IndirectionUtils.h"
+#include "llvm/ExecutionEngine/Orc/Layer.h"
+#include "llvm/ExecutionEngine/Orc/LazyReexports.h"
+#include "llvm/ExecutionEngine/Orc/ThreadSafeModule.h"
+#include "llvm/Support/ThreadPool.h"
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace llvm {
+namespace orc {
+
+/// Tiered compilation layer.
+///
+///   Modules added to this layer are emitted twice. The first tier is emitted
+/// right away to \p BaseLayer, typically a compile layer without
+/// optimizations: a stub is created for each of the function definitions of
+/// the module, and calls the function body through the LazyCallThroughManager
+/// when the function is first called. The bodies live in an implementation
+/// JITDylib, and count the calls made to them.
+///
+///   Once a function has been called HotCallThreshold times, it is emitted
+/// again to \p OptimizingLayer, typically a transform layer running the
+/// optimization pipeline in front of an optimizing compile layer, on one of
+/// the background compile threads of the layer. The stub of the function is
+/// then updated to point at the optimized body, which the following calls
+/// use. The first tier code keeps running on the threads that are already in
+/// it, so the update needs no synchronization with the running code.
+///
+///   All the calls to the function definitions of a module, including the
+/// calls between them, go through their stubs, so that every caller switches
+/// to the optimized body. The local functions of the module are copied into
+/// the second tier of their callers, where they may be inlined.
+class TieredCompilationLayer : public IRLayer {
+public:
+  /// Builder for IndirectStubsManagers.
+  using IndirectStubsManagerBuilder =
+      std::function<std::unique_ptr<IndirectStubsManager>()>;
+
+  /// Construct a TieredCompilationLayer, optimizing the hot functions on
+  /// \p NumCompileThreads background threads.
+  TieredCompilationLayer(ExecutionSession &ES, IRLayer &BaseLayer,
+                         IRLayer &OptimizingLayer,
+                         LazyCallThroughManager &LCTMgr,
+                         IndirectStubsManagerBuilder BuildIndirectStubsManager,
+                         unsigned NumCompileThreads = 1);
+
+  /// Set the number of calls after which a function is optimized. This
+  /// applies to the modules emitted afterwards.
+  void setHotCallThreshold(uint64_t Threshold) {
+    assert(Threshold > 0 && "Threshold must be at least one call");
+    HotCallThreshold = Threshold;
+  }
+
+  /// Emits the given module. This should not be called by clients: it will be
+  /// called by the JIT when a definition added via the add method is requested.
+  void emit(MaterializationResponsibility R, ThreadSafeModule TSM) override;
+
+  /// Wait for the optimization of the functions that became hot so far.
+  void waitForOptimizations() { CompileThreads.wait(); }
+
+private:
+  class PerDylibResources {
+  public:
+    PerDylibResources(JITDylib &ImplD,
+                      std::unique_ptr<IndirectStubsManager> ISMgr)
+        : ImplD(ImplD), ISMgr(std::move(ISMgr)) {}
+    JITDylib &getImplDylib() { return ImplD; }
+    IndirectStubsManager &getISManager() { return *ISMgr; }
+
+  private:
+    JITDylib &ImplD;
+    std::unique_ptr<IndirectStubsManager> ISMgr;
+  };
+
+  using PerDylibResourcesMap = std::map<const JITDylib *, PerDylibResources>;
+
+  /// The IR of an emitted module, as it was before the call counts were
+  /// added, to optimize its functions from.
+  struct SourceModule {
+    ThreadSafeModule TSM;
+    /// The local functions of the module, promoted to hidden globals.
+    StringSet<> LocalFunctions;
+  };
+
+  struct TieredFunction {
+    PerDylibResources *PDR;
+    std::shared_ptr<SourceModule> Source;
+    /// The name of the first tier body in the source module.
+    std::string BodyName;
+    /// The name of the second tier body.
+    std::string OptimizedName;
+    SymbolStringPtr StubSymbol;
+    SymbolStringPtr OptimizedSymbol;
+  };
+
+  PerDylibResources &getPerDylibResources(JITDylib &TargetD,
+                                          MangleAndInterner &Mangle);
+
+  static void reoptimizeEntryPoint(TieredCompilationLayer *Layer,
+                                   uint64_t FunctionId);
+  void reoptimize(uint64_t FunctionId);
+
+  std::mutex TieredLayerMutex;
+  IRLayer &BaseLayer;
+  IRLayer &OptimizingLayer;
+  LazyCallThroughManager &LCTMgr;
+  IndirectStubsManagerBuilder BuildIndirectStubsManager;
+  PerDylibResourcesMap DylibResources;
+  SymbolLinkagePromoter PromoteSymbols;
+  std::vector<TieredFunction> Functions;
+  uint64_t HotCallThreshold = 1000;
+  /// Last member, so that the compiles in flight are waited for before the
+  /// rest of the layer is destroyed.
+  ThreadPool CompileThreads;
+};
+
+} // end namespace orc
+} // end namespace llvm
+
+#endif // LLVM_EXECUTIONENGINE_ORC_TIEREDCOMPILATIONLAYER_H
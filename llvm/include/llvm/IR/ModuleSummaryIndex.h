@@ -63,16 +63,24 @@ struct CalleeInfo {
   // added to HotnessType enum.
   uint32_t Hotness : 3;
 
+  /// The callee is a target of an indirect call, found in its value profile.
+  /// Indirect call promotion can only turn the call into a direct call to the
+  /// callee when the callee is available in the calling module.
+  uint32_t IsICallTarget : 1;
+
   /// The value stored in RelBlockFreq has to be interpreted as the digits of
   /// a scaled number with a scale of \p -ScaleShift.
-  uint32_t RelBlockFreq : 29;
+  uint32_t RelBlockFreq : 28;
   static constexpr int32_t ScaleShift = 8;
-  static constexpr uint64_t MaxRelBlockFreq = (1 << 29) - 1;
+  static constexpr uint64_t MaxRelBlockFreq = (1 << 28) - 1;
 
   CalleeInfo()
-      : Hotness(static_cast<uint32_t>(HotnessType::Unknown)), RelBlockFreq(0) {}
-  explicit CalleeInfo(HotnessType Hotness, uint64_t RelBF)
-      : Hotness(static_cast<uint32_t>(Hotness)), RelBlockFreq(RelBF) {}
+      : Hotness(static_cast<uint32_t>(HotnessType::Unknown)), IsICallTarget(0),
+        RelBlockFreq(0) {}
+  explicit CalleeInfo(HotnessType Hotness, uint64_t RelBF,
+                      bool IsICallTarget = false)
+      : Hotness(static_cast<uint32_t>(Hotness)), IsICallTarget(IsICallTarget),
+        RelBlockFreq(RelBF) {}
 
   void updateHotness(const HotnessType OtherHotness) {
     Hotness = std::max(Hotness, static_cast<uint32_t>(OtherHotness));
@@ -80,6 +88,9 @@ struct CalleeInfo {
 
   HotnessType getHotness() const { return HotnessType(Hotness); }
 
+  bool isICallTarget() const { return IsICallTarget; }
+  void setICallTarget() { IsICallTarget = 1; }
+
   /// Update \p RelBlockFreq from \p BlockFreq and \p EntryFreq
   ///
   /// BlockFreq is divided by EntryFreq and added to RelBlockFreq. To represent
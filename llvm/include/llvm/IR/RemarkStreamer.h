@@ -13,6 +13,7 @@
 #ifndef LLVM_IR_REMARKSTREAMER_H
 #define LLVM_IR_REMARKSTREAMER_H
 
+#include "llvm/ADT/StringMap.h"
 #include "llvm/IR/DiagnosticInfo.h"
 #include "llvm/Remarks/RemarkSerializer.h"
 #include "llvm/Support/Error.h"
@@ -27,6 +28,8 @@ namespace llvm {
 class RemarkStreamer {
   /// The regex used to filter remarks based on the passes that emit them.
   Optional<Regex> PassFilter;
+  /// The result of matching PassFilter against each pass name seen so far.
+  StringMap<bool> PassFilterCache;
   /// The object used to serialize the remarks to a specific format.
   std::unique_ptr<remarks::RemarkSerializer> RemarkSerializer;
   /// The filename that the remark diagnostics are emitted to.
@@ -51,6 +54,9 @@ public:
   /// Set a pass filter based on a regex \p Filter.
   /// Returns an error if the regex is invalid.
   Error setFilter(StringRef Filter);
+  /// Return true if remarks emitted by \p PassName pass the filter, so that
+  /// passes can avoid building remarks that would be dropped.
+  bool matchesFilter(StringRef PassName);
   /// Emit a diagnostic through the streamer.
   void emit(const DiagnosticInfoOptimizationBase &Diag);
 };
@@ -32,6 +32,8 @@ struct UseListOrder {
       : V(V), F(F), Shuffle(ShuffleSize) {}
 
   UseListOrder() = default;
+  UseListOrder(const UseListOrder &) = default;
+  UseListOrder &operator=(const UseListOrder &) = default;
   UseListOrder(UseListOrder &&) = default;
   UseListOrder &operator=(UseListOrder &&) = default;
 };
@@ -33,6 +33,45 @@ using AddBufferFn =
 Expected<NativeObjectCache> localCache(StringRef CacheDirectoryPath,
                                        AddBufferFn AddBuffer);
 
+/// Interface to a cache of native object files that is shared between
+/// machines, for example a network service or a directory on a shared file
+/// system. Keys are the values computed by computeLTOCacheKey().
+///
+/// Implementations must be thread safe. Failures are never fatal to the link:
+/// the tiered cache treats an error from fetch() as a miss and drops errors
+/// from store().
+class RemoteObjectCache {
+public:
+  virtual ~RemoteObjectCache() = default;
+
+  /// Returns the object file for \p Key, or null if the remote cache does not
+  /// have an entry for it.
+  virtual Expected<std::unique_ptr<MemoryBuffer>> fetch(StringRef Key) = 0;
+
+  /// Makes \p Object available to other clients under \p Key.
+  virtual Error store(StringRef Key, MemoryBufferRef Object) = 0;
+};
+
+/// Create a cache which uses the given cache directory as a local tier in
+/// front of \p Remote. Local misses are looked up in the remote cache, and
+/// objects found there or built by the backend are added to both tiers. The
+/// local tier is pruned with pruneCache() like a cache created by
+/// localCache().
+///
+/// The keys requested by each link are recorded in the cache directory. When
+/// the cache is created, the entries the previous link requested are fetched
+/// from the remote cache in the background, so that they are likely to be
+/// local by the time the backends ask for them.
+Expected<NativeObjectCache>
+tieredCache(StringRef CacheDirectoryPath,
+            std::shared_ptr<RemoteObjectCache> Remote, AddBufferFn AddBuffer);
+
+/// Create a remote cache which stores its entries in the given directory. It
+/// is meant for a directory shared by several machines, e.g. over NFS. This
+/// function also creates the directory if it does not already exist.
+Expected<std::shared_ptr<RemoteObjectCache>>
+directoryRemoteCache(StringRef DirectoryPath);
+
 } // namespace lto
 } // namespace llvm
 
@@ -226,8 +226,15 @@ using ThinBackend = std::function<std::unique_ptr<ThinBackendProc>(
     StringMap<GVSummaryMapTy> &ModuleToDefinedGVSummaries,
     AddStreamFn AddStream, NativeObjectCache Cache)>;
 
-/// This ThinBackend runs the individual backend jobs in-process.
-ThinBackend createInProcessThinBackend(unsigned ParallelismLevel);
+/// This ThinBackend runs the individual backend jobs in-process. The jobs are
+/// started in decreasing order of their estimated cost, based on the
+/// instruction counts in the summaries.
+///
+/// If \p MemoryLimit is not zero, a job only starts when the estimated memory
+/// use of the running jobs, in bytes, stays under it, even if fewer than
+/// \p ParallelismLevel jobs are running.
+ThinBackend createInProcessThinBackend(unsigned ParallelismLevel,
+                                       uint64_t MemoryLimit = 0);
 
 /// This ThinBackend writes individual module indexes to files, instead of
 /// running the individual backend jobs. This backend is for distributed builds
@@ -123,6 +123,14 @@ private:
 
   MCDwarfLineTableParams LTParams;
 
+  /// The number of relaxation steps that changed a section during layout.
+  unsigned LayoutGeneration = 0;
+
+  /// For each section, by ordinal, the LayoutGeneration at which it was last
+  /// found to need no relaxation. A section needs no layout step while no
+  /// section changed since then.
+  std::vector<unsigned> SectionStableGeneration;
+
   /// The set of function symbols for which a .thumb_func directive has
   /// been seen.
   //
@@ -183,7 +191,8 @@ private:
                                const MCAsmLayout &Layout) const;
 
   /// Perform one layout iteration and return true if any offsets
-  /// were adjusted.
+  /// were adjusted. Sections which are still at a fixed point from an
+  /// earlier iteration are skipped.
   bool layoutOnce(MCAsmLayout &Layout);
 
   /// Perform one layout iteration of the given section and return true
@@ -95,6 +95,11 @@ protected:
   /// will be used as a symbol offset within the fragment.
   void flushPendingLabels(MCFragment *F, uint64_t FOffset = 0);
 
+  /// Encode \p Inst directly at the end of \p DF, adding its fixups to those
+  /// of the fragment, and return the index of its first fixup.
+  unsigned encodeInstToDataFragment(MCDataFragment &DF, const MCInst &Inst,
+                                    const MCSubtargetInfo &STI);
+
 public:
   void visitUsedSymbol(const MCSymbol &Sym) override;
 
@@ -255,6 +255,14 @@ protected:
   const Elf_Shdr *DotSymtabSec = nullptr; // Symbol table section.
   ArrayRef<Elf_Word> ShndxTable;
 
+  // Section indices of the symbol tables above, and their string tables if
+  // those are valid. They let getSymbol() and getSymbolName() skip finding
+  // and checking these sections again for every symbol.
+  uint32_t DotDynSymIndex = 0;
+  uint32_t DotSymtabIndex = 0;
+  StringRef DotDynSymStrTab;
+  StringRef DotSymtabStrTab;
+
   void moveSymbolNext(DataRefImpl &Symb) const override;
   Expected<StringRef> getSymbolName(DataRefImpl Symb) const override;
   Expected<uint64_t> getSymbolAddress(DataRefImpl Symb) const override;
@@ -399,7 +407,13 @@ public:
   const Elf_Rela *getRela(DataRefImpl Rela) const;
 
   const Elf_Sym *getSymbol(DataRefImpl Sym) const {
-    auto Ret = EF.template getEntry<Elf_Sym>(Sym.d.a, Sym.d.b);
+    const Elf_Shdr *SymTable = nullptr;
+    if (Sym.d.a == DotSymtabIndex)
+      SymTable = DotSymtabSec;
+    else if (Sym.d.a == DotDynSymIndex)
+      SymTable = DotDynSymSec;
+    auto Ret = SymTable ? EF.template getEntry<Elf_Sym>(SymTable, Sym.d.b)
+                        : EF.template getEntry<Elf_Sym>(Sym.d.a, Sym.d.b);
     if (!Ret)
       report_fatal_error(errorToErrorCode(Ret.takeError()).message());
     return *Ret;
@@ -453,18 +467,26 @@ void ELFObjectFile<ELFT>::moveSymbolNext(DataRefImpl &Sym) const {
 template <class ELFT>
 Expected<StringRef> ELFObjectFile<ELFT>::getSymbolName(DataRefImpl Sym) const {
   const Elf_Sym *ESym = getSymbol(Sym);
-  auto SymTabOrErr = EF.getSection(Sym.d.a);
-  if (!SymTabOrErr)
-    return SymTabOrErr.takeError();
-  const Elf_Shdr *SymTableSec = *SymTabOrErr;
-  auto StrTabOrErr = EF.getSection(SymTableSec->sh_link);
-  if (!StrTabOrErr)
-    return StrTabOrErr.takeError();
-  const Elf_Shdr *StringTableSec = *StrTabOrErr;
-  auto SymStrTabOrErr = EF.getStringTable(StringTableSec);
-  if (!SymStrTabOrErr)
-    return SymStrTabOrErr.takeError();
-  Expected<StringRef> Name = ESym->getName(*SymStrTabOrErr);
+  StringRef SymStrTab;
+  if (Sym.d.a == DotSymtabIndex)
+    SymStrTab = DotSymtabStrTab;
+  else if (Sym.d.a == DotDynSymIndex)
+    SymStrTab = DotDynSymStrTab;
+  if (SymStrTab.empty()) {
+    auto SymTabOrErr = EF.getSection(Sym.d.a);
+    if (!SymTabOrErr)
+      return SymTabOrErr.takeError();
+    const Elf_Shdr *SymTableSec = *SymTabOrErr;
+    auto StrTabOrErr = EF.getSection(SymTableSec->sh_link);
+    if (!StrTabOrErr)
+      return StrTabOrErr.takeError();
+    const Elf_Shdr *StringTableSec = *StrTabOrErr;
+    auto SymStrTabOrErr = EF.getStringTable(StringTableSec);
+    if (!SymStrTabOrErr)
+      return SymStrTabOrErr.takeError();
+    SymStrTab = *SymStrTabOrErr;
+  }
+  Expected<StringRef> Name = ESym->getName(SymStrTab);
   if (Name && !Name->empty())
     return Name;
 
@@ -989,7 +1011,27 @@ ELFObjectFile<ELFT>::ELFObjectFile(MemoryBufferRef Object, ELFFile<ELFT> EF,
           getELFType(ELFT::TargetEndianness == support::little, ELFT::Is64Bits),
           Object),
       EF(EF), DotDynSymSec(DotDynSymSec), DotSymtabSec(DotSymtabSec),
-      ShndxTable(ShndxTable) {}
+      ShndxTable(ShndxTable) {
+  auto SectionsOrErr = this->EF.sections();
+  if (!SectionsOrErr) {
+    consumeError(SectionsOrErr.takeError());
+    return;
+  }
+  auto InitSymbolTable = [&](const Elf_Shdr *SymTable, uint32_t &Index,
+                             StringRef &StrTab) {
+    if (!SymTable)
+      return;
+    Index = SymTable - SectionsOrErr->begin();
+    Expected<StringRef> StrTabOrErr =
+        this->EF.getStringTableForSymtab(*SymTable, *SectionsOrErr);
+    if (StrTabOrErr)
+      StrTab = *StrTabOrErr;
+    else
+      consumeError(StrTabOrErr.takeError());
+  };
+  InitSymbolTable(DotDynSymSec, DotDynSymIndex, DotDynSymStrTab);
+  InitSymbolTable(DotSymtabSec, DotSymtabIndex, DotSymtabStrTab);
+}
 
 template <class ELFT>
 ELFObjectFile<ELFT>::ELFObjectFile(ELFObjectFile<ELFT> &&Other)
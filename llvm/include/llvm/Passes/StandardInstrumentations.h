@@ -16,15 +16,19 @@
 #define LLVM_PASSES_STANDARDINSTRUMENTATIONS_H
 
 #include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/IR/PassInstrumentation.h"
 #include "llvm/IR/PassTimingInfo.h"
 
+#include <chrono>
 #include <string>
 #include <utility>
+#include <vector>
 
 namespace llvm {
 
 class Module;
+class raw_ostream;
 
 /// Instrumentation to print IR before/after passes.
 ///
@@ -53,11 +57,83 @@ private:
   bool StoreModuleDesc = false;
 };
 
+/// Instrumentation to profile passes and analyses for -pass-profile-file and
+/// -ftime-trace.
+///
+/// For each pass or analysis run on an IR unit, it records the time taken,
+/// the change in the number of bytes allocated with malloc, and the change in
+/// the number of instructions of the unit. Time and bytes exclude the nested
+/// pass and analysis runs, which are recorded on their own. The totals per
+/// pass, and the runs that took longer than -pass-profile-min-time-us, are
+/// written as JSON. When the time trace profiler is enabled, every run is
+/// also a time trace event with the IR unit as detail.
+class PassProfileInstrumentation {
+public:
+  PassProfileInstrumentation();
+
+  /// Writes the profile if it was not written yet.
+  ~PassProfileInstrumentation() { print(); }
+
+  PassProfileInstrumentation(const PassProfileInstrumentation &) = delete;
+  void operator=(const PassProfileInstrumentation &) = delete;
+
+  void registerCallbacks(PassInstrumentationCallbacks &PIC);
+
+  /// Writes the profile to \p OS rather than to -pass-profile-file.
+  void setOutStream(raw_ostream &OS) { OutStream = &OS; }
+
+  /// Writes the profile collected so far as JSON, and resets it.
+  void print();
+
+private:
+  using Clock = std::chrono::steady_clock;
+
+  /// A pass or analysis being run.
+  struct Frame {
+    StringRef PassID;
+    Clock::time_point Start;
+    size_t MallocStart;
+    int64_t InstsStart;
+    /// What the nested runs took, to be excluded from this run.
+    Clock::duration ChildTime = Clock::duration::zero();
+    int64_t ChildMalloc = 0;
+    int64_t ChildInsts = 0;
+    bool Traced;
+  };
+
+  struct Totals {
+    uint64_t Count = 0;
+    Clock::duration Time = Clock::duration::zero();
+    int64_t MallocBytes = 0;
+    int64_t InstDelta = 0;
+  };
+
+  struct Run {
+    std::string PassID;
+    std::string IRName;
+    Clock::duration Time;
+    int64_t MallocBytes;
+    int64_t InstDelta;
+  };
+
+  void begin(StringRef PassID, Any IR);
+  /// \p IR must be null if the pass invalidated the IR unit.
+  void end(StringRef PassID, const Any *IR);
+
+  bool isEnabled() const;
+
+  SmallVector<Frame, 8> Stack;
+  StringMap<Totals> PassTotals;
+  std::vector<Run> SlowRuns;
+  raw_ostream *OutStream = nullptr;
+};
+
 /// This class provides an interface to register all the standard pass
 /// instrumentations and manages their state (if any).
 class StandardInstrumentations {
   PrintIRInstrumentation PrintIR;
   TimePassesHandler TimePasses;
+  PassProfileInstrumentation PassProfile;
 
 public:
   StandardInstrumentations() = default;
@@ -65,6 +141,7 @@ public:
   void registerCallbacks(PassInstrumentationCallbacks &PIC);
 
   TimePassesHandler &getTimePasses() { return TimePasses; }
+  PassProfileInstrumentation &getPassProfile() { return PassProfile; }
 };
 } // namespace llvm
 
@@ -32,6 +32,7 @@
 #include <set>
 #include <string>
 #include <system_error>
+#include <tuple>
 #include <utility>
 
 namespace llvm {
@@ -100,14 +101,14 @@ static inline uint64_t SPMagic(SampleProfileFormat Format = SPF_Binary) {
          uint64_t('2') << (64 - 56) | uint64_t(Format);
 }
 
-// Get the proper representation of a string in the input Format.
-static inline StringRef getRepInFormat(StringRef Name,
-                                       SampleProfileFormat Format,
+// Get the proper representation of a string according to whether the
+// current Format uses MD5 to represent the string.
+static inline StringRef getRepInFormat(StringRef Name, bool UseMD5,
                                        std::string &GUIDBuf) {
   if (Name.empty())
     return Name;
   GUIDBuf = std::to_string(Function::getGUID(Name));
-  return (Format == SPF_Compact_Binary) ? StringRef(GUIDBuf) : Name;
+  return UseMD5 ? StringRef(GUIDBuf) : Name;
 }
 
 static inline uint64_t SPVersion() { return 103; }
@@ -153,7 +154,13 @@ struct SecHdrTableEntry {
   uint64_t Size;
 };
 
-enum SecFlags { SecFlagInValid = 0, SecFlagCompress = (1 << 0) };
+enum SecFlags {
+  SecFlagInValid = 0,
+  SecFlagCompress = (1 << 0),
+  // The name table section stores the MD5 of the names instead of the
+  // names themselves.
+  SecFlagMD5Name = (1 << 1)
+};
 
 static inline void addSecFlags(SecHdrTableEntry &Entry, uint64_t Flags) {
   Entry.Flags |= Flags;
@@ -163,7 +170,7 @@ static inline void removeSecFlags(SecHdrTableEntry &Entry, uint64_t Flags) {
   Entry.Flags &= ~Flags;
 }
 
-static inline bool hasSecFlag(SecHdrTableEntry &Entry, SecFlags Flag) {
+static inline bool hasSecFlag(const SecHdrTableEntry &Entry, SecFlags Flag) {
   return Entry.Flags & Flag;
 }
 
@@ -284,6 +291,89 @@ private:
 
 raw_ostream &operator<<(raw_ostream &OS, const SampleRecord &Sample);
 
+/// The calling context of a context-sensitive profile.
+///
+/// A context-sensitive profile keeps the samples of a function apart for each
+/// call stack it was sampled in. The context is written as
+/// "[main:3 @ foo:2.1 @ bar]": every frame but the last one is a caller and
+/// the location of its call to the next frame, and the last frame is the
+/// function the samples belong to. A function sampled outside of any known
+/// caller is written as "[bar]".
+class SampleContext {
+public:
+  using ContextFrame = std::pair<StringRef, LineLocation>;
+
+  SampleContext() = default;
+  SampleContext(StringRef ContextStr) { setContext(ContextStr); }
+
+  /// Returns true if \p Name is the textual form of a calling context, rather
+  /// than a function name.
+  static bool isContextString(StringRef Name) {
+    return Name.size() > 2 && Name.front() == '[' && Name.back() == ']';
+  }
+
+  void setContext(StringRef ContextStr) {
+    assert(isContextString(ContextStr) && "Expected a bracketed context");
+    InputContext = ContextStr;
+    FullContext = ContextStr.drop_front().drop_back();
+    size_t LeafPos = FullContext.rfind(" @ ");
+    if (LeafPos == StringRef::npos) {
+      Name = FullContext;
+      CallingContext = StringRef();
+    } else {
+      Name = FullContext.substr(LeafPos + 3);
+      CallingContext = FullContext.substr(0, LeafPos);
+    }
+  }
+
+  /// Split the calling context \p ContextStr ("main:3 @ foo:2.1") into its
+  /// frames, from the outermost caller to the innermost one. A caller name
+  /// may contain ':', so the location is taken after the last one.
+  static bool decodeContextString(StringRef ContextStr,
+                                  SmallVectorImpl<ContextFrame> &Frames) {
+    while (!ContextStr.empty()) {
+      StringRef Frame;
+      std::tie(Frame, ContextStr) = ContextStr.split(" @ ");
+      size_t LocPos = Frame.rfind(':');
+      if (LocPos == StringRef::npos)
+        return false;
+      StringRef Offset, Discriminator;
+      std::tie(Offset, Discriminator) = Frame.substr(LocPos + 1).split('.');
+      uint32_t LineOffset, Disc = 0;
+      if (Offset.getAsInteger(10, LineOffset) ||
+          (!Discriminator.empty() && Discriminator.getAsInteger(10, Disc)))
+        return false;
+      Frames.emplace_back(Frame.substr(0, LocPos),
+                          LineLocation(LineOffset, Disc));
+    }
+    return true;
+  }
+
+  bool empty() const { return InputContext.empty(); }
+
+  /// Returns true if a caller of the function is known.
+  bool hasContext() const { return !CallingContext.empty(); }
+
+  /// Return the name of the function the samples belong to.
+  StringRef getName() const { return Name; }
+
+  /// Return the callers of the function, without the function itself.
+  StringRef getCallingContext() const { return CallingContext; }
+
+  /// Return the whole context, in its bracketed textual form.
+  StringRef getNameWithContext() const { return InputContext; }
+
+private:
+  /// The context as read, with the brackets.
+  StringRef InputContext;
+  /// The context without the brackets.
+  StringRef FullContext;
+  /// The frames of the callers in FullContext.
+  StringRef CallingContext;
+  /// The leaf function of FullContext.
+  StringRef Name;
+};
+
 class FunctionSamples;
 
 using BodySampleMap = std::map<LineLocation, SampleRecord>;
@@ -357,6 +447,22 @@ public:
     return ret->second.getCallTargets();
   }
 
+  /// Returns the number of sampled cache misses of the memory accesses at a
+  /// given location. Cache miss profiles record them as the count of a call
+  /// target named getCacheMissTargetName() at the location of the access.
+  uint64_t findCacheMissesAt(uint32_t LineOffset,
+                             uint32_t Discriminator) const {
+    const auto &ret = BodySamples.find(LineLocation(LineOffset, Discriminator));
+    if (ret == BodySamples.end())
+      return 0;
+    const SampleRecord::CallTargetMap &Targets = ret->second.getCallTargets();
+    const auto &Misses = Targets.find(getCacheMissTargetName());
+    return Misses == Targets.end() ? 0 : Misses->second;
+  }
+
+  /// Returns the name of the call target that records cache misses.
+  static StringRef getCacheMissTargetName() { return "__cache_miss"; }
+
   /// Return the function samples at the given callsite location.
   FunctionSamplesMap &functionSamplesAt(const LineLocation &Loc) {
     return CallsiteSamples[Loc];
@@ -378,7 +484,7 @@ public:
   const FunctionSamples *findFunctionSamplesAt(const LineLocation &Loc,
                                                StringRef CalleeName) const {
     std::string CalleeGUID;
-    CalleeName = getRepInFormat(CalleeName, Format, CalleeGUID);
+    CalleeName = getRepInFormat(CalleeName, UseMD5, CalleeGUID);
 
     auto iter = CallsiteSamples.find(Loc);
     if (iter == CallsiteSamples.end())
@@ -442,6 +548,9 @@ public:
   /// Optionally scale samples by \p Weight.
   sampleprof_error merge(const FunctionSamples &Other, uint64_t Weight = 1) {
     sampleprof_error Result = sampleprof_error::success;
+    // A new profile takes the context of the first profile merged into it.
+    if (Name.empty())
+      Context = Other.getContext();
     Name = Other.getName();
     MergeResult(Result, addTotalSamples(Other.getTotalSamples(), Weight));
     MergeResult(Result, addHeadSamples(Other.getHeadSamples(), Weight));
@@ -489,6 +598,22 @@ public:
   /// Return the function name.
   StringRef getName() const { return Name; }
 
+  /// Set the calling context of a context-sensitive profile. The function is
+  /// the leaf of the context.
+  void setContext(const SampleContext &FContext) {
+    Context = FContext;
+    Name = Context.getName();
+  }
+
+  /// Return the calling context of a context-sensitive profile.
+  const SampleContext &getContext() const { return Context; }
+
+  /// Return the bracketed context of a context-sensitive profile, or the
+  /// function name of any other profile. This is the key of the profile.
+  StringRef getNameWithContext() const {
+    return Context.empty() ? Name : Context.getNameWithContext();
+  }
+
   /// Return the original function name if it exists in Module \p M.
   StringRef getFuncNameInModule(const Module *M) const {
     return getNameInModule(Name, M);
@@ -523,13 +648,13 @@ public:
   }
 
   /// Translate \p Name into its original name in Module.
-  /// When the Format is not SPF_Compact_Binary, \p Name needs no translation.
-  /// When the Format is SPF_Compact_Binary, \p Name in current FunctionSamples
+  /// When the profile doesn't use MD5, \p Name needs no translation.
+  /// When the profile uses MD5, \p Name in current FunctionSamples
   /// is actually GUID of the original function name. getNameInModule will
   /// translate \p Name in current FunctionSamples into its original name.
   /// If the original name doesn't exist in \p M, return empty StringRef.
   StringRef getNameInModule(StringRef Name, const Module *M) const {
-    if (Format != SPF_Compact_Binary)
+    if (!UseMD5)
       return Name;
 
     assert(GUIDToFuncNameMap && "GUIDToFuncNameMap needs to be popluated first");
@@ -556,22 +681,33 @@ public:
 
   static SampleProfileFormat Format;
 
+  /// Whether the profile uses MD5 to represent the names, which is the case
+  /// of the compact binary format and of the extensible binary format with
+  /// an MD5 name table.
+  static bool UseMD5;
+
+  /// Whether the profile read is context-sensitive: its top-level profiles
+  /// are keyed by calling context, and have no inlined callsite samples.
+  static bool ProfileIsCS;
+
   /// GUIDToFuncNameMap saves the mapping from GUID to the symbol name, for
   /// all the function symbols defined or declared in current module.
   DenseMap<uint64_t, StringRef> *GUIDToFuncNameMap = nullptr;
 
   // Assume the input \p Name is a name coming from FunctionSamples itself.
-  // If the format is SPF_Compact_Binary, the name is already a GUID and we
-  // don't want to return the GUID of GUID.
+  // If the profile uses MD5, the name is already a GUID and we don't want
+  // to return the GUID of GUID.
   static uint64_t getGUID(StringRef Name) {
-    return (Format == SPF_Compact_Binary) ? std::stoull(Name.data())
-                                          : Function::getGUID(Name);
+    return UseMD5 ? std::stoull(Name.data()) : Function::getGUID(Name);
   }
 
 private:
   /// Mangled name of the function.
   StringRef Name;
 
+  /// Calling context of a context-sensitive profile.
+  SampleContext Context;
+
   /// Total number of samples collected inside this function.
   ///
   /// Samples are cumulative, they include all the samples collected
@@ -114,6 +114,23 @@
 //    total number of samples collected for the inlined instance at this
 //    callsite
 //
+// Context-sensitive profiles
+// --------------------------
+//
+// A context-sensitive profile keeps a separate section for each call stack
+// a function was sampled in, and does not nest inlined callsites. The name
+// in the function header is then the calling context of the function, from
+// the outermost caller to the function itself, in brackets:
+//
+//     [main:3 @ foo:2.1 @ bar]:total_samples:total_head_samples
+//
+// which holds the samples of ``bar()`` when called at line offset 2,
+// discriminator 1 of ``foo()``, itself called at line offset 3 of
+// ``main()``. The profile loader uses the samples of the context matching
+// its own inlining decisions, and merges the contexts that were not inlined
+// into the profile of the outlined function. The binary formats store the
+// bracketed context in the name table in place of the function name.
+//
 //
 // Binary format
 // -------------
@@ -296,7 +313,7 @@ public:
   /// Return the samples collected for function \p F.
   virtual FunctionSamples *getSamplesFor(StringRef Fname) {
     std::string FGUID;
-    Fname = getRepInFormat(Fname, getFormat(), FGUID);
+    Fname = getRepInFormat(Fname, useMD5(), FGUID);
     auto It = Profiles.find(Fname);
     if (It != Profiles.end())
       return &It->second;
@@ -335,6 +352,9 @@ public:
   virtual std::vector<StringRef> *getNameTable() { return nullptr; }
   virtual bool dumpSectionInfo(raw_ostream &OS = dbgs()) { return false; };
 
+  /// Return whether the names in the profile are MD5 numbers.
+  virtual bool useMD5() { return false; }
+
 protected:
   /// Map every function to its associated profile.
   ///
@@ -504,7 +524,7 @@ protected:
   virtual std::error_code readHeader() override;
   virtual std::error_code verifySPMagic(uint64_t Magic) override = 0;
   virtual std::error_code readOneSection(const uint8_t *Start, uint64_t Size,
-                                         SecType Type) = 0;
+                                         const SecHdrTableEntry &Entry) = 0;
 
 public:
   SampleProfileReaderExtBinaryBase(std::unique_ptr<MemoryBuffer> B,
@@ -519,14 +539,18 @@ public:
   /// Get the total size of header and all sections.
   uint64_t getFileSize();
   virtual bool dumpSectionInfo(raw_ostream &OS = dbgs()) override;
+
+  /// Return whether the name table section stores MD5 names.
+  virtual bool useMD5() override;
 };
 
 class SampleProfileReaderExtBinary : public SampleProfileReaderExtBinaryBase {
 private:
   virtual std::error_code verifySPMagic(uint64_t Magic) override;
   virtual std::error_code readOneSection(const uint8_t *Start, uint64_t Size,
-                                         SecType Type) override;
+                                         const SecHdrTableEntry &Entry) override;
   std::error_code readProfileSymbolList();
+  std::error_code readMD5NameTable();
   std::error_code readFuncOffsetTable();
   std::error_code readFuncProfiles();
 
@@ -537,6 +561,9 @@ private:
   DenseSet<StringRef> FuncsToUse;
   /// Use all functions from the input profile.
   bool UseAllFuncs = true;
+  /// The strings of the MD5 names referenced by NameTable, when the name
+  /// table section stores MD5 names.
+  std::vector<std::string> MD5StringBuf;
 
 public:
   SampleProfileReaderExtBinary(std::unique_ptr<MemoryBuffer> B, LLVMContext &C,
@@ -585,6 +612,9 @@ public:
 
   /// Collect functions to be used when compiling Module \p M.
   void collectFuncsFrom(const Module &M) override;
+
+  /// Return whether names in the profile are all MD5 numbers.
+  virtual bool useMD5() override { return true; }
 };
 
 using InlineCallStack = SmallVector<FunctionSamples *, 10>;
@@ -672,6 +702,8 @@ public:
   FunctionSamples *getSamplesFor(StringRef FunctionName) override;
   using SampleProfileReader::getSamplesFor;
 
+  virtual bool useMD5() override { return UnderlyingReader->useMD5(); }
+
 private:
   SymbolRemappingReader Remappings;
   DenseMap<SymbolRemappingReader::Key, FunctionSamples*> SampleMap;
@@ -149,6 +149,8 @@ public:
 
   void setToCompressAllSections();
   void setToCompressSection(SecType Type);
+  /// Store the MD5 of the names in the name table instead of the names.
+  void setUseMD5();
 
 protected:
   uint64_t markSectionStart(SecType Type);
@@ -156,6 +158,7 @@ protected:
   virtual void initSectionHdrLayout() = 0;
   virtual std::error_code
   writeSections(const StringMap<FunctionSamples> &ProfileMap) = 0;
+  virtual std::error_code writeNameTable() override;
 
   // Specifiy the order of sections in section header table. Note
   // the order of sections in the profile may be different that the
@@ -188,6 +191,8 @@ private:
   uint64_t SecHdrTableOffset;
   // Initial Section Flags setting.
   std::vector<SecHdrTableEntry> SecHdrTable;
+  // Whether the name table stores the MD5 of the names.
+  bool UseMD5 = false;
 };
 
 class SampleProfileWriterExtBinary : public SampleProfileWriterExtBinaryBase {
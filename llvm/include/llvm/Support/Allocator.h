@@ -438,6 +438,37 @@ private:
 /// parameters.
 typedef BumpPtrAllocatorImpl<> BumpPtrAllocator;
 
+/// Allocates the slabs of a BumpPtrAllocatorImpl with sys::Memory, backed by
+/// huge pages where the system supports them. Large arenas then take fewer
+/// TLB misses than with malloc'ed slabs.
+///
+/// Every allocation is mapped on its own and rounded up to the huge page size,
+/// so this is only meant for large slabs, as in HugePageBumpPtrAllocator.
+class HugePageSlabAllocator : public AllocatorBase<HugePageSlabAllocator> {
+public:
+  static constexpr size_t HugePageSize = 2 * 1024 * 1024;
+
+  void Reset() {}
+
+  LLVM_ATTRIBUTE_RETURNS_NONNULL void *Allocate(size_t Size,
+                                                size_t /*Alignment*/);
+
+  // Pull in base class overloads.
+  using AllocatorBase<HugePageSlabAllocator>::Allocate;
+
+  void Deallocate(const void *Ptr, size_t Size);
+
+  // Pull in base class overloads.
+  using AllocatorBase<HugePageSlabAllocator>::Deallocate;
+
+  void PrintStats() const {}
+};
+
+/// A BumpPtrAllocator whose slabs are huge pages.
+typedef BumpPtrAllocatorImpl<HugePageSlabAllocator,
+                             HugePageSlabAllocator::HugePageSize>
+    HugePageBumpPtrAllocator;
+
 /// A BumpPtrAllocator that allows only elements of a specific type to be
 /// allocated.
 ///
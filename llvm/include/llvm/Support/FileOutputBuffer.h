@@ -18,6 +18,8 @@
 #include "llvm/Support/DataTypes.h"
 #include "llvm/Support/Error.h"
 #include "llvm/Support/FileSystem.h"
+#include "llvm/Support/raw_ostream.h"
+#include <memory>
 
 namespace llvm {
 /// FileOutputBuffer - This interface provides simple way to create an in-memory
@@ -32,6 +34,12 @@ public:
   enum {
     /// set the 'x' bit on the resulting file
     F_executable = 1,
+
+    /// Don't replace the file but write to it in place. The buffer initially
+    /// holds the existing contents of the file. Unlike the default mode,
+    /// changes are not atomic: if the process is interrupted before commit(),
+    /// the file may be left partially updated.
+    F_modify = 2,
   };
 
   /// Factory method to create an OutputBuffer object which manages a read/write
@@ -55,6 +63,13 @@ public:
   /// Returns size of the buffer.
   virtual size_t getBufferSize() const = 0;
 
+  /// Grows or shrinks the buffer to \p NewSize bytes, keeping its contents up
+  /// to the smaller of the two sizes. Pointers into the buffer are
+  /// invalidated. This allows writing outputs whose size isn't known up
+  /// front: create the buffer with an estimate, grow it as needed, and shrink
+  /// it to the final size before commit().
+  virtual Error resize(size_t NewSize) = 0;
+
   /// Returns path where file will show up if buffer is committed.
   StringRef getPath() const { return FinalPath; }
 
@@ -79,6 +94,50 @@ protected:
 
   std::string FinalPath;
 };
+
+/// A raw_pwrite_stream that writes to a FileOutputBuffer, resizing it as
+/// needed. Data is copied straight into the buffer, which is usually a
+/// mapping of a temporary file, rather than through write() calls. On
+/// commit(), the buffer is shrunk to the written size and the file atomically
+/// replaces the output, as for FileOutputBuffer.
+///
+/// If the buffer cannot be grown, the stream stops writing and commit()
+/// returns the error.
+class raw_mapped_ostream : public raw_pwrite_stream {
+public:
+  /// Writes to \p Buffer from its start. The initial size of \p Buffer is a
+  /// capacity: a good estimate of the output size avoids resizing it.
+  explicit raw_mapped_ostream(std::unique_ptr<FileOutputBuffer> Buffer);
+
+  /// Creates a buffer for \p Path of \p InitialSize bytes, with the flags of
+  /// FileOutputBuffer::create, and a stream writing to it.
+  static Expected<std::unique_ptr<raw_mapped_ostream>>
+  create(StringRef Path, size_t InitialSize = 1 << 20, unsigned Flags = 0);
+
+  /// The output is discarded if commit() isn't called.
+  ~raw_mapped_ostream() override;
+
+  /// Truncates the output to what was written and commits the buffer. Nothing
+  /// may be written afterwards.
+  Error commit();
+
+  /// Returns the written contents. Valid until the next write.
+  StringRef getContents() const {
+    return StringRef((const char *)Buffer->getBufferStart(), Pos);
+  }
+
+private:
+  void write_impl(const char *Ptr, size_t Size) override;
+  void pwrite_impl(const char *Ptr, size_t Size, uint64_t Offset) override;
+  uint64_t current_pos() const override { return Pos; }
+
+  /// Grows the buffer to hold at least \p MinSize bytes.
+  bool reserve(size_t MinSize);
+
+  std::unique_ptr<FileOutputBuffer> Buffer;
+  size_t Pos = 0;
+  Error WriteError = Error::success();
+};
 } // end namespace llvm
 
 #endif
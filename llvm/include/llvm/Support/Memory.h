@@ -80,6 +80,11 @@ namespace sys {
     /// If the address following \p NearBlock is not so aligned, it will be
     /// rounded up to the next allocation granularity boundary.
     ///
+    /// If \p Flags has MF_HUGE_HINT, the block is backed by huge pages where
+    /// the system supports them (large pages on Windows, transparent huge
+    /// pages on Linux), and its size is then a multiple of the huge page size.
+    /// Otherwise the hint is ignored.
+    ///
     /// \r a non-null MemoryBlock if the function was successful,
     /// otherwise a null MemoryBlock is with \p EC describing the error.
     ///
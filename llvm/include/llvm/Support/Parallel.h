@@ -12,6 +12,7 @@
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/Config/llvm-config.h"
 #include "llvm/Support/MathExtras.h"
+#include "llvm/Support/TaskScheduler.h"
 
 #include <algorithm>
 #include <condition_variable>
@@ -61,11 +62,17 @@ public:
     std::unique_lock<std::mutex> lock(Mutex);
     Cond.wait(lock, [&] { return Count == 0; });
   }
+
+  bool isZero() const {
+    std::lock_guard<std::mutex> lock(Mutex);
+    return Count == 0;
+  }
 };
 
+/// A group of tasks run by a TaskScheduler, which can be waited for.
 class TaskGroup {
   Latch L;
-  bool Parallel;
+  TaskScheduler &Scheduler;
 
 public:
   TaskGroup();
@@ -73,7 +80,9 @@ public:
 
   void spawn(std::function<void()> f);
 
-  void sync() const { L.sync(); }
+  /// Waits for the tasks of the group, running some of them on the calling
+  /// thread if it is a worker thread.
+  void sync() const;
 };
 
 const ptrdiff_t MinParallelSize = 1024;
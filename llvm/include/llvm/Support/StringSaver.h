@@ -13,6 +13,8 @@
 #include "llvm/ADT/StringRef.h"
 #include "llvm/ADT/Twine.h"
 #include "llvm/Support/Allocator.h"
+#include <memory>
+#include <mutex>
 
 namespace llvm {
 
@@ -53,5 +55,32 @@ public:
   StringRef save(const std::string &S) { return save(StringRef(S)); }
 };
 
+/// Saves strings in storage owned by the saver, like StringSaver, and can be
+/// called from several threads at once.
+///
+/// The storage is split in shards, each with its own lock and allocator, and
+/// each thread saves its strings in the same shard, so that threads seldom
+/// wait for each other.
+class ConcurrentStringSaver final {
+  struct Shard {
+    std::mutex Mutex;
+    BumpPtrAllocator Alloc;
+  };
+  std::unique_ptr<Shard[]> Shards;
+  unsigned NumShards;
+
+public:
+  explicit ConcurrentStringSaver(unsigned NumShards = 16);
+
+  // All returned strings are null-terminated: *save(S).end() == 0.
+  StringRef save(const char *S) { return save(StringRef(S)); }
+  StringRef save(StringRef S);
+  StringRef save(const Twine &S) { return save(StringRef(S.str())); }
+  StringRef save(const std::string &S) { return save(StringRef(S)); }
+
+  /// Returns the number of bytes allocated by all shards.
+  size_t getTotalMemory() const;
+};
+
 }
 #endif
@@ -0,0 +1,118 @@
+//===- llvm/Support/TaskScheduler.h - Work-stealing task scheduler -*- C++ -*-//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// This file defines TaskScheduler, the work-stealing scheduler that runs the
+// tasks of ThreadPool and of the parallel algorithms in Parallel.h.
+//
+// Each worker thread has a deque of tasks. The tasks a worker spawns are
+// pushed onto its own deque, and it runs them last-in first-out, while idle
+// workers steal the oldest tasks of the others. Tasks spawned by other threads
+// go through a shared queue.
+//
+// Tasks spawned by a worker always go to the scheduler of that worker, so
+// nested parallelism (e.g. a parallel_for_each in a ThreadPool task) runs on
+// the threads that are already there rather than on new ones.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_SUPPORT_TASKSCHEDULER_H
+#define LLVM_SUPPORT_TASKSCHEDULER_H
+
+#include "llvm/ADT/FunctionExtras.h"
+#include "llvm/Config/llvm-config.h"
+#include "llvm/Support/thread.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace llvm {
+
+#if LLVM_ENABLE_THREADS
+
+/// A set of worker threads running tasks with work stealing.
+class TaskScheduler {
+public:
+  using TaskTy = unique_function<void()>;
+
+  /// Starts \p ThreadCount worker threads.
+  explicit TaskScheduler(unsigned ThreadCount);
+
+  /// Stops and joins the worker threads. Tasks that didn't start yet are
+  /// dropped.
+  ~TaskScheduler();
+
+  TaskScheduler(const TaskScheduler &) = delete;
+  TaskScheduler &operator=(const TaskScheduler &) = delete;
+
+  /// Queues \p Task to be run by a worker thread.
+  void spawn(TaskTy Task);
+
+  /// If the calling thread is a worker of this scheduler, runs the newest task
+  /// of its own deque. This is how a worker waiting for tasks it spawned helps
+  /// with them instead of blocking.
+  ///
+  /// \returns false if there was nothing to run.
+  bool runOwnTask();
+
+  unsigned getThreadCount() const { return Workers.size(); }
+
+  /// Returns the scheduler of the calling thread if it is a worker thread,
+  /// and null otherwise.
+  static TaskScheduler *getCurrent();
+
+  /// Returns the scheduler of the calling thread if it is a worker thread, and
+  /// the scheduler shared by the process otherwise.
+  static TaskScheduler &getCurrentOrDefault();
+
+private:
+  struct Worker {
+    std::mutex Mutex;
+    std::deque<TaskTy> Tasks;
+    llvm::thread Thread;
+  };
+
+  void work(unsigned Index);
+
+  /// Takes a task from the shared queue or from the deque of another worker.
+  bool takeTask(unsigned ThiefIndex, TaskTy &Task);
+
+  std::vector<std::unique_ptr<Worker>> Workers;
+
+  /// Tasks spawned by threads that are not workers.
+  std::mutex SharedMutex;
+  std::deque<TaskTy> SharedTasks;
+
+  /// The number of queued tasks, in all deques.
+  std::atomic<size_t> NumQueued{0};
+
+  /// Locking and signaling for idle workers.
+  std::mutex SleepMutex;
+  std::condition_variable SleepCondition;
+  std::atomic<unsigned> NumSleeping{0};
+  bool Stop = false;
+};
+
+#endif // LLVM_ENABLE_THREADS
+
+/// Sets the number of threads of the scheduler shared by the process, and the
+/// default number of threads of a ThreadPool. Zero means one thread per
+/// hardware thread. The scheduler is created on first use, so this must be
+/// called before any parallel algorithm runs.
+void setThreadLimit(unsigned ThreadCount);
+
+/// Returns the number of threads set by setThreadLimit, or the number of
+/// hardware threads if none was set.
+unsigned getThreadLimit();
+
+} // namespace llvm
+
+#endif // LLVM_SUPPORT_TASKSCHEDULER_H
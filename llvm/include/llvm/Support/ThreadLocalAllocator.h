@@ -0,0 +1,145 @@
+//===- ThreadLocalAllocator.h - Per-thread bump pointer arenas --*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+/// \file
+///
+/// This file defines ThreadLocalBumpPtrAllocator, an allocator that several
+/// threads can allocate from at once without locking. Each thread allocates
+/// from an arena of its own, created on its first allocation, and all the
+/// memory is freed with the allocator.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_SUPPORT_THREADLOCALALLOCATOR_H
+#define LLVM_SUPPORT_THREADLOCALALLOCATOR_H
+
+#include "llvm/Support/Allocator.h"
+#include "llvm/Support/Compiler.h"
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace llvm {
+
+namespace detail {
+
+/// The arena of the ThreadLocalBumpPtrAllocatorImpl last used by a thread, so
+/// that allocating from the same allocator again doesn't take a lock.
+struct ThreadArenaCache {
+  uint64_t AllocatorID;
+  void *Arena;
+};
+
+extern LLVM_THREAD_LOCAL ThreadArenaCache CurrentThreadArena;
+
+/// Returns a different non-zero number on each call.
+uint64_t getNextThreadLocalAllocatorID();
+
+} // end namespace detail
+
+/// An allocator that gives each thread its own \p ArenaT, so that threads can
+/// allocate at the same time without taking a lock.
+///
+/// Allocating from another allocator in between takes a lock on the next
+/// allocation, to find the arena of the thread again. The memory of every
+/// arena lives as long as the allocator, even after its thread exits.
+template <typename ArenaT = BumpPtrAllocator>
+class ThreadLocalBumpPtrAllocatorImpl
+    : public AllocatorBase<ThreadLocalBumpPtrAllocatorImpl<ArenaT>> {
+public:
+  ThreadLocalBumpPtrAllocatorImpl()
+      : ID(detail::getNextThreadLocalAllocatorID()) {}
+
+  ThreadLocalBumpPtrAllocatorImpl(const ThreadLocalBumpPtrAllocatorImpl &) =
+      delete;
+  ThreadLocalBumpPtrAllocatorImpl &
+  operator=(const ThreadLocalBumpPtrAllocatorImpl &) = delete;
+
+  LLVM_ATTRIBUTE_RETURNS_NONNULL LLVM_ATTRIBUTE_RETURNS_NOALIAS void *
+  Allocate(size_t Size, size_t Alignment) {
+    return getThreadArena().Allocate(Size, Alignment);
+  }
+
+  // Pull in base class overloads.
+  using AllocatorBase<ThreadLocalBumpPtrAllocatorImpl>::Allocate;
+
+  // Like a BumpPtrAllocator, the memory is only freed with the allocator.
+  void Deallocate(const void *, size_t) {}
+
+  // Pull in base class overloads.
+  using AllocatorBase<ThreadLocalBumpPtrAllocatorImpl>::Deallocate;
+
+  /// Returns the arena of the calling thread, creating it if needed.
+  ArenaT &getThreadArena() {
+    detail::ThreadArenaCache &Cache = detail::CurrentThreadArena;
+    if (LLVM_LIKELY(Cache.AllocatorID == ID))
+      return *static_cast<ArenaT *>(Cache.Arena);
+
+    std::thread::id Self = std::this_thread::get_id();
+    std::lock_guard<std::mutex> Lock(Mutex);
+    ArenaT *Arena = nullptr;
+    for (auto &ThreadAndArena : Arenas)
+      if (ThreadAndArena.first == Self)
+        Arena = ThreadAndArena.second.get();
+    if (!Arena) {
+      Arenas.emplace_back(Self, std::make_unique<ArenaT>());
+      Arena = Arenas.back().second.get();
+    }
+    Cache.AllocatorID = ID;
+    Cache.Arena = Arena;
+    return *Arena;
+  }
+
+  /// Frees the memory of all arenas. No thread may allocate concurrently.
+  void Reset() {
+    std::lock_guard<std::mutex> Lock(Mutex);
+    for (auto &ThreadAndArena : Arenas)
+      ThreadAndArena.second->Reset();
+  }
+
+  /// The following return the totals of all arenas. As other threads may be
+  /// allocating, they are only snapshots.
+  size_t getTotalMemory() const {
+    std::lock_guard<std::mutex> Lock(Mutex);
+    size_t Total = 0;
+    for (auto &ThreadAndArena : Arenas)
+      Total += ThreadAndArena.second->getTotalMemory();
+    return Total;
+  }
+
+  size_t getBytesAllocated() const {
+    std::lock_guard<std::mutex> Lock(Mutex);
+    size_t Total = 0;
+    for (auto &ThreadAndArena : Arenas)
+      Total += ThreadAndArena.second->getBytesAllocated();
+    return Total;
+  }
+
+  void PrintStats() const {
+    std::lock_guard<std::mutex> Lock(Mutex);
+    for (auto &ThreadAndArena : Arenas)
+      ThreadAndArena.second->PrintStats();
+  }
+
+private:
+  /// Identifies this allocator in the thread caches. Unlike its address, it
+  /// isn't reused by an allocator created after this one is destroyed.
+  const uint64_t ID;
+
+  mutable std::mutex Mutex;
+  std::vector<std::pair<std::thread::id, std::unique_ptr<ArenaT>>> Arenas;
+};
+
+/// The standard ThreadLocalBumpPtrAllocator, with BumpPtrAllocator arenas.
+typedef ThreadLocalBumpPtrAllocatorImpl<> ThreadLocalBumpPtrAllocator;
+
+} // end namespace llvm
+
+#endif // LLVM_SUPPORT_THREADLOCALALLOCATOR_H
@@ -14,6 +14,7 @@
 #define LLVM_SUPPORT_THREAD_POOL_H
 
 #include "llvm/Config/llvm-config.h"
+#include "llvm/Support/TaskScheduler.h"
 #include "llvm/Support/thread.h"
 
 #include <future>
@@ -31,15 +32,15 @@ namespace llvm {
 /// A ThreadPool for asynchronous parallel execution on a defined number of
 /// threads.
 ///
-/// The pool keeps a vector of threads alive, waiting on a condition variable
-/// for some work to become available.
+/// The tasks are run by a TaskScheduler with that many threads, so tasks
+/// spawned from within a task, including by the parallel algorithms, are run
+/// by the threads of the pool.
 class ThreadPool {
 public:
   using TaskTy = std::function<void()>;
   using PackagedTaskTy = std::packaged_task<void()>;
 
-  /// Construct a pool with the number of threads found by
-  /// hardware_concurrency().
+  /// Construct a pool with the number of threads given by getThreadLimit().
   ThreadPool();
 
   /// Construct a pool of \p ThreadCount threads
@@ -73,26 +74,19 @@ private:
   /// used to wait for the task to finish and is *non-blocking* on destruction.
   std::shared_future<void> asyncImpl(TaskTy F);
 
-  /// Threads in flight
-  std::vector<llvm::thread> Threads;
-
-  /// Tasks waiting for execution in the pool.
-  std::queue<PackagedTaskTy> Tasks;
-
-  /// Locking and signaling for accessing the Tasks queue.
-  std::mutex QueueLock;
-  std::condition_variable QueueCondition;
+#if LLVM_ENABLE_THREADS
+  /// The threads running the tasks.
+  std::unique_ptr<TaskScheduler> Scheduler;
 
   /// Locking and signaling for job completion
   std::mutex CompletionLock;
   std::condition_variable CompletionCondition;
 
-  /// Keep track of the number of thread actually busy
-  std::atomic<unsigned> ActiveThreads;
-
-#if LLVM_ENABLE_THREADS // avoids warning for unused variable
-  /// Signal for the destruction of the pool, asking thread to exit.
-  bool EnableFlag;
+  /// The number of tasks queued or running.
+  unsigned PendingTasks = 0;
+#else
+  /// Tasks waiting for execution in the pool.
+  std::queue<PackagedTaskTy> Tasks;
 #endif
 };
 }
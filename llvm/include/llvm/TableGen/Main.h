@@ -13,6 +13,10 @@
 #ifndef LLVM_TABLEGEN_MAIN_H
 #define LLVM_TABLEGEN_MAIN_H
 
+#include "llvm/ADT/ArrayRef.h"
+#include <functional>
+#include <string>
+
 namespace llvm {
 
 class raw_ostream;
@@ -22,7 +26,19 @@ class RecordKeeper;
 /// Returns true on error, false otherwise.
 using TableGenMainFn = bool (raw_ostream &OS, RecordKeeper &Records);
 
-int TableGenMain(char *argv0, TableGenMainFn *MainFn);
+/// An additional action to perform on the records parsed by TableGenMain,
+/// and the file its output is written to.
+struct TableGenExtraOutput {
+  std::string Filename;
+  std::function<TableGenMainFn> Fn;
+};
+
+/// Parse the input file, perform MainFn and write its output to the file
+/// given by -o. Each of ExtraOutputs is then performed on the same records,
+/// in order, so that a build needing several outputs from one input only
+/// parses it once. Backends see the changes made by the ones before them.
+int TableGenMain(char *argv0, TableGenMainFn *MainFn,
+                 ArrayRef<TableGenExtraOutput> ExtraOutputs = None);
 
 } // end namespace llvm
 
@@ -98,7 +98,9 @@ public:
   ~InlinerPass();
   InlinerPass(InlinerPass &&Arg)
       : Params(std::move(Arg.Params)),
-        ImportedFunctionsStats(std::move(Arg.ImportedFunctionsStats)) {}
+        ImportedFunctionsStats(std::move(Arg.ImportedFunctionsStats)),
+        BudgetModule(Arg.BudgetModule), ModuleSizeBudget(Arg.ModuleSizeBudget),
+        ModuleSizeGrowth(Arg.ModuleSizeGrowth) {}
 
   PreservedAnalyses run(LazyCallGraph::SCC &C, CGSCCAnalysisManager &AM,
                         LazyCallGraph &CG, CGSCCUpdateResult &UR);
@@ -106,6 +108,14 @@ public:
 private:
   InlineParams Params;
   std::unique_ptr<ImportedFunctionsInliningStatistics> ImportedFunctionsStats;
+
+  /// With -inline-size-budget, the module whose growth is tracked, the number
+  /// of instructions it may grow by through inlining of call sites that are
+  /// not hot, and the estimated growth so far. The budget spans all the SCCs
+  /// of the module.
+  const Module *BudgetModule = nullptr;
+  uint64_t ModuleSizeBudget = 0;
+  uint64_t ModuleSizeGrowth = 0;
 };
 
 } // end namespace llvm
@@ -0,0 +1,137 @@
+//===- SampleContextTracker.h - Context-sensitive profile tracker -*- C++ -*-=//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+/// \file
+/// This file provides the interface for the context-sensitive profile
+/// tracker used by the sample profile loader. The tracker keeps the profiles
+/// of all the calling contexts in a trie, and merges the contexts that are not
+/// inlined in the current build into the profile of the outlined function.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_TRANSFORMS_IPO_SAMPLECONTEXTTRACKER_H
+#define LLVM_TRANSFORMS_IPO_SAMPLECONTEXTTRACKER_H
+
+#include "llvm/ADT/DenseSet.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/ProfileData/SampleProf.h"
+#include <map>
+#include <vector>
+
+namespace llvm {
+
+class CallBase;
+class DILocation;
+class Function;
+
+/// A node of the context trie. The children of a node are the contexts of
+/// its callees, keyed by callsite location and callee name. The children of
+/// the root are the functions sampled outside of any known caller.
+class ContextTrieNode {
+public:
+  ContextTrieNode(ContextTrieNode *Parent = nullptr,
+                  StringRef FName = StringRef(),
+                  sampleprof::LineLocation CallSiteLoc = {0, 0})
+      : ParentContext(Parent), FuncName(FName), CallSiteLoc(CallSiteLoc) {}
+
+  /// Return the context of \p CalleeName called at \p CallSite, or null if
+  /// there is none.
+  ContextTrieNode *getChildContext(const sampleprof::LineLocation &CallSite,
+                                   StringRef CalleeName);
+
+  /// Return the context with the most samples among all the callees called
+  /// at \p CallSite, or null if there is none.
+  ContextTrieNode *
+  getHottestChildContext(const sampleprof::LineLocation &CallSite);
+
+  ContextTrieNode &
+  getOrCreateChildContext(const sampleprof::LineLocation &CallSite,
+                          StringRef CalleeName);
+
+  /// Return the contexts of all the callees called at \p CallSite.
+  std::vector<ContextTrieNode *>
+  getChildContextsAt(const sampleprof::LineLocation &CallSite);
+
+  StringRef getFuncName() const { return FuncName; }
+  sampleprof::FunctionSamples *getFunctionSamples() const { return FSamples; }
+  void setFunctionSamples(sampleprof::FunctionSamples *FS) { FSamples = FS; }
+  const sampleprof::LineLocation &getCallSiteLoc() const { return CallSiteLoc; }
+  ContextTrieNode *getParentContext() const { return ParentContext; }
+
+  using ChildKey = std::pair<sampleprof::LineLocation, StringRef>;
+  std::map<ChildKey, ContextTrieNode> &getAllChildContext() {
+    return AllChildContext;
+  }
+
+  void dump(unsigned Indent = 0) const;
+
+private:
+  ContextTrieNode *ParentContext;
+  StringRef FuncName;
+  /// Location of the call to this context in its parent.
+  sampleprof::LineLocation CallSiteLoc;
+  /// Samples of this context, or null if it was not sampled.
+  sampleprof::FunctionSamples *FSamples = nullptr;
+  std::map<ChildKey, ContextTrieNode> AllChildContext;
+};
+
+/// Tracks the context-sensitive profiles while the sample profile loader
+/// makes its inlining decisions.
+///
+/// The functions must be processed top-down, so that the inlining decisions
+/// of all the callers of a function are known when its profile is queried:
+/// the contexts of a function that were not inlined into their caller are
+/// then merged, with the contexts of their own callees, into the profile of
+/// the outlined function.
+class SampleContextTracker {
+public:
+  SampleContextTracker(StringMap<sampleprof::FunctionSamples> &Profiles);
+
+  /// Return the samples of \p CalleeName called by \p Inst, in the context
+  /// of the inline stack of \p Inst. The callee with the most samples is
+  /// chosen when \p CalleeName is empty.
+  sampleprof::FunctionSamples *
+  getCalleeContextSamplesFor(const CallBase &Inst, StringRef CalleeName);
+
+  /// Return the samples of all the callees called at \p DIL, in the context
+  /// of its inline stack.
+  std::vector<const sampleprof::FunctionSamples *>
+  getIndirectCalleeContextSamplesFor(const DILocation *DIL);
+
+  /// Return the samples of the inline instance \p DIL comes from, in the
+  /// context of its inline stack.
+  sampleprof::FunctionSamples *getContextSamplesFor(const DILocation *DIL);
+
+  /// Return the samples of the outlined function \p Func, once the contexts
+  /// that were not inlined into their caller are merged into them.
+  sampleprof::FunctionSamples *getBaseSamplesFor(const Function &Func);
+
+  /// Record that the context \p Samples was inlined into its caller,
+  /// so that it is not merged into the outlined callee.
+  void markContextSamplesInlined(const sampleprof::FunctionSamples *Samples);
+
+  void dump() const;
+
+private:
+  ContextTrieNode *getContextFor(const DILocation *DIL);
+  ContextTrieNode &addContextNode(ContextTrieNode &Parent,
+                                  const sampleprof::LineLocation &CallSite,
+                                  StringRef CalleeName);
+  void mergeContextTree(ContextTrieNode &FromNode, ContextTrieNode &ToNode);
+
+  ContextTrieNode RootContext;
+  /// All the context nodes of each function.
+  StringMap<std::vector<ContextTrieNode *>> FuncToCtxtNodes;
+  /// Contexts inlined into their caller.
+  DenseSet<const sampleprof::FunctionSamples *> InlinedSamples;
+};
+
+} // end namespace llvm
+
+#endif // LLVM_TRANSFORMS_IPO_SAMPLECONTEXTTRACKER_H
@@ -61,6 +61,8 @@ private:
   std::vector<GlobalVariable *> ReferencedNames;
   GlobalVariable *NamesVar;
   size_t NamesSize;
+  // The thread local counter of sampled instrumentation.
+  GlobalVariable *SamplingVar;
 
   // Is this lowering for the context-sensitive instrumentation.
   bool IsCS;
@@ -85,6 +87,13 @@ private:
   /// Returns true if profile counter update register promotion is enabled.
   bool isCounterPromotionEnabled() const;
 
+  /// Returns true if the counters are only updated in sampled bursts.
+  bool isSamplingEnabled() const;
+
+  /// Get the thread local counter of sampled instrumentation, creating it if
+  /// necessary.
+  GlobalVariable *getOrCreateSamplingVar();
+
   /// Count the number of instrumented value sites for the function.
   void computeNumValueSiteCounts(InstrProfValueProfileInst *Ins);
 
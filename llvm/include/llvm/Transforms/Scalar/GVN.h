@@ -46,6 +46,9 @@ class FunctionPass;
 class IntrinsicInst;
 class LoadInst;
 class LoopInfo;
+class MemoryAccess;
+class MemorySSA;
+class MemorySSAUpdater;
 class OptimizationRemarkEmitter;
 class PHINode;
 class TargetLibraryInfo;
@@ -82,6 +85,7 @@ public:
   DominatorTree &getDominatorTree() const { return *DT; }
   AliasAnalysis *getAliasAnalysis() const { return VN.getAliasAnalysis(); }
   MemoryDependenceResults &getMemDep() const { return *MD; }
+  MemorySSA *getMemorySSA() const { return MSSA; }
 
   /// This class holds the mapping between values and value numbers.  It is used
   /// as an efficient mechanism to determine the expression-wise equivalence of
@@ -155,6 +159,8 @@ private:
   friend struct DenseMapInfo<Expression>;
 
   MemoryDependenceResults *MD;
+  MemorySSA *MSSA;
+  MemorySSAUpdater *MSSAU;
   DominatorTree *DT;
   const TargetLibraryInfo *TLI;
   AssumptionCache *AC;
@@ -197,7 +203,7 @@ private:
   bool runImpl(Function &F, AssumptionCache &RunAC, DominatorTree &RunDT,
                const TargetLibraryInfo &RunTLI, AAResults &RunAA,
                MemoryDependenceResults *RunMD, LoopInfo *LI,
-               OptimizationRemarkEmitter *ORE);
+               OptimizationRemarkEmitter *ORE, MemorySSA *RunMSSA = nullptr);
 
   /// Push a new Value to the LeaderTable onto the list for its value number.
   void addToLeaderTable(uint32_t N, Value *V, const BasicBlock *BB) {
@@ -252,6 +258,17 @@ private:
   bool processNonLocalLoad(LoadInst *L);
   bool processAssumeIntrinsic(IntrinsicInst *II);
 
+  /// Find the dependence MemoryDependenceAnalysis would return for the load
+  /// \p LI from \p Address at \p InsertPt by walking up the MemoryDefs from
+  /// \p Clobber, stopping at a MemoryPhi. \p Clobber is updated to the access
+  /// the walk ended at, or null if it gave up.
+  MemDepResult getMemorySSADependency(LoadInst *LI, MemoryAccess *&Clobber,
+                                      Value *Address, Instruction *InsertPt);
+
+  /// Find the dependencies of \p LI at the end of each predecessor of its
+  /// block using MemorySSA. Returns false if there are too many.
+  bool getMemorySSANonLocalDependencies(LoadInst *LI, LoadDepVect &Deps);
+
   /// Given a local dependency (Def or Clobber) determine if a value is
   /// available for the load.  Returns true if an value is known to be
   /// available and populates Res.  Returns false otherwise.
@@ -15,16 +15,29 @@
 
 #include "llvm/IR/Function.h"
 #include "llvm/IR/PassManager.h"
+#include <memory>
 
 namespace llvm {
 
+namespace sampleprof {
+class SampleProfileReader;
+} // end namespace sampleprof
+
 /// An optimization pass inserting data prefetches in loops.
 class LoopDataPrefetchPass : public PassInfoMixin<LoopDataPrefetchPass> {
 public:
-  LoopDataPrefetchPass() = default;
+  LoopDataPrefetchPass();
+  LoopDataPrefetchPass(LoopDataPrefetchPass &&);
+  ~LoopDataPrefetchPass();
 
   /// Run the pass over the function.
   PreservedAnalyses run(Function &F, FunctionAnalysisManager &AM);
+
+private:
+  /// The cache miss profile given with -loop-prefetch-miss-profile, read on
+  /// the first run.
+  std::unique_ptr<sampleprof::SampleProfileReader> MissProfile;
+  bool MissProfileRead = false;
 };
 
 } // end namespace llvm
@@ -25,6 +25,10 @@ class Module;
 /// Splits the module M into N linkable partitions. The function ModuleCallback
 /// is called N times passing each individual partition as the MPart argument.
 ///
+/// By default globals are distributed by the hash of their names. If
+/// ByCallGraph is true, functions that call each other are kept together where
+/// possible and the partitions are balanced by instruction count instead.
+///
 /// FIXME: This function does not deal with the somewhat subtle symbol
 /// visibility issues around module splitting, including (but not limited to):
 ///
@@ -35,7 +39,7 @@ class Module;
 void SplitModule(
     std::unique_ptr<Module> M, unsigned N,
     function_ref<void(std::unique_ptr<Module> MPart)> ModuleCallback,
-    bool PreserveLocals = false);
+    bool PreserveLocals = false, bool ByCallGraph = false);
 
 } // end namespace llvm
 
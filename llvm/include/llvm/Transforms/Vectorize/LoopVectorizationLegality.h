@@ -354,6 +354,11 @@ private:
   /// specific checks for outer loop vectorization.
   bool canVectorizeOuterLoop();
 
+  /// Return true if all the instructions of this outer loop nest can be
+  /// widened, none but the inductions is used outside of the loop, and the
+  /// iterations of the outer loop are independent.
+  bool canVectorizeOuterLoopInstrs();
+
   /// Return true if all of the instructions in the block can be speculatively
   /// executed, and record the loads/stores that require masking. If's that
   /// guard loads can be ignored under "assume safety" unless \p PreserveGuards
@@ -153,6 +153,10 @@ struct LoopVectorizePass : public PassInfoMixin<LoopVectorizePass> {
                OptimizationRemarkEmitter &ORE_, ProfileSummaryInfo *PSI_);
 
   bool processLoop(Loop *L);
+
+  /// Vectorize the scalar remainder loop \p L of a loop just vectorized with
+  /// \p MainVF and \p MainIC, with a narrower VF and no interleaving.
+  bool vectorizeEpilogue(Loop *L, unsigned MainVF, unsigned MainIC);
 };
 
 /// Reports a vectorization failure: print \p DebugMsg for debugging
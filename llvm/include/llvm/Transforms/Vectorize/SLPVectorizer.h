@@ -117,6 +117,11 @@ private:
                                 slpvectorizer::BoUpSLP &R,
                                 TargetTransformInfo *TTI);
 
+  /// Try to vectorize the trees feeding the PHI \p P in \p BB from its
+  /// predecessors.
+  bool vectorizeIncomingValues(PHINode *P, BasicBlock *BB,
+                               slpvectorizer::BoUpSLP &R);
+
   /// Try to vectorize trees that start at insertvalue instructions.
   bool vectorizeInsertValueInst(InsertValueInst *IVI, BasicBlock *BB,
                                 slpvectorizer::BoUpSLP &R);
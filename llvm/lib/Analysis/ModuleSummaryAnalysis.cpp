@@ -385,9 +385,12 @@ static void computeFunctionSummary(ModuleSummaryIndex &Index, const Module &M,
         auto CandidateProfileData =
             ICallAnalysis.getPromotionCandidatesForInstruction(
                 &I, NumVals, TotalCount, NumCandidates);
-        for (auto &Candidate : CandidateProfileData)
-          CallGraphEdges[Index.getOrInsertValueInfo(Candidate.Value)]
-              .updateHotness(getHotness(Candidate.Count, PSI));
+        for (auto &Candidate : CandidateProfileData) {
+          auto &ValueInfo =
+              CallGraphEdges[Index.getOrInsertValueInfo(Candidate.Value)];
+          ValueInfo.updateHotness(getHotness(Candidate.Count, PSI));
+          ValueInfo.setICallTarget();
+        }
       }
     }
 
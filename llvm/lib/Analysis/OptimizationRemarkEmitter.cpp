@@ -18,6 +18,7 @@
 #include "llvm/IR/DiagnosticInfo.h"
 #include "llvm/IR/Dominators.h"
 #include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/RemarkStreamer.h"
 
 using namespace llvm;
 
@@ -69,6 +70,14 @@ void OptimizationRemarkEmitter::computeHotness(
     OptDiag.setHotness(computeHotness(V));
 }
 
+bool OptimizationRemarkEmitter::allowExtraAnalysis(StringRef PassName) const {
+  // Remarks that the streamer would filter out are not worth the analysis.
+  if (RemarkStreamer *RS = F->getContext().getRemarkStreamer())
+    if (RS->matchesFilter(PassName))
+      return true;
+  return F->getContext().getDiagHandlerPtr()->isAnyRemarkEnabled(PassName);
+}
+
 void OptimizationRemarkEmitter::emit(
     DiagnosticInfoOptimizationBase &OptDiagBase) {
   auto &OptDiag = cast<DiagnosticInfoIROptimization>(OptDiagBase);
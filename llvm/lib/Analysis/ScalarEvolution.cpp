@@ -145,6 +145,11 @@ STATISTIC(NumTripCountsNotComputed,
           "Number of loops without predictable loop counts");
 STATISTIC(NumBruteForceTripCountsComputed,
           "Number of loops with trip counts computed by force");
+STATISTIC(NumBackedgeTakenCountsForgotten,
+          "Number of backedge-taken counts invalidated");
+STATISTIC(NumArithNotSimplified,
+          "Number of add and mul expressions not simplified due to their "
+          "depth or size");
 
 static cl::opt<unsigned>
 MaxBruteForceIterations("scalar-evolution-max-iterations", cl::ReallyHidden,
@@ -2445,8 +2450,10 @@ const SCEV *ScalarEvolution::getAddExpr(SmallVectorImpl<const SCEV *> &Ops,
   }
 
   // Limit recursion calls depth.
-  if (Depth > MaxArithDepth || hasHugeExpression(Ops))
+  if (Depth > MaxArithDepth || hasHugeExpression(Ops)) {
+    ++NumArithNotSimplified;
     return getOrCreateAddExpr(Ops, Flags);
+  }
 
   // Okay, check to see if the same value occurs in the operand list more than
   // once.  If so, merge them together into an multiply expression.  Since we
@@ -2924,8 +2931,10 @@ const SCEV *ScalarEvolution::getMulExpr(SmallVectorImpl<const SCEV *> &Ops,
   Flags = StrengthenNoWrapFlags(this, scMulExpr, Ops, Flags);
 
   // Limit recursion calls depth.
-  if (Depth > MaxArithDepth || hasHugeExpression(Ops))
+  if (Depth > MaxArithDepth || hasHugeExpression(Ops)) {
+    ++NumArithNotSimplified;
     return getOrCreateMulExpr(Ops, Flags);
+  }
 
   // If there are any constants, fold them together.
   unsigned Idx = 0;
@@ -6651,7 +6660,10 @@ ScalarEvolution::getPredicatedBackedgeTakenInfo(const Loop *L) {
   BackedgeTakenInfo Result =
       computeBackedgeTakenCount(L, /*AllowPredicates=*/true);
 
-  return PredicatedBackedgeTakenCounts.find(L)->second = std::move(Result);
+  BackedgeTakenInfo &PredicatedBTI =
+      PredicatedBackedgeTakenCounts.find(L)->second = std::move(Result);
+  addToBECountUsers(L, /*Predicated=*/true);
+  return PredicatedBTI;
 }
 
 const ScalarEvolution::BackedgeTakenInfo &
@@ -6754,7 +6766,10 @@ ScalarEvolution::getBackedgeTakenInfo(const Loop *L) {
   // recusive call to getBackedgeTakenInfo (on a different
   // loop), which would invalidate the iterator computed
   // earlier.
-  return BackedgeTakenCounts.find(L)->second = std::move(Result);
+  BackedgeTakenInfo &BTI = BackedgeTakenCounts.find(L)->second =
+      std::move(Result);
+  addToBECountUsers(L, /*Predicated=*/false);
+  return BTI;
 }
 
 void ScalarEvolution::forgetAllLoops() {
@@ -6765,6 +6780,7 @@ void ScalarEvolution::forgetAllLoops() {
   // result.
   BackedgeTakenCounts.clear();
   PredicatedBackedgeTakenCounts.clear();
+  BECountUsers.clear();
   LoopPropertiesCache.clear();
   ConstantEvolutionLoopExitValue.clear();
   ValueExprMap.clear();
@@ -6780,16 +6796,6 @@ void ScalarEvolution::forgetAllLoops() {
 }
 
 void ScalarEvolution::forgetLoop(const Loop *L) {
-  // Drop any stored trip count value.
-  auto RemoveLoopFromBackedgeMap =
-      [](DenseMap<const Loop *, BackedgeTakenInfo> &Map, const Loop *L) {
-        auto BTCPos = Map.find(L);
-        if (BTCPos != Map.end()) {
-          BTCPos->second.clear();
-          Map.erase(BTCPos);
-        }
-      };
-
   SmallVector<const Loop *, 16> LoopWorklist(1, L);
   SmallVector<Instruction *, 32> Worklist;
   SmallPtrSet<Instruction *, 16> Visited;
@@ -6798,8 +6804,9 @@ void ScalarEvolution::forgetLoop(const Loop *L) {
   while (!LoopWorklist.empty()) {
     auto *CurrL = LoopWorklist.pop_back_val();
 
-    RemoveLoopFromBackedgeMap(BackedgeTakenCounts, CurrL);
-    RemoveLoopFromBackedgeMap(PredicatedBackedgeTakenCounts, CurrL);
+    // Drop any stored trip count value.
+    forgetBackedgeTakenCount(CurrL, /*Predicated=*/false);
+    forgetBackedgeTakenCount(CurrL, /*Predicated=*/true);
 
     // Drop information about predicated SCEV rewrites for this loop.
     for (auto I = PredicatedSCEVRewrites.begin();
@@ -6951,18 +6958,22 @@ bool ScalarEvolution::BackedgeTakenInfo::isMaxOrZero(ScalarEvolution *SE) const
   return MaxOrZero && !any_of(ExitNotTaken, PredicateNotAlwaysTrue);
 }
 
-bool ScalarEvolution::BackedgeTakenInfo::hasOperand(const SCEV *S,
-                                                    ScalarEvolution *SE) const {
-  if (getMax() && getMax() != SE->getCouldNotCompute() &&
-      SE->hasOperand(getMax(), S))
-    return true;
+void ScalarEvolution::BackedgeTakenInfo::collectOperands(
+    SmallPtrSetImpl<const SCEV *> &Ops, ScalarEvolution *SE) const {
+  struct FindOperands {
+    FindOperands(SmallPtrSetImpl<const SCEV *> &Ops) : Ops(Ops) {}
+    SmallPtrSetImpl<const SCEV *> &Ops;
+    bool follow(const SCEV *S) { return Ops.insert(S).second; }
+    bool isDone() const { return false; }
+  };
 
-  for (auto &ENT : ExitNotTaken)
-    if (ENT.ExactNotTaken != SE->getCouldNotCompute() &&
-        SE->hasOperand(ENT.ExactNotTaken, S))
-      return true;
+  FindOperands F(Ops);
+  if (getMax() && getMax() != SE->getCouldNotCompute())
+    visitAll(getMax(), F);
 
-  return false;
+  for (auto &ENT : ExitNotTaken)
+    if (ENT.ExactNotTaken != SE->getCouldNotCompute())
+      visitAll(ENT.ExactNotTaken, F);
 }
 
 ScalarEvolution::ExitLimit::ExitLimit(const SCEV *E)
@@ -11379,6 +11390,7 @@ ScalarEvolution::ScalarEvolution(ScalarEvolution &&Arg)
       BackedgeTakenCounts(std::move(Arg.BackedgeTakenCounts)),
       PredicatedBackedgeTakenCounts(
           std::move(Arg.PredicatedBackedgeTakenCounts)),
+      BECountUsers(std::move(Arg.BECountUsers)),
       ConstantEvolutionLoopExitValue(
           std::move(Arg.ConstantEvolutionLoopExitValue)),
       ValuesAtScopes(std::move(Arg.ValuesAtScopes)),
@@ -11822,20 +11834,47 @@ ScalarEvolution::forgetMemoizedResults(const SCEV *S) {
       ++I;
   }
 
-  auto RemoveSCEVFromBackedgeMap =
-      [S, this](DenseMap<const Loop *, BackedgeTakenInfo> &Map) {
-        for (auto I = Map.begin(), E = Map.end(); I != E;) {
-          BackedgeTakenInfo &BEInfo = I->second;
-          if (BEInfo.hasOperand(S, this)) {
-            BEInfo.clear();
-            Map.erase(I++);
-          } else
-            ++I;
-        }
-      };
+  auto BEUsersIt = BECountUsers.find(S);
+  if (BEUsersIt != BECountUsers.end()) {
+    // Copy the users, forgetting their counts updates BECountUsers.
+    SmallVector<PointerIntPair<const Loop *, 1, bool>, 4> Users(
+        BEUsersIt->second.begin(), BEUsersIt->second.end());
+    for (auto LoopAndPredicated : Users)
+      forgetBackedgeTakenCount(LoopAndPredicated.getPointer(),
+                               LoopAndPredicated.getInt());
+  }
+}
+
+void ScalarEvolution::addToBECountUsers(const Loop *L, bool Predicated) {
+  auto &BECounts =
+      Predicated ? PredicatedBackedgeTakenCounts : BackedgeTakenCounts;
+  SmallPtrSet<const SCEV *, 16> Ops;
+  BECounts.find(L)->second.collectOperands(Ops, this);
+  for (const SCEV *S : Ops)
+    BECountUsers[S].insert({L, Predicated});
+}
+
+void ScalarEvolution::forgetBackedgeTakenCount(const Loop *L,
+                                               bool Predicated) {
+  auto &BECounts =
+      Predicated ? PredicatedBackedgeTakenCounts : BackedgeTakenCounts;
+  auto BTCPos = BECounts.find(L);
+  if (BTCPos == BECounts.end())
+    return;
+
+  SmallPtrSet<const SCEV *, 16> Ops;
+  BTCPos->second.collectOperands(Ops, this);
+  for (const SCEV *S : Ops) {
+    auto UsersIt = BECountUsers.find(S);
+    assert(UsersIt != BECountUsers.end() && "Missing BECountUsers entry!");
+    UsersIt->second.erase({L, Predicated});
+    if (UsersIt->second.empty())
+      BECountUsers.erase(UsersIt);
+  }
 
-  RemoveSCEVFromBackedgeMap(BackedgeTakenCounts);
-  RemoveSCEVFromBackedgeMap(PredicatedBackedgeTakenCounts);
+  BTCPos->second.clear();
+  BECounts.erase(BTCPos);
+  ++NumBackedgeTakenCountsForgotten;
 }
 
 void
@@ -752,6 +752,7 @@ lltok::Kind LLLexer::LexIdentifier() {
   KEYWORD(calls);
   KEYWORD(callee);
   KEYWORD(hotness);
+  KEYWORD(icall);
   KEYWORD(unknown);
   KEYWORD(hot);
   KEYWORD(critical);
@@ -8319,11 +8319,16 @@ bool LLParser::ParseOptionalCalls(std::vector<FunctionSummary::EdgeTy> &Calls) {
 
     CalleeInfo::HotnessType Hotness = CalleeInfo::HotnessType::Unknown;
     unsigned RelBF = 0;
+    unsigned ICall = 0;
     if (EatIfPresent(lltok::comma)) {
-      // Expect either hotness or relbf
+      // Expect either hotness, optionally followed by icall, or relbf
       if (EatIfPresent(lltok::kw_hotness)) {
         if (ParseToken(lltok::colon, "expected ':'") || ParseHotness(Hotness))
           return true;
+        if (EatIfPresent(lltok::comma) &&
+            (ParseToken(lltok::kw_icall, "expected icall") ||
+             ParseToken(lltok::colon, "expected ':'") || ParseFlag(ICall)))
+          return true;
       } else {
         if (ParseToken(lltok::kw_relbf, "expected relbf") ||
             ParseToken(lltok::colon, "expected ':'") || ParseUInt32(RelBF))
@@ -8335,7 +8340,8 @@ bool LLParser::ParseOptionalCalls(std::vector<FunctionSummary::EdgeTy> &Calls) {
     // can only do so once the std::vector is finalized.
     if (VI.getRef() == FwdVIRef)
       IdToIndexMap[GVId].push_back(std::make_pair(Calls.size(), Loc));
-    Calls.push_back(FunctionSummary::EdgeTy{VI, CalleeInfo(Hotness, RelBF)});
+    Calls.push_back(
+        FunctionSummary::EdgeTy{VI, CalleeInfo(Hotness, RelBF, ICall)});
 
     if (ParseToken(lltok::rparen, "expected ')' in call"))
       return true;
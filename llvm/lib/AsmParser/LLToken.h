@@ -383,6 +383,7 @@ enum Kind {
   kw_calls,
   kw_callee,
   kw_hotness,
+  kw_icall,
   kw_unknown,
   kw_hot,
   kw_critical,
@@ -963,6 +963,15 @@ static FunctionSummary::FFlags getDecodedFFlags(uint64_t RawFlags) {
   return Flags;
 }
 
+/// Decode the hotness of a call edge, and whether its callee is a target of
+/// an indirect call.
+static void getDecodedHotnessCallEdgeInfo(uint64_t RawFlags,
+                                          CalleeInfo::HotnessType &Hotness,
+                                          bool &IsICallTarget) {
+  Hotness = static_cast<CalleeInfo::HotnessType>(RawFlags & 0x7); // 3 bits
+  IsICallTarget = (RawFlags >> 3) & 0x1;
+}
+
 /// Decode the flags for GlobalValue in the summary.
 static GlobalValueSummary::GVFlags getDecodedGVSummaryFlags(uint64_t RawFlags,
                                                             uint64_t Version) {
@@ -5643,16 +5652,18 @@ ModuleSummaryIndexBitcodeReader::makeCallList(ArrayRef<uint64_t> Record,
   for (unsigned I = 0, E = Record.size(); I != E; ++I) {
     CalleeInfo::HotnessType Hotness = CalleeInfo::HotnessType::Unknown;
     uint64_t RelBF = 0;
+    bool IsICallTarget = false;
     ValueInfo Callee = getValueInfoFromValueId(Record[I]).first;
     if (IsOldProfileFormat) {
       I += 1; // Skip old callsitecount field
       if (HasProfile)
         I += 1; // Skip old profilecount field
     } else if (HasProfile)
-      Hotness = static_cast<CalleeInfo::HotnessType>(Record[++I]);
+      getDecodedHotnessCallEdgeInfo(Record[++I], Hotness, IsICallTarget);
     else if (HasRelBF)
       RelBF = Record[++I];
-    Ret.push_back(FunctionSummary::EdgeTy{Callee, CalleeInfo(Hotness, RelBF)});
+    Ret.push_back(FunctionSummary::EdgeTy{
+        Callee, CalleeInfo(Hotness, RelBF, IsICallTarget)});
   }
   return Ret;
 }
@@ -65,8 +65,10 @@
 #include "llvm/Support/Error.h"
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/MathExtras.h"
+#include "llvm/Support/Parallel.h"
 #include "llvm/Support/SHA1.h"
 #include "llvm/Support/TargetRegistry.h"
+#include "llvm/Support/Threading.h"
 #include "llvm/Support/raw_ostream.h"
 #include <algorithm>
 #include <cassert>
@@ -90,6 +92,10 @@ static cl::opt<bool> WriteRelBFToSummary(
     "write-relbf-to-summary", cl::Hidden, cl::init(false),
     cl::desc("Write relative block frequency to function summary "));
 
+static cl::opt<bool> ParallelFunctionBlocks(
+    "bitcode-parallel-function-blocks", cl::Hidden, cl::init(false),
+    cl::desc("Encode function blocks on multiple threads"));
+
 extern FunctionSummary::ForceSummaryHotnessType ForceSummaryEdgesCold;
 
 namespace {
@@ -202,6 +208,15 @@ public:
               assignValueId(CallEdge.first.getGUID());
   }
 
+  /// Constructs a ModuleBitcodeWriterBase object that writes the function
+  /// blocks of \p Parent's module to \p Stream, starting from a copy of
+  /// \p Parent's value enumeration.
+  ModuleBitcodeWriterBase(const ModuleBitcodeWriterBase &Parent,
+                          BitstreamWriter &Stream)
+      : BitcodeWriterBase(Stream, Parent.StrtabBuilder), M(Parent.M),
+        VE(Parent.VE), Index(Parent.Index),
+        GlobalValueId(Parent.GlobalValueId) {}
+
 protected:
   void writePerModuleGlobalValueSummary();
 
@@ -274,6 +289,14 @@ public:
   void write();
 
 private:
+  /// Constructs a ModuleBitcodeWriter object that encodes a subset of
+  /// \p Parent's function blocks into \p Buffer, to be spliced into the
+  /// parent's stream afterwards.
+  ModuleBitcodeWriter(const ModuleBitcodeWriter &Parent,
+                      SmallVectorImpl<char> &Buffer, BitstreamWriter &Stream)
+      : ModuleBitcodeWriterBase(Parent, Stream), Buffer(Buffer),
+        GenerateHash(false), ModHash(nullptr), BitcodeStartBit(0) {}
+
   uint64_t bitcodeStartBit() { return BitcodeStartBit; }
 
   size_t addToStrtab(StringRef Str);
@@ -388,6 +411,8 @@ private:
   void
   writeFunction(const Function &F,
                 DenseMap<const Function *, uint64_t> &FunctionToBitcodeIndex);
+  void writeFunctionBlocks(
+      DenseMap<const Function *, uint64_t> &FunctionToBitcodeIndex);
   void writeBlockInfo();
   void writeModuleHash(size_t BlockStartPos);
 
@@ -1008,6 +1033,15 @@ static uint64_t getEncodedFFlags(FunctionSummary::FFlags Flags) {
   return RawFlags;
 }
 
+// Encode the hotness of a call edge, and whether its callee is a target of an
+// indirect call.
+static uint64_t getEncodedHotnessCallEdgeInfo(const CalleeInfo &CI) {
+  uint64_t RawFlags = 0;
+  RawFlags |= CI.Hotness;            // 3 bits
+  RawFlags |= (CI.IsICallTarget << 3);
+  return RawFlags;
+}
+
 // Decode the flags for GlobalValue in the summary
 static uint64_t getEncodedGVSummaryFlags(GlobalValueSummary::GVFlags Flags) {
   uint64_t RawFlags = 0;
@@ -3241,6 +3275,73 @@ void ModuleBitcodeWriter::writeFunction(
   Stream.ExitBlock();
 }
 
+void ModuleBitcodeWriter::writeFunctionBlocks(
+    DenseMap<const Function *, uint64_t> &FunctionToBitcodeIndex) {
+  std::vector<const Function *> Functions;
+  for (const Function &F : M)
+    if (!F.isDeclaration())
+      Functions.push_back(&F);
+
+  // Function blocks only depend on the module-level state of the value
+  // enumerator, so they can be encoded independently from a copy of it. This
+  // is not possible if use-list orders are preserved: those are kept in a
+  // single stack that is consumed in module order.
+  size_t NumChunks = 1;
+  if (ParallelFunctionBlocks && !VE.shouldPreserveUseListOrder() &&
+      Stream.GetCurrentBitNo() % 32 == 0)
+    NumChunks = std::min<size_t>(heavyweight_hardware_concurrency(),
+                                 Functions.size());
+  if (NumChunks <= 1) {
+    for (const Function *F : Functions)
+      writeFunction(*F, FunctionToBitcodeIndex);
+    return;
+  }
+
+  // Split the functions into contiguous chunks with about the same number of
+  // instructions each, so that the chunks can be spliced in module order.
+  std::vector<unsigned> InstCounts;
+  InstCounts.reserve(Functions.size());
+  uint64_t TotalInstCount = 0;
+  for (const Function *F : Functions) {
+    InstCounts.push_back(F->getInstructionCount());
+    TotalInstCount += InstCounts.back();
+  }
+  std::vector<size_t> ChunkBegin = {0};
+  uint64_t InstCount = 0;
+  for (size_t I = 0, E = Functions.size(); I + 1 < E; ++I) {
+    InstCount += InstCounts[I];
+    if (ChunkBegin.size() < NumChunks &&
+        InstCount * NumChunks >= TotalInstCount * ChunkBegin.size())
+      ChunkBegin.push_back(I + 1);
+  }
+  ChunkBegin.push_back(Functions.size());
+  NumChunks = ChunkBegin.size() - 1;
+
+  struct EncodedChunk {
+    SmallVector<char, 0> Buffer;
+    DenseMap<const Function *, uint64_t> FunctionToBitcodeIndex;
+  };
+  std::vector<EncodedChunk> Chunks(NumChunks);
+  parallel::for_each_n(parallel::par, size_t(0), NumChunks, [&](size_t I) {
+    EncodedChunk &Chunk = Chunks[I];
+    BitstreamWriter ChunkStream(Chunk.Buffer);
+    ChunkStream.InheritBlockInfo(Stream);
+    ModuleBitcodeWriter ChunkWriter(*this, Chunk.Buffer, ChunkStream);
+    for (size_t J = ChunkBegin[I]; J != ChunkBegin[I + 1]; ++J)
+      ChunkWriter.writeFunction(*Functions[J], Chunk.FunctionToBitcodeIndex);
+  });
+
+  // Splice the chunks in order, rebasing the recorded function offsets.
+  for (EncodedChunk &Chunk : Chunks) {
+    uint64_t ChunkStartBit = Stream.GetCurrentBitNo();
+    for (auto &FunctionIndex : Chunk.FunctionToBitcodeIndex)
+      FunctionToBitcodeIndex[FunctionIndex.first] =
+          ChunkStartBit + FunctionIndex.second;
+    Stream.EmitSplicedBlocks(
+        StringRef(Chunk.Buffer.data(), Chunk.Buffer.size()));
+  }
+}
+
 // Emit blockinfo, which defines the standard abbreviations etc.
 void ModuleBitcodeWriter::writeBlockInfo() {
   // We only want to emit block info records for blocks that have multiple
@@ -3659,7 +3760,7 @@ void ModuleBitcodeWriterBase::writePerModuleFunctionSummaryRecord(
   for (auto &ECI : FS->calls()) {
     NameVals.push_back(getValueId(ECI.first));
     if (HasProfileData)
-      NameVals.push_back(static_cast<uint8_t>(ECI.second.Hotness));
+      NameVals.push_back(getEncodedHotnessCallEdgeInfo(ECI.second));
     else if (WriteRelBFToSummary)
       NameVals.push_back(ECI.second.RelBlockFreq);
   }
@@ -4099,7 +4200,7 @@ void IndexBitcodeWriter::writeCombinedGlobalValueSummary() {
       }
       NameVals.push_back(*CallValueId);
       if (HasProfileData)
-        NameVals.push_back(static_cast<uint8_t>(EI.second.Hotness));
+        NameVals.push_back(getEncodedHotnessCallEdgeInfo(EI.second));
     }
 
     unsigned FSAbbrev = (HasProfileData ? FSCallsProfileAbbrev : FSCallsAbbrev);
@@ -4263,9 +4364,7 @@ void ModuleBitcodeWriter::write() {
 
   // Emit function bodies.
   DenseMap<const Function *, uint64_t> FunctionToBitcodeIndex;
-  for (Module::const_iterator F = M.begin(), E = M.end(); F != E; ++F)
-    if (!F->isDeclaration())
-      writeFunction(*F, FunctionToBitcodeIndex);
+  writeFunctionBlocks(FunctionToBitcodeIndex);
 
   // Need to write after the above call to WriteFunction which populates
   // the summary information in the index.
@@ -140,7 +140,9 @@ private:
 
 public:
   ValueEnumerator(const Module &M, bool ShouldPreserveUseListOrder);
-  ValueEnumerator(const ValueEnumerator &) = delete;
+  /// Copying is only used to encode function blocks in parallel, each copy
+  /// incorporating a different set of functions.
+  explicit ValueEnumerator(const ValueEnumerator &) = default;
   ValueEnumerator &operator=(const ValueEnumerator &) = delete;
 
   void dump() const;
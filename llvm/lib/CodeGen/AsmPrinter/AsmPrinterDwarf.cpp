@@ -11,6 +11,7 @@
 //===----------------------------------------------------------------------===//
 
 #include "ByteStreamer.h"
+#include "llvm/ADT/SmallString.h"
 #include "llvm/ADT/Twine.h"
 #include "llvm/BinaryFormat/Dwarf.h"
 #include "llvm/CodeGen/AsmPrinter.h"
@@ -25,6 +26,8 @@
 #include "llvm/MC/MCSymbol.h"
 #include "llvm/MC/MachineLocation.h"
 #include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/LEB128.h"
+#include "llvm/Support/raw_ostream.h"
 #include "llvm/Target/TargetLoweringObjectFile.h"
 #include "llvm/Target/TargetMachine.h"
 using namespace llvm;
@@ -249,7 +252,103 @@ void AsmPrinter::emitCFIInstruction(const MCCFIInstruction &Inst) const {
   }
 }
 
+/// Appends the encoding of \p V to \p Buffer, the way DIEValue::EmitValue()
+/// would emit it. Returns false, without appending anything, for values that
+/// refer to symbols or need the streamer for another reason.
+static bool encodeDIEValue(const AsmPrinter &AP, const DIEValue &V,
+                           SmallVectorImpl<char> &Buffer) {
+  uint64_t Value;
+  switch (V.getType()) {
+  case DIEValue::isInteger:
+    Value = V.getDIEInteger().getValue();
+    break;
+  case DIEValue::isEntry:
+    if (V.getForm() == dwarf::DW_FORM_ref_addr)
+      return false;
+    Value = V.getDIEEntry().getEntry().getOffset();
+    break;
+  case DIEValue::isInlineString: {
+    StringRef S = V.getDIEInlineString().getString();
+    Buffer.append(S.begin(), S.end());
+    Buffer.push_back(0);
+    return true;
+  }
+  default:
+    return false;
+  }
+
+  raw_svector_ostream OS(Buffer);
+  switch (V.getForm()) {
+  case dwarf::DW_FORM_implicit_const:
+  case dwarf::DW_FORM_flag_present:
+    return true;
+  case dwarf::DW_FORM_GNU_str_index:
+  case dwarf::DW_FORM_GNU_addr_index:
+  case dwarf::DW_FORM_ref_udata:
+  case dwarf::DW_FORM_strx:
+  case dwarf::DW_FORM_addrx:
+  case dwarf::DW_FORM_rnglistx:
+  case dwarf::DW_FORM_udata:
+    encodeULEB128(Value, OS);
+    return true;
+  case dwarf::DW_FORM_sdata:
+    encodeSLEB128(int64_t(Value), OS);
+    return true;
+  default: {
+    unsigned Size = V.SizeOf(&AP);
+    bool IsLittleEndian = AP.MAI->isLittleEndian();
+    for (unsigned I = 0; I != Size; ++I) {
+      unsigned Shift = 8 * (IsLittleEndian ? I : Size - 1 - I);
+      Buffer.push_back(char(Value >> Shift));
+    }
+    return true;
+  }
+  }
+}
+
+/// Emits \p Die and its children, collecting the bytes of all values that
+/// don't refer to symbols in \p Buffer instead of handing every value to the
+/// streamer separately.
+static void emitDwarfDIEBytes(const AsmPrinter &AP, const DIE &Die,
+                              SmallVectorImpl<char> &Buffer) {
+  auto Flush = [&]() {
+    AP.OutStreamer->EmitBytes(StringRef(Buffer.data(), Buffer.size()));
+    Buffer.clear();
+  };
+  if (Buffer.size() >= 4096)
+    Flush();
+
+  {
+    raw_svector_ostream OS(Buffer);
+    encodeULEB128(Die.getAbbrevNumber(), OS);
+  }
+  for (const auto &V : Die.values()) {
+    assert(V.getForm() && "Too many attributes for DIE (check abbreviation)");
+    if (encodeDIEValue(AP, V, Buffer))
+      continue;
+    Flush();
+    V.EmitValue(&AP);
+  }
+
+  if (Die.hasChildren()) {
+    for (auto &Child : Die.children())
+      emitDwarfDIEBytes(AP, Child, Buffer);
+    // End of children mark.
+    Buffer.push_back(0);
+  }
+}
+
 void AsmPrinter::emitDwarfDIE(const DIE &Die) const {
+  // Without comments there is no need to emit the values one at a time.
+  // Emitting the DIE tree as a few blocks of bytes saves a lot of streamer
+  // calls and fragment bookkeeping for large units.
+  if (!isVerbose() && !OutStreamer->hasRawTextSupport()) {
+    SmallString<256> Buffer;
+    emitDwarfDIEBytes(*this, Die, Buffer);
+    OutStreamer->EmitBytes(Buffer);
+    return;
+  }
+
   // Emit the code (index) for the abbreviation.
   if (isVerbose())
     OutStreamer->AddComment("Abbrev [" + Twine(Die.getAbbrevNumber()) + "] 0x" +
@@ -24,7 +24,9 @@
 #include "llvm/ADT/DenseSet.h"
 #include "llvm/ADT/MapVector.h"
 #include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallString.h"
 #include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringExtras.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/ADT/Statistic.h"
 #include "llvm/ADT/Triple.h"
@@ -65,8 +67,11 @@
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/FileSystem.h"
 #include "llvm/Support/MD5.h"
 #include "llvm/Support/MathExtras.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
 #include "llvm/Support/Timer.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Target/TargetLoweringObjectFile.h"
@@ -105,6 +110,13 @@ static cl::opt<bool>
                            cl::desc("Generate DWARF4 type units."),
                            cl::init(false));
 
+static cl::opt<std::string> SplitDwarfTypeCache(
+    "split-dwarf-type-cache", cl::Hidden,
+    cl::desc("Directory, shared by all compilations of a build, in which split "
+             "DWARF type units are claimed by signature, so that every type "
+             "unit is emitted into a single .dwo file of the build"),
+    cl::value_desc("directory"));
+
 static cl::opt<bool> SplitDwarfCrossCuReferences(
     "split-dwarf-cross-cu-references", cl::Hidden,
     cl::desc("Enable cross-cu references in DWO files"), cl::init(false));
@@ -2845,6 +2857,37 @@ uint64_t DwarfDebug::makeTypeSignature(StringRef Identifier) {
   return Result.high();
 }
 
+/// Returns the path of the file in the type cache that names the .dwo file
+/// holding the type unit with \p Signature.
+static SmallString<128> getTypeCachePath(uint64_t Signature) {
+  SmallString<128> Path(SplitDwarfTypeCache);
+  sys::path::append(Path, utohexstr(Signature, /*LowerCase=*/true));
+  return Path;
+}
+
+/// Returns true if another .dwo file than \p DWOName holds the type unit
+/// with \p Signature. A claim that is still being written counts as well.
+static bool isTypeUnitInOtherDWO(uint64_t Signature, StringRef DWOName) {
+  auto Owner = MemoryBuffer::getFile(getTypeCachePath(Signature));
+  return Owner && (*Owner)->getBuffer() != DWOName;
+}
+
+/// Records in the type cache that \p DWOName holds the type unit with
+/// \p Signature. Returns false if another .dwo file claimed it first. If the
+/// cache can't be written, the type unit is emitted anyway.
+static bool claimTypeUnit(uint64_t Signature, StringRef DWOName) {
+  int FD;
+  std::error_code EC = sys::fs::openFileForWrite(
+      getTypeCachePath(Signature), FD, sys::fs::CD_CreateNew);
+  if (EC == std::errc::file_exists)
+    return !isTypeUnitInOtherDWO(Signature, DWOName);
+  if (EC)
+    return true;
+  raw_fd_ostream OS(FD, /*shouldClose=*/true);
+  OS << DWOName;
+  return true;
+}
+
 void DwarfDebug::addDwarfTypeUnitType(DwarfCompileUnit &CU,
                                       StringRef Identifier, DIE &RefDie,
                                       const DICompositeType *CTy) {
@@ -2860,6 +2903,17 @@ void DwarfDebug::addDwarfTypeUnitType(DwarfCompileUnit &CU,
     return;
   }
 
+  // With a type cache, a type unit that another .dwo file of the build holds
+  // only needs to be referenced. llvm-dwp puts all of them into the package.
+  uint64_t Signature = makeTypeSignature(Identifier);
+  bool UseTypeCache = useSplitDwarf() && !SplitDwarfTypeCache.empty();
+  StringRef DWOName = Asm->TM.Options.MCOptions.SplitDwarfFile;
+  if (UseTypeCache && isTypeUnitInOtherDWO(Signature, DWOName)) {
+    Ins.first->second = Signature;
+    CU.addDIETypeSignature(RefDie, Signature);
+    return;
+  }
+
   bool TopLevelType = TypeUnitsUnderConstruction.empty();
   AddrPool.resetUsedFlag();
 
@@ -2872,7 +2926,6 @@ void DwarfDebug::addDwarfTypeUnitType(DwarfCompileUnit &CU,
   NewTU.addUInt(UnitDie, dwarf::DW_AT_language, dwarf::DW_FORM_data2,
                 CU.getLanguage());
 
-  uint64_t Signature = makeTypeSignature(Identifier);
   NewTU.setTypeSignature(Signature);
   Ins.first->second = Signature;
 
@@ -2924,6 +2977,10 @@ void DwarfDebug::addDwarfTypeUnitType(DwarfCompileUnit &CU,
     // If the type wasn't dependent on fission addresses, finish adding the type
     // and all its dependent types.
     for (auto &TU : TypeUnitsToAdd) {
+      // Another compilation may have claimed the type since it was looked up.
+      if (UseTypeCache &&
+          !claimTypeUnit(TypeSignatures.lookup(TU.second), DWOName))
+        continue;
       InfoHolder.computeSizeAndOffsetsForUnit(TU.first.get());
       InfoHolder.emitUnit(TU.first.get(), useSplitDwarf());
     }
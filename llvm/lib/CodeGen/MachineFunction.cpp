@@ -16,9 +16,11 @@
 #include "llvm/ADT/BitVector.h"
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/DenseSet.h"
+#include "llvm/ADT/Hashing.h"
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/SmallString.h"
 #include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/Statistic.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/ADT/Twine.h"
 #include "llvm/Analysis/ConstantFolding.h"
@@ -84,6 +86,18 @@ static cl::opt<unsigned> AlignAllFunctions(
              "means align on 16B boundaries)."),
     cl::init(0), cl::Hidden);
 
+// Memory operands are uniqued by value, so this may only be enabled for
+// targets which don't update a memory operand in place when it may be shared
+// (with setOffset, setValue or setFlags) in ways the other users disagree
+// with.
+static cl::opt<bool> UniqueMemOperands(
+    "unique-machine-memoperands", cl::Hidden, cl::init(false),
+    cl::desc("Share equal MachineMemOperands within a function instead of "
+             "allocating each of them"));
+
+STATISTIC(NumMemOperands, "Number of MachineMemOperands allocated");
+STATISTIC(NumMemOperandsReused, "Number of MachineMemOperands reused");
+
 static const char *getPropertyName(MachineFunctionProperties::Property Prop) {
   using P = MachineFunctionProperties::Property;
 
@@ -224,6 +238,7 @@ void MachineFunction::clear() {
   BasicBlockRecycler.clear(Allocator);
   CodeViewAnnotations.clear();
   VariableDbgInfos.clear();
+  MemOperandPool.clear();
   if (RegInfo) {
     RegInfo->~MachineRegisterInfo();
     Allocator.Deallocate(RegInfo);
@@ -397,14 +412,66 @@ MachineFunction::DeleteMachineBasicBlock(MachineBasicBlock *MBB) {
   BasicBlockRecycler.Deallocate(Allocator, MBB);
 }
 
+unsigned
+MachineFunction::MemOperandInfo::getHashValue(const MachineMemOperand *MMO) {
+  const MachinePointerInfo &PtrInfo = MMO->getPointerInfo();
+  const AAMDNodes &AAInfo = MMO->getAAInfo();
+  return hash_combine(PtrInfo.V.getOpaqueValue(), PtrInfo.Offset,
+                      PtrInfo.StackID, PtrInfo.AddrSpace, MMO->getSize(),
+                      MMO->getFlags(), MMO->getBaseAlignment(), AAInfo.TBAA,
+                      AAInfo.Scope, AAInfo.NoAlias, MMO->getRanges(),
+                      MMO->getSyncScopeID(), MMO->getOrdering(),
+                      MMO->getFailureOrdering());
+}
+
+bool MachineFunction::MemOperandInfo::isEqual(const MachineMemOperand *LHS,
+                                              const MachineMemOperand *RHS) {
+  if (LHS == RHS)
+    return true;
+  if (LHS == getEmptyKey() || LHS == getTombstoneKey() ||
+      RHS == getEmptyKey() || RHS == getTombstoneKey())
+    return false;
+  const MachinePointerInfo &L = LHS->getPointerInfo();
+  const MachinePointerInfo &R = RHS->getPointerInfo();
+  return L.V == R.V && L.Offset == R.Offset && L.StackID == R.StackID &&
+         L.AddrSpace == R.AddrSpace && LHS->getSize() == RHS->getSize() &&
+         LHS->getFlags() == RHS->getFlags() &&
+         LHS->getBaseAlignment() == RHS->getBaseAlignment() &&
+         LHS->getAAInfo() == RHS->getAAInfo() &&
+         LHS->getRanges() == RHS->getRanges() &&
+         LHS->getSyncScopeID() == RHS->getSyncScopeID() &&
+         LHS->getOrdering() == RHS->getOrdering() &&
+         LHS->getFailureOrdering() == RHS->getFailureOrdering();
+}
+
+MachineMemOperand *
+MachineFunction::getOrCreateMemOperand(const MachineMemOperand &MMO) {
+  if (!UniqueMemOperands) {
+    ++NumMemOperands;
+    return new (Allocator) MachineMemOperand(MMO);
+  }
+
+  // A shared memory operand updated in place is hashed by its old fields,
+  // which at worst keeps it from being found again.
+  auto I = MemOperandPool.find(const_cast<MachineMemOperand *>(&MMO));
+  if (I != MemOperandPool.end()) {
+    ++NumMemOperandsReused;
+    return *I;
+  }
+  ++NumMemOperands;
+  MachineMemOperand *New = new (Allocator) MachineMemOperand(MMO);
+  MemOperandPool.insert(New);
+  return New;
+}
+
 MachineMemOperand *MachineFunction::getMachineMemOperand(
     MachinePointerInfo PtrInfo, MachineMemOperand::Flags f, uint64_t s,
     unsigned base_alignment, const AAMDNodes &AAInfo, const MDNode *Ranges,
     SyncScope::ID SSID, AtomicOrdering Ordering,
     AtomicOrdering FailureOrdering) {
-  return new (Allocator)
+  return getOrCreateMemOperand(
       MachineMemOperand(PtrInfo, f, s, base_alignment, AAInfo, Ranges,
-                        SSID, Ordering, FailureOrdering);
+                        SSID, Ordering, FailureOrdering));
 }
 
 MachineMemOperand *
@@ -418,10 +485,10 @@ MachineFunction::getMachineMemOperand(const MachineMemOperand *MMO,
                        ? MinAlign(MMO->getBaseAlignment(), Offset)
                        : MMO->getBaseAlignment();
 
-  return new (Allocator)
+  return getOrCreateMemOperand(
       MachineMemOperand(PtrInfo.getWithOffset(Offset), MMO->getFlags(), Size,
                         Align, AAMDNodes(), nullptr, MMO->getSyncScopeID(),
-                        MMO->getOrdering(), MMO->getFailureOrdering());
+                        MMO->getOrdering(), MMO->getFailureOrdering()));
 }
 
 MachineMemOperand *
@@ -431,20 +498,20 @@ MachineFunction::getMachineMemOperand(const MachineMemOperand *MMO,
              MachinePointerInfo(MMO->getValue(), MMO->getOffset()) :
              MachinePointerInfo(MMO->getPseudoValue(), MMO->getOffset());
 
-  return new (Allocator)
+  return getOrCreateMemOperand(
              MachineMemOperand(MPI, MMO->getFlags(), MMO->getSize(),
                                MMO->getBaseAlignment(), AAInfo,
                                MMO->getRanges(), MMO->getSyncScopeID(),
-                               MMO->getOrdering(), MMO->getFailureOrdering());
+                               MMO->getOrdering(), MMO->getFailureOrdering()));
 }
 
 MachineMemOperand *
 MachineFunction::getMachineMemOperand(const MachineMemOperand *MMO,
                                       MachineMemOperand::Flags Flags) {
-  return new (Allocator) MachineMemOperand(
+  return getOrCreateMemOperand(MachineMemOperand(
       MMO->getPointerInfo(), Flags, MMO->getSize(), MMO->getBaseAlignment(),
       MMO->getAAInfo(), MMO->getRanges(), MMO->getSyncScopeID(),
-      MMO->getOrdering(), MMO->getFailureOrdering());
+      MMO->getOrdering(), MMO->getFailureOrdering()));
 }
 
 MachineInstr::ExtraInfo *
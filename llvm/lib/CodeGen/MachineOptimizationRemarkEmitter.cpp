@@ -17,6 +17,7 @@
 #include "llvm/CodeGen/MachineInstr.h"
 #include "llvm/IR/DiagnosticInfo.h"
 #include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/RemarkStreamer.h"
 
 using namespace llvm;
 
@@ -45,6 +46,16 @@ void MachineOptimizationRemarkEmitter::computeHotness(
     Remark.setHotness(computeHotness(*MBB));
 }
 
+bool MachineOptimizationRemarkEmitter::allowExtraAnalysis(
+    StringRef PassName) const {
+  // Remarks that the streamer would filter out are not worth the analysis.
+  LLVMContext &Ctx = MF.getFunction().getContext();
+  if (RemarkStreamer *RS = Ctx.getRemarkStreamer())
+    if (RS->matchesFilter(PassName))
+      return true;
+  return Ctx.getDiagHandlerPtr()->isAnyRemarkEnabled(PassName);
+}
+
 void MachineOptimizationRemarkEmitter::emit(
     DiagnosticInfoOptimizationBase &OptDiagCommon) {
   auto &OptDiag = cast<DiagnosticInfoMIROptimization>(OptDiagCommon);
@@ -58,6 +58,7 @@
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/Statistic.h"
 #include "llvm/ADT/Twine.h"
+#include "llvm/Analysis/ProfileSummaryInfo.h"
 #include "llvm/CodeGen/MachineFunction.h"
 #include "llvm/CodeGen/MachineModuleInfo.h"
 #include "llvm/CodeGen/MachineOptimizationRemarkEmitter.h"
@@ -96,6 +97,20 @@ static cl::opt<bool> EnableLinkOnceODROutlining(
     cl::desc("Enable the machine outliner on linkonceodr functions"),
     cl::init(false));
 
+// Outlining can expose new repeated sequences, such as sequences containing
+// the calls to outlined functions, so the outliner may run several rounds.
+static cl::opt<unsigned> OutlinerReruns(
+    "machine-outliner-reruns", cl::init(0), cl::Hidden,
+    cl::desc(
+        "Number of times to rerun the outliner after the initial outline"));
+
+// Calls to outlined functions slow down hot code, so with a profile the
+// outliner leaves the functions with a hot entry alone by default.
+static cl::opt<bool> OutlineHotFunctions(
+    "machine-outliner-hot-functions", cl::Hidden,
+    cl::desc("Outline from functions the profile shows are hot"),
+    cl::init(false));
+
 namespace {
 
 /// Represents an undefined index in the suffix tree.
@@ -843,10 +858,14 @@ struct MachineOutliner : public ModulePass {
   /// Set when the pass is constructed in TargetPassConfig.
   bool RunOnAllFunctions = true;
 
+  /// The profile summary of the module, used to leave hot functions alone.
+  ProfileSummaryInfo *PSI = nullptr;
+
   StringRef getPassName() const override { return "Machine Outliner"; }
 
   void getAnalysisUsage(AnalysisUsage &AU) const override {
     AU.addRequired<MachineModuleInfoWrapperPass>();
+    AU.addRequired<ProfileSummaryInfoWrapperPass>();
     AU.addPreserved<MachineModuleInfoWrapperPass>();
     AU.setPreservesAll();
     ModulePass::getAnalysisUsage(AU);
@@ -887,8 +906,10 @@ struct MachineOutliner : public ModulePass {
   /// \param M The module we are outlining from.
   /// \param FunctionList A list of functions to be inserted into the module.
   /// \param Mapper Contains the instruction mappings for the module.
+  /// \param[in,out] OutlinedFunctionNum The number of the next outlined
+  /// function, used to name it.
   bool outline(Module &M, std::vector<OutlinedFunction> &FunctionList,
-               InstructionMapper &Mapper);
+               InstructionMapper &Mapper, unsigned &OutlinedFunctionNum);
 
   /// Creates a function for \p OF and inserts it into the module.
   MachineFunction *createOutlinedFunction(Module &M, OutlinedFunction &OF,
@@ -899,6 +920,12 @@ struct MachineOutliner : public ModulePass {
   /// strings from that tree.
   bool runOnModule(Module &M) override;
 
+  /// Run one round of outlining on \p M, numbering the outlined functions
+  /// from \p OutlinedFunctionNum on.
+  ///
+  /// \returns true if something was outlined.
+  bool doOutline(Module &M, unsigned &OutlinedFunctionNum);
+
   /// Return a DISubprogram for OF if one exists, and null otherwise. Helper
   /// function for remark emission.
   DISubprogram *getSubprogramOrNull(const OutlinedFunction &OF) {
@@ -941,8 +968,11 @@ ModulePass *createMachineOutlinerPass(bool RunOnAllFunctions) {
 
 } // namespace llvm
 
-INITIALIZE_PASS(MachineOutliner, DEBUG_TYPE, "Machine Function Outliner", false,
-                false)
+INITIALIZE_PASS_BEGIN(MachineOutliner, DEBUG_TYPE, "Machine Function Outliner",
+                      false, false)
+INITIALIZE_PASS_DEPENDENCY(ProfileSummaryInfoWrapperPass)
+INITIALIZE_PASS_END(MachineOutliner, DEBUG_TYPE, "Machine Function Outliner",
+                    false, false)
 
 void MachineOutliner::emitNotOutliningCheaperRemark(
     unsigned StringLen, std::vector<Candidate> &CandidatesForRepeatedSeq,
@@ -1016,6 +1046,9 @@ MachineOutliner::findCandidates(InstructionMapper &Mapper,
     CandidatesForRepeatedSeq.clear();
     SuffixTree::RepeatedSubstring RS = *It;
     unsigned StringLen = RS.Length;
+    // Visit the occurrences in order, so that a new one can only overlap with
+    // the last one saved.
+    llvm::sort(RS.StartIndices);
     for (const unsigned &StartIdx : RS.StartIndices) {
       unsigned EndIdx = StartIdx + StringLen - 1;
       // Trick: Discard some candidates that would be incompatible with the
@@ -1039,11 +1072,11 @@ MachineOutliner::findCandidates(InstructionMapper &Mapper,
       // That is, one must either
       // * End before the other starts
       // * Start after the other ends
-      if (std::all_of(
-              CandidatesForRepeatedSeq.begin(), CandidatesForRepeatedSeq.end(),
-              [&StartIdx, &EndIdx](const Candidate &C) {
-                return (EndIdx < C.getStartIdx() || StartIdx > C.getEndIdx());
-              })) {
+      //
+      // As the occurrences are sorted by their start, it is enough to check
+      // that this one starts after the last saved one ends.
+      if (CandidatesForRepeatedSeq.empty() ||
+          StartIdx > CandidatesForRepeatedSeq.back().getEndIdx()) {
         // It doesn't overlap with anything, so we can outline it.
         // Each sequence is over [StartIt, EndIt].
         // Save the candidate and its location.
@@ -1190,13 +1223,11 @@ MachineOutliner::createOutlinedFunction(Module &M, OutlinedFunction &OF,
 
 bool MachineOutliner::outline(Module &M,
                               std::vector<OutlinedFunction> &FunctionList,
-                              InstructionMapper &Mapper) {
+                              InstructionMapper &Mapper,
+                              unsigned &OutlinedFunctionNum) {
 
   bool OutlinedSomething = false;
 
-  // Number to append to the current outlined function.
-  unsigned OutlinedFunctionNum = 0;
-
   // Sort by benefit. The most beneficial functions should be outlined first.
   llvm::stable_sort(FunctionList, [](const OutlinedFunction &LHS,
                                      const OutlinedFunction &RHS) {
@@ -1323,6 +1354,11 @@ void MachineOutliner::populateMapper(InstructionMapper &Mapper, Module &M,
     if (!RunOnAllFunctions && !TII->shouldOutlineFromFunctionByDefault(*MF))
       continue;
 
+    // Calls to outlined functions would slow down a function the profile
+    // shows is hot.
+    if (!OutlineHotFunctions && PSI->isFunctionEntryHot(&F))
+      continue;
+
     // We have a MachineFunction. Ask the target if it's suitable for outlining.
     // If it isn't, then move on to the next Function in the module.
     if (!TII->isFunctionSafeToOutlineFrom(*MF, OutlineFromLinkOnceODRs))
@@ -1427,8 +1463,6 @@ bool MachineOutliner::runOnModule(Module &M) {
   if (M.empty())
     return false;
 
-  MachineModuleInfo &MMI = getAnalysis<MachineModuleInfoWrapperPass>().getMMI();
-
   // If the user passed -enable-machine-outliner=always or
   // -enable-machine-outliner, the pass will run on all functions in the module.
   // Otherwise, if the target supports default outlining, it will run on all
@@ -1446,6 +1480,25 @@ bool MachineOutliner::runOnModule(Module &M) {
   // If the user specifies that they want to outline from linkonceodrs, set
   // it here.
   OutlineFromLinkOnceODRs = EnableLinkOnceODROutlining;
+  PSI = &getAnalysis<ProfileSummaryInfoWrapperPass>().getPSI();
+
+  // Number to append to the current outlined function.
+  unsigned OutlinedFunctionNum = 0;
+
+  // Each round builds a new suffix tree on the instructions left after the
+  // previous one. Stop as soon as a round doesn't find anything to outline.
+  bool Changed = false;
+  for (unsigned Round = 0; Round <= OutlinerReruns; ++Round) {
+    LLVM_DEBUG(dbgs() << "Machine Outliner: Round " << Round << "\n");
+    if (!doOutline(M, OutlinedFunctionNum))
+      break;
+    Changed = true;
+  }
+  return Changed;
+}
+
+bool MachineOutliner::doOutline(Module &M, unsigned &OutlinedFunctionNum) {
+  MachineModuleInfo &MMI = getAnalysis<MachineModuleInfoWrapperPass>().getMMI();
   InstructionMapper Mapper;
 
   // Prepare instruction mappings for the suffix tree.
@@ -1470,7 +1523,8 @@ bool MachineOutliner::runOnModule(Module &M) {
     initSizeRemarkInfo(M, MMI, FunctionToInstrCount);
 
   // Outline each of the candidates and return true if something was outlined.
-  bool OutlinedSomething = outline(M, FunctionList, Mapper);
+  bool OutlinedSomething =
+      outline(M, FunctionList, Mapper, OutlinedFunctionNum);
 
   // If we outlined something, we definitely changed the MI count of the
   // module. If we've asked for size remarks, then output them.
@@ -18,6 +18,7 @@
 #include "llvm/ADT/PriorityQueue.h"
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/Statistic.h"
 #include "llvm/ADT/iterator_range.h"
 #include "llvm/Analysis/AliasAnalysis.h"
 #include "llvm/CodeGen/LiveInterval.h"
@@ -72,6 +73,8 @@ using namespace llvm;
 
 #define DEBUG_TYPE "machine-scheduler"
 
+STATISTIC(NumRegionsSplit, "Number of scheduling regions split for size");
+
 namespace llvm {
 
 cl::opt<bool> ForceTopDown("misched-topdown", cl::Hidden,
@@ -122,6 +125,12 @@ static cl::opt<bool> EnableRegPressure("misched-regpressure", cl::Hidden,
 static cl::opt<bool> EnableCyclicPath("misched-cyclicpath", cl::Hidden,
   cl::desc("Enable cyclic critical path analysis."), cl::init(true));
 
+static cl::opt<unsigned> MaxRegionInstrs(
+    "misched-max-region-size", cl::Hidden,
+    cl::desc("Split scheduling regions with more than N instructions, as "
+             "building their DAGs costs quadratic time (0 = no limit)"),
+    cl::init(0));
+
 static cl::opt<bool> EnableMemOpCluster("misched-cluster", cl::Hidden,
                                         cl::desc("Enable memop clustering."),
                                         cl::init(true));
@@ -482,12 +491,21 @@ getSchedRegions(MachineBasicBlock *MBB,
 
     // The next region starts above the previous region. Look backward in the
     // instruction stream until we find the nearest boundary.
+    //
+    // Past -misched-max-region-size instructions, end the region early. The
+    // instruction above it then ends the next region, and stays in place like
+    // any other boundary.
     unsigned NumRegionInstrs = 0;
     I = RegionEnd;
     for (;I != MBB->begin(); --I) {
       MachineInstr &MI = *std::prev(I);
       if (isSchedBoundary(&MI, &*MBB, MF, TII))
         break;
+      if (MaxRegionInstrs && NumRegionInstrs == MaxRegionInstrs &&
+          !MI.isDebugInstr()) {
+        ++NumRegionsSplit;
+        break;
+      }
       if (!MI.isDebugInstr()) {
         // MBB::size() uses instr_iterator to count. Here we need a bundle to
         // count as a single instruction.
@@ -72,6 +72,7 @@
 #include <algorithm>
 #include <cassert>
 #include <cstdint>
+#include <limits>
 #include <memory>
 #include <queue>
 #include <tuple>
@@ -84,6 +85,12 @@ using namespace llvm;
 STATISTIC(NumGlobalSplits, "Number of split global live ranges");
 STATISTIC(NumLocalSplits,  "Number of split local live ranges");
 STATISTIC(NumEvicted,      "Number of interferences evicted");
+STATISTIC(NumEvictionChecks, "Number of eviction candidates checked");
+STATISTIC(NumSplitCandidates, "Number of region split candidates checked");
+STATISTIC(NumRegionBlocks, "Number of blocks added to split regions");
+STATISTIC(NumLocalSplitGaps, "Number of gaps checked by local splitting");
+STATISTIC(NumOverBudget,   "Number of functions over the work budget");
+STATISTIC(NumSplitsSkipped, "Number of splits skipped over the work budget");
 
 static cl::opt<SplitEditor::ComplementSpillMode> SplitSpillMode(
     "split-spill-mode", cl::Hidden,
@@ -130,6 +137,18 @@ static cl::opt<unsigned>
                               "high compile time cost in global splitting."),
                      cl::init(5000));
 
+static cl::opt<unsigned> WorkBudgetPerInstr(
+    "regalloc-work-budget-per-instr", cl::Hidden,
+    cl::desc("Work the greedy allocator may spend on splitting and eviction "
+             "per instruction before falling back to cheaper strategies "
+             "(0 = unlimited)"),
+    cl::init(2000));
+
+static cl::opt<unsigned> MinWorkBudget(
+    "regalloc-min-work-budget", cl::Hidden,
+    cl::desc("Work budget of the greedy allocator for small functions"),
+    cl::init(1000000));
+
 // FIXME: Find a good default for this flag and remove the flag.
 static cl::opt<unsigned>
 CSRFirstTimeCost("regalloc-csr-first-time-cost",
@@ -411,6 +430,13 @@ class RAGreedy : public MachineFunctionPass,
   /// Set of broken hints that may be reconciled later because of eviction.
   SmallSetVector<LiveInterval *, 8> SetOfBrokenHints;
 
+  /// Work done so far on this function, in blocks and candidates visited by
+  /// splitting and eviction, and the budget for it. Past the budget, region
+  /// and local splitting are skipped, so that huge functions degrade to block
+  /// and instruction splitting instead of going superlinear.
+  uint64_t WorkDone;
+  uint64_t WorkBudget;
+
 public:
   RAGreedy();
 
@@ -437,6 +463,10 @@ public:
   static char ID;
 
 private:
+  /// Account for Units of work, reporting when the budget runs out.
+  void chargeWork(uint64_t Units);
+  bool isOverBudget() const { return WorkDone > WorkBudget; }
+
   unsigned selectOrSplitImpl(LiveInterval &, SmallVectorImpl<unsigned> &,
                              SmallVirtRegSet &, unsigned = 0);
 
@@ -1155,6 +1185,8 @@ unsigned RAGreedy::tryEvict(LiveInterval &VirtReg,
       continue;
     }
 
+    ++NumEvictionChecks;
+    chargeWork(1);
     if (!canEvictInterference(VirtReg, PhysReg, false, BestCost,
                               FixedRegisters))
       continue;
@@ -1333,6 +1365,7 @@ bool RAGreedy::growRegion(GlobalSplitCandidate &Cand) {
         Todo.reset(Block);
         // This is a new through block. Add it to SpillPlacer later.
         ActiveBlocks.push_back(Block);
+        ++NumRegionBlocks;
 #ifndef NDEBUG
         ++Visited;
 #endif
@@ -1342,6 +1375,12 @@ bool RAGreedy::growRegion(GlobalSplitCandidate &Cand) {
     if (ActiveBlocks.size() == AddedTo)
       break;
 
+    // Give up on the region once the budget is exhausted; the caller falls
+    // back to cheaper splitting.
+    chargeWork(ActiveBlocks.size() - AddedTo);
+    if (isOverBudget())
+      return false;
+
     // Compute through constraints from the interference, or assume that all
     // through blocks prefer spilling when forming compact regions.
     auto NewBlocks = makeArrayRef(ActiveBlocks).slice(AddedTo);
@@ -1879,6 +1918,10 @@ unsigned RAGreedy::calculateRegionSplitCost(LiveInterval &VirtReg,
   while (unsigned PhysReg = Order.next()) {
     if (IgnoreCSR && isUnusedCalleeSavedReg(PhysReg))
       continue;
+    if (isOverBudget())
+      break;
+    ++NumSplitCandidates;
+    chargeWork(1);
 
     // Discard bad candidates before we run out of interference cache cursors.
     // This will only affect register classes with a lot of registers (>32).
@@ -2317,6 +2360,9 @@ unsigned RAGreedy::tryLocalSplit(LiveInterval &VirtReg, AllocationOrder &Order,
 
   Order.rewind();
   while (unsigned PhysReg = Order.next()) {
+    NumLocalSplitGaps += NumGaps;
+    chargeWork(NumGaps);
+
     // Keep track of the largest spill weight that would need to be evicted in
     // order to make use of PhysReg between UseSlots[i] and UseSlots[i+1].
     calcGapWeights(PhysReg, GapWeight);
@@ -2469,9 +2515,15 @@ unsigned RAGreedy::trySplit(LiveInterval &VirtReg, AllocationOrder &Order,
     NamedRegionTimer T("local_split", "Local Splitting", TimerGroupName,
                        TimerGroupDescription, TimePassesIsEnabled);
     SA->analyze(&VirtReg);
-    unsigned PhysReg = tryLocalSplit(VirtReg, Order, NewVRegs);
-    if (PhysReg || !NewVRegs.empty())
-      return PhysReg;
+    // Local splitting is quadratic in the number of uses, skip it when over
+    // the budget.
+    if (isOverBudget()) {
+      ++NumSplitsSkipped;
+    } else {
+      unsigned PhysReg = tryLocalSplit(VirtReg, Order, NewVRegs);
+      if (PhysReg || !NewVRegs.empty())
+        return PhysReg;
+    }
     return tryInstructionSplit(VirtReg, Order, NewVRegs);
   }
 
@@ -2493,8 +2545,11 @@ unsigned RAGreedy::trySplit(LiveInterval &VirtReg, AllocationOrder &Order,
 
   // First try to split around a region spanning multiple blocks. RS_Split2
   // ranges already made dubious progress with region splitting, so they go
-  // straight to single block splitting.
-  if (getStage(VirtReg) < RS_Split2) {
+  // straight to single block splitting, as do all ranges once the function is
+  // over its work budget.
+  if (getStage(VirtReg) < RS_Split2 && isOverBudget())
+    ++NumSplitsSkipped;
+  else if (getStage(VirtReg) < RS_Split2) {
     unsigned PhysReg = tryRegionSplit(VirtReg, Order, NewVRegs);
     if (PhysReg || !NewVRegs.empty())
       return PhysReg;
@@ -3135,6 +3190,25 @@ unsigned RAGreedy::selectOrSplitImpl(LiveInterval &VirtReg,
   return 0;
 }
 
+void RAGreedy::chargeWork(uint64_t Units) {
+  bool WasOverBudget = isOverBudget();
+  WorkDone += Units;
+  if (WasOverBudget || !isOverBudget())
+    return;
+
+  ++NumOverBudget;
+  LLVM_DEBUG(dbgs() << "Work budget of " << WorkBudget
+                    << " exhausted, skipping region and local splitting\n");
+  ORE->emit([&]() {
+    return MachineOptimizationRemarkAnalysis(DEBUG_TYPE, "WorkBudgetExceeded",
+                                            DiagnosticLocation(),
+                                            &MF->front())
+           << "register allocation exceeded its work budget of "
+           << ore::NV("WorkBudget", WorkBudget)
+           << "; skipping region and local splitting";
+  });
+}
+
 void RAGreedy::reportNumberOfSplillsReloads(MachineLoop *L, unsigned &Reloads,
                                             unsigned &FoldedReloads,
                                             unsigned &Spills,
@@ -3256,6 +3330,16 @@ bool RAGreedy::runOnMachineFunction(MachineFunction &mf) {
   SetOfBrokenHints.clear();
   LastEvicted.clear();
 
+  WorkDone = 0;
+  WorkBudget = std::numeric_limits<uint64_t>::max();
+  if (WorkBudgetPerInstr) {
+    uint64_t NumInstrs = 0;
+    for (const MachineBasicBlock &MBB : *MF)
+      NumInstrs += MBB.size();
+    WorkBudget = std::max<uint64_t>(MinWorkBudget,
+                                    NumInstrs * WorkBudgetPerInstr);
+  }
+
   allocatePhysRegs();
   tryHintsRecoloring();
   postOptimization();
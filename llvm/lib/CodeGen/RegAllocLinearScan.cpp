@@ -0,0 +1,394 @@
+//===-- RegAllocLinearScan.cpp - Linear Scan Register Allocator -----------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// This file defines the RALinearScan function pass, a register allocator that
+// sits between the fast and the greedy allocators in compile time and code
+// quality.
+//
+// Live intervals are assigned in the order of their start, as in a linear scan
+// allocator, using the interference checks of LiveRegMatrix. When no register
+// is free, the allocator spills the cheapest set of lighter interfering
+// intervals. Failing that, a global interval is split around the blocks that
+// use it, and only the remainder is spilled. Unlike the greedy allocator,
+// nothing is evicted back into the queue and no region splitting is tried, so
+// each interval is visited a bounded number of times.
+//
+//===----------------------------------------------------------------------===//
+
+#include "AllocationOrder.h"
+#include "LiveDebugVariables.h"
+#include "RegAllocBase.h"
+#include "Spiller.h"
+#include "SplitKit.h"
+#include "llvm/ADT/BitVector.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/Analysis/AliasAnalysis.h"
+#include "llvm/CodeGen/CalcSpillWeights.h"
+#include "llvm/CodeGen/LiveIntervals.h"
+#include "llvm/CodeGen/LiveRangeEdit.h"
+#include "llvm/CodeGen/LiveRegMatrix.h"
+#include "llvm/CodeGen/LiveStacks.h"
+#include "llvm/CodeGen/MachineBlockFrequencyInfo.h"
+#include "llvm/CodeGen/MachineDominators.h"
+#include "llvm/CodeGen/MachineFunctionPass.h"
+#include "llvm/CodeGen/MachineLoopInfo.h"
+#include "llvm/CodeGen/MachineRegisterInfo.h"
+#include "llvm/CodeGen/Passes.h"
+#include "llvm/CodeGen/RegAllocRegistry.h"
+#include "llvm/CodeGen/TargetRegisterInfo.h"
+#include "llvm/CodeGen/VirtRegMap.h"
+#include "llvm/PassAnalysisSupport.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/raw_ostream.h"
+#include <queue>
+
+using namespace llvm;
+
+#define DEBUG_TYPE "regalloc"
+
+STATISTIC(NumEvicted, "Number of interferences spilled to free a register");
+STATISTIC(NumBlockSplits, "Number of live ranges split around blocks");
+
+static RegisterRegAlloc linearScanRegAlloc("linearscan",
+                                           "linear scan register allocator",
+                                           createLinearScanRegisterAllocator);
+
+namespace {
+/// RALinearScan assigns live intervals in the order of their start, spilling
+/// lighter interferences or splitting around use blocks when it runs out of
+/// registers.
+class RALinearScan : public MachineFunctionPass,
+                     public RegAllocBase,
+                     private LiveRangeEdit::Delegate {
+  // context
+  MachineFunction *MF;
+  LiveDebugVariables *DebugVars;
+  AliasAnalysis *AA;
+
+  // state
+  std::unique_ptr<Spiller> SpillerInstance;
+  std::unique_ptr<SplitAnalysis> SA;
+  std::unique_ptr<SplitEditor> SE;
+
+  /// The queue holds the start of each interval when it was enqueued, so that
+  /// shrinking an interval doesn't break the heap. The earliest start is
+  /// assigned first.
+  using QueueEntry = std::pair<SlotIndex, unsigned>;
+  struct LaterStart {
+    bool operator()(const QueueEntry &A, const QueueEntry &B) const {
+      return B < A;
+    }
+  };
+  std::priority_queue<QueueEntry, std::vector<QueueEntry>, LaterStart> Queue;
+
+  /// Virtual registers, by index, that were created by splitting and must be
+  /// spilled rather than split again.
+  BitVector NoSplit;
+
+  bool LRE_CanEraseVirtReg(unsigned) override;
+  void LRE_WillShrinkVirtReg(unsigned) override;
+
+public:
+  RALinearScan();
+
+  /// Return the pass name.
+  StringRef getPassName() const override {
+    return "Linear Scan Register Allocator";
+  }
+
+  void getAnalysisUsage(AnalysisUsage &AU) const override;
+
+  void releaseMemory() override;
+
+  Spiller &spiller() override { return *SpillerInstance; }
+
+  void enqueue(LiveInterval *LI) override {
+    Queue.push(
+        std::make_pair(LI->empty() ? SlotIndex() : LI->beginIndex(), LI->reg));
+  }
+
+  LiveInterval *dequeue() override {
+    if (Queue.empty())
+      return nullptr;
+    unsigned Reg = Queue.top().second;
+    Queue.pop();
+    return &LIS->getInterval(Reg);
+  }
+
+  unsigned selectOrSplit(LiveInterval &VirtReg,
+                         SmallVectorImpl<unsigned> &NewVRegs) override;
+
+  /// Perform register allocation.
+  bool runOnMachineFunction(MachineFunction &mf) override;
+
+  MachineFunctionProperties getRequiredProperties() const override {
+    return MachineFunctionProperties().set(
+        MachineFunctionProperties::Property::NoPHIs);
+  }
+
+  static char ID;
+
+private:
+  /// Collect the intervals assigned to PhysReg or its aliases that interfere
+  /// with VirtReg. Returns false if any of them cannot be spilled for VirtReg,
+  /// and otherwise sets Cost to their total spill weight.
+  bool collectInterferences(LiveInterval &VirtReg, unsigned PhysReg,
+                            SmallVectorImpl<LiveInterval *> &Intfs,
+                            float &Cost);
+
+  /// Spill the cheapest interferences of one of Candidates to free it for
+  /// VirtReg. Returns the freed register, or 0.
+  unsigned trySpillInterferences(LiveInterval &VirtReg,
+                                 ArrayRef<unsigned> Candidates,
+                                 SmallVectorImpl<unsigned> &NewVRegs);
+
+  /// Split VirtReg around the blocks that use it. Returns true if it was split.
+  bool tryBlockSplit(LiveInterval &VirtReg,
+                     SmallVectorImpl<unsigned> &NewVRegs);
+
+  bool canSplit(unsigned Reg) const {
+    unsigned Idx = Register::virtReg2Index(Reg);
+    return Idx >= NoSplit.size() || !NoSplit.test(Idx);
+  }
+};
+
+char RALinearScan::ID = 0;
+
+} // end anonymous namespace
+
+char &llvm::RALinearScanID = RALinearScan::ID;
+
+INITIALIZE_PASS_BEGIN(RALinearScan, "regalloclinearscan",
+                      "Linear Scan Register Allocator", false, false)
+INITIALIZE_PASS_DEPENDENCY(LiveDebugVariables)
+INITIALIZE_PASS_DEPENDENCY(SlotIndexes)
+INITIALIZE_PASS_DEPENDENCY(LiveIntervals)
+INITIALIZE_PASS_DEPENDENCY(RegisterCoalescer)
+INITIALIZE_PASS_DEPENDENCY(MachineScheduler)
+INITIALIZE_PASS_DEPENDENCY(LiveStacks)
+INITIALIZE_PASS_DEPENDENCY(MachineDominatorTree)
+INITIALIZE_PASS_DEPENDENCY(MachineLoopInfo)
+INITIALIZE_PASS_DEPENDENCY(VirtRegMap)
+INITIALIZE_PASS_DEPENDENCY(LiveRegMatrix)
+INITIALIZE_PASS_END(RALinearScan, "regalloclinearscan",
+                    "Linear Scan Register Allocator", false, false)
+
+bool RALinearScan::LRE_CanEraseVirtReg(unsigned VirtReg) {
+  LiveInterval &LI = LIS->getInterval(VirtReg);
+  if (VRM->hasPhys(VirtReg)) {
+    Matrix->unassign(LI);
+    aboutToRemoveInterval(LI);
+    return true;
+  }
+  // Unassigned virtreg is probably in the queue. RegAllocBase will erase it
+  // after dequeueing. Nonetheless, clear the live-range so that the debug dump
+  // will show the right state for that VirtReg.
+  LI.clear();
+  return false;
+}
+
+void RALinearScan::LRE_WillShrinkVirtReg(unsigned VirtReg) {
+  if (!VRM->hasPhys(VirtReg))
+    return;
+
+  // Register is assigned, put it back on the queue for reassignment.
+  LiveInterval &LI = LIS->getInterval(VirtReg);
+  Matrix->unassign(LI);
+  enqueue(&LI);
+}
+
+RALinearScan::RALinearScan() : MachineFunctionPass(ID) {}
+
+void RALinearScan::getAnalysisUsage(AnalysisUsage &AU) const {
+  AU.setPreservesCFG();
+  AU.addRequired<AAResultsWrapperPass>();
+  AU.addPreserved<AAResultsWrapperPass>();
+  AU.addRequired<LiveIntervals>();
+  AU.addPreserved<LiveIntervals>();
+  AU.addPreserved<SlotIndexes>();
+  AU.addRequired<LiveDebugVariables>();
+  AU.addPreserved<LiveDebugVariables>();
+  AU.addRequired<LiveStacks>();
+  AU.addPreserved<LiveStacks>();
+  AU.addRequired<MachineBlockFrequencyInfo>();
+  AU.addPreserved<MachineBlockFrequencyInfo>();
+  AU.addRequired<MachineDominatorTree>();
+  AU.addPreserved<MachineDominatorTree>();
+  AU.addRequired<MachineLoopInfo>();
+  AU.addPreserved<MachineLoopInfo>();
+  AU.addRequired<VirtRegMap>();
+  AU.addPreserved<VirtRegMap>();
+  AU.addRequired<LiveRegMatrix>();
+  AU.addPreserved<LiveRegMatrix>();
+  MachineFunctionPass::getAnalysisUsage(AU);
+}
+
+void RALinearScan::releaseMemory() {
+  SpillerInstance.reset();
+  SE.reset();
+  SA.reset();
+  NoSplit.clear();
+}
+
+bool RALinearScan::collectInterferences(LiveInterval &VirtReg,
+                                        unsigned PhysReg,
+                                        SmallVectorImpl<LiveInterval *> &Intfs,
+                                        float &Cost) {
+  Intfs.clear();
+  Cost = 0;
+  for (MCRegUnitIterator Units(PhysReg, TRI); Units.isValid(); ++Units) {
+    LiveIntervalUnion::Query &Q = Matrix->query(VirtReg, *Units);
+    Q.collectInterferingVRegs();
+    for (LiveInterval *Intf : Q.interferingVRegs()) {
+      // Only spill what is cheaper to spill than VirtReg.
+      if (!Intf->isSpillable() || Intf->weight >= VirtReg.weight)
+        return false;
+      if (is_contained(Intfs, Intf))
+        continue;
+      Intfs.push_back(Intf);
+      Cost += Intf->weight;
+      if (Cost >= VirtReg.weight)
+        return false;
+    }
+  }
+  return !Intfs.empty();
+}
+
+unsigned
+RALinearScan::trySpillInterferences(LiveInterval &VirtReg,
+                                    ArrayRef<unsigned> Candidates,
+                                    SmallVectorImpl<unsigned> &NewVRegs) {
+  unsigned BestPhys = 0;
+  float BestCost = 0;
+  SmallVector<LiveInterval *, 8> Intfs, BestIntfs;
+  for (unsigned PhysReg : Candidates) {
+    float Cost;
+    if (!collectInterferences(VirtReg, PhysReg, Intfs, Cost))
+      continue;
+    if (BestPhys && Cost >= BestCost)
+      continue;
+    BestPhys = PhysReg;
+    BestCost = Cost;
+    BestIntfs.swap(Intfs);
+  }
+  if (!BestPhys)
+    return 0;
+
+  LLVM_DEBUG(dbgs() << "spilling " << BestIntfs.size() << " interferences on "
+                    << printReg(BestPhys, TRI) << " for " << VirtReg << '\n');
+  for (LiveInterval *Spill : BestIntfs) {
+    // A LiveInterval instance may not be in a union during modification!
+    Matrix->unassign(*Spill);
+    LiveRangeEdit LRE(Spill, NewVRegs, *MF, *LIS, VRM, this, &DeadRemats);
+    spiller().spill(LRE);
+    ++NumEvicted;
+  }
+  assert(!Matrix->checkInterference(VirtReg, BestPhys) &&
+         "Interference after spill.");
+  return BestPhys;
+}
+
+bool RALinearScan::tryBlockSplit(LiveInterval &VirtReg,
+                                 SmallVectorImpl<unsigned> &NewVRegs) {
+  if (!canSplit(VirtReg.reg) || LIS->intervalIsInOneMBB(VirtReg))
+    return false;
+
+  SA->analyze(&VirtReg);
+  unsigned Reg = VirtReg.reg;
+  bool SingleInstrs = RegClassInfo.isProperSubClass(MRI->getRegClass(Reg));
+  LiveRangeEdit LREdit(&VirtReg, NewVRegs, *MF, *LIS, VRM, this, &DeadRemats);
+  SE->reset(LREdit, SplitEditor::SM_Speed);
+  for (const SplitAnalysis::BlockInfo &BI : SA->getUseBlocks())
+    if (SA->shouldSplitSingleBlock(BI, SingleInstrs))
+      SE->splitSingleBlock(BI);
+  if (LREdit.empty())
+    return false;
+
+  SE->finish();
+  DebugVars->splitRegister(Reg, LREdit.regs(), *LIS);
+  ++NumBlockSplits;
+
+  // The new local intervals are never split again, and the remainder would
+  // only be split around the same blocks: spill it if it's in the way.
+  NoSplit.resize(MRI->getNumVirtRegs());
+  for (unsigned NewReg : LREdit.regs())
+    NoSplit.set(Register::virtReg2Index(NewReg));
+
+  if (VerifyEnabled)
+    MF->verify(this, "After splitting live range around basic blocks");
+  return true;
+}
+
+unsigned RALinearScan::selectOrSplit(LiveInterval &VirtReg,
+                                     SmallVectorImpl<unsigned> &NewVRegs) {
+  // Take the first free register, in the order of the hints.
+  SmallVector<unsigned, 8> SpillCands;
+  AllocationOrder Order(VirtReg.reg, *VRM, RegClassInfo, Matrix);
+  while (unsigned PhysReg = Order.next()) {
+    switch (Matrix->checkInterference(VirtReg, PhysReg)) {
+    case LiveRegMatrix::IK_Free:
+      return PhysReg;
+    case LiveRegMatrix::IK_VirtReg:
+      // Only virtual registers in the way, we may be able to spill them.
+      SpillCands.push_back(PhysReg);
+      continue;
+    default:
+      // RegMask or RegUnit interference.
+      continue;
+    }
+  }
+
+  if (unsigned PhysReg = trySpillInterferences(VirtReg, SpillCands, NewVRegs))
+    return PhysReg;
+
+  if (tryBlockSplit(VirtReg, NewVRegs))
+    return 0;
+
+  LLVM_DEBUG(dbgs() << "spilling: " << VirtReg << '\n');
+  if (!VirtReg.isSpillable())
+    return ~0u;
+  LiveRangeEdit LRE(&VirtReg, NewVRegs, *MF, *LIS, VRM, this, &DeadRemats);
+  spiller().spill(LRE);
+
+  // The live virtual register requesting allocation was spilled, so tell
+  // the caller not to allocate anything during this round.
+  return 0;
+}
+
+bool RALinearScan::runOnMachineFunction(MachineFunction &mf) {
+  LLVM_DEBUG(dbgs() << "********** LINEAR SCAN REGISTER ALLOCATION **********\n"
+                    << "********** Function: " << mf.getName() << '\n');
+
+  MF = &mf;
+  RegAllocBase::init(getAnalysis<VirtRegMap>(), getAnalysis<LiveIntervals>(),
+                     getAnalysis<LiveRegMatrix>());
+  DebugVars = &getAnalysis<LiveDebugVariables>();
+  AA = &getAnalysis<AAResultsWrapperPass>().getAAResults();
+  MachineLoopInfo &Loops = getAnalysis<MachineLoopInfo>();
+  MachineBlockFrequencyInfo &MBFI = getAnalysis<MachineBlockFrequencyInfo>();
+
+  calculateSpillWeightsAndHints(*LIS, *MF, VRM, Loops, MBFI);
+
+  SpillerInstance.reset(createInlineSpiller(*this, *MF, *VRM));
+  SA.reset(new SplitAnalysis(*VRM, *LIS, Loops));
+  SE.reset(new SplitEditor(*SA, *AA, *LIS, *VRM,
+                           getAnalysis<MachineDominatorTree>(), MBFI));
+
+  allocatePhysRegs();
+  postOptimization();
+
+  // Diagnostic output before rewriting
+  LLVM_DEBUG(dbgs() << "Post alloc VirtRegMap:\n" << *VRM << "\n");
+
+  releaseMemory();
+  return true;
+}
+
+FunctionPass *llvm::createLinearScanRegisterAllocator() {
+  return new RALinearScan();
+}
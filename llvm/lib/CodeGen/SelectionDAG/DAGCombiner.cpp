@@ -83,6 +83,7 @@ STATISTIC(OpsNarrowed     , "Number of load/op/store narrowed");
 STATISTIC(LdStFP2Int      , "Number of fp load/store pairs transformed to int");
 STATISTIC(SlicedLoads, "Number of load sliced");
 STATISTIC(NumFPLogicOpsConv, "Number of logic ops converted to fp ops");
+STATISTIC(NodesSkipped, "Number of unchanged dag nodes not combined again");
 
 static cl::opt<bool>
 CombinerGlobalAA("combiner-global-alias-analysis", cl::Hidden,
@@ -115,6 +116,11 @@ static cl::opt<bool>
                        cl::desc("DAG combiner enable merging multiple stores "
                                 "into a wider store"));
 
+static cl::opt<bool> TopologicalWorklist(
+    "combiner-topological-worklist", cl::Hidden, cl::init(false),
+    cl::desc("Visit operands before their users and don't retry nodes for "
+             "which no combine applied until the DAG changes"));
+
 static cl::opt<unsigned> TokenFactorInlineLimit(
     "combiner-tokenfactor-inline-limit", cl::Hidden, cl::init(2048),
     cl::desc("Limit the number of operands to inline for Token Factors"));
@@ -169,6 +175,16 @@ namespace {
     /// candidate again.
     DenseMap<SDNode *, std::pair<SDNode *, unsigned>> StoreRootCountMap;
 
+    /// Count of the changes to the DAG, bumped on every node inserted, updated
+    /// or deleted and on every successful combine.
+    unsigned DAGEpoch = 0;
+
+    /// With -combiner-topological-worklist, the DAGEpoch at which each node was
+    /// visited without any combine applying or the DAG changing. While the
+    /// epoch is the same, visiting it again would fail again. Entries of
+    /// deleted nodes need not be removed, as deleting bumps the epoch.
+    DenseMap<SDNode *, unsigned> NoCombineEpoch;
+
     // AA - Used for DAG load/store alias analysis.
     AliasAnalysis *AA;
 
@@ -213,6 +229,9 @@ namespace {
     /// Call the node-specific routine that folds each particular type of node.
     SDValue visit(SDNode *N);
 
+    /// Append the nodes of the DAG to Order, each after all its operands.
+    void computeTopologicalOrder(SmallVectorImpl<SDNode *> &Order);
+
   public:
     DAGCombiner(SelectionDAG &D, AliasAnalysis *AA, CodeGenOpt::Level OL)
         : DAG(D), TLI(D.getTargetLoweringInfo()), Level(BeforeLegalizeTypes),
@@ -227,6 +246,9 @@ namespace {
           MaximumLegalStoreInBits = VT.getSizeInBits();
     }
 
+    /// Record a change to the DAG.
+    void bumpDAGEpoch() { ++DAGEpoch; }
+
     void ConsiderForPruning(SDNode *N) {
       // Mark this for potential pruning.
       PruningList.insert(N);
@@ -251,6 +273,7 @@ namespace {
 
     /// Remove all instances of N from the worklist.
     void removeFromWorklist(SDNode *N) {
+      bumpDAGEpoch();
       CombinedNodes.erase(N);
       PruningList.remove(N);
       StoreRootCountMap.erase(N);
@@ -733,7 +756,12 @@ public:
 
   // FIXME: Ideally we could add N to the worklist, but this causes exponential
   //        compile time costs in large DAGs, e.g. Halide.
-  void NodeInserted(SDNode *N) override { DC.ConsiderForPruning(N); }
+  void NodeInserted(SDNode *N) override {
+    DC.bumpDAGEpoch();
+    DC.ConsiderForPruning(N);
+  }
+
+  void NodeUpdated(SDNode *N) override { DC.bumpDAGEpoch(); }
 };
 
 } // end anonymous namespace
@@ -1398,9 +1426,18 @@ void DAGCombiner::Run(CombineLevel AtLevel) {
 
   WorklistInserter AddNodes(*this);
 
-  // Add all the dag nodes to the worklist.
-  for (SDNode &Node : DAG.allnodes())
-    AddToWorklist(&Node);
+  // Add all the dag nodes to the worklist. The worklist is a stack, so push
+  // users before their operands to visit operands first: users then see their
+  // operands already simplified, instead of being revisited after them.
+  if (TopologicalWorklist) {
+    SmallVector<SDNode *, 64> Order;
+    computeTopologicalOrder(Order);
+    for (SDNode *N : llvm::reverse(Order))
+      AddToWorklist(N);
+  } else {
+    for (SDNode &Node : DAG.allnodes())
+      AddToWorklist(&Node);
+  }
 
   // Create a dummy node (which is not added to allnodes), that adds a reference
   // to the root node, preventing it from being deleted, and tracking any
@@ -1423,6 +1460,8 @@ void DAGCombiner::Run(CombineLevel AtLevel) {
       SmallSetVector<SDNode *, 16> UpdatedNodes;
       bool NIsValid = DAG.LegalizeOp(N, UpdatedNodes);
 
+      if (!UpdatedNodes.empty())
+        bumpDAGEpoch();
       for (SDNode *LN : UpdatedNodes) {
         AddUsersToWorklist(LN);
         AddToWorklist(LN);
@@ -1441,12 +1480,27 @@ void DAGCombiner::Run(CombineLevel AtLevel) {
       if (!CombinedNodes.count(ChildN.getNode()))
         AddToWorklist(ChildN.getNode());
 
+    // Nothing applied to N last time, and nothing changed since.
+    unsigned EpochBefore = DAGEpoch;
+    if (TopologicalWorklist) {
+      auto It = NoCombineEpoch.find(N);
+      if (It != NoCombineEpoch.end() && It->second == EpochBefore) {
+        ++NodesSkipped;
+        continue;
+      }
+    }
+
     SDValue RV = combine(N);
 
-    if (!RV.getNode())
+    if (!RV.getNode()) {
+      // Only a combine that left the DAG untouched is known to fail again.
+      if (TopologicalWorklist && DAGEpoch == EpochBefore)
+        NoCombineEpoch[N] = EpochBefore;
       continue;
+    }
 
     ++NodesCombined;
+    bumpDAGEpoch();
 
     // If we get back the same node we passed in, rather than a new node or
     // zero, we know that the node must have defined multiple values and
@@ -1483,6 +1537,29 @@ void DAGCombiner::Run(CombineLevel AtLevel) {
   // If the root changed (e.g. it was a dead load, update the root).
   DAG.setRoot(Dummy.getValue());
   DAG.RemoveDeadNodes();
+  NoCombineEpoch.clear();
+}
+
+void DAGCombiner::computeTopologicalOrder(SmallVectorImpl<SDNode *> &Order) {
+  // Count the operands of each node still to be ordered, and start from the
+  // nodes without any.
+  DenseMap<SDNode *, unsigned> NumPendingOps;
+  for (SDNode &Node : DAG.allnodes()) {
+    if (Node.getNumOperands())
+      NumPendingOps[&Node] = Node.getNumOperands();
+    else
+      Order.push_back(&Node);
+  }
+
+  // Each use is one operand of its user, so the user is ready after the last
+  // of them.
+  for (unsigned I = 0; I != Order.size(); ++I)
+    for (SDNode *User : Order[I]->uses()) {
+      auto It = NumPendingOps.find(User);
+      if (It != NumPendingOps.end() && --It->second == 0)
+        Order.push_back(User);
+    }
+  assert(Order.size() == DAG.allnodes_size() && "DAG has a cycle?");
 }
 
 SDValue DAGCombiner::visit(SDNode *N) {
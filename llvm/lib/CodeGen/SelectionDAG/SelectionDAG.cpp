@@ -433,19 +433,22 @@ ISD::CondCode ISD::getSetCCAndOperation(ISD::CondCode Op1, ISD::CondCode Op2,
 //===----------------------------------------------------------------------===//
 
 /// AddNodeIDOpcode - Add the node opcode to the NodeID data.
-static void AddNodeIDOpcode(FoldingSetNodeID &ID, unsigned OpC)  {
+/// The AddNodeID helpers below also take a FoldingSetNodeIDHasher, to hash the
+/// ID of a node without building it.
+template <typename IDT> static void AddNodeIDOpcode(IDT &ID, unsigned OpC) {
   ID.AddInteger(OpC);
 }
 
 /// AddNodeIDValueTypes - Value type lists are intern'd so we can represent them
 /// solely with their pointer.
-static void AddNodeIDValueTypes(FoldingSetNodeID &ID, SDVTList VTList) {
+template <typename IDT>
+static void AddNodeIDValueTypes(IDT &ID, SDVTList VTList) {
   ID.AddPointer(VTList.VTs);
 }
 
 /// AddNodeIDOperands - Various routines for adding operands to the NodeID data.
-static void AddNodeIDOperands(FoldingSetNodeID &ID,
-                              ArrayRef<SDValue> Ops) {
+template <typename IDT>
+static void AddNodeIDOperands(IDT &ID, ArrayRef<SDValue> Ops) {
   for (auto& Op : Ops) {
     ID.AddPointer(Op.getNode());
     ID.AddInteger(Op.getResNo());
@@ -453,16 +456,17 @@ static void AddNodeIDOperands(FoldingSetNodeID &ID,
 }
 
 /// AddNodeIDOperands - Various routines for adding operands to the NodeID data.
-static void AddNodeIDOperands(FoldingSetNodeID &ID,
-                              ArrayRef<SDUse> Ops) {
+template <typename IDT>
+static void AddNodeIDOperands(IDT &ID, ArrayRef<SDUse> Ops) {
   for (auto& Op : Ops) {
     ID.AddPointer(Op.getNode());
     ID.AddInteger(Op.getResNo());
   }
 }
 
-static void AddNodeIDNode(FoldingSetNodeID &ID, unsigned short OpC,
-                          SDVTList VTList, ArrayRef<SDValue> OpList) {
+template <typename IDT>
+static void AddNodeIDNode(IDT &ID, unsigned short OpC, SDVTList VTList,
+                          ArrayRef<SDValue> OpList) {
   AddNodeIDOpcode(ID, OpC);
   AddNodeIDValueTypes(ID, VTList);
   AddNodeIDOperands(ID, OpList);
@@ -1073,6 +1077,34 @@ SDNode *SelectionDAG::FindNodeOrInsertPos(const FoldingSetNodeID &ID,
   return N;
 }
 
+SDNode *SelectionDAG::FindNodeOrInsertPos(unsigned Opcode, SDVTList VTs,
+                                          ArrayRef<SDValue> Ops,
+                                          const SDLoc &DL, void *&InsertPos) {
+  FoldingSetNodeIDHasher Hash;
+  AddNodeIDNode(Hash, Opcode, VTs, Ops);
+  SDNode *N = CSEMap.FindNodeOrInsertPos(
+      Hash,
+      [&](SDNode &E) {
+        if (E.getOpcode() != Opcode || E.getVTList().VTs != VTs.VTs ||
+            E.getNumOperands() != Ops.size())
+          return false;
+        for (unsigned I = 0, End = Ops.size(); I != End; ++I)
+          if (E.getOperand(I) != Ops[I])
+            return false;
+        // Nodes with special info have a longer ID. This depends only on the
+        // opcode, so it is rarely reached.
+        FoldingSetNodeID Custom;
+        AddNodeIDCustom(Custom, &E);
+        return Custom == FoldingSetNodeID();
+      },
+      InsertPos);
+  // Constants have special info, so only the default case of the overload
+  // above applies.
+  if (N && DL.getIROrder() && DL.getIROrder() < N->getIROrder())
+    N->setDebugLoc(DL.getDebugLoc());
+  return N;
+}
+
 void SelectionDAG::clear() {
   allnodes_clear();
   OperandRecycler.clear(OperandAllocator);
@@ -4666,10 +4698,8 @@ SDValue SelectionDAG::getNode(unsigned Opcode, const SDLoc &DL, EVT VT,
   SDVTList VTs = getVTList(VT);
   SDValue Ops[] = {Operand};
   if (VT != MVT::Glue) { // Don't CSE flag producing nodes
-    FoldingSetNodeID ID;
-    AddNodeIDNode(ID, Opcode, VTs, Ops);
     void *IP = nullptr;
-    if (SDNode *E = FindNodeOrInsertPos(ID, DL, IP)) {
+    if (SDNode *E = FindNodeOrInsertPos(Opcode, VTs, Ops, DL, IP)) {
       E->intersectFlagsWith(Flags);
       return SDValue(E, 0);
     }
@@ -5417,10 +5447,8 @@ SDValue SelectionDAG::getNode(unsigned Opcode, const SDLoc &DL, EVT VT,
   SDVTList VTs = getVTList(VT);
   SDValue Ops[] = {N1, N2};
   if (VT != MVT::Glue) {
-    FoldingSetNodeID ID;
-    AddNodeIDNode(ID, Opcode, VTs, Ops);
     void *IP = nullptr;
-    if (SDNode *E = FindNodeOrInsertPos(ID, DL, IP)) {
+    if (SDNode *E = FindNodeOrInsertPos(Opcode, VTs, Ops, DL, IP)) {
       E->intersectFlagsWith(Flags);
       return SDValue(E, 0);
     }
@@ -5553,10 +5581,8 @@ SDValue SelectionDAG::getNode(unsigned Opcode, const SDLoc &DL, EVT VT,
   SDVTList VTs = getVTList(VT);
   SDValue Ops[] = {N1, N2, N3};
   if (VT != MVT::Glue) {
-    FoldingSetNodeID ID;
-    AddNodeIDNode(ID, Opcode, VTs, Ops);
     void *IP = nullptr;
-    if (SDNode *E = FindNodeOrInsertPos(ID, DL, IP)) {
+    if (SDNode *E = FindNodeOrInsertPos(Opcode, VTs, Ops, DL, IP)) {
       E->intersectFlagsWith(Flags);
       return SDValue(E, 0);
     }
@@ -7231,11 +7257,8 @@ SDValue SelectionDAG::getNode(unsigned Opcode, const SDLoc &DL, EVT VT,
   SDVTList VTs = getVTList(VT);
 
   if (VT != MVT::Glue) {
-    FoldingSetNodeID ID;
-    AddNodeIDNode(ID, Opcode, VTs, Ops);
     void *IP = nullptr;
-
-    if (SDNode *E = FindNodeOrInsertPos(ID, DL, IP))
+    if (SDNode *E = FindNodeOrInsertPos(Opcode, VTs, Ops, DL, IP))
       return SDValue(E, 0);
 
     N = newSDNode<SDNode>(Opcode, DL.getIROrder(), DL.getDebugLoc(), VTs);
@@ -7289,10 +7312,8 @@ SDValue SelectionDAG::getNode(unsigned Opcode, const SDLoc &DL, SDVTList VTList,
   // Memoize the node unless it returns a flag.
   SDNode *N;
   if (VTList.VTs[VTList.NumVTs-1] != MVT::Glue) {
-    FoldingSetNodeID ID;
-    AddNodeIDNode(ID, Opcode, VTList, Ops);
     void *IP = nullptr;
-    if (SDNode *E = FindNodeOrInsertPos(ID, DL, IP))
+    if (SDNode *E = FindNodeOrInsertPos(Opcode, VTList, Ops, DL, IP))
       return SDValue(E, 0);
 
     N = newSDNode<SDNode>(Opcode, DL.getIROrder(), DL.getDebugLoc(), VTList);
@@ -87,6 +87,44 @@ uint32_t LazyRandomTypeCollection::getOffsetOfType(TypeIndex Index) {
   return Records[Index.toArrayIndex()].Offset;
 }
 
+std::vector<uint32_t> LazyRandomTypeCollection::getTypeOffsets() const {
+  std::vector<uint32_t> Offsets;
+  for (auto I = Types.begin(), E = Types.end(); I != E; ++I)
+    Offsets.push_back(I.offset());
+  return Offsets;
+}
+
+Error LazyRandomTypeCollection::setTypeOffsets(ArrayRef<uint32_t> Offsets) {
+  // Every record must end where the next one starts, and the last one at the
+  // end of the stream.
+  uint32_t StreamLength = Types.getUnderlyingStream().getLength();
+  if (Offsets.empty() && StreamLength != 0)
+    return make_error<CodeViewError>("Invalid type record offset");
+  std::vector<CVType> Found;
+  Found.reserve(Offsets.size());
+  for (size_t I = 0, E = Offsets.size(); I != E; ++I) {
+    uint32_t End = I + 1 == E ? StreamLength : Offsets[I + 1];
+    if (Offsets[I] >= End)
+      return make_error<CodeViewError>("Invalid type record offset");
+    auto Record = Types.at(Offsets[I]);
+    if (Record == Types.end() || Offsets[I] + Record->length() != End)
+      return make_error<CodeViewError>("Invalid type record offset");
+    Found.push_back(*Record);
+  }
+
+  Records.clear();
+  Records.resize(Offsets.size());
+  for (size_t I = 0, E = Offsets.size(); I != E; ++I) {
+    Records[I].Type = Found[I];
+    Records[I].Offset = Offsets[I];
+  }
+  Count = Offsets.size();
+  LargestTypeIndex = Offsets.empty()
+                         ? TypeIndex::None()
+                         : TypeIndex::fromArrayIndex(Offsets.size() - 1);
+  return Error::success();
+}
+
 CVType LazyRandomTypeCollection::getType(TypeIndex Index) {
   assert(!Index.isSimple());
 
@@ -45,6 +45,8 @@
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/TargetRegistry.h"
+#include "llvm/Support/ThreadPool.h"
+#include "llvm/Support/Threading.h"
 #include "llvm/Support/WithColor.h"
 #include "llvm/Support/raw_ostream.h"
 #include <algorithm>
@@ -645,6 +647,31 @@ DWARFDie DWARFContext::getDIEForOffset(uint64_t Offset) {
   return DWARFDie();
 }
 
+void DWARFContext::extractAllDIEs(unsigned NumThreads) {
+  parseNormalUnits();
+  // Looking up a unit's abbreviation set parses it into the shared
+  // DWARFDebugAbbrev. Do that serially; the DIE extraction of every unit
+  // after that only touches the unit itself.
+  for (const auto &U : NormalUnits)
+    U->getAbbreviations();
+
+  if (NumThreads == 0)
+    NumThreads = heavyweight_hardware_concurrency();
+  NumThreads = std::min<unsigned>(NumThreads, NormalUnits.size());
+  if (NumThreads <= 1) {
+    for (const auto &U : NormalUnits)
+      U->getUnitDIE(false);
+    return;
+  }
+
+  ThreadPool Pool(NumThreads);
+  for (const auto &U : NormalUnits) {
+    DWARFUnit *Unit = U.get();
+    Pool.async([Unit]() { Unit->getUnitDIE(false); });
+  }
+  Pool.wait();
+}
+
 bool DWARFContext::verify(raw_ostream &OS, DIDumpOptions DumpOpts) {
   bool Success = true;
   DWARFVerifier verifier(OS, *this, DumpOpts);
@@ -1092,6 +1119,11 @@ DILineInfo DWARFContext::getLineInfoForAddress(object::SectionedAddress Address,
                                                DILineInfoSpecifier Spec) {
   DILineInfo Result;
 
+  if (LineIndex && Spec.FNKind == FunctionNameKind::None) {
+    LineIndex->getFileLineInfoForAddress(Address, Spec.FLIKind, Result);
+    return Result;
+  }
+
   DWARFCompileUnit *CU = getCompileUnitForAddress(Address.Address);
   if (!CU)
     return Result;
@@ -1099,7 +1131,9 @@ DILineInfo DWARFContext::getLineInfoForAddress(object::SectionedAddress Address,
   getFunctionNameAndStartLineForAddress(CU, Address.Address, Spec.FNKind,
                                         Result.FunctionName, Result.StartLine);
   if (Spec.FLIKind != FileLineInfoKind::None) {
-    if (const DWARFLineTable *LineTable = getLineTableForUnit(CU)) {
+    if (LineIndex) {
+      LineIndex->getFileLineInfoForAddress(Address, Spec.FLIKind, Result);
+    } else if (const DWARFLineTable *LineTable = getLineTableForUnit(CU)) {
       LineTable->getFileLineInfoForAddress(
           {Address.Address, Address.SectionIndex}, CU->getCompilationDir(),
           Spec.FLIKind, Result);
@@ -35,15 +35,19 @@ bool DWARFDebugInfoEntry::extractFast(const DWARFUnit &U, uint64_t *OffsetPtr,
   uint64_t AbbrCode = DebugInfoData.getULEB128(OffsetPtr);
   if (0 == AbbrCode) {
     // NULL debug tag entry.
-    AbbrevDecl = nullptr;
+    AbbrevIdx = 0;
     return true;
   }
-  AbbrevDecl = U.getAbbreviations()->getAbbreviationDeclaration(AbbrCode);
+  const DWARFAbbreviationDeclarationSet *Abbrevs = U.getAbbreviations();
+  const DWARFAbbreviationDeclaration *AbbrevDecl =
+      Abbrevs->getAbbreviationDeclaration(AbbrCode);
   if (nullptr == AbbrevDecl) {
     // Restore the original offset.
     *OffsetPtr = Offset;
+    AbbrevIdx = 0;
     return false;
   }
+  AbbrevIdx = Abbrevs->getDeclarationIndex(AbbrevDecl) + 1;
   // See if all attributes in this DIE have fixed byte sizes. If so, we can
   // just add this size to the offset to skip to the next DIE.
   if (Optional<size_t> FixedSize = AbbrevDecl->getFixedAttributesByteSize(U)) {
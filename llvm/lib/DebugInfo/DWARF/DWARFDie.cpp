@@ -355,6 +355,12 @@ static void dumpAttribute(raw_ostream &OS, const DWARFDie &Die,
   OS << ")\n";
 }
 
+const DWARFAbbreviationDeclaration *
+DWARFDie::getAbbreviationDeclarationPtr() const {
+  assert(isValid() && "must check validity prior to calling");
+  return Die->getAbbreviationDeclarationPtr(U->getAbbreviations());
+}
+
 bool DWARFDie::isSubprogramDIE() const { return getTag() == DW_TAG_subprogram; }
 
 bool DWARFDie::isSubroutineDIE() const {
@@ -0,0 +1,305 @@
+//===- DWARFLineIndex.cpp -------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/DebugInfo/DWARF/DWARFLineIndex.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/DebugInfo/DWARF/DWARFContext.h"
+#include "llvm/DebugInfo/DWARF/DWARFDebugLine.h"
+#include "llvm/Support/DataExtractor.h"
+#include "llvm/Support/EndianStream.h"
+#include "llvm/Support/LEB128.h"
+#include "llvm/Support/raw_ostream.h"
+#include <algorithm>
+#include <tuple>
+
+using namespace llvm;
+
+using FileLineInfoKind = DILineInfoSpecifier::FileLineInfoKind;
+
+/// The file index of rows whose DWARF file index isn't in the prologue.
+static constexpr uint32_t InvalidFile = UINT32_MAX;
+
+static constexpr uint32_t IndexMagic = 0x5844494c; // "LIDX"
+static constexpr uint32_t IndexVersion = 1;
+
+static void appendULEB128(std::vector<uint8_t> &Data, uint64_t Value) {
+  uint8_t Buf[16];
+  unsigned Len = encodeULEB128(Value, Buf);
+  Data.insert(Data.end(), Buf, Buf + Len);
+}
+
+static void appendSLEB128(std::vector<uint8_t> &Data, int64_t Value) {
+  uint8_t Buf[16];
+  unsigned Len = encodeSLEB128(Value, Buf);
+  Data.insert(Data.end(), Buf, Buf + Len);
+}
+
+DWARFLineIndex DWARFLineIndex::build(DWARFContext &Ctx) {
+  struct SequenceRef {
+    const DWARFDebugLine::LineTable *LineTable;
+    const DWARFDebugLine::Sequence *Seq;
+    const char *CompDir;
+  };
+  std::vector<SequenceRef> AllSequences;
+  for (const auto &CU : Ctx.compile_units())
+    if (const DWARFDebugLine::LineTable *LT = Ctx.getLineTableForUnit(CU.get()))
+      for (const DWARFDebugLine::Sequence &Seq : LT->Sequences)
+        if (Seq.isValid())
+          AllSequences.push_back({LT, &Seq, CU->getCompilationDir()});
+  llvm::stable_sort(AllSequences,
+                    [](const SequenceRef &LHS, const SequenceRef &RHS) {
+                      return std::tie(LHS.Seq->SectionIndex, LHS.Seq->LowPC) <
+                             std::tie(RHS.Seq->SectionIndex, RHS.Seq->LowPC);
+                    });
+
+  DWARFLineIndex Index;
+  // DWARF file indexes are per line table; the index has one file table.
+  DenseMap<std::pair<const DWARFDebugLine::LineTable *, uint64_t>, uint32_t>
+      FileMap;
+  StringMap<uint32_t> FileIds;
+  auto getFile = [&](const SequenceRef &S, uint64_t DwarfFile) {
+    auto Inserted = FileMap.try_emplace({S.LineTable, DwarfFile}, InvalidFile);
+    if (!Inserted.second)
+      return Inserted.first->second;
+    FileName F;
+    if (!S.LineTable->getFileNameByIndex(DwarfFile, S.CompDir,
+                                         FileLineInfoKind::Default, F.Name) ||
+        !S.LineTable->getFileNameByIndex(
+            DwarfFile, S.CompDir, FileLineInfoKind::AbsoluteFilePath, F.Path))
+      return InvalidFile;
+    auto Id = FileIds.try_emplace((F.Path + Twine('\0') + F.Name).str(),
+                                  Index.Files.size());
+    if (Id.second)
+      Index.Files.push_back(std::move(F));
+    return Inserted.first->second = Id.first->second;
+  };
+
+  for (const SequenceRef &S : AllSequences) {
+    const DWARFDebugLine::Sequence &Seq = *S.Seq;
+    if (!Index.Sequences.empty()) {
+      const Sequence &Prev = Index.Sequences.back();
+      if (Prev.SectionIndex == Seq.SectionIndex && Seq.LowPC < Prev.HighPC)
+        continue;
+    }
+
+    Sequence NewSeq;
+    NewSeq.SectionIndex = Seq.SectionIndex;
+    NewSeq.LowPC = Seq.LowPC;
+    NewSeq.HighPC = Seq.HighPC;
+    NewSeq.FirstBucket = Index.Buckets.size();
+    // The last row of a sequence is the end_sequence row, which only
+    // provides HighPC.
+    const DWARFDebugLine::Row *Prev = nullptr;
+    for (uint32_t I = Seq.FirstRowIndex; I + 1 < Seq.LastRowIndex; ++I) {
+      const DWARFDebugLine::Row &Row = S.LineTable->Rows[I];
+      uint32_t File = getFile(S, Row.File);
+      if ((I - Seq.FirstRowIndex) % BucketSize == 0) {
+        Bucket B;
+        B.Address = Row.Address.Address;
+        B.DataOffset = Index.RowData.size();
+        B.File = File;
+        B.Line = Row.Line;
+        B.Discriminator = Row.Discriminator;
+        B.Column = Row.Column;
+        Index.Buckets.push_back(B);
+      } else {
+        appendULEB128(Index.RowData,
+                      Row.Address.Address - Prev->Address.Address);
+        appendSLEB128(Index.RowData, int64_t(Row.Line) - int64_t(Prev->Line));
+        appendULEB128(Index.RowData, File);
+        appendULEB128(Index.RowData, Row.Column);
+        appendULEB128(Index.RowData, Row.Discriminator);
+      }
+      Prev = &Row;
+      ++Index.NumRows;
+    }
+    NewSeq.NumBuckets = Index.Buckets.size() - NewSeq.FirstBucket;
+    Index.Sequences.push_back(NewSeq);
+  }
+  return Index;
+}
+
+const DWARFLineIndex::Sequence *
+DWARFLineIndex::findSequence(object::SectionedAddress Address) const {
+  // The sequences don't overlap, so they are sorted by HighPC as well.
+  auto It = llvm::partition_point(Sequences, [&](const Sequence &S) {
+    return std::tie(S.SectionIndex, S.HighPC) <=
+           std::tie(Address.SectionIndex, Address.Address);
+  });
+  if (It == Sequences.end() || It->SectionIndex != Address.SectionIndex ||
+      Address.Address < It->LowPC)
+    return nullptr;
+  return &*It;
+}
+
+bool DWARFLineIndex::getFileLineInfoForAddress(
+    object::SectionedAddress Address, FileLineInfoKind Kind,
+    DILineInfo &Result) const {
+  if (Kind == FileLineInfoKind::None)
+    return false;
+
+  // Like DWARFDebugLine::LineTable::lookupAddress, fall back to absolute
+  // addresses.
+  const Sequence *Seq = findSequence(Address);
+  if (!Seq && Address.SectionIndex != object::SectionedAddress::UndefSection)
+    Seq = findSequence(
+        {Address.Address, object::SectionedAddress::UndefSection});
+  if (!Seq || Seq->NumBuckets == 0)
+    return false;
+
+  auto FirstBucket = Buckets.begin() + Seq->FirstBucket;
+  auto BucketIt = std::prev(std::partition_point(
+      FirstBucket, FirstBucket + Seq->NumBuckets,
+      [&](const Bucket &B) { return B.Address <= Address.Address; }));
+
+  uint64_t RowAddress = BucketIt->Address;
+  uint32_t File = BucketIt->File;
+  uint32_t Line = BucketIt->Line;
+  uint32_t Discriminator = BucketIt->Discriminator;
+  uint16_t Column = BucketIt->Column;
+  const uint8_t *Ptr = RowData.data() + BucketIt->DataOffset;
+  const uint8_t *End =
+      std::next(BucketIt) == Buckets.end()
+          ? RowData.data() + RowData.size()
+          : RowData.data() + std::next(BucketIt)->DataOffset;
+  // As in the line table, the last row at or before the address wins, so
+  // rows with equal addresses resolve to the last one.
+  while (Ptr < End) {
+    unsigned Len;
+    uint64_t NextAddress = RowAddress + decodeULEB128(Ptr, &Len, End);
+    if (NextAddress > Address.Address)
+      break;
+    Ptr += Len;
+    RowAddress = NextAddress;
+    Line += decodeSLEB128(Ptr, &Len, End);
+    Ptr += Len;
+    File = decodeULEB128(Ptr, &Len, End);
+    Ptr += Len;
+    Column = decodeULEB128(Ptr, &Len, End);
+    Ptr += Len;
+    Discriminator = decodeULEB128(Ptr, &Len, End);
+    Ptr += Len;
+  }
+
+  if (File >= Files.size())
+    return false;
+  Result.FileName = Kind == FileLineInfoKind::AbsoluteFilePath
+                        ? Files[File].Path
+                        : Files[File].Name;
+  Result.Line = Line;
+  Result.Column = Column;
+  Result.Discriminator = Discriminator;
+  return true;
+}
+
+void DWARFLineIndex::encode(raw_ostream &OS) const {
+  support::endian::Writer W(OS, support::little);
+  W.write<uint32_t>(IndexMagic);
+  W.write<uint32_t>(IndexVersion);
+  W.write<uint64_t>(NumRows);
+  W.write<uint32_t>(Sequences.size());
+  W.write<uint32_t>(Buckets.size());
+  W.write<uint32_t>(RowData.size());
+  W.write<uint32_t>(Files.size());
+  for (const Sequence &S : Sequences) {
+    W.write<uint64_t>(S.SectionIndex);
+    W.write<uint64_t>(S.LowPC);
+    W.write<uint64_t>(S.HighPC);
+    W.write<uint32_t>(S.FirstBucket);
+    W.write<uint32_t>(S.NumBuckets);
+  }
+  for (const Bucket &B : Buckets) {
+    W.write<uint64_t>(B.Address);
+    W.write<uint32_t>(B.DataOffset);
+    W.write<uint32_t>(B.File);
+    W.write<uint32_t>(B.Line);
+    W.write<uint32_t>(B.Discriminator);
+    W.write<uint16_t>(B.Column);
+  }
+  OS.write(reinterpret_cast<const char *>(RowData.data()), RowData.size());
+  for (const FileName &F : Files) {
+    W.write<uint32_t>(F.Name.size());
+    OS << F.Name;
+    W.write<uint32_t>(F.Path.size());
+    OS << F.Path;
+  }
+}
+
+static std::string getString(DataExtractor &Data, DataExtractor::Cursor &C) {
+  SmallVector<uint8_t, 64> Bytes;
+  Data.getU8(C, Bytes, Data.getU32(C));
+  return std::string(Bytes.begin(), Bytes.end());
+}
+
+Expected<DWARFLineIndex> DWARFLineIndex::decode(StringRef Bytes) {
+  DataExtractor Data(Bytes, /*IsLittleEndian=*/true, 8);
+  DataExtractor::Cursor C(0);
+  if (Data.getU32(C) != IndexMagic || Data.getU32(C) != IndexVersion) {
+    consumeError(C.takeError());
+    return createStringError(errc::invalid_argument,
+                             "not a line index of a supported version");
+  }
+
+  DWARFLineIndex Index;
+  Index.NumRows = Data.getU64(C);
+  uint32_t NumSequences = Data.getU32(C);
+  uint32_t NumBuckets = Data.getU32(C);
+  uint32_t RowDataSize = Data.getU32(C);
+  uint32_t NumFiles = Data.getU32(C);
+  // Reject truncated data before allocating anything based on the counts.
+  if (C && Bytes.size() - C.tell() <
+               uint64_t(NumSequences) * 32 + uint64_t(NumBuckets) * 26 +
+                   RowDataSize + uint64_t(NumFiles) * 8) {
+    consumeError(C.takeError());
+    return createStringError(errc::invalid_argument, "truncated line index");
+  }
+
+  Index.Sequences.resize(NumSequences);
+  for (Sequence &S : Index.Sequences) {
+    S.SectionIndex = Data.getU64(C);
+    S.LowPC = Data.getU64(C);
+    S.HighPC = Data.getU64(C);
+    S.FirstBucket = Data.getU32(C);
+    S.NumBuckets = Data.getU32(C);
+  }
+  Index.Buckets.resize(NumBuckets);
+  for (Bucket &B : Index.Buckets) {
+    B.Address = Data.getU64(C);
+    B.DataOffset = Data.getU32(C);
+    B.File = Data.getU32(C);
+    B.Line = Data.getU32(C);
+    B.Discriminator = Data.getU32(C);
+    B.Column = Data.getU16(C);
+  }
+  Index.RowData.resize(RowDataSize);
+  Data.getU8(C, Index.RowData.data(), RowDataSize);
+  Index.Files.resize(NumFiles);
+  for (FileName &F : Index.Files) {
+    F.Name = getString(Data, C);
+    F.Path = getString(Data, C);
+  }
+  if (!C)
+    return C.takeError();
+
+  // Lookups trust the bucket ranges and data offsets, so check them here.
+  for (const Sequence &S : Index.Sequences)
+    if (uint64_t(S.FirstBucket) + S.NumBuckets > NumBuckets)
+      return createStringError(errc::invalid_argument,
+                               "line index sequence has invalid buckets");
+  uint32_t PrevOffset = 0;
+  for (const Bucket &B : Index.Buckets) {
+    if (B.DataOffset < PrevOffset || B.DataOffset > RowDataSize)
+      return createStringError(errc::invalid_argument,
+                               "line index bucket has an invalid data offset");
+    PrevOffset = B.DataOffset;
+  }
+  return std::move(Index);
+}
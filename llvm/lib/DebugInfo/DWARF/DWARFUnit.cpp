@@ -380,7 +380,7 @@ void DWARFUnit::extractDIEsToVector(
     }
 
     if (const DWARFAbbreviationDeclaration *AbbrDecl =
-            DIE.getAbbreviationDeclarationPtr()) {
+            DIE.getAbbreviationDeclarationPtr(getAbbreviations())) {
       // Normal DIE
       if (AbbrDecl->hasChildren())
         ++Depth;
@@ -701,7 +701,7 @@ DWARFDie DWARFUnit::getSibling(const DWARFDebugInfoEntry *Die) {
   if (Depth == 0)
     return DWARFDie();
   // NULL DIEs don't have siblings.
-  if (Die->getAbbreviationDeclarationPtr() == nullptr)
+  if (Die->isNULL())
     return DWARFDie();
 
   // Find the next DIE whose depth is the same as the Die's depth.
@@ -733,7 +733,7 @@ DWARFDie DWARFUnit::getPreviousSibling(const DWARFDebugInfoEntry *Die) {
 }
 
 DWARFDie DWARFUnit::getFirstChild(const DWARFDebugInfoEntry *Die) {
-  if (!Die->hasChildren())
+  if (!DWARFDie(this, Die).hasChildren())
     return DWARFDie();
 
   // We do not want access out of bounds when parsing corrupted debug data.
@@ -744,14 +744,14 @@ DWARFDie DWARFUnit::getFirstChild(const DWARFDebugInfoEntry *Die) {
 }
 
 DWARFDie DWARFUnit::getLastChild(const DWARFDebugInfoEntry *Die) {
-  if (!Die->hasChildren())
+  if (!DWARFDie(this, Die).hasChildren())
     return DWARFDie();
 
   uint32_t Depth = Die->getDepth();
   for (size_t I = getDIEIndex(Die) + 1, EndIdx = DieArray.size(); I < EndIdx;
        ++I) {
     if (DieArray[I].getDepth() == Depth + 1 &&
-        DieArray[I].getTag() == dwarf::DW_TAG_null)
+        DieArray[I].isNULL())
       return DWARFDie(this, &DieArray[I]);
     assert(DieArray[I].getDepth() > Depth && "Not processing children?");
   }
@@ -16,10 +16,14 @@
 #include "llvm/DebugInfo/DWARF/DWARFSection.h"
 #include "llvm/Support/DJB.h"
 #include "llvm/Support/FormatVariadic.h"
+#include "llvm/Support/MathExtras.h"
+#include "llvm/Support/ThreadPool.h"
+#include "llvm/Support/Threading.h"
 #include "llvm/Support/WithColor.h"
 #include "llvm/Support/raw_ostream.h"
 #include <map>
 #include <set>
+#include <string>
 #include <vector>
 
 using namespace llvm;
@@ -282,6 +286,10 @@ unsigned DWARFVerifier::verifyUnitSection(const DWARFSection &S,
   bool hasDIE = DebugInfoData.isValidOffset(Offset);
   DWARFUnitVector TypeUnitVector;
   DWARFUnitVector CompileUnitVector;
+  // When verifying in parallel, the contents of the units are verified after
+  // all headers, so that references between units can be followed.
+  bool VerifyInParallel = DumpOpts.NumThreads != 1;
+  std::vector<DWARFUnit *> Units;
   while (hasDIE) {
     OffsetStart = Offset;
     if (!verifyUnitHeader(DebugInfoData, &Offset, UnitIdx, UnitType,
@@ -320,11 +328,30 @@ unsigned DWARFVerifier::verifyUnitSection(const DWARFSection &S,
       }
       default: { llvm_unreachable("Invalid UnitType."); }
       }
-      NumDebugInfoErrors += verifyUnitContents(*Unit);
+      if (VerifyInParallel)
+        Units.push_back(Unit);
+      else
+        NumDebugInfoErrors += verifyUnitContents(*Unit);
     }
     hasDIE = DebugInfoData.isValidOffset(Offset);
     ++UnitIdx;
   }
+  if (!Units.empty()) {
+    // Parse the state that is shared between units serially, then extract the
+    // DIEs of all units before any reference between them is followed. The
+    // extraction doesn't report anything, so it ignores the chunk verifiers.
+    for (DWARFUnit *U : Units)
+      U->getAbbreviations();
+    DCtx.getDebugLoc();
+    verifyInParallel(Units.size(), [&](DWARFVerifier &, size_t I) {
+      Units[I]->getUnitDIE(/* ExtractUnitDIEOnly = */ false);
+      return 0u;
+    });
+    NumDebugInfoErrors +=
+        verifyInParallel(Units.size(), [&](DWARFVerifier &V, size_t I) {
+          return V.verifyUnitContents(*Units[I]);
+        });
+  }
   if (UnitIdx == 0 && !hasDIE) {
     warn() << "Section is empty.\n";
     isHeaderChainValid = true;
@@ -1441,21 +1468,42 @@ unsigned DWARFVerifier::verifyDebugNames(const DWARFSection &AccelSection,
   // Don't attempt Entry validation if any of the previous checks found errors
   if (NumErrors > 0)
     return NumErrors;
+
+  // The entries are checked against the DIEs of all units, so extract them
+  // and parse the location lists up front; the checks only read them.
+  DCtx.extractAllDIEs(DumpOpts.NumThreads);
+  DCtx.getDebugLoc();
+
+  std::vector<std::pair<const DWARFDebugNames::NameIndex *,
+                        DWARFDebugNames::NameTableEntry>>
+      Entries;
   for (const auto &NI : AccelTable)
     for (DWARFDebugNames::NameTableEntry NTE : NI)
-      NumErrors += verifyNameIndexEntries(NI, NTE);
+      Entries.emplace_back(&NI, NTE);
+  NumErrors +=
+      verifyInParallel(Entries.size(), [&](DWARFVerifier &V, size_t I) {
+        return V.verifyNameIndexEntries(*Entries[I].first, Entries[I].second);
+      });
 
   if (NumErrors > 0)
     return NumErrors;
 
-  for (const std::unique_ptr<DWARFUnit> &U : DCtx.compile_units()) {
+  std::vector<std::pair<DWARFCompileUnit *, const DWARFDebugNames::NameIndex *>>
+      IndexedUnits;
+  for (const std::unique_ptr<DWARFUnit> &U : DCtx.compile_units())
     if (const DWARFDebugNames::NameIndex *NI =
-            AccelTable.getCUNameIndex(U->getOffset())) {
-      auto *CU = cast<DWARFCompileUnit>(U.get());
-      for (const DWARFDebugInfoEntry &Die : CU->dies())
-        NumErrors += verifyNameIndexCompleteness(DWARFDie(CU, &Die), *NI);
-    }
-  }
+            AccelTable.getCUNameIndex(U->getOffset()))
+      IndexedUnits.emplace_back(cast<DWARFCompileUnit>(U.get()), NI);
+  NumErrors +=
+      verifyInParallel(IndexedUnits.size(), [&](DWARFVerifier &V, size_t I) {
+        DWARFCompileUnit *CU = IndexedUnits[I].first;
+        const DWARFDebugNames::NameIndex &NI = *IndexedUnits[I].second;
+        unsigned NumUnitErrors = 0;
+        for (const DWARFDebugInfoEntry &Die : CU->dies())
+          NumUnitErrors +=
+              V.verifyNameIndexCompleteness(DWARFDie(CU, &Die), NI);
+        return NumUnitErrors;
+      });
   return NumErrors;
 }
 
@@ -1491,3 +1539,53 @@ raw_ostream &DWARFVerifier::dump(const DWARFDie &Die, unsigned indent) const {
   Die.dump(OS, indent, DumpOpts);
   return OS;
 }
+
+unsigned DWARFVerifier::verifyInParallel(
+    size_t Count, function_ref<unsigned(DWARFVerifier &, size_t)> Verify) {
+  unsigned NumThreads = DumpOpts.NumThreads;
+  if (NumThreads == 0)
+    NumThreads = heavyweight_hardware_concurrency();
+  if (NumThreads <= 1 || Count <= 1) {
+    unsigned NumErrors = 0;
+    for (size_t I = 0; I != Count; ++I)
+      NumErrors += Verify(*this, I);
+    return NumErrors;
+  }
+
+  // Use a few chunks per thread, so that a chunk with expensive items doesn't
+  // keep the other threads idle.
+  struct Chunk {
+    std::string Output;
+    std::map<uint64_t, std::set<uint64_t>> References;
+    unsigned NumErrors = 0;
+  };
+  std::vector<Chunk> Chunks(std::min<size_t>(Count, NumThreads * 4));
+  size_t ChunkSize = divideCeil(Count, Chunks.size());
+  DIDumpOptions ChunkOpts = DumpOpts;
+  ChunkOpts.NumThreads = 1;
+
+  ThreadPool Pool(std::min<size_t>(NumThreads, Chunks.size()));
+  for (size_t C = 0; C != Chunks.size(); ++C) {
+    Pool.async([&, C]() {
+      Chunk &Ch = Chunks[C];
+      raw_string_ostream ChunkOS(Ch.Output);
+      DWARFVerifier Verifier(ChunkOS, DCtx, ChunkOpts);
+      size_t End = std::min(Count, (C + 1) * ChunkSize);
+      for (size_t I = C * ChunkSize; I < End; ++I)
+        Ch.NumErrors += Verify(Verifier, I);
+      ChunkOS.flush();
+      Ch.References = std::move(Verifier.ReferenceToDIEOffsets);
+    });
+  }
+  Pool.wait();
+
+  unsigned NumErrors = 0;
+  for (Chunk &Ch : Chunks) {
+    OS << Ch.Output;
+    for (auto &Ref : Ch.References)
+      ReferenceToDIEOffsets[Ref.first].insert(Ref.second.begin(),
+                                              Ref.second.end());
+    NumErrors += Ch.NumErrors;
+  }
+  return NumErrors;
+}
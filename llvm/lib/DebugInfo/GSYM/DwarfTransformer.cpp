@@ -0,0 +1,247 @@
+//===- DwarfTransformer.cpp -----------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/DebugInfo/GSYM/DwarfTransformer.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/DebugInfo/DWARF/DWARFCompileUnit.h"
+#include "llvm/DebugInfo/DWARF/DWARFContext.h"
+#include "llvm/DebugInfo/GSYM/FunctionInfo.h"
+#include "llvm/DebugInfo/GSYM/GsymCreator.h"
+#include "llvm/DebugInfo/GSYM/InlineInfo.h"
+#include "llvm/DebugInfo/GSYM/LineTable.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/Threading.h"
+#include "llvm/Support/ThreadPool.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+using namespace llvm;
+using namespace gsym;
+
+struct DwarfTransformer::CUInfo {
+  const DWARFDebugLine::LineTable *LineTable;
+  const char *CompDir;
+  /// Receives the warnings for this unit.
+  raw_ostream *Log = nullptr;
+  /// Maps DWARF file indexes of this unit to GSYM file indexes.
+  DenseMap<uint64_t, uint32_t> FileCache;
+
+  CUInfo(DWARFContext &DICtx, DWARFCompileUnit *CU)
+      : LineTable(DICtx.getLineTableForUnit(CU)),
+        CompDir(CU->getCompilationDir()) {}
+
+  /// Convert a DWARF file index into a GSYM file index, inserting the file
+  /// into \p Gsym the first time it is seen. Returns zero, GSYM's invalid file
+  /// index, if the DWARF file index is unknown.
+  uint32_t getFileIndex(GsymCreator &Gsym, uint64_t DwarfFileIdx) {
+    auto I = FileCache.find(DwarfFileIdx);
+    if (I != FileCache.end())
+      return I->second;
+    std::string Path;
+    uint32_t GsymFileIdx = 0;
+    if (LineTable &&
+        LineTable->getFileNameByIndex(
+            DwarfFileIdx, CompDir,
+            DILineInfoSpecifier::FileLineInfoKind::AbsoluteFilePath, Path))
+      GsymFileIdx = Gsym.insertFile(Path);
+    FileCache[DwarfFileIdx] = GsymFileIdx;
+    return GsymFileIdx;
+  }
+};
+
+/// Add the parts of [Low, High) that are within \p Parent to \p Ranges. GSYM
+/// requires the ranges of an inline function to be contained in the ranges of
+/// its parent.
+static void insertClipped(AddressRanges &Ranges, const AddressRanges &Parent,
+                          uint64_t Low, uint64_t High) {
+  for (const AddressRange &P : Parent) {
+    uint64_t Start = std::max(Low, P.Start);
+    uint64_t End = std::min(High, P.End);
+    if (Start < End)
+      Ranges.insert(AddressRange(Start, End));
+  }
+}
+
+static const char *getFunctionName(DWARFDie Die) {
+  // This follows DW_AT_abstract_origin and DW_AT_specification, and falls
+  // back to the short name if there is no linkage name.
+  return Die.getName(DINameKind::LinkageName);
+}
+
+llvm::Error DwarfTransformer::convert(uint32_t NumThreads) {
+  // DIE extraction is the expensive part of reading the DWARF and can be done
+  // for all units in parallel.
+  DICtx.extractAllDIEs(NumThreads);
+
+  // Parsing the line tables fills a cache that is shared by all units, so do
+  // that before the units are converted.
+  std::vector<std::unique_ptr<CUInfo>> CUs;
+  std::vector<DWARFCompileUnit *> Units;
+  for (const auto &CU : DICtx.compile_units()) {
+    auto *CompileUnit = dyn_cast<DWARFCompileUnit>(CU.get());
+    if (!CompileUnit)
+      continue;
+    CUs.push_back(std::make_unique<CUInfo>(DICtx, CompileUnit));
+    Units.push_back(CompileUnit);
+  }
+
+  if (NumThreads == 0)
+    NumThreads = heavyweight_hardware_concurrency();
+  NumThreads = std::min<uint32_t>(NumThreads, Units.size());
+  if (NumThreads <= 1) {
+    for (size_t I = 0; I < Units.size(); ++I) {
+      CUs[I]->Log = &Log;
+      handleDie(*CUs[I], Units[I]->getUnitDIE(false));
+    }
+  } else {
+    // The GsymCreator is thread safe, everything else a unit's conversion
+    // touches is either read only or owned by its CUInfo. Warnings are
+    // collected per unit and printed in unit order.
+    std::vector<std::string> Warnings(Units.size());
+    ThreadPool Pool(NumThreads);
+    for (size_t I = 0; I < Units.size(); ++I) {
+      Pool.async([this, I, &CUs, &Units, &Warnings]() {
+        CUInfo &CUI = *CUs[I];
+        raw_string_ostream OS(Warnings[I]);
+        CUI.Log = &OS;
+        handleDie(CUI, Units[I]->getUnitDIE(false));
+        OS.flush();
+      });
+    }
+    Pool.wait();
+    for (const std::string &W : Warnings)
+      Log << W;
+  }
+
+  if (NumFunctions == 0)
+    return createStringError(std::errc::invalid_argument,
+                             "no functions with address ranges in the DWARF");
+  return Error::success();
+}
+
+void DwarfTransformer::handleDie(CUInfo &CUI, DWARFDie Die) {
+  if (!Die)
+    return;
+  if (Die.getTag() == dwarf::DW_TAG_subprogram)
+    handleSubprogram(CUI, Die);
+  // Keep looking for subprograms: member functions of local classes are
+  // nested inside the subprogram that declares the class.
+  for (DWARFDie Child : Die.children())
+    handleDie(CUI, Child);
+}
+
+void DwarfTransformer::handleSubprogram(CUInfo &CUI, DWARFDie Die) {
+  Expected<DWARFAddressRangesVector> RangesOrErr = Die.getAddressRanges();
+  if (!RangesOrErr) {
+    consumeError(RangesOrErr.takeError());
+    return;
+  }
+  if (RangesOrErr->empty())
+    return;
+  const char *Name = getFunctionName(Die);
+  if (!Name)
+    return;
+  uint32_t NameIdx = Gsym.insertString(Name);
+
+  for (const DWARFAddressRange &Range : *RangesOrErr) {
+    if (Range.LowPC >= Range.HighPC)
+      continue;
+    FunctionInfo FI(Range.LowPC, Range.HighPC - Range.LowPC, NameIdx);
+    convertLineTable(CUI, FI, Range.SectionIndex);
+
+    // The root of the inline tree stands for the concrete function and has
+    // no name; getInlineStack() relies on that.
+    InlineInfo Root;
+    Root.Ranges.insert(FI.Range);
+    parseInlineInfo(CUI, Die, Root);
+    if (!Root.Children.empty())
+      FI.Inline = std::move(Root);
+
+    Gsym.addFunctionInfo(std::move(FI));
+    ++NumFunctions;
+  }
+}
+
+void DwarfTransformer::parseInlineInfo(CUInfo &CUI, DWARFDie Die,
+                                       InlineInfo &Parent) {
+  for (DWARFDie Child : Die.children()) {
+    switch (Child.getTag()) {
+    case dwarf::DW_TAG_inlined_subroutine: {
+      Expected<DWARFAddressRangesVector> RangesOrErr = Child.getAddressRanges();
+      if (!RangesOrErr) {
+        consumeError(RangesOrErr.takeError());
+        continue;
+      }
+      InlineInfo II;
+      for (const DWARFAddressRange &Range : *RangesOrErr)
+        insertClipped(II.Ranges, Parent.Ranges, Range.LowPC, Range.HighPC);
+      if (II.Ranges.empty()) {
+        if (!RangesOrErr->empty())
+          *CUI.Log << "warning: DIE " << format_hex(Child.getOffset(), 10)
+                   << ": inlined subroutine is outside of its parent's ranges\n";
+        continue;
+      }
+      // A zero name marks the concrete function, so never use it for an
+      // inlined one.
+      const char *Name = getFunctionName(Child);
+      II.Name = Gsym.insertString(Name && *Name ? Name : "<unknown>");
+      II.CallFile = CUI.getFileIndex(
+          Gsym, dwarf::toUnsigned(Child.find(dwarf::DW_AT_call_file), 0));
+      II.CallLine = dwarf::toUnsigned(Child.find(dwarf::DW_AT_call_line), 0);
+      parseInlineInfo(CUI, Child, II);
+      Parent.Children.push_back(std::move(II));
+      break;
+    }
+    case dwarf::DW_TAG_subprogram:
+      // Nested functions are converted by handleDie().
+      break;
+    default:
+      // Lexical blocks and the like can contain inlined subroutines.
+      parseInlineInfo(CUI, Child, Parent);
+      break;
+    }
+  }
+}
+
+void DwarfTransformer::convertLineTable(CUInfo &CUI, FunctionInfo &FI,
+                                        uint64_t SectionIndex) {
+  if (!CUI.LineTable)
+    return;
+  std::vector<uint32_t> RowVector;
+  if (!CUI.LineTable->lookupAddressRange({FI.startAddress(), SectionIndex},
+                                         FI.size(), RowVector))
+    return;
+
+  LineTable LT;
+  for (uint32_t RowIndex : RowVector) {
+    const DWARFDebugLine::Row &Row = CUI.LineTable->Rows[RowIndex];
+    if (Row.EndSequence)
+      continue;
+    // The first row may start before the function; GSYM line tables start at
+    // the function's address.
+    LineEntry LE(std::max(Row.Address.Address, FI.startAddress()),
+                 CUI.getFileIndex(Gsym, Row.File), Row.Line);
+    if (!LT.empty()) {
+      LineEntry &Last = LT[LT.size() - 1];
+      // Like DWARF lookups, use the last row for an address.
+      if (Last.Addr == LE.Addr) {
+        Last = LE;
+        continue;
+      }
+      // Rows that only change the column or flags add nothing for GSYM.
+      if (Last.File == LE.File && Last.Line == LE.Line)
+        continue;
+    }
+    LT.push(LE);
+  }
+  if (!LT.empty())
+    FI.OptLineTable = std::move(LT);
+}
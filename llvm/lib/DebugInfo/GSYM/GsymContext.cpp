@@ -0,0 +1,166 @@
+//===- GsymContext.cpp ----------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/DebugInfo/GSYM/GsymContext.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/DebugInfo/GSYM/FunctionInfo.h"
+#include "llvm/DebugInfo/GSYM/Header.h"
+#include "llvm/DebugInfo/GSYM/InlineInfo.h"
+#include "llvm/DebugInfo/GSYM/LineEntry.h"
+#include "llvm/DebugInfo/GSYM/LineTable.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <algorithm>
+
+using namespace llvm;
+using namespace gsym;
+
+using FileLineInfoKind = DILineInfoSpecifier::FileLineInfoKind;
+using FunctionNameKind = DILineInfoSpecifier::FunctionNameKind;
+
+GsymContext::GsymContext(GsymReader Reader)
+    : DIContext(CK_GSYM), Reader(std::move(Reader)) {}
+
+void GsymContext::dump(raw_ostream &OS, DIDumpOptions DIDumpOpts) {
+  OS << Reader.getHeader() << '\n';
+}
+
+std::string GsymContext::getFilePath(uint32_t Index) const {
+  Optional<FileEntry> File = Reader.getFile(Index);
+  if (Index == 0 || !File)
+    return std::string();
+  StringRef Dir = Reader.getString(File->Dir);
+  StringRef Base = Reader.getString(File->Base);
+  if (Dir.empty())
+    return Base;
+  SmallString<128> Path(Dir);
+  sys::path::append(Path, Base);
+  return Path.str();
+}
+
+LineEntry GsymContext::lookupLine(const FunctionInfo &FI, uint64_t Addr) {
+  if (!FI.OptLineTable)
+    return LineEntry();
+  const LineTable &LT = *FI.OptLineTable;
+  auto It = std::upper_bound(
+      LT.begin(), LT.end(), Addr,
+      [](uint64_t Addr, const LineEntry &LE) { return Addr < LE.Addr; });
+  if (It == LT.begin())
+    return LineEntry();
+  return *std::prev(It);
+}
+
+DILineInfo GsymContext::getLineInfoForAddress(object::SectionedAddress Address,
+                                              DILineInfoSpecifier Specifier) {
+  DILineInfo Result;
+  Expected<FunctionInfo> FI = Reader.getFunctionInfo(Address.Address);
+  if (!FI) {
+    consumeError(FI.takeError());
+    return Result;
+  }
+
+  if (Specifier.FNKind != FunctionNameKind::None) {
+    // Like DWARFContext, report the innermost inlined function.
+    uint32_t Name = FI->Name;
+    if (FI->Inline)
+      if (auto Stack = FI->Inline->getInlineStack(Address.Address))
+        Name = Stack->front()->Name;
+    Result.FunctionName = Reader.getString(Name);
+  }
+
+  LineEntry LE = lookupLine(*FI, Address.Address);
+  if (LE.isValid()) {
+    if (Specifier.FLIKind != FileLineInfoKind::None)
+      Result.FileName = getFilePath(LE.File);
+    Result.Line = LE.Line;
+  }
+  return Result;
+}
+
+DILineInfoTable
+GsymContext::getLineInfoForAddressRange(object::SectionedAddress Address,
+                                        uint64_t Size,
+                                        DILineInfoSpecifier Specifier) {
+  DILineInfoTable Table;
+  uint64_t End = Address.Address + Size;
+  for (uint64_t Addr = Address.Address; Addr < End;) {
+    Expected<FunctionInfo> FI = Reader.getFunctionInfo(Addr);
+    if (!FI) {
+      consumeError(FI.takeError());
+      break;
+    }
+    if (FI->OptLineTable) {
+      // Start with the row that covers the start of the range.
+      uint64_t FirstRowAddr = lookupLine(*FI, Addr).Addr;
+      for (const LineEntry &LE : *FI->OptLineTable) {
+        if (LE.Addr >= End)
+          break;
+        if (LE.Addr < FirstRowAddr)
+          continue;
+        DILineInfo Info;
+        if (Specifier.FNKind != FunctionNameKind::None)
+          Info.FunctionName = Reader.getString(FI->Name);
+        if (Specifier.FLIKind != FileLineInfoKind::None)
+          Info.FileName = getFilePath(LE.File);
+        Info.Line = LE.Line;
+        Table.push_back({std::max(LE.Addr, Addr), Info});
+      }
+    }
+    if (FI->endAddress() <= Addr)
+      break;
+    Addr = FI->endAddress();
+  }
+  return Table;
+}
+
+DIInliningInfo
+GsymContext::getInliningInfoForAddress(object::SectionedAddress Address,
+                                       DILineInfoSpecifier Specifier) {
+  DIInliningInfo InliningInfo;
+  Expected<FunctionInfo> FI = Reader.getFunctionInfo(Address.Address);
+  if (!FI) {
+    consumeError(FI.takeError());
+    return InliningInfo;
+  }
+
+  // The inline stack starts with the innermost inlined function. The caller
+  // of the last entry is the concrete function.
+  InlineInfo::InlineArray Stack;
+  if (FI->Inline)
+    if (auto InlineStack = FI->Inline->getInlineStack(Address.Address))
+      Stack = std::move(*InlineStack);
+
+  // The innermost frame gets its location from the line table, every other
+  // frame from the call site recorded in the inline info of its callee.
+  LineEntry LE = lookupLine(*FI, Address.Address);
+  uint32_t File = LE.File;
+  uint32_t Line = LE.Line;
+  for (size_t I = 0; I <= Stack.size(); ++I) {
+    DILineInfo Frame;
+    if (Specifier.FNKind != FunctionNameKind::None)
+      Frame.FunctionName =
+          Reader.getString(I < Stack.size() ? Stack[I]->Name : FI->Name);
+    if (File != 0) {
+      if (Specifier.FLIKind != FileLineInfoKind::None)
+        Frame.FileName = getFilePath(File);
+      Frame.Line = Line;
+    }
+    InliningInfo.addFrame(Frame);
+    if (I < Stack.size()) {
+      File = Stack[I]->CallFile;
+      Line = Stack[I]->CallLine;
+    }
+  }
+  return InliningInfo;
+}
+
+std::vector<DILocal>
+GsymContext::getLocalsForAddress(object::SectionedAddress Address) {
+  return std::vector<DILocal>();
+}
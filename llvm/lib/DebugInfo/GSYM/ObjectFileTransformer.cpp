@@ -0,0 +1,108 @@
+//===- ObjectFileTransformer.cpp ------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/DebugInfo/GSYM/ObjectFileTransformer.h"
+#include "llvm/BinaryFormat/ELF.h"
+#include "llvm/DebugInfo/GSYM/FunctionInfo.h"
+#include "llvm/DebugInfo/GSYM/GsymCreator.h"
+#include "llvm/Object/ELFObjectFile.h"
+#include "llvm/Object/MachO.h"
+#include "llvm/Object/ObjectFile.h"
+#include "llvm/Support/DataExtractor.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <vector>
+
+using namespace llvm;
+using namespace gsym;
+
+/// Returns the description of the NT_GNU_BUILD_ID note of an ELF object, or
+/// an empty vector if there is none.
+static std::vector<uint8_t> getELFBuildID(const object::ObjectFile &Obj) {
+  for (const object::SectionRef &Sect : Obj.sections()) {
+    Expected<StringRef> NameOrErr = Sect.getName();
+    if (!NameOrErr) {
+      consumeError(NameOrErr.takeError());
+      continue;
+    }
+    if (!NameOrErr->startswith(".note"))
+      continue;
+    Expected<StringRef> ContentsOrErr = Sect.getContents();
+    if (!ContentsOrErr) {
+      consumeError(ContentsOrErr.takeError());
+      continue;
+    }
+    DataExtractor Data(*ContentsOrErr, Obj.isLittleEndian(), 4);
+    uint64_t Offset = 0;
+    while (Data.isValidOffsetForDataOfSize(Offset, 12)) {
+      uint32_t NameSize = Data.getU32(&Offset);
+      uint32_t DescSize = Data.getU32(&Offset);
+      uint32_t Type = Data.getU32(&Offset);
+      StringRef Name = Data.getData().substr(Offset, NameSize);
+      Offset += alignTo(NameSize, 4);
+      if (!Data.isValidOffsetForDataOfSize(Offset, DescSize))
+        break;
+      if (Type == ELF::NT_GNU_BUILD_ID && Name == StringRef("GNU\0", 4)) {
+        const uint8_t *Desc = Data.getData().bytes_begin() + Offset;
+        return std::vector<uint8_t>(Desc, Desc + DescSize);
+      }
+      Offset += alignTo(DescSize, 4);
+    }
+  }
+  return std::vector<uint8_t>();
+}
+
+static std::vector<uint8_t> getUUID(const object::ObjectFile &Obj) {
+  if (auto *MachO = dyn_cast<object::MachOObjectFile>(&Obj)) {
+    ArrayRef<uint8_t> UUID = MachO->getUuid();
+    return std::vector<uint8_t>(UUID.begin(), UUID.end());
+  }
+  if (isa<object::ELFObjectFileBase>(&Obj))
+    return getELFBuildID(Obj);
+  return std::vector<uint8_t>();
+}
+
+llvm::Error ObjectFileTransformer::convert(const object::ObjectFile &Obj,
+                                           raw_ostream &Log,
+                                           GsymCreator &Gsym) {
+  std::vector<uint8_t> UUID = getUUID(Obj);
+  // The GSYM header has room for a 20 byte SHA1 build ID.
+  if (!UUID.empty() && UUID.size() <= 20)
+    Gsym.setUUID(UUID);
+
+  const auto *ELF = dyn_cast<object::ELFObjectFileBase>(&Obj);
+  for (const object::SymbolRef &Sym : Obj.symbols()) {
+    Expected<object::SymbolRef::Type> TypeOrErr = Sym.getType();
+    if (!TypeOrErr) {
+      consumeError(TypeOrErr.takeError());
+      continue;
+    }
+    if (*TypeOrErr != object::SymbolRef::ST_Function)
+      continue;
+    if (Sym.getFlags() & object::SymbolRef::SF_Undefined)
+      continue;
+    Expected<uint64_t> AddrOrErr = Sym.getAddress();
+    if (!AddrOrErr)
+      return AddrOrErr.takeError();
+    Expected<StringRef> NameOrErr = Sym.getName();
+    if (!NameOrErr) {
+      Log << "warning: skipping symbol at " << format_hex(*AddrOrErr, 18)
+          << ": " << toString(NameOrErr.takeError()) << '\n';
+      continue;
+    }
+    if (NameOrErr->empty())
+      continue;
+    // Only ELF symbols have a size. GsymCreator::finalize() drops zero sized
+    // symbols that are covered by other function infos.
+    uint64_t Size = ELF ? object::ELFSymbolRef(Sym).getSize() : 0;
+    Gsym.addFunctionInfo(
+        FunctionInfo(*AddrOrErr, Size, Gsym.insertString(*NameOrErr)));
+  }
+  return Error::success();
+}
@@ -16,6 +16,7 @@
 #include "llvm/ADT/Triple.h"
 #include "llvm/BinaryFormat/COFF.h"
 #include "llvm/DebugInfo/DWARF/DWARFContext.h"
+#include "llvm/DebugInfo/GSYM/GsymContext.h"
 #include "llvm/DebugInfo/Symbolize/SymbolizableModule.h"
 #include "llvm/Object/COFF.h"
 #include "llvm/Object/ObjectFile.h"
@@ -219,6 +220,11 @@ uint64_t SymbolizableObjectFile::getModulePreferredBase() const {
   return 0;
 }
 
+bool SymbolizableObjectFile::isThreadSafe() const {
+  // Demangling names of Win32 modules isn't thread-safe either.
+  return isa<gsym::GsymContext>(DebugInfoContext.get()) && !isWin32Module();
+}
+
 bool SymbolizableObjectFile::getNameFromSymbolTable(SymbolRef::Type Type,
                                                     uint64_t Address,
                                                     std::string &Name,
@@ -246,7 +252,8 @@ bool SymbolizableObjectFile::shouldOverrideWithSymbolTable(
   // probably using PEs and PDBs, and we shouldn't do the override. PE files
   // generally only contain the names of exported symbols.
   return FNKind == FunctionNameKind::LinkageName && UseSymbolTable &&
-         isa<DWARFContext>(DebugInfoContext.get());
+         (isa<DWARFContext>(DebugInfoContext.get()) ||
+          isa<gsym::GsymContext>(DebugInfoContext.get()));
 }
 
 DILineInfo
@@ -51,6 +51,10 @@ public:
   // it in memory assuming there were no conflicts.
   uint64_t getModulePreferredBase() const override;
 
+  // GSYM lookups and the symbol table are read-only; the other DIContexts
+  // parse debug info lazily.
+  bool isThreadSafe() const override;
+
 private:
   bool shouldOverrideWithSymbolTable(FunctionNameKind FNKind,
                                      bool UseSymbolTable) const;
@@ -17,6 +17,11 @@
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/BinaryFormat/COFF.h"
 #include "llvm/DebugInfo/DWARF/DWARFContext.h"
+#include "llvm/DebugInfo/GSYM/DwarfTransformer.h"
+#include "llvm/DebugInfo/GSYM/FileWriter.h"
+#include "llvm/DebugInfo/GSYM/GsymContext.h"
+#include "llvm/DebugInfo/GSYM/GsymCreator.h"
+#include "llvm/DebugInfo/GSYM/GsymReader.h"
 #include "llvm/DebugInfo/PDB/PDB.h"
 #include "llvm/DebugInfo/PDB/PDBContext.h"
 #include "llvm/Demangle/Demangle.h"
@@ -31,6 +36,8 @@
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/Support/xxhash.h"
 #include <algorithm>
 #include <cassert>
 #include <cstring>
@@ -58,6 +65,7 @@ LLVMSymbolizer::symbolizeCodeCommon(SymbolizableModule *Info,
   // result.
   if (!Info)
     return DILineInfo();
+  auto Lock = lockModule(Info);
 
   // If the user is giving us relative addresses, add the preferred base of the
   // object to the offset before we do the query. It's what DIContext expects.
@@ -75,17 +83,23 @@ Expected<DILineInfo>
 LLVMSymbolizer::symbolizeCode(const ObjectFile &Obj,
                               object::SectionedAddress ModuleOffset) {
   StringRef ModuleName = Obj.getFileName();
-  auto I = Modules.find(ModuleName);
-  if (I != Modules.end())
-    return symbolizeCodeCommon(I->second.get(), ModuleOffset);
-
-  std::unique_ptr<DIContext> Context =
-        DWARFContext::create(Obj, nullptr, DWARFContext::defaultErrorHandler);
-  Expected<SymbolizableModule *> InfoOrErr =
-                     createModuleInfo(&Obj, std::move(Context), ModuleName);
-  if (!InfoOrErr)
-    return InfoOrErr.takeError();
-  return symbolizeCodeCommon(*InfoOrErr, ModuleOffset);
+  SymbolizableModule *Info;
+  {
+    std::lock_guard<std::mutex> Lock(ModulesMutex);
+    auto I = Modules.find(ModuleName);
+    if (I != Modules.end()) {
+      Info = I->second.get();
+    } else {
+      std::unique_ptr<DIContext> Context = DWARFContext::create(
+          Obj, nullptr, DWARFContext::defaultErrorHandler);
+      Expected<SymbolizableModule *> InfoOrErr =
+          createModuleInfo(&Obj, std::move(Context), ModuleName);
+      if (!InfoOrErr)
+        return InfoOrErr.takeError();
+      Info = *InfoOrErr;
+    }
+  }
+  return symbolizeCodeCommon(Info, ModuleOffset);
 }
 
 Expected<DILineInfo>
@@ -110,6 +124,7 @@ LLVMSymbolizer::symbolizeInlinedCode(const std::string &ModuleName,
   // result.
   if (!Info)
     return DIInliningInfo();
+  auto Lock = lockModule(Info);
 
   // If the user is giving us relative addresses, add the preferred base of the
   // object to the offset before we do the query. It's what DIContext expects.
@@ -140,6 +155,7 @@ LLVMSymbolizer::symbolizeData(const std::string &ModuleName,
   // result.
   if (!Info)
     return DIGlobal();
+  auto Lock = lockModule(Info);
 
   // If the user is giving us relative addresses, add the preferred base of
   // the object to the offset before we do the query. It's what DIContext
@@ -166,6 +182,7 @@ LLVMSymbolizer::symbolizeFrame(const std::string &ModuleName,
   // result.
   if (!Info)
     return std::vector<DILocal>();
+  auto Lock = lockModule(Info);
 
   // If the user is giving us relative addresses, add the preferred base of
   // the object to the offset before we do the query. It's what DIContext
@@ -177,6 +194,7 @@ LLVMSymbolizer::symbolizeFrame(const std::string &ModuleName,
 }
 
 void LLVMSymbolizer::flush() {
+  std::lock_guard<std::mutex> Lock(ModulesMutex);
   ObjectForUBPathAndArch.clear();
   BinaryForPath.clear();
   ObjectPairForPathArch.clear();
@@ -437,6 +455,7 @@ LLVMSymbolizer::createModuleInfo(const ObjectFile *Obj,
 
 Expected<SymbolizableModule *>
 LLVMSymbolizer::getOrCreateModuleInfo(const std::string &ModuleName) {
+  std::lock_guard<std::mutex> Lock(ModulesMutex);
   auto I = Modules.find(ModuleName);
   if (I != Modules.end())
     return I->second.get();
@@ -479,6 +498,8 @@ LLVMSymbolizer::getOrCreateModuleInfo(const std::string &ModuleName) {
       Context.reset(new PDBContext(*CoffObject, std::move(Session)));
     }
   }
+  if (!Context && Opts.UseGSYM)
+    Context = createGsymContext(*Objects.second);
   if (!Context)
     Context =
         DWARFContext::create(*Objects.second, nullptr,
@@ -488,6 +509,104 @@ LLVMSymbolizer::getOrCreateModuleInfo(const std::string &ModuleName) {
 
 namespace {
 
+// The name of the cached GSYM file for Obj. It identifies the object by its
+// path, architecture, size and modification time, so a rebuilt object gets
+// a new GSYM file.
+Optional<std::string> getGsymCacheFileName(const ObjectFile &Obj) {
+  SmallString<128> Path(Obj.getFileName());
+  if (sys::fs::make_absolute(Path))
+    return None;
+  sys::fs::file_status Status;
+  if (sys::fs::status(Path, Status))
+    return None;
+  std::string Key;
+  raw_string_ostream KeyOS(Key);
+  KeyOS << Path << '\0' << Triple::getArchTypeName(Obj.getArch()) << '\0'
+        << Status.getSize() << '\0'
+        << Status.getLastModificationTime().time_since_epoch().count();
+  return (sys::path::filename(Path) + "-" +
+          utohexstr(xxHash64(KeyOS.str()), /*LowerCase=*/true) + ".gsym")
+      .str();
+}
+
+} // namespace
+
+std::unique_ptr<DIContext>
+LLVMSymbolizer::createGsymContext(const ObjectFile &DebugObj) {
+  SmallString<128> CachePath;
+  if (!Opts.GsymCacheDir.empty()) {
+    if (Optional<std::string> FileName = getGsymCacheFileName(DebugObj)) {
+      CachePath = Opts.GsymCacheDir;
+      sys::path::append(CachePath, *FileName);
+    }
+  }
+  if (!CachePath.empty()) {
+    Expected<gsym::GsymReader> ReaderOrErr =
+        gsym::GsymReader::openFile(CachePath);
+    if (ReaderOrErr)
+      return std::make_unique<gsym::GsymContext>(std::move(*ReaderOrErr));
+    consumeError(ReaderOrErr.takeError());
+  }
+
+  std::unique_ptr<DWARFContext> DICtx = DWARFContext::create(
+      DebugObj, nullptr, DWARFContext::defaultErrorHandler, Opts.DWPName);
+  gsym::GsymCreator Gsym;
+  gsym::DwarfTransformer Transformer(*DICtx, nulls(), Gsym);
+  if (Error E = Transformer.convert(/*NumThreads=*/0)) {
+    consumeError(std::move(E));
+    return nullptr;
+  }
+  if (Error E = Gsym.finalize(nulls())) {
+    consumeError(std::move(E));
+    return nullptr;
+  }
+
+  if (!CachePath.empty()) {
+    // Write to a temporary file first so that concurrent symbolizers never
+    // see a partially written GSYM file.
+    SmallString<128> TmpPath;
+    sys::fs::createUniquePath(CachePath + "-%%%%%%.tmp", TmpPath,
+                              /*MakeAbsolute=*/false);
+    sys::fs::create_directories(Opts.GsymCacheDir);
+    if (Error E = Gsym.save(TmpPath, support::endian::system_endianness())) {
+      consumeError(std::move(E));
+      sys::fs::remove(TmpPath);
+    } else if (sys::fs::rename(TmpPath, CachePath)) {
+      sys::fs::remove(TmpPath);
+    } else {
+      Expected<gsym::GsymReader> ReaderOrErr =
+          gsym::GsymReader::openFile(CachePath);
+      if (ReaderOrErr)
+        return std::make_unique<gsym::GsymContext>(std::move(*ReaderOrErr));
+      consumeError(ReaderOrErr.takeError());
+    }
+  }
+
+  // No usable cache; keep the GSYM data in memory.
+  SmallString<0> Buffer;
+  raw_svector_ostream OS(Buffer);
+  gsym::FileWriter Writer(OS, support::endian::system_endianness());
+  if (Error E = Gsym.encode(Writer)) {
+    consumeError(std::move(E));
+    return nullptr;
+  }
+  Expected<gsym::GsymReader> ReaderOrErr = gsym::GsymReader::copyBuffer(Buffer);
+  if (!ReaderOrErr) {
+    consumeError(ReaderOrErr.takeError());
+    return nullptr;
+  }
+  return std::make_unique<gsym::GsymContext>(std::move(*ReaderOrErr));
+}
+
+std::unique_lock<std::mutex>
+LLVMSymbolizer::lockModule(const SymbolizableModule *Info) {
+  if (Info->isThreadSafe())
+    return std::unique_lock<std::mutex>(QueryMutex, std::defer_lock);
+  return std::unique_lock<std::mutex>(QueryMutex);
+}
+
+namespace {
+
 // Undo these various manglings for Win32 extern "C" functions:
 // cdecl       - _foo
 // stdcall     - _foo@12
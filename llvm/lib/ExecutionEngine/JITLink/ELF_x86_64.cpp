@@ -0,0 +1,538 @@
+//===----- ELF_x86_64.cpp - JIT linker implementation for ELF/x86-64 ------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// ELF/x86-64 jit-link implementation.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/ExecutionEngine/JITLink/ELF_x86_64.h"
+#include "llvm/Object/ELF.h"
+
+#include "BasicGOTAndStubsBuilder.h"
+#include "JITLinkGeneric.h"
+
+#define DEBUG_TYPE "jitlink"
+
+using namespace llvm;
+using namespace llvm::jitlink;
+using namespace llvm::jitlink::ELF_x86_64_Edges;
+
+static const char *CommonSectionName = "__common";
+
+namespace {
+
+class ELFLinkGraphBuilder_x86_64 {
+public:
+  using ELFT = object::ELF64LE;
+
+  ELFLinkGraphBuilder_x86_64(StringRef FileName,
+                             const object::ELFFile<ELFT> &Obj)
+      : Obj(Obj), G(std::make_unique<LinkGraph>(FileName.str(), 8,
+                                                support::little)) {}
+
+  Expected<std::unique_ptr<LinkGraph>> buildGraph() {
+    // Sanity check: we only operate on relocatable objects.
+    if (Obj.getHeader()->e_type != ELF::ET_REL)
+      return make_error<JITLinkError>("Object is not a relocatable ELF");
+
+    if (auto SectionsOrErr = Obj.sections())
+      Sections = *SectionsOrErr;
+    else
+      return SectionsOrErr.takeError();
+
+    if (auto Err = graphifySections())
+      return std::move(Err);
+
+    if (auto Err = graphifySymbols())
+      return std::move(Err);
+
+    if (auto Err = addRelocations())
+      return std::move(Err);
+
+    return std::move(G);
+  }
+
+private:
+  using Elf_Shdr = ELFT::Shdr;
+  using Elf_Sym = ELFT::Sym;
+  using Elf_Rela = ELFT::Rela;
+
+  static sys::Memory::ProtectionFlags getProtection(const Elf_Shdr &Sec) {
+    unsigned Prot = sys::Memory::MF_READ;
+    if (Sec.sh_flags & ELF::SHF_WRITE)
+      Prot |= sys::Memory::MF_WRITE;
+    if (Sec.sh_flags & ELF::SHF_EXECINSTR)
+      Prot |= sys::Memory::MF_EXEC;
+    return static_cast<sys::Memory::ProtectionFlags>(Prot);
+  }
+
+  static Linkage getLinkage(const Elf_Sym &Sym) {
+    return Sym.getBinding() == ELF::STB_WEAK ? Linkage::Weak : Linkage::Strong;
+  }
+
+  static Scope getScope(const Elf_Sym &Sym) {
+    if (Sym.getBinding() == ELF::STB_LOCAL)
+      return Scope::Local;
+    if (Sym.getVisibility() == ELF::STV_HIDDEN ||
+        Sym.getVisibility() == ELF::STV_INTERNAL)
+      return Scope::Hidden;
+    return Scope::Default;
+  }
+
+  // Relocatable objects leave all the section addresses at zero: lay the
+  // sections out one after the other so that every block gets a distinct
+  // address before the final layout.
+  JITTargetAddress getNextAddress(uint64_t Size, uint64_t Alignment) {
+    JITTargetAddress Address =
+        alignTo(NextAddress, std::max<uint64_t>(Alignment, 1));
+    NextAddress = Address + Size;
+    return Address;
+  }
+
+  Error graphifySections() {
+    for (unsigned Idx = 0, E = Sections.size(); Idx != E; ++Idx) {
+      const Elf_Shdr &Sec = Sections[Idx];
+
+      if (Sec.sh_type == ELF::SHT_SYMTAB) {
+        if (SymTabSec)
+          return make_error<JITLinkError>("Multiple SHT_SYMTAB sections");
+        SymTabSec = &Sec;
+        continue;
+      }
+
+      // Only the sections loaded at runtime are part of the graph.
+      if (!(Sec.sh_flags & ELF::SHF_ALLOC))
+        continue;
+
+      auto Name = Obj.getSectionName(&Sec);
+      if (!Name)
+        return Name.takeError();
+
+      if (Sec.sh_flags & ELF::SHF_TLS)
+        return make_error<JITLinkError>("TLS section " + *Name +
+                                        " is not supported");
+
+      LLVM_DEBUG({
+        dbgs() << "Creating section for \"" << *Name << "\" ("
+               << formatv("{0:d}", Idx) << ")\n";
+      });
+
+      auto &GraphSec = G->createSection(*Name, getProtection(Sec));
+      JITTargetAddress Address = getNextAddress(Sec.sh_size, Sec.sh_addralign);
+      Block *B;
+      if (Sec.sh_type == ELF::SHT_NOBITS)
+        B = &G->createZeroFillBlock(GraphSec, Sec.sh_size, Address,
+                                    std::max<uint64_t>(Sec.sh_addralign, 1),
+                                    0);
+      else {
+        auto Content = Obj.getSectionContents(&Sec);
+        if (!Content)
+          return Content.takeError();
+        B = &G->createContentBlock(
+            GraphSec,
+            StringRef(reinterpret_cast<const char *>(Content->data()),
+                      Content->size()),
+            Address, std::max<uint64_t>(Sec.sh_addralign, 1), 0);
+      }
+      GraphBlocks[Idx] = B;
+
+      // Nothing refers to the unwind information: keep it alive for as long
+      // as the object, it is registered with the unwinder as a whole.
+      if (*Name == ".eh_frame")
+        G->addAnonymousSymbol(*B, 0, B->getSize(), false, true);
+    }
+
+    return Error::success();
+  }
+
+  Error graphifySymbols() {
+    if (!SymTabSec)
+      return Error::success();
+
+    auto Symbols = Obj.symbols(SymTabSec);
+    if (!Symbols)
+      return Symbols.takeError();
+    auto StrTab = Obj.getStringTableForSymtab(*SymTabSec, Sections);
+    if (!StrTab)
+      return StrTab.takeError();
+
+    // Entry zero is the null symbol.
+    for (unsigned Idx = 1, E = Symbols->size(); Idx < E; ++Idx) {
+      const Elf_Sym &Sym = (*Symbols)[Idx];
+
+      if (Sym.getType() == ELF::STT_FILE)
+        continue;
+      if (Sym.getType() == ELF::STT_TLS)
+        return make_error<JITLinkError>("TLS symbols are not supported");
+
+      auto Name = Sym.getName(*StrTab);
+      if (!Name)
+        return Name.takeError();
+
+      LLVM_DEBUG({
+        dbgs() << "Adding symbol " << formatv("{0:d}", Idx) << ": \"" << *Name
+               << "\", section = " << Sym.st_shndx
+               << ", value = " << formatv("{0:x16}", Sym.st_value) << "\n";
+      });
+
+      Symbol *GraphSym = nullptr;
+      if (Sym.isUndefined()) {
+        // Compilers reference the GOT base even when no relocation needs it.
+        // The relocations relative to it are not supported, and would fail
+        // to find it.
+        if (Name->empty() || *Name == "_GLOBAL_OFFSET_TABLE_")
+          continue;
+        GraphSym = &G->addExternalSymbol(*Name, Sym.st_size);
+      } else if (Sym.isAbsolute()) {
+        GraphSym = &G->addAbsoluteSymbol(*Name, Sym.st_value, Sym.st_size,
+                                         getLinkage(Sym), getScope(Sym), false);
+      } else if (Sym.isCommon()) {
+        // The value of a common symbol is its alignment.
+        if (!CommonSection) {
+          auto Prot = static_cast<sys::Memory::ProtectionFlags>(
+              sys::Memory::MF_READ | sys::Memory::MF_WRITE);
+          CommonSection = &G->createSection(CommonSectionName, Prot);
+        }
+        GraphSym = &G->addCommonSymbol(
+            *Name, getScope(Sym), *CommonSection,
+            getNextAddress(Sym.st_size, Sym.st_value), Sym.st_size,
+            Sym.st_value, false);
+      } else {
+        if (Sym.st_shndx == ELF::SHN_XINDEX)
+          return make_error<JITLinkError>(
+              "Extended section indices are not supported");
+        auto BI = GraphBlocks.find(Sym.st_shndx);
+        // Symbols of the sections that are not loaded are not needed.
+        if (BI == GraphBlocks.end())
+          continue;
+        Block &B = *BI->second;
+
+        if (Sym.st_value > B.getSize())
+          return make_error<JITLinkError>("Symbol " + *Name +
+                                          " is outside of its section");
+
+        if (Sym.getType() == ELF::STT_SECTION || Name->empty())
+          GraphSym = &G->addAnonymousSymbol(B, Sym.st_value, Sym.st_size,
+                                            false, false);
+        else
+          GraphSym = &G->addDefinedSymbol(
+              B, Sym.st_value, *Name, Sym.st_size, getLinkage(Sym),
+              getScope(Sym), Sym.getType() == ELF::STT_FUNC, false);
+      }
+
+      GraphSymbols[Idx] = GraphSym;
+    }
+
+    return Error::success();
+  }
+
+  static Expected<ELFX86RelocationKind> getRelocationKind(uint32_t Type) {
+    switch (Type) {
+    case ELF::R_X86_64_PLT32:
+      return Branch32;
+    case ELF::R_X86_64_32:
+      return Pointer32;
+    case ELF::R_X86_64_32S:
+      return Pointer32Signed;
+    case ELF::R_X86_64_64:
+      return Pointer64;
+    case ELF::R_X86_64_PC32:
+      return PCRel32;
+    case ELF::R_X86_64_GOTPCREL:
+    case ELF::R_X86_64_GOTPCRELX:
+    case ELF::R_X86_64_REX_GOTPCRELX:
+      return PCRel32GOTLoad;
+    case ELF::R_X86_64_PC64:
+      return Delta64;
+    }
+
+    return make_error<JITLinkError>("Unsupported x86-64 relocation: type=" +
+                                    formatv("{0:d}", Type));
+  }
+
+  Error addRelocations() {
+    for (auto &Sec : Sections) {
+      if (Sec.sh_type == ELF::SHT_REL)
+        return make_error<JITLinkError>(
+            "SHT_REL relocations are not supported on x86-64");
+      if (Sec.sh_type != ELF::SHT_RELA)
+        continue;
+
+      // Skip the relocations of the sections that are not loaded.
+      auto BI = GraphBlocks.find(Sec.sh_info);
+      if (BI == GraphBlocks.end())
+        continue;
+      Block &BlockToFix = *BI->second;
+
+      auto Relocations = Obj.relas(&Sec);
+      if (!Relocations)
+        return Relocations.takeError();
+
+      for (const Elf_Rela &Rel : *Relocations) {
+        uint32_t Type = Rel.getType(false);
+        if (Type == ELF::R_X86_64_NONE)
+          continue;
+
+        auto Kind = getRelocationKind(Type);
+        if (!Kind)
+          return Kind.takeError();
+
+        auto SI = GraphSymbols.find(Rel.getSymbol(false));
+        if (SI == GraphSymbols.end())
+          return make_error<JITLinkError>(
+              "Relocation references a symbol that is not loaded: index=" +
+              formatv("{0:d}", Rel.getSymbol(false)));
+        Symbol &TargetSymbol = *SI->second;
+
+        uint64_t Size = (*Kind == Pointer64 || *Kind == Delta64) ? 8 : 4;
+        if (Rel.r_offset + Size > BlockToFix.getSize())
+          return make_error<JITLinkError>(
+              "Relocation extends past end of fixup block");
+
+        // The addend of the PC-relative relocations is relative to the fixup,
+        // our edges are relative to the end of the 32-bit field.
+        int64_t Addend = Rel.r_addend;
+        if (*Kind == Branch32 || *Kind == PCRel32 || *Kind == PCRel32GOTLoad)
+          Addend += 4;
+
+        LLVM_DEBUG({
+          Edge GE(*Kind, Rel.r_offset, TargetSymbol, Addend);
+          printEdge(dbgs(), BlockToFix, GE, getELFX86RelocationKindName(*Kind));
+          dbgs() << "\n";
+        });
+        BlockToFix.addEdge(*Kind, Rel.r_offset, TargetSymbol, Addend);
+      }
+    }
+    return Error::success();
+  }
+
+  const object::ELFFile<ELFT> &Obj;
+  std::unique_ptr<LinkGraph> G;
+  ArrayRef<Elf_Shdr> Sections;
+  const Elf_Shdr *SymTabSec = nullptr;
+  DenseMap<unsigned, Block *> GraphBlocks;
+  DenseMap<unsigned, Symbol *> GraphSymbols;
+  Section *CommonSection = nullptr;
+  JITTargetAddress NextAddress = 0;
+};
+
+class ELF_x86_64_GOTAndStubsBuilder
+    : public BasicGOTAndStubsBuilder<ELF_x86_64_GOTAndStubsBuilder> {
+public:
+  ELF_x86_64_GOTAndStubsBuilder(LinkGraph &G)
+      : BasicGOTAndStubsBuilder<ELF_x86_64_GOTAndStubsBuilder>(G) {}
+
+  bool isGOTEdge(Edge &E) const { return E.getKind() == PCRel32GOTLoad; }
+
+  Symbol &createGOTEntry(Symbol &Target) {
+    auto &GOTEntryBlock = G.createContentBlock(
+        getGOTSection(), getGOTEntryBlockContent(), 0, 8, 0);
+    GOTEntryBlock.addEdge(Pointer64, 0, Target, 0);
+    return G.addAnonymousSymbol(GOTEntryBlock, 0, 8, false, false);
+  }
+
+  void fixGOTEdge(Edge &E, Symbol &GOTEntry) {
+    assert(E.getKind() == PCRel32GOTLoad && "Not a GOT edge?");
+    E.setKind(PCRel32);
+    E.setTarget(GOTEntry);
+    // Leave the edge addend as-is.
+  }
+
+  bool isExternalBranchEdge(Edge &E) {
+    return E.getKind() == Branch32 && !E.getTarget().isDefined();
+  }
+
+  Symbol &createStub(Symbol &Target) {
+    auto &StubContentBlock =
+        G.createContentBlock(getStubsSection(), getStubBlockContent(), 0, 1, 0);
+    // Re-use GOT entries for stub targets.
+    auto &GOTEntrySymbol = getGOTEntrySymbol(Target);
+    StubContentBlock.addEdge(PCRel32, 2, GOTEntrySymbol, 0);
+    return G.addAnonymousSymbol(StubContentBlock, 0, 6, true, false);
+  }
+
+  void fixExternalBranchEdge(Edge &E, Symbol &Stub) {
+    assert(E.getKind() == Branch32 && "Not a Branch32 edge?");
+    assert(E.getAddend() == 0 && "Branch32 edge has non-zero addend?");
+    E.setTarget(Stub);
+  }
+
+private:
+  Section &getGOTSection() {
+    if (!GOTSection)
+      GOTSection = &G.createSection("$__GOT", sys::Memory::MF_READ);
+    return *GOTSection;
+  }
+
+  Section &getStubsSection() {
+    if (!StubsSection) {
+      auto StubsProt = static_cast<sys::Memory::ProtectionFlags>(
+          sys::Memory::MF_READ | sys::Memory::MF_EXEC);
+      StubsSection = &G.createSection("$__STUBS", StubsProt);
+    }
+    return *StubsSection;
+  }
+
+  StringRef getGOTEntryBlockContent() {
+    return StringRef(reinterpret_cast<const char *>(NullGOTEntryContent),
+                     sizeof(NullGOTEntryContent));
+  }
+
+  StringRef getStubBlockContent() {
+    return StringRef(reinterpret_cast<const char *>(StubContent),
+                     sizeof(StubContent));
+  }
+
+  static const uint8_t NullGOTEntryContent[8];
+  static const uint8_t StubContent[6];
+  Section *GOTSection = nullptr;
+  Section *StubsSection = nullptr;
+};
+
+const uint8_t ELF_x86_64_GOTAndStubsBuilder::NullGOTEntryContent[8] = {
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00};
+const uint8_t ELF_x86_64_GOTAndStubsBuilder::StubContent[6] = {
+    0xFF, 0x25, 0x00, 0x00, 0x00, 0x00};
+} // namespace
+
+namespace llvm {
+namespace jitlink {
+
+class ELFJITLinker_x86_64 : public JITLinker<ELFJITLinker_x86_64> {
+  friend class JITLinker<ELFJITLinker_x86_64>;
+
+public:
+  ELFJITLinker_x86_64(std::unique_ptr<JITLinkContext> Ctx,
+                      PassConfiguration PassConfig)
+      : JITLinker(std::move(Ctx), std::move(PassConfig)) {}
+
+private:
+  StringRef getEdgeKindName(Edge::Kind R) const override {
+    return getELFX86RelocationKindName(R);
+  }
+
+  Expected<std::unique_ptr<LinkGraph>>
+  buildGraph(MemoryBufferRef ObjBuffer) override {
+    auto ELFObj =
+        object::ELFFile<object::ELF64LE>::create(ObjBuffer.getBuffer());
+    if (!ELFObj)
+      return ELFObj.takeError();
+    return ELFLinkGraphBuilder_x86_64(ObjBuffer.getBufferIdentifier(), *ELFObj)
+        .buildGraph();
+  }
+
+  static Error targetOutOfRangeError(const Block &B, const Edge &E) {
+    std::string ErrMsg;
+    {
+      raw_string_ostream ErrStream(ErrMsg);
+      ErrStream << "Relocation target out of range: ";
+      printEdge(ErrStream, B, E, getELFX86RelocationKindName(E.getKind()));
+      ErrStream << "\n";
+    }
+    return make_error<JITLinkError>(std::move(ErrMsg));
+  }
+
+  Error applyFixup(Block &B, const Edge &E, char *BlockWorkingMem) const {
+
+    using namespace support;
+
+    char *FixupPtr = BlockWorkingMem + E.getOffset();
+    JITTargetAddress FixupAddress = B.getAddress() + E.getOffset();
+
+    switch (E.getKind()) {
+    case Branch32:
+    case PCRel32: {
+      int64_t Value =
+          E.getTarget().getAddress() - (FixupAddress + 4) + E.getAddend();
+      if (Value < std::numeric_limits<int32_t>::min() ||
+          Value > std::numeric_limits<int32_t>::max())
+        return targetOutOfRangeError(B, E);
+      *(little32_t *)FixupPtr = Value;
+      break;
+    }
+    case Pointer64: {
+      uint64_t Value = E.getTarget().getAddress() + E.getAddend();
+      *(ulittle64_t *)FixupPtr = Value;
+      break;
+    }
+    case Pointer32: {
+      uint64_t Value = E.getTarget().getAddress() + E.getAddend();
+      if (Value > std::numeric_limits<uint32_t>::max())
+        return targetOutOfRangeError(B, E);
+      *(ulittle32_t *)FixupPtr = Value;
+      break;
+    }
+    case Pointer32Signed: {
+      int64_t Value = E.getTarget().getAddress() + E.getAddend();
+      if (Value < std::numeric_limits<int32_t>::min() ||
+          Value > std::numeric_limits<int32_t>::max())
+        return targetOutOfRangeError(B, E);
+      *(little32_t *)FixupPtr = Value;
+      break;
+    }
+    case Delta64: {
+      int64_t Value = E.getTarget().getAddress() - FixupAddress + E.getAddend();
+      *(little64_t *)FixupPtr = Value;
+      break;
+    }
+    default:
+      llvm_unreachable("Unrecognized edge kind");
+    }
+
+    return Error::success();
+  }
+};
+
+void jitLink_ELF_x86_64(std::unique_ptr<JITLinkContext> Ctx) {
+  PassConfiguration Config;
+  Triple TT("x86_64-unknown-linux");
+
+  if (Ctx->shouldAddDefaultTargetPasses(TT)) {
+    // Add a mark-live pass.
+    if (auto MarkLive = Ctx->getMarkLivePass(TT))
+      Config.PrePrunePasses.push_back(std::move(MarkLive));
+    else
+      Config.PrePrunePasses.push_back(markAllSymbolsLive);
+
+    // Add an in-place GOT/Stubs pass.
+    Config.PostPrunePasses.push_back([](LinkGraph &G) -> Error {
+      ELF_x86_64_GOTAndStubsBuilder(G).run();
+      return Error::success();
+    });
+  }
+
+  if (auto Err = Ctx->modifyPassConfig(TT, Config))
+    return Ctx->notifyFailed(std::move(Err));
+
+  // Construct a JITLinker and run the link function.
+  ELFJITLinker_x86_64::link(std::move(Ctx), std::move(Config));
+}
+
+StringRef getELFX86RelocationKindName(Edge::Kind R) {
+  switch (R) {
+  case Branch32:
+    return "Branch32";
+  case Pointer32:
+    return "Pointer32";
+  case Pointer32Signed:
+    return "Pointer32Signed";
+  case Pointer64:
+    return "Pointer64";
+  case PCRel32:
+    return "PCRel32";
+  case PCRel32GOTLoad:
+    return "PCRel32GOTLoad";
+  case Delta64:
+    return "Delta64";
+  default:
+    return getGenericEdgeKindName(static_cast<Edge::Kind>(R));
+  }
+}
+
+} // end namespace jitlink
+} // end namespace llvm
@@ -8,8 +8,20 @@
 //===----------------------------------------------------------------------===//
 
 #include "llvm/ExecutionEngine/JITLink/JITLinkMemoryManager.h"
+#include "llvm/ADT/Optional.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/Config/llvm-config.h"
+#include "llvm/Support/MathExtras.h"
 #include "llvm/Support/Process.h"
 
+#include <map>
+
+#ifdef LLVM_ON_UNIX
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
 namespace llvm {
 namespace jitlink {
 
@@ -98,5 +110,444 @@ InProcessMemoryManager::allocate(const SegmentsRequestMap &Request) {
       new IPMMAlloc(std::move(Blocks)));
 }
 
+SharedMemoryManager::Mapper::~Mapper() = default;
+
+/// A shared memory object mapped read-write and with fixed protections, and
+/// the ranges of it that are not allocated.
+class SlabMemoryManager::Slab {
+public:
+  static Expected<std::unique_ptr<Slab>> Create(uint64_t Id, uint64_t Size,
+                                                ProtectionFlags Prot);
+  ~Slab();
+
+  char *getWorkingMemory() const { return WorkingMem; }
+  char *getTargetMemory() const { return TargetMem; }
+
+  /// Marks the first free range of Size bytes at the given alignment as used
+  /// and returns its offset, or returns None if there is no such range.
+  Optional<uint64_t> allocate(uint64_t Size, uint64_t Alignment) {
+    for (auto I = FreeRanges.begin(), E = FreeRanges.end(); I != E; ++I) {
+      uint64_t Start = I->first;
+      uint64_t End = I->first + I->second;
+      uint64_t Offset = alignTo(Start, Alignment);
+      if (Offset + Size > End)
+        continue;
+      FreeRanges.erase(I);
+      if (Offset > Start)
+        FreeRanges[Start] = Offset - Start;
+      if (Offset + Size < End)
+        FreeRanges[Offset + Size] = End - (Offset + Size);
+      return Offset;
+    }
+    return None;
+  }
+
+  /// Marks a range as free again, merging it with the free ranges around it.
+  void release(uint64_t Offset, uint64_t RangeSize) {
+    auto Next = FreeRanges.lower_bound(Offset);
+    if (Next != FreeRanges.end() && Offset + RangeSize == Next->first) {
+      RangeSize += Next->second;
+      Next = FreeRanges.erase(Next);
+    }
+    if (Next != FreeRanges.begin()) {
+      auto Prev = std::prev(Next);
+      if (Prev->first + Prev->second == Offset) {
+        Prev->second += RangeSize;
+        return;
+      }
+    }
+    FreeRanges[Offset] = RangeSize;
+  }
+
+  bool empty() const {
+    return FreeRanges.size() == 1 && FreeRanges.begin()->second == Size;
+  }
+
+private:
+  Slab(char *WorkingMem, char *TargetMem, uint64_t Size)
+      : WorkingMem(WorkingMem), TargetMem(TargetMem), Size(Size) {
+    FreeRanges[0] = Size;
+  }
+
+  char *WorkingMem;
+  char *TargetMem;
+  uint64_t Size;
+  std::map<uint64_t, uint64_t> FreeRanges;
+};
+
+SlabMemoryManager::SlabMemoryManager(uint64_t SlabSize) : SlabSize(SlabSize) {}
+
+SlabMemoryManager::~SlabMemoryManager() = default;
+
+size_t SlabMemoryManager::getNumSlabs() const {
+  std::lock_guard<std::mutex> Lock(SlabsMutex);
+  size_t NumSlabs = 0;
+  for (auto &KV : Slabs)
+    NumSlabs += KV.second.size();
+  return NumSlabs;
+}
+
+Expected<SlabMemoryManager::SlabRange>
+SlabMemoryManager::allocateRange(ProtectionFlags Prot, uint64_t Size,
+                                 uint64_t Alignment) {
+  // Empty segments still need an address of their own.
+  Size = std::max<uint64_t>(Size, 1);
+  Alignment = std::max<uint64_t>(Alignment, 1);
+
+  std::lock_guard<std::mutex> Lock(SlabsMutex);
+  auto &ProtSlabs = Slabs[Prot];
+  for (auto &S : ProtSlabs)
+    if (auto Offset = S->allocate(Size, Alignment))
+      return SlabRange{S.get(), *Offset, Size};
+
+  uint64_t NewSlabSize =
+      alignTo(std::max(SlabSize, Size), sys::Process::getPageSizeEstimate());
+  auto NewSlab = Slab::Create(NextObjectId++, NewSlabSize, Prot);
+  if (!NewSlab)
+    return NewSlab.takeError();
+
+  auto Offset = (*NewSlab)->allocate(Size, Alignment);
+  assert(Offset && "New slab can not hold the range");
+  ProtSlabs.push_back(std::move(*NewSlab));
+  return SlabRange{ProtSlabs.back().get(), *Offset, Size};
+}
+
+void SlabMemoryManager::releaseRange(ProtectionFlags Prot,
+                                     const SlabRange &Range) {
+  std::lock_guard<std::mutex> Lock(SlabsMutex);
+  Range.S->release(Range.Offset, Range.Size);
+
+  auto &ProtSlabs = Slabs[Prot];
+  if (!Range.S->empty() || ProtSlabs.size() == 1)
+    return;
+
+  auto I = llvm::find_if(ProtSlabs, [&](const std::unique_ptr<Slab> &S) {
+    return S.get() == Range.S;
+  });
+  assert(I != ProtSlabs.end() && "Range is not in a slab of its protection");
+  ProtSlabs.erase(I);
+}
+
+Expected<std::unique_ptr<JITLinkMemoryManager::Allocation>>
+SlabMemoryManager::allocate(const SegmentsRequestMap &Request) {
+
+  using SegmentRangeMap = DenseMap<unsigned, SlabRange>;
+
+  // Local class for allocation.
+  class SlabAlloc : public Allocation {
+  public:
+    SlabAlloc(SlabMemoryManager &MemMgr, SegmentRangeMap Segments)
+        : MemMgr(MemMgr), Segments(std::move(Segments)) {}
+    MutableArrayRef<char> getWorkingMemory(ProtectionFlags Seg) override {
+      assert(Segments.count(Seg) && "No allocation for segment");
+      auto &Range = Segments[Seg];
+      return {Range.S->getWorkingMemory() + Range.Offset, Range.Size};
+    }
+    JITTargetAddress getTargetMemory(ProtectionFlags Seg) override {
+      assert(Segments.count(Seg) && "No allocation for segment");
+      auto &Range = Segments[Seg];
+      return pointerToJITTargetAddress(Range.S->getTargetMemory() +
+                                       Range.Offset);
+    }
+    void finalizeAsync(FinalizeContinuation OnFinalize) override {
+      // The content is already in the target memory, which has its final
+      // protections.
+      for (auto &KV : Segments)
+        if (KV.first & sys::Memory::MF_EXEC)
+          sys::Memory::InvalidateInstructionCache(
+              KV.second.S->getTargetMemory() + KV.second.Offset,
+              KV.second.Size);
+      OnFinalize(Error::success());
+    }
+    Error deallocate() override {
+      for (auto &KV : Segments)
+        MemMgr.releaseRange(static_cast<ProtectionFlags>(KV.first), KV.second);
+      Segments.clear();
+      return Error::success();
+    }
+
+  private:
+    SlabMemoryManager &MemMgr;
+    SegmentRangeMap Segments;
+  };
+
+  uint64_t PageSize = sys::Process::getPageSizeEstimate();
+  if (!isPowerOf2_64(PageSize))
+    return make_error<StringError>("Page size is not a power of 2",
+                                   inconvertibleErrorCode());
+
+  SegmentRangeMap Segments;
+  auto ReleaseSegments = [&]() {
+    for (auto &KV : Segments)
+      releaseRange(static_cast<ProtectionFlags>(KV.first), KV.second);
+  };
+
+  for (auto &KV : Request) {
+    auto &Seg = KV.second;
+
+    if (Seg.getAlignment() > PageSize) {
+      ReleaseSegments();
+      return make_error<StringError>("Cannot request higher than page "
+                                     "alignment",
+                                     inconvertibleErrorCode());
+    }
+
+    auto Range = allocateRange(static_cast<ProtectionFlags>(KV.first),
+                               Seg.getContentSize() + Seg.getZeroFillSize(),
+                               Seg.getAlignment());
+    if (!Range) {
+      ReleaseSegments();
+      return Range.takeError();
+    }
+
+    // Ranges are reused, so zero all of it. This covers the zero-fill memory.
+    memset(Range->S->getWorkingMemory() + Range->Offset, 0, Range->Size);
+    Segments[KV.first] = *Range;
+  }
+
+  return std::unique_ptr<SlabMemoryManager::Allocation>(
+      new SlabAlloc(*this, std::move(Segments)));
+}
+
+#ifdef LLVM_ON_UNIX
+
+static Error errnoToError(const Twine &What) {
+  return make_error<StringError>(
+      What, std::error_code(errno, std::generic_category()));
+}
+
+Expected<JITTargetAddress>
+SharedMemoryManager::InProcessMapper::map(StringRef Name, uint64_t Size) {
+  int FD = shm_open(Name.str().c_str(), O_RDWR, 0);
+  if (FD < 0)
+    return errnoToError("Could not open shared memory object " + Name);
+
+  // Keep the mapping inaccessible until it is finalized.
+  void *Addr = mmap(nullptr, Size, PROT_NONE, MAP_SHARED, FD, 0);
+  if (Addr == MAP_FAILED) {
+    auto Err = errnoToError("Could not map shared memory object " + Name);
+    close(FD);
+    return std::move(Err);
+  }
+  close(FD);
+  return pointerToJITTargetAddress(Addr);
+}
+
+Error SharedMemoryManager::InProcessMapper::protect(JITTargetAddress Addr,
+                                                    uint64_t Size,
+                                                    ProtectionFlags Prot) {
+  sys::MemoryBlock Block(jitTargetAddressToPointer<void *>(Addr), Size);
+  if (auto EC = sys::Memory::protectMappedMemory(Block, Prot))
+    return errorCodeToError(EC);
+  if (Prot & sys::Memory::MF_EXEC)
+    sys::Memory::InvalidateInstructionCache(Block.base(),
+                                            Block.allocatedSize());
+  return Error::success();
+}
+
+Error SharedMemoryManager::InProcessMapper::unmap(JITTargetAddress Addr,
+                                                  uint64_t Size) {
+  if (munmap(jitTargetAddressToPointer<void *>(Addr), Size) != 0)
+    return errnoToError("Could not unmap shared memory");
+  return Error::success();
+}
+
+Expected<std::unique_ptr<JITLinkMemoryManager::Allocation>>
+SharedMemoryManager::allocate(const SegmentsRequestMap &Request) {
+
+  struct SegmentRange {
+    uint64_t Offset;
+    uint64_t Size;
+  };
+  using SegmentRangeMap = DenseMap<unsigned, SegmentRange>;
+
+  // Local class for allocation.
+  class SMMAlloc : public Allocation {
+  public:
+    SMMAlloc(Mapper &M, char *WorkingMem, JITTargetAddress TargetMem,
+             uint64_t Size, SegmentRangeMap Segments)
+        : M(M), WorkingMem(WorkingMem), TargetMem(TargetMem), Size(Size),
+          Segments(std::move(Segments)) {}
+    ~SMMAlloc() override { releaseWorkingMemory(); }
+    MutableArrayRef<char> getWorkingMemory(ProtectionFlags Seg) override {
+      assert(Segments.count(Seg) && "No allocation for segment");
+      assert(WorkingMem && "Working memory was released");
+      return {WorkingMem + Segments[Seg].Offset, Segments[Seg].Size};
+    }
+    JITTargetAddress getTargetMemory(ProtectionFlags Seg) override {
+      assert(Segments.count(Seg) && "No allocation for segment");
+      return TargetMem + Segments[Seg].Offset;
+    }
+    void finalizeAsync(FinalizeContinuation OnFinalize) override {
+      // The content is already in the target memory.
+      releaseWorkingMemory();
+      for (auto &KV : Segments)
+        if (auto Err =
+                M.protect(TargetMem + KV.second.Offset, KV.second.Size,
+                          static_cast<ProtectionFlags>(KV.first)))
+          return OnFinalize(std::move(Err));
+      OnFinalize(Error::success());
+    }
+    Error deallocate() override {
+      releaseWorkingMemory();
+      return M.unmap(TargetMem, Size);
+    }
+
+  private:
+    void releaseWorkingMemory() {
+      if (WorkingMem)
+        munmap(WorkingMem, Size);
+      WorkingMem = nullptr;
+    }
+
+    Mapper &M;
+    char *WorkingMem;
+    JITTargetAddress TargetMem;
+    uint64_t Size;
+    SegmentRangeMap Segments;
+  };
+
+  uint64_t PageSize = sys::Process::getPageSizeEstimate();
+  if (!isPowerOf2_64(PageSize))
+    return make_error<StringError>("Page size is not a power of 2",
+                                   inconvertibleErrorCode());
+
+  // Lay the segments out on separate pages, so that each gets its own
+  // protections.
+  SegmentRangeMap Segments;
+  uint64_t TotalSize = 0;
+  for (auto &KV : Request) {
+    auto &Seg = KV.second;
+
+    if (Seg.getAlignment() > PageSize)
+      return make_error<StringError>("Cannot request higher than page "
+                                     "alignment",
+                                     inconvertibleErrorCode());
+
+    uint64_t SegmentSize =
+        alignTo(Seg.getContentSize() + Seg.getZeroFillSize(), PageSize);
+    Segments[KV.first] = {TotalSize, SegmentSize};
+    TotalSize += SegmentSize;
+  }
+  if (TotalSize == 0)
+    TotalSize = PageSize;
+
+  std::string Name = ("/llvm-jitlink-" + Twine(::getpid()) + "-" +
+                      Twine(NextObjectId++))
+                         .str();
+  int FD = shm_open(Name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+  if (FD < 0)
+    return errnoToError("Could not create shared memory object " + Name);
+
+  // The object starts out zeroed, which takes care of the zero-fill memory.
+  void *WorkingMem = MAP_FAILED;
+  if (ftruncate(FD, TotalSize) == 0)
+    WorkingMem =
+        mmap(nullptr, TotalSize, PROT_READ | PROT_WRITE, MAP_SHARED, FD, 0);
+  if (WorkingMem == MAP_FAILED) {
+    auto Err = errnoToError("Could not map shared memory object " + Name);
+    close(FD);
+    shm_unlink(Name.c_str());
+    return std::move(Err);
+  }
+  close(FD);
+
+  auto TargetMem = M->map(Name, TotalSize);
+  shm_unlink(Name.c_str());
+  if (!TargetMem) {
+    munmap(WorkingMem, TotalSize);
+    return TargetMem.takeError();
+  }
+
+  return std::unique_ptr<SharedMemoryManager::Allocation>(
+      new SMMAlloc(*M, static_cast<char *>(WorkingMem), *TargetMem, TotalSize,
+                   std::move(Segments)));
+}
+
+static int toMMapProtection(sys::Memory::ProtectionFlags Prot) {
+  int Result = 0;
+  if (Prot & sys::Memory::MF_READ)
+    Result |= PROT_READ;
+  if (Prot & sys::Memory::MF_WRITE)
+    Result |= PROT_WRITE;
+  if (Prot & sys::Memory::MF_EXEC)
+    Result |= PROT_EXEC;
+  return Result;
+}
+
+Expected<std::unique_ptr<SlabMemoryManager::Slab>>
+SlabMemoryManager::Slab::Create(uint64_t Id, uint64_t Size,
+                                ProtectionFlags Prot) {
+  std::string Name =
+      ("/llvm-jitlink-slab-" + Twine(::getpid()) + "-" + Twine(Id)).str();
+  int FD = shm_open(Name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+  if (FD < 0)
+    return errnoToError("Could not create shared memory object " + Name);
+  // Both mappings are made through FD, so the name is not needed anymore.
+  shm_unlink(Name.c_str());
+
+  void *WorkingMem = MAP_FAILED;
+  void *TargetMem = MAP_FAILED;
+  if (ftruncate(FD, Size) == 0)
+    WorkingMem =
+        mmap(nullptr, Size, PROT_READ | PROT_WRITE, MAP_SHARED, FD, 0);
+  if (WorkingMem != MAP_FAILED)
+    TargetMem = mmap(nullptr, Size, toMMapProtection(Prot), MAP_SHARED, FD, 0);
+  if (TargetMem == MAP_FAILED) {
+    auto Err = errnoToError("Could not map shared memory object " + Name);
+    if (WorkingMem != MAP_FAILED)
+      munmap(WorkingMem, Size);
+    close(FD);
+    return std::move(Err);
+  }
+  close(FD);
+
+  return std::unique_ptr<Slab>(new Slab(static_cast<char *>(WorkingMem),
+                                        static_cast<char *>(TargetMem), Size));
+}
+
+SlabMemoryManager::Slab::~Slab() {
+  munmap(WorkingMem, Size);
+  munmap(TargetMem, Size);
+}
+
+#else
+
+Expected<std::unique_ptr<SlabMemoryManager::Slab>>
+SlabMemoryManager::Slab::Create(uint64_t Id, uint64_t Size,
+                                ProtectionFlags Prot) {
+  return make_error<StringError>("Shared memory is not supported on this host",
+                                 inconvertibleErrorCode());
+}
+
+SlabMemoryManager::Slab::~Slab() {}
+
+Expected<JITTargetAddress>
+SharedMemoryManager::InProcessMapper::map(StringRef Name, uint64_t Size) {
+  return make_error<StringError>("Shared memory is not supported on this host",
+                                 inconvertibleErrorCode());
+}
+
+Error SharedMemoryManager::InProcessMapper::protect(JITTargetAddress Addr,
+                                                    uint64_t Size,
+                                                    ProtectionFlags Prot) {
+  return make_error<StringError>("Shared memory is not supported on this host",
+                                 inconvertibleErrorCode());
+}
+
+Error SharedMemoryManager::InProcessMapper::unmap(JITTargetAddress Addr,
+                                                  uint64_t Size) {
+  return make_error<StringError>("Shared memory is not supported on this host",
+                                 inconvertibleErrorCode());
+}
+
+Expected<std::unique_ptr<JITLinkMemoryManager::Allocation>>
+SharedMemoryManager::allocate(const SegmentsRequestMap &Request) {
+  return make_error<StringError>("Shared memory is not supported on this host",
+                                 inconvertibleErrorCode());
+}
+
+#endif
+
 } // end namespace jitlink
 } // end namespace llvm
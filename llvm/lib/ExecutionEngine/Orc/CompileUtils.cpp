@@ -74,12 +74,45 @@ void SimpleCompiler::notifyObjectCompiled(const Module &M,
 
 ConcurrentIRCompiler::ConcurrentIRCompiler(JITTargetMachineBuilder JTMB,
                                            ObjectCache *ObjCache)
-    : JTMB(std::move(JTMB)), ObjCache(ObjCache) {}
+    : JTMB(std::move(JTMB)), ObjCache(ObjCache),
+      TMPool(std::make_shared<TargetMachinePool>()) {}
 
 std::unique_ptr<MemoryBuffer> ConcurrentIRCompiler::operator()(Module &M) {
-  auto TM = cantFail(JTMB.createTargetMachine());
-  SimpleCompiler C(*TM, ObjCache);
-  return C(M);
+  auto TM = cantFail(takeTargetMachine());
+  std::unique_ptr<MemoryBuffer> ObjBuffer;
+  {
+    SimpleCompiler C(*TM, ObjCache);
+    ObjBuffer = C(M);
+  }
+  returnTargetMachine(std::move(TM));
+  return ObjBuffer;
+}
+
+size_t ConcurrentIRCompiler::getNumTargetMachinesCreated() const {
+  std::lock_guard<std::mutex> Lock(TMPool->PoolMutex);
+  return TMPool->NumCreated;
+}
+
+Expected<std::unique_ptr<TargetMachine>>
+ConcurrentIRCompiler::takeTargetMachine() {
+  {
+    std::lock_guard<std::mutex> Lock(TMPool->PoolMutex);
+    if (!TMPool->Available.empty()) {
+      auto TM = std::move(TMPool->Available.back());
+      TMPool->Available.pop_back();
+      return std::move(TM);
+    }
+    ++TMPool->NumCreated;
+  }
+
+  // Create the TargetMachine outside the lock: this is the expensive part.
+  return JTMB.createTargetMachine();
+}
+
+void ConcurrentIRCompiler::returnTargetMachine(
+    std::unique_ptr<TargetMachine> TM) {
+  std::lock_guard<std::mutex> Lock(TMPool->PoolMutex);
+  TMPool->Available.push_back(std::move(TM));
 }
 
 } // end namespace orc
@@ -741,6 +741,7 @@ void JITDylib::removeGenerator(DefinitionGenerator &G) {
                           });
     assert(I != DefGenerators.end() && "Generator not found");
     DefGenerators.erase(I);
+    publishHasGenerators(!DefGenerators.empty());
   });
 }
 
@@ -758,10 +759,13 @@ Error JITDylib::defineMaterializing(const SymbolFlagsMap &SymbolFlags) {
       if (Added) {
         AddedSyms.push_back(EntryItr);
         EntryItr->second.setState(SymbolState::Materializing);
+        publishDefinition(KV.first);
       } else {
         // Remove any symbols already added.
-        for (auto &SI : AddedSyms)
+        for (auto &SI : AddedSyms) {
+          unpublish(SI->first);
           Symbols.erase(SI);
+        }
 
         // FIXME: Return all duplicates.
         return make_error<DuplicateDefinition>(*KV.first);
@@ -1089,6 +1093,8 @@ Error JITDylib::emit(const SymbolFlagsMap &Emitted) {
             // Since this dependant is now ready, we erase its MaterializingInfo
             // and update its materializing state.
             DependantSymEntry.setState(SymbolState::Ready);
+            DependantJD.publishReady(DependantName,
+                                     DependantSymEntry.getSymbol());
 
             for (auto &Q : DependantMI.takeQueriesMeeting(SymbolState::Ready)) {
               Q->notifySymbolMetRequiredState(
@@ -1106,6 +1112,7 @@ Error JITDylib::emit(const SymbolFlagsMap &Emitted) {
       MI.Dependants.clear();
       if (MI.UnemittedDependencies.empty()) {
         SymI->second.setState(SymbolState::Ready);
+        publishReady(Name, SymI->second.getSymbol());
         for (auto &Q : MI.takeQueriesMeeting(SymbolState::Ready)) {
           Q->notifySymbolMetRequiredState(Name, SymI->second.getSymbol());
           if (Q->isComplete())
@@ -1339,6 +1346,7 @@ Error JITDylib::remove(const SymbolNameSet &Names) {
       }
 
       auto SymI = SymbolMaterializerItrPair.first;
+      unpublish(SymI->first);
       Symbols.erase(SymI);
     }
 
@@ -1777,11 +1785,34 @@ Error JITDylib::defineImpl(MaterializationUnit &MU) {
     SymEntry.setFlags(KV.second);
     SymEntry.setState(SymbolState::NeverSearched);
     SymEntry.setMaterializerAttached(true);
+    publishDefinition(KV.first);
   }
 
   return Error::success();
 }
 
+void JITDylib::publishDefinition(const SymbolStringPtr &Name) {
+  sys::ScopedWriter Lock(PublishedSymbolsMutex);
+  PublishedSymbols[Name] = None;
+}
+
+void JITDylib::publishReady(const SymbolStringPtr &Name,
+                            JITEvaluatedSymbol Sym) {
+  sys::ScopedWriter Lock(PublishedSymbolsMutex);
+  assert(PublishedSymbols.count(Name) && "Symbol was never published");
+  PublishedSymbols[Name] = Sym;
+}
+
+void JITDylib::unpublish(const SymbolStringPtr &Name) {
+  sys::ScopedWriter Lock(PublishedSymbolsMutex);
+  PublishedSymbols.erase(Name);
+}
+
+void JITDylib::publishHasGenerators(bool HasGenerators) {
+  sys::ScopedWriter Lock(PublishedSymbolsMutex);
+  this->HasGenerators = HasGenerators;
+}
+
 void JITDylib::detachQueryHelper(AsynchronousSymbolQuery &Q,
                                  const SymbolNameSet &QuerySymbols) {
   for (auto &QuerySymbol : QuerySymbols) {
@@ -2027,6 +2058,12 @@ ExecutionSession::lookup(const JITDylibSearchList &SearchOrder,
                          const SymbolNameSet &Symbols,
                          SymbolState RequiredState,
                          RegisterDependenciesFunction RegisterDependencies) {
+  // Symbols that are already ready need no bookkeeping: return them without
+  // contending for the session lock with the materializing threads. Ready
+  // symbols never need their dependencies registered.
+  if (auto Result = lookupReady(SearchOrder, Symbols))
+    return std::move(*Result);
+
 #if LLVM_ENABLE_THREADS
   // In the threaded case we use promises to return the results.
   std::promise<SymbolMap> PromisedResult;
@@ -2076,6 +2113,45 @@ ExecutionSession::lookup(const JITDylibSearchList &SearchOrder,
 #endif
 }
 
+Optional<SymbolMap>
+ExecutionSession::lookupReady(const JITDylibSearchList &SearchOrder,
+                              const SymbolNameSet &Symbols) {
+  SymbolMap Result;
+  for (auto &Name : Symbols) {
+    bool Found = false;
+    for (auto &KV : SearchOrder) {
+      auto &JD = *KV.first;
+      bool MatchNonExported = KV.second;
+      sys::ScopedReader Lock(JD.PublishedSymbolsMutex);
+
+      // A generator may define the symbol here.
+      auto I = JD.PublishedSymbols.find(Name);
+      if (I == JD.PublishedSymbols.end()) {
+        if (JD.HasGenerators)
+          return None;
+        continue;
+      }
+
+      // The symbol must be materialized first.
+      if (!I->second)
+        return None;
+
+      if (!I->second->getFlags().isExported() && !MatchNonExported)
+        continue;
+
+      Result[Name] = *I->second;
+      Found = true;
+      break;
+    }
+
+    // Leave reporting the missing symbols to the full lookup.
+    if (!Found)
+      return None;
+  }
+
+  return Result;
+}
+
 Expected<JITEvaluatedSymbol>
 ExecutionSession::lookup(const JITDylibSearchList &SearchOrder,
                          SymbolStringPtr Name) {
@@ -349,7 +349,10 @@ Error ObjectLinkingLayer::notifyEmitted(MaterializationResponsibility &MR,
 
   {
     std::lock_guard<std::mutex> Lock(LayerMutex);
-    UntrackedAllocs.push_back(std::move(Alloc));
+    if (auto Key = MR.getVModuleKey())
+      TrackedAllocs[Key].push_back(std::move(Alloc));
+    else
+      UntrackedAllocs.push_back(std::move(Alloc));
   }
 
   return Error::success();
@@ -361,18 +364,23 @@ Error ObjectLinkingLayer::removeModule(VModuleKey K) {
   for (auto &P : Plugins)
     Err = joinErrors(std::move(Err), P->notifyRemovingModule(K));
 
-  AllocPtr Alloc;
+  std::vector<AllocPtr> Allocs;
 
   {
     std::lock_guard<std::mutex> Lock(LayerMutex);
     auto AllocItr = TrackedAllocs.find(K);
-    Alloc = std::move(AllocItr->second);
-    TrackedAllocs.erase(AllocItr);
+    if (AllocItr != TrackedAllocs.end()) {
+      Allocs = std::move(AllocItr->second);
+      TrackedAllocs.erase(AllocItr);
+    }
   }
 
-  assert(Alloc && "No allocation for key K");
+  while (!Allocs.empty()) {
+    Err = joinErrors(std::move(Err), Allocs.back()->deallocate());
+    Allocs.pop_back();
+  }
 
-  return joinErrors(std::move(Err), Alloc->deallocate());
+  return Err;
 }
 
 Error ObjectLinkingLayer::removeAllModules() {
@@ -388,7 +396,8 @@ Error ObjectLinkingLayer::removeAllModules() {
     Allocs = std::move(UntrackedAllocs);
 
     for (auto &KV : TrackedAllocs)
-      Allocs.push_back(std::move(KV.second));
+      for (auto &Alloc : KV.second)
+        Allocs.push_back(std::move(Alloc));
 
     TrackedAllocs.clear();
   }
@@ -431,7 +440,7 @@ Error EHFrameRegistrationPlugin::notifyEmitted(
 
   InProcessLinks.erase(EHFrameRangeItr);
   if (auto Key = MR.getVModuleKey())
-    TrackedEHFrameRanges[Key] = EHFrameRange;
+    TrackedEHFrameRanges[Key].push_back(EHFrameRange);
   else
     UntrackedEHFrameRanges.push_back(EHFrameRange);
 
@@ -443,22 +452,27 @@ Error EHFrameRegistrationPlugin::notifyRemovingModule(VModuleKey K) {
   if (EHFrameRangeItr == TrackedEHFrameRanges.end())
     return Error::success();
 
-  auto EHFrameRange = EHFrameRangeItr->second;
-  assert(EHFrameRange.Addr && "Tracked eh-frame range must not be null");
-
+  auto EHFrameRanges = std::move(EHFrameRangeItr->second);
   TrackedEHFrameRanges.erase(EHFrameRangeItr);
 
-  return Registrar.deregisterEHFrames(EHFrameRange.Addr, EHFrameRange.Size);
+  Error Err = Error::success();
+  for (auto &EHFrameRange : EHFrameRanges) {
+    assert(EHFrameRange.Addr && "Tracked eh-frame range must not be null");
+    Err = joinErrors(std::move(Err),
+                     Registrar.deregisterEHFrames(EHFrameRange.Addr,
+                                                  EHFrameRange.Size));
+  }
+
+  return Err;
 }
 
 Error EHFrameRegistrationPlugin::notifyRemovingAllModules() {
 
   std::vector<EHFrameRange> EHFrameRanges =
     std::move(UntrackedEHFrameRanges);
-  EHFrameRanges.reserve(EHFrameRanges.size() + TrackedEHFrameRanges.size());
-
   for (auto &KV : TrackedEHFrameRanges)
-    EHFrameRanges.push_back(KV.second);
+    EHFrameRanges.insert(EHFrameRanges.end(), KV.second.begin(),
+                         KV.second.end());
 
   TrackedEHFrameRanges.clear();
 
@@ -0,0 +1,140 @@
+//===---- PersistentObjectCache.cpp - On-disk cache of JIT'd objects ------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/ExecutionEngine/Orc/PersistentObjectCache.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/Bitcode/BitcodeWriter.h"
+#include "llvm/Config/llvm-config.h"
+#include "llvm/ExecutionEngine/Orc/JITTargetMachineBuilder.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/SHA1.h"
+#include "llvm/Support/raw_ostream.h"
+
+namespace llvm {
+namespace orc {
+
+/// Describe the options of the TargetMachines built by \p JTMB that affect
+/// the generated code.
+static std::string getTargetKey(const JITTargetMachineBuilder &JTMB) {
+  std::string Key;
+  raw_string_ostream OS(Key);
+  OS << LLVM_VERSION_STRING << ':' << JTMB.getTargetTriple().str() << ':'
+     << JTMB.getCPU() << ':' << JTMB.getFeatures().getString() << ':'
+     << static_cast<int>(JTMB.getCodeGenOptLevel());
+  if (auto RM = JTMB.getRelocationModel())
+    OS << ":rm" << static_cast<int>(*RM);
+  if (auto CM = JTMB.getCodeModel())
+    OS << ":cm" << static_cast<int>(*CM);
+
+  const TargetOptions &Options = JTMB.getOptions();
+  OS << ':' << Options.UnsafeFPMath << Options.NoInfsFPMath
+     << Options.NoNaNsFPMath << Options.NoTrappingFPMath
+     << Options.NoSignedZerosFPMath << Options.FunctionSections
+     << Options.DataSections << Options.UniqueSectionNames
+     << Options.EmulatedTLS << Options.ExplicitEmulatedTLS << ':'
+     << static_cast<int>(Options.FloatABIType) << ':'
+     << static_cast<int>(Options.AllowFPOpFusion) << ':'
+     << static_cast<int>(Options.ThreadModel) << ':'
+     << static_cast<int>(Options.ExceptionModel);
+  return OS.str();
+}
+
+Expected<std::unique_ptr<PersistentObjectCache>>
+PersistentObjectCache::Create(StringRef CacheDir,
+                              const JITTargetMachineBuilder &JTMB,
+                              CachePruningPolicy Policy) {
+  if (std::error_code EC = sys::fs::create_directories(CacheDir))
+    return createFileError(CacheDir, errorCodeToError(EC));
+  pruneCache(CacheDir, Policy);
+  return std::unique_ptr<PersistentObjectCache>(
+      new PersistentObjectCache(CacheDir, getTargetKey(JTMB)));
+}
+
+std::string PersistentObjectCache::getKey(const Module &M) const {
+  SmallVector<char, 0> Bitcode;
+  {
+    raw_svector_ostream OS(Bitcode);
+    WriteBitcodeToFile(M, OS);
+  }
+
+  SHA1 Hasher;
+  Hasher.update(TargetKey);
+  Hasher.update(StringRef(Bitcode.data(), Bitcode.size()));
+
+  // This choice of file name allows the cache to be pruned (see pruneCache()
+  // in include/llvm/Support/CachePruning.h).
+  SmallString<128> EntryPath;
+  sys::path::append(EntryPath, CacheDir,
+                    "llvmcache-" + toHex(Hasher.result()));
+  return EntryPath.str();
+}
+
+std::unique_ptr<MemoryBuffer>
+PersistentObjectCache::getObject(const Module *M) {
+  std::string EntryPath = getKey(*M);
+
+  // Update the access time of the entry, which is what the pruning uses to
+  // find the least recently used entries.
+  Expected<sys::fs::file_t> FDOrErr =
+      sys::fs::openNativeFileForRead(EntryPath, sys::fs::OF_UpdateAtime);
+  if (FDOrErr) {
+    ErrorOr<std::unique_ptr<MemoryBuffer>> MBOrErr =
+        MemoryBuffer::getOpenFile(*FDOrErr, EntryPath, /*FileSize=*/-1,
+                                  /*RequiresNullTerminator=*/false);
+    sys::fs::closeFile(*FDOrErr);
+    if (MBOrErr)
+      return std::move(*MBOrErr);
+  } else
+    consumeError(FDOrErr.takeError());
+
+  // A miss: remember the key, the module changes before it is compiled.
+  std::lock_guard<std::mutex> Lock(PendingKeysMutex);
+  PendingKeys[M] = std::move(EntryPath);
+  return nullptr;
+}
+
+void PersistentObjectCache::notifyObjectCompiled(const Module *M,
+                                                 MemoryBufferRef Obj) {
+  std::string EntryPath;
+  {
+    std::lock_guard<std::mutex> Lock(PendingKeysMutex);
+    auto I = PendingKeys.find(M);
+    if (I == PendingKeys.end())
+      return;
+    EntryPath = std::move(I->second);
+    PendingKeys.erase(I);
+  }
+
+  // Write to a temporary and rename it, so that another process using the
+  // same directory never reads a partially written entry. Failing to add an
+  // entry only costs a compile in a later run.
+  SmallString<128> TempFilenameModel;
+  sys::path::append(TempFilenameModel, CacheDir, "Orc-%%%%%%.tmp.o");
+  Expected<sys::fs::TempFile> Temp = sys::fs::TempFile::create(
+      TempFilenameModel, sys::fs::owner_read | sys::fs::owner_write);
+  if (!Temp) {
+    consumeError(Temp.takeError());
+    return;
+  }
+
+  raw_fd_ostream OS(Temp->FD, /* ShouldClose */ false);
+  OS << Obj.getBuffer();
+  OS.flush();
+  if (OS.has_error()) {
+    OS.clear_error();
+    consumeError(Temp->discard());
+    return;
+  }
+  consumeError(Temp->keep(EntryPath));
+}
+
+} // end namespace orc
+} // end namespace llvm
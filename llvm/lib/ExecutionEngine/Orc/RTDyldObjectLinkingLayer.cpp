@@ -126,9 +126,12 @@ void RTDyldObjectLinkingLayer::emit(MaterializationResponsibility R,
   // Create a record a memory manager for this object.
   {
     auto Tmp = GetMemoryManager();
+    MemMgr = Tmp.get();
     std::lock_guard<std::mutex> Lock(RTDyldLayerMutex);
-    MemMgrs.push_back(std::move(Tmp));
-    MemMgr = MemMgrs.back().get();
+    if (K)
+      TrackedMemMgrs[K].push_back(std::move(Tmp));
+    else
+      UntrackedMemMgrs.push_back(std::move(Tmp));
   }
 
   JITDylibSearchOrderResolver Resolver(*SharedR);
@@ -146,6 +149,22 @@ void RTDyldObjectLinkingLayer::emit(MaterializationResponsibility R,
       });
 }
 
+void RTDyldObjectLinkingLayer::removeModule(VModuleKey K) {
+  std::vector<MemoryManagerPtr> MemMgrs;
+
+  {
+    std::lock_guard<std::mutex> Lock(RTDyldLayerMutex);
+    auto MemMgrsItr = TrackedMemMgrs.find(K);
+    if (MemMgrsItr == TrackedMemMgrs.end())
+      return;
+    MemMgrs = std::move(MemMgrsItr->second);
+    TrackedMemMgrs.erase(MemMgrsItr);
+  }
+
+  for (auto &MemMgr : MemMgrs)
+    MemMgr->deregisterEHFrames();
+}
+
 Error RTDyldObjectLinkingLayer::onObjLoad(
     VModuleKey K, MaterializationResponsibility &R, object::ObjectFile &Obj,
     std::unique_ptr<RuntimeDyld::LoadedObjectInfo> LoadedObjInfo,
@@ -17,6 +17,10 @@
 #include "llvm/IR/Type.h"
 #include "llvm/IR/Verifier.h"
 #include "llvm/Support/Debug.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/LineIterator.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/raw_ostream.h"
 
 #include <vector>
 
@@ -55,6 +59,102 @@ Error Speculator::addSpeculationRuntime(JITDylib &JD,
   }));
 }
 
+void Speculator::compileImpls(const SymbolNameSet &Stubs) {
+  SymbolDependenceMap SpeculativeLookUpImpls;
+
+  for (auto &Callee : Stubs) {
+    auto ImplSymbol = AliaseeImplTable.getImplFor(Callee);
+    // try to distinguish already compiled & library symbols
+    if (!ImplSymbol.hasValue())
+      continue;
+    const auto &ImplSymbolName = ImplSymbol.getPointer()->first;
+    JITDylib *ImplJD = ImplSymbol.getPointer()->second;
+    auto &SymbolsInJD = SpeculativeLookUpImpls[ImplJD];
+    SymbolsInJD.insert(ImplSymbolName);
+  }
+
+  DEBUG_WITH_TYPE("orc", for (auto &I
+                              : SpeculativeLookUpImpls) {
+    llvm::dbgs() << "\n In " << I.first->getName() << " JITDylib ";
+    for (auto &N : I.second)
+      llvm::dbgs() << "\n Likely Symbol : " << N;
+  });
+
+  // for a given symbol, there may be no symbol qualified for speculatively
+  // compile try to fix this before jumping to this code if possible.
+  for (auto &LookupPair : SpeculativeLookUpImpls)
+    ES.lookup(JITDylibSearchList({{LookupPair.first, true}}),
+              LookupPair.second, SymbolState::Ready,
+              [this](Expected<SymbolMap> Result) {
+                if (auto Err = Result.takeError())
+                  ES.reportError(std::move(Err));
+              },
+              NoDependenciesToRegister);
+}
+
+Error Speculator::writeAccessTrace(StringRef Path) {
+  std::error_code EC;
+  raw_fd_ostream OS(Path, EC, sys::fs::OF_Text);
+  if (EC)
+    return createFileError(Path, errorCodeToError(EC));
+
+  {
+    std::lock_guard<std::mutex> Lockit(ConcurrentAccess);
+    for (auto &Name : AccessTrace)
+      OS << *Name << "\n";
+  }
+
+  OS.close();
+  if (OS.has_error()) {
+    OS.clear_error();
+    return createFileError(Path, errorCodeToError(OS.error()));
+  }
+  return Error::success();
+}
+
+Error Speculator::speculateFromAccessTrace(JITDylib &JD, StringRef Path) {
+  auto Buffer = MemoryBuffer::getFile(Path);
+  if (!Buffer) {
+    // No trace was recorded yet.
+    if (Buffer.getError() == std::errc::no_such_file_or_directory)
+      return Error::success();
+    return createFileError(Path, errorCodeToError(Buffer.getError()));
+  }
+
+  SymbolNameSet Names;
+  for (line_iterator I(**Buffer, /*SkipBlanks=*/true), E; I != E; ++I)
+    Names.insert(ES.intern(I->trim()));
+
+  // The program may have changed since the trace was recorded.
+  auto Flags = JD.lookupFlags(Names);
+  if (!Flags)
+    return Flags.takeError();
+
+  SymbolNameSet Stubs;
+  for (auto &KV : *Flags)
+    if (KV.second.isCallable())
+      Stubs.insert(KV.first);
+  if (Stubs.empty())
+    return Error::success();
+
+  // Looking the stubs up emits them, which records their implementations in
+  // the ImplSymbolMap; then compile the implementations.
+  ES.lookup(JITDylibSearchList({{&JD, true}}), std::move(Stubs),
+            SymbolState::Ready,
+            [this](Expected<SymbolMap> Result) {
+              if (!Result) {
+                ES.reportError(Result.takeError());
+                return;
+              }
+              SymbolNameSet Resolved;
+              for (auto &KV : *Result)
+                Resolved.insert(KV.first);
+              compileImpls(Resolved);
+            },
+            NoDependenciesToRegister);
+  return Error::success();
+}
+
 // If two modules, share the same LLVMContext, different threads must
 // not access them concurrently without locking the associated LLVMContext
 // this implementation follows this contract.
@@ -87,6 +187,11 @@ void IRSpeculationLayer::emit(MaterializationResponsibility R,
       if (!Fn.isDeclaration()) {
 
         auto IRNames = QueryAnalysis(Fn);
+        // Functions without likely callees are still instrumented to record
+        // their first call.
+        if (!IRNames.hasValue() && S.isRecordingAccesses())
+          IRNames.emplace(
+              DenseMap<StringRef, DenseSet<StringRef>>({{Fn.getName(), {}}}));
         // Instrument and register if Query has result
         if (IRNames.hasValue()) {
 
@@ -0,0 +1,285 @@
+//===-- TieredCompilationLayer.cpp - Recompile hot functions --------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/ExecutionEngine/Orc/TieredCompilationLayer.h"
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/IR/IRBuilder.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/IR/Mangler.h"
+#include "llvm/IR/Module.h"
+#include "llvm/IR/Verifier.h"
+#include "llvm/Support/Debug.h"
+
+#define DEBUG_TYPE "orc"
+
+namespace llvm {
+namespace orc {
+
+TieredCompilationLayer::TieredCompilationLayer(
+    ExecutionSession &ES, IRLayer &BaseLayer, IRLayer &OptimizingLayer,
+    LazyCallThroughManager &LCTMgr,
+    IndirectStubsManagerBuilder BuildIndirectStubsManager,
+    unsigned NumCompileThreads)
+    : IRLayer(ES), BaseLayer(BaseLayer), OptimizingLayer(OptimizingLayer),
+      LCTMgr(LCTMgr),
+      BuildIndirectStubsManager(std::move(BuildIndirectStubsManager)),
+      CompileThreads(NumCompileThreads) {}
+
+/// Count the calls to \p F in its entry block, and call the reoptimization
+/// runtime entry point with \p FunctionId once they reach \p Threshold.
+static void addCallCounter(Function &F, uint64_t FunctionId,
+                           uint64_t Threshold, GlobalVariable &LayerAddr,
+                           FunctionCallee RuntimeCall) {
+  Module &M = *F.getParent();
+  LLVMContext &Ctx = M.getContext();
+  Type *Int64Ty = Type::getInt64Ty(Ctx);
+
+  auto *Counter = new GlobalVariable(
+      M, Int64Ty, false, GlobalValue::InternalLinkage,
+      ConstantInt::get(Int64Ty, 0), "__orc_tiered.calls." + F.getName());
+
+  // Keep the static allocas in the entry block.
+  BasicBlock &Entry = F.getEntryBlock();
+  BasicBlock::iterator InsertPt = Entry.getFirstInsertionPt();
+  while (isa<AllocaInst>(*InsertPt))
+    ++InsertPt;
+  BasicBlock *Body = Entry.splitBasicBlock(InsertPt, "__orc_tiered.body");
+  BasicBlock *Reoptimize =
+      BasicBlock::Create(Ctx, "__orc_tiered.reoptimize", &F, Body);
+  Entry.getTerminator()->eraseFromParent();
+
+  // The counter is only incremented atomically, the call in which it reaches
+  // the threshold is the only one asking for the optimization.
+  IRBuilder<> Builder(&Entry);
+  Value *Calls =
+      Builder.CreateAtomicRMW(AtomicRMWInst::Add, Counter,
+                              ConstantInt::get(Int64Ty, 1),
+                              AtomicOrdering::Monotonic);
+  Value *IsHot =
+      Builder.CreateICmpEQ(Calls, ConstantInt::get(Int64Ty, Threshold - 1));
+  Builder.CreateCondBr(IsHot, Reoptimize, Body);
+
+  Builder.SetInsertPoint(Reoptimize);
+  Builder.CreateCall(RuntimeCall,
+                     {&LayerAddr, ConstantInt::get(Int64Ty, FunctionId)});
+  Builder.CreateBr(Body);
+}
+
+void TieredCompilationLayer::emit(MaterializationResponsibility R,
+                                  ThreadSafeModule TSM) {
+  assert(TSM && "Null module");
+
+  auto &ES = getExecutionSession();
+  auto Source = std::make_shared<SourceModule>();
+  PerDylibResources *PDR = nullptr;
+  std::vector<TieredFunction> NewFunctions;
+  SymbolAliasMap NonCallables;
+  SymbolAliasMap Callables;
+
+  // Move the function bodies aside under new names, and route all the calls,
+  // including the ones within the module, through stubs named after the
+  // functions.
+  TSM.withModuleDo([&](Module &M) {
+    MangleAndInterner Mangle(ES, M.getDataLayout());
+    PDR = &getPerDylibResources(R.getTargetJITDylib(), Mangle);
+
+    for (auto &F : M.functions()) {
+      if (F.isDeclaration() || !F.hasAvailableExternallyLinkage())
+        continue;
+      F.deleteBody();
+      F.setPersonalityFn(nullptr);
+    }
+
+    // Aliases must keep pointing at a definition, the functions they alias
+    // are emitted once, like the other non-callable symbols.
+    SmallPtrSet<const GlobalValue *, 8> Aliasees;
+    for (auto &A : M.aliases())
+      Aliasees.insert(A.getBaseObject());
+
+    std::vector<Function *> Tiered;
+    for (auto &GV : M.global_values()) {
+      if (GV.isDeclaration() || GV.hasLocalLinkage() ||
+          GV.hasAppendingLinkage())
+        continue;
+
+      auto Name = Mangle(GV.getName());
+      auto Flags = JITSymbolFlags::fromGlobalValue(GV);
+      if (Flags.isCallable() && isa<Function>(GV) && !Aliasees.count(&GV))
+        Tiered.push_back(cast<Function>(&GV));
+      else
+        NonCallables[Name] = SymbolAliasMapEntry(Name, Flags);
+    }
+
+    for (Function *F : Tiered) {
+      std::string Name = F->getName();
+      auto Flags = JITSymbolFlags::fromGlobalValue(*F);
+      F->setName(Name + ".tier0");
+      Function *Decl = cloneFunctionDecl(M, *F);
+      Decl->setLinkage(GlobalValue::ExternalLinkage);
+      Decl->setDSOLocal(false);
+      F->replaceAllUsesWith(Decl);
+      Decl->setName(Name);
+
+      // The body is only reached through the stub now, make sure it is kept.
+      F->setLinkage(GlobalValue::ExternalLinkage);
+      F->setComdat(nullptr);
+
+      Callables[Mangle(Name)] =
+          SymbolAliasMapEntry(Mangle(F->getName()), Flags);
+      NewFunctions.push_back({PDR, Source, F->getName(), Name + ".tier1",
+                              Mangle(Name), Mangle(Name + ".tier1")});
+    }
+
+    // The second tier of a function is emitted in a module of its own, which
+    // refers to the rest of this module by name.
+    for (GlobalValue *GV : PromoteSymbols(M))
+      if (isa<Function>(GV))
+        Source->LocalFunctions.insert(GV->getName());
+  });
+
+  // Keep a copy of the IR without the call counters to optimize from.
+  if (!NewFunctions.empty())
+    Source->TSM = cloneToNewContext(TSM);
+
+  uint64_t FirstId;
+  {
+    std::lock_guard<std::mutex> Lock(TieredLayerMutex);
+    FirstId = Functions.size();
+    for (auto &TF : NewFunctions)
+      Functions.push_back(TF);
+  }
+
+  TSM.withModuleDo([&](Module &M) {
+    if (NewFunctions.empty())
+      return;
+    LLVMContext &Ctx = M.getContext();
+    Type *Int8Ty = Type::getInt8Ty(Ctx);
+    auto *LayerAddr = new GlobalVariable(M, Int8Ty, false,
+                                         GlobalValue::ExternalLinkage, nullptr,
+                                         "__orc_tiered_layer");
+    FunctionCallee RuntimeCall = M.getOrInsertFunction(
+        "__orc_tiered_reoptimize", Type::getVoidTy(Ctx),
+        Int8Ty->getPointerTo(), Type::getInt64Ty(Ctx));
+    for (unsigned I = 0, E = NewFunctions.size(); I != E; ++I)
+      addCallCounter(*M.getFunction(NewFunctions[I].BodyName), FirstId + I,
+                     HotCallThreshold, *LayerAddr, RuntimeCall);
+  });
+  assert(!TSM.withModuleDo([](const Module &M) { return verifyModule(M); }) &&
+         "Call counters break the IR?");
+
+  if (auto Err = BaseLayer.add(PDR->getImplDylib(), std::move(TSM),
+                               R.getVModuleKey())) {
+    ES.reportError(std::move(Err));
+    R.failMaterialization();
+    return;
+  }
+
+  if (!NonCallables.empty())
+    R.replace(reexports(PDR->getImplDylib(), std::move(NonCallables), true));
+  if (!Callables.empty())
+    R.replace(lazyReexports(LCTMgr, PDR->getISManager(), PDR->getImplDylib(),
+                            std::move(Callables)));
+}
+
+TieredCompilationLayer::PerDylibResources &
+TieredCompilationLayer::getPerDylibResources(JITDylib &TargetD,
+                                             MangleAndInterner &Mangle) {
+  std::lock_guard<std::mutex> Lock(TieredLayerMutex);
+
+  auto I = DylibResources.find(&TargetD);
+  if (I == DylibResources.end()) {
+    auto &ES = getExecutionSession();
+    auto &ImplD = ES.createJITDylib(TargetD.getName() + ".tiered", false);
+    TargetD.withSearchOrderDo([&](const JITDylibSearchList &TargetSearchOrder) {
+      auto NewSearchOrder = TargetSearchOrder;
+      assert(!NewSearchOrder.empty() &&
+             NewSearchOrder.front().first == &TargetD &&
+             NewSearchOrder.front().second == true &&
+             "TargetD must be at the front of its own search order and match "
+             "non-exported symbol");
+      NewSearchOrder.insert(std::next(NewSearchOrder.begin()), {&ImplD, true});
+      ImplD.setSearchOrder(std::move(NewSearchOrder), false);
+    });
+
+    // The runtime entry point the call counters call into.
+    JITEvaluatedSymbol ThisPtr(pointerToJITTargetAddress(this),
+                               JITSymbolFlags::Exported);
+    JITEvaluatedSymbol ReoptimizePtr(
+        pointerToJITTargetAddress(&reoptimizeEntryPoint),
+        JITSymbolFlags::Exported);
+    if (auto Err = ImplD.define(absoluteSymbols(
+            {{Mangle("__orc_tiered_layer"), ThisPtr},
+             {Mangle("__orc_tiered_reoptimize"), ReoptimizePtr}})))
+      ES.reportError(std::move(Err));
+
+    PerDylibResources PDR(ImplD, BuildIndirectStubsManager());
+    I = DylibResources.insert(std::make_pair(&TargetD, std::move(PDR))).first;
+  }
+
+  return I->second;
+}
+
+void TieredCompilationLayer::reoptimizeEntryPoint(
+    TieredCompilationLayer *Layer, uint64_t FunctionId) {
+  // Return to the first tier code right away, the caller must not wait for
+  // the optimization.
+  Layer->CompileThreads.async(
+      [Layer, FunctionId]() { Layer->reoptimize(FunctionId); });
+}
+
+void TieredCompilationLayer::reoptimize(uint64_t FunctionId) {
+  auto &ES = getExecutionSession();
+
+  TieredFunction TF;
+  {
+    std::lock_guard<std::mutex> Lock(TieredLayerMutex);
+    assert(FunctionId < Functions.size() && "Unknown function");
+    TF = Functions[FunctionId];
+  }
+
+  LLVM_DEBUG(dbgs() << "Reoptimizing hot function " << *TF.StubSymbol << "\n");
+
+  // Copy the body and the local functions it may inline, the other symbols
+  // are reused from the first tier.
+  auto &Source = *TF.Source;
+  auto OptTSM = cloneToNewContext(Source.TSM, [&](const GlobalValue &GV) {
+    return GV.getName() == TF.BodyName ||
+           (isa<Function>(GV) && Source.LocalFunctions.count(GV.getName()));
+  });
+  OptTSM.withModuleDo([&](Module &M) {
+    for (auto &F : M.functions()) {
+      if (F.isDeclaration())
+        continue;
+      if (F.getName() == TF.BodyName)
+        F.setName(TF.OptimizedName);
+      else
+        F.setLinkage(GlobalValue::InternalLinkage);
+    }
+  });
+
+  auto &ImplD = TF.PDR->getImplDylib();
+  if (auto Err = OptimizingLayer.add(ImplD, std::move(OptTSM),
+                                     ES.allocateVModule())) {
+    ES.reportError(std::move(Err));
+    return;
+  }
+
+  auto Sym = ES.lookup({{&ImplD, true}}, TF.OptimizedSymbol);
+  if (!Sym) {
+    ES.reportError(Sym.takeError());
+    return;
+  }
+
+  // Later calls through the stub go to the optimized body.
+  if (auto Err = TF.PDR->getISManager().updatePointer(*TF.StubSymbol,
+                                                      Sym->getAddress()))
+    ES.reportError(std::move(Err));
+}
+
+} // end namespace orc
+} // end namespace llvm
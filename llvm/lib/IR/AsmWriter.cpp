@@ -2966,9 +2966,11 @@ void AssemblyWriter::printFunctionSummary(const FunctionSummary *FS) {
     for (auto &Call : FS->calls()) {
       Out << IFS;
       Out << "(callee: ^" << Machine.getGUIDSlot(Call.first.getGUID());
-      if (Call.second.getHotness() != CalleeInfo::HotnessType::Unknown)
+      if (Call.second.getHotness() != CalleeInfo::HotnessType::Unknown) {
         Out << ", hotness: " << getHotnessName(Call.second.getHotness());
-      else if (Call.second.RelBlockFreq)
+        if (Call.second.isICallTarget())
+          Out << ", icall: 1";
+      } else if (Call.second.RelBlockFreq)
         Out << ", relbf: " << Call.second.RelBlockFreq;
       Out << ")";
     }
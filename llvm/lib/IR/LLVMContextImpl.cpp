@@ -142,18 +142,29 @@ LLVMContextImpl::~LLVMContextImpl() {
 }
 
 void LLVMContextImpl::dropTriviallyDeadConstantArrays() {
-  bool Changed;
-  do {
-    Changed = false;
-
-    for (auto I = ArrayConstants.begin(), E = ArrayConstants.end(); I != E;) {
-      auto *C = *I++;
-      if (C->use_empty()) {
-        Changed = true;
-        C->destroyConstant();
-      }
-    }
-  } while (Changed);
+  // Destroying an array can only make the arrays among its operands dead, so
+  // scan the whole map once and then follow the operands, instead of scanning
+  // the map again until nothing changes. This is called after every module
+  // that IRMover links, when the map holds the arrays of all of them.
+  SmallVector<ConstantArray *, 16> Worklist;
+  for (ConstantArray *C : ArrayConstants)
+    if (C->use_empty())
+      Worklist.push_back(C);
+
+  SmallPtrSet<ConstantArray *, 16> Destroyed;
+  while (!Worklist.empty()) {
+    ConstantArray *C = Worklist.pop_back_val();
+    if (!Destroyed.insert(C).second)
+      continue;
+    SmallVector<ConstantArray *, 8> Operands;
+    for (Value *Op : C->operands())
+      if (auto *OpC = dyn_cast<ConstantArray>(Op))
+        Operands.push_back(OpC);
+    C->destroyConstant();
+    for (ConstantArray *OpC : Operands)
+      if (!Destroyed.count(OpC) && OpC->use_empty())
+        Worklist.push_back(OpC);
+  }
 }
 
 void Module::dropTriviallyDeadConstantArrays() {
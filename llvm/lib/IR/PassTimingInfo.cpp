@@ -148,6 +148,10 @@ PassTimingInfo *PassTimingInfo::TheTimeInfo;
 } // namespace
 
 Timer *getPassTimer(Pass *P) {
+  // Don't time passes once timing is turned off again, as tools that time only
+  // some of their pipelines do.
+  if (!TimePassesIsEnabled)
+    return nullptr;
   legacy::PassTimingInfo::init();
   if (legacy::PassTimingInfo::TheTimeInfo)
     return legacy::PassTimingInfo::TheTimeInfo->getPassTimer(P, P);
@@ -16,7 +16,9 @@
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/Process.h"
+#include "llvm/Support/ThreadPool.h"
 #include "llvm/Support/raw_ostream.h"
+#include <mutex>
 
 #if !defined(_MSC_VER) && !defined(__MINGW32__)
 #include <unistd.h>
@@ -27,16 +29,152 @@
 using namespace llvm;
 using namespace llvm::lto;
 
-Expected<NativeObjectCache> lto::localCache(StringRef CacheDirectoryPath,
-                                            AddBufferFn AddBuffer) {
-  if (std::error_code EC = sys::fs::create_directories(CacheDirectoryPath))
-    return errorCodeToError(EC);
+// This choice of file name allows the cache to be pruned (see pruneCache()
+// in include/llvm/Support/CachePruning.h).
+static SmallString<64> getEntryPath(StringRef CacheDirectoryPath,
+                                    StringRef Key) {
+  SmallString<64> EntryPath;
+  sys::path::append(EntryPath, CacheDirectoryPath, "llvmcache-" + Key);
+  return EntryPath;
+}
+
+// Atomically adds an entry with the contents of Object to the cache in the
+// given directory.
+static Error writeEntry(StringRef CacheDirectoryPath, StringRef Key,
+                        MemoryBufferRef Object) {
+  SmallString<64> TempFilenameModel;
+  sys::path::append(TempFilenameModel, CacheDirectoryPath, "Thin-%%%%%%.tmp.o");
+  Expected<sys::fs::TempFile> Temp = sys::fs::TempFile::create(
+      TempFilenameModel, sys::fs::owner_read | sys::fs::owner_write);
+  if (!Temp)
+    return Temp.takeError();
+
+  raw_fd_ostream OS(Temp->FD, /* ShouldClose */ false);
+  OS << Object.getBuffer();
+  OS.flush();
+  if (OS.has_error()) {
+    OS.clear_error();
+    consumeError(Temp->discard());
+    return createStringError(errc::io_error, "failed to write " +
+                                                 Temp->TmpName);
+  }
+  return Temp->keep(getEntryPath(CacheDirectoryPath, Key));
+}
+
+namespace {
+// The state shared by all copies of a tiered cache's callback. It is destroyed
+// together with the last copy, that is, when the link no longer needs the
+// cache.
+struct TieredCacheState {
+  std::string CacheDirectoryPath;
+  std::shared_ptr<RemoteObjectCache> Remote;
+
+  // The keys requested by this link, in order. They are written to the key log
+  // so that the next link can prefetch them.
+  std::mutex Mu;
+  std::vector<std::string> RequestedKeys;
+
+  // Fetches the keys requested by the previous link. Created only if there is
+  // something to prefetch.
+  std::unique_ptr<ThreadPool> Prefetcher;
+
+  TieredCacheState(StringRef CacheDirectoryPath,
+                   std::shared_ptr<RemoteObjectCache> Remote)
+      : CacheDirectoryPath(CacheDirectoryPath), Remote(std::move(Remote)) {}
+
+  ~TieredCacheState() {
+    if (Prefetcher)
+      Prefetcher->wait();
+    writeKeyLog();
+  }
 
+  SmallString<64> getKeyLogPath() const {
+    // The pruner only considers files starting with "llvmcache-", so the key
+    // log is never pruned.
+    SmallString<64> Path;
+    sys::path::append(Path, CacheDirectoryPath, "llvmcache.keys");
+    return Path;
+  }
+
+  void addRequestedKey(StringRef Key) {
+    std::lock_guard<std::mutex> Lock(Mu);
+    RequestedKeys.push_back(Key);
+  }
+
+  void startPrefetch();
+  void writeKeyLog();
+};
+} // namespace
+
+void TieredCacheState::startPrefetch() {
+  ErrorOr<std::unique_ptr<MemoryBuffer>> MBOrErr =
+      MemoryBuffer::getFile(getKeyLogPath(), /*FileSize=*/-1,
+                            /*RequiresNullTerminator=*/false);
+  if (!MBOrErr)
+    return;
+
+  SmallVector<StringRef, 0> Lines;
+  (*MBOrErr)->getBuffer().split(Lines, '\n', /*MaxSplit=*/-1,
+                                /*KeepEmpty=*/false);
+  std::vector<std::string> Missing;
+  for (StringRef Key : Lines)
+    if (!sys::fs::exists(getEntryPath(CacheDirectoryPath, Key)))
+      Missing.push_back(Key);
+  if (Missing.empty())
+    return;
+
+  // Remote lookups are dominated by latency rather than by CPU time, so use a
+  // small, fixed number of threads regardless of the hardware.
+  Prefetcher = std::make_unique<ThreadPool>(
+      std::min<unsigned>(4, Missing.size()));
+  for (std::string &Key : Missing) {
+    // The tasks must not refer to this object because they may still be
+    // running while the callbacks are being destroyed.
+    std::string Dir = CacheDirectoryPath;
+    std::shared_ptr<RemoteObjectCache> R = Remote;
+    Prefetcher->async([Dir, R, Key]() {
+      Expected<std::unique_ptr<MemoryBuffer>> MBOrErr = R->fetch(Key);
+      if (!MBOrErr) {
+        consumeError(MBOrErr.takeError());
+        return;
+      }
+      if (*MBOrErr)
+        consumeError(writeEntry(Dir, Key, (*MBOrErr)->getMemBufferRef()));
+    });
+  }
+}
+
+void TieredCacheState::writeKeyLog() {
+  std::lock_guard<std::mutex> Lock(Mu);
+  if (RequestedKeys.empty())
+    return;
+
+  // Write to a temporary so that a link running concurrently in the same cache
+  // directory never sees a partially written log.
+  SmallString<64> TempFilenameModel;
+  sys::path::append(TempFilenameModel, CacheDirectoryPath, "Keys-%%%%%%.tmp");
+  Expected<sys::fs::TempFile> Temp = sys::fs::TempFile::create(
+      TempFilenameModel, sys::fs::owner_read | sys::fs::owner_write);
+  if (!Temp) {
+    consumeError(Temp.takeError());
+    return;
+  }
+  {
+    raw_fd_ostream OS(Temp->FD, /* ShouldClose */ false);
+    for (const std::string &Key : RequestedKeys)
+      OS << Key << '\n';
+  }
+  consumeError(Temp->keep(getKeyLogPath()));
+}
+
+static NativeObjectCache
+createCache(StringRef CacheDirectoryPath,
+            std::shared_ptr<TieredCacheState> State, AddBufferFn AddBuffer) {
   return [=](unsigned Task, StringRef Key) -> AddStreamFn {
-    // This choice of file name allows the cache to be pruned (see pruneCache()
-    // in include/llvm/Support/CachePruning.h).
-    SmallString<64> EntryPath;
-    sys::path::append(EntryPath, CacheDirectoryPath, "llvmcache-" + Key);
+    SmallString<64> EntryPath = getEntryPath(CacheDirectoryPath, Key);
+    if (State)
+      State->addRequestedKey(Key);
+
     // First, see if we have a cache hit.
     SmallString<64> ResultPath;
     Expected<sys::fs::file_t> FDOrErr = sys::fs::openNativeFileForRead(
@@ -67,20 +205,38 @@ Expected<NativeObjectCache> lto::localCache(StringRef CacheDirectoryPath,
       report_fatal_error(Twine("Failed to open cache file ") + EntryPath +
                          ": " + EC.message() + "\n");
 
+    // On a local miss, try the remote cache. An entry found there is copied
+    // into the local cache so that the next link does not need to fetch it.
+    if (State) {
+      Expected<std::unique_ptr<MemoryBuffer>> MBOrErr =
+          State->Remote->fetch(Key);
+      if (!MBOrErr) {
+        consumeError(MBOrErr.takeError());
+      } else if (*MBOrErr) {
+        consumeError(writeEntry(CacheDirectoryPath, Key,
+                                (*MBOrErr)->getMemBufferRef()));
+        AddBuffer(Task, std::move(*MBOrErr));
+        return AddStreamFn();
+      }
+    }
+
     // This native object stream is responsible for commiting the resulting
     // file to the cache and calling AddBuffer to add it to the link.
     struct CacheStream : NativeObjectStream {
       AddBufferFn AddBuffer;
       sys::fs::TempFile TempFile;
       std::string EntryPath;
+      std::string Key;
+      std::shared_ptr<TieredCacheState> State;
       unsigned Task;
 
       CacheStream(std::unique_ptr<raw_pwrite_stream> OS, AddBufferFn AddBuffer,
                   sys::fs::TempFile TempFile, std::string EntryPath,
+                  std::string Key, std::shared_ptr<TieredCacheState> State,
                   unsigned Task)
           : NativeObjectStream(std::move(OS)), AddBuffer(std::move(AddBuffer)),
             TempFile(std::move(TempFile)), EntryPath(std::move(EntryPath)),
-            Task(Task) {}
+            Key(std::move(Key)), State(std::move(State)), Task(Task) {}
 
       ~CacheStream() {
         // Make sure the stream is closed before committing it.
@@ -126,6 +282,11 @@ Expected<NativeObjectCache> lto::localCache(StringRef CacheDirectoryPath,
                              TempFile.TmpName + " to " + EntryPath + ": " +
                              toString(std::move(E)) + "\n");
 
+        // Share the new object with other machines. A failure only means that
+        // they have to build it themselves.
+        if (State)
+          consumeError(State->Remote->store(Key, (*MBOrErr)->getMemBufferRef()));
+
         AddBuffer(Task, std::move(*MBOrErr));
       }
     };
@@ -144,7 +305,71 @@ Expected<NativeObjectCache> lto::localCache(StringRef CacheDirectoryPath,
       // This CacheStream will move the temporary file into the cache when done.
       return std::make_unique<CacheStream>(
           std::make_unique<raw_fd_ostream>(Temp->FD, /* ShouldClose */ false),
-          AddBuffer, std::move(*Temp), EntryPath.str(), Task);
+          AddBuffer, std::move(*Temp), EntryPath.str(), Key.str(), State,
+          Task);
     };
   };
 }
+
+Expected<NativeObjectCache> lto::localCache(StringRef CacheDirectoryPath,
+                                            AddBufferFn AddBuffer) {
+  if (std::error_code EC = sys::fs::create_directories(CacheDirectoryPath))
+    return errorCodeToError(EC);
+  return createCache(CacheDirectoryPath, nullptr, std::move(AddBuffer));
+}
+
+Expected<NativeObjectCache>
+lto::tieredCache(StringRef CacheDirectoryPath,
+                 std::shared_ptr<RemoteObjectCache> Remote,
+                 AddBufferFn AddBuffer) {
+  if (!Remote)
+    return localCache(CacheDirectoryPath, std::move(AddBuffer));
+  if (std::error_code EC = sys::fs::create_directories(CacheDirectoryPath))
+    return errorCodeToError(EC);
+
+  auto State =
+      std::make_shared<TieredCacheState>(CacheDirectoryPath, std::move(Remote));
+  State->startPrefetch();
+  return createCache(CacheDirectoryPath, std::move(State),
+                     std::move(AddBuffer));
+}
+
+namespace {
+// A remote cache stored in a directory, usually on a file system shared by the
+// machines using it. The entries use the same names as in a local cache, so
+// the directory can be pruned with pruneCache().
+class DirectoryRemoteCache : public RemoteObjectCache {
+public:
+  DirectoryRemoteCache(StringRef DirectoryPath) : DirectoryPath(DirectoryPath) {}
+
+  Expected<std::unique_ptr<MemoryBuffer>> fetch(StringRef Key) override {
+    ErrorOr<std::unique_ptr<MemoryBuffer>> MBOrErr =
+        MemoryBuffer::getFile(getEntryPath(DirectoryPath, Key),
+                              /*FileSize=*/-1,
+                              /*RequiresNullTerminator=*/false);
+    if (MBOrErr)
+      return std::move(*MBOrErr);
+    std::error_code EC = MBOrErr.getError();
+    if (EC == errc::no_such_file_or_directory || EC == errc::permission_denied)
+      return nullptr;
+    return errorCodeToError(EC);
+  }
+
+  Error store(StringRef Key, MemoryBufferRef Object) override {
+    // Another machine may have stored the same object in the meantime.
+    if (sys::fs::exists(getEntryPath(DirectoryPath, Key)))
+      return Error::success();
+    return writeEntry(DirectoryPath, Key, Object);
+  }
+
+private:
+  std::string DirectoryPath;
+};
+} // namespace
+
+Expected<std::shared_ptr<RemoteObjectCache>>
+lto::directoryRemoteCache(StringRef DirectoryPath) {
+  if (std::error_code EC = sys::fs::create_directories(DirectoryPath))
+    return errorCodeToError(EC);
+  return std::make_shared<DirectoryRemoteCache>(DirectoryPath);
+}
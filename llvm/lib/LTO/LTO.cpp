@@ -48,6 +48,8 @@
 #include "llvm/Transforms/Utils/FunctionImportUtils.h"
 #include "llvm/Transforms/Utils/SplitModule.h"
 
+#include <condition_variable>
+#include <numeric>
 #include <set>
 
 using namespace llvm;
@@ -60,6 +62,11 @@ static cl::opt<bool>
     DumpThinCGSCCs("dump-thin-cg-sccs", cl::init(false), cl::Hidden,
                    cl::desc("Dump the SCCs in the ThinLTO index's callgraph"));
 
+static cl::opt<unsigned> ThinLTOBackendBytesPerInst(
+    "thinlto-backend-bytes-per-inst", cl::init(1024), cl::Hidden,
+    cl::desc("Estimated peak memory use of a ThinLTO backend per instruction "
+             "it compiles, used to enforce the backend memory limit"));
+
 /// Enable global value internalization in LTO.
 cl::opt<bool> EnableLTOInternalization(
     "enable-lto-internalization", cl::init(true), cl::Hidden,
@@ -146,19 +153,46 @@ void llvm::computeLTOCacheKey(
   // Include the hash for the current module
   auto ModHash = Index.getModuleHash(ModuleID);
   Hasher.update(ArrayRef<uint8_t>((uint8_t *)&ModHash[0], sizeof(ModHash)));
-  for (auto F : ExportList)
+  // The export and import lists are unordered sets, whose iteration order
+  // depends on the order in which the thin link happened to fill them. Hash
+  // them in a canonical order so that the same lists always produce the same
+  // key.
+  std::vector<GlobalValue::GUID> ExportsGUID(ExportList.begin(),
+                                             ExportList.end());
+  llvm::sort(ExportsGUID);
+  for (auto F : ExportsGUID)
     // The export list can impact the internalization, be conservative here
     Hasher.update(ArrayRef<uint8_t>((uint8_t *)&F, sizeof(F)));
 
   // Include the hash for every module we import functions from. The set of
   // imported symbols for each module may affect code generation and is
-  // sensitive to link order, so include that as well.
+  // sensitive to link order, so include that as well. The modules are ordered
+  // by their hashes rather than by their paths, so that the key does not
+  // depend on where the inputs are.
+  struct ImportedModule {
+    ModuleHash Hash;
+    StringRef Path;
+    std::vector<GlobalValue::GUID> GUIDs;
+  };
+  std::vector<ImportedModule> ImportedModules;
+  ImportedModules.reserve(ImportList.size());
   for (auto &Entry : ImportList) {
-    auto ModHash = Index.getModuleHash(Entry.first());
-    Hasher.update(ArrayRef<uint8_t>((uint8_t *)&ModHash[0], sizeof(ModHash)));
-
-    AddUint64(Entry.second.size());
-    for (auto &Fn : Entry.second)
+    ImportedModule M{Index.getModuleHash(Entry.first()), Entry.first(),
+                     {Entry.second.begin(), Entry.second.end()}};
+    llvm::sort(M.GUIDs);
+    ImportedModules.push_back(std::move(M));
+  }
+  llvm::sort(ImportedModules,
+             [](const ImportedModule &A, const ImportedModule &B) {
+               return std::tie(A.Hash, A.GUIDs, A.Path) <
+                      std::tie(B.Hash, B.GUIDs, B.Path);
+             });
+  for (const ImportedModule &M : ImportedModules) {
+    Hasher.update(ArrayRef<uint8_t>((const uint8_t *)&M.Hash[0],
+                                    sizeof(M.Hash)));
+
+    AddUint64(M.GUIDs.size());
+    for (auto &Fn : M.GUIDs)
       AddUint64(Fn);
   }
 
@@ -227,9 +261,9 @@ void llvm::computeLTOCacheKey(
 
   // Imported functions may introduce new uses of type identifier resolutions,
   // so we need to collect their used resolutions as well.
-  for (auto &ImpM : ImportList)
-    for (auto &ImpF : ImpM.second) {
-      GlobalValueSummary *S = Index.findSummaryInModule(ImpF, ImpM.first());
+  for (const ImportedModule &ImpM : ImportedModules)
+    for (auto &ImpF : ImpM.GUIDs) {
+      GlobalValueSummary *S = Index.findSummaryInModule(ImpF, ImpM.Path);
       AddUsedThings(S);
       // If this is an alias, we also care about any types/etc. that the aliasee
       // may reference.
@@ -1044,8 +1078,31 @@ public:
       const std::map<GlobalValue::GUID, GlobalValue::LinkageTypes> &ResolvedODR,
       MapVector<StringRef, BitcodeModule> &ModuleMap) = 0;
   virtual Error wait() = 0;
+
+  /// Returns true if the backends must be started in input order, e.g.
+  /// because their outputs are listed in a file as they are started.
+  virtual bool isSensitiveToInputOrder() { return false; }
 };
 
+// Predicts the cost of the backend for a module as the number of instructions
+// it has to optimize and compile: those of the functions defined in the module
+// and those of the functions it imports.
+static uint64_t
+getThinBackendCost(const ModuleSummaryIndex &Index,
+                   const GVSummaryMapTy &DefinedGlobals,
+                   const FunctionImporter::ImportMapTy &ImportList) {
+  uint64_t Cost = 0;
+  for (auto &GV : DefinedGlobals)
+    if (auto *FS = dyn_cast<FunctionSummary>(GV.second))
+      Cost += FS->instCount();
+  for (auto &Src : ImportList)
+    for (GlobalValue::GUID GUID : Src.second)
+      if (auto *FS = dyn_cast_or_null<FunctionSummary>(
+              Index.findSummaryInModule(GUID, Src.first())))
+        Cost += FS->instCount();
+  return Cost;
+}
+
 namespace {
 class InProcessThinBackend : public ThinBackendProc {
   ThreadPool BackendThreadPool;
@@ -1057,15 +1114,41 @@ class InProcessThinBackend : public ThinBackendProc {
   Optional<Error> Err;
   std::mutex ErrMu;
 
+  // The estimated memory use of the running backends and the limit it must
+  // stay under. A limit of zero means that there is no limit.
+  uint64_t MemoryLimit;
+  uint64_t MemoryInUse = 0;
+  std::mutex MemoryMu;
+  std::condition_variable MemoryCV;
+
+  void acquireMemory(uint64_t Bytes) {
+    std::unique_lock<std::mutex> L(MemoryMu);
+    // A backend that exceeds the limit on its own runs when no other backend
+    // is running.
+    MemoryCV.wait(L, [&] {
+      return MemoryInUse == 0 || MemoryInUse + Bytes <= MemoryLimit;
+    });
+    MemoryInUse += Bytes;
+  }
+
+  void releaseMemory(uint64_t Bytes) {
+    {
+      std::lock_guard<std::mutex> L(MemoryMu);
+      MemoryInUse -= Bytes;
+    }
+    MemoryCV.notify_all();
+  }
+
 public:
   InProcessThinBackend(
       Config &Conf, ModuleSummaryIndex &CombinedIndex,
-      unsigned ThinLTOParallelismLevel,
+      unsigned ThinLTOParallelismLevel, uint64_t MemoryLimit,
       const StringMap<GVSummaryMapTy> &ModuleToDefinedGVSummaries,
       AddStreamFn AddStream, NativeObjectCache Cache)
       : ThinBackendProc(Conf, CombinedIndex, ModuleToDefinedGVSummaries),
         BackendThreadPool(ThinLTOParallelismLevel),
-        AddStream(std::move(AddStream)), Cache(std::move(Cache)) {
+        AddStream(std::move(AddStream)), Cache(std::move(Cache)),
+        MemoryLimit(MemoryLimit) {
     for (auto &Name : CombinedIndex.cfiFunctionDefs())
       CfiFunctionDefs.insert(
           GlobalValue::getGUID(GlobalValue::dropLLVMManglingEscape(Name)));
@@ -1122,6 +1205,11 @@ public:
     assert(ModuleToDefinedGVSummaries.count(ModulePath));
     const GVSummaryMapTy &DefinedGlobals =
         ModuleToDefinedGVSummaries.find(ModulePath)->second;
+    uint64_t MemoryEstimate = 0;
+    if (MemoryLimit)
+      MemoryEstimate =
+          getThinBackendCost(CombinedIndex, DefinedGlobals, ImportList) *
+          ThinLTOBackendBytesPerInst;
     BackendThreadPool.async(
         [=](BitcodeModule BM, ModuleSummaryIndex &CombinedIndex,
             const FunctionImporter::ImportMapTy &ImportList,
@@ -1130,9 +1218,13 @@ public:
                 &ResolvedODR,
             const GVSummaryMapTy &DefinedGlobals,
             MapVector<StringRef, BitcodeModule> &ModuleMap) {
+          if (MemoryLimit)
+            acquireMemory(MemoryEstimate);
           Error E = runThinLTOBackendThread(
               AddStream, Cache, Task, BM, CombinedIndex, ImportList, ExportList,
               ResolvedODR, DefinedGlobals, ModuleMap);
+          if (MemoryLimit)
+            releaseMemory(MemoryEstimate);
           if (E) {
             std::unique_lock<std::mutex> L(ErrMu);
             if (Err)
@@ -1156,13 +1248,14 @@ public:
 };
 } // end anonymous namespace
 
-ThinBackend lto::createInProcessThinBackend(unsigned ParallelismLevel) {
+ThinBackend lto::createInProcessThinBackend(unsigned ParallelismLevel,
+                                            uint64_t MemoryLimit) {
   return [=](Config &Conf, ModuleSummaryIndex &CombinedIndex,
              const StringMap<GVSummaryMapTy> &ModuleToDefinedGVSummaries,
              AddStreamFn AddStream, NativeObjectCache Cache) {
     return std::make_unique<InProcessThinBackend>(
-        Conf, CombinedIndex, ParallelismLevel, ModuleToDefinedGVSummaries,
-        AddStream, Cache);
+        Conf, CombinedIndex, ParallelismLevel, MemoryLimit,
+        ModuleToDefinedGVSummaries, AddStream, Cache);
   };
 }
 
@@ -1241,6 +1334,11 @@ public:
   }
 
   Error wait() override { return Error::success(); }
+
+  bool isSensitiveToInputOrder() override {
+    // The linked objects file lists the modules in the order they are started.
+    return true;
+  }
 };
 } // end anonymous namespace
 
@@ -1361,16 +1459,39 @@ Error LTO::runThinLTO(AddStreamFn AddStream, NativeObjectCache Cache,
                       AddStream, Cache);
 
   // Tasks 0 through ParallelCodeGenParallelismLevel-1 are reserved for combined
-  // module and parallel code generation partitions.
-  unsigned Task = RegularLTO.ParallelCodeGenParallelismLevel;
-  for (auto &Mod : ThinLTO.ModuleMap) {
-    if (Error E = BackendProc->start(Task, Mod.second, ImportLists[Mod.first],
-                                     ExportLists[Mod.first],
-                                     ResolvedODR[Mod.first], ThinLTO.ModuleMap))
-      return E;
-    ++Task;
+  // module and parallel code generation partitions. The task of a module does
+  // not depend on the order in which the backends are started.
+  auto StartModule = [&](size_t I) -> Error {
+    auto &Mod = *(ThinLTO.ModuleMap.begin() + I);
+    unsigned Task = RegularLTO.ParallelCodeGenParallelismLevel + I;
+    return BackendProc->start(Task, Mod.second, ImportLists[Mod.first],
+                              ExportLists[Mod.first], ResolvedODR[Mod.first],
+                              ThinLTO.ModuleMap);
+  };
+
+  std::vector<size_t> Order(ThinLTO.ModuleMap.size());
+  std::iota(Order.begin(), Order.end(), 0);
+  if (!BackendProc->isSensitiveToInputOrder()) {
+    // Start the most expensive backends first, so that a large module that
+    // happens to come last does not extend the tail of the link.
+    std::vector<uint64_t> Costs;
+    Costs.reserve(Order.size());
+    for (auto &Mod : ThinLTO.ModuleMap) {
+      auto It = ModuleToDefinedGVSummaries.find(Mod.first);
+      Costs.push_back(It == ModuleToDefinedGVSummaries.end()
+                          ? 0
+                          : getThinBackendCost(ThinLTO.CombinedIndex,
+                                               It->second,
+                                               ImportLists[Mod.first]));
+    }
+    llvm::stable_sort(Order,
+                      [&](size_t A, size_t B) { return Costs[A] > Costs[B]; });
   }
 
+  for (size_t I : Order)
+    if (Error E = StartModule(I))
+      return E;
+
   return BackendProc->wait();
 }
 
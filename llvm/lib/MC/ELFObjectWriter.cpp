@@ -39,6 +39,7 @@
 #include "llvm/Support/Alignment.h"
 #include "llvm/Support/Allocator.h"
 #include "llvm/Support/Casting.h"
+#include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Compression.h"
 #include "llvm/Support/Endian.h"
 #include "llvm/Support/Error.h"
@@ -46,6 +47,7 @@
 #include "llvm/Support/Host.h"
 #include "llvm/Support/LEB128.h"
 #include "llvm/Support/MathExtras.h"
+#include "llvm/Support/Parallel.h"
 #include "llvm/Support/SMLoc.h"
 #include "llvm/Support/StringSaver.h"
 #include "llvm/Support/SwapByteOrder.h"
@@ -65,6 +67,11 @@ using namespace llvm;
 #undef  DEBUG_TYPE
 #define DEBUG_TYPE "reloc-info"
 
+static cl::opt<unsigned> ParallelWriteMinSections(
+    "elf-parallel-write-min-sections", cl::Hidden, cl::init(64),
+    cl::desc("Encode the sections and relocations of ELF objects in parallel "
+             "from this many sections on (0 = never)"));
+
 namespace {
 
 using SectionIndexMapTy = DenseMap<const MCSectionELF *, uint32_t>;
@@ -220,7 +227,9 @@ public:
                         uint32_t Link, uint32_t Info, uint64_t Alignment,
                         uint64_t EntrySize);
 
-  void writeRelocations(const MCAssembler &Asm, const MCSectionELF &Sec);
+  void writeRelocations(const MCAssembler &Asm, const MCSectionELF &Sec,
+                        std::vector<ELFRelocationEntry> &Relocs,
+                        raw_ostream &OS);
 
   uint64_t writeObject(MCAssembler &Asm, const MCAsmLayout &Layout);
   void writeSection(const SectionIndexMapTy &SectionIndexMap,
@@ -863,6 +872,42 @@ bool ELFWriter::maybeWriteCompression(
   return true;
 }
 
+/// Returns true if the contents of \p Sec are compressed when written.
+static bool mayCompressSection(const MCAsmInfo &MAI, const MCSectionELF &Sec) {
+  // Compressing debug_frame requires handling alignment fragments which is
+  // more work (possibly generalizing MCAssembler.cpp:writeFragment to allow
+  // for writing to arbitrary buffers) for little benefit.
+  StringRef SectionName = Sec.getSectionName();
+  return MAI.compressDebugSections() != DebugCompressionType::None &&
+         SectionName.startswith(".debug_") && SectionName != ".debug_frame";
+}
+
+/// Returns true if writing the contents of \p Sec only reads its fragments
+/// and their final layout, so that several sections can be written at once.
+/// Writing other fragments evaluates expressions, which marks symbols used.
+static bool canWriteSectionInParallel(const MCAsmInfo &MAI,
+                                      const MCSectionELF &Sec) {
+  if (mayCompressSection(MAI, Sec))
+    return false;
+  for (const MCFragment &F : Sec) {
+    switch (F.getKind()) {
+    case MCFragment::FT_Align:
+    case MCFragment::FT_Data:
+    case MCFragment::FT_CompactEncodedInst:
+    case MCFragment::FT_Relaxable:
+    case MCFragment::FT_Dwarf:
+    case MCFragment::FT_DwarfFrame:
+    case MCFragment::FT_LEB:
+    case MCFragment::FT_Padding:
+    case MCFragment::FT_Dummy:
+      continue;
+    default:
+      return false;
+    }
+  }
+  return true;
+}
+
 void ELFWriter::writeSectionData(const MCAssembler &Asm, MCSection &Sec,
                                  const MCAsmLayout &Layout) {
   MCSectionELF &Section = static_cast<MCSectionELF &>(Sec);
@@ -871,13 +916,7 @@ void ELFWriter::writeSectionData(const MCAssembler &Asm, MCSection &Sec,
   auto &MC = Asm.getContext();
   const auto &MAI = MC.getAsmInfo();
 
-  // Compressing debug_frame requires handling alignment fragments which is
-  // more work (possibly generalizing MCAssembler.cpp:writeFragment to allow
-  // for writing to arbitrary buffers) for little benefit.
-  bool CompressionEnabled =
-      MAI->compressDebugSections() != DebugCompressionType::None;
-  if (!CompressionEnabled || !SectionName.startswith(".debug_") ||
-      SectionName == ".debug_frame") {
+  if (!mayCompressSection(*MAI, Section)) {
     Asm.writeSectionData(W.OS, &Section, Layout);
     return;
   }
@@ -936,8 +975,10 @@ void ELFWriter::WriteSecHdrEntry(uint32_t Name, uint32_t Type, uint64_t Flags,
 }
 
 void ELFWriter::writeRelocations(const MCAssembler &Asm,
-                                       const MCSectionELF &Sec) {
-  std::vector<ELFRelocationEntry> &Relocs = OWriter.Relocations[&Sec];
+                                 const MCSectionELF &Sec,
+                                 std::vector<ELFRelocationEntry> &Relocs,
+                                 raw_ostream &OS) {
+  support::endian::Writer RW(OS, W.Endian);
 
   // We record relocations by pushing to the end of a vector. Reverse the vector
   // to get the relocations in the order they were created.
@@ -953,47 +994,47 @@ void ELFWriter::writeRelocations(const MCAssembler &Asm,
     unsigned Index = Entry.Symbol ? Entry.Symbol->getIndex() : 0;
 
     if (is64Bit()) {
-      write(Entry.Offset);
+      RW.write(Entry.Offset);
       if (OWriter.TargetObjectWriter->getEMachine() == ELF::EM_MIPS) {
-        write(uint32_t(Index));
+        RW.write(uint32_t(Index));
 
-        write(OWriter.TargetObjectWriter->getRSsym(Entry.Type));
-        write(OWriter.TargetObjectWriter->getRType3(Entry.Type));
-        write(OWriter.TargetObjectWriter->getRType2(Entry.Type));
-        write(OWriter.TargetObjectWriter->getRType(Entry.Type));
+        RW.write(OWriter.TargetObjectWriter->getRSsym(Entry.Type));
+        RW.write(OWriter.TargetObjectWriter->getRType3(Entry.Type));
+        RW.write(OWriter.TargetObjectWriter->getRType2(Entry.Type));
+        RW.write(OWriter.TargetObjectWriter->getRType(Entry.Type));
       } else {
         struct ELF::Elf64_Rela ERE64;
         ERE64.setSymbolAndType(Index, Entry.Type);
-        write(ERE64.r_info);
+        RW.write(ERE64.r_info);
       }
       if (hasRelocationAddend())
-        write(Entry.Addend);
+        RW.write(Entry.Addend);
     } else {
-      write(uint32_t(Entry.Offset));
+      RW.write(uint32_t(Entry.Offset));
 
       struct ELF::Elf32_Rela ERE32;
       ERE32.setSymbolAndType(Index, Entry.Type);
-      write(ERE32.r_info);
+      RW.write(ERE32.r_info);
 
       if (hasRelocationAddend())
-        write(uint32_t(Entry.Addend));
+        RW.write(uint32_t(Entry.Addend));
 
       if (OWriter.TargetObjectWriter->getEMachine() == ELF::EM_MIPS) {
         if (uint32_t RType =
                 OWriter.TargetObjectWriter->getRType2(Entry.Type)) {
-          write(uint32_t(Entry.Offset));
+          RW.write(uint32_t(Entry.Offset));
 
           ERE32.setSymbolAndType(0, RType);
-          write(ERE32.r_info);
-          write(uint32_t(0));
+          RW.write(ERE32.r_info);
+          RW.write(uint32_t(0));
         }
         if (uint32_t RType =
                 OWriter.TargetObjectWriter->getRType3(Entry.Type)) {
-          write(uint32_t(Entry.Offset));
+          RW.write(uint32_t(Entry.Offset));
 
           ERE32.setSymbolAndType(0, RType);
-          write(ERE32.r_info);
-          write(uint32_t(0));
+          RW.write(ERE32.r_info);
+          RW.write(uint32_t(0));
         }
       }
     }
@@ -1106,15 +1147,47 @@ uint64_t ELFWriter::writeObject(MCAssembler &Asm, const MCAsmLayout &Layout) {
   writeHeader(Asm);
 
   // ... then the sections ...
-  SectionOffsetsTy SectionOffsets;
-  std::vector<MCSectionELF *> Groups;
-  std::vector<MCSectionELF *> Relocations;
+  std::vector<MCSectionELF *> Sections;
   for (MCSection &Sec : Asm) {
     MCSectionELF &Section = static_cast<MCSectionELF &>(Sec);
     if (Mode == NonDwoOnly && isDwoSection(Section))
       continue;
     if (Mode == DwoOnly && !isDwoSection(Section))
       continue;
+    Sections.push_back(&Section);
+  }
+
+  // With many sections, encode their contents in parallel beforehand, each
+  // into a buffer of its final size. Querying the sizes first completes the
+  // layout, which the threads then only read.
+  bool WriteInParallel =
+      ParallelWriteMinSections && Sections.size() >= ParallelWriteMinSections;
+  std::vector<SmallString<0>> Contents;
+  std::vector<bool> HasContents;
+  if (WriteInParallel) {
+    const MCAsmInfo &MAI = *Ctx.getAsmInfo();
+    Contents.resize(Sections.size());
+    HasContents.resize(Sections.size());
+    for (size_t I = 0, E = Sections.size(); I != E; ++I) {
+      if (!canWriteSectionInParallel(MAI, *Sections[I]))
+        continue;
+      Contents[I].reserve(Layout.getSectionFileSize(Sections[I]));
+      HasContents[I] = true;
+    }
+    parallel::for_each_n(parallel::par, size_t(0), Sections.size(),
+                         [&](size_t I) {
+                           if (!HasContents[I])
+                             return;
+                           raw_svector_ostream OS(Contents[I]);
+                           Asm.writeSectionData(OS, Sections[I], Layout);
+                         });
+  }
+
+  SectionOffsetsTy SectionOffsets;
+  std::vector<MCSectionELF *> Groups;
+  std::vector<MCSectionELF *> Relocations;
+  for (size_t I = 0, E = Sections.size(); I != E; ++I) {
+    MCSectionELF &Section = *Sections[I];
 
     align(Section.getAlignment());
 
@@ -1122,7 +1195,12 @@ uint64_t ELFWriter::writeObject(MCAssembler &Asm, const MCAsmLayout &Layout) {
     uint64_t SecStart = W.OS.tell();
 
     const MCSymbolELF *SignatureSymbol = Section.getGroup();
-    writeSectionData(Asm, Section, Layout);
+    if (WriteInParallel && HasContents[I]) {
+      W.OS << Contents[I];
+      Contents[I] = SmallString<0>();
+    } else {
+      writeSectionData(Asm, Section, Layout);
+    }
 
     uint64_t SecEnd = W.OS.tell();
     SectionOffsets[&Section] = std::make_pair(SecStart, SecEnd);
@@ -1196,14 +1274,38 @@ uint64_t ELFWriter::writeObject(MCAssembler &Asm, const MCAsmLayout &Layout) {
     computeSymbolTable(Asm, Layout, SectionIndexMap, RevGroupMap,
                        SectionOffsets);
 
-    for (MCSectionELF *RelSection : Relocations) {
+    // The symbol indices are final now, so the relocation tables can be
+    // encoded in parallel too.
+    std::vector<std::vector<ELFRelocationEntry> *> Relocs;
+    for (MCSectionELF *RelSection : Relocations)
+      Relocs.push_back(&OWriter.Relocations[cast<MCSectionELF>(
+          RelSection->getAssociatedSection())]);
+    std::vector<SmallString<0>> RelContents;
+    if (WriteInParallel) {
+      RelContents.resize(Relocations.size());
+      parallel::for_each_n(
+          parallel::par, size_t(0), Relocations.size(), [&](size_t I) {
+            const MCSection *Sec = Relocations[I]->getAssociatedSection();
+            raw_svector_ostream OS(RelContents[I]);
+            writeRelocations(Asm, cast<MCSectionELF>(*Sec), *Relocs[I], OS);
+          });
+    }
+
+    for (size_t I = 0, E = Relocations.size(); I != E; ++I) {
+      MCSectionELF *RelSection = Relocations[I];
       align(RelSection->getAlignment());
 
       // Remember the offset into the file for this section.
       uint64_t SecStart = W.OS.tell();
 
-      writeRelocations(Asm,
-                       cast<MCSectionELF>(*RelSection->getAssociatedSection()));
+      if (WriteInParallel) {
+        W.OS << RelContents[I];
+        RelContents[I] = SmallString<0>();
+      } else {
+        writeRelocations(
+            Asm, cast<MCSectionELF>(*RelSection->getAssociatedSection()),
+            *Relocs[I], W.OS);
+      }
 
       uint64_t SecEnd = W.OS.tell();
       SectionOffsets[RelSection] = std::make_pair(SecStart, SecEnd);
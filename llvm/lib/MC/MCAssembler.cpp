@@ -68,6 +68,8 @@ STATISTIC(FragmentLayouts, "Number of fragment layouts");
 STATISTIC(ObjectBytes, "Number of emitted object file bytes");
 STATISTIC(RelaxationSteps, "Number of assembler layout and relaxation steps");
 STATISTIC(RelaxedInstructions, "Number of relaxed instructions");
+STATISTIC(SkippedSectionLayouts,
+          "Number of section layouts skipped as nothing changed since");
 STATISTIC(PaddingFragmentsRelaxations,
           "Number of Padding Fragments relaxations");
 STATISTIC(PaddingFragmentsBytes,
@@ -103,6 +105,8 @@ void MCAssembler::reset() {
   DataRegions.clear();
   LinkerOptions.clear();
   FileNames.clear();
+  LayoutGeneration = 0;
+  SectionStableGeneration.clear();
   ThumbFuncs.clear();
   BundleAlignSize = 0;
   RelaxAll = false;
@@ -783,6 +787,8 @@ void MCAssembler::layout(MCAsmLayout &Layout) {
   }
 
   // Layout until everything fits.
+  LayoutGeneration = 0;
+  SectionStableGeneration.assign(SectionIndex, ~0u);
   while (layoutOnce(Layout))
     if (getContext().hadError())
       return;
@@ -1112,8 +1118,18 @@ bool MCAssembler::layoutOnce(MCAsmLayout &Layout) {
   bool WasRelaxed = false;
   for (iterator it = begin(), ie = end(); it != ie; ++it) {
     MCSection &Sec = *it;
-    while (layoutSectionOnce(Layout, Sec))
+    // Relaxation only depends on the layout, so a section which was stable
+    // is still stable if no section changed since.
+    unsigned &StableGeneration = SectionStableGeneration[Sec.getOrdinal()];
+    if (StableGeneration == LayoutGeneration) {
+      ++stats::SkippedSectionLayouts;
+      continue;
+    }
+    while (layoutSectionOnce(Layout, Sec)) {
       WasRelaxed = true;
+      ++LayoutGeneration;
+    }
+    StableGeneration = LayoutGeneration;
   }
 
   return WasRelaxed;
@@ -357,6 +357,23 @@ void MCObjectStreamer::EmitInstructionImpl(const MCInst &Inst,
   EmitInstToFragment(Inst, STI);
 }
 
+unsigned MCObjectStreamer::encodeInstToDataFragment(MCDataFragment &DF,
+                                                    const MCInst &Inst,
+                                                    const MCSubtargetInfo &STI) {
+  // Encode straight into the fragment instead of going through a temporary
+  // buffer. Fixup offsets are relative to the start of the instruction.
+  SmallVectorImpl<char> &Contents = DF.getContents();
+  SmallVectorImpl<MCFixup> &Fixups = DF.getFixups();
+  uint64_t Offset = Contents.size();
+  unsigned FirstFixup = Fixups.size();
+  raw_svector_ostream VecOS(Contents);
+  getAssembler().getEmitter().encodeInstruction(Inst, VecOS, Fixups, STI);
+  for (unsigned i = FirstFixup, e = Fixups.size(); i != e; ++i)
+    Fixups[i].setOffset(Fixups[i].getOffset() + Offset);
+  DF.setHasInstructions(STI);
+  return FirstFixup;
+}
+
 void MCObjectStreamer::EmitInstToFragment(const MCInst &Inst,
                                           const MCSubtargetInfo &STI) {
   if (getAssembler().getRelaxAll() && getAssembler().isBundlingEnabled())
@@ -23,7 +23,9 @@
 #include "llvm/Support/EndianStream.h"
 #include "llvm/Support/Errc.h"
 #include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/FileOutputBuffer.h"
 #include "llvm/Support/Format.h"
+#include "llvm/Support/Parallel.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/ToolOutputFile.h"
 #include "llvm/Support/raw_ostream.h"
@@ -453,7 +455,43 @@ computeMemberData(raw_ostream &StringTable, raw_ostream &SymNames,
       Entry.second = Entry.second > 1 ? 1 : 0;
   }
 
-  for (const NewArchiveMember &M : NewMembers) {
+  // Reading the symbols of the members is the expensive part, so do it for
+  // all members in parallel. The names of each member go to a buffer of their
+  // own and are appended to SymNames in member order below.
+  struct MemberSymbols {
+    std::string Names;
+    std::vector<unsigned> Offsets;
+    bool HasObject = false;
+    Error Err = Error::success();
+  };
+  std::vector<MemberSymbols> Symbols(NewMembers.size());
+  parallel::for_each_n(parallel::par, size_t(0), NewMembers.size(),
+                       [&](size_t I) {
+                         MemberSymbols &Syms = Symbols[I];
+                         raw_string_ostream Names(Syms.Names);
+                         Expected<std::vector<unsigned>> OffsetsOrErr =
+                             getSymbols(NewMembers[I].Buf->getMemBufferRef(),
+                                        Names, Syms.HasObject);
+                         Names.flush();
+                         if (OffsetsOrErr)
+                           Syms.Offsets = std::move(*OffsetsOrErr);
+                         else
+                           Syms.Err = OffsetsOrErr.takeError();
+                       });
+  Error Err = Error::success();
+  for (MemberSymbols &Syms : Symbols) {
+    if (!Syms.Err)
+      continue;
+    if (Err)
+      consumeError(std::move(Syms.Err));
+    else
+      Err = std::move(Syms.Err);
+  }
+  if (Err)
+    return std::move(Err);
+
+  for (size_t I = 0, E = NewMembers.size(); I != E; ++I) {
+    const NewArchiveMember &M = NewMembers[I];
     std::string Header;
     raw_string_ostream Out(Header);
 
@@ -489,13 +527,15 @@ computeMemberData(raw_ostream &StringTable, raw_ostream &SymNames,
                       ModTime, Size);
     Out.flush();
 
-    Expected<std::vector<unsigned>> Symbols =
-        getSymbols(Buf, SymNames, HasObject);
-    if (auto E = Symbols.takeError())
-      return std::move(E);
+    MemberSymbols &Syms = Symbols[I];
+    unsigned NamesPos = SymNames.tell();
+    for (unsigned &Offset : Syms.Offsets)
+      Offset += NamesPos;
+    SymNames << Syms.Names;
+    HasObject |= Syms.HasObject;
 
     Pos += Header.size() + Data.size() + Padding.size();
-    Ret.push_back({std::move(*Symbols), std::move(Header), Data, Padding});
+    Ret.push_back({std::move(Syms.Offsets), std::move(Header), Data, Padding});
   }
   // If there are no symbols, emit an empty symbol table, to satisfy Solaris
   // tools, older versions of which expect a symbol table in a non-empty
@@ -604,24 +644,42 @@ Error writeArchive(StringRef ArcName, ArrayRef<NewArchiveMember> NewMembers,
     }
   }
 
-  Expected<sys::fs::TempFile> Temp =
-      sys::fs::TempFile::create(ArcName + ".temp-archive-%%%%%%%.a");
-  if (!Temp)
-    return Temp.takeError();
-
-  raw_fd_ostream Out(Temp->FD, false);
+  // The magic and the symbol table are small, so build them in memory. Then
+  // every member has a known offset in the file and can be copied into place
+  // independently of the others.
+  SmallString<0> HeadBuf;
+  raw_svector_ostream Head(HeadBuf);
   if (Thin)
-    Out << "!<thin>\n";
+    Head << "!<thin>\n";
   else
-    Out << "!<arch>\n";
+    Head << "!<arch>\n";
 
   if (WriteSymtab)
-    writeSymbolTable(Out, Kind, Deterministic, Data, SymNamesBuf);
-
-  for (const MemberData &M : Data)
-    Out << M.Header << M.Data << M.Padding;
+    writeSymbolTable(Head, Kind, Deterministic, Data, SymNamesBuf);
+
+  std::vector<uint64_t> MemberOffsets;
+  MemberOffsets.reserve(Data.size());
+  uint64_t Size = HeadBuf.size();
+  for (const MemberData &M : Data) {
+    MemberOffsets.push_back(Size);
+    Size += M.Header.size() + M.Data.size() + M.Padding.size();
+  }
 
-  Out.flush();
+  Expected<std::unique_ptr<FileOutputBuffer>> BufOrErr =
+      FileOutputBuffer::create(ArcName, Size);
+  if (!BufOrErr)
+    return BufOrErr.takeError();
+  std::unique_ptr<FileOutputBuffer> &Buf = *BufOrErr;
+  uint8_t *Out = Buf->getBufferStart();
+
+  memcpy(Out, HeadBuf.data(), HeadBuf.size());
+  parallel::for_each_n(parallel::par, size_t(0), Data.size(), [&](size_t I) {
+    const MemberData &M = Data[I];
+    uint8_t *P = Out + MemberOffsets[I];
+    P = std::copy(M.Header.begin(), M.Header.end(), P);
+    P = std::copy(M.Data.begin(), M.Data.end(), P);
+    std::copy(M.Padding.begin(), M.Padding.end(), P);
+  });
 
   // At this point, we no longer need whatever backing memory
   // was used to generate the NewMembers. On Windows, this buffer
@@ -635,7 +693,7 @@ Error writeArchive(StringRef ArcName, ArrayRef<NewArchiveMember> NewMembers,
   // closed before we attempt to rename.
   OldArchiveBuf.reset();
 
-  return Temp->keep(ArcName);
+  return Buf->commit();
 }
 
 } // namespace llvm
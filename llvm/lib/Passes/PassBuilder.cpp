@@ -231,10 +231,20 @@ PipelineTuningOptions::PipelineTuningOptions() {
 }
 
 extern cl::opt<bool> EnableHotColdSplit;
+extern cl::opt<bool> EnablePGOHotColdSplit;
 extern cl::opt<bool> EnableOrderFileInstrumentation;
 
 extern cl::opt<bool> FlattenedProfileUsed;
 
+/// Whether to split out cold code. Splitting is on by default when optimizing
+/// with a profile, as the profile tells the cold code apart reliably.
+static bool shouldSplitHotCold(const Optional<PGOOptions> &PGOOpt) {
+  return EnableHotColdSplit ||
+         (EnablePGOHotColdSplit && PGOOpt &&
+          (PGOOpt->Action == PGOOptions::IRUse ||
+           PGOOpt->Action == PGOOptions::SampleUse));
+}
+
 static bool isOptimizingForSize(PassBuilder::OptimizationLevel Level) {
   switch (Level) {
   case PassBuilder::O0:
@@ -974,7 +984,7 @@ ModulePassManager PassBuilder::buildModuleOptimizationPipeline(
   // Split out cold code. Splitting is done late to avoid hiding context from
   // other optimizations and inadvertently regressing performance. The tradeoff
   // is that this has a higher code size cost than splitting early.
-  if (EnableHotColdSplit && !LTOPreLink)
+  if (shouldSplitHotCold(PGOOpt) && !LTOPreLink)
     MPM.addPass(HotColdSplittingPass());
 
   // LoopSink pass sinks instructions hoisted by LICM, which serves as a
@@ -1340,7 +1350,7 @@ PassBuilder::buildLTODefaultPipeline(OptimizationLevel Level, bool DebugLogging,
 
   // Enable splitting late in the FullLTO post-link pipeline. This is done in
   // the same stage in the old pass manager (\ref addLateLTOOptimizationPasses).
-  if (EnableHotColdSplit)
+  if (shouldSplitHotCold(PGOOpt))
     MPM.addPass(HotColdSplittingPass());
 
   // Add late LTO optimization passes.
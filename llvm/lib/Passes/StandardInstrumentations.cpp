@@ -7,8 +7,9 @@
 //===----------------------------------------------------------------------===//
 /// \file
 ///
-/// This file defines IR-printing pass instrumentation callbacks as well as
-/// StandardInstrumentations class that manages standard pass instrumentations.
+/// This file defines IR-printing and profiling pass instrumentation callbacks
+/// as well as StandardInstrumentations class that manages standard pass
+/// instrumentations.
 ///
 //===----------------------------------------------------------------------===//
 
@@ -21,12 +22,29 @@
 #include "llvm/IR/IRPrintingPasses.h"
 #include "llvm/IR/Module.h"
 #include "llvm/IR/PassInstrumentation.h"
+#include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Debug.h"
+#include "llvm/Support/FileSystem.h"
 #include "llvm/Support/FormatVariadic.h"
+#include "llvm/Support/JSON.h"
+#include "llvm/Support/Process.h"
+#include "llvm/Support/TimeProfiler.h"
+#include "llvm/Support/WithColor.h"
 #include "llvm/Support/raw_ostream.h"
+#include <algorithm>
 
 using namespace llvm;
 
+static cl::opt<std::string> PassProfileFile(
+    "pass-profile-file", cl::Hidden, cl::value_desc("filename"),
+    cl::desc("Write the time, allocations and instruction count change of "
+             "each pass to this file as JSON (new pass manager only)"));
+
+static cl::opt<unsigned> PassProfileMinTimeUs(
+    "pass-profile-min-time-us", cl::Hidden, cl::init(100),
+    cl::desc("Minimum time in microseconds of a single pass run for it to be "
+             "listed in -pass-profile-file, besides the per pass totals"));
+
 namespace {
 
 /// Extracting Module out of \p IR unit. Also fills a textual description
@@ -235,8 +253,204 @@ void PrintIRInstrumentation::registerCallbacks(
   }
 }
 
+namespace {
+
+/// Returns the number of instructions of \p IR, or 0 for IR units with no
+/// instructions of their own.
+int64_t getInstructionCount(Any IR) {
+  if (any_isa<const Module *>(IR)) {
+    int64_t Count = 0;
+    for (const Function &F : *any_cast<const Module *>(IR))
+      Count += F.getInstructionCount();
+    return Count;
+  }
+  if (any_isa<const Function *>(IR))
+    return any_cast<const Function *>(IR)->getInstructionCount();
+  if (any_isa<const LazyCallGraph::SCC *>(IR)) {
+    int64_t Count = 0;
+    const LazyCallGraph::SCC *C = any_cast<const LazyCallGraph::SCC *>(IR);
+    for (const LazyCallGraph::Node &N : *C)
+      Count += N.getFunction().getInstructionCount();
+    return Count;
+  }
+  if (any_isa<const Loop *>(IR)) {
+    int64_t Count = 0;
+    for (const BasicBlock *BB : any_cast<const Loop *>(IR)->blocks())
+      Count += BB->size();
+    return Count;
+  }
+  return 0;
+}
+
+/// Returns a description of \p IR for the profile and time trace events.
+std::string getIRName(Any IR) {
+  if (any_isa<const Module *>(IR))
+    return any_cast<const Module *>(IR)->getName().str();
+  if (any_isa<const Function *>(IR))
+    return any_cast<const Function *>(IR)->getName().str();
+  if (any_isa<const LazyCallGraph::SCC *>(IR))
+    return any_cast<const LazyCallGraph::SCC *>(IR)->getName();
+  if (any_isa<const Loop *>(IR)) {
+    std::string LoopName;
+    raw_string_ostream OS(LoopName);
+    any_cast<const Loop *>(IR)->getHeader()->printAsOperand(OS, false);
+    return OS.str();
+  }
+  return std::string();
+}
+
+} // namespace
+
+PassProfileInstrumentation::PassProfileInstrumentation() = default;
+
+bool PassProfileInstrumentation::isEnabled() const {
+  return OutStream || !PassProfileFile.empty() || timeTraceProfilerEnabled();
+}
+
+void PassProfileInstrumentation::begin(StringRef PassID, Any IR) {
+  if (PassID.startswith("PassManager<") || PassID.contains("PassAdaptor<"))
+    return;
+
+  Frame F;
+  F.PassID = PassID;
+  F.Traced = timeTraceProfilerEnabled();
+  if (F.Traced)
+    timeTraceProfilerBegin(PassID, [&] { return getIRName(IR); });
+  F.InstsStart = getInstructionCount(IR);
+  F.MallocStart = sys::Process::GetMallocUsage();
+  F.Start = Clock::now();
+  Stack.push_back(F);
+}
+
+void PassProfileInstrumentation::end(StringRef PassID, const Any *IR) {
+  if (PassID.startswith("PassManager<") || PassID.contains("PassAdaptor<"))
+    return;
+
+  Clock::time_point Now = Clock::now();
+  int64_t MallocNow = sys::Process::GetMallocUsage();
+  assert(!Stack.empty() && Stack.back().PassID == PassID &&
+         "Unbalanced pass profile");
+  Frame F = Stack.pop_back_val();
+  if (F.Traced)
+    timeTraceProfilerEnd();
+
+  // Passes that invalidated their IR unit are assumed to have removed all of
+  // its instructions.
+  int64_t InstDelta = (IR ? getInstructionCount(*IR) : 0) - F.InstsStart;
+  Clock::duration Time = Now - F.Start;
+  int64_t Malloc = MallocNow - static_cast<int64_t>(F.MallocStart);
+  if (!Stack.empty()) {
+    Frame &Parent = Stack.back();
+    Parent.ChildTime += Time;
+    Parent.ChildMalloc += Malloc;
+    Parent.ChildInsts += InstDelta;
+  }
+  Time -= F.ChildTime;
+  Malloc -= F.ChildMalloc;
+  InstDelta -= F.ChildInsts;
+
+  Totals &T = PassTotals[PassID];
+  ++T.Count;
+  T.Time += Time;
+  T.MallocBytes += Malloc;
+  T.InstDelta += InstDelta;
+
+  if (Time >= std::chrono::microseconds(PassProfileMinTimeUs))
+    SlowRuns.push_back({PassID.str(),
+                        IR ? getIRName(*IR) : std::string("<invalidated>"),
+                        Time, Malloc, InstDelta});
+}
+
+void PassProfileInstrumentation::print() {
+  if (PassTotals.empty() && SlowRuns.empty())
+    return;
+
+  std::unique_ptr<raw_fd_ostream> File;
+  raw_ostream *OS = OutStream;
+  if (!OS) {
+    if (PassProfileFile.empty())
+      return;
+    std::error_code EC;
+    File = std::make_unique<raw_fd_ostream>(PassProfileFile, EC,
+                                            sys::fs::OF_Text);
+    if (EC) {
+      WithColor::warning() << "could not open pass profile file '"
+                           << PassProfileFile << "': " << EC.message() << "\n";
+      PassTotals.clear();
+      SlowRuns.clear();
+      return;
+    }
+    OS = File.get();
+  }
+
+  auto toUs = [](Clock::duration D) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(D).count();
+  };
+
+  std::vector<StringMapEntry<Totals> *> Passes;
+  for (StringMapEntry<Totals> &E : PassTotals)
+    Passes.push_back(&E);
+  llvm::sort(Passes, [](const StringMapEntry<Totals> *A,
+                        const StringMapEntry<Totals> *B) {
+    if (A->getValue().Time != B->getValue().Time)
+      return A->getValue().Time > B->getValue().Time;
+    return A->getKey() < B->getKey();
+  });
+
+  json::OStream J(*OS, 2);
+  J.object([&] {
+    J.attributeArray("passes", [&] {
+      for (const StringMapEntry<Totals> *E : Passes) {
+        const Totals &T = E->getValue();
+        J.object([&] {
+          J.attribute("pass", E->getKey());
+          J.attribute("count", int64_t(T.Count));
+          J.attribute("time_us", int64_t(toUs(T.Time)));
+          J.attribute("malloc_bytes", T.MallocBytes);
+          J.attribute("inst_delta", T.InstDelta);
+        });
+      }
+    });
+    J.attributeArray("runs", [&] {
+      for (const Run &R : SlowRuns)
+        J.object([&] {
+          J.attribute("pass", R.PassID);
+          J.attribute("ir", R.IRName);
+          J.attribute("time_us", int64_t(toUs(R.Time)));
+          J.attribute("malloc_bytes", R.MallocBytes);
+          J.attribute("inst_delta", R.InstDelta);
+        });
+    });
+  });
+  *OS << "\n";
+  OS->flush();
+
+  PassTotals.clear();
+  SlowRuns.clear();
+}
+
+void PassProfileInstrumentation::registerCallbacks(
+    PassInstrumentationCallbacks &PIC) {
+  if (!isEnabled())
+    return;
+
+  PIC.registerBeforePassCallback([this](StringRef P, Any IR) {
+    this->begin(P, IR);
+    return true;
+  });
+  PIC.registerAfterPassCallback(
+      [this](StringRef P, Any IR) { this->end(P, &IR); });
+  PIC.registerAfterPassInvalidatedCallback(
+      [this](StringRef P) { this->end(P, nullptr); });
+  PIC.registerBeforeAnalysisCallback(
+      [this](StringRef P, Any IR) { this->begin(P, IR); });
+  PIC.registerAfterAnalysisCallback(
+      [this](StringRef P, Any IR) { this->end(P, &IR); });
+}
+
 void StandardInstrumentations::registerCallbacks(
     PassInstrumentationCallbacks &PIC) {
   PrintIR.registerCallbacks(PIC);
   TimePasses.registerCallbacks(PIC);
+  PassProfile.registerCallbacks(PIC);
 }
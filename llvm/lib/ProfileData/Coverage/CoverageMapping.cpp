@@ -215,6 +215,17 @@ Error CoverageMapping::loadFunctionRecord(
   else
     OrigFuncName = getFuncNameWithoutPrefix(OrigFuncName, Record.Filenames[0]);
 
+  // Don't create records for (filenames, function) pairs we've already seen.
+  // Check before looking up the counters, the functions of a header or of a
+  // library linked into several of the binaries are loaded many times.
+  auto FilenamesHash = hash_combine_range(Record.Filenames.begin(),
+                                          Record.Filenames.end());
+  auto FuncNameHash = hash_value(OrigFuncName);
+  auto ProvenanceIt = RecordProvenance.find(FilenamesHash);
+  if (ProvenanceIt != RecordProvenance.end() &&
+      ProvenanceIt->second.count(FuncNameHash))
+    return Error::success();
+
   CounterMappingContext Ctx(Record.Expressions);
 
   std::vector<uint64_t> Counts;
@@ -251,12 +262,7 @@ Error CoverageMapping::loadFunctionRecord(
     Function.pushRegion(Region, *ExecutionCount);
   }
 
-  // Don't create records for (filenames, function) pairs we've already seen.
-  auto FilenamesHash = hash_combine_range(Record.Filenames.begin(),
-                                          Record.Filenames.end());
-  if (!RecordProvenance[FilenamesHash].insert(hash_value(OrigFuncName)).second)
-    return Error::success();
-
+  RecordProvenance[FilenamesHash].insert(FuncNameHash);
   Functions.push_back(std::move(Function));
 
   // Performance optimization: keep track of the indices of the function records
@@ -313,6 +319,10 @@ CoverageMapping::load(ArrayRef<StringRef> ObjectFilenames,
 
   SmallVector<std::unique_ptr<CoverageMappingReader>, 4> Readers;
   SmallVector<std::unique_ptr<MemoryBuffer>, 4> Buffers;
+  // The objects already loaded, by hash of their contents and architecture.
+  // Identical copies of a binary would only add records that are discarded
+  // as duplicates, don't decode their coverage mapping again.
+  DenseMap<size_t, SmallVector<std::pair<StringRef, StringRef>, 1>> Loaded;
   for (const auto &File : llvm::enumerate(ObjectFilenames)) {
     auto CovMappingBufOrErr = MemoryBuffer::getFileOrSTDIN(File.value());
     if (std::error_code EC = CovMappingBufOrErr.getError())
@@ -320,6 +330,10 @@ CoverageMapping::load(ArrayRef<StringRef> ObjectFilenames,
     StringRef Arch = Arches.empty() ? StringRef() : Arches[File.index()];
     MemoryBufferRef CovMappingBufRef =
         CovMappingBufOrErr.get()->getMemBufferRef();
+    StringRef Contents = CovMappingBufRef.getBuffer();
+    auto &Copies = Loaded[hash_combine(Contents, Arch)];
+    if (llvm::is_contained(Copies, std::make_pair(Contents, Arch)))
+      continue;
     auto CoverageReadersOrErr =
         BinaryCoverageReader::create(CovMappingBufRef, Arch, Buffers);
     if (Error E = CoverageReadersOrErr.takeError()) {
@@ -331,6 +345,7 @@ CoverageMapping::load(ArrayRef<StringRef> ObjectFilenames,
     }
     for (auto &Reader : CoverageReadersOrErr.get())
       Readers.push_back(std::move(Reader));
+    Copies.push_back(std::make_pair(Contents, Arch));
     Buffers.push_back(std::move(CovMappingBufOrErr.get()));
   }
   // If no readers were created, either no objects were provided or none of them
@@ -30,6 +30,8 @@ using namespace sampleprof;
 namespace llvm {
 namespace sampleprof {
 SampleProfileFormat FunctionSamples::Format;
+bool FunctionSamples::UseMD5 = false;
+bool FunctionSamples::ProfileIsCS = false;
 } // namespace sampleprof
 } // namespace llvm
 
@@ -223,6 +223,10 @@ std::error_code SampleProfileReaderText::read() {
       Profiles[FName] = FunctionSamples();
       FunctionSamples &FProfile = Profiles[FName];
       FProfile.setName(FName);
+      if (SampleContext::isContextString(FName)) {
+        FProfile.setContext(SampleContext(FName));
+        FunctionSamples::ProfileIsCS = true;
+      }
       MergeResult(Result, FProfile.addTotalSamples(NumSamples));
       MergeResult(Result, FProfile.addHeadSamples(NumHeadSamples));
       InlineStack.clear();
@@ -453,6 +457,10 @@ SampleProfileReaderBinary::readFuncProfile(const uint8_t *Start) {
   Profiles[*FName] = FunctionSamples();
   FunctionSamples &FProfile = Profiles[*FName];
   FProfile.setName(*FName);
+  if (SampleContext::isContextString(*FName)) {
+    FProfile.setContext(SampleContext(*FName));
+    FunctionSamples::ProfileIsCS = true;
+  }
 
   FProfile.addHeadSamples(*NumHeadSamples);
 
@@ -472,16 +480,20 @@ std::error_code SampleProfileReaderBinary::read() {
 
 std::error_code
 SampleProfileReaderExtBinary::readOneSection(const uint8_t *Start,
-                                             uint64_t Size, SecType Type) {
+                                             uint64_t Size,
+                                             const SecHdrTableEntry &Entry) {
   Data = Start;
   End = Start + Size;
-  switch (Type) {
+  switch (Entry.Type) {
   case SecProfSummary:
     if (std::error_code EC = readSummary())
       return EC;
     break;
   case SecNameTable:
-    if (std::error_code EC = readNameTable())
+    if (hasSecFlag(Entry, SecFlagMD5Name)) {
+      if (std::error_code EC = readMD5NameTable())
+        return EC;
+    } else if (std::error_code EC = readNameTable())
       return EC;
     break;
   case SecLBRProfile:
@@ -525,6 +537,8 @@ std::error_code SampleProfileReaderExtBinary::readFuncOffsetTable() {
       return EC;
 
     FuncOffsetTable[*FName] = *Offset;
+    if (SampleContext::isContextString(*FName))
+      FunctionSamples::ProfileIsCS = true;
   }
   return sampleprof_error::success;
 }
@@ -540,7 +554,31 @@ std::error_code SampleProfileReaderExtBinary::readFuncProfiles() {
     return sampleprof_error::success;
   }
 
+  if (FunctionSamples::ProfileIsCS) {
+    // A function of the module may use the profile of any of its contexts,
+    // so they are all read.
+    for (const auto &NameOffset : FuncOffsetTable) {
+      StringRef Name = NameOffset.first;
+      if (SampleContext::isContextString(Name))
+        Name = SampleContext(Name).getName();
+      if (!FuncsToUse.count(Name))
+        continue;
+      const uint8_t *FuncProfileAddr = Start + NameOffset.second;
+      assert(FuncProfileAddr < End && "out of LBRProfile section");
+      if (std::error_code EC = readFuncProfile(FuncProfileAddr))
+        return EC;
+    }
+    Data = End;
+    return sampleprof_error::success;
+  }
+
+  bool IsMD5 = useMD5();
   for (auto Name : FuncsToUse) {
+    std::string GUID;
+    if (IsMD5) {
+      GUID = std::to_string(MD5Hash(Name));
+      Name = GUID;
+    }
     auto iter = FuncOffsetTable.find(Name);
     if (iter == FuncOffsetTable.end())
       continue;
@@ -553,6 +591,25 @@ std::error_code SampleProfileReaderExtBinary::readFuncProfiles() {
   return sampleprof_error::success;
 }
 
+std::error_code SampleProfileReaderExtBinary::readMD5NameTable() {
+  auto Size = readNumber<uint64_t>();
+  if (std::error_code EC = Size.getError())
+    return EC;
+  // NameTable refers to the strings of MD5StringBuf, so it must not be
+  // reallocated while the table is read.
+  MD5StringBuf.clear();
+  MD5StringBuf.reserve(*Size);
+  NameTable.reserve(*Size);
+  for (uint32_t I = 0; I < *Size; ++I) {
+    auto FID = readNumber<uint64_t>();
+    if (std::error_code EC = FID.getError())
+      return EC;
+    MD5StringBuf.push_back(std::to_string(*FID));
+    NameTable.push_back(MD5StringBuf.back());
+  }
+  return sampleprof_error::success;
+}
+
 std::error_code SampleProfileReaderExtBinary::readProfileSymbolList() {
   if (!ProfSymList)
     ProfSymList = std::make_unique<ProfileSymbolList>();
@@ -620,7 +677,7 @@ std::error_code SampleProfileReaderExtBinaryBase::read() {
       SecSize = DecompressBufSize;
     }
 
-    if (std::error_code EC = readOneSection(SecStart, SecSize, Entry.Type))
+    if (std::error_code EC = readOneSection(SecStart, SecSize, Entry))
       return EC;
     if (Data != SecStart + SecSize)
       return sampleprof_error::malformed;
@@ -764,6 +821,14 @@ std::error_code SampleProfileReaderExtBinaryBase::readHeader() {
   return sampleprof_error::success;
 }
 
+bool SampleProfileReaderExtBinaryBase::useMD5() {
+  for (auto &Entry : SecHdrTable) {
+    if (Entry.Type == SecNameTable)
+      return hasSecFlag(Entry, SecFlagMD5Name);
+  }
+  return false;
+}
+
 uint64_t SampleProfileReaderExtBinaryBase::getSectionSize(SecType Type) {
   for (auto &Entry : SecHdrTable) {
     if (Entry.Type == Type)
@@ -1202,13 +1267,13 @@ bool SampleProfileReaderGCC::hasFormat(const MemoryBuffer &Buffer) {
 }
 
 std::error_code SampleProfileReaderItaniumRemapper::read() {
-  // If the underlying data is in compact format, we can't remap it because
+  // If the underlying data uses MD5 names, we can't remap it because
   // we don't know what the original function names were.
-  if (getFormat() == SPF_Compact_Binary) {
+  if (useMD5()) {
     Ctx.diagnose(DiagnosticInfoSampleProfile(
         Buffer->getBufferIdentifier(),
         "Profile data remapping cannot be applied to profile data "
-        "in compact format (original mangled names are not available).",
+        "using MD5 names (original mangled names are not available).",
         DS_Warning));
     return sampleprof_error::success;
   }
@@ -1312,9 +1377,11 @@ SampleProfileReader::create(std::unique_ptr<MemoryBuffer> &B, LLVMContext &C) {
     return sampleprof_error::unrecognized_format;
 
   FunctionSamples::Format = Reader->getFormat();
+  FunctionSamples::ProfileIsCS = false;
   if (std::error_code EC = Reader->readHeader()) {
     return EC;
   }
+  FunctionSamples::UseMD5 = Reader->useMD5();
 
   return std::move(Reader);
 }
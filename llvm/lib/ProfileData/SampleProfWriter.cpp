@@ -146,7 +146,7 @@ std::error_code SampleProfileWriterExtBinaryBase::write(
 std::error_code
 SampleProfileWriterExtBinary::writeSample(const FunctionSamples &S) {
   uint64_t Offset = OutputStream->tell();
-  StringRef Name = S.getName();
+  StringRef Name = S.getNameWithContext();
   FuncOffsetTable[Name] = Offset - SecLBRProfileStart;
   encodeULEB128(S.getHeadSamples(), *OutputStream);
   return writeBody(S);
@@ -230,7 +230,7 @@ std::error_code SampleProfileWriterCompactBinary::write(
 /// it needs to be parsed by the SampleProfileReaderText class.
 std::error_code SampleProfileWriterText::writeSample(const FunctionSamples &S) {
   auto &OS = *OutputStream;
-  OS << S.getName() << ":" << S.getTotalSamples();
+  OS << S.getNameWithContext() << ":" << S.getTotalSamples();
   if (Indent == 0)
     OS << ":" << S.getHeadSamples();
   OS << "\n";
@@ -361,6 +361,21 @@ std::error_code SampleProfileWriterCompactBinary::writeNameTable() {
   return sampleprof_error::success;
 }
 
+std::error_code SampleProfileWriterExtBinaryBase::writeNameTable() {
+  if (!UseMD5)
+    return SampleProfileWriterBinary::writeNameTable();
+
+  auto &OS = *OutputStream;
+  std::set<StringRef> V;
+  stablizeNameTable(V);
+
+  // Write out the name table.
+  encodeULEB128(NameTable.size(), OS);
+  for (auto N : V)
+    encodeULEB128(MD5Hash(N), OS);
+  return sampleprof_error::success;
+}
+
 std::error_code
 SampleProfileWriterBinary::writeMagicIdent(SampleProfileFormat Format) {
   auto &OS = *OutputStream;
@@ -397,6 +412,11 @@ void SampleProfileWriterExtBinaryBase::setToCompressSection(SecType Type) {
   addSectionFlags(Type, SecFlagCompress);
 }
 
+void SampleProfileWriterExtBinaryBase::setUseMD5() {
+  UseMD5 = true;
+  addSectionFlags(SecNameTable, SecFlagMD5Name);
+}
+
 void SampleProfileWriterExtBinaryBase::addSectionFlags(SecType Type,
                                                        SecFlags Flags) {
   for (auto &Entry : SectionHdrLayout) {
@@ -496,7 +516,7 @@ std::error_code SampleProfileWriterBinary::writeSummary() {
 std::error_code SampleProfileWriterBinary::writeBody(const FunctionSamples &S) {
   auto &OS = *OutputStream;
 
-  if (std::error_code EC = writeNameIdx(S.getName()))
+  if (std::error_code EC = writeNameIdx(S.getNameWithContext()))
     return EC;
 
   encodeULEB128(S.getTotalSamples(), OS);
@@ -549,7 +569,7 @@ SampleProfileWriterBinary::writeSample(const FunctionSamples &S) {
 std::error_code
 SampleProfileWriterCompactBinary::writeSample(const FunctionSamples &S) {
   uint64_t Offset = OutputStream->tell();
-  StringRef Name = S.getName();
+  StringRef Name = S.getNameWithContext();
   FuncOffsetTable[Name] = Offset;
   encodeULEB128(S.getHeadSamples(), *OutputStream);
   return writeBody(S);
@@ -11,7 +11,10 @@
 //===----------------------------------------------------------------------===//
 
 #include "llvm/Support/Allocator.h"
+#include "llvm/Support/Memory.h"
+#include "llvm/Support/ThreadLocalAllocator.h"
 #include "llvm/Support/raw_ostream.h"
+#include <atomic>
 
 namespace llvm {
 
@@ -26,8 +29,36 @@ void printBumpPtrAllocatorStats(unsigned NumSlabs, size_t BytesAllocated,
          << " (includes alignment, etc)\n";
 }
 
+LLVM_THREAD_LOCAL ThreadArenaCache CurrentThreadArena = {0, nullptr};
+
+uint64_t getNextThreadLocalAllocatorID() {
+  static std::atomic<uint64_t> NextID{1};
+  return NextID++;
+}
+
 } // End namespace detail.
 
+constexpr size_t HugePageSlabAllocator::HugePageSize;
+
+void *HugePageSlabAllocator::Allocate(size_t Size, size_t /*Alignment*/) {
+  // Round up here, so that Deallocate can compute the size of the mapping
+  // whether or not the system gave huge pages.
+  std::error_code EC;
+  sys::MemoryBlock MB = sys::Memory::allocateMappedMemory(
+      alignTo(Size, HugePageSize), nullptr,
+      sys::Memory::MF_READ | sys::Memory::MF_WRITE |
+          sys::Memory::MF_HUGE_HINT,
+      EC);
+  if (EC)
+    report_bad_alloc_error("Allocation failed");
+  return MB.base();
+}
+
+void HugePageSlabAllocator::Deallocate(const void *Ptr, size_t Size) {
+  sys::MemoryBlock MB(const_cast<void *>(Ptr), alignTo(Size, HugePageSize));
+  sys::Memory::releaseMappedMemory(MB);
+}
+
 void PrintRecyclerStats(size_t Size,
                         size_t Align,
                         size_t FreeListSize) {
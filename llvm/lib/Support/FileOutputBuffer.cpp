@@ -16,6 +16,7 @@
 #include "llvm/Support/Errc.h"
 #include "llvm/Support/Memory.h"
 #include "llvm/Support/Path.h"
+#include "llvm/Support/Process.h"
 #include <system_error>
 
 #if !defined(_MSC_VER) && !defined(__MINGW32__)
@@ -27,6 +28,26 @@
 using namespace llvm;
 using namespace llvm::sys;
 
+// Unmaps \p Buffer, resizes the file \p FD to \p NewSize bytes and maps it
+// again. The buffer is left unmapped if the new size is zero or on error.
+static Error remapFile(std::unique_ptr<fs::mapped_file_region> &Buffer, int FD,
+                       size_t NewSize) {
+  Buffer.reset();
+  if (auto EC = fs::resize_file(FD, NewSize))
+    return errorCodeToError(EC);
+  if (NewSize == 0)
+    return Error::success();
+
+  std::error_code EC;
+  auto MappedFile = std::make_unique<fs::mapped_file_region>(
+      fs::convertFDToNativeFile(FD), fs::mapped_file_region::readwrite,
+      NewSize, 0, EC);
+  if (EC)
+    return errorCodeToError(EC);
+  Buffer = std::move(MappedFile);
+  return Error::success();
+}
+
 namespace {
 // A FileOutputBuffer which creates a temporary file in the same directory
 // as the final output file. The final output file is atomically replaced
@@ -37,13 +58,19 @@ public:
                std::unique_ptr<fs::mapped_file_region> Buf)
       : FileOutputBuffer(Path), Buffer(std::move(Buf)), Temp(std::move(Temp)) {}
 
-  uint8_t *getBufferStart() const override { return (uint8_t *)Buffer->data(); }
+  uint8_t *getBufferStart() const override {
+    return Buffer ? (uint8_t *)Buffer->data() : nullptr;
+  }
 
   uint8_t *getBufferEnd() const override {
-    return (uint8_t *)Buffer->data() + Buffer->size();
+    return getBufferStart() + getBufferSize();
   }
 
-  size_t getBufferSize() const override { return Buffer->size(); }
+  size_t getBufferSize() const override { return Buffer ? Buffer->size() : 0; }
+
+  Error resize(size_t NewSize) override {
+    return remapFile(Buffer, Temp.FD, NewSize);
+  }
 
   Error commit() override {
     // Unmap buffer, letting OS flush dirty pages to file on disk.
@@ -71,6 +98,43 @@ private:
   fs::TempFile Temp;
 };
 
+// A FileOutputBuffer which maps an existing file and modifies it in place.
+class InPlaceBuffer : public FileOutputBuffer {
+public:
+  InPlaceBuffer(StringRef Path, int FD,
+                std::unique_ptr<fs::mapped_file_region> Buf)
+      : FileOutputBuffer(Path), Buffer(std::move(Buf)), FD(FD) {}
+
+  uint8_t *getBufferStart() const override {
+    return Buffer ? (uint8_t *)Buffer->data() : nullptr;
+  }
+
+  uint8_t *getBufferEnd() const override {
+    return getBufferStart() + getBufferSize();
+  }
+
+  size_t getBufferSize() const override { return Buffer ? Buffer->size() : 0; }
+
+  Error resize(size_t NewSize) override {
+    return remapFile(Buffer, FD, NewSize);
+  }
+
+  Error commit() override {
+    // Unmap buffer, letting OS flush dirty pages to file on disk.
+    Buffer.reset();
+    return Error::success();
+  }
+
+  ~InPlaceBuffer() override {
+    Buffer.reset();
+    sys::Process::SafelyCloseFileDescriptor(FD);
+  }
+
+private:
+  std::unique_ptr<fs::mapped_file_region> Buffer;
+  int FD;
+};
+
 // A FileOutputBuffer which keeps data in memory and writes to the final
 // output file on commit(). This is used only when we cannot use OnDiskBuffer.
 class InMemoryBuffer : public FileOutputBuffer {
@@ -88,6 +152,24 @@ public:
 
   size_t getBufferSize() const override { return BufferSize; }
 
+  Error resize(size_t NewSize) override {
+    if (NewSize > Buffer.allocatedSize()) {
+      std::error_code EC;
+      MemoryBlock MB = Memory::allocateMappedMemory(
+          NewSize, nullptr, sys::Memory::MF_READ | sys::Memory::MF_WRITE, EC);
+      if (EC)
+        return errorCodeToError(EC);
+      if (BufferSize)
+        memcpy(MB.base(), Buffer.base(), BufferSize);
+      Buffer = OwningMemoryBlock(MB);
+    } else if (NewSize > BufferSize) {
+      // Like a file, the grown part reads as zeros.
+      memset((uint8_t *)Buffer.base() + BufferSize, 0, NewSize - BufferSize);
+    }
+    BufferSize = NewSize;
+    return Error::success();
+  }
+
   Error commit() override {
     if (FinalPath == "-") {
       llvm::outs() << StringRef((const char *)Buffer.base(), BufferSize);
@@ -161,6 +243,39 @@ createOnDiskBuffer(StringRef Path, size_t Size, unsigned Mode) {
                                          std::move(MappedFile));
 }
 
+static Expected<std::unique_ptr<FileOutputBuffer>>
+createInPlaceBuffer(StringRef Path, size_t Size) {
+  int FD;
+  if (auto EC = fs::openFileForReadWrite(Path, FD, fs::CD_OpenExisting,
+                                         fs::OF_None))
+    return errorCodeToError(EC);
+
+  fs::file_status Stat;
+  if (auto EC = fs::status(FD, Stat)) {
+    sys::Process::SafelyCloseFileDescriptor(FD);
+    return errorCodeToError(EC);
+  }
+
+  if (Size == size_t(-1)) {
+    Size = Stat.getSize();
+  } else if (Size != Stat.getSize()) {
+    if (auto EC = fs::resize_file(FD, Size)) {
+      sys::Process::SafelyCloseFileDescriptor(FD);
+      return errorCodeToError(EC);
+    }
+  }
+
+  std::error_code EC;
+  auto MappedFile = std::make_unique<fs::mapped_file_region>(
+      fs::convertFDToNativeFile(FD), fs::mapped_file_region::readwrite, Size,
+      0, EC);
+  if (EC) {
+    sys::Process::SafelyCloseFileDescriptor(FD);
+    return errorCodeToError(EC);
+  }
+  return std::make_unique<InPlaceBuffer>(Path, FD, std::move(MappedFile));
+}
+
 // Create an instance of FileOutputBuffer.
 Expected<std::unique_ptr<FileOutputBuffer>>
 FileOutputBuffer::create(StringRef Path, size_t Size, unsigned Flags) {
@@ -175,6 +290,13 @@ FileOutputBuffer::create(StringRef Path, size_t Size, unsigned Flags) {
   fs::file_status Stat;
   fs::status(Path, Stat);
 
+  if (Flags & F_modify) {
+    if (Stat.type() == fs::file_type::regular_file)
+      return createInPlaceBuffer(Path, Size);
+    if (Size == size_t(-1))
+      return errorCodeToError(errc::no_such_file_or_directory);
+  }
+
   // Usually, we want to create OnDiskBuffer to create a temporary file in
   // the same directory as the destination file and atomically replaces it
   // by rename(2).
@@ -194,3 +316,64 @@ FileOutputBuffer::create(StringRef Path, size_t Size, unsigned Flags) {
     return createInMemoryBuffer(Path, Size, Mode);
   }
 }
+
+raw_mapped_ostream::raw_mapped_ostream(std::unique_ptr<FileOutputBuffer> Buffer)
+    : raw_pwrite_stream(/*Unbuffered=*/true), Buffer(std::move(Buffer)) {}
+
+Expected<std::unique_ptr<raw_mapped_ostream>>
+raw_mapped_ostream::create(StringRef Path, size_t InitialSize,
+                           unsigned Flags) {
+  Expected<std::unique_ptr<FileOutputBuffer>> BufferOrErr =
+      FileOutputBuffer::create(Path, std::max<size_t>(InitialSize, 1), Flags);
+  if (!BufferOrErr)
+    return BufferOrErr.takeError();
+  return std::make_unique<raw_mapped_ostream>(std::move(*BufferOrErr));
+}
+
+raw_mapped_ostream::~raw_mapped_ostream() {
+  consumeError(std::move(WriteError));
+}
+
+bool raw_mapped_ostream::reserve(size_t MinSize) {
+  if (WriteError || !Buffer)
+    return false;
+  size_t Size = Buffer->getBufferSize();
+  if (MinSize <= Size)
+    return true;
+  // Grow geometrically, so that writing N bytes resizes the buffer O(log N)
+  // times.
+  size_t NewSize = std::max<size_t>(Size, 4096);
+  while (NewSize < MinSize)
+    NewSize *= 2;
+  if (Error E = Buffer->resize(NewSize)) {
+    WriteError = std::move(E);
+    return false;
+  }
+  return true;
+}
+
+void raw_mapped_ostream::write_impl(const char *Ptr, size_t Size) {
+  if (!reserve(Pos + Size))
+    return;
+  memcpy(Buffer->getBufferStart() + Pos, Ptr, Size);
+  Pos += Size;
+}
+
+void raw_mapped_ostream::pwrite_impl(const char *Ptr, size_t Size,
+                                     uint64_t Offset) {
+  assert(Offset + Size <= Pos && "pwrite past the end of the stream");
+  if (WriteError || !Buffer)
+    return;
+  memcpy(Buffer->getBufferStart() + Offset, Ptr, Size);
+}
+
+Error raw_mapped_ostream::commit() {
+  assert(Buffer && "stream already committed");
+  std::unique_ptr<FileOutputBuffer> B = std::move(Buffer);
+  if (WriteError)
+    return std::move(WriteError);
+  if (Pos != B->getBufferSize())
+    if (Error E = B->resize(Pos))
+      return E;
+  return B->commit();
+}
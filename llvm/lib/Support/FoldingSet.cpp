@@ -12,7 +12,6 @@
 //===----------------------------------------------------------------------===//
 
 #include "llvm/ADT/FoldingSet.h"
-#include "llvm/ADT/Hashing.h"
 #include "llvm/Support/Allocator.h"
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/Host.h"
@@ -27,7 +26,10 @@ using namespace llvm;
 /// ComputeHash - Compute a strong hash value for this FoldingSetNodeIDRef,
 /// used to lookup the node in the FoldingSetBase.
 unsigned FoldingSetNodeIDRef::ComputeHash() const {
-  return static_cast<unsigned>(hash_combine_range(Data, Data+Size));
+  detail::FoldingSetHashState State;
+  for (const unsigned *I = Data, *E = Data + Size; I != E; ++I)
+    State.add(*I);
+  return State.get();
 }
 
 bool FoldingSetNodeIDRef::operator==(FoldingSetNodeIDRef RHS) const {
@@ -135,6 +137,30 @@ void FoldingSetNodeID::AddString(StringRef String) {
   Bits.push_back(V);
 }
 
+//===----------------------------------------------------------------------===//
+// FoldingSetNodeIDHasher Implementation
+
+void FoldingSetNodeIDHasher::AddString(StringRef String) {
+  // Hash the same words as FoldingSetNodeID::AddString adds.
+  unsigned Size = String.size();
+  AddInteger(Size);
+  unsigned Pos = 4;
+  for (; Pos <= Size; Pos += 4) {
+    unsigned V;
+    memcpy(&V, String.data() + Pos - 4, sizeof(V));
+    AddInteger(V);
+  }
+
+  unsigned V = 0;
+  switch (Pos - Size) {
+  case 1: V = (V << 8) | (unsigned char)String[Size - 3]; LLVM_FALLTHROUGH;
+  case 2: V = (V << 8) | (unsigned char)String[Size - 2]; LLVM_FALLTHROUGH;
+  case 3: V = (V << 8) | (unsigned char)String[Size - 1]; break;
+  default: return; // Nothing left.
+  }
+  AddInteger(V);
+}
+
 // AddNodeID - Adds the Bit data of another ID to *this.
 void FoldingSetNodeID::AddNodeID(const FoldingSetNodeID &ID) {
   Bits.append(ID.Bits.begin(), ID.Bits.end());
@@ -340,6 +366,26 @@ FoldingSetBase::FindNodeOrInsertPos(const FoldingSetNodeID &ID,
   return nullptr;
 }
 
+FoldingSetBase::Node *
+FoldingSetBase::FindNodeOrInsertPos(unsigned IDHash,
+                                    function_ref<bool(Node *)> Matches,
+                                    void *&InsertPos) {
+  void **Bucket = GetBucketFor(IDHash, Buckets, NumBuckets);
+  void *Probe = *Bucket;
+
+  InsertPos = nullptr;
+
+  while (Node *NodeInBucket = GetNextPtr(Probe)) {
+    if (Matches(NodeInBucket))
+      return NodeInBucket;
+    Probe = NodeInBucket->getNextInBucket();
+  }
+
+  // Didn't find the node, return null with the bucket as the InsertPos.
+  InsertPos = Bucket;
+  return nullptr;
+}
+
 /// InsertNode - Insert the specified node into the folding set, knowing that it
 /// is not already in the map.  InsertPos must be obtained from
 /// FindNodeOrInsertPos.
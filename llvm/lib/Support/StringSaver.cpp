@@ -7,6 +7,8 @@
 //===----------------------------------------------------------------------===//
 
 #include "llvm/Support/StringSaver.h"
+#include "llvm/Support/Compiler.h"
+#include <atomic>
 
 using namespace llvm;
 
@@ -24,3 +26,27 @@ StringRef UniqueStringSaver::save(StringRef S) {
     *R.first = Strings.save(S); // safe replacement with equal value
   return *R.first;
 }
+
+ConcurrentStringSaver::ConcurrentStringSaver(unsigned NumShards)
+    : Shards(new Shard[NumShards]), NumShards(NumShards) {}
+
+StringRef ConcurrentStringSaver::save(StringRef S) {
+  // Threads are given shards round-robin on their first save.
+  static std::atomic<unsigned> NextThreadIndex{0};
+  static LLVM_THREAD_LOCAL unsigned ThreadIndex = 0;
+  if (ThreadIndex == 0)
+    ThreadIndex = ++NextThreadIndex;
+
+  Shard &Sh = Shards[ThreadIndex % NumShards];
+  std::lock_guard<std::mutex> Lock(Sh.Mutex);
+  return StringSaver(Sh.Alloc).save(S);
+}
+
+size_t ConcurrentStringSaver::getTotalMemory() const {
+  size_t Total = 0;
+  for (unsigned I = 0; I != NumShards; ++I) {
+    std::lock_guard<std::mutex> Lock(Shards[I].Mutex);
+    Total += Shards[I].Alloc.getTotalMemory();
+  }
+  return Total;
+}
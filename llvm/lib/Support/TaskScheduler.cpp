@@ -0,0 +1,140 @@
+//===- llvm/Support/TaskScheduler.cpp - Work-stealing task scheduler ------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Support/TaskScheduler.h"
+#include "llvm/Support/Compiler.h"
+#include "llvm/Support/Threading.h"
+
+using namespace llvm;
+
+static std::atomic<unsigned> ThreadLimit{0};
+
+void llvm::setThreadLimit(unsigned ThreadCount) { ThreadLimit = ThreadCount; }
+
+unsigned llvm::getThreadLimit() {
+  if (unsigned Limit = ThreadLimit)
+    return Limit;
+  return hardware_concurrency();
+}
+
+#if LLVM_ENABLE_THREADS
+
+// The scheduler and the index of the worker running on this thread, if any.
+static LLVM_THREAD_LOCAL TaskScheduler *CurrentScheduler = nullptr;
+static LLVM_THREAD_LOCAL unsigned CurrentWorker = 0;
+
+TaskScheduler::TaskScheduler(unsigned ThreadCount) {
+  Workers.reserve(ThreadCount);
+  for (unsigned I = 0; I != ThreadCount; ++I)
+    Workers.push_back(std::make_unique<Worker>());
+  // The threads are started once all deques exist, as they steal from all.
+  for (unsigned I = 0; I != ThreadCount; ++I)
+    Workers[I]->Thread = llvm::thread([this, I] { work(I); });
+}
+
+TaskScheduler::~TaskScheduler() {
+  {
+    std::lock_guard<std::mutex> Lock(SleepMutex);
+    Stop = true;
+  }
+  SleepCondition.notify_all();
+  for (auto &W : Workers)
+    W->Thread.join();
+}
+
+TaskScheduler *TaskScheduler::getCurrent() { return CurrentScheduler; }
+
+TaskScheduler &TaskScheduler::getCurrentOrDefault() {
+  if (CurrentScheduler)
+    return *CurrentScheduler;
+  static TaskScheduler Default(getThreadLimit());
+  return Default;
+}
+
+void TaskScheduler::spawn(TaskTy Task) {
+  if (CurrentScheduler == this) {
+    Worker &W = *Workers[CurrentWorker];
+    std::lock_guard<std::mutex> Lock(W.Mutex);
+    W.Tasks.push_back(std::move(Task));
+  } else {
+    std::lock_guard<std::mutex> Lock(SharedMutex);
+    SharedTasks.push_back(std::move(Task));
+  }
+  ++NumQueued;
+  // An idle worker increments NumSleeping before checking NumQueued, so
+  // either it sees this task or it is counted here. Taking the lock makes
+  // sure that it is waiting, not between the check and the wait.
+  if (NumSleeping) {
+    { std::lock_guard<std::mutex> Lock(SleepMutex); }
+    SleepCondition.notify_one();
+  }
+}
+
+bool TaskScheduler::runOwnTask() {
+  if (CurrentScheduler != this)
+    return false;
+  TaskTy Task;
+  {
+    Worker &W = *Workers[CurrentWorker];
+    std::lock_guard<std::mutex> Lock(W.Mutex);
+    if (W.Tasks.empty())
+      return false;
+    Task = std::move(W.Tasks.back());
+    W.Tasks.pop_back();
+  }
+  --NumQueued;
+  Task();
+  return true;
+}
+
+bool TaskScheduler::takeTask(unsigned ThiefIndex, TaskTy &Task) {
+  {
+    std::lock_guard<std::mutex> Lock(SharedMutex);
+    if (!SharedTasks.empty()) {
+      Task = std::move(SharedTasks.front());
+      SharedTasks.pop_front();
+      --NumQueued;
+      return true;
+    }
+  }
+  // Steal the oldest task of the next workers, which is likely to be the
+  // largest: it was spawned first by a recursive algorithm.
+  for (unsigned I = 1, E = Workers.size(); I < E; ++I) {
+    Worker &Victim = *Workers[(ThiefIndex + I) % E];
+    std::lock_guard<std::mutex> Lock(Victim.Mutex);
+    if (!Victim.Tasks.empty()) {
+      Task = std::move(Victim.Tasks.front());
+      Victim.Tasks.pop_front();
+      --NumQueued;
+      return true;
+    }
+  }
+  return false;
+}
+
+void TaskScheduler::work(unsigned Index) {
+  CurrentScheduler = this;
+  CurrentWorker = Index;
+  while (true) {
+    if (runOwnTask())
+      continue;
+    TaskTy Task;
+    if (takeTask(Index, Task)) {
+      Task();
+      continue;
+    }
+    std::unique_lock<std::mutex> Lock(SleepMutex);
+    ++NumSleeping;
+    SleepCondition.wait(Lock, [&] { return Stop || NumQueued; });
+    --NumSleeping;
+    if (Stop)
+      return;
+  }
+}
+
+#endif // LLVM_ENABLE_THREADS
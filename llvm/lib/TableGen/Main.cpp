@@ -26,6 +26,7 @@
 #include <algorithm>
 #include <cstdio>
 #include <system_error>
+#include <vector>
 using namespace llvm;
 
 static cl::opt<std::string>
@@ -62,7 +63,8 @@ static int reportError(const char *ProgName, Twine Msg) {
 ///
 /// This functionality is really only for the benefit of the build system.
 /// It is similar to GCC's `-M*` family of options.
-static int createDependencyFile(const TGParser &Parser, const char *argv0) {
+static int createDependencyFile(const TGParser &Parser, const char *argv0,
+                                ArrayRef<TableGenExtraOutput> ExtraOutputs) {
   if (OutputFilename == "-")
     return reportError(argv0, "the option -d must be used together with -o\n");
 
@@ -71,7 +73,10 @@ static int createDependencyFile(const TGParser &Parser, const char *argv0) {
   if (EC)
     return reportError(argv0, "error opening " + DependFilename + ":" +
                                   EC.message() + "\n");
-  DepOut.os() << OutputFilename << ":";
+  DepOut.os() << OutputFilename;
+  for (const TableGenExtraOutput &Extra : ExtraOutputs)
+    DepOut.os() << ' ' << Extra.Filename;
+  DepOut.os() << ":";
   for (const auto &Dep : Parser.getDependencies()) {
     DepOut.os() << ' ' << Dep.first;
   }
@@ -80,7 +85,35 @@ static int createDependencyFile(const TGParser &Parser, const char *argv0) {
   return 0;
 }
 
-int llvm::TableGenMain(char *argv0, TableGenMainFn *MainFn) {
+/// Write Contents to Filename, honoring -write-if-changed.
+static int writeOutput(const char *argv0, StringRef Filename,
+                       StringRef Contents) {
+  if (WriteIfChanged) {
+    // Only updates the real output file if there are any differences.
+    // This prevents recompilation of all the files depending on it if there
+    // aren't any.
+    if (auto ExistingOrErr = MemoryBuffer::getFile(Filename))
+      if (std::move(ExistingOrErr.get())->getBuffer() == Contents)
+        return 0;
+  }
+
+  std::error_code EC;
+  ToolOutputFile OutFile(Filename, EC, sys::fs::OF_None);
+  if (EC)
+    return reportError(argv0, "error opening " + Filename + ":" +
+                                  EC.message() + "\n");
+  OutFile.os() << Contents;
+
+  if (ErrorsPrinted > 0)
+    return reportError(argv0, Twine(ErrorsPrinted) + " errors.\n");
+
+  // Declare success.
+  OutFile.keep();
+  return 0;
+}
+
+int llvm::TableGenMain(char *argv0, TableGenMainFn *MainFn,
+                       ArrayRef<TableGenExtraOutput> ExtraOutputs) {
   RecordKeeper Records;
 
   // Parse the input file.
@@ -108,35 +141,27 @@ int llvm::TableGenMain(char *argv0, TableGenMainFn *MainFn) {
   if (MainFn(Out, Records))
     return 1;
 
+  std::vector<std::string> ExtraOutStrings(ExtraOutputs.size());
+  for (size_t I = 0, E = ExtraOutputs.size(); I != E; ++I) {
+    raw_string_ostream ExtraOut(ExtraOutStrings[I]);
+    if (ExtraOutputs[I].Fn(ExtraOut, Records))
+      return 1;
+    ExtraOut.flush();
+  }
+
   // Always write the depfile, even if the main output hasn't changed.
   // If it's missing, Ninja considers the output dirty.  If this was below
   // the early exit below and someone deleted the .inc.d file but not the .inc
   // file, tablegen would never write the depfile.
   if (!DependFilename.empty()) {
-    if (int Ret = createDependencyFile(Parser, argv0))
+    if (int Ret = createDependencyFile(Parser, argv0, ExtraOutputs))
       return Ret;
   }
 
-  if (WriteIfChanged) {
-    // Only updates the real output file if there are any differences.
-    // This prevents recompilation of all the files depending on it if there
-    // aren't any.
-    if (auto ExistingOrErr = MemoryBuffer::getFile(OutputFilename))
-      if (std::move(ExistingOrErr.get())->getBuffer() == Out.str())
-        return 0;
-  }
-
-  std::error_code EC;
-  ToolOutputFile OutFile(OutputFilename, EC, sys::fs::OF_None);
-  if (EC)
-    return reportError(argv0, "error opening " + OutputFilename + ":" +
-                                  EC.message() + "\n");
-  OutFile.os() << Out.str();
-
-  if (ErrorsPrinted > 0)
-    return reportError(argv0, Twine(ErrorsPrinted) + " errors.\n");
+  for (size_t I = 0, E = ExtraOutputs.size(); I != E; ++I)
+    if (int Ret = writeOutput(argv0, ExtraOutputs[I].Filename,
+                              ExtraOutStrings[I]))
+      return Ret;
 
-  // Declare success.
-  OutFile.keep();
-  return 0;
+  return writeOutput(argv0, OutputFilename, Out.str());
 }
@@ -16,10 +16,12 @@
 #include "llvm/Transforms/IPO/Attributor.h"
 
 #include "llvm/ADT/DepthFirstIterator.h"
+#include "llvm/ADT/SCCIterator.h"
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/Statistic.h"
+#include "llvm/Analysis/CallGraph.h"
 #include "llvm/Analysis/CaptureTracking.h"
 #include "llvm/Analysis/EHPersonalities.h"
 #include "llvm/Analysis/GlobalsModRef.h"
@@ -53,6 +55,8 @@ STATISTIC(NumAttributesValidFixpoint,
           "Number of abstract attributes in a valid fixpoint state");
 STATISTIC(NumAttributesManifested,
           "Number of abstract attributes manifested in IR");
+STATISTIC(NumAttributeUpdates, "Number of abstract attribute updates");
+STATISTIC(NumFixpointIterations, "Number of fixpoint iterations");
 
 // Some helper macros to deal with statistics tracking.
 //
@@ -110,6 +114,11 @@ static cl::opt<unsigned>
     MaxFixpointIterations("attributor-max-iterations", cl::Hidden,
                           cl::desc("Maximal number of fixpoint iterations."),
                           cl::init(32));
+static cl::opt<unsigned> MaxUpdates(
+    "attributor-max-updates", cl::Hidden,
+    cl::desc("Maximal number of abstract attribute updates in all fixpoint "
+             "iterations (0 = unlimited)."),
+    cl::init(0));
 static cl::opt<bool> VerifyMaxFixpointIterations(
     "attributor-max-iterations-verify", cl::Hidden,
     cl::desc("Verify that max-iterations is a tight bound for a fixpoint"),
@@ -4408,6 +4417,8 @@ ChangeStatus Attributor::run(Module &M) {
   // the abstract analysis.
 
   unsigned IterationCounter = 1;
+  unsigned UpdateCounter = 0;
+  bool UpdateBudgetExhausted = false;
 
   SmallVector<AbstractAttribute *, 64> ChangedAAs;
   SetVector<AbstractAttribute *> Worklist;
@@ -4447,11 +4458,20 @@ ChangeStatus Attributor::run(Module &M) {
     ChangedAAs.clear();
 
     // Update all abstract attribute in the work list and record the ones that
-    // changed.
-    for (AbstractAttribute *AA : Worklist)
-      if (!isAssumedDead(*AA, nullptr))
+    // changed. Once the update budget is exhausted, the remaining ones might
+    // not be in a fixpoint anymore, so they are treated as changed.
+    for (AbstractAttribute *AA : Worklist) {
+      if (UpdateBudgetExhausted) {
+        ChangedAAs.push_back(AA);
+        continue;
+      }
+      if (!isAssumedDead(*AA, nullptr)) {
+        NumAttributeUpdates++;
         if (AA->update(*this) == ChangeStatus::CHANGED)
           ChangedAAs.push_back(AA);
+      }
+      UpdateBudgetExhausted = MaxUpdates && ++UpdateCounter >= MaxUpdates;
+    }
 
     // Check if we recompute the dependences in the next iteration.
     RecomputeDependences = (DepRecomputeInterval > 0 &&
@@ -4467,12 +4487,16 @@ ChangeStatus Attributor::run(Module &M) {
     Worklist.clear();
     Worklist.insert(ChangedAAs.begin(), ChangedAAs.end());
 
-  } while (!Worklist.empty() && (IterationCounter++ < MaxFixpointIterations ||
-                                 VerifyMaxFixpointIterations));
+  } while (!Worklist.empty() && !UpdateBudgetExhausted &&
+           (IterationCounter++ < MaxFixpointIterations ||
+            VerifyMaxFixpointIterations));
 
+  NumFixpointIterations += IterationCounter;
   LLVM_DEBUG(dbgs() << "\n[Attributor] Fixpoint iteration done after: "
                     << IterationCounter << "/" << MaxFixpointIterations
-                    << " iterations\n");
+                    << " iterations and " << UpdateCounter << " updates"
+                    << (UpdateBudgetExhausted ? " (budget exhausted)" : "")
+                    << "\n");
 
   size_t NumFinalAAs = AllAbstractAttributes.size();
 
@@ -4885,7 +4909,24 @@ static bool runAttributorOnModule(Module &M, AnalysisGetter &AG) {
   for (Function &F : M)
     A.initializeInformationCache(F);
 
-  for (Function &F : M) {
+  // Seed the abstract attributes bottom-up on the call graph, callees before
+  // their callers. The initial updates of a caller then already see the
+  // updated state of its callees, which saves fixpoint iterations. Functions
+  // not reachable in the call graph follow in module order.
+  SetVector<Function *> Functions;
+  {
+    CallGraph CG(M);
+    for (scc_iterator<CallGraph *> SCCI = scc_begin(&CG); !SCCI.isAtEnd();
+         ++SCCI)
+      for (CallGraphNode *Node : *SCCI)
+        if (Function *F = Node->getFunction())
+          Functions.insert(F);
+  }
+  for (Function &F : M)
+    Functions.insert(&F);
+
+  for (Function *FPtr : Functions) {
+    Function &F = *FPtr;
     if (F.hasExactDefinition())
       NumFnWithExactDefinition++;
     else
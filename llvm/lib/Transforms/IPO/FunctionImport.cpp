@@ -41,6 +41,7 @@
 #include "llvm/Support/Error.h"
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Parallel.h"
 #include "llvm/Support/SourceMgr.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Transforms/IPO/Internalize.h"
@@ -65,6 +66,8 @@ STATISTIC(NumImportedHotFunctionsThinLink,
           "Number of hot functions thin link decided to import");
 STATISTIC(NumImportedCriticalFunctionsThinLink,
           "Number of critical functions thin link decided to import");
+STATISTIC(NumImportedICallTargetsThinLink,
+          "Number of indirect call targets thin link decided to import");
 STATISTIC(NumImportedGlobalVarsThinLink,
           "Number of global variables thin link decided to import");
 STATISTIC(NumImportedFunctions, "Number of functions imported in backend");
@@ -108,6 +111,13 @@ static cl::opt<float> ImportCriticalMultiplier(
         "Multiply the `import-instr-limit` threshold for critical callsites"));
 
 // FIXME: This multiplier was not really tuned up.
+static cl::opt<float> ImportICallTargetMultiplier(
+    "import-icall-target-multiplier", cl::init(2.0), cl::Hidden,
+    cl::value_desc("x"),
+    cl::desc("Multiply the `import-instr-limit` threshold for the targets of "
+             "indirect calls found in value profiles, which can only be "
+             "promoted to direct calls when imported"));
+
 static cl::opt<float> ImportColdMultiplier(
     "import-cold-multiplier", cl::init(0), cl::Hidden, cl::value_desc("N"),
     cl::desc("Multiply the `import-instr-limit` threshold for cold callsites"));
@@ -353,6 +363,8 @@ static void computeImportForFunction(
     FunctionImporter::ImportThresholdsTy &ImportThresholds) {
   computeImportForReferencedGlobals(Summary, DefinedGVSummaries, ImportList,
                                     ExportLists);
+  // Shared by all modules. It is only updated when there is a cutoff, in which
+  // case ComputeCrossModuleImport processes the modules one at a time.
   static int ImportCount = 0;
   for (auto &Edge : Summary.calls()) {
     ValueInfo VI = Edge.first;
@@ -384,8 +396,11 @@ static void computeImportForFunction(
       return 1.0;
     };
 
+    // The target of an indirect call is both promoted and inlined when it is
+    // imported, and neither when it is not.
     const auto NewThreshold =
-        Threshold * GetBonusMultiplier(Edge.second.getHotness());
+        Threshold * GetBonusMultiplier(Edge.second.getHotness()) *
+        (Edge.second.isICallTarget() ? ImportICallTargetMultiplier : 1.0);
 
     auto IT = ImportThresholds.insert(std::make_pair(
         VI.getGUID(), std::make_tuple(NewThreshold, nullptr, nullptr)));
@@ -476,6 +491,8 @@ static void computeImportForFunction(
           NumImportedHotFunctionsThinLink++;
         if (IsCriticalCallsite)
           NumImportedCriticalFunctionsThinLink++;
+        if (Edge.second.isICallTarget())
+          NumImportedICallTargetsThinLink++;
       }
 
       // Make exports in the source module.
@@ -512,7 +529,8 @@ static void computeImportForFunction(
 
     const auto AdjThreshold = GetAdjustedThreshold(Threshold, IsHotCallsite);
 
-    ImportCount++;
+    if (ImportCutoff >= 0)
+      ImportCount++;
 
     // Insert the newly imported function to the worklist.
     Worklist.emplace_back(ResolvedCalleeSummary, AdjThreshold, VI.getGUID());
@@ -621,13 +639,51 @@ void llvm::ComputeCrossModuleImport(
     StringMap<FunctionImporter::ImportMapTy> &ImportLists,
     StringMap<FunctionImporter::ExportSetTy> &ExportLists) {
   // For each module that has function defined, compute the import/export lists.
+  // The modules only read the index, so they are processed in parallel. Each
+  // module collects the exports it causes in a map of its own, and these are
+  // merged in module order afterwards so that the export lists do not depend
+  // on the scheduling. Debugging output and the global import cutoff need the
+  // modules to be processed one at a time.
+  std::vector<const StringMapEntry<GVSummaryMapTy> *> Modules;
+  std::vector<FunctionImporter::ImportMapTy *> ModuleImportLists;
   for (auto &DefinedGVSummaries : ModuleToDefinedGVSummaries) {
-    auto &ImportList = ImportLists[DefinedGVSummaries.first()];
+    Modules.push_back(&DefinedGVSummaries);
+    ModuleImportLists.push_back(&ImportLists[DefinedGVSummaries.first()]);
+  }
+  std::vector<StringMap<FunctionImporter::ExportSetTy>> ModuleExportLists(
+      Modules.size());
+
+  auto ComputeForModule = [&](size_t I) {
+    const StringMapEntry<GVSummaryMapTy> &DefinedGVSummaries = *Modules[I];
     LLVM_DEBUG(dbgs() << "Computing import for Module '"
                       << DefinedGVSummaries.first() << "'\n");
     ComputeImportForModule(DefinedGVSummaries.second, Index,
-                           DefinedGVSummaries.first(), ImportList,
-                           &ExportLists);
+                           DefinedGVSummaries.first(), *ModuleImportLists[I],
+                           &ModuleExportLists[I]);
+  };
+
+  bool Serial = ImportCutoff >= 0 || PrintImportFailures;
+#ifndef NDEBUG
+  Serial |= DebugFlag;
+#endif
+  if (Serial) {
+    for (size_t I = 0, E = Modules.size(); I != E; ++I)
+      ComputeForModule(I);
+  } else {
+    parallel::for_each_n(parallel::par, size_t(0), Modules.size(),
+                         ComputeForModule);
+  }
+
+  for (StringMap<FunctionImporter::ExportSetTy> &Exports : ModuleExportLists) {
+    for (auto &ELI : Exports) {
+      auto &ExportList = ExportLists[ELI.first()];
+      if (ExportList.empty())
+        ExportList = std::move(ELI.second);
+      else
+        ExportList.insert(ELI.second.begin(), ELI.second.end());
+    }
+    // Release the memory as we go, as there can be one map per module.
+    Exports = StringMap<FunctionImporter::ExportSetTy>();
   }
 
   // When computing imports we added all GUIDs referenced by anything
@@ -635,16 +691,19 @@ void llvm::ComputeCrossModuleImport(
   // of any not defined in that module. This is more efficient than checking
   // while computing imports because some of the summary lists may be long
   // due to linkonce (comdat) copies.
-  for (auto &ELI : ExportLists) {
-    const auto &DefinedGVSummaries =
-        ModuleToDefinedGVSummaries.lookup(ELI.first());
-    for (auto EI = ELI.second.begin(); EI != ELI.second.end();) {
-      if (!DefinedGVSummaries.count(*EI))
-        EI = ELI.second.erase(EI);
+  std::vector<StringMapEntry<FunctionImporter::ExportSetTy> *> ExportEntries;
+  for (auto &ELI : ExportLists)
+    ExportEntries.push_back(&ELI);
+  parallel::for_each(parallel::par, ExportEntries.begin(), ExportEntries.end(),
+                     [&](StringMapEntry<FunctionImporter::ExportSetTy> *ELI) {
+    auto It = ModuleToDefinedGVSummaries.find(ELI->first());
+    for (auto EI = ELI->second.begin(); EI != ELI->second.end();) {
+      if (It == ModuleToDefinedGVSummaries.end() || !It->second.count(*EI))
+        EI = ELI->second.erase(EI);
       else
         ++EI;
     }
-  }
+  });
 
 #ifndef NDEBUG
   LLVM_DEBUG(dbgs() << "Import/Export lists for " << ImportLists.size()
@@ -1098,9 +1157,30 @@ Expected<bool> FunctionImporter::importFunctions(
       return std::move(Err);
 
     auto &ImportGUIDs = FunctionsToImportPerModule->second;
+
+    // Count the globals of each kind to import, so that the scans below can
+    // stop once they have found all of them. Source modules are often large
+    // and only a few of their globals are imported, so this avoids computing
+    // the GUIDs of most of their globals.
+    unsigned NumFunctionsLeft = 0, NumVarsLeft = 0, NumAliasesLeft = 0;
+    bool CanStopEarly = true;
+    for (auto GUID : ImportGUIDs) {
+      GlobalValueSummary *S = Index.findSummaryInModule(GUID, Name);
+      if (!S)
+        CanStopEarly = false;
+      else if (isa<FunctionSummary>(S))
+        ++NumFunctionsLeft;
+      else if (isa<GlobalVarSummary>(S))
+        ++NumVarsLeft;
+      else
+        ++NumAliasesLeft;
+    }
+
     // Find the globals to import
     SetVector<GlobalValue *> GlobalsToImport;
     for (Function &F : *SrcModule) {
+      if (CanStopEarly && !NumFunctionsLeft)
+        break;
       if (!F.hasName())
         continue;
       auto GUID = F.getGUID();
@@ -1109,6 +1189,8 @@ Expected<bool> FunctionImporter::importFunctions(
                         << GUID << " " << F.getName() << " from "
                         << SrcModule->getSourceFileName() << "\n");
       if (Import) {
+        if (NumFunctionsLeft)
+          --NumFunctionsLeft;
         if (Error Err = F.materialize())
           return std::move(Err);
         if (EnableImportMetadata) {
@@ -1123,6 +1205,8 @@ Expected<bool> FunctionImporter::importFunctions(
       }
     }
     for (GlobalVariable &GV : SrcModule->globals()) {
+      if (CanStopEarly && !NumVarsLeft)
+        break;
       if (!GV.hasName())
         continue;
       auto GUID = GV.getGUID();
@@ -1131,12 +1215,16 @@ Expected<bool> FunctionImporter::importFunctions(
                         << GUID << " " << GV.getName() << " from "
                         << SrcModule->getSourceFileName() << "\n");
       if (Import) {
+        if (NumVarsLeft)
+          --NumVarsLeft;
         if (Error Err = GV.materialize())
           return std::move(Err);
         ImportedGVCount += GlobalsToImport.insert(&GV);
       }
     }
     for (GlobalAlias &GA : SrcModule->aliases()) {
+      if (CanStopEarly && !NumAliasesLeft)
+        break;
       if (!GA.hasName())
         continue;
       auto GUID = GA.getGUID();
@@ -1145,6 +1233,8 @@ Expected<bool> FunctionImporter::importFunctions(
                         << GUID << " " << GA.getName() << " from "
                         << SrcModule->getSourceFileName() << "\n");
       if (Import) {
+        if (NumAliasesLeft)
+          --NumAliasesLeft;
         if (Error Err = GA.materialize())
           return std::move(Err);
         // Import alias as a copy of its aliasee.
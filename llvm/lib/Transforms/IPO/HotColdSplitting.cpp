@@ -84,6 +84,11 @@ static cl::opt<int>
                        cl::desc("Base penalty for splitting cold code (as a "
                                 "multiple of TCC_Basic)"));
 
+static cl::opt<std::string> ColdSectionPrefix(
+    "hotcoldsplit-section-prefix", cl::init(".unlikely"), cl::Hidden,
+    cl::desc("Section prefix of the split cold functions, which places them "
+             "in .text<prefix> (empty to keep them in .text)"));
+
 namespace {
 // Same as blockEndsInUnreachable in CodeGen/BranchFolding.cpp. Do not modify
 // this function unless you modify the MBB version as well.
@@ -328,6 +333,14 @@ Function *HotColdSplitting::extractColdRegion(
 
     markFunctionCold(*OutF, BFI != nullptr);
 
+    // Keep the cold code in the explicit section of its original function if
+    // there is one. Otherwise place it with the other unlikely executed code,
+    // away from the hot code.
+    if (OrigF->hasSection())
+      OutF->setSection(OrigF->getSection());
+    else if (!ColdSectionPrefix.empty())
+      OutF->setSectionPrefix(ColdSectionPrefix);
+
     LLVM_DEBUG(llvm::dbgs() << "Outlined Region: " << *OutF);
     ORE.emit([&]() {
       return OptimizationRemark(DEBUG_TYPE, "HotColdSplit",
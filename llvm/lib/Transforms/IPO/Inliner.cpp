@@ -76,6 +76,8 @@ STATISTIC(NumInlined, "Number of functions inlined");
 STATISTIC(NumCallsDeleted, "Number of call sites deleted, not inlined");
 STATISTIC(NumDeleted, "Number of functions deleted because all callers found");
 STATISTIC(NumMergedAllocas, "Number of allocas merged together");
+STATISTIC(NumOverBudget,
+          "Number of call sites not inlined because of the size budget");
 
 // This weirdly named statistic tracks the number of times that, when attempting
 // to inline a function A into B, we analyze the callers of B in order to see
@@ -120,6 +122,14 @@ static cl::opt<bool>
                                    " callsites processed by inliner but decided"
                                    " to be not inlined"));
 
+/// Module-level size budget of the new pass manager inliner.
+static cl::opt<unsigned> InlineSizeBudget(
+    "inline-size-budget", cl::init(0), cl::Hidden,
+    cl::desc("Limit the growth of the module through inlining of call sites "
+             "that are not hot to this percentage of its initial size, and "
+             "inline the calls of each function in the order of their "
+             "profile weighted benefit per instruction (0 = no budget)"));
+
 LegacyInlinerBase::LegacyInlinerBase(char &ID) : CallGraphSCCPass(ID) {}
 
 LegacyInlinerBase::LegacyInlinerBase(char &ID, bool InsertLifetime)
@@ -434,7 +444,7 @@ shouldInline(CallSite CS, function_ref<InlineCost(CallSite CS)> GetInlineCost,
   if (IC.isNever()) {
     LLVM_DEBUG(dbgs() << "    NOT Inlining " << inlineCostStr(IC)
                       << ", Call: " << *CS.getInstruction() << "\n");
-    ORE.emit([&]() {
+    ORE.emit(DEBUG_TYPE, [&]() {
       return OptimizationRemarkMissed(DEBUG_TYPE, "NeverInline", Call)
              << NV("Callee", Callee) << " not inlined into "
              << NV("Caller", Caller) << " because it should never be inlined "
@@ -446,7 +456,7 @@ shouldInline(CallSite CS, function_ref<InlineCost(CallSite CS)> GetInlineCost,
   if (!IC) {
     LLVM_DEBUG(dbgs() << "    NOT Inlining " << inlineCostStr(IC)
                       << ", Call: " << *CS.getInstruction() << "\n");
-    ORE.emit([&]() {
+    ORE.emit(DEBUG_TYPE, [&]() {
       return OptimizationRemarkMissed(DEBUG_TYPE, "TooCostly", Call)
              << NV("Callee", Callee) << " not inlined into "
              << NV("Caller", Caller) << " because too costly to inline " << IC;
@@ -459,7 +469,7 @@ shouldInline(CallSite CS, function_ref<InlineCost(CallSite CS)> GetInlineCost,
     LLVM_DEBUG(dbgs() << "    NOT Inlining: " << *CS.getInstruction()
                       << " Cost = " << IC.getCost()
                       << ", outer Cost = " << TotalSecondaryCost << '\n');
-    ORE.emit([&]() {
+    ORE.emit(DEBUG_TYPE, [&]() {
       return OptimizationRemarkMissed(DEBUG_TYPE, "IncreaseCostInOtherContexts",
                                       Call)
              << "Not inlining. Cost of inlining " << NV("Callee", Callee)
@@ -507,7 +517,7 @@ bool LegacyInlinerBase::runOnSCC(CallGraphSCC &SCC) {
 static void emit_inlined_into(OptimizationRemarkEmitter &ORE, DebugLoc &DLoc,
                               const BasicBlock *Block, const Function &Callee,
                               const Function &Caller, const InlineCost &IC) {
-  ORE.emit([&]() {
+  ORE.emit(DEBUG_TYPE, [&]() {
     bool AlwaysInline = IC.isAlways();
     StringRef RemarkName = AlwaysInline ? "AlwaysInline" : "Inlined";
     return OptimizationRemark(DEBUG_TYPE, RemarkName, DLoc, Block)
@@ -575,7 +585,7 @@ inlineCallsImpl(CallGraphSCC &SCC, CallGraph &CG,
             using namespace ore;
 
             setInlineRemark(CS, "unavailable definition");
-            ORE.emit([&]() {
+            ORE.emit(DEBUG_TYPE, [&]() {
               return OptimizationRemarkMissed(DEBUG_TYPE, "NoDefinition", &I)
                      << NV("Callee", Callee) << " will not be inlined into "
                      << NV("Caller", CS.getCaller())
@@ -689,7 +699,7 @@ inlineCallsImpl(CallGraphSCC &SCC, CallGraph &CG,
             InsertLifetime, AARGetter, ImportedFunctionsStats);
         if (!IR) {
           setInlineRemark(CS, std::string(IR) + "; " + inlineCostStr(*OIC));
-          ORE.emit([&]() {
+          ORE.emit(DEBUG_TYPE, [&]() {
             return OptimizationRemarkMissed(DEBUG_TYPE, "NotInlined", DLoc,
                                             Block)
                    << NV("Callee", Callee) << " will not be inlined into "
@@ -862,6 +872,53 @@ bool LegacyInlinerBase::removeDeadFunctions(CallGraph &CG,
   return true;
 }
 
+/// Returns the number of instructions inlining \p Callee adds to the module. A
+/// local callee with a single use is removed after it is inlined.
+static uint64_t getInlineSizeGrowth(Function &Callee) {
+  if (Callee.hasLocalLinkage() && Callee.hasOneUse())
+    return 0;
+  return Callee.getInstructionCount();
+}
+
+/// Orders the calls of each caller in \p Calls by decreasing benefit per
+/// instruction, so that a size budget is spent on the call sites executed most
+/// often relative to the size of their callee first. The callers keep their
+/// order. As the benefit is only compared between the calls of one caller,
+/// the block frequencies of the caller stand in for its profile counts.
+static void
+sortCallsByBenefit(SmallVectorImpl<std::pair<CallSite, int>> &Calls,
+                   FunctionAnalysisManager &FAM) {
+  using CallTy = std::pair<CallSite, int>;
+  DenseMap<Function *, uint64_t> CalleeSizes;
+  for (auto Begin = Calls.begin(), End = Begin; Begin != Calls.end();
+       Begin = End) {
+    Function *Caller = Begin->first.getCaller();
+    End = std::find_if(Begin, Calls.end(), [&](const CallTy &Call) {
+      return Call.first.getCaller() != Caller;
+    });
+    if (std::next(Begin) == End)
+      continue;
+
+    BlockFrequencyInfo &BFI = FAM.getResult<BlockFrequencyAnalysis>(*Caller);
+    DenseMap<Instruction *, std::pair<uint64_t, uint64_t>> Weights;
+    for (const CallTy &Call : make_range(Begin, End)) {
+      Function *Callee = Call.first.getCalledFunction();
+      auto It = CalleeSizes.try_emplace(Callee, 0);
+      if (It.second)
+        It.first->second = std::max<uint64_t>(Callee->getInstructionCount(), 1);
+      Weights[Call.first.getInstruction()] = {
+          BFI.getBlockFreq(Call.first.getParent()).getFrequency(),
+          It.first->second};
+    }
+    std::stable_sort(Begin, End, [&](const CallTy &A, const CallTy &B) {
+      auto WA = Weights.lookup(A.first.getInstruction());
+      auto WB = Weights.lookup(B.first.getInstruction());
+      return SaturatingMultiply(WA.first, WB.second) >
+             SaturatingMultiply(WB.first, WA.second);
+    });
+  }
+}
+
 InlinerPass::~InlinerPass() {
   if (ImportedFunctionsStats) {
     assert(InlinerFunctionImportStats != InlinerFunctionImportStatsOpts::No);
@@ -935,7 +992,7 @@ PreservedAnalyses InlinerPass::run(LazyCallGraph::SCC &InitialC,
           else if (!isa<IntrinsicInst>(I)) {
             using namespace ore;
             setInlineRemark(CS, "unavailable definition");
-            ORE.emit([&]() {
+            ORE.emit(DEBUG_TYPE, [&]() {
               return OptimizationRemarkMissed(DEBUG_TYPE, "NoDefinition", &I)
                      << NV("Callee", Callee) << " will not be inlined into "
                      << NV("Caller", CS.getCaller())
@@ -948,6 +1005,17 @@ PreservedAnalyses InlinerPass::run(LazyCallGraph::SCC &InitialC,
   if (Calls.empty())
     return PreservedAnalyses::all();
 
+  // With a module size budget, set it up when first seeing the module and
+  // spend it on the most beneficial calls first.
+  if (InlineSizeBudget) {
+    if (BudgetModule != &M) {
+      BudgetModule = &M;
+      ModuleSizeBudget = M.getInstructionCount() * InlineSizeBudget / 100;
+      ModuleSizeGrowth = 0;
+    }
+    sortCallsByBenefit(Calls, FAM);
+  }
+
   // Capture updatable variables for the current SCC and RefSCC.
   auto *C = &InitialC;
   auto *RC = &C->getOuterRefSCC();
@@ -1062,6 +1130,25 @@ PreservedAnalyses InlinerPass::run(LazyCallGraph::SCC &InitialC,
         continue;
       }
 
+      // Past the module size budget, only hot call sites are still inlined.
+      uint64_t SizeGrowth = 0;
+      if (InlineSizeBudget) {
+        SizeGrowth = getInlineSizeGrowth(Callee);
+        if (ModuleSizeGrowth + SizeGrowth > ModuleSizeBudget &&
+            !(PSI && PSI->isHotCallSite(CS, &GetBFI(F)))) {
+          ++NumOverBudget;
+          setInlineRemark(CS, "module size budget exhausted");
+          ORE.emit(DEBUG_TYPE, [&]() {
+            return OptimizationRemarkMissed(DEBUG_TYPE, "OverSizeBudget",
+                                            CS.getInstruction())
+                   << ore::NV("Callee", &Callee) << " will not be inlined into "
+                   << ore::NV("Caller", &F)
+                   << " because the module size budget is exhausted";
+          });
+          continue;
+        }
+      }
+
       // Setup the data structure used to plumb customization into the
       // `InlineFunction` routine.
       InlineFunctionInfo IFI(
@@ -1078,7 +1165,7 @@ PreservedAnalyses InlinerPass::run(LazyCallGraph::SCC &InitialC,
       InlineResult IR = InlineFunction(CS, IFI);
       if (!IR) {
         setInlineRemark(CS, std::string(IR) + "; " + inlineCostStr(*OIC));
-        ORE.emit([&]() {
+        ORE.emit(DEBUG_TYPE, [&]() {
           return OptimizationRemarkMissed(DEBUG_TYPE, "NotInlined", DLoc, Block)
                  << NV("Callee", &Callee) << " will not be inlined into "
                  << NV("Caller", &F) << ": " << NV("Reason", IR.message);
@@ -1087,6 +1174,7 @@ PreservedAnalyses InlinerPass::run(LazyCallGraph::SCC &InitialC,
       }
       DidInline = true;
       InlinedCallees.insert(&Callee);
+      ModuleSizeGrowth += SizeGrowth;
 
       ++NumInlined;
 
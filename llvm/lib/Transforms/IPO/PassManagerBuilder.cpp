@@ -101,6 +101,10 @@ static cl::opt<bool>
 cl::opt<bool> EnableHotColdSplit("hot-cold-split", cl::init(false), cl::Hidden,
     cl::desc("Enable hot-cold splitting pass"));
 
+cl::opt<bool> EnablePGOHotColdSplit(
+    "pgo-hot-cold-split", cl::init(true), cl::Hidden,
+    cl::desc("Enable hot-cold splitting pass when optimizing with a profile"));
+
 static cl::opt<bool> UseLoopVersioningLICM(
     "enable-loop-versioning-licm", cl::init(false), cl::Hidden,
     cl::desc("Enable the experimental Loop Versioning LICM pass"));
@@ -189,6 +193,14 @@ static ManagedStatic<SmallVector<std::pair<PassManagerBuilder::ExtensionPointTy,
 /// Check if GlobalExtensions is constructed and not empty.
 /// Since GlobalExtensions is a managed static, calling 'empty()' will trigger
 /// the construction of the object.
+/// Whether to split out cold code. Splitting is on by default when optimizing
+/// with a profile, as the profile tells the cold code apart reliably.
+static bool shouldSplitHotCold(const PassManagerBuilder &PMB) {
+  return EnableHotColdSplit ||
+         (EnablePGOHotColdSplit &&
+          (!PMB.PGOInstrUse.empty() || !PMB.PGOSampleUse.empty()));
+}
+
 static bool GlobalExtensionsNotEmpty() {
   return GlobalExtensions.isConstructed() && !GlobalExtensions->empty();
 }
@@ -754,7 +766,7 @@ void PassManagerBuilder::populateModulePassManager(
 
   // See comment in the new PM for justification of scheduling splitting at
   // this stage (\ref buildModuleSimplificationPipeline).
-  if (EnableHotColdSplit && !(PrepareForLTO || PrepareForThinLTO))
+  if (shouldSplitHotCold(*this) && !(PrepareForLTO || PrepareForThinLTO))
     MPM.add(createHotColdSplittingPass());
 
   if (MergeFunctions)
@@ -959,7 +971,7 @@ void PassManagerBuilder::addLateLTOOptimizationPasses(
     legacy::PassManagerBase &PM) {
   // See comment in the new PM for justification of scheduling splitting at
   // this stage (\ref buildLTODefaultPipeline).
-  if (EnableHotColdSplit)
+  if (shouldSplitHotCold(*this))
     PM.add(createHotColdSplittingPass());
 
   // Delete basic blocks, which optimization passes may have killed.
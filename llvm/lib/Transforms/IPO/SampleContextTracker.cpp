@@ -0,0 +1,262 @@
+//===- SampleContextTracker.cpp - Context-sensitive profile tracker -------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements the SampleContextTracker used by the sample profile
+// loader to match context-sensitive profiles with its inlining decisions.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Transforms/IPO/SampleContextTracker.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/IR/DebugInfoMetadata.h"
+#include "llvm/IR/InstrTypes.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/raw_ostream.h"
+
+using namespace llvm;
+using namespace sampleprof;
+
+#define DEBUG_TYPE "sample-context-tracker"
+
+ContextTrieNode *ContextTrieNode::getChildContext(const LineLocation &CallSite,
+                                                  StringRef CalleeName) {
+  auto It = AllChildContext.find(ChildKey(CallSite, CalleeName));
+  if (It == AllChildContext.end())
+    return nullptr;
+  return &It->second;
+}
+
+ContextTrieNode *
+ContextTrieNode::getHottestChildContext(const LineLocation &CallSite) {
+  ContextTrieNode *ChildNodeRet = nullptr;
+  uint64_t MaxCalleeSamples = 0;
+  for (ContextTrieNode *ChildNode : getChildContextsAt(CallSite)) {
+    FunctionSamples *Samples = ChildNode->getFunctionSamples();
+    if (!Samples)
+      continue;
+    if (!ChildNodeRet || Samples->getTotalSamples() > MaxCalleeSamples) {
+      ChildNodeRet = ChildNode;
+      MaxCalleeSamples = Samples->getTotalSamples();
+    }
+  }
+  return ChildNodeRet;
+}
+
+ContextTrieNode &
+ContextTrieNode::getOrCreateChildContext(const LineLocation &CallSite,
+                                         StringRef CalleeName) {
+  return AllChildContext
+      .emplace(ChildKey(CallSite, CalleeName),
+               ContextTrieNode(this, CalleeName, CallSite))
+      .first->second;
+}
+
+std::vector<ContextTrieNode *>
+ContextTrieNode::getChildContextsAt(const LineLocation &CallSite) {
+  std::vector<ContextTrieNode *> ChildNodes;
+  // The children are sorted by callsite first, so the callees of CallSite
+  // are adjacent.
+  for (auto It = AllChildContext.lower_bound(ChildKey(CallSite, StringRef()));
+       It != AllChildContext.end(); ++It) {
+    const LineLocation &Loc = It->first.first;
+    if (Loc.LineOffset != CallSite.LineOffset ||
+        Loc.Discriminator != CallSite.Discriminator)
+      break;
+    ChildNodes.push_back(&It->second);
+  }
+  return ChildNodes;
+}
+
+#if !defined(NDEBUG) || defined(LLVM_ENABLE_DUMP)
+LLVM_DUMP_METHOD void ContextTrieNode::dump(unsigned Indent) const {
+  // The root has no function, only list its children.
+  if (ParentContext) {
+    dbgs().indent(Indent);
+    if (ParentContext->ParentContext)
+      dbgs() << CallSiteLoc << ": ";
+    dbgs() << FuncName << ": "
+           << (FSamples ? FSamples->getTotalSamples() : uint64_t(0)) << "\n";
+    Indent += 2;
+  }
+  for (const auto &Child : AllChildContext)
+    Child.second.dump(Indent);
+}
+#endif
+
+SampleContextTracker::SampleContextTracker(
+    StringMap<FunctionSamples> &Profiles) {
+  for (auto &FuncSample : Profiles) {
+    FunctionSamples &FSamples = FuncSample.second;
+    const SampleContext &Context = FSamples.getContext();
+    SmallVector<SampleContext::ContextFrame, 8> Callers;
+    if (!SampleContext::decodeContextString(Context.getCallingContext(),
+                                            Callers)) {
+      LLVM_DEBUG(dbgs() << "Ignoring malformed context "
+                        << FSamples.getNameWithContext() << "\n");
+      continue;
+    }
+
+    // Walk the callers from the outermost one, each caller being called at
+    // the location of the previous frame.
+    ContextTrieNode *Node = &RootContext;
+    LineLocation CallSite(0, 0);
+    for (const SampleContext::ContextFrame &Caller : Callers) {
+      Node = &addContextNode(*Node, CallSite, Caller.first);
+      CallSite = Caller.second;
+    }
+    Node = &addContextNode(*Node, CallSite, FSamples.getName());
+
+    if (FunctionSamples *NodeSamples = Node->getFunctionSamples())
+      NodeSamples->merge(FSamples);
+    else
+      Node->setFunctionSamples(&FSamples);
+  }
+}
+
+ContextTrieNode &
+SampleContextTracker::addContextNode(ContextTrieNode &Parent,
+                                     const LineLocation &CallSite,
+                                     StringRef CalleeName) {
+  if (ContextTrieNode *Node = Parent.getChildContext(CallSite, CalleeName))
+    return *Node;
+  ContextTrieNode &Node = Parent.getOrCreateChildContext(CallSite, CalleeName);
+  FuncToCtxtNodes[CalleeName].push_back(&Node);
+  return Node;
+}
+
+/// Return the name of the function \p DIL belongs to, as it appears in the
+/// profile.
+static StringRef getFunctionName(const DILocation *DIL) {
+  const DISubprogram *SP = DIL->getScope()->getSubprogram();
+  StringRef Name = SP->getLinkageName();
+  return Name.empty() ? SP->getName() : Name;
+}
+
+ContextTrieNode *SampleContextTracker::getContextFor(const DILocation *DIL) {
+  assert(DIL && "Expected a debug location");
+  // Collect the inline stack, from the innermost frame to the outermost one.
+  SmallVector<std::pair<LineLocation, StringRef>, 10> S;
+  const DILocation *PrevDIL = DIL;
+  for (DIL = DIL->getInlinedAt(); DIL; DIL = DIL->getInlinedAt()) {
+    S.push_back(std::make_pair(
+        LineLocation(FunctionSamples::getOffset(DIL),
+                     DIL->getBaseDiscriminator()),
+        getFunctionName(PrevDIL)));
+    PrevDIL = DIL;
+  }
+
+  ContextTrieNode *Node =
+      RootContext.getChildContext(LineLocation(0, 0), getFunctionName(PrevDIL));
+  for (int I = S.size() - 1; I >= 0 && Node; --I)
+    Node = Node->getChildContext(S[I].first, S[I].second);
+  return Node;
+}
+
+FunctionSamples *
+SampleContextTracker::getCalleeContextSamplesFor(const CallBase &Inst,
+                                                 StringRef CalleeName) {
+  const DILocation *DIL = Inst.getDebugLoc();
+  if (!DIL)
+    return nullptr;
+  ContextTrieNode *CallerNode = getContextFor(DIL);
+  if (!CallerNode)
+    return nullptr;
+
+  LineLocation CallSite(FunctionSamples::getOffset(DIL),
+                        DIL->getBaseDiscriminator());
+  ContextTrieNode *CalleeNode =
+      CalleeName.empty() ? CallerNode->getHottestChildContext(CallSite)
+                         : CallerNode->getChildContext(CallSite, CalleeName);
+  return CalleeNode ? CalleeNode->getFunctionSamples() : nullptr;
+}
+
+std::vector<const FunctionSamples *>
+SampleContextTracker::getIndirectCalleeContextSamplesFor(
+    const DILocation *DIL) {
+  std::vector<const FunctionSamples *> R;
+  if (!DIL)
+    return R;
+  ContextTrieNode *CallerNode = getContextFor(DIL);
+  if (!CallerNode)
+    return R;
+
+  LineLocation CallSite(FunctionSamples::getOffset(DIL),
+                        DIL->getBaseDiscriminator());
+  for (ContextTrieNode *CalleeNode : CallerNode->getChildContextsAt(CallSite))
+    if (const FunctionSamples *CalleeSamples = CalleeNode->getFunctionSamples())
+      R.push_back(CalleeSamples);
+  return R;
+}
+
+FunctionSamples *
+SampleContextTracker::getContextSamplesFor(const DILocation *DIL) {
+  ContextTrieNode *Node = getContextFor(DIL);
+  return Node ? Node->getFunctionSamples() : nullptr;
+}
+
+FunctionSamples *SampleContextTracker::getBaseSamplesFor(const Function &Func) {
+  StringRef CanonName = FunctionSamples::getCanonicalFnName(Func);
+  auto It = FuncToCtxtNodes.find(CanonName);
+  if (It == FuncToCtxtNodes.end())
+    return nullptr;
+  // Use the name kept by the trie, the canonical name may not outlive Func.
+  CanonName = It->first();
+
+  ContextTrieNode &BaseNode =
+      addContextNode(RootContext, LineLocation(0, 0), CanonName);
+  // Merging adds nodes, only look at the contexts that were there before.
+  std::vector<ContextTrieNode *> &Nodes = FuncToCtxtNodes[CanonName];
+  for (size_t I = 0, E = Nodes.size(); I < E; ++I) {
+    ContextTrieNode *Node = Nodes[I];
+    if (Node == &BaseNode)
+      continue;
+    // The samples of an inlined context were used by its caller.
+    FunctionSamples *Samples = Node->getFunctionSamples();
+    if (Samples && InlinedSamples.count(Samples))
+      continue;
+    mergeContextTree(*Node, BaseNode);
+  }
+  return BaseNode.getFunctionSamples();
+}
+
+void SampleContextTracker::markContextSamplesInlined(
+    const FunctionSamples *Samples) {
+  if (Samples)
+    InlinedSamples.insert(Samples);
+}
+
+/// Merge the samples of \p FromNode into \p ToNode, and the contexts of its
+/// callees into the contexts of the callees of \p ToNode. The samples of
+/// \p FromNode are cleared, so that they are only accounted once.
+void SampleContextTracker::mergeContextTree(ContextTrieNode &FromNode,
+                                            ContextTrieNode &ToNode) {
+  if (FunctionSamples *FromSamples = FromNode.getFunctionSamples()) {
+    LLVM_DEBUG(dbgs() << "Merging context " << FromSamples->getNameWithContext()
+                      << " into " << ToNode.getFuncName() << "\n");
+    if (FunctionSamples *ToSamples = ToNode.getFunctionSamples())
+      ToSamples->merge(*FromSamples);
+    else
+      ToNode.setFunctionSamples(FromSamples);
+    FromNode.setFunctionSamples(nullptr);
+  }
+
+  for (auto &Child : FromNode.getAllChildContext()) {
+    FunctionSamples *ChildSamples = Child.second.getFunctionSamples();
+    if (ChildSamples && InlinedSamples.count(ChildSamples))
+      continue;
+    mergeContextTree(Child.second, addContextNode(ToNode, Child.first.first,
+                                                  Child.first.second));
+  }
+}
+
+#if !defined(NDEBUG) || defined(LLVM_ENABLE_DUMP)
+LLVM_DUMP_METHOD void SampleContextTracker::dump() const {
+  dbgs() << "Context profile tree:\n";
+  RootContext.dump();
+}
+#endif
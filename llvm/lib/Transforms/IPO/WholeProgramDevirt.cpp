@@ -87,6 +87,7 @@
 #include "llvm/Support/Error.h"
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/MathExtras.h"
+#include "llvm/Support/Parallel.h"
 #include "llvm/Transforms/IPO.h"
 #include "llvm/Transforms/IPO/FunctionAttrs.h"
 #include "llvm/Transforms/Utils/Evaluator.h"
@@ -601,7 +602,7 @@ struct DevirtIndex {
         LocalWPDTargetsMap(LocalWPDTargetsMap) {}
 
   bool tryFindVirtualCallTargets(std::vector<ValueInfo> &TargetsForSlot,
-                                 const TypeIdCompatibleVtableInfo TIdInfo,
+                                 const TypeIdCompatibleVtableInfo &TIdInfo,
                                  uint64_t ByteOffset);
 
   bool trySingleImplDevirt(MutableArrayRef<ValueInfo> TargetsForSlot,
@@ -841,9 +842,9 @@ bool DevirtModule::tryFindVirtualCallTargets(
 }
 
 bool DevirtIndex::tryFindVirtualCallTargets(
-    std::vector<ValueInfo> &TargetsForSlot, const TypeIdCompatibleVtableInfo TIdInfo,
-    uint64_t ByteOffset) {
-  for (const TypeIdOffsetVtableInfo P : TIdInfo) {
+    std::vector<ValueInfo> &TargetsForSlot,
+    const TypeIdCompatibleVtableInfo &TIdInfo, uint64_t ByteOffset) {
+  for (const TypeIdOffsetVtableInfo &P : TIdInfo) {
     // VTable initializer should have only one summary, or all copies must be
     // linkonce/weak ODR.
     assert(P.VTableVI.getSummaryList().size() == 1 ||
@@ -1962,17 +1963,28 @@ void DevirtIndex::run() {
     }
   }
 
+  // For each (type, offset) pair, search each of the members of the type
+  // identifier for the virtual function implementation at offset
+  // S.first.ByteOffset, and add to TargetsForSlot. This only reads the index,
+  // so it is done for all pairs in parallel.
+  std::vector<std::vector<ValueInfo>> TargetsForSlots(CallSlots.size());
+  parallel::for_each_n(parallel::par, size_t(0), CallSlots.size(),
+                       [&](size_t I) {
+    const VTableSlotSummary &Slot = (CallSlots.begin() + I)->first;
+    auto TidSummary =
+        ExportSummary.getTypeIdCompatibleVtableSummary(Slot.TypeID);
+    assert(TidSummary);
+    tryFindVirtualCallTargets(TargetsForSlots[I], *TidSummary,
+                              Slot.ByteOffset);
+  });
+
+  // Update the index with the results for each pair in order, so that the
+  // result does not depend on the scheduling.
   std::set<ValueInfo> DevirtTargets;
-  // For each (type, offset) pair:
+  size_t I = 0;
   for (auto &S : CallSlots) {
-    // Search each of the members of the type identifier for the virtual
-    // function implementation at offset S.first.ByteOffset, and add to
-    // TargetsForSlot.
-    std::vector<ValueInfo> TargetsForSlot;
-    auto TidSummary = ExportSummary.getTypeIdCompatibleVtableSummary(S.first.TypeID);
-    assert(TidSummary);
-    if (tryFindVirtualCallTargets(TargetsForSlot, *TidSummary,
-                                  S.first.ByteOffset)) {
+    std::vector<ValueInfo> &TargetsForSlot = TargetsForSlots[I++];
+    if (!TargetsForSlot.empty()) {
       WholeProgramDevirtResolution *Res =
           &ExportSummary.getOrInsertTypeIdSummary(S.first.TypeID)
                .WPDRes[S.first.ByteOffset];
@@ -23,7 +23,12 @@
 #include "llvm/ADT/StringRef.h"
 #include "llvm/ADT/Triple.h"
 #include "llvm/ADT/Twine.h"
+#include "llvm/Analysis/AssumptionCache.h"
+#include "llvm/Analysis/LoopInfo.h"
 #include "llvm/Analysis/MemoryBuiltins.h"
+#include "llvm/Analysis/ScalarEvolution.h"
+#include "llvm/Analysis/ScalarEvolutionExpander.h"
+#include "llvm/Analysis/ScalarEvolutionExpressions.h"
 #include "llvm/Analysis/TargetLibraryInfo.h"
 #include "llvm/Analysis/ValueTracking.h"
 #include "llvm/BinaryFormat/MachO.h"
@@ -349,6 +354,12 @@ static cl::opt<bool> ClOptStack(
     "asan-opt-stack", cl::desc("Don't instrument scalar stack variables"),
     cl::Hidden, cl::init(false));
 
+static cl::opt<bool> ClOptLoops(
+    "asan-opt-loops",
+    cl::desc("Check the memory accessed by consecutive loads and stores in a "
+             "loop once, before the loop"),
+    cl::Hidden, cl::init(false));
+
 static cl::opt<bool> ClDynamicAllocaStack(
     "asan-stack-dynamic-alloca",
     cl::desc("Use dynamic alloca to represent stack variables"), cl::Hidden,
@@ -405,6 +416,9 @@ STATISTIC(NumOptimizedAccessesToGlobalVar,
           "Number of optimized accesses to global vars");
 STATISTIC(NumOptimizedAccessesToStackVar,
           "Number of optimized accesses to stack vars");
+STATISTIC(NumOptimizedAccessesInLoops,
+          "Number of accesses in loops checked before the loop");
+STATISTIC(NumLoopRangeChecks, "Number of range checks before loops");
 
 namespace {
 
@@ -652,6 +666,8 @@ private:
   bool GlobalIsLinkerInitialized(GlobalVariable *G);
   bool isSafeAccess(ObjectSizeOffsetVisitor &ObjSizeVis, Value *Addr,
                     uint64_t TypeSize) const;
+  void hoistLoopAccessChecks(Function &F, const TargetLibraryInfo &TLI,
+                             SmallVectorImpl<Instruction *> &ToInstrument);
 
   /// Helper to cleanup per-function state.
   struct FunctionStateRAII {
@@ -2698,6 +2714,9 @@ bool AddressSanitizer::instrumentFunction(Function &F,
     }
   }
 
+  if (ClOpt && ClOptLoops && TLI && !ToInstrument.empty())
+    hoistLoopAccessChecks(F, *TLI, ToInstrument);
+
   bool UseCalls =
       (ClInstrumentationWithCallsThreshold >= 0 &&
        ToInstrument.size() > (unsigned)ClInstrumentationWithCallsThreshold);
@@ -3335,3 +3354,119 @@ bool AddressSanitizer::isSafeAccess(ObjectSizeOffsetVisitor &ObjSizeVis,
   return Offset >= 0 && Size >= uint64_t(Offset) &&
          Size - uint64_t(Offset) >= TypeSize / 8;
 }
+
+// Replaces the checks of loads and stores that access consecutive memory in
+// every iteration of a loop with a single check of all the memory they access
+// in the loop, done in the loop preheader. This is only done for innermost
+// loops without calls, as a call could poison memory (e.g. free it) while the
+// loop runs, and with a trip count that can be computed before the loop.
+// Accesses that are handled here are removed from ToInstrument.
+void AddressSanitizer::hoistLoopAccessChecks(
+    Function &F, const TargetLibraryInfo &TLI,
+    SmallVectorImpl<Instruction *> &ToInstrument) {
+  DominatorTree DT(F);
+  LoopInfo LI(DT);
+  if (LI.empty())
+    return;
+  AssumptionCache AC(F);
+  // ScalarEvolution only queries the TargetLibraryInfo.
+  ScalarEvolution SE(F, const_cast<TargetLibraryInfo &>(TLI), AC, DT, LI);
+  SCEVExpander Expander(SE, F.getParent()->getDataLayout(), "asan.range");
+  uint32_t Exp = ClForceExperiment;
+
+  DenseMap<Loop *, bool> IsCallFree;
+  auto LoopIsCallFree = [&](Loop *L) {
+    auto It = IsCallFree.find(L);
+    if (It != IsCallFree.end())
+      return It->second;
+    bool Result = llvm::none_of(L->blocks(), [](BasicBlock *BB) {
+      return llvm::any_of(*BB, [](Instruction &I) {
+        return isa<CallBase>(I) && !isa<DbgInfoIntrinsic>(I);
+      });
+    });
+    IsCallFree[L] = Result;
+    return Result;
+  };
+
+  // The ranges that are already checked, so that accesses to the same memory
+  // share a check.
+  SmallVector<std::tuple<Loop *, const SCEV *, const SCEV *, bool>, 8> Checked;
+
+  auto HoistCheck = [&](Instruction *I) {
+    if (!isa<LoadInst>(I) && !isa<StoreInst>(I))
+      return false;
+    bool IsWrite;
+    uint64_t TypeSize;
+    unsigned Alignment;
+    Value *Addr = isInterestingMemoryAccess(I, &IsWrite, &TypeSize, &Alignment);
+    if (!Addr)
+      return false;
+
+    Loop *L = LI.getLoopFor(I->getParent());
+    if (!L || !L->empty())
+      return false;
+    BasicBlock *Preheader = L->getLoopPreheader();
+    BasicBlock *Latch = L->getLoopLatch();
+    if (!Preheader || !Latch || !LoopIsCallFree(L))
+      return false;
+    // The access has to happen in every iteration, including the last one.
+    if (!DT.dominates(I->getParent(), Latch))
+      return false;
+    SmallVector<BasicBlock *, 4> ExitingBlocks;
+    L->getExitingBlocks(ExitingBlocks);
+    if (llvm::any_of(ExitingBlocks, [&](BasicBlock *BB) {
+          return !DT.dominates(I->getParent(), BB);
+        }))
+      return false;
+
+    // The accessed memory has to be contiguous: the address has to advance by
+    // at most the access size in every iteration.
+    const auto *AR = dyn_cast<SCEVAddRecExpr>(SE.getSCEV(Addr));
+    if (!AR || AR->getLoop() != L || !AR->isAffine() || !AR->hasNoSelfWrap())
+      return false;
+    const auto *Step = dyn_cast<SCEVConstant>(AR->getStepRecurrence(SE));
+    uint64_t AccessSize = TypeSize / 8;
+    if (!Step || Step->getAPInt().isNullValue() ||
+        Step->getAPInt().abs().ugt(AccessSize))
+      return false;
+    const SCEV *BackedgeTakenCount = SE.getBackedgeTakenCount(L);
+    if (isa<SCEVCouldNotCompute>(BackedgeTakenCount))
+      return false;
+
+    const SCEV *First = AR->getStart();
+    const SCEV *Last = AR->evaluateAtIteration(BackedgeTakenCount, SE);
+    if (Step->getAPInt().isNegative())
+      std::swap(First, Last);
+    const SCEV *Size = SE.getAddExpr(SE.getMinusSCEV(Last, First),
+                                     SE.getConstant(IntptrTy, AccessSize));
+    Instruction *InsertBefore = Preheader->getTerminator();
+    if (!isSafeToExpandAt(First, InsertBefore, SE) ||
+        !isSafeToExpandAt(Size, InsertBefore, SE))
+      return false;
+
+    ++NumOptimizedAccessesInLoops;
+    auto Range = std::make_tuple(L, First, Size, IsWrite);
+    if (llvm::is_contained(Checked, Range))
+      return true;
+    Checked.push_back(Range);
+    ++NumLoopRangeChecks;
+    LLVM_DEBUG(dbgs() << "ASAN checking " << *I << " before "
+                      << L->getHeader()->getName() << ": [" << *First << ", +"
+                      << *Size << ")\n");
+
+    Value *Begin = Expander.expandCodeFor(First, IntptrTy, InsertBefore);
+    Value *Len = Expander.expandCodeFor(Size, IntptrTy, InsertBefore);
+    IRBuilder<> IRB(InsertBefore);
+    IRB.SetCurrentDebugLocation(I->getDebugLoc());
+    if (Exp == 0)
+      IRB.CreateCall(AsanMemoryAccessCallbackSized[IsWrite][0], {Begin, Len});
+    else
+      IRB.CreateCall(AsanMemoryAccessCallbackSized[IsWrite][1],
+                     {Begin, Len, ConstantInt::get(IRB.getInt32Ty(), Exp)});
+    return true;
+  };
+
+  ToInstrument.erase(
+      std::remove_if(ToInstrument.begin(), ToInstrument.end(), HoistCheck),
+      ToInstrument.end());
+}
@@ -35,6 +35,7 @@
 #include "llvm/IR/Instruction.h"
 #include "llvm/IR/Instructions.h"
 #include "llvm/IR/IntrinsicInst.h"
+#include "llvm/IR/MDBuilder.h"
 #include "llvm/IR/Module.h"
 #include "llvm/IR/Type.h"
 #include "llvm/Pass.h"
@@ -142,6 +143,25 @@ cl::opt<bool> IterativeCounterPromotion(
     cl::ZeroOrMore, "iterative-counter-promotion", cl::init(true),
     cl::desc("Allow counter promotion across the whole loop nest."));
 
+// Sampled instrumentation: each thread counts the increments it executes and
+// only updates the counters during the first SampledInstrBurstDuration of
+// every SampledInstrPeriod of them. Multi-threaded programs then rarely write
+// the shared counters, which removes most of the cache line contention they
+// cause, while the relative counts stay representative.
+cl::opt<bool> SampledInstr("sampled-instr", cl::ZeroOrMore, cl::init(false),
+                           cl::desc("Only update profile counters in sampled "
+                                    "bursts"));
+
+cl::opt<unsigned> SampledInstrPeriod(
+    "sampled-instr-period", cl::ZeroOrMore, cl::init(65536),
+    cl::desc("The number of counter updates in a sampling period of sampled "
+             "instrumentation"));
+
+cl::opt<unsigned> SampledInstrBurstDuration(
+    "sampled-instr-burst-duration", cl::ZeroOrMore, cl::init(200),
+    cl::desc("The number of counter updates that are done at the start of "
+             "each sampling period of sampled instrumentation"));
+
 class InstrProfilingLegacyPass : public ModulePass {
   InstrProfiling InstrProf;
 
@@ -409,12 +429,17 @@ static InstrProfIncrementInst *castToIncrementInst(Instruction *Instr) {
 bool InstrProfiling::lowerIntrinsics(Function *F) {
   bool MadeChange = false;
   PromotionCandidates.clear();
+  // Sampled increments split their block, so they are lowered afterwards.
+  SmallVector<InstrProfIncrementInst *, 16> SampledIncs;
   for (BasicBlock &BB : *F) {
     for (auto I = BB.begin(), E = BB.end(); I != E;) {
       auto Instr = I++;
       InstrProfIncrementInst *Inc = castToIncrementInst(&*Instr);
       if (Inc) {
-        lowerIncrement(Inc);
+        if (isSamplingEnabled())
+          SampledIncs.push_back(Inc);
+        else
+          lowerIncrement(Inc);
         MadeChange = true;
       } else if (auto *Ind = dyn_cast<InstrProfValueProfileInst>(Instr)) {
         lowerValueProfileInst(Ind);
@@ -422,6 +447,8 @@ bool InstrProfiling::lowerIntrinsics(Function *F) {
       }
     }
   }
+  for (InstrProfIncrementInst *Inc : SampledIncs)
+    lowerIncrement(Inc);
 
   if (!MadeChange)
     return false;
@@ -431,12 +458,38 @@ bool InstrProfiling::lowerIntrinsics(Function *F) {
 }
 
 bool InstrProfiling::isCounterPromotionEnabled() const {
+  // The sampled updates are conditional, promoting them would make them
+  // unconditional again.
+  if (isSamplingEnabled())
+    return false;
+
   if (DoCounterPromotion.getNumOccurrences() > 0)
     return DoCounterPromotion;
 
   return Options.DoCounterPromotion;
 }
 
+bool InstrProfiling::isSamplingEnabled() const {
+  return SampledInstr && SampledInstrBurstDuration < SampledInstrPeriod;
+}
+
+GlobalVariable *InstrProfiling::getOrCreateSamplingVar() {
+  if (SamplingVar)
+    return SamplingVar;
+
+  // Each module has its own copy, merged by the linker, so that no runtime
+  // support is needed.
+  auto *Int32Ty = Type::getInt32Ty(M->getContext());
+  SamplingVar = new GlobalVariable(
+      *M, Int32Ty, false, GlobalValue::LinkOnceODRLinkage,
+      Constant::getNullValue(Int32Ty), "__llvm_profile_sampling", nullptr,
+      GlobalValue::GeneralDynamicTLSModel);
+  SamplingVar->setVisibility(GlobalValue::HiddenVisibility);
+  if (TT.supportsCOMDAT())
+    SamplingVar->setComdat(M->getOrInsertComdat(SamplingVar->getName()));
+  return SamplingVar;
+}
+
 void InstrProfiling::promoteCounterLoadStores(Function *F) {
   if (!isCounterPromotionEnabled())
     return;
@@ -495,6 +548,7 @@ bool InstrProfiling::run(
   this->GetTLI = std::move(GetTLI);
   NamesVar = nullptr;
   NamesSize = 0;
+  SamplingVar = nullptr;
   ProfileDataMap.clear();
   UsedVars.clear();
   getMemOPSizeRangeFromOption(MemOPSizeRange, MemOPSizeRangeStart,
@@ -636,6 +690,28 @@ void InstrProfiling::lowerIncrement(InstrProfIncrementInst *Inc) {
   GlobalVariable *Counters = getOrCreateRegionCounters(Inc);
 
   IRBuilder<> Builder(Inc);
+  if (isSamplingEnabled()) {
+    // Advance the sampling counter of the thread, and only update the counter
+    // in the burst at the start of the sampling period.
+    GlobalVariable *Sampling = getOrCreateSamplingVar();
+    Type *Int32Ty = Builder.getInt32Ty();
+    Value *Current = Builder.CreateLoad(Int32Ty, Sampling, "pgosampling");
+    Value *Next = Builder.CreateAdd(Current, Builder.getInt32(1));
+    Next = Builder.CreateSelect(
+        Builder.CreateICmpEQ(Next, Builder.getInt32(SampledInstrPeriod)),
+        Builder.getInt32(0), Next);
+    Builder.CreateStore(Next, Sampling);
+    Value *InBurst = Builder.CreateICmpULT(
+        Current, Builder.getInt32(SampledInstrBurstDuration));
+    MDNode *Weights = MDBuilder(M->getContext())
+                          .createBranchWeights(SampledInstrBurstDuration,
+                                               SampledInstrPeriod -
+                                                   SampledInstrBurstDuration);
+    Instruction *ThenTerm =
+        SplitBlockAndInsertIfThen(InBurst, Inc, /*Unreachable=*/false, Weights);
+    Builder.SetInsertPoint(ThenTerm);
+  }
+
   uint64_t Index = Inc->getIndex()->getZExtValue();
   Value *Addr = Builder.CreateConstInBoundsGEP2_64(Counters->getValueType(),
                                                    Counters, 0, Index);
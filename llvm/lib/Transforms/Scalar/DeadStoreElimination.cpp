@@ -9,8 +9,9 @@
 // This file implements a trivial dead store elimination that only considers
 // basic-block local redundant stores.
 //
-// FIXME: This should eventually be extended to be a post-dominator tree
-// traversal.  Doing so would be pretty trivial.
+// With -enable-dse-memoryssa, it instead walks MemorySSA forward from each
+// store to find a later store overwriting it on every path, which may be in
+// another basic block.
 //
 //===----------------------------------------------------------------------===//
 
@@ -28,7 +29,10 @@
 #include "llvm/Analysis/MemoryBuiltins.h"
 #include "llvm/Analysis/MemoryDependenceAnalysis.h"
 #include "llvm/Analysis/MemoryLocation.h"
+#include "llvm/Analysis/MemorySSA.h"
+#include "llvm/Analysis/MemorySSAUpdater.h"
 #include "llvm/Analysis/OrderedBasicBlock.h"
+#include "llvm/Analysis/PostDominators.h"
 #include "llvm/Analysis/TargetLibraryInfo.h"
 #include "llvm/Analysis/ValueTracking.h"
 #include "llvm/IR/Argument.h"
@@ -74,6 +78,8 @@ STATISTIC(NumFastStores, "Number of stores deleted");
 STATISTIC(NumFastOther, "Number of other instrs removed");
 STATISTIC(NumCompletePartials, "Number of stores dead by later partials");
 STATISTIC(NumModifiedStores, "Number of stores modified");
+STATISTIC(NumCrossBlockStores,
+          "Number of stores deleted by a store in another block");
 
 static cl::opt<bool>
 EnablePartialOverwriteTracking("enable-dse-partial-overwrite-tracking",
@@ -85,6 +91,16 @@ EnablePartialStoreMerging("enable-dse-partial-store-merging",
   cl::init(true), cl::Hidden,
   cl::desc("Enable partial store merging in DSE"));
 
+static cl::opt<bool>
+EnableMemorySSA("enable-dse-memoryssa", cl::init(false), cl::Hidden,
+  cl::desc("Use the MemorySSA-based DSE, which also eliminates stores "
+           "killed in other blocks"));
+
+static cl::opt<unsigned>
+MemorySSAScanLimit("dse-memoryssa-scanlimit", cl::init(150), cl::Hidden,
+  cl::desc("The number of memory accesses the MemorySSA-based DSE looks at "
+           "for each store"));
+
 //===----------------------------------------------------------------------===//
 // Helper functions
 //===----------------------------------------------------------------------===//
@@ -1322,22 +1338,259 @@ static bool eliminateDeadStores(Function &F, AliasAnalysis *AA,
   return MadeChange;
 }
 
+//===----------------------------------------------------------------------===//
+// MemorySSA-based DSE
+//===----------------------------------------------------------------------===//
+namespace {
+
+/// Eliminates stores killed by a later store, possibly in another block, by
+/// walking MemorySSA forward from each store instead of querying MemDep.
+class DSEMemorySSA {
+  Function &F;
+  AliasAnalysis &AA;
+  MemorySSA &MSSA;
+  MemorySSAUpdater Updater;
+  DominatorTree &DT;
+  PostDominatorTree &PDT;
+  const TargetLibraryInfo &TLI;
+  const DataLayout &DL;
+
+  /// The position of each instruction in its block.
+  DenseMap<const Instruction *, unsigned> InstOrder;
+
+  /// The positions of the instructions which may throw in each block.
+  DenseMap<const BasicBlock *, SmallVector<unsigned, 4>> ThrowingInsts;
+
+  /// The stores which may be removed, in program order.
+  SmallVector<Instruction *, 64> Candidates;
+
+  /// Instructions deleted so far, not to be looked at again.
+  SmallPtrSet<Instruction *, 16> Deleted;
+
+  /// A map of interval maps representing partially-overwritten value parts.
+  InstOverlapIntervalsTy IOL;
+
+public:
+  DSEMemorySSA(Function &F, AliasAnalysis &AA, MemorySSA &MSSA,
+               DominatorTree &DT, PostDominatorTree &PDT,
+               const TargetLibraryInfo &TLI)
+      : F(F), AA(AA), MSSA(MSSA), Updater(&MSSA), DT(DT), PDT(PDT), TLI(TLI),
+        DL(F.getParent()->getDataLayout()) {}
+
+  bool run();
+
+private:
+  bool isThrowingBetween(const Instruction *Earlier,
+                         const Instruction *Later) const;
+  bool isInvisibleOnUnwind(const MemoryLocation &Loc) const;
+  bool eliminateKilledStore(Instruction *Dead);
+  void deleteDeadInstruction(Instruction *I);
+};
+
+} // end anonymous namespace
+
+/// Returns true if an instruction after \p Earlier and before \p Later, which
+/// are in the same block, may throw; or, if they are in different blocks, if
+/// anything besides the instructions before \p Earlier or after \p Later may
+/// throw.
+bool DSEMemorySSA::isThrowingBetween(const Instruction *Earlier,
+                                     const Instruction *Later) const {
+  unsigned EarlierPos = InstOrder.lookup(Earlier);
+  unsigned LaterPos = InstOrder.lookup(Later);
+  if (Earlier->getParent() == Later->getParent()) {
+    auto I = ThrowingInsts.find(Earlier->getParent());
+    if (I == ThrowingInsts.end())
+      return false;
+    return llvm::any_of(I->second, [&](unsigned Pos) {
+      return Pos > EarlierPos && Pos < LaterPos;
+    });
+  }
+  for (auto &BlockAndPositions : ThrowingInsts)
+    for (unsigned Pos : BlockAndPositions.second)
+      if (!(BlockAndPositions.first == Earlier->getParent() &&
+            Pos < EarlierPos) &&
+          !(BlockAndPositions.first == Later->getParent() && Pos > LaterPos))
+        return true;
+  return false;
+}
+
+/// Returns true if the memory at \p Loc can't be read once the function
+/// unwinds, so that stores to it are dead along the unwind edges.
+bool DSEMemorySSA::isInvisibleOnUnwind(const MemoryLocation &Loc) const {
+  const Value *Underlying = GetUnderlyingObject(Loc.Ptr, DL);
+  if (isa<AllocaInst>(Underlying))
+    return true;
+  return isAllocLikeFn(Underlying, &TLI) &&
+         !PointerMayBeCaptured(Underlying, false, true);
+}
+
+void DSEMemorySSA::deleteDeadInstruction(Instruction *I) {
+  SmallVector<Instruction *, 32> NowDeadInsts;
+  NowDeadInsts.push_back(I);
+  --NumFastOther;
+
+  do {
+    Instruction *DeadInst = NowDeadInsts.pop_back_val();
+    ++NumFastOther;
+
+    // Try to preserve debug information attached to the dead instruction.
+    salvageDebugInfo(*DeadInst);
+
+    // Remove it from MemorySSA first, which needs it to be in the function.
+    if (MemoryAccess *MA = MSSA.getMemoryAccess(DeadInst))
+      Updater.removeMemoryAccess(MA);
+
+    for (unsigned op = 0, e = DeadInst->getNumOperands(); op != e; ++op) {
+      Value *Op = DeadInst->getOperand(op);
+      DeadInst->setOperand(op, nullptr);
+
+      // If this operand just became dead, add it to the NowDeadInsts list.
+      if (!Op->use_empty())
+        continue;
+
+      if (Instruction *OpI = dyn_cast<Instruction>(Op))
+        if (isInstructionTriviallyDead(OpI, &TLI))
+          NowDeadInsts.push_back(OpI);
+    }
+
+    IOL.erase(DeadInst);
+    Deleted.insert(DeadInst);
+    DeadInst->eraseFromParent();
+  } while (!NowDeadInsts.empty());
+}
+
+/// Walk the MemorySSA def chain down from \p Dead, looking for a store which
+/// overwrites all of the memory \p Dead writes on every path. The walk gives
+/// up at any access which may read that memory, at a def with more than one
+/// def or phi user, at a loop header and after MemorySSAScanLimit accesses.
+/// Returns true if \p Dead was deleted.
+bool DSEMemorySSA::eliminateKilledStore(Instruction *Dead) {
+  MemoryLocation DeadLoc = getLocForWrite(Dead);
+  if (!DeadLoc.Ptr)
+    return false;
+  bool DeadIsInvisibleOnUnwind = isInvisibleOnUnwind(DeadLoc);
+
+  MemoryAccess *Current = MSSA.getMemoryAccess(Dead);
+  unsigned ScanLimit = MemorySSAScanLimit;
+  while (true) {
+    // Look at the users of the current access: a read of the dead store's
+    // memory keeps it alive, and the next def or phi is where the walk
+    // continues.
+    MemoryAccess *Next = nullptr;
+    for (Use &U : Current->uses()) {
+      if (ScanLimit-- == 0)
+        return false;
+      auto *UseAccess = cast<MemoryAccess>(U.getUser());
+      if (auto *MU = dyn_cast<MemoryUse>(UseAccess)) {
+        if (isRefSet(AA.getModRefInfo(MU->getMemoryInst(), DeadLoc)))
+          return false;
+        continue;
+      }
+      if (Next)
+        return false;
+      Next = UseAccess;
+    }
+    if (!Next)
+      return false;
+
+    if (auto *Phi = dyn_cast<MemoryPhi>(Next)) {
+      // Don't follow a back edge; a store on the other side of it runs in
+      // another iteration, where the same pointer may mean another address.
+      BasicBlock *PhiBB = Phi->getBlock();
+      if (llvm::any_of(Phi->blocks(), [&](BasicBlock *Pred) {
+            return DT.dominates(PhiBB, Pred);
+          }))
+        return false;
+      Current = Phi;
+      continue;
+    }
+
+    Instruction *Later = cast<MemoryDef>(Next)->getMemoryInst();
+    MemoryLocation LaterLoc;
+    if (hasAnalyzableMemoryWrite(Later, TLI))
+      LaterLoc = getLocForWrite(Later);
+
+    // The later store must run whenever the dead one does, without anything
+    // which may throw in between unless the memory is dead on unwind, too.
+    if (LaterLoc.Ptr &&
+        (Later->getParent() == Dead->getParent() ||
+         PDT.dominates(Later->getParent(), Dead->getParent())) &&
+        (DeadIsInvisibleOnUnwind || !isThrowingBetween(Dead, Later)) &&
+        !isPossibleSelfRead(Later, LaterLoc, Dead, TLI, AA)) {
+      int64_t LaterOffset, DeadOffset;
+      OverwriteResult OR = isOverwrite(LaterLoc, DeadLoc, DL, TLI,
+                                       DeadOffset, LaterOffset, Dead, IOL, AA,
+                                       &F);
+      if (OR == OW_Complete) {
+        LLVM_DEBUG(dbgs() << "DSE: Remove Dead Store:\n  DEAD: " << *Dead
+                          << "\n  KILLER: " << *Later << '\n');
+        if (Later->getParent() != Dead->getParent())
+          ++NumCrossBlockStores;
+        deleteDeadInstruction(Dead);
+        ++NumFastStores;
+        return true;
+      }
+    }
+
+    // Keep looking past the later def, unless it may read the memory.
+    if (isRefSet(AA.getModRefInfo(Later, DeadLoc)))
+      return false;
+    Current = Next;
+  }
+}
+
+bool DSEMemorySSA::run() {
+  for (BasicBlock &BB : F) {
+    // Only look at stores in reachable blocks. Dead blocks may have strange
+    // pointer cycles that will confuse alias analysis.
+    if (!DT.isReachableFromEntry(&BB))
+      continue;
+    unsigned Pos = 0;
+    for (Instruction &I : BB) {
+      InstOrder[&I] = Pos;
+      if (I.mayThrow())
+        ThrowingInsts[&BB].push_back(Pos);
+      ++Pos;
+      if (hasAnalyzableMemoryWrite(&I, TLI) && isRemovable(&I) &&
+          MSSA.getMemoryAccess(&I))
+        Candidates.push_back(&I);
+    }
+  }
+
+  bool MadeChange = false;
+  for (Instruction *Dead : Candidates)
+    if (!Deleted.count(Dead))
+      MadeChange |= eliminateKilledStore(Dead);
+
+  if (EnablePartialOverwriteTracking)
+    MadeChange |= removePartiallyOverlappedStores(&AA, DL, IOL);
+  return MadeChange;
+}
+
 //===----------------------------------------------------------------------===//
 // DSE Pass
 //===----------------------------------------------------------------------===//
 PreservedAnalyses DSEPass::run(Function &F, FunctionAnalysisManager &AM) {
   AliasAnalysis *AA = &AM.getResult<AAManager>(F);
   DominatorTree *DT = &AM.getResult<DominatorTreeAnalysis>(F);
-  MemoryDependenceResults *MD = &AM.getResult<MemoryDependenceAnalysis>(F);
   const TargetLibraryInfo *TLI = &AM.getResult<TargetLibraryAnalysis>(F);
 
-  if (!eliminateDeadStores(F, AA, MD, DT, TLI))
-    return PreservedAnalyses::all();
-
   PreservedAnalyses PA;
+  if (EnableMemorySSA) {
+    MemorySSA &MSSA = AM.getResult<MemorySSAAnalysis>(F).getMSSA();
+    PostDominatorTree &PDT = AM.getResult<PostDominatorTreeAnalysis>(F);
+    if (!DSEMemorySSA(F, *AA, MSSA, *DT, PDT, *TLI).run())
+      return PreservedAnalyses::all();
+    PA.preserve<MemorySSAAnalysis>();
+  } else {
+    MemoryDependenceResults *MD = &AM.getResult<MemoryDependenceAnalysis>(F);
+    if (!eliminateDeadStores(F, AA, MD, DT, TLI))
+      return PreservedAnalyses::all();
+    PA.preserve<MemoryDependenceAnalysis>();
+  }
+
   PA.preserveSet<CFGAnalyses>();
   PA.preserve<GlobalsAA>();
-  PA.preserve<MemoryDependenceAnalysis>();
   return PA;
 }
 
@@ -1358,11 +1611,18 @@ public:
 
     DominatorTree *DT = &getAnalysis<DominatorTreeWrapperPass>().getDomTree();
     AliasAnalysis *AA = &getAnalysis<AAResultsWrapperPass>().getAAResults();
-    MemoryDependenceResults *MD =
-        &getAnalysis<MemoryDependenceWrapperPass>().getMemDep();
     const TargetLibraryInfo *TLI =
         &getAnalysis<TargetLibraryInfoWrapperPass>().getTLI(F);
 
+    if (EnableMemorySSA) {
+      MemorySSA &MSSA = getAnalysis<MemorySSAWrapperPass>().getMSSA();
+      PostDominatorTree &PDT =
+          getAnalysis<PostDominatorTreeWrapperPass>().getPostDomTree();
+      return DSEMemorySSA(F, *AA, MSSA, *DT, PDT, *TLI).run();
+    }
+
+    MemoryDependenceResults *MD =
+        &getAnalysis<MemoryDependenceWrapperPass>().getMemDep();
     return eliminateDeadStores(F, AA, MD, DT, TLI);
   }
 
@@ -1370,11 +1630,18 @@ public:
     AU.setPreservesCFG();
     AU.addRequired<DominatorTreeWrapperPass>();
     AU.addRequired<AAResultsWrapperPass>();
-    AU.addRequired<MemoryDependenceWrapperPass>();
     AU.addRequired<TargetLibraryInfoWrapperPass>();
     AU.addPreserved<DominatorTreeWrapperPass>();
     AU.addPreserved<GlobalsAAWrapperPass>();
-    AU.addPreserved<MemoryDependenceWrapperPass>();
+    if (EnableMemorySSA) {
+      AU.addRequired<MemorySSAWrapperPass>();
+      AU.addRequired<PostDominatorTreeWrapperPass>();
+      AU.addPreserved<MemorySSAWrapperPass>();
+      AU.addPreserved<PostDominatorTreeWrapperPass>();
+    } else {
+      AU.addRequired<MemoryDependenceWrapperPass>();
+      AU.addPreserved<MemoryDependenceWrapperPass>();
+    }
   }
 };
 
@@ -1388,6 +1655,8 @@ INITIALIZE_PASS_DEPENDENCY(DominatorTreeWrapperPass)
 INITIALIZE_PASS_DEPENDENCY(AAResultsWrapperPass)
 INITIALIZE_PASS_DEPENDENCY(GlobalsAAWrapperPass)
 INITIALIZE_PASS_DEPENDENCY(MemoryDependenceWrapperPass)
+INITIALIZE_PASS_DEPENDENCY(MemorySSAWrapperPass)
+INITIALIZE_PASS_DEPENDENCY(PostDominatorTreeWrapperPass)
 INITIALIZE_PASS_DEPENDENCY(TargetLibraryInfoWrapperPass)
 INITIALIZE_PASS_END(DSELegacyPass, "dse", "Dead Store Elimination", false,
                     false)
@@ -35,6 +35,8 @@
 #include "llvm/Analysis/LoopInfo.h"
 #include "llvm/Analysis/MemoryBuiltins.h"
 #include "llvm/Analysis/MemoryDependenceAnalysis.h"
+#include "llvm/Analysis/MemorySSA.h"
+#include "llvm/Analysis/MemorySSAUpdater.h"
 #include "llvm/Analysis/OptimizationRemarkEmitter.h"
 #include "llvm/Analysis/PHITransAddr.h"
 #include "llvm/Analysis/TargetLibraryInfo.h"
@@ -100,6 +102,10 @@ static cl::opt<bool> EnablePRE("enable-pre",
                                cl::init(true), cl::Hidden);
 static cl::opt<bool> EnableLoadPRE("enable-load-pre", cl::init(true));
 static cl::opt<bool> EnableMemDep("enable-gvn-memdep", cl::init(true));
+static cl::opt<bool> EnableMemorySSA(
+    "enable-gvn-memoryssa", cl::init(false), cl::Hidden,
+    cl::desc("Find the dependencies of loads with MemorySSA instead of "
+             "MemoryDependenceAnalysis"));
 
 // Maximum allowed recursion depth.
 static cl::opt<uint32_t>
@@ -110,6 +116,11 @@ static cl::opt<uint32_t> MaxNumDeps(
     "gvn-max-num-deps", cl::Hidden, cl::init(100), cl::ZeroOrMore,
     cl::desc("Max number of dependences to attempt Load PRE (default = 100)"));
 
+static cl::opt<unsigned> MemorySSAScanLimit(
+    "gvn-memoryssa-scan-limit", cl::Hidden, cl::init(100), cl::ZeroOrMore,
+    cl::desc("Max number of MemorySSA accesses to look at when finding the "
+             "dependence of a load (default = 100)"));
+
 struct llvm::GVN::Expression {
   uint32_t opcode;
   Type *type;
@@ -617,10 +628,15 @@ PreservedAnalyses GVN::run(Function &F, FunctionAnalysisManager &AM) {
   auto &DT = AM.getResult<DominatorTreeAnalysis>(F);
   auto &TLI = AM.getResult<TargetLibraryAnalysis>(F);
   auto &AA = AM.getResult<AAManager>(F);
-  auto &MemDep = AM.getResult<MemoryDependenceAnalysis>(F);
+  MemoryDependenceResults *MemDep = nullptr;
+  MemorySSA *MSSA = nullptr;
+  if (EnableMemorySSA)
+    MSSA = &AM.getResult<MemorySSAAnalysis>(F).getMSSA();
+  else
+    MemDep = &AM.getResult<MemoryDependenceAnalysis>(F);
   auto *LI = AM.getCachedResult<LoopAnalysis>(F);
   auto &ORE = AM.getResult<OptimizationRemarkEmitterAnalysis>(F);
-  bool Changed = runImpl(F, AC, DT, TLI, AA, &MemDep, LI, &ORE);
+  bool Changed = runImpl(F, AC, DT, TLI, AA, MemDep, LI, &ORE, MSSA);
   if (!Changed)
     return PreservedAnalyses::all();
   PreservedAnalyses PA;
@@ -629,6 +645,8 @@ PreservedAnalyses GVN::run(Function &F, FunctionAnalysisManager &AM) {
   PA.preserve<TargetLibraryAnalysis>();
   if (LI)
     PA.preserve<LoopAnalysis>();
+  if (MSSA)
+    PA.preserve<MemorySSAAnalysis>();
   return PA;
 }
 
@@ -794,7 +812,8 @@ Value *AvailableValue::MaterializeAdjustedValue(LoadInst *LI,
       // tracks.  It is potentially possible to remove the load from the table,
       // but then there all of the operations based on it would need to be
       // rehashed.  Just leave the dead load around.
-      gvn.getMemDep().removeInstruction(Load);
+      if (!gvn.getMemorySSA())
+        gvn.getMemDep().removeInstruction(Load);
       LLVM_DEBUG(dbgs() << "GVN COERCED NONLOCAL LOAD:\nOffset: " << Offset
                         << "  " << *getCoercedLoadValue() << '\n'
                         << *Res << '\n'
@@ -1021,6 +1040,147 @@ void GVN::AnalyzeLoadAvailability(LoadInst *LI, LoadDepVect &Deps,
          "post condition violation");
 }
 
+MemDepResult GVN::getMemorySSADependency(LoadInst *LI, MemoryAccess *&Clobber,
+                                         Value *Address,
+                                         Instruction *InsertPt) {
+  const DataLayout &DL = LI->getModule()->getDataLayout();
+  AliasAnalysis *AA = getAliasAnalysis();
+  MemoryLocation Loc = MemoryLocation::get(LI).getWithNewPtr(Address);
+  unsigned NumAccesses = 0;
+  for (;; Clobber = cast<MemoryDef>(Clobber)->getDefiningAccess()) {
+    if (++NumAccesses > MemorySSAScanLimit) {
+      Clobber = nullptr;
+      return MemDepResult::getUnknown();
+    }
+
+    // A load of the same address after the access reads the value the query
+    // would, like the loads MemDep stops at.
+    unsigned NumUsers = 0;
+    for (User *U : Clobber->users()) {
+      if (++NumUsers > MemorySSAScanLimit)
+        break;
+      auto *Use = dyn_cast<MemoryUse>(U);
+      if (!Use)
+        continue;
+      auto *DepLI = dyn_cast<LoadInst>(Use->getMemoryInst());
+      if (DepLI && DepLI->isUnordered() &&
+          DepLI->getPointerOperand() == Address &&
+          DT->dominates(DepLI, InsertPt))
+        return MemDepResult::getDef(DepLI);
+    }
+
+    if (MSSA->isLiveOnEntryDef(Clobber)) {
+      // Nothing writes the memory of a local variable before the load.
+      if (auto *AI = dyn_cast<AllocaInst>(GetUnderlyingObject(Address, DL)))
+        return MemDepResult::getDef(AI);
+      return MemDepResult::getNonFuncLocal();
+    }
+    if (isa<MemoryPhi>(Clobber))
+      return MemDepResult::getNonLocal();
+
+    // Skip the defs that don't write the location. Like MemDep, let calls
+    // pass objects that are not captured before them, which MemorySSA
+    // doesn't.
+    Instruction *DefInst = cast<MemoryDef>(Clobber)->getMemoryInst();
+    ModRefInfo MR = AA->getModRefInfo(DefInst, Loc);
+    if (isModSet(MR) && isa<CallBase>(DefInst))
+      MR = AA->callCapturesBefore(DefInst, Loc, DT);
+    if (isModSet(MR))
+      break;
+  }
+
+  Instruction *DefInst = cast<MemoryDef>(Clobber)->getMemoryInst();
+  if (auto *SI = dyn_cast<StoreInst>(DefInst))
+    return AA->alias(MemoryLocation::get(SI), Loc) == MustAlias
+               ? MemDepResult::getDef(SI)
+               : MemDepResult::getClobber(SI);
+  if (isNoAliasFn(DefInst, TLI) && GetUnderlyingObject(Address, DL) == DefInst)
+    return MemDepResult::getDef(DefInst);
+  if (isLifetimeStart(DefInst) &&
+      AA->isMustAlias(cast<IntrinsicInst>(DefInst)->getArgOperand(1), Address))
+    return MemDepResult::getDef(DefInst);
+
+  // Ordered loads are defs in MemorySSA, but there is nothing to forward from
+  // them.
+  if (isa<LoadInst>(DefInst))
+    return MemDepResult::getUnknown();
+  return MemDepResult::getClobber(DefInst);
+}
+
+bool GVN::getMemorySSANonLocalDependencies(LoadInst *LI, LoadDepVect &Deps) {
+  const DataLayout &DL = LI->getModule()->getDataLayout();
+  BasicBlock *LoadBB = LI->getParent();
+  Value *Address = LI->getPointerOperand();
+
+  // The blocks to find the dependence at the end of, with the address loaded
+  // there. The address is PHI translated into the predecessors of the load's
+  // block, and must be the same further up.
+  SmallVector<std::pair<BasicBlock *, Value *>, 8> Worklist;
+  SmallDenseMap<BasicBlock *, Value *, 16> Visited;
+  SmallPtrSet<MemoryPhi *, 4> VisitedPhis;
+  for (BasicBlock *Pred : predecessors(LoadBB)) {
+    PHITransAddr Translator(Address, DL, AC);
+    Value *PredAddress = Translator.PHITranslateValue(LoadBB, Pred, DT,
+                                                      /*MustDominate=*/false)
+                             ? nullptr
+                             : Translator.getAddr();
+    Worklist.push_back({Pred, PredAddress});
+  }
+
+  while (!Worklist.empty()) {
+    BasicBlock *BB;
+    Value *BBAddress;
+    std::tie(BB, BBAddress) = Worklist.pop_back_val();
+    // Like MemDep, leave out unreachable blocks.
+    if (!DT->isReachableFromEntry(BB))
+      continue;
+    auto Inserted = Visited.insert({BB, BBAddress});
+    if (!Inserted.second) {
+      // Reaching a block with two different addresses is a PHI translation
+      // conflict, like in MemDep.
+      if (Inserted.first->second != BBAddress)
+        return false;
+      continue;
+    }
+    if (Visited.size() > MaxNumDeps)
+      return false;
+
+    if (!BBAddress) {
+      Deps.push_back(
+          NonLocalDepResult(BB, MemDepResult::getUnknown(), Address));
+      continue;
+    }
+
+    // The memory state at the end of the block is the last access of the
+    // closest dominating block that has any.
+    MemoryAccess *Clobber = MSSA->getLiveOnEntryDef();
+    for (DomTreeNode *N = DT->getNode(BB); N; N = N->getIDom())
+      if (auto *Defs = MSSA->getBlockDefs(N->getBlock())) {
+        Clobber = const_cast<MemoryAccess *>(&Defs->back());
+        break;
+      }
+
+    MemDepResult Dep = getMemorySSADependency(LI, Clobber, BBAddress,
+                                              BB->getTerminator());
+
+    // Continue into the predecessors of a MemoryPhi if the address is
+    // available above it.
+    if (Dep.isNonLocal()) {
+      auto *Phi = cast<MemoryPhi>(Clobber);
+      auto *AddrInst = dyn_cast<Instruction>(BBAddress);
+      if (!AddrInst ||
+          DT->properlyDominates(AddrInst->getParent(), Phi->getBlock())) {
+        if (VisitedPhis.insert(Phi).second)
+          for (BasicBlock *Pred : predecessors(Phi->getBlock()))
+            Worklist.push_back({Pred, BBAddress});
+        continue;
+      }
+    }
+    Deps.push_back(NonLocalDepResult(BB, Dep, BBAddress));
+  }
+  return true;
+}
+
 bool GVN::PerformLoadPRE(LoadInst *LI, AvailValInBlkVect &ValuesPerBlock,
                          UnavailBlkVect &UnavailableBlocks) {
   // Okay, we have *some* definitions of the value.  This means that the value
@@ -1269,7 +1429,17 @@ bool GVN::PerformLoadPRE(LoadInst *LI, AvailValInBlkVect &ValuesPerBlock,
     // Add the newly created load.
     ValuesPerBlock.push_back(AvailableValueInBlock::get(UnavailablePred,
                                                         NewLoad));
-    MD->invalidateCachedPointerInfo(LoadPtr);
+    if (MSSAU) {
+      // The inserted load reads the same memory as the original one; the
+      // updater finds its defining access in the predecessor.
+      MemoryAccess *LIAccess = MSSA->getMemoryAccess(LI);
+      MemoryAccess *NewAccess = MSSAU->createMemoryAccessInBB(
+          NewLoad, cast<MemoryUse>(LIAccess)->getDefiningAccess(),
+          UnavailablePred, MemorySSA::End);
+      MSSAU->insertUse(cast<MemoryUse>(NewAccess), /*RenameUses=*/true);
+    } else {
+      MD->invalidateCachedPointerInfo(LoadPtr);
+    }
     LLVM_DEBUG(dbgs() << "GVN INSERTED " << *NewLoad << '\n');
   }
 
@@ -1280,7 +1450,7 @@ bool GVN::PerformLoadPRE(LoadInst *LI, AvailValInBlkVect &ValuesPerBlock,
     V->takeName(LI);
   if (Instruction *I = dyn_cast<Instruction>(V))
     I->setDebugLoc(LI->getDebugLoc());
-  if (V->getType()->isPtrOrPtrVectorTy())
+  if (MD && V->getType()->isPtrOrPtrVectorTy())
     MD->invalidateCachedPointerInfo(V);
   markInstructionForDeletion(LI);
   ORE->emit([&]() {
@@ -1315,7 +1485,12 @@ bool GVN::processNonLocalLoad(LoadInst *LI) {
 
   // Step 1: Find the non-local dependencies of the load.
   LoadDepVect Deps;
-  MD->getNonLocalPointerDependency(LI, Deps);
+  if (MSSA) {
+    if (!getMemorySSANonLocalDependencies(LI, Deps))
+      return false;
+  } else {
+    MD->getNonLocalPointerDependency(LI, Deps);
+  }
 
   // If we had to process more than one hundred blocks to find the
   // dependencies, this load isn't worth worrying about.  Optimizing
@@ -1372,7 +1547,7 @@ bool GVN::processNonLocalLoad(LoadInst *LI) {
       // to propagate LI's DebugLoc because LI may not post-dominate I.
       if (LI->getDebugLoc() && LI->getParent() == I->getParent())
         I->setDebugLoc(LI->getDebugLoc());
-    if (V->getType()->isPtrOrPtrVectorTy())
+    if (MD && V->getType()->isPtrOrPtrVectorTy())
       MD->invalidateCachedPointerInfo(V);
     markInstructionForDeletion(LI);
     ++NumGVNLoad;
@@ -1406,9 +1581,25 @@ bool GVN::processAssumeIntrinsic(IntrinsicInst *IntrinsicI) {
       // Insert a new store to null instruction before the load to indicate that
       // this code is not reachable.  FIXME: We could insert unreachable
       // instruction directly because we can modify the CFG.
-      new StoreInst(UndefValue::get(Int8Ty),
-                    Constant::getNullValue(Int8Ty->getPointerTo()),
-                    IntrinsicI);
+      auto *NewS = new StoreInst(UndefValue::get(Int8Ty),
+                                 Constant::getNullValue(Int8Ty->getPointerTo()),
+                                 IntrinsicI);
+      if (MSSAU) {
+        // Give the store its MemoryDef in front of the next access in the
+        // block. The code is unreachable, so nothing needs to be renamed.
+        MemoryAccess *LiveOnEntry = MSSA->getLiveOnEntryDef();
+        MemoryUseOrDef *NextAccess = nullptr;
+        for (Instruction *I = NewS->getNextNode(); I && !NextAccess;
+             I = I->getNextNode())
+          NextAccess = MSSA->getMemoryAccess(I);
+        MemoryAccess *NewDef =
+            NextAccess
+                ? MSSAU->createMemoryAccessBefore(NewS, LiveOnEntry, NextAccess)
+                : MSSAU->createMemoryAccessInBB(NewS, LiveOnEntry,
+                                                NewS->getParent(),
+                                                MemorySSA::End);
+        MSSAU->insertDef(cast<MemoryDef>(NewDef), /*RenameUses=*/false);
+      }
     }
     markInstructionForDeletion(IntrinsicI);
     return false;
@@ -1514,7 +1705,7 @@ static void patchAndReplaceAllUsesWith(Instruction *I, Value *Repl) {
 /// Attempt to eliminate a load, first by eliminating it
 /// locally, and then attempting non-local elimination if that fails.
 bool GVN::processLoad(LoadInst *L) {
-  if (!MD)
+  if (!MD && !MSSA)
     return false;
 
   // This code hasn't been audited for ordered or volatile memory access
@@ -1527,7 +1718,18 @@ bool GVN::processLoad(LoadInst *L) {
   }
 
   // ... to a pointer that has been loaded from before...
-  MemDepResult Dep = MD->getDependency(L);
+  MemDepResult Dep;
+  // Unlike MemDep, MemorySSA can find the dependence in a dominating block.
+  // If that doesn't give the value, still try the predecessors.
+  bool TryNonLocal = false;
+  if (MSSA) {
+    MemoryAccess *Clobber = MSSA->getWalker()->getClobberingMemoryAccess(L);
+    Dep = getMemorySSADependency(L, Clobber, L->getPointerOperand(), L);
+    TryNonLocal = Clobber && (MSSA->isLiveOnEntryDef(Clobber) ||
+                              Clobber->getBlock() != L->getParent());
+  } else {
+    Dep = MD->getDependency(L);
+  }
 
   // If it is defined in another block, try harder.
   if (Dep.isNonLocal())
@@ -1540,7 +1742,7 @@ bool GVN::processLoad(LoadInst *L) {
         // fast print dep, using operator<< on instruction is too slow.
         dbgs() << "GVN: load "; L->printAsOperand(dbgs());
         dbgs() << " has unknown dependence\n";);
-    return false;
+    return TryNonLocal && processNonLocalLoad(L);
   }
 
   AvailableValue AV;
@@ -1559,7 +1761,7 @@ bool GVN::processLoad(LoadInst *L) {
     return true;
   }
 
-  return false;
+  return TryNonLocal && processNonLocalLoad(L);
 }
 
 /// Return a pair the first field showing the value number of \p Exp and the
@@ -2079,13 +2281,16 @@ bool GVN::processInstruction(Instruction *I) {
 bool GVN::runImpl(Function &F, AssumptionCache &RunAC, DominatorTree &RunDT,
                   const TargetLibraryInfo &RunTLI, AAResults &RunAA,
                   MemoryDependenceResults *RunMD, LoopInfo *LI,
-                  OptimizationRemarkEmitter *RunORE) {
+                  OptimizationRemarkEmitter *RunORE, MemorySSA *RunMSSA) {
   AC = &RunAC;
   DT = &RunDT;
   VN.setDomTree(DT);
   TLI = &RunTLI;
   VN.setAliasAnalysis(&RunAA);
   MD = RunMD;
+  MSSA = RunMSSA;
+  MemorySSAUpdater Updater(MSSA);
+  MSSAU = MSSA ? &Updater : nullptr;
   ImplicitControlFlowTracking ImplicitCFT(DT);
   ICF = &ImplicitCFT;
   this->LI = LI;
@@ -2102,7 +2307,7 @@ bool GVN::runImpl(Function &F, AssumptionCache &RunAC, DominatorTree &RunDT,
   for (Function::iterator FI = F.begin(), FE = F.end(); FI != FE; ) {
     BasicBlock *BB = &*FI++;
 
-    bool removedBlock = MergeBlockIntoPredecessor(BB, &DTU, LI, nullptr, MD);
+    bool removedBlock = MergeBlockIntoPredecessor(BB, &DTU, LI, MSSAU, MD);
     if (removedBlock)
       ++NumGVNBlocks;
 
@@ -2138,6 +2343,10 @@ bool GVN::runImpl(Function &F, AssumptionCache &RunAC, DominatorTree &RunDT,
   // iteration.
   DeadBlocks.clear();
 
+  if (MSSA && VerifyMemorySSA)
+    MSSA->verifyMemorySSA();
+  MSSAU = nullptr;
+
   return Changed;
 }
 
@@ -2177,6 +2386,8 @@ bool GVN::processBlock(BasicBlock *BB) {
       LLVM_DEBUG(dbgs() << "GVN removed: " << *I << '\n');
       salvageDebugInfo(*I);
       if (MD) MD->removeInstruction(I);
+      if (MSSAU)
+        MSSAU->removeMemoryAccess(I);
       LLVM_DEBUG(verifyRemoved(I));
       ICF->removeInstruction(I);
       I->eraseFromParent();
@@ -2407,6 +2618,8 @@ bool GVN::performScalarPRE(Instruction *CurInst) {
   LLVM_DEBUG(dbgs() << "GVN PRE removed: " << *CurInst << '\n');
   if (MD)
     MD->removeInstruction(CurInst);
+  if (MSSAU)
+    MSSAU->removeMemoryAccess(CurInst);
   LLVM_DEBUG(verifyRemoved(CurInst));
   // FIXME: Intended to be markInstructionForDeletion(CurInst), but it causes
   // some assertion failures.
@@ -2447,8 +2660,8 @@ bool GVN::performPRE(Function &F) {
 /// Split the critical edge connecting the given two blocks, and return
 /// the block inserted to the critical edge.
 BasicBlock *GVN::splitCriticalEdges(BasicBlock *Pred, BasicBlock *Succ) {
-  BasicBlock *BB =
-      SplitCriticalEdge(Pred, Succ, CriticalEdgeSplittingOptions(DT, LI));
+  BasicBlock *BB = SplitCriticalEdge(
+      Pred, Succ, CriticalEdgeSplittingOptions(DT, LI, MSSAU));
   if (MD)
     MD->invalidateCachedPredecessors();
   InvalidBlockRPONumbers = true;
@@ -2463,7 +2676,7 @@ bool GVN::splitCriticalEdges() {
   do {
     std::pair<Instruction *, unsigned> Edge = toSplit.pop_back_val();
     SplitCriticalEdge(Edge.first, Edge.second,
-                      CriticalEdgeSplittingOptions(DT, LI));
+                      CriticalEdgeSplittingOptions(DT, LI, MSSAU));
   } while (!toSplit.empty());
   if (MD) MD->invalidateCachedPredecessors();
   InvalidBlockRPONumbers = true;
@@ -2667,11 +2880,14 @@ public:
         getAnalysis<DominatorTreeWrapperPass>().getDomTree(),
         getAnalysis<TargetLibraryInfoWrapperPass>().getTLI(F),
         getAnalysis<AAResultsWrapperPass>().getAAResults(),
-        NoMemDepAnalysis
+        NoMemDepAnalysis || EnableMemorySSA
             ? nullptr
             : &getAnalysis<MemoryDependenceWrapperPass>().getMemDep(),
         LIWP ? &LIWP->getLoopInfo() : nullptr,
-        &getAnalysis<OptimizationRemarkEmitterWrapperPass>().getORE());
+        &getAnalysis<OptimizationRemarkEmitterWrapperPass>().getORE(),
+        !NoMemDepAnalysis && EnableMemorySSA
+            ? &getAnalysis<MemorySSAWrapperPass>().getMSSA()
+            : nullptr);
   }
 
   void getAnalysisUsage(AnalysisUsage &AU) const override {
@@ -2679,8 +2895,12 @@ public:
     AU.addRequired<DominatorTreeWrapperPass>();
     AU.addRequired<TargetLibraryInfoWrapperPass>();
     AU.addRequired<LoopInfoWrapperPass>();
-    if (!NoMemDepAnalysis)
-      AU.addRequired<MemoryDependenceWrapperPass>();
+    if (!NoMemDepAnalysis) {
+      if (EnableMemorySSA)
+        AU.addRequired<MemorySSAWrapperPass>();
+      else
+        AU.addRequired<MemoryDependenceWrapperPass>();
+    }
     AU.addRequired<AAResultsWrapperPass>();
 
     AU.addPreserved<DominatorTreeWrapperPass>();
@@ -2688,6 +2908,8 @@ public:
     AU.addPreserved<TargetLibraryInfoWrapperPass>();
     AU.addPreserved<LoopInfoWrapperPass>();
     AU.addPreservedID(LoopSimplifyID);
+    if (!NoMemDepAnalysis && EnableMemorySSA)
+      AU.addPreserved<MemorySSAWrapperPass>();
     AU.addRequired<OptimizationRemarkEmitterWrapperPass>();
   }
 
@@ -2701,6 +2923,7 @@ char GVNLegacyPass::ID = 0;
 INITIALIZE_PASS_BEGIN(GVNLegacyPass, "gvn", "Global Value Numbering", false, false)
 INITIALIZE_PASS_DEPENDENCY(AssumptionCacheTracker)
 INITIALIZE_PASS_DEPENDENCY(MemoryDependenceWrapperPass)
+INITIALIZE_PASS_DEPENDENCY(MemorySSAWrapperPass)
 INITIALIZE_PASS_DEPENDENCY(DominatorTreeWrapperPass)
 INITIALIZE_PASS_DEPENDENCY(TargetLibraryInfoWrapperPass)
 INITIALIZE_PASS_DEPENDENCY(AAResultsWrapperPass)
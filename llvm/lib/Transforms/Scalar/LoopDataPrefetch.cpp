@@ -24,15 +24,20 @@
 #include "llvm/Analysis/ScalarEvolutionExpressions.h"
 #include "llvm/Analysis/TargetTransformInfo.h"
 #include "llvm/IR/CFG.h"
+#include "llvm/IR/DiagnosticInfo.h"
+#include "llvm/IR/DebugInfoMetadata.h"
 #include "llvm/IR/Dominators.h"
 #include "llvm/IR/Function.h"
 #include "llvm/IR/Module.h"
+#include "llvm/ProfileData/SampleProf.h"
+#include "llvm/ProfileData/SampleProfReader.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Transforms/Scalar.h"
 #include "llvm/Transforms/Utils/BasicBlockUtils.h"
 #include "llvm/Transforms/Utils/ValueMapper.h"
 using namespace llvm;
+using namespace sampleprof;
 
 // By default, we limit this to creating 16 PHIs (which is a little over half
 // of the allocatable register set).
@@ -53,23 +58,60 @@ static cl::opt<unsigned> MaxPrefetchIterationsAhead(
     "max-prefetch-iters-ahead",
     cl::desc("Max number of iterations to prefetch ahead"), cl::Hidden);
 
+/// Cache miss profile, in one of the sample profile formats. The sampled cache
+/// misses of a memory access are recorded as the count of the call target
+/// FunctionSamples::getCacheMissTargetName() at the location of the access.
+cl::opt<std::string> PrefetchMissProfile(
+    "loop-prefetch-miss-profile", cl::Hidden,
+    cl::desc("Only prefetch the accesses that miss in the cache according to "
+             "this profile, including the indirect and pointer chasing ones"));
+
+static cl::opt<unsigned> MinPrefetchMisses(
+    "min-prefetch-misses", cl::init(1), cl::Hidden,
+    cl::desc("Min number of sampled cache misses of an access to prefetch it "
+             "with a cache miss profile"));
+
+// The defaults for targets that don't enable prefetching, used when a miss
+// profile asks for prefetches.
+static const unsigned DefaultMissPrefetchDistance = 256;
+static const unsigned DefaultCacheLineSize = 64;
+
 STATISTIC(NumPrefetches, "Number of prefetches inserted");
+STATISTIC(NumIndirectPrefetches, "Number of indirect access prefetches inserted");
+STATISTIC(NumPointerChasePrefetches,
+          "Number of pointer chasing prefetches inserted");
 
 namespace {
 
 /// Loop prefetch implementation class.
 class LoopDataPrefetch {
 public:
-  LoopDataPrefetch(AssumptionCache *AC, LoopInfo *LI, ScalarEvolution *SE,
-                   const TargetTransformInfo *TTI,
-                   OptimizationRemarkEmitter *ORE)
-      : AC(AC), LI(LI), SE(SE), TTI(TTI), ORE(ORE) {}
+  LoopDataPrefetch(AssumptionCache *AC, DominatorTree *DT, LoopInfo *LI,
+                   ScalarEvolution *SE, const TargetTransformInfo *TTI,
+                   OptimizationRemarkEmitter *ORE,
+                   const FunctionSamples *MissSamples)
+      : AC(AC), DT(DT), LI(LI), SE(SE), TTI(TTI), ORE(ORE),
+        MissSamples(MissSamples) {}
 
   bool run();
 
 private:
   bool runOnLoop(Loop *L);
 
+  /// Returns the number of sampled cache misses of \p MemI in the profile.
+  uint64_t getCacheMisses(const Instruction *MemI) const;
+
+  /// Prefetch a missing access \p MemI of \p L to a location \p PtrSCEV that
+  /// isn't strided: a pointer chasing access at an offset from a pointer
+  /// loaded in the previous iteration, or an indirect access through a strided
+  /// load, prefetched \p ItersAhead iterations ahead.
+  bool prefetchIrregularAccess(Loop *L, Instruction *MemI,
+                               const SCEV *PtrSCEV, unsigned ItersAhead);
+
+  /// Insert a prefetch of \p PrefAddr for \p MemI before \p InsertPt.
+  void insertPrefetch(const SCEV *PrefAddr, Instruction *MemI,
+                      Instruction *InsertPt);
+
   /// Check if the stride of the accesses is large enough to
   /// warrant a prefetch.
   bool isStrideLargeEnough(const SCEVAddRecExpr *AR);
@@ -83,7 +125,17 @@ private:
   unsigned getPrefetchDistance() {
     if (PrefetchDistance.getNumOccurrences() > 0)
       return PrefetchDistance;
-    return TTI->getPrefetchDistance();
+    unsigned Distance = TTI->getPrefetchDistance();
+    if (!Distance && MissSamples)
+      return DefaultMissPrefetchDistance;
+    return Distance;
+  }
+
+  unsigned getCacheLineSize() {
+    unsigned Size = TTI->getCacheLineSize();
+    if (!Size && MissSamples)
+      return DefaultCacheLineSize;
+    return Size;
   }
 
   unsigned getMaxPrefetchIterationsAhead() {
@@ -93,10 +145,14 @@ private:
   }
 
   AssumptionCache *AC;
+  DominatorTree *DT;
   LoopInfo *LI;
   ScalarEvolution *SE;
   const TargetTransformInfo *TTI;
   OptimizationRemarkEmitter *ORE;
+  /// The cache misses of the function, if there is a miss profile. Only the
+  /// accesses it shows missing are prefetched then.
+  const FunctionSamples *MissSamples;
 };
 
 /// Legacy class for inserting loop data prefetches.
@@ -109,6 +165,7 @@ public:
 
   void getAnalysisUsage(AnalysisUsage &AU) const override {
     AU.addRequired<AssumptionCacheTracker>();
+    AU.addRequired<DominatorTreeWrapperPass>();
     AU.addPreserved<DominatorTreeWrapperPass>();
     AU.addRequired<LoopInfoWrapperPass>();
     AU.addPreserved<LoopInfoWrapperPass>();
@@ -118,7 +175,11 @@ public:
     AU.addRequired<TargetTransformInfoWrapperPass>();
   }
 
+  bool doInitialization(Module &M) override;
   bool runOnFunction(Function &F) override;
+
+private:
+  std::unique_ptr<SampleProfileReader> MissProfile;
   };
 }
 
@@ -126,6 +187,7 @@ char LoopDataPrefetchLegacyPass::ID = 0;
 INITIALIZE_PASS_BEGIN(LoopDataPrefetchLegacyPass, "loop-data-prefetch",
                       "Loop Data Prefetch", false, false)
 INITIALIZE_PASS_DEPENDENCY(AssumptionCacheTracker)
+INITIALIZE_PASS_DEPENDENCY(DominatorTreeWrapperPass)
 INITIALIZE_PASS_DEPENDENCY(TargetTransformInfoWrapperPass)
 INITIALIZE_PASS_DEPENDENCY(LoopInfoWrapperPass)
 INITIALIZE_PASS_DEPENDENCY(OptimizationRemarkEmitterWrapperPass)
@@ -153,16 +215,50 @@ bool LoopDataPrefetch::isStrideLargeEnough(const SCEVAddRecExpr *AR) {
   return TargetMinStride <= AbsStride;
 }
 
+/// Reads the cache miss profile of -loop-prefetch-miss-profile, if any.
+static std::unique_ptr<SampleProfileReader> readMissProfile(LLVMContext &Ctx) {
+  if (PrefetchMissProfile.empty())
+    return nullptr;
+  ErrorOr<std::unique_ptr<SampleProfileReader>> ReaderOrErr =
+      SampleProfileReader::create(PrefetchMissProfile, Ctx);
+  if (std::error_code EC = ReaderOrErr.getError()) {
+    std::string Msg = "Could not open profile: " + EC.message();
+    Ctx.diagnose(DiagnosticInfoSampleProfile(PrefetchMissProfile, Msg,
+                                             DiagnosticSeverity::DS_Warning));
+    return nullptr;
+  }
+  std::unique_ptr<SampleProfileReader> Reader = std::move(ReaderOrErr.get());
+  if (std::error_code EC = Reader->read()) {
+    std::string Msg = "Could not read profile: " + EC.message();
+    Ctx.diagnose(DiagnosticInfoSampleProfile(PrefetchMissProfile, Msg,
+                                             DiagnosticSeverity::DS_Warning));
+    return nullptr;
+  }
+  return Reader;
+}
+
+LoopDataPrefetchPass::LoopDataPrefetchPass() = default;
+LoopDataPrefetchPass::LoopDataPrefetchPass(LoopDataPrefetchPass &&) = default;
+LoopDataPrefetchPass::~LoopDataPrefetchPass() = default;
+
 PreservedAnalyses LoopDataPrefetchPass::run(Function &F,
                                             FunctionAnalysisManager &AM) {
+  if (!MissProfileRead) {
+    MissProfile = readMissProfile(F.getContext());
+    MissProfileRead = true;
+  }
+
+  DominatorTree *DT = &AM.getResult<DominatorTreeAnalysis>(F);
   LoopInfo *LI = &AM.getResult<LoopAnalysis>(F);
   ScalarEvolution *SE = &AM.getResult<ScalarEvolutionAnalysis>(F);
   AssumptionCache *AC = &AM.getResult<AssumptionAnalysis>(F);
   OptimizationRemarkEmitter *ORE =
       &AM.getResult<OptimizationRemarkEmitterAnalysis>(F);
   const TargetTransformInfo *TTI = &AM.getResult<TargetIRAnalysis>(F);
+  const FunctionSamples *MissSamples =
+      MissProfile ? MissProfile->getSamplesFor(F) : nullptr;
 
-  LoopDataPrefetch LDP(AC, LI, SE, TTI, ORE);
+  LoopDataPrefetch LDP(AC, DT, LI, SE, TTI, ORE, MissSamples);
   bool Changed = LDP.run();
 
   if (Changed) {
@@ -175,10 +271,16 @@ PreservedAnalyses LoopDataPrefetchPass::run(Function &F,
   return PreservedAnalyses::all();
 }
 
+bool LoopDataPrefetchLegacyPass::doInitialization(Module &M) {
+  MissProfile = readMissProfile(M.getContext());
+  return false;
+}
+
 bool LoopDataPrefetchLegacyPass::runOnFunction(Function &F) {
   if (skipFunction(F))
     return false;
 
+  DominatorTree *DT = &getAnalysis<DominatorTreeWrapperPass>().getDomTree();
   LoopInfo *LI = &getAnalysis<LoopInfoWrapperPass>().getLoopInfo();
   ScalarEvolution *SE = &getAnalysis<ScalarEvolutionWrapperPass>().getSE();
   AssumptionCache *AC =
@@ -187,18 +289,21 @@ bool LoopDataPrefetchLegacyPass::runOnFunction(Function &F) {
       &getAnalysis<OptimizationRemarkEmitterWrapperPass>().getORE();
   const TargetTransformInfo *TTI =
       &getAnalysis<TargetTransformInfoWrapperPass>().getTTI(F);
+  const FunctionSamples *MissSamples =
+      MissProfile ? MissProfile->getSamplesFor(F) : nullptr;
 
-  LoopDataPrefetch LDP(AC, LI, SE, TTI, ORE);
+  LoopDataPrefetch LDP(AC, DT, LI, SE, TTI, ORE, MissSamples);
   return LDP.run();
 }
 
 bool LoopDataPrefetch::run() {
   // If PrefetchDistance is not set, don't run the pass.  This gives an
   // opportunity for targets to run this pass for selected subtargets only
-  // (whose TTI sets PrefetchDistance).
+  // (whose TTI sets PrefetchDistance). A miss profile enables it for the
+  // functions it has samples for.
   if (getPrefetchDistance() == 0)
     return false;
-  assert(TTI->getCacheLineSize() && "Cache line size is not set for target");
+  assert(getCacheLineSize() && "Cache line size is not set for target");
 
   bool MadeChange = false;
 
@@ -266,17 +371,27 @@ bool LoopDataPrefetch::runOnLoop(Loop *L) {
       if (PtrAddrSpace)
         continue;
 
+      // With a miss profile, only prefetch the accesses that miss.
+      if (MissSamples && getCacheMisses(MemI) < MinPrefetchMisses)
+        continue;
+
       if (L->isLoopInvariant(PtrValue))
         continue;
 
       const SCEV *LSCEV = SE->getSCEV(PtrValue);
       const SCEVAddRecExpr *LSCEVAddRec = dyn_cast<SCEVAddRecExpr>(LSCEV);
-      if (!LSCEVAddRec)
+      if (!LSCEVAddRec) {
+        // Accesses that aren't strided are only worth the overhead when the
+        // profile shows that they miss.
+        if (MissSamples)
+          MadeChange |= prefetchIrregularAccess(L, MemI, LSCEV, ItersAhead);
         continue;
+      }
 
       // Check if the stride of the accesses is large enough to warrant a
-      // prefetch.
-      if (!isStrideLargeEnough(LSCEVAddRec))
+      // prefetch. The accesses that miss according to the profile are always
+      // prefetched.
+      if (!MissSamples && !isStrideLargeEnough(LSCEVAddRec))
         continue;
 
       // We don't want to double prefetch individual cache lines. If this load
@@ -288,7 +403,7 @@ bool LoopDataPrefetch::runOnLoop(Loop *L) {
         if (const SCEVConstant *ConstPtrDiff =
             dyn_cast<SCEVConstant>(PtrDiff)) {
           int64_t PD = std::abs(ConstPtrDiff->getValue()->getSExtValue());
-          if (PD < (int64_t) TTI->getCacheLineSize()) {
+          if (PD < (int64_t) getCacheLineSize()) {
             DupPref = true;
             break;
           }
@@ -305,21 +420,7 @@ bool LoopDataPrefetch::runOnLoop(Loop *L) {
 
       PrefLoads.push_back(std::make_pair(MemI, LSCEVAddRec));
 
-      Type *I8Ptr = Type::getInt8PtrTy(BB->getContext(), PtrAddrSpace);
-      SCEVExpander SCEVE(*SE, I.getModule()->getDataLayout(), "prefaddr");
-      Value *PrefPtrValue = SCEVE.expandCodeFor(NextLSCEV, I8Ptr, MemI);
-
-      IRBuilder<> Builder(MemI);
-      Module *M = BB->getParent()->getParent();
-      Type *I32 = Type::getInt32Ty(BB->getContext());
-      Function *PrefetchFunc = Intrinsic::getDeclaration(
-          M, Intrinsic::prefetch, PrefPtrValue->getType());
-      Builder.CreateCall(
-          PrefetchFunc,
-          {PrefPtrValue,
-           ConstantInt::get(I32, MemI->mayReadFromMemory() ? 0 : 1),
-           ConstantInt::get(I32, 3), ConstantInt::get(I32, 1)});
-      ++NumPrefetches;
+      insertPrefetch(NextLSCEV, MemI, MemI);
       LLVM_DEBUG(dbgs() << "  Access: " << *PtrValue << ", SCEV: " << *LSCEV
                         << "\n");
       ORE->emit([&]() {
@@ -333,3 +434,140 @@ bool LoopDataPrefetch::runOnLoop(Loop *L) {
 
   return MadeChange;
 }
+
+uint64_t LoopDataPrefetch::getCacheMisses(const Instruction *MemI) const {
+  const DILocation *DIL = MemI->getDebugLoc();
+  if (!DIL)
+    return 0;
+  // The misses of inlined code are in the samples of its inline call chain.
+  const FunctionSamples *Samples = MissSamples->findFunctionSamples(DIL);
+  if (!Samples)
+    return 0;
+  return Samples->findCacheMissesAt(FunctionSamples::getOffset(DIL),
+                                    DIL->getBaseDiscriminator());
+}
+
+void LoopDataPrefetch::insertPrefetch(const SCEV *PrefAddr, Instruction *MemI,
+                                      Instruction *InsertPt) {
+  Type *I8Ptr = Type::getInt8PtrTy(MemI->getContext());
+  SCEVExpander SCEVE(*SE, MemI->getModule()->getDataLayout(), "prefaddr");
+  Value *PrefPtrValue = SCEVE.expandCodeFor(PrefAddr, I8Ptr, InsertPt);
+
+  IRBuilder<> Builder(InsertPt);
+  Module *M = MemI->getModule();
+  Type *I32 = Type::getInt32Ty(MemI->getContext());
+  Function *PrefetchFunc = Intrinsic::getDeclaration(
+      M, Intrinsic::prefetch, PrefPtrValue->getType());
+  Builder.CreateCall(
+      PrefetchFunc,
+      {PrefPtrValue,
+       ConstantInt::get(I32, MemI->mayReadFromMemory() ? 0 : 1),
+       ConstantInt::get(I32, 3), ConstantInt::get(I32, 1)});
+  ++NumPrefetches;
+}
+
+bool LoopDataPrefetch::prefetchIrregularAccess(Loop *L, Instruction *MemI,
+                                               const SCEV *PtrSCEV,
+                                               unsigned ItersAhead) {
+  BasicBlock *Latch = L->getLoopLatch();
+  if (!Latch || !isSafeToExpand(PtrSCEV, *SE))
+    return false;
+
+  // A pointer chasing access is at an invariant offset from a pointer
+  // phi, p = p->next. The address it accesses in the next iteration is known
+  // as soon as the pointer for the next iteration is loaded, so prefetch it
+  // from there.
+  const SCEV *Base = SE->getPointerBase(PtrSCEV);
+  if (auto *BaseUnknown = dyn_cast<SCEVUnknown>(Base)) {
+    auto *Phi = dyn_cast<PHINode>(BaseUnknown->getValue());
+    if (Phi && Phi->getParent() == L->getHeader()) {
+      auto *Next = dyn_cast<Instruction>(Phi->getIncomingValueForBlock(Latch));
+      if (!Next || !L->contains(Next) || isa<PHINode>(Next) ||
+          Next->isTerminator())
+        return false;
+      const SCEV *Offset = SE->getMinusSCEV(PtrSCEV, Base);
+      if (!SE->isLoopInvariant(Offset, L))
+        return false;
+      const SCEV *NextAddr = SE->getAddExpr(SE->getSCEV(Next), Offset);
+      if (!isSafeToExpand(NextAddr, *SE))
+        return false;
+
+      insertPrefetch(NextAddr, MemI, Next->getNextNode());
+      ++NumPointerChasePrefetches;
+      LLVM_DEBUG(dbgs() << "  Pointer chasing access: " << *MemI << "\n");
+      ORE->emit([&]() {
+        return OptimizationRemark(DEBUG_TYPE, "PrefetchedPointerChase", MemI)
+               << "prefetched pointer chasing memory access";
+      });
+      return true;
+    }
+  }
+
+  // An indirect access, A[B[i]], depends on a strided load in the loop. Load
+  // the index ItersAhead iterations ahead to prefetch the access. The ahead
+  // iteration is clamped to the last one, so that the index load only
+  // accesses locations the loop itself loads, which requires the index load
+  // to execute on every iteration.
+  struct FindLoopLoads {
+    Loop *L;
+    SmallSetVector<LoadInst *, 2> Loads;
+    bool follow(const SCEV *S) {
+      if (auto *U = dyn_cast<SCEVUnknown>(S))
+        if (auto *Load = dyn_cast<LoadInst>(U->getValue()))
+          if (L->contains(Load))
+            Loads.insert(Load);
+      return true;
+    }
+    bool isDone() const { return false; }
+  };
+  FindLoopLoads Finder{L, {}};
+  visitAll(PtrSCEV, Finder);
+  if (Finder.Loads.size() != 1)
+    return false;
+  LoadInst *IdxLoad = Finder.Loads.front();
+  if (!IdxLoad->isSimple() || L->getExitingBlock() != Latch ||
+      !DT->dominates(IdxLoad->getParent(), Latch))
+    return false;
+
+  auto *IdxAddr =
+      dyn_cast<SCEVAddRecExpr>(SE->getSCEV(IdxLoad->getPointerOperand()));
+  if (!IdxAddr || IdxAddr->getLoop() != L || !IdxAddr->isAffine())
+    return false;
+  const SCEV *BTC = SE->getBackedgeTakenCount(L);
+  if (isa<SCEVCouldNotCompute>(BTC))
+    return false;
+
+  Type *CountTy = BTC->getType();
+  const SCEV *Iteration = SE->getAddRecExpr(
+      SE->getZero(CountTy), SE->getOne(CountTy), L, SCEV::FlagAnyWrap);
+  const SCEV *AheadIteration = SE->getUMinExpr(
+      SE->getAddExpr(Iteration, SE->getConstant(CountTy, ItersAhead)), BTC);
+  const SCEV *Step = IdxAddr->getStepRecurrence(*SE);
+  const SCEV *AheadIdxAddr = SE->getAddExpr(
+      IdxAddr->getStart(),
+      SE->getMulExpr(SE->getTruncateOrZeroExtend(AheadIteration,
+                                                 Step->getType()),
+                     Step));
+  if (!isSafeToExpand(AheadIdxAddr, *SE))
+    return false;
+
+  SCEVExpander SCEVE(*SE, MemI->getModule()->getDataLayout(), "prefidxaddr");
+  Value *AheadIdxPtr = SCEVE.expandCodeFor(
+      AheadIdxAddr, IdxLoad->getPointerOperandType(), MemI);
+  IRBuilder<> Builder(MemI);
+  LoadInst *AheadIdx = Builder.CreateAlignedLoad(
+      IdxLoad->getType(), AheadIdxPtr, IdxLoad->getAlignment(), "prefidx");
+
+  ValueToValueMap RewriteMap;
+  RewriteMap[IdxLoad] = AheadIdx;
+  insertPrefetch(SCEVParameterRewriter::rewrite(PtrSCEV, *SE, RewriteMap),
+                 MemI, MemI);
+  ++NumIndirectPrefetches;
+  LLVM_DEBUG(dbgs() << "  Indirect access: " << *MemI << ", index: "
+                    << *IdxLoad << "\n");
+  ORE->emit([&]() {
+    return OptimizationRemark(DEBUG_TYPE, "PrefetchedIndirect", MemI)
+           << "prefetched indirect memory access";
+  });
+  return true;
+}
@@ -15,6 +15,7 @@
 #include "llvm/Transforms/Utils/SplitModule.h"
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/EquivalenceClasses.h"
+#include "llvm/ADT/MapVector.h"
 #include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/StringRef.h"
@@ -27,6 +28,7 @@
 #include "llvm/IR/GlobalIndirectSymbol.h"
 #include "llvm/IR/GlobalValue.h"
 #include "llvm/IR/GlobalVariable.h"
+#include "llvm/IR/InstrTypes.h"
 #include "llvm/IR/Instruction.h"
 #include "llvm/IR/Module.h"
 #include "llvm/IR/User.h"
@@ -91,12 +93,109 @@ static void addAllGlobalValueUsers(ClusterMapType &GVtoClusterMap,
   }
 }
 
+// Returns an estimate of the time it takes to generate code for GV.
+static uint64_t getCodeGenWeight(const GlobalValue *GV) {
+  if (const Function *F = dyn_cast<Function>(GV))
+    return std::max(1u, F->getInstructionCount());
+  return 1;
+}
+
+// Assigns every cluster in GVtoClusterMap to one of N partitions. Clusters that
+// call each other are merged first, as long as the result does not exceed the
+// average partition weight, so that callers and their callees tend to end up
+// in the same partition. The merged clusters are then packed into the
+// partitions heaviest first, each into the currently lightest partition.
+static void findCallGraphPartitions(Module *M, ClusterMapType &GVtoClusterMap,
+                                    ClusterIDMapType &ClusterIDMap,
+                                    unsigned N) {
+  DenseMap<const GlobalValue *, uint64_t> ClusterWeights;
+  uint64_t TotalWeight = 0;
+  for (auto I = GVtoClusterMap.begin(), E = GVtoClusterMap.end(); I != E; ++I) {
+    uint64_t Weight = getCodeGenWeight(I->getData());
+    ClusterWeights[GVtoClusterMap.getLeaderValue(I->getData())] += Weight;
+    TotalWeight += Weight;
+  }
+
+  // Count the call sites between each pair of defined functions, in module
+  // order for determinism.
+  MapVector<std::pair<const Function *, const Function *>, unsigned> Calls;
+  for (const Function &F : *M) {
+    if (F.isDeclaration())
+      continue;
+    for (const BasicBlock &BB : F)
+      for (const Instruction &I : BB) {
+        const auto *CB = dyn_cast<CallBase>(&I);
+        if (!CB)
+          continue;
+        const Function *Callee = CB->getCalledFunction();
+        if (!Callee || Callee == &F || Callee->isDeclaration())
+          continue;
+        ++Calls[std::make_pair(&F, Callee)];
+      }
+  }
+
+  std::vector<std::pair<std::pair<const Function *, const Function *>,
+                        unsigned>>
+      Edges(Calls.begin(), Calls.end());
+  llvm::stable_sort(Edges, [](const decltype(Edges)::value_type &A,
+                              const decltype(Edges)::value_type &B) {
+    return A.second > B.second;
+  });
+
+  uint64_t MaxWeight = std::max<uint64_t>(1, TotalWeight / N);
+  for (auto &Edge : Edges) {
+    const GlobalValue *A = GVtoClusterMap.getLeaderValue(Edge.first.first);
+    const GlobalValue *B = GVtoClusterMap.getLeaderValue(Edge.first.second);
+    if (A == B)
+      continue;
+    uint64_t Weight = ClusterWeights[A] + ClusterWeights[B];
+    if (Weight > MaxWeight)
+      continue;
+    ClusterWeights.erase(A);
+    ClusterWeights.erase(B);
+    GVtoClusterMap.unionSets(A, B);
+    ClusterWeights[GVtoClusterMap.getLeaderValue(A)] = Weight;
+  }
+
+  // Collect the clusters in module order, then sort them by weight.
+  using ClusterType = std::pair<const GlobalValue *, uint64_t>;
+  std::vector<ClusterType> Clusters;
+  SmallPtrSet<const GlobalValue *, 32> Seen;
+  auto AddCluster = [&](const GlobalValue &GV) {
+    if (GVtoClusterMap.findValue(&GV) == GVtoClusterMap.end())
+      return;
+    const GlobalValue *Leader = GVtoClusterMap.getLeaderValue(&GV);
+    if (Seen.insert(Leader).second)
+      Clusters.push_back(std::make_pair(Leader, ClusterWeights[Leader]));
+  };
+  llvm::for_each(M->functions(), AddCluster);
+  llvm::for_each(M->globals(), AddCluster);
+  llvm::for_each(M->aliases(), AddCluster);
+  llvm::for_each(M->ifuncs(), AddCluster);
+  llvm::stable_sort(Clusters, [](const ClusterType &A, const ClusterType &B) {
+    return A.second > B.second;
+  });
+
+  std::vector<uint64_t> PartitionWeights(N);
+  for (auto &Cluster : Clusters) {
+    unsigned ID = std::min_element(PartitionWeights.begin(),
+                                   PartitionWeights.end()) -
+                  PartitionWeights.begin();
+    PartitionWeights[ID] += Cluster.second;
+    LLVM_DEBUG(dbgs() << "Root[" << ID << "] cluster_weight(" << Cluster.second
+                      << ") ----> " << Cluster.first->getName() << "\n");
+    for (auto MI = GVtoClusterMap.findLeader(Cluster.first);
+         MI != GVtoClusterMap.member_end(); ++MI)
+      ClusterIDMap[*MI] = ID;
+  }
+}
+
 // Find partitions for module in the way that no locals need to be
 // globalized.
 // Try to balance pack those partitions into N files since this roughly equals
 // thread balancing for the backend codegen step.
 static void findPartitions(Module *M, ClusterIDMapType &ClusterIDMap,
-                           unsigned N) {
+                           unsigned N, bool ByCallGraph) {
   // At this point module should have the proper mix of globals and locals.
   // As we attempt to partition this module, we must not change any
   // locals to globals.
@@ -105,13 +204,18 @@ static void findPartitions(Module *M, ClusterIDMapType &ClusterIDMap,
   ClusterMapType GVtoClusterMap;
   ComdatMembersType ComdatMembers;
 
-  auto recordGVSet = [&GVtoClusterMap, &ComdatMembers](GlobalValue &GV) {
+  auto recordGVSet = [&](GlobalValue &GV) {
     if (GV.isDeclaration())
       return;
 
     if (!GV.hasName())
       GV.setName("__llvmsplit_unnamed");
 
+    // When partitioning by call graph every definition is assigned explicitly,
+    // rather than by the hash of its name.
+    if (ByCallGraph)
+      GVtoClusterMap.insert(&GV);
+
     // Comdat groups must not be partitioned. For comdat groups that contain
     // locals, record all their members here so we can keep them together.
     // Comdat groups that only contain external globals are already handled by
@@ -148,6 +252,12 @@ static void findPartitions(Module *M, ClusterIDMapType &ClusterIDMap,
   llvm::for_each(M->globals(), recordGVSet);
   llvm::for_each(M->aliases(), recordGVSet);
 
+  if (ByCallGraph) {
+    llvm::for_each(M->ifuncs(), recordGVSet);
+    findCallGraphPartitions(M, GVtoClusterMap, ClusterIDMap, N);
+    return;
+  }
+
   // Assigned all GVs to merged clusters while balancing number of objects in
   // each.
   auto CompareClusters = [](const std::pair<unsigned, unsigned> &a,
@@ -249,7 +359,7 @@ static bool isInPartition(const GlobalValue *GV, unsigned I, unsigned N) {
 void llvm::SplitModule(
     std::unique_ptr<Module> M, unsigned N,
     function_ref<void(std::unique_ptr<Module> MPart)> ModuleCallback,
-    bool PreserveLocals) {
+    bool PreserveLocals, bool ByCallGraph) {
   if (!PreserveLocals) {
     for (Function &F : *M)
       externalize(&F);
@@ -264,7 +374,7 @@ void llvm::SplitModule(
   // This performs splitting without a need for externalization, which might not
   // always be possible.
   ClusterIDMapType ClusterIDMap;
-  findPartitions(M.get(), ClusterIDMap, N);
+  findPartitions(M.get(), ClusterIDMap, N, ByCallGraph);
 
   // FIXME: We should be able to reuse M as the last partition instead of
   // cloning it.
@@ -25,6 +25,7 @@ using namespace llvm;
 #define LV_NAME "loop-vectorize"
 #define DEBUG_TYPE LV_NAME
 
+extern cl::opt<bool> EnableVPlanNativePath;
 extern cl::opt<bool> EnableVPlanPredication;
 
 static cl::opt<bool>
@@ -352,6 +353,77 @@ static bool isUniformLoopNest(Loop *Lp, Loop *OuterLp) {
   return true;
 }
 
+// Return true if \p I can be widened in the VPlan-native path, which widens
+// every instruction of the outer loop nest and never scalarizes one.
+static bool isWidenableInOuterLoop(Instruction &I,
+                                   const TargetLibraryInfo *TLI) {
+  if (!I.getType()->isVoidTy() && !VectorType::isValidElementType(I.getType()))
+    return false;
+  if (any_of(I.operands(),
+             [](Value *Op) { return Op->getType()->isVectorTy(); }))
+    return false;
+
+  switch (I.getOpcode()) {
+  case Instruction::PHI:
+  case Instruction::Br:
+  case Instruction::GetElementPtr:
+  case Instruction::UDiv:
+  case Instruction::SDiv:
+  case Instruction::SRem:
+  case Instruction::URem:
+  case Instruction::Add:
+  case Instruction::FAdd:
+  case Instruction::Sub:
+  case Instruction::FSub:
+  case Instruction::FNeg:
+  case Instruction::Mul:
+  case Instruction::FMul:
+  case Instruction::FDiv:
+  case Instruction::FRem:
+  case Instruction::Shl:
+  case Instruction::LShr:
+  case Instruction::AShr:
+  case Instruction::And:
+  case Instruction::Or:
+  case Instruction::Xor:
+  case Instruction::Select:
+  case Instruction::ICmp:
+  case Instruction::FCmp:
+  case Instruction::ZExt:
+  case Instruction::SExt:
+  case Instruction::FPToUI:
+  case Instruction::FPToSI:
+  case Instruction::FPExt:
+  case Instruction::PtrToInt:
+  case Instruction::IntToPtr:
+  case Instruction::SIToFP:
+  case Instruction::UIToFP:
+  case Instruction::Trunc:
+  case Instruction::FPTrunc:
+  case Instruction::BitCast:
+    return true;
+  case Instruction::Load:
+    return cast<LoadInst>(I).isSimple();
+  case Instruction::Store: {
+    auto &SI = cast<StoreInst>(I);
+    return SI.isSimple() &&
+           VectorType::isValidElementType(SI.getValueOperand()->getType());
+  }
+  case Instruction::Call: {
+    // Calls need a vector intrinsic or a vector library function.
+    auto &CI = cast<CallInst>(I);
+    Function *F = CI.getCalledFunction();
+    if (!F)
+      return false;
+    if (getVectorIntrinsicIDForCall(&CI, TLI))
+      return true;
+    return TLI && !CI.isNoBuiltin() && TLI->isFunctionVectorizable(F->getName());
+  }
+  default:
+    return false;
+  }
+}
+
 /// Check whether it is safe to if-convert this phi node.
 ///
 /// Phi nodes with constant expressions that can trap are not safe to if
@@ -485,6 +557,69 @@ bool LoopVectorizationLegality::canVectorizeOuterLoop() {
       return false;
   }
 
+  // Check whether the instructions of the loop nest can be vectorized. This
+  // needs the inductions, which may be used outside of the loop.
+  if (!canVectorizeOuterLoopInstrs()) {
+    if (DoExtraAnalysis)
+      Result = false;
+    else
+      return false;
+  }
+
+  return Result;
+}
+
+bool LoopVectorizationLegality::canVectorizeOuterLoopInstrs() {
+  bool Result = true;
+  bool DoExtraAnalysis = ORE->allowExtraAnalysis(DEBUG_TYPE);
+  bool MayWriteToMemory = false;
+
+  for (BasicBlock *BB : TheLoop->blocks()) {
+    for (Instruction &I : BB->instructionsWithoutDebug()) {
+      MayWriteToMemory |= I.mayWriteToMemory();
+
+      if (!isWidenableInOuterLoop(I, TLI)) {
+        reportVectorizationFailure("Found an instruction that cannot be "
+                                   "widened in an outer loop",
+                                   "instruction cannot be vectorized",
+                                   "CantVectorizeInstruction", ORE, TheLoop,
+                                   &I);
+        if (DoExtraAnalysis)
+          Result = false;
+        else
+          return false;
+      }
+
+      // Reductions are not supported yet, so only the inductions may be used
+      // outside of the loop.
+      if (hasOutsideLoopUser(TheLoop, &I, AllowedExit)) {
+        reportVectorizationFailure("Value cannot be used outside the loop",
+                                   "value cannot be used outside the loop",
+                                   "ValueUsedOutsideLoop", ORE, TheLoop, &I);
+        if (DoExtraAnalysis)
+          Result = false;
+        else
+          return false;
+      }
+    }
+  }
+
+  // There is no dependence analysis for loop nests, so the outer loop
+  // iterations must be marked independent if the loop nest writes to memory.
+  // The experimental VPlan-native path assumes that they are.
+  if (MayWriteToMemory && !EnableVPlanNativePath &&
+      !TheLoop->isAnnotatedParallel()) {
+    reportVectorizationFailure("Outer loop iterations are not known to be "
+                               "independent",
+                               "cannot prove that the outer loop iterations "
+                               "are independent",
+                               "UnsafeDep", ORE, TheLoop);
+    if (DoExtraAnalysis)
+      Result = false;
+    else
+      return false;
+  }
+
   return Result;
 }
 
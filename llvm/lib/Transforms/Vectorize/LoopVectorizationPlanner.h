@@ -227,8 +227,9 @@ public:
       : OrigLoop(L), LI(LI), TLI(TLI), TTI(TTI), Legal(Legal), CM(CM) {}
 
   /// Plan how to best vectorize, return the best VF and its cost, or None if
-  /// vectorization and interleaving should be avoided up front.
-  Optional<VectorizationFactor> plan(unsigned UserVF);
+  /// vectorization and interleaving should be avoided up front. If \p
+  /// MaxVFLimit is not zero, no VF above it is considered.
+  Optional<VectorizationFactor> plan(unsigned UserVF, unsigned MaxVFLimit = 0);
 
   /// Use the VPlan-native path to plan how to best vectorize, return the best
   /// VF and its cost.
@@ -31,7 +31,9 @@
 // http://lists.llvm.org/pipermail/llvm-dev/2017-December/119523.html). For this
 // purpose, we temporarily introduced the VPlan-native vectorization path: an
 // alternative vectorization path that is natively implemented on top of the
-// VPlan infrastructure. See EnableVPlanNativePath for enabling.
+// VPlan infrastructure. Outer loops with an explicit vectorization hint are
+// vectorized in this path, see VectorizeExplicitOuterLoops; the experimental
+// parts of it are enabled by EnableVPlanNativePath.
 //
 //===----------------------------------------------------------------------===//
 //
@@ -168,6 +170,7 @@ static const char *const LLVMLoopVectorizeFollowupEpilogue =
 
 STATISTIC(LoopsVectorized, "Number of loops vectorized");
 STATISTIC(LoopsAnalyzed, "Number of loops analyzed for vectorization");
+STATISTIC(LoopEpiloguesVectorized, "Number of epilogue loops vectorized");
 
 /// Loops with a known constant trip count below this number are vectorized only
 /// if no scalar iteration overheads are incurred.
@@ -204,6 +207,20 @@ static cl::opt<bool> EnableMaskedInterleavedMemAccesses(
 /// number.
 static const unsigned TinyTripCountInterleaveThreshold = 128;
 
+/// The trip count assumed for inner loops of an outer loop being vectorized
+/// when weighting their cost, if it is not a known constant.
+static const unsigned DefaultInnerLoopTripCount = 8;
+
+static cl::opt<bool> EnableEpilogueVectorization(
+    "enable-epilogue-vectorization", cl::init(true), cl::Hidden,
+    cl::desc("Vectorize the remainder loop of vectorized loops with a "
+             "narrower VF."));
+
+static cl::opt<unsigned> EpilogueVectorizationMinVF(
+    "epilogue-vectorization-minimum-VF", cl::init(16), cl::Hidden,
+    cl::desc("Only vectorize the epilogue of loops whose vector loop processes "
+             "at least this many iterations at once (VF * IC)."));
+
 static cl::opt<unsigned> ForceTargetNumScalarRegs(
     "force-target-num-scalar-regs", cl::init(0), cl::Hidden,
     cl::desc("A flag that overrides the target's number of scalar registers."));
@@ -268,6 +285,16 @@ cl::opt<bool> EnableVPlanNativePath(
     cl::desc("Enable VPlan-native vectorization path with "
              "support for outer loop vectorization."));
 
+// Outer loops annotated for explicit vectorization are vectorized in the
+// VPlan-native path when they are in the supported configuration: uniform
+// control flow, no reductions or live-outs other than inductions, and
+// iterations marked independent (or no writes to memory in the loop nest).
+// EnableVPlanNativePath additionally lifts the independence requirement.
+static cl::opt<bool> VectorizeExplicitOuterLoops(
+    "vectorize-explicit-outer-loops", cl::init(true), cl::Hidden,
+    cl::desc("Vectorize outer loops with explicit vectorization hints in the "
+             "VPlan-native path."));
+
 // FIXME: Remove this switch once we have divergence analysis. Currently we
 // assume divergent non-backedge branches when this switch is true.
 cl::opt<bool> EnableVPlanPredication(
@@ -976,6 +1003,16 @@ public:
   /// possible.
   VectorizationFactor selectVectorizationFactor(unsigned MaxVF);
 
+  /// \return The most profitable vectorization factor for an outer loop and
+  /// the cost of that VF, checking every power of two up to MaxVF. Width 1 is
+  /// returned if the loop nest cannot be vectorized with any of them.
+  VectorizationFactor selectOuterLoopVectorizationFactor(unsigned MaxVF);
+
+  /// \return The expected cost of one iteration of the outer loop vectorized
+  /// with factor \p VF in the VPlan-native path, or None if the loop nest
+  /// cannot be vectorized with \p VF. Vector width of one means scalar.
+  Optional<unsigned> expectedOuterLoopCost(unsigned VF);
+
   /// Setup cost-based decisions for user vectorization factor.
   void selectUserVectorizationFactor(unsigned UserVF) {
     collectUniformsAndScalars(UserVF);
@@ -1034,7 +1071,7 @@ public:
 
     // Cost model is not run in the VPlan-native path - return conservative
     // result until this changes.
-    if (EnableVPlanNativePath)
+    if (!TheLoop->empty())
       return false;
 
     auto Scalars = InstsToScalarize.find(VF);
@@ -1050,7 +1087,7 @@ public:
 
     // Cost model is not run in the VPlan-native path - return conservative
     // result until this changes.
-    if (EnableVPlanNativePath)
+    if (!TheLoop->empty())
       return false;
 
     auto UniformsPerVF = Uniforms.find(VF);
@@ -1066,7 +1103,7 @@ public:
 
     // Cost model is not run in the VPlan-native path - return conservative
     // result until this changes.
-    if (EnableVPlanNativePath)
+    if (!TheLoop->empty())
       return false;
 
     auto ScalarsPerVF = Scalars.find(VF);
@@ -1126,7 +1163,7 @@ public:
 
     // Cost model is not run in the VPlan-native path - return conservative
     // result until this changes.
-    if (EnableVPlanNativePath)
+    if (!TheLoop->empty())
       return CM_GatherScatter;
 
     std::pair<Instruction *, unsigned> InstOnVF = std::make_pair(I, VF);
@@ -1339,6 +1376,10 @@ private:
   /// The cost computation for Gather/Scatter instruction.
   unsigned getGatherScatterCost(Instruction *I, unsigned VF);
 
+  /// Returns the cost of instruction \p I of an outer loop when widened with
+  /// factor \p VF in the VPlan-native path, or None if it cannot be.
+  Optional<unsigned> getOuterLoopInstructionCost(Instruction *I, unsigned VF);
+
   /// The cost computation for widening instruction \p I with consecutive
   /// memory access.
   unsigned getConsecutiveMemOpCost(Instruction *I, unsigned VF);
@@ -1558,16 +1599,17 @@ static void collectSupportedLoops(Loop &L, LoopInfo *LI,
   // are stress testing the VPlan H-CFG construction, we collect the outermost
   // loop of every loop nest.
   if (L.empty() || VPlanBuildStressTest ||
-      (EnableVPlanNativePath && isExplicitVecOuterLoop(&L, ORE))) {
+      ((EnableVPlanNativePath || VectorizeExplicitOuterLoops) &&
+       isExplicitVecOuterLoop(&L, ORE))) {
     LoopBlocksRPO RPOT(&L);
     RPOT.perform(LI);
     if (!containsIrreducibleCFG<const BasicBlock *>(RPOT, *LI)) {
+      // The inner loops of an outer loop are collected when vectorizing the
+      // outer loop fails, see LoopVectorizePass::runImpl.
+      // TODO: Do not invoke 'containsIrreducibleCFG' again for inner loops
+      // when the outer loop is already known to be reducible. We can use an
+      // inherited attribute for that.
       V.push_back(&L);
-      // TODO: Collect inner loops inside marked outer loops in case
-      // vectorization fails for the outer loop. Do not invoke
-      // 'containsIrreducibleCFG' again for inner loops when the outer loop is
-      // already known to be reducible. We can use an inherited attribute for
-      // that.
       return;
     }
   }
@@ -1629,14 +1671,10 @@ struct LoopVectorize : public FunctionPass {
     AU.addRequired<DemandedBitsWrapperPass>();
     AU.addRequired<OptimizationRemarkEmitterWrapperPass>();
 
-    // We currently do not preserve loopinfo/dominator analyses with outer loop
-    // vectorization. Until this is addressed, mark these analyses as preserved
-    // only for non-VPlan-native path.
-    // TODO: Preserve Loop and Dominator analyses for VPlan-native path.
-    if (!EnableVPlanNativePath) {
-      AU.addPreserved<LoopInfoWrapperPass>();
-      AU.addPreserved<DominatorTreeWrapperPass>();
-    }
+    // Loop and dominator analyses are recomputed after outer loop
+    // vectorization, see LoopVectorizePass::runImpl.
+    AU.addPreserved<LoopInfoWrapperPass>();
+    AU.addPreserved<DominatorTreeWrapperPass>();
 
     AU.addPreserved<BasicAAWrapperPass>();
     AU.addPreserved<GlobalsAAWrapperPass>();
@@ -1991,7 +2029,7 @@ Value *InnerLoopVectorizer::getOrCreateVectorValue(Value *V, unsigned Part) {
 
   // If we have a stride that is replaced by one, do it here. Defer this for
   // the VPlan-native path until we start running Legal checks in that path.
-  if (!EnableVPlanNativePath && Legal->hasStride(V))
+  if (OrigLoop->empty() && Legal->hasStride(V))
     V = ConstantInt::get(V->getType(), 1);
 
   // If we have a vector mapped to this value, return it.
@@ -2741,7 +2779,7 @@ void InnerLoopVectorizer::emitSCEVChecks(Loop *L, BasicBlock *Bypass) {
 
 void InnerLoopVectorizer::emitMemRuntimeChecks(Loop *L, BasicBlock *Bypass) {
   // VPlan-native path does not do any analysis for runtime checks currently.
-  if (EnableVPlanNativePath)
+  if (!OrigLoop->empty())
     return;
 
   BasicBlock *BB = L->getLoopPreheader();
@@ -3418,7 +3456,7 @@ void InnerLoopVectorizer::fixVectorizedLoop() {
 
   // Fix widened non-induction PHIs by setting up the PHI operands.
   if (OrigPHIsToFix.size()) {
-    assert(EnableVPlanNativePath &&
+    assert(!OrigLoop->empty() &&
            "Unexpected non-induction PHIs for fixup in non VPlan-native path");
     fixNonInductionPHIs();
   }
@@ -3963,7 +4001,7 @@ void InnerLoopVectorizer::fixNonInductionPHIs() {
 void InnerLoopVectorizer::widenPHIInstruction(Instruction *PN, unsigned UF,
                                               unsigned VF) {
   PHINode *P = cast<PHINode>(PN);
-  if (EnableVPlanNativePath) {
+  if (!OrigLoop->empty()) {
     // Currently we enter here in the VPlan-native path for non-induction
     // PHIs where all control flow is uniform. We simply widen these PHIs.
     // Create a vector phi with no operands - the vector phi operands will be
@@ -4276,9 +4314,13 @@ void InnerLoopVectorizer::widenInstruction(Instruction &I) {
     // Is it beneficial to perform intrinsic call compared to lib call?
     bool NeedToScalarize;
     unsigned CallCost = Cost->getVectorCallCost(CI, VF, NeedToScalarize);
+    // Outer loops are not scalarized, so for them a vector intrinsic is
+    // used when there is no vector version of the library call.
     bool UseVectorIntrinsic =
-        ID && Cost->getVectorIntrinsicCost(CI, VF) <= CallCost;
-    assert((UseVectorIntrinsic || !NeedToScalarize) &&
+        ID && (Cost->getVectorIntrinsicCost(CI, VF) <= CallCost ||
+               (!OrigLoop->empty() && NeedToScalarize));
+    assert((UseVectorIntrinsic || !NeedToScalarize ||
+            (!OrigLoop->empty() && TLI->isFunctionVectorizable(FnName, VF))) &&
            "Instruction should be scalarized elsewhere.");
 
     for (unsigned Part = 0; Part < UF; ++Part) {
@@ -4339,8 +4381,9 @@ void InnerLoopVectorizer::updateAnalysis() {
   // Forget the original basic block.
   PSE.getSE()->forgetLoop(OrigLoop);
 
-  // DT is not kept up-to-date for outer loop vectorization
-  if (EnableVPlanNativePath)
+  // DT is not kept up-to-date for outer loop vectorization, it is recomputed
+  // once all loops of the function are processed.
+  if (!OrigLoop->empty())
     return;
 
   // Update the dominator tree information.
@@ -5064,6 +5107,183 @@ LoopVectorizationCostModel::selectVectorizationFactor(unsigned MaxVF) {
   return Factor;
 }
 
+VectorizationFactor
+LoopVectorizationCostModel::selectOuterLoopVectorizationFactor(unsigned MaxVF) {
+  assert(!TheLoop->empty() && "Outer loop expected.");
+  Optional<unsigned> ScalarCost = expectedOuterLoopCost(1);
+  LLVM_DEBUG(if (ScalarCost) dbgs()
+             << "LV: Scalar outer loop costs: " << *ScalarCost << ".\n");
+
+  // Outer loops are only vectorized on request, in which case the scalar cost
+  // is ignored like for forced inner loops.
+  bool ForceVectorization = Hints->getForce() == LoopVectorizeHints::FK_Enabled;
+  float Cost = std::numeric_limits<float>::max();
+  if (!ForceVectorization && ScalarCost)
+    Cost = *ScalarCost;
+  unsigned Width = 1;
+
+  for (unsigned i = 2; i <= MaxVF; i *= 2) {
+    Optional<unsigned> C = expectedOuterLoopCost(i);
+    if (!C) {
+      LLVM_DEBUG(dbgs() << "LV: Not considering outer loop vectorization of "
+                           "width "
+                        << i << " because it cannot be code generated.\n");
+      continue;
+    }
+    // The vector loop nest runs a fraction of the outer loop iterations.
+    float VectorCost = *C / (float)i;
+    LLVM_DEBUG(dbgs() << "LV: Vector outer loop of width " << i
+                      << " costs: " << (int)VectorCost << ".\n");
+    if (VectorCost < Cost) {
+      Cost = VectorCost;
+      Width = i;
+    }
+  }
+
+  if (Width == 1) {
+    LLVM_DEBUG(dbgs() << "LV: No vectorization factor found for the outer "
+                         "loop.\n");
+    return VectorizationFactor::Disabled();
+  }
+
+  LLVM_DEBUG(if (ScalarCost && Cost >= *ScalarCost) dbgs()
+             << "LV: Vectorization seems to be not beneficial, "
+             << "but was forced by a user.\n");
+  LLVM_DEBUG(dbgs() << "LV: Selecting VF: " << Width << ".\n");
+  VectorizationFactor Factor = {Width, (unsigned)(Width * Cost)};
+  return Factor;
+}
+
+Optional<unsigned>
+LoopVectorizationCostModel::expectedOuterLoopCost(unsigned VF) {
+  assert(!TheLoop->empty() && "Outer loop expected.");
+  unsigned Cost = 0;
+
+  for (BasicBlock *BB : TheLoop->blocks()) {
+    // The inner loops are uniform, so all lanes run them with the same trip
+    // counts: a block runs once per iteration of each inner loop around it,
+    // in the scalar and in the vector loop nest alike.
+    unsigned Weight = 1;
+    for (Loop *L = LI->getLoopFor(BB); L != TheLoop; L = L->getParentLoop()) {
+      unsigned TC = PSE.getSE()->getSmallConstantTripCount(L);
+      Weight = SaturatingMultiply(Weight, TC ? TC : DefaultInnerLoopTripCount);
+    }
+
+    unsigned BlockCost = 0;
+    for (Instruction &I : BB->instructionsWithoutDebug()) {
+      Optional<unsigned> C = getOuterLoopInstructionCost(&I, VF);
+      if (!C) {
+        LLVM_DEBUG(dbgs() << "LV: Cannot widen " << I << " with VF " << VF
+                          << ".\n");
+        return None;
+      }
+      BlockCost = SaturatingAdd(BlockCost, *C);
+    }
+    Cost = SaturatingAdd(Cost, SaturatingMultiply(BlockCost, Weight));
+  }
+
+  return Cost;
+}
+
+Optional<unsigned>
+LoopVectorizationCostModel::getOuterLoopInstructionCost(Instruction *I,
+                                                        unsigned VF) {
+  Type *VectorTy = ToVectorTy(I->getType(), VF);
+  switch (I->getOpcode()) {
+  case Instruction::PHI:
+  case Instruction::GetElementPtr:
+    // Phis are widened for free. As in the inner loop model, the cost of the
+    // address computation is accounted to the memory instructions.
+    return 0;
+  case Instruction::Br:
+    // All control flow is uniform, so branches remain scalar.
+    return TTI.getCFInstrCost(Instruction::Br);
+  case Instruction::Load:
+  case Instruction::Store: {
+    if (VF == 1) {
+      Type *ValTy = getMemInstValueType(I);
+      unsigned Alignment = getLoadStoreAlignment(I);
+      unsigned AS = getLoadStoreAddressSpace(I);
+      return TTI.getAddressComputationCost(ValTy) +
+             TTI.getMemoryOpCost(I->getOpcode(), ValTy, Alignment, AS, I);
+    }
+    // The VPlan-native path widens every access into a gather or a scatter.
+    return getGatherScatterCost(I, VF);
+  }
+  case Instruction::Call: {
+    auto *CI = cast<CallInst>(I);
+    Intrinsic::ID ID = getVectorIntrinsicIDForCall(CI, TLI);
+    bool NeedToScalarize = false;
+    unsigned CallCost = getVectorCallCost(CI, VF, NeedToScalarize);
+    if (VF == 1)
+      return ID ? std::min(CallCost, getVectorIntrinsicCost(CI, VF)) : CallCost;
+    // Calls are never scalarized, mirror the choice of the code generation.
+    if (ID) {
+      unsigned IntrinsicCost = getVectorIntrinsicCost(CI, VF);
+      if (NeedToScalarize || IntrinsicCost <= CallCost)
+        return IntrinsicCost;
+    }
+    if (!NeedToScalarize)
+      return CallCost;
+    // The vector library call is used even if scalarizing looks cheaper, so
+    // its cost is bounded by the scalarization cost.
+    if (!CI->isNoBuiltin() &&
+        TLI->isFunctionVectorizable(CI->getCalledFunction()->getName(), VF))
+      return CallCost;
+    return None;
+  }
+  case Instruction::UDiv:
+  case Instruction::SDiv:
+  case Instruction::SRem:
+  case Instruction::URem:
+  case Instruction::Add:
+  case Instruction::FAdd:
+  case Instruction::Sub:
+  case Instruction::FSub:
+  case Instruction::FNeg:
+  case Instruction::Mul:
+  case Instruction::FMul:
+  case Instruction::FDiv:
+  case Instruction::FRem:
+  case Instruction::Shl:
+  case Instruction::LShr:
+  case Instruction::AShr:
+  case Instruction::And:
+  case Instruction::Or:
+  case Instruction::Xor:
+    return TTI.getArithmeticInstrCost(I->getOpcode(), VectorTy);
+  case Instruction::Select: {
+    Type *CondTy = I->getOperand(0)->getType();
+    if (!TheLoop->isLoopInvariant(I->getOperand(0)))
+      CondTy = ToVectorTy(CondTy, VF);
+    return TTI.getCmpSelInstrCost(I->getOpcode(), VectorTy, CondTy, I);
+  }
+  case Instruction::ICmp:
+  case Instruction::FCmp: {
+    Type *ValTy = ToVectorTy(I->getOperand(0)->getType(), VF);
+    return TTI.getCmpSelInstrCost(I->getOpcode(), ValTy, nullptr, I);
+  }
+  case Instruction::ZExt:
+  case Instruction::SExt:
+  case Instruction::FPToUI:
+  case Instruction::FPToSI:
+  case Instruction::FPExt:
+  case Instruction::PtrToInt:
+  case Instruction::IntToPtr:
+  case Instruction::SIToFP:
+  case Instruction::UIToFP:
+  case Instruction::Trunc:
+  case Instruction::FPTrunc:
+  case Instruction::BitCast: {
+    Type *SrcVecTy = ToVectorTy(I->getOperand(0)->getType(), VF);
+    return TTI.getCastInstrCost(I->getOpcode(), VectorTy, SrcVecTy, I);
+  }
+  default:
+    // Not handled by InnerLoopVectorizer::widenInstruction.
+    return None;
+  }
+}
+
 std::pair<unsigned, unsigned>
 LoopVectorizationCostModel::getSmallestAndWidestTypes() {
   unsigned MinWidth = -1U;
@@ -6394,6 +6614,15 @@ LoopVectorizationPlanner::planInVPlanNativePath(unsigned UserVF) {
   // Since we cannot modify the incoming IR, we need to build VPlan upfront in
   // the vectorization pipeline.
   if (!OrigLoop->empty()) {
+    // The VPlan-native path cannot fold the tail of the loop by masking, the
+    // remaining iterations always run in the scalar loop nest.
+    if (!VPlanBuildStressTest && !CM.isScalarEpilogueAllowed()) {
+      LLVM_DEBUG(dbgs() << "LV: Not vectorizing outer loop: a scalar "
+                           "epilogue is not allowed.\n");
+      return VectorizationFactor::Disabled();
+    }
+
+    unsigned Cost = 0;
     // If the user doesn't provide a vectorization factor, determine a
     // reasonable one.
     if (!UserVF) {
@@ -6406,8 +6635,25 @@ LoopVectorizationPlanner::planInVPlanNativePath(unsigned UserVF) {
                           << "overriding computed VF.\n");
         VF = 4;
       }
+
+      // Pick the most profitable VF up to the computed one.
+      if (!VPlanBuildStressTest) {
+        VectorizationFactor Best = CM.selectOuterLoopVectorizationFactor(VF);
+        if (Best.Width < 2)
+          return VectorizationFactor::Disabled();
+        VF = Best.Width;
+        Cost = Best.Cost;
+      }
+    } else if (!VPlanBuildStressTest) {
+      Optional<unsigned> UserCost = CM.expectedOuterLoopCost(UserVF);
+      if (!UserCost) {
+        LLVM_DEBUG(dbgs() << "LV: Not vectorizing outer loop: it cannot be "
+                             "vectorized with user VF "
+                          << UserVF << ".\n");
+        return VectorizationFactor::Disabled();
+      }
+      Cost = *UserCost;
     }
-    assert(EnableVPlanNativePath && "VPlan-native path is not enabled.");
     assert(isPowerOf2_32(VF) && "VF needs to be a power of two");
     LLVM_DEBUG(dbgs() << "LV: Using " << (UserVF ? "user " : "") << "VF " << VF
                       << " to build VPlans.\n");
@@ -6417,7 +6663,7 @@ LoopVectorizationPlanner::planInVPlanNativePath(unsigned UserVF) {
     if (VPlanBuildStressTest)
       return VectorizationFactor::Disabled();
 
-    return {VF, 0};
+    return {VF, Cost};
   }
 
   LLVM_DEBUG(
@@ -6426,7 +6672,8 @@ LoopVectorizationPlanner::planInVPlanNativePath(unsigned UserVF) {
   return VectorizationFactor::Disabled();
 }
 
-Optional<VectorizationFactor> LoopVectorizationPlanner::plan(unsigned UserVF) {
+Optional<VectorizationFactor>
+LoopVectorizationPlanner::plan(unsigned UserVF, unsigned MaxVFLimit) {
   assert(OrigLoop->empty() && "Inner loop expected.");
   Optional<unsigned> MaybeMaxVF = CM.computeMaxVF();
   if (!MaybeMaxVF) // Cases that should not to be vectorized nor interleaved.
@@ -6455,6 +6702,8 @@ Optional<VectorizationFactor> LoopVectorizationPlanner::plan(unsigned UserVF) {
 
   unsigned MaxVF = MaybeMaxVF.getValue();
   assert(MaxVF != 0 && "MaxVF is zero.");
+  if (MaxVFLimit)
+    MaxVF = std::min(MaxVF, MaxVFLimit);
 
   for (unsigned VF = 1; VF <= MaxVF; VF *= 2) {
     // Collect Uniform and Scalar instructions after vectorization with VF.
@@ -6497,6 +6746,7 @@ void LoopVectorizationPlanner::executePlan(InnerLoopVectorizer &ILV,
   VPTransformState State{BestVF, BestUF,      LI,
                          DT,     ILV.Builder, ILV.VectorLoopValueMap,
                          &ILV,   CallbackILV};
+  State.CFG.OuterLoop = !OrigLoop->empty();
   State.CFG.PrevBB = ILV.createVectorizedLoopSkeleton();
   State.TripCount = ILV.getOrCreateTripCount(nullptr);
 
@@ -7227,7 +7477,6 @@ VPlanPtr LoopVectorizationPlanner::buildVPlan(VFRange &Range) {
   // Since we cannot modify the incoming IR, we need to build VPlan upfront in
   // the vectorization pipeline.
   assert(!OrigLoop->empty());
-  assert(EnableVPlanNativePath && "VPlan-native path is not enabled.");
 
   // Create new empty VPlan
   auto Plan = std::make_unique<VPlan>();
@@ -7461,7 +7710,7 @@ static bool processLoopInVPlanNativePath(
     OptimizationRemarkEmitter *ORE, BlockFrequencyInfo *BFI,
     ProfileSummaryInfo *PSI, LoopVectorizeHints &Hints) {
 
-  assert(EnableVPlanNativePath && "VPlan-native path is disabled.");
+  assert(!L->empty() && "Outer loop expected.");
   Function *F = L->getHeader()->getParent();
   InterleavedAccessInfo IAI(PSE, L, DT, LI, LVL->getLAI());
   ScalarEpilogueLowering SEL = getScalarEpilogueLowering(F, L, Hints, PSI, BFI);
@@ -7502,7 +7751,8 @@ static bool processLoopInVPlanNativePath(
 }
 
 bool LoopVectorizePass::processLoop(Loop *L) {
-  assert((EnableVPlanNativePath || L->empty()) &&
+  assert((EnableVPlanNativePath || VectorizeExplicitOuterLoops ||
+          VPlanBuildStressTest || L->empty()) &&
          "VPlan-native path is not enabled. Only process inner loops.");
 
 #ifndef NDEBUG
@@ -7548,7 +7798,7 @@ bool LoopVectorizePass::processLoop(Loop *L) {
   LoopVectorizationRequirements Requirements(*ORE);
   LoopVectorizationLegality LVL(L, PSE, DT, TTI, TLI, AA, F, GetLAA, LI, ORE,
                                 &Requirements, &Hints, DB, AC);
-  if (!LVL.canVectorize(EnableVPlanNativePath)) {
+  if (!LVL.canVectorize(!L->empty())) {
     LLVM_DEBUG(dbgs() << "LV: Not vectorizing: Cannot prove legality.\n");
     Hints.emitRemarkWithHints();
     return false;
@@ -7741,6 +7991,9 @@ bool LoopVectorizePass::processLoop(Loop *L) {
   using namespace ore;
   bool DisableRuntimeUnroll = false;
   MDNode *OrigLoopID = L->getLoopID();
+  Optional<MDNode *> RemainderLoopID =
+      makeFollowupLoopID(OrigLoopID, {LLVMLoopVectorizeFollowupAll,
+                                      LLVMLoopVectorizeFollowupEpilogue});
 
   if (!VectorizeLoop) {
     assert(IC > 1 && "interleave count should not be 1 or 0");
@@ -7777,11 +8030,17 @@ bool LoopVectorizePass::processLoop(Loop *L) {
              << NV("VectorizationFactor", VF.Width)
              << ", interleaved count: " << NV("InterleaveCount", IC) << ")";
     });
+
+    // With a wide vector loop, up to VF * IC - 1 iterations are left to the
+    // remainder loop. Vectorize it too, unless its transformation is given
+    // explicitly.
+    if (EnableEpilogueVectorization &&
+        VF.Width * IC >= EpilogueVectorizationMinVF &&
+        CM.isScalarEpilogueAllowed() && !CM.foldTailByMasking() &&
+        !RemainderLoopID.hasValue())
+      vectorizeEpilogue(L, VF.Width, IC);
   }
 
-  Optional<MDNode *> RemainderLoopID =
-      makeFollowupLoopID(OrigLoopID, {LLVMLoopVectorizeFollowupAll,
-                                      LLVMLoopVectorizeFollowupEpilogue});
   if (RemainderLoopID.hasValue()) {
     L->setLoopID(RemainderLoopID.getValue());
   } else {
@@ -7796,6 +8055,77 @@ bool LoopVectorizePass::processLoop(Loop *L) {
   return true;
 }
 
+bool LoopVectorizePass::vectorizeEpilogue(Loop *L, unsigned MainVF,
+                                          unsigned MainIC) {
+  // The exit block of the remainder loop is now also reached from the middle
+  // block. Restore the loop forms that the vectorizer expects.
+  simplifyLoop(L, DT, LI, SE, AC, nullptr, false /* PreserveLCSSA */);
+  formLCSSARecursively(*L, *DT, LI, SE);
+
+  LLVM_DEBUG(dbgs() << "\nLV: Checking the epilogue of a loop vectorized with "
+                    << "VF " << MainVF << " and IC " << MainIC << ".\n");
+
+  Function *F = L->getHeader()->getParent();
+  LoopVectorizeHints Hints(L, true /*DisableInterleaving*/, *ORE);
+  PredicatedScalarEvolution PSE(*SE, *L);
+
+  // The cached access info describes the loop before it was vectorized, so
+  // analyze the remainder loop afresh.
+  std::unique_ptr<LoopAccessInfo> EpilogueLAI;
+  std::function<const LoopAccessInfo &(Loop &)> GetEpilogueLAA =
+      [&](Loop &Lp) -> const LoopAccessInfo & {
+    EpilogueLAI = std::make_unique<LoopAccessInfo>(&Lp, SE, TLI, AA, DT, LI);
+    return *EpilogueLAI;
+  };
+
+  LoopVectorizationRequirements Requirements(*ORE);
+  LoopVectorizationLegality LVL(L, PSE, DT, TTI, TLI, AA, F, &GetEpilogueLAA,
+                                LI, ORE, &Requirements, &Hints, DB, AC);
+  if (!LVL.canVectorize(false /*UseVPlanNativePath*/) ||
+      Requirements.doesNotMeet(F, L, Hints)) {
+    LLVM_DEBUG(dbgs() << "LV: Not vectorizing the epilogue: Cannot prove "
+                         "legality.\n");
+    return false;
+  }
+
+  bool UseInterleaved = TTI->enableInterleavedAccessVectorization();
+  if (EnableInterleavedMemAccesses.getNumOccurrences() > 0)
+    UseInterleaved = EnableInterleavedMemAccesses;
+  InterleavedAccessInfo IAI(PSE, L, DT, LI, LVL.getLAI());
+  if (UseInterleaved)
+    IAI.analyzeInterleaving(useMaskedInterleavedAccesses(*TTI));
+
+  // The remainder loop keeps a scalar loop for its own remainder.
+  LoopVectorizationCostModel CM(CM_ScalarEpilogueAllowed, L, PSE, LI, &LVL,
+                                *TTI, TLI, DB, AC, ORE, F, &Hints, IAI);
+  CM.collectValuesToIgnore();
+  LoopVectorizationPlanner LVP(L, LI, TLI, TTI, &LVL, CM);
+
+  // The remainder loop runs fewer than MainVF * MainIC iterations, so only
+  // narrower factors can help.
+  unsigned MaxVF = std::min(MainVF, MainVF * MainIC / 2);
+  Optional<VectorizationFactor> MaybeVF = LVP.plan(0 /*UserVF*/, MaxVF);
+  if (!MaybeVF || MaybeVF->Width == 1) {
+    LLVM_DEBUG(dbgs() << "LV: Vectorizing the epilogue is not beneficial.\n");
+    return false;
+  }
+  VectorizationFactor VF = *MaybeVF;
+
+  LVP.setBestPlan(VF.Width, 1);
+  InnerLoopVectorizer EB(L, PSE, LI, DT, TLI, TTI, AC, ORE, VF.Width, 1, &LVL,
+                         &CM);
+  LVP.executePlan(EB, DT);
+  ++LoopEpiloguesVectorized;
+
+  ORE->emit([&]() {
+    return OptimizationRemark(LV_NAME, "VectorizedEpilogue", L->getStartLoc(),
+                              L->getHeader())
+           << "vectorized epilogue loop (vectorization width: "
+           << ore::NV("VectorizationFactor", VF.Width) << ")";
+  });
+  return true;
+}
+
 bool LoopVectorizePass::runImpl(
     Function &F, ScalarEvolution &SE_, LoopInfo &LI_, TargetTransformInfo &TTI_,
     DominatorTree &DT_, BlockFrequencyInfo &BFI_, TargetLibraryInfo *TLI_,
@@ -7848,6 +8178,7 @@ bool LoopVectorizePass::runImpl(
   LoopsAnalyzed += Worklist.size();
 
   // Now walk the identified inner loops.
+  bool VectorizedOuterLoop = false;
   while (!Worklist.empty()) {
     Loop *L = Worklist.pop_back_val();
 
@@ -7855,7 +8186,29 @@ bool LoopVectorizePass::runImpl(
     // transform.
     Changed |= formLCSSARecursively(*L, *DT, LI, SE);
 
-    Changed |= processLoop(L);
+    bool IsOuterLoop = !L->empty();
+    if (processLoop(L)) {
+      Changed = true;
+      VectorizedOuterLoop |= IsOuterLoop;
+      continue;
+    }
+
+    // Try the inner loops of an outer loop that was not vectorized.
+    if (IsOuterLoop && !VPlanBuildStressTest) {
+      unsigned NumLoops = Worklist.size();
+      for (Loop *InnerL : *L)
+        collectSupportedLoops(*InnerL, LI, ORE, Worklist);
+      LoopsAnalyzed += Worklist.size() - NumLoops;
+    }
+  }
+
+  // The VPlan-native path doesn't keep the dominator tree and loop info up to
+  // date for the vector loop nests it generates, so recompute them.
+  // TODO: Update them incrementally.
+  if (VectorizedOuterLoop) {
+    DT->recalculate(F);
+    LI->releaseMemory();
+    LI->analyze(*DT);
   }
 
   // Process each loop nest in the function.
@@ -7894,14 +8247,10 @@ PreservedAnalyses LoopVectorizePass::run(Function &F,
       return PreservedAnalyses::all();
     PreservedAnalyses PA;
 
-    // We currently do not preserve loopinfo/dominator analyses with outer loop
-    // vectorization. Until this is addressed, mark these analyses as preserved
-    // only for non-VPlan-native path.
-    // TODO: Preserve Loop and Dominator analyses for VPlan-native path.
-    if (!EnableVPlanNativePath) {
-      PA.preserve<LoopAnalysis>();
-      PA.preserve<DominatorTreeAnalysis>();
-    }
+    // Loop and dominator analyses are recomputed after outer loop
+    // vectorization, see runImpl.
+    PA.preserve<LoopAnalysis>();
+    PA.preserve<DominatorTreeAnalysis>();
     PA.preserve<BasicAA>();
     PA.preserve<GlobalsAA>();
     return PA;
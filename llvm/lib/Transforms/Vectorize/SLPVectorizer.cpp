@@ -123,6 +123,11 @@ static cl::opt<bool> ShouldStartVectorizeHorAtStore(
     cl::desc(
         "Attempt to vectorize horizontal reductions feeding into a store"));
 
+static cl::opt<bool> ShouldVectorizeAcrossBlocks(
+    "slp-vectorize-across-blocks", cl::init(false), cl::Hidden,
+    cl::desc("Attempt to vectorize reductions spanning several basic blocks "
+             "and the values flowing into the phis of if/else joins"));
+
 static cl::opt<int>
 MaxVectorRegSizeOption("slp-max-reg-size", cl::init(128), cl::Hidden,
     cl::desc("Attempt to vectorize for this register size in bits"));
@@ -5696,6 +5701,11 @@ class HorizontalReduction {
   // Use map vector to make stable output.
   MapVector<Instruction *, Value *> ExtraArgs;
 
+  /// Analyses used to match reductions across basic blocks. They are only set
+  /// if -slp-vectorize-across-blocks is on.
+  const DominatorTree *DT = nullptr;
+  const LoopInfo *LI = nullptr;
+
   /// Kind of the reduction data.
   enum ReductionKind {
     RK_None,       /// Not a reduction.
@@ -6085,6 +6095,42 @@ class HorizontalReduction {
     }
   }
 
+  /// Checks if \p I, an operand of the tree node \p TreeN, may be a part of a
+  /// reduction rooted in \p RootBB although it is in another block. The
+  /// reduction operations may come from the blocks dominating \p RootBB in the
+  /// same loop, so that they are not moved into a loop, and the reduced values
+  /// from the block of their reduction operation.
+  bool canReduceAcrossBlocks(Instruction *I, Instruction *TreeN,
+                             BasicBlock *RootBB, bool IsRedOp) const {
+    if (!DT)
+      return false;
+    BasicBlock *BB = I->getParent();
+    if (!IsRedOp)
+      return BB == TreeN->getParent();
+    return ReductionData.hasSameParent(I, BB, /*IsRedOp=*/true) &&
+           DT->dominates(BB, RootBB) &&
+           LI->getLoopFor(BB) == LI->getLoopFor(RootBB);
+  }
+
+  /// Reorders the reduced values so that the values of each block are
+  /// adjacent, the blocks with more values first. A vector tree is only built
+  /// from the values of one block.
+  void groupReducedValuesByBlock() {
+    MapVector<BasicBlock *, SmallVector<Value *, 8>> Groups;
+    for (Value *V : ReducedVals)
+      Groups[cast<Instruction>(V)->getParent()].push_back(V);
+    if (Groups.size() < 2)
+      return;
+    using GroupTy = std::pair<BasicBlock *, SmallVector<Value *, 8>>;
+    std::vector<GroupTy> GroupList = Groups.takeVector();
+    llvm::stable_sort(GroupList, [](const GroupTy &G1, const GroupTy &G2) {
+      return G1.second.size() > G2.second.size();
+    });
+    ReducedVals.clear();
+    for (auto &Group : GroupList)
+      ReducedVals.append(Group.second.begin(), Group.second.end());
+  }
+
   static OperationData getOperationData(Value *V) {
     if (!V)
       return OperationData();
@@ -6128,29 +6174,31 @@ class HorizontalReduction {
         // %4 = extractelement <2 x i32> %a, i32 1
         // %select = select i1 %cond, i32 %3, i32 %4
         CmpInst::Predicate Pred;
-        Instruction *L1;
-        Instruction *L2;
+        Value *CmpLHS;
+        Value *CmpRHS;
 
         LHS = Select->getTrueValue();
         RHS = Select->getFalseValue();
         Value *Cond = Select->getCondition();
+        if (!match(Cond, m_Cmp(Pred, m_Value(CmpLHS), m_Value(CmpRHS))))
+          return OperationData(V);
 
-        // TODO: Support inverse predicates.
-        if (match(Cond, m_Cmp(Pred, m_Specific(LHS), m_Instruction(L2)))) {
-          if (!isa<ExtractElementInst>(RHS) ||
-              !L2->isIdenticalTo(cast<Instruction>(RHS)))
-            return OperationData(V);
-        } else if (match(Cond, m_Cmp(Pred, m_Instruction(L1), m_Specific(RHS)))) {
-          if (!isa<ExtractElementInst>(LHS) ||
-              !L1->isIdenticalTo(cast<Instruction>(LHS)))
-            return OperationData(V);
-        } else {
-          if (!isa<ExtractElementInst>(LHS) || !isa<ExtractElementInst>(RHS))
-            return OperationData(V);
-          if (!match(Cond, m_Cmp(Pred, m_Instruction(L1), m_Instruction(L2))) ||
-              !L1->isIdenticalTo(cast<Instruction>(LHS)) ||
-              !L2->isIdenticalTo(cast<Instruction>(RHS)))
+        // Checks if the compared value is the selected one or an identical
+        // extractelement.
+        auto IsSameValue = [](Value *CmpOp, Value *SelectOp) {
+          if (CmpOp == SelectOp)
+            return true;
+          auto *Extract = dyn_cast<ExtractElementInst>(CmpOp);
+          return Extract && isa<ExtractElementInst>(SelectOp) &&
+                 Extract->isIdenticalTo(cast<Instruction>(SelectOp));
+        };
+        // The values may also be selected in the inverse order of the
+        // comparison, select ((cmp Inst2, Inst1), Inst1, Inst2), which is the
+        // same min/max with the swapped predicate.
+        if (!IsSameValue(CmpLHS, LHS) || !IsSameValue(CmpRHS, RHS)) {
+          if (!IsSameValue(CmpLHS, RHS) || !IsSameValue(CmpRHS, LHS))
             return OperationData(V);
+          Pred = CmpInst::getSwappedPredicate(Pred);
         }
         switch (Pred) {
         default:
@@ -6194,10 +6242,16 @@ class HorizontalReduction {
 public:
   HorizontalReduction() = default;
 
-  /// Try to find a reduction tree.
-  bool matchAssociativeReduction(PHINode *Phi, Instruction *B) {
+  /// Try to find a reduction tree. If the dominator tree \p DomTree and the
+  /// loop info \p LoopI are given, the tree may reach into the blocks
+  /// dominating the block of \p B.
+  bool matchAssociativeReduction(PHINode *Phi, Instruction *B,
+                                 const DominatorTree *DomTree = nullptr,
+                                 const LoopInfo *LoopI = nullptr) {
     assert((!Phi || is_contained(Phi->operands(), B)) &&
            "Thi phi needs to use the binary operator");
+    DT = DomTree;
+    LI = LoopI;
 
     ReductionData = getOperationData(B);
 
@@ -6277,9 +6331,12 @@ public:
         if (I && (!ReducedValueData || OpData == ReducedValueData ||
                   OpData == ReductionData)) {
           const bool IsReductionOperation = OpData == ReductionData;
-          // Only handle trees in the current basic block.
+          // Only handle trees in the current basic block, unless the tree may
+          // span several blocks.
           if (!ReductionData.hasSameParent(I, B->getParent(),
-                                           IsReductionOperation)) {
+                                           IsReductionOperation) &&
+              !canReduceAcrossBlocks(I, TreeN, B->getParent(),
+                                     IsReductionOperation)) {
             // I is an extra argument for TreeN (its parent operation).
             markExtraArg(Stack.back(), I);
             continue;
@@ -6319,6 +6376,8 @@ public:
       // NextV is an extra argument for TreeN (its parent operation).
       markExtraArg(Stack.back(), NextV);
     }
+    if (DT)
+      groupReducedValuesByBlock();
     return true;
   }
 
@@ -6360,7 +6419,27 @@ public:
     SmallVector<Value *, 16> IgnoreList;
     for (auto &V : ReductionOps)
       IgnoreList.append(V.begin(), V.end());
+    // The reduced values left for the scalar part of the reduction.
+    SmallVector<Value *, 16> RemainingVals;
     while (i < NumReducedVals - ReduxWidth + 1 && ReduxWidth > 2) {
+      // A vector tree is only built from the values of one block. Leave the
+      // blocks with too few values for the scalar part of the reduction.
+      if (DT) {
+        BasicBlock *BB = cast<Instruction>(ReducedVals[i])->getParent();
+        unsigned GroupEnd = i + 1;
+        while (GroupEnd < NumReducedVals &&
+               cast<Instruction>(ReducedVals[GroupEnd])->getParent() == BB)
+          ++GroupEnd;
+        ReduxWidth =
+            std::min<unsigned>(ReduxWidth, PowerOf2Floor(GroupEnd - i));
+        if (ReduxWidth <= 2) {
+          RemainingVals.append(ReducedVals.begin() + i,
+                               ReducedVals.begin() + GroupEnd);
+          i = GroupEnd;
+          ReduxWidth = PowerOf2Floor(NumReducedVals - i);
+          continue;
+        }
+      }
       auto VL = makeArrayRef(&ReducedVals[i], ReduxWidth);
       V.buildTree(VL, ExternallyUsedValues, IgnoreList);
       Optional<ArrayRef<unsigned>> Order = V.bestOrder();
@@ -6426,8 +6505,9 @@ public:
 
     if (VectorizedTree) {
       // Finish the reduction.
-      for (; i < NumReducedVals; ++i) {
-        auto *I = cast<Instruction>(ReducedVals[i]);
+      RemainingVals.append(ReducedVals.begin() + i, ReducedVals.end());
+      for (Value *V : RemainingVals) {
+        auto *I = cast<Instruction>(V);
         Builder.SetCurrentDebugLocation(I->getDebugLoc());
         OperationData VectReductionData(ReductionData.getOpcode(),
                                         VectorizedTree, I,
@@ -6682,9 +6762,11 @@ static Value *getReductionValue(const DominatorTree *DT, PHINode *P,
 /// \returns false if a horizontal reduction was not matched (or not possible)
 /// or no vectorization of any binary operation feeding \a Root instruction was
 /// performed.
+/// With -slp-vectorize-across-blocks, \a DT and \a LI are used to match
+/// reductions reaching into the blocks dominating \a BB.
 static bool tryToVectorizeHorReductionOrInstOperands(
     PHINode *P, Instruction *Root, BasicBlock *BB, BoUpSLP &R,
-    TargetTransformInfo *TTI,
+    TargetTransformInfo *TTI, const DominatorTree *DT, const LoopInfo *LI,
     const function_ref<bool(Instruction *, BoUpSLP &)> Vectorize) {
   if (!ShouldVectorizeHor)
     return false;
@@ -6714,7 +6796,11 @@ static bool tryToVectorizeHorReductionOrInstOperands(
     auto *SI = dyn_cast<SelectInst>(Inst);
     if (BI || SI) {
       HorizontalReduction HorRdx;
-      if (HorRdx.matchAssociativeReduction(P, Inst)) {
+      bool Matched =
+          ShouldVectorizeAcrossBlocks
+              ? HorRdx.matchAssociativeReduction(P, Inst, DT, LI)
+              : HorRdx.matchAssociativeReduction(P, Inst);
+      if (Matched) {
         if (HorRdx.tryToReduce(R, TTI)) {
           Res = true;
           // Set P to nullptr to avoid re-analysis of phi node in
@@ -6771,10 +6857,30 @@ bool SLPVectorizerPass::vectorizeRootInstruction(PHINode *P, Value *V,
   auto &&ExtraVectorization = [this](Instruction *I, BoUpSLP &R) -> bool {
     return tryToVectorize(I, R);
   };
-  return tryToVectorizeHorReductionOrInstOperands(P, I, BB, R, TTI,
+  return tryToVectorizeHorReductionOrInstOperands(P, I, BB, R, TTI, DT, LI,
                                                   ExtraVectorization);
 }
 
+bool SLPVectorizerPass::vectorizeIncomingValues(PHINode *P, BasicBlock *BB,
+                                                BoUpSLP &R) {
+  // The reduction value of the PHI is handled as the root of a reduction of
+  // the PHI itself.
+  Value *Rdx = P->getNumIncomingValues() == 2
+                   ? getReductionValue(DT, P, BB, LI)
+                   : nullptr;
+  bool Changed = false;
+  SmallPtrSet<Value *, 4> Visited;
+  for (unsigned Idx = 0, E = P->getNumIncomingValues(); Idx != E; ++Idx) {
+    Value *V = P->getIncomingValue(Idx);
+    BasicBlock *IncomingBB = P->getIncomingBlock(Idx);
+    if (V == Rdx || IncomingBB == BB || !DT->isReachableFromEntry(IncomingBB) ||
+        !Visited.insert(V).second)
+      continue;
+    Changed |= vectorizeRootInstruction(nullptr, V, IncomingBB, R, TTI);
+  }
+  return Changed;
+}
+
 bool SLPVectorizerPass::vectorizeInsertValueInst(InsertValueInst *IVI,
                                                  BasicBlock *BB, BoUpSLP &R) {
   const DataLayout &DL = BB->getModule()->getDataLayout();
@@ -6920,6 +7026,15 @@ bool SLPVectorizerPass::vectorizeChainsInBlock(BasicBlock *BB, BoUpSLP &R) {
 
     // Try to vectorize reductions that use PHINodes.
     if (PHINode *P = dyn_cast<PHINode>(it)) {
+      // Across blocks, also try the values flowing into the PHI from the
+      // predecessors, such as the reductions in the arms of an if/else.
+      if (ShouldVectorizeAcrossBlocks && vectorizeIncomingValues(P, BB, R)) {
+        Changed = true;
+        it = BB->begin();
+        e = BB->end();
+        continue;
+      }
+
       // Check that the PHI is a reduction PHI.
       if (P->getNumIncomingValues() != 2)
         return Changed;
@@ -43,7 +43,6 @@
 #include <vector>
 
 using namespace llvm;
-extern cl::opt<bool> EnableVPlanNativePath;
 
 #define DEBUG_TYPE "vplan"
 
@@ -132,7 +131,7 @@ VPBasicBlock::createEmptyBasicBlock(VPTransformState::CFGState &CFG) {
     // and latch blocks. As a result, we never enter this function for the
     // header block in the non VPlan-native path.
     if (!PredBB) {
-      assert(EnableVPlanNativePath &&
+      assert(CFG.OuterLoop &&
              "Unexpected null predecessor in non VPlan-native path");
       CFG.VPBBsToFix.push_back(PredVPBB);
       continue;
@@ -200,7 +199,7 @@ void VPBasicBlock::execute(VPTransformState *State) {
     Recipe.execute(*State);
 
   VPValue *CBV;
-  if (EnableVPlanNativePath && (CBV = getCondBit())) {
+  if (State->CFG.OuterLoop && (CBV = getCondBit())) {
     Value *IRCBV = CBV->getUnderlyingValue();
     assert(IRCBV && "Unexpected null underlying value for condition bit");
 
@@ -233,7 +232,7 @@ void VPRegionBlock::execute(VPTransformState *State) {
   if (!isReplicator()) {
     // Visit the VPBlocks connected to "this", starting from it.
     for (VPBlockBase *Block : RPOT) {
-      if (EnableVPlanNativePath) {
+      if (State->CFG.OuterLoop) {
         // The inner loop vectorization path does not represent loop preheader
         // and exit blocks as part of the VPlan. In the VPlan-native path, skip
         // vectorizing loop preheader block. In future, we may replace this
@@ -413,7 +412,7 @@ void VPlan::execute(VPTransformState *State) {
   // Setup branch terminator successors for VPBBs in VPBBsToFix based on
   // VPBB's successors.
   for (auto VPBB : State->CFG.VPBBsToFix) {
-    assert(EnableVPlanNativePath &&
+    assert(State->CFG.OuterLoop &&
            "Unexpected VPBBsToFix in non VPlan-native path");
     BasicBlock *BB = State->CFG.VPBB2IRBB[VPBB];
     assert(BB && "Unexpected null basic block for VPBB");
@@ -431,10 +430,10 @@ void VPlan::execute(VPTransformState *State) {
   // 3. Merge the temporary latch created with the last basic-block filled.
   BasicBlock *LastBB = State->CFG.PrevBB;
   // Connect LastBB to VectorLatchBB to facilitate their merge.
-  assert((EnableVPlanNativePath ||
+  assert((State->CFG.OuterLoop ||
           isa<UnreachableInst>(LastBB->getTerminator())) &&
          "Expected InnerLoop VPlan CFG to terminate with unreachable");
-  assert((!EnableVPlanNativePath || isa<BranchInst>(LastBB->getTerminator())) &&
+  assert((!State->CFG.OuterLoop || isa<BranchInst>(LastBB->getTerminator())) &&
          "Expected VPlan CFG to terminate with branch in NativePath");
   LastBB->getTerminator()->eraseFromParent();
   BranchInst::Create(VectorLatchBB, LastBB);
@@ -446,7 +445,7 @@ void VPlan::execute(VPTransformState *State) {
   VectorLatchBB = LastBB;
 
   // We do not attempt to preserve DT for outer loop vectorization currently.
-  if (!EnableVPlanNativePath)
+  if (!State->CFG.OuterLoop)
     updateDominatorTree(State->DT, VectorPreHeaderBB, VectorLatchBB);
 }
 
@@ -299,6 +299,10 @@ struct VPTransformState {
     /// up at the end of vector code generation.
     SmallVector<VPBasicBlock *, 8> VPBBsToFix;
 
+    /// True if the VPlan of an outer loop is executed, in the VPlan-native
+    /// path.
+    bool OuterLoop = false;
+
     CFGState() = default;
   } CFG;
 
@@ -2586,6 +2586,24 @@ bool DwarfLinker::link(const DebugMap &Map) {
       Options.TheAccelTableKind = AccelTableKind::Apple;
   }
 
+  // Extracting the DIEs is the bulk of the cost of reading the input debug
+  // info. Every object owns its DWARFContext, so the DIEs of all objects can
+  // be extracted concurrently ahead of the serial loop below, which then only
+  // walks already parsed units. Nothing shared by the link is touched here,
+  // so the output doesn't depend on the scheduling.
+  if (Options.Threads > 1) {
+    ThreadPool Pool(std::min<unsigned>(Options.Threads, NumObjects));
+    for (LinkContext &LinkContext : ObjectContexts) {
+      if (!LinkContext.ObjectFile || !LinkContext.DwarfContext)
+        continue;
+      Pool.async([&LinkContext]() {
+        for (const auto &CU : LinkContext.DwarfContext->compile_units())
+          CU->getUnitDIE(false);
+      });
+    }
+    Pool.wait();
+  }
+
   for (LinkContext &LinkContext : ObjectContexts) {
     if (Options.Verbose)
       outs() << "DEBUG MAP OBJECT: " << LinkContext.DMO.getObjectFilename()
@@ -188,6 +188,9 @@ namespace options {
   static std::string thinlto_object_suffix_replace;
   // Optional path to a directory for caching ThinLTO objects.
   static std::string cache_dir;
+  // Optional path to a directory, shared with other machines, which is used as
+  // a second-level cache for ThinLTO objects.
+  static std::string remote_cache_dir;
   // Optional pruning policy for ThinLTO caches.
   static std::string cache_policy;
   // Additional options to pass into the code generator.
@@ -258,6 +261,8 @@ namespace options {
                 "thinlto-object-suffix-replace expects 'old;new' format");
     } else if (opt.startswith("cache-dir=")) {
       cache_dir = opt.substr(strlen("cache-dir="));
+    } else if (opt.startswith("remote-cache-dir=")) {
+      remote_cache_dir = opt.substr(strlen("remote-cache-dir="));
     } else if (opt.startswith("cache-policy=")) {
       cache_policy = opt.substr(strlen("cache-policy="));
     } else if (opt.size() == 2 && opt[0] == 'O') {
@@ -1051,12 +1056,33 @@ static std::vector<std::pair<SmallString<128>, bool>> runLTO() {
   };
 
   auto AddBuffer = [&](size_t Task, std::unique_ptr<MemoryBuffer> MB) {
+    // A cache hit is normally backed by a file in the cache directory. Hand
+    // gold a hard link to that file instead of copying the object's contents
+    // into a new temporary file. The link keeps the object alive even if the
+    // cache entry is pruned before gold reads it.
+    if (!SaveTemps) {
+      StringRef EntryPath = MB->getBufferIdentifier();
+      uint64_t Size;
+      SmallString<128> LinkPath;
+      if (!sys::fs::file_size(EntryPath, Size) &&
+          Size == MB->getBufferSize() &&
+          !sys::fs::getPotentiallyUniqueTempFileName("lto-llvm", "o",
+                                                     LinkPath) &&
+          !sys::fs::create_hard_link(EntryPath, LinkPath)) {
+        Files[Task] = {LinkPath, /* TempOutFile */ true};
+        return;
+      }
+    }
     *AddStream(Task)->OS << MB->getBuffer();
   };
 
   NativeObjectCache Cache;
-  if (!options::cache_dir.empty())
-    Cache = check(localCache(options::cache_dir, AddBuffer));
+  if (!options::cache_dir.empty()) {
+    std::shared_ptr<RemoteObjectCache> Remote;
+    if (!options::remote_cache_dir.empty())
+      Remote = check(directoryRemoteCache(options::remote_cache_dir));
+    Cache = check(tieredCache(options::cache_dir, std::move(Remote), AddBuffer));
+  }
 
   check(Lto->run(AddStream, Cache));
 
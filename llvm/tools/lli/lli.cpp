@@ -57,6 +57,8 @@
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Transforms/Instrumentation.h"
 #include <cerrno>
+#include <chrono>
+#include <thread>
 
 #ifdef __CYGWIN__
 #include <cygwin/version.h>
@@ -104,6 +106,19 @@ namespace {
                     cl::desc("calls the given entry-point on a new thread "
                              "(jit-kind=orc-lazy only)"));
 
+  cl::opt<unsigned> LookupBenchmarkThreads(
+      "lookup-benchmark-threads",
+      cl::desc("Instead of running main, look up the functions of the main "
+               "module concurrently on the given number of threads, and "
+               "report the lookup throughput (jit-kind=orc-lazy only)"),
+      cl::init(0));
+
+  cl::opt<unsigned> LookupBenchmarkIterations(
+      "lookup-benchmark-iterations",
+      cl::desc("Number of times each -lookup-benchmark-threads thread looks "
+               "up each function"),
+      cl::init(1000));
+
   cl::opt<bool> PerModuleLazy(
       "per-module-lazy",
       cl::desc("Performs lazy compilation on whole module boundaries "
@@ -740,6 +755,30 @@ static std::function<void(Module &)> createDebugDumper() {
 
 static void exitOnLazyCallThroughFailure() { exit(1); }
 
+// Look up the given functions from several threads at once. The first lookups
+// emit the lazy call-through stubs, the others find them ready.
+static void runLookupBenchmark(orc::LLLazyJIT &J,
+                               ArrayRef<std::string> FunctionNames) {
+  std::vector<std::thread> Threads;
+  auto Start = std::chrono::steady_clock::now();
+  for (unsigned I = 0; I != LookupBenchmarkThreads; ++I)
+    Threads.push_back(std::thread([&]() {
+      for (unsigned It = 0; It != LookupBenchmarkIterations; ++It)
+        for (auto &Name : FunctionNames)
+          ExitOnErr(J.lookup(Name));
+    }));
+  for (auto &T : Threads)
+    T.join();
+  std::chrono::duration<double> Elapsed =
+      std::chrono::steady_clock::now() - Start;
+
+  uint64_t NumLookups = uint64_t(LookupBenchmarkThreads) *
+                        LookupBenchmarkIterations * FunctionNames.size();
+  outs() << NumLookups << " lookups on " << LookupBenchmarkThreads
+         << " threads in " << format("%.3f", Elapsed.count()) << "s ("
+         << format("%.0f", NumLookups / Elapsed.count()) << " lookups/s)\n";
+}
+
 int runOrcLazyJIT(const char *ProgName) {
   // Start setting up the JIT environment.
 
@@ -750,6 +789,12 @@ int runOrcLazyJIT(const char *ProgName) {
   if (!MainModule)
     reportError(Err, ProgName);
 
+  std::vector<std::string> BenchmarkFunctions;
+  if (LookupBenchmarkThreads != 0)
+    for (auto &F : *MainModule)
+      if (!F.isDeclaration() && !F.hasLocalLinkage())
+        BenchmarkFunctions.push_back(F.getName());
+
   const auto &TT = MainModule->getTargetTriple();
   orc::LLLazyJITBuilder Builder;
 
@@ -859,6 +904,13 @@ int runOrcLazyJIT(const char *ProgName) {
   // Run any static constructors.
   ExitOnErr(J->runConstructors());
 
+  if (LookupBenchmarkThreads != 0) {
+    runLookupBenchmark(*J, BenchmarkFunctions);
+    ExitOnErr(J->runDestructors());
+    CXXRuntimeOverrides.runDestructors();
+    return 0;
+  }
+
   // Run any -thread-entry points.
   std::vector<std::thread> AltEntryThreads;
   for (auto &ThreadEntryPoint : ThreadEntryPoints) {
@@ -906,6 +958,11 @@ void disallowOrcOptions() {
     exit(1);
   }
 
+  if (LookupBenchmarkThreads != 0) {
+    errs() << "-lookup-benchmark-threads requires -jit-kind=orc-lazy\n";
+    exit(1);
+  }
+
   if (PerModuleLazy) {
     errs() << "-per-module-lazy requires -jit-kind=orc-lazy\n";
     exit(1);
@@ -48,7 +48,6 @@
 #include "llvm/Support/ThreadPool.h"
 #include "llvm/Support/Threading.h"
 #include <algorithm>
-#include <mutex>
 #include <utility>
 
 /// The semantic version combined as a string.
@@ -148,44 +147,52 @@ json::Object renderFile(const coverage::CoverageMapping &Coverage,
   return File;
 }
 
-json::Array renderFiles(const coverage::CoverageMapping &Coverage,
-                        ArrayRef<std::string> SourceFiles,
-                        ArrayRef<FileCoverageSummary> FileReports,
-                        const CoverageViewOptions &Options) {
+/// Render the files in batches of a few files per thread: the files of a
+/// batch are rendered in parallel, then streamed out in order, so that only
+/// the JSON values of one batch are in memory at once.
+void renderFiles(json::OStream &JOS, const coverage::CoverageMapping &Coverage,
+                 ArrayRef<std::string> SourceFiles,
+                 ArrayRef<FileCoverageSummary> FileReports,
+                 const CoverageViewOptions &Options) {
   auto NumThreads = Options.NumThreads;
   if (NumThreads == 0) {
     NumThreads = std::max(1U, std::min(llvm::heavyweight_hardware_concurrency(),
                                        unsigned(SourceFiles.size())));
   }
   ThreadPool Pool(NumThreads);
-  json::Array FileArray;
-  std::mutex FileArrayMutex;
-
-  for (unsigned I = 0, E = SourceFiles.size(); I < E; ++I) {
-    auto &SourceFile = SourceFiles[I];
-    auto &FileReport = FileReports[I];
-    Pool.async([&] {
-      auto File = renderFile(Coverage, SourceFile, FileReport, Options);
-      {
-        std::lock_guard<std::mutex> Lock(FileArrayMutex);
-        FileArray.push_back(std::move(File));
-      }
-    });
+  const unsigned BatchSize = NumThreads * 16;
+  std::vector<json::Value> Batch;
+
+  for (unsigned Begin = 0, E = SourceFiles.size(); Begin < E;
+       Begin += BatchSize) {
+    unsigned End = std::min(Begin + BatchSize, E);
+    Batch.assign(End - Begin, nullptr);
+    for (unsigned I = Begin; I < End; ++I) {
+      Pool.async([&, I] {
+        Batch[I - Begin] =
+            renderFile(Coverage, SourceFiles[I], FileReports[I], Options);
+      });
+    }
+    Pool.wait();
+    for (const json::Value &File : Batch)
+      JOS.value(File);
   }
-  Pool.wait();
-  return FileArray;
 }
 
-json::Array renderFunctions(
+void renderFunctions(
+    json::OStream &JOS,
     const iterator_range<coverage::FunctionRecordIterator> &Functions) {
-  json::Array FunctionArray;
-  for (const auto &F : Functions)
-    FunctionArray.push_back(
-        json::Object({{"name", F.Name},
-                      {"count", int64_t(F.ExecutionCount)},
-                      {"regions", renderRegions(F.CountedRegions)},
-                      {"filenames", json::Array(F.Filenames)}}));
-  return FunctionArray;
+  for (const auto &F : Functions) {
+    JOS.object([&] {
+      JOS.attribute("count", int64_t(F.ExecutionCount));
+      JOS.attribute("filenames", json::Array(F.Filenames));
+      JOS.attribute("name", F.Name);
+      JOS.attributeArray("regions", [&] {
+        for (const auto &Region : F.CountedRegions)
+          JOS.value(renderRegion(Region));
+      });
+    });
+  }
 }
 
 } // end anonymous namespace
@@ -200,30 +207,32 @@ void CoverageExporterJson::renderRoot(const CoverageFilters &IgnoreFilters) {
 }
 
 void CoverageExporterJson::renderRoot(ArrayRef<std::string> SourceFiles) {
+  // Sort files in order of their names.
+  std::vector<std::string> SortedFiles(SourceFiles.begin(), SourceFiles.end());
+  llvm::sort(SortedFiles);
   FileCoverageSummary Totals = FileCoverageSummary("Totals");
   auto FileReports = CoverageReport::prepareFileReports(Coverage, Totals,
-                                                        SourceFiles, Options);
-  auto Files = renderFiles(Coverage, SourceFiles, FileReports, Options);
-  // Sort files in order of their names.
-  std::sort(Files.begin(), Files.end(),
-    [](const json::Value &A, const json::Value &B) {
-      const json::Object *ObjA = A.getAsObject();
-      const json::Object *ObjB = B.getAsObject();
-      assert(ObjA != nullptr && "Value A was not an Object");
-      assert(ObjB != nullptr && "Value B was not an Object");
-      const StringRef FilenameA = ObjA->getString("filename").getValue();
-      const StringRef FilenameB = ObjB->getString("filename").getValue();
-      return FilenameA.compare(FilenameB) < 0;
+                                                        SortedFiles, Options);
+
+  // Stream the export out rather than building the whole JSON document in
+  // memory, the detailed coverage of a large project does not fit there. The
+  // attributes are emitted in the sorted order json::Object prints them in.
+  json::OStream JOS(OS);
+  JOS.object([&] {
+    JOS.attributeArray("data", [&] {
+      JOS.object([&] {
+        JOS.attributeArray("files", [&] {
+          renderFiles(JOS, Coverage, SortedFiles, FileReports, Options);
+        });
+        // Skip functions-level information  if necessary.
+        if (!Options.ExportSummaryOnly && !Options.SkipFunctions)
+          JOS.attributeArray("functions", [&] {
+            renderFunctions(JOS, Coverage.getCoveredFunctions());
+          });
+        JOS.attribute("totals", renderSummary(Totals));
+      });
     });
-  auto Export = json::Object(
-      {{"files", std::move(Files)}, {"totals", renderSummary(Totals)}});
-  // Skip functions-level information  if necessary.
-  if (!Options.ExportSummaryOnly && !Options.SkipFunctions)
-    Export["functions"] = renderFunctions(Coverage.getCoveredFunctions());
-
-  auto ExportArray = json::Array({std::move(Export)});
-
-  OS << json::Object({{"version", LLVM_COVERAGE_EXPORT_JSON_STR},
-                      {"type", LLVM_COVERAGE_EXPORT_JSON_TYPE_STR},
-                      {"data", std::move(ExportArray)}});
+    JOS.attribute("type", LLVM_COVERAGE_EXPORT_JSON_TYPE_STR);
+    JOS.attribute("version", LLVM_COVERAGE_EXPORT_JSON_STR);
+  });
 }
@@ -6,6 +6,8 @@
 #include "llvm/DebugInfo/DWARF/DWARFDebugLoc.h"
 #include "llvm/Object/ObjectFile.h"
 #include "llvm/Support/JSON.h"
+#include "llvm/Support/ThreadPool.h"
+#include "llvm/Support/Threading.h"
 
 #define DEBUG_TYPE "dwarfdump"
 using namespace llvm;
@@ -447,6 +449,72 @@ static void collectStatsRecursive(DWARFDie Die, uint64_t UnitLowPC, std::string
   }
 }
 
+/// Add the statistics of one compile unit to those of the previous ones.
+/// \{
+static void mergeStats(PerFunctionStats &Stats,
+                       const PerFunctionStats &UnitStats) {
+  Stats.NumFnInlined += UnitStats.NumFnInlined;
+  Stats.NumAbstractOrigins += UnitStats.NumAbstractOrigins;
+  Stats.TotalVarWithLoc += UnitStats.TotalVarWithLoc;
+  Stats.ConstantMembers += UnitStats.ConstantMembers;
+  for (const auto &Var : UnitStats.VarsInFunction)
+    Stats.VarsInFunction.insert(Var.getKey());
+  Stats.IsFunction |= UnitStats.IsFunction;
+  Stats.HasPCAddresses |= UnitStats.HasPCAddresses;
+  Stats.HasSourceLocation |= UnitStats.HasSourceLocation;
+  Stats.NumParams += UnitStats.NumParams;
+  Stats.NumParamSourceLocations += UnitStats.NumParamSourceLocations;
+  Stats.NumParamTypes += UnitStats.NumParamTypes;
+  Stats.NumParamLocations += UnitStats.NumParamLocations;
+  Stats.NumVars += UnitStats.NumVars;
+  Stats.NumVarSourceLocations += UnitStats.NumVarSourceLocations;
+  Stats.NumVarTypes += UnitStats.NumVarTypes;
+  Stats.NumVarLocations += UnitStats.NumVarLocations;
+}
+
+static void mergeStats(GlobalStats &Stats, const GlobalStats &UnitStats) {
+  Stats.ScopeBytesCovered += UnitStats.ScopeBytesCovered;
+  Stats.ScopeBytesFromFirstDefinition +=
+      UnitStats.ScopeBytesFromFirstDefinition;
+  Stats.ScopeEntryValueBytesCovered += UnitStats.ScopeEntryValueBytesCovered;
+  Stats.ParamScopeBytesCovered += UnitStats.ParamScopeBytesCovered;
+  Stats.ParamScopeBytesFromFirstDefinition +=
+      UnitStats.ParamScopeBytesFromFirstDefinition;
+  Stats.ParamScopeEntryValueBytesCovered +=
+      UnitStats.ParamScopeEntryValueBytesCovered;
+  Stats.VarScopeBytesCovered += UnitStats.VarScopeBytesCovered;
+  Stats.VarScopeBytesFromFirstDefinition +=
+      UnitStats.VarScopeBytesFromFirstDefinition;
+  Stats.VarScopeEntryValueBytesCovered +=
+      UnitStats.VarScopeEntryValueBytesCovered;
+  Stats.CallSiteEntries += UnitStats.CallSiteEntries;
+  Stats.CallSiteDIEs += UnitStats.CallSiteDIEs;
+  Stats.CallSiteParamDIEs += UnitStats.CallSiteParamDIEs;
+  Stats.FunctionSize += UnitStats.FunctionSize;
+  Stats.InlineFunctionSize += UnitStats.InlineFunctionSize;
+}
+
+static void mergeStats(LocationStats &Stats, const LocationStats &UnitStats) {
+  auto MergeCoverage = [](std::vector<unsigned> &Coverage,
+                          const std::vector<unsigned> &UnitCoverage) {
+    for (unsigned I = 0; I < NumOfCoverageCategories; ++I)
+      Coverage[I] += UnitCoverage[I];
+  };
+  MergeCoverage(Stats.VarParamLocStats, UnitStats.VarParamLocStats);
+  MergeCoverage(Stats.VarParamNonEntryValLocStats,
+                UnitStats.VarParamNonEntryValLocStats);
+  MergeCoverage(Stats.ParamLocStats, UnitStats.ParamLocStats);
+  MergeCoverage(Stats.ParamNonEntryValLocStats,
+                UnitStats.ParamNonEntryValLocStats);
+  MergeCoverage(Stats.VarLocStats, UnitStats.VarLocStats);
+  MergeCoverage(Stats.VarNonEntryValLocStats,
+                UnitStats.VarNonEntryValLocStats);
+  Stats.NumVarParam += UnitStats.NumVarParam;
+  Stats.NumParam += UnitStats.NumParam;
+  Stats.NumVar += UnitStats.NumVar;
+}
+/// \}
+
 /// Print machine-readable output.
 /// The machine-readable format is single-line JSON output.
 /// \{
@@ -487,16 +555,63 @@ static void printLocationStats(raw_ostream &OS,
 /// of particular optimizations. The raw numbers themselves are not particularly
 /// useful, only the delta between compiling the same program with different
 /// compilers is.
+///
+/// The compile units are visited by \p NumThreads threads, or one per core if
+/// it is 0, and their statistics are added up afterwards.
 bool collectStatsForObjectFile(ObjectFile &Obj, DWARFContext &DICtx,
-                               Twine Filename, raw_ostream &OS) {
+                               Twine Filename, raw_ostream &OS,
+                               unsigned NumThreads) {
   StringRef FormatName = Obj.getFileFormatName();
   GlobalStats GlobalStats;
   LocationStats LocStats;
   StringMap<PerFunctionStats> Statistics;
-  for (const auto &CU : static_cast<DWARFContext *>(&DICtx)->compile_units())
-    if (DWARFDie CUDie = CU->getNonSkeletonUnitDIE(false))
-      collectStatsRecursive(CUDie, getLowPC(CUDie), "/", "g", 0, 0, 0,
-                            Statistics, GlobalStats, LocStats);
+  // Every DIE of every unit gets visited, so extract them all in parallel.
+  DICtx.extractAllDIEs(NumThreads);
+
+  // Load the split units and parse the state that the units share up front;
+  // after that, visiting a unit only reads the context.
+  std::vector<DWARFDie> CUDies;
+  for (const auto &CU : DICtx.compile_units()) {
+    DWARFDie CUDie = CU->getNonSkeletonUnitDIE(/*ExtractUnitDIEOnly=*/true);
+    if (!CUDie)
+      continue;
+    CUDie.getDwarfUnit()->getAbbreviations();
+    CUDie.getDwarfUnit()->getContext().getDebugLoc();
+    CUDies.push_back(CUDie);
+  }
+
+  struct UnitStats {
+    StringMap<PerFunctionStats> Functions;
+    struct GlobalStats Global;
+    LocationStats Loc;
+  };
+  std::vector<UnitStats> PerUnit(CUDies.size());
+  auto CollectUnit = [&](size_t I) {
+    // A split unit only has its unit DIE so far.
+    DWARFDie CUDie = CUDies[I].getDwarfUnit()->getUnitDIE(false);
+    collectStatsRecursive(CUDie, getLowPC(CUDie), "/", "g", 0, 0, 0,
+                          PerUnit[I].Functions, PerUnit[I].Global,
+                          PerUnit[I].Loc);
+  };
+  if (NumThreads == 0)
+    NumThreads = heavyweight_hardware_concurrency();
+  if (NumThreads <= 1 || CUDies.size() <= 1) {
+    for (size_t I = 0; I != CUDies.size(); ++I)
+      CollectUnit(I);
+  } else {
+    ThreadPool Pool(std::min<size_t>(NumThreads, CUDies.size()));
+    for (size_t I = 0; I != CUDies.size(); ++I)
+      Pool.async(CollectUnit, I);
+    Pool.wait();
+  }
+
+  // Merge in unit order, so the result doesn't depend on the thread count.
+  for (UnitStats &Unit : PerUnit) {
+    for (auto &Entry : Unit.Functions)
+      mergeStats(Statistics[Entry.getKey()], Entry.getValue());
+    mergeStats(GlobalStats, Unit.Global);
+    mergeStats(LocStats, Unit.Loc);
+  }
 
   /// The version number should be increased every time the algorithm is changed
   /// (including bug fixes). New metrics may be added without increasing the
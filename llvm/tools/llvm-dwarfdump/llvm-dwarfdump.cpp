@@ -195,6 +195,13 @@ static opt<unsigned>
                       cat(DwarfDumpCategory), init(-1U), value_desc("N"));
 static alias ChildRecurseDepthAlias("r", desc("Alias for -recurse-depth."),
                                     aliasopt(ChildRecurseDepth));
+static opt<unsigned>
+    NumThreads("num-threads",
+               desc("Number of threads used by -verify and -statistics "
+                    "(0 = one per core)."),
+               cat(DwarfDumpCategory), init(1), value_desc("N"));
+static alias NumThreadsAlias("j", desc("Alias for -num-threads."),
+                             aliasopt(NumThreads));
 static opt<unsigned>
     ParentRecurseDepth("parent-recurse-depth",
                        desc("Only recurse to a depth of N when displaying "
@@ -244,6 +251,7 @@ static DIDumpOptions getDumpOpts() {
   DumpOpts.ShowForm = ShowForm;
   DumpOpts.SummarizeTypes = SummarizeTypes;
   DumpOpts.Verbose = Verbose;
+  DumpOpts.NumThreads = NumThreads;
   // In -verify mode, print DIEs without children in error messages.
   if (Verify)
     return DumpOpts.noImplicitRecursion();
@@ -411,7 +419,13 @@ static bool lookup(ObjectFile &Obj, DWARFContext &DICtx, uint64_t Address,
 }
 
 bool collectStatsForObjectFile(ObjectFile &Obj, DWARFContext &DICtx,
-                               Twine Filename, raw_ostream &OS);
+                               Twine Filename, raw_ostream &OS,
+                               unsigned NumThreads);
+
+static bool collectStats(ObjectFile &Obj, DWARFContext &DICtx, Twine Filename,
+                         raw_ostream &OS) {
+  return collectStatsForObjectFile(Obj, DICtx, Filename, OS, NumThreads);
+}
 
 static bool dumpObjectFile(ObjectFile &Obj, DWARFContext &DICtx, Twine Filename,
                            raw_ostream &OS) {
@@ -637,7 +651,7 @@ int main(int argc, char **argv) {
       return 1;
   } else if (Statistics)
     for (auto Object : Objects)
-      handleFile(Object, collectStatsForObjectFile, OutputFile.os());
+      handleFile(Object, collectStats, OutputFile.os());
   else
     for (auto Object : Objects)
       handleFile(Object, dumpObjectFile, OutputFile.os());
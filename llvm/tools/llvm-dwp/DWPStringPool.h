@@ -1,54 +1,43 @@
 #ifndef TOOLS_LLVM_DWP_DWPSTRINGPOOL
 #define TOOLS_LLVM_DWP_DWPSTRINGPOOL
 
+#include "llvm/ADT/CachedHashString.h"
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/MC/MCSection.h"
 #include "llvm/MC/MCStreamer.h"
-#include <cassert>
+#include "llvm/Support/Allocator.h"
+#include "llvm/Support/StringSaver.h"
 
 namespace llvm {
 class DWPStringPool {
-
-  struct CStrDenseMapInfo {
-    static inline const char *getEmptyKey() {
-      return reinterpret_cast<const char *>(~static_cast<uintptr_t>(0));
-    }
-    static inline const char *getTombstoneKey() {
-      return reinterpret_cast<const char *>(~static_cast<uintptr_t>(1));
-    }
-    static unsigned getHashValue(const char *Val) {
-      assert(Val != getEmptyKey() && "Cannot hash the empty key!");
-      assert(Val != getTombstoneKey() && "Cannot hash the tombstone key!");
-      return (unsigned)hash_value(StringRef(Val));
-    }
-    static bool isEqual(const char *LHS, const char *RHS) {
-      if (RHS == getEmptyKey())
-        return LHS == getEmptyKey();
-      if (RHS == getTombstoneKey())
-        return LHS == getTombstoneKey();
-      return strcmp(LHS, RHS) == 0;
-    }
-  };
-
   MCStreamer &Out;
   MCSection *Sec;
-  DenseMap<const char *, uint32_t, CStrDenseMapInfo> Pool;
+  /// Owns the strings in Pool, so that the input files they were read from
+  /// can be released as soon as they have been written.
+  BumpPtrAllocator Alloc;
+  StringSaver Saver{Alloc};
+  DenseMap<CachedHashStringRef, uint32_t> Pool;
   uint32_t Offset = 0;
 
 public:
   DWPStringPool(MCStreamer &Out, MCSection *Sec) : Out(Out), Sec(Sec) {}
 
-  uint32_t getOffset(const char *Str, unsigned Length) {
-    assert(strlen(Str) + 1 == Length && "Ensure length hint is correct");
-
-    auto Pair = Pool.insert(std::make_pair(Str, Offset));
-    if (Pair.second) {
-      Out.SwitchSection(Sec);
-      Out.EmitBytes(StringRef(Str, Length));
-      Offset += Length;
-    }
-
-    return Pair.first->second;
+  /// Returns the offset of \p Str in the output string section, adding it if
+  /// it isn't there yet. The hash of \p Str is computed by the caller, which
+  /// can do so in parallel for many strings.
+  uint32_t getOffset(CachedHashStringRef Str) {
+    auto It = Pool.find(Str);
+    if (It != Pool.end())
+      return It->second;
+
+    StringRef Saved = Saver.save(Str.val());
+    Pool.insert(std::make_pair(CachedHashStringRef(Saved, Str.hash()), Offset));
+    Out.SwitchSection(Sec);
+    // Emit the string with its null terminator, which StringSaver provides.
+    Out.EmitBytes(StringRef(Saved.data(), Saved.size() + 1));
+    uint32_t StrOffset = Offset;
+    Offset += Saved.size() + 1;
+    return StrOffset;
   }
 };
 }
@@ -12,9 +12,11 @@
 //===----------------------------------------------------------------------===//
 #include "DWPError.h"
 #include "DWPStringPool.h"
+#include "llvm/ADT/CachedHashString.h"
 #include "llvm/ADT/MapVector.h"
 #include "llvm/ADT/Optional.h"
 #include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/ScopeExit.h"
 #include "llvm/DebugInfo/DWARF/DWARFContext.h"
 #include "llvm/DebugInfo/DWARF/DWARFFormValue.h"
 #include "llvm/DebugInfo/DWARF/DWARFUnitIndex.h"
@@ -39,6 +41,8 @@
 #include "llvm/Support/Path.h"
 #include "llvm/Support/TargetRegistry.h"
 #include "llvm/Support/TargetSelect.h"
+#include "llvm/Support/ThreadPool.h"
+#include "llvm/Support/Threading.h"
 #include "llvm/Support/ToolOutputFile.h"
 #include "llvm/Support/WithColor.h"
 #include "llvm/Support/raw_ostream.h"
@@ -61,9 +65,18 @@ static cl::opt<std::string> OutputFilename(cl::Required, "o",
                                            cl::value_desc("filename"),
                                            cl::cat(DwpCategory));
 
+static cl::opt<unsigned>
+    NumThreads("j",
+               cl::desc("Number of threads used to read the input files "
+                        "(0 = one per core)"),
+               cl::init(0), cl::cat(DwpCategory));
+static cl::alias NumThreadsAlias("threads", cl::desc("Alias for -j"),
+                                 cl::aliasopt(NumThreads));
+
 static void writeStringsAndOffsets(MCStreamer &Out, DWPStringPool &Strings,
                                    MCSection *StrOffsetSection,
                                    StringRef CurStrSection,
+                                   ArrayRef<CachedHashStringRef> CurStrings,
                                    StringRef CurStrOffsetSection) {
   // Could possibly produce an error or warning if one of these was non-null but
   // the other was null.
@@ -72,16 +85,13 @@ static void writeStringsAndOffsets(MCStreamer &Out, DWPStringPool &Strings,
 
   DenseMap<uint64_t, uint32_t> OffsetRemapping;
 
-  DataExtractor Data(CurStrSection, true, 0);
-  uint64_t LocalOffset = 0;
   uint64_t PrevOffset = 0;
-  while (const char *s = Data.getCStr(&LocalOffset)) {
-    OffsetRemapping[PrevOffset] =
-        Strings.getOffset(s, LocalOffset - PrevOffset);
-    PrevOffset = LocalOffset;
+  for (CachedHashStringRef S : CurStrings) {
+    OffsetRemapping[PrevOffset] = Strings.getOffset(S);
+    PrevOffset += S.size() + 1;
   }
 
-  Data = DataExtractor(CurStrOffsetSection, true, 0);
+  DataExtractor Data(CurStrOffsetSection, true, 0);
 
   Out.SwitchSection(StrOffsetSection);
 
@@ -389,41 +399,84 @@ handleCompressedSection(std::deque<SmallString<32>> &UncompressedSections,
   return Error::success();
 }
 
-static Error handleSection(
-    const StringMap<std::pair<MCSection *, DWARFSectionKind>> &KnownSections,
-    const MCSection *StrSection, const MCSection *StrOffsetSection,
-    const MCSection *TypesSection, const MCSection *CUIndexSection,
-    const MCSection *TUIndexSection, const SectionRef &Section, MCStreamer &Out,
-    std::deque<SmallString<32>> &UncompressedSections,
-    uint32_t (&ContributionOffsets)[8], UnitIndexEntry &CurEntry,
-    StringRef &CurStrSection, StringRef &CurStrOffsetSection,
-    std::vector<StringRef> &CurTypesSection, StringRef &InfoSection,
-    StringRef &AbbrevSection, StringRef &CurCUIndexSection,
-    StringRef &CurTUIndexSection) {
-  if (Section.isBSS())
-    return Error::success();
+using KnownSectionMap =
+    StringMap<std::pair<MCSection *, DWARFSectionKind>>;
+
+namespace {
+/// An input file whose sections have been read and decompressed.
+///
+/// Loading an input doesn't depend on the other inputs, so the inputs are
+/// loaded on a thread pool ahead of the one being written. Only the writing
+/// is done in input order, which keeps the output deterministic.
+struct LoadedInput {
+  OwningBinary<object::ObjectFile> Obj;
+  std::deque<SmallString<32>> UncompressedSections;
+  /// The sections llvm-dwp knows about, in file order. The names have the
+  /// leading "._" and the ".z" of compressed sections stripped.
+  std::vector<std::pair<StringRef, StringRef>> Sections;
+  /// The strings of the .debug_str.dwo section along with their hashes, so
+  /// that merging them into the output string pool is just a lookup.
+  std::vector<CachedHashStringRef> Strings;
+};
+} // end anonymous namespace
 
-  if (Section.isVirtual())
-    return Error::success();
+static Expected<std::unique_ptr<LoadedInput>>
+loadInput(StringRef Input, const KnownSectionMap &KnownSections,
+          const MCSection *StrSection) {
+  auto ErrOrObj = object::ObjectFile::createObjectFile(Input);
+  if (!ErrOrObj)
+    return ErrOrObj.takeError();
+
+  auto L = std::make_unique<LoadedInput>();
+  L->Obj = std::move(*ErrOrObj);
+  for (const auto &Section : L->Obj.getBinary()->sections()) {
+    if (Section.isBSS() || Section.isVirtual())
+      continue;
 
-  Expected<StringRef> NameOrErr = Section.getName();
-  if (!NameOrErr)
-    return NameOrErr.takeError();
-  StringRef Name = *NameOrErr;
+    Expected<StringRef> NameOrErr = Section.getName();
+    if (!NameOrErr)
+      return NameOrErr.takeError();
+    StringRef Name = *NameOrErr;
 
-  Expected<StringRef> ContentsOrErr = Section.getContents();
-  if (!ContentsOrErr)
-    return ContentsOrErr.takeError();
-  StringRef Contents = *ContentsOrErr;
+    Expected<StringRef> ContentsOrErr = Section.getContents();
+    if (!ContentsOrErr)
+      return ContentsOrErr.takeError();
+    StringRef Contents = *ContentsOrErr;
 
-  if (auto Err = handleCompressedSection(UncompressedSections, Name, Contents))
-    return Err;
+    if (auto Err =
+            handleCompressedSection(L->UncompressedSections, Name, Contents))
+      return std::move(Err);
 
-  Name = Name.substr(Name.find_first_not_of("._"));
+    Name = Name.substr(Name.find_first_not_of("._"));
 
+    auto SectionPair = KnownSections.find(Name);
+    if (SectionPair == KnownSections.end())
+      continue;
+    L->Sections.emplace_back(Name, Contents);
+
+    if (SectionPair->second.first == StrSection) {
+      L->Strings.clear();
+      DataExtractor Data(Contents, true, 0);
+      uint64_t Offset = 0;
+      while (const char *S = Data.getCStr(&Offset))
+        L->Strings.emplace_back(S);
+    }
+  }
+  return std::move(L);
+}
+
+static Error handleSection(
+    const KnownSectionMap &KnownSections, const MCSection *StrSection,
+    const MCSection *StrOffsetSection, const MCSection *TypesSection,
+    const MCSection *CUIndexSection, const MCSection *TUIndexSection,
+    StringRef Name, StringRef Contents, MCStreamer &Out,
+    uint32_t (&ContributionOffsets)[8], UnitIndexEntry &CurEntry,
+    StringRef &CurStrSection, StringRef &CurStrOffsetSection,
+    std::vector<StringRef> &CurTypesSection, StringRef &InfoSection,
+    StringRef &AbbrevSection, StringRef &CurCUIndexSection,
+    StringRef &CurTUIndexSection) {
   auto SectionPair = KnownSections.find(Name);
-  if (SectionPair == KnownSections.end())
-    return Error::success();
+  assert(SectionPair != KnownSections.end() && "filtered by loadInput");
 
   if (DWARFSectionKind Kind = SectionPair->second.second) {
     auto Index = Kind - DW_SECT_INFO;
@@ -509,7 +562,7 @@ static Error write(MCStreamer &Out, ArrayRef<std::string> Inputs) {
   MCSection *const TypesSection = MCOFI.getDwarfTypesDWOSection();
   MCSection *const CUIndexSection = MCOFI.getDwarfCUIndexSection();
   MCSection *const TUIndexSection = MCOFI.getDwarfTUIndexSection();
-  const StringMap<std::pair<MCSection *, DWARFSectionKind>> KnownSections = {
+  const KnownSectionMap KnownSections = {
       {"debug_info.dwo", {MCOFI.getDwarfInfoDWOSection(), DW_SECT_INFO}},
       {"debug_types.dwo", {MCOFI.getDwarfTypesDWOSection(), DW_SECT_TYPES}},
       {"debug_str_offsets.dwo", {StrOffsetSection, DW_SECT_STR_OFFSETS}},
@@ -527,18 +580,44 @@ static Error write(MCStreamer &Out, ArrayRef<std::string> Inputs) {
 
   DWPStringPool Strings(Out, StrSection);
 
-  SmallVector<OwningBinary<object::ObjectFile>, 128> Objects;
-  Objects.reserve(Inputs.size());
-
-  std::deque<SmallString<32>> UncompressedSections;
+  // Inputs are loaded ahead of time on the thread pool, but at most Window of
+  // them are held at once, and each is released once it has been written.
+  // This bounds the memory used for inputs independently of their number.
+  unsigned Threads =
+      NumThreads ? NumThreads : heavyweight_hardware_concurrency();
+  ThreadPool Pool(Threads);
+  const size_t Window = 2 * Threads;
+  struct PendingInput {
+    std::shared_future<void> Loaded;
+    Optional<Expected<std::unique_ptr<LoadedInput>>> Result;
+  };
+  std::deque<PendingInput> Pending;
+  size_t NextToLoad = 0;
+  // When returning early with an error, wait for the loads still in flight
+  // and drop their results.
+  auto DrainPending = make_scope_exit([&]() {
+    Pool.wait();
+    for (PendingInput &P : Pending)
+      consumeError(P.Result->takeError());
+  });
 
   for (const auto &Input : Inputs) {
-    auto ErrOrObj = object::ObjectFile::createObjectFile(Input);
-    if (!ErrOrObj)
-      return ErrOrObj.takeError();
-
-    auto &Obj = *ErrOrObj->getBinary();
-    Objects.push_back(std::move(*ErrOrObj));
+    while (NextToLoad != Inputs.size() && Pending.size() < Window) {
+      Pending.emplace_back();
+      PendingInput *P = &Pending.back();
+      StringRef ToLoad = Inputs[NextToLoad++];
+      P->Loaded = Pool.async([P, ToLoad, &KnownSections, StrSection]() {
+        P->Result.emplace(loadInput(ToLoad, KnownSections, StrSection));
+      });
+    }
+    Pending.front().Loaded.wait();
+    Expected<std::unique_ptr<LoadedInput>> LoadedOrErr =
+        std::move(*Pending.front().Result);
+    Pending.pop_front();
+    if (!LoadedOrErr)
+      return LoadedOrErr.takeError();
+    const LoadedInput &L = **LoadedOrErr;
+    auto &Obj = *L.Obj.getBinary();
 
     UnitIndexEntry CurEntry = {};
 
@@ -550,20 +629,20 @@ static Error write(MCStreamer &Out, ArrayRef<std::string> Inputs) {
     StringRef CurCUIndexSection;
     StringRef CurTUIndexSection;
 
-    for (const auto &Section : Obj.sections())
+    for (const auto &Section : L.Sections)
       if (auto Err = handleSection(
               KnownSections, StrSection, StrOffsetSection, TypesSection,
-              CUIndexSection, TUIndexSection, Section, Out,
-              UncompressedSections, ContributionOffsets, CurEntry,
-              CurStrSection, CurStrOffsetSection, CurTypesSection, InfoSection,
-              AbbrevSection, CurCUIndexSection, CurTUIndexSection))
+              CUIndexSection, TUIndexSection, Section.first, Section.second,
+              Out, ContributionOffsets, CurEntry, CurStrSection,
+              CurStrOffsetSection, CurTypesSection, InfoSection, AbbrevSection,
+              CurCUIndexSection, CurTUIndexSection))
         return Err;
 
     if (InfoSection.empty())
       continue;
 
     writeStringsAndOffsets(Out, Strings, StrOffsetSection, CurStrSection,
-                           CurStrOffsetSection);
+                           L.Strings, CurStrOffsetSection);
 
     if (CurCUIndexSection.empty()) {
       Expected<CompileUnitIdentifiers> EID = getCUIdentifiers(
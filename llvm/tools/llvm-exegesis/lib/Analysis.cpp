@@ -11,7 +11,9 @@
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/MC/MCAsmInfo.h"
 #include "llvm/Support/FormatVariadic.h"
+#include <cmath>
 #include <limits>
+#include <set>
 #include <unordered_set>
 #include <vector>
 
@@ -241,6 +243,29 @@ Analysis::makePointsPerSchedClass() const {
   return Entries;
 }
 
+std::vector<Analysis::SchedClassCluster> Analysis::makeSchedClassClusters(
+    const ResolvedSchedClassAndPoints &RSCAndPoints) const {
+  std::vector<SchedClassCluster> SchedClassClusters;
+  for (const size_t PointId : RSCAndPoints.PointIds) {
+    const auto &ClusterId = Clustering_.getClusterIdForPoint(PointId);
+    if (!ClusterId.isValid())
+      continue; // Ignore noise and errors. FIXME: take noise into account ?
+    if (ClusterId.isUnstable() ^ AnalysisDisplayUnstableOpcodes_)
+      continue; // Either display stable or unstable clusters only.
+    auto SchedClassClusterIt =
+        std::find_if(SchedClassClusters.begin(), SchedClassClusters.end(),
+                     [ClusterId](const SchedClassCluster &C) {
+                       return C.id() == ClusterId;
+                     });
+    if (SchedClassClusterIt == SchedClassClusters.end()) {
+      SchedClassClusters.emplace_back();
+      SchedClassClusterIt = std::prev(SchedClassClusters.end());
+    }
+    SchedClassClusterIt->addPoint(PointId, Clustering_);
+  }
+  return SchedClassClusters;
+}
+
 // Uops repeat the same opcode over again. Just show this opcode and show the
 // whole snippet only on hover.
 static void writeUopsSnippetHtml(raw_ostream &OS,
@@ -544,25 +569,8 @@ Error Analysis::run<Analysis::PrintSchedClassInconsistencies>(
   for (const auto &RSCAndPoints : makePointsPerSchedClass()) {
     if (!RSCAndPoints.RSC.SCDesc)
       continue;
-    // Bucket sched class points into sched class clusters.
-    std::vector<SchedClassCluster> SchedClassClusters;
-    for (const size_t PointId : RSCAndPoints.PointIds) {
-      const auto &ClusterId = Clustering_.getClusterIdForPoint(PointId);
-      if (!ClusterId.isValid())
-        continue; // Ignore noise and errors. FIXME: take noise into account ?
-      if (ClusterId.isUnstable() ^ AnalysisDisplayUnstableOpcodes_)
-        continue; // Either display stable or unstable clusters only.
-      auto SchedClassClusterIt =
-          std::find_if(SchedClassClusters.begin(), SchedClassClusters.end(),
-                       [ClusterId](const SchedClassCluster &C) {
-                         return C.id() == ClusterId;
-                       });
-      if (SchedClassClusterIt == SchedClassClusters.end()) {
-        SchedClassClusters.emplace_back();
-        SchedClassClusterIt = std::prev(SchedClassClusters.end());
-      }
-      SchedClassClusterIt->addPoint(PointId, Clustering_);
-    }
+    const std::vector<SchedClassCluster> SchedClassClusters =
+        makeSchedClassClusters(RSCAndPoints);
 
     // Print any scheduling class that has at least one cluster that does not
     // match the checked-in data.
@@ -596,5 +604,107 @@ Error Analysis::run<Analysis::PrintSchedClassInconsistencies>(
   return Error::success();
 }
 
+template <>
+Error Analysis::run<Analysis::PrintSchedClassOverrides>(
+    raw_ostream &OS) const {
+  const auto &Points = Clustering_.getPoints();
+  const auto &FirstPoint = Points[0];
+  const InstructionBenchmark::ModeE Mode = FirstPoint.Mode;
+  const MCSchedModel &SM = SubtargetInfo_->getSchedModel();
+  OS << "// Scheduling model overrides suggested by llvm-exegesis for the sched\n"
+        "// classes whose measurements do not match the model.\n";
+  OS << "// Triple: " << FirstPoint.LLVMTriple << "\n";
+  OS << "// Cpu: " << FirstPoint.CpuName << "\n";
+
+  for (const auto &RSCAndPoints : makePointsPerSchedClass()) {
+    const ResolvedSchedClass &RSC = RSCAndPoints.RSC;
+    if (!RSC.SCDesc)
+      continue;
+    for (const SchedClassCluster &Cluster :
+         makeSchedClassClusters(RSCAndPoints)) {
+      // Measurements that do not make sense cannot be turned into a model.
+      if (!Cluster.getCentroid().validate(Mode) ||
+          Cluster.measurementsMatch(*SubtargetInfo_, RSC, Clustering_,
+                                    AnalysisInconsistencyEpsilonSquared_))
+        continue;
+
+      // Start from the model, and replace what was measured.
+      unsigned ModelLatency = 0;
+      for (int I = 0, E = RSC.SCDesc->NumWriteLatencyEntries; I < E; ++I)
+        ModelLatency = std::max<unsigned>(
+            ModelLatency,
+            SubtargetInfo_->getWriteLatencyEntry(RSC.SCDesc, I)->Cycles);
+      unsigned Latency = ModelLatency;
+      unsigned NumMicroOps = RSC.SCDesc->NumMicroOps;
+
+      OS << "\n// Sched class ";
+#if !defined(NDEBUG) || defined(LLVM_ENABLE_DUMP)
+      OS << RSC.SCDesc->Name;
+#else
+      OS << RSC.SchedClassId;
+#endif
+      OS << ", cluster ";
+      writeClusterId<kEscapeCsv>(OS, Cluster.id());
+      OS << ":\n";
+      for (const PerInstructionStats &Stats : Cluster.getCentroid().getStats()) {
+        OS << "//   measured " << Stats.key() << ": ";
+        writeMeasurementValue<kEscapeCsv>(OS, Stats.avg());
+        OS << " [";
+        writeMeasurementValue<kEscapeCsv>(OS, Stats.min());
+        OS << ";";
+        writeMeasurementValue<kEscapeCsv>(OS, Stats.max());
+        OS << "]\n";
+        if (Mode == InstructionBenchmark::Latency)
+          Latency = std::lround(Stats.avg());
+        else if (Mode == InstructionBenchmark::Uops &&
+                 Stats.key() == "NumMicroOps")
+          NumMicroOps = std::lround(Stats.avg());
+      }
+      OS << "//   model: latency " << ModelLatency << ", uops "
+         << RSC.SCDesc->NumMicroOps << ", inverse throughput ";
+      writeMeasurementValue<kEscapeCsv>(
+          OS, MCSchedModel::getReciprocalThroughput(*SubtargetInfo_,
+                                                    *RSC.SCDesc));
+      OS << "\n";
+      if (Mode == InstructionBenchmark::InverseThroughput)
+        OS << "//   note: adjust ResourceCycles to match the measured inverse "
+              "throughput\n";
+      if (RSC.WasVariant)
+        OS << "//   note: resolved from a variant sched class\n";
+
+      // The opcodes measured in this cluster.
+      std::set<StringRef> Opcodes;
+      for (const size_t PointId : Cluster.getPointIds())
+        Opcodes.insert(
+            InstrInfo_->getName(Points[PointId].keyInstruction().getOpcode()));
+
+      const std::string WriteName = formatv("ExegesisWrite_{0}_{1}",
+                                            RSC.SchedClassId,
+                                            Cluster.id().getId())
+                                        .str();
+      OS << "def " << WriteName << " : SchedWriteRes<[";
+      for (size_t I = 0, E = RSC.NonRedundantWriteProcRes.size(); I < E; ++I) {
+        if (I > 0)
+          OS << ", ";
+        OS << SM.getProcResource(RSC.NonRedundantWriteProcRes[I].ProcResourceIdx)
+                  ->Name;
+      }
+      OS << "]> {\n";
+      OS << "  let Latency = " << Latency << ";\n";
+      OS << "  let NumMicroOps = " << NumMicroOps << ";\n";
+      OS << "  let ResourceCycles = [";
+      for (size_t I = 0, E = RSC.NonRedundantWriteProcRes.size(); I < E; ++I) {
+        if (I > 0)
+          OS << ", ";
+        OS << RSC.NonRedundantWriteProcRes[I].Cycles;
+      }
+      OS << "];\n}\n";
+      OS << "def : InstRW<[" << WriteName << "], (instrs "
+         << join(Opcodes.begin(), Opcodes.end(), ", ") << ")>;\n";
+    }
+  }
+  return Error::success();
+}
+
 } // namespace exegesis
 } // namespace llvm
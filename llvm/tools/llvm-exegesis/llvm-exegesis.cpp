@@ -56,10 +56,21 @@ static cl::opt<std::string>
                 cl::desc("comma-separated list of opcodes to measure, by name"),
                 cl::cat(BenchmarkOptions), cl::init(""));
 
+static cl::opt<std::string> SchedClassOf(
+    "sched-class-of",
+    cl::desc("measure all opcodes that have the same sched class as this "
+             "opcode, by name"),
+    cl::cat(BenchmarkOptions), cl::init(""));
+
 static cl::opt<std::string> SnippetsFile("snippets-file",
                                          cl::desc("code snippets to measure"),
                                          cl::cat(BenchmarkOptions),
                                          cl::init(""));
+static cl::opt<std::string> AnalysisSchedClassOverridesOutputFile(
+    "analysis-sched-class-overrides-output-file",
+    cl::desc("file to write suggested .td overrides for the sched classes "
+             "that do not match the measurements to"),
+    cl::cat(AnalysisOptions), cl::init(""));
 
 static cl::opt<std::string>
     BenchmarkFile("benchmarks-file",
@@ -162,17 +173,18 @@ static cl::opt<bool>
 
 static ExitOnError ExitOnErr;
 
-// Checks that only one of OpcodeNames, OpcodeIndex or SnippetsFile is provided,
-// and returns the opcode indices or {} if snippets should be read from
-// `SnippetsFile`.
+// Checks that only one of OpcodeNames, OpcodeIndex, SchedClassOf or
+// SnippetsFile is provided, and returns the opcode indices or {} if snippets
+// should be read from `SnippetsFile`.
 static std::vector<unsigned> getOpcodesOrDie(const MCInstrInfo &MCInstrInfo) {
   const size_t NumSetFlags = (OpcodeNames.empty() ? 0 : 1) +
                              (OpcodeIndex == 0 ? 0 : 1) +
+                             (SchedClassOf.empty() ? 0 : 1) +
                              (SnippetsFile.empty() ? 0 : 1);
   if (NumSetFlags != 1)
     report_fatal_error(
-        "please provide one and only one of 'opcode-index', 'opcode-name' or "
-        "'snippets-file'");
+        "please provide one and only one of 'opcode-index', 'opcode-name', "
+        "'sched-class-of' or 'snippets-file'");
   if (!SnippetsFile.empty())
     return {};
   if (OpcodeIndex > 0)
@@ -190,6 +202,19 @@ static std::vector<unsigned> getOpcodesOrDie(const MCInstrInfo &MCInstrInfo) {
         return I;
     return 0u;
   };
+  if (!SchedClassOf.empty()) {
+    const unsigned Opcode = ResolveName(SchedClassOf);
+    if (!Opcode)
+      report_fatal_error(Twine("unknown opcode ").concat(SchedClassOf));
+    const unsigned SchedClass = MCInstrInfo.get(Opcode).getSchedClass();
+    if (SchedClass == 0)
+      report_fatal_error(Twine(SchedClassOf).concat(" has no sched class"));
+    std::vector<unsigned> Result;
+    for (unsigned I = 1, E = MCInstrInfo.getNumOpcodes(); I < E; ++I)
+      if (MCInstrInfo.get(I).getSchedClass() == SchedClass)
+        Result.push_back(I);
+    return Result;
+  }
   SmallVector<StringRef, 2> Pieces;
   StringRef(OpcodeNames.getValue())
       .split(Pieces, ",", /* MaxSplit */ -1, /* KeepEmpty */ false);
@@ -318,10 +343,12 @@ static void analysisMain() {
     report_fatal_error("--benchmarks-file must be set.");
 
   if (AnalysisClustersOutputFile.empty() &&
-      AnalysisInconsistenciesOutputFile.empty()) {
+      AnalysisInconsistenciesOutputFile.empty() &&
+      AnalysisSchedClassOverridesOutputFile.empty()) {
     report_fatal_error(
-        "At least one of --analysis-clusters-output-file and "
-        "--analysis-inconsistencies-output-file must be specified.");
+        "At least one of --analysis-clusters-output-file, "
+        "--analysis-inconsistencies-output-file and "
+        "--analysis-sched-class-overrides-output-file must be specified.");
   }
 
   InitializeNativeTarget();
@@ -362,6 +389,8 @@ static void analysisMain() {
   maybeRunAnalysis<Analysis::PrintSchedClassInconsistencies>(
       Analyzer, "sched class consistency analysis",
       AnalysisInconsistenciesOutputFile);
+  maybeRunAnalysis<Analysis::PrintSchedClassOverrides>(
+      Analyzer, "sched class overrides", AnalysisSchedClassOverridesOutputFile);
 }
 
 } // namespace exegesis
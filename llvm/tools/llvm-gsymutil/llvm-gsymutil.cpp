@@ -0,0 +1,157 @@
+//===-- llvm-gsymutil.cpp - GSYM creation and lookup tool -----------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// A utility that converts the DWARF and symbol table of object files into
+// GSYM files, and looks up addresses in GSYM files.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/DebugInfo/DWARF/DWARFContext.h"
+#include "llvm/DebugInfo/GSYM/DwarfTransformer.h"
+#include "llvm/DebugInfo/GSYM/GsymContext.h"
+#include "llvm/DebugInfo/GSYM/GsymCreator.h"
+#include "llvm/DebugInfo/GSYM/GsymReader.h"
+#include "llvm/DebugInfo/GSYM/ObjectFileTransformer.h"
+#include "llvm/Object/ObjectFile.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/InitLLVM.h"
+#include "llvm/Support/WithColor.h"
+#include "llvm/Support/raw_ostream.h"
+
+using namespace llvm;
+using namespace gsym;
+using namespace object;
+
+namespace {
+
+cl::OptionCategory GsymCategory("Specific Options");
+
+cl::list<std::string> InputFilenames(cl::Positional, cl::ZeroOrMore,
+                                     cl::desc("<input GSYM files>"),
+                                     cl::cat(GsymCategory));
+
+cl::opt<std::string>
+    ConvertFilename("convert",
+                    cl::desc("Convert the DWARF and symbol table of the "
+                             "specified object file into a GSYM file."),
+                    cl::value_desc("path"), cl::cat(GsymCategory));
+
+cl::opt<std::string> OutputFilename(
+    "out-file",
+    cl::desc("The GSYM file to create, defaults to the converted object file "
+             "with a .gsym extension."),
+    cl::value_desc("path"), cl::cat(GsymCategory));
+cl::alias OutputFilenameAlias("o", cl::desc("Alias for --out-file"),
+                              cl::aliasopt(OutputFilename));
+
+cl::opt<unsigned>
+    NumThreads("num-threads",
+               cl::desc("Number of threads used to convert the DWARF, or 0 "
+                        "for one per core."),
+               cl::init(0), cl::cat(GsymCategory));
+cl::alias NumThreadsAlias("j", cl::desc("Alias for --num-threads"),
+                          cl::aliasopt(NumThreads));
+
+cl::opt<bool> Quiet("quiet",
+                    cl::desc("Don't print warnings about the converted DWARF."),
+                    cl::cat(GsymCategory));
+
+cl::list<uint64_t> LookupAddresses("address",
+                                   cl::desc("Look up the specified address "
+                                            "in the input GSYM files."),
+                                   cl::value_desc("addr"),
+                                   cl::cat(GsymCategory));
+cl::alias LookupAddressesAlias("a", cl::desc("Alias for --address"),
+                               cl::aliasopt(LookupAddresses));
+
+} // namespace
+
+static StringRef ToolName;
+
+static void error(StringRef Prefix, Error Err) {
+  if (!Err)
+    return;
+  WithColor::error(errs(), ToolName)
+      << Prefix << ": " << toString(std::move(Err)) << '\n';
+  exit(1);
+}
+
+static Error convertObjectFile(StringRef Path, StringRef OutPath) {
+  Expected<OwningBinary<ObjectFile>> ObjOrErr =
+      ObjectFile::createObjectFile(Path);
+  if (!ObjOrErr)
+    return ObjOrErr.takeError();
+  const ObjectFile &Obj = *ObjOrErr->getBinary();
+
+  raw_ostream &Log = Quiet ? nulls() : outs();
+  GsymCreator Gsym;
+  std::unique_ptr<DWARFContext> DICtx = DWARFContext::create(Obj);
+  DwarfTransformer DT(*DICtx, Log, Gsym);
+  // An object without debug info still gets the functions of its symbol
+  // table, so no functions in the DWARF is not an error.
+  if (Error Err = DT.convert(NumThreads))
+    consumeError(std::move(Err));
+  if (Error Err = ObjectFileTransformer::convert(Obj, Log, Gsym))
+    return Err;
+  if (Error Err = Gsym.finalize(Log))
+    return Err;
+  return Gsym.save(OutPath, Obj.isLittleEndian() ? support::little
+                                                 : support::big);
+}
+
+static void lookupAddresses(StringRef Path) {
+  Expected<GsymReader> ReaderOrErr = GsymReader::openFile(Path);
+  error(Path, ReaderOrErr.takeError());
+  GsymContext Ctx(std::move(*ReaderOrErr));
+  for (uint64_t Addr : LookupAddresses) {
+    outs() << Path << ": " << format_hex(Addr, 18) << '\n';
+    DIInliningInfo Inlining = Ctx.getInliningInfoForAddress({Addr});
+    if (Inlining.getNumberOfFrames() == 0) {
+      outs() << "  <no function>\n";
+      continue;
+    }
+    for (uint32_t I = 0; I < Inlining.getNumberOfFrames(); ++I) {
+      const DILineInfo &Frame = Inlining.getFrame(I);
+      outs() << "  " << Frame.FunctionName;
+      if (!Frame.FileName.empty())
+        outs() << " @ " << Frame.FileName << ':' << Frame.Line;
+      outs() << '\n';
+    }
+  }
+}
+
+int main(int argc, char **argv) {
+  InitLLVM X(argc, argv);
+  ToolName = argv[0];
+
+  cl::HideUnrelatedOptions({&GsymCategory, &ColorCategory});
+  cl::ParseCommandLineOptions(argc, argv, "GSYM file utility\n");
+
+  if (!ConvertFilename.empty()) {
+    std::string OutPath = OutputFilename;
+    if (OutPath.empty())
+      OutPath = ConvertFilename + ".gsym";
+    error(ConvertFilename, convertObjectFile(ConvertFilename, OutPath));
+    // Allow looking up addresses in the file that was just created.
+    if (InputFilenames.empty() && !LookupAddresses.empty())
+      InputFilenames.push_back(OutPath);
+  }
+
+  for (const std::string &Path : InputFilenames) {
+    if (LookupAddresses.empty()) {
+      Expected<GsymReader> ReaderOrErr = GsymReader::openFile(Path);
+      error(Path, ReaderOrErr.takeError());
+      outs() << Path << ":\n" << ReaderOrErr->getHeader() << '\n';
+      continue;
+    }
+    lookupAddresses(Path);
+  }
+  return 0;
+}
@@ -0,0 +1,474 @@
+//===- llvm-jit-bench.cpp - End-to-end JIT compile latency benchmark ------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// This utility measures how long it takes LLJIT, LLLazyJIT and MCJIT to make
+// generated workloads executable:
+//
+//   tiny  - many modules holding one small function each.
+//   large - a few modules holding one function with thousands of blocks each.
+//   lazy  - one module holding a chain of functions, each calling the next.
+//           LLLazyJIT reaches them through lazy reexports.
+//
+// Each sample is the lookup of one function followed by a call to it. For
+// every workload and JIT the tool reports the latency percentiles of the
+// samples, split into the time spent generating code and the rest (linking,
+// partitioning, stubs, symbol resolution), and the heap growth of the run.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/AsmParser/Parser.h"
+#include "llvm/ExecutionEngine/ExecutionEngine.h"
+#include "llvm/ExecutionEngine/MCJIT.h"
+#include "llvm/ExecutionEngine/ObjectCache.h"
+#include "llvm/ExecutionEngine/Orc/CompileUtils.h"
+#include "llvm/ExecutionEngine/Orc/LLJIT.h"
+#include "llvm/ExecutionEngine/SectionMemoryManager.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/InitLLVM.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Process.h"
+#include "llvm/Support/SourceMgr.h"
+#include "llvm/Support/TargetSelect.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <vector>
+
+using namespace llvm;
+using namespace llvm::orc;
+
+namespace {
+
+enum class JITKind { LLJIT, LLLazyJIT, MCJIT };
+enum class WorkloadKind { Tiny, Large, Lazy };
+
+} // end anonymous namespace
+
+static cl::list<JITKind>
+    JITs("jit", cl::desc("JITs to benchmark (default: all)"),
+         cl::values(clEnumValN(JITKind::LLJIT, "lljit", "LLJIT"),
+                    clEnumValN(JITKind::LLLazyJIT, "lllazyjit", "LLLazyJIT"),
+                    clEnumValN(JITKind::MCJIT, "mcjit", "MCJIT")),
+         cl::CommaSeparated, cl::ZeroOrMore);
+
+static cl::list<WorkloadKind> Workloads(
+    "workload", cl::desc("Workloads to run (default: all)"),
+    cl::values(clEnumValN(WorkloadKind::Tiny, "tiny",
+                          "Many modules with one small function each"),
+               clEnumValN(WorkloadKind::Large, "large",
+                          "A few modules with one large function each"),
+               clEnumValN(WorkloadKind::Lazy, "lazy",
+                          "One module with a chain of calling functions")),
+    cl::CommaSeparated, cl::ZeroOrMore);
+
+static cl::opt<unsigned>
+    NumTinyFunctions("tiny-functions",
+                     cl::desc("Number of functions in the tiny workload"),
+                     cl::init(1000));
+
+static cl::opt<unsigned>
+    NumLargeFunctions("large-functions",
+                      cl::desc("Number of functions in the large workload"),
+                      cl::init(4));
+
+static cl::opt<unsigned> NumLargeFunctionBlocks(
+    "large-function-blocks",
+    cl::desc("Number of basic blocks in each function of the large workload"),
+    cl::init(2000));
+
+static cl::opt<unsigned>
+    NumLazyFunctions("lazy-functions",
+                     cl::desc("Number of functions in the lazy workload"),
+                     cl::init(500));
+
+static cl::opt<unsigned> Repetitions("repetitions",
+                                     cl::desc("Number of runs per JIT and "
+                                              "workload to gather samples from"),
+                                     cl::init(3));
+
+static cl::opt<unsigned>
+    NumCompileThreads("compile-threads",
+                      cl::desc("Number of compile threads for LLJIT and "
+                               "LLLazyJIT (0 compiles on the lookup thread)"),
+                      cl::init(0));
+
+static ExitOnError ExitOnErr;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+uint64_t nanosecondsSince(Clock::time_point Start) {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() -
+                                                              Start)
+      .count();
+}
+
+/// The IR of a workload, and the functions to look up and call, in order.
+struct Workload {
+  std::vector<std::string> ModulesIR;
+  std::vector<std::string> Entries;
+};
+
+Workload createTinyWorkload() {
+  Workload W;
+  for (unsigned I = 0; I != NumTinyFunctions; ++I) {
+    std::string Name = "tiny" + std::to_string(I);
+    std::string IR;
+    raw_string_ostream OS(IR);
+    OS << "define i32 @" << Name << "(i32 %x) {\n"
+       << "entry:\n"
+       << "  %a = add i32 %x, " << I << "\n"
+       << "  %b = mul i32 %a, 3\n"
+       << "  ret i32 %b\n"
+       << "}\n";
+    W.ModulesIR.push_back(std::move(OS.str()));
+    W.Entries.push_back(std::move(Name));
+  }
+  return W;
+}
+
+Workload createLargeWorkload() {
+  Workload W;
+  for (unsigned I = 0; I != NumLargeFunctions; ++I) {
+    std::string Name = "large" + std::to_string(I);
+    std::string IR;
+    raw_string_ostream OS(IR);
+    OS << "define i32 @" << Name << "(i32 %x) {\n"
+       << "entry:\n"
+       << "  br label %b0\n";
+    // A chain of blocks, each of which may leave the function early.
+    for (unsigned B = 0; B != NumLargeFunctionBlocks; ++B) {
+      std::string Prev = B == 0 ? "%x" : "%v" + std::to_string(B - 1);
+      OS << "b" << B << ":\n"
+         << "  %m" << B << " = mul i32 " << Prev << ", 1103515245\n"
+         << "  %v" << B << " = add i32 %m" << B << ", " << B << "\n"
+         << "  %c" << B << " = icmp ne i32 %v" << B << ", " << B << "\n"
+         << "  br i1 %c" << B << ", label %b" << B + 1 << ", label %e" << B
+         << "\n"
+         << "e" << B << ":\n"
+         << "  ret i32 %v" << B << "\n";
+    }
+    OS << "b" << NumLargeFunctionBlocks << ":\n"
+       << "  ret i32 0\n"
+       << "}\n";
+    W.ModulesIR.push_back(std::move(OS.str()));
+    W.Entries.push_back(std::move(Name));
+  }
+  return W;
+}
+
+Workload createLazyWorkload() {
+  Workload W;
+  std::string IR;
+  raw_string_ostream OS(IR);
+  // lazy<N>(x) returns 0 if x is 0, and lazy<N+1>(x - 1) otherwise. Calling
+  // each function with 1 in turn reaches one new function per call.
+  for (unsigned I = 0; I != NumLazyFunctions; ++I) {
+    OS << "define i32 @lazy" << I << "(i32 %x) {\n"
+       << "entry:\n"
+       << "  %done = icmp eq i32 %x, 0\n"
+       << "  br i1 %done, label %exit, label %next\n"
+       << "next:\n";
+    if (I + 1 != NumLazyFunctions)
+      OS << "  %y = sub i32 %x, 1\n"
+         << "  %r = call i32 @lazy" << I + 1 << "(i32 %y)\n"
+         << "  ret i32 %r\n";
+    else
+      OS << "  ret i32 %x\n";
+    OS << "exit:\n"
+       << "  ret i32 0\n"
+       << "}\n";
+    W.Entries.push_back("lazy" + std::to_string(I));
+  }
+  W.ModulesIR.push_back(std::move(OS.str()));
+  return W;
+}
+
+std::unique_ptr<Module> parseWorkloadModule(StringRef IR, unsigned Index,
+                                            LLVMContext &Ctx) {
+  SMDiagnostic Err;
+  auto M = parseAssemblyString(IR, Err, Ctx);
+  if (!M) {
+    Err.print("llvm-jit-bench", errs());
+    exit(1);
+  }
+  M->setModuleIdentifier("workload" + std::to_string(Index));
+  return M;
+}
+
+/// The samples gathered for one JIT and workload.
+struct Samples {
+  std::vector<uint64_t> CodegenNs;
+  std::vector<uint64_t> TotalNs;
+  size_t HeapGrowth = 0;
+};
+
+/// Runs the entry points of a workload on one JIT instance.
+class JITRunner {
+public:
+  virtual ~JITRunner() = default;
+
+  /// Returns the address of the function with the given IR name, compiling
+  /// it if the JIT does so on lookup.
+  virtual JITTargetAddress lookup(StringRef Name) = 0;
+
+  /// Returns the nanoseconds spent generating code so far.
+  uint64_t getCodegenNs() const { return CodegenNs; }
+
+protected:
+  std::atomic<uint64_t> CodegenNs{0};
+};
+
+class LLJITRunner : public JITRunner {
+public:
+  LLJITRunner(bool Lazy, const Workload &W) {
+    auto CreateCompileFunction = [this](JITTargetMachineBuilder JTMB)
+        -> Expected<IRCompileLayer::CompileFunction> {
+      IRCompileLayer::CompileFunction Compile;
+      if (NumCompileThreads > 0)
+        Compile = ConcurrentIRCompiler(std::move(JTMB));
+      else if (auto TM = JTMB.createTargetMachine())
+        Compile = TMOwningSimpleCompiler(std::move(*TM));
+      else
+        return TM.takeError();
+
+      return [this, Compile](Module &M) {
+        auto Start = Clock::now();
+        auto Obj = Compile(M);
+        CodegenNs += nanosecondsSince(Start);
+        return Obj;
+      };
+    };
+
+    auto TSCtx = ThreadSafeContext(std::make_unique<LLVMContext>());
+    if (Lazy) {
+      auto J = ExitOnErr(LLLazyJITBuilder()
+                             .setCompileFunctionCreator(CreateCompileFunction)
+                             .setNumCompileThreads(NumCompileThreads)
+                             .create());
+      for (unsigned I = 0; I != W.ModulesIR.size(); ++I)
+        ExitOnErr(J->addLazyIRModule(ThreadSafeModule(
+            parseWorkloadModule(W.ModulesIR[I], I, *TSCtx.getContext()),
+            TSCtx)));
+      this->J = std::move(J);
+    } else {
+      J = ExitOnErr(LLJITBuilder()
+                        .setCompileFunctionCreator(CreateCompileFunction)
+                        .setNumCompileThreads(NumCompileThreads)
+                        .create());
+      for (unsigned I = 0; I != W.ModulesIR.size(); ++I)
+        ExitOnErr(J->addIRModule(ThreadSafeModule(
+            parseWorkloadModule(W.ModulesIR[I], I, *TSCtx.getContext()),
+            TSCtx)));
+    }
+  }
+
+  JITTargetAddress lookup(StringRef Name) override {
+    return ExitOnErr(J->lookup(Name)).getAddress();
+  }
+
+private:
+  std::unique_ptr<LLJIT> J;
+};
+
+class MCJITRunner : public JITRunner, public ObjectCache {
+public:
+  MCJITRunner(const Workload &W) {
+    std::string ErrStr;
+    EE.reset(EngineBuilder(std::make_unique<Module>("empty", Ctx))
+                 .setEngineKind(EngineKind::JIT)
+                 .setErrorStr(&ErrStr)
+                 .setMCJITMemoryManager(
+                     std::make_unique<SectionMemoryManager>())
+                 .create());
+    if (!EE)
+      ExitOnErr(make_error<StringError>("Could not create MCJIT: " + ErrStr,
+                                        inconvertibleErrorCode()));
+    EE->setObjectCache(this);
+    for (unsigned I = 0; I != W.ModulesIR.size(); ++I)
+      EE->addModule(parseWorkloadModule(W.ModulesIR[I], I, Ctx));
+  }
+
+  JITTargetAddress lookup(StringRef Name) override {
+    // MCJIT does not let us wrap its compiler. Codegen of the modules a lookup
+    // compiles ends when the last of them is handed to the object cache.
+    CodegenStart = LastCodegenEnd = Clock::now();
+    auto Addr = EE->getFunctionAddress(Name);
+    if (!Addr)
+      ExitOnErr(make_error<StringError>("Symbol not found: " + Name,
+                                        inconvertibleErrorCode()));
+    CodegenNs += std::chrono::duration_cast<std::chrono::nanoseconds>(
+                     LastCodegenEnd - CodegenStart)
+                     .count();
+    return Addr;
+  }
+
+  void notifyObjectCompiled(const Module *M, MemoryBufferRef Obj) override {
+    LastCodegenEnd = Clock::now();
+  }
+
+  std::unique_ptr<MemoryBuffer> getObject(const Module *M) override {
+    return nullptr;
+  }
+
+private:
+  LLVMContext Ctx;
+  std::unique_ptr<ExecutionEngine> EE;
+  Clock::time_point CodegenStart, LastCodegenEnd;
+};
+
+std::unique_ptr<JITRunner> createRunner(JITKind Kind, const Workload &W) {
+  switch (Kind) {
+  case JITKind::LLJIT:
+    return std::make_unique<LLJITRunner>(/*Lazy=*/false, W);
+  case JITKind::LLLazyJIT:
+    return std::make_unique<LLJITRunner>(/*Lazy=*/true, W);
+  case JITKind::MCJIT:
+    return std::make_unique<MCJITRunner>(W);
+  }
+  llvm_unreachable("Unknown JIT kind");
+}
+
+void runOnce(JITKind Kind, const Workload &W, Samples &S) {
+  size_t HeapBefore = sys::Process::GetMallocUsage();
+  auto Runner = createRunner(Kind, W);
+
+  volatile int32_t Sink = 0;
+  for (auto &Entry : W.Entries) {
+    uint64_t CodegenBefore = Runner->getCodegenNs();
+    auto Start = Clock::now();
+    auto *F = reinterpret_cast<int32_t (*)(int32_t)>(
+        static_cast<uintptr_t>(Runner->lookup(Entry)));
+    Sink = Sink + F(1);
+    S.TotalNs.push_back(nanosecondsSince(Start));
+    S.CodegenNs.push_back(Runner->getCodegenNs() - CodegenBefore);
+  }
+
+  size_t HeapAfter = sys::Process::GetMallocUsage();
+  if (HeapAfter > HeapBefore)
+    S.HeapGrowth = std::max(S.HeapGrowth, HeapAfter - HeapBefore);
+}
+
+/// Returns the nearest-rank percentile P of the sorted samples.
+uint64_t percentile(ArrayRef<uint64_t> Sorted, unsigned P) {
+  if (Sorted.empty())
+    return 0;
+  size_t Rank = (Sorted.size() * P + 99) / 100;
+  return Sorted[Rank ? Rank - 1 : 0];
+}
+
+void printPhase(StringRef Phase, std::vector<uint64_t> Ns) {
+  llvm::sort(Ns);
+  uint64_t Sum = 0;
+  for (auto N : Ns)
+    Sum += N;
+  outs() << format("  %-12s", Phase.str().c_str())
+         << format(" %10.1f", percentile(Ns, 50) / 1000.0)
+         << format(" %10.1f", percentile(Ns, 90) / 1000.0)
+         << format(" %10.1f", percentile(Ns, 99) / 1000.0)
+         << format(" %10.1f", (Ns.empty() ? 0 : Ns.back()) / 1000.0)
+         << format(" %10.1f", Sum / 1000000.0) << "\n";
+}
+
+void printSamples(StringRef WorkloadName, StringRef JITName,
+                  const Samples &S) {
+  outs() << WorkloadName << "/" << JITName << ": " << S.TotalNs.size()
+         << " samples, " << S.HeapGrowth / 1024 << " KB heap growth\n";
+  outs() << "  " << left_justify("phase", 12);
+  for (const char *Column : {"p50 us", "p90 us", "p99 us", "max us", "sum ms"})
+    outs() << right_justify(Column, 11);
+  outs() << "\n";
+
+  std::vector<uint64_t> OtherNs;
+  for (unsigned I = 0; I != S.TotalNs.size(); ++I)
+    OtherNs.push_back(S.TotalNs[I] > S.CodegenNs[I]
+                          ? S.TotalNs[I] - S.CodegenNs[I]
+                          : 0);
+
+  printPhase("codegen", S.CodegenNs);
+  printPhase("link+other", std::move(OtherNs));
+  printPhase("total", S.TotalNs);
+}
+
+StringRef getName(JITKind Kind) {
+  switch (Kind) {
+  case JITKind::LLJIT:
+    return "lljit";
+  case JITKind::LLLazyJIT:
+    return "lllazyjit";
+  case JITKind::MCJIT:
+    return "mcjit";
+  }
+  llvm_unreachable("Unknown JIT kind");
+}
+
+StringRef getName(WorkloadKind Kind) {
+  switch (Kind) {
+  case WorkloadKind::Tiny:
+    return "tiny";
+  case WorkloadKind::Large:
+    return "large";
+  case WorkloadKind::Lazy:
+    return "lazy";
+  }
+  llvm_unreachable("Unknown workload kind");
+}
+
+} // end anonymous namespace
+
+int main(int argc, char *argv[]) {
+  InitLLVM X(argc, argv);
+
+  InitializeNativeTarget();
+  InitializeNativeTargetAsmPrinter();
+
+  cl::ParseCommandLineOptions(argc, argv, "llvm JIT compile time benchmark\n");
+  ExitOnErr.setBanner(std::string(argv[0]) + ": ");
+
+  std::vector<JITKind> JITKinds(JITs.begin(), JITs.end());
+  if (JITKinds.empty())
+    JITKinds = {JITKind::LLJIT, JITKind::LLLazyJIT, JITKind::MCJIT};
+  std::vector<WorkloadKind> WorkloadKinds(Workloads.begin(), Workloads.end());
+  if (WorkloadKinds.empty())
+    WorkloadKinds = {WorkloadKind::Tiny, WorkloadKind::Large,
+                     WorkloadKind::Lazy};
+
+  for (auto WK : WorkloadKinds) {
+    Workload W;
+    switch (WK) {
+    case WorkloadKind::Tiny:
+      W = createTinyWorkload();
+      break;
+    case WorkloadKind::Large:
+      W = createLargeWorkload();
+      break;
+    case WorkloadKind::Lazy:
+      W = createLazyWorkload();
+      break;
+    }
+
+    for (auto JK : JITKinds) {
+      Samples S;
+      for (unsigned R = 0; R != Repetitions; ++R)
+        runOnce(JK, W, S);
+      printSamples(getName(WK), getName(JK), S);
+    }
+  }
+
+  return 0;
+}
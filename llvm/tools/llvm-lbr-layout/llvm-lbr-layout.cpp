@@ -0,0 +1,222 @@
+//===- llvm-lbr-layout.cpp - Function layout from LBR profiles ------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// llvm-lbr-layout turns the last branch records sampled by perf on an ELF
+// binary into the function layout files of lld: the calls between the
+// functions of the binary, for --call-graph-ordering-file, and the functions
+// sorted by hotness, for --symbol-ordering-file.
+//
+// The input is the output of "perf script -F ip,brstack", where each branch
+// record is written as FROM/TO/FLAGS...
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/ADT/MapVector.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Object/ELFObjectFile.h"
+#include "llvm/Object/ObjectFile.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/InitLLVM.h"
+#include "llvm/Support/LineIterator.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/WithColor.h"
+#include "llvm/Support/raw_ostream.h"
+#include <algorithm>
+
+using namespace llvm;
+using namespace llvm::object;
+
+static cl::opt<std::string> BinaryFilename(cl::Positional, cl::Required,
+                                           cl::desc("<binary>"));
+static cl::opt<std::string>
+    PerfScriptFilename("perf-script", cl::Required,
+                       cl::value_desc("file"),
+                       cl::desc("Output of perf script -F ip,brstack"));
+static cl::opt<std::string>
+    CallGraphFilename("call-graph", cl::value_desc("file"), cl::init(""),
+                      cl::desc("Output the calls between the functions as a "
+                               "--call-graph-ordering-file for lld"));
+static cl::opt<std::string>
+    OrderingFilename("symbol-ordering", cl::value_desc("file"), cl::init(""),
+                     cl::desc("Output the sampled functions, hottest first, "
+                              "as a --symbol-ordering-file for lld"));
+static cl::opt<uint64_t>
+    LoadBias("load-bias", cl::init(0),
+             cl::desc("Difference between the sampled addresses and the "
+                      "addresses of the binary, for position independent "
+                      "executables"));
+
+static void exitWithError(Twine Message, StringRef Whence = "") {
+  WithColor::error();
+  if (!Whence.empty())
+    errs() << Whence << ": ";
+  errs() << Message << "\n";
+  exit(1);
+}
+
+static void exitWithError(Error E, StringRef Whence) {
+  exitWithError(toString(std::move(E)), Whence);
+}
+
+namespace {
+struct FuncRange {
+  uint64_t Start;
+  uint64_t End;
+  StringRef Name;
+};
+
+/// The functions of the binary, sorted by address.
+class FuncMap {
+public:
+  void add(uint64_t Start, uint64_t Size, StringRef Name) {
+    Ranges.push_back({Start, Start + std::max<uint64_t>(Size, 1), Name});
+  }
+
+  void finalize() {
+    llvm::sort(Ranges, [](const FuncRange &A, const FuncRange &B) {
+      return A.Start < B.Start;
+    });
+    // Aliases share their address, keep the first name.
+    Ranges.erase(std::unique(Ranges.begin(), Ranges.end(),
+                             [](const FuncRange &A, const FuncRange &B) {
+                               return A.Start == B.Start;
+                             }),
+                 Ranges.end());
+  }
+
+  /// Return the function containing \p Addr, or null if there is none.
+  const FuncRange *lookup(uint64_t Addr) const {
+    auto It = llvm::upper_bound(Ranges, Addr,
+                                [](uint64_t A, const FuncRange &R) {
+                                  return A < R.Start;
+                                });
+    if (It == Ranges.begin())
+      return nullptr;
+    --It;
+    return Addr < It->End ? &*It : nullptr;
+  }
+
+private:
+  std::vector<FuncRange> Ranges;
+};
+} // namespace
+
+static void readFunctions(const ObjectFile &Obj, FuncMap &Funcs) {
+  const auto *ELFObj = dyn_cast<ELFObjectFileBase>(&Obj);
+  if (!ELFObj)
+    exitWithError("not an ELF file", BinaryFilename);
+
+  for (ELFSymbolRef Sym : ELFObj->symbols()) {
+    Expected<SymbolRef::Type> Type = Sym.getType();
+    if (!Type)
+      exitWithError(Type.takeError(), BinaryFilename);
+    if (*Type != SymbolRef::ST_Function)
+      continue;
+    Expected<uint64_t> Addr = Sym.getAddress();
+    if (!Addr)
+      exitWithError(Addr.takeError(), BinaryFilename);
+    Expected<StringRef> Name = Sym.getName();
+    if (!Name)
+      exitWithError(Name.takeError(), BinaryFilename);
+    // Skip the undefined functions.
+    if (!*Addr)
+      continue;
+    Funcs.add(*Addr, Sym.getSize(), *Name);
+  }
+  Funcs.finalize();
+}
+
+/// Parse the address \p S in the hexadecimal notation of perf.
+static bool parseAddress(StringRef S, uint64_t &Addr) {
+  if (!S.consume_front("0x"))
+    return false;
+  return !S.getAsInteger(16, Addr);
+}
+
+int main(int argc, const char *argv[]) {
+  InitLLVM X(argc, argv);
+  cl::ParseCommandLineOptions(argc, argv,
+                              "LLVM function layout from LBR profiles\n");
+
+  Expected<OwningBinary<ObjectFile>> BinaryOrErr =
+      ObjectFile::createObjectFile(BinaryFilename);
+  if (!BinaryOrErr)
+    exitWithError(BinaryOrErr.takeError(), BinaryFilename);
+  FuncMap Funcs;
+  readFunctions(*BinaryOrErr->getBinary(), Funcs);
+
+  ErrorOr<std::unique_ptr<MemoryBuffer>> BufferOrErr =
+      MemoryBuffer::getFileOrSTDIN(PerfScriptFilename);
+  if (std::error_code EC = BufferOrErr.getError())
+    exitWithError(EC.message(), PerfScriptFilename);
+
+  // A branch to the start of another function is a call, or a tail call.
+  // Every branch taken inside a function counts for its hotness.
+  MapVector<std::pair<StringRef, StringRef>, uint64_t> Calls;
+  MapVector<StringRef, uint64_t> Hotness;
+  uint64_t NumBranches = 0, NumUnknown = 0;
+  for (line_iterator Line(**BufferOrErr, /*SkipBlanks=*/true);
+       !Line.is_at_eof(); ++Line) {
+    SmallVector<StringRef, 32> Fields;
+    Line->split(Fields, ' ', /*MaxSplit=*/-1, /*KeepEmpty=*/false);
+    for (StringRef Field : Fields) {
+      StringRef FromStr, ToStr;
+      std::tie(FromStr, ToStr) = Field.split('/');
+      ToStr = ToStr.split('/').first;
+      uint64_t From, To;
+      if (!parseAddress(FromStr, From) || !parseAddress(ToStr, To))
+        continue;
+      ++NumBranches;
+      const FuncRange *Source = Funcs.lookup(From - LoadBias);
+      const FuncRange *Target = Funcs.lookup(To - LoadBias);
+      if (!Source || !Target) {
+        ++NumUnknown;
+        continue;
+      }
+      ++Hotness[Target->Name];
+      if (Source != Target && To - LoadBias == Target->Start)
+        ++Calls[{Source->Name, Target->Name}];
+    }
+  }
+
+  if (NumBranches == 0)
+    exitWithError("no branch record found, use perf script -F ip,brstack",
+                  PerfScriptFilename);
+  if (NumUnknown * 2 > NumBranches)
+    WithColor::warning() << NumUnknown << " of " << NumBranches
+                         << " branches are outside of the functions of "
+                         << BinaryFilename << ", check -load-bias\n";
+
+  if (!CallGraphFilename.empty()) {
+    std::error_code EC;
+    raw_fd_ostream OS(CallGraphFilename, EC, sys::fs::OF_Text);
+    if (EC)
+      exitWithError(EC.message(), CallGraphFilename);
+    for (const auto &Call : Calls)
+      OS << Call.first.first << " " << Call.first.second << " " << Call.second
+         << "\n";
+  }
+
+  if (!OrderingFilename.empty()) {
+    std::error_code EC;
+    raw_fd_ostream OS(OrderingFilename, EC, sys::fs::OF_Text);
+    if (EC)
+      exitWithError(EC.message(), OrderingFilename);
+    std::vector<std::pair<StringRef, uint64_t>> Sorted(Hotness.begin(),
+                                                       Hotness.end());
+    std::stable_sort(Sorted.begin(), Sorted.end(),
+                     [](const std::pair<StringRef, uint64_t> &A,
+                        const std::pair<StringRef, uint64_t> &B) {
+                       return A.second > B.second;
+                     });
+    for (const auto &Func : Sorted)
+      OS << Func.first << "\n";
+  }
+  return 0;
+}
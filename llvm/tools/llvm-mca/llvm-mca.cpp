@@ -32,6 +32,7 @@
 #include "Views/SchedulerStatistics.h"
 #include "Views/SummaryView.h"
 #include "Views/TimelineView.h"
+#include "llvm/ADT/Optional.h"
 #include "llvm/MC/MCAsmBackend.h"
 #include "llvm/MC/MCAsmInfo.h"
 #include "llvm/MC/MCCodeEmitter.h"
@@ -57,6 +58,8 @@
 #include "llvm/Support/SourceMgr.h"
 #include "llvm/Support/TargetRegistry.h"
 #include "llvm/Support/TargetSelect.h"
+#include "llvm/Support/ThreadPool.h"
+#include "llvm/Support/Threading.h"
 #include "llvm/Support/ToolOutputFile.h"
 #include "llvm/Support/WithColor.h"
 
@@ -208,6 +211,13 @@ static cl::opt<bool> EnableBottleneckAnalysis(
     cl::desc("Enable bottleneck analysis (disabled by default)"),
     cl::cat(ViewOptions), cl::init(false));
 
+static cl::opt<unsigned>
+    NumThreads("num-threads",
+               cl::desc("Number of code regions to simulate in parallel; the "
+                        "reports are still printed in region order "
+                        "(0: autodetect)"),
+               cl::cat(ToolOptions), cl::init(1));
+
 static cl::opt<bool> ShowEncoding(
     "show-encoding",
     cl::desc("Print encoding information in the instruction info view"),
@@ -274,16 +284,40 @@ static void processViewOptions() {
 }
 
 // Returns true on success.
-static bool runPipeline(mca::Pipeline &P) {
-  // Handle pipeline errors here.
+static Error runPipeline(mca::Pipeline &P) {
+  // Pipeline errors are reported along with the region.
   Expected<unsigned> Cycles = P.run();
-  if (!Cycles) {
-    WithColor::error() << toString(Cycles.takeError());
-    return false;
-  }
-  return true;
+  if (!Cycles)
+    return Cycles.takeError();
+  return Error::success();
 }
 
+namespace {
+/// The simulation of one code region. The views of the region refer to all of
+/// it, so it is kept alive until the report has been printed.
+struct RegionAnalysis {
+  RegionAnalysis(const MCSubtargetInfo &STI, const MCInstrInfo &MCII,
+                 const MCRegisterInfo &MRI, const MCInstrAnalysis *MCIA,
+                 const MCAsmBackend &MAB, const MCCodeEmitter &MCE,
+                 ArrayRef<MCInst> Insts)
+      : IB(STI, MCII, MRI, MCIA), MCA(MRI, STI), CE(STI, MAB, MCE, Insts) {}
+  ~RegionAnalysis() {
+    if (Err)
+      consumeError(std::move(*Err));
+  }
+
+  mca::InstrBuilder IB;
+  mca::Context MCA;
+  mca::CodeEmitter CE;
+  std::vector<std::unique_ptr<mca::Instruction>> LoweredSequence;
+  std::unique_ptr<mca::SourceMgr> S;
+  std::unique_ptr<mca::Pipeline> P;
+  std::unique_ptr<mca::PipelinePrinter> Printer;
+  /// Set if the region could not be lowered or simulated.
+  Optional<Error> Err;
+};
+} // end of anonymous namespace
+
 int main(int argc, char **argv) {
   InitLLVM X(argc, argv);
 
@@ -424,12 +458,6 @@ int main(int argc, char **argv) {
 
   const MCSchedModel &SM = STI->getSchedModel();
 
-  // Create an instruction builder.
-  mca::InstrBuilder IB(*STI, *MCII, *MRI, MCIA.get());
-
-  // Create a context to control ownership of the pipeline hardware.
-  mca::Context MCA(*MRI, *STI);
-
   mca::PipelineOptions PO(MicroOpQueue, DecoderThroughput, DispatchWidth,
                           RegisterFileSize, LoadQueueSize, StoreQueueSize,
                           AssumeNoAlias, EnableBottleneckAnalysis);
@@ -443,76 +471,54 @@ int main(int argc, char **argv) {
   std::unique_ptr<MCAsmBackend> MAB(TheTarget->createMCAsmBackend(
       *STI, *MRI, InitMCTargetOptionsFromFlags()));
 
-  for (const std::unique_ptr<mca::CodeRegion> &Region : Regions) {
-    // Skip empty code regions.
-    if (Region->empty())
-      continue;
-
-    // Don't print the header of this region if it is the default region, and
-    // it doesn't have an end location.
-    if (Region->startLoc().isValid() || Region->endLoc().isValid()) {
-      TOF->os() << "\n[" << RegionIdx++ << "] Code Region";
-      StringRef Desc = Region->getDescription();
-      if (!Desc.empty())
-        TOF->os() << " - " << Desc;
-      TOF->os() << "\n\n";
-    }
+  // Lower and simulate a region. This only reads the shared target
+  // descriptions, so several regions can be analyzed at the same time.
+  auto AnalyzeRegion = [&](const mca::CodeRegion &Region) {
+    ArrayRef<MCInst> Insts = Region.getInstructions();
+    auto RA = std::make_unique<RegionAnalysis>(*STI, *MCII, *MRI, MCIA.get(),
+                                               *MAB, *MCE, Insts);
 
     // Lower the MCInst sequence into an mca::Instruction sequence.
-    ArrayRef<MCInst> Insts = Region->getInstructions();
-    mca::CodeEmitter CE(*STI, *MAB, *MCE, Insts);
-    std::vector<std::unique_ptr<mca::Instruction>> LoweredSequence;
     for (const MCInst &MCI : Insts) {
       Expected<std::unique_ptr<mca::Instruction>> Inst =
-          IB.createInstruction(MCI);
+          RA->IB.createInstruction(MCI);
       if (!Inst) {
-        if (auto NewE = handleErrors(
-                Inst.takeError(),
-                [&IP, &STI](const mca::InstructionError<MCInst> &IE) {
-                  std::string InstructionStr;
-                  raw_string_ostream SS(InstructionStr);
-                  WithColor::error() << IE.Message << '\n';
-                  IP->printInst(&IE.Inst, SS, "", *STI);
-                  SS.flush();
-                  WithColor::note()
-                      << "instruction: " << InstructionStr << '\n';
-                })) {
-          // Default case.
-          WithColor::error() << toString(std::move(NewE));
-        }
-        return 1;
+        RA->Err = Inst.takeError();
+        return RA;
       }
 
-      LoweredSequence.emplace_back(std::move(Inst.get()));
+      RA->LoweredSequence.emplace_back(std::move(Inst.get()));
     }
 
-    mca::SourceMgr S(LoweredSequence, PrintInstructionTables ? 1 : Iterations);
+    RA->S = std::make_unique<mca::SourceMgr>(
+        RA->LoweredSequence, PrintInstructionTables ? 1 : Iterations);
+    mca::SourceMgr &S = *RA->S;
 
     if (PrintInstructionTables) {
       //  Create a pipeline, stages, and a printer.
-      auto P = std::make_unique<mca::Pipeline>();
-      P->appendStage(std::make_unique<mca::EntryStage>(S));
-      P->appendStage(std::make_unique<mca::InstructionTables>(SM));
-      mca::PipelinePrinter Printer(*P);
+      RA->P = std::make_unique<mca::Pipeline>();
+      RA->P->appendStage(std::make_unique<mca::EntryStage>(S));
+      RA->P->appendStage(std::make_unique<mca::InstructionTables>(SM));
+      RA->Printer = std::make_unique<mca::PipelinePrinter>(*RA->P);
+      mca::PipelinePrinter &Printer = *RA->Printer;
 
       // Create the views for this pipeline, execute, and emit a report.
       if (PrintInstructionInfoView) {
         Printer.addView(std::make_unique<mca::InstructionInfoView>(
-            *STI, *MCII, CE, ShowEncoding, Insts, *IP));
+            *STI, *MCII, RA->CE, ShowEncoding, Insts, *IP));
       }
       Printer.addView(
           std::make_unique<mca::ResourcePressureView>(*STI, *IP, Insts));
 
-      if (!runPipeline(*P))
-        return 1;
-
-      Printer.printReport(TOF->os());
-      continue;
+      if (Error E = runPipeline(*RA->P))
+        RA->Err = std::move(E);
+      return RA;
     }
 
     // Create a basic pipeline simulating an out-of-order backend.
-    auto P = MCA.createDefaultPipeline(PO, S);
-    mca::PipelinePrinter Printer(*P);
+    RA->P = RA->MCA.createDefaultPipeline(PO, S);
+    RA->Printer = std::make_unique<mca::PipelinePrinter>(*RA->P);
+    mca::PipelinePrinter &Printer = *RA->Printer;
 
     if (PrintSummaryView)
       Printer.addView(
@@ -525,7 +531,7 @@ int main(int argc, char **argv) {
 
     if (PrintInstructionInfoView)
       Printer.addView(std::make_unique<mca::InstructionInfoView>(
-          *STI, *MCII, CE, ShowEncoding, Insts, *IP));
+          *STI, *MCII, RA->CE, ShowEncoding, Insts, *IP));
 
     if (PrintDispatchStats)
       Printer.addView(std::make_unique<mca::DispatchStatistics>());
@@ -551,13 +557,78 @@ int main(int argc, char **argv) {
           TimelineMaxCycles));
     }
 
-    if (!runPipeline(*P))
-      return 1;
+    if (Error E = runPipeline(*RA->P))
+      RA->Err = std::move(E);
+    return RA;
+  };
 
-    Printer.printReport(TOF->os());
+  // Print the report of a region, in region order. Returns false on error.
+  auto PrintRegion = [&](const mca::CodeRegion &Region, RegionAnalysis &RA) {
+    // Don't print the header of this region if it is the default region, and
+    // it doesn't have an end location.
+    if (Region.startLoc().isValid() || Region.endLoc().isValid()) {
+      TOF->os() << "\n[" << RegionIdx++ << "] Code Region";
+      StringRef Desc = Region.getDescription();
+      if (!Desc.empty())
+        TOF->os() << " - " << Desc;
+      TOF->os() << "\n\n";
+    }
 
-    // Clear the InstrBuilder internal state in preparation for another round.
-    IB.clear();
+    if (RA.Err) {
+      if (auto NewE = handleErrors(
+              std::move(*RA.Err),
+              [&IP, &STI](const mca::InstructionError<MCInst> &IE) {
+                std::string InstructionStr;
+                raw_string_ostream SS(InstructionStr);
+                WithColor::error() << IE.Message << '\n';
+                IP->printInst(&IE.Inst, SS, "", *STI);
+                SS.flush();
+                WithColor::note() << "instruction: " << InstructionStr << '\n';
+              })) {
+        // Default case.
+        WithColor::error() << toString(std::move(NewE));
+      }
+      return false;
+    }
+
+    RA.Printer->printReport(TOF->os());
+    return true;
+  };
+
+  if (NumThreads == 1) {
+    for (const std::unique_ptr<mca::CodeRegion> &Region : Regions) {
+      // Skip empty code regions.
+      if (Region->empty())
+        continue;
+
+      if (!PrintRegion(*Region, *AnalyzeRegion(*Region)))
+        return 1;
+    }
+  } else {
+    // Simulate the regions in parallel, and print each report as soon as it
+    // and the ones before it are ready.
+    std::vector<const mca::CodeRegion *> NonEmptyRegions;
+    for (const std::unique_ptr<mca::CodeRegion> &Region : Regions)
+      if (!Region->empty())
+        NonEmptyRegions.push_back(Region.get());
+
+    std::vector<std::unique_ptr<RegionAnalysis>> Analyses(
+        NonEmptyRegions.size());
+    std::vector<std::shared_future<void>> Done;
+    ThreadPool Pool(NumThreads ? NumThreads : hardware_concurrency());
+    for (size_t I = 0, E = NonEmptyRegions.size(); I != E; ++I)
+      Done.push_back(Pool.async([&, I] {
+        Analyses[I] = AnalyzeRegion(*NonEmptyRegions[I]);
+      }));
+
+    for (size_t I = 0, E = NonEmptyRegions.size(); I != E; ++I) {
+      Done[I].wait();
+      if (!PrintRegion(*NonEmptyRegions[I], *Analyses[I])) {
+        Pool.wait();
+        return 1;
+      }
+      Analyses[I].reset();
+    }
   }
 
   TOF->keep();
@@ -37,8 +37,11 @@
 #include "llvm/Support/Program.h"
 #include "llvm/Support/Signals.h"
 #include "llvm/Support/TargetSelect.h"
+#include "llvm/Support/ThreadPool.h"
+#include "llvm/Support/Threading.h"
 #include "llvm/Support/WithColor.h"
 #include "llvm/Support/raw_ostream.h"
+#include <atomic>
 #include <vector>
 
 using namespace llvm;
@@ -151,7 +154,7 @@ cl::opt<bool> PrintSize("print-size",
                         cl::cat(NMCat));
 cl::alias PrintSizeS("S", cl::desc("Alias for --print-size"),
                      cl::aliasopt(PrintSize), cl::Grouping);
-bool MachOPrintSizeWarning = false;
+std::atomic<bool> MachOPrintSizeWarning(false);
 
 cl::opt<bool> SizeSort("size-sort", cl::desc("Sort symbols by size"),
                        cl::cat(NMCat));
@@ -210,20 +213,34 @@ cl::opt<bool> NoLLVMBitcode("no-llvm-bc",
                             cl::desc("Disable LLVM bitcode reader"),
                             cl::cat(NMCat));
 
+cl::opt<unsigned>
+    NumThreads("num-threads", cl::init(1),
+               cl::desc("Number of files to read in parallel; the output is "
+                        "still printed in file order (0: autodetect)"),
+               cl::cat(NMCat));
+
 cl::extrahelp HelpResponse("\nPass @FILE as argument to read options from FILE.\n");
 
 bool PrintAddress = true;
 
 bool MultipleFiles = false;
 
-bool HadError = false;
+std::atomic<bool> HadError(false);
 
 std::string ToolName;
 } // anonymous namespace
 
+// When several files are read in parallel, the output and the errors for each
+// file go to buffers of their own, which are printed in file order.
+static LLVM_THREAD_LOCAL raw_ostream *FileOuts;
+static LLVM_THREAD_LOCAL raw_ostream *FileErrs;
+
+static raw_ostream &out() { return FileOuts ? *FileOuts : outs(); }
+static raw_ostream &err() { return FileErrs ? *FileErrs : errs(); }
+
 static void error(Twine Message, Twine Path = Twine()) {
   HadError = true;
-  WithColor::error(errs(), ToolName) << Path << ": " << Message << ".\n";
+  WithColor::error(err(), ToolName) << Path << ": " << Message << ".\n";
 }
 
 static bool error(std::error_code EC, Twine Path = Twine()) {
@@ -240,7 +257,7 @@ static bool error(std::error_code EC, Twine Path = Twine()) {
 static void error(llvm::Error E, StringRef FileName, const Archive::Child &C,
                   StringRef ArchitectureName = StringRef()) {
   HadError = true;
-  WithColor::error(errs(), ToolName) << FileName;
+  WithColor::error(err(), ToolName) << FileName;
 
   Expected<StringRef> NameOrErr = C.getName();
   // TODO: if we have a error getting the name then it would be nice to print
@@ -248,18 +265,18 @@ static void error(llvm::Error E, StringRef FileName, const Archive::Child &C,
   // archive instead of "???" as the name.
   if (!NameOrErr) {
     consumeError(NameOrErr.takeError());
-    errs() << "(" << "???" << ")";
+    err() << "(" << "???" << ")";
   } else
-    errs() << "(" << NameOrErr.get() << ")";
+    err() << "(" << NameOrErr.get() << ")";
 
   if (!ArchitectureName.empty())
-    errs() << " (for architecture " << ArchitectureName << ") ";
+    err() << " (for architecture " << ArchitectureName << ") ";
 
   std::string Buf;
   raw_string_ostream OS(Buf);
   logAllUnhandledErrors(std::move(E), OS);
   OS.flush();
-  errs() << " " << Buf << "\n";
+  err() << " " << Buf << "\n";
 }
 
 // This version of error() prints the file name and which architecture slice it
@@ -269,16 +286,16 @@ static void error(llvm::Error E, StringRef FileName, const Archive::Child &C,
 static void error(llvm::Error E, StringRef FileName,
                   StringRef ArchitectureName = StringRef()) {
   HadError = true;
-  WithColor::error(errs(), ToolName) << FileName;
+  WithColor::error(err(), ToolName) << FileName;
 
   if (!ArchitectureName.empty())
-    errs() << " (for architecture " << ArchitectureName << ") ";
+    err() << " (for architecture " << ArchitectureName << ") ";
 
   std::string Buf;
   raw_string_ostream OS(Buf);
   logAllUnhandledErrors(std::move(E), OS);
   OS.flush();
-  errs() << " " << Buf << "\n";
+  err() << " " << Buf << "\n";
 }
 
 namespace {
@@ -341,8 +358,6 @@ static char isSymbolList64Bit(SymbolicFile &Obj) {
   return cast<ELFObjectFileBase>(Obj).getBytesInAddress() == 8;
 }
 
-static StringRef CurrentFilename;
-static std::vector<NMSymbol> SymbolList;
 
 static char getSymbolNMTypeChar(IRObjectFile &Obj, basic_symbol_iterator I);
 
@@ -430,22 +445,22 @@ static void darwinPrintSymbol(SymbolicFile &Obj, const NMSymbol &S,
 
   // If we are printing Mach-O symbols in hex do that and return.
   if (FormatMachOasHex) {
-    outs() << format(printFormat, NValue) << ' '
+    out() << format(printFormat, NValue) << ' '
            << format("%02x %02x %04x %08x", NType, NSect, NDesc, NStrx) << ' '
            << S.Name;
     if ((NType & MachO::N_TYPE) == MachO::N_INDR) {
-      outs() << " (indirect for ";
-      outs() << format(printFormat, NValue) << ' ';
+      out() << " (indirect for ";
+      out() << format(printFormat, NValue) << ' ';
       StringRef IndirectName;
       if (S.Sym.getRawDataRefImpl().p) {
         if (MachO->getIndirectName(S.Sym.getRawDataRefImpl(), IndirectName))
-          outs() << "?)";
+          out() << "?)";
         else
-          outs() << IndirectName << ")";
+          out() << IndirectName << ")";
       } else
-        outs() << S.IndirectName << ")";
+        out() << S.IndirectName << ")";
     }
-    outs() << "\n";
+    out() << "\n";
     return;
   }
 
@@ -454,51 +469,51 @@ static void darwinPrintSymbol(SymbolicFile &Obj, const NMSymbol &S,
       strcpy(SymbolAddrStr, printBlanks);
     if (Obj.isIR() && (NType & MachO::N_TYPE) == MachO::N_TYPE)
       strcpy(SymbolAddrStr, printDashes);
-    outs() << SymbolAddrStr << ' ';
+    out() << SymbolAddrStr << ' ';
   }
 
   switch (NType & MachO::N_TYPE) {
   case MachO::N_UNDF:
     if (NValue != 0) {
-      outs() << "(common) ";
+      out() << "(common) ";
       if (MachO::GET_COMM_ALIGN(NDesc) != 0)
-        outs() << "(alignment 2^" << (int)MachO::GET_COMM_ALIGN(NDesc) << ") ";
+        out() << "(alignment 2^" << (int)MachO::GET_COMM_ALIGN(NDesc) << ") ";
     } else {
       if ((NType & MachO::N_TYPE) == MachO::N_PBUD)
-        outs() << "(prebound ";
+        out() << "(prebound ";
       else
-        outs() << "(";
+        out() << "(";
       if ((NDesc & MachO::REFERENCE_TYPE) ==
           MachO::REFERENCE_FLAG_UNDEFINED_LAZY)
-        outs() << "undefined [lazy bound]) ";
+        out() << "undefined [lazy bound]) ";
       else if ((NDesc & MachO::REFERENCE_TYPE) ==
                MachO::REFERENCE_FLAG_PRIVATE_UNDEFINED_LAZY)
-        outs() << "undefined [private lazy bound]) ";
+        out() << "undefined [private lazy bound]) ";
       else if ((NDesc & MachO::REFERENCE_TYPE) ==
                MachO::REFERENCE_FLAG_PRIVATE_UNDEFINED_NON_LAZY)
-        outs() << "undefined [private]) ";
+        out() << "undefined [private]) ";
       else
-        outs() << "undefined) ";
+        out() << "undefined) ";
     }
     break;
   case MachO::N_ABS:
-    outs() << "(absolute) ";
+    out() << "(absolute) ";
     break;
   case MachO::N_INDR:
-    outs() << "(indirect) ";
+    out() << "(indirect) ";
     break;
   case MachO::N_SECT: {
     if (Obj.isIR()) {
       // For llvm bitcode files print out a fake section name using the values
       // use 1, 2 and 3 for section numbers as set above.
       if (NSect == 1)
-        outs() << "(LTO,CODE) ";
+        out() << "(LTO,CODE) ";
       else if (NSect == 2)
-        outs() << "(LTO,DATA) ";
+        out() << "(LTO,DATA) ";
       else if (NSect == 3)
-        outs() << "(LTO,RODATA) ";
+        out() << "(LTO,RODATA) ";
       else
-        outs() << "(?,?) ";
+        out() << "(?,?) ";
       break;
     }
     section_iterator Sec = SectionRef();
@@ -507,12 +522,12 @@ static void darwinPrintSymbol(SymbolicFile &Obj, const NMSymbol &S,
           MachO->getSymbolSection(S.Sym.getRawDataRefImpl());
       if (!SecOrErr) {
         consumeError(SecOrErr.takeError());
-        outs() << "(?,?) ";
+        out() << "(?,?) ";
         break;
       }
       Sec = *SecOrErr;
       if (Sec == MachO->section_end()) {
-        outs() << "(?,?) ";
+        out() << "(?,?) ";
         break;
       }
     } else {
@@ -523,70 +538,70 @@ static void darwinPrintSymbol(SymbolicFile &Obj, const NMSymbol &S,
     if (Expected<StringRef> NameOrErr = MachO->getSectionName(Ref))
       SectionName = *NameOrErr;
     StringRef SegmentName = MachO->getSectionFinalSegmentName(Ref);
-    outs() << "(" << SegmentName << "," << SectionName << ") ";
+    out() << "(" << SegmentName << "," << SectionName << ") ";
     break;
   }
   default:
-    outs() << "(?) ";
+    out() << "(?) ";
     break;
   }
 
   if (NType & MachO::N_EXT) {
     if (NDesc & MachO::REFERENCED_DYNAMICALLY)
-      outs() << "[referenced dynamically] ";
+      out() << "[referenced dynamically] ";
     if (NType & MachO::N_PEXT) {
       if ((NDesc & MachO::N_WEAK_DEF) == MachO::N_WEAK_DEF)
-        outs() << "weak private external ";
+        out() << "weak private external ";
       else
-        outs() << "private external ";
+        out() << "private external ";
     } else {
       if ((NDesc & MachO::N_WEAK_REF) == MachO::N_WEAK_REF ||
           (NDesc & MachO::N_WEAK_DEF) == MachO::N_WEAK_DEF) {
         if ((NDesc & (MachO::N_WEAK_REF | MachO::N_WEAK_DEF)) ==
             (MachO::N_WEAK_REF | MachO::N_WEAK_DEF))
-          outs() << "weak external automatically hidden ";
+          out() << "weak external automatically hidden ";
         else
-          outs() << "weak external ";
+          out() << "weak external ";
       } else
-        outs() << "external ";
+        out() << "external ";
     }
   } else {
     if (NType & MachO::N_PEXT)
-      outs() << "non-external (was a private external) ";
+      out() << "non-external (was a private external) ";
     else
-      outs() << "non-external ";
+      out() << "non-external ";
   }
 
   if (Filetype == MachO::MH_OBJECT) {
     if (NDesc & MachO::N_NO_DEAD_STRIP)
-      outs() << "[no dead strip] ";
+      out() << "[no dead strip] ";
     if ((NType & MachO::N_TYPE) != MachO::N_UNDF &&
         NDesc & MachO::N_SYMBOL_RESOLVER)
-      outs() << "[symbol resolver] ";
+      out() << "[symbol resolver] ";
     if ((NType & MachO::N_TYPE) != MachO::N_UNDF && NDesc & MachO::N_ALT_ENTRY)
-      outs() << "[alt entry] ";
+      out() << "[alt entry] ";
     if ((NType & MachO::N_TYPE) != MachO::N_UNDF && NDesc & MachO::N_COLD_FUNC)
-      outs() << "[cold func] ";
+      out() << "[cold func] ";
   }
 
   if ((NDesc & MachO::N_ARM_THUMB_DEF) == MachO::N_ARM_THUMB_DEF)
-    outs() << "[Thumb] ";
+    out() << "[Thumb] ";
 
   if ((NType & MachO::N_TYPE) == MachO::N_INDR) {
-    outs() << S.Name << " (for ";
+    out() << S.Name << " (for ";
     StringRef IndirectName;
     if (MachO) {
       if (S.Sym.getRawDataRefImpl().p) {
         if (MachO->getIndirectName(S.Sym.getRawDataRefImpl(), IndirectName))
-          outs() << "?)";
+          out() << "?)";
         else
-          outs() << IndirectName << ")";
+          out() << IndirectName << ")";
       } else
-        outs() << S.IndirectName << ")";
+        out() << S.IndirectName << ")";
     } else
-      outs() << "?)";
+      out() << "?)";
   } else
-    outs() << S.Name;
+    out() << S.Name;
 
   if ((Flags & MachO::MH_TWOLEVEL) == MachO::MH_TWOLEVEL &&
       (((NType & MachO::N_TYPE) == MachO::N_UNDF && NValue == 0) ||
@@ -594,21 +609,21 @@ static void darwinPrintSymbol(SymbolicFile &Obj, const NMSymbol &S,
     uint32_t LibraryOrdinal = MachO::GET_LIBRARY_ORDINAL(NDesc);
     if (LibraryOrdinal != 0) {
       if (LibraryOrdinal == MachO::EXECUTABLE_ORDINAL)
-        outs() << " (from executable)";
+        out() << " (from executable)";
       else if (LibraryOrdinal == MachO::DYNAMIC_LOOKUP_ORDINAL)
-        outs() << " (dynamically looked up)";
+        out() << " (dynamically looked up)";
       else {
         StringRef LibraryName;
         if (!MachO ||
             MachO->getLibraryShortNameByIndex(LibraryOrdinal - 1, LibraryName))
-          outs() << " (from bad library ordinal " << LibraryOrdinal << ")";
+          out() << " (from bad library ordinal " << LibraryOrdinal << ")";
         else
-          outs() << " (from " << LibraryName << ")";
+          out() << " (from " << LibraryName << ")";
       }
     }
   }
 
-  outs() << "\n";
+  out() << "\n";
 }
 
 // Table that maps Darwin's Mach-O stab constants to strings to allow printing.
@@ -678,11 +693,11 @@ static void darwinPrintStab(MachOObjectFile *MachO, const NMSymbol &S) {
     NDesc = STE.n_desc;
   }
 
-  outs() << format(" %02x %04x ", NSect, NDesc);
+  out() << format(" %02x %04x ", NSect, NDesc);
   if (const char *stabString = getDarwinStabString(NType))
-    outs() << format("%5.5s", stabString);
+    out() << format("%5.5s", stabString);
   else
-    outs() << format("   %02x", NType);
+    out() << format("   %02x", NType);
 }
 
 static Optional<std::string> demangle(StringRef Name, bool StripUnderscore) {
@@ -707,9 +722,12 @@ static bool symbolIsDefined(const NMSymbol &Sym) {
   return Sym.TypeChar != 'U' && Sym.TypeChar != 'w' && Sym.TypeChar != 'v';
 }
 
-static void sortAndPrintSymbolList(SymbolicFile &Obj, bool printName,
+static void sortAndPrintSymbolList(SymbolicFile &Obj,
+                                   std::vector<NMSymbol> &SymbolList,
+                                   bool printName,
                                    const std::string &ArchiveName,
                                    const std::string &ArchitectureName) {
+  StringRef CurrentFilename = Obj.getFileName();
   if (!NoSort) {
     using Comparator = bool (*)(const NMSymbol &, const NMSymbol &);
     Comparator Cmp;
@@ -730,16 +748,16 @@ static void sortAndPrintSymbolList(SymbolicFile &Obj, bool printName,
 
   if (!PrintFileName) {
     if (OutputFormat == posix && MultipleFiles && printName) {
-      outs() << '\n' << CurrentFilename << ":\n";
+      out() << '\n' << CurrentFilename << ":\n";
     } else if (OutputFormat == bsd && MultipleFiles && printName) {
-      outs() << "\n" << CurrentFilename << ":\n";
+      out() << "\n" << CurrentFilename << ":\n";
     } else if (OutputFormat == sysv) {
-      outs() << "\n\nSymbols from " << CurrentFilename << ":\n\n";
+      out() << "\n\nSymbols from " << CurrentFilename << ":\n\n";
       if (isSymbolList64Bit(Obj))
-        outs() << "Name                  Value           Class        Type"
+        out() << "Name                  Value           Class        Type"
                << "         Size             Line  Section\n";
       else
-        outs() << "Name                  Value   Class        Type"
+        out() << "Name                  Value   Class        Type"
                << "         Size     Line  Section\n";
     }
   }
@@ -787,17 +805,20 @@ static void sortAndPrintSymbolList(SymbolicFile &Obj, bool printName,
 
   if (SymbolList.empty()) {
     if (PrintFileName)
-      writeFileName(errs());
-    errs() << "no symbols\n";
+      writeFileName(err());
+    err() << "no symbols\n";
   }
 
   for (const NMSymbol &S : SymbolList) {
     uint32_t SymFlags;
-    std::string Name = S.Name.str();
+    StringRef Name = S.Name;
+    std::string DemangledName;
     MachOObjectFile *MachO = dyn_cast<MachOObjectFile>(&Obj);
     if (Demangle) {
-      if (Optional<std::string> Opt = demangle(S.Name, MachO))
-        Name = *Opt;
+      if (Optional<std::string> Opt = demangle(S.Name, MachO)) {
+        DemangledName = std::move(*Opt);
+        Name = DemangledName;
+      }
     }
     if (S.Sym.getRawDataRefImpl().p)
       SymFlags = S.Sym.getFlags();
@@ -811,11 +832,11 @@ static void sortAndPrintSymbolList(SymbolicFile &Obj, bool printName,
         (!Global && ExternalOnly) || (Weak && NoWeakSymbols))
       continue;
     if (PrintFileName)
-      writeFileName(outs());
+      writeFileName(out());
     if ((JustSymbolName ||
          (UndefinedOnly && MachO && OutputFormat != darwin)) &&
         OutputFormat != posix) {
-      outs() << Name << "\n";
+      out() << Name << "\n";
       continue;
     }
 
@@ -854,37 +875,35 @@ static void sortAndPrintSymbolList(SymbolicFile &Obj, bool printName,
       darwinPrintSymbol(Obj, S, SymbolAddrStr, printBlanks, printDashes,
                         printFormat);
     } else if (OutputFormat == posix) {
-      outs() << Name << " " << S.TypeChar << " " << SymbolAddrStr << " "
+      out() << Name << " " << S.TypeChar << " " << SymbolAddrStr << " "
              << (MachO ? "0" : SymbolSizeStr) << "\n";
     } else if (OutputFormat == bsd || (OutputFormat == darwin && !MachO)) {
       if (PrintAddress)
-        outs() << SymbolAddrStr << ' ';
+        out() << SymbolAddrStr << ' ';
       if (PrintSize)
-        outs() << SymbolSizeStr << ' ';
-      outs() << S.TypeChar;
+        out() << SymbolSizeStr << ' ';
+      out() << S.TypeChar;
       if (S.TypeChar == '-' && MachO)
         darwinPrintStab(MachO, S);
-      outs() << " " << Name;
+      out() << " " << Name;
       if (S.TypeChar == 'I' && MachO) {
-        outs() << " (indirect for ";
+        out() << " (indirect for ";
         if (S.Sym.getRawDataRefImpl().p) {
           StringRef IndirectName;
           if (MachO->getIndirectName(S.Sym.getRawDataRefImpl(), IndirectName))
-            outs() << "?)";
+            out() << "?)";
           else
-            outs() << IndirectName << ")";
+            out() << IndirectName << ")";
         } else
-          outs() << S.IndirectName << ")";
+          out() << S.IndirectName << ")";
       }
-      outs() << "\n";
+      out() << "\n";
     } else if (OutputFormat == sysv) {
-      outs() << left_justify(Name, 20) << "|" << SymbolAddrStr << "|   "
+      out() << left_justify(Name, 20) << "|" << SymbolAddrStr << "|   "
              << S.TypeChar << "  |" << right_justify(S.TypeName, 18) << "|"
              << SymbolSizeStr << "|     |" << S.SectionName << "\n";
     }
   }
-
-  SymbolList.clear();
 }
 
 static char getSymbolNMTypeChar(ELFObjectFileBase &Obj,
@@ -1194,8 +1213,13 @@ dumpSymbolNamesFromObject(SymbolicFile &Obj, bool printName,
     }
     Symbols = E->getDynamicSymbolIterators();
   }
+  std::vector<NMSymbol> SymbolList;
+  // The names of object file symbols already are in the file. Those of other
+  // symbolic files are printed to NameBuffer, and SymbolList entries are
+  // pointed at them once it is complete.
   std::string NameBuffer;
   raw_string_ostream OS(NameBuffer);
+  std::vector<std::pair<size_t, size_t>> BufferedNames;
   // If a "-s segname sectname" option was specified and this is a Mach-O
   // file get the section number for that section in this object file.
   unsigned int Nsect = 0;
@@ -1234,26 +1258,34 @@ dumpSymbolNamesFromObject(SymbolicFile &Obj, bool printName,
       }
       S.TypeName = getNMTypeName(Obj, Sym);
       S.TypeChar = getNMSectionTagAndName(Obj, Sym, S.SectionName);
-      if (Error E = Sym.printName(OS)) {
-        if (MachO) {
-          OS << "bad string index";
-          consumeError(std::move(E));
-        } else
-          error(std::move(E), Obj.getFileName());
+      Expected<StringRef> NameOrErr = StringRef();
+      if (isa<ObjectFile>(Obj))
+        NameOrErr = SymbolRef(Sym).getName();
+      if (isa<ObjectFile>(Obj) && NameOrErr) {
+        S.Name = *NameOrErr;
+      } else {
+        // Print the name, which also reports errors the same way for all
+        // kinds of files.
+        consumeError(NameOrErr.takeError());
+        BufferedNames.emplace_back(SymbolList.size(), OS.tell());
+        if (Error E = Sym.printName(OS)) {
+          if (MachO) {
+            OS << "bad string index";
+            consumeError(std::move(E));
+          } else
+            error(std::move(E), Obj.getFileName());
+        }
+        OS << '\0';
       }
-      OS << '\0';
       S.Sym = Sym;
       SymbolList.push_back(S);
     }
   }
 
   OS.flush();
-  const char *P = NameBuffer.c_str();
-  unsigned I;
-  for (I = 0; I < SymbolList.size(); ++I) {
-    SymbolList[I].Name = P;
-    P += strlen(P) + 1;
-  }
+  for (const std::pair<size_t, size_t> &Buffered : BufferedNames)
+    SymbolList[Buffered.first].Name = NameBuffer.c_str() + Buffered.second;
+  unsigned I = SymbolList.size();
 
   // If this is a Mach-O file where the nlist symbol table is out of sync
   // with the dyld export trie then look through exports and fake up symbols
@@ -1735,8 +1767,8 @@ dumpSymbolNamesFromObject(SymbolicFile &Obj, bool printName,
     }
   }
 
-  CurrentFilename = Obj.getFileName();
-  sortAndPrintSymbolList(Obj, printName, ArchiveName, ArchitectureName);
+  sortAndPrintSymbolList(Obj, SymbolList, printName, ArchiveName,
+                         ArchitectureName);
 }
 
 // checkMachOAndArchFlags() checks to see if the SymbolicFile is a Mach-O file
@@ -1794,7 +1826,7 @@ static void dumpSymbolNamesFromFile(std::string &Filename) {
       Archive::symbol_iterator I = A->symbol_begin();
       Archive::symbol_iterator E = A->symbol_end();
       if (I != E) {
-        outs() << "Archive map\n";
+        out() << "Archive map\n";
         for (; I != E; ++I) {
           Expected<Archive::Child> C = I->getMember();
           if (!C) {
@@ -1807,9 +1839,9 @@ static void dumpSymbolNamesFromFile(std::string &Filename) {
             break;
           }
           StringRef SymName = I->getName();
-          outs() << SymName << " in " << FileNameOrErr.get() << "\n";
+          out() << SymName << " in " << FileNameOrErr.get() << "\n";
         }
-        outs() << "\n";
+        out() << "\n";
       }
     }
 
@@ -1824,20 +1856,20 @@ static void dumpSymbolNamesFromFile(std::string &Filename) {
           continue;
         }
         if (SymbolicFile *O = dyn_cast<SymbolicFile>(&*ChildOrErr.get())) {
-          if (!MachOPrintSizeWarning && PrintSize &&  isa<MachOObjectFile>(O)) {
-            WithColor::warning(errs(), ToolName)
+          if (PrintSize && isa<MachOObjectFile>(O) &&
+              !MachOPrintSizeWarning.exchange(true)) {
+            WithColor::warning(err(), ToolName)
                 << "sizes with -print-size for Mach-O files are always zero.\n";
-            MachOPrintSizeWarning = true;
           }
           if (!checkMachOAndArchFlags(O, Filename))
             return;
           if (!PrintFileName) {
-            outs() << "\n";
+            out() << "\n";
             if (isa<MachOObjectFile>(O)) {
-              outs() << Filename << "(" << O->getFileName() << ")";
+              out() << Filename << "(" << O->getFileName() << ")";
             } else
-              outs() << O->getFileName();
-            outs() << ":\n";
+              out() << O->getFileName();
+            out() << ":\n";
           }
           dumpSymbolNamesFromObject(*O, false, Filename);
         }
@@ -1871,7 +1903,7 @@ static void dumpSymbolNamesFromFile(std::string &Filename) {
                 if (PrintFileName)
                   ArchitectureName = I->getArchFlagName();
                 else
-                  outs() << "\n" << Obj.getFileName() << " (for architecture "
+                  out() << "\n" << Obj.getFileName() << " (for architecture "
                          << I->getArchFlagName() << ")"
                          << ":\n";
               }
@@ -1904,13 +1936,13 @@ static void dumpSymbolNamesFromFile(std::string &Filename) {
                     if (ArchFlags.size() > 1)
                       ArchitectureName = I->getArchFlagName();
                   } else {
-                    outs() << "\n" << A->getFileName();
-                    outs() << "(" << O->getFileName() << ")";
+                    out() << "\n" << A->getFileName();
+                    out() << "(" << O->getFileName() << ")";
                     if (ArchFlags.size() > 1) {
-                      outs() << " (for architecture " << I->getArchFlagName()
+                      out() << " (for architecture " << I->getArchFlagName()
                              << ")";
                     }
-                    outs() << ":\n";
+                    out() << ":\n";
                   }
                   dumpSymbolNamesFromObject(*O, false, ArchiveName,
                                             ArchitectureName);
@@ -1971,7 +2003,7 @@ static void dumpSymbolNamesFromFile(std::string &Filename) {
                 if (PrintFileName)
                   ArchiveName = A->getFileName();
                 else
-                  outs() << "\n" << A->getFileName() << "(" << O->getFileName()
+                  out() << "\n" << A->getFileName() << "(" << O->getFileName()
                          << ")"
                          << ":\n";
                 dumpSymbolNamesFromObject(*O, false, ArchiveName);
@@ -2006,11 +2038,11 @@ static void dumpSymbolNamesFromFile(std::string &Filename) {
             ArchitectureName = O.getArchFlagName();
         } else {
           if (moreThanOneArch)
-            outs() << "\n";
-          outs() << Obj.getFileName();
+            out() << "\n";
+          out() << Obj.getFileName();
           if (isa<MachOObjectFile>(Obj) && moreThanOneArch)
-            outs() << " (for architecture " << O.getArchFlagName() << ")";
-          outs() << ":\n";
+            out() << " (for architecture " << O.getArchFlagName() << ")";
+          out() << ":\n";
         }
         dumpSymbolNamesFromObject(Obj, false, ArchiveName, ArchitectureName);
       } else if (auto E = isNotObjectErrorInvalidFileType(
@@ -2038,15 +2070,15 @@ static void dumpSymbolNamesFromFile(std::string &Filename) {
               if (isa<MachOObjectFile>(F) && moreThanOneArch)
                 ArchitectureName = O.getArchFlagName();
             } else {
-              outs() << "\n" << A->getFileName();
+              out() << "\n" << A->getFileName();
               if (isa<MachOObjectFile>(F)) {
-                outs() << "(" << F->getFileName() << ")";
+                out() << "(" << F->getFileName() << ")";
                 if (moreThanOneArch)
-                  outs() << " (for architecture " << O.getArchFlagName()
+                  out() << " (for architecture " << O.getArchFlagName()
                          << ")";
               } else
-                outs() << ":" << F->getFileName();
-              outs() << ":\n";
+                out() << ":" << F->getFileName();
+              out() << ":\n";
             }
             dumpSymbolNamesFromObject(*F, false, ArchiveName, ArchitectureName);
           }
@@ -2064,10 +2096,10 @@ static void dumpSymbolNamesFromFile(std::string &Filename) {
     return;
   }
   if (SymbolicFile *O = dyn_cast<SymbolicFile>(&Bin)) {
-    if (!MachOPrintSizeWarning && PrintSize &&  isa<MachOObjectFile>(O)) {
-      WithColor::warning(errs(), ToolName)
+    if (PrintSize && isa<MachOObjectFile>(O) &&
+        !MachOPrintSizeWarning.exchange(true)) {
+      WithColor::warning(err(), ToolName)
           << "sizes with --print-size for Mach-O files are always zero.\n";
-      MachOPrintSizeWarning = true;
     }
     if (!checkMachOAndArchFlags(O, Filename))
       return;
@@ -2130,7 +2162,34 @@ int main(int argc, char **argv) {
   if (NoDyldInfo && (AddDyldInfo || DyldInfoOnly))
     error("--no-dyldinfo can't be used with --add-dyldinfo or --dyldinfo-only");
 
-  llvm::for_each(InputFilenames, dumpSymbolNamesFromFile);
+  if (NumThreads == 0)
+    NumThreads = hardware_concurrency();
+  if (NumThreads == 1 || InputFilenames.size() == 1) {
+    llvm::for_each(InputFilenames, dumpSymbolNamesFromFile);
+  } else {
+    size_t NumFiles = InputFilenames.size();
+    std::vector<std::string> Outs(NumFiles), Errs(NumFiles);
+    std::vector<std::shared_future<void>> Dumped;
+    ThreadPool Pool(std::min<size_t>(NumThreads, NumFiles));
+    for (size_t I = 0; I != NumFiles; ++I)
+      Dumped.push_back(Pool.async([&, I] {
+        raw_string_ostream OS(Outs[I]);
+        raw_string_ostream ES(Errs[I]);
+        FileOuts = &OS;
+        FileErrs = &ES;
+        dumpSymbolNamesFromFile(InputFilenames[I]);
+        FileOuts = nullptr;
+        FileErrs = nullptr;
+      }));
+    // Print each file as soon as it and all files before it are done.
+    for (size_t I = 0; I != NumFiles; ++I) {
+      Dumped[I].wait();
+      outs() << Outs[I];
+      errs() << Errs[I];
+      std::string().swap(Outs[I]);
+      std::string().swap(Errs[I]);
+    }
+  }
 
   if (HadError)
     return 1;
@@ -7,17 +7,29 @@
 //===----------------------------------------------------------------------===//
 
 #include "Buffer.h"
+#include "llvm/ADT/STLExtras.h"
 #include "llvm/Support/FileOutputBuffer.h"
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Process.h"
+#include "llvm/Support/raw_ostream.h"
 #include <memory>
 
+#if defined(__linux__)
+#include <cerrno>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
 namespace llvm {
 namespace objcopy {
 
 Buffer::~Buffer() {}
 
+void Buffer::copyFrom(uint64_t Offset, ArrayRef<uint8_t> Data) {
+  llvm::copy(Data, getBufferStart() + Offset);
+}
+
 static Error createEmptyFile(StringRef FileName) {
   // Create an empty tempfile and atomically swap it in place with the desired
   // output file.
@@ -53,7 +65,104 @@ Error FileBuffer::commit() {
   Error Err = Buf->commit();
   // FileOutputBuffer::commit() returns an Error that is just a wrapper around
   // std::error_code. Wrap it in FileError to include the actual filename.
-  return Err ? createFileError(getName(), std::move(Err)) : std::move(Err);
+  if (Err)
+    return createFileError(getName(), std::move(Err));
+  return copyFileRanges();
+}
+
+FileBuffer::~FileBuffer() {
+  if (InputFD != -1)
+    sys::Process::SafelyCloseFileDescriptor(InputFD);
+}
+
+// Smaller copies are not worth a system call of their own.
+static const uint64_t MinFileCopySize = 1 << 20;
+
+bool FileBuffer::openInputFile() {
+  if (InputFD != -1)
+    return true;
+  if (InputData.empty() || InputFileName == "-" || getName() == "-")
+    return false;
+
+  // The copies are done by reopening the output after commit(), which only
+  // works if FileOutputBuffer renames a regular file into place. The input is
+  // opened now, as an in-place strip replaces it on commit().
+  sys::fs::file_status Stat;
+  if (!sys::fs::status(getName(), Stat) &&
+      Stat.type() != sys::fs::file_type::regular_file) {
+    InputData = {};
+    return false;
+  }
+  int FD;
+  if (sys::fs::openFileForRead(InputFileName, FD)) {
+    InputData = {};
+    return false;
+  }
+  if (sys::fs::status(FD, Stat) ||
+      Stat.type() != sys::fs::file_type::regular_file ||
+      Stat.getSize() != InputData.size()) {
+    sys::Process::SafelyCloseFileDescriptor(FD);
+    InputData = {};
+    return false;
+  }
+  InputFD = FD;
+  return true;
+}
+
+void FileBuffer::copyFrom(uint64_t Offset, ArrayRef<uint8_t> Data) {
+  if (Data.size() >= MinFileCopySize && Data.begin() >= InputData.begin() &&
+      Data.end() <= InputData.end() && openInputFile()) {
+    FileCopies.push_back(
+        {Offset, uint64_t(Data.begin() - InputData.begin()), Data.size()});
+    return;
+  }
+  Buffer::copyFrom(Offset, Data);
+}
+
+Error FileBuffer::copyFileRanges() {
+  if (FileCopies.empty())
+    return Error::success();
+
+  int OutputFD;
+  if (std::error_code EC = sys::fs::openFileForWrite(
+          getName(), OutputFD, sys::fs::CD_OpenExisting))
+    return createFileError(getName(), EC);
+  raw_fd_ostream OS(OutputFD, /*shouldClose=*/true, /*unbuffered=*/true);
+
+  for (const FileCopy &Copy : FileCopies) {
+    uint64_t InputOffset = Copy.InputOffset;
+    uint64_t OutputOffset = Copy.OutputOffset;
+    uint64_t Size = Copy.Size;
+#if defined(__linux__) && defined(SYS_copy_file_range)
+    // Let the kernel copy or share the blocks. Fall back to writing from the
+    // mapped input if the file systems do not support it.
+    while (Size != 0) {
+      loff_t In = InputOffset, Out = OutputOffset;
+      ssize_t Copied =
+          syscall(SYS_copy_file_range, InputFD, &In, OutputFD, &Out, Size, 0);
+      if (Copied < 0 && errno == EINTR)
+        continue;
+      if (Copied <= 0)
+        break;
+      InputOffset += Copied;
+      OutputOffset += Copied;
+      Size -= Copied;
+    }
+#endif
+    if (Size != 0) {
+      OS.seek(OutputOffset);
+      OS.write(reinterpret_cast<const char *>(InputData.data() + InputOffset),
+               Size);
+    }
+  }
+
+  OS.close();
+  if (OS.has_error()) {
+    std::error_code EC = OS.error();
+    OS.clear_error();
+    return createFileError(getName(), EC);
+  }
+  return Error::success();
 }
 
 uint8_t *FileBuffer::getBufferStart() {
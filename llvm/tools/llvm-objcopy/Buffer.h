@@ -9,10 +9,12 @@
 #ifndef LLVM_TOOLS_OBJCOPY_BUFFER_H
 #define LLVM_TOOLS_OBJCOPY_BUFFER_H
 
+#include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Support/FileOutputBuffer.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include <memory>
+#include <vector>
 
 namespace llvm {
 namespace objcopy {
@@ -31,6 +33,11 @@ public:
   virtual uint8_t *getBufferStart() = 0;
   virtual Error commit() = 0;
 
+  // Copies Data to Offset in the buffer. Data may point into the input file,
+  // in which case the copy may be deferred until commit(). Nothing else may
+  // write to the destination range.
+  virtual void copyFrom(uint64_t Offset, ArrayRef<uint8_t> Data);
+
   explicit Buffer(StringRef Name) : Name(Name) {}
   StringRef getName() const { return Name; }
 };
@@ -41,12 +48,36 @@ class FileBuffer : public Buffer {
   // truncate a file instead of using a FileOutputBuffer.
   bool EmptyFile = false;
 
+  // The input file set with setInputFile(), if any. Large copies out of it are
+  // done file to file on commit(), so that unmodified data is not paged in
+  // and written through the output mapping.
+  StringRef InputFileName;
+  ArrayRef<uint8_t> InputData;
+  int InputFD = -1;
+  struct FileCopy {
+    uint64_t OutputOffset;
+    uint64_t InputOffset;
+    uint64_t Size;
+  };
+  std::vector<FileCopy> FileCopies;
+
+  bool openInputFile();
+  Error copyFileRanges();
+
 public:
   Error allocate(size_t Size) override;
   uint8_t *getBufferStart() override;
   Error commit() override;
+  void copyFrom(uint64_t Offset, ArrayRef<uint8_t> Data) override;
+
+  // Tells the buffer that Data is the whole contents of the file FileName.
+  void setInputFile(StringRef FileName, ArrayRef<uint8_t> Data) {
+    InputFileName = FileName;
+    InputData = Data;
+  }
 
   explicit FileBuffer(StringRef FileName) : Buffer(FileName) {}
+  ~FileBuffer() override;
 };
 
 class MemBuffer : public Buffer {
@@ -144,7 +144,7 @@ void BinarySectionWriter::visit(const GroupSection &Sec) {
 
 void SectionWriter::visit(const Section &Sec) {
   if (Sec.Type != SHT_NOBITS)
-    llvm::copy(Sec.Contents, Out.getBufferStart() + Sec.Offset);
+    Out.copyFrom(Sec.Offset, Sec.Contents);
 }
 
 static bool addressOverflows32bit(uint64_t Addr) {
@@ -1763,11 +1763,47 @@ template <class ELFT> void ELFWriter<ELFT>::writeSectionData() {
 }
 
 template <class ELFT> void ELFWriter<ELFT>::writeSegmentData() {
+  // Ranges that are written again after the segment data: the ELF header, the
+  // program headers and removed sections. Only the rest of the segment data
+  // may be copied with Buffer::copyFrom, which can defer the copy.
+  std::vector<std::pair<uint64_t, uint64_t>> Rewritten;
+  Rewritten.emplace_back(0, sizeof(Elf_Ehdr));
+  Rewritten.emplace_back(Obj.ProgramHdrSegment.Offset,
+                         Obj.ProgramHdrSegment.Offset +
+                             llvm::size(Obj.segments()) * sizeof(Elf_Phdr));
+  for (auto &Sec : Obj.removedSections()) {
+    Segment *Parent = Sec.ParentSegment;
+    if (Parent == nullptr || Sec.Type == SHT_NOBITS || Sec.Size == 0)
+      continue;
+    uint64_t Offset =
+        Sec.OriginalOffset - Parent->OriginalOffset + Parent->Offset;
+    Rewritten.emplace_back(Offset, Offset + Sec.Size);
+  }
+  llvm::sort(Rewritten);
+
   for (Segment &Seg : Obj.segments()) {
-    uint8_t *B = Buf.getBufferStart() + Seg.Offset;
-    assert(Seg.FileSize == Seg.getContents().size() &&
+    // The contents of a nested segment are part of its parent's.
+    if (Seg.ParentSegment != nullptr)
+      continue;
+    ArrayRef<uint8_t> Contents = Seg.getContents();
+    assert(Seg.FileSize == Contents.size() &&
            "Segment size must match contents size");
-    std::memcpy(B, Seg.getContents().data(), Seg.FileSize);
+    uint64_t End = Seg.Offset + Seg.FileSize;
+    uint64_t Pos = Seg.Offset;
+    for (const std::pair<uint64_t, uint64_t> &Range : Rewritten) {
+      if (Range.second <= Pos || Range.first >= End)
+        continue;
+      if (Range.first > Pos) {
+        Buf.copyFrom(Pos, Contents.slice(Pos - Seg.Offset, Range.first - Pos));
+        Pos = Range.first;
+      }
+      uint64_t RangeEnd = std::min(Range.second, End);
+      std::memcpy(Buf.getBufferStart() + Pos,
+                  Contents.data() + (Pos - Seg.Offset), RangeEnd - Pos);
+      Pos = RangeEnd;
+    }
+    if (Pos < End)
+      Buf.copyFrom(Pos, Contents.slice(Pos - Seg.Offset));
   }
 
   // Iterate over removed sections and overwrite their old data with zeroes.
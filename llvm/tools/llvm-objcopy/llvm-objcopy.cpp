@@ -15,6 +15,7 @@
 
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringExtras.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/ADT/Twine.h"
 #include "llvm/Object/Archive.h"
@@ -293,6 +294,9 @@ static Error executeObjcopy(CopyConfig &Config) {
         return E;
     } else {
       FileBuffer FB(Config.OutputFilename);
+      // Let unmodified data be copied file to file rather than through memory.
+      StringRef InputData = BinaryOrErr.get().getBinary()->getData();
+      FB.setInputFile(Config.InputFilename, arrayRefFromStringRef(InputData));
       if (Error E = executeObjcopyOnBinary(Config,
                                            *BinaryOrErr.get().getBinary(), FB))
         return E;
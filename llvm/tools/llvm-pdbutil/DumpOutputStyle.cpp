@@ -52,6 +52,8 @@
 #include "llvm/Support/BinaryStreamReader.h"
 #include "llvm/Support/FormatAdapters.h"
 #include "llvm/Support/FormatVariadic.h"
+#include "llvm/Support/ThreadPool.h"
+#include "llvm/Support/Threading.h"
 
 #include <cctype>
 
@@ -307,6 +309,53 @@ static StatCollection getChunkStats(const SymbolGroup &SG,
   return Stats;
 }
 
+namespace {
+struct ModuleStats {
+  StatCollection Symbols;
+  StatCollection Chunks;
+};
+} // namespace
+
+/// Collects the symbol and chunk statistics of every module stream of \p File
+/// on \p NumThreads threads, indexed by module.
+static std::vector<ModuleStats> getAllModuleStats(PDBFile &File,
+                                                  uint32_t NumThreads) {
+  // Reading module descriptors goes through the DBI stream, so do it here.
+  // The module streams are then only read by the thread that handles them.
+  const DbiModuleList &Modules = cantFail(File.getPDBDbiStream()).modules();
+  std::vector<DbiModuleDescriptor> Descriptors;
+  for (uint32_t I = 0, E = Modules.getModuleCount(); I != E; ++I)
+    Descriptors.push_back(Modules.getModuleDescriptor(I));
+
+  std::vector<ModuleStats> Stats(Descriptors.size());
+  ThreadPool Pool(NumThreads);
+  for (uint32_t I = 0, E = Descriptors.size(); I != E; ++I) {
+    Pool.async([&, I]() {
+      uint16_t StreamIdx = Descriptors[I].getModuleStreamIndex();
+      if (StreamIdx == kInvalidStreamIndex)
+        return;
+      // A stream allocates from its allocator when a read crosses blocks, and
+      // the allocator of the file can't be shared between threads.
+      BumpPtrAllocator Allocator;
+      ModuleDebugStreamRef ModS(
+          Descriptors[I],
+          MappedBlockStream::createIndexedStream(
+              File.getMsfLayout(), File.getMsfBuffer(), StreamIdx, Allocator));
+      if (auto EC = ModS.reload()) {
+        consumeError(std::move(EC));
+        return;
+      }
+      for (const auto &S : ModS.symbols(nullptr))
+        Stats[I].Symbols.update(S.kind(), S.length());
+      for (const auto &Chunk : ModS.subsections())
+        Stats[I].Chunks.update(uint32_t(Chunk.kind()),
+                               Chunk.getRecordLength());
+    });
+  }
+  Pool.wait();
+  return Stats;
+}
+
 static inline std::string formatModuleDetailKind(DebugSubsectionKind K) {
   return formatChunkKind(K, false);
 }
@@ -661,9 +710,27 @@ Error DumpOutputStyle::dumpSymbolStats() {
   if (File.isPdb())
     Scope.emplace(P, 2);
 
+  // Reading the module streams is what takes time, so with multiple threads
+  // it is done for all modules up front.
+  std::vector<ModuleStats> AllModuleStats;
+  uint32_t NumThreads = opts::dump::NumThreads;
+  if (NumThreads == 0)
+    NumThreads = heavyweight_hardware_concurrency();
+  if (File.isPdb() && NumThreads > 1)
+    AllModuleStats = getAllModuleStats(getPdb(), NumThreads);
+
   iterateSymbolGroups(File, Scope, [&](uint32_t Modi, const SymbolGroup &SG) {
-    StatCollection SS = getSymbolStats(SG, SymStats);
-    StatCollection CS = getChunkStats(SG, ChunkStats);
+    StatCollection SS;
+    StatCollection CS;
+    if (Modi < AllModuleStats.size()) {
+      SS = AllModuleStats[Modi].Symbols;
+      CS = AllModuleStats[Modi].Chunks;
+      SymStats.update(SS);
+      ChunkStats.update(CS);
+    } else {
+      SS = getSymbolStats(SG, SymStats);
+      CS = getChunkStats(SG, ChunkStats);
+    }
 
     if (SG.getFile().isPdb()) {
       AutoIndent Indent(P);
@@ -57,6 +57,15 @@ struct StatCollection {
     if (!Iter.second)
       Iter.first->second.update(RecordSize);
   }
+  void update(const StatCollection &Other) {
+    Totals.Count += Other.Totals.Count;
+    Totals.Size += Other.Totals.Size;
+    for (const auto &KS : Other.Individual) {
+      Stat &S = Individual[KS.first];
+      S.Count += KS.second.Count;
+      S.Size += KS.second.Size;
+    }
+  }
   Stat Totals;
   DenseMap<uint32_t, Stat> Individual;
 
@@ -586,6 +586,11 @@ cl::opt<bool> JustMyCode("jmc", cl::Optional,
                          cl::desc("For all options that iterate over modules, "
                                   "ignore modules from system libraries"),
                          cl::cat(FileOptions), cl::sub(DumpSubcommand));
+cl::opt<uint32_t> NumThreads("threads", cl::init(1),
+                             cl::desc("Number of threads that read module "
+                                      "streams for -sym-stats "
+                                      "(0 = one per core)"),
+                             cl::cat(FileOptions), cl::sub(DumpSubcommand));
 
 // MISCELLANEOUS OPTIONS
 cl::opt<bool> DumpNamedStreams("named-streams",
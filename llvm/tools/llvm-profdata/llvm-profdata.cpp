@@ -10,6 +10,8 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/MapVector.h"
 #include "llvm/ADT/SmallSet.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/StringRef.h"
@@ -26,9 +28,11 @@
 #include "llvm/Support/InitLLVM.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
+#include "llvm/Support/StringSaver.h"
 #include "llvm/Support/ThreadPool.h"
 #include "llvm/Support/WithColor.h"
 #include "llvm/Support/raw_ostream.h"
+#include "llvm/Support/xxhash.h"
 #include <algorithm>
 
 using namespace llvm;
@@ -220,41 +224,61 @@ static void overlapInput(const std::string &BaseFilename,
 }
 
 /// Load an input into a writer context.
-static void loadInput(const WeightedFile &Input, SymbolRemapper *Remapper,
-                      WriterContext *WC) {
-  std::unique_lock<std::mutex> CtxGuard{WC->Lock};
+/// Returns the writer context that merges the records of \p FuncName. The
+/// functions are partitioned between the contexts, so that each function is
+/// merged in a single context.
+static WriterContext *getPartition(StringRef FuncName,
+                                   ArrayRef<WriterContext *> Partitions) {
+  if (Partitions.size() == 1)
+    return Partitions[0];
+  return Partitions[xxHash64(FuncName) % Partitions.size()];
+}
 
+/// Load the records of \p Input into the writer contexts of their partition.
+/// The errors of the input are reported in \p ErrorCtx.
+static void loadInput(const WeightedFile &Input, SymbolRemapper *Remapper,
+                      ArrayRef<WriterContext *> Partitions,
+                      WriterContext *ErrorCtx) {
   // Copy the filename, because llvm::ThreadPool copied the input "const
   // WeightedFile &" by value, making a reference to the filename within it
   // invalid outside of this packaged task.
   std::string Filename = Input.Filename;
 
+  auto AddError = [&](Error E) {
+    std::unique_lock<std::mutex> CtxGuard{ErrorCtx->Lock};
+    ErrorCtx->Errors.emplace_back(std::move(E), Filename);
+  };
+
   auto ReaderOrErr = InstrProfReader::create(Input.Filename);
   if (Error E = ReaderOrErr.takeError()) {
     // Skip the empty profiles by returning sliently.
     instrprof_error IPE = InstrProfError::take(std::move(E));
     if (IPE != instrprof_error::empty_raw_profile)
-      WC->Errors.emplace_back(make_error<InstrProfError>(IPE), Filename);
+      AddError(make_error<InstrProfError>(IPE));
     return;
   }
 
   auto Reader = std::move(ReaderOrErr.get());
   bool IsIRProfile = Reader->isIRLevelProfile();
   bool HasCSIRProfile = Reader->hasCSIRLevelProfile();
-  if (WC->Writer.setIsIRLevelProfile(IsIRProfile, HasCSIRProfile)) {
-    WC->Errors.emplace_back(
-        make_error<StringError>(
-            "Merge IR generated profile with Clang generated profile.",
-            std::error_code()),
-        Filename);
-    return;
+  for (WriterContext *WC : Partitions) {
+    std::unique_lock<std::mutex> CtxGuard{WC->Lock};
+    if (WC->Writer.setIsIRLevelProfile(IsIRProfile, HasCSIRProfile)) {
+      CtxGuard.unlock();
+      AddError(make_error<StringError>(
+          "Merge IR generated profile with Clang generated profile.",
+          std::error_code()));
+      return;
+    }
   }
 
   for (auto &I : *Reader) {
     if (Remapper)
       I.Name = (*Remapper)(I.Name);
     const StringRef FuncName = I.Name;
+    WriterContext *WC = getPartition(FuncName, Partitions);
     bool Reported = false;
+    std::unique_lock<std::mutex> CtxGuard{WC->Lock};
     WC->Writer.addRecord(std::move(I), Input.Weight, [&](Error E) {
       if (Reported) {
         consumeError(std::move(E));
@@ -271,10 +295,10 @@ static void loadInput(const WeightedFile &Input, SymbolRemapper *Remapper,
   }
   if (Reader->hasError())
     if (Error E = Reader->getError())
-      WC->Errors.emplace_back(std::move(E), Filename);
+      AddError(std::move(E));
 }
 
-/// Merge the \p Src writer context into \p Dst.
+/// Merge the records of \p Src into \p Dst.
 static void mergeWriterContexts(WriterContext *Dst, WriterContext *Src) {
   for (auto &ErrorPair : Src->Errors)
     Dst->Errors.push_back(std::move(ErrorPair));
@@ -315,37 +339,32 @@ static void mergeInstrProfile(const WeightedFileVector &Inputs,
     Contexts.emplace_back(std::make_unique<WriterContext>(
         OutputSparse, ErrorLock, WriterErrorCodes));
 
+  SmallVector<WriterContext *, 4> Partitions;
+  for (std::unique_ptr<WriterContext> &WC : Contexts)
+    Partitions.push_back(WC.get());
+
   if (NumThreads == 1) {
     for (const auto &Input : Inputs)
-      loadInput(Input, Remapper, Contexts[0].get());
+      loadInput(Input, Remapper, Partitions, Contexts[0].get());
   } else {
     ThreadPool Pool(NumThreads);
 
-    // Load the inputs in parallel (N/NumThreads serial steps).
+    // Load the inputs in parallel (N/NumThreads serial steps). Each context
+    // merges its own partition of the functions, of all the inputs, so the
+    // merged profile is only held once in memory, whatever the number of
+    // threads.
     unsigned Ctx = 0;
     for (const auto &Input : Inputs) {
-      Pool.async(loadInput, Input, Remapper, Contexts[Ctx].get());
+      Pool.async(loadInput, Input, Remapper, makeArrayRef(Partitions),
+                 Contexts[Ctx].get());
       Ctx = (Ctx + 1) % NumThreads;
     }
     Pool.wait();
 
-    // Merge the writer contexts together (~ lg(NumThreads) serial steps).
-    unsigned Mid = Contexts.size() / 2;
-    unsigned End = Contexts.size();
-    assert(Mid > 0 && "Expected more than one context");
-    do {
-      for (unsigned I = 0; I < Mid; ++I)
-        Pool.async(mergeWriterContexts, Contexts[I].get(),
-                   Contexts[I + Mid].get());
-      Pool.wait();
-      if (End & 1) {
-        Pool.async(mergeWriterContexts, Contexts[0].get(),
-                   Contexts[End - 1].get());
-        Pool.wait();
-      }
-      End = Mid;
-      Mid /= 2;
-    } while (Mid > 0);
+    // The partitions have distinct functions, so gathering them in the first
+    // context only moves the records, without merging any counts.
+    for (unsigned I = 1; I < NumThreads; ++I)
+      mergeWriterContexts(Contexts[0].get(), Contexts[I].get());
   }
 
   // Handle deferred errors encountered during merging. If the number of errors
@@ -443,7 +462,8 @@ static void handleExtBinaryWriter(sampleprof::SampleProfileWriter &Writer,
                                   ProfileFormat OutputFormat,
                                   MemoryBuffer *Buffer,
                                   sampleprof::ProfileSymbolList &WriterList,
-                                  bool CompressAllSections) {
+                                  bool CompressAllSections, bool UseMD5,
+                                  bool ProfileIsCS) {
   populateProfileSymbolList(Buffer, WriterList);
   if (WriterList.size() > 0 && OutputFormat != PF_Ext_Binary)
     warn("Profile Symbol list is not empty but the output format is not "
@@ -460,6 +480,19 @@ static void handleExtBinaryWriter(sampleprof::SampleProfileWriter &Writer,
       ExtBinaryWriter->setToCompressAllSections();
     }
   }
+
+  if (UseMD5) {
+    if (OutputFormat != PF_Ext_Binary) {
+      warn("-use-md5 is ignored. Specify -extbinary to enable it");
+    } else if (ProfileIsCS) {
+      // The calling contexts are encoded in the names, they would be lost.
+      warn("-use-md5 is ignored for context-sensitive profiles");
+    } else {
+      auto ExtBinaryWriter =
+          static_cast<sampleprof::SampleProfileWriterExtBinary *>(&Writer);
+      ExtBinaryWriter->setUseMD5();
+    }
+  }
 }
 
 static void mergeSampleProfile(const WeightedFileVector &Inputs,
@@ -467,12 +500,14 @@ static void mergeSampleProfile(const WeightedFileVector &Inputs,
                                StringRef OutputFilename,
                                ProfileFormat OutputFormat,
                                StringRef ProfileSymbolListFile,
-                               bool CompressAllSections, FailureMode FailMode) {
+                               bool CompressAllSections, bool UseMD5,
+                               FailureMode FailMode) {
   using namespace sampleprof;
   StringMap<FunctionSamples> ProfileMap;
   SmallVector<std::unique_ptr<sampleprof::SampleProfileReader>, 5> Readers;
   LLVMContext Context;
   sampleprof::ProfileSymbolList WriterList;
+  bool ProfileIsCS = false;
   for (const auto &Input : Inputs) {
     auto ReaderOrErr = SampleProfileReader::create(Input.Filename, Context);
     if (std::error_code EC = ReaderOrErr.getError()) {
@@ -491,6 +526,7 @@ static void mergeSampleProfile(const WeightedFileVector &Inputs,
       Readers.pop_back();
       continue;
     }
+    ProfileIsCS |= FunctionSamples::ProfileIsCS;
 
     StringMap<FunctionSamples> &Profiles = Reader->getProfiles();
     for (StringMap<FunctionSamples>::iterator I = Profiles.begin(),
@@ -501,7 +537,7 @@ static void mergeSampleProfile(const WeightedFileVector &Inputs,
           Remapper ? remapSamples(I->second, *Remapper, Result)
                    : FunctionSamples();
       FunctionSamples &Samples = Remapper ? Remapped : I->second;
-      StringRef FName = Samples.getName();
+      StringRef FName = Samples.getNameWithContext();
       MergeResult(Result, ProfileMap[FName].merge(Samples, Input.Weight));
       if (Result != sampleprof_error::success) {
         std::error_code EC = make_error_code(Result);
@@ -524,7 +560,7 @@ static void mergeSampleProfile(const WeightedFileVector &Inputs,
   // Make sure Buffer lives as long as WriterList.
   auto Buffer = getInputFileBuf(ProfileSymbolListFile);
   handleExtBinaryWriter(*Writer, OutputFormat, Buffer.get(), WriterList,
-                        CompressAllSections);
+                        CompressAllSections, UseMD5, ProfileIsCS);
   Writer->write(ProfileMap);
 }
 
@@ -652,6 +688,10 @@ static int merge_main(int argc, const char *argv[]) {
       "compress-all-sections", cl::init(false), cl::Hidden,
       cl::desc("Compress all sections when writing the profile (only "
                "meaningful for -extbinary)"));
+  cl::opt<bool> UseMD5(
+      "use-md5", cl::init(false), cl::Hidden,
+      cl::desc("Choose to use MD5 to represent string in name table (only "
+               "meaningful for -extbinary)"));
 
   cl::ParseCommandLineOptions(argc, argv, "LLVM profile data merger\n");
 
@@ -686,7 +726,7 @@ static int merge_main(int argc, const char *argv[]) {
   else
     mergeSampleProfile(WeightedInputs, Remapper.get(), OutputFilename,
                        OutputFormat, ProfileSymbolListFile, CompressAllSections,
-                       FailureMode);
+                       UseMD5, FailureMode);
 
   return 0;
 }
@@ -712,7 +752,8 @@ static void overlapInstrProfile(const std::string &BaseFilename,
     OS << "Sum of edge counts for profile " << TestFilename << " is 0.\n";
     exit(0);
   }
-  loadInput(WeightedInput, nullptr, &Context);
+  WriterContext *Partition = &Context;
+  loadInput(WeightedInput, nullptr, Partition, &Context);
   overlapInput(BaseFilename, TestFilename, &Context, Overlap, FuncFilter, OS,
                IsCS);
   Overlap.dump(OS);
@@ -1135,6 +1176,241 @@ static int show_main(int argc, const char *argv[]) {
                              ShowSectionInfoOnly, OS);
 }
 
+namespace {
+/// The call graph of the profiled functions, with the hotness of each
+/// function and the number of calls along each edge.
+struct ProfileCallGraph {
+  BumpPtrAllocator Alloc;
+  UniqueStringSaver Saver{Alloc};
+  MapVector<StringRef, uint64_t> FuncWeights;
+  MapVector<std::pair<StringRef, StringRef>, uint64_t> Edges;
+
+  void addFunction(StringRef Name, uint64_t Weight) {
+    FuncWeights[Saver.save(Name)] += Weight;
+  }
+
+  void addEdge(StringRef Caller, StringRef Callee, uint64_t Count) {
+    if (!Count || Caller == Callee)
+      return;
+    Caller = Saver.save(Caller);
+    Callee = Saver.save(Callee);
+    // Make sure the callee is ordered even if it has no profile of its own.
+    FuncWeights.insert({Callee, 0});
+    Edges[{Caller, Callee}] += Count;
+  }
+};
+} // namespace
+
+/// Return the name of the symbol of the function \p PGOName, without the
+/// file name prefix the local functions get in the instrumentation profiles.
+static StringRef getSymbolName(StringRef PGOName) {
+  size_t Pos = PGOName.rfind(':');
+  return Pos == StringRef::npos ? PGOName : PGOName.drop_front(Pos + 1);
+}
+
+static void buildInstrCallGraph(const std::string &Filename,
+                                ProfileCallGraph &CG) {
+  auto ReaderOrErr = InstrProfReader::create(Filename);
+  if (Error E = ReaderOrErr.takeError())
+    exitWithError(std::move(E), Filename);
+  auto Reader = std::move(ReaderOrErr.get());
+  InstrProfSymtab &Symtab = Reader->getSymtab();
+
+  for (const auto &Func : *Reader) {
+    // The context-sensitive records duplicate the counts of the others.
+    if (Reader->isIRLevelProfile() &&
+        NamedInstrProfRecord::hasCSFlagInHash(Func.Hash))
+      continue;
+    StringRef Caller = getSymbolName(Func.Name);
+    uint64_t FuncMax = 0;
+    for (uint64_t Count : Func.Counts)
+      FuncMax = std::max(FuncMax, Count);
+    CG.addFunction(Caller, FuncMax);
+
+    // The direct calls are not profiled, only the indirect ones give edges.
+    for (uint32_t I = 0, E = Func.getNumValueSites(IPVK_IndirectCallTarget);
+         I < E; ++I) {
+      uint32_t NV = Func.getNumValueDataForSite(IPVK_IndirectCallTarget, I);
+      std::unique_ptr<InstrProfValueData[]> VD =
+          Func.getValueForSite(IPVK_IndirectCallTarget, I);
+      for (uint32_t V = 0; V < NV; ++V) {
+        StringRef Callee = Symtab.getFuncName(VD[V].Value);
+        if (!Callee.empty())
+          CG.addEdge(Caller, getSymbolName(Callee), VD[V].Count);
+      }
+    }
+  }
+  if (Reader->hasError())
+    exitWithError(Reader->getError(), Filename);
+}
+
+/// Add the calls made by \p FS, and by the functions inlined into it, as
+/// calls from \p Caller: they are all made from the code of \p Caller.
+static void addSampleCallEdges(StringRef Caller,
+                               const sampleprof::FunctionSamples &FS,
+                               ProfileCallGraph &CG) {
+  for (const auto &BodySample : FS.getBodySamples())
+    for (const auto &Target : BodySample.second.getCallTargets())
+      CG.addEdge(Caller, Target.first(), Target.second);
+  for (const auto &CallsiteSamples : FS.getCallsiteSamples())
+    for (const auto &Callee : CallsiteSamples.second)
+      addSampleCallEdges(Caller, Callee.second, CG);
+}
+
+static void buildSampleCallGraph(const std::string &Filename,
+                                 ProfileCallGraph &CG) {
+  using namespace sampleprof;
+  LLVMContext Context;
+  auto ReaderOrErr = SampleProfileReader::create(Filename, Context);
+  if (std::error_code EC = ReaderOrErr.getError())
+    exitWithErrorCode(EC, Filename);
+  auto Reader = std::move(ReaderOrErr.get());
+  if (Reader->useMD5())
+    exitWithError("the function names are not available in a profile using "
+                  "MD5 names",
+                  Filename);
+  if (std::error_code EC = Reader->read())
+    exitWithErrorCode(EC, Filename);
+
+  for (const auto &I : Reader->getProfiles()) {
+    const FunctionSamples &FS = I.second;
+    // The context-sensitive profiles are accounted to their leaf function.
+    CG.addFunction(FS.getName(), FS.getTotalSamples());
+    addSampleCallEdges(FS.getName(), FS, CG);
+  }
+}
+
+/// Order the functions of \p CG so that the hottest functions come first,
+/// each placed right after its hottest caller.
+///
+/// This is the clustering of C3 (Ottoni and Maher, CGO 2017), also done by
+/// lld for --call-graph-ordering-file: the functions are visited from the
+/// hottest one, and the cluster of each function is appended to the cluster
+/// of its hottest caller. The clusters are then sorted by decreasing
+/// hotness. The section sizes are only known to the linker, so every
+/// function counts for one here and the clusters are not bounded; give the
+/// call graph to lld to also pack the clusters by size.
+static std::vector<StringRef> orderFunctions(const ProfileCallGraph &CG) {
+  size_t NumFuncs = CG.FuncWeights.size();
+  DenseMap<StringRef, size_t> FuncIndex;
+  for (size_t I = 0; I < NumFuncs; ++I)
+    FuncIndex[CG.FuncWeights.begin()[I].first] = I;
+
+  // Find the hottest caller of each function.
+  std::vector<size_t> HottestCaller(NumFuncs, NumFuncs);
+  std::vector<uint64_t> HottestCallerCount(NumFuncs, 0);
+  for (const auto &Edge : CG.Edges) {
+    size_t Caller = FuncIndex.lookup(Edge.first.first);
+    size_t Callee = FuncIndex.lookup(Edge.first.second);
+    if (Edge.second > HottestCallerCount[Callee]) {
+      HottestCaller[Callee] = Caller;
+      HottestCallerCount[Callee] = Edge.second;
+    }
+  }
+
+  std::vector<size_t> Sorted(NumFuncs);
+  for (size_t I = 0; I < NumFuncs; ++I)
+    Sorted[I] = I;
+  std::stable_sort(Sorted.begin(), Sorted.end(), [&](size_t A, size_t B) {
+    return CG.FuncWeights.begin()[A].second > CG.FuncWeights.begin()[B].second;
+  });
+
+  // Each function starts in its own cluster.
+  std::vector<size_t> Leader(NumFuncs);
+  std::vector<std::vector<size_t>> Clusters(NumFuncs);
+  std::vector<uint64_t> ClusterWeights(NumFuncs);
+  for (size_t I = 0; I < NumFuncs; ++I) {
+    Leader[I] = I;
+    Clusters[I].push_back(I);
+    ClusterWeights[I] = CG.FuncWeights.begin()[I].second;
+  }
+
+  for (size_t Func : Sorted) {
+    size_t Caller = HottestCaller[Func];
+    if (Caller == NumFuncs)
+      continue;
+    size_t From = Leader[Func], To = Leader[Caller];
+    if (From == To)
+      continue;
+    for (size_t F : Clusters[From]) {
+      Leader[F] = To;
+      Clusters[To].push_back(F);
+    }
+    Clusters[From].clear();
+    ClusterWeights[To] += ClusterWeights[From];
+  }
+
+  std::vector<size_t> SortedClusters;
+  for (size_t I = 0; I < NumFuncs; ++I)
+    if (!Clusters[I].empty())
+      SortedClusters.push_back(I);
+  std::stable_sort(SortedClusters.begin(), SortedClusters.end(),
+                   [&](size_t A, size_t B) {
+                     return double(ClusterWeights[A]) / Clusters[A].size() >
+                            double(ClusterWeights[B]) / Clusters[B].size();
+                   });
+
+  std::vector<StringRef> Order;
+  for (size_t C : SortedClusters)
+    for (size_t F : Clusters[C])
+      Order.push_back(CG.FuncWeights.begin()[F].first);
+  return Order;
+}
+
+static int order_main(int argc, const char *argv[]) {
+  cl::list<std::string> InputFilenames(cl::Positional, cl::OneOrMore,
+                                       cl::desc("<profile files>"));
+  cl::opt<std::string> OutputFilename("output", cl::value_desc("output"),
+                                      cl::init("-"),
+                                      cl::desc("Output symbol ordering file"));
+  cl::alias OutputFilenameA("o", cl::desc("Alias for --output"),
+                            cl::aliasopt(OutputFilename));
+  cl::opt<std::string> CallGraphFilename(
+      "call-graph", cl::value_desc("file"), cl::init(""),
+      cl::desc("Output the call graph of the profile as a "
+               "--call-graph-ordering-file for lld"));
+  cl::opt<ProfileKinds> ProfileKind(
+      cl::desc("Profile kind:"), cl::init(instr),
+      cl::values(clEnumVal(instr, "Instrumentation profile (default)"),
+                 clEnumVal(sample, "Sample profile")));
+  cl::opt<bool> OnlyHot(
+      "only-hot", cl::init(false),
+      cl::desc("Leave the functions with no samples or counts out of the "
+               "symbol ordering file"));
+
+  cl::ParseCommandLineOptions(argc, argv,
+                              "LLVM profile guided function ordering\n");
+
+  ProfileCallGraph CG;
+  for (const std::string &Filename : InputFilenames) {
+    if (ProfileKind == instr)
+      buildInstrCallGraph(Filename, CG);
+    else
+      buildSampleCallGraph(Filename, CG);
+  }
+
+  if (!CallGraphFilename.empty()) {
+    std::error_code EC;
+    raw_fd_ostream OS(CallGraphFilename, EC, sys::fs::OF_Text);
+    if (EC)
+      exitWithErrorCode(EC, CallGraphFilename);
+    for (const auto &Edge : CG.Edges)
+      OS << Edge.first.first << " " << Edge.first.second << " " << Edge.second
+         << "\n";
+  }
+
+  std::error_code EC;
+  raw_fd_ostream OS(OutputFilename, EC, sys::fs::OF_Text);
+  if (EC)
+    exitWithErrorCode(EC, OutputFilename);
+  for (StringRef Name : orderFunctions(CG)) {
+    if (OnlyHot && !CG.FuncWeights.lookup(Name))
+      continue;
+    OS << Name << "\n";
+  }
+  return 0;
+}
+
 int main(int argc, const char *argv[]) {
   InitLLVM X(argc, argv);
 
@@ -1148,6 +1424,8 @@ int main(int argc, const char *argv[]) {
       func = show_main;
     else if (strcmp(argv[1], "overlap") == 0)
       func = overlap_main;
+    else if (strcmp(argv[1], "order") == 0)
+      func = order_main;
 
     if (func) {
       std::string Invocation(ProgName.str() + " " + argv[1]);
@@ -1162,7 +1440,7 @@ int main(int argc, const char *argv[]) {
              << "USAGE: " << ProgName << " <command> [args...]\n"
              << "USAGE: " << ProgName << " <command> -help\n\n"
              << "See each individual command --help for more details.\n"
-             << "Available commands: merge, show, overlap\n";
+             << "Available commands: merge, show, overlap, order\n";
       return 0;
     }
   }
@@ -1172,6 +1450,6 @@ int main(int argc, const char *argv[]) {
   else
     errs() << ProgName << ": Unknown command!\n";
 
-  errs() << "USAGE: " << ProgName << " <merge|show|overlap> [args...]\n";
+  errs() << "USAGE: " << ProgName << " <merge|show|overlap|order> [args...]\n";
   return 1;
 }
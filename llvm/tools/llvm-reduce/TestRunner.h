@@ -30,6 +30,14 @@ public:
   /// @returns 0 if test was successful, 1 if otherwise
   int run(StringRef Filename);
 
+  /// Starts the interesting-ness test for the specified file without waiting
+  /// for it to finish
+  sys::ProcessInfo start(StringRef Filename);
+
+  /// Waits for a test started with start() to finish
+  /// @returns the same as run() for the file the test was started on
+  int wait(const sys::ProcessInfo &PI);
+
   /// Returns the most reduced version of the original testcase
   Module *getProgram() const { return Program.get(); }
 
@@ -14,47 +14,104 @@
 
 #include "Delta.h"
 #include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Bitcode/BitcodeWriter.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/MD5.h"
 #include "llvm/Support/ToolOutputFile.h"
 #include "llvm/Transforms/Utils/Cloning.h"
-#include <fstream>
 #include <set>
 
 using namespace llvm;
 
-bool IsReduced(Module &M, TestRunner &Test, SmallString<128> &CurrentFilepath) {
+static cl::opt<unsigned> NumJobs(
+    "j",
+    cl::desc("Maximum number of interesting-ness tests to run in parallel"),
+    cl::init(1));
+
+static cl::opt<bool> TmpFilesAsBitcode(
+    "write-tmp-files-as-bitcode",
+    cl::desc("Write temporary files as bitcode, instead of textual IR"),
+    cl::init(false));
+
+namespace {
+/// A variant of the program that is given to the interesting-ness test.
+struct Variant {
+  /// The index of the chunk that was left out of this variant.
+  int ChunkIndex = -1;
+  std::unique_ptr<Module> Program;
+
+  /// The serialized program and its hash.
+  SmallString<0> Buffer;
+  SmallString<32> Hash;
+
+  /// The temporary file read by the test, if the test had to be run. It is
+  /// removed once the variant goes away.
+  std::unique_ptr<ToolOutputFile> File;
+  sys::ProcessInfo Process;
+
+  bool Interesting = false;
+};
+} // namespace
+
+/// The interesting-ness of all variants tested so far, keyed by the hash of
+/// their serialization. The same variant can come up more than once, e.g. if
+/// leaving out a chunk does not change the program.
+static StringMap<bool> TestedVariants;
+
+/// Serializes \p M into \p V and starts the interesting-ness test on it,
+/// unless the same variant has been tested before.
+static void startTest(Module &M, Variant &V, TestRunner &Test) {
+  raw_svector_ostream OS(V.Buffer);
+  if (TmpFilesAsBitcode)
+    WriteBitcodeToFile(M, OS);
+  else
+    M.print(OS, /*AnnotationWriter=*/nullptr);
+
+  MD5 Hasher;
+  MD5::MD5Result Result;
+  Hasher.update(V.Buffer);
+  Hasher.final(Result);
+  V.Hash = Result.digest();
+
+  auto Tested = TestedVariants.find(V.Hash);
+  if (Tested != TestedVariants.end()) {
+    V.Interesting = Tested->second;
+    return;
+  }
+
   // Write Module to tmp file
   int FD;
-  std::error_code EC =
-      sys::fs::createTemporaryFile("llvm-reduce", "ll", FD, CurrentFilepath);
+  SmallString<128> Filepath;
+  std::error_code EC = sys::fs::createTemporaryFile(
+      "llvm-reduce", TmpFilesAsBitcode ? "bc" : "ll", FD, Filepath);
   if (EC) {
     errs() << "Error making unique filename: " << EC.message() << "!\n";
     exit(1);
   }
 
-  ToolOutputFile Out(CurrentFilepath, FD);
-  M.print(Out.os(), /*AnnotationWriter=*/nullptr);
-  Out.os().close();
-  if (Out.os().has_error()) {
-    errs() << "Error emitting bitcode to file '" << CurrentFilepath << "'!\n";
+  V.File = std::make_unique<ToolOutputFile>(Filepath, FD);
+  V.File->os() << V.Buffer;
+  V.File->os().close();
+  if (V.File->os().has_error()) {
+    errs() << "Error emitting bitcode to file '" << Filepath << "'!\n";
     exit(1);
   }
 
-  // Current Chunks aren't interesting
-  return Test.run(CurrentFilepath);
+  V.Process = Test.start(Filepath);
 }
 
-/// Counts the amount of lines for a given file
-static int getLines(StringRef Filepath) {
-  int Lines = 0;
-  std::string CurrLine;
-  std::ifstream FileStream(Filepath);
-
-  while (std::getline(FileStream, CurrLine))
-    ++Lines;
-
-  return Lines;
+/// Waits for the test started by startTest() and records its result.
+static void finishTest(Variant &V, TestRunner &Test) {
+  if (!V.File)
+    return;
+  V.Interesting = Test.wait(V.Process);
+  TestedVariants[V.Hash] = V.Interesting;
 }
 
+/// Counts the amount of lines of a serialized program.
+static int getLines(StringRef Buffer) { return Buffer.count('\n'); }
+
 /// Splits Chunks in half and prints them.
 /// If unable to split (when chunk size is 1) returns false.
 static bool increaseGranularity(std::vector<Chunk> &Chunks) {
@@ -98,8 +155,10 @@ void llvm::runDeltaPass(
   }
 
   if (Module *Program = Test.getProgram()) {
-    SmallString<128> CurrentFilepath;
-    if (!IsReduced(*Program, Test, CurrentFilepath)) {
+    Variant V;
+    startTest(*Program, V, Test);
+    finishTest(V, Test);
+    if (!V.Interesting) {
       errs() << "\nInput isn't interesting! Verify interesting-ness test\n";
       exit(1);
     }
@@ -114,39 +173,57 @@ void llvm::runDeltaPass(
     return;
   }
 
+  unsigned MaxBatchSize = std::max(1u, unsigned(NumJobs));
   do {
     UninterestingChunks = {};
-    for (int I = Chunks.size() - 1; I >= 0; --I) {
-      std::vector<Chunk> CurrentChunks;
-
-      for (auto C : Chunks)
-        if (!UninterestingChunks.count(C) && C != Chunks[I])
-          CurrentChunks.push_back(C);
-
-      if (CurrentChunks.empty())
-        continue;
-
-      // Clone module before hacking it up..
-      std::unique_ptr<Module> Clone = CloneModule(*Test.getProgram());
-      // Generate Module with only Targets inside Current Chunks
-      ExtractChunksFromModule(CurrentChunks, Clone.get());
-
-      errs() << "Ignoring: ";
-      Chunks[I].print();
-      for (auto C : UninterestingChunks)
-        C.print();
-
-
-
-      SmallString<128> CurrentFilepath;
-      if (!IsReduced(*Clone, Test, CurrentFilepath)) {
-        errs() << "\n";
-        continue;
+    int I = Chunks.size() - 1;
+    while (I >= 0) {
+      // Test the next chunks in parallel, each one assuming that none of the
+      // others in the batch can be left out. The first interesting variant
+      // wins, and the chunks after it are tested again on top of it, so the
+      // result is the same as testing the chunks one at a time.
+      std::vector<Variant> Batch;
+      for (; I >= 0 && Batch.size() < MaxBatchSize; --I) {
+        std::vector<Chunk> CurrentChunks;
+
+        for (auto C : Chunks)
+          if (!UninterestingChunks.count(C) && C != Chunks[I])
+            CurrentChunks.push_back(C);
+
+        if (CurrentChunks.empty())
+          continue;
+
+        Batch.emplace_back();
+        Variant &V = Batch.back();
+        V.ChunkIndex = I;
+        // Clone module before hacking it up..
+        V.Program = CloneModule(*Test.getProgram());
+        // Generate Module with only Targets inside Current Chunks
+        ExtractChunksFromModule(CurrentChunks, V.Program.get());
       }
 
-      UninterestingChunks.insert(Chunks[I]);
-      ReducedProgram = std::move(Clone);
-      errs() << " **** SUCCESS | lines: " << getLines(CurrentFilepath) << "\n";
+      for (Variant &V : Batch)
+        startTest(*V.Program, V, Test);
+      for (Variant &V : Batch)
+        finishTest(V, Test);
+
+      for (Variant &V : Batch) {
+        errs() << "Ignoring: ";
+        Chunks[V.ChunkIndex].print();
+        for (auto C : UninterestingChunks)
+          C.print();
+
+        if (!V.Interesting) {
+          errs() << "\n";
+          continue;
+        }
+
+        UninterestingChunks.insert(Chunks[V.ChunkIndex]);
+        ReducedProgram = std::move(V.Program);
+        errs() << " **** SUCCESS | lines: " << getLines(V.Buffer) << "\n";
+        I = V.ChunkIndex - 1;
+        break;
+      }
     }
     // Delete uninteresting chunks
     erase_if(Chunks, [&UninterestingChunks](const Chunk &C) {
@@ -39,6 +39,11 @@ static cl::opt<bool>
     PreserveLocals("preserve-locals", cl::Prefix, cl::init(false),
                    cl::desc("Split without externalizing locals"));
 
+static cl::opt<bool>
+    SplitByCallGraph("split-by-call-graph", cl::init(false),
+                     cl::desc("Keep callers and callees together and balance "
+                              "the outputs by instruction count"));
+
 int main(int argc, char **argv) {
   LLVMContext Context;
   SMDiagnostic Err;
@@ -66,7 +71,7 @@ int main(int argc, char **argv) {
 
     // Declare success.
     Out->keep();
-  }, PreserveLocals);
+  }, PreserveLocals, SplitByCallGraph);
 
   return 0;
 }
@@ -23,10 +23,16 @@
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/InitLLVM.h"
 #include "llvm/Support/Path.h"
+#include "llvm/Support/ThreadPool.h"
+#include "llvm/Support/Threading.h"
 #include "llvm/Support/raw_ostream.h"
+#include <condition_variable>
 #include <cstdio>
 #include <cstring>
+#include <deque>
+#include <mutex>
 #include <string>
+#include <thread>
 
 using namespace llvm;
 using namespace symbolize;
@@ -158,6 +164,22 @@ static cl::opt<DIPrinter::OutputStyle>
                              clEnumValN(DIPrinter::OutputStyle::GNU, "GNU",
                                         "GNU addr2line style")));
 
+static cl::opt<bool>
+    ClUseGSYM("use-gsym", cl::init(false),
+              cl::desc("Convert the debug info to GSYM and symbolize using "
+                       "that"));
+
+static cl::opt<std::string>
+    ClGsymCacheDir("gsym-cache-dir", cl::init(""),
+                   cl::desc("Directory to cache the GSYM files of "
+                            "--use-gsym in"));
+
+static cl::opt<unsigned>
+    ClThreads("threads", cl::init(1),
+              cl::desc("Number of threads answering the queries read from "
+                       "stdin. Best combined with --use-gsym, as queries "
+                       "answered from DWARF are serialized"));
+
 static cl::extrahelp
     HelpResponse("\nPass @FILE as argument to read options from FILE.\n");
 
@@ -170,6 +192,8 @@ static bool error(Expected<T> &ResOrErr) {
   return true;
 }
 
+static const int kMaxInputStringLength = 1024;
+
 enum class Command {
   Code,
   Data,
@@ -217,20 +241,23 @@ static bool parseCommand(StringRef InputString, Command &Cmd,
 }
 
 static void symbolizeInput(StringRef InputString, LLVMSymbolizer &Symbolizer,
-                           DIPrinter &Printer) {
+                           raw_ostream &OS) {
   Command Cmd;
   std::string ModuleName;
   uint64_t Offset = 0;
   if (!parseCommand(StringRef(InputString), Cmd, ModuleName, Offset)) {
-    outs() << InputString;
+    OS << InputString;
     return;
   }
 
+  DIPrinter Printer(OS, ClPrintFunctions != FunctionNameKind::None,
+                    ClPrettyPrint, ClPrintSourceContextLines, ClVerbose,
+                    ClBasenames, ClOutputStyle);
   if (ClPrintAddress) {
-    outs() << "0x";
-    outs().write_hex(Offset);
+    OS << "0x";
+    OS.write_hex(Offset);
     StringRef Delimiter = ClPrettyPrint ? ": " : "\n";
-    outs() << Delimiter;
+    OS << Delimiter;
   }
   Offset -= ClAdjustVMA;
   if (Cmd == Command::Data) {
@@ -244,7 +271,7 @@ static void symbolizeInput(StringRef InputString, LLVMSymbolizer &Symbolizer,
       for (DILocal Local : *ResOrErr)
         Printer << Local;
       if (ResOrErr->empty())
-        outs() << "??\n";
+        OS << "??\n";
     }
   } else if (ClPrintInlining) {
     auto ResOrErr = Symbolizer.symbolizeInlinedCode(
@@ -266,7 +293,65 @@ static void symbolizeInput(StringRef InputString, LLVMSymbolizer &Symbolizer,
     Printer << (error(ResOrErr) ? DILineInfo() : ResOrErr.get());
   }
   if (ClOutputStyle == DIPrinter::OutputStyle::LLVM)
-    outs() << "\n";
+    OS << "\n";
+}
+
+/// Answers the queries read from stdin on \p NumThreads threads. The answers
+/// are written in input order, each as soon as it and all earlier ones are
+/// ready, so clients that wait for every answer before sending the next query
+/// keep working.
+static void symbolizeStdinConcurrently(LLVMSymbolizer &Symbolizer,
+                                       unsigned NumThreads) {
+  struct Query {
+    std::string Input;
+    std::string Output;
+    std::shared_future<void> Done;
+  };
+  std::deque<std::unique_ptr<Query>> Pending;
+  std::mutex PendingMutex;
+  std::condition_variable PendingCV;
+  bool InputDone = false;
+
+  std::thread Writer([&]() {
+    while (true) {
+      std::unique_ptr<Query> Q;
+      {
+        std::unique_lock<std::mutex> Lock(PendingMutex);
+        PendingCV.wait(Lock, [&]() { return !Pending.empty() || InputDone; });
+        if (Pending.empty())
+          return;
+        Q = std::move(Pending.front());
+        Pending.pop_front();
+      }
+      Q->Done.wait();
+      outs() << Q->Output;
+      outs().flush();
+    }
+  });
+
+  ThreadPool Pool(NumThreads);
+  char InputString[kMaxInputStringLength];
+  while (fgets(InputString, sizeof(InputString), stdin)) {
+    auto Q = std::make_unique<Query>();
+    Q->Input = InputString;
+    Query *QPtr = Q.get();
+    Q->Done = Pool.async([QPtr, &Symbolizer]() {
+      raw_string_ostream OS(QPtr->Output);
+      symbolizeInput(QPtr->Input, Symbolizer, OS);
+    });
+    {
+      std::lock_guard<std::mutex> Lock(PendingMutex);
+      Pending.push_back(std::move(Q));
+    }
+    PendingCV.notify_one();
+  }
+
+  {
+    std::lock_guard<std::mutex> Lock(PendingMutex);
+    InputDone = true;
+  }
+  PendingCV.notify_one();
+  Writer.join();
 }
 
 int main(int argc, char **argv) {
@@ -299,6 +384,8 @@ int main(int argc, char **argv) {
   Opts.DefaultArch = ClDefaultArch;
   Opts.FallbackDebugPath = ClFallbackDebugPath;
   Opts.DWPName = ClDwpName;
+  Opts.UseGSYM = ClUseGSYM;
+  Opts.GsymCacheDir = ClGsymCacheDir;
 
   for (const auto &hint : ClDsymHint) {
     if (sys::path::extension(hint) == ".dSYM") {
@@ -310,21 +397,21 @@ int main(int argc, char **argv) {
   }
   LLVMSymbolizer Symbolizer(Opts);
 
-  DIPrinter Printer(outs(), ClPrintFunctions != FunctionNameKind::None,
-                    ClPrettyPrint, ClPrintSourceContextLines, ClVerbose,
-                    ClBasenames, ClOutputStyle);
-
   if (ClInputAddresses.empty()) {
-    const int kMaxInputStringLength = 1024;
+    if (ClThreads > 1 && llvm_is_multithreaded()) {
+      symbolizeStdinConcurrently(Symbolizer, ClThreads);
+      return 0;
+    }
+
     char InputString[kMaxInputStringLength];
 
     while (fgets(InputString, sizeof(InputString), stdin)) {
-      symbolizeInput(InputString, Symbolizer, Printer);
+      symbolizeInput(InputString, Symbolizer, outs());
       outs().flush();
     }
   } else {
     for (StringRef Address : ClInputAddresses)
-      symbolizeInput(Address, Symbolizer, Printer);
+      symbolizeInput(Address, Symbolizer, outs());
   }
 
   return 0;
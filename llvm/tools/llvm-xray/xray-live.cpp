@@ -0,0 +1,348 @@
+//===- xray-live.cpp: XRay Live Trace Consumer ----------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// Implements the 'live' subcommand, which reads the buffers that a program in
+// FDR mode publishes to a stream file (see the stream_file flag of the XRay
+// runtime) while the program runs, and periodically prints the time spent in
+// each call stack.
+//
+//===----------------------------------------------------------------------===//
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <forward_list>
+#include <thread>
+
+#include "func-id-helper.h"
+#include "trie-node.h"
+#include "xray-registry.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/DataExtractor.h"
+#include "llvm/Support/Endian.h"
+#include "llvm/Support/Errc.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/FormatVariadic.h"
+#include "llvm/XRay/InstrumentationMap.h"
+#include "llvm/XRay/Trace.h"
+
+using namespace llvm;
+using namespace llvm::xray;
+
+static cl::SubCommand Live("live", "Live call stack accounting");
+static cl::opt<std::string> LiveInput(cl::Positional,
+                                      cl::desc("<xray stream file>"),
+                                      cl::Required, cl::sub(Live));
+static cl::opt<std::string>
+    LiveInstrMap("instr_map",
+                 cl::desc("binary with the instrumentation map, or "
+                          "a separate instrumentation map"),
+                 cl::value_desc("binary with xray_instr_map"), cl::sub(Live),
+                 cl::init(""));
+static cl::alias LiveInstrMap2("m", cl::aliasopt(LiveInstrMap),
+                               cl::desc("Alias for -instr_map"),
+                               cl::sub(Live));
+static cl::opt<unsigned>
+    LiveInterval("interval", cl::desc("seconds between two reports"),
+                 cl::sub(Live), cl::init(1));
+static cl::opt<unsigned>
+    LiveReports("reports",
+                cl::desc("number of reports to print before exiting, or 0 to "
+                         "keep going until interrupted"),
+                cl::sub(Live), cl::init(0));
+static cl::opt<unsigned> LiveTop("top",
+                                 cl::desc("number of call stacks to show at "
+                                          "each level of the call tree"),
+                                 cl::sub(Live), cl::init(10));
+static cl::alias LiveTop2("p", cl::desc("Alias for -top"),
+                          cl::aliasopt(LiveTop), cl::sub(Live));
+static cl::opt<unsigned> LiveDepth("depth",
+                                   cl::desc("depth of the call tree to show"),
+                                   cl::sub(Live), cl::init(3));
+
+namespace {
+
+// The layout of the stream file, as defined by the XRay runtime in
+// compiler-rt/lib/xray/xray_fdr_stream.h. Keep the two in sync.
+//
+// The file starts with a StreamHeader, followed by SlotCount slots of
+// SlotStride bytes. Each slot starts with a StreamSlot, followed by one block
+// of an FDR mode log. The N-th published block goes into slot N % SlotCount,
+// and the slot's sequence is 2 * N + 2 once it is complete.
+struct StreamHeader {
+  char Magic[8];
+  uint32_t Version;
+  uint32_t SlotCount;
+  uint64_t SlotStride;
+  std::atomic<uint64_t> Published;
+  char FileHeader[32];
+};
+
+struct StreamSlot {
+  std::atomic<uint64_t> Sequence;
+  uint64_t Size;
+};
+
+static_assert(sizeof(StreamHeader) == 64, "StreamHeader != 64 bytes");
+static_assert(sizeof(StreamSlot) == 16, "StreamSlot != 16 bytes");
+
+constexpr char StreamMagic[8] = {'X', 'R', 'A', 'Y', 'S', 'T', 'R', 'M'};
+constexpr uint32_t StreamVersion = 1;
+
+struct CallStats {
+  uint64_t Count = 0;
+  uint64_t TotalTicks = 0;
+};
+
+using CallNode = TrieNode<CallStats>;
+
+/// Builds a call tree, merged across threads, from the records of a live
+/// trace.
+class LiveCallTrie {
+  std::forward_list<CallNode> NodeStore;
+  SmallVector<CallNode *, 4> Roots;
+  // The calls that are in progress on each thread, with their entry TSC.
+  DenseMap<uint32_t, SmallVector<std::pair<CallNode *, uint64_t>, 8>>
+      ThreadStacks;
+
+  CallNode *getCallee(CallNode *Parent, int32_t FuncId) {
+    auto &Callees = Parent ? Parent->Callees : Roots;
+    auto It = find_if(Callees,
+                      [&](CallNode *Node) { return Node->FuncId == FuncId; });
+    if (It != Callees.end())
+      return *It;
+    NodeStore.push_front(CallNode{FuncId, Parent, {}, {}});
+    Callees.push_back(&NodeStore.front());
+    return Callees.back();
+  }
+
+public:
+  void accountRecord(const XRayRecord &R) {
+    auto &Stack = ThreadStacks[R.TId];
+    switch (R.Type) {
+    case RecordTypes::ENTER:
+    case RecordTypes::ENTER_ARG: {
+      CallNode *Parent = Stack.empty() ? nullptr : Stack.back().first;
+      Stack.emplace_back(getCallee(Parent, R.FuncId), R.TSC);
+      break;
+    }
+    case RecordTypes::EXIT:
+    case RecordTypes::TAIL_EXIT: {
+      // Exits whose entry we have not seen, e.g. because the trace started in
+      // the middle of the call, are ignored. Calls above the exiting one whose
+      // exit we missed end with it.
+      auto It = find_if(reverse(Stack), [&](const auto &Call) {
+        return Call.first->FuncId == R.FuncId;
+      });
+      if (It == Stack.rend())
+        break;
+      size_t Depth = Stack.rend() - It - 1;
+      for (size_t I = Depth; I < Stack.size(); ++I) {
+        CallStats &Stats = Stack[I].first->ExtraData;
+        ++Stats.Count;
+        if (R.TSC > Stack[I].second)
+          Stats.TotalTicks += R.TSC - Stack[I].second;
+      }
+      Stack.resize(Depth);
+      break;
+    }
+    case RecordTypes::CUSTOM_EVENT:
+    case RecordTypes::TYPED_EVENT:
+      break;
+    }
+  }
+
+  /// Forgets the calls in progress, when the stream restarts.
+  void resetThreads() { ThreadStacks.clear(); }
+
+  void print(raw_ostream &OS, FuncIdConversionHelper &FN,
+             double TicksPerMicrosecond) const {
+    OS << formatv("{0,10} {1,14} {2,12}  {3}\n", "calls", "total (ms)",
+                  "avg (us)", "function");
+    printLevel(OS, FN, TicksPerMicrosecond, Roots, 0);
+  }
+
+private:
+  void printLevel(raw_ostream &OS, FuncIdConversionHelper &FN,
+                  double TicksPerMicrosecond, ArrayRef<CallNode *> Nodes,
+                  unsigned Level) const {
+    if (Level >= LiveDepth)
+      return;
+    SmallVector<CallNode *, 16> Sorted(Nodes.begin(), Nodes.end());
+    llvm::sort(Sorted, [](const CallNode *L, const CallNode *R) {
+      return L->ExtraData.TotalTicks > R->ExtraData.TotalTicks;
+    });
+    if (Sorted.size() > LiveTop)
+      Sorted.resize(LiveTop);
+    for (const CallNode *Node : Sorted) {
+      const CallStats &Stats = Node->ExtraData;
+      if (Stats.Count == 0)
+        continue;
+      double TotalUs = Stats.TotalTicks / TicksPerMicrosecond;
+      OS << formatv("{0,10} {1,14:f3} {2,12:f3}  {3}{4}\n", Stats.Count,
+                    TotalUs / 1000, TotalUs / Stats.Count,
+                    std::string(Level * 2, ' '),
+                    FN.SymbolOrNumber(Node->FuncId));
+      printLevel(OS, FN, TicksPerMicrosecond, Node->Callees, Level + 1);
+    }
+  }
+};
+
+/// Reads the blocks that have been published to a stream file since the last
+/// call to poll().
+class StreamReader {
+  std::string Path;
+  std::unique_ptr<sys::fs::mapped_file_region> Region;
+  uint64_t Next = 0;
+
+public:
+  uint64_t BlocksRead = 0;
+  uint64_t BlocksLost = 0;
+  uint64_t BlocksInvalid = 0;
+  uint64_t CycleFrequency = 0;
+
+  explicit StreamReader(std::string Path) : Path(std::move(Path)) {}
+
+  /// Maps the stream file, if it has changed size since it was last mapped.
+  Error map() {
+    uint64_t FileSize;
+    if (auto EC = sys::fs::file_size(Path, FileSize))
+      return createStringError(EC, "Failed to get file size for '%s'.",
+                               Path.c_str());
+    if (Region && Region->size() == FileSize)
+      return Error::success();
+    Region.reset();
+    if (FileSize < sizeof(StreamHeader))
+      return Error::success();
+    auto FDOrErr = sys::fs::openNativeFileForRead(Path);
+    if (!FDOrErr)
+      return FDOrErr.takeError();
+    std::error_code EC;
+    Region = std::make_unique<sys::fs::mapped_file_region>(
+        *FDOrErr, sys::fs::mapped_file_region::mapmode::readonly, FileSize, 0,
+        EC);
+    sys::fs::closeFile(*FDOrErr);
+    if (EC) {
+      Region.reset();
+      return createStringError(EC, "Failed to map '%s'.", Path.c_str());
+    }
+    return Error::success();
+  }
+
+  /// Calls \p Callback with the records of each new block. \p Restarted is
+  /// called when the program has restarted the stream.
+  Error poll(function_ref<void(const Trace &)> Callback,
+             function_ref<void()> Restarted) {
+    if (auto E = map())
+      return E;
+    if (!Region)
+      return Error::success();
+    const char *Base = Region->const_data();
+    const auto *H = reinterpret_cast<const StreamHeader *>(Base);
+    if (std::memcmp(H->Magic, StreamMagic, sizeof(StreamMagic)) != 0)
+      return Error::success();
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (H->Version != StreamVersion)
+      return createStringError(std::make_error_code(std::errc::not_supported),
+                               "Unsupported stream version %u.", H->Version);
+    if (H->SlotCount == 0 || H->SlotStride <= sizeof(StreamSlot) ||
+        sizeof(StreamHeader) + H->SlotCount * H->SlotStride > Region->size())
+      return createStringError(
+          std::make_error_code(std::errc::illegal_byte_sequence),
+          "Invalid stream header in '%s'.", Path.c_str());
+    CycleFrequency = support::endian::read64le(H->FileHeader + 8);
+
+    uint64_t Published = H->Published.load(std::memory_order_acquire);
+    if (Published < Next) {
+      Next = 0;
+      Restarted();
+    }
+    if (Published - Next > H->SlotCount) {
+      BlocksLost += Published - H->SlotCount - Next;
+      Next = Published - H->SlotCount;
+    }
+
+    std::string Block;
+    for (; Next < Published; ++Next) {
+      const auto *Slot = reinterpret_cast<const StreamSlot *>(
+          Base + sizeof(StreamHeader) + (Next % H->SlotCount) * H->SlotStride);
+      uint64_t Sequence = 2 * Next + 2;
+      uint64_t Seen = Slot->Sequence.load(std::memory_order_acquire);
+      // The block is still being written; look at it again on the next poll.
+      if (Seen < Sequence)
+        break;
+      if (Seen > Sequence) {
+        ++BlocksLost;
+        continue;
+      }
+      uint64_t Size =
+          std::min<uint64_t>(Slot->Size, H->SlotStride - sizeof(StreamSlot));
+      Block.assign(H->FileHeader, sizeof(H->FileHeader));
+      Block.append(reinterpret_cast<const char *>(Slot + 1), Size);
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (Slot->Sequence.load(std::memory_order_relaxed) != Sequence) {
+        ++BlocksLost;
+        continue;
+      }
+
+      DataExtractor DE(Block, true, 8);
+      auto TraceOrErr = loadTrace(DE);
+      if (!TraceOrErr) {
+        consumeError(TraceOrErr.takeError());
+        ++BlocksInvalid;
+        continue;
+      }
+      ++BlocksRead;
+      Callback(*TraceOrErr);
+    }
+    return Error::success();
+  }
+};
+
+} // namespace
+
+static CommandRegistration Unused(&Live, []() -> Error {
+  InstrumentationMap Map;
+  if (!LiveInstrMap.empty()) {
+    auto InstrumentationMapOrError = loadInstrumentationMap(LiveInstrMap);
+    if (!InstrumentationMapOrError)
+      return joinErrors(make_error<StringError>(
+                            Twine("Cannot open instrumentation map '") +
+                                LiveInstrMap + "'",
+                            std::make_error_code(std::errc::invalid_argument)),
+                        InstrumentationMapOrError.takeError());
+    Map = std::move(*InstrumentationMapOrError);
+  }
+  symbolize::LLVMSymbolizer Symbolizer;
+  FuncIdConversionHelper FuncIdHelper(LiveInstrMap, Symbolizer,
+                                      Map.getFunctionAddresses());
+
+  LiveCallTrie Calls;
+  StreamReader Reader(LiveInput);
+  for (unsigned Report = 1; LiveReports == 0 || Report <= LiveReports;
+       ++Report) {
+    std::this_thread::sleep_for(std::chrono::seconds(LiveInterval));
+    if (auto E = Reader.poll(
+            [&](const Trace &T) {
+              for (const XRayRecord &R : T)
+                Calls.accountRecord(R);
+            },
+            [&] { Calls.resetThreads(); }))
+      return E;
+
+    outs() << formatv("--- report {0}: {1} blocks read, {2} lost, {3} invalid "
+                      "---\n",
+                      Report, Reader.BlocksRead, Reader.BlocksLost,
+                      Reader.BlocksInvalid);
+    double TicksPerMicrosecond =
+        Reader.CycleFrequency ? Reader.CycleFrequency / 1e6 : 1e3;
+    Calls.print(outs(), FuncIdHelper, TicksPerMicrosecond);
+    outs().flush();
+  }
+  return Error::success();
+});
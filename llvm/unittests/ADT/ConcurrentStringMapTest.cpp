@@ -0,0 +1,106 @@
+//===- ConcurrentStringMapTest.cpp - ConcurrentStringMap unit tests -------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/ADT/ConcurrentStringMap.h"
+#include "llvm/ADT/Twine.h"
+#include "llvm/Support/StringSaver.h"
+#include "llvm/Support/ThreadPool.h"
+#include "gtest/gtest.h"
+#include <atomic>
+#include <vector>
+
+using namespace llvm;
+
+namespace {
+
+TEST(ConcurrentStringMapTest, Basic) {
+  ConcurrentStringMap<unsigned> Map(4);
+  EXPECT_TRUE(Map.empty());
+  EXPECT_EQ(nullptr, Map.find("a"));
+
+  auto R = Map.try_emplace("a", 1u);
+  EXPECT_TRUE(R.second);
+  EXPECT_EQ("a", R.first->getKey());
+  EXPECT_EQ(1u, R.first->getValue());
+
+  // Inserting an existing key returns the existing entry.
+  auto R2 = Map.insert({"a", 2u});
+  EXPECT_FALSE(R2.second);
+  EXPECT_EQ(R.first, R2.first);
+  EXPECT_EQ(1u, R2.first->getValue());
+
+  Map.try_emplace("b", 3u);
+  EXPECT_EQ(2u, Map.size());
+  EXPECT_EQ(1u, Map.count("b"));
+  EXPECT_EQ(R.first, Map.find("a"));
+
+  unsigned Sum = 0;
+  Map.forEach([&](StringMapEntry<unsigned> &E) { Sum += E.getValue(); });
+  EXPECT_EQ(4u, Sum);
+
+  Map.clear();
+  EXPECT_TRUE(Map.empty());
+  EXPECT_EQ(nullptr, Map.find("a"));
+}
+
+TEST(ConcurrentStringMapTest, Intern) {
+  ConcurrentStringMap<char> Map;
+  std::string A = "hello";
+  StringRef Interned = Map.intern(A);
+  EXPECT_EQ("hello", Interned);
+  EXPECT_NE(A.data(), Interned.data());
+  EXPECT_EQ('\0', *Interned.end());
+  EXPECT_EQ(Interned.data(), Map.intern(std::string("hello")).data());
+}
+
+// Threads interning overlapping sets of names all get the same copy of each.
+TEST(ConcurrentStringMapTest, ConcurrentIntern) {
+  ConcurrentStringMap<std::atomic<unsigned>> Map;
+  const unsigned NumTasks = 8, NumNames = 2000;
+  std::vector<std::vector<const char *>> Results(NumTasks);
+  {
+    ThreadPool Pool;
+    for (unsigned T = 0; T != NumTasks; ++T)
+      Pool.async([&, T] {
+        for (unsigned I = 0; I != NumNames; ++I) {
+          auto *E = Map.try_emplace(("name" + Twine(I)).str(), 0u).first;
+          ++E->getValue();
+          Results[T].push_back(E->getKeyData());
+        }
+      });
+  }
+  EXPECT_EQ(NumNames, Map.size());
+  for (unsigned T = 1; T != NumTasks; ++T)
+    EXPECT_EQ(Results[0], Results[T]);
+  Map.forEach([&](StringMapEntry<std::atomic<unsigned>> &E) {
+    EXPECT_EQ(NumTasks, E.getValue().load());
+  });
+}
+
+TEST(ConcurrentStringMapTest, ConcurrentStringSaver) {
+  ConcurrentStringSaver Saver;
+  const unsigned NumTasks = 8, NumNames = 1000;
+  std::vector<std::vector<StringRef>> Results(NumTasks);
+  {
+    ThreadPool Pool;
+    for (unsigned T = 0; T != NumTasks; ++T)
+      Pool.async([&, T] {
+        for (unsigned I = 0; I != NumNames; ++I)
+          Results[T].push_back(Saver.save(Twine(T) + "." + Twine(I)));
+      });
+  }
+  for (unsigned T = 0; T != NumTasks; ++T) {
+    for (unsigned I = 0; I != NumNames; ++I) {
+      EXPECT_EQ((Twine(T) + "." + Twine(I)).str(), Results[T][I]);
+      EXPECT_EQ('\0', *Results[T][I].end());
+    }
+  }
+  EXPECT_LT(0u, Saver.getTotalMemory());
+}
+
+} // end anonymous namespace
@@ -95,6 +95,58 @@ TEST(FoldingSetTest, MissedIDComparison) {
   EXPECT_NE(nullptr, InsertPos);
 }
 
+// The hasher computes the same hash as a FoldingSetNodeID with the same data.
+TEST(FoldingSetTest, HasherMatchesID) {
+  int X;
+  for (unsigned Len = 0; Len != 9; ++Len) {
+    std::string Str = ">" + std::string("abcdefgh").substr(0, Len);
+    FoldingSetNodeID ID;
+    FoldingSetNodeIDHasher Hash;
+    ID.AddInteger(42U);
+    Hash.AddInteger(42U);
+    ID.AddInteger(-1LL);
+    Hash.AddInteger(-1LL);
+    ID.AddPointer(&X);
+    Hash.AddPointer(&X);
+    ID.AddBoolean(true);
+    Hash.AddBoolean(true);
+    // Unaligned strings of each length.
+    ID.AddString(StringRef(Str).drop_front());
+    Hash.AddString(StringRef(Str).drop_front());
+    EXPECT_EQ(ID.ComputeHash(), Hash.ComputeHash()) << "length " << Len;
+  }
+}
+
+TEST(FoldingSetTest, HasherLookup) {
+  FoldingSet<TrivialPair> Trivial;
+  TrivialPair T(99, 42);
+  Trivial.InsertNode(&T);
+
+  auto Find = [&](unsigned Key, unsigned Value, void *&InsertPos) {
+    FoldingSetNodeIDHasher Hash;
+    Hash.AddInteger(Key);
+    Hash.AddInteger(Value);
+    return Trivial.FindNodeOrInsertPos(
+        Hash,
+        [&](TrivialPair &P) { return P.Key == Key && P.Value == Value; },
+        InsertPos);
+  };
+
+  void *InsertPos = nullptr;
+  EXPECT_EQ(&T, Find(99, 42, InsertPos));
+  EXPECT_EQ(nullptr, InsertPos);
+
+  TrivialPair S(100, 42);
+  EXPECT_EQ(nullptr, Find(100, 42, InsertPos));
+  ASSERT_NE(nullptr, InsertPos);
+  Trivial.InsertNode(&S, InsertPos);
+
+  // Nodes inserted at the position found with a hasher are found by ID.
+  FoldingSetNodeID ID;
+  S.Profile(ID);
+  EXPECT_EQ(&S, Trivial.FindNodeOrInsertPos(ID, InsertPos));
+}
+
 TEST(FoldingSetTest, RemoveNodeThatIsPresent) {
   FoldingSet<TrivialPair> Trivial;
 
@@ -0,0 +1,242 @@
+//===- llvm/unittest/ADT/SwissMapTest.cpp - SwissMap unit tests -----------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/ADT/SwissMap.h"
+#include "llvm/ADT/Hashing.h"
+#include "gtest/gtest.h"
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace llvm;
+
+namespace {
+
+TEST(SwissMapTest, EmptyMap) {
+  SwissMap<unsigned, unsigned> Map;
+  EXPECT_TRUE(Map.empty());
+  EXPECT_EQ(0u, Map.size());
+  EXPECT_EQ(0u, Map.getNumBuckets());
+  EXPECT_EQ(0u, Map.getMemorySize());
+  EXPECT_TRUE(Map.begin() == Map.end());
+  EXPECT_EQ(0u, Map.count(1));
+  EXPECT_TRUE(Map.find(1) == Map.end());
+  EXPECT_EQ(0u, Map.lookup(1));
+  EXPECT_FALSE(Map.erase(1));
+}
+
+TEST(SwissMapTest, InsertFindErase) {
+  SwissMap<unsigned, unsigned> Map;
+  auto R = Map.insert({7, 70});
+  EXPECT_TRUE(R.second);
+  EXPECT_EQ(7u, R.first->first);
+  EXPECT_EQ(70u, R.first->second);
+
+  // Inserting an existing key doesn't update the value.
+  R = Map.insert({7, 71});
+  EXPECT_FALSE(R.second);
+  EXPECT_EQ(70u, R.first->second);
+
+  EXPECT_EQ(1u, Map.size());
+  EXPECT_EQ(1u, Map.count(7));
+  EXPECT_EQ(70u, Map.lookup(7));
+  EXPECT_EQ(70u, Map[7]);
+  EXPECT_EQ(0u, Map[8]);
+  EXPECT_EQ(2u, Map.size());
+
+  EXPECT_TRUE(Map.erase(7));
+  EXPECT_FALSE(Map.erase(7));
+  EXPECT_EQ(1u, Map.size());
+  EXPECT_TRUE(Map.find(7) == Map.end());
+
+  Map.erase(Map.find(8));
+  EXPECT_TRUE(Map.empty());
+}
+
+// Insert and erase enough keys to grow the table many times and to reuse
+// erased buckets, checking against std::map.
+TEST(SwissMapTest, ManyKeys) {
+  SwissMap<unsigned, unsigned> Map;
+  std::map<unsigned, unsigned> Ref;
+  unsigned Seed = 1;
+  for (unsigned I = 0; I != 20000; ++I) {
+    Seed = Seed * 1103515245 + 12345;
+    unsigned Key = (Seed >> 8) % 5000;
+    if (Seed & 0x10000) {
+      EXPECT_EQ(Ref.erase(Key) != 0, Map.erase(Key));
+    } else {
+      Map[Key] = I;
+      Ref[Key] = I;
+    }
+  }
+  EXPECT_EQ(Ref.size(), Map.size());
+  for (auto &KV : Ref)
+    EXPECT_EQ(KV.second, Map.lookup(KV.first));
+  unsigned Visited = 0;
+  for (auto &KV : Map) {
+    EXPECT_EQ(Ref[KV.first], KV.second);
+    ++Visited;
+  }
+  EXPECT_EQ(Ref.size(), Visited);
+}
+
+// Sequential keys all hash to neighbouring values with DenseMapInfo.
+TEST(SwissMapTest, SequentialKeys) {
+  SwissMap<unsigned, unsigned> Map;
+  for (unsigned I = 0; I != 1000; ++I)
+    Map[I * 16] = I;
+  EXPECT_EQ(1000u, Map.size());
+  for (unsigned I = 0; I != 1000; ++I) {
+    EXPECT_EQ(I, Map.lookup(I * 16));
+    EXPECT_EQ(0u, Map.count(I * 16 + 1));
+  }
+}
+
+// Keys that collide in all their hash bits still work.
+struct CollidingInfo {
+  static unsigned getHashValue(unsigned) { return 42; }
+  static bool isEqual(unsigned LHS, unsigned RHS) { return LHS == RHS; }
+};
+
+TEST(SwissMapTest, Collisions) {
+  SwissMap<unsigned, unsigned, CollidingInfo> Map;
+  for (unsigned I = 0; I != 100; ++I)
+    Map[I] = I + 1;
+  for (unsigned I = 0; I != 100; I += 2)
+    EXPECT_TRUE(Map.erase(I));
+  EXPECT_EQ(50u, Map.size());
+  for (unsigned I = 0; I != 100; ++I)
+    EXPECT_EQ(I % 2 ? I + 1 : 0, Map.lookup(I));
+}
+
+TEST(SwissMapTest, EraseWhileIterating) {
+  SwissMap<unsigned, unsigned> Map;
+  for (unsigned I = 0; I != 100; ++I)
+    Map[I] = I;
+  for (auto I = Map.begin(), E = Map.end(); I != E;) {
+    auto Cur = I++;
+    if (Cur->first % 3 == 0)
+      Map.erase(Cur);
+  }
+  EXPECT_EQ(66u, Map.size());
+  for (auto &KV : Map)
+    EXPECT_NE(0u, KV.first % 3);
+}
+
+// Inserting and erasing in a loop must not grow the table: erased buckets are
+// reclaimed by rehashing in place.
+TEST(SwissMapTest, ChurnDoesNotGrow) {
+  SwissMap<unsigned, unsigned> Map;
+  Map.reserve(100);
+  unsigned NumBuckets = Map.getNumBuckets();
+  for (unsigned I = 0; I != 100000; ++I) {
+    Map[I] = I;
+    if (I >= 50)
+      EXPECT_TRUE(Map.erase(I - 50));
+  }
+  EXPECT_EQ(50u, Map.size());
+  EXPECT_EQ(NumBuckets, Map.getNumBuckets());
+}
+
+TEST(SwissMapTest, Reserve) {
+  SwissMap<unsigned, unsigned> Map(100);
+  unsigned NumBuckets = Map.getNumBuckets();
+  EXPECT_LE(100u, NumBuckets - NumBuckets / 8);
+  for (unsigned I = 0; I != 100; ++I)
+    Map[I] = I;
+  EXPECT_EQ(NumBuckets, Map.getNumBuckets());
+}
+
+TEST(SwissMapTest, ClearAndShrink) {
+  SwissMap<unsigned, unsigned> Map;
+  for (unsigned I = 0; I != 100; ++I)
+    Map[I] = I;
+  unsigned NumBuckets = Map.getNumBuckets();
+  Map.clear();
+  EXPECT_TRUE(Map.empty());
+  EXPECT_EQ(NumBuckets, Map.getNumBuckets());
+  EXPECT_EQ(0u, Map.count(5));
+  Map[5] = 6;
+  EXPECT_EQ(6u, Map.lookup(5));
+  Map.shrink_and_clear();
+  EXPECT_TRUE(Map.empty());
+  EXPECT_EQ(0u, Map.getNumBuckets());
+}
+
+TEST(SwissMapTest, CopyMoveSwap) {
+  SwissMap<unsigned, unsigned> Map = {{1, 2}, {3, 4}};
+  SwissMap<unsigned, unsigned> Copy(Map);
+  EXPECT_EQ(2u, Copy.size());
+  EXPECT_EQ(4u, Copy.lookup(3));
+  Copy[5] = 6;
+  EXPECT_EQ(0u, Map.count(5));
+
+  SwissMap<unsigned, unsigned> Moved(std::move(Copy));
+  EXPECT_EQ(3u, Moved.size());
+  EXPECT_TRUE(Copy.empty());
+
+  Copy = Moved;
+  EXPECT_EQ(3u, Copy.size());
+  Moved = std::move(Map);
+  EXPECT_EQ(2u, Moved.size());
+  EXPECT_EQ(0u, Moved.count(5));
+
+  Moved.swap(Copy);
+  EXPECT_EQ(3u, Moved.size());
+  EXPECT_EQ(2u, Copy.size());
+  EXPECT_EQ(6u, Moved.lookup(5));
+}
+
+// SwissMap needs no empty or tombstone keys.
+struct StringInfo {
+  static unsigned getHashValue(const std::string &S) { return hash_value(S); }
+  static bool isEqual(const std::string &LHS, const std::string &RHS) {
+    return LHS == RHS;
+  }
+};
+
+// Values that own memory are destroyed and moved correctly.
+TEST(SwissMapTest, NonTrivialValues) {
+  SwissMap<unsigned, std::unique_ptr<unsigned>> Map;
+  for (unsigned I = 0; I != 1000; ++I)
+    Map.try_emplace(I, std::make_unique<unsigned>(I));
+  for (unsigned I = 0; I != 1000; I += 2)
+    Map.erase(I);
+  for (unsigned I = 1; I < 1000; I += 2)
+    EXPECT_EQ(I, *Map.find(I)->second);
+
+  SwissMap<std::string, std::string, StringInfo> Strings;
+  Strings["a"] = "b";
+  Strings.try_emplace(std::string(100, 'x'), "y");
+  SwissMap<std::string, std::string, StringInfo> Copy = Strings;
+  EXPECT_EQ("b", Copy.lookup("a"));
+  EXPECT_EQ("y", Copy.lookup(std::string(100, 'x')));
+}
+
+TEST(SwissMapTest, ConstIterator) {
+  SwissMap<unsigned, unsigned> Map = {{1, 2}};
+  const auto &ConstMap = Map;
+  SwissMap<unsigned, unsigned>::const_iterator I = Map.begin();
+  EXPECT_TRUE(I == ConstMap.begin());
+  EXPECT_TRUE(ConstMap.find(1) == I);
+  EXPECT_TRUE(ConstMap.find(2) == ConstMap.end());
+}
+
+TEST(SwissMapTest, PointerKeys) {
+  std::vector<std::unique_ptr<int>> Objects;
+  SwissMap<int *, unsigned> Map;
+  for (unsigned I = 0; I != 500; ++I) {
+    Objects.push_back(std::make_unique<int>(I));
+    Map[Objects.back().get()] = I;
+  }
+  for (unsigned I = 0; I != 500; ++I)
+    EXPECT_EQ(I, Map.lookup(Objects[I].get()));
+}
+
+} // end anonymous namespace
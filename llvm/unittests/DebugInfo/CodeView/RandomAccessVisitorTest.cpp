@@ -396,3 +396,26 @@ TEST_F(RandomAccessVisitorTest, CrossChunkName) {
   StringRef Name = Types.getTypeName(IndexOne);
   EXPECT_EQ("const FooClass", Name);
 }
+
+TEST_F(RandomAccessVisitorTest, TypeOffsets) {
+  LazyRandomTypeCollection Scanned(GlobalState->TypeArray,
+                                   GlobalState->TypeVector.size());
+  std::vector<uint32_t> Offsets = Scanned.getTypeOffsets();
+  ASSERT_EQ(GlobalState->AllOffsets.size(), Offsets.size());
+  for (uint32_t I = 0; I < Offsets.size(); ++I)
+    EXPECT_EQ(uint32_t(GlobalState->AllOffsets[I].Offset), Offsets[I]);
+
+  // Loading the offsets makes every record known without visiting any.
+  LazyRandomTypeCollection Types(GlobalState->TypeArray, 1);
+  ASSERT_THAT_ERROR(Types.setTypeOffsets(Offsets), Succeeded());
+  EXPECT_EQ(Offsets.size(), Types.size());
+  for (uint32_t I = 0; I < Offsets.size(); ++I)
+    EXPECT_TRUE(ValidateDatabaseRecord(Types, I));
+
+  // Offsets that are not record boundaries are rejected.
+  std::vector<uint32_t> BadOffsets = Offsets;
+  ++BadOffsets[1];
+  LazyRandomTypeCollection BadTypes(GlobalState->TypeArray, 1);
+  EXPECT_THAT_ERROR(BadTypes.setTypeOffsets(BadOffsets), Failed());
+  EXPECT_EQ(0u, BadTypes.size());
+}
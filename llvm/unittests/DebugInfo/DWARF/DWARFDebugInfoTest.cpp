@@ -1351,6 +1351,56 @@ TEST(DWARFDebugInfo, TestChildIterators) {
   EXPECT_EQ(A.begin(), A.end());
 }
 
+TEST(DWARFDebugInfo, TestExtractAllDIEs) {
+  Triple Triple = getNormalizedDefaultTargetTriple();
+  if (!isConfigurationSupported(Triple))
+    return;
+
+  // Extract several units at once and check that every unit sees its own DIEs
+  // through the abbreviation indices recorded during extraction.
+  uint16_t Version = 4;
+  auto ExpectedDG = dwarfgen::Generator::create(Triple, Version);
+  ASSERT_THAT_EXPECTED(ExpectedDG, Succeeded());
+  dwarfgen::Generator *DG = ExpectedDG.get().get();
+  const unsigned NumUnits = 8;
+  for (unsigned I = 0; I != NumUnits; ++I) {
+    // CU
+    //   subprogram (I + 1 times)
+    //     variable
+    auto CUDie = DG->addCompileUnit().getUnitDIE();
+    for (unsigned J = 0; J <= I; ++J) {
+      auto SubprogramDie = CUDie.addChild(DW_TAG_subprogram);
+      SubprogramDie.addAttribute(DW_AT_name, DW_FORM_strp, "f");
+      SubprogramDie.addChild(DW_TAG_variable);
+    }
+  }
+
+  MemoryBufferRef FileBuffer(DG->generate(), "dwarf");
+  auto Obj = object::ObjectFile::createObjectFile(FileBuffer);
+  EXPECT_TRUE((bool)Obj);
+  std::unique_ptr<DWARFContext> DwarfContext = DWARFContext::create(**Obj);
+  DwarfContext->extractAllDIEs(4);
+
+  EXPECT_EQ(DwarfContext->getNumCompileUnits(), NumUnits);
+  for (unsigned I = 0; I != NumUnits; ++I) {
+    DWARFUnit *U = DwarfContext->getUnitAtIndex(I);
+    // The CU and its NULL terminator, then the subprogram, the variable and
+    // the NULL terminator of the subprogram's children for every subprogram.
+    EXPECT_EQ(U->getNumDIEs(), 2 + 3 * (I + 1));
+    DWARFDie CUDie = U->getUnitDIE(false);
+    EXPECT_EQ(CUDie.getTag(), DW_TAG_compile_unit);
+    unsigned NumSubprograms = 0;
+    for (DWARFDie Child : CUDie.children()) {
+      EXPECT_EQ(Child.getTag(), DW_TAG_subprogram);
+      EXPECT_TRUE(Child.hasChildren());
+      EXPECT_EQ(Child.getFirstChild().getTag(), DW_TAG_variable);
+      EXPECT_TRUE(Child.getLastChild().isNULL());
+      ++NumSubprograms;
+    }
+    EXPECT_EQ(NumSubprograms, I + 1);
+  }
+}
+
 TEST(DWARFDebugInfo, TestChildIteratorsOnInvalidDie) {
   // Verify that an invalid DIE has no children.
   DWARFDie Invalid;
@@ -1927,6 +1977,97 @@ TEST(DWARFDebugInfo, TestDwarfVerifyInvalidCURef) {
                              "0x0000001a):");
 }
 
+TEST(DWARFDebugInfo, TestDwarfVerifyParallel) {
+  // Create three compile units that each have an invalid CU relative
+  // DW_AT_type, and check that verifying them with several threads reports
+  // the same errors in the same order as verifying them serially.
+  const char *yamldata = R"(
+    debug_str:
+      - ''
+      - /tmp/main.c
+      - main
+    debug_abbrev:
+      - Code:            0x00000001
+        Tag:             DW_TAG_compile_unit
+        Children:        DW_CHILDREN_yes
+        Attributes:
+          - Attribute:       DW_AT_name
+            Form:            DW_FORM_strp
+      - Code:            0x00000002
+        Tag:             DW_TAG_subprogram
+        Children:        DW_CHILDREN_no
+        Attributes:
+          - Attribute:       DW_AT_name
+            Form:            DW_FORM_strp
+          - Attribute:       DW_AT_type
+            Form:            DW_FORM_ref4
+    debug_info:
+      - Length:
+          TotalLength:     22
+        Version:         4
+        AbbrOffset:      0
+        AddrSize:        8
+        Entries:
+          - AbbrCode:        0x00000001
+            Values:
+              - Value:           0x0000000000000001
+          - AbbrCode:        0x00000002
+            Values:
+              - Value:           0x000000000000000D
+              - Value:           0x0000000000001234
+          - AbbrCode:        0x00000000
+            Values:
+      - Length:
+          TotalLength:     22
+        Version:         4
+        AbbrOffset:      0
+        AddrSize:        8
+        Entries:
+          - AbbrCode:        0x00000001
+            Values:
+              - Value:           0x0000000000000001
+          - AbbrCode:        0x00000002
+            Values:
+              - Value:           0x000000000000000D
+              - Value:           0x0000000000001235
+          - AbbrCode:        0x00000000
+            Values:
+      - Length:
+          TotalLength:     22
+        Version:         4
+        AbbrOffset:      0
+        AddrSize:        8
+        Entries:
+          - AbbrCode:        0x00000001
+            Values:
+              - Value:           0x0000000000000001
+          - AbbrCode:        0x00000002
+            Values:
+              - Value:           0x000000000000000D
+              - Value:           0x0000000000001236
+          - AbbrCode:        0x00000000
+            Values:
+  )";
+  auto ErrOrSections = DWARFYAML::EmitDebugSections(StringRef(yamldata));
+  ASSERT_TRUE((bool)ErrOrSections);
+  std::unique_ptr<DWARFContext> DwarfContext =
+      DWARFContext::create(*ErrOrSections, 8);
+
+  auto Verify = [&](unsigned NumThreads) {
+    std::string Str;
+    raw_string_ostream Strm(Str);
+    DIDumpOptions DumpOpts;
+    DumpOpts.NumThreads = NumThreads;
+    EXPECT_FALSE(DwarfContext->verify(Strm, DumpOpts));
+    return Strm.str();
+  };
+  std::string Serial = Verify(1);
+  EXPECT_TRUE(StringRef(Serial).contains("CU offset 0x00001234 is invalid"));
+  EXPECT_TRUE(StringRef(Serial).contains("CU offset 0x00001236 is invalid"));
+  EXPECT_EQ(Serial, Verify(2));
+  EXPECT_EQ(Serial, Verify(0));
+}
+
 TEST(DWARFDebugInfo, TestDwarfVerifyInvalidRefAddr) {
   // Create a single compile unit with a single function that has an invalid
   // DW_AT_type with an invalid .debug_info offset in its DW_FORM_ref_addr.
@@ -2201,6 +2342,122 @@ TEST(DWARFDebugInfo, TestDwarfVerifyInvalidLineSequence) {
                              "in address from previous row:");
 }
 
+TEST(DWARFDebugInfo, TestLineIndex) {
+  // Create a single compile unit with a line table that maps 0x1000-0x100f
+  // to line 10 and 0x1010-0x101f to line 11 of /tmp/main.c.
+  StringRef yamldata = R"(
+    debug_str:
+      - ''
+      - /tmp/main.c
+    debug_abbrev:
+      - Code:            0x00000001
+        Tag:             DW_TAG_compile_unit
+        Children:        DW_CHILDREN_no
+        Attributes:
+          - Attribute:       DW_AT_name
+            Form:            DW_FORM_strp
+          - Attribute:       DW_AT_stmt_list
+            Form:            DW_FORM_sec_offset
+    debug_info:
+      - Length:
+          TotalLength:     16
+        Version:         4
+        AbbrOffset:      0
+        AddrSize:        8
+        Entries:
+          - AbbrCode:        0x00000001
+            Values:
+              - Value:           0x0000000000000001
+              - Value:           0x0000000000000000
+    debug_line:
+      - Length:
+          TotalLength:     64
+        Version:         2
+        PrologueLength:  34
+        MinInstLength:   1
+        DefaultIsStmt:   1
+        LineBase:        251
+        LineRange:       14
+        OpcodeBase:      13
+        StandardOpcodeLengths: [ 0, 1, 1, 1, 1, 0, 0, 0, 1, 0, 0, 1 ]
+        IncludeDirs:
+          - /tmp
+        Files:
+          - Name:            main.c
+            DirIdx:          1
+            ModTime:         0
+            Length:          0
+        Opcodes:
+          - Opcode:          DW_LNS_extended_op
+            ExtLen:          9
+            SubOpcode:       DW_LNE_set_address
+            Data:            4096
+          - Opcode:          DW_LNS_advance_line
+            SData:           9
+            Data:            0
+          - Opcode:          DW_LNS_copy
+            Data:            0
+          - Opcode:          DW_LNS_advance_pc
+            Data:            16
+          - Opcode:          DW_LNS_advance_line
+            SData:           1
+            Data:            0
+          - Opcode:          DW_LNS_copy
+            Data:            0
+          - Opcode:          DW_LNS_advance_pc
+            Data:            16
+          - Opcode:          DW_LNS_extended_op
+            ExtLen:          1
+            SubOpcode:       DW_LNE_end_sequence
+            Data:            0
+  )";
+  auto ErrOrSections = DWARFYAML::EmitDebugSections(yamldata);
+  ASSERT_TRUE((bool)ErrOrSections);
+  std::unique_ptr<DWARFContext> DwarfContext =
+      DWARFContext::create(*ErrOrSections, 8);
+
+  DWARFLineIndex Index = DWARFLineIndex::build(*DwarfContext);
+  EXPECT_EQ(Index.getNumSequences(), 1u);
+  EXPECT_EQ(Index.getNumRows(), 2u);
+
+  std::string Encoded;
+  raw_string_ostream OS(Encoded);
+  Index.encode(OS);
+  OS.flush();
+  Expected<DWARFLineIndex> Decoded = DWARFLineIndex::decode(Encoded);
+  ASSERT_THAT_EXPECTED(Decoded, Succeeded());
+  EXPECT_THAT_EXPECTED(DWARFLineIndex::decode(StringRef(Encoded).drop_back()),
+                       Failed());
+
+  using FileLineInfoKind = DILineInfoSpecifier::FileLineInfoKind;
+  const uint64_t Undef = object::SectionedAddress::UndefSection;
+  for (const DWARFLineIndex *I : {&Index, &*Decoded}) {
+    DILineInfo Info;
+    EXPECT_FALSE(I->getFileLineInfoForAddress(
+        {0xfff, Undef}, FileLineInfoKind::AbsoluteFilePath, Info));
+    EXPECT_TRUE(I->getFileLineInfoForAddress(
+        {0x1008, Undef}, FileLineInfoKind::AbsoluteFilePath, Info));
+    EXPECT_EQ(Info.FileName, "/tmp/main.c");
+    EXPECT_EQ(Info.Line, 10u);
+    EXPECT_TRUE(I->getFileLineInfoForAddress(
+        {0x1010, Undef}, FileLineInfoKind::Default, Info));
+    EXPECT_EQ(Info.FileName, "main.c");
+    EXPECT_EQ(Info.Line, 11u);
+    EXPECT_FALSE(I->getFileLineInfoForAddress(
+        {0x1020, Undef}, FileLineInfoKind::AbsoluteFilePath, Info));
+  }
+
+  // Once set, the context answers file and line queries from the index.
+  DwarfContext->setLineIndex(
+      std::make_unique<DWARFLineIndex>(std::move(*Decoded)));
+  DILineInfo Info = DwarfContext->getLineInfoForAddress(
+      {0x1018, Undef},
+      DILineInfoSpecifier(FileLineInfoKind::AbsoluteFilePath,
+                          DINameKind::None));
+  EXPECT_EQ(Info.FileName, "/tmp/main.c");
+  EXPECT_EQ(Info.Line, 11u);
+}
+
 TEST(DWARFDebugInfo, TestDwarfVerifyInvalidLineFileIndex) {
   // Create a single compile unit whose line table has a line table row with
   // an invalid file index.
@@ -13,6 +13,7 @@
 #include "llvm/DebugInfo/GSYM/FileEntry.h"
 #include "llvm/DebugInfo/GSYM/FileWriter.h"
 #include "llvm/DebugInfo/GSYM/FunctionInfo.h"
+#include "llvm/DebugInfo/GSYM/GsymContext.h"
 #include "llvm/DebugInfo/GSYM/GsymCreator.h"
 #include "llvm/DebugInfo/GSYM/GsymReader.h"
 #include "llvm/DebugInfo/GSYM/InlineInfo.h"
@@ -1300,3 +1301,70 @@ TEST(GSYMTest, TestGsymReader) {
                             "address 0x1030 not in GSYM");
   }
 }
+
+TEST(GSYMTest, TestGsymContext) {
+  // Create a function "main" at 0x1000-0x1020 from "/tmp/main.c" that has
+  // "inl" from "/tmp/inl.h" inlined at 0x1010-0x1018, called from line 12.
+  GsymCreator GC;
+  const uint32_t MainName = GC.insertString("main");
+  const uint32_t InlName = GC.insertString("inl");
+  const uint32_t MainFile = GC.insertFile("/tmp/main.c");
+  const uint32_t InlFile = GC.insertFile("/tmp/inl.h");
+  FunctionInfo FI(0x1000, 0x20, MainName);
+  FI.OptLineTable = LineTable();
+  FI.OptLineTable->push(LineEntry(0x1000, MainFile, 10));
+  FI.OptLineTable->push(LineEntry(0x1010, InlFile, 3));
+  FI.OptLineTable->push(LineEntry(0x1018, MainFile, 13));
+  FI.Inline = InlineInfo();
+  FI.Inline->Ranges.insert(AddressRange(0x1000, 0x1020));
+  InlineInfo Inl;
+  Inl.Name = InlName;
+  Inl.CallFile = MainFile;
+  Inl.CallLine = 12;
+  Inl.Ranges.insert(AddressRange(0x1010, 0x1018));
+  FI.Inline->Children.push_back(Inl);
+  GC.addFunctionInfo(std::move(FI));
+  ASSERT_FALSE((bool)GC.finalize(llvm::nulls()));
+  SmallString<512> Str;
+  raw_svector_ostream OutStrm(Str);
+  FileWriter FW(OutStrm, support::endian::system_endianness());
+  ASSERT_FALSE((bool)GC.encode(FW));
+  Expected<GsymReader> GR = GsymReader::copyBuffer(OutStrm.str());
+  ASSERT_TRUE((bool)GR);
+  GsymContext Ctx(std::move(*GR));
+
+  DILineInfo Info = Ctx.getLineInfoForAddress({0x1004});
+  EXPECT_EQ(Info.FunctionName, "main");
+  EXPECT_EQ(Info.FileName, "/tmp/main.c");
+  EXPECT_EQ(Info.Line, 10u);
+
+  // The line info of an inlined address names the inlined function.
+  Info = Ctx.getLineInfoForAddress({0x1014});
+  EXPECT_EQ(Info.FunctionName, "inl");
+  EXPECT_EQ(Info.FileName, "/tmp/inl.h");
+  EXPECT_EQ(Info.Line, 3u);
+
+  DIInliningInfo Inlining = Ctx.getInliningInfoForAddress({0x1014});
+  ASSERT_EQ(Inlining.getNumberOfFrames(), 2u);
+  EXPECT_EQ(Inlining.getFrame(0).FunctionName, "inl");
+  EXPECT_EQ(Inlining.getFrame(0).FileName, "/tmp/inl.h");
+  EXPECT_EQ(Inlining.getFrame(0).Line, 3u);
+  EXPECT_EQ(Inlining.getFrame(1).FunctionName, "main");
+  EXPECT_EQ(Inlining.getFrame(1).FileName, "/tmp/main.c");
+  EXPECT_EQ(Inlining.getFrame(1).Line, 12u);
+
+  Inlining = Ctx.getInliningInfoForAddress({0x101c});
+  ASSERT_EQ(Inlining.getNumberOfFrames(), 1u);
+  EXPECT_EQ(Inlining.getFrame(0).FunctionName, "main");
+  EXPECT_EQ(Inlining.getFrame(0).Line, 13u);
+
+  DILineInfoTable Table = Ctx.getLineInfoForAddressRange({0x1008}, 0x10);
+  ASSERT_EQ(Table.size(), 2u);
+  EXPECT_EQ(Table[0].first, 0x1008u);
+  EXPECT_EQ(Table[0].second.Line, 10u);
+  EXPECT_EQ(Table[1].first, 0x1010u);
+  EXPECT_EQ(Table[1].second.Line, 3u);
+
+  // Addresses outside of any function produce no information.
+  EXPECT_FALSE(Ctx.getLineInfoForAddress({0x2000}));
+}
@@ -0,0 +1,202 @@
+//===---------- ELF_x86_64.cpp - Tests for JITLink ELF/x86-64 -------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "JITLinkTestCommon.h"
+
+#include "llvm/ExecutionEngine/JITLink/ELF_x86_64.h"
+#include "llvm/Testing/Support/Error.h"
+
+#include "gtest/gtest.h"
+
+using namespace llvm;
+using namespace llvm::jitlink;
+using namespace llvm::jitlink::ELF_x86_64_Edges;
+
+namespace {
+
+class JITLinkTest_ELF_x86_64 : public JITLinkTestCommon,
+                               public testing::Test {
+public:
+  using BasicVerifyGraphFunction =
+      std::function<void(LinkGraph &, const MCDisassembler &)>;
+
+  void runBasicVerifyGraphTest(StringRef AsmSrc, StringRef Triple,
+                               StringMap<JITEvaluatedSymbol> Externals,
+                               bool PIC, bool LargeCodeModel,
+                               MCTargetOptions Options,
+                               BasicVerifyGraphFunction RunGraphTest) {
+    auto TR = getTestResources(AsmSrc, Triple, PIC, LargeCodeModel,
+                               std::move(Options));
+    if (!TR) {
+      dbgs() << "Skipping JITLInk unit test: " << toString(TR.takeError())
+             << "\n";
+      return;
+    }
+
+    auto JTCtx = std::make_unique<TestJITLinkContext>(
+        **TR, [&](LinkGraph &G) { RunGraphTest(G, (*TR)->getDisassembler()); });
+
+    JTCtx->externals() = std::move(Externals);
+
+    jitLink_ELF_x86_64(std::move(JTCtx));
+  }
+
+protected:
+  // All the functions of an ELF section share its block: find the edge of
+  // the instruction at the given offset.
+  static Edge *findEdgeAt(Block &B, JITTargetAddress Offset) {
+    for (auto &E : B.edges())
+      if (E.getOffset() == Offset)
+        return &E;
+    ADD_FAILURE() << "No edge at offset " << Offset;
+    return nullptr;
+  }
+
+  static void verifyIsPointerTo(LinkGraph &G, Block &B, Symbol &Target) {
+    EXPECT_EQ(B.edges_size(), 1U) << "Incorrect number of edges for pointer";
+    if (B.edges_size() != 1U)
+      return;
+    auto &E = *B.edges().begin();
+    EXPECT_EQ(E.getOffset(), 0U) << "Expected edge offset of zero";
+    EXPECT_EQ(E.getKind(), Pointer64)
+        << "Expected pointer to have a pointer64 relocation";
+    EXPECT_EQ(&E.getTarget(), &Target) << "Expected edge to point at target";
+    EXPECT_THAT_EXPECTED(readInt<uint64_t>(G, B), HasValue(Target.getAddress()))
+        << "Pointer does not point to target";
+  }
+
+  static void verifyCall(const MCDisassembler &Dis, Block &CallerBlock,
+                         Edge &E, Symbol &Callee) {
+    EXPECT_EQ(E.getKind(), Branch32) << "Edge is not a Branch32";
+    EXPECT_EQ(E.getAddend(), 0U) << "Expected no addend on call";
+    EXPECT_EQ(&E.getTarget(), &Callee)
+        << "Edge does not point at expected callee";
+
+    JITTargetAddress FixupAddress = CallerBlock.getAddress() + E.getOffset();
+    uint64_t PCRelDelta = Callee.getAddress() - (FixupAddress + 4);
+
+    EXPECT_THAT_EXPECTED(
+        decodeImmediateOperand(Dis, CallerBlock, 0, E.getOffset() - 1),
+        HasValue(PCRelDelta));
+  }
+};
+
+} // end anonymous namespace
+
+TEST_F(JITLinkTest_ELF_x86_64, BasicRelocations) {
+  runBasicVerifyGraphTest(
+      R"(
+            .text
+            .globl  bar
+            .p2align        4, 0x90
+            .type   bar,@function
+    bar:
+            callq   baz@PLT
+
+            .globl  foo
+            .p2align        4, 0x90
+            .type   foo,@function
+    foo:
+            callq   bar@PLT
+    foo.1:
+            movq    y@GOTPCREL(%rip), %rcx
+    foo.2:
+            movq    p(%rip), %rdx
+
+            .data
+            .globl  x
+            .p2align        2
+    x:
+            .long   42
+
+            .globl  p
+            .p2align        3
+    p:
+            .quad   x)",
+      "x86_64-unknown-linux",
+      {{"y", JITEvaluatedSymbol(0xdeadbeef, JITSymbolFlags::Exported)},
+       {"baz", JITEvaluatedSymbol(0xcafef00d, JITSymbolFlags::Exported)}},
+      true, false, MCTargetOptions(),
+      [](LinkGraph &G, const MCDisassembler &Dis) {
+        // Name the symbols in the asm above.
+        auto &Baz = symbol(G, "baz");
+        auto &Y = symbol(G, "y");
+        auto &Bar = symbol(G, "bar");
+        auto &Foo = symbol(G, "foo");
+        auto &Foo_1 = symbol(G, "foo.1");
+        auto &Foo_2 = symbol(G, "foo.2");
+        auto &X = symbol(G, "x");
+        auto &P = symbol(G, "p");
+
+        auto &Text = Foo.getBlock();
+        EXPECT_EQ(Text.edges_size(), 4U) << "Unexpected number of relocations";
+
+        // Check the R_X86_64_64 reloc for p.
+        {
+          auto *E = findEdgeAt(P.getBlock(), P.getOffset());
+          ASSERT_TRUE(E);
+          EXPECT_EQ(E->getKind(), Pointer64) << "Unexpected edge kind for p";
+          EXPECT_THAT_EXPECTED(readInt<uint64_t>(G, P.getBlock(),
+                                                 P.getOffset()),
+                               HasValue(X.getAddress()))
+              << "Pointer relocation did not apply correctly";
+        }
+
+        // Check that bar calls baz through a stub, which jumps through a GOT
+        // entry pointing to baz.
+        {
+          auto *E = findEdgeAt(Text, Bar.getOffset() + 1);
+          ASSERT_TRUE(E);
+          ASSERT_TRUE(E->getTarget().isDefined())
+              << "Edge target is not a stub";
+          verifyCall(Dis, Text, *E, E->getTarget());
+
+          auto &StubBlock = E->getTarget().getBlock();
+          ASSERT_EQ(StubBlock.edges_size(), 1U)
+              << "Expected one edge from stub to target";
+          auto &StubEdge = *StubBlock.edges().begin();
+          EXPECT_EQ(StubEdge.getKind(), PCRel32);
+          ASSERT_TRUE(StubEdge.getTarget().isDefined());
+          verifyIsPointerTo(G, StubEdge.getTarget().getBlock(), Baz);
+        }
+
+        // Check that foo is a direct call to bar.
+        {
+          auto *E = findEdgeAt(Text, Foo.getOffset() + 1);
+          ASSERT_TRUE(E);
+          verifyCall(Dis, Text, *E, Bar);
+        }
+
+        // Check the GOT load in foo.1.
+        {
+          auto *E = findEdgeAt(Text, Foo_1.getOffset() + 3);
+          ASSERT_TRUE(E);
+          EXPECT_EQ(E->getKind(), PCRel32);
+          EXPECT_EQ(E->getAddend(), 0U)
+              << "Expected GOT load to have a zero addend";
+          ASSERT_TRUE(E->getTarget().isDefined())
+              << "GOT entry should be a defined symbol";
+          verifyIsPointerTo(G, E->getTarget().getBlock(), Y);
+        }
+
+        // Check the PC-relative reference to p in foo.2.
+        {
+          auto *E = findEdgeAt(Text, Foo_2.getOffset() + 3);
+          ASSERT_TRUE(E);
+          EXPECT_EQ(E->getKind(), PCRel32);
+
+          JITTargetAddress FixupAddress = Text.getAddress() + E->getOffset();
+          uint64_t PCRelDelta = P.getAddress() - (FixupAddress + 4);
+
+          EXPECT_THAT_EXPECTED(
+              decodeImmediateOperand(Dis, Text, 4, Foo_2.getOffset()),
+              HasValue(PCRelDelta))
+              << "PCRel load does not reference expected target";
+        }
+      });
+}
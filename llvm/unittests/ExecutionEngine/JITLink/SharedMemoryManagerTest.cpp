@@ -0,0 +1,77 @@
+//===------ SharedMemoryManagerTest.cpp - SharedMemoryManager tests -------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/ExecutionEngine/JITLink/JITLinkMemoryManager.h"
+#include "llvm/Config/llvm-config.h"
+#include "llvm/Testing/Support/Error.h"
+
+#include "gtest/gtest.h"
+
+using namespace llvm;
+using namespace llvm::jitlink;
+
+namespace {
+
+#ifdef LLVM_ON_UNIX
+
+TEST(SharedMemoryManagerTest, TargetMemorySharesWorkingMemory) {
+  auto RW = static_cast<sys::Memory::ProtectionFlags>(sys::Memory::MF_READ |
+                                                      sys::Memory::MF_WRITE);
+  auto RO = sys::Memory::MF_READ;
+
+  JITLinkMemoryManager::SegmentsRequestMap Request;
+  Request[RW] = {8, 16, 4096};
+  Request[RO] = {16, 5, 0};
+
+  SharedMemoryManager MemMgr;
+  auto Alloc = MemMgr.allocate(Request);
+  ASSERT_THAT_EXPECTED(Alloc, Succeeded());
+
+  auto Data = (*Alloc)->getWorkingMemory(RW);
+  auto Const = (*Alloc)->getWorkingMemory(RO);
+  ASSERT_GE(Data.size(), 16U + 4096U);
+  ASSERT_GE(Const.size(), 5U);
+  memcpy(Data.data(), "0123456789abcdef", 16);
+  memcpy(Const.data(), "const", 5);
+
+  // The working memory and the target memory are distinct mappings.
+  JITTargetAddress DataAddr = (*Alloc)->getTargetMemory(RW);
+  JITTargetAddress ConstAddr = (*Alloc)->getTargetMemory(RO);
+  EXPECT_NE(DataAddr, pointerToJITTargetAddress(Data.data()));
+  EXPECT_NE(DataAddr, ConstAddr);
+
+  bool Finalized = false;
+  (*Alloc)->finalizeAsync([&](Error Err) {
+    EXPECT_THAT_ERROR(std::move(Err), Succeeded());
+    Finalized = true;
+  });
+  ASSERT_TRUE(Finalized);
+
+  // The content written to the working memory is visible at the target
+  // addresses without having been copied, and the zero-fill is zeroed.
+  const char *Target = jitTargetAddressToPointer<const char *>(DataAddr);
+  EXPECT_EQ(StringRef(Target, 16), "0123456789abcdef");
+  EXPECT_TRUE(std::all_of(Target + 16, Target + 16 + 4096,
+                          [](char C) { return C == 0; }));
+  EXPECT_EQ(StringRef(jitTargetAddressToPointer<const char *>(ConstAddr), 5),
+            "const");
+
+  EXPECT_THAT_ERROR((*Alloc)->deallocate(), Succeeded());
+}
+
+TEST(SharedMemoryManagerTest, RejectsOverAlignedSegments) {
+  JITLinkMemoryManager::SegmentsRequestMap Request;
+  Request[sys::Memory::MF_READ] = {1 << 30, 8, 0};
+
+  SharedMemoryManager MemMgr;
+  EXPECT_THAT_EXPECTED(MemMgr.allocate(Request), Failed());
+}
+
+#endif
+
+} // namespace
@@ -0,0 +1,102 @@
+//===-------- SlabMemoryManagerTest.cpp - SlabMemoryManager tests ---------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/ExecutionEngine/JITLink/JITLinkMemoryManager.h"
+#include "llvm/Config/llvm-config.h"
+#include "llvm/Support/Process.h"
+#include "llvm/Testing/Support/Error.h"
+
+#include "gtest/gtest.h"
+
+using namespace llvm;
+using namespace llvm::jitlink;
+
+namespace {
+
+#ifdef LLVM_ON_UNIX
+
+const auto RW = static_cast<sys::Memory::ProtectionFlags>(
+    sys::Memory::MF_READ | sys::Memory::MF_WRITE);
+const auto RO = sys::Memory::MF_READ;
+
+TEST(SlabMemoryManagerTest, PacksSmallAllocations) {
+  JITLinkMemoryManager::SegmentsRequestMap Request;
+  Request[RO] = {16, 5, 0};
+
+  SlabMemoryManager MemMgr;
+  auto A = MemMgr.allocate(Request);
+  ASSERT_THAT_EXPECTED(A, Succeeded());
+  auto B = MemMgr.allocate(Request);
+  ASSERT_THAT_EXPECTED(B, Succeeded());
+
+  memcpy((*A)->getWorkingMemory(RO).data(), "aaaaa", 5);
+  memcpy((*B)->getWorkingMemory(RO).data(), "bbbbb", 5);
+  (*A)->finalizeAsync(
+      [](Error Err) { EXPECT_THAT_ERROR(std::move(Err), Succeeded()); });
+  (*B)->finalizeAsync(
+      [](Error Err) { EXPECT_THAT_ERROR(std::move(Err), Succeeded()); });
+
+  // Both allocations live in the same slab, at their requested alignment.
+  EXPECT_EQ(MemMgr.getNumSlabs(), 1U);
+  JITTargetAddress AAddr = (*A)->getTargetMemory(RO);
+  JITTargetAddress BAddr = (*B)->getTargetMemory(RO);
+  EXPECT_EQ(AAddr % 16, 0U);
+  EXPECT_EQ(BAddr % 16, 0U);
+  EXPECT_EQ(BAddr - AAddr, 16U);
+  EXPECT_EQ(StringRef(jitTargetAddressToPointer<const char *>(AAddr), 5),
+            "aaaaa");
+  EXPECT_EQ(StringRef(jitTargetAddressToPointer<const char *>(BAddr), 5),
+            "bbbbb");
+
+  EXPECT_THAT_ERROR((*A)->deallocate(), Succeeded());
+  EXPECT_THAT_ERROR((*B)->deallocate(), Succeeded());
+}
+
+TEST(SlabMemoryManagerTest, ReusesAndZeroesDeallocatedRanges) {
+  JITLinkMemoryManager::SegmentsRequestMap Request;
+  Request[RW] = {8, 8, 8};
+
+  SlabMemoryManager MemMgr;
+  auto A = MemMgr.allocate(Request);
+  ASSERT_THAT_EXPECTED(A, Succeeded());
+  JITTargetAddress AAddr = (*A)->getTargetMemory(RW);
+  memset((*A)->getWorkingMemory(RW).data(), 0xff, 16);
+  EXPECT_THAT_ERROR((*A)->deallocate(), Succeeded());
+
+  auto B = MemMgr.allocate(Request);
+  ASSERT_THAT_EXPECTED(B, Succeeded());
+  EXPECT_EQ((*B)->getTargetMemory(RW), AAddr);
+  auto Data = (*B)->getWorkingMemory(RW);
+  EXPECT_TRUE(std::all_of(Data.begin(), Data.begin() + 16,
+                          [](char C) { return C == 0; }));
+  EXPECT_THAT_ERROR((*B)->deallocate(), Succeeded());
+}
+
+TEST(SlabMemoryManagerTest, UnmapsEmptySlabs) {
+  uint64_t PageSize = sys::Process::getPageSizeEstimate();
+  JITLinkMemoryManager::SegmentsRequestMap Request;
+  Request[RO] = {8, PageSize, 0};
+
+  // Each allocation fills a slab.
+  SlabMemoryManager MemMgr(PageSize);
+  auto A = MemMgr.allocate(Request);
+  ASSERT_THAT_EXPECTED(A, Succeeded());
+  auto B = MemMgr.allocate(Request);
+  ASSERT_THAT_EXPECTED(B, Succeeded());
+  EXPECT_EQ(MemMgr.getNumSlabs(), 2U);
+
+  // The last slab of each protection is kept.
+  EXPECT_THAT_ERROR((*A)->deallocate(), Succeeded());
+  EXPECT_EQ(MemMgr.getNumSlabs(), 1U);
+  EXPECT_THAT_ERROR((*B)->deallocate(), Succeeded());
+  EXPECT_EQ(MemMgr.getNumSlabs(), 1U);
+}
+
+#endif
+
+} // namespace
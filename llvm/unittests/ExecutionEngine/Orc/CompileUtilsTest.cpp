@@ -0,0 +1,50 @@
+//===------ CompileUtilsTest.cpp - Unit tests for ORC compile utils -------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/ExecutionEngine/Orc/CompileUtils.h"
+#include "OrcTestCommon.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Support/MemoryBuffer.h"
+
+using namespace llvm;
+using namespace llvm::orc;
+
+namespace {
+
+TEST(CompileUtilsTest, ConcurrentIRCompilerReusesTargetMachines) {
+  // Make sure LLVM has been initialized.
+  OrcNativeTarget::initialize();
+
+  auto JTMB = JITTargetMachineBuilder::detectHost();
+  if (!JTMB) {
+    consumeError(JTMB.takeError());
+    return;
+  }
+
+  // Bail out if the host target can not be built.
+  if (auto TM = JTMB->createTargetMachine())
+    (void)TM;
+  else {
+    consumeError(TM.takeError());
+    return;
+  }
+
+  ConcurrentIRCompiler Compile(std::move(*JTMB));
+  auto CopyOfCompile = Compile;
+
+  LLVMContext Ctx;
+  for (unsigned I = 0; I != 3; ++I) {
+    Module M("M" + std::to_string(I), Ctx);
+    EXPECT_NE(CopyOfCompile(M), nullptr) << "Compile failed";
+  }
+
+  EXPECT_EQ(Compile.getNumTargetMachinesCreated(), 1U)
+      << "Sequential compiles should share one TargetMachine";
+}
+
+} // namespace
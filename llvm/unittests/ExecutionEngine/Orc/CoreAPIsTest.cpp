@@ -12,6 +12,7 @@
 #include "llvm/ExecutionEngine/Orc/OrcError.h"
 #include "llvm/Testing/Support/Error.h"
 
+#include <atomic>
 #include <set>
 #include <thread>
 
@@ -1119,6 +1120,50 @@ TEST_F(CoreAPIsStandardTest, TestLookupWithThreadedMaterialization) {
 #endif
 }
 
+TEST_F(CoreAPIsStandardTest, ReadySymbolsDoNotHideEarlierDefinitions) {
+  // Make JD2's Foo ready first, while JD's Foo is still unmaterialized.
+  cantFail(JD.define(absoluteSymbols({{Foo, FooSym}})));
+  auto &JD2 = ES.createJITDylib("JD2");
+  cantFail(JD2.define(absoluteSymbols({{Foo, BarSym}})));
+  EXPECT_EQ(cantFail(ES.lookup(JITDylibSearchList({{&JD2, false}}), Foo))
+                .getAddress(),
+            BarSym.getAddress());
+
+  auto Result = cantFail(
+      ES.lookup(JITDylibSearchList({{&JD, false}, {&JD2, false}}), Foo));
+  EXPECT_EQ(Result.getAddress(), FooSym.getAddress())
+      << "Lookup skipped the definition that was not ready";
+
+  // Removed symbols are not found anymore.
+  cantFail(JD.remove({Foo}));
+  EXPECT_THAT_EXPECTED(ES.lookup(JITDylibSearchList({{&JD, false}}), Foo),
+                       Failed());
+}
+
+TEST_F(CoreAPIsStandardTest, ConcurrentLookupsOfReadySymbols) {
+#if LLVM_ENABLE_THREADS
+  cantFail(JD.define(absoluteSymbols({{Foo, FooSym}, {Bar, BarSym}})));
+  cantFail(ES.lookup(JITDylibSearchList({{&JD, false}}), {Foo, Bar}));
+
+  std::vector<std::thread> Threads;
+  std::atomic<unsigned> Mismatches(0);
+  for (unsigned I = 0; I != 4; ++I)
+    Threads.push_back(std::thread([&]() {
+      for (unsigned J = 0; J != 100; ++J) {
+        auto Result = cantFail(
+            ES.lookup(JITDylibSearchList({{&JD, false}}), {Foo, Bar}));
+        if (Result[Foo].getAddress() != FooAddr ||
+            Result[Bar].getAddress() != BarAddr)
+          ++Mismatches;
+      }
+    }));
+  for (auto &T : Threads)
+    T.join();
+
+  EXPECT_EQ(Mismatches, 0U) << "Concurrent lookups returned wrong addresses";
+#endif
+}
+
 TEST_F(CoreAPIsStandardTest, TestGetRequestedSymbolsAndReplace) {
   // Test that GetRequestedSymbols returns the set of symbols that currently
   // have pending queries, and test that MaterializationResponsibility's
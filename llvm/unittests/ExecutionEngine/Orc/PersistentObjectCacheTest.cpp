@@ -0,0 +1,101 @@
+//===- PersistentObjectCacheTest.cpp - PersistentObjectCache tests --------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/ExecutionEngine/Orc/PersistentObjectCache.h"
+#include "llvm/ExecutionEngine/Orc/JITTargetMachineBuilder.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Testing/Support/Error.h"
+#include "gtest/gtest.h"
+
+using namespace llvm;
+using namespace llvm::orc;
+
+namespace {
+
+class PersistentObjectCacheTest : public testing::Test {
+protected:
+  void SetUp() override {
+    ASSERT_FALSE(
+        sys::fs::createUniqueDirectory("orc-object-cache", CacheDir));
+  }
+
+  void TearDown() override { sys::fs::remove_directories(CacheDir); }
+
+  std::unique_ptr<PersistentObjectCache>
+  createCache(const JITTargetMachineBuilder &JTMB) {
+    auto Cache = PersistentObjectCache::Create(CacheDir, JTMB);
+    EXPECT_THAT_EXPECTED(Cache, Succeeded());
+    return Cache ? std::move(*Cache) : nullptr;
+  }
+
+  SmallString<128> CacheDir;
+  LLVMContext Ctx;
+};
+
+TEST_F(PersistentObjectCacheTest, ReusesObjectsAcrossInstances) {
+  JITTargetMachineBuilder JTMB(Triple("x86_64-unknown-linux-gnu"));
+  Module M("M", Ctx);
+  M.getOrInsertGlobal("G", Type::getInt32Ty(Ctx));
+
+  auto Cache = createCache(JTMB);
+  ASSERT_TRUE(Cache);
+  EXPECT_EQ(Cache->getObject(&M), nullptr);
+  Cache->notifyObjectCompiled(&M, MemoryBufferRef("object", "M"));
+
+  // The object is found by a new cache, as in a later run of the process.
+  auto NewCache = createCache(JTMB);
+  ASSERT_TRUE(NewCache);
+  auto Obj = NewCache->getObject(&M);
+  ASSERT_NE(Obj, nullptr);
+  EXPECT_EQ(Obj->getBuffer(), "object");
+
+  // A different module is a miss.
+  Module Other("Other", Ctx);
+  EXPECT_EQ(NewCache->getObject(&Other), nullptr);
+}
+
+TEST_F(PersistentObjectCacheTest, KeysIncludeTargetOptions) {
+  JITTargetMachineBuilder JTMB(Triple("x86_64-unknown-linux-gnu"));
+  Module M("M", Ctx);
+
+  auto Cache = createCache(JTMB);
+  ASSERT_TRUE(Cache);
+  EXPECT_EQ(Cache->getObject(&M), nullptr);
+  Cache->notifyObjectCompiled(&M, MemoryBufferRef("object", "M"));
+
+  JTMB.setCodeGenOptLevel(CodeGenOpt::Aggressive);
+  auto OptCache = createCache(JTMB);
+  ASSERT_TRUE(OptCache);
+  EXPECT_EQ(OptCache->getObject(&M), nullptr);
+
+  JITTargetMachineBuilder OtherJTMB(Triple("aarch64-unknown-linux-gnu"));
+  auto OtherCache = createCache(OtherJTMB);
+  ASSERT_TRUE(OtherCache);
+  EXPECT_EQ(OtherCache->getObject(&M), nullptr);
+}
+
+TEST_F(PersistentObjectCacheTest, UsesKeyComputedBeforeCompiling) {
+  JITTargetMachineBuilder JTMB(Triple("x86_64-unknown-linux-gnu"));
+  Module M("M", Ctx);
+
+  auto Cache = createCache(JTMB);
+  ASSERT_TRUE(Cache);
+  EXPECT_EQ(Cache->getObject(&M), nullptr);
+  // Code generation may change the module before the object is added.
+  M.getOrInsertGlobal("AddedByCodeGen", Type::getInt32Ty(Ctx));
+  Cache->notifyObjectCompiled(&M, MemoryBufferRef("object", "M"));
+  M.getGlobalVariable("AddedByCodeGen")->eraseFromParent();
+
+  auto NewCache = createCache(JTMB);
+  ASSERT_TRUE(NewCache);
+  EXPECT_NE(NewCache->getObject(&M), nullptr);
+}
+
+} // namespace
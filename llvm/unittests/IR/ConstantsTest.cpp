@@ -583,5 +583,24 @@ TEST(ConstantsTest, FoldGlobalVariablePtr) {
       Instruction::And, TheConstantExpr, TheConstant)->isNullValue());
 }
 
+TEST(ConstantsTest, DropTriviallyDeadConstantArrays) {
+  LLVMContext Context;
+  Module M("M", Context);
+
+  Type *Int32Ty = Type::getInt32Ty(Context);
+  auto *G = new GlobalVariable(M, Int32Ty, false, GlobalValue::ExternalLinkage,
+                               nullptr, "g");
+
+  // Only the outer array is dead at first. Dropping it makes the inner array,
+  // which is the only user of @g, dead as well.
+  ArrayType *InnerTy = ArrayType::get(G->getType(), 1);
+  Constant *Inner = ConstantArray::get(InnerTy, {G});
+  ConstantArray::get(ArrayType::get(InnerTy, 2), {Inner, Inner});
+  EXPECT_FALSE(G->use_empty());
+
+  M.dropTriviallyDeadConstantArrays();
+  EXPECT_TRUE(G->use_empty());
+}
+
 }  // end anonymous namespace
 }  // end namespace llvm
@@ -0,0 +1,132 @@
+//===- unittests/IR/PassProfileTest.cpp - PassProfileInstrumentation tests ===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Passes/StandardInstrumentations.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/IR/IRBuilder.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/Module.h"
+#include "llvm/IR/PassInstrumentation.h"
+#include "llvm/IR/PassManager.h"
+#include "llvm/Support/JSON.h"
+#include "llvm/Support/raw_ostream.h"
+#include "gtest/gtest.h"
+
+using namespace llvm;
+
+namespace {
+
+class OuterPass : public PassInfoMixin<OuterPass> {};
+class InnerPass : public PassInfoMixin<InnerPass> {};
+
+// Pass names are qualified with their namespace, look for the class name.
+const json::Object *findPass(const json::Array &Passes, StringRef Name) {
+  for (const json::Value &V : Passes) {
+    const json::Object *O = V.getAsObject();
+    Optional<StringRef> PassName = O ? O->getString("pass") : None;
+    if (PassName && PassName->endswith(Name))
+      return O;
+  }
+  return nullptr;
+}
+
+TEST(PassProfileTest, Totals) {
+  PassInstrumentationCallbacks PIC;
+  PassInstrumentation PI(&PIC);
+
+  LLVMContext Context;
+  Module M("TestModule", Context);
+  Function *F = Function::Create(
+      FunctionType::get(Type::getVoidTy(Context), false),
+      GlobalValue::ExternalLinkage, "f", M);
+  BasicBlock *BB = BasicBlock::Create(Context, "entry", F);
+  OuterPass Outer;
+  InnerPass Inner;
+
+  SmallString<0> ProfileStr;
+  raw_svector_ostream ProfileStream(ProfileStr);
+  auto Profile = std::make_unique<PassProfileInstrumentation>();
+  Profile->setOutStream(ProfileStream);
+  Profile->registerCallbacks(PIC);
+
+  // The inner pass adds an instruction, which the outer pass doesn't count.
+  PI.runBeforePass(Outer, M);
+  PI.runBeforePass(Inner, *F);
+  ReturnInst::Create(Context, BB);
+  PI.runAfterPass(Inner, *F);
+  PI.runAfterPass(Outer, M);
+  PI.runBeforePass(Inner, *F);
+  PI.runAfterPass(Inner, *F);
+  Profile->print();
+
+  Expected<json::Value> Parsed = json::parse(ProfileStr);
+  ASSERT_TRUE(bool(Parsed));
+  const json::Object *Root = Parsed->getAsObject();
+  ASSERT_NE(nullptr, Root);
+  const json::Array *Passes = Root->getArray("passes");
+  ASSERT_NE(nullptr, Passes);
+  ASSERT_NE(nullptr, Root->getArray("runs"));
+  EXPECT_EQ(2u, Passes->size());
+
+  const json::Object *OuterTotals = findPass(*Passes, "OuterPass");
+  ASSERT_NE(nullptr, OuterTotals);
+  EXPECT_EQ(1, *OuterTotals->getInteger("count"));
+  EXPECT_EQ(0, *OuterTotals->getInteger("inst_delta"));
+
+  const json::Object *InnerTotals = findPass(*Passes, "InnerPass");
+  ASSERT_NE(nullptr, InnerTotals);
+  EXPECT_EQ(2, *InnerTotals->getInteger("count"));
+  EXPECT_EQ(1, *InnerTotals->getInteger("inst_delta"));
+
+  // The profile was reset by printing it.
+  ProfileStr.clear();
+  Profile->print();
+  EXPECT_TRUE(ProfileStr.empty());
+
+  // An invalidated IR unit is reported as removing all of its instructions.
+  PI.runBeforePass(Inner, *F);
+  PI.runAfterPassInvalidated<Function>(Inner);
+  Profile.reset();
+
+  Parsed = json::parse(ProfileStr);
+  ASSERT_TRUE(bool(Parsed));
+  Passes = Parsed->getAsObject()->getArray("passes");
+  ASSERT_NE(nullptr, Passes);
+  InnerTotals = findPass(*Passes, "InnerPass");
+  ASSERT_NE(nullptr, InnerTotals);
+  EXPECT_EQ(1, *InnerTotals->getInteger("count"));
+  EXPECT_EQ(-1, *InnerTotals->getInteger("inst_delta"));
+}
+
+// Pass managers and adaptors are not profiled, only the passes they run.
+TEST(PassProfileTest, SkipsPassManagers) {
+  PassInstrumentationCallbacks PIC;
+  PassInstrumentation PI(&PIC);
+
+  LLVMContext Context;
+  Module M("TestModule", Context);
+  ModulePassManager MPM;
+  InnerPass Inner;
+
+  SmallString<0> ProfileStr;
+  raw_svector_ostream ProfileStream(ProfileStr);
+  PassProfileInstrumentation Profile;
+  Profile.setOutStream(ProfileStream);
+  Profile.registerCallbacks(PIC);
+
+  PI.runBeforePass(MPM, M);
+  PI.runBeforePass(Inner, M);
+  PI.runAfterPass(Inner, M);
+  PI.runAfterPass(MPM, M);
+  Profile.print();
+
+  EXPECT_TRUE(StringRef(ProfileStr).contains("InnerPass"));
+  EXPECT_FALSE(StringRef(ProfileStr).contains("PassManager"));
+}
+
+} // end anonymous namespace
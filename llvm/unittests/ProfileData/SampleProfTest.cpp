@@ -57,11 +57,14 @@ struct SampleProfTest : ::testing::Test {
     Reader->collectFuncsFrom(M);
   }
 
-  void testRoundTrip(SampleProfileFormat Format, bool Remap) {
+  void testRoundTrip(SampleProfileFormat Format, bool Remap,
+                     bool UseMD5 = false) {
     SmallVector<char, 128> ProfilePath;
     ASSERT_TRUE(NoError(llvm::sys::fs::createTemporaryFile("profile", "", ProfilePath)));
     StringRef Profile(ProfilePath.data(), ProfilePath.size());
     createWriter(Format, Profile);
+    if (UseMD5)
+      static_cast<SampleProfileWriterExtBinary *>(Writer.get())->setUseMD5();
 
     StringRef FooName("_Z3fooi");
     FunctionSamples FooSamples;
@@ -147,7 +150,7 @@ struct SampleProfTest : ::testing::Test {
 
     FunctionSamples *ReadFooSamples = Reader->getSamplesFor(FooName);
     ASSERT_TRUE(ReadFooSamples != nullptr);
-    if (Format != SampleProfileFormat::SPF_Compact_Binary) {
+    if (!Reader->useMD5()) {
       ASSERT_EQ("_Z3fooi", ReadFooSamples->getName());
     }
     ASSERT_EQ(7711u, ReadFooSamples->getTotalSamples());
@@ -155,7 +158,7 @@ struct SampleProfTest : ::testing::Test {
 
     FunctionSamples *ReadBarSamples = Reader->getSamplesFor(BarName);
     ASSERT_TRUE(ReadBarSamples != nullptr);
-    if (Format != SampleProfileFormat::SPF_Compact_Binary) {
+    if (!Reader->useMD5()) {
       ASSERT_EQ("_Z3bari", ReadBarSamples->getName());
     }
     ASSERT_EQ(20301u, ReadBarSamples->getTotalSamples());
@@ -180,10 +183,10 @@ struct SampleProfTest : ::testing::Test {
 
     std::string MconstructGUID;
     StringRef MconstructRep =
-        getRepInFormat(MconstructName, Format, MconstructGUID);
+        getRepInFormat(MconstructName, Reader->useMD5(), MconstructGUID);
     std::string StringviewGUID;
     StringRef StringviewRep =
-        getRepInFormat(StringviewName, Format, StringviewGUID);
+        getRepInFormat(StringviewName, Reader->useMD5(), StringviewGUID);
     ASSERT_EQ(1000u, CTMap.get()[MconstructRep]);
     ASSERT_EQ(437u, CTMap.get()[StringviewRep]);
 
@@ -234,6 +237,77 @@ struct SampleProfTest : ::testing::Test {
     delete PS;
   }
 
+  void testContextRoundTrip(SampleProfileFormat Format) {
+    SmallVector<char, 128> ProfilePath;
+    ASSERT_TRUE(NoError(llvm::sys::fs::createTemporaryFile("profile", "", ProfilePath)));
+    StringRef Profile(ProfilePath.data(), ProfilePath.size());
+    createWriter(Format, Profile);
+
+    StringRef BarContext("[main:3 @ _Z3fooi:2.1 @ _Z3bari]");
+    FunctionSamples BarSamples;
+    BarSamples.setContext(SampleContext(BarContext));
+    BarSamples.addTotalSamples(100);
+    BarSamples.addHeadSamples(10);
+    BarSamples.addBodySamples(1, 0, 90);
+
+    StringRef FooContext("[_Z3fooi]");
+    FunctionSamples FooSamples;
+    FooSamples.setContext(SampleContext(FooContext));
+    FooSamples.addTotalSamples(50);
+    FooSamples.addBodySamples(2, 1, 50);
+
+    Module M("my_module", Context);
+    FunctionType *fn_type =
+        FunctionType::get(Type::getVoidTy(Context), {}, false);
+    M.getOrInsertFunction("_Z3bari", fn_type);
+    M.getOrInsertFunction("_Z3fooi", fn_type);
+
+    StringMap<FunctionSamples> Profiles;
+    Profiles[BarContext] = std::move(BarSamples);
+    Profiles[FooContext] = std::move(FooSamples);
+
+    std::error_code EC;
+    EC = Writer->write(Profiles);
+    ASSERT_TRUE(NoError(EC));
+
+    Writer->getOutputStream().flush();
+
+    readProfile(M, Profile);
+
+    EC = Reader->read();
+    ASSERT_TRUE(NoError(EC));
+    ASSERT_TRUE(FunctionSamples::ProfileIsCS);
+
+    FunctionSamples *ReadBarSamples = Reader->getSamplesFor(BarContext);
+    ASSERT_TRUE(ReadBarSamples != nullptr);
+    ASSERT_EQ("_Z3bari", ReadBarSamples->getName());
+    ASSERT_EQ(100u, ReadBarSamples->getTotalSamples());
+    ASSERT_EQ(10u, ReadBarSamples->getHeadSamples());
+    ASSERT_EQ(90u, ReadBarSamples->findSamplesAt(1, 0).get());
+
+    const SampleContext &ReadBarContext = ReadBarSamples->getContext();
+    ASSERT_TRUE(ReadBarContext.hasContext());
+    ASSERT_EQ(BarContext, ReadBarContext.getNameWithContext());
+    ASSERT_EQ("main:3 @ _Z3fooi:2.1", ReadBarContext.getCallingContext());
+
+    SmallVector<SampleContext::ContextFrame, 2> Callers;
+    ASSERT_TRUE(SampleContext::decodeContextString(
+        ReadBarContext.getCallingContext(), Callers));
+    ASSERT_EQ(2u, Callers.size());
+    ASSERT_EQ("main", Callers[0].first);
+    ASSERT_EQ(3u, Callers[0].second.LineOffset);
+    ASSERT_EQ(0u, Callers[0].second.Discriminator);
+    ASSERT_EQ("_Z3fooi", Callers[1].first);
+    ASSERT_EQ(2u, Callers[1].second.LineOffset);
+    ASSERT_EQ(1u, Callers[1].second.Discriminator);
+
+    FunctionSamples *ReadFooSamples = Reader->getSamplesFor(FooContext);
+    ASSERT_TRUE(ReadFooSamples != nullptr);
+    ASSERT_EQ("_Z3fooi", ReadFooSamples->getName());
+    ASSERT_FALSE(ReadFooSamples->getContext().hasContext());
+    ASSERT_EQ(50u, ReadFooSamples->findSamplesAt(2, 1).get());
+  }
+
   void addFunctionSamples(StringMap<FunctionSamples> *Smap, const char *Fname,
                           uint64_t TotalSamples, uint64_t HeadSamples) {
     StringRef Name(Fname);
@@ -323,6 +397,10 @@ TEST_F(SampleProfTest, roundtrip_ext_binary_profile) {
   testRoundTrip(SampleProfileFormat::SPF_Ext_Binary, false);
 }
 
+TEST_F(SampleProfTest, roundtrip_md5_ext_binary_profile) {
+  testRoundTrip(SampleProfileFormat::SPF_Ext_Binary, false, true);
+}
+
 TEST_F(SampleProfTest, remap_text_profile) {
   testRoundTrip(SampleProfileFormat::SPF_Text, true);
 }
@@ -335,6 +413,18 @@ TEST_F(SampleProfTest, remap_ext_binary_profile) {
   testRoundTrip(SampleProfileFormat::SPF_Ext_Binary, true);
 }
 
+TEST_F(SampleProfTest, roundtrip_context_text_profile) {
+  testContextRoundTrip(SampleProfileFormat::SPF_Text);
+}
+
+TEST_F(SampleProfTest, roundtrip_context_raw_binary_profile) {
+  testContextRoundTrip(SampleProfileFormat::SPF_Binary);
+}
+
+TEST_F(SampleProfTest, roundtrip_context_ext_binary_profile) {
+  testContextRoundTrip(SampleProfileFormat::SPF_Ext_Binary);
+}
+
 TEST_F(SampleProfTest, sample_overflow_saturation) {
   const uint64_t Max = std::numeric_limits<uint64_t>::max();
   sampleprof_error Result;
@@ -7,8 +7,13 @@
 //===----------------------------------------------------------------------===//
 
 #include "llvm/Support/Allocator.h"
+#include "llvm/Config/llvm-config.h"
+#include "llvm/Support/ThreadLocalAllocator.h"
 #include "gtest/gtest.h"
 #include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
 
 using namespace llvm;
 
@@ -184,4 +189,62 @@ TEST(AllocatorTest, TestBigAlignment) {
   EXPECT_GT(MockSlabAllocator::GetLastSlabSize(), 4096u);
 }
 
+TEST(AllocatorTest, HugePageSlabs) {
+  HugePageBumpPtrAllocator Alloc;
+  char *A = Alloc.Allocate<char>(100);
+  memset(A, 1, 100);
+  // In the same slab, whether or not the system gave huge pages.
+  char *B = Alloc.Allocate<char>(1024 * 1024);
+  memset(B, 2, 1024 * 1024);
+  EXPECT_EQ(1U, Alloc.GetNumSlabs());
+  EXPECT_EQ(HugePageSlabAllocator::HugePageSize, Alloc.getTotalMemory());
+
+  // Allocations larger than a slab get their own.
+  char *C = Alloc.Allocate<char>(3 * 1024 * 1024);
+  memset(C, 3, 3 * 1024 * 1024);
+  EXPECT_EQ(2U, Alloc.GetNumSlabs());
+  EXPECT_EQ(1, A[99]);
+  EXPECT_EQ(2, B[0]);
+
+  Alloc.Reset();
+  EXPECT_EQ(1U, Alloc.GetNumSlabs());
+}
+
+TEST(AllocatorTest, ThreadLocal) {
+  ThreadLocalBumpPtrAllocator Alloc;
+  int *A = Alloc.Allocate<int>();
+  *A = 1;
+  EXPECT_EQ(&Alloc.getThreadArena(), &Alloc.getThreadArena());
+
+  // Allocating from another allocator doesn't lose the arena of this one.
+  ThreadLocalBumpPtrAllocator Other;
+  BumpPtrAllocator *Arena = &Alloc.getThreadArena();
+  Other.Allocate<int>();
+  EXPECT_EQ(Arena, &Alloc.getThreadArena());
+  EXPECT_NE(Arena, &Other.getThreadArena());
+
+#if LLVM_ENABLE_THREADS
+  const unsigned NumThreads = 4, NumAllocs = 1000;
+  std::vector<BumpPtrAllocator *> Arenas(NumThreads);
+  std::vector<std::thread> Threads;
+  for (unsigned T = 0; T != NumThreads; ++T)
+    Threads.emplace_back([&, T] {
+      for (unsigned I = 0; I != NumAllocs; ++I)
+        *Alloc.Allocate<unsigned>() = I;
+      Arenas[T] = &Alloc.getThreadArena();
+    });
+  for (std::thread &T : Threads)
+    T.join();
+
+  for (unsigned T = 0; T != NumThreads; ++T) {
+    EXPECT_NE(Arena, Arenas[T]);
+    for (unsigned U = 0; U != T; ++U)
+      EXPECT_NE(Arenas[U], Arenas[T]);
+  }
+  EXPECT_EQ((NumThreads * NumAllocs + 1) * sizeof(int),
+            Alloc.getBytesAllocated());
+#endif
+  EXPECT_EQ(1, *A);
+}
+
 }  // anonymous namespace
@@ -118,7 +118,117 @@ TEST(FileOutputBuffer, Test) {
   EXPECT_TRUE(IsExecutable);
   ASSERT_NO_ERROR(fs::remove(File4.str()));
 
+  // TEST 5: Verify a file can be modified in place.
+  SmallString<128> File5(TestDirectory);
+  File5.append("/file5");
+  {
+    Expected<std::unique_ptr<FileOutputBuffer>> BufferOrErr =
+        FileOutputBuffer::create(File5, 8192);
+    ASSERT_NO_ERROR(errorToErrorCode(BufferOrErr.takeError()));
+    std::unique_ptr<FileOutputBuffer> &Buffer = *BufferOrErr;
+    memcpy(Buffer->getBufferStart(), "AABBCCDDEEFFGGHHIIJJ", 20);
+    memcpy(Buffer->getBufferEnd() - 20, "AABBCCDDEEFFGGHHIIJJ", 20);
+    ASSERT_NO_ERROR(errorToErrorCode(Buffer->commit()));
+  }
+  {
+    Expected<std::unique_ptr<FileOutputBuffer>> BufferOrErr =
+        FileOutputBuffer::create(File5, 8192, FileOutputBuffer::F_modify);
+    ASSERT_NO_ERROR(errorToErrorCode(BufferOrErr.takeError()));
+    std::unique_ptr<FileOutputBuffer> &Buffer = *BufferOrErr;
+    // The existing contents are preserved.
+    ASSERT_EQ(0, memcmp(Buffer->getBufferStart(), "AABBCCDDEEFFGGHHIIJJ", 20));
+    memcpy(Buffer->getBufferStart(), "KKLL", 4);
+    ASSERT_NO_ERROR(errorToErrorCode(Buffer->commit()));
+  }
+  {
+    ErrorOr<std::unique_ptr<MemoryBuffer>> BufferOrErr =
+        MemoryBuffer::getFile(File5);
+    ASSERT_NO_ERROR(BufferOrErr.getError());
+    MemoryBuffer &Buffer = **BufferOrErr;
+    ASSERT_EQ(8192U, Buffer.getBufferSize());
+    ASSERT_EQ(0, memcmp(Buffer.getBufferStart(), "KKLLCCDDEEFFGGHHIIJJ", 20));
+    ASSERT_EQ(0,
+              memcmp(Buffer.getBufferEnd() - 20, "AABBCCDDEEFFGGHHIIJJ", 20));
+  }
+  ASSERT_NO_ERROR(fs::remove(File5.str()));
+
   // Clean up.
   ASSERT_NO_ERROR(fs::remove(TestDirectory.str()));
 }
+
+TEST(FileOutputBuffer, Resize) {
+  SmallString<128> TestDirectory;
+  ASSERT_NO_ERROR(
+      fs::createUniqueDirectory("FileOutputBuffer-resize", TestDirectory));
+  SmallString<128> File(TestDirectory);
+  File.append("/file");
+  {
+    Expected<std::unique_ptr<FileOutputBuffer>> BufferOrErr =
+        FileOutputBuffer::create(File, 100);
+    ASSERT_NO_ERROR(errorToErrorCode(BufferOrErr.takeError()));
+    std::unique_ptr<FileOutputBuffer> &Buffer = *BufferOrErr;
+    memcpy(Buffer->getBufferStart(), "AABBCCDDEEFFGGHHIIJJ", 20);
+    // Growing keeps the contents and zero fills the rest.
+    ASSERT_NO_ERROR(errorToErrorCode(Buffer->resize(100000)));
+    ASSERT_EQ(100000U, Buffer->getBufferSize());
+    ASSERT_EQ(0, memcmp(Buffer->getBufferStart(), "AABBCCDDEEFFGGHHIIJJ", 20));
+    ASSERT_EQ(0, Buffer->getBufferEnd()[-1]);
+    memcpy(Buffer->getBufferEnd() - 4, "KKLL", 4);
+    // Shrinking truncates the file.
+    ASSERT_NO_ERROR(errorToErrorCode(Buffer->resize(10)));
+    ASSERT_NO_ERROR(errorToErrorCode(Buffer->commit()));
+  }
+  {
+    ErrorOr<std::unique_ptr<MemoryBuffer>> BufferOrErr =
+        MemoryBuffer::getFile(File);
+    ASSERT_NO_ERROR(BufferOrErr.getError());
+    ASSERT_EQ("AABBCCDDEE", (*BufferOrErr)->getBuffer());
+  }
+  ASSERT_NO_ERROR(fs::remove(File.str()));
+  ASSERT_NO_ERROR(fs::remove(TestDirectory.str()));
+}
+
+TEST(FileOutputBuffer, MappedStream) {
+  SmallString<128> TestDirectory;
+  ASSERT_NO_ERROR(
+      fs::createUniqueDirectory("FileOutputBuffer-stream", TestDirectory));
+  SmallString<128> File(TestDirectory);
+  File.append("/file");
+
+  // Write far more than the initial size, then patch the header.
+  std::string Contents;
+  {
+    Expected<std::unique_ptr<raw_mapped_ostream>> OSOrErr =
+        raw_mapped_ostream::create(File, /*InitialSize=*/16);
+    ASSERT_NO_ERROR(errorToErrorCode(OSOrErr.takeError()));
+    raw_mapped_ostream &OS = **OSOrErr;
+    OS << "HDR0";
+    Contents = "HDR1";
+    for (unsigned I = 0; I != 10000; ++I) {
+      OS << I << ',';
+      Contents += std::to_string(I) + ',';
+    }
+    EXPECT_EQ(Contents.size(), OS.tell());
+    OS.pwrite("HDR1", 4, 0);
+    EXPECT_EQ(Contents, OS.getContents());
+    ASSERT_NO_ERROR(errorToErrorCode(OS.commit()));
+  }
+  {
+    ErrorOr<std::unique_ptr<MemoryBuffer>> BufferOrErr =
+        MemoryBuffer::getFile(File);
+    ASSERT_NO_ERROR(BufferOrErr.getError());
+    ASSERT_EQ(Contents, (*BufferOrErr)->getBuffer());
+  }
+
+  // Without commit(), the output is not written.
+  ASSERT_NO_ERROR(fs::remove(File.str()));
+  {
+    Expected<std::unique_ptr<raw_mapped_ostream>> OSOrErr =
+        raw_mapped_ostream::create(File);
+    ASSERT_NO_ERROR(errorToErrorCode(OSOrErr.takeError()));
+    **OSOrErr << "discarded";
+  }
+  ASSERT_FALSE(fs::exists(Twine(File)));
+  ASSERT_NO_ERROR(fs::remove(TestDirectory.str()));
+}
 } // anonymous namespace
@@ -49,4 +49,14 @@ TEST(Parallel, parallel_for) {
   ASSERT_EQ(range[2049], 1u);
 }
 
+TEST(Parallel, nested_parallel_for) {
+  // Nested groups run in parallel too, and the workers waiting for the inner
+  // ones run their tasks instead of blocking the outer ones.
+  std::atomic<uint32_t> sum{0};
+  for_each_n(parallel::par, 0, 64, [&sum](size_t I) {
+    for_each_n(parallel::par, 0, 2048, [&sum](size_t J) { sum += J; });
+  });
+  ASSERT_EQ(sum, 64u * (2047u * 2048u / 2));
+}
+
 #endif
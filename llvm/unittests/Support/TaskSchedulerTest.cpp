@@ -0,0 +1,78 @@
+//===- llvm/unittest/Support/TaskSchedulerTest.cpp ------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Support/TaskScheduler.h"
+#include "gtest/gtest.h"
+
+#include <future>
+
+using namespace llvm;
+
+#if LLVM_ENABLE_THREADS
+
+TEST(TaskScheduler, RunsTasks) {
+  std::atomic<int> Count{0};
+  std::promise<void> Done;
+  {
+    TaskScheduler Scheduler(3);
+    EXPECT_EQ(3u, Scheduler.getThreadCount());
+    EXPECT_EQ(nullptr, TaskScheduler::getCurrent());
+    for (int I = 0; I < 100; ++I)
+      Scheduler.spawn([&] {
+        if (++Count == 100)
+          Done.set_value();
+      });
+    Done.get_future().wait();
+  }
+  EXPECT_EQ(100, Count);
+}
+
+TEST(TaskScheduler, NestedTasks) {
+  // A worker runs the tasks it spawned when asked, unless they were stolen.
+  // With a single worker, there is no thief.
+  TaskScheduler Scheduler(1);
+  std::promise<int> Result;
+  Scheduler.spawn([&] {
+    EXPECT_EQ(&Scheduler, TaskScheduler::getCurrent());
+    EXPECT_EQ(&Scheduler, &TaskScheduler::getCurrentOrDefault());
+    int Ran = 0;
+    Scheduler.spawn([&] { Ran = 1; });
+    Scheduler.spawn([&] { Ran = Ran * 10 + 2; });
+    // Newest first.
+    EXPECT_TRUE(Scheduler.runOwnTask());
+    EXPECT_TRUE(Scheduler.runOwnTask());
+    EXPECT_FALSE(Scheduler.runOwnTask());
+    Result.set_value(Ran);
+  });
+  EXPECT_EQ(21, Result.get_future().get());
+  // Other threads have no deque of their own.
+  EXPECT_FALSE(Scheduler.runOwnTask());
+}
+
+TEST(TaskScheduler, Stealing) {
+  // A task blocked until a task it spawned has run: another worker must
+  // steal it.
+  TaskScheduler Scheduler(2);
+  std::promise<void> Done;
+  Scheduler.spawn([&] {
+    std::promise<void> Stolen;
+    Scheduler.spawn([&] { Stolen.set_value(); });
+    Stolen.get_future().wait();
+    Done.set_value();
+  });
+  Done.get_future().wait();
+}
+
+#endif
+
+TEST(TaskScheduler, ThreadLimit) {
+  setThreadLimit(3);
+  EXPECT_EQ(3u, getThreadLimit());
+  setThreadLimit(0);
+  EXPECT_LE(1u, getThreadLimit());
+}
@@ -12,6 +12,7 @@
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/Triple.h"
 #include "llvm/Support/Host.h"
+#include "llvm/Support/Parallel.h"
 #include "llvm/Support/TargetSelect.h"
 
 #include "gtest/gtest.h"
@@ -163,3 +164,21 @@ TEST_F(ThreadPoolTest, PoolDestruction) {
   }
   ASSERT_EQ(5, checked_in);
 }
+
+TEST_F(ThreadPoolTest, NestedParallelism) {
+  CHECK_UNSUPPORTED();
+  // The parallel algorithms run on the threads of the pool when used from a
+  // task, so a single thread can't deadlock waiting for them.
+  ThreadPool Pool(1);
+  std::atomic_int Sum{0};
+  Pool.async([&] {
+    TaskScheduler *Scheduler = TaskScheduler::getCurrent();
+    ASSERT_NE(nullptr, Scheduler);
+    parallel::for_each_n(parallel::par, 0, 2048, [&](int I) {
+      EXPECT_EQ(Scheduler, TaskScheduler::getCurrent());
+      Sum += I;
+    });
+  });
+  Pool.wait();
+  ASSERT_EQ(2047 * 2048 / 2, Sum);
+}
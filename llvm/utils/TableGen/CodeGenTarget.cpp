@@ -18,6 +18,7 @@
 #include "CodeGenIntrinsics.h"
 #include "CodeGenSchedule.h"
 #include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/ADT/StringExtras.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Timer.h"
@@ -478,6 +479,12 @@ void CodeGenTarget::reverseBitsForLittleEndianEncoding() {
   if (!isLittleEndianEncoding())
     return;
 
+  // The records are updated in place, and several backends may run on them
+  // (see -extra-output). Only reverse them once.
+  static SmallPtrSet<const RecordKeeper *, 1> ReversedRecords;
+  if (!ReversedRecords.insert(&Records).second)
+    return;
+
   std::vector<Record *> Insts =
       Records.getAllDerivedDefinitions("InstructionEncoding");
   for (Record *R : Insts) {
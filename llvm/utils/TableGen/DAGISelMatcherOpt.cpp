@@ -455,7 +455,36 @@ static void FactorNodes(std::unique_ptr<Matcher> &InputMatcherPtr) {
     }
     return;
   }
-  
+
+  // Otherwise, turn each run of opcode checks into a SwitchOpcode, so that
+  // the matcher jumps straight to the right case instead of trying each of
+  // them in turn. This is only valid while the opcodes in the run differ:
+  // when a case fails, the options after the run are tried next, which is
+  // what the scope did since no other option of the run could have matched.
+  SmallVector<Matcher*, 32> MergedOptions;
+  for (unsigned i = 0, e = NewOptionsToMatch.size(); i != e;) {
+    StringSet<> Opcodes;
+    unsigned RunEnd = i;
+    while (RunEnd != e && isa<CheckOpcodeMatcher>(NewOptionsToMatch[RunEnd]) &&
+           Opcodes.insert(cast<CheckOpcodeMatcher>(NewOptionsToMatch[RunEnd])
+                              ->getOpcode().getEnumName()).second)
+      ++RunEnd;
+
+    // Short runs are smaller and just as fast as a scope.
+    if (RunEnd - i < 3) {
+      MergedOptions.push_back(NewOptionsToMatch[i++]);
+      continue;
+    }
+
+    SmallVector<std::pair<const SDNodeInfo*, Matcher*>, 8> Cases;
+    for (; i != RunEnd; ++i) {
+      CheckOpcodeMatcher *COM = cast<CheckOpcodeMatcher>(NewOptionsToMatch[i]);
+      Cases.push_back(std::make_pair(&COM->getOpcode(), COM->takeNext()));
+      delete COM;
+    }
+    MergedOptions.push_back(new SwitchOpcodeMatcher(Cases));
+  }
+  NewOptionsToMatch.assign(MergedOptions.begin(), MergedOptions.end());
 
   // Reassemble the Scope node with the adjusted children.
   Scope->setNumChildren(NewOptionsToMatch.size());
@@ -134,13 +134,19 @@ cl::opt<std::string> Class("class", cl::desc("Print Enum list for this class"),
                            cl::value_desc("class name"),
                            cl::cat(PrintEnumsCat));
 
+cl::list<std::string> ExtraOutputs(
+    "extra-output",
+    cl::desc("Also perform <action> on the parsed records and write its output "
+             "to <file>"),
+    cl::value_desc("action=file"));
+
 cl::opt<bool, true>
     TimeRegionsOpt("time-regions",
                    cl::desc("Time regions of tablegens execution"),
                    cl::location(TimeRegions));
 
-bool LLVMTableGenMain(raw_ostream &OS, RecordKeeper &Records) {
-  switch (Action) {
+bool runAction(ActionType A, raw_ostream &OS, RecordKeeper &Records) {
+  switch (A) {
   case PrintRecords:
     OS << Records;           // No argument, dump all contents
     break;
@@ -259,6 +265,10 @@ bool LLVMTableGenMain(raw_ostream &OS, RecordKeeper &Records) {
 
   return false;
 }
+
+bool LLVMTableGenMain(raw_ostream &OS, RecordKeeper &Records) {
+  return runAction(Action, OS, Records);
+}
 }
 
 int main(int argc, char **argv) {
@@ -268,7 +278,23 @@ int main(int argc, char **argv) {
 
   llvm_shutdown_obj Y;
 
-  return TableGenMain(argv[0], &LLVMTableGenMain);
+  std::vector<TableGenExtraOutput> Extras;
+  for (StringRef Extra : ExtraOutputs) {
+    StringRef ActionName, Filename;
+    std::tie(ActionName, Filename) = Extra.split('=');
+    ActionType A;
+    if (Filename.empty() ||
+        Action.getParser().parse(Action, ActionName.ltrim('-'), "", A)) {
+      errs() << argv[0] << ": invalid -extra-output '" << Extra
+             << "', expected <action>=<file>\n";
+      return 1;
+    }
+    Extras.push_back({Filename.str(), [A](raw_ostream &OS, RecordKeeper &RK) {
+                        return runAction(A, OS, RK);
+                      }});
+  }
+
+  return TableGenMain(argv[0], &LLVMTableGenMain, Extras);
 }
 
 #ifndef __has_feature
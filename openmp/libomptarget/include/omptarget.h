@@ -111,6 +111,14 @@ struct __tgt_target_table {
       *EntriesEnd; // End of the table with all the entries (non inclusive)
 };
 
+/// This struct records the device queue (for CUDA, a stream) that the
+/// asynchronous operations of one target region are issued on. It starts out
+/// zeroed; the plugin fills in Queue on first use and takes it back in
+/// __tgt_rtl_synchronize.
+struct __tgt_async_info {
+  void *Queue; // Plugin-specific queue, or NULL if nothing was issued yet
+};
+
 #ifdef __cplusplus
 extern "C" {
 #endif
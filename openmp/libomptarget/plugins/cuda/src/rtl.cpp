@@ -14,6 +14,8 @@
 #include <cstddef>
 #include <cuda.h>
 #include <list>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 
@@ -83,6 +85,17 @@ struct omptarget_device_environmentTy {
   int32_t debug_level;
 };
 
+/// Streams of one device that are not in use by any target region. Each
+/// asynchronous region takes one for its copies and kernel launch and puts it
+/// back once it has synchronized, so regions issued by different host threads
+/// (e.g. nowait target tasks) can overlap on the device. The streams are
+/// blocking, i.e. ordered after work on the NULL stream, which is what the
+/// synchronous copies still use.
+struct StreamPoolTy {
+  std::mutex Mtx;
+  std::vector<CUstream> IdleStreams;
+};
+
 /// List that contains all the kernels.
 /// FIXME: we may need this to be per device and per library.
 std::list<KernelTy> KernelsList;
@@ -95,6 +108,7 @@ public:
   int NumberOfDevices;
   std::vector<CUmodule> Modules;
   std::vector<CUcontext> Contexts;
+  std::vector<std::unique_ptr<StreamPoolTy>> StreamPools;
 
   // Device properties
   std::vector<int> ThreadsPerBlock;
@@ -163,6 +177,38 @@ public:
     return &E.Table;
   }
 
+  // Take an idle stream of the device, or create a new one if there is none.
+  // The device's context must be current. Return NULL in case of error.
+  CUstream acquireStream(int32_t device_id) {
+    StreamPoolTy &Pool = *StreamPools[device_id];
+    {
+      std::lock_guard<std::mutex> Lock(Pool.Mtx);
+      if (!Pool.IdleStreams.empty()) {
+        CUstream Stream = Pool.IdleStreams.back();
+        Pool.IdleStreams.pop_back();
+        return Stream;
+      }
+    }
+
+    CUstream Stream;
+    CUresult err = cuStreamCreate(&Stream, CU_STREAM_DEFAULT);
+    if (err != CUDA_SUCCESS) {
+      DP("Error when creating CUDA stream\n");
+      CUDA_ERR_STRING(err);
+      return NULL;
+    }
+    DP("Created CUDA stream " DPxMOD " for device %d\n", DPxPTR(Stream),
+       device_id);
+    return Stream;
+  }
+
+  // Give back a stream taken with acquireStream.
+  void releaseStream(int32_t device_id, CUstream Stream) {
+    StreamPoolTy &Pool = *StreamPools[device_id];
+    std::lock_guard<std::mutex> Lock(Pool.Mtx);
+    Pool.IdleStreams.push_back(Stream);
+  }
+
   // Clear entries table for a device
   void clearOffloadEntriesTable(int32_t device_id) {
     assert(device_id < (int32_t)FuncGblEntries.size() &&
@@ -210,6 +256,8 @@ public:
     WarpSize.resize(NumberOfDevices);
     NumTeams.resize(NumberOfDevices);
     NumThreads.resize(NumberOfDevices);
+    for (int i = 0; i < NumberOfDevices; ++i)
+      StreamPools.emplace_back(new StreamPoolTy());
 
     // Get environment variables regarding teams
     char *envStr = getenv("OMP_TEAM_LIMIT");
@@ -244,6 +292,25 @@ public:
         }
       }
 
+    // Destroy streams
+    for (size_t i = 0; i < StreamPools.size(); ++i) {
+      if (!Contexts[i] || StreamPools[i]->IdleStreams.empty())
+        continue;
+      CUresult err = cuCtxSetCurrent(Contexts[i]);
+      if (err != CUDA_SUCCESS) {
+        DP("Error when setting CUDA context\n");
+        CUDA_ERR_STRING(err);
+        continue;
+      }
+      for (CUstream Stream : StreamPools[i]->IdleStreams) {
+        err = cuStreamDestroy(Stream);
+        if (err != CUDA_SUCCESS) {
+          DP("Error when destroying CUDA stream\n");
+          CUDA_ERR_STRING(err);
+        }
+      }
+    }
+
     // Destroy contexts
     for (auto &ctx : Contexts)
       if (ctx) {
@@ -258,6 +325,15 @@ public:
 
 static RTLDeviceInfoTy DeviceInfo;
 
+// Return the stream of the target region described by async_info, taking one
+// from the device's pool on first use. The device's context must be current.
+static CUstream getStream(int32_t device_id, __tgt_async_info *async_info) {
+  assert(async_info && "async_info is nullptr");
+  if (!async_info->Queue)
+    async_info->Queue = DeviceInfo.acquireStream(device_id);
+  return (CUstream)async_info->Queue;
+}
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -639,6 +715,56 @@ int32_t __tgt_rtl_data_retrieve(int32_t device_id, void *hst_ptr, void *tgt_ptr,
   return OFFLOAD_SUCCESS;
 }
 
+int32_t __tgt_rtl_data_submit_async(int32_t device_id, void *tgt_ptr,
+    void *hst_ptr, int64_t size, __tgt_async_info *async_info) {
+  // Set the context we are using.
+  CUresult err = cuCtxSetCurrent(DeviceInfo.Contexts[device_id]);
+  if (err != CUDA_SUCCESS) {
+    DP("Error when setting CUDA context\n");
+    CUDA_ERR_STRING(err);
+    return OFFLOAD_FAIL;
+  }
+
+  CUstream stream = getStream(device_id, async_info);
+  if (!stream)
+    return OFFLOAD_FAIL;
+
+  err = cuMemcpyHtoDAsync((CUdeviceptr)tgt_ptr, hst_ptr, size, stream);
+  if (err != CUDA_SUCCESS) {
+    DP("Error when copying data from host to device. Pointers: host = " DPxMOD
+       ", device = " DPxMOD ", size = %" PRId64 "\n", DPxPTR(hst_ptr),
+       DPxPTR(tgt_ptr), size);
+    CUDA_ERR_STRING(err);
+    return OFFLOAD_FAIL;
+  }
+  return OFFLOAD_SUCCESS;
+}
+
+int32_t __tgt_rtl_data_retrieve_async(int32_t device_id, void *hst_ptr,
+    void *tgt_ptr, int64_t size, __tgt_async_info *async_info) {
+  // Set the context we are using.
+  CUresult err = cuCtxSetCurrent(DeviceInfo.Contexts[device_id]);
+  if (err != CUDA_SUCCESS) {
+    DP("Error when setting CUDA context\n");
+    CUDA_ERR_STRING(err);
+    return OFFLOAD_FAIL;
+  }
+
+  CUstream stream = getStream(device_id, async_info);
+  if (!stream)
+    return OFFLOAD_FAIL;
+
+  err = cuMemcpyDtoHAsync(hst_ptr, (CUdeviceptr)tgt_ptr, size, stream);
+  if (err != CUDA_SUCCESS) {
+    DP("Error when copying data from device to host. Pointers: host = " DPxMOD
+        ", device = " DPxMOD ", size = %" PRId64 "\n", DPxPTR(hst_ptr),
+        DPxPTR(tgt_ptr), size);
+    CUDA_ERR_STRING(err);
+    return OFFLOAD_FAIL;
+  }
+  return OFFLOAD_SUCCESS;
+}
+
 int32_t __tgt_rtl_data_delete(int32_t device_id, void *tgt_ptr) {
   // Set the context we are using.
   CUresult err = cuCtxSetCurrent(DeviceInfo.Contexts[device_id]);
@@ -657,9 +783,10 @@ int32_t __tgt_rtl_data_delete(int32_t device_id, void *tgt_ptr) {
   return OFFLOAD_SUCCESS;
 }
 
-int32_t __tgt_rtl_run_target_team_region(int32_t device_id, void *tgt_entry_ptr,
-    void **tgt_args, ptrdiff_t *tgt_offsets, int32_t arg_num, int32_t team_num,
-    int32_t thread_limit, uint64_t loop_tripcount) {
+int32_t __tgt_rtl_run_target_team_region_async(int32_t device_id,
+    void *tgt_entry_ptr, void **tgt_args, ptrdiff_t *tgt_offsets,
+    int32_t arg_num, int32_t team_num, int32_t thread_limit,
+    uint64_t loop_tripcount, __tgt_async_info *async_info) {
   // Set the context we are using.
   CUresult err = cuCtxSetCurrent(DeviceInfo.Contexts[device_id]);
   if (err != CUDA_SUCCESS) {
@@ -668,6 +795,10 @@ int32_t __tgt_rtl_run_target_team_region(int32_t device_id, void *tgt_entry_ptr,
     return OFFLOAD_FAIL;
   }
 
+  CUstream stream = getStream(device_id, async_info);
+  if (!stream)
+    return OFFLOAD_FAIL;
+
   // All args are references.
   std::vector<void *> args(arg_num);
   std::vector<void *> ptrs(arg_num);
@@ -755,8 +886,11 @@ int32_t __tgt_rtl_run_target_team_region(int32_t device_id, void *tgt_entry_ptr,
   DP("Launch kernel with %d blocks and %d threads\n", cudaBlocksPerGrid,
      cudaThreadsPerBlock);
 
+  // The kernel parameters are copied at launch, so args and ptrs need not
+  // outlive this call.
   err = cuLaunchKernel(KernelInfo->Func, cudaBlocksPerGrid, 1, 1,
-      cudaThreadsPerBlock, 1, 1, 0 /*bytes of shared memory*/, 0, &args[0], 0);
+      cudaThreadsPerBlock, 1, 1, 0 /*bytes of shared memory*/, stream,
+      &args[0], 0);
   if (err != CUDA_SUCCESS) {
     DP("Device kernel launch failed!\n");
     CUDA_ERR_STRING(err);
@@ -766,18 +900,31 @@ int32_t __tgt_rtl_run_target_team_region(int32_t device_id, void *tgt_entry_ptr,
   DP("Launch of entry point at " DPxMOD " successful!\n",
       DPxPTR(tgt_entry_ptr));
 
-  CUresult sync_err = cuCtxSynchronize();
-  if (sync_err != CUDA_SUCCESS) {
-    DP("Kernel execution error at " DPxMOD "!\n", DPxPTR(tgt_entry_ptr));
-    CUDA_ERR_STRING(sync_err);
-    return OFFLOAD_FAIL;
-  } else {
-    DP("Kernel execution at " DPxMOD " successful!\n", DPxPTR(tgt_entry_ptr));
-  }
-
   return OFFLOAD_SUCCESS;
 }
 
+int32_t __tgt_rtl_run_target_team_region(int32_t device_id, void *tgt_entry_ptr,
+    void **tgt_args, ptrdiff_t *tgt_offsets, int32_t arg_num, int32_t team_num,
+    int32_t thread_limit, uint64_t loop_tripcount) {
+  __tgt_async_info async_info = {};
+  int32_t rc = __tgt_rtl_run_target_team_region_async(device_id, tgt_entry_ptr,
+      tgt_args, tgt_offsets, arg_num, team_num, thread_limit, loop_tripcount,
+      &async_info);
+  // Give the stream back even if the launch failed.
+  int32_t sync_rc = __tgt_rtl_synchronize(device_id, &async_info);
+  return rc != OFFLOAD_SUCCESS ? rc : sync_rc;
+}
+
+int32_t __tgt_rtl_run_target_region_async(int32_t device_id,
+    void *tgt_entry_ptr, void **tgt_args, ptrdiff_t *tgt_offsets,
+    int32_t arg_num, __tgt_async_info *async_info) {
+  // use one team and the default number of threads.
+  const int32_t team_num = 1;
+  const int32_t thread_limit = 0;
+  return __tgt_rtl_run_target_team_region_async(device_id, tgt_entry_ptr,
+      tgt_args, tgt_offsets, arg_num, team_num, thread_limit, 0, async_info);
+}
+
 int32_t __tgt_rtl_run_target_region(int32_t device_id, void *tgt_entry_ptr,
     void **tgt_args, ptrdiff_t *tgt_offsets, int32_t arg_num) {
   // use one team and the default number of threads.
@@ -787,6 +934,25 @@ int32_t __tgt_rtl_run_target_region(int32_t device_id, void *tgt_entry_ptr,
       tgt_offsets, arg_num, team_num, thread_limit, 0);
 }
 
+int32_t __tgt_rtl_synchronize(int32_t device_id,
+                              __tgt_async_info *async_info) {
+  assert(async_info && "async_info is nullptr");
+  CUstream stream = (CUstream)async_info->Queue;
+  if (!stream)
+    return OFFLOAD_SUCCESS;
+
+  CUresult err = cuStreamSynchronize(stream);
+  // Errors are sticky in the context, so the stream is as good as any other.
+  DeviceInfo.releaseStream(device_id, stream);
+  async_info->Queue = nullptr;
+  if (err != CUDA_SUCCESS) {
+    DP("Error when synchronizing stream " DPxMOD "\n", DPxPTR(stream));
+    CUDA_ERR_STRING(err);
+    return OFFLOAD_FAIL;
+  }
+  return OFFLOAD_SUCCESS;
+}
+
 #ifdef __cplusplus
 }
 #endif
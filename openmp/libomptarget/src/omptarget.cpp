@@ -209,9 +209,11 @@ static int32_t member_of(int64_t type) {
   return ((type & OMP_TGT_MAPTYPE_MEMBER_OF) >> 48) - 1;
 }
 
-/// Internal function to do the mapping and transfer the data to the device
+/// Internal function to do the mapping and transfer the data to the device.
+/// If AsyncInfo is non-null the copies may still be in flight on return.
 int target_data_begin(DeviceTy &Device, int32_t arg_num,
-    void **args_base, void **args, int64_t *arg_sizes, int64_t *arg_types) {
+    void **args_base, void **args, int64_t *arg_sizes, int64_t *arg_types,
+    __tgt_async_info *AsyncInfo) {
   // process each input.
   for (int32_t i = 0; i < arg_num; ++i) {
     // Ignore private variables and arrays - there is no mapping for them.
@@ -312,7 +314,8 @@ int target_data_begin(DeviceTy &Device, int32_t arg_num,
       if (copy && !IsHostPtr) {
         DP("Moving %" PRId64 " bytes (hst:" DPxMOD ") -> (tgt:" DPxMOD ")\n",
             data_size, DPxPTR(HstPtrBegin), DPxPTR(TgtPtrBegin));
-        int rt = Device.data_submit(TgtPtrBegin, HstPtrBegin, data_size);
+        int rt = Device.data_submit(TgtPtrBegin, HstPtrBegin, data_size,
+            AsyncInfo);
         if (rt != OFFLOAD_SUCCESS) {
           DP("Copying data to device failed.\n");
           return OFFLOAD_FAIL;
@@ -325,8 +328,12 @@ int target_data_begin(DeviceTy &Device, int32_t arg_num,
           DPxPTR(Pointer_TgtPtrBegin), DPxPTR(TgtPtrBegin));
       uint64_t Delta = (uint64_t)HstPtrBegin - (uint64_t)HstPtrBase;
       void *TgtPtrBase = (void *)((uint64_t)TgtPtrBegin - Delta);
+      // The copy has to be ordered after the one of the enclosing object, so
+      // it goes on the same queue, but it reads a local: wait for it.
       int rt = Device.data_submit(Pointer_TgtPtrBegin, &TgtPtrBase,
-          sizeof(void *));
+          sizeof(void *), AsyncInfo);
+      if (rt == OFFLOAD_SUCCESS)
+        rt = Device.synchronize(AsyncInfo);
       if (rt != OFFLOAD_SUCCESS) {
         DP("Copying data to device failed.\n");
         return OFFLOAD_FAIL;
@@ -342,9 +349,25 @@ int target_data_begin(DeviceTy &Device, int32_t arg_num,
   return OFFLOAD_SUCCESS;
 }
 
+namespace {
+/// A mapping whose device memory is released once the copies back are done.
+struct DeallocTy {
+  void *HstPtrBegin;
+  int64_t Size;
+  bool ForceDelete;
+  bool HasCloseModifier;
+};
+} // namespace
+
 /// Internal function to undo the mapping and retrieve the data from the device.
+/// The copies back are complete on return, also if AsyncInfo is non-null.
 int target_data_end(DeviceTy &Device, int32_t arg_num, void **args_base,
-    void **args, int64_t *arg_sizes, int64_t *arg_types) {
+    void **args, int64_t *arg_sizes, int64_t *arg_types,
+    __tgt_async_info *AsyncInfo) {
+  // With asynchronous copies, device memory is released only after all of
+  // them have completed.
+  std::vector<DeallocTy> Deallocs;
+
   // process each input.
   for (int32_t i = arg_num - 1; i >= 0; --i) {
     // Ignore private variables and arrays - there is no mapping for them.
@@ -415,7 +438,8 @@ int target_data_end(DeviceTy &Device, int32_t arg_num, void **args_base,
               TgtPtrBegin == HstPtrBegin)) {
           DP("Moving %" PRId64 " bytes (tgt:" DPxMOD ") -> (hst:" DPxMOD ")\n",
               data_size, DPxPTR(TgtPtrBegin), DPxPTR(HstPtrBegin));
-          int rt = Device.data_retrieve(HstPtrBegin, TgtPtrBegin, data_size);
+          int rt = Device.data_retrieve(HstPtrBegin, TgtPtrBegin, data_size,
+              AsyncInfo);
           if (rt != OFFLOAD_SUCCESS) {
             DP("Copying data from device failed.\n");
             return OFFLOAD_FAIL;
@@ -429,6 +453,19 @@ int target_data_end(DeviceTy &Device, int32_t arg_num, void **args_base,
       // shadow pointer entries for this struct.
       uintptr_t lb = (uintptr_t) HstPtrBegin;
       uintptr_t ub = (uintptr_t) HstPtrBegin + data_size;
+      if (AsyncInfo && (arg_types[i] & OMP_TGT_MAPTYPE_FROM)) {
+        // The copy back must not land on top of the restored pointers.
+        Device.ShadowMtx.lock();
+        ShadowPtrListTy::iterator it = Device.ShadowPtrMap.lower_bound(
+            HstPtrBegin);
+        bool HasShadowPtrs = it != Device.ShadowPtrMap.end() &&
+            (uintptr_t) it->first < ub;
+        Device.ShadowMtx.unlock();
+        if (HasShadowPtrs && Device.synchronize(AsyncInfo) != OFFLOAD_SUCCESS) {
+          DP("Copying data from device failed.\n");
+          return OFFLOAD_FAIL;
+        }
+      }
       Device.ShadowMtx.lock();
       for (ShadowPtrListTy::iterator it = Device.ShadowPtrMap.begin();
            it != Device.ShadowPtrMap.end();) {
@@ -461,7 +498,15 @@ int target_data_end(DeviceTy &Device, int32_t arg_num, void **args_base,
       Device.ShadowMtx.unlock();
 
       // Deallocate map
-      if (DelEntry) {
+      if (DelEntry && AsyncInfo) {
+        // The same mapping may be seen twice; release it only once.
+        bool Seen = false;
+        for (const DeallocTy &D : Deallocs)
+          Seen |= D.HstPtrBegin == HstPtrBegin;
+        if (!Seen)
+          Deallocs.push_back(
+              {HstPtrBegin, data_size, ForceDelete, HasCloseModifier});
+      } else if (DelEntry) {
         int rt = Device.deallocTgtPtr(HstPtrBegin, data_size, ForceDelete,
                                       HasCloseModifier);
         if (rt != OFFLOAD_SUCCESS) {
@@ -472,6 +517,20 @@ int target_data_end(DeviceTy &Device, int32_t arg_num, void **args_base,
     }
   }
 
+  if (Device.synchronize(AsyncInfo) != OFFLOAD_SUCCESS) {
+    DP("Copying data from device failed.\n");
+    return OFFLOAD_FAIL;
+  }
+
+  for (const DeallocTy &D : Deallocs) {
+    int rt = Device.deallocTgtPtr(D.HstPtrBegin, D.Size, D.ForceDelete,
+                                  D.HasCloseModifier);
+    if (rt != OFFLOAD_SUCCESS) {
+      DP("Deallocating data from device failed.\n");
+      return OFFLOAD_FAIL;
+    }
+  }
+
   return OFFLOAD_SUCCESS;
 }
 
@@ -633,9 +692,14 @@ int target(int64_t device_id, void *host_ptr, int32_t arg_num,
   TrlTblMtx.unlock();
   assert(TargetTable && "Global data has not been mapped\n");
 
+  // All copies and the kernel launch of this region go on one device queue so
+  // that they are ordered with respect to each other, but the host only waits
+  // for them in target_data_end.
+  __tgt_async_info AsyncInfo = {};
+
   // Move data to device.
   int rc = target_data_begin(Device, arg_num, args_base, args, arg_sizes,
-      arg_types);
+      arg_types, &AsyncInfo);
   if (rc != OFFLOAD_SUCCESS) {
     DP("Call to target_data_begin failed, abort target.\n");
     return OFFLOAD_FAIL;
@@ -685,8 +749,11 @@ int target(int64_t device_id, void *host_ptr, int32_t arg_num,
         }
         DP("Update lambda reference (" DPxMOD ") -> [" DPxMOD "]\n",
            DPxPTR(Pointer_TgtPtrBegin), DPxPTR(TgtPtrBegin));
+        // Pointer_TgtPtrBegin is a local, wait for the copy to finish.
         int rt = Device.data_submit(TgtPtrBegin, &Pointer_TgtPtrBegin,
-                                    sizeof(void *));
+                                    sizeof(void *), &AsyncInfo);
+        if (rt == OFFLOAD_SUCCESS)
+          rt = Device.synchronize(&AsyncInfo);
         if (rt != OFFLOAD_SUCCESS) {
           DP("Copying data to device failed.\n");
           return OFFLOAD_FAIL;
@@ -727,7 +794,8 @@ int target(int64_t device_id, void *host_ptr, int32_t arg_num,
 #endif
       // If first-private, copy data from host
       if (arg_types[i] & OMP_TGT_MAPTYPE_TO) {
-        int rt = Device.data_submit(TgtPtrBegin, HstPtrBegin, arg_sizes[i]);
+        int rt = Device.data_submit(TgtPtrBegin, HstPtrBegin, arg_sizes[i],
+            &AsyncInfo);
         if (rt != OFFLOAD_SUCCESS) {
           DP ("Copying data to device failed, failed.\n");
           return OFFLOAD_FAIL;
@@ -776,16 +844,24 @@ int target(int64_t device_id, void *host_ptr, int32_t arg_num,
   if (IsTeamConstruct) {
     rc = Device.run_team_region(TargetTable->EntriesBegin[TM->Index].addr,
         &tgt_args[0], &tgt_offsets[0], tgt_args.size(), team_num,
-        thread_limit, ltc);
+        thread_limit, ltc, &AsyncInfo);
   } else {
     rc = Device.run_region(TargetTable->EntriesBegin[TM->Index].addr,
-        &tgt_args[0], &tgt_offsets[0], tgt_args.size());
+        &tgt_args[0], &tgt_offsets[0], tgt_args.size(), &AsyncInfo);
   }
   if (rc != OFFLOAD_SUCCESS) {
     DP ("Executing target region abort target.\n");
     return OFFLOAD_FAIL;
   }
 
+  // Move data from device. This waits for the kernel to complete.
+  int rt = target_data_end(Device, arg_num, args_base, args, arg_sizes,
+      arg_types, &AsyncInfo);
+  if (rt != OFFLOAD_SUCCESS) {
+    DP("Call to target_data_end failed, abort targe.\n");
+    return OFFLOAD_FAIL;
+  }
+
   // Deallocate (first-)private arrays
   for (auto it : fpArrays) {
     int rt = Device.RTL->data_delete(Device.RTLDeviceID, it);
@@ -795,13 +871,5 @@ int target(int64_t device_id, void *host_ptr, int32_t arg_num,
     }
   }
 
-  // Move data from device.
-  int rt = target_data_end(Device, arg_num, args_base, args, arg_sizes,
-      arg_types);
-  if (rt != OFFLOAD_SUCCESS) {
-    DP("Call to target_data_end failed, abort targe.\n");
-    return OFFLOAD_FAIL;
-  }
-
   return OFFLOAD_SUCCESS;
 }
@@ -788,6 +788,7 @@ extern int __kmp_affinity_respect_mask; // Respect process' init affinity mask?
 extern char *__kmp_affinity_proclist; /* proc ID list */
 extern kmp_affin_mask_t *__kmp_affinity_masks;
 extern unsigned __kmp_affinity_num_masks;
+extern int *__kmp_affinity_place_pkgs; /* package of each place, or NULL */
 extern void __kmp_affinity_bind_thread(int which);
 
 extern kmp_affin_mask_t *__kmp_affin_fullMask;
@@ -2061,6 +2062,7 @@ typedef enum kmp_tasking_mode {
 extern kmp_tasking_mode_t
     __kmp_tasking_mode; /* determines how/when to execute tasks */
 extern int __kmp_task_stealing_constraint;
+extern int __kmp_task_stealing_local_tries;
 extern int __kmp_enable_task_throttling;
 extern kmp_int32 __kmp_default_device; // Set via OMP_DEFAULT_DEVICE if
 // specified, defaults to 0 otherwise
@@ -2148,6 +2150,10 @@ struct kmp_depnode_list {
 
 // Max number of mutexinoutset dependencies per node
 #define MAX_MTX_DEPS 4
+// Number of list cells embedded in each depnode. A node usually sits on one
+// or two lists (the successors of its predecessor, the last inputs of an
+// address), so these save the allocations in the common in/out case.
+#define KMP_DEPNODE_CELLS 2
 
 typedef struct kmp_base_depnode {
   kmp_depnode_list_t *successors; /* used under lock */
@@ -2160,6 +2166,8 @@ typedef struct kmp_base_depnode {
 #endif
   std::atomic<kmp_int32> npredecessors;
   std::atomic<kmp_int32> nrefs;
+  kmp_int32 ncells_used; /* embedded cells handed out, only by the creator */
+  kmp_depnode_list_t cells[KMP_DEPNODE_CELLS]; /* list cells pointing here */
 } kmp_base_depnode_t;
 
 union KMP_ALIGN_CACHE kmp_depnode {
@@ -2780,6 +2780,43 @@ static kmp_affin_mask_t *__kmp_create_masks(unsigned *maxIndex,
   return osId2Mask;
 }
 
+// Record the package containing each place in __kmp_affinity_place_pkgs, so
+// that threads looking for tasks to steal can prefer victims that share a
+// package (and therefore usually a memory controller) with them. Places that
+// span packages get -1. The table is left NULL when there is nothing to gain,
+// i.e. on single package machines or when the topology is unknown.
+static void __kmp_affinity_find_place_pkgs(AddrUnsPair *address2os,
+                                           int numAddrs, unsigned maxOsId) {
+  if (nPackages <= 1 || nPackages >= __kmp_avail_proc ||
+      __kmp_affinity_num_masks == 0)
+    return;
+  int *osId2Pkg = (int *)__kmp_allocate(sizeof(int) * (maxOsId + 1));
+  for (unsigned i = 0; i <= maxOsId; i++)
+    osId2Pkg[i] = -1;
+  for (int i = 0; i < numAddrs; i++)
+    osId2Pkg[address2os[i].second] = (int)address2os[i].first.labels[0];
+
+  __kmp_affinity_place_pkgs =
+      (int *)__kmp_allocate(sizeof(int) * __kmp_affinity_num_masks);
+  for (unsigned place = 0; place < __kmp_affinity_num_masks; place++) {
+    kmp_affin_mask_t *mask = KMP_CPU_INDEX(__kmp_affinity_masks, place);
+    int pkg = -1;
+    int i;
+    KMP_CPU_SET_ITERATE(i, mask) {
+      if ((unsigned)i > maxOsId || osId2Pkg[i] < 0)
+        continue;
+      if (pkg == -1) {
+        pkg = osId2Pkg[i];
+      } else if (pkg != osId2Pkg[i]) {
+        pkg = -1;
+        break;
+      }
+    }
+    __kmp_affinity_place_pkgs[place] = pkg;
+  }
+  __kmp_free(osId2Pkg);
+}
+
 // Stuff for the affinity proclist parsers.  It's easier to declare these vars
 // as file-static than to try and pass them through the calling sequence of
 // the recursive-descent OMP_PLACES parser.
@@ -4641,6 +4678,7 @@ static void __kmp_aux_affinity_initialize(void) {
     KMP_ASSERT2(0, "Unexpected affinity setting");
   }
 
+  __kmp_affinity_find_place_pkgs(address2os, __kmp_avail_proc, maxIndex);
   KMP_CPU_FREE_ARRAY(osId2Mask, maxIndex + 1);
   machine_hierarchy.init(address2os, __kmp_avail_proc);
 }
@@ -4677,6 +4715,10 @@ void __kmp_affinity_uninitialize(void) {
     KMP_CPU_FREE(__kmp_affin_fullMask);
     __kmp_affin_fullMask = NULL;
   }
+  if (__kmp_affinity_place_pkgs != NULL) {
+    __kmp_free(__kmp_affinity_place_pkgs);
+    __kmp_affinity_place_pkgs = NULL;
+  }
   __kmp_affinity_num_masks = 0;
   __kmp_affinity_type = affinity_default;
   __kmp_affinity_num_places = 0;
@@ -20,8 +20,6 @@
 #include "ompt-specific.h"
 #endif
 
-// TODO: Improve memory allocation? keep a list of pre-allocated structures?
-// allocate in blocks? re-use list finished list entries?
 // TODO: don't use atomic ref counters for stack-allocated nodes.
 // TODO: find an alternate to atomic refs for heap-allocated nodes?
 // TODO: Finish graph output support
@@ -42,6 +40,7 @@ static void __kmp_init_node(kmp_depnode_t *node) {
   node->dn.mtx_num_locks = 0;
   __kmp_init_lock(&node->dn.lock);
   KMP_ATOMIC_ST_RLX(&node->dn.nrefs, 1); // init creates the first reference
+  node->dn.ncells_used = 0;
 #ifdef KMP_SUPPORT_GRAPH_OUTPUT
   node->dn.id = KMP_ATOMIC_INC(&kmp_node_id_seed);
 #endif
@@ -186,18 +185,25 @@ __kmp_dephash_find(kmp_info_t *thread, kmp_dephash_t **hash, kmp_intptr_t addr)
   return entry;
 }
 
+// Prepend node to list. node is always the one whose dependences are being
+// processed by this thread, so its embedded cells can be handed out without
+// synchronization; they are never reused once the list drops them.
 static kmp_depnode_list_t *__kmp_add_node(kmp_info_t *thread,
                                           kmp_depnode_list_t *list,
                                           kmp_depnode_t *node) {
   kmp_depnode_list_t *new_head;
 
+  if (node->dn.ncells_used < KMP_DEPNODE_CELLS) {
+    new_head = &node->dn.cells[node->dn.ncells_used++];
+  } else {
 #if USE_FAST_MEMORY
-  new_head = (kmp_depnode_list_t *)__kmp_fast_allocate(
-      thread, sizeof(kmp_depnode_list_t));
+    new_head = (kmp_depnode_list_t *)__kmp_fast_allocate(
+        thread, sizeof(kmp_depnode_list_t));
 #else
-  new_head = (kmp_depnode_list_t *)__kmp_thread_malloc(
-      thread, sizeof(kmp_depnode_list_t));
+    new_head = (kmp_depnode_list_t *)__kmp_thread_malloc(
+        thread, sizeof(kmp_depnode_list_t));
 #endif
+  }
 
   new_head->node = __kmp_node_ref(node);
   new_head->next = list;
@@ -687,6 +693,9 @@ void __kmpc_omp_wait_deps(ident_t *loc_ref, kmp_int32 gtid, kmp_int32 ndeps,
 
   kmp_depnode_t node = {0};
   __kmp_init_node(&node);
+  // The releasing thread may still be walking a list after this frame is
+  // gone, so list cells must not live in a stack node.
+  node.dn.ncells_used = KMP_DEPNODE_CELLS;
 
   if (!__kmp_check_deps(gtid, &node, NULL, &current_task->td_dephash,
                         DEP_BARRIER, ndeps, dep_list, ndeps_noalias,
@@ -35,19 +35,33 @@ static inline void __kmp_node_deref(kmp_info_t *thread, kmp_depnode_t *node) {
   }
 }
 
+// A list cell embedded in the node it points to goes away with that node, so
+// this must be checked before the node is dereferenced.
+static inline bool __kmp_depnode_cell_is_embedded(kmp_depnode_list_t *cell) {
+  kmp_depnode_t *node = cell->node;
+  return cell >= node->dn.cells && cell < node->dn.cells + KMP_DEPNODE_CELLS;
+}
+
+static inline void __kmp_depnode_cell_free(kmp_info_t *thread,
+                                           kmp_depnode_list_t *cell) {
+  bool embedded = __kmp_depnode_cell_is_embedded(cell);
+  __kmp_node_deref(thread, cell->node);
+  if (embedded)
+    return;
+#if USE_FAST_MEMORY
+  __kmp_fast_free(thread, cell);
+#else
+  __kmp_thread_free(thread, cell);
+#endif
+}
+
 static inline void __kmp_depnode_list_free(kmp_info_t *thread,
                                            kmp_depnode_list *list) {
   kmp_depnode_list *next;
 
   for (; list; list = next) {
     next = list->next;
-
-    __kmp_node_deref(thread, list->node);
-#if USE_FAST_MEMORY
-    __kmp_fast_free(thread, list);
-#else
-    __kmp_thread_free(thread, list);
-#endif
+    __kmp_depnode_cell_free(thread, list);
   }
 }
 
@@ -126,12 +140,7 @@ static inline void __kmp_release_deps(kmp_int32 gtid, kmp_taskdata_t *task) {
     }
 
     next = p->next;
-    __kmp_node_deref(thread, p->node);
-#if USE_FAST_MEMORY
-    __kmp_fast_free(thread, p);
-#else
-    __kmp_thread_free(thread, p);
-#endif
+    __kmp_depnode_cell_free(thread, p);
   }
 
   __kmp_node_deref(thread, node);
@@ -2770,6 +2770,18 @@ static kmp_task_t *__kmp_steal_task(kmp_info_t *victim_thr, kmp_int32 gtid,
   return task;
 }
 
+#if KMP_AFFINITY_SUPPORTED
+// __kmp_thread_package: return the package the thread is bound to, or -1 if
+// it is unbound, its place spans packages, or the topology is unknown.
+static inline int __kmp_thread_package(kmp_info_t *th) {
+  int place = th->th.th_current_place;
+  if (__kmp_affinity_place_pkgs == NULL || place < 0 ||
+      place >= (int)__kmp_affinity_num_masks)
+    return -1;
+  return __kmp_affinity_place_pkgs[place];
+}
+#endif
+
 // __kmp_execute_tasks_template: Choose and execute tasks until either the
 // condition is statisfied (return true) or there are none left (return false).
 //
@@ -2833,6 +2845,10 @@ static inline int __kmp_execute_tasks_template(
           asleep = 0;
         } else if (!new_victim) { // no recent steals and we haven't already
           // used a new victim; select a random thread
+#if KMP_AFFINITY_SUPPORTED
+          int my_pkg = __kmp_thread_package(thread);
+          int local_tries = my_pkg < 0 ? 0 : __kmp_task_stealing_local_tries;
+#endif
           do { // Find a different thread to steal work from.
             // Pick a random thread. Initial plan was to cycle through all the
             // threads, and only return if we tried to steal from every thread,
@@ -2843,6 +2859,17 @@ static inline int __kmp_execute_tasks_template(
             }
             // Found a potential victim
             other_thread = threads_data[victim_tid].td.td_thr;
+#if KMP_AFFINITY_SUPPORTED
+            // On multi-package machines, redraw a few times to find a victim
+            // in our own package: the data its tasks touch is more likely to
+            // be in a shared cache and in local memory. Remote victims are
+            // still picked once the tries run out, so no work is stranded.
+            if (local_tries > 0 && __kmp_thread_package(other_thread) != my_pkg) {
+              --local_tries;
+              asleep = 1;
+              continue;
+            }
+#endif
             // There is a slight chance that __kmp_enable_tasking() did not wake
             // up all threads waiting at the barrier.  If victim is sleeping,
             // then wake it up. Since we were going to pay the cache miss
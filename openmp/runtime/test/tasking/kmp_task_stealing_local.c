@@ -0,0 +1,54 @@
+// RUN: %libomp-compile
+// RUN: env KMP_AFFINITY=compact KMP_TASK_STEALING_LOCAL_TRIES=0 %libomp-run
+// RUN: env KMP_AFFINITY=compact KMP_TASK_STEALING_LOCAL_TRIES=4 %libomp-run
+// RUN: env OMP_PROC_BIND=spread KMP_TASK_STEALING_LOCAL_TRIES=64 %libomp-run
+// REQUIRES: affinity
+
+#include <stdio.h>
+#include <omp.h>
+#include "omp_testsuite.h"
+#include "omp_my_sleep.h"
+
+/*
+ * Every thread creates tasks that the other threads have to steal. Whatever
+ * the package-local stealing preference is, all tasks must run exactly once.
+ */
+
+#define NUM_STOLEN_TASKS 2000
+
+int test_task_stealing_local() {
+  int counts[NUM_STOLEN_TASKS] = {0};
+  int i, errors = 0;
+
+  #pragma omp parallel
+  {
+    #pragma omp for schedule(static) nowait
+    for (i = 0; i < NUM_STOLEN_TASKS; i++) {
+      #pragma omp task firstprivate(i) shared(counts)
+      {
+        my_sleep(0.0001);
+        #pragma omp atomic
+        counts[i]++;
+      }
+    }
+  }
+
+  for (i = 0; i < NUM_STOLEN_TASKS; i++) {
+    if (counts[i] != 1) {
+      fprintf(stderr, "task %d ran %d times\n", i, counts[i]);
+      errors++;
+    }
+  }
+  return errors == 0;
+}
+
+int main() {
+  int i;
+  int num_failed = 0;
+  for (i = 0; i < REPETITIONS; i++) {
+    if (!test_task_stealing_local()) {
+      num_failed++;
+    }
+  }
+  return num_failed;
+}
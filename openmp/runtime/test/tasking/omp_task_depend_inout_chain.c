@@ -0,0 +1,71 @@
+// RUN: %libomp-compile-and-run
+
+#include <stdio.h>
+#include <omp.h>
+#include "omp_testsuite.h"
+
+/*
+ * Alternate writers and groups of readers on a handful of addresses. Each
+ * writer has to see every earlier reader finished, and each reader has to see
+ * the value of the writer before it. The readers per group vary so that
+ * dependence nodes end up on more lists than they have embedded cells.
+ */
+
+#define NUM_ADDRS 4
+#define NUM_ROUNDS 200
+#define MAX_READERS 5
+
+int test_task_depend_inout_chain() {
+  int value[NUM_ADDRS] = {0};
+  int errors = 0;
+
+  #pragma omp parallel
+  #pragma omp single
+  {
+    int round, a, r;
+    for (round = 0; round < NUM_ROUNDS; round++) {
+      for (a = 0; a < NUM_ADDRS; a++) {
+        int nreaders = (round + a) % (MAX_READERS + 1);
+        #pragma omp task depend(inout: value[a]) firstprivate(a, round) \
+            shared(value, errors)
+        {
+          if (value[a] != round) {
+            #pragma omp atomic
+            errors++;
+          }
+          value[a] = round + 1;
+        }
+        for (r = 0; r < nreaders; r++) {
+          #pragma omp task depend(in: value[a]) firstprivate(a, round) \
+              shared(value, errors)
+          {
+            if (value[a] != round + 1) {
+              #pragma omp atomic
+              errors++;
+            }
+          }
+        }
+      }
+    }
+    #pragma omp taskwait
+  }
+
+  for (int a = 0; a < NUM_ADDRS; a++) {
+    if (value[a] != NUM_ROUNDS) {
+      fprintf(stderr, "value[%d] = %d\n", a, value[a]);
+      errors++;
+    }
+  }
+  return errors == 0;
+}
+
+int main() {
+  int i;
+  int num_failed = 0;
+  for (i = 0; i < REPETITIONS; i++) {
+    if (!test_task_depend_inout_chain()) {
+      num_failed++;
+    }
+  }
+  return num_failed;
+}
@@ -83,6 +83,13 @@ public:
   /// @return A Value ref which holds the current global thread number.
   Value *createCallGlobalThreadNum();
 
+  /// Create a runtime library call to check whether an active parallel region
+  /// encloses the current code.
+  ///
+  /// @return A Value which holds a non-zero value if inside an active parallel
+  ///         region, 0 otherwise.
+  Value *createCallInParallel();
+
   /// Create a runtime library call to request a number of threads.
   /// Which will be used in the next OpenMP section (by the next fork).
   ///
@@ -123,11 +130,13 @@ public:
   ///                         the last chunk of work, or 0 otherwise.
   /// @param LBPtr            Pointer to the lower bound for the next chunk.
   /// @param UBPtr            Pointer to the upper bound for the next chunk.
-  /// @param StridePtr        Pointer to the stride for the next chunk.
+  /// @param StridePtr        Pointer to the distance between the chunks of
+  ///                         this thread.
+  /// @param Inc              The loop increment.
   /// @param ChunkSize        The chunk size of the parallel loop.
   void createCallStaticInit(Value *GlobalThreadID, Value *IsLastPtr,
                             Value *LBPtr, Value *UBPtr, Value *StridePtr,
-                            Value *ChunkSize);
+                            Value *Inc, Value *ChunkSize);
 
   /// Create a runtime library call to mark the end of
   /// a statically scheduled loop.
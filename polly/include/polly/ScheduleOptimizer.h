@@ -51,6 +51,10 @@ class Scop;
 struct OptimizerAdditionalInfoTy {
   const llvm::TargetTransformInfo *TTI;
   const Dependences *D;
+
+  /// If not null, incremented for every band that a pattern-matching based
+  /// optimization has been applied to.
+  unsigned *PatternOptsApplied;
 };
 
 /// Parameters of the matrix multiplication operands.
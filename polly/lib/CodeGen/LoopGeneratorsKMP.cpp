@@ -63,11 +63,19 @@ void ParallelLoopGeneratorKMP::deployParallelExecution(Value *SubFn,
                                                        Value *SubFnParam,
                                                        Value *LB, Value *UB,
                                                        Value *Stride) {
-  // Inform OpenMP runtime about the number of threads if greater than zero
-  if (PollyNumThreads > 0) {
-    Value *GlobalThreadID = createCallGlobalThreadNum();
-    createCallPushNumThreads(GlobalThreadID, Builder.getInt32(PollyNumThreads));
-  }
+  // Inform OpenMP runtime about the number of threads. Within an active
+  // parallel region (e.g. the SCoP is part of an OpenMP parallel region or of
+  // a function called from one), the loop is run by a team of a single thread
+  // instead of oversubscribing the machine with nested teams. A value of zero
+  // leaves the runtime's choice unchanged.
+  Value *GlobalThreadID = createCallGlobalThreadNum();
+  Value *InParallel = Builder.CreateICmpNE(
+      createCallInParallel(), Builder.getInt32(0), "polly.par.inParallel");
+  Value *NumThreads =
+      Builder.CreateSelect(InParallel, Builder.getInt32(1),
+                           Builder.getInt32(PollyNumThreads),
+                           "polly.par.numThreads");
+  createCallPushNumThreads(GlobalThreadID, NumThreads);
 
   // Tell the runtime we start a parallel loop
   createCallSpawnThreads(SubFn, SubFnParam, LB, UB, Stride);
@@ -117,10 +125,10 @@ Function *ParallelLoopGeneratorKMP::prepareSubFnDefinition(Function *F) const {
 //     ExitBB
 //
 // HeaderBB will hold allocations, loading of variables and kmp-init calls.
-// CheckNextBB will check for more work (dynamic) or will be "empty" (static).
+// CheckNextBB will check for more work (dynamic), advance to the thread's next
+// chunk (static chunked) or will be "empty" (static non-chunked).
 // If there is more work to do: go to PreHeaderBB, otherwise go to ExitBB.
 // PreHeaderBB loads the new boundaries (& will lead to the loop body later on).
-// Just like CheckNextBB: PreHeaderBB is empty in the static scheduling case.
 // ExitBB marks the end of the parallel execution.
 // The possibly empty BasicBlocks will automatically be removed.
 std::tuple<Value *, Function *>
@@ -180,16 +188,16 @@ ParallelLoopGeneratorKMP::createSubFn(Value *StrideNotUsed,
   Value *ID =
       Builder.CreateAlignedLoad(IDPtr, Alignment, "polly.par.global_tid");
 
-  Builder.CreateAlignedStore(LB, LBPtr, Alignment);
-  Builder.CreateAlignedStore(UB, UBPtr, Alignment);
-  Builder.CreateAlignedStore(Builder.getInt32(0), IsLastPtr, Alignment);
-  Builder.CreateAlignedStore(Stride, StridePtr, Alignment);
-
   // Subtract one as the upper bound provided by openmp is a < comparison
   // whereas the codegenForSequential function creates a <= comparison.
   Value *AdjustedUB = Builder.CreateAdd(UB, ConstantInt::get(LongType, -1),
                                         "polly.indvar.UBAdjusted");
 
+  Builder.CreateAlignedStore(LB, LBPtr, Alignment);
+  Builder.CreateAlignedStore(AdjustedUB, UBPtr, Alignment);
+  Builder.CreateAlignedStore(Builder.getInt32(0), IsLastPtr, Alignment);
+  Builder.CreateAlignedStore(Stride, StridePtr, Alignment);
+
   Value *ChunkSize =
       ConstantInt::get(LongType, std::max<int>(PollyChunkSize, 1));
 
@@ -224,26 +232,58 @@ ParallelLoopGeneratorKMP::createSubFn(Value *StrideNotUsed,
   case OMPGeneralSchedulingType::StaticNonChunked:
     // "STATIC" scheduling types are handled below
     {
-      createCallStaticInit(ID, IsLastPtr, LBPtr, UBPtr, StridePtr, ChunkSize);
+      createCallStaticInit(ID, IsLastPtr, LBPtr, UBPtr, StridePtr, Stride,
+                           ChunkSize);
 
-      LB = Builder.CreateAlignedLoad(LBPtr, Alignment, "polly.indvar.LB");
-      UB = Builder.CreateAlignedLoad(UBPtr, Alignment, "polly.indvar.UB");
+      Value *ChunkLB =
+          Builder.CreateAlignedLoad(LBPtr, Alignment, "polly.indvar.LB");
+      Value *ChunkUB =
+          Builder.CreateAlignedLoad(UBPtr, Alignment, "polly.indvar.UB");
 
       Value *AdjUBOutOfBounds =
-          Builder.CreateICmp(llvm::CmpInst::Predicate::ICMP_SLT, UB, AdjustedUB,
-                             "polly.adjustedUBOutOfBounds");
+          Builder.CreateICmp(llvm::CmpInst::Predicate::ICMP_SLT, ChunkUB,
+                             AdjustedUB, "polly.adjustedUBOutOfBounds");
 
-      UB = Builder.CreateSelect(AdjUBOutOfBounds, UB, AdjustedUB);
-      Builder.CreateAlignedStore(UB, UBPtr, Alignment);
+      ChunkUB = Builder.CreateSelect(AdjUBOutOfBounds, ChunkUB, AdjustedUB);
+      Builder.CreateAlignedStore(ChunkUB, UBPtr, Alignment);
 
-      Value *HasIteration = Builder.CreateICmp(
-          llvm::CmpInst::Predicate::ICMP_SLE, LB, UB, "polly.hasIteration");
+      Value *HasIteration =
+          Builder.CreateICmp(llvm::CmpInst::Predicate::ICMP_SLE, ChunkLB,
+                             ChunkUB, "polly.hasIteration");
       Builder.CreateCondBr(HasIteration, PreHeaderBB, ExitBB);
 
       Builder.SetInsertPoint(CheckNextBB);
-      Builder.CreateBr(ExitBB);
+      if (getSchedType(PollyChunkSize, PollyScheduling) ==
+          OMPGeneralSchedulingType::StaticChunked) {
+        // The runtime only hands out the first chunk of this thread; its
+        // further chunks follow at the distance returned in StridePtr.
+        Value *ChunkStride = Builder.CreateAlignedLoad(
+            StridePtr, Alignment, "polly.par.chunkStride");
+        ChunkLB = Builder.CreateAdd(
+            Builder.CreateAlignedLoad(LBPtr, Alignment), ChunkStride,
+            "polly.indvar.nextLB");
+        ChunkUB = Builder.CreateAdd(
+            Builder.CreateAlignedLoad(UBPtr, Alignment), ChunkStride,
+            "polly.indvar.nextUB");
+
+        AdjUBOutOfBounds =
+            Builder.CreateICmp(llvm::CmpInst::Predicate::ICMP_SLT, ChunkUB,
+                               AdjustedUB, "polly.adjustedUBOutOfBounds");
+        ChunkUB = Builder.CreateSelect(AdjUBOutOfBounds, ChunkUB, AdjustedUB);
+        Builder.CreateAlignedStore(ChunkLB, LBPtr, Alignment);
+        Builder.CreateAlignedStore(ChunkUB, UBPtr, Alignment);
+
+        HasIteration =
+            Builder.CreateICmp(llvm::CmpInst::Predicate::ICMP_SLE, ChunkLB,
+                               ChunkUB, "polly.hasWork");
+        Builder.CreateCondBr(HasIteration, PreHeaderBB, ExitBB);
+      } else {
+        Builder.CreateBr(ExitBB);
+      }
 
       Builder.SetInsertPoint(PreHeaderBB);
+      LB = Builder.CreateAlignedLoad(LBPtr, Alignment, "polly.indvar.LB");
+      UB = Builder.CreateAlignedLoad(UBPtr, Alignment, "polly.indvar.UB");
     }
     break;
   }
@@ -260,7 +300,8 @@ ParallelLoopGeneratorKMP::createSubFn(Value *StrideNotUsed,
   // Add code to terminate this subfunction.
   Builder.SetInsertPoint(ExitBB);
   // Static (i.e. non-dynamic) scheduling types, are terminated with a fini-call
-  if (PollyScheduling == OMPGeneralSchedulingType::StaticChunked) {
+  if (PollyScheduling == OMPGeneralSchedulingType::StaticChunked ||
+      PollyScheduling == OMPGeneralSchedulingType::StaticNonChunked) {
     createCallStaticFini(ID);
   }
   Builder.CreateRetVoid();
@@ -287,6 +328,24 @@ Value *ParallelLoopGeneratorKMP::createCallGlobalThreadNum() {
   return Builder.CreateCall(F, {SourceLocationInfo});
 }
 
+Value *ParallelLoopGeneratorKMP::createCallInParallel() {
+  const std::string Name = "__kmpc_in_parallel";
+  Function *F = M->getFunction(Name);
+
+  // If F is not available, declare it.
+  if (!F) {
+    StructType *IdentTy = M->getTypeByName("struct.ident_t");
+
+    GlobalValue::LinkageTypes Linkage = Function::ExternalLinkage;
+    Type *Params[] = {IdentTy->getPointerTo()};
+
+    FunctionType *Ty = FunctionType::get(Builder.getInt32Ty(), Params, false);
+    F = Function::Create(Ty, Linkage, Name, M);
+  }
+
+  return Builder.CreateCall(F, {SourceLocationInfo});
+}
+
 void ParallelLoopGeneratorKMP::createCallPushNumThreads(Value *GlobalThreadID,
                                                         Value *NumThreads) {
   const std::string Name = "__kmpc_push_num_threads";
@@ -313,6 +372,7 @@ void ParallelLoopGeneratorKMP::createCallStaticInit(Value *GlobalThreadID,
                                                     Value *IsLastPtr,
                                                     Value *LBPtr, Value *UBPtr,
                                                     Value *StridePtr,
+                                                    Value *Inc,
                                                     Value *ChunkSize) {
   const std::string Name =
       is64BitArch() ? "__kmpc_for_static_init_8" : "__kmpc_for_static_init_4";
@@ -347,7 +407,7 @@ void ParallelLoopGeneratorKMP::createCallStaticInit(Value *GlobalThreadID,
       LBPtr,
       UBPtr,
       StridePtr,
-      ConstantInt::get(LongType, 1),
+      Inc,
       ChunkSize};
 
   Builder.CreateCall(F, Args);
@@ -51,12 +51,15 @@
 #include "polly/LinkAllPasses.h"
 #include "polly/Options.h"
 #include "polly/ScheduleTreeTransform.h"
+#include "polly/ScopDetectionDiagnostic.h"
 #include "polly/ScopInfo.h"
 #include "polly/ScopPass.h"
 #include "polly/Simplify.h"
+#include "polly/Support/GICHelper.h"
 #include "polly/Support/ISLOStream.h"
 #include "llvm/ADT/Statistic.h"
 #include "llvm/Analysis/TargetTransformInfo.h"
+#include "llvm/IR/DiagnosticInfo.h"
 #include "llvm/IR/Function.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Debug.h"
@@ -260,6 +263,18 @@ static cl::opt<bool>
                 cl::desc("Perform optimizations based on pattern matching"),
                 cl::init(true), cl::ZeroOrMore, cl::cat(PollyCategory));
 
+static cl::opt<bool> PatternOnly(
+    "polly-opt-pattern-only",
+    cl::desc("Only change the schedule of SCoPs in which a pattern of the "
+             "pattern-matching based optimizations has been detected"),
+    cl::Hidden, cl::init(false), cl::ZeroOrMore, cl::cat(PollyCategory));
+
+static cl::opt<int> ScheduleComputeOut(
+    "polly-schedule-computeout",
+    cl::desc("Bound the scheduler by maximal amount of computational steps "
+             "(0 means no bound)"),
+    cl::Hidden, cl::init(300000), cl::ZeroOrMore, cl::cat(PollyCategory));
+
 static cl::opt<bool> OptimizedScops(
     "polly-optimized-scops",
     cl::desc("Polly - Dump polyhedral description of Scops optimized with "
@@ -270,6 +285,10 @@ static cl::opt<bool> OptimizedScops(
 STATISTIC(ScopsProcessed, "Number of scops processed");
 STATISTIC(ScopsRescheduled, "Number of scops rescheduled");
 STATISTIC(ScopsOptimized, "Number of scops optimized");
+STATISTIC(ScopsOutOfQuota,
+          "Number of scops whose scheduling exceeded the max operations");
+STATISTIC(ScopsWithoutPattern,
+          "Number of scops skipped because no pattern has been detected");
 
 STATISTIC(NumAffineLoopsOptimized, "Number of affine loops optimized");
 STATISTIC(NumBoxedLoopsOptimized, "Number of boxed loops optimized");
@@ -1339,6 +1358,8 @@ ScheduleTreeOptimizer::optimizeBand(__isl_take isl_schedule_node *Node,
       isMatrMultPattern(isl::manage_copy(Node), OAI->D, MMI)) {
     LLVM_DEBUG(dbgs() << "The matrix multiplication pattern was detected\n");
     MatMulOpts++;
+    if (OAI->PatternOptsApplied)
+      ++*OAI->PatternOptsApplied;
     return optimizeMatMulPattern(isl::manage(Node), OAI->TTI, MMI).release();
   }
 
@@ -1465,6 +1486,40 @@ static void walkScheduleTreeForStatistics(isl::schedule Schedule, int Version) {
       &Version);
 }
 
+/// Emit a remark about the schedule optimization of @p S.
+template <typename RemarkTy>
+static void emitScheduleRemark(Scop &S, StringRef RemarkName, StringRef Msg) {
+  DebugLoc Begin, End;
+  getDebugLocations(getBBPairForRegion(&S.getRegion()), Begin, End);
+  RemarkTy R(DEBUG_TYPE, RemarkName, Begin, S.getEntry());
+  R << Msg;
+  S.getFunction().getContext().diagnose(R);
+}
+
+/// Return whether a statement of @p S may form a matrix multiplication.
+///
+/// This is a cheap necessary condition for the pattern-matching based
+/// optimizations: a statement nested in at least three loops that reads C, A
+/// and B and writes C. It allows skipping the rescheduling of SCoPs that
+/// cannot contain a pattern.
+static bool mayContainMatMul(Scop &S) {
+  for (ScopStmt &Stmt : S) {
+    if (Stmt.getNumIterators() < 3)
+      continue;
+    unsigned NumArrayAccesses = 0;
+    bool HasArrayWrite = false;
+    for (MemoryAccess *MA : Stmt) {
+      if (!MA->isLatestArrayKind())
+        continue;
+      NumArrayAccesses++;
+      HasArrayWrite |= MA->isWrite();
+    }
+    if (HasArrayWrite && NumArrayAccesses >= 4)
+      return true;
+  }
+  return false;
+}
+
 bool IslScheduleOptimizer::runOnScop(Scop &S) {
   // Skip SCoPs in case they're already optimised by PPCGCodeGeneration
   if (S.isToBeSkipped())
@@ -1488,6 +1543,12 @@ bool IslScheduleOptimizer::runOnScop(Scop &S) {
   if (!D.hasValidDependences())
     return false;
 
+  if (PatternOnly && (!PMBasedOpts || !mayContainMatMul(S))) {
+    LLVM_DEBUG(dbgs() << "SCoP cannot contain a known pattern\n");
+    ScopsWithoutPattern++;
+    return false;
+  }
+
   isl_schedule_free(LastSchedule);
   LastSchedule = nullptr;
 
@@ -1593,9 +1654,23 @@ bool IslScheduleOptimizer::runOnScop(Scop &S) {
   SC = SC.set_proximity(Proximity);
   SC = SC.set_validity(Validity);
   SC = SC.set_coincidence(Validity);
-  auto Schedule = SC.compute_schedule();
+  isl::schedule Schedule;
+  bool OutOfQuota;
+  {
+    IslMaxOperationsGuard MaxOpGuard(Ctx, ScheduleComputeOut);
+    Schedule = SC.compute_schedule();
+    OutOfQuota = MaxOpGuard.hasQuotaExceeded();
+  }
   isl_options_set_on_error(Ctx, OnErrorStatus);
 
+  if (OutOfQuota) {
+    LLVM_DEBUG(dbgs() << "Schedule optimizer calculation exceeds ISL quota\n");
+    ScopsOutOfQuota++;
+    emitScheduleRemark<OptimizationRemarkAnalysis>(
+        S, "OutOfQuota",
+        "maximal number of operations exceeded during scheduling");
+  }
+
   walkScheduleTreeForStatistics(Schedule, 1);
 
   // In cases the scheduler is not able to optimize the code, we just do not
@@ -1617,11 +1692,24 @@ bool IslScheduleOptimizer::runOnScop(Scop &S) {
 
   Function &F = S.getFunction();
   auto *TTI = &getAnalysis<TargetTransformInfoWrapperPass>().getTTI(F);
-  const OptimizerAdditionalInfoTy OAI = {TTI, const_cast<Dependences *>(&D)};
+  unsigned NumPatternOpts = 0;
+  const OptimizerAdditionalInfoTy OAI = {TTI, const_cast<Dependences *>(&D),
+                                         &NumPatternOpts};
   auto NewSchedule = ScheduleTreeOptimizer::optimizeSchedule(Schedule, &OAI);
   NewSchedule = hoistExtensionNodes(NewSchedule);
   walkScheduleTreeForStatistics(NewSchedule, 2);
 
+  if (NumPatternOpts > 0) {
+    emitScheduleRemark<OptimizationRemark>(
+        S, "MatMul", "optimized matrix multiplication pattern");
+  } else if (PatternOnly) {
+    LLVM_DEBUG(dbgs() << "No pattern detected, keeping the schedule\n");
+    ScopsWithoutPattern++;
+    emitScheduleRemark<OptimizationRemarkMissed>(
+        S, "NoPattern", "no matrix multiplication pattern detected");
+    return false;
+  }
+
   if (!ScheduleTreeOptimizer::isProfitableSchedule(S, NewSchedule))
     return false;
 
@@ -0,0 +1,567 @@
+// -*- C++ -*-
+//===-- parallel_backend_std_thread.h -------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef _PSTL_PARALLEL_BACKEND_STD_THREAD_H
+#define _PSTL_PARALLEL_BACKEND_STD_THREAD_H
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <optional>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// A backend that needs nothing but the standard library: the algorithms are
+// divided into tasks that run on a pool of std::threads. Every pool thread has
+// a queue of tasks, takes work from the back of its own queue and steals from
+// the front of the others. Threads that are not part of the pool share one
+// more queue. A thread that waits for a task to complete keeps executing
+// other tasks meanwhile, so nested parallelism can not deadlock.
+
+namespace __pstl
+{
+namespace __std_thread_backend
+{
+
+//! Raw memory buffer with automatic freeing and no exceptions.
+/** Some of our algorithms need to start with raw memory buffer,
+not an initialize array, because initialization/destruction
+would make the span be at least O(N). */
+template <typename _Tp>
+class __buffer
+{
+    std::allocator<_Tp> __allocator_;
+    _Tp* __ptr_;
+    const std::size_t __buf_size_;
+    __buffer(const __buffer&) = delete;
+    void
+    operator=(const __buffer&) = delete;
+
+  public:
+    //! Try to obtain buffer of given size to store objects of _Tp type
+    __buffer(std::size_t __n) : __allocator_(), __ptr_(__allocator_.allocate(__n)), __buf_size_(__n) {}
+    //! True if buffer was successfully obtained, zero otherwise.
+    operator bool() const { return __ptr_ != nullptr; }
+    //! Return pointer to buffer, or nullptr if buffer could not be obtained.
+    _Tp*
+    get() const
+    {
+        return __ptr_;
+    }
+    //! Destroy buffer
+    ~__buffer() { __allocator_.deallocate(__ptr_, __buf_size_); }
+};
+
+inline void
+__cancel_execution()
+{
+}
+
+class __task
+{
+  public:
+    virtual void
+    __execute() = 0;
+
+    //! Executes the task and marks it as done. The task may be destroyed by
+    //! its owner as soon as it is marked, so it must not be used afterwards.
+    void
+    __run()
+    {
+        __execute();
+        __done_.store(true, std::memory_order_release);
+    }
+
+    bool
+    __is_done() const
+    {
+        return __done_.load(std::memory_order_acquire);
+    }
+
+  protected:
+    ~__task() = default;
+
+  private:
+    std::atomic<bool> __done_{false};
+};
+
+template <typename _Fp>
+class __function_task final : public __task
+{
+    _Fp& __f_;
+
+  public:
+    explicit __function_task(_Fp& __f) : __f_(__f) {}
+
+    void
+    __execute() override
+    {
+        __f_();
+    }
+};
+
+class __thread_pool
+{
+    struct __queue
+    {
+        std::mutex __mutex_;
+        std::deque<__task*> __tasks_;
+    };
+
+    std::size_t __num_threads_;
+    // Queue 0 is shared by the threads outside of the pool, queue I + 1
+    // belongs to pool thread I.
+    std::unique_ptr<__queue[]> __queues_;
+    std::atomic<std::size_t> __num_queued_{0};
+    std::atomic<std::size_t> __num_sleeping_{0};
+    std::mutex __sleep_mutex_;
+    std::condition_variable __wake_;
+
+    static std::size_t&
+    __queue_index()
+    {
+        static thread_local std::size_t __index = 0;
+        return __index;
+    }
+
+    __task*
+    __pop_back(std::size_t __index)
+    {
+        __queue& __q = __queues_[__index];
+        std::lock_guard<std::mutex> __lock(__q.__mutex_);
+        if (__q.__tasks_.empty())
+            return nullptr;
+        __task* __t = __q.__tasks_.back();
+        __q.__tasks_.pop_back();
+        __num_queued_.fetch_sub(1, std::memory_order_relaxed);
+        return __t;
+    }
+
+    __task*
+    __steal(std::size_t __index)
+    {
+        __queue& __q = __queues_[__index];
+        std::unique_lock<std::mutex> __lock(__q.__mutex_, std::try_to_lock);
+        if (!__lock || __q.__tasks_.empty())
+            return nullptr;
+        __task* __t = __q.__tasks_.front();
+        __q.__tasks_.pop_front();
+        __num_queued_.fetch_sub(1, std::memory_order_relaxed);
+        return __t;
+    }
+
+    void
+    __worker(std::size_t __index)
+    {
+        __queue_index() = __index;
+        for (;;)
+        {
+            if (__task* __t = __find_task())
+            {
+                __t->__run();
+                continue;
+            }
+            std::unique_lock<std::mutex> __lock(__sleep_mutex_);
+            ++__num_sleeping_;
+            __wake_.wait(__lock, [this] { return __num_queued_.load() != 0; });
+            --__num_sleeping_;
+        }
+    }
+
+  public:
+    __thread_pool()
+        : __num_threads_(std::max(std::thread::hardware_concurrency(), 1u) - 1),
+          __queues_(new __queue[__num_threads_ + 1])
+    {
+        for (std::size_t __i = 0; __i < __num_threads_; ++__i)
+            std::thread(&__thread_pool::__worker, this, __i + 1).detach();
+    }
+
+    //! The pool lives as long as the process, so that algorithms may run
+    //! during static destruction as well. Its threads are detached.
+    static __thread_pool&
+    __instance()
+    {
+        static __thread_pool* __pool = new __thread_pool;
+        return *__pool;
+    }
+
+    //! The number of threads that execute tasks, including the caller.
+    std::size_t
+    __concurrency() const
+    {
+        return __num_threads_ + 1;
+    }
+
+    void
+    __push(__task* __t)
+    {
+        __queue& __q = __queues_[__queue_index()];
+        {
+            std::lock_guard<std::mutex> __lock(__q.__mutex_);
+            __q.__tasks_.push_back(__t);
+            ++__num_queued_;
+        }
+        // Either a thread that is about to sleep sees the new task, or we see
+        // that it sleeps. Taking the lock makes sure that it waits already.
+        if (__num_sleeping_.load() != 0)
+        {
+            std::lock_guard<std::mutex> __lock(__sleep_mutex_);
+            __wake_.notify_one();
+        }
+    }
+
+    //! Takes __t back out of the caller's queue, unless another thread has
+    //! taken it already.
+    bool
+    __try_take_back(__task* __t)
+    {
+        __queue& __q = __queues_[__queue_index()];
+        std::lock_guard<std::mutex> __lock(__q.__mutex_);
+        auto __it = std::find(__q.__tasks_.rbegin(), __q.__tasks_.rend(), __t);
+        if (__it == __q.__tasks_.rend())
+            return false;
+        __q.__tasks_.erase(std::next(__it).base());
+        __num_queued_.fetch_sub(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    __task*
+    __find_task()
+    {
+        const std::size_t __index = __queue_index();
+        if (__task* __t = __pop_back(__index))
+            return __t;
+        const std::size_t __num_queues = __num_threads_ + 1;
+        for (std::size_t __i = 1; __i < __num_queues; ++__i)
+            if (__task* __t = __steal((__index + __i) % __num_queues))
+                return __t;
+        return nullptr;
+    }
+
+    //! Executes other tasks until __t is done.
+    void
+    __wait(const __task& __t)
+    {
+        while (!__t.__is_done())
+        {
+            if (__task* __other = __find_task())
+                __other->__run();
+            else
+                std::this_thread::yield();
+        }
+    }
+};
+
+//! Runs __f1 and __f2, possibly in parallel.
+template <typename _F1, typename _F2>
+void
+__invoke_pair(_F1&& __f1, _F2&& __f2)
+{
+    __thread_pool& __pool = __thread_pool::__instance();
+    __function_task<_F2> __task2(__f2);
+    __pool.__push(&__task2);
+    __f1();
+    if (__pool.__try_take_back(&__task2))
+        __f2();
+    else
+        __pool.__wait(__task2);
+}
+
+//! The size of the pieces that a range of __n elements is divided into.
+template <typename _Index>
+_Index
+__grain_size(_Index __n)
+{
+    const _Index __pieces = _Index(__thread_pool::__instance().__concurrency() * 8);
+    return std::max(__n / __pieces, _Index(1));
+}
+
+template <typename _Index, typename _Fp>
+void
+__for_each_piece(_Index __first, _Index __last, _Index __grain, _Fp&& __f)
+{
+    if (__last - __first <= __grain)
+    {
+        __f(__first, __last);
+        return;
+    }
+    const _Index __middle = __first + (__last - __first) / 2;
+    __invoke_pair([&] { __for_each_piece(__first, __middle, __grain, __f); },
+                  [&] { __for_each_piece(__middle, __last, __grain, __f); });
+}
+
+template <class _ExecutionPolicy, class _Index, class _Fp>
+void
+__parallel_for(_ExecutionPolicy&&, _Index __first, _Index __last, _Fp __f)
+{
+    if (__first == __last)
+        return;
+    __for_each_piece(__first, __last, __grain_size(__last - __first), __f);
+}
+
+template <typename _Value, typename _Index, typename _RealBody, typename _Reduction>
+_Value
+__reduce_pieces(_Index __first, _Index __last, _Index __grain, const _Value& __identity,
+                const _RealBody& __real_body, const _Reduction& __reduction)
+{
+    if (__last - __first <= __grain)
+        return __real_body(__first, __last, __identity);
+    const _Index __middle = __first + (__last - __first) / 2;
+    std::optional<_Value> __left, __right;
+    __invoke_pair(
+        [&] { __left.emplace(__reduce_pieces(__first, __middle, __grain, __identity, __real_body, __reduction)); },
+        [&] { __right.emplace(__reduce_pieces(__middle, __last, __grain, __identity, __real_body, __reduction)); });
+    return __reduction(*__left, *__right);
+}
+
+template <class _ExecutionPolicy, class _Value, class _Index, typename _RealBody, typename _Reduction>
+_Value
+__parallel_reduce(_ExecutionPolicy&&, _Index __first, _Index __last, const _Value& __identity,
+                  const _RealBody& __real_body, const _Reduction& __reduction)
+{
+    if (__first == __last)
+        return __identity;
+    return __reduce_pieces(__first, __last, __grain_size(__last - __first), __identity, __real_body,
+                           __reduction);
+}
+
+//! Reduces the pieces after the first one. There is no identity for the
+//! transformed values, so each piece starts with its own first element.
+template <class _Index, class _Up, class _Tp, class _Cp, class _Rp>
+_Tp
+__transform_reduce_pieces(_Index __first, _Index __last, _Index __grain, _Up& __u, _Cp& __combine,
+                          _Rp& __brick_reduce)
+{
+    if (__last - __first <= __grain)
+        return __brick_reduce(__first + 1, __last, __u(__first));
+    const _Index __middle = __first + (__last - __first) / 2;
+    std::optional<_Tp> __left, __right;
+    __invoke_pair(
+        [&] {
+            __left.emplace(__transform_reduce_pieces<_Index, _Up, _Tp>(__first, __middle, __grain, __u, __combine,
+                                                                      __brick_reduce));
+        },
+        [&] {
+            __right.emplace(__transform_reduce_pieces<_Index, _Up, _Tp>(__middle, __last, __grain, __u, __combine,
+                                                                       __brick_reduce));
+        });
+    return __combine(*__left, *__right);
+}
+
+template <class _ExecutionPolicy, class _Index, class _Up, class _Tp, class _Cp, class _Rp>
+_Tp
+__parallel_transform_reduce(_ExecutionPolicy&&, _Index __first, _Index __last, _Up __u, _Tp __init, _Cp __combine,
+                            _Rp __brick_reduce)
+{
+    const _Index __n = __last - __first;
+    const _Index __grain = __grain_size(__n);
+    if (__n <= __grain)
+        return __brick_reduce(__first, __last, __init);
+    return __combine(__init, __transform_reduce_pieces<_Index, _Up, _Tp>(__first, __last, __grain, __u, __combine,
+                                                                        __brick_reduce));
+}
+
+//! Runs __reduce on every piece in parallel, combines the results serially
+//! in order, and runs __scan on every piece in parallel with the combination
+//! of the pieces before it.
+template <class _ExecutionPolicy, typename _Index, typename _Tp, typename _Rp, typename _Cp, typename _Sp,
+          typename _Ap>
+void
+__parallel_strict_scan(_ExecutionPolicy&& __exec, _Index __n, _Tp __initial, _Rp __reduce, _Cp __combine,
+                       _Sp __scan, _Ap __apex)
+{
+    const _Index __grain = __grain_size(__n);
+    if (__n <= __grain)
+    {
+        _Tp __sum = __initial;
+        if (__n)
+            __sum = __combine(__sum, __reduce(_Index(0), __n));
+        __apex(__sum);
+        if (__n)
+            __scan(_Index(0), __n, __initial);
+        return;
+    }
+    const _Index __num_pieces = (__n + __grain - 1) / __grain;
+    std::vector<_Tp> __sums(__num_pieces, __initial);
+    __parallel_for(__exec, _Index(0), __num_pieces, [&](_Index __i, _Index __j) {
+        for (; __i != __j; ++__i)
+            __sums[__i] = __reduce(__i * __grain, std::min(__n, (__i + 1) * __grain));
+    });
+    // Turn the sums into the prefixes of the pieces.
+    _Tp __prefix = __initial;
+    for (_Index __i = 0; __i < __num_pieces; ++__i)
+    {
+        _Tp __sum = __combine(__prefix, __sums[__i]);
+        __sums[__i] = __prefix;
+        __prefix = __sum;
+    }
+    __apex(__prefix);
+    __parallel_for(__exec, _Index(0), __num_pieces, [&](_Index __i, _Index __j) {
+        for (; __i != __j; ++__i)
+            __scan(__i * __grain, std::min(__n, (__i + 1) * __grain), __sums[__i]);
+    });
+}
+
+template <class _ExecutionPolicy, class _Index, class _Up, class _Tp, class _Cp, class _Rp, class _Sp>
+_Tp
+__parallel_transform_scan(_ExecutionPolicy&& __exec, _Index __n, _Up __u, _Tp __init, _Cp __combine,
+                          _Rp __brick_reduce, _Sp __scan)
+{
+    const _Index __grain = __grain_size(__n);
+    if (__n <= __grain)
+        return __scan(_Index(0), __n, __init);
+    const _Index __num_pieces = (__n + __grain - 1) / __grain;
+    // The prefix of piece I is kept in __prefixes[I]. The sums of the pieces
+    // are computed into the next slot first.
+    std::vector<_Tp> __prefixes(__num_pieces, __init);
+    __parallel_for(__exec, _Index(1), __num_pieces, [&](_Index __i, _Index __j) {
+        for (; __i != __j; ++__i)
+        {
+            const _Index __begin = (__i - 1) * __grain;
+            __prefixes[__i] = __brick_reduce(__begin + 1, __begin + __grain, __u(__begin));
+        }
+    });
+    for (_Index __i = 1; __i < __num_pieces; ++__i)
+        __prefixes[__i] = __combine(__prefixes[__i - 1], __prefixes[__i]);
+    _Tp __result = __init;
+    __parallel_for(__exec, _Index(0), __num_pieces, [&](_Index __i, _Index __j) {
+        for (; __i != __j; ++__i)
+        {
+            _Tp __sum = __scan(__i * __grain, std::min(__n, (__i + 1) * __grain), __prefixes[__i]);
+            if (__i == __num_pieces - 1)
+                __result = __sum;
+        }
+    });
+    return __result;
+}
+
+//! Merges [__first1, __last1) and [__first2, __last2) into __out, splitting
+//! the larger range in the middle while both are larger than __grain. Ties
+//! are resolved in favor of the first range, like std::merge does.
+template <typename _It1, typename _It2, typename _It3, typename _Compare, typename _LeafMerge>
+void
+__merge_pieces(_It1 __first1, _It1 __last1, _It2 __first2, _It2 __last2, _It3 __out, _Compare __comp,
+               _LeafMerge& __leaf_merge, std::size_t __grain)
+{
+    const std::size_t __n1 = __last1 - __first1, __n2 = __last2 - __first2;
+    if (__n1 + __n2 <= __grain)
+    {
+        __leaf_merge(__first1, __last1, __first2, __last2, __out, __comp);
+        return;
+    }
+    _It1 __middle1;
+    _It2 __middle2;
+    if (__n1 >= __n2)
+    {
+        __middle1 = __first1 + __n1 / 2;
+        __middle2 = std::lower_bound(__first2, __last2, *__middle1, __comp);
+    }
+    else
+    {
+        __middle2 = __first2 + __n2 / 2;
+        __middle1 = std::upper_bound(__first1, __last1, *__middle2, __comp);
+    }
+    _It3 __middle_out = __out + (__middle1 - __first1) + (__middle2 - __first2);
+    __invoke_pair(
+        [&] { __merge_pieces(__first1, __middle1, __first2, __middle2, __out, __comp, __leaf_merge, __grain); },
+        [&] {
+            __merge_pieces(__middle1, __last1, __middle2, __last2, __middle_out, __comp, __leaf_merge, __grain);
+        });
+}
+
+template <class _ExecutionPolicy, typename _RandomAccessIterator1, typename _RandomAccessIterator2,
+          typename _RandomAccessIterator3, typename _Compare, typename _LeafMerge>
+void
+__parallel_merge(_ExecutionPolicy&&, _RandomAccessIterator1 __first1, _RandomAccessIterator1 __last1,
+                 _RandomAccessIterator2 __first2, _RandomAccessIterator2 __last2, _RandomAccessIterator3 __outit,
+                 _Compare __comp, _LeafMerge __leaf_merge)
+{
+    const std::size_t __n = (__last1 - __first1) + (__last2 - __first2);
+    __merge_pieces(__first1, __last1, __first2, __last2, __outit, __comp, __leaf_merge,
+                   std::max<std::size_t>(__grain_size(__n), 1024));
+}
+
+//! Sorts [__first, __last) by sorting its halves in parallel and merging them
+//! through __buf, which has room for __last - __first elements.
+template <typename _RandomAccessIterator, typename _Tp, typename _Compare, typename _LeafSort>
+void
+__stable_sort_pieces(_RandomAccessIterator __first, _RandomAccessIterator __last, _Tp* __buf, _Compare __comp,
+                     _LeafSort& __leaf_sort, std::size_t __grain)
+{
+    const std::size_t __n = __last - __first;
+    if (__n <= __grain)
+    {
+        __leaf_sort(__first, __last, __comp);
+        return;
+    }
+    const std::size_t __half = __n / 2;
+    __invoke_pair([&] { __stable_sort_pieces(__first, __first + __half, __buf, __comp, __leaf_sort, __grain); },
+                  [&] {
+                      __stable_sort_pieces(__first + __half, __last, __buf + __half, __comp, __leaf_sort, __grain);
+                  });
+    __for_each_piece(std::size_t(0), __n, __grain, [&](std::size_t __i, std::size_t __j) {
+        for (; __i != __j; ++__i)
+            ::new (std::addressof(__buf[__i])) _Tp(std::move(__first[__i]));
+    });
+    auto __move_merge = [](_Tp* __first1, _Tp* __last1, _Tp* __first2, _Tp* __last2, _RandomAccessIterator __out,
+                           _Compare __comp) {
+        for (; __first1 != __last1 && __first2 != __last2; ++__out)
+        {
+            if (__comp(*__first2, *__first1))
+                *__out = std::move(*__first2++);
+            else
+                *__out = std::move(*__first1++);
+        }
+        std::move(__first2, __last2, std::move(__first1, __last1, __out));
+    };
+    __merge_pieces(__buf, __buf + __half, __buf + __half, __buf + __n, __first, __comp, __move_merge, __grain);
+    __for_each_piece(std::size_t(0), __n, __grain, [&](std::size_t __i, std::size_t __j) {
+        for (; __i != __j; ++__i)
+            __buf[__i].~_Tp();
+    });
+}
+
+template <class _ExecutionPolicy, typename _RandomAccessIterator, typename _Compare, typename _LeafSort>
+void
+__parallel_stable_sort(_ExecutionPolicy&&, _RandomAccessIterator __first, _RandomAccessIterator __last,
+                       _Compare __comp, _LeafSort __leaf_sort, std::size_t __nsort = 0)
+{
+    typedef typename std::iterator_traits<_RandomAccessIterator>::value_type _Tp;
+    const std::size_t __n = __last - __first;
+    const std::size_t __grain = std::max<std::size_t>(__grain_size(__n), 1024);
+    // A partial sort is left to the leaf sort, merging only the sorted
+    // prefixes of the pieces is not worth it.
+    if (__n <= __grain || (__nsort != 0 && __nsort < __n))
+    {
+        __leaf_sort(__first, __last, __comp);
+        return;
+    }
+    __buffer<_Tp> __buf(__n);
+    __stable_sort_pieces(__first, __last, __buf.get(), __comp, __leaf_sort, __grain);
+}
+
+template <class _ExecutionPolicy, typename _F1, typename _F2>
+void
+__parallel_invoke(_ExecutionPolicy&&, _F1&& __f1, _F2&& __f2)
+{
+    __invoke_pair(std::forward<_F1>(__f1), std::forward<_F2>(__f2));
+}
+
+} // namespace __std_thread_backend
+} // namespace __pstl
+
+#endif /* _PSTL_PARALLEL_BACKEND_STD_THREAD_H */